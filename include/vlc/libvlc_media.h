@@ -124,6 +124,7 @@ typedef struct libvlc_media_stats_t
     int         i_displayed_pictures;
     int         i_late_pictures;
     int         i_lost_pictures;
+    int         i_missed_vsyncs; /**< presentations after the targeted vblank */
 
     /* Audio output */
     int         i_played_abuffers;
@@ -499,6 +499,182 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+/**
+ * A decoded video frame, as handed by libvlc_video_frame_cb.
+ *
+ * The frame is the decoder output itself, in system memory or in the memory
+ * of the hardware decoder: no copy nor conversion is made.
+ */
+typedef struct libvlc_video_frame_t libvlc_video_frame_t;
+
+/**
+ * Memory holding a video frame
+ */
+typedef enum libvlc_video_frame_type_t
+{
+    libvlc_video_frame_cpu,           /**< planes in system memory */
+    libvlc_video_frame_dmabuf,        /**< planes in dma-buf file descriptors */
+    libvlc_video_frame_d3d11,         /**< ID3D11Texture2D* and array slice */
+    libvlc_video_frame_cvpixelbuffer, /**< CVPixelBufferRef */
+    libvlc_video_frame_cuda,          /**< CUdeviceptr and pitch */
+    libvlc_video_frame_vaapi,         /**< VADisplay and VASurfaceID */
+} libvlc_video_frame_type_t;
+
+/**
+ * Plane of a video frame, in system memory or in a dma-buf
+ */
+typedef struct libvlc_video_frame_plane_t
+{
+    const void *data; /**< pixels (libvlc_video_frame_cpu only) */
+    int fd; /**< dma-buf file descriptor (libvlc_video_frame_dmabuf only) */
+    unsigned offset; /**< offset of the plane in the dma-buf */
+    unsigned pitch; /**< line size in bytes */
+    unsigned lines; /**< number of lines */
+} libvlc_video_frame_plane_t;
+
+/**
+ * Callback prototype receiving decoded video frames.
+ *
+ * The frame is only valid during the callback, unless retained with
+ * libvlc_video_frame_retain(). Frames belong to a limited pool of the
+ * decoder: holding too many of them for too long stalls decoding.
+ *
+ * \param opaque private pointer as passed to libvlc_video_set_frame_callback()
+ * \param frame the decoded frame
+ */
+typedef void (*libvlc_video_frame_cb)(void *opaque,
+                                      libvlc_video_frame_t *frame);
+
+/**
+ * Set a callback receiving decoded video frames without copy.
+ *
+ * Contrary to libvlc_video_set_callbacks(), hardware decoding stays enabled,
+ * and the frames are handed in their native memory: system memory planes,
+ * dma-buf file descriptors, Direct3D 11 textures, CoreVideo pixel buffers,
+ * CUDA device memory or VA surfaces. Hardware frames of other types are
+ * converted to system memory. Subpictures are not blended.
+ *
+ * The callback is invoked from the video output thread, at the display date
+ * of each frame.
+ *
+ * \param mp the media player
+ * \param cb callback receiving the frames (must not be NULL)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb cb,
+                                      void *opaque );
+
+/**
+ * Decode the video of the media without playing it.
+ *
+ * The media player only demuxes and decodes the video tracks: no video or
+ * audio output is created, the timestamps are not waited for, and
+ * subpictures are not rendered. Each decoded frame is handed to the callback
+ * straight from the decoder, in system memory, as soon as it is available.
+ * Files are therefore decoded as fast as possible.
+ *
+ * This is meant for analytics on many streams at a time. It replaces the
+ * "sout" option of the media player and must be set before playback.
+ *
+ * \param mp the media player
+ * \param cb callback receiving the frames (must not be NULL)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \param frame_step hand one frame out of frame_step decoded frames
+ *                   (0 or 1 for every frame)
+ * \param keyframes_only decode only the key frames
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_decode_callback( libvlc_media_player_t *mp,
+                                       libvlc_video_frame_cb cb,
+                                       void *opaque, unsigned frame_step,
+                                       bool keyframes_only );
+
+/**
+ * Hold a video frame beyond the callback.
+ *
+ * \param frame the frame
+ * \return the same frame
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+libvlc_video_frame_t *libvlc_video_frame_retain( libvlc_video_frame_t *frame );
+
+/**
+ * Release a video frame held by libvlc_video_frame_retain().
+ *
+ * \param frame the frame
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_frame_release( libvlc_video_frame_t *frame );
+
+/**
+ * Get the memory type of a video frame
+ *
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+libvlc_video_frame_type_t
+libvlc_video_frame_get_type( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the format of a video frame
+ *
+ * \param frame the frame
+ * \param chroma a four-characters chroma identifier (e.g. "I420" or "NV12")
+ *               for system memory and dma-buf frames, the VLC hardware
+ *               chroma otherwise [OUT]
+ * \param width visible width in pixels [OUT]
+ * \param height visible height in pixels [OUT]
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_frame_get_format( const libvlc_video_frame_t *frame,
+                                    char chroma[4],
+                                    unsigned *width, unsigned *height );
+
+/**
+ * Get the presentation timestamp of a video frame
+ *
+ * \return the timestamp in microseconds, in the time base of the media
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+int64_t libvlc_video_frame_get_pts( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the planes of a system memory or dma-buf video frame
+ *
+ * The dma-buf file descriptors belong to the frame: duplicate them to use
+ * them after the frame is released.
+ *
+ * \param frame the frame
+ * \param planes array of (at least) 5 planes [OUT]
+ * \return the number of planes, 0 for other frame types
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+unsigned libvlc_video_frame_get_planes( const libvlc_video_frame_t *frame,
+                                        libvlc_video_frame_plane_t *planes );
+
+/**
+ * Get the native handle of a hardware video frame
+ *
+ * \param frame the frame
+ * \param index the array slice (Direct3D 11), the pitch (CUDA) or the
+ *              VASurfaceID (VA-API) [OUT]
+ * \return the ID3D11Texture2D*, CVPixelBufferRef, CUdeviceptr or
+ *         VADisplay, or NULL for system memory and dma-buf frames
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void *libvlc_video_frame_get_handle( const libvlc_video_frame_t *frame,
+                                     uintptr_t *index );
+
 
 typedef struct libvlc_video_setup_device_cfg_t
 {
@@ -1084,6 +1260,96 @@ LIBVLC_API
 void libvlc_audio_set_format( libvlc_media_player_t *mp, const char *format,
                               unsigned rate, unsigned channels );
 
+/**
+ * Opaque audio tap handle.
+ *
+ * \see libvlc_audio_tap_add()
+ */
+typedef struct libvlc_audio_tap_t libvlc_audio_tap_t;
+
+/**
+ * Single-producer single-consumer ring buffer for an audio tap.
+ *
+ * The ring is allocated by the application, which reads the samples between
+ * read_index and write_index. Indexes count samples and wrap around the
+ * storage modulo its capacity.
+ *
+ * \warning Both indexes must be accessed atomically: write_index with
+ * acquire semantics by the application, read_index with release semantics
+ * (e.g. C11 atomic_load_explicit() on a cast pointer or C++20
+ * std::atomic_ref). LibVLC never blocks on the ring.
+ */
+typedef struct libvlc_audio_ring_t
+{
+    float *buffer; /**< storage for interleaved 32-bits float samples */
+    size_t capacity; /**< storage size in samples, a power of two */
+    uint64_t write_index; /**< samples written, updated by LibVLC only */
+    uint64_t read_index; /**< samples read, updated by the application only */
+} libvlc_audio_ring_t;
+
+/**
+ * Callback prototype for audio tap batches.
+ *
+ * LibVLC invokes this callback from the audio thread after each batch is
+ * made visible in the ring. It must not block.
+ *
+ * \param opaque private pointer as passed to libvlc_audio_tap_add() [IN]
+ * \param rate sample rate of the batch in Hz [IN]
+ * \param channels channel count of the batch [IN]
+ * \param write_index new value of the ring write index [IN]
+ */
+typedef void (*libvlc_audio_tap_cb)(void *opaque, unsigned rate,
+                                    unsigned channels, uint64_t write_index);
+
+/**
+ * Add an audio tap to a media player.
+ *
+ * The tap copies the decoded audio of the media player into the ring, while
+ * the audio is still played by the audio output. Several taps can be added to
+ * the same media player.
+ *
+ * Samples are published in batches of at least the requested number of
+ * frames, so that the consumer is not woken up for every audio buffer. If
+ * the ring is too full for a whole audio buffer, the buffer is dropped
+ * for this tap and counted as overrun.
+ *
+ * \param mp the media player
+ * \param ring the ring buffer, which must outlive the tap
+ * \param batch_frames minimum number of frames per batch (0 to publish every
+ *                     audio buffer)
+ * \param cb callback invoked after each batch (or NULL)
+ * \param opaque private pointer for the callback
+ * \return the tap, or NULL on error
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+libvlc_audio_tap_t *libvlc_audio_tap_add( libvlc_media_player_t *mp,
+                                          libvlc_audio_ring_t *ring,
+                                          unsigned batch_frames,
+                                          libvlc_audio_tap_cb cb,
+                                          void *opaque );
+
+/**
+ * Remove an audio tap.
+ *
+ * Once this function returns, LibVLC does not access the ring anymore.
+ *
+ * \param tap the tap to remove
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_audio_tap_remove( libvlc_audio_tap_t *tap );
+
+/**
+ * Get the number of audio frames dropped for a tap because its ring was full.
+ *
+ * \param tap the tap
+ * \return the number of dropped frames since the tap was added
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+uint64_t libvlc_audio_tap_get_overruns( const libvlc_audio_tap_t *tap );
+
 /** \bug This might go away ... to be replaced by a broader system */
 
 /**
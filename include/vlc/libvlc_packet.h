@@ -0,0 +1,407 @@
+/*****************************************************************************
+ * libvlc_packet.h:  libvlc external API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_LIBVLC_PACKET_H
+#define VLC_LIBVLC_PACKET_H 1
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/** \defgroup libvlc_packet LibVLC elementary stream packets
+ * \ingroup libvlc
+ * Compressed elementary stream packets, as output by the demuxers.
+ *
+ * Packets can be received from any media played by a media player, without
+ * decoding, and injected back into a media created from a packet source.
+ * Packets are reference counted and their payload is never copied.
+ * @{
+ * \file
+ * LibVLC elementary stream packets external API
+ */
+
+typedef struct libvlc_packet_es_t libvlc_packet_es_t;
+typedef struct libvlc_packet_t libvlc_packet_t;
+typedef struct libvlc_packet_source_t libvlc_packet_source_t;
+
+/**
+ * Packet flags
+ */
+typedef enum libvlc_packet_flag_t
+{
+    libvlc_packet_discontinuity = 0x0001, /**< discontinuity before this packet */
+    libvlc_packet_keyframe      = 0x0002, /**< packet starts a key frame */
+    libvlc_packet_corrupted     = 0x0400, /**< packet is known to be damaged */
+} libvlc_packet_flag_t;
+
+/*
+ * Elementary streams
+ */
+
+/**
+ * Create an elementary stream description.
+ *
+ * This is only needed to inject streams that were not received from LibVLC.
+ * Streams received with libvlc_media_player_set_packet_callbacks() can be
+ * injected as is.
+ *
+ * \param type the track type (audio, video or text)
+ * \param codec the codec fourcc, as in \ref libvlc_media_track_t
+ * \param id the track identifier, or -1 to let LibVLC pick one
+ * \return a new elementary stream, or NULL on error
+ */
+LIBVLC_API libvlc_packet_es_t *
+libvlc_packet_es_new( libvlc_track_type_t type, uint32_t codec, int id );
+
+/**
+ * Increment the reference count of an elementary stream.
+ *
+ * \param es an elementary stream
+ * \return the same elementary stream
+ */
+LIBVLC_API libvlc_packet_es_t *
+libvlc_packet_es_retain( libvlc_packet_es_t *es );
+
+/**
+ * Decrement the reference count of an elementary stream.
+ *
+ * \param es an elementary stream
+ */
+LIBVLC_API void
+libvlc_packet_es_release( libvlc_packet_es_t *es );
+
+/**
+ * Get the track of an elementary stream.
+ *
+ * The track describes the codec, identifier, language and the audio, video
+ * or subtitle properties of the stream.
+ *
+ * \param es an elementary stream
+ * \return a new track, to be released with libvlc_media_track_release(),
+ * or NULL on error
+ */
+LIBVLC_API libvlc_media_track_t *
+libvlc_packet_es_get_track( const libvlc_packet_es_t *es );
+
+/**
+ * Get the codec extra data (decoder configuration) of an elementary stream.
+ *
+ * \param es an elementary stream
+ * \param size storage for the size of the extra data in bytes [OUT]
+ * \return the extra data owned by the elementary stream, or NULL if none
+ */
+LIBVLC_API const void *
+libvlc_packet_es_get_extra( const libvlc_packet_es_t *es, size_t *size );
+
+/**
+ * Set the codec extra data of an elementary stream.
+ *
+ * \note This cannot be changed once the stream is added to a source.
+ *
+ * \param es an elementary stream
+ * \param data the extra data, copied
+ * \param size the size of the extra data in bytes
+ * \return 0 on success, -1 on error
+ */
+LIBVLC_API int
+libvlc_packet_es_set_extra( libvlc_packet_es_t *es,
+                            const void *data, size_t size );
+
+/**
+ * Set the picture size of a video elementary stream.
+ *
+ * \param es an elementary stream
+ * \param width the picture width in pixels
+ * \param height the picture height in pixels
+ */
+LIBVLC_API void
+libvlc_packet_es_set_video( libvlc_packet_es_t *es,
+                            unsigned width, unsigned height );
+
+/**
+ * Set the format of an audio elementary stream.
+ *
+ * \param es an elementary stream
+ * \param rate the sample rate in Hz
+ * \param channels the number of channels
+ */
+LIBVLC_API void
+libvlc_packet_es_set_audio( libvlc_packet_es_t *es,
+                            unsigned rate, unsigned channels );
+
+/*
+ * Packets
+ */
+
+/**
+ * Callback prototype releasing the payload of a packet.
+ *
+ * \param opaque the private pointer passed to libvlc_packet_new()
+ */
+typedef void (*libvlc_packet_free_cb)( void *opaque );
+
+/**
+ * Create a packet from application memory, without copying.
+ *
+ * \param data the payload, which must not be modified while the packet
+ * exists
+ * \param size the payload size in bytes
+ * \param free_cb callback invoked once LibVLC is done with the payload
+ * (or NULL)
+ * \param opaque private pointer for the free callback
+ * \return a new packet with a reference count of 1, or NULL on error
+ */
+LIBVLC_API libvlc_packet_t *
+libvlc_packet_new( void *data, size_t size,
+                   libvlc_packet_free_cb free_cb, void *opaque );
+
+/**
+ * Increment the reference count of a packet.
+ *
+ * \param pkt a packet
+ * \return the same packet
+ */
+LIBVLC_API libvlc_packet_t *
+libvlc_packet_retain( libvlc_packet_t *pkt );
+
+/**
+ * Decrement the reference count of a packet.
+ * The packet payload must not be accessed after this call.
+ *
+ * \param pkt a packet
+ */
+LIBVLC_API void
+libvlc_packet_release( libvlc_packet_t *pkt );
+
+/**
+ * Get the payload of a packet.
+ *
+ * \param pkt a packet
+ * \param size storage for the payload size in bytes [OUT]
+ * \return the payload, owned by the packet
+ */
+LIBVLC_API const void *
+libvlc_packet_get_data( const libvlc_packet_t *pkt, size_t *size );
+
+/**
+ * Get the presentation timestamp of a packet.
+ *
+ * \param pkt a packet
+ * \return the timestamp in microseconds, or -1 if unknown
+ */
+LIBVLC_API int64_t
+libvlc_packet_get_pts( const libvlc_packet_t *pkt );
+
+/**
+ * Get the decoding timestamp of a packet.
+ *
+ * \param pkt a packet
+ * \return the timestamp in microseconds, or -1 if unknown
+ */
+LIBVLC_API int64_t
+libvlc_packet_get_dts( const libvlc_packet_t *pkt );
+
+/**
+ * Get the duration of a packet.
+ *
+ * \param pkt a packet
+ * \return the duration in microseconds, or 0 if unknown
+ */
+LIBVLC_API int64_t
+libvlc_packet_get_duration( const libvlc_packet_t *pkt );
+
+/**
+ * Get the flags of a packet.
+ *
+ * \param pkt a packet
+ * \return a combination of the libvlc_packet_* flags
+ */
+LIBVLC_API unsigned
+libvlc_packet_get_flags( const libvlc_packet_t *pkt );
+
+/**
+ * Set the timestamps of a packet.
+ *
+ * \param pkt a packet
+ * \param pts the presentation timestamp in microseconds, or -1 if unknown
+ * \param dts the decoding timestamp in microseconds, or -1 if unknown
+ * \param duration the duration in microseconds, or 0 if unknown
+ */
+LIBVLC_API void
+libvlc_packet_set_timestamps( libvlc_packet_t *pkt, int64_t pts, int64_t dts,
+                              int64_t duration );
+
+/**
+ * Set the flags of a packet.
+ *
+ * \param pkt a packet
+ * \param flags a combination of the libvlc_packet_* flags
+ */
+LIBVLC_API void
+libvlc_packet_set_flags( libvlc_packet_t *pkt, unsigned flags );
+
+/*
+ * Packet output
+ */
+
+/**
+ * Callback prototype for a new elementary stream.
+ *
+ * \param opaque private pointer as passed to
+ * libvlc_media_player_set_packet_callbacks()
+ * \param es the elementary stream; it can be retained to outlive the call
+ * \return a private pointer for the stream, passed to the other callbacks
+ */
+typedef void *(*libvlc_packet_es_added_cb)( void *opaque,
+                                            libvlc_packet_es_t *es );
+
+/**
+ * Callback prototype for a removed elementary stream.
+ *
+ * \param opaque private pointer as passed to
+ * libvlc_media_player_set_packet_callbacks()
+ * \param es_opaque the stream private pointer
+ */
+typedef void (*libvlc_packet_es_removed_cb)( void *opaque, void *es_opaque );
+
+/**
+ * Callback prototype for an elementary stream packet.
+ *
+ * \param opaque private pointer as passed to
+ * libvlc_media_player_set_packet_callbacks()
+ * \param es_opaque the stream private pointer
+ * \param pkt the packet; it can be retained to outlive the call
+ */
+typedef void (*libvlc_packet_cb)( void *opaque, void *es_opaque,
+                                  libvlc_packet_t *pkt );
+
+/**
+ * Receive the elementary stream packets of the media, instead of playing it.
+ *
+ * The packets are output by the demuxers (and packetizers) and are neither
+ * decoded nor transcoded. The callbacks are invoked from the input thread and
+ * should not block.
+ *
+ * \note This must be set before the media is played, and overrides the
+ * "sout" option of the media player.
+ *
+ * \param mp the media player
+ * \param es_added callback for a new elementary stream (or NULL to disable)
+ * \param es_removed callback for a removed elementary stream (can be NULL)
+ * \param packet callback for each packet
+ * \param opaque private pointer for the callbacks
+ */
+LIBVLC_API void
+libvlc_media_player_set_packet_callbacks( libvlc_media_player_t *mp,
+                                          libvlc_packet_es_added_cb es_added,
+                                          libvlc_packet_es_removed_cb es_removed,
+                                          libvlc_packet_cb packet,
+                                          void *opaque );
+
+/*
+ * Packet sources
+ */
+
+/**
+ * Create a packet source.
+ *
+ * The application feeds elementary streams and packets into the source and
+ * plays a media created with libvlc_media_new_packet_source(). The
+ * application paces the source: packets are queued until the media player
+ * consumes them.
+ *
+ * \return a new packet source, or NULL on error
+ */
+LIBVLC_API libvlc_packet_source_t *
+libvlc_packet_source_new( void );
+
+/**
+ * Destroy a packet source.
+ *
+ * \note The media using this source must not be played anymore.
+ *
+ * \param src a packet source
+ */
+LIBVLC_API void
+libvlc_packet_source_release( libvlc_packet_source_t *src );
+
+/**
+ * Add an elementary stream to a packet source.
+ *
+ * \param src a packet source
+ * \param es the elementary stream, retained by the source
+ * \return 0 on success, -1 on error
+ */
+LIBVLC_API int
+libvlc_packet_source_add_es( libvlc_packet_source_t *src,
+                             libvlc_packet_es_t *es );
+
+/**
+ * Remove an elementary stream from a packet source.
+ *
+ * \param src a packet source
+ * \param es an elementary stream that was added to the source
+ */
+LIBVLC_API void
+libvlc_packet_source_remove_es( libvlc_packet_source_t *src,
+                                libvlc_packet_es_t *es );
+
+/**
+ * Push a packet into a packet source.
+ *
+ * Packets should be pushed in decoding order across all streams.
+ *
+ * \param src a packet source
+ * \param es an elementary stream that was added to the source
+ * \param pkt the packet, retained by the source
+ * \return 0 on success, -1 on error
+ */
+LIBVLC_API int
+libvlc_packet_source_push( libvlc_packet_source_t *src,
+                           libvlc_packet_es_t *es, libvlc_packet_t *pkt );
+
+/**
+ * Signal the end of the stream to a packet source.
+ *
+ * The media reaches its end once the queued packets are consumed.
+ *
+ * \param src a packet source
+ */
+LIBVLC_API void
+libvlc_packet_source_end( libvlc_packet_source_t *src );
+
+/**
+ * Create a media playing the packets of a packet source.
+ *
+ * \param instance the instance
+ * \param src the packet source, which must outlive the media playback
+ * \return the newly created media, or NULL on error
+ */
+LIBVLC_API libvlc_media_t *
+libvlc_media_new_packet_source( libvlc_instance_t *instance,
+                                libvlc_packet_source_t *src );
+
+/** @} */
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif /* VLC_LIBVLC_PACKET_H */
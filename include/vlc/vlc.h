@@ -41,6 +41,7 @@ extern "C" {
 #include <vlc/libvlc_picture.h>
 #include <vlc/libvlc_media.h>
 #include <vlc/libvlc_media_player.h>
+#include <vlc/libvlc_packet.h>
 #include <vlc/libvlc_media_list.h>
 #include <vlc/libvlc_media_list_player.h>
 #include <vlc/libvlc_media_discoverer.h>
@@ -404,6 +404,24 @@ VLC_API char *aout_DeviceGet (audio_output_t *);
 VLC_API int aout_DeviceSet (audio_output_t *, const char *);
 VLC_API int aout_DevicesList (audio_output_t *, char ***, char ***);
 
+/**
+ * Report the playback time of the audio samples.
+ *
+ * The outputs knowing precisely when their samples are played, typically
+ * from hardware timestamps, report it to synchronize the clock.
+ *
+ * \param system_now system date when the sample is played
+ * \param pts timestamp of the sample
+ *
+ * \warning This must be called from the audio_output_t.play callback, after
+ * the buffer has been queued: the core may call back the output.
+ */
+static inline void aout_TimingReport(audio_output_t *aout,
+                                     vlc_tick_t system_now, vlc_tick_t pts)
+{
+    aout->events->timing_report(aout, system_now, pts);
+}
+
 /**
  * Report change of configured audio volume to the core and UI.
  */
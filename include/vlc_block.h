@@ -306,6 +306,125 @@ VLC_API block_t *block_File(int fd, bool write) VLC_USED VLC_MALLOC;
  */
 VLC_API block_t *block_FilePath(const char *, bool write) VLC_USED VLC_MALLOC;
 
+/**
+ * \defgroup block_pool Block pool
+ * Recycling allocator for blocks
+ * @{
+ */
+
+/**
+ * Block pool handle
+ */
+typedef struct block_pool_t block_pool_t;
+
+/**
+ * Block pool statistics
+ */
+struct block_pool_stats
+{
+    uint64_t hits; /**< Allocations served with a recycled block */
+    uint64_t misses; /**< Allocations that required a heap allocation */
+    uint64_t oversized; /**< Allocations too large for any size class */
+};
+
+/**
+ * Creates a block pool.
+ *
+ * A block pool recycles released blocks in a few size classes suitable for
+ * TS packets, datagrams, PES packets and NAL units. This avoids heap
+ * allocator round-trips, and contention thereof, on hot paths allocating
+ * many blocks of similar sizes.
+ *
+ * The pool is typically owned by a single producer, such as a demuxer or a
+ * packetizer. Blocks allocated from the pool can be released from any
+ * thread with block_Release() as usual, and may outlive the pool.
+ *
+ * @return a pointer to the new pool on success, or NULL on error
+ */
+VLC_API block_pool_t *block_pool_New(void) VLC_USED;
+
+/**
+ * Releases a block pool.
+ *
+ * Recycled blocks are freed. Blocks still in use remain valid and are freed
+ * when they are released.
+ */
+VLC_API void block_pool_Release(block_pool_t *);
+
+/**
+ * Allocates a block from a pool.
+ *
+ * This is equivalent to block_Alloc(), but reuses a previously released block
+ * if one is available in the matching size class. Requests larger than the
+ * largest size class fall back to block_Alloc().
+ *
+ * @param size size in bytes (possibly zero)
+ * @return the created block, or NULL on memory error.
+ */
+VLC_API block_t *block_pool_Alloc(block_pool_t *, size_t size) VLC_USED;
+
+/**
+ * Gets the statistics of a block pool.
+ *
+ * The hit rate is \c hits / (\c hits + \c misses + \c oversized).
+ */
+VLC_API void block_pool_GetStats(block_pool_t *, struct block_pool_stats *);
+
+/** @} */
+
+/**
+ * \defgroup block_view Block views
+ * Blocks sharing the data of another block
+ * @{
+ */
+
+/**
+ * Makes a block shareable.
+ *
+ * Wraps a block so that views of its data can be taken with block_View().
+ * The wrapper replaces the block: it has the same payload and properties,
+ * and the data is released when both the wrapper and all its views have
+ * been released.
+ *
+ * If the block is already shareable, or is a view, it is returned as is.
+ *
+ * @param block block to wrap (cannot be NULL)
+ * @return the shareable block, or the original block on memory error.
+ */
+VLC_API block_t *block_Shareable(block_t *block) VLC_USED;
+
+/**
+ * Creates a view of a block.
+ *
+ * Creates a block referencing a range of the payload of a shareable block
+ * or of another view, without copying. The view has default properties,
+ * and can be released independently of the viewed block.
+ *
+ * Views of a same block may overlap, so their data must not be modified
+ * in place. Growing a view with block_Realloc() always copies.
+ *
+ * @param block shareable block or view (cannot be NULL)
+ * @param offset byte offset of the view within the payload
+ * @param length byte length of the view
+ * @return the view, or NULL if the block is not shareable or on memory error.
+ */
+VLC_API block_t *block_View(const block_t *block, size_t offset,
+                            size_t length) VLC_USED;
+
+/**
+ * Joins a chain of views.
+ *
+ * If all the blocks of a chain are views of the same block, covering
+ * contiguous ranges in order, creates a single view of the whole range.
+ * The chain itself is left untouched.
+ *
+ * @return the joined view, or NULL if the chain cannot be joined or on
+ * memory error.
+ */
+VLC_API block_t *block_ViewJoin(const block_t *list) VLC_USED;
+
+/** @} */
+
 static inline void block_Cleanup (void *block)
 {
     block_Release ((block_t *)block);
@@ -327,7 +446,8 @@ static inline void block_Cleanup (void *block)
  *      and update it.
  * - block_ChainRelease : release a chain of block
  * - block_ChainExtract : extract data from a chain, return real bytes counts
- * - block_ChainGather : gather a chain, free it and return one block.
+ * - block_ChainGather : gather a chain, free it and return one block,
+ *      without copying if the chain is made of contiguous views.
  ****************************************************************************/
 static inline void block_ChainAppend( block_t **pp_list, block_t *p_block )
 {
@@ -416,10 +536,14 @@ static inline block_t *block_ChainGather( block_t *p_list )
 
     block_ChainProperties( p_list, NULL, &i_total, &i_length );
 
-    g = block_Alloc( i_total );
+    g = block_ViewJoin( p_list );
     if( !g )
-        return NULL;
-    block_ChainExtract( p_list, g->p_buffer, g->i_buffer );
+    {
+        g = block_Alloc( i_total );
+        if( !g )
+            return NULL;
+        block_ChainExtract( p_list, g->p_buffer, g->i_buffer );
+    }
 
     g->i_flags = p_list->i_flags;
     g->i_pts   = p_list->i_pts;
@@ -451,7 +575,20 @@ static inline block_t *block_ChainGather( block_t *p_list )
 VLC_API block_fifo_t *block_FifoNew(void) VLC_USED VLC_MALLOC;
 
 /**
- * Destroys a FIFO created by block_FifoNew().
+ * Creates a thread-safe FIFO queue of blocks with a lock-free producer path.
+ *
+ * This is the same as block_FifoNew(), except that vlc_fifo_Push() does not
+ * lock the FIFO, unless the consumer is waiting or the FIFO is congested.
+ * vlc_fifo_Push() must not be called by more than one thread at a time,
+ * and only one thread may wait with vlc_fifo_Wait().
+ * All other FIFO functions can be used as usual.
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API block_fifo_t *block_FifoNewSPSC(void) VLC_USED VLC_MALLOC;
+
+/**
+ * Destroys a FIFO created by block_FifoNew() or block_FifoNewSPSC().
  *
  * @note Any queued blocks are also destroyed.
  * @warning No other threads may be using the FIFO when this function is
@@ -542,10 +679,7 @@ static inline void vlc_fifo_Signal(vlc_fifo_t *fifo)
  * @note This function is a cancellation point. In case of cancellation, the
  * the FIFO will be locked before cancellation cleanup handlers are processed.
  */
-static inline void vlc_fifo_Wait(vlc_fifo_t *fifo)
-{
-    vlc_queue_Wait(vlc_fifo_queue(fifo));
-}
+VLC_API void vlc_fifo_Wait(vlc_fifo_t *fifo);
 
 static inline void vlc_fifo_WaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar)
 {
@@ -567,6 +701,21 @@ static inline void vlc_fifo_WaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar)
  */
 VLC_API void vlc_fifo_QueueUnlocked(vlc_fifo_t *fifo, block_t *block);
 
+/**
+ * Queues a linked-list of blocks into an unlocked FIFO.
+ *
+ * This is equivalent to block_FifoPut(). However, with a FIFO created by
+ * block_FifoNewSPSC(), the FIFO is normally not locked.
+ *
+ * @param block the head of the list of blocks
+ *              (if NULL, this function has no effects)
+ *
+ * @note This function is not a cancellation point.
+ *
+ * @warning The FIFO must not be locked by the calling thread.
+ */
+VLC_API void vlc_fifo_Push(vlc_fifo_t *fifo, block_t *block);
+
 /**
  * Dequeues the first block from a locked FIFO, if any.
  *
@@ -605,6 +754,9 @@ VLC_API block_t *vlc_fifo_DequeueAllUnlocked(vlc_fifo_t *) VLC_USED;
  * vlc_fifo_Lock(). Otherwise behaviour is undefined.
  *
  * @return the number of blocks in the FIFO (zero if it is empty)
+ *
+ * @note With a FIFO created by block_FifoNewSPSC(), this function can also be
+ * called without locking, e.g. to throttle the producer.
  */
 VLC_API size_t vlc_fifo_GetCount(const vlc_fifo_t *) VLC_USED;
 
@@ -623,13 +775,21 @@ VLC_API size_t vlc_fifo_GetCount(const vlc_fifo_t *) VLC_USED;
  * @note Zero bytes does not necessarily mean that the FIFO is empty since
  * a block could contain zero bytes. Use vlc_fifo_GetCount() to determine if
  * a FIFO is empty.
+ *
+ * @note With a FIFO created by block_FifoNewSPSC(), this function can also be
+ * called without locking, e.g. to throttle the producer.
  */
 VLC_API size_t vlc_fifo_GetBytes(const vlc_fifo_t *) VLC_USED;
 
-VLC_USED static inline bool vlc_fifo_IsEmpty(const vlc_fifo_t *fifo)
-{
-    return vlc_queue_IsEmpty(vlc_fifo_queue(fifo));
-}
+/**
+ * Checks if a locked FIFO is empty.
+ *
+ * @note This function is not cancellation point.
+ *
+ * @warning The FIFO must be locked by the calling thread using
+ * vlc_fifo_Lock(). Otherwise behaviour is undefined.
+ */
+VLC_API bool vlc_fifo_IsEmpty(vlc_fifo_t *) VLC_USED;
 
 static inline void vlc_fifo_Cleanup(void *fifo)
 {
@@ -42,6 +42,7 @@
  */
 
 typedef struct decoder_cc_desc_t decoder_cc_desc_t;
+struct vlc_display_load;
 
 struct decoder_owner_callbacks
 {
@@ -66,6 +67,10 @@ struct decoder_owner_callbacks
             /* Display rate
              * cf. decoder_GetDisplayRate */
             float       (*get_display_rate)( decoder_t * );
+            /* Display load
+             * cf. decoder_GetDisplayLoad */
+            int         (*get_display_load)( decoder_t *,
+                                             struct vlc_display_load * );
         } video;
         struct
         {
@@ -379,6 +384,61 @@ VLC_API void decoder_Destroy( decoder_t *p_dec );
  */
 VLC_API void decoder_Clean( decoder_t *p_dec );
 
+/**
+ * Decoder threads budget
+ *
+ * Software decoders acquire their thread count from a budget shared by all
+ * the decoders of the process, instead of each one using all the CPUs.
+ * The budget is split according to the decoders resolution, and split again
+ * whenever a decoder acquires or releases its share.
+ */
+typedef struct vlc_decoder_threads vlc_decoder_threads;
+
+/**
+ * Acquire a share of the decoder threads budget.
+ *
+ * To be used by decoder modules when opening, once the input format is known.
+ *
+ * \param dec the decoder object
+ * \param max the maximum number of threads the decoder can use, or 0
+ * \return a threads budget share, or NULL on allocation error
+ */
+VLC_API vlc_decoder_threads *vlc_decoder_threads_Acquire( decoder_t *dec,
+                                                         unsigned max );
+
+/**
+ * Get the current number of threads assigned to a decoder.
+ *
+ * This changes when other decoders acquire or release their share. Decoders
+ * that can change their thread count, usually on flush, may check it again.
+ *
+ * \return the number of threads, always at least 1
+ */
+VLC_API unsigned vlc_decoder_threads_Count( vlc_decoder_threads * );
+
+/**
+ * Release a share of the decoder threads budget.
+ *
+ * The remaining decoders get the released threads.
+ */
+VLC_API void vlc_decoder_threads_Release( vlc_decoder_threads * );
+
+/**
+ * Acquire a share of the decoder threads budget for an encoder.
+ *
+ * Software encoders running in the same process as decoders take their
+ * threads from the same budget, so that transcoding does not oversubscribe
+ * the CPUs. An encoder weighs twice as much as a decoder of the same
+ * resolution. The share is used with vlc_decoder_threads_Count() and
+ * vlc_decoder_threads_Release().
+ *
+ * \param enc the encoder object, with its input format set
+ * \param max the maximum number of threads the encoder can use, or 0
+ * eturn a threads budget share, or NULL on allocation error
+ */
+VLC_API vlc_decoder_threads *vlc_encoder_threads_Acquire( encoder_t *enc,
+                                                         unsigned max );
+
 /**
  * This function queues a single picture to the video output.
  *
@@ -533,6 +593,35 @@ static inline float decoder_GetDisplayRate( decoder_t *dec )
     return dec->cbs->video.get_display_rate( dec );
 }
 
+/**
+ * Load of the video output
+ */
+struct vlc_display_load
+{
+    unsigned   queued; /**< decoded pictures waiting to be displayed */
+    vlc_tick_t render; /**< estimated time to prepare and render a picture */
+};
+
+/**
+ * This function returns the load of the video output, so that a decoder
+ * falling behind can skip the decoding of the pictures that would be late.
+ * You MUST use it *only* for decoding speed decisions.
+ *
+ * 
+eturn VLC_SUCCESS, or an error if the load is unknown
+ */
+VLC_USED
+static inline int decoder_GetDisplayLoad( decoder_t *dec,
+                                          struct vlc_display_load *load )
+{
+    vlc_assert( dec->fmt_in.i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( !dec->cbs->video.get_display_load )
+        return VLC_EGENERIC;
+
+    return dec->cbs->video.get_display_load( dec, load );
+}
+
 /** @} */
 
 /**
@@ -552,6 +641,7 @@ enum vlc_decoder_device_type
     VLC_DECODER_DEVICE_AWINDOW,
     VLC_DECODER_DEVICE_NVDEC,
     VLC_DECODER_DEVICE_MMAL,
+    VLC_DECODER_DEVICE_DRM_PRIME,
 };
 
 struct vlc_decoder_device_operations
@@ -631,5 +721,23 @@ vlc_decoder_device_Hold(vlc_decoder_device *device);
 VLC_API void
 vlc_decoder_device_Release(vlc_decoder_device *device);
 
+/**
+ * Select the adapter a decoder device should use
+ *
+ * This applies the "dec-dev-adapter" policy to the adapters available to
+ * the decoder device module. The device counts as an active session on the
+ * selected adapter until it is released, so that the next devices of the
+ * same type can be balanced across the adapters.
+ *
+ * This can only be called once, from the "decoder device" module open entry
+ * point, after the device type is set.
+ *
+ * \param device the decoder device being opened
+ * \param count the number of adapters available, at least 1
+ * \return the index of the adapter to use, below count
+ */
+VLC_API unsigned
+vlc_decoder_device_SelectAdapter(vlc_decoder_device *device, unsigned count);
+
 /** @} */
 #endif /* _VLC_CODEC_H */
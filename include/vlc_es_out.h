@@ -113,6 +113,10 @@ enum es_out_query_e
     ES_OUT_SPU_SET_HIGHLIGHT, /* arg1= es_out_id_t* (spu es),
                                  arg2= const vlc_spu_highlight_t *, res=can fail  */
 
+    /* Playback speed adjustment, applied on top of the user rate, so that a
+     * live demuxer can keep up with its source (low latency streaming) */
+    ES_OUT_SET_RATE_ADJUST, /* arg1=double (1.0 for none), res=can fail */
+
     /* First value usable for private control */
     ES_OUT_PRIVATE_START = 0x10000,
 };
@@ -200,6 +204,10 @@ static inline int es_out_ControlModifyPcrSystem( es_out_t *out, bool b_absolute,
 {
     return es_out_Control( out, ES_OUT_MODIFY_PCR_SYSTEM, b_absolute, i_system );
 }
+static inline int es_out_ControlSetRateAdjust( es_out_t *out, double adjust )
+{
+    return es_out_Control( out, ES_OUT_SET_RATE_ADJUST, adjust );
+}
 
 /**
  * @}
@@ -60,8 +60,31 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    void *owner;
 };
 
+/**
+ * Priority of a runnable.
+ *
+ * Queued runnables of higher priority are started before those of lower
+ * priority. Runnables of the same priority are started in submission order
+ * (only approximately with a work-stealing executor).
+ */
+enum vlc_executor_priority {
+    VLC_EXECUTOR_PRIORITY_LOW,
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    VLC_EXECUTOR_PRIORITY_HIGH,
+};
+
+/**
+ * Use one queue per thread, and let idle threads steal tasks from the other
+ * queues, instead of a single queue shared by all the threads.
+ *
+ * This reduces contention when many small runnables are submitted in bursts.
+ * All the threads are started upfront.
+ */
+#define VLC_EXECUTOR_WORK_STEALING 0x1
+
 /**
  * Create a new executor.
  *
@@ -71,6 +94,16 @@ struct vlc_runnable {
 VLC_API vlc_executor_t *
 vlc_executor_New(unsigned max_threads);
 
+/**
+ * Create a new executor with specific flags.
+ *
+ * \param max_threads the maximum number of threads used to execute runnables
+ * \param flags a combination of VLC_EXECUTOR_* flags
+ * \return a pointer to a new executor, or NULL if an error occurred
+ */
+VLC_API vlc_executor_t *
+vlc_executor_NewExt(unsigned max_threads, unsigned flags);
+
 /**
  * Delete an executor.
  *
@@ -145,6 +178,21 @@ vlc_executor_Delete(vlc_executor_t *executor);
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution with a given priority.
+ *
+ * This is equivalent to vlc_executor_Submit(), which uses
+ * VLC_EXECUTOR_PRIORITY_NORMAL.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ * \param priority the priority of the task
+ */
+VLC_API void
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority);
+
 /**
  * Cancel a runnable previously submitted.
  *
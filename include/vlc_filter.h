@@ -263,7 +263,7 @@ static inline picture_t *filter_NewPicture( filter_t *p_filter )
     if ( pic == NULL )
     {
         // legacy filter owners not setting a default filter_allocator
-        pic = picture_NewFromFormat( &p_filter->fmt_out.video );
+        pic = picture_NewCached( p_filter, &p_filter->fmt_out.video );
     }
     if( pic == NULL )
         msg_Warn( p_filter, "can't get output picture" );
@@ -386,6 +386,56 @@ VLC_API void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 # define filter_DelProxyCallbacks(a, b, c) \
     filter_DelProxyCallbacks(VLC_OBJECT(a), b, c)
 
+/**
+ * Callback processing one slice of a picture.
+ *
+ * \param opaque the data pointer passed to filter_ExecuteSlices()
+ * \param slice index of the slice to process, from 0 to count - 1
+ * \param count number of slices the picture is split into
+ * \see filter_GetSliceLines()
+ */
+typedef void (*filter_slice_cb)(void *opaque, unsigned slice, unsigned count);
+
+/**
+ * Runs a callback on horizontal slices of a picture, in parallel.
+ *
+ * The slices are spread over a pool of worker threads shared by all the
+ * filters of the LibVLC instance, and the calling thread processes one of
+ * them. This function returns once all the slices have been processed.
+ *
+ * The callback is called once for each slice, with the same count. The
+ * callback must only write its own slice, but may read anything that is not
+ * written concurrently, e.g. the neighbouring lines of the input picture.
+ *
+ * This must not be called from a slice callback.
+ *
+ * \param filter the filter instance
+ * \param max_slices maximum number of slices; the actual count may be lower,
+ *                   down to a single slice processed by the calling thread
+ * \param cb callback processing one slice
+ * \param opaque data pointer passed to the callback
+ */
+VLC_API void filter_ExecuteSlices(filter_t *filter, unsigned max_slices,
+                                  filter_slice_cb cb, void *opaque);
+
+/**
+ * Gets the lines of a plane belonging to a slice.
+ *
+ * \param lines number of lines of the plane
+ * \param slice index of the slice, as passed to the callback
+ * \param count number of slices, as passed to the callback
+ * \param[out] begin first line of the slice
+ * \param[out] end line following the last line of the slice
+ */
+static inline void filter_GetSliceLines(int lines, unsigned slice,
+                                        unsigned count, int *restrict begin,
+                                        int *restrict end)
+{
+    assert(slice < count);
+    *begin = (int)((int64_t)lines * slice / count);
+    *end = (int)((int64_t)lines * (slice + 1) / count);
+}
+
 typedef filter_t vlc_blender_t;
 
 /**
@@ -601,6 +651,34 @@ VLC_API picture_t *filter_chain_VideoFilter(filter_chain_t *chain,
  */
 VLC_API void filter_chain_VideoFlush( filter_chain_t * );
 
+/**
+ * Run the video filters of a chain in a pipeline.
+ *
+ * The filters are split into at most \p threads groups of consecutive
+ * filters. Each group runs on its own thread, with at most \p depth pictures
+ * queued at its input. The threads are started on the next call to
+ * filter_chain_VideoFilter().
+ *
+ * This trades latency for throughput: filter_chain_VideoFilter() returns the
+ * pictures filtered so far, or NULL while they are still being processed.
+ * filter_chain_VideoDrain() must be called before draining the chain.
+ *
+ * \param chain video filter chain
+ * \param threads maximum number of threads, 0 to disable the pipeline
+ * \param depth maximum number of queued pictures per thread (at least 1)
+ */
+VLC_API void filter_chain_SetPipeline(filter_chain_t *chain, unsigned threads,
+                                      unsigned depth);
+
+/**
+ * Wait until a pipelined video filter chain has processed all its input.
+ *
+ * The filtered pictures can then be retrieved by calling
+ * filter_chain_VideoFilter() with a NULL picture until it returns NULL.
+ * This does nothing if the chain is not pipelined.
+ */
+VLC_API void filter_chain_VideoDrain(filter_chain_t *chain);
+
 /**
  * Generate subpictures from a chain of subpicture source "filters".
  *
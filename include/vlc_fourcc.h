@@ -432,6 +432,10 @@
 #define VLC_CODEC_CVPX_BGRA       VLC_FOURCC('C','V','P','B')
 #define VLC_CODEC_CVPX_P010       VLC_FOURCC('C','V','P','P')
 
+/* DRM PRIME (dma-buf) opaque buffer type, for use with KMS/EGL */
+#define VLC_CODEC_DRM_PRIME_NV12  VLC_FOURCC('D','R','M','8') /* 4:2:0  8 bpc */
+#define VLC_CODEC_DRM_PRIME_P010  VLC_FOURCC('D','R','M','0') /* 4:2:0 10 bpc */
+
 /* Image codec (video) */
 #define VLC_CODEC_PNG             VLC_FOURCC('p','n','g',' ')
 #define VLC_CODEC_PPM             VLC_FOURCC('p','p','m',' ')
@@ -609,6 +613,8 @@
 #define VLC_CODEC_EBU_STL   VLC_FOURCC('S','T','L',' ')
 #define VLC_CODEC_SCTE_18   VLC_FOURCC('S','C','1','8')
 #define VLC_CODEC_SCTE_27   VLC_FOURCC('S','C','2','7')
+/* SCTE-35 splice_info_section, the PTS is the splice time */
+#define VLC_CODEC_SCTE_35   VLC_FOURCC('S','C','3','5')
 /* EIA/CEA-608/708 */
 #define VLC_CODEC_CEA608    VLC_FOURCC('c','6','0','8')
 #define VLC_CODEC_CEA708    VLC_FOURCC('c','7','0','8')
@@ -499,6 +499,8 @@ VLC_API int libvlc_ArtRequest(libvlc_int_t *, input_item_t *,
                               const input_fetcher_callbacks_t *cbs,
                               void *cbs_userdata );
 VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
+VLC_API bool libvlc_MetadataCacheRestore( libvlc_int_t *, input_item_t * );
+VLC_API void libvlc_MetadataCacheStore( libvlc_int_t *, input_item_t * );
 
 /******************
  * Input stats
@@ -525,10 +527,16 @@ struct input_stats_t
     int64_t i_displayed_pictures;
     int64_t i_late_pictures;
     int64_t i_lost_pictures;
+    int64_t i_missed_vsyncs;
 
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* CPU time of the input and decoder threads */
+    vlc_tick_t i_cpu_time;
+    float f_cpu_usage; /**< in CPUs, e.g. 1.5 for one and a half CPU */
+    int i_cpu_degradation; /**< 0 within the CPU budget, see input-cpu-budget */
 };
 
 /**
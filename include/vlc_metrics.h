@@ -0,0 +1,94 @@
+/*****************************************************************************
+ * vlc_metrics.h: performance metrics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_METRICS_H
+#define VLC_METRICS_H
+
+/**
+ * \defgroup metrics Metrics
+ * \ingroup os
+ * \brief Performance histograms
+ *
+ * Histograms of processing times and queue depths, shared by all the objects
+ * of a LibVLC instance, and exported in the OpenMetrics text format.
+ *
+ * The metrics are only collected if the "metrics" option is enabled.
+ *
+ * @{
+ * \file
+ * Metrics functions
+ */
+
+/**
+ * Unit of the observed values
+ */
+enum vlc_metric_unit
+{
+    VLC_METRIC_SECONDS, /**< durations, observed as vlc_tick_t */
+    VLC_METRIC_BYTES,
+};
+
+struct vlc_histogram;
+
+/**
+ * Get a histogram, creating it on first use.
+ *
+ * The histogram remains valid until the LibVLC instance is destroyed, so it
+ * is meant to be looked up once, when the observing object is created.
+ *
+ * \param obj an object of the instance
+ * \param name the metric name, e.g. "vlc_decode_duration_seconds"
+ * \param labels the labels in the OpenMetrics syntax (e.g. "type=\"video\"")
+ *               or NULL
+ * \param help the description of the metric
+ * \param unit the unit of the observed values
+ * \return the histogram, or NULL if the metrics are disabled or on error
+ */
+VLC_API struct vlc_histogram *
+vlc_histogram_Get(vlc_object_t *obj, const char *name, const char *labels,
+                  const char *help, enum vlc_metric_unit unit);
+#define vlc_histogram_Get(o, n, l, h, u) \
+    vlc_histogram_Get(VLC_OBJECT(o), n, l, h, u)
+
+/**
+ * Record a value in a histogram.
+ *
+ * This function is lock-free.
+ *
+ * \param histogram the histogram (NULL is a no-op)
+ * \param value the value, a vlc_tick_t for durations
+ */
+VLC_API void vlc_histogram_Observe(struct vlc_histogram *histogram,
+                                   int64_t value);
+
+/**
+ * Format all the metrics of the instance.
+ *
+ * \param obj an object of the instance
+ * \return the metrics in the OpenMetrics text format (to be freed with
+ *         free()), or NULL on error
+ */
+VLC_API char *vlc_metrics_Format(vlc_object_t *obj) VLC_USED;
+#define vlc_metrics_Format(o) vlc_metrics_Format(VLC_OBJECT(o))
+
+/**
+ * @}
+ */
+#endif
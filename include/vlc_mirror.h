@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * vlc_mirror.h: mirrored ring buffers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MIRROR_H
+# define VLC_MIRROR_H 1
+
+/**
+ * \defgroup mirror Mirrored buffers
+ * \ingroup cext
+ *
+ * A mirrored buffer maps the same memory twice, one copy right after the
+ * other. Used as a ring buffer, any range of up to the buffer size starting
+ * within the first copy is contiguous: reads and writes never need to be
+ * split where the ring wraps around.
+ *
+ * @{
+ */
+
+/**
+ * Allocates a mirrored buffer.
+ *
+ * The buffer spans twice the requested size in the address space; writing
+ * the byte at offset @c i also writes it at offset <tt>i + size</tt>, and
+ * vice versa.
+ *
+ * @param size size of the buffer, a multiple of the page size
+ * @return the buffer address, or NULL if mirroring is not supported by the
+ *         platform or on error (the caller should then fall back to a
+ *         plain buffer)
+ */
+VLC_API void *vlc_mirror_Alloc(size_t size) VLC_USED;
+
+/**
+ * Releases a mirrored buffer.
+ *
+ * @param addr buffer address (as returned by vlc_mirror_Alloc())
+ * @param size size of the buffer (as passed to vlc_mirror_Alloc())
+ */
+VLC_API void vlc_mirror_Free(void *addr, size_t size);
+
+/** @} */
+
+#endif
@@ -96,6 +96,7 @@ enum vlc_video_context_type
     VLC_VIDEO_CONTEXT_NVDEC,
     VLC_VIDEO_CONTEXT_CVPX,
     VLC_VIDEO_CONTEXT_MMAL,
+    VLC_VIDEO_CONTEXT_DRM_PRIME,
 };
 
 VLC_API vlc_video_context * vlc_video_context_Create(vlc_decoder_device *,
@@ -313,6 +314,37 @@ VLC_API picture_t * picture_New( vlc_fourcc_t i_chroma, int i_width, int i_heigh
  */
 VLC_API picture_t * picture_NewFromFormat( const video_format_t *p_fmt ) VLC_USED;
 
+/**
+ * This function will create a new picture using the given format, reusing
+ * the buffer of a released picture of the same size if possible.
+ *
+ * The buffers are recycled by the LibVLC instance of the object, within the
+ * limits set by the "picture-cache-size" and "picture-cache-count" options.
+ * This otherwise behaves like picture_NewFromFormat().
+ */
+VLC_API picture_t * picture_NewCached( vlc_object_t *obj,
+                                       const video_format_t *p_fmt ) VLC_USED;
+#define picture_NewCached(o, f) picture_NewCached(VLC_OBJECT(o), f)
+
+/**
+ * Picture buffers cache statistics
+ */
+struct vlc_picture_cache_stats
+{
+    uint64_t hits; /**< Buffers reused */
+    uint64_t misses; /**< Buffers allocated */
+    uint64_t evictions; /**< Buffers freed to stay within the limits */
+    size_t cached_size; /**< Bytes of unused buffers */
+    unsigned cached_count; /**< Unused buffers */
+};
+
+/**
+ * Gets the picture buffers cache statistics of the LibVLC instance.
+ */
+VLC_API void picture_GetCacheStats( vlc_object_t *obj,
+                                    struct vlc_picture_cache_stats *stats );
+#define picture_GetCacheStats(o, s) picture_GetCacheStats(VLC_OBJECT(o), s)
+
 /**
  * Resource for a picture.
  */
@@ -61,6 +61,11 @@ VLC_API picture_t * picture_fifo_Pop( picture_fifo_t * ) VLC_USED;
  */
 VLC_API bool picture_fifo_IsEmpty( picture_fifo_t * );
 
+/**
+ * It returns the number of pictures inside the fifo.
+ */
+VLC_API size_t picture_fifo_Count( picture_fifo_t * );
+
 /**
  * It saves a picture_t into the fifo.
  */
@@ -290,6 +290,25 @@ struct vlc_playlist_callbacks
     void
     (*on_has_next_changed)(vlc_playlist_t *playlist,
                            bool has_next, void *userdata);
+
+    /**
+     * Called when several, possibly non-contiguous, items have been removed
+     * at once by vlc_playlist_RequestRemove().
+     *
+     * The removal is only notified this way if all the listeners implementing
+     * on_items_removed() also implement this callback. Otherwise, each slice
+     * is removed and notified separately by on_items_removed().
+     *
+     * \param playlist the playlist
+     * \param indices  the indices of the removed items before the removal, in
+     *                 increasing order
+     * \param count    the number of items removed
+     * \param userdata userdata provided to AddListener()
+     */
+    void
+    (*on_items_batch_removed)(vlc_playlist_t *playlist,
+                              const size_t indices[], size_t count,
+                              void *userdata);
 };
 
 /* Playlist items */
@@ -632,6 +651,8 @@ vlc_playlist_Shuffle(vlc_playlist_t *playlist);
 /**
  * Sort the playlist by a list of criteria.
  *
+ * The sort is stable: items comparing equal keep their relative order.
+ *
  * \param playlist the playlist, locked
  * \param criteria the sort criteria (in order)
  * \param count    the number of criteria
@@ -170,6 +170,7 @@ enum sout_stream_query_e {
     SOUT_STREAM_WANTS_SUBSTREAMS,  /* arg1=bool *, res=can fail (assume false) */
     SOUT_STREAM_ID_SPU_HIGHLIGHT,  /* arg1=void *, arg2=const vlc_spu_highlight_t *, res=can fail */
     SOUT_STREAM_IS_SYNCHRONOUS, /* arg1=bool *, can fail (assume false) */
+    SOUT_STREAM_RECORD_START,   /* res=can fail */
 };
 
 struct sout_stream_operations {
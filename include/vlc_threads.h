@@ -199,14 +199,15 @@ typedef pthread_key_t   vlc_threadvar_t;
 typedef struct vlc_timer *vlc_timer_t;
 
 /* Thread priorities.
- * No effect for POSIX threads
+ * These only identify the role of POSIX threads: their scheduling is left
+ * as inherited, unless a policy is set with the thread-<role> options.
  */
 # define VLC_THREAD_PRIORITY_LOW      0
-# define VLC_THREAD_PRIORITY_INPUT    0
-# define VLC_THREAD_PRIORITY_AUDIO    0
-# define VLC_THREAD_PRIORITY_VIDEO    0
-# define VLC_THREAD_PRIORITY_OUTPUT   0
-# define VLC_THREAD_PRIORITY_HIGHEST  0
+# define VLC_THREAD_PRIORITY_INPUT    1
+# define VLC_THREAD_PRIORITY_AUDIO    2
+# define VLC_THREAD_PRIORITY_VIDEO    3
+# define VLC_THREAD_PRIORITY_OUTPUT   4
+# define VLC_THREAD_PRIORITY_HIGHEST  5
 
 #endif
 
@@ -43,6 +43,24 @@ typedef struct vlc_thumbnailer_request_t vlc_thumbnailer_request_t;
  */
 typedef void(*vlc_thumbnailer_cb)( void* data, picture_t* thumbnail );
 
+/**
+ * \brief vlc_thumbnailer_batch_cb defines a callback invoked on completion or
+ * error of each thumbnail of a batch request
+ *
+ * This callback will be called once for each requested time, in the order of
+ * the request, provided vlc_thumbnailer_RequestBatchByTime returned a non
+ * NULL request. Cancelling the request will call it with a NULL picture for
+ * all the remaining thumbnails.
+ * The picture ownership is the same as for \link vlc_thumbnailer_cb \endlink
+ *
+ * \param data Is the opaque pointer passed as the request last parameter
+ * \param index The index of the requested time
+ * \param thumbnail The generated thumbnail, or NULL in case of failure or
+ *                  timeout
+ */
+typedef void(*vlc_thumbnailer_batch_cb)( void* data, size_t index,
+                                         picture_t* thumbnail );
+
 
 /**
  * \brief vlc_thumbnailer_Create Creates a thumbnailer object
@@ -112,6 +130,39 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               input_item_t *input_item, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief vlc_thumbnailer_RequestBatchByTime Requests several thumbnails of
+ * the same media
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken
+ * \param count The number of times
+ * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
+ * \param width The maximum width of the thumbnails, or 0
+ * \param height The maximum height of the thumbnails, or 0
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for each thumbnail, or VLC_TICK_INVALID to
+ *                disable timeout
+ * \param cb A user callback to be called on the completion of each thumbnail
+ * \param user_data An opaque value, provided as cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The media is opened only once to generate all the thumbnails. They are
+ * downscaled to fit the width x height box, preserving the display aspect
+ * ratio.
+ * The returned request object must not be used after the callback has been
+ * invoked for the last thumbnail. Apart from that, the request and the
+ * input_item follow the same rules as vlc_thumbnailer_RequestByTime().
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatchByTime( vlc_thumbnailer_t *thumbnailer,
+                                    const vlc_tick_t times[], size_t count,
+                                    enum vlc_thumbnailer_seek_speed speed,
+                                    unsigned width, unsigned height,
+                                    input_item_t *input_item,
+                                    vlc_tick_t timeout,
+                                    vlc_thumbnailer_batch_cb cb,
+                                    void* user_data );
+
 /**
  * \brief vlc_thumbnailer_Cancel Cancel a thumbnail request
  * \param thumbnailer A thumbnailer object
@@ -424,6 +424,14 @@ VLC_API vlc_tls_t *vlc_tls_SocketOpen(int fd);
  */
 VLC_API int vlc_tls_SocketPair(int family, int protocol, vlc_tls_t *[2]);
 
+/**
+ * Checks whether a transport-layer stream is a plain socket.
+ *
+ * If so, data can be sent and received directly through the file descriptor
+ * from vlc_tls_GetFD(), e.g. to let the kernel offload TLS.
+ */
+VLC_API bool vlc_tls_IsSocket(const vlc_tls_t *);
+
 struct addrinfo;
 
 /**
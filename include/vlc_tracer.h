@@ -179,6 +179,48 @@ static inline void vlc_tracer_TracePCR( struct vlc_tracer *tracer, const char *t
                      VLC_TRACE("pcr", NS_FROM_VLC_TICK(pcr)), VLC_TRACE_END);
 }
 
+/**
+ * Trace the value of a counter (a fifo depth, a clock drift, ...).
+ *
+ * \param counter the name of the counter
+ */
+static inline void vlc_tracer_TraceCounter(struct vlc_tracer *tracer, const char *type,
+                                const char *id, const char *counter,
+                                int64_t value)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("counter", counter),
+                     VLC_TRACE("value", (vlc_tick_t)value), VLC_TRACE_END);
+}
+
+/**
+ * Trace the beginning of a processing step of a frame.
+ *
+ * Each step of the pipeline (decoding, filtering, ...) is traced as a span,
+ * between a begin and an end event with the same type, id and pts, so that
+ * the latency of a frame through the whole pipeline can be reconstructed.
+ */
+static inline void vlc_tracer_TraceSpanBegin(struct vlc_tracer *tracer, const char *type,
+                                const char *id, vlc_tick_t pts)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("span", "begin"),
+                     VLC_TRACE("pts", NS_FROM_VLC_TICK(pts)), VLC_TRACE_END);
+}
+
+/**
+ * Trace the end of a processing step of a frame.
+ *
+ * \see vlc_tracer_TraceSpanBegin()
+ */
+static inline void vlc_tracer_TraceSpanEnd(struct vlc_tracer *tracer, const char *type,
+                                const char *id, vlc_tick_t pts)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("span", "end"),
+                     VLC_TRACE("pts", NS_FROM_VLC_TICK(pts)), VLC_TRACE_END);
+}
+
 /**
  * @}
  */
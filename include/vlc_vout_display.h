@@ -203,6 +203,10 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+
+    /* Presentation of a picture at the vblank of the given system date,
+     * with the refresh period of the output (0 if unknown). */
+    void (*vsync)(void *sys, vlc_tick_t date, vlc_tick_t period);
 };
 
 /**
@@ -437,6 +441,23 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+/**
+ * Reports the presentation of the last displayed picture.
+ *
+ * The displays getting a feedback from the compositor or the kernel report
+ * it, so that the pictures are scheduled on the refresh of the output.
+ *
+ * \param date system date of the vblank the picture was presented at
+ * \param period refresh period, or 0 if unknown
+ */
+static inline void vout_display_SendEventVsync(vout_display_t *vd,
+                                               vlc_tick_t date,
+                                               vlc_tick_t period)
+{
+    if (vd->owner.vsync)
+        vd->owner.vsync(vd->owner.sys, date, period);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
@@ -36,6 +36,7 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_atomic.h>
 #include <vlc_modules.h>
 
 #include "libvlc_internal.h"
@@ -596,3 +597,202 @@ float libvlc_audio_equalizer_get_amp_at_index( libvlc_equalizer_t *p_equalizer,
 
     return p_equalizer->f_amp[ u_band ];
 }
+
+/******************************************************************************
+ * Audio taps
+ *****************************************************************************/
+
+struct libvlc_audio_tap_t
+{
+    struct vlc_list node;
+    libvlc_media_player_t *mp;
+    libvlc_audio_ring_t *ring;
+    unsigned batch_frames;
+    libvlc_audio_tap_cb cb;
+    void *opaque;
+
+    /* Audio thread state, protected by the media player taps lock */
+    uint64_t write_index; /* including the unpublished samples */
+    unsigned pending; /* unpublished frames */
+    unsigned rate;
+    unsigned channels;
+
+    atomic_uint_fast64_t overruns;
+};
+
+static void audio_tap_publish( libvlc_audio_tap_t *tap )
+{
+    if( tap->pending == 0 )
+        return;
+
+    atomic_store_explicit( (_Atomic uint64_t *)&tap->ring->write_index,
+                           tap->write_index, memory_order_release );
+    tap->pending = 0;
+    if( tap->cb != NULL )
+        tap->cb( tap->opaque, tap->rate, tap->channels, tap->write_index );
+}
+
+static void audio_tap_write( libvlc_audio_tap_t *tap, const float *samples,
+                             unsigned frames, unsigned rate,
+                             unsigned channels )
+{
+    libvlc_audio_ring_t *ring = tap->ring;
+
+    if( rate != tap->rate || channels != tap->channels )
+    {
+        /* A batch never mixes formats */
+        audio_tap_publish( tap );
+        tap->rate = rate;
+        tap->channels = channels;
+    }
+
+    size_t count = (size_t)frames * channels;
+    uint64_t read_index =
+        atomic_load_explicit( (_Atomic uint64_t *)&ring->read_index,
+                              memory_order_acquire );
+
+    if( count > ring->capacity - (tap->write_index - read_index) )
+    {
+        atomic_fetch_add_explicit( &tap->overruns, frames,
+                                   memory_order_relaxed );
+        return;
+    }
+
+    size_t offset = tap->write_index & (ring->capacity - 1);
+    size_t first = __MIN(count, ring->capacity - offset);
+
+    memcpy( ring->buffer + offset, samples, first * sizeof (float) );
+    memcpy( ring->buffer, samples + first, (count - first) * sizeof (float) );
+    tap->write_index += count;
+    tap->pending += frames;
+
+    if( tap->pending >= tap->batch_frames )
+        audio_tap_publish( tap );
+}
+
+/* NOTE: the prototypes must match those of the atap audio filter */
+static void audio_tap_process( void *hub, const block_t *block,
+                               unsigned rate, unsigned channels )
+{
+    libvlc_media_player_t *mp = hub;
+    libvlc_audio_tap_t *tap;
+
+    vlc_mutex_lock( &mp->audio_taps.lock );
+    vlc_list_foreach( tap, &mp->audio_taps.list, node )
+    {
+        if( block != NULL )
+            audio_tap_write( tap, (const float *)block->p_buffer,
+                             block->i_nb_samples, rate, channels );
+        else /* drain */
+            audio_tap_publish( tap );
+    }
+    vlc_mutex_unlock( &mp->audio_taps.lock );
+}
+
+static void audio_tap_flush( void *hub )
+{
+    libvlc_media_player_t *mp = hub;
+    libvlc_audio_tap_t *tap;
+
+    vlc_mutex_lock( &mp->audio_taps.lock );
+    vlc_list_foreach( tap, &mp->audio_taps.list, node )
+    {
+        tap->write_index -= (uint64_t)tap->pending * tap->channels;
+        tap->pending = 0;
+    }
+    vlc_mutex_unlock( &mp->audio_taps.lock );
+}
+
+bool libvlc_audio_has_taps( libvlc_media_player_t *mp )
+{
+    vlc_mutex_lock( &mp->audio_taps.lock );
+    bool ret = !vlc_list_is_empty( &mp->audio_taps.list );
+    vlc_mutex_unlock( &mp->audio_taps.lock );
+    return ret;
+}
+
+static void audio_tap_enable( libvlc_media_player_t *mp, bool enable )
+{
+    char *filters = var_GetString( mp, "audio-filter" );
+    bool equalizer = filters != NULL && strstr( filters, "equalizer" ) != NULL;
+
+    free( filters );
+    if( enable )
+        var_SetString( mp, "audio-filter", equalizer ? "equalizer:atap"
+                                                     : "atap" );
+    else
+        var_SetString( mp, "audio-filter", equalizer ? "equalizer" : "" );
+
+    audio_output_t *aout = vlc_player_aout_Hold( mp->player );
+    if( aout != NULL )
+    {
+        aout_EnableFilter( aout, "atap", enable );
+        aout_Release( aout );
+    }
+}
+
+libvlc_audio_tap_t *libvlc_audio_tap_add( libvlc_media_player_t *mp,
+                                          libvlc_audio_ring_t *ring,
+                                          unsigned batch_frames,
+                                          libvlc_audio_tap_cb cb,
+                                          void *opaque )
+{
+    if( ring->buffer == NULL || ring->capacity == 0
+     || (ring->capacity & (ring->capacity - 1)) != 0 )
+    {
+        libvlc_printerr( "Invalid audio ring buffer" );
+        return NULL;
+    }
+
+    libvlc_audio_tap_t *tap = malloc( sizeof (*tap) );
+    if( unlikely(tap == NULL) )
+    {
+        libvlc_printerr( "Not enough memory" );
+        return NULL;
+    }
+
+    tap->mp = mp;
+    tap->ring = ring;
+    tap->batch_frames = batch_frames;
+    tap->cb = cb;
+    tap->opaque = opaque;
+    tap->write_index = ring->write_index;
+    tap->pending = 0;
+    tap->rate = 0;
+    tap->channels = 0;
+    atomic_init( &tap->overruns, 0 );
+
+    var_SetAddress( mp, "atap-hub", mp );
+    var_SetAddress( mp, "atap-process", audio_tap_process );
+    var_SetAddress( mp, "atap-flush", audio_tap_flush );
+
+    libvlc_media_player_retain( mp );
+    vlc_mutex_lock( &mp->audio_taps.lock );
+    bool first = vlc_list_is_empty( &mp->audio_taps.list );
+    vlc_list_append( &tap->node, &mp->audio_taps.list );
+    vlc_mutex_unlock( &mp->audio_taps.lock );
+
+    if( first )
+        audio_tap_enable( mp, true );
+    return tap;
+}
+
+void libvlc_audio_tap_remove( libvlc_audio_tap_t *tap )
+{
+    libvlc_media_player_t *mp = tap->mp;
+
+    vlc_mutex_lock( &mp->audio_taps.lock );
+    vlc_list_remove( &tap->node );
+    bool last = vlc_list_is_empty( &mp->audio_taps.list );
+    vlc_mutex_unlock( &mp->audio_taps.lock );
+
+    if( last )
+        audio_tap_enable( mp, false );
+    free( tap );
+    libvlc_media_player_release( mp );
+}
+
+uint64_t libvlc_audio_tap_get_overruns( const libvlc_audio_tap_t *tap )
+{
+    return atomic_load_explicit( &tap->overruns, memory_order_relaxed );
+}
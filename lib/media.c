@@ -803,6 +803,7 @@ bool libvlc_media_get_stats(libvlc_media_t *p_md,
     p_stats->i_displayed_pictures = p_itm_stats->i_displayed_pictures;
     p_stats->i_late_pictures = p_itm_stats->i_late_pictures;
     p_stats->i_lost_pictures = p_itm_stats->i_lost_pictures;
+    p_stats->i_missed_vsyncs = p_itm_stats->i_missed_vsyncs;
 
     p_stats->i_played_abuffers = p_itm_stats->i_played_abuffers;
     p_stats->i_lost_abuffers = p_itm_stats->i_lost_abuffers;
@@ -1113,6 +1114,24 @@ static void media_on_thumbnail_ready( void* data, picture_t* thumbnail )
         libvlc_picture_release( pic );
 }
 
+/* The thumbnailer threads are only started on the first request */
+static vlc_thumbnailer_t *media_get_thumbnailer( libvlc_media_t *md )
+{
+    libvlc_int_t *libvlc = md->p_libvlc_instance->p_libvlc_int;
+    libvlc_priv_t *priv = libvlc_priv( libvlc );
+
+    vlc_mutex_lock( &priv->lock );
+    if( priv->p_thumbnailer == NULL )
+    {
+        priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( libvlc ) );
+        if( priv->p_thumbnailer == NULL )
+            msg_Warn( libvlc, "Failed to instantiate thumbnailer" );
+    }
+    vlc_thumbnailer_t *thumbnailer = priv->p_thumbnailer;
+    vlc_mutex_unlock( &priv->lock );
+    return thumbnailer;
+}
+
 // Start an asynchronous thumbnail generation
 libvlc_media_thumbnail_request_t*
 libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
@@ -1122,8 +1141,8 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
                                         libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( p_priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer = media_get_thumbnailer( md );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1135,7 +1154,7 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
     req->type = picture_type;
     req->crop = crop;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByTime( p_priv->p_thumbnailer,
+    req->req = vlc_thumbnailer_RequestByTime( thumbnailer,
         VLC_TICK_FROM_MS( time ),
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
@@ -1160,8 +1179,8 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
                                        libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer = media_get_thumbnailer( md );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1173,7 +1192,7 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
     req->crop = crop;
     req->type = picture_type;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByPos( priv->p_thumbnailer, pos,
+    req->req = vlc_thumbnailer_RequestByPos( thumbnailer, pos,
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
         md->p_input_item,
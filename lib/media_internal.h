@@ -107,6 +107,9 @@ libvlc_media_trackpriv_from_es( libvlc_media_trackpriv_t *trackpriv,
 libvlc_media_track_t *
 libvlc_media_track_create_from_player_track( const struct vlc_player_track *track );
 
+libvlc_media_track_t *
+libvlc_media_track_create_from_es( const es_format_t *es );
+
 libvlc_media_tracklist_t *
 libvlc_media_tracklist_from_es_array( es_format_t **es_array,
                                       size_t es_count,
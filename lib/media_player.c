@@ -608,6 +608,18 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-pitch", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
+    var_Create (mp, "vframe-output", VLC_VAR_ADDRESS);
+    var_Create (mp, "vframe-cb", VLC_VAR_ADDRESS);
+    var_Create (mp, "vframe-data", VLC_VAR_ADDRESS);
+    var_Create (mp, "vdecode-step", VLC_VAR_INTEGER);
+    var_Create (mp, "vdecode-keyframes", VLC_VAR_BOOL);
+    var_Create (mp, "packets-add", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-del", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-send", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-es-added", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-es-removed", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-packet", VLC_VAR_ADDRESS);
+    var_Create (mp, "packets-data", VLC_VAR_ADDRESS);
 
     var_Create (mp, "vout-cb-type", VLC_VAR_INTEGER );
     var_Create( mp, "vout-cb-opaque", VLC_VAR_ADDRESS );
@@ -697,6 +709,9 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "amem-format", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
     var_Create (mp, "amem-rate", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "amem-channels", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
+    var_Create (mp, "atap-hub", VLC_VAR_ADDRESS);
+    var_Create (mp, "atap-process", VLC_VAR_ADDRESS);
+    var_Create (mp, "atap-flush", VLC_VAR_ADDRESS);
 
     /* Video Title */
     var_Create (mp, "video-title-show", VLC_VAR_BOOL);
@@ -731,6 +746,8 @@ libvlc_media_player_new( libvlc_instance_t *instance )
 
     vlc_atomic_rc_init(&mp->rc);
     libvlc_event_manager_init(&mp->event_manager, mp);
+    vlc_mutex_init(&mp->audio_taps.lock);
+    vlc_list_init(&mp->audio_taps.list);
 
     /* Snapshot initialization */
     /* Attach a var callback to the global object to provide the glue between
@@ -1964,6 +1981,13 @@ int libvlc_media_player_add_slave( libvlc_media_player_t *p_mi,
 int libvlc_media_player_set_equalizer( libvlc_media_player_t *p_mi, libvlc_equalizer_t *p_equalizer )
 {
     char bands[EQZ_BANDS_MAX * EQZ_BAND_VALUE_SIZE + 1];
+    const char *filters;
+
+    /* Keep the audio taps filter, if any */
+    if( libvlc_audio_has_taps( p_mi ) )
+        filters = p_equalizer ? "equalizer:atap" : "atap";
+    else
+        filters = p_equalizer ? "equalizer" : "";
 
     if( p_equalizer != NULL )
     {
@@ -1978,7 +2002,7 @@ int libvlc_media_player_set_equalizer( libvlc_media_player_t *p_mi, libvlc_equal
         var_SetFloat( p_mi, "equalizer-preamp", p_equalizer->f_preamp );
         var_SetString( p_mi, "equalizer-bands", bands );
     }
-    var_SetString( p_mi, "audio-filter", p_equalizer ? "equalizer" : "" );
+    var_SetString( p_mi, "audio-filter", filters );
 
     audio_output_t *p_aout = vlc_player_aout_Hold( p_mi->player );
     if( p_aout != NULL )
@@ -1989,7 +2013,7 @@ int libvlc_media_player_set_equalizer( libvlc_media_player_t *p_mi, libvlc_equal
             var_SetString( p_aout, "equalizer-bands", bands );
         }
 
-        var_SetString( p_aout, "audio-filter", p_equalizer ? "equalizer" : "" );
+        var_SetString( p_aout, "audio-filter", filters );
         aout_Release(p_aout);
     }
 
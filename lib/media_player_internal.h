@@ -33,6 +33,7 @@
 #include <vlc_input.h>
 #include <vlc_player.h>
 #include <vlc_viewpoint.h>
+#include <vlc_list.h>
 #include "media_internal.h"
 
 #include "../modules/audio_filter/equalizer_presets.h"
@@ -49,8 +50,15 @@ struct libvlc_media_player_t
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
     libvlc_media_t * p_md; /* current media descriptor */
     libvlc_event_manager_t event_manager;
+
+    struct {
+        vlc_mutex_t lock;
+        struct vlc_list list;
+    } audio_taps;
 };
 
+bool libvlc_audio_has_taps( libvlc_media_player_t *mp );
+
 libvlc_track_description_t * libvlc_get_track_description(
         libvlc_media_player_t *p_mi,
         enum es_format_category_e cat );
@@ -246,6 +246,16 @@ libvlc_media_track_create_from_player_track( const struct vlc_player_track *trac
     return &trackpriv->t;
 }
 
+libvlc_media_track_t *
+libvlc_media_track_create_from_es( const es_format_t *es )
+{
+    libvlc_media_trackpriv_t *trackpriv = libvlc_media_trackpriv_new();
+    if( trackpriv == NULL )
+        return NULL;
+    libvlc_media_trackpriv_from_es( trackpriv, es );
+    return &trackpriv->t;
+}
+
 libvlc_media_tracklist_t *
 libvlc_media_tracklist_from_player( vlc_player_t *player,
                                     libvlc_track_type_t type )
@@ -0,0 +1,592 @@
+/*****************************************************************************
+ * packet.c: libvlc elementary stream packets API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_media_player.h>
+#include <vlc/libvlc_packet.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_interrupt.h>
+
+#include "libvlc_internal.h"
+#include "media_internal.h"
+#include "media_player_internal.h"
+
+static_assert(libvlc_packet_discontinuity == BLOCK_FLAG_DISCONTINUITY
+           && libvlc_packet_keyframe == BLOCK_FLAG_TYPE_I
+           && libvlc_packet_corrupted == BLOCK_FLAG_CORRUPTED,
+              "Mismatched packet flags");
+
+#define PACKET_FLAGS_MASK \
+    (BLOCK_FLAG_DISCONTINUITY|BLOCK_FLAG_TYPE_I|BLOCK_FLAG_CORRUPTED)
+
+struct libvlc_packet_es_t
+{
+    vlc_atomic_rc_t rc;
+    es_format_t fmt;
+    void *tap_opaque;
+};
+
+struct libvlc_packet_t
+{
+    vlc_atomic_rc_t rc;
+    block_t *block;
+};
+
+static int64_t packet_time_to_us( vlc_tick_t ts )
+{
+    return ts != VLC_TICK_INVALID ? US_FROM_VLC_TICK(ts - VLC_TICK_0) : -1;
+}
+
+static vlc_tick_t packet_time_from_us( int64_t us )
+{
+    return us >= 0 ? VLC_TICK_0 + VLC_TICK_FROM_US(us) : VLC_TICK_INVALID;
+}
+
+/******************************************************************************
+ * Elementary streams
+ *****************************************************************************/
+
+static libvlc_packet_es_t *packet_es_create( const es_format_t *fmt )
+{
+    libvlc_packet_es_t *es = malloc( sizeof (*es) );
+    if( unlikely(es == NULL) )
+        return NULL;
+
+    if( es_format_Copy( &es->fmt, fmt ) != VLC_SUCCESS )
+    {
+        free( es );
+        return NULL;
+    }
+    vlc_atomic_rc_init( &es->rc );
+    es->tap_opaque = NULL;
+    return es;
+}
+
+libvlc_packet_es_t *libvlc_packet_es_new( libvlc_track_type_t type,
+                                          uint32_t codec, int id )
+{
+    es_format_t fmt;
+
+    es_format_Init( &fmt, libvlc_track_type_to_escat( type ), codec );
+    fmt.i_id = id;
+
+    libvlc_packet_es_t *es = packet_es_create( &fmt );
+    if( es == NULL )
+        libvlc_printerr( "Not enough memory" );
+    return es;
+}
+
+libvlc_packet_es_t *libvlc_packet_es_retain( libvlc_packet_es_t *es )
+{
+    vlc_atomic_rc_inc( &es->rc );
+    return es;
+}
+
+void libvlc_packet_es_release( libvlc_packet_es_t *es )
+{
+    if( !vlc_atomic_rc_dec( &es->rc ) )
+        return;
+
+    es_format_Clean( &es->fmt );
+    free( es );
+}
+
+libvlc_media_track_t *
+libvlc_packet_es_get_track( const libvlc_packet_es_t *es )
+{
+    return libvlc_media_track_create_from_es( &es->fmt );
+}
+
+const void *libvlc_packet_es_get_extra( const libvlc_packet_es_t *es,
+                                        size_t *size )
+{
+    *size = es->fmt.i_extra;
+    return es->fmt.i_extra > 0 ? es->fmt.p_extra : NULL;
+}
+
+int libvlc_packet_es_set_extra( libvlc_packet_es_t *es,
+                                const void *data, size_t size )
+{
+    void *extra = NULL;
+
+    if( size > 0 )
+    {
+        extra = malloc( size );
+        if( unlikely(extra == NULL) )
+        {
+            libvlc_printerr( "Not enough memory" );
+            return -1;
+        }
+        memcpy( extra, data, size );
+    }
+
+    free( es->fmt.p_extra );
+    es->fmt.p_extra = extra;
+    es->fmt.i_extra = size;
+    return 0;
+}
+
+void libvlc_packet_es_set_video( libvlc_packet_es_t *es,
+                                 unsigned width, unsigned height )
+{
+    es->fmt.video.i_width = es->fmt.video.i_visible_width = width;
+    es->fmt.video.i_height = es->fmt.video.i_visible_height = height;
+}
+
+void libvlc_packet_es_set_audio( libvlc_packet_es_t *es,
+                                 unsigned rate, unsigned channels )
+{
+    es->fmt.audio.i_rate = rate;
+    es->fmt.audio.i_channels = channels;
+}
+
+/******************************************************************************
+ * Packets
+ *****************************************************************************/
+
+static libvlc_packet_t *packet_create( block_t *block )
+{
+    libvlc_packet_t *pkt = malloc( sizeof (*pkt) );
+    if( unlikely(pkt == NULL) )
+        return NULL;
+
+    vlc_atomic_rc_init( &pkt->rc );
+    pkt->block = block;
+    return pkt;
+}
+
+struct packet_app_block
+{
+    block_t self;
+    libvlc_packet_free_cb free_cb;
+    void *opaque;
+};
+
+static void packet_app_block_free( block_t *block )
+{
+    struct packet_app_block *ab =
+        container_of( block, struct packet_app_block, self );
+
+    if( ab->free_cb != NULL )
+        ab->free_cb( ab->opaque );
+    free( ab );
+}
+
+static const struct vlc_block_callbacks packet_app_block_cbs =
+{
+    packet_app_block_free,
+};
+
+libvlc_packet_t *libvlc_packet_new( void *data, size_t size,
+                                    libvlc_packet_free_cb free_cb,
+                                    void *opaque )
+{
+    struct packet_app_block *ab = malloc( sizeof (*ab) );
+    if( unlikely(ab == NULL) )
+        goto error;
+
+    block_Init( &ab->self, &packet_app_block_cbs, data, size );
+    ab->free_cb = free_cb;
+    ab->opaque = opaque;
+
+    libvlc_packet_t *pkt = packet_create( &ab->self );
+    if( unlikely(pkt == NULL) )
+    {
+        free( ab );
+        goto error;
+    }
+    return pkt;
+
+error:
+    libvlc_printerr( "Not enough memory" );
+    return NULL;
+}
+
+libvlc_packet_t *libvlc_packet_retain( libvlc_packet_t *pkt )
+{
+    vlc_atomic_rc_inc( &pkt->rc );
+    return pkt;
+}
+
+void libvlc_packet_release( libvlc_packet_t *pkt )
+{
+    if( !vlc_atomic_rc_dec( &pkt->rc ) )
+        return;
+
+    block_Release( pkt->block );
+    free( pkt );
+}
+
+const void *libvlc_packet_get_data( const libvlc_packet_t *pkt, size_t *size )
+{
+    *size = pkt->block->i_buffer;
+    return pkt->block->p_buffer;
+}
+
+int64_t libvlc_packet_get_pts( const libvlc_packet_t *pkt )
+{
+    return packet_time_to_us( pkt->block->i_pts );
+}
+
+int64_t libvlc_packet_get_dts( const libvlc_packet_t *pkt )
+{
+    return packet_time_to_us( pkt->block->i_dts );
+}
+
+int64_t libvlc_packet_get_duration( const libvlc_packet_t *pkt )
+{
+    return US_FROM_VLC_TICK( pkt->block->i_length );
+}
+
+unsigned libvlc_packet_get_flags( const libvlc_packet_t *pkt )
+{
+    return pkt->block->i_flags & PACKET_FLAGS_MASK;
+}
+
+void libvlc_packet_set_timestamps( libvlc_packet_t *pkt, int64_t pts,
+                                   int64_t dts, int64_t duration )
+{
+    pkt->block->i_pts = packet_time_from_us( pts );
+    pkt->block->i_dts = packet_time_from_us( dts );
+    pkt->block->i_length = duration > 0 ? VLC_TICK_FROM_US( duration ) : 0;
+}
+
+void libvlc_packet_set_flags( libvlc_packet_t *pkt, unsigned flags )
+{
+    pkt->block->i_flags = (pkt->block->i_flags & ~PACKET_FLAGS_MASK)
+                        | (flags & PACKET_FLAGS_MASK);
+}
+
+/******************************************************************************
+ * Packet output
+ *****************************************************************************/
+
+/* NOTE: the prototypes must match the ones of the packets stream output */
+static void *packet_tap_add( libvlc_packet_es_added_cb cb, void *opaque,
+                             const es_format_t *fmt )
+{
+    libvlc_packet_es_t *es = packet_es_create( fmt );
+    if( unlikely(es == NULL) )
+        return NULL;
+
+    es->tap_opaque = cb( opaque, es );
+    return es;
+}
+
+static void packet_tap_del( libvlc_packet_es_removed_cb cb, void *opaque,
+                            void *id )
+{
+    libvlc_packet_es_t *es = id;
+
+    if( cb != NULL )
+        cb( opaque, es->tap_opaque );
+    libvlc_packet_es_release( es );
+}
+
+static void packet_tap_send( libvlc_packet_cb cb, void *opaque, void *id,
+                             block_t *chain )
+{
+    libvlc_packet_es_t *es = id;
+
+    while( chain != NULL )
+    {
+        block_t *block = chain;
+
+        chain = block->p_next;
+        block->p_next = NULL;
+
+        libvlc_packet_t *pkt = packet_create( block );
+        if( unlikely(pkt == NULL) )
+        {
+            block_Release( block );
+            continue;
+        }
+        cb( opaque, es->tap_opaque, pkt );
+        libvlc_packet_release( pkt );
+    }
+}
+
+void libvlc_media_player_set_packet_callbacks( libvlc_media_player_t *mp,
+                                               libvlc_packet_es_added_cb es_added,
+                                               libvlc_packet_es_removed_cb es_removed,
+                                               libvlc_packet_cb packet,
+                                               void *opaque )
+{
+    if( es_added == NULL )
+    {
+        var_SetString( mp, "sout", "" );
+        return;
+    }
+
+    assert( packet != NULL );
+    var_SetAddress( mp, "packets-add", packet_tap_add );
+    var_SetAddress( mp, "packets-del", packet_tap_del );
+    var_SetAddress( mp, "packets-send", packet_tap_send );
+    var_SetAddress( mp, "packets-es-added", es_added );
+    var_SetAddress( mp, "packets-es-removed", es_removed );
+    var_SetAddress( mp, "packets-packet", packet );
+    var_SetAddress( mp, "packets-data", opaque );
+    var_SetString( mp, "sout", "#packets" );
+}
+
+/******************************************************************************
+ * Packet sources
+ *****************************************************************************/
+
+/* NOTE: the values must match the ones of the packets access demux */
+enum packet_source_cmd
+{
+    PACKET_SOURCE_ES_ADD,
+    PACKET_SOURCE_ES_DEL,
+    PACKET_SOURCE_SEND,
+    PACKET_SOURCE_END,
+};
+
+struct packet_source_entry
+{
+    struct packet_source_entry *next;
+    enum packet_source_cmd cmd;
+    libvlc_packet_es_t *es;
+    libvlc_packet_t *pkt;
+};
+
+struct libvlc_packet_source_t
+{
+    vlc_mutex_t lock;
+    vlc_sem_t ready;
+    struct packet_source_entry *first;
+    struct packet_source_entry **lastp;
+    /* Last entry returned to the access demux, kept alive until the next */
+    struct packet_source_entry *current;
+    bool ended;
+};
+
+static void packet_source_entry_delete( struct packet_source_entry *entry )
+{
+    if( entry->pkt != NULL )
+        libvlc_packet_release( entry->pkt );
+    if( entry->es != NULL )
+        libvlc_packet_es_release( entry->es );
+    free( entry );
+}
+
+static int packet_source_queue( libvlc_packet_source_t *src,
+                                enum packet_source_cmd cmd,
+                                libvlc_packet_es_t *es, libvlc_packet_t *pkt )
+{
+    struct packet_source_entry *entry = malloc( sizeof (*entry) );
+    if( unlikely(entry == NULL) )
+    {
+        libvlc_printerr( "Not enough memory" );
+        return -1;
+    }
+
+    entry->next = NULL;
+    entry->cmd = cmd;
+    entry->es = es != NULL ? libvlc_packet_es_retain( es ) : NULL;
+    entry->pkt = pkt != NULL ? libvlc_packet_retain( pkt ) : NULL;
+
+    vlc_mutex_lock( &src->lock );
+    if( src->ended )
+    {
+        vlc_mutex_unlock( &src->lock );
+        packet_source_entry_delete( entry );
+        libvlc_printerr( "The packet source has ended" );
+        return -1;
+    }
+    if( cmd == PACKET_SOURCE_END )
+        src->ended = true;
+    *src->lastp = entry;
+    src->lastp = &entry->next;
+    vlc_mutex_unlock( &src->lock );
+
+    vlc_sem_post( &src->ready );
+    return 0;
+}
+
+struct packet_source_block
+{
+    block_t self;
+    libvlc_packet_t *pkt;
+};
+
+static void packet_source_block_free( block_t *block )
+{
+    struct packet_source_block *sb =
+        container_of( block, struct packet_source_block, self );
+
+    libvlc_packet_release( sb->pkt );
+    free( sb );
+}
+
+static const struct vlc_block_callbacks packet_source_block_cbs =
+{
+    packet_source_block_free,
+};
+
+/* Wraps the packet into a block that shares its payload, so that the
+ * application can keep its own reference to the packet. */
+static block_t *packet_source_block( libvlc_packet_t *pkt )
+{
+    struct packet_source_block *sb = malloc( sizeof (*sb) );
+    if( unlikely(sb == NULL) )
+        return NULL;
+
+    const block_t *orig = pkt->block;
+
+    block_Init( &sb->self, &packet_source_block_cbs,
+                orig->p_buffer, orig->i_buffer );
+    sb->self.i_flags = orig->i_flags;
+    sb->self.i_nb_samples = orig->i_nb_samples;
+    sb->self.i_pts = orig->i_pts;
+    sb->self.i_dts = orig->i_dts;
+    sb->self.i_length = orig->i_length;
+    sb->pkt = libvlc_packet_retain( pkt );
+    return &sb->self;
+}
+
+/* NOTE: the prototype must match the one of the packets access demux.
+ * Returns the next command, or -1 if interrupted. The format remains valid
+ * until the next call. */
+static int packet_source_pop( void *opaque, const es_format_t **fmt,
+                              void **key, block_t **block )
+{
+    libvlc_packet_source_t *src = opaque;
+
+    if( src->current != NULL )
+    {
+        packet_source_entry_delete( src->current );
+        src->current = NULL;
+    }
+
+    if( vlc_sem_wait_i11e( &src->ready ) )
+        return -1;
+
+    vlc_mutex_lock( &src->lock );
+    struct packet_source_entry *entry = src->first;
+    assert( entry != NULL );
+    src->first = entry->next;
+    if( src->first == NULL )
+        src->lastp = &src->first;
+    if( entry->cmd == PACKET_SOURCE_END )
+    {
+        /* Let any later call see the end again */
+        entry->next = NULL;
+        src->first = entry;
+        src->lastp = &entry->next;
+        vlc_mutex_unlock( &src->lock );
+        vlc_sem_post( &src->ready );
+        return PACKET_SOURCE_END;
+    }
+    vlc_mutex_unlock( &src->lock );
+
+    enum packet_source_cmd cmd = entry->cmd;
+
+    *fmt = &entry->es->fmt;
+    *key = entry->es;
+    /* The block is NULL if it could not be allocated */
+    *block = cmd == PACKET_SOURCE_SEND ? packet_source_block( entry->pkt )
+                                       : NULL;
+
+    src->current = entry;
+    return cmd;
+}
+
+libvlc_packet_source_t *libvlc_packet_source_new( void )
+{
+    libvlc_packet_source_t *src = malloc( sizeof (*src) );
+    if( unlikely(src == NULL) )
+    {
+        libvlc_printerr( "Not enough memory" );
+        return NULL;
+    }
+
+    vlc_mutex_init( &src->lock );
+    vlc_sem_init( &src->ready, 0 );
+    src->first = NULL;
+    src->lastp = &src->first;
+    src->current = NULL;
+    src->ended = false;
+    return src;
+}
+
+void libvlc_packet_source_release( libvlc_packet_source_t *src )
+{
+    struct packet_source_entry *entry = src->first;
+
+    while( entry != NULL )
+    {
+        struct packet_source_entry *next = entry->next;
+
+        packet_source_entry_delete( entry );
+        entry = next;
+    }
+    if( src->current != NULL )
+        packet_source_entry_delete( src->current );
+    free( src );
+}
+
+int libvlc_packet_source_add_es( libvlc_packet_source_t *src,
+                                 libvlc_packet_es_t *es )
+{
+    return packet_source_queue( src, PACKET_SOURCE_ES_ADD, es, NULL );
+}
+
+void libvlc_packet_source_remove_es( libvlc_packet_source_t *src,
+                                     libvlc_packet_es_t *es )
+{
+    packet_source_queue( src, PACKET_SOURCE_ES_DEL, es, NULL );
+}
+
+int libvlc_packet_source_push( libvlc_packet_source_t *src,
+                               libvlc_packet_es_t *es, libvlc_packet_t *pkt )
+{
+    return packet_source_queue( src, PACKET_SOURCE_SEND, es, pkt );
+}
+
+void libvlc_packet_source_end( libvlc_packet_source_t *src )
+{
+    packet_source_queue( src, PACKET_SOURCE_END, NULL, NULL );
+}
+
+libvlc_media_t *libvlc_media_new_packet_source( libvlc_instance_t *instance,
+                                                libvlc_packet_source_t *src )
+{
+    libvlc_media_t *m = libvlc_media_new_location( instance, "packets://" );
+    if( unlikely(m == NULL) )
+        return NULL;
+
+    input_item_AddOpaque( m->p_input_item, "packets-source", src );
+    input_item_AddOpaque( m->p_input_item, "packets-pop", packet_source_pop );
+    return m;
+}
@@ -35,7 +35,9 @@
 #include <vlc/libvlc_media_player.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_modules.h>
+#include <vlc_picture.h>
 #include <vlc_vout.h>
 #include <vlc_url.h>
 
@@ -550,6 +552,7 @@ void libvlc_video_set_deinterlace( libvlc_media_player_t *p_mi, int deinterlace,
      && strcmp (psz_mode, "discard")  && strcmp (psz_mode, "linear")
      && strcmp (psz_mode, "mean")     && strcmp (psz_mode, "x")
      && strcmp (psz_mode, "yadif")    && strcmp (psz_mode, "yadif2x")
+     && strcmp (psz_mode, "bwdif")    && strcmp (psz_mode, "bwdif2x")
      && strcmp (psz_mode, "phosphor") && strcmp (psz_mode, "ivtc")
      && strcmp (psz_mode, "auto"))
         return;
@@ -932,3 +935,117 @@ float libvlc_video_get_adjust_float( libvlc_media_player_t *p_mi,
 {
     return get_float( p_mi, "adjust", adjust_option_bynumber(option) );
 }
+
+/******************************************************************************
+ * Decoded frames
+ *****************************************************************************/
+
+struct libvlc_video_frame_t
+{
+    vlc_atomic_rc_t rc;
+    picture_t *pic;
+    libvlc_video_frame_type_t type;
+    vlc_fourcc_t chroma;
+    unsigned plane_count;
+    libvlc_video_frame_plane_t planes[PICTURE_PLANE_MAX];
+    void *handle;
+    uintptr_t index;
+};
+
+/* NOTE: the prototype must match the one of the vframe video output */
+static void video_frame_output( libvlc_video_frame_cb cb, void *opaque,
+                                picture_t *pic, int type, vlc_fourcc_t chroma,
+                                const libvlc_video_frame_plane_t *planes,
+                                unsigned plane_count,
+                                void *handle, uintptr_t index )
+{
+    libvlc_video_frame_t *frame = malloc( sizeof (*frame) );
+    if( unlikely(frame == NULL) )
+        return;
+
+    assert( plane_count <= PICTURE_PLANE_MAX );
+    vlc_atomic_rc_init( &frame->rc );
+    frame->pic = picture_Hold( pic );
+    frame->type = type;
+    frame->chroma = chroma;
+    frame->plane_count = plane_count;
+    memcpy( frame->planes, planes, plane_count * sizeof (*planes) );
+    frame->handle = handle;
+    frame->index = index;
+
+    cb( opaque, frame );
+    libvlc_video_frame_release( frame );
+}
+
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb cb,
+                                      void *opaque )
+{
+    var_SetAddress( mp, "vframe-output", video_frame_output );
+    var_SetAddress( mp, "vframe-cb", cb );
+    var_SetAddress( mp, "vframe-data", opaque );
+    var_SetString( mp, "vout", "vframe" );
+    var_SetString( mp, "window", "dummy" );
+}
+
+void libvlc_video_set_decode_callback( libvlc_media_player_t *mp,
+                                       libvlc_video_frame_cb cb,
+                                       void *opaque, unsigned frame_step,
+                                       bool keyframes_only )
+{
+    var_SetAddress( mp, "vframe-output", video_frame_output );
+    var_SetAddress( mp, "vframe-cb", cb );
+    var_SetAddress( mp, "vframe-data", opaque );
+    var_SetInteger( mp, "vdecode-step", frame_step );
+    var_SetBool( mp, "vdecode-keyframes", keyframes_only );
+    var_SetString( mp, "sout", "#vdecode" );
+}
+
+libvlc_video_frame_t *libvlc_video_frame_retain( libvlc_video_frame_t *frame )
+{
+    vlc_atomic_rc_inc( &frame->rc );
+    return frame;
+}
+
+void libvlc_video_frame_release( libvlc_video_frame_t *frame )
+{
+    if( !vlc_atomic_rc_dec( &frame->rc ) )
+        return;
+
+    picture_Release( frame->pic );
+    free( frame );
+}
+
+libvlc_video_frame_type_t
+libvlc_video_frame_get_type( const libvlc_video_frame_t *frame )
+{
+    return frame->type;
+}
+
+void libvlc_video_frame_get_format( const libvlc_video_frame_t *frame,
+                                    char chroma[4],
+                                    unsigned *width, unsigned *height )
+{
+    memcpy( chroma, &frame->chroma, 4 );
+    *width = frame->pic->format.i_visible_width;
+    *height = frame->pic->format.i_visible_height;
+}
+
+int64_t libvlc_video_frame_get_pts( const libvlc_video_frame_t *frame )
+{
+    return US_FROM_VLC_TICK( frame->pic->date );
+}
+
+unsigned libvlc_video_frame_get_planes( const libvlc_video_frame_t *frame,
+                                        libvlc_video_frame_plane_t *planes )
+{
+    memcpy( planes, frame->planes, frame->plane_count * sizeof (*planes) );
+    return frame->plane_count;
+}
+
+void *libvlc_video_frame_get_handle( const libvlc_video_frame_t *frame,
+                                     uintptr_t *index )
+{
+    *index = frame->index;
+    return frame->handle;
+}
@@ -53,6 +53,7 @@
 
 #include "../demux/mpeg/timestamps.h"
 #include "../demux/timestamps_filter.h"
+#include "disc_readahead.h"
 
 #include <libbluray/bluray.h>
 #include <libbluray/bluray-version.h>
@@ -355,6 +356,7 @@ typedef struct
 
     /* stream input */
     vlc_mutex_t         read_block_lock;
+    disc_readahead_t    *p_readahead;       /* NULL if reading directly */
 
     /* Used to store bluray disc path */
     char                *psz_bd_path;
@@ -710,7 +712,18 @@ static int blurayReadBlock(void *object, void *buf, int lba, int num_blocks)
 
     vlc_mutex_lock(&p_sys->read_block_lock);
 
-    if (vlc_stream_Seek( p_demux->s, lba * INT64_C(2048) ) == VLC_SUCCESS) {
+    if (p_sys->p_readahead) {
+        ssize_t got;
+
+        disc_readahead_Seek(p_sys->p_readahead, lba * INT64_C(2048));
+        got = disc_readahead_Read(p_sys->p_readahead, buf,
+                                  (size_t)2048 * num_blocks);
+        if (got < 0) {
+            msg_Err(p_demux, "read from lba %d failed", lba);
+        } else {
+            result = got / 2048;
+        }
+    } else if (vlc_stream_Seek( p_demux->s, lba * INT64_C(2048) ) == VLC_SUCCESS) {
         size_t  req = (size_t)2048 * num_blocks;
         ssize_t got;
 
@@ -884,6 +897,14 @@ static int blurayOpen(vlc_object_t *object)
     if (p_demux->s) {
         i_init_pos = vlc_stream_Tell(p_demux->s);
 
+        /* Slow sources (network shares, ...) would stall playback on each
+         * synchronous read or clip change: read the image ahead. */
+        bool b_fastseek = false;
+        vlc_stream_Control(p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek);
+        if (!b_fastseek)
+            p_sys->p_readahead = disc_readahead_New(object, p_demux->s,
+                                                    DISC_READAHEAD_SIZE);
+
         p_sys->bluray = bd_init();
         if (!bd_open_stream(p_sys->bluray, p_demux, blurayReadBlock)) {
             bd_close(p_sys->bluray);
@@ -1096,6 +1117,9 @@ static void blurayClose(vlc_object_t *object)
         bd_close(p_sys->bluray);
     }
 
+    if (p_sys->p_readahead)
+        disc_readahead_Delete(p_sys->p_readahead);
+
     vlc_mutex_lock(&p_sys->bdj.lock);
     for(int i = 0; i < MAX_OVERLAY; i++)
         blurayCloseOverlay(p_demux, i);
@@ -50,6 +50,7 @@
 #include "sdi.h"
 
 #include <atomic>
+#include <new>
 
 static int  Open (vlc_object_t *);
 static void Close(vlc_object_t *);
@@ -318,6 +319,38 @@ private:
     demux_t *demux_;
 };
 
+/* Block referencing the memory of a captured frame, to avoid copying it */
+struct decklink_frame_block
+{
+    block_t self;
+    IDeckLinkVideoInputFrame *frame;
+};
+
+static void decklink_frame_block_Release(block_t *block)
+{
+    decklink_frame_block *fb = container_of(block, decklink_frame_block, self);
+
+    fb->frame->Release();
+    delete fb;
+}
+
+static const struct vlc_block_callbacks decklink_frame_block_cbs =
+{
+    decklink_frame_block_Release,
+};
+
+static block_t *decklink_frame_block_New(IDeckLinkVideoInputFrame *frame,
+                                         void *bytes, size_t length)
+{
+    decklink_frame_block *fb = new (std::nothrow) decklink_frame_block;
+    if (unlikely(fb == NULL))
+        return NULL;
+
+    frame->AddRef();
+    fb->frame = frame;
+    return block_Init(&fb->self, &decklink_frame_block_cbs, bytes, length);
+}
+
 } // namespace
 
 HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
@@ -345,13 +378,24 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 bpp = 2;
                 break;
         };
-        block_t *video_frame = block_Alloc(width * height * bpp);
-        if (!video_frame)
-            return S_OK;
 
         const uint32_t *frame_bytes;
         videoFrame->GetBytes((void**)&frame_bytes);
 
+        /* Packed formats without padding are passed in place; the frame
+         * goes back to the driver once the block is released. */
+        const bool in_place = sys->video_fmt.i_codec != VLC_CODEC_I422_10L
+                           && stride == width * bpp;
+        block_t *video_frame;
+        if (in_place)
+            video_frame = decklink_frame_block_New(videoFrame,
+                                                   (void *)frame_bytes,
+                                                   width * height * bpp);
+        else
+            video_frame = block_Alloc(width * height * bpp);
+        if (!video_frame)
+            return S_OK;
+
         BMDTimeValue stream_time, frame_duration;
         videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
         video_frame->i_flags = BLOCK_FLAG_TYPE_I | sys->dominance_flags;
@@ -390,6 +434,8 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 }
                 vanc->Release();
             }
+        } else if (in_place) {
+            /* nothing to copy */
         } else if (sys->video_fmt.i_codec == VLC_CODEC_UYVY) {
             for (int y = 0; y < height; ++y) {
                 const uint8_t *src = (const uint8_t *)frame_bytes + stride * y;
@@ -0,0 +1,263 @@
+/*****************************************************************************
+ * disc_readahead.c: asynchronous read-ahead for disc images
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_interrupt.h>
+
+#include "disc_readahead.h"
+
+/* Size of each read from the source */
+#define READ_CHUNK (256 << 10)
+/* Forward jumps shorter than this are read through rather than seeked */
+#define SEEK_THRESHOLD (1 << 20)
+
+struct disc_readahead
+{
+    vlc_object_t *obj;
+    stream_t *source;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data;
+    vlc_cond_t wait_space;
+    vlc_thread_t thread;
+    vlc_interrupt_t *interrupt;
+
+    uint8_t *buffer;
+    size_t buffer_size;
+    uint64_t buffer_offset; /**< source offset of the oldest buffered byte */
+    size_t buffer_length;
+
+    uint64_t offset; /**< read position */
+    bool restart; /**< the source must be seeked to the read position */
+    bool eof;
+    bool error;
+};
+
+static void *Thread(void *data)
+{
+    disc_readahead_t *ra = data;
+
+    vlc_interrupt_set(ra->interrupt);
+
+    vlc_mutex_lock(&ra->lock);
+    while (!vlc_killed())
+    {
+        if (ra->restart)
+        {
+            uint64_t offset = ra->offset;
+
+            ra->restart = false;
+            vlc_mutex_unlock(&ra->lock);
+            int val = vlc_stream_Seek(ra->source, offset);
+            vlc_mutex_lock(&ra->lock);
+
+            if (ra->restart)
+                continue; /* superseded by another seek */
+
+            ra->buffer_offset = offset;
+            ra->buffer_length = 0;
+            ra->eof = false;
+            ra->error = val != VLC_SUCCESS;
+            if (ra->error)
+                msg_Err(ra->obj, "seek to offset %"PRIu64" failed", offset);
+            vlc_cond_signal(&ra->wait_data);
+            continue;
+        }
+
+        if (ra->eof || ra->error)
+        {
+            vlc_cond_wait(&ra->wait_space, &ra->lock);
+            continue;
+        }
+
+        if (ra->buffer_length == ra->buffer_size)
+        {   /* Full: discard already read data to make room, if any */
+            uint64_t history = ra->offset - ra->buffer_offset;
+            size_t len = __MIN(history, READ_CHUNK);
+
+            if (len > ra->buffer_length)
+                len = ra->buffer_length;
+
+            if (len == 0)
+            {
+                vlc_cond_wait(&ra->wait_space, &ra->lock);
+                continue;
+            }
+            ra->buffer_offset += len;
+            ra->buffer_length -= len;
+        }
+
+        uint64_t end = ra->buffer_offset + ra->buffer_length;
+        size_t pos = end % ra->buffer_size;
+        size_t len = __MIN(ra->buffer_size - ra->buffer_length, READ_CHUNK);
+        /* Do not step past the sharp edge of the circular buffer */
+        if (pos + len > ra->buffer_size)
+            len = ra->buffer_size - pos;
+
+        /* The reader never touches unbuffered space, so no locking is needed
+         * while filling it. */
+        vlc_mutex_unlock(&ra->lock);
+        ssize_t val = vlc_stream_Read(ra->source, ra->buffer + pos, len);
+        vlc_mutex_lock(&ra->lock);
+
+        if (ra->restart)
+            continue;
+        if (val < 0)
+            ra->error = true;
+        else if (val == 0)
+            ra->eof = true;
+        else
+            ra->buffer_length += val;
+        vlc_cond_signal(&ra->wait_data);
+    }
+
+    ra->error = true;
+    vlc_cond_signal(&ra->wait_data);
+    vlc_mutex_unlock(&ra->lock);
+    return NULL;
+}
+
+void disc_readahead_Seek(disc_readahead_t *ra, uint64_t offset)
+{
+    vlc_mutex_lock(&ra->lock);
+    ra->offset = offset;
+    if (offset < ra->buffer_offset
+     || offset > ra->buffer_offset + ra->buffer_length + SEEK_THRESHOLD)
+    {
+        ra->restart = true;
+        vlc_cond_signal(&ra->wait_space);
+    }
+    vlc_mutex_unlock(&ra->lock);
+}
+
+ssize_t disc_readahead_Read(disc_readahead_t *ra, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    size_t copied = 0;
+
+    vlc_mutex_lock(&ra->lock);
+    while (copied < len)
+    {
+        uint64_t end = ra->buffer_offset + ra->buffer_length;
+
+        if (ra->restart)
+        {
+            vlc_cond_wait(&ra->wait_data, &ra->lock);
+            continue;
+        }
+
+        if (ra->offset < ra->buffer_offset
+         || ra->offset > end + SEEK_THRESHOLD)
+        {   /* Dropped or too far: read again from there */
+            ra->restart = true;
+            vlc_cond_signal(&ra->wait_space);
+            continue;
+        }
+
+        if (ra->offset >= end)
+        {
+            if (ra->eof || ra->error)
+                break;
+            vlc_cond_wait(&ra->wait_data, &ra->lock);
+            continue;
+        }
+
+        size_t pos = ra->offset % ra->buffer_size;
+        size_t size = __MIN(len - copied, end - ra->offset);
+        if (pos + size > ra->buffer_size)
+            size = ra->buffer_size - pos;
+
+        memcpy(p + copied, ra->buffer + pos, size);
+        copied += size;
+        ra->offset += size;
+        vlc_cond_signal(&ra->wait_space);
+    }
+
+    bool error = ra->error;
+    vlc_mutex_unlock(&ra->lock);
+
+    if (copied == 0 && len > 0 && error)
+        return -1;
+    return copied;
+}
+
+disc_readahead_t *disc_readahead_New(vlc_object_t *obj, stream_t *source,
+                                     size_t size)
+{
+    disc_readahead_t *ra = malloc(sizeof (*ra));
+    if (unlikely(ra == NULL))
+        return NULL;
+
+    ra->buffer = malloc(size);
+    ra->interrupt = vlc_interrupt_create();
+    if (unlikely(ra->buffer == NULL || ra->interrupt == NULL))
+        goto error;
+
+    ra->obj = obj;
+    ra->source = source;
+    ra->buffer_size = size;
+    ra->buffer_offset = ra->offset = vlc_stream_Tell(source);
+    ra->buffer_length = 0;
+    ra->restart = false;
+    ra->eof = false;
+    ra->error = false;
+
+    vlc_mutex_init(&ra->lock);
+    vlc_cond_init(&ra->wait_data);
+    vlc_cond_init(&ra->wait_space);
+
+    if (vlc_clone(&ra->thread, Thread, ra, VLC_THREAD_PRIORITY_INPUT))
+        goto error;
+
+    msg_Dbg(obj, "reading ahead with %zu bytes buffer", size);
+    return ra;
+
+error:
+    if (ra->interrupt != NULL)
+        vlc_interrupt_destroy(ra->interrupt);
+    free(ra->buffer);
+    free(ra);
+    return NULL;
+}
+
+void disc_readahead_Delete(disc_readahead_t *ra)
+{
+    vlc_mutex_lock(&ra->lock);
+    vlc_interrupt_kill(ra->interrupt);
+    vlc_cond_signal(&ra->wait_space);
+    vlc_mutex_unlock(&ra->lock);
+
+    vlc_join(ra->thread, NULL);
+    vlc_interrupt_destroy(ra->interrupt);
+
+    /* Leave the source where the reader expects it */
+    vlc_stream_Seek(ra->source, ra->offset);
+    free(ra->buffer);
+    free(ra);
+}
@@ -0,0 +1,57 @@
+/*****************************************************************************
+ * disc_readahead.h: asynchronous read-ahead for disc images
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DISC_READAHEAD_H
+#define VLC_DISC_READAHEAD_H
+
+/**
+ * Read-ahead of a disc image from a slow source stream.
+ *
+ * Disc navigation libraries read the image synchronously, in small units,
+ * from the demux thread. This reads the image ahead in a background thread
+ * into a ring buffer, keeping already read data for short backward jumps.
+ * The source stream must not be used directly while the read-ahead exists.
+ */
+typedef struct disc_readahead disc_readahead_t;
+
+#define DISC_READAHEAD_SIZE (8 << 20)
+
+/**
+ * Starts reading ahead from the current position of the source.
+ *
+ * \param size ring buffer size in bytes
+ * \return the read-ahead, or NULL on error
+ */
+disc_readahead_t *disc_readahead_New(vlc_object_t *obj, stream_t *source,
+                                     size_t size);
+void disc_readahead_Delete(disc_readahead_t *);
+
+/** Sets the read position; errors are reported by the next read. */
+void disc_readahead_Seek(disc_readahead_t *, uint64_t offset);
+
+/**
+ * Reads from the current position, waiting for the data if needed.
+ *
+ * \return the number of bytes read, 0 at the end of the stream, or -1 on
+ * error
+ */
+ssize_t disc_readahead_Read(disc_readahead_t *, void *buf, size_t len);
+
+#endif
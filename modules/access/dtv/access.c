@@ -456,7 +456,8 @@ static int Open (vlc_object_t *obj)
     sys->pf_setup = NULL;
     access->p_sys = sys;
 
-    uint64_t freq = var_InheritFrequency (obj);
+    /* Another input already tuned the shared tuner to this transponder */
+    uint64_t freq = dvb_is_shared (dev) ? 0 : var_InheritFrequency (obj);
     if (freq != 0)
     {
         dtv_delivery_t d = GuessSystem (access->psz_name, dev);
@@ -496,25 +497,9 @@ static void Close (vlc_object_t *obj)
 
 static block_t *Read (stream_t *access, bool *restrict eof)
 {
-#define BUFSIZE (20*188)
-    block_t *block = block_Alloc (BUFSIZE);
-    if (unlikely(block == NULL))
-        return NULL;
-
     access_sys_t *sys = access->p_sys;
-    ssize_t val = dvb_read (sys->dev, block->p_buffer, BUFSIZE, -1);
-
-    if (val <= 0)
-    {
-        if (val == 0)
-            *eof = true;
-        block_Release (block);
-        return NULL;
-    }
-
-    block->i_buffer = val;
 
-    return block;
+    return dvb_read_block (sys->dev, eof);
 }
 
 static int Control (stream_t *access, int query, va_list args)
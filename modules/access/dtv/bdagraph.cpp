@@ -154,9 +154,29 @@ void dvb_close (dvb_device_t *d)
     delete d;
 }
 
-ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
+bool dvb_is_shared (const dvb_device_t *)
 {
-    return d->module->Pop(buf, len, ms);
+    return false;
+}
+
+block_t *dvb_read_block (dvb_device_t *d, bool *eof)
+{
+#define BUFSIZE (20*188)
+    block_t *block = block_Alloc (BUFSIZE);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    ssize_t val = d->module->Pop(block->p_buffer, BUFSIZE, -1);
+    if (val <= 0)
+    {
+        if (val == 0)
+            *eof = true;
+        block_Release (block);
+        return NULL;
+    }
+
+    block->i_buffer = val;
+    return block;
 }
 
 int dvb_add_pid (dvb_device_t *, uint16_t)
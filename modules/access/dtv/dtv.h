@@ -62,7 +62,8 @@ tuner_setup_t dtv_get_delivery_tuner_setup( dtv_delivery_t );
 
 dvb_device_t *dvb_open (vlc_object_t *obj);
 void dvb_close (dvb_device_t *);
-ssize_t dvb_read (dvb_device_t *, void *, size_t, int);
+bool dvb_is_shared (const dvb_device_t *);
+block_t *dvb_read_block (dvb_device_t *, bool *eof);
 
 int dvb_add_pid (dvb_device_t *, uint16_t);
 void dvb_remove_pid (dvb_device_t *, uint16_t);
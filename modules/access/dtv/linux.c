@@ -25,10 +25,15 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_block.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
+#include <vlc_queue.h>
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <assert.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -141,9 +146,25 @@ static int dvb_parse_fec (uint32_t fec)
 }
 
 
-struct dvb_device
+/* Size of each read from the DVR, shared by all inputs of a tuner */
+#define DVB_CHUNK_SIZE (20*188)
+/* Chunks queued per input before dropping data (about 4 MiB) */
+#define DVB_MAX_PENDING 1024
+
+/**
+ * A tuner, with its frontend and demultiplexer, shared by all the inputs
+ * using the same adapter on the same transponder.
+ */
+struct dvb_tuner
 {
-    vlc_object_t *obj;
+    struct vlc_list node;
+    unsigned refs; /**< protected by dvb_tuners_lock */
+    vlc_object_t *obj; /**< outlives the inputs sharing the tuner */
+    uint8_t adapter;
+    uint8_t device;
+    int64_t frequency;
+    char *polarization;
+
     int dir;
     int demux;
     int frontend;
@@ -156,11 +177,49 @@ struct dvb_device
     } pids[MAX_PIDS];
 #endif
     cam_t *cam;
-    uint8_t device;
     bool budget;
     //size_t buffer_size;
+
+    vlc_mutex_t lock; /**< protects the users, PID filters and CAM */
+    struct vlc_list users;
+    uint16_t pid_refs[0x2000];
+    bool eof;
+
+    vlc_thread_t thread;
+    vlc_interrupt_t *interrupt;
+};
+
+/** An input reading from a tuner */
+struct dvb_device
+{
+    vlc_object_t *obj;
+    struct dvb_tuner *tuner;
+    struct vlc_list node;
+    bool shared;
+
+    vlc_queue_t queue;
+    vlc_sem_t ready;
+    atomic_uint pending;
+    bool overflow;
+    uint8_t pids[0x2000 / 8];
+};
+
+/** Data read from the DVR, referenced by the blocks of each input */
+struct dvb_chunk
+{
+    vlc_atomic_rc_t rc;
+    uint8_t data[DVB_CHUNK_SIZE];
 };
 
+struct dvb_block
+{
+    block_t self;
+    struct dvb_chunk *chunk;
+};
+
+static vlc_mutex_t dvb_tuners_lock = VLC_STATIC_MUTEX;
+static struct vlc_list dvb_tuners = VLC_LIST_INITIALIZER(&dvb_tuners);
+
 /** Opens the device directory for the specified DVB adapter */
 static int dvb_open_adapter (uint8_t adapter)
 {
@@ -171,55 +230,270 @@ static int dvb_open_adapter (uint8_t adapter)
 }
 
 /** Opens the DVB device node of the specified type */
-static int dvb_open_node (dvb_device_t *d, const char *type, int flags)
+static int dvb_open_node (struct dvb_tuner *t, const char *type, int flags)
 {
     char path[strlen (type) + 4];
 
-    snprintf (path, sizeof (path), "%s%u", type, d->device);
-    return vlc_openat (d->dir, path, flags | O_NONBLOCK);
+    snprintf (path, sizeof (path), "%s%u", type, t->device);
+    return vlc_openat (t->dir, path, flags | O_NONBLOCK);
+}
+
+static void dvb_chunk_Release (struct dvb_chunk *chunk)
+{
+    if (vlc_atomic_rc_dec (&chunk->rc))
+        free (chunk);
+}
+
+static void dvb_block_Release (block_t *block)
+{
+    struct dvb_block *b = container_of (block, struct dvb_block, self);
+
+    dvb_chunk_Release (b->chunk);
+    free (b);
+}
+
+static const struct vlc_block_callbacks dvb_block_cbs =
+{
+    dvb_block_Release,
+};
+
+static void dvb_frontend_status(vlc_object_t *obj, fe_status_t s)
+{
+    msg_Dbg(obj, "frontend status:");
+#define S(f) \
+    if (s & FE_ ## f) \
+        msg_Dbg(obj, "\t%s", #f);
+
+    S(HAS_SIGNAL);
+    S(HAS_CARRIER);
+    S(HAS_VITERBI);
+    S(HAS_SYNC);
+    S(HAS_LOCK);
+    S(TIMEDOUT);
+    S(REINIT);
+#undef S
 }
 
 /**
- * Opens the DVB tuner
+ * Reads TS data from the tuner.
+ * @return number of bytes read, 0 on EOF, -1 if no data (yet).
  */
-dvb_device_t *dvb_open (vlc_object_t *obj)
+static ssize_t dvb_read_tuner (struct dvb_tuner *t, void *buf, size_t len,
+                               int ms)
 {
-    dvb_device_t *d = malloc (sizeof (*d));
-    if (unlikely(d == NULL))
-        return NULL;
+    struct pollfd ufd[2];
+    int n;
 
-    d->obj = obj;
+    /* The frontend is opened while tuning, from the input thread */
+    vlc_mutex_lock (&t->lock);
+    if (t->cam != NULL)
+        en50221_Poll (t->cam);
+    int frontend = t->frontend;
+    vlc_mutex_unlock (&t->lock);
 
-    uint8_t adapter = var_InheritInteger (obj, "dvb-adapter");
-    d->device = var_InheritInteger (obj, "dvb-device");
+    ufd[0].fd = t->demux;
+    ufd[0].events = POLLIN;
+    if (frontend != -1)
+    {
+        ufd[1].fd = frontend;
+        ufd[1].events = POLLPRI;
+        n = 2;
+    }
+    else
+        n = 1;
+
+    errno = 0;
+    n = vlc_poll_i11e (ufd, n, ms);
+    if (n == 0)
+        errno = EAGAIN;
+    if (n <= 0)
+        return -1;
+
+    if (frontend != -1 && ufd[1].revents)
+    {
+        struct dvb_frontend_event ev;
+
+        if (ioctl (frontend, FE_GET_EVENT, &ev) < 0)
+        {
+            if (errno == EOVERFLOW)
+            {
+                msg_Err (t->obj, "cannot dequeue events fast enough!");
+                return -1;
+            }
+            msg_Err (t->obj, "cannot dequeue frontend event: %s",
+                     vlc_strerror_c(errno));
+            return 0;
+        }
+
+        dvb_frontend_status(t->obj, ev.status);
+    }
+
+    if (ufd[0].revents)
+    {
+        ssize_t val = read (t->demux, buf, len);
+        if (val == -1 && (errno != EAGAIN && errno != EINTR))
+        {
+            if (errno == EOVERFLOW)
+            {
+                msg_Err (t->obj, "cannot demux data fast enough!");
+                return -1;
+            }
+            msg_Err (t->obj, "cannot demux: %s", vlc_strerror_c(errno));
+            return 0;
+        }
+        return val;
+    }
+
+    return -1;
+}
+
+/** Queues a reference to the data for one input */
+static void dvb_push (dvb_device_t *d, struct dvb_chunk *chunk, size_t len)
+{
+    if (atomic_load_explicit (&d->pending, memory_order_relaxed)
+            >= DVB_MAX_PENDING)
+    {   /* The input does not keep up (or is paused): drop the data */
+        if (!d->overflow)
+            msg_Warn (d->obj, "input too slow, dropping data");
+        d->overflow = true;
+        return;
+    }
+    d->overflow = false;
+
+    struct dvb_block *b = malloc (sizeof (*b));
+    if (unlikely(b == NULL))
+        return;
+
+    vlc_atomic_rc_inc (&chunk->rc);
+    b->chunk = chunk;
+    block_Init (&b->self, &dvb_block_cbs, chunk->data, len);
+
+    atomic_fetch_add_explicit (&d->pending, 1, memory_order_relaxed);
+    vlc_queue_Enqueue (&d->queue, &b->self);
+    vlc_sem_post (&d->ready);
+}
+
+/** Reads the DVR and hands the data to all the inputs, without copying */
+static void *dvb_thread (void *data)
+{
+    struct dvb_tuner *t = data;
+    struct dvb_chunk *chunk = NULL;
+
+    vlc_interrupt_set (t->interrupt);
+
+    while (!vlc_killed ())
+    {
+        if (chunk == NULL)
+        {
+            chunk = malloc (sizeof (*chunk));
+            if (unlikely(chunk == NULL))
+                break;
+            vlc_atomic_rc_init (&chunk->rc);
+        }
+
+        ssize_t val = dvb_read_tuner (t, chunk->data, sizeof (chunk->data),
+                                      -1);
+        if (val < 0)
+            continue;
+        if (val == 0)
+            break;
+
+        vlc_mutex_lock (&t->lock);
+        dvb_device_t *d;
+        vlc_list_foreach (d, &t->users, node)
+            dvb_push (d, chunk, val);
+        vlc_mutex_unlock (&t->lock);
+
+        dvb_chunk_Release (chunk);
+        chunk = NULL;
+    }
+
+    free (chunk);
 
-    d->dir = dvb_open_adapter (adapter);
-    if (d->dir == -1)
+    vlc_mutex_lock (&t->lock);
+    t->eof = true;
+    dvb_device_t *d;
+    vlc_list_foreach (d, &t->users, node)
+        vlc_sem_post (&d->ready);
+    vlc_mutex_unlock (&t->lock);
+    return NULL;
+}
+
+static void dvb_tuner_close (struct dvb_tuner *t)
+{
+    if (t->interrupt != NULL)
+    {
+        vlc_interrupt_kill (t->interrupt);
+        vlc_join (t->thread, NULL);
+        vlc_interrupt_destroy (t->interrupt);
+    }
+#ifndef USE_DMX
+    if (!t->budget)
+    {
+        for (size_t i = 0; i < MAX_PIDS; i++)
+            if (t->pids[i].fd != -1)
+                vlc_close (t->pids[i].fd);
+    }
+#endif
+    if (t->cam != NULL)
+        en50221_End (t->cam);
+    if (t->frontend != -1)
+        vlc_close (t->frontend);
+    vlc_close (t->demux);
+    vlc_close (t->dir);
+    free (t->polarization);
+    free (t);
+}
+
+/**
+ * Opens the DVB tuner devices and starts reading
+ */
+static struct dvb_tuner *dvb_tuner_open (vlc_object_t *obj, uint8_t adapter,
+                                         uint8_t device)
+{
+    struct dvb_tuner *t = malloc (sizeof (*t));
+    if (unlikely(t == NULL))
+        return NULL;
+
+    /* Messages from the tuner are not tied to any one of its inputs */
+    t->obj = VLC_OBJECT(vlc_object_instance (obj));
+    t->adapter = adapter;
+    t->device = device;
+    t->refs = 1;
+
+    t->dir = dvb_open_adapter (adapter);
+    if (t->dir == -1)
     {
         msg_Err (obj, "cannot access adapter %"PRIu8": %s", adapter,
                  vlc_strerror_c(errno));
-        free (d);
+        free (t);
         return NULL;
     }
-    d->frontend = -1;
-    d->cam = NULL;
-    d->budget = var_InheritBool (obj, "dvb-budget-mode");
+    t->frontend = -1;
+    t->cam = NULL;
+    t->budget = var_InheritBool (obj, "dvb-budget-mode");
+    t->polarization = NULL;
+    t->interrupt = NULL;
+    t->eof = false;
+    vlc_mutex_init (&t->lock);
+    vlc_list_init (&t->users);
+    memset (t->pid_refs, 0, sizeof (t->pid_refs));
 
 #ifndef USE_DMX
-    if (d->budget)
+    if (t->budget)
 #endif
     {
-       d->demux = dvb_open_node (d, "demux", O_RDONLY);
-       if (d->demux == -1)
+       t->demux = dvb_open_node (t, "demux", O_RDONLY);
+       if (t->demux == -1)
        {
            msg_Err (obj, "cannot access demultiplexer: %s",
                     vlc_strerror_c(errno));
-           vlc_close (d->dir);
-           free (d);
+           vlc_close (t->dir);
+           free (t);
            return NULL;
        }
 
-       if (ioctl (d->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
+       if (ioctl (t->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
            msg_Warn (obj, "cannot expand demultiplexing buffer: %s",
                      vlc_strerror_c(errno));
 
@@ -227,12 +501,12 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
         * cannot be configured otherwise. So add the PAT. */
         struct dmx_pes_filter_params param;
 
-        param.pid = d->budget ? 0x2000 : 0x000;
+        param.pid = t->budget ? 0x2000 : 0x000;
         param.input = DMX_IN_FRONTEND;
         param.output = DMX_OUT_TSDEMUX_TAP;
         param.pes_type = DMX_PES_OTHER;
         param.flags = DMX_IMMEDIATE_START;
-        if (ioctl (d->demux, DMX_SET_PES_FILTER, &param) < 0)
+        if (ioctl (t->demux, DMX_SET_PES_FILTER, &param) < 0)
         {
             msg_Err (obj, "cannot setup TS demultiplexer: %s",
                      vlc_strerror_c(errno));
@@ -243,155 +517,184 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
     else
     {
         for (size_t i = 0; i < MAX_PIDS; i++)
-            d->pids[i].pid = d->pids[i].fd = -1;
-        d->demux = dvb_open_node (d, "dvr", O_RDONLY);
-        if (d->demux == -1)
+            t->pids[i].pid = t->pids[i].fd = -1;
+        t->demux = dvb_open_node (t, "dvr", O_RDONLY);
+        if (t->demux == -1)
         {
             msg_Err (obj, "cannot access DVR: %s", vlc_strerror_c(errno));
-            vlc_close (d->dir);
-            free (d);
+            vlc_close (t->dir);
+            free (t);
             return NULL;
         }
 #endif
     }
 
-    int ca = dvb_open_node (d, "ca", O_RDWR);
+    int ca = dvb_open_node (t, "ca", O_RDWR);
     if (ca != -1)
     {
-        d->cam = en50221_Init (obj, ca);
-        if (d->cam == NULL)
+        t->cam = en50221_Init (t->obj, ca);
+        if (t->cam == NULL)
             vlc_close (ca);
     }
     else
         msg_Dbg (obj, "conditional access module not available: %s",
                  vlc_strerror_c(errno));
-    return d;
 
-error:
-    dvb_close (d);
-    return NULL;
-}
-
-void dvb_close (dvb_device_t *d)
-{
-#ifndef USE_DMX
-    if (!d->budget)
+    t->interrupt = vlc_interrupt_create ();
+    if (unlikely(t->interrupt == NULL))
+        goto error;
+    if (vlc_clone (&t->thread, dvb_thread, t, VLC_THREAD_PRIORITY_INPUT))
     {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            if (d->pids[i].fd != -1)
-                vlc_close (d->pids[i].fd);
+        vlc_interrupt_destroy (t->interrupt);
+        t->interrupt = NULL;
+        goto error;
     }
-#endif
-    if (d->cam != NULL)
-        en50221_End (d->cam);
-    if (d->frontend != -1)
-        vlc_close (d->frontend);
-    vlc_close (d->demux);
-    vlc_close (d->dir);
-    free (d);
-}
-
-static void dvb_frontend_status(vlc_object_t *obj, fe_status_t s)
-{
-    msg_Dbg(obj, "frontend status:");
-#define S(f) \
-    if (s & FE_ ## f) \
-        msg_Dbg(obj, "\t%s", #f);
+    return t;
 
-    S(HAS_SIGNAL);
-    S(HAS_CARRIER);
-    S(HAS_VITERBI);
-    S(HAS_SYNC);
-    S(HAS_LOCK);
-    S(TIMEDOUT);
-    S(REINIT);
-#undef S
+error:
+    dvb_tuner_close (t);
+    return NULL;
 }
 
 /**
- * Reads TS data from the tuner.
- * @return number of bytes read, 0 on EOF, -1 if no data (yet).
+ * Opens the DVB tuner, or shares it if another input already uses it on the
+ * same transponder.
  */
-ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
+dvb_device_t *dvb_open (vlc_object_t *obj)
 {
-    struct pollfd ufd[2];
-    int n;
+    dvb_device_t *d = malloc (sizeof (*d));
+    if (unlikely(d == NULL))
+        return NULL;
 
-    if (d->cam != NULL)
-        en50221_Poll (d->cam);
+    d->obj = obj;
 
-    ufd[0].fd = d->demux;
-    ufd[0].events = POLLIN;
-    if (d->frontend != -1)
-    {
-        ufd[1].fd = d->frontend;
-        ufd[1].events = POLLPRI;
-        n = 2;
-    }
-    else
-        n = 1;
+    uint8_t adapter = var_InheritInteger (obj, "dvb-adapter");
+    uint8_t device = var_InheritInteger (obj, "dvb-device");
+    int64_t frequency = var_InheritInteger (obj, "dvb-frequency");
+    char *pol = var_InheritString (obj, "dvb-polarization");
+    struct dvb_tuner *t = NULL, *cur;
 
-    errno = 0;
-    n = vlc_poll_i11e (ufd, n, ms);
-    if (n == 0)
-        errno = EAGAIN;
-    if (n <= 0)
-        return -1;
+    vlc_mutex_lock (&dvb_tuners_lock);
+    vlc_list_foreach (cur, &dvb_tuners, node)
+        if (cur->adapter == adapter && cur->device == device)
+            t = cur;
 
-    if (d->frontend != -1 && ufd[1].revents)
+    if (t != NULL)
     {
-        struct dvb_frontend_event ev;
-
-        if (ioctl (d->frontend, FE_GET_EVENT, &ev) < 0)
+        if (t->frequency != frequency
+         || strcmp (t->polarization ? t->polarization : "", pol ? pol : ""))
         {
-            if (errno == EOVERFLOW)
-            {
-                msg_Err (d->obj, "cannot dequeue events fast enough!");
-                return -1;
-            }
-            msg_Err (d->obj, "cannot dequeue frontend event: %s",
-                     vlc_strerror_c(errno));
-            return 0;
+            msg_Err (obj, "adapter %"PRIu8" is in use on another transponder",
+                     adapter);
+            vlc_mutex_unlock (&dvb_tuners_lock);
+            free (pol);
+            free (d);
+            return NULL;
         }
-
-        dvb_frontend_status(d->obj, ev.status);
+        msg_Dbg (obj, "sharing adapter %"PRIu8" with other inputs", adapter);
+        t->refs++;
+        free (pol);
+        d->shared = true;
     }
-
-    if (ufd[0].revents)
+    else
     {
-        ssize_t val = read (d->demux, buf, len);
-        if (val == -1 && (errno != EAGAIN && errno != EINTR))
+        t = dvb_tuner_open (obj, adapter, device);
+        if (t == NULL)
         {
-            if (errno == EOVERFLOW)
-            {
-                msg_Err (d->obj, "cannot demux data fast enough!");
-                return -1;
-            }
-            msg_Err (d->obj, "cannot demux: %s", vlc_strerror_c(errno));
-            return 0;
+            vlc_mutex_unlock (&dvb_tuners_lock);
+            free (pol);
+            free (d);
+            return NULL;
         }
-        return val;
+        t->frequency = frequency;
+        t->polarization = pol;
+        vlc_list_append (&t->node, &dvb_tuners);
+        d->shared = false;
     }
+    vlc_mutex_unlock (&dvb_tuners_lock);
+
+    d->tuner = t;
+    vlc_queue_Init (&d->queue, offsetof (block_t, p_next));
+    vlc_sem_init (&d->ready, 0);
+    atomic_init (&d->pending, 0);
+    d->overflow = false;
+    memset (d->pids, 0, sizeof (d->pids));
+
+    vlc_mutex_lock (&t->lock);
+    vlc_list_append (&d->node, &t->users);
+    if (t->eof)
+        vlc_sem_post (&d->ready);
+    vlc_mutex_unlock (&t->lock);
+    return d;
+}
 
-    return -1;
+void dvb_close (dvb_device_t *d)
+{
+    struct dvb_tuner *t = d->tuner;
+
+    for (unsigned pid = 0; pid < 0x2000; pid++)
+        dvb_remove_pid (d, pid);
+
+    vlc_mutex_lock (&t->lock);
+    vlc_list_remove (&d->node);
+    vlc_mutex_unlock (&t->lock);
+
+    block_ChainRelease (vlc_queue_DequeueAll (&d->queue));
+    free (d);
+
+    vlc_mutex_lock (&dvb_tuners_lock);
+    if (--t->refs > 0)
+        t = NULL;
+    else
+        vlc_list_remove (&t->node);
+    vlc_mutex_unlock (&dvb_tuners_lock);
+
+    if (t != NULL)
+        dvb_tuner_close (t);
 }
 
-int dvb_add_pid (dvb_device_t *d, uint16_t pid)
+bool dvb_is_shared (const dvb_device_t *d)
+{
+    return d->shared;
+}
+
+/**
+ * Reads TS data from the tuner. The data is shared with the other inputs.
+ * @return a block, or NULL if interrupted or on EOF (then *eof is set).
+ */
+block_t *dvb_read_block (dvb_device_t *d, bool *restrict eof)
+{
+    if (vlc_sem_wait_i11e (&d->ready))
+        return NULL;
+
+    vlc_queue_Lock (&d->queue);
+    block_t *block = vlc_queue_DequeueUnlocked (&d->queue);
+    vlc_queue_Unlock (&d->queue);
+    if (block == NULL)
+    {   /* Only posted without data at the end of the stream */
+        *eof = true;
+        vlc_sem_post (&d->ready);
+        return NULL;
+    }
+
+    atomic_fetch_sub_explicit (&d->pending, 1, memory_order_relaxed);
+    return block;
+}
+
+static int dvb_add_pid_tuner (struct dvb_tuner *t, uint16_t pid)
 {
-    if (d->budget)
-        return 0;
 #ifdef USE_DMX
-    if (pid == 0 || ioctl (d->demux, DMX_ADD_PID, &pid) >= 0)
+    if (pid == 0 || ioctl (t->demux, DMX_ADD_PID, &pid) >= 0)
         return 0;
 #else
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
-        if (d->pids[i].pid == pid)
+        if (t->pids[i].pid == pid)
             return 0;
-        if (d->pids[i].fd != -1)
+        if (t->pids[i].fd != -1)
             continue;
 
-        int fd = dvb_open_node (d, "demux", O_RDONLY);
+        int fd = dvb_open_node (t, "demux", O_RDONLY);
         if (fd == -1)
             goto error;
 
@@ -409,64 +712,103 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
             vlc_close (fd);
             goto error;
         }
-        d->pids[i].fd = fd;
-        d->pids[i].pid = pid;
+        t->pids[i].fd = fd;
+        t->pids[i].pid = pid;
         return 0;
     }
     errno = EMFILE;
 error:
 #endif
-    msg_Err (d->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
+    msg_Err (t->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
              vlc_strerror_c(errno));
     return -1;
 }
 
-void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
+static void dvb_remove_pid_tuner (struct dvb_tuner *t, uint16_t pid)
 {
-    if (d->budget)
-        return;
 #ifdef USE_DMX
     if (pid != 0)
-        ioctl (d->demux, DMX_REMOVE_PID, &pid);
+        ioctl (t->demux, DMX_REMOVE_PID, &pid);
 #else
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
-        if (d->pids[i].pid == pid)
+        if (t->pids[i].pid == pid)
         {
-            vlc_close (d->pids[i].fd);
-            d->pids[i].pid = d->pids[i].fd = -1;
+            vlc_close (t->pids[i].fd);
+            t->pids[i].pid = t->pids[i].fd = -1;
             return;
         }
     }
 #endif
 }
 
+/* The hardware filters the union of the PIDs wanted by the inputs sharing
+ * the tuner. Then each input ignores the PIDs of the others. */
+int dvb_add_pid (dvb_device_t *d, uint16_t pid)
+{
+    struct dvb_tuner *t = d->tuner;
+
+    if (t->budget || (d->pids[pid / 8] & (1 << (pid % 8))))
+        return 0;
+
+    vlc_mutex_lock (&t->lock);
+    if (t->pid_refs[pid] == 0 && dvb_add_pid_tuner (t, pid))
+    {
+        vlc_mutex_unlock (&t->lock);
+        return -1;
+    }
+    t->pid_refs[pid]++;
+    vlc_mutex_unlock (&t->lock);
+
+    d->pids[pid / 8] |= 1 << (pid % 8);
+    return 0;
+}
+
+void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
+{
+    struct dvb_tuner *t = d->tuner;
+
+    if (t->budget || !(d->pids[pid / 8] & (1 << (pid % 8))))
+        return;
+
+    d->pids[pid / 8] &= ~(1 << (pid % 8));
+
+    vlc_mutex_lock (&t->lock);
+    assert (t->pid_refs[pid] > 0);
+    if (--t->pid_refs[pid] == 0)
+        dvb_remove_pid_tuner (t, pid);
+    vlc_mutex_unlock (&t->lock);
+}
+
 bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
 {
-    if (d->budget)
+    if (d->tuner->budget)
         return true;
 
-    for (size_t i = 0; i < MAX_PIDS; i++)
-        if (d->pids[i].pid == pid)
-            return true;
-
-    return false;
+    return (d->pids[pid / 8] & (1 << (pid % 8))) != 0;
 }
 
 /** Finds a frontend of the correct type */
 static int dvb_open_frontend (dvb_device_t *d)
 {
-    if (d->frontend != -1)
-        return 0;
-    int fd = dvb_open_node (d, "frontend", O_RDWR);
-    if (fd == -1)
+    struct dvb_tuner *t = d->tuner;
+    int ret = 0;
+
+    vlc_mutex_lock (&t->lock);
+    if (t->frontend == -1)
     {
-        msg_Err (d->obj, "cannot access frontend: %s", vlc_strerror_c(errno));
-        return -1;
+        int fd = dvb_open_node (t, "frontend", O_RDWR);
+        if (fd == -1)
+        {
+            msg_Err (d->obj, "cannot access frontend: %s",
+                     vlc_strerror_c(errno));
+            ret = -1;
+        }
+        else
+            t->frontend = fd;
     }
-
-    d->frontend = fd;
-    return 0;
+    vlc_mutex_unlock (&t->lock);
+    return ret;
 }
 #define dvb_find_frontend(d, sys) (dvb_open_frontend(d))
 
@@ -489,7 +831,7 @@ unsigned dvb_enum_systems (dvb_device_t *d)
         .props = prop
     };
 
-    if (ioctl (d->frontend, FE_GET_PROPERTY, &props) < 0)
+    if (ioctl (d->tuner->frontend, FE_GET_PROPERTY, &props) < 0)
     {
          msg_Err (d->obj, "cannot enumerate frontend systems: %s",
                   vlc_strerror_c(errno));
@@ -547,7 +889,7 @@ legacy:
         .props = prop
     };
 #endif
-    if (ioctl (d->frontend, FE_GET_PROPERTY, &props) < 0)
+    if (ioctl (d->tuner->frontend, FE_GET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "unsupported kernel DVB version 3 or older (%s)",
                  vlc_strerror_c(errno));
@@ -567,7 +909,7 @@ legacy:
         msg_Info (d->obj, "please recompile "PACKAGE_NAME" "PACKAGE_VERSION);
 #endif
     struct dvb_frontend_info info;
-    if (ioctl (d->frontend, FE_GET_INFO, &info) < 0)
+    if (ioctl (d->tuner->frontend, FE_GET_INFO, &info) < 0)
     {
         msg_Err (d->obj, "cannot get frontend info: %s",
                  vlc_strerror_c(errno));
@@ -617,8 +959,8 @@ float dvb_get_signal_strength (dvb_device_t *d)
 {
     uint16_t strength;
 
-    if (d->frontend == -1
-     || ioctl (d->frontend, FE_READ_SIGNAL_STRENGTH, &strength) < 0)
+    if (d->tuner->frontend == -1
+     || ioctl (d->tuner->frontend, FE_READ_SIGNAL_STRENGTH, &strength) < 0)
         return 0.;
     return strength / 65535.;
 }
@@ -627,19 +969,22 @@ float dvb_get_snr (dvb_device_t *d)
 {
     uint16_t snr;
 
-    if (d->frontend == -1 || ioctl (d->frontend, FE_READ_SNR, &snr) < 0)
+    if (d->tuner->frontend == -1 || ioctl (d->tuner->frontend, FE_READ_SNR, &snr) < 0)
         return 0.;
     return snr / 65535.;
 }
 
 bool dvb_set_ca_pmt (dvb_device_t *d, en50221_capmt_info_t *p_capmtinfo)
 {
-    if (d->cam != NULL)
-    {
-        en50221_SetCAPMT (d->cam, p_capmtinfo);
-        return true;
-    }
-    return false;
+    struct dvb_tuner *t = d->tuner;
+
+    if (t->cam == NULL)
+        return false;
+
+    vlc_mutex_lock (&t->lock);
+    en50221_SetCAPMT (t->cam, p_capmtinfo);
+    vlc_mutex_unlock (&t->lock);
+    return true;
 }
 
 static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
@@ -661,7 +1006,7 @@ static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
         n--;
     }
 
-    if (ioctl (d->frontend, FE_SET_PROPERTY, &props) < 0)
+    if (ioctl (d->tuner->frontend, FE_SET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "cannot set frontend tuning parameters: %s",
                  vlc_strerror_c(errno));
@@ -705,7 +1050,7 @@ int dvb_tune (dvb_device_t *d)
 int dvb_fill_device_caps(dvb_device_t *d, dvb_device_caps_t *caps)
 {
     struct dvb_frontend_info info;
-    if (ioctl (d->frontend, FE_GET_INFO, &info) < 0)
+    if (ioctl (d->tuner->frontend, FE_GET_INFO, &info) < 0)
     {
         msg_Err (d->obj, "cannot get frontend info: %s",
                  vlc_strerror_c(errno));
@@ -761,7 +1106,7 @@ int dvb_set_sec (dvb_device_t *d, uint64_t freq_Hz, char pol,
 
     /* Always try to configure high voltage, but only warn on enable failure */
     int val = var_InheritBool (d->obj, "dvb-high-voltage");
-    if (ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
+    if (ioctl (d->tuner->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
         msg_Err (d->obj, "cannot enable high LNB voltage: %s",
                  vlc_strerror_c(errno));
 
@@ -856,7 +1201,7 @@ known:
                        | (tone == SEC_TONE_ON); /* option */
           uncmd.msg[4] = uncmd.msg[5] = 0; /* unused */
           uncmd.msg_len = 4; /* length */
-          if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
+          if (ioctl (d->tuner->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
           {
               msg_Err (d->obj, "cannot send uncommitted DiSEqC command: %s",
                        vlc_strerror_c(errno));
@@ -864,7 +1209,7 @@ known:
           }
           /* Repeat uncommitted command */
           uncmd.msg[0] = 0xE1; /* framing: master, no reply, repeated TX */
-          if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
+          if (ioctl (d->tuner->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
           {
               msg_Err (d->obj,
                        "cannot send repeated uncommitted DiSEqC command: %s",
@@ -873,7 +1218,7 @@ known:
           }
           vlc_tick_sleep(VLC_TICK_FROM_MS(125)); /* wait 125 ms before committed DiSEqC command */
         }
-        if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &cmd) < 0)
+        if (ioctl (d->tuner->frontend, FE_DISEQC_SEND_MASTER_CMD, &cmd) < 0)
         {
             msg_Err (d->obj, "cannot send committed DiSEqC command: %s",
                      vlc_strerror_c(errno));
@@ -883,7 +1228,7 @@ known:
 
         /* Mini-DiSEqC */
         satno &= 1;
-        if (ioctl (d->frontend, FE_DISEQC_SEND_BURST,
+        if (ioctl (d->tuner->frontend, FE_DISEQC_SEND_BURST,
                    satno ? SEC_MINI_B : SEC_MINI_A) < 0)
         {
             msg_Err (d->obj, "cannot send Mini-DiSEqC tone burst: %s",
@@ -62,6 +62,7 @@ dvdnav_status_t dvdnav_jump_to_sector_by_time(dvdnav_t *, uint64_t, int32_t);
 #include "../demux/timestamps_filter.h"
 
 #include "disc_helper.h"
+#include "disc_readahead.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -123,6 +124,7 @@ typedef struct
     /* */
     bool        b_reset_pcr;
     bool        b_readahead;
+    disc_readahead_t *p_readahead; /* stream input read-ahead, or NULL */
 
     struct
     {
@@ -489,14 +491,30 @@ static int StreamProbeDVD( stream_t *s )
 /*****************************************************************************
  * dvdnav stream callbacks
  *****************************************************************************/
+static disc_readahead_t *stream_cb_readahead( demux_t *p_demux )
+{
+    /* CommonOpen() has not run yet while dvdnav opens the stream */
+    demux_sys_t *p_sys = p_demux->p_sys;
+    return p_sys != NULL ? p_sys->p_readahead : NULL;
+}
+
 static int stream_cb_seek( void *demux, uint64_t pos )
 {
-    return vlc_stream_Seek( ((demux_t *)demux)->s, pos );
+    disc_readahead_t *p_readahead = stream_cb_readahead( demux );
+    if( p_readahead == NULL )
+        return vlc_stream_Seek( ((demux_t *)demux)->s, pos );
+
+    disc_readahead_Seek( p_readahead, pos );
+    return VLC_SUCCESS;
 }
 
 static int stream_cb_read( void *demux, void* buffer, int size )
 {
-    return vlc_stream_Read( ((demux_t *)demux)->s, buffer, size );
+    disc_readahead_t *p_readahead = stream_cb_readahead( demux );
+    if( p_readahead == NULL )
+        return vlc_stream_Read( ((demux_t *)demux)->s, buffer, size );
+
+    return disc_readahead_Read( p_readahead, buffer, size );
 }
 
 /*****************************************************************************
@@ -546,8 +564,19 @@ static int DemuxOpen ( vlc_object_t *p_this )
 
     int i_ret = CommonOpen( p_this, p_dvdnav, false );
     if( i_ret != VLC_SUCCESS )
+    {
         dvdnav_close( p_dvdnav );
-    return i_ret;
+        return i_ret;
+    }
+
+    /* Slow sources (network shares, ...) would stall playback on each
+     * synchronous read: read the image ahead for playback. */
+    bool b_fastseek = false;
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    if( !b_fastseek )
+        p_demux->p_sys->p_readahead =
+            disc_readahead_New( p_this, p_demux->s, DISC_READAHEAD_SIZE );
+    return VLC_SUCCESS;
 }
 
 /*****************************************************************************
@@ -580,6 +609,8 @@ static void Close( vlc_object_t *p_this )
     timestamps_filter_es_out_Delete( p_sys->p_tf_out );
 
     dvdnav_close( p_sys->dvdnav );
+    if( p_sys->p_readahead != NULL )
+        disc_readahead_Delete( p_sys->p_readahead );
     free( p_sys );
 }
 
@@ -52,6 +52,9 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -63,9 +66,19 @@
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
 
+/* Size of the mapped windows */
+#define FILE_MMAP_WINDOW (8 << 20)
+
 typedef struct
 {
     int fd;
+#ifdef HAVE_LINUX_IO_URING_H
+    file_uring_t *uring;
+#endif
+#ifdef HAVE_MMAP
+    uint64_t offset; /**< current offset in mapped mode */
+    uint64_t size; /**< known file size in mapped mode */
+#endif
 
     bool b_pace_control;
 } access_sys_t;
@@ -128,6 +141,14 @@ static bool IsRemote (const char *path)
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
+#ifdef HAVE_LINUX_IO_URING_H
+static block_t *UringBlock (stream_t *, bool *);
+static int UringSeek (stream_t *, uint64_t);
+#endif
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
 static int FileControl (stream_t *, int, va_list);
 
 /*****************************************************************************
@@ -213,6 +234,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_LINUX_IO_URING_H
+    p_sys->uring = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -231,6 +255,32 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        off_t offset;
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && (offset = lseek (fd, 0, SEEK_CUR)) != (off_t)-1)
+        {
+            p_sys->offset = offset;
+            p_sys->size = st.st_size;
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+        }
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+        unsigned depth = var_InheritInteger (p_access, "file-queue-depth");
+        off_t start;
+
+        if (p_access->pf_read != NULL && depth > 0
+         && (start = lseek (fd, 0, SEEK_CUR)) != (off_t)-1)
+            p_sys->uring = FileUringNew (p_this, fd, start, depth);
+        if (p_sys->uring != NULL)
+        {
+            p_access->pf_read = NULL;
+            p_access->pf_block = UringBlock;
+            p_access->pf_seek = UringSeek;
+        }
 #endif
     }
     else
@@ -253,7 +303,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -261,6 +311,10 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_LINUX_IO_URING_H
+    if (p_sys->uring != NULL)
+        FileUringDelete (p_sys->uring);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -299,6 +353,83 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_LINUX_IO_URING_H
+static block_t *UringBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    return FileUringRead (sys->uring, eof);
+}
+
+static int UringSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    FileUringSeek (sys->uring, i_pos);
+    return VLC_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_MMAP
+/**
+ * Maps the next window of the file: the block is a view of the page cache,
+ * so the data is not copied on the way to the demuxer.
+ */
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    if (sys->offset >= sys->size)
+    {   /* The file may be growing */
+        struct stat st;
+
+        if (fstat (sys->fd, &st) == 0)
+            sys->size = st.st_size;
+        if (sys->offset >= sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    uint64_t page_mask = sysconf (_SC_PAGESIZE) - 1;
+    uint64_t base = sys->offset & ~page_mask;
+    size_t skip = sys->offset - base;
+    size_t length = __MIN(sys->size - base, FILE_MMAP_WINDOW);
+
+    void *addr = mmap (NULL, length, PROT_READ, MAP_PRIVATE, sys->fd, base);
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "cannot map file: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+    madvise (addr, length, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    /* This needs huge pages for the page cache of the file system */
+    madvise (addr, length, MADV_HUGEPAGE);
+#endif
+
+    block_t *block = block_mmap_Alloc (addr, length);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    block->p_buffer += skip;
+    block->i_buffer -= skip;
+    sys->offset += block->i_buffer;
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    sys->offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
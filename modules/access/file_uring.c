@@ -0,0 +1,499 @@
+/*****************************************************************************
+ * file_uring.c: asynchronous file reads with io_uring
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_interrupt.h>
+#include "fs.h"
+
+/*
+ * The reads are queued ahead of the reader, each into its own slot of one
+ * buffer registered with the kernel, and the slots are handed out as blocks
+ * in the file order. A slot is queued again once its block is released, so
+ * that the readahead is bounded by the blocks still held downstream.
+ *
+ * Only the reader thread (open, read, seek and close) touches the rings; the
+ * blocks can be released from any thread, hence the lock on the slot states.
+ */
+
+#define FILE_URING_BLOCK (1 << 20)
+
+enum slot_state
+{
+    SLOT_FREE,   /**< available for a new read */
+    SLOT_QUEUED, /**< read in flight */
+    SLOT_DONE,   /**< read completed, waiting for the reader */
+    SLOT_HELD,   /**< delivered, waiting for the block to be released */
+    SLOT_STALE,  /**< read in flight, but discarded by a seek */
+};
+
+struct file_uring_slot
+{
+    block_t block;
+    struct file_uring *uring;
+    uint8_t *buf;
+    uint64_t offset;
+    size_t filled;
+    enum slot_state state;
+};
+
+struct file_uring
+{
+    vlc_object_t *obj;
+    int fd;
+    int ring_fd;
+    int event_fd;
+    bool fixed; /**< whether the buffer is registered */
+
+    /* rings */
+    void *sq_map, *cq_map;
+    size_t sq_map_size, cq_map_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    _Atomic unsigned *sq_head, *sq_tail;
+    unsigned *sq_array, sq_mask;
+    _Atomic unsigned *cq_head, *cq_tail;
+    struct io_uring_cqe *cqes;
+    unsigned cq_mask;
+
+    /* reads */
+    uint64_t next_offset;
+    bool eof;
+    unsigned depth;
+    unsigned inflight;
+    unsigned fifo_head, fifo_count;
+    unsigned *fifo;
+
+    vlc_mutex_t lock;
+    unsigned refs; /**< reader and held blocks */
+    uint8_t *arena;
+    struct file_uring_slot slots[];
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned submit, unsigned complete,
+                       unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, submit, complete, flags,
+                   NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void *arg,
+                          unsigned count)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+static void FileUringRelease(struct file_uring *u)
+{
+    vlc_mutex_lock(&u->lock);
+    unsigned refs = --u->refs;
+    vlc_mutex_unlock(&u->lock);
+
+    if (refs == 0)
+    {
+        free(u->arena);
+        free(u->fifo);
+        free(u);
+    }
+}
+
+static void SlotFree(block_t *block)
+{
+    struct file_uring_slot *slot =
+        container_of(block, struct file_uring_slot, block);
+    struct file_uring *u = slot->uring;
+
+    vlc_mutex_lock(&u->lock);
+    assert(slot->state == SLOT_HELD);
+    slot->state = SLOT_FREE;
+    vlc_mutex_unlock(&u->lock);
+    FileUringRelease(u);
+}
+
+static const struct vlc_block_callbacks slot_cbs = { SlotFree };
+
+/** Queues a read of the rest of a slot (without submitting it) */
+static void SlotQueue(struct file_uring *u, struct file_uring_slot *slot)
+{
+    unsigned tail = atomic_load_explicit(u->sq_tail, memory_order_relaxed);
+    unsigned index = tail & u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[index];
+
+    memset(sqe, 0, sizeof (*sqe));
+    sqe->opcode = u->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = u->fd;
+    sqe->off = slot->offset + slot->filled;
+    sqe->addr = (uintptr_t)(slot->buf + slot->filled);
+    sqe->len = FILE_URING_BLOCK - slot->filled;
+    sqe->buf_index = 0;
+    sqe->user_data = slot - u->slots;
+
+    u->sq_array[index] = index;
+    atomic_store_explicit(u->sq_tail, tail + 1, memory_order_release);
+    slot->state = SLOT_QUEUED;
+    u->inflight++;
+}
+
+static int Submit(struct file_uring *u)
+{
+    unsigned head = atomic_load_explicit(u->sq_head, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(u->sq_tail, memory_order_relaxed);
+
+    while (tail != head)
+    {
+        int val = uring_enter(u->ring_fd, tail - head, 0, 0);
+        if (val < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            msg_Err(u->obj, "cannot submit reads: %s", vlc_strerror_c(errno));
+            return -1;
+        }
+        head = atomic_load_explicit(u->sq_head, memory_order_acquire);
+    }
+    return 0;
+}
+
+/** Queues reads in all the free slots */
+static int Fill(struct file_uring *u)
+{
+    vlc_mutex_lock(&u->lock);
+    for (unsigned i = 0; i < u->depth && !u->eof; i++)
+    {
+        struct file_uring_slot *slot = &u->slots[i];
+
+        if (slot->state != SLOT_FREE)
+            continue;
+
+        slot->offset = u->next_offset;
+        slot->filled = 0;
+        u->next_offset += FILE_URING_BLOCK;
+        SlotQueue(u, slot);
+        u->fifo[(u->fifo_head + u->fifo_count++) % u->depth] = i;
+    }
+    vlc_mutex_unlock(&u->lock);
+    return Submit(u);
+}
+
+/** Handles the completed reads, and submits their continuations */
+static int Reap(struct file_uring *u)
+{
+    unsigned head = atomic_load_explicit(u->cq_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(u->cq_tail, memory_order_acquire);
+    bool requeued = false;
+
+    vlc_mutex_lock(&u->lock);
+    for (; head != tail; head++)
+    {
+        const struct io_uring_cqe *cqe = &u->cqes[head & u->cq_mask];
+        struct file_uring_slot *slot = &u->slots[cqe->user_data];
+
+        assert(cqe->user_data < u->depth);
+        u->inflight--;
+
+        if (slot->state == SLOT_STALE)
+        {
+            slot->state = SLOT_FREE;
+            continue;
+        }
+        assert(slot->state == SLOT_QUEUED);
+
+        if (cqe->res < 0)
+        {
+            if (cqe->res == -EINTR || cqe->res == -EAGAIN)
+            {
+                SlotQueue(u, slot);
+                requeued = true;
+                continue;
+            }
+            msg_Err(u->obj, "read error: %s", vlc_strerror_c(-cqe->res));
+            u->eof = true;
+            slot->filled = 0;
+        }
+        else if (cqe->res > 0)
+        {   /* a short read is continued, unless it ends the file */
+            slot->filled += cqe->res;
+            if (slot->filled < FILE_URING_BLOCK)
+            {
+                SlotQueue(u, slot);
+                requeued = true;
+                continue;
+            }
+        }
+        slot->state = SLOT_DONE;
+    }
+    vlc_mutex_unlock(&u->lock);
+
+    atomic_store_explicit(u->cq_head, head, memory_order_release);
+    return requeued ? Submit(u) : 0;
+}
+
+/** Waits for one completion at least */
+static int Wait(struct file_uring *u, bool interruptible)
+{
+    if (!interruptible)
+    {
+        if (uring_enter(u->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0
+         && errno != EINTR)
+            return -1;
+        return 0;
+    }
+
+    struct pollfd ufd = { .fd = u->event_fd, .events = POLLIN };
+    uint64_t events;
+
+    if (vlc_poll_i11e(&ufd, 1, -1) < 0)
+        return -1;
+    if (read(u->event_fd, &events, sizeof (events)) < 0 && errno != EAGAIN)
+        return -1;
+    return 0;
+}
+
+block_t *FileUringRead(file_uring_t *u, bool *restrict eof)
+{
+    for (;;)
+    {
+        if (Reap(u) || Fill(u))
+            break;
+
+        if (u->fifo_count == 0)
+        {   /* nothing left to read */
+            *eof = true;
+            return NULL;
+        }
+
+        struct file_uring_slot *slot = &u->slots[u->fifo[u->fifo_head]];
+
+        vlc_mutex_lock(&u->lock);
+        if (slot->state == SLOT_DONE)
+        {
+            u->fifo_head = (u->fifo_head + 1) % u->depth;
+            u->fifo_count--;
+
+            if (slot->filled == 0)
+            {   /* end of the file: the next reads are beyond */
+                slot->state = SLOT_FREE;
+                u->eof = true;
+                vlc_mutex_unlock(&u->lock);
+                *eof = true;
+                return NULL;
+            }
+
+            slot->state = SLOT_HELD;
+            u->refs++;
+            vlc_mutex_unlock(&u->lock);
+
+            block_t *block = block_Init(&slot->block, &slot_cbs, slot->buf,
+                                        FILE_URING_BLOCK);
+            block->i_buffer = slot->filled;
+            return block;
+        }
+        vlc_mutex_unlock(&u->lock);
+
+        if (Wait(u, true))
+            return NULL; /* interrupted */
+    }
+
+    *eof = true;
+    return NULL;
+}
+
+void FileUringSeek(file_uring_t *u, uint64_t offset)
+{
+    if (Reap(u))
+        u->eof = true;
+
+    vlc_mutex_lock(&u->lock);
+    for (unsigned i = 0; i < u->depth; i++)
+    {
+        struct file_uring_slot *slot = &u->slots[i];
+
+        if (slot->state == SLOT_QUEUED)
+            slot->state = SLOT_STALE;
+        else if (slot->state == SLOT_DONE)
+            slot->state = SLOT_FREE;
+    }
+    u->fifo_head = u->fifo_count = 0;
+    u->next_offset = offset;
+    u->eof = false;
+    vlc_mutex_unlock(&u->lock);
+}
+
+static void Unmap(file_uring_t *u)
+{
+    if (u->sqes != MAP_FAILED)
+        munmap(u->sqes, u->sqes_size);
+    if (u->cq_map != MAP_FAILED && u->cq_map != u->sq_map)
+        munmap(u->cq_map, u->cq_map_size);
+    if (u->sq_map != MAP_FAILED)
+        munmap(u->sq_map, u->sq_map_size);
+}
+
+void FileUringDelete(file_uring_t *u)
+{
+    FileUringSeek(u, 0);
+
+    /* the kernel may still write to the buffer until the reads complete */
+    while (u->inflight > 0)
+        if (Wait(u, false) || Reap(u))
+        {   /* leak the buffer rather than have it overwritten once freed */
+            u->refs++;
+            break;
+        }
+
+    Unmap(u);
+    vlc_close(u->event_fd);
+    vlc_close(u->ring_fd);
+    FileUringRelease(u);
+}
+
+file_uring_t *FileUringNew(vlc_object_t *obj, int fd, uint64_t offset,
+                           unsigned depth)
+{
+    file_uring_t *u = malloc(sizeof (*u) + depth * sizeof (u->slots[0]));
+    if (unlikely(u == NULL))
+        return NULL;
+
+    u->obj = obj;
+    u->fd = fd;
+    u->sq_map = u->cq_map = u->sqes = MAP_FAILED;
+    u->next_offset = offset;
+    u->eof = false;
+    u->depth = depth;
+    u->inflight = 0;
+    u->fifo_head = u->fifo_count = 0;
+    u->fifo = vlc_alloc(depth, sizeof (*u->fifo));
+    u->arena = aligned_alloc(4096, (size_t)depth * FILE_URING_BLOCK);
+    vlc_mutex_init(&u->lock);
+    u->refs = 1;
+    if (unlikely(u->fifo == NULL || u->arena == NULL))
+        goto error;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof (params));
+    u->ring_fd = uring_setup(depth, &params);
+    if (u->ring_fd < 0)
+    {
+        msg_Dbg(obj, "cannot create I/O ring: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    u->sq_map_size = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    u->cq_map_size = params.cq_off.cqes
+                   + params.cq_entries * sizeof (struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        u->sq_map_size = u->cq_map_size = __MAX(u->sq_map_size,
+                                                u->cq_map_size);
+
+    u->sq_map = mmap(NULL, u->sq_map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, u->ring_fd,
+                     IORING_OFF_SQ_RING);
+    if (u->sq_map == MAP_FAILED)
+        goto error_ring;
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        u->cq_map = u->sq_map;
+    else
+    {
+        u->cq_map = mmap(NULL, u->cq_map_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, u->ring_fd,
+                         IORING_OFF_CQ_RING);
+        if (u->cq_map == MAP_FAILED)
+            goto error_ring;
+    }
+    u->sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED)
+        goto error_ring;
+
+    uint8_t *sq = u->sq_map, *cq = u->cq_map;
+    u->sq_head = (void *)(sq + params.sq_off.head);
+    u->sq_tail = (void *)(sq + params.sq_off.tail);
+    u->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    u->sq_array = (void *)(sq + params.sq_off.array);
+    u->cq_head = (void *)(cq + params.cq_off.head);
+    u->cq_tail = (void *)(cq + params.cq_off.tail);
+    u->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    u->cqes = (void *)(cq + params.cq_off.cqes);
+
+    u->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (u->event_fd < 0)
+        goto error_ring;
+    if (uring_register(u->ring_fd, IORING_REGISTER_EVENTFD, &u->event_fd, 1))
+    {
+        msg_Dbg(obj, "cannot register event: %s", vlc_strerror_c(errno));
+        vlc_close(u->event_fd);
+        goto error_ring;
+    }
+
+    /* Registered buffers are pinned, and may exceed the locked memory
+     * limit: the reads then work on plain buffers. */
+    struct iovec iov = {
+        .iov_base = u->arena, .iov_len = (size_t)depth * FILE_URING_BLOCK,
+    };
+    u->fixed = uring_register(u->ring_fd, IORING_REGISTER_BUFFERS,
+                              &iov, 1) == 0;
+    if (!u->fixed)
+        msg_Dbg(obj, "cannot register buffers: %s", vlc_strerror_c(errno));
+
+    for (unsigned i = 0; i < depth; i++)
+    {
+        u->slots[i].uring = u;
+        u->slots[i].buf = u->arena + (size_t)i * FILE_URING_BLOCK;
+        u->slots[i].state = SLOT_FREE;
+    }
+
+    msg_Dbg(obj, "reading ahead %u blocks of %u bytes%s", depth,
+            FILE_URING_BLOCK, u->fixed ? " (registered)" : "");
+    return u;
+
+error_ring:
+    Unmap(u);
+    vlc_close(u->ring_fd);
+error:
+    free(u->arena);
+    free(u->fifo);
+    free(u);
+    return NULL;
+}
+#endif
@@ -38,6 +38,19 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+#ifdef HAVE_MMAP
+    add_bool( "file-mmap", false, N_("Map files in memory"),
+        N_("Read regular files through memory mappings, so that the data is "
+           "not copied on its way to the demuxer. The file must not be "
+           "truncated while it is being read.") )
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+    add_integer_with_range( "file-queue-depth", 0, 0, 64,
+        N_("Asynchronous reads"),
+        N_("Number of reads of 1 MiB queued ahead of the demuxer through "
+           "io_uring, so that the input does not wait for the storage. "
+           "0 reads synchronously.") )
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
@@ -23,6 +23,16 @@
 int FileOpen (vlc_object_t *);
 void FileClose (vlc_object_t *);
 
+#ifdef HAVE_LINUX_IO_URING_H
+typedef struct file_uring file_uring_t;
+
+file_uring_t *FileUringNew (vlc_object_t *, int fd, uint64_t offset,
+                            unsigned depth);
+void FileUringDelete (file_uring_t *);
+block_t *FileUringRead (file_uring_t *, bool *eof);
+void FileUringSeek (file_uring_t *, uint64_t offset);
+#endif
+
 int DirOpen (vlc_object_t *);
 int DirInit (stream_t *p_access, DIR *handle);
 void DirClose (vlc_object_t *);
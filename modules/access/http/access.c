@@ -39,12 +39,15 @@
 #include "connmgr.h"
 #include "resource.h"
 #include "file.h"
+#include "parallel.h"
 #include "live.h"
 
 typedef struct
 {
     struct vlc_http_mgr *manager;
     struct vlc_http_resource *resource;
+    struct vlc_http_parallel *parallel;
+    char *content_type;
 } access_sys_t;
 
 static block_t *FileRead(stream_t *access, bool *restrict eof)
@@ -113,6 +116,71 @@ static int FileControl(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+static block_t *ParallelRead(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    block_t *b = vlc_http_parallel_read(sys->parallel);
+    if (b == NULL)
+        *eof = true;
+    return b;
+}
+
+static int ParallelSeek(stream_t *access, uint64_t pos)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (vlc_http_parallel_seek(sys->parallel, pos))
+        return VLC_EGENERIC;
+    return VLC_SUCCESS;
+}
+
+static int ParallelControl(stream_t *access, int query, va_list args)
+{
+    access_sys_t *sys = access->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+
+        case STREAM_GET_SIZE:
+        {
+            uintmax_t val = vlc_http_parallel_get_size(sys->parallel);
+            if (val >= UINT64_MAX)
+                return VLC_EGENERIC;
+
+            *va_arg(args, uint64_t *) = val;
+            break;
+        }
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = VLC_TICK_FROM_MS(
+                var_InheritInteger(access, "network-caching") );
+            break;
+
+        case STREAM_GET_CONTENT_TYPE:
+            if (sys->content_type == NULL)
+                return VLC_EGENERIC;
+            *va_arg(args, char **) = strdup(sys->content_type);
+            break;
+
+        case STREAM_SET_PAUSE_STATE:
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 static block_t *LiveRead(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
@@ -162,6 +230,8 @@ static int Open(vlc_object_t *obj)
 
     sys->manager = NULL;
     sys->resource = NULL;
+    sys->parallel = NULL;
+    sys->content_type = NULL;
 
     void *jar = NULL;
     if (var_InheritBool(obj, "http-forward-cookies"))
@@ -251,9 +321,28 @@ static int Open(vlc_object_t *obj)
     }
     else
     {
-        access->pf_block = FileRead;
-        access->pf_seek = FileSeek;
-        access->pf_control = FileControl;
+        unsigned conns = var_InheritInteger(obj, "http-connections");
+
+        if (conns > 1)
+            sys->parallel = vlc_http_parallel_create(obj, jar, sys->resource,
+                                                     conns);
+        if (sys->parallel != NULL)
+        {   /* The initial response is not needed anymore */
+            msg_Dbg(access, "reading through %u connections", conns);
+            sys->content_type = vlc_http_file_get_type(sys->resource);
+            vlc_http_res_destroy(sys->resource);
+            sys->resource = NULL;
+
+            access->pf_block = ParallelRead;
+            access->pf_seek = ParallelSeek;
+            access->pf_control = ParallelControl;
+        }
+        else
+        {
+            access->pf_block = FileRead;
+            access->pf_seek = FileSeek;
+            access->pf_control = FileControl;
+        }
     }
     access->p_sys = sys;
     return VLC_SUCCESS;
@@ -275,8 +364,12 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
-    vlc_http_res_destroy(sys->resource);
+    if (sys->parallel != NULL)
+        vlc_http_parallel_destroy(sys->parallel);
+    if (sys->resource != NULL)
+        vlc_http_res_destroy(sys->resource);
     vlc_http_mgr_destroy(sys->manager);
+    free(sys->content_type);
     free(sys);
 }
 
@@ -292,6 +385,13 @@ vlc_module_begin()
     add_bool("http-continuous", false, N_("Continuous stream"),
              N_("Keep reading a resource that keeps being updated."))
         change_volatile()
+    add_integer("http-connections", 1, N_("Connections"),
+                N_("Number of connections to fetch seekable files through, "
+                   "each requesting chunks of the file ahead of the "
+                   "playback. Several connections can be faster on links "
+                   "with a high bandwidth and a long delay."))
+        change_integer_range(1, 16)
+        change_safe()
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."))
     add_string("http-referrer", NULL, N_("Referrer"),
@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <vlc_common.h>
 #include <vlc_network.h>
+#include <vlc_strings.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
 #include "transport.h"
@@ -96,6 +97,16 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/** Origin known to a shared manager */
+struct vlc_http_origin
+{
+    struct vlc_http_origin *next;
+    struct vlc_http_conn *conn; /**< HTTP/2 connection, or NULL */
+    bool h1; /**< server negotiated HTTP/1.x, connections cannot be shared */
+    unsigned port;
+    char host[];
+};
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
@@ -103,6 +114,10 @@ struct vlc_http_mgr
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    /* Shared managers only */
+    bool shared;
+    vlc_mutex_t lock;
+    struct vlc_http_origin *origins;
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -270,6 +285,176 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
     return resp;
 }
 
+static struct vlc_http_origin *vlc_http_origin_find(struct vlc_http_mgr *mgr,
+                                                   const char *host,
+                                                   unsigned port)
+{
+    for (struct vlc_http_origin *o = mgr->origins; o != NULL; o = o->next)
+        if (o->port == port && !vlc_ascii_strcasecmp(o->host, host))
+            return o;
+    return NULL;
+}
+
+static struct vlc_http_origin *vlc_http_origin_get(struct vlc_http_mgr *mgr,
+                                                  const char *host,
+                                                  unsigned port)
+{
+    struct vlc_http_origin *o = vlc_http_origin_find(mgr, host, port);
+    if (o != NULL)
+        return o;
+
+    size_t len = strlen(host) + 1;
+    o = malloc(sizeof (*o) + len);
+    if (unlikely(o == NULL))
+        return NULL;
+
+    o->conn = NULL;
+    o->h1 = false;
+    o->port = port;
+    memcpy(o->host, host, len);
+    o->next = mgr->origins;
+    mgr->origins = o;
+    return o;
+}
+
+/* Stops sharing a connection, unless it was already replaced. */
+static void vlc_http_origin_drop(struct vlc_http_mgr *mgr,
+                                 struct vlc_http_conn *conn)
+{
+    for (struct vlc_http_origin *o = mgr->origins; o != NULL; o = o->next)
+        if (o->conn == conn)
+        {
+            o->conn = NULL;
+            vlc_http_conn_release(conn);
+            break;
+        }
+}
+
+static
+struct vlc_http_msg *vlc_http_shared_reuse(struct vlc_http_mgr *mgr,
+                                           const char *host, unsigned port,
+                                           const struct vlc_http_msg *req,
+                                           bool payload)
+{
+    struct vlc_http_conn *conn = NULL;
+    struct vlc_http_stream *stream = NULL;
+
+    /* Streams are opened under the lock, so that the connection cannot be
+     * released in the mean time. Only the wait for the response is not. */
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_origin *o = vlc_http_origin_find(mgr, host, port);
+    if (o != NULL && o->conn != NULL)
+    {
+        conn = o->conn;
+        stream = vlc_http_stream_open(conn, req, payload);
+        if (stream == NULL)
+            vlc_http_origin_drop(mgr, conn);
+    }
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (stream == NULL)
+        return NULL;
+
+    struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+    if (m == NULL)
+    {   /* Get rid of closing or reset connection */
+        vlc_mutex_lock(&mgr->lock);
+        vlc_http_origin_drop(mgr, conn);
+        vlc_mutex_unlock(&mgr->lock);
+    }
+    return m;
+}
+
+static struct vlc_http_msg *vlc_http_shared_request(struct vlc_http_mgr *mgr,
+                                                    const char *host,
+                                                    unsigned port,
+                                                    const struct vlc_http_msg *req,
+                                                    bool idempotent,
+                                                    bool payload)
+{
+    vlc_tls_t *tls;
+    bool http2 = true;
+
+    if (port == 0)
+        port = 443;
+
+    if (idempotent)
+    {
+        struct vlc_http_msg *resp = vlc_http_shared_reuse(mgr, host, port, req,
+                                                          payload);
+        if (resp != NULL)
+            return resp; /* existing connection reused */
+    }
+
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->creds == NULL) /* First TLS connection: load x509 credentials */
+        mgr->creds = vlc_tls_ClientCreate(mgr->obj);
+    vlc_tls_client_t *creds = mgr->creds;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (creds == NULL)
+        return NULL;
+
+    char *proxy = vlc_http_proxy_find(host, port, true);
+    if (proxy != NULL)
+    {
+        tls = vlc_https_connect_proxy(creds, creds, host, port, &http2, proxy);
+        free(proxy);
+    }
+    else
+        tls = vlc_https_connect(creds, host, port, &http2);
+
+    if (tls == NULL)
+        return NULL;
+
+    struct vlc_http_conn *conn;
+
+    if (http2)
+        conn = vlc_h2_conn_create(mgr->logger, tls);
+    else
+        conn = vlc_h1_conn_create(mgr->logger, tls, false);
+
+    if (unlikely(conn == NULL))
+    {
+        vlc_tls_Close(tls);
+        return NULL;
+    }
+
+    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    if (stream == NULL)
+    {
+        vlc_http_conn_release(conn);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_origin *o = vlc_http_origin_get(mgr, host, port);
+    if (o != NULL)
+        o->h1 = !http2;
+    if (o != NULL && http2)
+    {   /* Publish the connection before the response is even received */
+        if (o->conn != NULL)
+            vlc_http_conn_release(o->conn);
+        o->conn = conn;
+    }
+    else
+    {   /* An HTTP/1.x connection carries only one request at a time: it is
+         * not kept, and gets closed once its response is read. */
+        vlc_http_conn_release(conn);
+        conn = NULL;
+    }
+    vlc_mutex_unlock(&mgr->lock);
+
+    struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
+    if (resp == NULL && conn != NULL)
+    {
+        vlc_mutex_lock(&mgr->lock);
+        vlc_http_origin_drop(mgr, conn);
+        vlc_mutex_unlock(&mgr->lock);
+    }
+    return resp;
+}
+
 struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
                                           const char *host, unsigned port,
                                           const struct vlc_http_msg *m,
@@ -278,10 +463,34 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     if (port && vlc_http_port_blocked(port))
         return NULL;
 
+    if (mgr->shared)
+    {
+        if (!https)
+            return NULL; /* HTTP/2 is only negotiated over TLS */
+        return vlc_http_shared_request(mgr, host, port, m, idempotent,
+                                       payload);
+    }
+
     return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
                                                           idempotent, payload);
 }
 
+bool vlc_http_mgr_can_multiplex(struct vlc_http_mgr *mgr, const char *host,
+                                unsigned port)
+{
+    if (!mgr->shared)
+        return false;
+
+    if (port == 0)
+        port = 443;
+
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_origin *o = vlc_http_origin_find(mgr, host, port);
+    bool ret = (o == NULL) || !o->h1;
+    vlc_mutex_unlock(&mgr->lock);
+    return ret;
+}
+
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
 {
     return mgr->jar;
@@ -299,6 +508,20 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->shared = false;
+    mgr->origins = NULL;
+    return mgr;
+}
+
+struct vlc_http_mgr *vlc_http_mgr_create_shared(vlc_object_t *obj,
+                                                struct vlc_http_cookie_jar_t *jar)
+{
+    struct vlc_http_mgr *mgr = vlc_http_mgr_create(obj, jar);
+    if (likely(mgr != NULL))
+    {
+        mgr->shared = true;
+        vlc_mutex_init(&mgr->lock);
+    }
     return mgr;
 }
 
@@ -306,6 +529,15 @@ void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
     if (mgr->conn != NULL)
         vlc_http_mgr_release(mgr, mgr->conn);
+    while (mgr->origins != NULL)
+    {
+        struct vlc_http_origin *o = mgr->origins;
+
+        mgr->origins = o->next;
+        if (o->conn != NULL)
+            vlc_http_conn_release(o->conn);
+        free(o);
+    }
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
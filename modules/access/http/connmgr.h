@@ -68,6 +68,35 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar);
 
+/**
+ * Creates a shared HTTP connection manager
+ *
+ * Allocates an HTTP client connections manager that can be used by several
+ * threads at the same time. HTTPS requests to a same server are multiplexed
+ * onto a single HTTP/2 connection, whichever thread issues them.
+ *
+ * Connections to servers that negotiate HTTP/1.x cannot carry concurrent
+ * requests, and are not kept. Unencrypted HTTP is not supported.
+ *
+ * @param obj parent VLC object
+ * @param jar HTTP cookies jar (NULL to disable cookies)
+ */
+struct vlc_http_mgr *vlc_http_mgr_create_shared(vlc_object_t *obj,
+                                                struct vlc_http_cookie_jar_t *jar);
+
+/**
+ * Checks whether requests to a server can be multiplexed
+ *
+ * @param mgr shared HTTP connection manager
+ * @param host name of the HTTPS server
+ * @param port TCP server port number, or 0 for the default port number
+ *
+ * @return false if the server is known to only speak HTTP/1.x, or if the
+ * manager is not shared, true otherwise.
+ */
+bool vlc_http_mgr_can_multiplex(struct vlc_http_mgr *mgr, const char *host,
+                                unsigned port);
+
 /**
  * Destroys an HTTP connection manager
  *
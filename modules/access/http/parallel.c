@@ -0,0 +1,535 @@
+/*****************************************************************************
+ * parallel.c: HTTP read-only file over parallel connections
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_interrupt.h>
+#include "message.h"
+#include "connmgr.h"
+#include "resource.h"
+#include "file.h"
+#include "parallel.h"
+
+#pragma GCC visibility push(default)
+
+/** Size of the chunks fetched by one request */
+#define VLC_HTTP_CHUNK_SIZE (4 << 20)
+/** Attempts to fetch a chunk */
+#define VLC_HTTP_CHUNK_TRIES 3
+
+struct vlc_http_chunk
+{
+    uintmax_t index; /**< chunk number from the base, or UINTMAX_MAX */
+    block_t *head;
+    block_t **tailp;
+    size_t skip; /**< bytes to drop before handing data out */
+    bool done;
+    bool error;
+};
+
+struct vlc_http_range
+{
+    struct vlc_http_resource resource;
+    const struct vlc_http_parallel *owner;
+    uintmax_t offset;
+    uintmax_t end;
+};
+
+struct vlc_http_worker
+{
+    struct vlc_http_parallel *owner;
+    struct vlc_http_mgr *manager;
+    struct vlc_http_range *range;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+};
+
+struct vlc_http_parallel
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data;
+    vlc_cond_t wait_work;
+    bool closing;
+    bool interrupted;
+
+    uintmax_t size;
+    uintmax_t base; /**< offset of the first chunk */
+    uintmax_t offset; /**< read offset */
+    uintmax_t read_index; /**< chunk being read */
+    uintmax_t fetch_index; /**< next chunk to fetch */
+    unsigned generation; /**< incremented whenever the chunks are dropped */
+
+    char *etag;
+    time_t mtime;
+
+    unsigned window;
+    struct vlc_http_chunk *chunks;
+    unsigned count;
+    struct vlc_http_worker workers[];
+};
+
+static int vlc_http_range_req(const struct vlc_http_resource *res,
+                              struct vlc_http_msg *req, void *opaque)
+{
+    const struct vlc_http_range *range = opaque;
+    const struct vlc_http_parallel *p = range->owner;
+
+    if (p->etag != NULL)
+        vlc_http_msg_add_header(req, "If-Match", "%s", p->etag);
+    else if (p->mtime != -1)
+        vlc_http_msg_add_time(req, "If-Unmodified-Since", &p->mtime);
+
+    (void) res;
+    return vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-%" PRIuMAX,
+                                   range->offset, range->end - 1);
+}
+
+static int vlc_http_range_resp(const struct vlc_http_resource *res,
+                               const struct vlc_http_msg *resp, void *opaque)
+{
+    const struct vlc_http_range *range = opaque;
+
+    /* Anything else than the requested range is useless here, including
+     * the whole file. */
+    if (vlc_http_msg_get_status(resp) != 206)
+        goto fail;
+
+    const char *str = vlc_http_msg_get_header(resp, "Content-Range");
+    uintmax_t start, end;
+
+    if (str == NULL
+     || sscanf(str, "bytes %" SCNuMAX "-%" SCNuMAX, &start, &end) != 2
+     || start != range->offset || start > end)
+        goto fail;
+
+    (void) res;
+    return 0;
+
+fail:
+    errno = EIO;
+    return -1;
+}
+
+static const struct vlc_http_resource_cbs vlc_http_range_callbacks =
+{
+    vlc_http_range_req,
+    vlc_http_range_resp,
+};
+
+static void vlc_http_chunk_clear(struct vlc_http_chunk *c)
+{
+    block_ChainRelease(c->head);
+    c->index = UINTMAX_MAX;
+    c->head = NULL;
+    c->tailp = &c->head;
+    c->skip = 0;
+    c->done = false;
+    c->error = false;
+}
+
+static bool vlc_http_chunk_stale(const struct vlc_http_parallel *p,
+                                 const struct vlc_http_chunk *c,
+                                 uintmax_t index, unsigned generation)
+{
+    return p->closing || p->generation != generation || c->index != index;
+}
+
+/**
+ * Fetches a chunk, with the lock held on entry and on return.
+ */
+static void vlc_http_worker_fetch(struct vlc_http_worker *w,
+                                  struct vlc_http_chunk *c, uintmax_t index)
+{
+    struct vlc_http_parallel *p = w->owner;
+    const unsigned generation = p->generation;
+    uintmax_t offset = p->base + index * VLC_HTTP_CHUNK_SIZE;
+    uintmax_t end = offset + VLC_HTTP_CHUNK_SIZE;
+    unsigned tries = 0;
+
+    if (end > p->size)
+        end = p->size;
+
+    while (offset < end)
+    {
+        if (tries++ >= VLC_HTTP_CHUNK_TRIES)
+            break;
+
+        vlc_mutex_unlock(&p->lock);
+
+        w->range->offset = offset;
+        w->range->end = end;
+
+        struct vlc_http_msg *resp = vlc_http_res_open(&w->range->resource,
+                                                      w->range);
+        bool stale = false;
+
+        while (resp != NULL && offset < end)
+        {
+            block_t *block = vlc_http_msg_read(resp);
+            if (block == NULL || block == vlc_http_error)
+                break;
+
+            if (block->i_buffer > end - offset)
+                block->i_buffer = end - offset;
+            block->p_next = NULL;
+
+            vlc_mutex_lock(&p->lock);
+            stale = vlc_http_chunk_stale(p, c, index, generation);
+            if (!stale)
+            {
+                *c->tailp = block;
+                c->tailp = &block->p_next;
+                offset += block->i_buffer;
+                vlc_cond_signal(&p->wait_data);
+            }
+            vlc_mutex_unlock(&p->lock);
+
+            if (stale)
+            {
+                block_Release(block);
+                break;
+            }
+        }
+
+        if (resp != NULL)
+            vlc_http_msg_destroy(resp);
+
+        vlc_mutex_lock(&p->lock);
+        if (stale || vlc_http_chunk_stale(p, c, index, generation))
+            return;
+    }
+
+    if (offset >= end)
+        c->done = true;
+    else
+        c->error = true;
+    vlc_cond_signal(&p->wait_data);
+}
+
+static void *vlc_http_worker_thread(void *data)
+{
+    struct vlc_http_worker *w = data;
+    struct vlc_http_parallel *p = w->owner;
+
+    vlc_interrupt_set(w->interrupt);
+
+    vlc_mutex_lock(&p->lock);
+    while (!p->closing)
+    {
+        uintmax_t index = p->fetch_index;
+
+        if (p->base >= p->size
+         || index >= (p->size - p->base + VLC_HTTP_CHUNK_SIZE - 1)
+                     / VLC_HTTP_CHUNK_SIZE
+         || index >= p->read_index + p->window)
+        {   /* Nothing to fetch (yet) */
+            vlc_cond_wait(&p->wait_work, &p->lock);
+            continue;
+        }
+
+        struct vlc_http_chunk *c = &p->chunks[index % p->window];
+
+        /* The previous chunk in this slot was read, or dropped. */
+        vlc_http_chunk_clear(c);
+        c->index = index;
+        p->fetch_index++;
+
+        vlc_http_worker_fetch(w, c, index);
+    }
+    vlc_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static int vlc_http_worker_init(struct vlc_http_worker *w,
+                                struct vlc_http_parallel *p, vlc_object_t *obj,
+                                struct vlc_http_cookie_jar_t *jar,
+                                const struct vlc_http_resource *file,
+                                const char *url)
+{
+    w->owner = p;
+    w->manager = vlc_http_mgr_create(obj, jar);
+    if (w->manager == NULL)
+        return -1;
+
+    w->range = malloc(sizeof (*w->range));
+    if (unlikely(w->range == NULL))
+        goto error;
+
+    if (vlc_http_res_init(&w->range->resource, &vlc_http_range_callbacks,
+                          w->manager, url, file->agent, file->referrer))
+    {
+        free(w->range);
+        goto error;
+    }
+
+    w->range->owner = p;
+    if (file->username != NULL)
+        vlc_http_res_set_login(&w->range->resource, file->username,
+                               file->password);
+
+    w->interrupt = vlc_interrupt_create();
+    if (unlikely(w->interrupt == NULL))
+        goto error_res;
+
+    if (vlc_clone(&w->thread, vlc_http_worker_thread, w,
+                  VLC_THREAD_PRIORITY_INPUT))
+    {
+        vlc_interrupt_destroy(w->interrupt);
+        goto error_res;
+    }
+    return 0;
+
+error_res:
+    vlc_http_res_destroy(&w->range->resource);
+error:
+    vlc_http_mgr_destroy(w->manager);
+    return -1;
+}
+
+static void vlc_http_worker_deinit(struct vlc_http_worker *w)
+{
+    vlc_interrupt_kill(w->interrupt);
+    vlc_join(w->thread, NULL);
+    vlc_interrupt_destroy(w->interrupt);
+    vlc_http_res_destroy(&w->range->resource);
+    vlc_http_mgr_destroy(w->manager);
+}
+
+static void vlc_http_parallel_stop(struct vlc_http_parallel *p)
+{
+    vlc_mutex_lock(&p->lock);
+    p->closing = true;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+
+    for (unsigned i = 0; i < p->count; i++)
+        vlc_http_worker_deinit(&p->workers[i]);
+
+    for (unsigned i = 0; i < p->window; i++)
+        vlc_http_chunk_clear(&p->chunks[i]);
+    free(p->chunks);
+    free(p->etag);
+    free(p);
+}
+
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+                                          struct vlc_http_cookie_jar_t *jar,
+                                          struct vlc_http_resource *file,
+                                          unsigned conns)
+{
+    assert(conns > 0);
+
+    uintmax_t size = vlc_http_file_get_size(file);
+    if (size == (uintmax_t)-1 || !vlc_http_file_can_seek(file))
+        return NULL;
+
+    struct vlc_http_parallel *p = malloc(sizeof (*p)
+                                         + conns * sizeof (p->workers[0]));
+    if (unlikely(p == NULL))
+        return NULL;
+
+    vlc_mutex_init(&p->lock);
+    vlc_cond_init(&p->wait_data);
+    vlc_cond_init(&p->wait_work);
+    p->closing = false;
+    p->interrupted = false;
+    p->size = size;
+    p->base = 0;
+    p->offset = 0;
+    p->read_index = 0;
+    p->fetch_index = 0;
+    p->generation = 0;
+    p->count = 0;
+
+    /* Same validators as vlc_http_file_req() */
+    const char *str = vlc_http_msg_get_header(file->response, "ETag");
+    if (str != NULL && !memcmp(str, "W/", 2))
+        str += 2; /* skip weak mark */
+    p->etag = (str != NULL) ? strdup(str) : NULL;
+    p->mtime = vlc_http_msg_get_mtime(file->response);
+
+    /* Room for every connection to fetch one chunk while the chunk being
+     * read completes */
+    p->window = 2 * conns;
+    p->chunks = malloc(p->window * sizeof (*p->chunks));
+    if (unlikely(p->chunks == NULL))
+    {
+        p->window = 0;
+        goto error;
+    }
+
+    for (unsigned i = 0; i < p->window; i++)
+    {
+        p->chunks[i].head = NULL;
+        vlc_http_chunk_clear(&p->chunks[i]);
+    }
+
+    char *url;
+    if (unlikely(asprintf(&url, "http%s://%s%s", file->secure ? "s" : "",
+                          file->authority, file->path) == -1))
+        goto error;
+
+    while (p->count < conns
+        && vlc_http_worker_init(&p->workers[p->count], p, obj, jar, file,
+                                url) == 0)
+        p->count++;
+    free(url);
+
+    if (p->count == 0)
+        goto error;
+    return p;
+
+error:
+    vlc_http_parallel_stop(p);
+    return NULL;
+}
+
+void vlc_http_parallel_destroy(struct vlc_http_parallel *p)
+{
+    vlc_http_parallel_stop(p);
+}
+
+uintmax_t vlc_http_parallel_get_size(struct vlc_http_parallel *p)
+{
+    return p->size;
+}
+
+int vlc_http_parallel_seek(struct vlc_http_parallel *p, uintmax_t offset)
+{
+    vlc_mutex_lock(&p->lock);
+
+    if (offset >= p->offset && offset >= p->base
+     && (offset - p->base) / VLC_HTTP_CHUNK_SIZE < p->fetch_index)
+    {   /* Seeking forward within the fetched chunks */
+        uintmax_t index = (offset - p->base) / VLC_HTTP_CHUNK_SIZE;
+        struct vlc_http_chunk *c;
+
+        while (p->read_index < index)
+            vlc_http_chunk_clear(&p->chunks[p->read_index++ % p->window]);
+
+        c = &p->chunks[index % p->window];
+        if (p->offset >= p->base + index * VLC_HTTP_CHUNK_SIZE)
+            c->skip += offset - p->offset;
+        else
+            c->skip = offset - (p->base + index * VLC_HTTP_CHUNK_SIZE);
+    }
+    else
+    {   /* Drop everything, and start over from the new offset */
+        for (unsigned i = 0; i < p->window; i++)
+            vlc_http_chunk_clear(&p->chunks[i]);
+
+        p->base = offset;
+        p->read_index = 0;
+        p->fetch_index = 0;
+        p->generation++;
+
+        /* Abort the fetches in progress */
+        for (unsigned i = 0; i < p->count; i++)
+            vlc_interrupt_raise(p->workers[i].interrupt);
+    }
+
+    p->offset = offset;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+    return 0;
+}
+
+static void vlc_http_parallel_wake_up(void *data)
+{
+    struct vlc_http_parallel *p = data;
+
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = true;
+    vlc_cond_signal(&p->wait_data);
+    vlc_mutex_unlock(&p->lock);
+}
+
+block_t *vlc_http_parallel_read(struct vlc_http_parallel *p)
+{
+    block_t *block = NULL;
+
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = false;
+    vlc_mutex_unlock(&p->lock);
+
+    /* A pending interruption invokes the callback right away */
+    vlc_interrupt_register(vlc_http_parallel_wake_up, p);
+    vlc_mutex_lock(&p->lock);
+
+    while (block == NULL && !p->interrupted)
+    {
+        if (p->offset >= p->size)
+            break; /* end of file */
+
+        struct vlc_http_chunk *c = &p->chunks[p->read_index % p->window];
+
+        if (c->index == p->read_index && c->head != NULL)
+        {
+            block = c->head;
+            c->head = block->p_next;
+            if (c->head == NULL)
+                c->tailp = &c->head;
+            block->p_next = NULL;
+
+            if (c->skip >= block->i_buffer)
+            {   /* Skipped over by a seek */
+                c->skip -= block->i_buffer;
+                block_Release(block);
+                block = NULL;
+                continue;
+            }
+
+            block->p_buffer += c->skip;
+            block->i_buffer -= c->skip;
+            c->skip = 0;
+            p->offset += block->i_buffer;
+            break;
+        }
+
+        if (c->index == p->read_index && c->done)
+        {   /* Next chunk, and make room for another fetch */
+            vlc_http_chunk_clear(c);
+            p->read_index++;
+            vlc_cond_broadcast(&p->wait_work);
+            continue;
+        }
+
+        if (c->index == p->read_index && c->error)
+            break;
+
+        vlc_cond_wait(&p->wait_data, &p->lock);
+    }
+
+    vlc_mutex_unlock(&p->lock);
+    vlc_interrupt_unregister();
+    return block;
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * parallel.h: HTTP read-only file over parallel connections
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include <stdint.h>
+
+/**
+ * \defgroup http_parallel Parallel files
+ * HTTP read-only files fetched over parallel connections
+ * \ingroup http_res
+ * @{
+ */
+
+struct vlc_http_parallel;
+struct vlc_http_resource;
+struct vlc_http_cookie_jar_t;
+struct block_t;
+
+/**
+ * Creates a parallel HTTP file reader.
+ *
+ * Reads a file through several connections of their own, each fetching one
+ * chunk of the file at a time with a bounded range request. Chunks ahead of
+ * the read offset are fetched concurrently, and handed out in order.
+ *
+ * The requests are conditional on the current response of the given file,
+ * so that all chunks come from the same version of the file.
+ *
+ * @param obj parent VLC object (for the connection managers)
+ * @param jar HTTP cookies jar (or NULL to disable cookies)
+ * @param file opened and seekable HTTP file, for its URL, credentials and
+ *             size; it is not used afterward and may be destroyed
+ * @param conns number of connections
+ *
+ * @return a parallel reader, or NULL on error
+ */
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+                                          struct vlc_http_cookie_jar_t *jar,
+                                          struct vlc_http_resource *file,
+                                          unsigned conns);
+
+void vlc_http_parallel_destroy(struct vlc_http_parallel *);
+
+/**
+ * Gets file size.
+ *
+ * @return Bytes count (as determined when creating the reader).
+ */
+uintmax_t vlc_http_parallel_get_size(struct vlc_http_parallel *);
+
+/**
+ * Sets the read offset.
+ *
+ * Forward seeks within the fetched or being fetched data keep that data.
+ *
+ * @retval 0 always (reading beyond the end of the file yields end-of-file)
+ */
+int vlc_http_parallel_seek(struct vlc_http_parallel *, uintmax_t offset);
+
+/**
+ * Reads data.
+ *
+ * Waits for the data at the read offset, and updates the offset.
+ *
+ * @return a block of data, or NULL on end-of-file or error
+ */
+struct block_t *vlc_http_parallel_read(struct vlc_http_parallel *);
+
+/** @} */
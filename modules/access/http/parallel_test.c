@@ -0,0 +1,267 @@
+/*****************************************************************************
+ * parallel_test.c: HTTP parallel file reader test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "resource.h"
+#include "file.h"
+#include "parallel.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_parallel";
+
+static const char url[] = "https://www.example.com:8443/dir/file.ext?a=b";
+static const char ua[] = PACKAGE_NAME "/" PACKAGE_VERSION " (test suite)";
+
+/* Not a multiple of the chunk size */
+#define FILE_SIZE ((22 << 20) + 12345)
+
+static atomic_uint requests;
+
+static uint8_t file_byte(uintmax_t offset)
+{
+    return (offset * 7) ^ (offset >> 11);
+}
+
+static void check_read(struct vlc_http_parallel *p, uintmax_t offset,
+                       size_t length)
+{
+    while (length > 0)
+    {
+        block_t *block = vlc_http_parallel_read(p);
+        assert(block != NULL);
+        assert(block->i_buffer > 0);
+
+        for (size_t i = 0; i < block->i_buffer && length > 0; i++)
+        {
+            assert(block->p_buffer[i] == file_byte(offset));
+            offset++;
+            length--;
+        }
+        block_Release(block);
+    }
+}
+
+static void check_eof(struct vlc_http_parallel *p, uintmax_t offset)
+{
+    block_t *block;
+
+    while ((block = vlc_http_parallel_read(p)) != NULL)
+    {
+        for (size_t i = 0; i < block->i_buffer; i++)
+            assert(block->p_buffer[i] == file_byte(offset++));
+        block_Release(block);
+    }
+    assert(offset == FILE_SIZE);
+}
+
+int main(void)
+{
+    struct vlc_http_resource *f;
+    struct vlc_http_parallel *p;
+
+    f = vlc_http_file_create(NULL, url, ua, NULL);
+    assert(f != NULL);
+    assert(vlc_http_file_get_status(f) == 206);
+    assert(vlc_http_file_get_size(f) == FILE_SIZE);
+
+    /* Sequential read */
+    p = vlc_http_parallel_create(NULL, NULL, f, 4);
+    assert(p != NULL);
+    assert(vlc_http_parallel_get_size(p) == FILE_SIZE);
+    check_eof(p, 0);
+
+    /* Seeks */
+    assert(vlc_http_parallel_seek(p, 12345) == 0);
+    check_read(p, 12345, 100000);
+    /* forward within the current chunk */
+    assert(vlc_http_parallel_seek(p, 300000) == 0);
+    check_read(p, 300000, 5000);
+    /* forward to a later chunk */
+    assert(vlc_http_parallel_seek(p, (9 << 20) + 17) == 0);
+    check_read(p, (9 << 20) + 17, 3 << 20);
+    /* backward */
+    assert(vlc_http_parallel_seek(p, 4242) == 0);
+    check_read(p, 4242, 1 << 20);
+    /* near the end */
+    assert(vlc_http_parallel_seek(p, FILE_SIZE - 1000) == 0);
+    check_eof(p, FILE_SIZE - 1000);
+    /* beyond the end */
+    assert(vlc_http_parallel_seek(p, FILE_SIZE + 1) == 0);
+    assert(vlc_http_parallel_read(p) == NULL);
+    vlc_http_parallel_destroy(p);
+
+    /* Destruction while fetching */
+    unsigned before = atomic_load(&requests);
+    p = vlc_http_parallel_create(NULL, NULL, f, 3);
+    assert(p != NULL);
+    check_read(p, 0, 1000);
+    vlc_http_parallel_destroy(p);
+    assert(atomic_load(&requests) > before);
+
+    vlc_http_file_destroy(f);
+    return 0;
+}
+
+/* Callback for vlc_http_msg_h2_frame */
+#include "h2frame.h"
+
+struct vlc_h2_frame *
+vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
+                     unsigned count, const char *const tab[][2])
+{
+    (void) id; (void) mtu; (void) count, (void) tab;
+    assert(!eos);
+    return NULL;
+}
+
+/* Callback for the HTTP request */
+#include "connmgr.h"
+
+struct test_stream
+{
+    struct vlc_http_stream stream;
+    uintmax_t offset;
+    uintmax_t end;
+};
+
+static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+    char *answer;
+
+    assert(asprintf(&answer, "HTTP/1.1 206 Partial Content\r\n"
+                    "Content-Range: bytes %ju-%ju/%ju\r\n"
+                    "Content-Length: %ju\r\n"
+                    "ETag: \"foobar42\"\r\n\r\n", ts->offset, ts->end - 1,
+                    (uintmax_t)FILE_SIZE, ts->end - ts->offset) >= 0);
+
+    struct vlc_http_msg *m = vlc_http_msg_headers(answer);
+    assert(m != NULL);
+    free(answer);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static struct block_t *stream_read(struct vlc_http_stream *s)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+    size_t length = 1 + rand() % 65536;
+
+    if (ts->offset >= ts->end)
+        return NULL;
+    if (length > ts->end - ts->offset)
+        length = ts->end - ts->offset;
+
+    block_t *block = block_Alloc(length);
+    assert(block != NULL);
+    for (size_t i = 0; i < length; i++)
+        block->p_buffer[i] = file_byte(ts->offset++);
+    return block;
+}
+
+static void stream_close(struct vlc_http_stream *s, bool abort)
+{
+    free(container_of(s, struct test_stream, stream));
+    (void) abort;
+}
+
+static const struct vlc_http_stream_cbs stream_callbacks =
+{
+    stream_read_headers,
+    NULL,
+    stream_read,
+    stream_close,
+};
+
+struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
+                                          const char *host, unsigned port,
+                                          const struct vlc_http_msg *req,
+                                          bool idempotent, bool payload)
+{
+    const char *str;
+    char *end;
+
+    assert(https);
+    assert(!strcmp(host, "www.example.com"));
+    assert(port == 8443);
+    assert(idempotent);
+    assert(!payload);
+    (void) mgr;
+
+    str = vlc_http_msg_get_path(req);
+    assert(!strcmp(str, "/dir/file.ext?a=b"));
+    str = vlc_http_msg_get_agent(req);
+    assert(!strcmp(str, ua));
+
+    struct test_stream *ts = malloc(sizeof (*ts));
+    assert(ts != NULL);
+    ts->stream.cbs = &stream_callbacks;
+
+    str = vlc_http_msg_get_header(req, "Range");
+    assert(str != NULL && !strncmp(str, "bytes=", 6));
+    ts->offset = strtoumax(str + 6, &end, 10);
+    assert(*end == '-');
+    if (end[1] != '\0')
+    {   /* Chunk request, conditional on the initial response */
+        ts->end = strtoumax(end + 1, &end, 10) + 1;
+        assert(*end == '\0');
+        assert(ts->end - ts->offset <= (4 << 20));
+        str = vlc_http_msg_get_header(req, "If-Match");
+        assert(str != NULL && !strcmp(str, "\"foobar42\""));
+    }
+    else
+        ts->end = FILE_SIZE;
+
+    assert(ts->offset < ts->end && ts->end <= FILE_SIZE);
+    atomic_fetch_add(&requests, 1);
+    return vlc_http_msg_get_initial(&ts->stream);
+}
+
+struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
+                                         struct vlc_http_cookie_jar_t *jar)
+{
+    (void) obj;
+    assert(jar == NULL);
+    return malloc(1);
+}
+
+void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
+{
+    free(mgr);
+}
+
+struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
+{
+    (void) mgr;
+    return NULL;
+}
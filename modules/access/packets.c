@@ -0,0 +1,192 @@
+/*****************************************************************************
+ * packets.c: elementary stream packets input from the LibVLC application
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_plugin.h>
+#include <vlc_vector.h>
+
+/* NOTE: the values and the prototype must match those of LibVLC */
+enum
+{
+    PACKETS_ES_ADD,
+    PACKETS_ES_DEL,
+    PACKETS_SEND,
+    PACKETS_END,
+};
+
+typedef int (*vlc_packets_pop_cb)(void *, const es_format_t **, void **,
+                                  block_t **);
+
+struct packets_es
+{
+    void *key;
+    es_out_id_t *id;
+};
+
+typedef struct
+{
+    vlc_packets_pop_cb pop;
+    void *source;
+    struct VLC_VECTOR(struct packets_es) es;
+    vlc_tick_t pcr;
+} demux_sys_t;
+
+static size_t FindES(demux_sys_t *sys, const void *key)
+{
+    for (size_t i = 0; i < sys->es.size; i++)
+        if (sys->es.data[i].key == key)
+            return i;
+    return SIZE_MAX;
+}
+
+static int Demux(demux_t *demux)
+{
+    demux_sys_t *sys = demux->p_sys;
+    const es_format_t *fmt;
+    void *key;
+    block_t *block;
+    size_t idx;
+
+    /* Blocks until the application queues something, or the input stops */
+    switch (sys->pop(sys->source, &fmt, &key, &block))
+    {
+        case PACKETS_ES_ADD:
+        {
+            struct packets_es es = { key, es_out_Add(demux->out, fmt) };
+
+            if (es.id == NULL)
+                msg_Warn(demux, "cannot add %4.4s elementary stream",
+                         (const char *)&fmt->i_codec);
+            else if (!vlc_vector_push(&sys->es, es))
+                es_out_Del(demux->out, es.id);
+            break;
+        }
+
+        case PACKETS_ES_DEL:
+            idx = FindES(sys, key);
+            if (idx != SIZE_MAX)
+            {
+                es_out_Del(demux->out, sys->es.data[idx].id);
+                vlc_vector_remove(&sys->es, idx);
+            }
+            break;
+
+        case PACKETS_SEND:
+            if (block == NULL)
+                break;
+
+            idx = FindES(sys, key);
+            if (idx == SIZE_MAX)
+            {
+                block_Release(block);
+                break;
+            }
+
+            vlc_tick_t ts = block->i_dts != VLC_TICK_INVALID ? block->i_dts
+                                                            : block->i_pts;
+            if (ts != VLC_TICK_INVALID && ts > sys->pcr)
+            {
+                sys->pcr = ts;
+                es_out_SetPCR(demux->out, ts);
+            }
+            es_out_Send(demux->out, sys->es.data[idx].id, block);
+            break;
+
+        default: /* end of stream or interrupted */
+            return VLC_DEMUXER_EOF;
+    }
+    return VLC_DEMUXER_SUCCESS;
+}
+
+static int Control(demux_t *demux, int query, va_list args)
+{
+    demux_sys_t *sys = demux->p_sys;
+
+    switch (query)
+    {
+        case DEMUX_CAN_SEEK:
+        case DEMUX_CAN_PAUSE:
+        case DEMUX_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+
+        case DEMUX_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) =
+                VLC_TICK_FROM_MS(var_InheritInteger(demux, "live-caching"));
+            return VLC_SUCCESS;
+
+        case DEMUX_GET_TIME:
+            if (sys->pcr == VLC_TICK_INVALID)
+                return VLC_EGENERIC;
+            *va_arg(args, vlc_tick_t *) = sys->pcr;
+            return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+
+    if (demux->out == NULL)
+        return VLC_EGENERIC;
+
+    demux_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->pop = var_InheritAddress(demux, "packets-pop");
+    sys->source = var_InheritAddress(demux, "packets-source");
+    if (sys->pop == NULL || sys->source == NULL)
+        return VLC_EGENERIC;
+
+    vlc_vector_init(&sys->es);
+    sys->pcr = VLC_TICK_INVALID;
+
+    demux->p_sys = sys;
+    demux->pf_demux = Demux;
+    demux->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+    demux_sys_t *sys = demux->p_sys;
+
+    for (size_t i = 0; i < sys->es.size; i++)
+        es_out_Del(demux->out, sys->es.data[i].id);
+    vlc_vector_destroy(&sys->es);
+}
+
+vlc_module_begin()
+    set_shortname(N_("Packets"))
+    set_description(N_("Elementary stream packets from LibVLC"))
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_ACCESS)
+    set_capability("access", 0)
+    add_shortcut("packets")
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -44,6 +44,21 @@ static const char *const nack_type_names[] = {
     N_("Range"), N_("Bitmask"),
 };
 
+#define RIST_MAX_SLAB_SIZE (512 << 20)
+
+/* Preallocated ring of received payloads, each preceded by a header */
+struct rist_slab_hdr
+{
+    uint32_t len;
+    uint32_t flags;
+};
+
+#define RIST_SLAB_PAD   0x80000000 /* skip to the start of the ring */
+#define RIST_SLAB_ALIGN sizeof (struct rist_slab_hdr)
+#define RIST_SLAB_RECORD(len) \
+    (sizeof (struct rist_slab_hdr) \
+     + (((len) + RIST_SLAB_ALIGN - 1) & ~(RIST_SLAB_ALIGN - 1)))
+
 typedef struct
 {
     struct       rist_ctx *receiver_ctx;
@@ -55,7 +70,17 @@ typedef struct
     int          i_maximum_jitter;
     struct       rist_logging_settings logging_settings;
     vlc_mutex_t  lock;
-    struct       rist_data_block *rist_items[RIST_MAX_QUEUE_BUFFERS];
+
+    /* Receive buffer, filled by the libRIST receiver thread
+     * (protected by lock) */
+    vlc_cond_t   wait;
+    uint8_t      *slab;
+    size_t       slab_size;
+    size_t       slab_head;
+    size_t       slab_tail;
+    size_t       slab_used;
+    uint32_t     slab_overflows;
+    bool         slab_discontinuity;
 } stream_sys_t;
 
 static int cb_stats(void *arg, const struct rist_stats *stats_container)
@@ -68,6 +93,7 @@ static int cb_stats(void *arg, const struct rist_stats *stats_container)
     const struct rist_stats_receiver_flow *stats_receiver_flow = &stats_container->stats.receiver_flow;
 
     p_sys->cumulative_loss += stats_receiver_flow->lost;
+    var_SetString(p_access, "rist-stats", stats_container->stats_json);
     msg_Dbg(p_access, "[RIST-STATS]: received %"PRIu64", missing %"PRIu32", reordered %"PRIu32", recovered %"PRIu32", lost %"PRIu32", Q %.2f, max jitter (us) %"PRIu64", rtt %"PRIu32"ms, cumulative loss %"PRIu32"", 
     stats_receiver_flow->received,
     stats_receiver_flow->missing,
@@ -94,6 +120,12 @@ static int cb_stats(void *arg, const struct rist_stats *stats_container)
 
 
     vlc_mutex_lock( &p_sys->lock );
+    if (p_sys->slab_overflows > 0) {
+        msg_Warn(p_access, "Receive buffer overflow, %"PRIu32" packets dropped (%zu/%zu bytes used), "
+            "you should increase the receive buffer size", p_sys->slab_overflows,
+            p_sys->slab_used, p_sys->slab_size);
+        p_sys->slab_overflows = 0;
+    }
     /* Trigger the appropriate response when there is no more data */
     /* status of 1 is no data for one buffer length */
     /* status of 2 is no data for 60 seconds, i.e. session timeout */
@@ -129,80 +161,138 @@ static int Control(stream_t *p_access, int i_query, va_list args)
     return VLC_SUCCESS;
 }
 
-static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
+/* Called by the libRIST receiver thread for each packet, in order */
+static int cb_data(void *arg, struct rist_data_block *rist_buffer)
 {
+    stream_t *p_access = (stream_t*)arg;
     stream_sys_t *p_sys = p_access->p_sys;
-    block_t *pktout = NULL;
-    struct rist_data_block *rist_buffer = NULL;
-    size_t i_total_size, i_rist_items_index;
-    int i_flags, ret;
-    *eof = false;
-    i_rist_items_index = i_flags = i_total_size = 0;
-    int i_read_timeout_ms = p_sys->i_maximum_jitter;
 
-    while ((ret = rist_receiver_data_read2(p_sys->receiver_ctx, &rist_buffer, i_read_timeout_ms)) > 0)
-    {
-        if (p_sys->gre_filter_dst_port > 0 && rist_buffer->virt_dst_port != p_sys->gre_filter_dst_port) {
-            rist_receiver_data_block_free2(&rist_buffer);
-            continue;
-        }
-        i_read_timeout_ms = 0;
-
-        p_sys->rist_items[i_rist_items_index++] = rist_buffer;
-        i_total_size += rist_buffer->payload_len;
-        vlc_mutex_lock( &p_sys->lock );
-        if (p_sys->flow_id != rist_buffer->flow_id ||
-            rist_buffer->flags == RIST_DATA_FLAGS_DISCONTINUITY ||
-            rist_buffer->flags == RIST_DATA_FLAGS_FLOW_BUFFER_START) {
-            if (p_sys->flow_id != rist_buffer->flow_id) {
-                msg_Info(p_access, "New flow detected with id %"PRIu32"", rist_buffer->flow_id);
-                p_sys->flow_id = rist_buffer->flow_id;
-            }
-            i_flags = BLOCK_FLAG_DISCONTINUITY;
-            vlc_mutex_unlock( &p_sys->lock );
-            break;
+    if (p_sys->gre_filter_dst_port > 0 && rist_buffer->virt_dst_port != p_sys->gre_filter_dst_port) {
+        rist_receiver_data_block_free2(&rist_buffer);
+        return 0;
+    }
+
+    size_t len = __MIN(rist_buffer->payload_len, RIST_MAX_PACKET_SIZE);
+    size_t need = RIST_SLAB_RECORD(len);
+
+    vlc_mutex_lock( &p_sys->lock );
+    uint32_t flags = 0;
+    if (p_sys->flow_id != rist_buffer->flow_id ||
+        rist_buffer->flags == RIST_DATA_FLAGS_DISCONTINUITY ||
+        rist_buffer->flags == RIST_DATA_FLAGS_FLOW_BUFFER_START) {
+        if (p_sys->flow_id != rist_buffer->flow_id) {
+            msg_Info(p_access, "New flow detected with id %"PRIu32"", rist_buffer->flow_id);
+            p_sys->flow_id = rist_buffer->flow_id;
         }
-        vlc_mutex_unlock( &p_sys->lock );
-        // Make sure we never read more than our array size
-        if (i_rist_items_index == (RIST_MAX_QUEUE_BUFFERS -1))
-            break;
+        flags = BLOCK_FLAG_DISCONTINUITY;
     }
 
-    if (ret > 50)
-        msg_Dbg(p_access, "Falling behind reading rist buffer by %d packets", ret);
+    /* Records do not wrap around: skip the end of the ring if too small */
+    size_t pad = p_sys->slab_size - p_sys->slab_tail;
+    if (pad >= need)
+        pad = 0;
 
-    if (ret < 0) {
-        msg_Err(p_access, "Unrecoverable error %i while reading from rist, ending stream", ret);
-        *eof = true;
-        goto failed_cleanup;
+    if (p_sys->slab_used + pad + need > p_sys->slab_size) {
+        p_sys->slab_overflows++;
+        p_sys->slab_discontinuity = true;
+        vlc_mutex_unlock( &p_sys->lock );
+        rist_receiver_data_block_free2(&rist_buffer);
+        return 0;
     }
 
-    if (i_total_size == 0) {
-        return NULL;
+    if (pad > 0) {
+        struct rist_slab_hdr *hdr = (void *)(p_sys->slab + p_sys->slab_tail);
+        hdr->len = 0;
+        hdr->flags = RIST_SLAB_PAD;
+        p_sys->slab_used += pad;
+        p_sys->slab_tail = 0;
     }
 
-    // Prepare one large buffer (when we are behing in reading, otherwise it is the same size as what is being read)
-    pktout = block_Alloc(i_total_size);
-    if ( unlikely(pktout == NULL) ) {
-        goto failed_cleanup;
+    if (p_sys->slab_discontinuity) {
+        flags = BLOCK_FLAG_DISCONTINUITY;
+        p_sys->slab_discontinuity = false;
     }
 
-    size_t block_offset = 0;
-    for(size_t i = 0; i < i_rist_items_index; ++i) {
-        memcpy(pktout->p_buffer + block_offset,  p_sys->rist_items[i]->payload,  p_sys->rist_items[i]->payload_len);
-        block_offset +=  p_sys->rist_items[i]->payload_len;
-        rist_receiver_data_block_free2(& p_sys->rist_items[i]);
+    struct rist_slab_hdr *hdr = (void *)(p_sys->slab + p_sys->slab_tail);
+    hdr->len = len;
+    hdr->flags = flags;
+    memcpy(hdr + 1, rist_buffer->payload, len);
+    p_sys->slab_tail += need;
+    if (p_sys->slab_tail == p_sys->slab_size)
+        p_sys->slab_tail = 0;
+    p_sys->slab_used += need;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    rist_receiver_data_block_free2(&rist_buffer);
+    return 0;
+}
+
+static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+    *eof = false;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if (p_sys->slab_used == 0)
+        vlc_cond_timedwait( &p_sys->wait, &p_sys->lock,
+                            vlc_tick_now() + VLC_TICK_FROM_MS(p_sys->i_maximum_jitter) );
+
+    /* Gather the records received so far, up to the next discontinuity.
+     * Only this thread consumes them, so they are copied without the lock:
+     * the receiver thread only writes to the free part of the ring. */
+    size_t head = p_sys->slab_head, used = p_sys->slab_used;
+    vlc_mutex_unlock( &p_sys->lock );
+
+    size_t i_total_size = 0, consumed = 0, pos = head;
+    int i_flags = 0;
+    while (consumed < used) {
+        const struct rist_slab_hdr *hdr = (const void *)(p_sys->slab + pos);
+        if (hdr->flags & RIST_SLAB_PAD) {
+            consumed += p_sys->slab_size - pos;
+            pos = 0;
+            continue;
+        }
+        if (hdr->flags & BLOCK_FLAG_DISCONTINUITY) {
+            if (i_total_size > 0)
+                break;
+            i_flags = BLOCK_FLAG_DISCONTINUITY;
+        }
+        i_total_size += hdr->len;
+        consumed += RIST_SLAB_RECORD(hdr->len);
+        pos = (pos + RIST_SLAB_RECORD(hdr->len)) % p_sys->slab_size;
     }
-    pktout->i_flags = i_flags;
-    return pktout;
 
-failed_cleanup:
-    if (i_total_size > 0) {
-        for (size_t i = 0; i < i_rist_items_index; i++) {
-            rist_receiver_data_block_free2(&p_sys->rist_items[i]);
+    if (consumed > p_sys->slab_size / 2)
+        msg_Dbg(p_access, "Falling behind reading rist buffer by %zu bytes", consumed);
+
+    if (consumed == 0)
+        return NULL;
+
+    // Prepare one large buffer (when we are behind in reading, otherwise it is the same size as what is being read)
+    block_t *pktout = NULL;
+    if (i_total_size > 0)
+        pktout = block_Alloc(i_total_size);
+    if (pktout != NULL) {
+        size_t block_offset = 0;
+        for (pos = head; block_offset < i_total_size; ) {
+            const struct rist_slab_hdr *hdr = (const void *)(p_sys->slab + pos);
+            if (hdr->flags & RIST_SLAB_PAD) {
+                pos = 0;
+                continue;
+            }
+            memcpy(pktout->p_buffer + block_offset, hdr + 1, hdr->len);
+            block_offset += hdr->len;
+            pos = (pos + RIST_SLAB_RECORD(hdr->len)) % p_sys->slab_size;
         }
+        pktout->i_flags = i_flags;
     }
-    return NULL;
+
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->slab_head = (head + consumed) % p_sys->slab_size;
+    p_sys->slab_used -= consumed;
+    vlc_mutex_unlock( &p_sys->lock );
+    return pktout;
 }
 
 
@@ -211,6 +301,7 @@ static void Close(vlc_object_t *p_this)
     stream_t *p_access = (stream_t*)p_this;
     stream_sys_t *p_sys = p_access->p_sys;
     rist_destroy(p_sys->receiver_ctx);
+    free(p_sys->slab);
 }
 
 static int Open(vlc_object_t *p_this)
@@ -225,6 +316,7 @@ static int Open(vlc_object_t *p_this)
     p_access->p_sys = p_sys;
 
     vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
 
     int rist_profile = var_InheritInteger(p_access, RIST_CFG_PREFIX RIST_URL_PARAM_PROFILE);
     p_sys->i_maximum_jitter = var_InheritInteger(p_access, RIST_CFG_PREFIX "maximum-jitter");
@@ -243,6 +335,20 @@ static int Open(vlc_object_t *p_this)
     }
     p_sys->i_recovery_buffer = i_recovery_length;
 
+    /* Size the receive buffer for the maximum bitrate */
+    uint64_t i_slab_size = (uint64_t)var_InheritInteger(p_access, RIST_CFG_PREFIX RIST_URL_PARAM_BANDWIDTH)
+        * var_InheritInteger(p_access, RIST_CFG_PREFIX "receive-buffer") / 8;
+    i_slab_size += i_slab_size / 16; /* record headers */
+    i_slab_size = VLC_CLIP(i_slab_size, 4 * RIST_SLAB_RECORD(RIST_MAX_PACKET_SIZE),
+                           RIST_MAX_SLAB_SIZE);
+    p_sys->slab_size = i_slab_size & ~(RIST_SLAB_ALIGN - 1);
+    p_sys->slab = malloc(p_sys->slab_size);
+    if (unlikely(p_sys->slab == NULL))
+        return VLC_ENOMEM;
+    msg_Dbg(p_access, "Receive buffer of %zu bytes", p_sys->slab_size);
+
+    var_Create(p_access, "rist-stats", VLC_VAR_STRING);
+
     int i_verbose_level = var_InheritInteger( p_access, RIST_CFG_PREFIX RIST_URL_PARAM_VERBOSE_LEVEL );
 
     //This simply disables the global logs, which are only used by the udpsocket functions provided
@@ -263,6 +369,7 @@ static int Open(vlc_object_t *p_this)
 
     if (rist_receiver_create(&p_sys->receiver_ctx, rist_profile, logging_settings) != 0) {
         msg_Err(p_access, "Could not create rist receiver context");
+        free(p_sys->slab);
         return VLC_EGENERIC;
     }
 
@@ -272,6 +379,11 @@ static int Open(vlc_object_t *p_this)
         goto failed;
     }
 
+    if (rist_receiver_data_callback_set2(p_sys->receiver_ctx, cb_data, p_access)) {
+        msg_Err(p_access, "Could not set data callback");
+        goto failed;
+    }
+
     // Enable stats data
     if (rist_stats_callback_set(p_sys->receiver_ctx, 1000, cb_stats, (void *)p_access) == -1) {
         msg_Err(p_access, "Could not enable stats callback");
@@ -294,10 +406,17 @@ static int Open(vlc_object_t *p_this)
 
 failed:
     rist_destroy(p_sys->receiver_ctx);
+    free(p_sys->slab);
     msg_Err(p_access, "Failed to open rist module");
     return VLC_EGENERIC;
 }
 
+#define RECEIVE_BUFFER_TEXT N_("Receive buffer size (ms)")
+#define RECEIVE_BUFFER_LONGTEXT N_( \
+    "Amount of data at the maximum bitrate that can be received ahead of " \
+    "the demux/decode chain. Increase it for long-haul links or if the " \
+    "input thread falls behind." )
+
 #define DST_PORT_TEXT N_("Virtual Destination Port Filter")
 #define DST_PORT_LONGTEXT N_( \
     "Destination port to be used inside the reduced-mode of the main profile "\
@@ -318,6 +437,9 @@ vlc_module_begin ()
     add_integer( RIST_CFG_PREFIX "nack-type", NACK_FMT_RANGE,
             N_("RIST nack type, 0 = range, 1 = bitmask. Default is range"), NULL)
         change_integer_list( nack_type_values, nack_type_names )
+    add_integer( RIST_CFG_PREFIX "receive-buffer", 2000,
+            RECEIVE_BUFFER_TEXT, RECEIVE_BUFFER_LONGTEXT )
+        change_integer_range( 100, 60000 )
     add_integer( RIST_CFG_PREFIX RIST_URL_PARAM_VIRT_DST_PORT, 0,
             DST_PORT_TEXT, DST_PORT_LONGTEXT )
     add_integer( RIST_CFG_PREFIX RIST_CFG_MAX_PACKET_SIZE, RIST_MAX_PACKET_SIZE,
@@ -41,6 +41,7 @@
 #include <vlc_network.h>
 #include <vlc_block.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
@@ -53,15 +54,417 @@
  */
 #define MRU 65507u
 
+/* Maximum number of datagrams received per system call */
+#define VLEN 32
+
+/*
+ * Fast channel change
+ *
+ * The streams listed in "udp-fcc" are received along with the played one,
+ * and the MPEG-TS datagrams since their last video key frame are kept, with
+ * their last PAT and PMT. When one of them is opened next, the kept data is
+ * output at once, so that decoding does not wait for the next key frame.
+ * Channels are kept open for a while after their access is closed, so that
+ * a new access can take them over.
+ */
+#define TS_PACKET_SIZE 188
+
+#define FCC_MAX_NEIGHBORS 8
+#define FCC_MAX_PMT 4
+/* Maximum data kept per channel since its key frame */
+#define FCC_MAX_GOP (16u << 20)
+/* Kernel buffer, to hold the datagrams while no access reads a channel */
+#define FCC_RCVBUF (4 << 20)
+/* Delay an unused channel is kept open */
+#define FCC_LINGER VLC_TICK_FROM_SEC(2)
+/* Delay after which the data kept by an unused channel is not contiguous */
+#define FCC_STALE VLC_TICK_FROM_MS(500)
+
+typedef struct fcc_channel
+{
+    char *location;
+    int fd;
+
+    /* All the fields below are protected by fcc_lock */
+    const void *owner; /* access reading the socket, or NULL */
+    bool is_main; /* whether the owner plays this channel */
+    unsigned refs; /* accesses referencing the channel */
+    vlc_tick_t idle_date;
+
+    uint8_t pat[TS_PACKET_SIZE];
+    bool has_pat;
+    struct
+    {
+        uint16_t pid;
+        bool valid;
+        uint8_t packet[TS_PACKET_SIZE];
+    } pmt[FCC_MAX_PMT];
+    unsigned pmt_count;
+    int video_pid;
+
+    /* data since the last video key frame */
+    bool synced;
+    block_t *gop;
+    block_t **gop_last;
+    size_t gop_size;
+
+    struct vlc_list node;
+} fcc_channel_t;
+
+static vlc_mutex_t fcc_lock = VLC_STATIC_MUTEX;
+static struct vlc_list fcc_channels = VLC_LIST_INITIALIZER(&fcc_channels);
+
 typedef struct {
     int fd;
     int timeout;
 
+    fcc_channel_t *channel; /* played channel, if fast channel change is on */
+    fcc_channel_t *neighbors[FCC_MAX_NEIGHBORS];
+    unsigned neighbor_count;
+    uint8_t *fcc_buf;
+    block_t *burst; /* data kept for the played channel, output first */
+
+#ifdef HAVE_RECVMMSG
+    unsigned vlen; /* current batch size */
+    char *buf; /* VLEN datagrams of up to MRU bytes each */
+#else
     size_t length;
     char *offset;
     char buf[MRU];
+#endif
 } access_sys_t;
 
+static void FccResetLocked(fcc_channel_t *ch)
+{
+    block_ChainRelease(ch->gop);
+    ch->synced = false;
+    ch->gop = NULL;
+    ch->gop_last = &ch->gop;
+    ch->gop_size = 0;
+}
+
+static fcc_channel_t *FccNew(const char *location, int fd)
+{
+    fcc_channel_t *ch = malloc(sizeof (*ch));
+    if (unlikely(ch == NULL))
+        return NULL;
+
+    ch->location = strdup(location);
+    if (unlikely(ch->location == NULL)) {
+        free(ch);
+        return NULL;
+    }
+    ch->fd = fd;
+    ch->owner = NULL;
+    ch->is_main = false;
+    ch->refs = 0;
+    ch->has_pat = false;
+    ch->pmt_count = 0;
+    ch->video_pid = -1;
+    ch->gop = NULL;
+    FccResetLocked(ch);
+
+    /* Best effort: keep up until the next access takes the channel over */
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (void *)&(int){ FCC_RCVBUF },
+               sizeof (int));
+    return ch;
+}
+
+static void FccDelete(fcc_channel_t *ch)
+{
+    net_Close(ch->fd);
+    block_ChainRelease(ch->gop);
+    free(ch->location);
+    free(ch);
+}
+
+static fcc_channel_t *FccFindLocked(const char *location)
+{
+    fcc_channel_t *ch;
+
+    vlc_list_foreach(ch, &fcc_channels, node)
+        if (strcmp(ch->location, location) == 0)
+            return ch;
+    return NULL;
+}
+
+static void FccHoldLocked(fcc_channel_t *ch, const void *owner, bool is_main)
+{
+    if (ch->refs == 0 && vlc_tick_now() - ch->idle_date > FCC_STALE)
+        FccResetLocked(ch);
+    ch->owner = owner;
+    ch->is_main = is_main;
+    ch->refs++;
+}
+
+static void FccReleaseLocked(fcc_channel_t *ch, const void *owner)
+{
+    if (ch->owner == owner) {
+        ch->owner = NULL;
+        ch->is_main = false;
+    }
+    if (--ch->refs == 0)
+        ch->idle_date = vlc_tick_now();
+}
+
+/* Closes the channels unused for too long */
+static void FccCollectLocked(struct vlc_list *garbage)
+{
+    const vlc_tick_t now = vlc_tick_now();
+    fcc_channel_t *ch;
+
+    vlc_list_foreach(ch, &fcc_channels, node)
+        if (ch->refs == 0 && now - ch->idle_date > FCC_LINGER) {
+            vlc_list_remove(&ch->node);
+            vlc_list_append(&ch->node, garbage);
+        }
+}
+
+static void FccDeleteAll(struct vlc_list *garbage)
+{
+    fcc_channel_t *ch;
+
+    vlc_list_foreach(ch, garbage, node)
+        FccDelete(ch);
+}
+
+/* Returns the PSI section starting in a TS packet */
+static const uint8_t *TsSection(const uint8_t *p, size_t *restrict size)
+{
+    if (!(p[1] & 0x40) || !(p[3] & 0x10))
+        return NULL; /* no payload unit start */
+
+    size_t offset = 4;
+    if (p[3] & 0x20)
+        offset += 1 + p[4];
+    if (offset >= TS_PACKET_SIZE)
+        return NULL;
+    offset += 1 + p[offset]; /* pointer field */
+    if (offset >= TS_PACKET_SIZE)
+        return NULL;
+
+    const uint8_t *sec = p + offset;
+    *size = TS_PACKET_SIZE - offset;
+    if (*size < 3 || 3 + (GetWBE(&sec[1]) & 0xfff) > *size)
+        return NULL; /* sections over several packets are not kept */
+    *size = 3 + (GetWBE(&sec[1]) & 0xfff);
+    return sec;
+}
+
+static void FccParsePat(fcc_channel_t *ch, const uint8_t *p)
+{
+    size_t size;
+    const uint8_t *sec = TsSection(p, &size);
+    if (sec == NULL || sec[0] != 0x00 || size < 12)
+        return;
+
+    uint16_t pids[FCC_MAX_PMT];
+    unsigned count = 0;
+
+    for (size_t i = 8; i + 4 <= size - 4 && count < FCC_MAX_PMT; i += 4)
+        if (GetWBE(&sec[i]) != 0) /* not the NIT */
+            pids[count++] = GetWBE(&sec[i + 2]) & 0x1fff;
+
+    memcpy(ch->pat, p, TS_PACKET_SIZE);
+    ch->has_pat = true;
+
+    bool changed = count != ch->pmt_count;
+    for (unsigned i = 0; i < count && !changed; i++)
+        changed = pids[i] != ch->pmt[i].pid;
+    if (!changed)
+        return;
+
+    for (unsigned i = 0; i < count; i++) {
+        ch->pmt[i].pid = pids[i];
+        ch->pmt[i].valid = false;
+    }
+    ch->pmt_count = count;
+    ch->video_pid = -1;
+}
+
+static bool TsIsVideo(uint8_t stream_type)
+{
+    switch (stream_type) {
+        case 0x01: /* MPEG-1 */
+        case 0x02: /* MPEG-2 */
+        case 0x10: /* MPEG-4 part 2 */
+        case 0x1b: /* H.264 */
+        case 0x24: /* HEVC */
+        case 0x42: /* AVS */
+        case 0xea: /* VC-1 */
+            return true;
+    }
+    return false;
+}
+
+static void FccParsePmt(fcc_channel_t *ch, unsigned pid, const uint8_t *p)
+{
+    unsigned idx = 0;
+    while (idx < ch->pmt_count && ch->pmt[idx].pid != pid)
+        idx++;
+    if (idx == ch->pmt_count)
+        return;
+
+    size_t size;
+    const uint8_t *sec = TsSection(p, &size);
+    if (sec == NULL || sec[0] != 0x02 || size < 16)
+        return;
+
+    memcpy(ch->pmt[idx].packet, p, TS_PACKET_SIZE);
+    ch->pmt[idx].valid = true;
+
+    size_t i = 12 + (GetWBE(&sec[10]) & 0xfff);
+    while (i + 5 <= size - 4 && ch->video_pid < 0) {
+        if (TsIsVideo(sec[i]))
+            ch->video_pid = GetWBE(&sec[i + 1]) & 0x1fff;
+        i += 5 + (GetWBE(&sec[i + 3]) & 0xfff);
+    }
+}
+
+/* Keeps the datagrams received since the last video key frame */
+static void FccInputLocked(fcc_channel_t *ch, const uint8_t *buf, size_t len)
+{
+    if (len == 0 || len % TS_PACKET_SIZE != 0)
+        return; /* not MPEG-TS over raw UDP */
+
+    size_t rap = len;
+
+    for (size_t offset = 0; offset < len; offset += TS_PACKET_SIZE) {
+        const uint8_t *p = buf + offset;
+        if (p[0] != 0x47)
+            return;
+
+        const unsigned pid = GetWBE(&p[1]) & 0x1fff;
+        if (p[1] & 0x40) {
+            if (pid == 0)
+                FccParsePat(ch, p);
+            else
+                FccParsePmt(ch, pid, p);
+        }
+
+        /* random access indicator of the video elementary stream */
+        if (rap == len && (int)pid == ch->video_pid
+         && (p[3] & 0x20) && p[4] > 0 && (p[5] & 0x40))
+            rap = offset;
+    }
+
+    if (rap < len) {
+        FccResetLocked(ch);
+        ch->synced = true;
+    } else if (ch->synced)
+        rap = 0;
+    else
+        return;
+
+    if (ch->gop_size + (len - rap) > FCC_MAX_GOP) {
+        FccResetLocked(ch);
+        return;
+    }
+
+    block_t *block = block_Alloc(len - rap);
+    if (unlikely(block == NULL))
+        return;
+    memcpy(block->p_buffer, buf + rap, len - rap);
+    block_ChainLastAppend(&ch->gop_last, block);
+    ch->gop_size += block->i_buffer;
+}
+
+/* Takes the data kept since the last key frame, with the PAT and PMT */
+static block_t *FccBurstLocked(fcc_channel_t *ch)
+{
+    if (!ch->synced || ch->gop == NULL || !ch->has_pat)
+        return NULL;
+
+    unsigned count = 1;
+    for (unsigned i = 0; i < ch->pmt_count; i++)
+        if (ch->pmt[i].valid)
+            count++;
+
+    block_t *psi = block_Alloc(count * TS_PACKET_SIZE);
+    if (unlikely(psi == NULL))
+        return NULL;
+
+    uint8_t *p = psi->p_buffer;
+    memcpy(p, ch->pat, TS_PACKET_SIZE);
+    for (unsigned i = 0; i < ch->pmt_count; i++)
+        if (ch->pmt[i].valid) {
+            p += TS_PACKET_SIZE;
+            memcpy(p, ch->pmt[i].packet, TS_PACKET_SIZE);
+        }
+
+    psi->p_next = ch->gop;
+    ch->gop = NULL;
+    FccResetLocked(ch);
+    return psi;
+}
+
+/* Receives the pending datagrams of a neighbor channel */
+static void FccReceive(stream_t *access, unsigned idx)
+{
+    access_sys_t *sys = access->p_sys;
+    fcc_channel_t *ch = sys->neighbors[idx];
+
+    vlc_mutex_lock(&fcc_lock);
+    if (ch->owner != sys) {
+        /* another access took the channel over */
+        FccReleaseLocked(ch, sys);
+        sys->neighbors[idx] = sys->neighbors[--sys->neighbor_count];
+        vlc_mutex_unlock(&fcc_lock);
+        return;
+    }
+
+    for (unsigned i = 0; i < VLEN; i++) {
+        ssize_t len = recv(ch->fd, sys->fcc_buf, MRU, MSG_DONTWAIT);
+        if (len < 0)
+            break;
+        FccInputLocked(ch, sys->fcc_buf, len);
+    }
+    vlc_mutex_unlock(&fcc_lock);
+}
+
+/* Waits for the played socket, while receiving the neighbor channels */
+static int WaitRecv(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct pollfd ufd[1 + FCC_MAX_NEIGHBORS];
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+
+    if (sys->timeout >= 0)
+        deadline = vlc_tick_now() + VLC_TICK_FROM_MS(sys->timeout);
+
+    for (;;) {
+        unsigned count = 1;
+
+        ufd[0].fd = sys->fd;
+        ufd[0].events = POLLIN;
+        for (unsigned i = 0; i < sys->neighbor_count; i++) {
+            ufd[count].fd = sys->neighbors[i]->fd;
+            ufd[count].events = POLLIN;
+            count++;
+        }
+
+        int timeout = -1;
+        if (deadline != VLC_TICK_INVALID) {
+            vlc_tick_t delay = deadline - vlc_tick_now();
+            timeout = delay > 0 ? MS_FROM_VLC_TICK(delay) : 0;
+        }
+
+        int val = vlc_poll_i11e(ufd, count, timeout);
+        if (val <= 0)
+            return val;
+
+        /* backward, as a neighbor taken over is replaced by the last one */
+        for (unsigned i = count - 1; i > 0; i--)
+            if (ufd[i].revents)
+                FccReceive(access, i - 1);
+
+        if (ufd[0].revents)
+            return val;
+        if (deadline != VLC_TICK_INVALID && vlc_tick_now() >= deadline)
+            return 0;
+    }
+}
+
 static int Control(stream_t *access, int query, va_list args)
 {
     switch (query) {
@@ -83,10 +486,102 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_RECVMMSG
+static block_t *BlockRecv(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->burst != NULL) {
+        block_t *block = sys->burst;
+
+        sys->burst = block->p_next;
+        block->p_next = NULL;
+        return block;
+    }
+
+    switch (WaitRecv(access)) {
+        case 0:
+            msg_Err(access, "receive time-out");
+            *eof = true;
+            /* fall through */
+        case -1:
+            return NULL;
+    }
+
+    /* The slots are sized after the MRU, as any datagram of the batch may
+     * be larger than the first one. Only the received bytes get copied. */
+    const unsigned vlen = sys->vlen;
+    struct mmsghdr msgs[VLEN];
+    struct iovec iovecs[VLEN];
+
+    for (unsigned i = 0; i < vlen; i++) {
+        iovecs[i].iov_base = sys->buf + i * MRU;
+        iovecs[i].iov_len = MRU;
+        memset(&msgs[i], 0, sizeof (msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int val = recvmmsg(sys->fd, msgs, vlen, MSG_DONTWAIT, NULL);
+    if (val <= 0)
+        return NULL;
+
+    /* Grow the batch while the socket keeps filling it, shrink it when it
+     * does not. */
+    if ((unsigned)val == vlen) {
+        if (vlen < VLEN)
+            sys->vlen = vlen * 2;
+    } else if ((unsigned)val < vlen / 2)
+        sys->vlen = vlen / 2;
+
+    size_t total = 0;
+
+    for (int i = 0; i < val; i++)
+        total += msgs[i].msg_len;
+
+    if (total == 0) /* empty (0 bytes) payload does *not* mean EOF here */
+        return NULL;
+
+    block_t *block = block_Alloc(total);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    uint8_t *p = block->p_buffer;
+
+    for (int i = 0; i < val; i++) {
+        memcpy(p, iovecs[i].iov_base, msgs[i].msg_len);
+        p += msgs[i].msg_len;
+    }
+
+    block->i_buffer = total;
+
+    if (sys->channel != NULL) {
+        vlc_mutex_lock(&fcc_lock);
+        FccInputLocked(sys->channel, block->p_buffer, total);
+        vlc_mutex_unlock(&fcc_lock);
+    }
+    return block;
+}
+#else
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
 
+    if (sys->burst != NULL) {
+        block_t *block = sys->burst;
+
+        if (len > block->i_buffer)
+            len = block->i_buffer;
+        memcpy(buf, block->p_buffer, len);
+        block->p_buffer += len;
+        block->i_buffer -= len;
+        if (block->i_buffer == 0) {
+            sys->burst = block->p_next;
+            block_Release(block);
+        }
+        return len;
+    }
+
     if (sys->length > 0) {
         if (len > sys->length)
             len = sys->length;
@@ -97,12 +592,9 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
         return len;
     }
 
-    struct pollfd ufd[1];
-
-    ufd[0].fd = sys->fd;
-    ufd[0].events = POLLIN;
-
-    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+    /* Datagrams are split across reads here, so the played channel itself is
+     * not kept for a later fast channel change, only its neighbors. */
+    switch (WaitRecv(access)) {
         case 0:
             msg_Err(access, "receive time-out");
             return 0;
@@ -131,36 +623,20 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
 
     return val;
 }
+#endif
 
 /*****************************************************************************
- * Open: open the socket
+ * OpenSocket: open the socket of a location
  *****************************************************************************/
-static int Open( vlc_object_t *p_this )
+static int OpenSocket( vlc_object_t *p_this, const char *psz_location )
 {
-    stream_t     *p_access = (stream_t*)p_this;
-    access_sys_t *sys;
-
-    if( p_access->b_preparsing )
-        return VLC_EGENERIC;
-
-    sys = vlc_obj_malloc( p_this, sizeof( *sys ) );
-    if( unlikely( sys == NULL ) )
-        return VLC_ENOMEM;
-
-    sys->length = 0;
-    p_access->p_sys = sys;
-    p_access->pf_read = Read;
-    p_access->pf_block = NULL;
-    p_access->pf_control = Control;
-    p_access->pf_seek = NULL;
-
-    char *psz_name = strdup( p_access->psz_location );
+    char *psz_name = strdup( psz_location );
     char *psz_parser;
     const char *psz_server_addr, *psz_bind_addr = "";
     int  i_bind_port = 1234, i_server_port = 0;
 
     if( unlikely(psz_name == NULL) )
-        return VLC_ENOMEM;
+        return -1;
 
     /* Parse psz_name syntax :
      * [serveraddr[:serverport]][@[bindaddr]:[bindport]] */
@@ -201,18 +677,151 @@ static int Open( vlc_object_t *p_this )
         }
     }
 
-    msg_Dbg( p_access, "opening server=%s:%d local=%s:%d",
+    msg_Dbg( p_this, "opening server=%s:%d local=%s:%d",
              psz_server_addr, i_server_port, psz_bind_addr, i_bind_port );
 
-    sys->fd = net_OpenDgram( p_access, psz_bind_addr, i_bind_port,
-                             psz_server_addr, i_server_port, IPPROTO_UDP );
+    int fd = net_OpenDgram( p_this, psz_bind_addr, i_bind_port,
+                            psz_server_addr, i_server_port, IPPROTO_UDP );
     free( psz_name );
-    if( sys->fd == -1 )
+    return fd;
+}
+
+/*****************************************************************************
+ * OpenNeighbors: start receiving the fast channel change neighbors
+ *****************************************************************************/
+static void OpenNeighbors( stream_t *p_access, char *psz_list )
+{
+    access_sys_t *sys = p_access->p_sys;
+    char *psz_save;
+
+    for( const char *psz_loc = strtok_r( psz_list, ", ", &psz_save );
+         psz_loc != NULL && sys->neighbor_count < FCC_MAX_NEIGHBORS;
+         psz_loc = strtok_r( NULL, ", ", &psz_save ) )
     {
-        msg_Err( p_access, "cannot open socket" );
+        if( strcmp( psz_loc, p_access->psz_location ) == 0 )
+            continue;
+
+        vlc_mutex_lock( &fcc_lock );
+        fcc_channel_t *ch = FccFindLocked( psz_loc );
+        if( ch != NULL )
+        {
+            if( ch->owner != NULL && ch->is_main )
+                ch = NULL; /* played by another access */
+            else
+                FccHoldLocked( ch, sys, false );
+        }
+        vlc_mutex_unlock( &fcc_lock );
+
+        if( ch == NULL )
+        {
+            int fd = OpenSocket( VLC_OBJECT(p_access), psz_loc );
+            if( fd == -1 )
+                continue;
+            ch = FccNew( psz_loc, fd );
+            if( unlikely(ch == NULL) )
+            {
+                net_Close( fd );
+                continue;
+            }
+            vlc_mutex_lock( &fcc_lock );
+            FccHoldLocked( ch, sys, false );
+            vlc_list_append( &ch->node, &fcc_channels );
+            vlc_mutex_unlock( &fcc_lock );
+        }
+        sys->neighbors[sys->neighbor_count++] = ch;
+    }
+}
+
+/*****************************************************************************
+ * Open: open the socket
+ *****************************************************************************/
+static int Open( vlc_object_t *p_this )
+{
+    stream_t     *p_access = (stream_t*)p_this;
+    access_sys_t *sys;
+
+    if( p_access->b_preparsing )
         return VLC_EGENERIC;
+
+    sys = vlc_obj_malloc( p_this, sizeof( *sys ) );
+    if( unlikely( sys == NULL ) )
+        return VLC_ENOMEM;
+
+    p_access->p_sys = sys;
+#ifdef HAVE_RECVMMSG
+    sys->vlen = 1;
+    sys->buf = vlc_obj_malloc( p_this, VLEN * MRU );
+    if( unlikely( sys->buf == NULL ) )
+        return VLC_ENOMEM;
+    p_access->pf_read = NULL;
+    p_access->pf_block = BlockRecv;
+#else
+    sys->length = 0;
+    p_access->pf_read = Read;
+    p_access->pf_block = NULL;
+#endif
+    p_access->pf_control = Control;
+    p_access->pf_seek = NULL;
+
+    sys->channel = NULL;
+    sys->neighbor_count = 0;
+    sys->fcc_buf = NULL;
+    sys->burst = NULL;
+
+    char *psz_fcc = var_InheritString( p_access, "udp-fcc" );
+    if( psz_fcc != NULL )
+    {
+        /* Take the channel over if it was received in the background */
+        vlc_mutex_lock( &fcc_lock );
+        fcc_channel_t *ch = FccFindLocked( p_access->psz_location );
+        if( ch != NULL && ( ch->owner == NULL || !ch->is_main ) )
+        {
+            FccHoldLocked( ch, sys, true );
+            sys->burst = FccBurstLocked( ch );
+            sys->channel = ch;
+        }
+        vlc_mutex_unlock( &fcc_lock );
+
+        if( sys->channel != NULL )
+        {
+            sys->fd = sys->channel->fd;
+            if( sys->burst != NULL )
+                msg_Dbg( p_access, "fast channel change from %s",
+                         p_access->psz_location );
+        }
+    }
+
+    if( sys->channel == NULL )
+    {
+        sys->fd = OpenSocket( p_this, p_access->psz_location );
+        if( sys->fd == -1 )
+        {
+            msg_Err( p_access, "cannot open socket" );
+            free( psz_fcc );
+            return VLC_EGENERIC;
+        }
+
+        if( psz_fcc != NULL )
+        {
+            sys->channel = FccNew( p_access->psz_location, sys->fd );
+            if( likely(sys->channel != NULL) )
+            {
+                vlc_mutex_lock( &fcc_lock );
+                FccHoldLocked( sys->channel, sys, true );
+                vlc_list_append( &sys->channel->node, &fcc_channels );
+                vlc_mutex_unlock( &fcc_lock );
+            }
+        }
     }
 
+    if( sys->channel != NULL )
+    {
+        sys->fcc_buf = malloc( MRU );
+        if( likely(sys->fcc_buf != NULL) )
+            OpenNeighbors( p_access, psz_fcc );
+    }
+    free( psz_fcc );
+
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
         sys->timeout *= 1000;
@@ -228,10 +837,34 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
-    net_Close( sys->fd );
+    if( sys->channel != NULL )
+    {
+        /* Keep the channels for a while, for the next access */
+        struct vlc_list garbage;
+        vlc_list_init( &garbage );
+
+        vlc_mutex_lock( &fcc_lock );
+        for( unsigned i = 0; i < sys->neighbor_count; i++ )
+            FccReleaseLocked( sys->neighbors[i], sys );
+        FccReleaseLocked( sys->channel, sys );
+        FccCollectLocked( &garbage );
+        vlc_mutex_unlock( &fcc_lock );
+
+        FccDeleteAll( &garbage );
+    }
+    else
+        net_Close( sys->fd );
+
+    block_ChainRelease( sys->burst );
+    free( sys->fcc_buf );
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define FCC_TEXT N_("Fast channel change streams")
+#define FCC_LONGTEXT N_("Comma-separated list of other UDP streams, " \
+    "as in udp://<stream>, received in the background while playing. " \
+    "Switching to one of them then starts from its last key frame " \
+    "instead of waiting for the next one (MPEG-TS only).")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -241,6 +874,7 @@ vlc_module_begin()
 
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL)
+    add_string("udp-fcc", NULL, FCC_TEXT, FCC_LONGTEXT)
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
@@ -47,7 +47,7 @@ typedef struct
     int fd;
     vlc_thread_t thread;
 
-    struct buffer_t *bufv;
+    vlc_v4l2_pool_t *pool;
     union
     {
         uint32_t bufc;
@@ -567,17 +567,19 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
             const long pagemask = sysconf (_SC_PAGE_SIZE) - 1;
 
             sys->blocksize = (fmt.fmt.pix.sizeimage + pagemask) & ~pagemask;
-            sys->bufv = NULL;
+            sys->pool = NULL;
             entry = UserPtrThread;
             msg_Dbg (demux, "streaming with %"PRIu32"-bytes user buffers",
                      sys->blocksize);
         }
         else /* fall back to memory map */
         {
-            sys->bufc = 4;
-            sys->bufv = StartMmap (VLC_OBJECT(demux), fd, &sys->bufc);
-            if (sys->bufv == NULL)
+            /* Frames are passed downstream in place, so allow for a few
+             * of them to be held by the decoder. */
+            sys->pool = StartMmapPool (VLC_OBJECT(demux), fd, 8);
+            if (sys->pool == NULL)
                 return -1;
+            sys->bufc = GetMmapPoolSize (sys->pool);
             entry = MmapThread;
             msg_Dbg (demux, "streaming with %"PRIu32" memory-mapped buffers",
                      sys->bufc);
@@ -586,7 +588,7 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
     else if (caps & V4L2_CAP_READWRITE)
     {
         sys->blocksize = fmt.fmt.pix.sizeimage;
-        sys->bufv = NULL;
+        sys->pool = NULL;
         entry = ReadThread;
         msg_Dbg (demux, "reading %"PRIu32" bytes at a time", sys->blocksize);
     }
@@ -612,8 +614,8 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
         if (sys->vbi != NULL)
             CloseVBI (sys->vbi);
 #endif
-        if (sys->bufv != NULL)
-            StopMmap (sys->fd, sys->bufv, sys->bufc);
+        if (sys->pool != NULL)
+            StopMmapPool (sys->pool);
         return -1;
     }
     return 0;
@@ -626,8 +628,8 @@ void DemuxClose( vlc_object_t *obj )
 
     vlc_cancel (sys->thread);
     vlc_join (sys->thread, NULL);
-    if (sys->bufv != NULL)
-        StopMmap (sys->fd, sys->bufv, sys->bufc);
+    if (sys->pool != NULL)
+        StopMmapPool (sys->pool);
     ControlsDeinit(vlc_object_parent(obj), sys->controls);
     v4l2_close (sys->fd);
 
@@ -759,7 +761,7 @@ static void *MmapThread (void *data)
         if( ufd[0].revents )
         {
             int canc = vlc_savecancel ();
-            block_t *block = GrabVideo (VLC_OBJECT(demux), fd, sys->bufv);
+            block_t *block = GrabVideoPool (VLC_OBJECT(demux), sys->pool);
             if (block != NULL)
             {
                 block->i_flags |= sys->block_flags;
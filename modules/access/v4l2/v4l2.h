@@ -31,6 +31,7 @@ extern int (*v4l2_munmap) (void *, size_t);
 #define CFG_PREFIX "v4l2-"
 
 typedef struct vlc_v4l2_ctrl vlc_v4l2_ctrl_t;
+typedef struct vlc_v4l2_pool vlc_v4l2_pool_t;
 
 struct buffer_t
 {
@@ -58,6 +59,11 @@ void StopMmap (int, struct buffer_t *, uint32_t);
 vlc_tick_t GetBufferPTS (const struct v4l2_buffer *);
 block_t* GrabVideo (vlc_object_t *, int, const struct buffer_t *);
 
+vlc_v4l2_pool_t *StartMmapPool (vlc_object_t *, int, uint32_t);
+uint32_t GetMmapPoolSize (const vlc_v4l2_pool_t *);
+void StopMmapPool (vlc_v4l2_pool_t *);
+block_t *GrabVideoPool (vlc_object_t *, vlc_v4l2_pool_t *);
+
 #ifdef ZVBI_COMPILED
 /* vbi.c */
 typedef struct vlc_v4l2_vbi vlc_v4l2_vbi_t;
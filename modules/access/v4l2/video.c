@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
@@ -740,3 +741,169 @@ void StopMmap (int fd, struct buffer_t *bufv, uint32_t bufc)
         v4l2_munmap (bufv[i].start, bufv[i].length);
     free (bufv);
 }
+
+/* Buffers kept queued in the driver before frames get copied again */
+#define POOL_MIN_QUEUED 2
+
+struct vlc_v4l2_pool_block
+{
+    block_t self;
+    struct vlc_v4l2_pool *pool;
+    struct v4l2_buffer buf;
+};
+
+struct vlc_v4l2_pool
+{
+    vlc_mutex_t lock;
+    int fd; /**< -1 once streaming is stopped */
+    atomic_uint refs; /**< 1 for the owner + 1 per outstanding block */
+    uint32_t queued; /**< buffers currently owned by the driver */
+    uint32_t bufc;
+    struct buffer_t *bufv;
+    struct vlc_v4l2_pool_block blocks[];
+};
+
+static void PoolRelease (vlc_v4l2_pool_t *pool)
+{
+    if (atomic_fetch_sub_explicit (&pool->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    for (uint32_t i = 0; i < pool->bufc; i++)
+        v4l2_munmap (pool->bufv[i].start, pool->bufv[i].length);
+    free (pool->bufv);
+    free (pool);
+}
+
+static void PoolBlockRelease (block_t *block)
+{
+    struct vlc_v4l2_pool_block *pb =
+        container_of (block, struct vlc_v4l2_pool_block, self);
+    vlc_v4l2_pool_t *pool = pb->pool;
+
+    /* Give the buffer back to the driver, unless it has stopped streaming */
+    vlc_mutex_lock (&pool->lock);
+    if (pool->fd != -1 && v4l2_ioctl (pool->fd, VIDIOC_QBUF, &pb->buf) == 0)
+        pool->queued++;
+    vlc_mutex_unlock (&pool->lock);
+    PoolRelease (pool);
+}
+
+static const struct vlc_block_callbacks pool_block_cbs =
+{
+    PoolBlockRelease,
+};
+
+/**
+ * Allocates memory-mapped buffers, and starts streaming.
+ *
+ * Unlike StartMmap(), the captured frames are handed downstream without
+ * copying them: each buffer is queued back to the driver when its block is
+ * released. The buffers outlive StopMmapPool() until their last block goes.
+ * @param n requested buffers count
+ */
+vlc_v4l2_pool_t *StartMmapPool (vlc_object_t *obj, int fd, uint32_t n)
+{
+    struct buffer_t *bufv = StartMmap (obj, fd, &n);
+    if (bufv == NULL)
+        return NULL;
+
+    vlc_v4l2_pool_t *pool = malloc (sizeof (*pool)
+                                    + n * sizeof (pool->blocks[0]));
+    if (unlikely(pool == NULL))
+    {
+        StopMmap (fd, bufv, n);
+        return NULL;
+    }
+
+    vlc_mutex_init (&pool->lock);
+    pool->fd = fd;
+    atomic_init (&pool->refs, 1);
+    pool->queued = n;
+    pool->bufc = n;
+    pool->bufv = bufv;
+    for (uint32_t i = 0; i < n; i++)
+        pool->blocks[i].pool = pool;
+    return pool;
+}
+
+uint32_t GetMmapPoolSize (const vlc_v4l2_pool_t *pool)
+{
+    return pool->bufc;
+}
+
+void StopMmapPool (vlc_v4l2_pool_t *pool)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    /* STREAMOFF implicitly dequeues all buffers */
+    vlc_mutex_lock (&pool->lock);
+    v4l2_ioctl (pool->fd, VIDIOC_STREAMOFF, &type);
+    pool->fd = -1;
+    vlc_mutex_unlock (&pool->lock);
+    PoolRelease (pool);
+}
+
+/**
+ * Grabs a video frame from a buffer pool.
+ *
+ * The frame is returned in place if enough buffers remain queued in the
+ * driver, otherwise it is copied so that capture does not stall on slow
+ * consumers.
+ */
+block_t *GrabVideoPool (vlc_object_t *demux, vlc_v4l2_pool_t *pool)
+{
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    block_t *block;
+
+    vlc_mutex_lock (&pool->lock);
+    if (v4l2_ioctl (pool->fd, VIDIOC_DQBUF, &buf) < 0)
+    {
+        vlc_mutex_unlock (&pool->lock);
+        if (errno != EAGAIN)
+            msg_Err (demux, "dequeue error: %s", vlc_strerror_c(errno));
+        return NULL;
+    }
+    assert (buf.index < pool->bufc);
+
+    const struct buffer_t *mem = &pool->bufv[buf.index];
+
+    if (pool->queued > POOL_MIN_QUEUED)
+    {
+        struct vlc_v4l2_pool_block *pb = &pool->blocks[buf.index];
+
+        pool->queued--;
+        vlc_mutex_unlock (&pool->lock);
+
+        pb->buf = buf;
+        block = block_Init (&pb->self, &pool_block_cbs, mem->start,
+                            mem->length);
+        block->i_buffer = buf.bytesused;
+        atomic_fetch_add_explicit (&pool->refs, 1, memory_order_relaxed);
+    }
+    else
+    {
+        /* Too many buffers held downstream: copy and requeue at once */
+        block = block_Alloc (buf.bytesused);
+        if (likely(block != NULL))
+            memcpy (block->p_buffer, mem->start, buf.bytesused);
+
+        if (v4l2_ioctl (pool->fd, VIDIOC_QBUF, &buf) < 0)
+        {
+            vlc_mutex_unlock (&pool->lock);
+            msg_Err (demux, "queue error: %s", vlc_strerror_c(errno));
+            if (block != NULL)
+                block_Release (block);
+            return NULL;
+        }
+        vlc_mutex_unlock (&pool->lock);
+
+        if (unlikely(block == NULL))
+            return NULL;
+    }
+
+    block->i_pts = block->i_dts = GetBufferPTS (&buf);
+    return block;
+}
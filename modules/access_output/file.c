@@ -57,14 +57,369 @@
 
 #define SOUT_CFG_PREFIX "sout-file-"
 
+typedef struct
+{
+    int fd;
+    struct file_writer *writer; /* NULL if writing synchronously */
+} sout_access_out_sys_t;
+
+/*****************************************************************************
+ * Asynchronous writer
+ *****************************************************************************
+ * The blocks are written by a dedicated thread, through a staging buffer so
+ * that the writes are large and aligned. Reads and seeks wait for the queued
+ * data to be written first, so they see the file as written synchronously.
+ */
+#define WRITER_BUFFER_SIZE (4 << 20)
+#define WRITER_ALIGN       4096
+#define WRITER_MAX_QUEUED  (64 << 20)
+
+struct file_writer
+{
+    sout_access_out_t *access;
+    int fd;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_cond_t idle;
+    block_t *first;
+    block_t **lastp;
+    size_t queued;
+    bool busy;
+    bool drain;
+    bool quit;
+    int error;
+
+    /* Only used by the writer thread, or while it is idle */
+    uint8_t *buf;
+    size_t used;
+    bool direct;
+    off_t pos;
+    off_t allocated;
+    off_t prealloc;
+    off_t synced;
+    vlc_tick_t sync_interval;
+    vlc_tick_t sync_date;
+};
+
+static int WriterWriteAll(struct file_writer *w, const uint8_t *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t val = write(w->fd, buf, len);
+        if (val < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno;
+        }
+        buf += val;
+        len -= val;
+        w->pos += val;
+    }
+    return 0;
+}
+
+/* Writes the staged data, or only its aligned part unless all is true. */
+static int WriterFlush(struct file_writer *w, bool all)
+{
+    size_t len = w->used;
+
+    if (w->direct && !all)
+        len &= ~(size_t)(WRITER_ALIGN - 1);
+    if (len == 0)
+        return 0;
+
+#ifdef O_DIRECT
+    if (w->direct && (len % WRITER_ALIGN))
+    {   /* The unaligned tail leaves the file offset unaligned for good */
+        int flags = fcntl(w->fd, F_GETFL);
+        if (flags != -1)
+            fcntl(w->fd, F_SETFL, flags & ~O_DIRECT);
+        w->direct = false;
+    }
+#endif
+
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (w->prealloc > 0 && w->pos + (off_t)len > w->allocated)
+    {
+        off_t from = __MAX(w->pos, w->allocated);
+
+        if (fallocate(w->fd, FALLOC_FL_KEEP_SIZE, from, w->prealloc) == 0)
+            w->allocated = from + w->prealloc;
+        else
+        {
+            msg_Warn(w->access, "cannot preallocate: %s",
+                     vlc_strerror_c(errno));
+            w->prealloc = 0;
+        }
+    }
+#endif
+
+    int val = WriterWriteAll(w, w->buf, len);
+    if (val)
+        return val;
+
+    w->used -= len;
+    memmove(w->buf, w->buf + len, w->used);
+    return 0;
+}
+
+/* Writes the staged data to the disk, then drops it from the page cache. */
+static int WriterSync(struct file_writer *w)
+{
+    int val = WriterFlush(w, false);
+    if (val)
+        return val;
+
+    if (fdatasync(w->fd))
+        return errno;
+#ifdef HAVE_POSIX_FADVISE
+    if (!w->direct && w->pos > w->synced)
+        posix_fadvise(w->fd, w->synced, w->pos - w->synced,
+                      POSIX_FADV_DONTNEED);
+#endif
+    w->synced = w->pos;
+    return 0;
+}
+
+static int WriterStage(struct file_writer *w, block_t *block)
+{
+    const uint8_t *p = block->p_buffer;
+    size_t len = block->i_buffer;
+
+    while (len > 0)
+    {
+        size_t n = __MIN(len, WRITER_BUFFER_SIZE - w->used);
+
+        memcpy(w->buf + w->used, p, n);
+        w->used += n;
+        p += n;
+        len -= n;
+
+        if (w->used == WRITER_BUFFER_SIZE)
+        {
+            int val = WriterFlush(w, false);
+            if (val)
+                return val;
+        }
+    }
+    return 0;
+}
+
+static void *WriterThread(void *data)
+{
+    struct file_writer *w = data;
+
+    vlc_mutex_lock(&w->lock);
+    for (;;)
+    {
+        while (w->first == NULL && !w->drain && !w->quit)
+        {
+            if (w->sync_interval <= 0)
+                vlc_cond_wait(&w->wait, &w->lock);
+            else if (vlc_cond_timedwait(&w->wait, &w->lock, w->sync_date))
+                break;
+        }
+
+        block_t *chain = w->first;
+        bool drain = w->drain;
+        bool sync = w->sync_interval > 0 && vlc_tick_now() >= w->sync_date;
+
+        if (chain == NULL && !drain && !sync)
+            break; /* quit */
+
+        w->first = NULL;
+        w->lastp = &w->first;
+        w->queued = 0;
+        w->busy = true;
+        vlc_cond_broadcast(&w->idle);
+        vlc_mutex_unlock(&w->lock);
+
+        int val = 0;
+        while (chain != NULL)
+        {
+            block_t *next = chain->p_next;
+
+            if (val == 0)
+                val = WriterStage(w, chain);
+            block_Release(chain);
+            chain = next;
+        }
+
+        if (val == 0 && sync)
+        {
+            val = WriterSync(w);
+            w->sync_date = vlc_tick_now() + w->sync_interval;
+        }
+        if (val == 0 && drain)
+            val = WriterFlush(w, true);
+
+        vlc_mutex_lock(&w->lock);
+        if (val && !w->error)
+        {
+            msg_Err(w->access, "cannot write: %s", vlc_strerror_c(val));
+            w->error = val;
+        }
+        if (drain && w->first == NULL)
+            w->drain = false;
+        w->busy = false;
+        vlc_cond_broadcast(&w->idle);
+    }
+    vlc_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+/* Waits until all the queued data is written to the file. */
+static int WriterDrain(struct file_writer *w)
+{
+    vlc_mutex_lock(&w->lock);
+    w->drain = true;
+    vlc_cond_signal(&w->wait);
+    while (w->drain || w->busy)
+        vlc_cond_wait(&w->idle, &w->lock);
+    int val = w->error;
+    vlc_mutex_unlock(&w->lock);
+    return val;
+}
+
+static ssize_t WriterQueue(struct file_writer *w, block_t *block)
+{
+    size_t total = 0;
+
+    for (block_t *b = block; b != NULL; b = b->p_next)
+        total += b->i_buffer;
+
+    vlc_mutex_lock(&w->lock);
+    while (w->queued > WRITER_MAX_QUEUED && !w->error)
+        vlc_cond_wait(&w->idle, &w->lock);
+
+    if (w->error)
+    {
+        vlc_mutex_unlock(&w->lock);
+        block_ChainRelease(block);
+        return -1;
+    }
+
+    *w->lastp = block;
+    while (*w->lastp != NULL)
+        w->lastp = &(*w->lastp)->p_next;
+    w->queued += total;
+    vlc_cond_signal(&w->wait);
+    vlc_mutex_unlock(&w->lock);
+    return total;
+}
+
+static struct file_writer *WriterNew(sout_access_out_t *access, int fd)
+{
+    struct file_writer *w = malloc(sizeof (*w));
+    if (unlikely(w == NULL))
+        return NULL;
+
+    w->buf = aligned_alloc(WRITER_ALIGN, WRITER_BUFFER_SIZE);
+    if (unlikely(w->buf == NULL))
+    {
+        free(w);
+        return NULL;
+    }
+
+    w->access = access;
+    w->fd = fd;
+    vlc_mutex_init(&w->lock);
+    vlc_cond_init(&w->wait);
+    vlc_cond_init(&w->idle);
+    w->first = NULL;
+    w->lastp = &w->first;
+    w->queued = 0;
+    w->busy = false;
+    w->drain = false;
+    w->quit = false;
+    w->error = 0;
+    w->used = 0;
+    w->direct = false;
+    w->pos = lseek(fd, 0, SEEK_CUR);
+    if (w->pos < 0)
+        w->pos = 0;
+    w->allocated = w->pos;
+    w->synced = w->pos;
+    w->prealloc = (off_t)var_GetInteger(access, SOUT_CFG_PREFIX"preallocate")
+                  << 20;
+    w->sync_interval = VLC_TICK_FROM_MS(
+                     var_GetInteger(access, SOUT_CFG_PREFIX"sync-interval"));
+    w->sync_date = vlc_tick_now() + w->sync_interval;
+
+#ifdef O_DIRECT
+    if (var_GetBool(access, SOUT_CFG_PREFIX"direct"))
+    {
+        int flags = fcntl(fd, F_GETFL);
+
+        if (w->pos % WRITER_ALIGN)
+            msg_Warn(access, "unaligned file offset, not using direct I/O");
+        else if (flags == -1 || fcntl(fd, F_SETFL, flags | O_DIRECT))
+            msg_Warn(access, "cannot use direct I/O: %s",
+                     vlc_strerror_c(errno));
+        else
+            w->direct = true;
+    }
+#endif
+
+    if (vlc_clone(&w->thread, WriterThread, w, VLC_THREAD_PRIORITY_OUTPUT))
+    {
+        aligned_free(w->buf);
+        free(w);
+        return NULL;
+    }
+    msg_Dbg(access, "asynchronous writing%s", w->direct ? " (direct)" : "");
+    return w;
+}
+
+static void WriterDelete(struct file_writer *w)
+{
+    WriterDrain(w);
+
+    vlc_mutex_lock(&w->lock);
+    w->quit = true;
+    vlc_cond_signal(&w->wait);
+    vlc_mutex_unlock(&w->lock);
+    vlc_join(w->thread, NULL);
+
+    aligned_free(w->buf);
+    free(w);
+}
+
+static void WriterNoDirect(struct file_writer *w)
+{
+#ifdef O_DIRECT
+    if (w->direct)
+    {
+        int flags = fcntl(w->fd, F_GETFL);
+        if (flags != -1)
+            fcntl(w->fd, F_SETFL, flags & ~O_DIRECT);
+        w->direct = false;
+    }
+#else
+    VLC_UNUSED(w);
+#endif
+}
+
+
 /*****************************************************************************
  * Read: standard read on a file descriptor.
  *****************************************************************************/
 static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
     ssize_t val;
 
+    if (p_sys->writer != NULL)
+    {
+        if (WriterDrain(p_sys->writer))
+            return -1;
+        /* Direct I/O would need an aligned buffer */
+        WriterNoDirect(p_sys->writer);
+    }
+
     do
         val = read(fd, p_buffer->p_buffer, p_buffer->i_buffer);
     while (val == -1 && errno == EINTR);
@@ -76,7 +431,8 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
  *****************************************************************************/
 static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
     size_t i_write = 0;
 
     while( p_buffer )
@@ -107,9 +463,17 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_write;
 }
 
+static ssize_t WriteAsync(sout_access_out_t *access, block_t *block)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+
+    return WriterQueue(sys->writer, block);
+}
+
 static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 {
-    int *fdp = access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *sys = access->p_sys;
+    int fd = sys->fd;
     ssize_t total = 0;
 
     while (block != NULL)
@@ -148,7 +512,8 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 #ifdef S_ISSOCK
 static ssize_t Send(sout_access_out_t *access, block_t *block)
 {
-    int *fdp = access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *sys = access->p_sys;
+    int fd = sys->fd;
     size_t total = 0;
 
     while (block != NULL)
@@ -187,9 +552,22 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
  *****************************************************************************/
 static int Seek( sout_access_out_t *p_access, off_t i_pos )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
-
-    return lseek(fd, i_pos, SEEK_SET);
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
+    struct file_writer *w = p_sys->writer;
+
+    if (w == NULL)
+        return lseek(fd, i_pos, SEEK_SET);
+
+    if (WriterDrain(w))
+        return -1;
+    if (i_pos % WRITER_ALIGN)
+        WriterNoDirect(w);
+
+    off_t pos = lseek(fd, i_pos, SEEK_SET);
+    if (pos >= 0)
+        w->pos = pos;
+    return pos;
 }
 
 static int Control( sout_access_out_t *p_access, int i_query, va_list args )
@@ -223,6 +601,12 @@ static const char *const ppsz_sout_options[] = {
 #ifdef O_SYNC
     "sync",
 #endif
+    "async",
+#ifdef O_DIRECT
+    "direct",
+#endif
+    "preallocate",
+    "sync-interval",
     NULL
 };
 
@@ -233,9 +617,9 @@ static int Open( vlc_object_t *p_this )
 {
     sout_access_out_t   *p_access = (sout_access_out_t*)p_this;
     int fd;
-    int *fdp = vlc_obj_malloc(p_this, sizeof (*fdp));
+    sout_access_out_sys_t *p_sys = vlc_obj_malloc(p_this, sizeof (*p_sys));
 
-    if (unlikely(fdp == NULL))
+    if (unlikely(p_sys == NULL))
         return VLC_ENOMEM;
 
     config_ChainParse( p_access, SOUT_CFG_PREFIX, ppsz_sout_options, p_access->p_cfg );
@@ -320,8 +704,9 @@ static int Open( vlc_object_t *p_this )
             return VLC_EGENERIC;
     }
 
-    *fdp = fd;
-    p_access->p_sys = fdp;
+    p_sys->fd = fd;
+    p_sys->writer = NULL;
+    p_access->p_sys = p_sys;
 
     struct stat st;
 
@@ -334,10 +719,20 @@ static int Open( vlc_object_t *p_this )
 
     p_access->pf_read  = Read;
 
+    if (append)
+        lseek (fd, 0, SEEK_END);
+
     if (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode))
     {
         p_access->pf_write = Write;
         p_access->pf_seek  = Seek;
+
+        if (var_GetBool (p_access, SOUT_CFG_PREFIX"async"))
+        {
+            p_sys->writer = WriterNew (p_access, fd);
+            if (p_sys->writer != NULL)
+                p_access->pf_write = WriteAsync;
+        }
     }
 #ifdef S_ISSOCK
     else if (S_ISSOCK(st.st_mode))
@@ -354,8 +749,6 @@ static int Open( vlc_object_t *p_this )
     p_access->pf_control = Control;
 
     msg_Dbg( p_access, "file access output opened (%s)", p_access->psz_path );
-    if (append)
-        lseek (fd, 0, SEEK_END);
 
     return VLC_SUCCESS;
 }
@@ -366,9 +759,11 @@ static int Open( vlc_object_t *p_this )
 static void Close( vlc_object_t * p_this )
 {
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    vlc_close(fd);
+    if (p_sys->writer != NULL)
+        WriterDelete(p_sys->writer);
+    vlc_close(p_sys->fd);
     msg_Dbg( p_access, "file access output closed" );
 }
 
@@ -383,6 +778,20 @@ static void Close( vlc_object_t * p_this )
     "on the file path")
 #define SYNC_TEXT N_("Synchronous writing")
 #define SYNC_LONGTEXT N_( "Open the file with synchronous writing.")
+#define ASYNC_TEXT N_("Asynchronous writing")
+#define ASYNC_LONGTEXT N_( "Write the file from a dedicated thread, in " \
+    "large chunks, so that slow disks do not stall the stream output.")
+#define DIRECT_TEXT N_("Direct I/O")
+#define DIRECT_LONGTEXT N_( "Bypass the page cache when writing " \
+    "asynchronously, if the file system allows it.")
+#define PREALLOCATE_TEXT N_("Preallocation (MiB)")
+#define PREALLOCATE_LONGTEXT N_( "Reserve disk space ahead of the data by " \
+    "steps of this size when writing asynchronously, to limit " \
+    "fragmentation. Zero disables it.")
+#define SYNC_INTERVAL_TEXT N_("Flush interval (ms)")
+#define SYNC_INTERVAL_LONGTEXT N_( "Flush the written data to the disk " \
+    "and release it from the page cache at this interval when writing " \
+    "asynchronously. Zero disables it.")
 
 vlc_module_begin ()
     set_description( N_("File stream output") )
@@ -398,5 +807,15 @@ vlc_module_begin ()
 #ifdef O_SYNC
     add_bool( SOUT_CFG_PREFIX "sync", false, SYNC_TEXT,SYNC_LONGTEXT )
 #endif
+    add_bool( SOUT_CFG_PREFIX "async", false, ASYNC_TEXT, ASYNC_LONGTEXT )
+#ifdef O_DIRECT
+    add_bool( SOUT_CFG_PREFIX "direct", false, DIRECT_TEXT, DIRECT_LONGTEXT )
+#endif
+    add_integer( SOUT_CFG_PREFIX "preallocate", 0, PREALLOCATE_TEXT,
+                 PREALLOCATE_LONGTEXT )
+        change_integer_range( 0, 4096 )
+    add_integer( SOUT_CFG_PREFIX "sync-interval", 0, SYNC_INTERVAL_TEXT,
+                 SYNC_INTERVAL_LONGTEXT )
+        change_integer_range( 0, 60000 )
     set_callbacks( Open, Close )
 vlc_module_end ()
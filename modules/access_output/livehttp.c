@@ -105,6 +105,28 @@ static void Close( vlc_object_t * );
 #define INTITIAL_SEG_TEXT N_("Number of first segment")
 #define INITIAL_SEG_LONGTEXT N_("The number of the first segment generated")
 
+#define CMAF_TEXT N_("CMAF segments")
+#define CMAF_LONGTEXT N_("Expect a fragmented MP4 stream (mp4frag muxer with "\
+                         "CMAF fragments) and publish it as CMAF segments "\
+                         "with low latency partial segments")
+
+#define PARTLEN_TEXT N_("Partial segment length")
+#define PARTLEN_LONGTEXT N_("Target length of the partial segments in "\
+                            "milliseconds. Partial segments end on fragment "\
+                            "boundaries, so this should not be shorter "\
+                            "than the fragment duration of the muxer")
+
+#define INITSEG_TEXT N_("Initialization segment")
+#define INITSEG_LONGTEXT N_("Path to the initialization segment to create. "\
+                            "By default, the #'s of the segment path are "\
+                            "replaced with \"init\"")
+
+#define BLOCKRELOAD_TEXT N_("Blocking playlist reload")
+#define BLOCKRELOAD_LONGTEXT N_("Advertise blocking playlist reload in the "\
+                                "index. The HTTP server delivering the index "\
+                                "must then hold the _HLS_msn and _HLS_part "\
+                                "requests until the index is updated")
+
 vlc_module_begin ()
     set_description( N_("HTTP Live streaming output") )
     set_shortname( N_("LiveHTTP" ))
@@ -135,6 +157,13 @@ vlc_module_begin ()
                  KEYFILE_TEXT, KEYFILE_LONGTEXT)
     add_loadfile(SOUT_CFG_PREFIX "key-loadfile", NULL,
                  KEYLOADFILE_TEXT, KEYLOADFILE_LONGTEXT)
+    add_bool( SOUT_CFG_PREFIX "cmaf", false, CMAF_TEXT, CMAF_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "part-length", 1000, 100, 10000,
+                            PARTLEN_TEXT, PARTLEN_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "init-segment", NULL,
+                INITSEG_TEXT, INITSEG_LONGTEXT )
+    add_bool( SOUT_CFG_PREFIX "can-block-reload", false,
+              BLOCKRELOAD_TEXT, BLOCKRELOAD_LONGTEXT )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -156,12 +185,24 @@ static const char *const ppsz_sout_options[] = {
     "key-loadfile",
     "generate-iv",
     "initial-segment-number",
+    "cmaf",
+    "part-length",
+    "init-segment",
+    "can-block-reload",
     NULL
 };
 
 static ssize_t Write( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
+typedef struct
+{
+    vlc_tick_t length;
+    uint64_t i_offset;
+    size_t i_size;
+    bool b_independent;
+} output_part_t;
+
 typedef struct output_segment
 {
     char *psz_filename;
@@ -171,6 +212,9 @@ typedef struct output_segment
     vlc_tick_t segment_length;
     uint32_t i_segment_number;
     uint8_t aes_ivs[16];
+    /* CMAF partial segments, as byte ranges of the segment file */
+    output_part_t *p_parts;
+    size_t i_parts;
 } output_segment_t;
 
 typedef struct
@@ -202,6 +246,16 @@ typedef struct
     uint8_t stuffing_bytes[16];
     ssize_t stuffing_size;
     vlc_array_t segments_t;
+    /* CMAF output */
+    bool b_cmaf;
+    bool b_can_block_reload;
+    bool b_part_independent;
+    char *psz_initPath;
+    char *psz_initUri;
+    vlc_tick_t part_max_length;
+    uint64_t i_segment_size;
+    block_t *ongoing_part;
+    block_t **ongoing_part_end;
 } sout_access_out_sys_t;
 
 static int LoadCryptFile( sout_access_out_t *p_access);
@@ -209,6 +263,8 @@ static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
 static ssize_t writeSegment( sout_access_out_t *p_access );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
+static char *formatInitPath( const char *psz_path );
+static int writePart( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
 /*****************************************************************************
  * Open: open the file
  *****************************************************************************/
@@ -247,6 +303,12 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_caching = var_GetBool( p_access, SOUT_CFG_PREFIX "caching") ;
     p_sys->b_generate_iv = var_GetBool( p_access, SOUT_CFG_PREFIX "generate-iv") ;
     p_sys->b_segment_has_data = false;
+    p_sys->b_cmaf = var_GetBool( p_access, SOUT_CFG_PREFIX "cmaf" );
+    p_sys->b_can_block_reload = var_GetBool( p_access, SOUT_CFG_PREFIX "can-block-reload" );
+    p_sys->part_max_length =
+        VLC_TICK_FROM_MS( var_GetInteger( p_access, SOUT_CFG_PREFIX "part-length" ) );
+    p_sys->ongoing_part = NULL;
+    p_sys->ongoing_part_end = &p_sys->ongoing_part;
 
     vlc_array_init( &p_sys->segments_t );
 
@@ -275,6 +337,37 @@ static int Open( vlc_object_t *p_this )
 
     p_access->p_sys = p_sys;
 
+    if( p_sys->b_cmaf )
+    {
+        /* the partial segments are byte ranges of the segment files */
+        bool b_error = p_sys->psz_keyfile || p_sys->key_uri;
+        if( b_error )
+            msg_Err( p_access, "encryption is not supported with CMAF segments" );
+        else
+        {
+            char *psz_init = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "init-segment" );
+            if( !psz_init )
+                psz_init = strdup( p_access->psz_path );
+            p_sys->psz_initPath = formatInitPath( psz_init );
+            p_sys->psz_initUri = formatInitPath( p_sys->psz_indexUrl ? p_sys->psz_indexUrl
+                                                                     : psz_init );
+            free( psz_init );
+            b_error = !p_sys->psz_initPath || !p_sys->psz_initUri;
+        }
+
+        if( b_error )
+        {
+            free( p_sys->psz_initPath );
+            free( p_sys->psz_initUri );
+            free( p_sys->psz_keyfile );
+            free( p_sys->key_uri );
+            free( p_sys->psz_indexUrl );
+            free( p_sys->psz_indexPath );
+            free( p_sys );
+            return VLC_EGENERIC;
+        }
+    }
+
     if( p_sys->psz_keyfile && ( LoadCryptFile( p_access ) < 0 ) )
     {
         free( p_sys->psz_indexUrl );
@@ -499,8 +592,48 @@ static char *formatSegmentPath( char *psz_path, uint32_t i_seg )
     return psz_result;
 }
 
+/*****************************************************************************
+ * formatInitPath: create the initialization segment path name
+ *****************************************************************************/
+static char *formatInitPath( const char *psz_path )
+{
+    char *psz_result;
+
+    if ( !psz_path || ! ( psz_result = vlc_strftime( psz_path ) ) )
+        return NULL;
+
+    char *psz_firstNumSign = psz_result + strcspn( psz_result, SEG_NUMBER_PLACEHOLDER );
+    if ( *psz_firstNumSign )
+    {
+        char *psz_newResult;
+        int i_cnt = strspn( psz_firstNumSign, SEG_NUMBER_PLACEHOLDER );
+        int ret;
+
+        *psz_firstNumSign = '\0';
+        ret = asprintf( &psz_newResult, "%sinit%s", psz_result, psz_firstNumSign + i_cnt );
+        free ( psz_result );
+        if ( ret < 0 )
+            return NULL;
+        psz_result = psz_newResult;
+    }
+
+    return psz_result;
+}
+
+/*****************************************************************************
+ * formatSeconds: locale independent duration with millisecond precision
+ *****************************************************************************/
+static const char *formatSeconds( char psz[32], vlc_tick_t duration )
+{
+    int64_t i_ms = MS_FROM_VLC_TICK( duration );
+
+    snprintf( psz, 32, "%"PRId64".%03u", i_ms / 1000, (unsigned)( i_ms % 1000 ) );
+    return psz;
+}
+
 static void destroySegment( output_segment_t *segment )
 {
+    free( segment->p_parts );
     free( segment->psz_filename );
     free( segment->psz_duration );
     free( segment->psz_uri );
@@ -550,6 +683,69 @@ static bool isFirstItemRemovable( sout_access_out_sys_t *p_sys, uint32_t i_first
     return duration >= (first->segment_length + (p_sys->i_numsegs * p_sys->segment_max_length));
 }
 
+/************************************************************************
+ * writeCmafHeader: write the low latency and initialization segment tags
+ ************************************************************************/
+static int writeCmafHeader( FILE *fp, sout_access_out_sys_t *p_sys )
+{
+    char psz_target[32], psz_holdback[32];
+
+    return fprintf( fp, "#EXT-X-PART-INF:PART-TARGET=%s\n"
+                        "#EXT-X-SERVER-CONTROL:%sPART-HOLD-BACK=%s\n"
+                        "#EXT-X-MAP:URI=\"%s\"\n",
+                    formatSeconds( psz_target, p_sys->part_max_length ),
+                    p_sys->b_can_block_reload ? "CAN-BLOCK-RELOAD=YES," : "",
+                    formatSeconds( psz_holdback, 3 * p_sys->part_max_length ),
+                    p_sys->psz_initUri );
+}
+
+/************************************************************************
+ * writeCmafParts: list the partial segments of a segment
+ ************************************************************************/
+static int writeCmafParts( FILE *fp, const output_segment_t *segment )
+{
+    for( size_t i = 0; i < segment->i_parts; i++ )
+    {
+        const output_part_t *part = &segment->p_parts[i];
+        char psz_duration[32];
+
+        if( fprintf( fp, "#EXT-X-PART:DURATION=%s,URI=\"%s\",BYTERANGE=\"%zu@%"PRIu64"\"%s\n",
+                     formatSeconds( psz_duration, part->length ), segment->psz_uri,
+                     part->i_size, part->i_offset,
+                     part->b_independent ? ",INDEPENDENT=YES" : "" ) < 0 )
+            return -1;
+    }
+    return 0;
+}
+
+/************************************************************************
+ * writeCmafHint: announce the next partial segment
+ ************************************************************************/
+static int writeCmafHint( sout_access_out_t *p_access, FILE *fp, sout_access_out_sys_t *p_sys )
+{
+    char *psz_uri;
+    uint64_t i_start = 0;
+
+    if( p_sys->i_handle >= 0 )
+    {
+        output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, vlc_array_count( &p_sys->segments_t ) - 1 );
+        psz_uri = segment->psz_uri ? strdup( segment->psz_uri ) : NULL;
+        i_start = p_sys->i_segment_size;
+    }
+    else
+    {
+        char *psz_idxFormat = p_sys->psz_indexUrl ? p_sys->psz_indexUrl : p_access->psz_path;
+        psz_uri = formatSegmentPath( psz_idxFormat, p_sys->i_segment + 1 );
+    }
+    if( unlikely( !psz_uri ) )
+        return -1;
+
+    int ret = fprintf( fp, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\",BYTERANGE-START=%"PRIu64"\n",
+                       psz_uri, i_start );
+    free( psz_uri );
+    return ret;
+}
+
 /************************************************************************
  * updateIndexAndDel: If necessary, update index file & delete old segments
  ************************************************************************/
@@ -588,12 +784,15 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             return -1;
         }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+        /* fMP4 segments need EXT-X-MAP, thus version 6 */
+        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
                           "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
+                          p_sys->b_cmaf ? 6 : 3,
                           p_sys->b_caching ? "YES" : "NO",
                           p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
                           i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
-                          ) < 0 )
+                          ) < 0 ||
+             ( p_sys->b_cmaf && writeCmafHeader( fp, p_sys ) < 0 ) )
         {
             free( psz_idxTmp );
             fclose( fp );
@@ -641,7 +840,13 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 }
             }
 
-            val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
+            /* only the segments close to the live edge list their parts,
+             * the segment being written has nothing else */
+            val = 0;
+            if ( p_sys->b_cmaf && i + 3 > p_sys->i_segment )
+                val = writeCmafParts( fp, segment );
+            if ( val >= 0 && segment->psz_duration )
+                val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
             if ( val < 0 )
             {
                 free( psz_current_uri );
@@ -652,6 +857,13 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
         }
         free( psz_current_uri );
 
+        if ( p_sys->b_cmaf && !b_isend && writeCmafHint( p_access, fp, p_sys ) < 0 )
+        {
+            free( psz_idxTmp );
+            fclose( fp );
+            return -1;
+        }
+
         if ( b_isend )
         {
             if ( fputs ( STR_ENDLIST, fp ) < 0)
@@ -757,38 +969,48 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    if( p_sys->ongoing_segment )
-        block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
-    p_sys->ongoing_segment = NULL;
-    p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
-
-    block_t *output_block = p_sys->full_segments;
-    p_sys->full_segments = NULL;
-    p_sys->full_segments_end = &p_sys->full_segments;
-
-    while( output_block )
+    if( p_sys->b_cmaf )
     {
-        block_t *p_next = output_block->p_next;
-        output_block->p_next = NULL;
-
-        Write( p_access, output_block );
-        output_block = p_next;
+        if( p_sys->ongoing_part && writePart( p_access, p_sys ) < 0 )
+            msg_Err( p_access, "Error writing the last partial segment" );
+        if( p_sys->i_handle < 0 )
+            updateIndexAndDel( p_access, p_sys, true );
     }
-    if( p_sys->ongoing_segment )
+    else
     {
-        block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
+        if( p_sys->ongoing_segment )
+            block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
         p_sys->ongoing_segment = NULL;
         p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
-    }
 
-    ssize_t writevalue = writeSegment( p_access );
-    msg_Dbg( p_access, "Writing.. %zd", writevalue );
-    if( unlikely( writevalue < 0 ) )
-    {
-        if( p_sys->full_segments )
-            block_ChainRelease( p_sys->full_segments );
+        block_t *output_block = p_sys->full_segments;
+        p_sys->full_segments = NULL;
+        p_sys->full_segments_end = &p_sys->full_segments;
+
+        while( output_block )
+        {
+            block_t *p_next = output_block->p_next;
+            output_block->p_next = NULL;
+
+            Write( p_access, output_block );
+            output_block = p_next;
+        }
         if( p_sys->ongoing_segment )
-            block_ChainRelease( p_sys->ongoing_segment );
+        {
+            block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
+            p_sys->ongoing_segment = NULL;
+            p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+        }
+
+        ssize_t writevalue = writeSegment( p_access );
+        msg_Dbg( p_access, "Writing.. %zd", writevalue );
+        if( unlikely( writevalue < 0 ) )
+        {
+            if( p_sys->full_segments )
+                block_ChainRelease( p_sys->full_segments );
+            if( p_sys->ongoing_segment )
+                block_ChainRelease( p_sys->ongoing_segment );
+        }
     }
 
     closeCurrentSegment( p_access, p_sys, true );
@@ -812,6 +1034,8 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    free( p_sys->psz_initPath );
+    free( p_sys->psz_initUri );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -1006,6 +1230,201 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     return i_write;
 }
 
+static ssize_t writeBlocks( int fd, block_t *output )
+{
+    ssize_t i_write = 0;
+    while( output )
+    {
+        ssize_t val = vlc_write( fd, output->p_buffer, output->i_buffer );
+        if ( val == -1 )
+        {
+           if ( errno == EINTR )
+              continue;
+           block_ChainRelease( output );
+           return -1;
+        }
+
+        if ( (size_t)val >= output->i_buffer )
+        {
+           block_t *p_next = output->p_next;
+           block_Release (output);
+           output = p_next;
+        }
+        else
+        {
+           output->p_buffer += val;
+           output->i_buffer -= val;
+        }
+        i_write += val;
+    }
+    return i_write;
+}
+
+/*****************************************************************************
+ * chainSpan: media time covered by the samples of a fragmented MP4 chain
+ *****************************************************************************/
+static vlc_tick_t chainSpan( const block_t *p_chain )
+{
+    /* the tracks are interleaved, summing the lengths would count the
+     * duration once per track */
+    vlc_tick_t i_start = VLC_TICK_INVALID, i_end = VLC_TICK_INVALID;
+
+    for( ; p_chain; p_chain = p_chain->p_next )
+    {
+        if( p_chain->i_dts == VLC_TICK_INVALID )
+            continue;
+        if( i_start == VLC_TICK_INVALID || p_chain->i_dts < i_start )
+            i_start = p_chain->i_dts;
+        if( i_end == VLC_TICK_INVALID || p_chain->i_dts + p_chain->i_length > i_end )
+            i_end = p_chain->i_dts + p_chain->i_length;
+    }
+    return i_start == VLC_TICK_INVALID ? 0 : i_end - i_start;
+}
+
+/*****************************************************************************
+ * writeInitSegment: write the ftyp and moov boxes of a CMAF stream
+ *****************************************************************************/
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_header )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    int fd = vlc_open( p_sys->psz_initPath, O_WRONLY | O_CREAT | O_LARGEFILE |
+                       O_TRUNC, 0666 );
+    if ( fd == -1 )
+    {
+        msg_Err( p_access, "cannot open `%s' (%s)", p_sys->psz_initPath,
+                 vlc_strerror_c(errno) );
+        block_ChainRelease( p_header );
+        return -1;
+    }
+
+    ssize_t val = writeBlocks( fd, p_header );
+    vlc_close( fd );
+    if ( val < 0 )
+    {
+        msg_Err( p_access, "cannot write `%s'", p_sys->psz_initPath );
+        return -1;
+    }
+    msg_Dbg( p_access, "LiveHttpInitComplete: %s", p_sys->psz_initPath );
+    return 0;
+}
+
+/*****************************************************************************
+ * writePart: append the ongoing partial segment to the segment file
+ *****************************************************************************/
+static int writePart( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys )
+{
+    block_t *p_part = p_sys->ongoing_part;
+    const vlc_tick_t length = chainSpan( p_part );
+
+    p_sys->ongoing_part = NULL;
+    p_sys->ongoing_part_end = &p_sys->ongoing_part;
+
+    if ( p_sys->i_handle < 0 )
+    {
+        if ( openNextFile( p_access, p_sys ) < 0 )
+        {
+            block_ChainRelease( p_part );
+            return -1;
+        }
+        p_sys->i_segment_size = 0;
+        p_sys->current_segment_length = 0;
+    }
+
+    output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, vlc_array_count( &p_sys->segments_t ) - 1 );
+    output_part_t *p_parts = vlc_reallocarray( segment->p_parts, segment->i_parts + 1,
+                                               sizeof( *p_parts ) );
+    if ( unlikely( !p_parts ) )
+    {
+        block_ChainRelease( p_part );
+        return -1;
+    }
+    segment->p_parts = p_parts;
+
+    ssize_t i_size = writeBlocks( p_sys->i_handle, p_part );
+    if ( i_size < 0 )
+    {
+        msg_Err( p_access, "cannot write `%s'", segment->psz_filename );
+        return -1;
+    }
+
+    p_parts[segment->i_parts++] = (output_part_t) {
+        .length = length,
+        .i_offset = p_sys->i_segment_size,
+        .i_size = i_size,
+        .b_independent = p_sys->b_part_independent,
+    };
+    p_sys->i_segment_size += i_size;
+    p_sys->current_segment_length += length;
+    segment->segment_length = p_sys->current_segment_length;
+    return 0;
+}
+
+static bool isMoof( const block_t *p_block )
+{
+    return p_block->i_buffer >= 8 && !memcmp( &p_block->p_buffer[4], "moof", 4 );
+}
+
+/*****************************************************************************
+ * WriteCmaf: gather the fragments into partial segments
+ *****************************************************************************/
+static ssize_t WriteCmaf( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    size_t i_write = 0;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    while( p_buffer )
+    {
+        block_t *p_block = p_buffer;
+        p_buffer = p_buffer->p_next;
+        p_block->p_next = NULL;
+        i_write += p_block->i_buffer;
+
+        if( p_block->i_flags & BLOCK_FLAG_HEADER )
+        {
+            if( writeInitSegment( p_access, p_block ) < 0 )
+            {
+                block_ChainRelease( p_buffer );
+                return -1;
+            }
+            continue;
+        }
+
+        /* Parts end on fragment boundaries, segments on fragments a client
+         * can start from, which the muxer flags as keyframes */
+        if( p_sys->ongoing_part && isMoof( p_block ) )
+        {
+            const vlc_tick_t part_length = chainSpan( p_sys->ongoing_part );
+            const vlc_tick_t segment_length =
+                p_sys->i_handle >= 0 ? p_sys->current_segment_length : 0;
+            const bool b_segment_end =
+                ( p_sys->b_splitanywhere || ( p_block->i_flags & BLOCK_FLAG_TYPE_I ) ) &&
+                segment_length + part_length >= p_sys->segment_max_length;
+
+            if( b_segment_end || part_length >= p_sys->part_max_length )
+            {
+                if( writePart( p_access, p_sys ) < 0 )
+                {
+                    msg_Err( p_access, "Error in write loop");
+                    block_Release( p_block );
+                    block_ChainRelease( p_buffer );
+                    return -1;
+                }
+
+                if( b_segment_end )
+                    closeCurrentSegment( p_access, p_sys, false );
+                else
+                    updateIndexAndDel( p_access, p_sys, false );
+            }
+        }
+
+        if( !p_sys->ongoing_part )
+            p_sys->b_part_independent = ( p_block->i_flags & BLOCK_FLAG_TYPE_I ) != 0;
+        block_ChainLastAppend( &p_sys->ongoing_part_end, p_block );
+    }
+
+    return i_write;
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -1013,6 +1432,10 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
     size_t i_write = 0;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_sys->b_cmaf )
+        return WriteCmaf( p_access, p_buffer );
+
     while( p_buffer )
     {
         /* Check if current block is already past segment-length
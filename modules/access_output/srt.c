@@ -24,27 +24,49 @@
 
 #include <srt_common.h>
 
-#include <vlc_interrupt.h>
 #include <vlc_fs.h>
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
 #include <vlc_block.h>
-#include <vlc_block_helper.h>
 #include <vlc_network.h>
+#include <vlc_queue.h>
+
+#if SRT_VERSION_VALUE >= SRT_MAKE_VERSION_VALUE(1, 5, 0)
+# define HAVE_SRT_GROUPS 1
+#endif
+
+#define SRT_PARAM_GROUP       "srt-group"
+#define SRT_PARAM_GROUP_LINKS "srt-group-links"
+
+/* Queued data above which the oldest is dropped */
+#define SRT_MAX_PENDING_SIZE (4 << 20)
+#define SRT_STATS_INTERVAL VLC_TICK_FROM_SEC(5)
 
 typedef struct
 {
-    SRTSOCKET     sock;
+    SRTSOCKET     sock; /* socket, or socket group */
     int           i_poll_id;
     bool          b_interrupted;
     vlc_mutex_t   lock;
     int           i_payload_size;
-    block_bytestream_t block_stream;
+    int           i_poll_timeout;
+
+    /* Sender thread */
+    vlc_thread_t  thread;
+    vlc_queue_t   queue;
+    bool          dead;
+    block_t      *p_pending; /* dequeued but not sent yet */
+    block_t     **pp_pending_last;
+    size_t        i_pending_size;
+    vlc_tick_t    i_stats_date;
+
+#ifdef HAVE_SRT_GROUPS
+    int           i_group_type; /* -1 for a single link */
+#endif
 } sout_access_out_sys_t;
 
-static void srt_wait_interrupted(void *p_data)
+static void srt_wait_interrupted(sout_access_out_t *p_access)
 {
-    sout_access_out_t *p_access = p_data;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
     vlc_mutex_lock( &p_sys->lock );
@@ -61,6 +83,92 @@ static void srt_wait_interrupted(void *p_data)
     vlc_mutex_unlock( &p_sys->lock );
 }
 
+#ifdef HAVE_SRT_GROUPS
+static const char *const srt_group_names[] = { "", "broadcast", "backup" };
+static const char *const srt_group_texts[] = {
+    N_("None"), N_("Broadcast"), N_("Backup") };
+static const int srt_group_types[] = {
+    -1, SRT_GTYPE_BROADCAST, SRT_GTYPE_BACKUP };
+
+static int srt_group_type( sout_access_out_t *p_access )
+{
+    char *psz_group = var_InheritString( p_access, SRT_PARAM_GROUP );
+    int type = -1;
+
+    if ( psz_group != NULL )
+    {
+        for ( size_t i = 0; i < ARRAY_SIZE(srt_group_names); i++ )
+            if ( strcmp( psz_group, srt_group_names[i] ) == 0 )
+                type = srt_group_types[i];
+        free( psz_group );
+    }
+    return type;
+}
+
+/* Connects the socket group to the destination and to each additional
+ * link, given as a comma-separated list of host:port. */
+static int srt_connect_links( sout_access_out_t *p_access,
+                              const struct addrinfo *dst )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char *psz_links = var_InheritString( p_access, SRT_PARAM_GROUP_LINKS );
+    struct addrinfo *links[16];
+    SRT_SOCKGROUPCONFIG configs[1 + ARRAY_SIZE(links)];
+    size_t count = 0;
+    int stat;
+
+    configs[0] = srt_prepare_endpoint( NULL, dst->ai_addr, dst->ai_addrlen );
+
+    for ( char *psz_link = psz_links, *psz_save = NULL;
+          (psz_link = strtok_r( psz_link, ",", &psz_save )) != NULL;
+          psz_link = NULL )
+    {
+        struct addrinfo hints = { .ai_socktype = SOCK_DGRAM };
+        int i_port = SRT_DEFAULT_PORT;
+        char *psz_port = psz_link;
+
+        if ( count >= ARRAY_SIZE(links) )
+        {
+            msg_Warn( p_access, "Too many SRT links, ignoring %s", psz_link );
+            break;
+        }
+
+        if ( psz_port[0] == '[' )
+        {
+            psz_link++;
+            psz_port = strchr( psz_port, ']' );
+            if ( psz_port != NULL )
+                *psz_port++ = '\0';
+        }
+        if ( psz_port != NULL && (psz_port = strchr( psz_port, ':' )) != NULL )
+        {
+            *psz_port++ = '\0';
+            i_port = atoi( psz_port );
+        }
+
+        stat = vlc_getaddrinfo( psz_link, i_port, &hints, &links[count] );
+        if ( stat )
+        {
+            msg_Warn( p_access, "Cannot resolve [%s]:%d (reason: %s)",
+                      psz_link, i_port, gai_strerror( stat ) );
+            continue;
+        }
+
+        configs[1 + count] = srt_prepare_endpoint( NULL, links[count]->ai_addr,
+                                                   links[count]->ai_addrlen );
+        count++;
+    }
+    free( psz_links );
+
+    msg_Dbg( p_access, "Connecting SRT group over %zu links", 1 + count );
+    stat = srt_connect_group( p_sys->sock, configs, 1 + count );
+
+    for ( size_t i = 0; i < count; i++ )
+        freeaddrinfo( links[i] );
+    return stat;
+}
+#endif
+
 static bool srt_schedule_reconnect(sout_access_out_t *p_access)
 {
     vlc_object_t *access_obj = (vlc_object_t *) p_access;
@@ -121,7 +229,12 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
         srt_close( p_sys->sock );
     }
 
-    p_sys->sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
+#ifdef HAVE_SRT_GROUPS
+    if ( p_sys->i_group_type != -1 )
+        p_sys->sock = srt_create_group( p_sys->i_group_type );
+    else
+#endif
+        p_sys->sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
     if ( p_sys->sock == SRT_INVALID_SOCK )
     {
         msg_Err( p_access, "Failed to open socket." );
@@ -210,7 +323,12 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
     msg_Dbg( p_access, "Schedule SRT connect (dest addresss: %s, port: %d).",
         psz_dst_addr, i_dst_port );
 
-    stat = srt_connect( p_sys->sock, res->ai_addr, res->ai_addrlen );
+#ifdef HAVE_SRT_GROUPS
+    if ( p_sys->i_group_type != -1 )
+        stat = srt_connect_links( p_access, res );
+    else
+#endif
+        stat = srt_connect( p_sys->sock, res->ai_addr, res->ai_addrlen );
     if ( stat == SRT_ERROR )
     {
         msg_Err( p_access, "Failed to connect to server (reason: %s)",
@@ -237,36 +355,182 @@ out:
     return !failed;
 }
 
-static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+static void srt_report_stats( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    SRT_TRACEBSTATS stats;
+
+    if ( srt_bstats( p_sys->sock, &stats, 1 ) == SRT_ERROR )
+        return;
+
+    msg_Dbg( p_access, "SRT sent %"PRId64" packets (%d lost, "
+             "%d retransmitted, %d dropped), %.2f Mbit/s, RTT %.1f ms",
+             (int64_t) stats.pktSent, (int) stats.pktSndLoss,
+             (int) stats.pktRetrans, (int) stats.pktSndDrop,
+             stats.mbpsSendRate, stats.msRTT );
+
+#ifdef HAVE_SRT_GROUPS
+    if ( p_sys->i_group_type == -1 )
+        return;
+
+    static const char *const states[] = {
+        [SRT_GST_PENDING] = "pending", [SRT_GST_IDLE] = "idle",
+        [SRT_GST_RUNNING] = "running", [SRT_GST_BROKEN] = "broken",
+    };
+    SRT_SOCKGROUPDATA members[17];
+    size_t count = ARRAY_SIZE(members);
+
+    if ( srt_group_data( p_sys->sock, members, &count ) == SRT_ERROR )
+        return;
+
+    for ( size_t i = 0; i < count; i++ )
+    {
+        char addr[NI_MAXNUMERICHOST];
+        int port;
+
+        if ( vlc_getnameinfo( (struct sockaddr *) &members[i].peeraddr,
+                              sizeof (members[i].peeraddr), addr,
+                              sizeof (addr), &port, NI_NUMERICHOST ) )
+            strcpy( addr, "?" );
+
+        unsigned state = members[i].memberstate;
+        msg_Dbg( p_access, "SRT link [%s]:%d %s", addr, port,
+                 state < ARRAY_SIZE(states) && states[state] != NULL
+                 ? states[state] : "unknown" );
+    }
+#endif
+}
+
+/* Drops the given amount of data from the head of the pending data. */
+static void srt_consume( sout_access_out_sys_t *p_sys, size_t size )
+{
+    p_sys->i_pending_size -= size;
+
+    while ( p_sys->p_pending != NULL )
+    {
+        block_t *p_block = p_sys->p_pending;
+        size_t len = __MIN( p_block->i_buffer, size );
+
+        p_block->p_buffer += len;
+        p_block->i_buffer -= len;
+        size -= len;
+        if ( p_block->i_buffer > 0 )
+            break;
+
+        p_sys->p_pending = p_block->p_next;
+        block_Release( p_block );
+    }
+
+    if ( p_sys->p_pending == NULL )
+        p_sys->pp_pending_last = &p_sys->p_pending;
+}
+
+static void srt_flush( sout_access_out_sys_t *p_sys )
+{
+    block_ChainRelease( p_sys->p_pending );
+    p_sys->p_pending = NULL;
+    p_sys->pp_pending_last = &p_sys->p_pending;
+    p_sys->i_pending_size = 0;
+}
+
+/* Sends the pending data, one payload per SRT message, as long as the
+ * socket accepts it. A payload is sent straight from the block holding it
+ * unless it spans several blocks.
+ *
+ * Returns 0 once everything is sent, 1 if the sending buffer is full,
+ * -1 on error. */
+static int srt_send_pending( sout_access_out_t *p_access )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    int i_poll_timeout = var_InheritInteger( p_access, SRT_PARAM_POLL_TIMEOUT );
-    bool b_interrupted = false;
-    ssize_t i_len = 0;
-    int chunk_size;
     uint8_t chunk[SRT_LIVE_MAX_PLSIZE];
 
-    if ( p_buffer == NULL )
-        return 0;
-    block_BytestreamPush( &p_sys->block_stream, p_buffer );
+    while ( p_sys->i_pending_size > 0 )
+    {
+        block_t *p_block = p_sys->p_pending;
+        size_t payload = __MIN( p_sys->i_pending_size,
+                                (size_t) p_sys->i_payload_size );
+        const uint8_t *data;
+
+        if ( p_block->i_buffer >= payload )
+            data = p_block->p_buffer;
+        else
+        {
+            size_t size = 0;
+
+            for ( ; size < payload; p_block = p_block->p_next )
+            {
+                size_t len = __MIN( p_block->i_buffer, payload - size );
+
+                memcpy( chunk + size, p_block->p_buffer, len );
+                size += len;
+            }
+            data = chunk;
+        }
+
+        if ( srt_sendmsg2( p_sys->sock, (const char *) data, payload,
+                           NULL ) == SRT_ERROR )
+        {
+            if ( srt_getlasterror( NULL ) == SRT_EASYNCSND )
+                return 1;
 
-    vlc_interrupt_register( srt_wait_interrupted, p_access);
+            msg_Warn( p_access, "send error: %s", srt_getlasterror_str() );
+            return -1;
+        }
+        srt_consume( p_sys, payload );
+    }
+    return 0;
+}
+
+static void *Thread( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    while( true )
+    for ( ;; )
     {
-        /* We can leave the remaining bytes less than i_payload_size for next
-         * Write() round, but it will add delay.
-         */
-        chunk_size = __MIN( block_BytestreamRemaining( &p_sys->block_stream ),
-                            p_sys->i_payload_size );
-        if ( chunk_size == 0 )
+        block_t *p_block = NULL;
+
+        if ( p_sys->p_pending == NULL )
+        {
+            p_block = vlc_queue_DequeueKillable( &p_sys->queue, &p_sys->dead );
+            if ( p_block == NULL )
+                break;
+        }
+
+        /* Take everything queued meanwhile in the same batch */
+        vlc_queue_Lock( &p_sys->queue );
+        if ( p_sys->dead )
+        {
+            vlc_queue_Unlock( &p_sys->queue );
+            if ( p_sys->p_pending == NULL )
+                block_ChainRelease( p_block );
             break;
+        }
+        if ( p_sys->p_pending != NULL )
+            p_block = vlc_queue_DequeueAllUnlocked( &p_sys->queue );
+        else
+            p_block->p_next = vlc_queue_DequeueAllUnlocked( &p_sys->queue );
+        vlc_queue_Unlock( &p_sys->queue );
+
+        for ( ; p_block != NULL; p_block = p_block->p_next )
+        {
+            *p_sys->pp_pending_last = p_block;
+            p_sys->pp_pending_last = &p_block->p_next;
+            p_sys->i_pending_size += p_block->i_buffer;
+        }
 
-        if ( vlc_killed() )
+        if ( p_sys->i_pending_size > SRT_MAX_PENDING_SIZE )
         {
-            /* We are told to stop. Stop. */
-            i_len = VLC_EGENERIC;
-            goto out;
+            msg_Warn( p_access, "SRT link too slow, dropping %zu bytes",
+                      p_sys->i_pending_size - SRT_MAX_PENDING_SIZE );
+            srt_consume( p_sys, p_sys->i_pending_size - SRT_MAX_PENDING_SIZE );
+        }
+
+        vlc_tick_t now = vlc_tick_now();
+        if ( now >= p_sys->i_stats_date )
+        {
+            srt_report_stats( p_access );
+            p_sys->i_stats_date = now + SRT_STATS_INTERVAL;
         }
 
         switch( srt_getsockstate( p_sys->sock ) )
@@ -283,82 +547,50 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
                 /* Fall-through */
             default:
                 /* Not ready */
-                i_len = VLC_EGENERIC;
-                goto out;
+                srt_flush( p_sys );
+                continue;
         }
 
+        int val = srt_send_pending( p_access );
+        if ( val < 0 )
+            srt_flush( p_sys );
+        if ( val <= 0 )
+            continue;
+
+        /* Wait for the sending buffer to drain */
         SRTSOCKET ready[1];
         int readycnt = 1;
         if ( srt_epoll_wait( p_sys->i_poll_id,
             0, 0, &ready[0], &readycnt,
-            i_poll_timeout, NULL, 0, NULL, 0 ) < 0)
+            p_sys->i_poll_timeout, NULL, 0, NULL, 0 ) < 0 )
         {
-            if ( vlc_killed() )
-            {
-                /* We are told to stop. Stop. */
-                i_len = VLC_EGENERIC;
-                goto out;
-            }
-
-            /* if 'srt_epoll_wait' is interrupted, we still need to
-            *  finish sending current block or it may be sent only
-            *  partially. TODO: this delay can be prevented,
-            *  possibly with a FIFO and an additional thread.
-            */
             vlc_mutex_lock( &p_sys->lock );
             if ( p_sys->b_interrupted )
             {
                 srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
                     &(int) { SRT_EPOLL_ERR | SRT_EPOLL_OUT });
                 p_sys->b_interrupted = false;
-                b_interrupted = true;
-            }
-            vlc_mutex_unlock( &p_sys->lock );
-
-            if ( !b_interrupted )
-            {
-                continue;
-            }
-            else
-            {
                 msg_Dbg( p_access, "srt_epoll_wait was interrupted");
             }
-        }
-
-        if ( readycnt > 0  && ready[0] == p_sys->sock
-            && srt_getsockstate( p_sys->sock ) == SRTS_CONNECTED)
-        {
-            if ( block_GetBytes( &p_sys->block_stream, chunk,
-                                 chunk_size ) != VLC_SUCCESS )
-                break;
-            if (srt_sendmsg2( p_sys->sock,
-                (char *)chunk, chunk_size, 0 ) == SRT_ERROR )
-            {
-                msg_Warn( p_access, "send error: %s", srt_getlasterror_str() );
-                i_len = VLC_EGENERIC;
-                goto out;
-            }
-            else
-            {
-                i_len += chunk_size;
-            }
+            vlc_mutex_unlock( &p_sys->lock );
         }
     }
 
-out:
-    block_BytestreamEmpty( &p_sys->block_stream );
-    vlc_interrupt_unregister();
+    srt_flush( p_sys );
+    return NULL;
+}
 
-    /* Re-add the socket to the poll if we were interrupted */
-    vlc_mutex_lock( &p_sys->lock );
-    if ( p_sys->b_interrupted )
-    {
-        srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
-            &(int) { SRT_EPOLL_ERR | SRT_EPOLL_OUT } );
-        p_sys->b_interrupted = false;
-    }
-    vlc_mutex_unlock( &p_sys->lock );
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t i_len = 0;
+
+    for ( const block_t *p_block = p_buffer; p_block != NULL;
+          p_block = p_block->p_next )
+        i_len += p_block->i_buffer;
 
+    /* The sender thread takes it from here */
+    vlc_queue_Enqueue( &p_sys->queue, p_buffer );
     return i_len;
 }
 
@@ -403,7 +635,16 @@ static int Open( vlc_object_t *p_this )
     srt_startup();
 
     vlc_mutex_init( &p_sys->lock );
-    block_BytestreamInit( &p_sys->block_stream );
+    vlc_queue_Init( &p_sys->queue, offsetof (block_t, p_next) );
+    p_sys->dead = false;
+    p_sys->p_pending = NULL;
+    p_sys->pp_pending_last = &p_sys->p_pending;
+    p_sys->i_pending_size = 0;
+    p_sys->i_stats_date = vlc_tick_now() + SRT_STATS_INTERVAL;
+    p_sys->i_poll_timeout = var_InheritInteger( p_access, SRT_PARAM_POLL_TIMEOUT );
+#ifdef HAVE_SRT_GROUPS
+    p_sys->i_group_type = srt_group_type( p_access );
+#endif
 
     p_access->p_sys = p_sys;
 
@@ -423,6 +664,10 @@ static int Open( vlc_object_t *p_this )
         goto failed;
     }
 
+    if ( vlc_clone( &p_sys->thread, Thread, p_access,
+                    VLC_THREAD_PRIORITY_HIGHEST ) )
+        goto failed;
+
     p_access->pf_write = Write;
     p_access->pf_control = Control;
 
@@ -440,10 +685,14 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t     *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
+    vlc_queue_Kill( &p_sys->queue, &p_sys->dead );
+    srt_wait_interrupted( p_access );
+    vlc_join( p_sys->thread, NULL );
+
     srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
     srt_close( p_sys->sock );
     srt_epoll_release( p_sys->i_poll_id );
-    block_BytestreamRelease( &p_sys->block_stream );
+    block_ChainRelease( vlc_queue_DequeueAll( &p_sys->queue ) );
 
     srt_cleanup();
 }
@@ -475,6 +724,16 @@ vlc_module_begin()
     add_string(SRT_PARAM_STREAMID, "",
             N_(" SRT Stream ID"), NULL)
     change_safe()
+#ifdef HAVE_SRT_GROUPS
+    add_string( SRT_PARAM_GROUP, "", N_( "SRT connection bonding" ),
+            N_( "Send over several links with a socket group: the same "
+                "packets on every link (broadcast), or on the main link with "
+                "the others on standby (backup)." ) )
+        change_string_list( srt_group_names, srt_group_texts )
+    add_string( SRT_PARAM_GROUP_LINKS, "", N_( "SRT bonded links" ),
+            N_( "Comma-separated list of additional host:port destinations "
+                "of the socket group." ) )
+#endif
 
     set_capability( "sout access", 0 )
     add_shortcut( "srt" )
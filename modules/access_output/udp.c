@@ -39,6 +39,7 @@
 #include <vlc_queue.h>
 #include <vlc_sout.h>
 #include <vlc_block.h>
+#include <vlc_list.h>
 
 #ifdef _WIN32
 #   include <winsock2.h>
@@ -47,10 +48,19 @@
 #   include <sys/socket.h>
 #endif
 
+#ifdef HAVE_NETINET_UDP_H
+#   include <netinet/udp.h>
+#endif
+
 #include <vlc_network.h>
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Maximum number of packets sent per system call */
+#define VLEN 32
+/* Maximum payload of a segmented (GSO) datagram */
+#define GSO_MAX_SIZE 65000
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -71,6 +81,11 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define THREADS_TEXT N_("Shared sender threads")
+#define THREADS_LONGTEXT N_("Number of sender threads shared by all the " \
+                            "UDP outputs of the process, instead of one " \
+                            "thread per output. 0 disables sharing." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -78,6 +93,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_SOUT_ACO )
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "threads", 0, 0, 64,
+                            THREADS_TEXT, THREADS_LONGTEXT )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -91,6 +108,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "threads",
     NULL
 };
 
@@ -107,20 +125,59 @@ static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
 
+/* Sender thread shared by several outputs */
+struct udp_sender
+{
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait;
+    vlc_cond_t   idle;
+    struct vlc_list outputs;
+    unsigned     count;   /* outputs, protected by the pool lock */
+    bool         pending; /* packets were queued */
+    bool         busy;    /* the outputs are being served */
+    bool         quit;
+};
+
+/* Process-wide pool of shared sender threads */
+static struct
+{
+    vlc_mutex_t lock;
+    struct udp_sender *senders;
+    unsigned count;
+    unsigned refs;
+} udp_pool = { VLC_STATIC_MUTEX, NULL, 0, 0 };
+
 typedef struct
 {
     vlc_tick_t    i_caching;
     int           i_handle;
     bool          b_mtu_warning;
     bool          dead;
+    bool          b_gso;
     size_t        i_mtu;
 
     vlc_queue_t   queue;
     block_t      *p_buffer;
 
     vlc_thread_t  thread;
+
+    /* Shared sender thread, and its pacing state for this output */
+    struct udp_sender *sender;
+    sout_access_out_t *access;
+    struct vlc_list node;
+    unsigned      i_group;
+    int           i_to_send;
+    vlc_tick_t    i_date_last;
+    unsigned      i_dropped_packets;
+    block_t      *p_due; /* packet waiting for its date */
+    vlc_tick_t    i_due;
 } sout_access_out_sys_t;
 
+static int SenderAttach( sout_access_out_t *, unsigned );
+static void SenderDetach( sout_access_out_t * );
+static void SenderWake( struct udp_sender * );
+
 #define DEFAULT_PORT 1234
 
 /*****************************************************************************
@@ -208,9 +265,27 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
     p_sys->dead = false;
+#ifdef UDP_SEGMENT
+    p_sys->b_gso = true;
+#else
+    p_sys->b_gso = false;
+#endif
     vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
     p_sys->p_buffer = NULL;
+    p_sys->sender = NULL;
+    p_sys->access = p_access;
 
+    unsigned i_threads = var_GetInteger( p_access, SOUT_CFG_PREFIX "threads" );
+    if( i_threads > 0 )
+    {
+        if( SenderAttach( p_access, i_threads ) )
+        {
+            net_Close (i_handle);
+            free (p_sys);
+            return VLC_ENOMEM;
+        }
+    }
+    else
     if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
@@ -234,8 +309,17 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t     *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    vlc_queue_Kill(&p_sys->queue, &p_sys->dead);
-    vlc_join( p_sys->thread, NULL );
+    if( p_sys->sender != NULL )
+    {
+        SenderDetach( p_access );
+        block_ChainRelease( vlc_queue_DequeueAll( &p_sys->queue ) );
+        if( p_sys->p_due ) block_Release( p_sys->p_due );
+    }
+    else
+    {
+        vlc_queue_Kill(&p_sys->queue, &p_sys->dead);
+        vlc_join( p_sys->thread, NULL );
+    }
 
     if( p_sys->p_buffer ) block_Release( p_sys->p_buffer );
 
@@ -280,6 +364,25 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
             p_sys->b_mtu_warning = true;
         }
 
+        /* A block leaving no room for another TS packet, such as the ones
+         * gathered by the TS muxer, is a datagram on its own: queue it
+         * without copying */
+        if( p_sys->p_buffer == NULL && p_buffer->i_buffer <= p_sys->i_mtu
+         && p_buffer->i_buffer + 188 > p_sys->i_mtu )
+        {
+            if( p_buffer->i_dts + p_sys->i_caching < now )
+            {
+                msg_Dbg( p_access, "late packet for udp input (%"PRId64 ")",
+                         now - p_buffer->i_dts - p_sys->i_caching );
+            }
+            i_len += p_buffer->i_buffer;
+            p_next = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            vlc_queue_Enqueue(&p_sys->queue, p_buffer);
+            p_buffer = p_next;
+            continue;
+        }
+
         /* Check if there is enough space in the buffer */
         if( p_sys->p_buffer &&
             p_sys->p_buffer->i_buffer + p_buffer->i_buffer > p_sys->i_mtu )
@@ -342,9 +445,134 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
         p_buffer = p_next;
     }
 
+    if( p_sys->sender != NULL )
+        SenderWake( p_sys->sender );
     return i_len;
 }
 
+/*****************************************************************************
+ * SendBatch: send a burst of packets with as few system calls as possible.
+ *****************************************************************************/
+#ifdef UDP_SEGMENT
+static int SendSegmented( sout_access_out_t *p_access, block_t **pp_pk,
+                          unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    const size_t i_segment = pp_pk[0]->i_buffer;
+    struct iovec iov[VLEN];
+    size_t i_total = 0;
+
+    /* All segments but the last must have the same size */
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        if( pp_pk[i]->i_buffer > i_segment
+         || ( i + 1 < i_count && pp_pk[i]->i_buffer != i_segment ) )
+            return -1;
+
+        iov[i].iov_base = pp_pk[i]->p_buffer;
+        iov[i].iov_len = pp_pk[i]->i_buffer;
+        i_total += pp_pk[i]->i_buffer;
+    }
+
+    if( i_segment == 0 || i_total > GSO_MAX_SIZE )
+        return -1;
+
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = i_count,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    uint16_t i_gso_size = i_segment;
+
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (i_gso_size));
+    memcpy( CMSG_DATA(cmsg), &i_gso_size, sizeof (i_gso_size) );
+
+    if( sendmsg( p_sys->i_handle, &msg, 0 ) == -1 )
+    {
+        switch( errno )
+        {
+            case EINVAL:
+            case EIO:
+            case ENOPROTOOPT:
+            case EOPNOTSUPP:
+                /* Not supported by the kernel or the outgoing interface */
+                msg_Dbg( p_access, "UDP segmentation offload disabled: %s",
+                         vlc_strerror_c(errno) );
+                p_sys->b_gso = false;
+                return -1;
+        }
+        msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    }
+    return 0;
+}
+#endif
+
+static void SendBatch( sout_access_out_t *p_access, block_t **pp_pk,
+                       unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+#ifdef UDP_SEGMENT
+    if( i_count > 1 && p_sys->b_gso
+     && SendSegmented( p_access, pp_pk, i_count ) == 0 )
+        goto done;
+#endif
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[VLEN];
+    struct iovec iov[VLEN];
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        iov[i].iov_base = pp_pk[i]->p_buffer;
+        iov[i].iov_len = pp_pk[i]->i_buffer;
+        memset( &msgs[i], 0, sizeof (msgs[i]) );
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for( unsigned i_sent = 0; i_sent < i_count; )
+    {
+        int val = sendmmsg( p_sys->i_handle, msgs + i_sent,
+                            i_count - i_sent, 0 );
+        if( val == -1 )
+        {
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            val = 1; /* skip the failed packet */
+        }
+        i_sent += val;
+    }
+#else
+    for( unsigned i = 0; i < i_count; i++ )
+        if( send( p_sys->i_handle, pp_pk[i]->p_buffer,
+                  pp_pk[i]->i_buffer, 0 ) == -1 )
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+#endif
+#ifdef UDP_SEGMENT
+done:
+#endif
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+#if 1
+        vlc_tick_t i_date = vlc_tick_now() - p_sys->i_caching
+                            - pp_pk[i]->i_dts;
+        if ( i_date > VLC_TICK_FROM_MS(20) )
+        {
+            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                     i_date );
+        }
+#endif
+        block_Release( pp_pk[i] );
+    }
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -357,13 +585,36 @@ static void* ThreadWrite( void *data )
                                              SOUT_CFG_PREFIX "group" );
     int i_to_send = i_group;
     unsigned i_dropped_packets = 0;
-    block_t *p_pk;
+    block_t *pp_batch[VLEN];
+    unsigned i_batch = 0;
 
-    while ((p_pk = vlc_queue_DequeueKillable(&p_sys->queue,
-                                             &p_sys->dead)) != NULL)
+    for( ;; )
     {
+        block_t      *p_pk;
         vlc_tick_t    i_date;
 
+        if( i_batch > 0 )
+        {
+            /* Only packets that are already queued can join the burst:
+             * anything else would delay the ones already pending. */
+            vlc_queue_Lock( &p_sys->queue );
+            p_pk = vlc_queue_DequeueUnlocked( &p_sys->queue );
+            vlc_queue_Unlock( &p_sys->queue );
+
+            if( p_pk == NULL )
+            {
+                SendBatch( p_access, pp_batch, i_batch );
+                i_batch = 0;
+                continue;
+            }
+        }
+        else
+        {
+            p_pk = vlc_queue_DequeueKillable( &p_sys->queue, &p_sys->dead );
+            if( p_pk == NULL )
+                break;
+        }
+
         i_date = p_sys->i_caching + p_pk->i_dts;
         if( i_date_last > 0 )
         {
@@ -390,11 +641,16 @@ static void* ThreadWrite( void *data )
         i_to_send--;
         if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
         {
+            /* The pending burst is due now, this packet only later */
+            if( i_batch > 0 )
+            {
+                SendBatch( p_access, pp_batch, i_batch );
+                i_batch = 0;
+            }
             vlc_tick_wait( i_date );
             i_to_send = i_group;
         }
-        if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
-            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+        pp_batch[i_batch++] = p_pk;
 
         if( i_dropped_packets )
         {
@@ -404,17 +660,246 @@ static void* ThreadWrite( void *data )
 
         i_date_last = i_date;
 
-#if 1
-        i_date = vlc_tick_now() - i_date;
-        if ( i_date > VLC_TICK_FROM_MS(20) )
+        if( i_batch == VLEN )
         {
-            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
-                     i_date );
+            SendBatch( p_access, pp_batch, i_batch );
+            i_batch = 0;
         }
-#endif
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * Shared sender threads: each one paces several outputs, serving the ones
+ * that are due and sleeping until the earliest next date.
+ *****************************************************************************/
+
+/* Sends the due packets of an output, returns the date of the next one */
+static vlc_tick_t SenderServe( sout_access_out_t *p_access, vlc_tick_t now )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    block_t *pp_batch[VLEN];
+    unsigned i_batch = 0;
+    vlc_tick_t i_next = VLC_TICK_MAX;
+
+    for( ;; )
+    {
+        block_t *p_pk = p_sys->p_due;
+
+        if( p_pk == NULL )
+        {
+            vlc_queue_Lock( &p_sys->queue );
+            p_pk = vlc_queue_DequeueUnlocked( &p_sys->queue );
+            vlc_queue_Unlock( &p_sys->queue );
+            if( p_pk == NULL )
+                break;
+
+            vlc_tick_t i_date = p_sys->i_caching + p_pk->i_dts;
+            if( p_sys->i_date_last > 0
+             && i_date - p_sys->i_date_last > VLC_TICK_FROM_SEC(2) )
+            {
+                if( !p_sys->i_dropped_packets )
+                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                             i_date - p_sys->i_date_last );
+                block_Release( p_pk );
+                p_sys->i_date_last = i_date;
+                p_sys->i_dropped_packets++;
+                continue;
+            }
 
-        block_Release( p_pk );
+            p_sys->i_to_send--;
+            if( !p_sys->i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+            {
+                p_sys->p_due = p_pk;
+                p_sys->i_due = i_date;
+                p_sys->i_to_send = p_sys->i_group;
+            }
+            else
+                p_sys->i_date_last = i_date;
+        }
 
+        if( p_sys->p_due != NULL )
+        {
+            if( p_sys->i_due > now )
+            {
+                i_next = p_sys->i_due;
+                break;
+            }
+            p_sys->p_due = NULL;
+            p_sys->i_date_last = p_sys->i_due;
+        }
+
+        pp_batch[i_batch++] = p_pk;
+
+        if( p_sys->i_dropped_packets )
+        {
+            msg_Dbg( p_access, "dropped %i packets", p_sys->i_dropped_packets );
+            p_sys->i_dropped_packets = 0;
+        }
+
+        if( i_batch == VLEN )
+        {
+            SendBatch( p_access, pp_batch, i_batch );
+            i_batch = 0;
+        }
     }
+
+    if( i_batch > 0 )
+        SendBatch( p_access, pp_batch, i_batch );
+    return i_next;
+}
+
+static void *SenderThread( void *data )
+{
+    struct udp_sender *sender = data;
+    vlc_tick_t i_deadline = VLC_TICK_MAX;
+
+    vlc_mutex_lock( &sender->lock );
+    for( ;; )
+    {
+        while( !sender->quit && !sender->pending )
+        {
+            if( i_deadline == VLC_TICK_MAX )
+                vlc_cond_wait( &sender->wait, &sender->lock );
+            else if( vlc_cond_timedwait( &sender->wait, &sender->lock,
+                                         i_deadline ) )
+                break;
+        }
+        if( sender->quit )
+            break;
+
+        sender->pending = false;
+        sender->busy = true;
+        vlc_mutex_unlock( &sender->lock );
+
+        /* The list only changes while the sender is not busy */
+        sout_access_out_sys_t *p_sys;
+        i_deadline = VLC_TICK_MAX;
+        vlc_list_foreach( p_sys, &sender->outputs, node )
+        {
+            vlc_tick_t i_next = SenderServe( p_sys->access, vlc_tick_now() );
+            if( i_next < i_deadline )
+                i_deadline = i_next;
+        }
+
+        vlc_mutex_lock( &sender->lock );
+        sender->busy = false;
+        vlc_cond_broadcast( &sender->idle );
+    }
+    vlc_mutex_unlock( &sender->lock );
     return NULL;
 }
+
+static void SenderWake( struct udp_sender *sender )
+{
+    vlc_mutex_lock( &sender->lock );
+    sender->pending = true;
+    vlc_cond_signal( &sender->wait );
+    vlc_mutex_unlock( &sender->lock );
+}
+
+static void PoolStop( unsigned i_count )
+{
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        struct udp_sender *sender = &udp_pool.senders[i];
+
+        vlc_mutex_lock( &sender->lock );
+        sender->quit = true;
+        vlc_cond_signal( &sender->wait );
+        vlc_mutex_unlock( &sender->lock );
+        vlc_join( sender->thread, NULL );
+        assert( vlc_list_is_empty( &sender->outputs ) );
+    }
+    free( udp_pool.senders );
+    udp_pool.senders = NULL;
+    udp_pool.count = 0;
+}
+
+static int PoolStart( unsigned i_count )
+{
+    udp_pool.senders = malloc( i_count * sizeof (*udp_pool.senders) );
+    if( unlikely(udp_pool.senders == NULL) )
+        return VLC_ENOMEM;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        struct udp_sender *sender = &udp_pool.senders[i];
+
+        vlc_mutex_init( &sender->lock );
+        vlc_cond_init( &sender->wait );
+        vlc_cond_init( &sender->idle );
+        vlc_list_init( &sender->outputs );
+        sender->count = 0;
+        sender->pending = false;
+        sender->busy = false;
+        sender->quit = false;
+
+        if( vlc_clone( &sender->thread, SenderThread, sender,
+                       VLC_THREAD_PRIORITY_HIGHEST ) )
+        {
+            PoolStop( i );
+            return VLC_EGENERIC;
+        }
+    }
+    udp_pool.count = i_count;
+    return VLC_SUCCESS;
+}
+
+/* Hands an output to the least loaded shared sender, starting the pool with
+ * the outputs' thread count if needed */
+static int SenderAttach( sout_access_out_t *p_access, unsigned i_threads )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->i_group = var_GetInteger( p_access, SOUT_CFG_PREFIX "group" );
+    p_sys->i_to_send = p_sys->i_group;
+    p_sys->i_date_last = -1;
+    p_sys->i_dropped_packets = 0;
+    p_sys->p_due = NULL;
+
+    vlc_mutex_lock( &udp_pool.lock );
+    if( udp_pool.refs == 0 && PoolStart( i_threads ) )
+    {
+        vlc_mutex_unlock( &udp_pool.lock );
+        msg_Err( p_access, "cannot spawn sout access threads" );
+        return VLC_EGENERIC;
+    }
+    udp_pool.refs++;
+
+    struct udp_sender *sender = &udp_pool.senders[0];
+    for( unsigned i = 1; i < udp_pool.count; i++ )
+        if( udp_pool.senders[i].count < sender->count )
+            sender = &udp_pool.senders[i];
+    sender->count++;
+    vlc_mutex_unlock( &udp_pool.lock );
+
+    vlc_mutex_lock( &sender->lock );
+    while( sender->busy )
+        vlc_cond_wait( &sender->idle, &sender->lock );
+    vlc_list_append( &p_sys->node, &sender->outputs );
+    vlc_mutex_unlock( &sender->lock );
+
+    p_sys->sender = sender;
+    msg_Dbg( p_access, "using shared sender thread %td of %u",
+             sender - udp_pool.senders, udp_pool.count );
+    return VLC_SUCCESS;
+}
+
+static void SenderDetach( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct udp_sender *sender = p_sys->sender;
+
+    vlc_mutex_lock( &sender->lock );
+    while( sender->busy )
+        vlc_cond_wait( &sender->idle, &sender->lock );
+    vlc_list_remove( &p_sys->node );
+    vlc_mutex_unlock( &sender->lock );
+
+    vlc_mutex_lock( &udp_pool.lock );
+    sender->count--;
+    if( --udp_pool.refs == 0 )
+        PoolStop( udp_pool.count );
+    vlc_mutex_unlock( &udp_pool.lock );
+}
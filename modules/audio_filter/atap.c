@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * atap.c : audio filter copying samples to the LibVLC audio taps
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+
+/* NOTE: the callback prototypes must match those of LibVLC */
+typedef void (*vlc_atap_process_cb)(void *, const block_t *, unsigned,
+                                    unsigned);
+typedef void (*vlc_atap_flush_cb)(void *);
+
+typedef struct
+{
+    vlc_atap_process_cb process;
+    vlc_atap_flush_cb flush;
+    void *hub;
+    unsigned channels;
+} filter_sys_t;
+
+static block_t *Process(filter_t *filter, block_t *block)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    sys->process(sys->hub, block, filter->fmt_in.audio.i_rate, sys->channels);
+    return block;
+}
+
+static block_t *Drain(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    sys->process(sys->hub, NULL, filter->fmt_in.audio.i_rate, sys->channels);
+    return NULL;
+}
+
+static void Flush(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    sys->flush(sys->hub);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    filter_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->process = var_InheritAddress(filter, "atap-process");
+    sys->flush = var_InheritAddress(filter, "atap-flush");
+    sys->hub = var_InheritAddress(filter, "atap-hub");
+    if (sys->process == NULL || sys->flush == NULL || sys->hub == NULL)
+        return VLC_EGENERIC;
+
+    /* The taps receive interleaved float samples */
+    filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
+    aout_FormatPrepare(&filter->fmt_in.audio);
+    filter->fmt_out.audio = filter->fmt_in.audio;
+    sys->channels = aout_FormatNbChannels(&filter->fmt_in.audio);
+
+    static const struct vlc_filter_operations filter_ops = {
+        .filter_audio = Process, .drain_audio = Drain, .flush = Flush,
+    };
+    filter->p_sys = sys;
+    filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_shortname(N_("Audio tap"))
+    set_description(N_("Audio samples to LibVLC"))
+    set_category(CAT_AUDIO)
+    set_subcategory(SUBCAT_AUDIO_AFILTER)
+    set_capability("audio filter", 0)
+    add_shortcut("atap")
+    set_callback(Open)
+vlc_module_end()
@@ -37,11 +37,14 @@
 #include <vlc_filter.h>
 #include <vlc_block.h>
 
+#include "../convolver.h"
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
 static int  OpenFilter ( vlc_object_t * );
 static void CloseFilter( filter_t * );
+static void Flush      ( filter_t * );
 static block_t *Convert( filter_t *, block_t * );
 
 /*****************************************************************************
@@ -70,6 +73,12 @@ static block_t *Convert( filter_t *, block_t * );
      "Dolby Surround encoded streams won't be decoded before being " \
      "processed by this filter. Enabling this setting is not recommended.")
 
+#define HEADPHONE_HRIR_TEXT N_("Head-related impulse responses")
+#define HEADPHONE_HRIR_LONGTEXT N_( \
+     "WAVE file of measured impulse responses to use instead of the " \
+     "physical model, at the rate of the audio. It holds a left ear and a " \
+     "right ear channel for each channel of the audio, in its order.")
+
 vlc_module_begin ()
     set_description( N_("Headphone virtual spatialization effect") )
     set_shortname( N_("Headphone effect") )
@@ -83,6 +92,8 @@ vlc_module_begin ()
               HEADPHONE_COMPENSATE_LONGTEXT )
     add_bool( "headphone-dolby", false, HEADPHONE_DOLBY_TEXT,
               HEADPHONE_DOLBY_LONGTEXT )
+    add_loadfile( "headphone-hrir", NULL, HEADPHONE_HRIR_TEXT,
+                  HEADPHONE_HRIR_LONGTEXT )
 
     set_capability( "audio filter", 0 )
     set_callback( OpenFilter )
@@ -98,17 +109,30 @@ struct atomic_operation_t
     int i_source_channel_offset;
     int i_dest_channel_offset;
     unsigned int i_delay;/* in sample unit */
-    double d_amplitude_factor;
+    float f_amplitude_factor;
 };
 
 typedef struct
 {
-    size_t i_overflow_buffer_size;/* in bytes */
-    float * p_overflow_buffer;
     unsigned int i_nb_atomic_operations;
     struct atomic_operation_t * p_atomic_operations;
+    unsigned int i_max_delay;/* in sample unit */
+
+    /* The left and right ears are accumulated in planar buffers of
+     * i_max_delay + i_max_samples samples each, the first i_max_delay
+     * samples carrying the delayed signal of the previous buffers. Each
+     * operation then is a plain multiply-add over contiguous samples. */
+    float * p_accumulator;
+    float * p_source;/* the current source channel, deinterleaved */
+    unsigned int i_max_samples;
+
+    /* convolution with measured responses, replacing the model */
+    convolver_t * p_conv;
+    vlc_tick_t i_conv_latency;
 } filter_sys_t;
 
+#define HRIR_BLOCK 256
+
 /*****************************************************************************
  * Init: initialize internal data structures
  * and computes the needed atomic operations
@@ -127,6 +151,13 @@ typedef struct
  *
  *          x-axis
  *  */
+/* The compensation may bring the speakers nearer than the reference one
+ * (the LFE at the rear) ahead of time: play them without delay. */
+static unsigned int DelayOf( double d_delay )
+{
+    return d_delay > 0 ? (unsigned int)d_delay : 0;
+}
+
 static void ComputeChannelOperations( filter_sys_t * p_data
         , unsigned int i_rate, unsigned int i_next_atomic_operation
         , int i_source_channel_offset, double d_x, double d_z
@@ -141,22 +172,22 @@ static void ComputeChannelOperations( filter_sys_t * p_data
     p_data->p_atomic_operations[i_next_atomic_operation]
         .i_dest_channel_offset = 0;/* left */
     p_data->p_atomic_operations[i_next_atomic_operation]
-        .i_delay = (int)( sqrt( (-0.1-d_x)*(-0.1-d_x) + (0-d_z)*(0-d_z) )
-                          / d_c * i_rate - d_compensation_delay );
+        .i_delay = DelayOf( sqrt( (-0.1-d_x)*(-0.1-d_x) + (0-d_z)*(0-d_z) )
+                            / d_c * i_rate - d_compensation_delay );
     if( d_x < 0 )
     {
         p_data->p_atomic_operations[i_next_atomic_operation]
-            .d_amplitude_factor = d_channel_amplitude_factor * 1.1 / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor * 1.1 / 2;
     }
     else if( d_x > 0 )
     {
         p_data->p_atomic_operations[i_next_atomic_operation]
-            .d_amplitude_factor = d_channel_amplitude_factor * 0.9 / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor * 0.9 / 2;
     }
     else
     {
         p_data->p_atomic_operations[i_next_atomic_operation]
-            .d_amplitude_factor = d_channel_amplitude_factor / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor / 2;
     }
 
     /* Right ear */
@@ -165,22 +196,22 @@ static void ComputeChannelOperations( filter_sys_t * p_data
     p_data->p_atomic_operations[i_next_atomic_operation + 1]
         .i_dest_channel_offset = 1;/* right */
     p_data->p_atomic_operations[i_next_atomic_operation + 1]
-        .i_delay = (int)( sqrt( (0.1-d_x)*(0.1-d_x) + (0-d_z)*(0-d_z) )
-                          / d_c * i_rate - d_compensation_delay );
+        .i_delay = DelayOf( sqrt( (0.1-d_x)*(0.1-d_x) + (0-d_z)*(0-d_z) )
+                            / d_c * i_rate - d_compensation_delay );
     if( d_x < 0 )
     {
         p_data->p_atomic_operations[i_next_atomic_operation + 1]
-            .d_amplitude_factor = d_channel_amplitude_factor * 0.9 / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor * 0.9 / 2;
     }
     else if( d_x > 0 )
     {
         p_data->p_atomic_operations[i_next_atomic_operation + 1]
-            .d_amplitude_factor = d_channel_amplitude_factor * 1.1 / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor * 1.1 / 2;
     }
     else
     {
         p_data->p_atomic_operations[i_next_atomic_operation + 1]
-            .d_amplitude_factor = d_channel_amplitude_factor / 2;
+            .f_amplitude_factor = d_channel_amplitude_factor / 2;
     }
 }
 
@@ -302,131 +333,152 @@ static int Init( vlc_object_t *p_this, filter_sys_t * p_data
         i_source_channel_offset++;
     }
 
-    /* Initialize the overflow buffer
-     * we need it because the process induce a delay in the samples */
-    p_data->i_overflow_buffer_size = 0;
+    p_data->i_max_delay = 0;
     for( i = 0 ; i < p_data->i_nb_atomic_operations ; i++ )
     {
-        if( p_data->i_overflow_buffer_size
-                < p_data->p_atomic_operations[i].i_delay * 2 * sizeof (float) )
-        {
-            p_data->i_overflow_buffer_size
-                = p_data->p_atomic_operations[i].i_delay * 2 * sizeof (float);
-        }
+        if( p_data->i_max_delay < p_data->p_atomic_operations[i].i_delay )
+            p_data->i_max_delay = p_data->p_atomic_operations[i].i_delay;
     }
-    p_data->p_overflow_buffer = malloc( p_data->i_overflow_buffer_size );
-    if( p_data->p_overflow_buffer == NULL )
+
+    return 0;
+}
+
+/*****************************************************************************
+ * Reserve: grow the scratch buffers for the given number of samples
+ *****************************************************************************/
+static int Reserve( filter_sys_t * p_sys, unsigned int i_nb_samples )
+{
+    if( i_nb_samples <= p_sys->i_max_samples )
+        return 0;
+
+    unsigned int i_old_stride = p_sys->i_max_delay + p_sys->i_max_samples;
+    unsigned int i_stride = p_sys->i_max_delay + i_nb_samples;
+    float * p_accumulator = calloc( 2 * i_stride, sizeof (float) );
+    float * p_source = malloc( i_nb_samples * sizeof (float) );
+    if( p_accumulator == NULL || p_source == NULL )
     {
-        free( p_data->p_atomic_operations );
+        free( p_accumulator );
+        free( p_source );
         return -1;
     }
-    memset( p_data->p_overflow_buffer, 0 , p_data->i_overflow_buffer_size );
 
+    /* Keep the delayed samples */
+    if( p_sys->p_accumulator != NULL )
+    {
+        for( unsigned int i = 0; i < 2; i++ )
+            memcpy( p_accumulator + i * i_stride,
+                    p_sys->p_accumulator + i * i_old_stride,
+                    p_sys->i_max_delay * sizeof (float) );
+    }
+    free( p_sys->p_accumulator );
+    free( p_sys->p_source );
+    p_sys->p_accumulator = p_accumulator;
+    p_sys->p_source = p_source;
+    p_sys->i_max_samples = i_nb_samples;
     return 0;
 }
 
 /*****************************************************************************
  * DoWork: convert a buffer
  *****************************************************************************/
-static void DoWork( filter_t * p_filter,
-                    block_t * p_in_buf, block_t * p_out_buf )
+static int DoWork( filter_t * p_filter,
+                   block_t * p_in_buf, block_t * p_out_buf )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
-    int i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
-
-    float * p_in = (float*) p_in_buf->p_buffer;
-    float * p_out;
-    uint8_t * p_overflow;
-    uint8_t * p_end_overflow;
-    uint8_t * p_slide;
+    unsigned int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    unsigned int i_nb_samples = p_in_buf->i_nb_samples;
 
-    size_t i_overflow_size;     /* in bytes */
-    size_t i_out_size;          /* in bytes */
+    const float * p_in = (const float*) p_in_buf->p_buffer;
+    float * p_out = (float *)p_out_buf->p_buffer;
 
-    unsigned int i, j;
-
-    int i_source_channel_offset;
-    int i_dest_channel_offset;
-    unsigned int i_delay;
-    double d_amplitude_factor;
+    if( p_sys->p_conv != NULL )
+    {
+        convolver_Process( p_sys->p_conv, p_in, p_out, i_nb_samples );
+        return 0;
+    }
 
-    p_out = (float *)p_out_buf->p_buffer;
-    i_out_size = p_out_buf->i_buffer;
+    if( Reserve( p_sys, i_nb_samples ) )
+        return -1;
 
-    /* Slide the overflow buffer */
-    p_overflow = (uint8_t *) p_sys->p_overflow_buffer;
-    i_overflow_size = p_sys->i_overflow_buffer_size;
-    p_end_overflow = p_overflow + i_overflow_size;
+    unsigned int i_max_delay = p_sys->i_max_delay;
+    unsigned int i_stride = i_max_delay + p_sys->i_max_samples;
+    float * p_acc[2] = { p_sys->p_accumulator,
+                         p_sys->p_accumulator + i_stride };
+    float * restrict p_source = p_sys->p_source;
+    int i_source = -1;
 
-    memset( p_out, 0, i_out_size );
-    memcpy( p_out, p_overflow, __MIN( i_out_size, i_overflow_size ) );
+    for( unsigned int i = 0; i < 2; i++ )
+        memset( p_acc[i] + i_max_delay, 0, i_nb_samples * sizeof (float) );
 
-    p_slide = (uint8_t *) p_sys->p_overflow_buffer;
-    while( p_slide < p_end_overflow )
+    /* apply the atomic operations, they are sorted by source channel */
+    for( unsigned int i = 0; i < p_sys->i_nb_atomic_operations; i++ )
     {
-        size_t i_bytes_copied;
+        const struct atomic_operation_t *p_op = &p_sys->p_atomic_operations[i];
 
-        if( p_slide + i_out_size < p_end_overflow )
+        if( p_op->i_source_channel_offset != i_source )
         {
-            memset( p_slide, 0, i_out_size );
-            if( p_slide + 2 * i_out_size < p_end_overflow )
-                i_bytes_copied = i_out_size;
-            else
-                i_bytes_copied = p_end_overflow - ( p_slide + i_out_size );
-            memcpy( p_slide, p_slide + i_out_size, i_bytes_copied );
+            i_source = p_op->i_source_channel_offset;
+            for( unsigned int j = 0; j < i_nb_samples; j++ )
+                p_source[j] = p_in[j * i_input_nb + i_source];
         }
-        else
-        {
-            i_bytes_copied = p_end_overflow - p_slide;
-            memset( p_slide, 0, i_bytes_copied );
-        }
-        p_slide += i_bytes_copied;
+
+        float * restrict p_dest = p_acc[p_op->i_dest_channel_offset]
+                                + p_op->i_delay;
+        const float f_factor = p_op->f_amplitude_factor;
+        for( unsigned int j = 0; j < i_nb_samples; j++ )
+            p_dest[j] += p_source[j] * f_factor;
     }
 
-    /* apply the atomic operations */
-    for( i = 0; i < p_sys->i_nb_atomic_operations; i++ )
+    /* interleave the ears, then slide the delayed samples */
+    for( unsigned int j = 0; j < i_nb_samples; j++ )
     {
-        /* shorter variable names */
-        i_source_channel_offset
-            = p_sys->p_atomic_operations[i].i_source_channel_offset;
-        i_dest_channel_offset
-            = p_sys->p_atomic_operations[i].i_dest_channel_offset;
-        i_delay = p_sys->p_atomic_operations[i].i_delay;
-        d_amplitude_factor
-            = p_sys->p_atomic_operations[i].d_amplitude_factor;
+        p_out[2 * j]     = p_acc[0][j];
+        p_out[2 * j + 1] = p_acc[1][j];
+    }
+    for( unsigned int i = 0; i < 2; i++ )
+        memmove( p_acc[i], p_acc[i] + i_nb_samples,
+                 i_max_delay * sizeof (float) );
+    return 0;
+}
 
-        if( p_out_buf->i_nb_samples > i_delay )
-        {
-            /* current buffer coefficients */
-            for( j = 0; j < p_out_buf->i_nb_samples - i_delay; j++ )
-            {
-                ((float*)p_out)[ (i_delay+j)*i_output_nb + i_dest_channel_offset ]
-                    += p_in[ j * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-
-            /* overflow buffer coefficients */
-            for( j = 0; j < i_delay; j++ )
-            {
-                ((float*)p_overflow)[ j*i_output_nb + i_dest_channel_offset ]
-                    += p_in[ (p_out_buf->i_nb_samples - i_delay + j)
-                       * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-        }
-        else
-        {
-            /* overflow buffer coefficients only */
-            for( j = 0; j < p_out_buf->i_nb_samples; j++ )
-            {
-                ((float*)p_overflow)[ (i_delay - p_out_buf->i_nb_samples + j)
-                                        * i_output_nb + i_dest_channel_offset ]
-                    += p_in[ j * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-        }
+/*****************************************************************************
+ * InitHRIR: load the measured responses, one pair per input channel
+ *****************************************************************************/
+static convolver_t *InitHRIR( filter_t * p_filter, const char * psz_file )
+{
+    unsigned int i_nb_channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    unsigned int i_ir_channels, i_ir_rate;
+    size_t i_taps;
+
+    float * p_ir = convolver_LoadWAV( VLC_OBJECT(p_filter), psz_file,
+                                      &i_ir_channels, &i_ir_rate, &i_taps );
+    if( p_ir == NULL )
+        return NULL;
+
+    if( i_ir_channels != 2 * i_nb_channels
+     || i_ir_rate != p_filter->fmt_in.audio.i_rate )
+    {
+        msg_Warn( p_filter, "%s: %u channels at %u Hz do not fit %u channels "
+                  "at %u Hz", psz_file, i_ir_channels, i_ir_rate,
+                  i_nb_channels, p_filter->fmt_in.audio.i_rate );
+        free( p_ir );
+        return NULL;
     }
+
+    struct convolver_filter filters[2 * AOUT_CHAN_MAX];
+    for( unsigned int i = 0; i < i_ir_channels; i++ )
+        filters[i] = (struct convolver_filter) {
+            .input = i / 2, .output = i % 2,
+            .ir = &p_ir[i * i_taps], .length = i_taps,
+        };
+
+    convolver_t * p_conv = convolver_New( HRIR_BLOCK, i_nb_channels, 2,
+                                          filters, i_ir_channels );
+    free( p_ir );
+    if( p_conv != NULL )
+        msg_Dbg( p_filter, "convolving with %s: %zu taps (%s)", psz_file,
+                 i_taps, convolver_GetKernelsName( p_conv ) );
+    return p_conv;
 }
 
 /*
@@ -452,8 +504,10 @@ static int OpenFilter( vlc_object_t *p_this )
     p_sys = p_filter->p_sys = malloc( sizeof(filter_sys_t) );
     if( p_sys == NULL )
         return VLC_ENOMEM;
-    p_sys->i_overflow_buffer_size = 0;
-    p_sys->p_overflow_buffer = NULL;
+    p_sys->p_accumulator = NULL;
+    p_sys->p_source = NULL;
+    p_sys->i_max_samples = 0;
+    p_sys->p_conv = NULL;
     p_sys->i_nb_atomic_operations = 0;
     p_sys->p_atomic_operations = NULL;
 
@@ -479,9 +533,20 @@ static int OpenFilter( vlc_object_t *p_this )
         p_filter->fmt_in.audio.i_physical_channels = AOUT_CHANS_5_0;
     }
 
+    char * psz_hrir = var_InheritString( p_filter, "headphone-hrir" );
+    if( psz_hrir != NULL )
+    {
+        p_sys->p_conv = InitHRIR( p_filter, psz_hrir );
+        if( p_sys->p_conv == NULL )
+            msg_Warn( p_filter, "using the physical model" );
+        p_sys->i_conv_latency = vlc_tick_from_samples( HRIR_BLOCK,
+                                             p_filter->fmt_in.audio.i_rate );
+        free( psz_hrir );
+    }
+
     static const struct vlc_filter_operations filter_ops =
     {
-        .filter_audio = Convert, .close = CloseFilter,
+        .filter_audio = Convert, .flush = Flush, .close = CloseFilter,
     };
     p_filter->ops = &filter_ops;
 
@@ -498,13 +563,32 @@ static void CloseFilter( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    free( p_sys->p_overflow_buffer );
+    if( p_sys->p_conv != NULL )
+        convolver_Delete( p_sys->p_conv );
+    free( p_sys->p_accumulator );
+    free( p_sys->p_source );
     free( p_sys->p_atomic_operations );
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Flush: forget the delayed samples
+ *****************************************************************************/
+static void Flush( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->p_conv != NULL )
+        convolver_Reset( p_sys->p_conv );
+    if( p_sys->p_accumulator != NULL )
+        memset( p_sys->p_accumulator, 0, 2 * sizeof (float)
+                * ( p_sys->i_max_delay + p_sys->i_max_samples ) );
+}
+
 static block_t *Convert( filter_t *p_filter, block_t *p_block )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     if( !p_block || !p_block->i_nb_samples )
     {
         if( p_block )
@@ -528,8 +612,21 @@ static block_t *Convert( filter_t *p_filter, block_t *p_block )
     p_out->i_dts = p_block->i_dts;
     p_out->i_pts = p_block->i_pts;
     p_out->i_length = p_block->i_length;
+    if( p_sys->p_conv != NULL )
+    {
+        /* the samples are those of one block before */
+        if( p_out->i_pts != VLC_TICK_INVALID )
+            p_out->i_pts -= p_sys->i_conv_latency;
+        if( p_out->i_dts != VLC_TICK_INVALID )
+            p_out->i_dts -= p_sys->i_conv_latency;
+    }
 
-    DoWork( p_filter, p_block, p_out );
+    if( DoWork( p_filter, p_block, p_out ) )
+    {
+        msg_Warn( p_filter, "can't get work buffers" );
+        block_Release( p_out );
+        p_out = NULL;
+    }
 
     block_Release( p_block );
     return p_out;
@@ -97,6 +97,7 @@ vlc_module_end ()
  *****************************************************************************/
 
 static block_t *Remap( filter_t *, block_t * );
+static void CloseFilter( filter_t * );
 
 typedef void (*remap_fun_t)( filter_t *, const void *, void *,
                              int, unsigned, unsigned);
@@ -107,6 +108,7 @@ typedef struct
     int nb_in_ch[AOUT_CHAN_MAX];
     int8_t map_ch[AOUT_CHAN_MAX];
     bool b_normalize;
+    block_pool_t *pool; /* output blocks */
 } filter_sys_t;
 
 static const uint32_t valid_channels[] = {
@@ -220,6 +222,75 @@ DEFINE_REMAP( FL64, double   )
 
 #undef DEFINE_REMAP
 
+/* Remapping and conversion to float in a single pass, sparing the pipeline
+ * a format converter and an intermediate buffer after the remap */
+#define DEFINE_REMAP_FL32( name, type, scale ) \
+static void RemapCopy##name##toFL32( filter_t *p_filter, \
+                    const void *p_srcorig, void *p_destorig, \
+                    int i_nb_samples, \
+                    unsigned i_nb_in_channels, unsigned i_nb_out_channels ) \
+{ \
+    filter_sys_t *p_sys = ( filter_sys_t * )p_filter->p_sys; \
+    const type *p_src = p_srcorig; \
+    float *p_dest = p_destorig; \
+ \
+    for( int i = 0; i < i_nb_samples; i++ ) \
+    { \
+        for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
+        { \
+            int8_t out_ch = p_sys->map_ch[ in_ch ]; \
+            if (out_ch < 0) continue; \
+            p_dest[ out_ch ] = (float)p_src[ in_ch ] / scale; \
+        } \
+        p_src  += i_nb_in_channels; \
+        p_dest += i_nb_out_channels; \
+    } \
+} \
+ \
+static void RemapAdd##name##toFL32( filter_t *p_filter, \
+                    const void *p_srcorig, void *p_destorig, \
+                    int i_nb_samples, \
+                    unsigned i_nb_in_channels, unsigned i_nb_out_channels ) \
+{ \
+    filter_sys_t *p_sys = ( filter_sys_t * )p_filter->p_sys; \
+    const type *p_src = p_srcorig; \
+    float *p_dest = p_destorig; \
+ \
+    for( int i = 0; i < i_nb_samples; i++ ) \
+    { \
+        for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
+        { \
+            int8_t out_ch = p_sys->map_ch[ in_ch ]; \
+            if (out_ch < 0) continue; \
+            float f = (float)p_src[ in_ch ] / scale; \
+            if( p_sys->b_normalize ) \
+                p_dest[ out_ch ] += f / p_sys->nb_in_ch[ out_ch ]; \
+            else \
+                p_dest[ out_ch ] += f; \
+        } \
+        p_src  += i_nb_in_channels; \
+        p_dest += i_nb_out_channels; \
+    } \
+}
+
+DEFINE_REMAP_FL32( S16N, int16_t, 32768.f )
+DEFINE_REMAP_FL32( S32N, int32_t, 2147483648.f )
+
+#undef DEFINE_REMAP_FL32
+
+static inline remap_fun_t GetRemapFL32Fun( audio_format_t *p_format,
+                                           bool b_add )
+{
+    switch( p_format->i_format )
+    {
+        case VLC_CODEC_S16N:
+            return b_add ? RemapAddS16NtoFL32 : RemapCopyS16NtoFL32;
+        case VLC_CODEC_S32N:
+            return b_add ? RemapAddS32NtoFL32 : RemapCopyS32NtoFL32;
+    }
+    return NULL;
+}
+
 static inline remap_fun_t GetRemapFun( audio_format_t *p_format, bool b_add )
 {
     if( b_add )
@@ -347,15 +418,29 @@ static int OpenFilter( vlc_object_t *p_this )
             b_multiple = true;
     }
 
-    p_sys->pf_remap = GetRemapFun( audio_in, b_multiple );
+    /* Convert while remapping if the float output is requested */
+    vlc_fourcc_t i_format = audio_in->i_format;
+    p_sys->pf_remap = NULL;
+    if( audio_out->i_format == VLC_CODEC_FL32 )
+    {
+        p_sys->pf_remap = GetRemapFL32Fun( audio_in, b_multiple );
+        if( p_sys->pf_remap )
+            i_format = VLC_CODEC_FL32;
+    }
+    if( !p_sys->pf_remap )
+        p_sys->pf_remap = GetRemapFun( audio_in, b_multiple );
     if( !p_sys->pf_remap )
     {
         msg_Err( p_filter, "Could not decide on %s remap function", b_multiple ? "an add" : "a copy" );
         return VLC_EGENERIC;
     }
 
+    p_sys->pool = block_pool_New();
+    if( unlikely( p_sys->pool == NULL ) )
+        return VLC_ENOMEM;
+
     audio_out->i_rate = audio_in->i_rate;
-    audio_out->i_format = audio_in->i_format;
+    audio_out->i_format = i_format;
     audio_out->i_physical_channels = i_output_physical;
     aout_FormatPrepare( audio_out );
 
@@ -368,7 +453,7 @@ static int OpenFilter( vlc_object_t *p_this )
 
     static const struct vlc_filter_operations filter_ops =
     {
-        .filter_audio = Remap,
+        .filter_audio = Remap, .close = CloseFilter,
     };
     p_filter->ops = &filter_ops;
     return VLC_SUCCESS;
@@ -390,7 +475,7 @@ static block_t *Remap( filter_t *p_filter, block_t *p_block )
     size_t i_out_size = p_block->i_nb_samples *
         p_filter->fmt_out.audio.i_bytes_per_frame;
 
-    block_t *p_out = block_Alloc( i_out_size );
+    block_t *p_out = block_pool_Alloc( p_sys->pool, i_out_size );
     if( !p_out )
     {
         msg_Warn( p_filter, "can't get output buffer" );
@@ -414,3 +499,9 @@ static block_t *Remap( filter_t *p_filter, block_t *p_block )
 
     return p_out;
 }
+
+static void CloseFilter( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = (filter_sys_t *)p_filter->p_sys;
+    block_pool_Release( p_sys->pool );
+}
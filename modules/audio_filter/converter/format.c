@@ -39,6 +39,8 @@
 #include <vlc_block.h>
 #include <vlc_filter.h>
 
+#include "format_kernels.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -59,6 +61,21 @@ vlc_module_end()
 typedef block_t *(*cvt_t)(filter_t *, block_t *);
 static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst);
 
+typedef struct
+{
+    block_pool_t *pool; /* output blocks of the widening conversions */
+    format_kernels_t kernels;
+} filter_sys_t;
+
+static void Close(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if (sys->pool != NULL)
+        block_pool_Release(sys->pool);
+    free(sys);
+}
+
 static int Open(vlc_object_t *object)
 {
     filter_t     *filter = (filter_t *)object;
@@ -75,11 +92,31 @@ static int Open(vlc_object_t *object)
     if (filter_ops == NULL)
         return VLC_EGENERIC;
 
+    filter_sys_t *sys = malloc(sizeof(*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    /* The widening conversions cannot work in place: their output blocks are
+     * recycled across calls */
+    sys->pool = NULL;
+    if (aout_BitsPerSample(dst->i_codec) > aout_BitsPerSample(src->i_codec))
+    {
+        sys->pool = block_pool_New();
+        if (unlikely(sys->pool == NULL))
+        {
+            free(sys);
+            return VLC_ENOMEM;
+        }
+    }
+    format_kernels_Init(&sys->kernels);
+
+    filter->p_sys = sys;
     filter->ops = filter_ops;
 
-    msg_Dbg(filter, "%4.4s->%4.4s, bits per sample: %i->%i",
+    msg_Dbg(filter, "%4.4s->%4.4s, bits per sample: %i->%i, %s kernels",
             (char *)&src->i_codec, (char *)&dst->i_codec,
-            src->audio.i_bitspersample, dst->audio.i_bitspersample);
+            src->audio.i_bitspersample, dst->audio.i_bitspersample,
+            sys->kernels.name);
     return VLC_SUCCESS;
 }
 
@@ -87,7 +124,8 @@ static int Open(vlc_object_t *object)
 /*** from U8 ***/
 static block_t *U8toS16(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -98,13 +136,13 @@ static block_t *U8toS16(filter_t *filter, block_t *bsrc)
         *dst++ = ((*src++) << 8) - 0x8000;
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
 static block_t *U8toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -115,13 +153,13 @@ static block_t *U8toFl32(filter_t *filter, block_t *bsrc)
         *dst++ = ((float)((*src++) - 128)) / 128.f;
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
 static block_t *U8toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -132,13 +170,13 @@ static block_t *U8toS32(filter_t *filter, block_t *bsrc)
         *dst++ = ((*src++) << 24) - 0x80000000;
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
 static block_t *U8toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 8);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 8);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -149,7 +187,6 @@ static block_t *U8toFl64(filter_t *filter, block_t *bsrc)
         *dst++ = ((double)((*src++) - 128)) / 128.;
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
@@ -169,52 +206,38 @@ static block_t *S16toU8(filter_t *filter, block_t *b)
 
 static block_t *S16toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
     block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
-#if 0
-        /* Slow version */
-        *dst++ = (float)*src++ / 32768.f;
-#else
-    {   /* This is Walken's trick based on IEEE float format. On my PIII
-         * this takes 16 seconds to perform one billion conversions, instead
-         * of 19 seconds for the above division. */
-        union { float f; int32_t i; } u;
-        u.i = *src++ + 0x43c00000;
-        *dst++ = u.f - 384.f;
-    }
-#endif
+    sys->kernels.s16_fl32((float *)bdst->p_buffer,
+                          (const int16_t *)bsrc->p_buffer, bsrc->i_buffer / 2);
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
 static block_t *S16toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
     block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (int i = bsrc->i_buffer / 2; i--;)
-        *dst++ = *src++ << 16;
+    sys->kernels.s16_s32((int32_t *)bdst->p_buffer,
+                         (const int16_t *)bsrc->p_buffer, bsrc->i_buffer / 2);
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
 static block_t *S16toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -225,7 +248,6 @@ static block_t *S16toFl64(filter_t *filter, block_t *bsrc)
         *dst++ = (double)*src++ / 32768.;
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
@@ -253,54 +275,25 @@ static block_t *Fl32toU8(filter_t *filter, block_t *b)
 
 static block_t *Fl32toS16(filter_t *filter, block_t *b)
 {
-    VLC_UNUSED(filter);
-    float   *src = (float *)b->p_buffer;
-    int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
-#if 0
-        /* Slow version. */
-        if (*src >= 1.0) *dst = 32767;
-        else if (*src < -1.0) *dst = -32768;
-        else *dst = lroundf(*src * 32768.f);
-        src++; dst++;
-#else
-        /* This is Walken's trick based on IEEE float format. */
-        union { float f; int32_t i; } u;
-        u.f = *src++ + 384.f;
-        if (u.i > 0x43c07fff)
-            *dst++ = 32767;
-        else if (u.i < 0x43bf8000)
-            *dst++ = -32768;
-        else
-            *dst++ = u.i - 0x43c00000;
-#endif
-    }
+    filter_sys_t *sys = filter->p_sys;
+    sys->kernels.fl32_s16((int16_t *)b->p_buffer, (const float *)b->p_buffer,
+                          b->i_buffer / 4);
     b->i_buffer /= 2;
     return b;
 }
 
 static block_t *Fl32toS32(filter_t *filter, block_t *b)
 {
-    float   *src = (float *)b->p_buffer;
-    int32_t *dst = (int32_t *)src;
-    for (size_t i = b->i_buffer / 4; i--;)
-    {
-        float s = *(src++) * 2147483648.f;
-        if (s >= 2147483647.f)
-            *(dst++) = 2147483647;
-        else
-        if (s <= -2147483648.f)
-            *(dst++) = -2147483648;
-        else
-            *(dst++) = lroundf(s);
-    }
-    VLC_UNUSED(filter);
+    filter_sys_t *sys = filter->p_sys;
+    sys->kernels.fl32_s32((int32_t *)b->p_buffer, (const float *)b->p_buffer,
+                          b->i_buffer / 4);
     return b;
 }
 
 static block_t *Fl32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -311,7 +304,6 @@ static block_t *Fl32toFl64(filter_t *filter, block_t *bsrc)
         *(dst++) = *(src++);
 out:
     block_Release(bsrc);
-    VLC_UNUSED(filter);
     return bdst;
 }
 
@@ -331,29 +323,25 @@ static block_t *S32toU8(filter_t *filter, block_t *b)
 
 static block_t *S32toS16(filter_t *filter, block_t *b)
 {
-    VLC_UNUSED(filter);
-    int32_t *src = (int32_t *)b->p_buffer;
-    int16_t *dst = (int16_t *)src;
-    for (size_t i = b->i_buffer / 4; i--;)
-        *dst++ = (*src++) >> 16;
-
+    filter_sys_t *sys = filter->p_sys;
+    sys->kernels.s32_s16((int16_t *)b->p_buffer, (const int32_t *)b->p_buffer,
+                         b->i_buffer / 4);
     b->i_buffer /= 2;
     return b;
 }
 
 static block_t *S32toFl32(filter_t *filter, block_t *b)
 {
-    VLC_UNUSED(filter);
-    int32_t *src = (int32_t*)b->p_buffer;
-    float   *dst = (float *)src;
-    for (int i = b->i_buffer / 4; i--;)
-        *dst++ = (float)(*src++) / 2147483648.f;
+    filter_sys_t *sys = filter->p_sys;
+    sys->kernels.s32_fl32((float *)b->p_buffer, (const int32_t *)b->p_buffer,
+                          b->i_buffer / 4);
     return b;
 }
 
 static block_t *S32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    filter_sys_t *sys = filter->p_sys;
+    block_t *bdst = block_pool_Alloc(sys->pool, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
@@ -363,7 +351,6 @@ static block_t *S32toFl64(filter_t *filter, block_t *bsrc)
     for (size_t i = bsrc->i_buffer / 4; i--;)
         *dst++ = (double)(*src++) / 2147483648.;
 out:
-    VLC_UNUSED(filter);
     block_Release(bsrc);
     return bdst;
 }
@@ -449,30 +436,30 @@ static const struct {
     vlc_fourcc_t dst;
     struct vlc_filter_operations convert;
 } cvt_directs[] = {
-    { VLC_CODEC_U8,   VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = U8toS16 }    },
-    { VLC_CODEC_U8,   VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = U8toFl32 }   },
-    { VLC_CODEC_U8,   VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = U8toS32 }    },
-    { VLC_CODEC_U8,   VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = U8toFl64 }   },
-
-    { VLC_CODEC_S16N, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = S16toU8 }    },
-    { VLC_CODEC_S16N, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = S16toFl32 }  },
-    { VLC_CODEC_S16N, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = S16toS32 }   },
-    { VLC_CODEC_S16N, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = S16toFl64 }  },
-
-    { VLC_CODEC_FL32, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = Fl32toU8 }   },
-    { VLC_CODEC_FL32, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = Fl32toS16 }  },
-    { VLC_CODEC_FL32, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = Fl32toS32 }  },
-    { VLC_CODEC_FL32, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = Fl32toFl64 } },
-
-    { VLC_CODEC_S32N, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = S32toU8 }    },
-    { VLC_CODEC_S32N, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = S32toS16 }   },
-    { VLC_CODEC_S32N, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = S32toFl32 }  },
-    { VLC_CODEC_S32N, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = S32toFl64 }  },
-
-    { VLC_CODEC_FL64, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = Fl64toU8 }   },
-    { VLC_CODEC_FL64, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = Fl64toS16 }  },
-    { VLC_CODEC_FL64, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = Fl64toFl32 } },
-    { VLC_CODEC_FL64, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = Fl64toS32 }  },
+    { VLC_CODEC_U8,   VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = U8toS16, .close = Close }    },
+    { VLC_CODEC_U8,   VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = U8toFl32, .close = Close }   },
+    { VLC_CODEC_U8,   VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = U8toS32, .close = Close }    },
+    { VLC_CODEC_U8,   VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = U8toFl64, .close = Close }   },
+
+    { VLC_CODEC_S16N, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = S16toU8, .close = Close }    },
+    { VLC_CODEC_S16N, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = S16toFl32, .close = Close }  },
+    { VLC_CODEC_S16N, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = S16toS32, .close = Close }   },
+    { VLC_CODEC_S16N, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = S16toFl64, .close = Close }  },
+
+    { VLC_CODEC_FL32, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = Fl32toU8, .close = Close }   },
+    { VLC_CODEC_FL32, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = Fl32toS16, .close = Close }  },
+    { VLC_CODEC_FL32, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = Fl32toS32, .close = Close }  },
+    { VLC_CODEC_FL32, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = Fl32toFl64, .close = Close } },
+
+    { VLC_CODEC_S32N, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = S32toU8, .close = Close }    },
+    { VLC_CODEC_S32N, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = S32toS16, .close = Close }   },
+    { VLC_CODEC_S32N, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = S32toFl32, .close = Close }  },
+    { VLC_CODEC_S32N, VLC_CODEC_FL64, (struct vlc_filter_operations) { .filter_audio = S32toFl64, .close = Close }  },
+
+    { VLC_CODEC_FL64, VLC_CODEC_U8,   (struct vlc_filter_operations) { .filter_audio = Fl64toU8, .close = Close }   },
+    { VLC_CODEC_FL64, VLC_CODEC_S16N, (struct vlc_filter_operations) { .filter_audio = Fl64toS16, .close = Close }  },
+    { VLC_CODEC_FL64, VLC_CODEC_FL32, (struct vlc_filter_operations) { .filter_audio = Fl64toFl32, .close = Close } },
+    { VLC_CODEC_FL64, VLC_CODEC_S32N, (struct vlc_filter_operations) { .filter_audio = Fl64toS32, .close = Close }  },
 
     { 0, 0, (struct vlc_filter_operations) { .filter_audio = NULL } }
 };
@@ -0,0 +1,501 @@
+/*****************************************************************************
+ * format_kernels.c: vectorized PCM samples conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "format_kernels.h"
+
+/*
+ * The vector loops read a whole vector of source samples before storing the
+ * converted ones: the narrower destination never overwrites unread samples.
+ */
+
+/*****************************************************************************
+ * C, also handling the remainder of the vectorized arrays
+ *****************************************************************************/
+static void s16_fl32_c( float *dst, const int16_t *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+    {   /* This is Walken's trick based on IEEE float format. */
+        union { float f; int32_t i; } u;
+        u.i = src[i] + 0x43c00000;
+        dst[i] = u.f - 384.f;
+    }
+}
+
+static void s32_fl32_c( float *dst, const int32_t *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+        dst[i] = (float)src[i] / 2147483648.f;
+}
+
+static void fl32_s16_c( int16_t *dst, const float *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+    {   /* This is Walken's trick based on IEEE float format. */
+        union { float f; int32_t i; } u;
+        u.f = src[i] + 384.f;
+        if( u.i > 0x43c07fff )
+            dst[i] = 32767;
+        else if( u.i < 0x43bf8000 )
+            dst[i] = -32768;
+        else
+            dst[i] = u.i - 0x43c00000;
+    }
+}
+
+static void fl32_s32_c( int32_t *dst, const float *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+    {
+        float s = src[i] * 2147483648.f;
+        if( s >= 2147483647.f )
+            dst[i] = 2147483647;
+        else
+        if( s <= -2147483648.f )
+            dst[i] = -2147483648;
+        else
+            dst[i] = lroundf( s );
+    }
+}
+
+static void s16_s32_c( int32_t *dst, const int16_t *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+        dst[i] = src[i] * 65536;
+}
+
+static void s32_s16_c( int16_t *dst, const int32_t *src, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+        dst[i] = src[i] >> 16;
+}
+
+/*
+ * The floats to S16 conversions keep Walken's trick: the sum with 384 rounds
+ * the samples to the nearest multiple of 1/32768, and the saturated packing
+ * does the clipping. The samples are first kept above -2 so that the sum
+ * stays positive.
+ *
+ * The floats to S32 conversions round half away from zero, like lroundf():
+ * the truncated value is corrected by the remaining fraction, and the
+ * samples out of range are set to the bounds afterwards.
+ */
+
+#if defined(__i386__) || defined(__x86_64__)
+/*****************************************************************************
+ * SSE2
+ *****************************************************************************/
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_FORMAT_SSE2 1
+
+static __attribute__((__target__("sse2")))
+void s16_fl32_sse2( float *dst, const int16_t *src, size_t count )
+{
+    const __m128 scale = _mm_set1_ps( 1.f / 32768.f );
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i v = _mm_loadu_si128( (const __m128i *)&src[i] );
+        const __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        const __m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        _mm_storeu_ps( &dst[i],     _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale ) );
+        _mm_storeu_ps( &dst[i + 4], _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale ) );
+    }
+    s16_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("sse2")))
+void s32_fl32_sse2( float *dst, const int32_t *src, size_t count )
+{
+    const __m128 scale = _mm_set1_ps( 1.f / 2147483648.f );
+    size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        const __m128i v = _mm_loadu_si128( (const __m128i *)&src[i] );
+        _mm_storeu_ps( &dst[i], _mm_mul_ps( _mm_cvtepi32_ps( v ), scale ) );
+    }
+    s32_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static inline __attribute__((__target__("sse2")))
+__m128i fl32_s16_walken_sse2( __m128 v )
+{
+    v = _mm_add_ps( _mm_max_ps( v, _mm_set1_ps( -2.f ) ), _mm_set1_ps( 384.f ) );
+    return _mm_sub_epi32( _mm_castps_si128( v ), _mm_set1_epi32( 0x43c00000 ) );
+}
+
+static __attribute__((__target__("sse2")))
+void fl32_s16_sse2( int16_t *dst, const float *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i lo = fl32_s16_walken_sse2( _mm_loadu_ps( &src[i] ) );
+        const __m128i hi = fl32_s16_walken_sse2( _mm_loadu_ps( &src[i + 4] ) );
+        _mm_storeu_si128( (__m128i *)&dst[i], _mm_packs_epi32( lo, hi ) );
+    }
+    fl32_s16_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("sse2")))
+void fl32_s32_sse2( int32_t *dst, const float *src, size_t count )
+{
+    const __m128 scale = _mm_set1_ps( 2147483648.f );
+    const __m128 half = _mm_set1_ps( .5f );
+    size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        const __m128 s = _mm_mul_ps( _mm_loadu_ps( &src[i] ), scale );
+        __m128i t = _mm_cvttps_epi32( s );
+        const __m128 f = _mm_sub_ps( s, _mm_cvtepi32_ps( t ) );
+        /* the masks are -1 where set */
+        t = _mm_sub_epi32( t, _mm_castps_si128( _mm_cmpge_ps( f, half ) ) );
+        t = _mm_add_epi32( t, _mm_castps_si128(
+                _mm_cmple_ps( f, _mm_sub_ps( _mm_setzero_ps(), half ) ) ) );
+
+        const __m128i over = _mm_castps_si128( _mm_cmpge_ps( s, scale ) );
+        const __m128i under = _mm_castps_si128(
+                _mm_cmple_ps( s, _mm_sub_ps( _mm_setzero_ps(), scale ) ) );
+        t = _mm_or_si128( _mm_andnot_si128( _mm_or_si128( over, under ), t ),
+                          _mm_or_si128( _mm_and_si128( over, _mm_set1_epi32( INT32_MAX ) ),
+                                        _mm_and_si128( under, _mm_set1_epi32( INT32_MIN ) ) ) );
+        _mm_storeu_si128( (__m128i *)&dst[i], t );
+    }
+    fl32_s32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("sse2")))
+void s16_s32_sse2( int32_t *dst, const int16_t *src, size_t count )
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i v = _mm_loadu_si128( (const __m128i *)&src[i] );
+        _mm_storeu_si128( (__m128i *)&dst[i],     _mm_unpacklo_epi16( zero, v ) );
+        _mm_storeu_si128( (__m128i *)&dst[i + 4], _mm_unpackhi_epi16( zero, v ) );
+    }
+    s16_s32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("sse2")))
+void s32_s16_sse2( int16_t *dst, const int32_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i lo = _mm_loadu_si128( (const __m128i *)&src[i] );
+        const __m128i hi = _mm_loadu_si128( (const __m128i *)&src[i + 4] );
+        _mm_storeu_si128( (__m128i *)&dst[i],
+                          _mm_packs_epi32( _mm_srai_epi32( lo, 16 ),
+                                           _mm_srai_epi32( hi, 16 ) ) );
+    }
+    s32_s16_c( &dst[i], &src[i], count - i );
+}
+# endif
+
+/*****************************************************************************
+ * AVX2
+ *****************************************************************************/
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_FORMAT_AVX2 1
+
+static __attribute__((__target__("avx2")))
+void s16_fl32_avx2( float *dst, const int16_t *src, size_t count )
+{
+    const __m256 scale = _mm256_set1_ps( 1.f / 32768.f );
+    size_t i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        const __m256i lo = _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *)&src[i] ) );
+        const __m256i hi = _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *)&src[i + 8] ) );
+        _mm256_storeu_ps( &dst[i],     _mm256_mul_ps( _mm256_cvtepi32_ps( lo ), scale ) );
+        _mm256_storeu_ps( &dst[i + 8], _mm256_mul_ps( _mm256_cvtepi32_ps( hi ), scale ) );
+    }
+    s16_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("avx2")))
+void s32_fl32_avx2( float *dst, const int32_t *src, size_t count )
+{
+    const __m256 scale = _mm256_set1_ps( 1.f / 2147483648.f );
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m256i v = _mm256_loadu_si256( (const __m256i *)&src[i] );
+        _mm256_storeu_ps( &dst[i], _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+    }
+    s32_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static inline __attribute__((__target__("avx2")))
+__m256i fl32_s16_walken_avx2( __m256 v )
+{
+    v = _mm256_add_ps( _mm256_max_ps( v, _mm256_set1_ps( -2.f ) ),
+                       _mm256_set1_ps( 384.f ) );
+    return _mm256_sub_epi32( _mm256_castps_si256( v ),
+                             _mm256_set1_epi32( 0x43c00000 ) );
+}
+
+static __attribute__((__target__("avx2")))
+void fl32_s16_avx2( int16_t *dst, const float *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        const __m256i lo = fl32_s16_walken_avx2( _mm256_loadu_ps( &src[i] ) );
+        const __m256i hi = fl32_s16_walken_avx2( _mm256_loadu_ps( &src[i + 8] ) );
+        /* packs works within the 128 bits halves */
+        _mm256_storeu_si256( (__m256i *)&dst[i],
+            _mm256_permute4x64_epi64( _mm256_packs_epi32( lo, hi ), 0xd8 ) );
+    }
+    fl32_s16_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("avx2")))
+void fl32_s32_avx2( int32_t *dst, const float *src, size_t count )
+{
+    const __m256 scale = _mm256_set1_ps( 2147483648.f );
+    const __m256 nscale = _mm256_set1_ps( -2147483648.f );
+    const __m256 half = _mm256_set1_ps( .5f );
+    const __m256 nhalf = _mm256_set1_ps( -.5f );
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m256 s = _mm256_mul_ps( _mm256_loadu_ps( &src[i] ), scale );
+        __m256i t = _mm256_cvttps_epi32( s );
+        const __m256 f = _mm256_sub_ps( s, _mm256_cvtepi32_ps( t ) );
+        /* the masks are -1 where set */
+        t = _mm256_sub_epi32( t, _mm256_castps_si256( _mm256_cmp_ps( f, half, _CMP_GE_OQ ) ) );
+        t = _mm256_add_epi32( t, _mm256_castps_si256( _mm256_cmp_ps( f, nhalf, _CMP_LE_OQ ) ) );
+
+        t = _mm256_blendv_epi8( t, _mm256_set1_epi32( INT32_MAX ),
+                _mm256_castps_si256( _mm256_cmp_ps( s, scale, _CMP_GE_OQ ) ) );
+        t = _mm256_blendv_epi8( t, _mm256_set1_epi32( INT32_MIN ),
+                _mm256_castps_si256( _mm256_cmp_ps( s, nscale, _CMP_LE_OQ ) ) );
+        _mm256_storeu_si256( (__m256i *)&dst[i], t );
+    }
+    fl32_s32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("avx2")))
+void s16_s32_avx2( int32_t *dst, const int16_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m256i v = _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *)&src[i] ) );
+        _mm256_storeu_si256( (__m256i *)&dst[i], _mm256_slli_epi32( v, 16 ) );
+    }
+    s16_s32_c( &dst[i], &src[i], count - i );
+}
+
+static __attribute__((__target__("avx2")))
+void s32_s16_avx2( int16_t *dst, const int32_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        const __m256i lo = _mm256_loadu_si256( (const __m256i *)&src[i] );
+        const __m256i hi = _mm256_loadu_si256( (const __m256i *)&src[i + 8] );
+        const __m256i v = _mm256_packs_epi32( _mm256_srai_epi32( lo, 16 ),
+                                              _mm256_srai_epi32( hi, 16 ) );
+        _mm256_storeu_si256( (__m256i *)&dst[i],
+                             _mm256_permute4x64_epi64( v, 0xd8 ) );
+    }
+    s32_s16_c( &dst[i], &src[i], count - i );
+}
+# endif
+#endif
+
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_FORMAT_NEON 1
+
+static void s16_fl32_neon( float *dst, const int16_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const int16x8_t v = vld1q_s16( &src[i] );
+        vst1q_f32( &dst[i], vmulq_n_f32( vcvtq_f32_s32(
+                   vmovl_s16( vget_low_s16( v ) ) ), 1.f / 32768.f ) );
+        vst1q_f32( &dst[i + 4], vmulq_n_f32( vcvtq_f32_s32(
+                   vmovl_s16( vget_high_s16( v ) ) ), 1.f / 32768.f ) );
+    }
+    s16_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static void s32_fl32_neon( float *dst, const int32_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+        vst1q_f32( &dst[i], vmulq_n_f32( vcvtq_f32_s32( vld1q_s32( &src[i] ) ),
+                                         1.f / 2147483648.f ) );
+    s32_fl32_c( &dst[i], &src[i], count - i );
+}
+
+static inline int16x4_t fl32_s16_walken_neon( float32x4_t v )
+{
+    v = vaddq_f32( vmaxq_f32( v, vdupq_n_f32( -2.f ) ), vdupq_n_f32( 384.f ) );
+    return vqmovn_s32( vsubq_s32( vreinterpretq_s32_f32( v ),
+                                  vdupq_n_s32( 0x43c00000 ) ) );
+}
+
+static void fl32_s16_neon( int16_t *dst, const float *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const int16x4_t lo = fl32_s16_walken_neon( vld1q_f32( &src[i] ) );
+        const int16x4_t hi = fl32_s16_walken_neon( vld1q_f32( &src[i + 4] ) );
+        vst1q_s16( &dst[i], vcombine_s16( lo, hi ) );
+    }
+    fl32_s16_c( &dst[i], &src[i], count - i );
+}
+
+/* The conversions to integers saturate: the corrections saturate as well */
+static void fl32_s32_neon( int32_t *dst, const float *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        const float32x4_t s = vmulq_n_f32( vld1q_f32( &src[i] ), 2147483648.f );
+        int32x4_t t = vcvtq_s32_f32( s );
+        const float32x4_t f = vsubq_f32( s, vcvtq_f32_s32( t ) );
+        /* the masks are -1 where set */
+        t = vqsubq_s32( t, vreinterpretq_s32_u32( vcgeq_f32( f, vdupq_n_f32( .5f ) ) ) );
+        t = vqaddq_s32( t, vreinterpretq_s32_u32( vcleq_f32( f, vdupq_n_f32( -.5f ) ) ) );
+        vst1q_s32( &dst[i], t );
+    }
+    fl32_s32_c( &dst[i], &src[i], count - i );
+}
+
+static void s16_s32_neon( int32_t *dst, const int16_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const int16x8_t v = vld1q_s16( &src[i] );
+        vst1q_s32( &dst[i],     vshll_n_s16( vget_low_s16( v ), 16 ) );
+        vst1q_s32( &dst[i + 4], vshll_n_s16( vget_high_s16( v ), 16 ) );
+    }
+    s16_s32_c( &dst[i], &src[i], count - i );
+}
+
+static void s32_s16_neon( int16_t *dst, const int32_t *src, size_t count )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const int16x4_t lo = vshrn_n_s32( vld1q_s32( &src[i] ), 16 );
+        const int16x4_t hi = vshrn_n_s32( vld1q_s32( &src[i + 4] ), 16 );
+        vst1q_s16( &dst[i], vcombine_s16( lo, hi ) );
+    }
+    s32_s16_c( &dst[i], &src[i], count - i );
+}
+#endif
+
+void format_kernels_InitC( format_kernels_t *k )
+{
+    k->s16_fl32 = s16_fl32_c;
+    k->s32_fl32 = s32_fl32_c;
+    k->fl32_s16 = fl32_s16_c;
+    k->fl32_s32 = fl32_s32_c;
+    k->s16_s32 = s16_s32_c;
+    k->s32_s16 = s32_s16_c;
+    k->name = "C";
+}
+
+void format_kernels_Init( format_kernels_t *k )
+{
+    format_kernels_InitC( k );
+
+#ifdef CAN_COMPILE_FORMAT_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        k->s16_fl32 = s16_fl32_avx2;
+        k->s32_fl32 = s32_fl32_avx2;
+        k->fl32_s16 = fl32_s16_avx2;
+        k->fl32_s32 = fl32_s32_avx2;
+        k->s16_s32 = s16_s32_avx2;
+        k->s32_s16 = s32_s16_avx2;
+        k->name = "AVX2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_FORMAT_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        k->s16_fl32 = s16_fl32_sse2;
+        k->s32_fl32 = s32_fl32_sse2;
+        k->fl32_s16 = fl32_s16_sse2;
+        k->fl32_s32 = fl32_s32_sse2;
+        k->s16_s32 = s16_s32_sse2;
+        k->s32_s16 = s32_s16_sse2;
+        k->name = "SSE2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_FORMAT_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        k->s16_fl32 = s16_fl32_neon;
+        k->s32_fl32 = s32_fl32_neon;
+        k->fl32_s16 = fl32_s16_neon;
+        k->fl32_s32 = fl32_s32_neon;
+        k->s16_s32 = s16_s32_neon;
+        k->s32_s16 = s32_s16_neon;
+        k->name = "NEON";
+        return;
+    }
+#endif
+}
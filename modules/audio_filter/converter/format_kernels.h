@@ -0,0 +1,58 @@
+/*****************************************************************************
+ * format_kernels.h: vectorized PCM samples conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FORMAT_KERNELS_H
+#define VLC_FORMAT_KERNELS_H
+
+/**
+ * \file
+ * Conversions of arrays of native endian samples between the most common
+ * PCM formats. They compute the same output as the plain C conversions of
+ * format.c, bit for bit, including the clipping of the floats.
+ *
+ * The destination may alias the source when its samples are not wider,
+ * as the conversions in place of the filter do.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    void (*s16_fl32)( float *dst, const int16_t *src, size_t count );
+    void (*s32_fl32)( float *dst, const int32_t *src, size_t count );
+    void (*fl32_s16)( int16_t *dst, const float *src, size_t count );
+    void (*fl32_s32)( int32_t *dst, const float *src, size_t count );
+    void (*s16_s32)( int32_t *dst, const int16_t *src, size_t count );
+    void (*s32_s16)( int16_t *dst, const int32_t *src, size_t count );
+    const char *name;
+} format_kernels_t;
+
+/**
+ * Selects the fastest kernels supported by the CPU.
+ */
+void format_kernels_Init( format_kernels_t * );
+
+/**
+ * Selects the plain C kernels.
+ */
+void format_kernels_InitC( format_kernels_t * );
+
+#endif
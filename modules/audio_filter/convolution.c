@@ -0,0 +1,216 @@
+/*****************************************************************************
+ * convolution.c: impulse response convolution filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+
+#include "convolver.h"
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+
+static int      Open        ( vlc_object_t * );
+
+typedef struct
+{
+    convolver_t *conv;
+    vlc_tick_t latency;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+
+#define HELP_TEXT N_( \
+    "Convolves the audio with an impulse response, for room correction " \
+    "or reverberation. The response is read from a WAVE file at the rate " \
+    "of the audio, with either one channel for all the audio channels or " \
+    "one channel per audio channel.")
+
+#define FILE_TEXT N_( "Impulse response file" )
+#define FILE_LONGTEXT N_( "WAVE file of the impulse response." )
+
+#define BLOCK_TEXT N_( "Block size" )
+#define BLOCK_LONGTEXT N_( \
+    "Number of samples processed at once, that is the latency of the " \
+    "filter. Larger blocks need less CPU with long responses." )
+
+#define GAIN_TEXT N_( "Gain" )
+#define GAIN_LONGTEXT N_( "Gain applied to the impulse response, in dB." )
+
+static const int block_values[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+static const char *const block_texts[] = {
+    "64", "128", "256", "512", "1024", "2048", "4096",
+};
+
+vlc_module_begin()
+    set_shortname( N_("Convolution") )
+    set_description( N_("Impulse response convolution") )
+    set_help( HELP_TEXT )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+
+    add_loadfile( "convolution-file", NULL, FILE_TEXT, FILE_LONGTEXT )
+    add_integer( "convolution-block", 256, BLOCK_TEXT, BLOCK_LONGTEXT )
+        change_integer_list( block_values, block_texts )
+    add_float_with_range( "convolution-gain", 0., -40., 40.,
+                          GAIN_TEXT, GAIN_LONGTEXT )
+
+    set_capability( "audio filter", 0 )
+    add_shortcut( "convolution" )
+    set_callback( Open )
+vlc_module_end()
+
+/*****************************************************************************
+ * Process: convolve the samples buffer
+ *****************************************************************************/
+
+static block_t *Process( filter_t *p_filter, block_t *p_block )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    float *p_samples = (float *)p_block->p_buffer;
+
+    convolver_Process( p_sys->conv, p_samples, p_samples,
+                       p_block->i_nb_samples );
+
+    /* the samples are those of one block before */
+    if( p_block->i_pts != VLC_TICK_INVALID )
+        p_block->i_pts -= p_sys->latency;
+    if( p_block->i_dts != VLC_TICK_INVALID )
+        p_block->i_dts -= p_sys->latency;
+    return p_block;
+}
+
+static void Flush( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    convolver_Reset( p_sys->conv );
+}
+
+static void Close( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    convolver_Delete( p_sys->conv );
+    free( p_sys );
+}
+
+/*****************************************************************************
+ * Open: initialize filter
+ *****************************************************************************/
+
+static int Open( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+    unsigned i_channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+
+    char *psz_file = var_InheritString( p_filter, "convolution-file" );
+    if( psz_file == NULL )
+    {
+        msg_Err( p_filter, "no impulse response file" );
+        return VLC_EGENERIC;
+    }
+
+    unsigned i_ir_channels, i_ir_rate;
+    size_t i_taps;
+    float *p_ir = convolver_LoadWAV( p_this, psz_file, &i_ir_channels,
+                                     &i_ir_rate, &i_taps );
+    if( p_ir == NULL )
+    {
+        free( psz_file );
+        return VLC_EGENERIC;
+    }
+
+    if( i_ir_rate != p_filter->fmt_in.audio.i_rate
+     || (i_ir_channels != 1 && i_ir_channels != i_channels) )
+    {
+        msg_Err( p_filter, "%s: %u channels at %u Hz does not fit %u channels "
+                 "at %u Hz", psz_file, i_ir_channels, i_ir_rate, i_channels,
+                 p_filter->fmt_in.audio.i_rate );
+        free( p_ir );
+        free( psz_file );
+        return VLC_EGENERIC;
+    }
+
+    const float f_gain = powf( 10.f, var_InheritFloat( p_filter,
+                                                  "convolution-gain" ) / 20.f );
+    for( size_t i = 0; i < i_ir_channels * i_taps; i++ )
+        p_ir[i] *= f_gain;
+
+    struct convolver_filter filters[AOUT_CHAN_MAX];
+    for( unsigned i = 0; i < i_channels; i++ )
+        filters[i] = (struct convolver_filter) {
+            .input = i, .output = i, .length = i_taps,
+            .ir = &p_ir[(i_ir_channels > 1 ? i : 0) * i_taps],
+        };
+
+    unsigned i_block = var_InheritInteger( p_filter, "convolution-block" );
+    filter_sys_t *p_sys = malloc( sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+    {
+        free( p_ir );
+        free( psz_file );
+        return VLC_ENOMEM;
+    }
+
+    p_sys->conv = convolver_New( i_block, i_channels, i_channels,
+                                 filters, i_channels );
+    free( p_ir );
+    if( p_sys->conv == NULL )
+    {
+        msg_Err( p_filter, "cannot convolve with blocks of %u samples",
+                 i_block );
+        free( p_sys );
+        free( psz_file );
+        return VLC_EGENERIC;
+    }
+    p_sys->latency = vlc_tick_from_samples( i_block,
+                                            p_filter->fmt_in.audio.i_rate );
+
+    msg_Dbg( p_filter, "convolving with %s: %zu taps, blocks of %u samples "
+             "(%s)", psz_file, i_taps, i_block,
+             convolver_GetKernelsName( p_sys->conv ) );
+    free( psz_file );
+
+    p_filter->p_sys = p_sys;
+    p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
+    aout_FormatPrepare( &p_filter->fmt_in.audio );
+    p_filter->fmt_out.audio = p_filter->fmt_in.audio;
+
+    static const struct vlc_filter_operations filter_ops =
+        { .filter_audio = Process, .flush = Flush, .close = Close };
+    p_filter->ops = &filter_ops;
+
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,747 @@
+/*****************************************************************************
+ * convolver.c: partitioned FFT convolution of audio streams
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_fs.h>
+
+#include "convolver.h"
+
+/*
+ * With a block of B samples, the transforms are real FFTs of 2B samples:
+ * the previous and the current input blocks, and an impulse response
+ * partition padded with B zeros. The last B samples of the inverse transform
+ * of their product are the linear convolution of the current block by the
+ * partition. The spectra of the past input blocks are kept in a frequency
+ * domain delay line, and partition p multiplies the spectrum of the block
+ * input p blocks ago.
+ *
+ * The spectra are B + 1 complex bins, held as split real and imaginary parts
+ * padded to a multiple of 8 floats. The multiply-accumulate of the spectra,
+ * which dominates with long responses, is a straight loop over these arrays.
+ */
+
+struct convolver_partitions
+{
+    unsigned input;
+    unsigned output;
+    unsigned count;
+    float *spectra;   /* count spectra of 2 * stride floats */
+    bool *used;       /* false for the partitions of zeros */
+};
+
+typedef void (*cmac_t)( float *yr, float *yi,
+                        const float *xr, const float *xi,
+                        const float *hr, const float *hi, size_t count );
+
+struct convolver
+{
+    unsigned block;
+    unsigned stride;
+    unsigned inputs;
+    unsigned outputs;
+    unsigned depth;   /* length of the delay line, in blocks */
+    unsigned slot;    /* delay line slot of the newest spectra */
+    unsigned fill;    /* samples of the current block */
+
+    float *in;        /* previous and current blocks of each input */
+    float *out;       /* last computed block of each output */
+    float *fdl;       /* depth spectra of each input */
+    float *acc;       /* spectrum of an output */
+    float *work;      /* 4 arrays of B floats for the complex FFT */
+    float *twr;       /* B + 1 twiddles exp(-2i pi k / 2B) */
+    float *twi;
+
+    struct convolver_partitions *filters;
+    size_t filter_count;
+
+    cmac_t cmac;
+    const char *kernels;
+};
+
+/*****************************************************************************
+ * Multiply-accumulate of spectra
+ *****************************************************************************/
+static void cmac_c( float *yr, float *yi, const float *xr, const float *xi,
+                    const float *hr, const float *hi, size_t count )
+{
+    for( size_t k = 0; k < count; k++ )
+    {
+        yr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+        yi[k] += xr[k] * hi[k] + xi[k] * hr[k];
+    }
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_CONVOLVER_SSE2 1
+
+static __attribute__((__target__("sse2")))
+void cmac_sse2( float *yr, float *yi, const float *xr, const float *xi,
+                const float *hr, const float *hi, size_t count )
+{
+    for( size_t k = 0; k < count; k += 4 )
+    {
+        const __m128 ar = _mm_loadu_ps( &xr[k] ), ai = _mm_loadu_ps( &xi[k] );
+        const __m128 br = _mm_loadu_ps( &hr[k] ), bi = _mm_loadu_ps( &hi[k] );
+        __m128 r = _mm_sub_ps( _mm_mul_ps( ar, br ), _mm_mul_ps( ai, bi ) );
+        __m128 i = _mm_add_ps( _mm_mul_ps( ar, bi ), _mm_mul_ps( ai, br ) );
+        _mm_storeu_ps( &yr[k], _mm_add_ps( _mm_loadu_ps( &yr[k] ), r ) );
+        _mm_storeu_ps( &yi[k], _mm_add_ps( _mm_loadu_ps( &yi[k] ), i ) );
+    }
+}
+# endif
+
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_CONVOLVER_AVX2 1
+
+static __attribute__((__target__("avx2")))
+void cmac_avx2( float *yr, float *yi, const float *xr, const float *xi,
+                const float *hr, const float *hi, size_t count )
+{
+    for( size_t k = 0; k < count; k += 8 )
+    {
+        const __m256 ar = _mm256_loadu_ps( &xr[k] );
+        const __m256 ai = _mm256_loadu_ps( &xi[k] );
+        const __m256 br = _mm256_loadu_ps( &hr[k] );
+        const __m256 bi = _mm256_loadu_ps( &hi[k] );
+        __m256 r = _mm256_sub_ps( _mm256_mul_ps( ar, br ),
+                                  _mm256_mul_ps( ai, bi ) );
+        __m256 i = _mm256_add_ps( _mm256_mul_ps( ar, bi ),
+                                  _mm256_mul_ps( ai, br ) );
+        _mm256_storeu_ps( &yr[k], _mm256_add_ps( _mm256_loadu_ps( &yr[k] ), r ) );
+        _mm256_storeu_ps( &yi[k], _mm256_add_ps( _mm256_loadu_ps( &yi[k] ), i ) );
+    }
+}
+# endif
+#endif
+
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_CONVOLVER_NEON 1
+
+static void cmac_neon( float *yr, float *yi, const float *xr, const float *xi,
+                       const float *hr, const float *hi, size_t count )
+{
+    for( size_t k = 0; k < count; k += 4 )
+    {
+        const float32x4_t ar = vld1q_f32( &xr[k] ), ai = vld1q_f32( &xi[k] );
+        const float32x4_t br = vld1q_f32( &hr[k] ), bi = vld1q_f32( &hi[k] );
+        float32x4_t r = vmlaq_f32( vld1q_f32( &yr[k] ), ar, br );
+        float32x4_t i = vmlaq_f32( vld1q_f32( &yi[k] ), ar, bi );
+        vst1q_f32( &yr[k], vmlsq_f32( r, ai, bi ) );
+        vst1q_f32( &yi[k], vmlaq_f32( i, ai, br ) );
+    }
+}
+#endif
+
+static void SelectKernels( convolver_t *c )
+{
+    c->cmac = cmac_c;
+    c->kernels = "C";
+
+#ifdef CAN_COMPILE_CONVOLVER_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        c->cmac = cmac_avx2;
+        c->kernels = "AVX2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_CONVOLVER_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        c->cmac = cmac_sse2;
+        c->kernels = "SSE2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_CONVOLVER_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        c->cmac = cmac_neon;
+        c->kernels = "NEON";
+        return;
+    }
+#endif
+}
+
+/*****************************************************************************
+ * FFT
+ *****************************************************************************/
+
+/* Complex FFT of B points (Stockham autosort, radix 2): the inner loops run
+ * over contiguous samples. The result is left in buf[0] or buf[1]; the
+ * inverse is computed by swapping the real and imaginary parts. */
+static void FFT( const convolver_t *c, float *buf[2][2], unsigned *res )
+{
+    const unsigned n = c->block;
+    unsigned src = 0;
+
+    for( unsigned l = n / 2, m = 1; l >= 1; l /= 2, m *= 2 )
+    {
+        const float *xr = buf[src][0], *xi = buf[src][1];
+        float *restrict yr = buf[!src][0], *restrict yi = buf[!src][1];
+
+        for( unsigned j = 0; j < l; j++ )
+        {
+            /* exp(-2i pi j m / B) */
+            const float wr = c->twr[2 * j * m], wi = c->twi[2 * j * m];
+            const float *ar = &xr[j * m], *ai = &xi[j * m];
+            const float *br = &xr[(j + l) * m], *bi = &xi[(j + l) * m];
+            float *cr = &yr[2 * j * m], *ci = &yi[2 * j * m];
+            float *dr = &yr[(2 * j + 1) * m], *di = &yi[(2 * j + 1) * m];
+
+            for( unsigned k = 0; k < m; k++ )
+            {
+                const float sr = ar[k] - br[k], si = ai[k] - bi[k];
+                cr[k] = ar[k] + br[k];
+                ci[k] = ai[k] + bi[k];
+                dr[k] = sr * wr - si * wi;
+                di[k] = sr * wi + si * wr;
+            }
+        }
+        src = !src;
+    }
+    *res = src;
+}
+
+/* Spectrum of 2B real samples, scaled by 2 */
+static void ForwardFFT( const convolver_t *c, const float *in,
+                        float *outr, float *outi )
+{
+    const unsigned n = c->block;
+    float *buf[2][2] = {
+        { c->work, c->work + n }, { c->work + 2 * n, c->work + 3 * n },
+    };
+    unsigned res;
+
+    /* the even samples as the real parts, the odd ones as the imaginary */
+    for( unsigned i = 0; i < n; i++ )
+    {
+        buf[0][0][i] = in[2 * i];
+        buf[0][1][i] = in[2 * i + 1];
+    }
+    FFT( c, buf, &res );
+
+    const float *zr = buf[res][0], *zi = buf[res][1];
+    for( unsigned k = 0; k <= n; k++ )
+    {
+        const unsigned k1 = k & (n - 1), k2 = (n - k) & (n - 1);
+        /* even part: Z[k] + conj(Z[n - k]), odd part: -i (Z[k] - conj()) */
+        const float er = zr[k1] + zr[k2], ei = zi[k1] - zi[k2];
+        const float odr = zi[k1] + zi[k2], odi = zr[k2] - zr[k1];
+        outr[k] = er + odr * c->twr[k] - odi * c->twi[k];
+        outi[k] = ei + odr * c->twi[k] + odi * c->twr[k];
+    }
+    for( unsigned k = n + 1; k < c->stride; k++ )
+        outr[k] = outi[k] = 0.f;
+}
+
+/* Last B real samples of the inverse transform, scaled by 2B */
+static void InverseFFT( const convolver_t *c, const float *inr,
+                        const float *ini, float *out )
+{
+    const unsigned n = c->block;
+    /* the inverse transform is the transform of the swapped parts */
+    float *buf[2][2] = {
+        { c->work + n, c->work }, { c->work + 3 * n, c->work + 2 * n },
+    };
+    unsigned res;
+
+    for( unsigned k = 0; k < n; k++ )
+    {
+        const float er = inr[k] + inr[n - k], ei = ini[k] - ini[n - k];
+        const float sr = inr[k] - inr[n - k], si = ini[k] + ini[n - k];
+        /* odd part: (X[k] - conj(X[n - k])) exp(2i pi k / 2B) */
+        const float odr = sr * c->twr[k] + si * c->twi[k];
+        const float odi = si * c->twr[k] - sr * c->twi[k];
+        c->work[k] = er - odi;
+        c->work[n + k] = ei + odr;
+    }
+    FFT( c, buf, &res );
+
+    /* swapped back */
+    const float *zr = buf[res][1], *zi = buf[res][0];
+    for( unsigned i = 0; i < n / 2; i++ )
+    {
+        out[2 * i] = zr[n / 2 + i];
+        out[2 * i + 1] = zi[n / 2 + i];
+    }
+}
+
+/*****************************************************************************
+ * Convolver
+ *****************************************************************************/
+static float *Spectrum( const convolver_t *c, float *base, size_t index )
+{
+    return base + index * 2 * c->stride;
+}
+
+convolver_t *convolver_New( unsigned block, unsigned inputs, unsigned outputs,
+                            const struct convolver_filter *filters,
+                            size_t count )
+{
+    if( block < 16 || block > 16384 || (block & (block - 1))
+     || inputs == 0 || outputs == 0 )
+        return NULL;
+
+    convolver_t *c = calloc( 1, sizeof (*c) );
+    if( unlikely(c == NULL) )
+        return NULL;
+
+    c->block = block;
+    c->stride = block + 8;
+    c->inputs = inputs;
+    c->outputs = outputs;
+    c->depth = 1;
+    SelectKernels( c );
+
+    c->twr = vlc_alloc( 2 * (block + 1), sizeof (float) );
+    c->work = vlc_alloc( 4 * block, sizeof (float) );
+    c->in = vlc_alloc( 2 * block * inputs, sizeof (float) );
+    c->out = vlc_alloc( block * outputs, sizeof (float) );
+    c->acc = vlc_alloc( 2 * c->stride, sizeof (float) );
+    c->filters = calloc( count ? count : 1, sizeof (*c->filters) );
+    if( c->twr == NULL || c->work == NULL || c->in == NULL || c->out == NULL
+     || c->acc == NULL || c->filters == NULL )
+        goto error;
+
+    c->twi = c->twr + block + 1;
+    for( unsigned k = 0; k <= block; k++ )
+    {
+        c->twr[k] = cos( M_PI * k / block );
+        c->twi[k] = -sin( M_PI * k / block );
+    }
+
+    /* The transforms scale the product by 8B instead of the 1/2 of the
+     * forward and inverse transforms: the filters compensate */
+    const float scale = 1.f / (8 * block);
+    float *pad = vlc_alloc( 2 * block, sizeof (float) );
+    if( pad == NULL )
+        goto error;
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        const struct convolver_filter *f = &filters[i];
+        struct convolver_partitions *p = &c->filters[c->filter_count++];
+
+        assert( f->input < inputs && f->output < outputs );
+        p->input = f->input;
+        p->output = f->output;
+        p->count = (f->length + block - 1) / block;
+        if( p->count == 0 )
+            continue;
+        p->spectra = vlc_alloc( p->count, 2 * c->stride * sizeof (float) );
+        p->used = calloc( p->count, sizeof (bool) );
+        if( p->spectra == NULL || p->used == NULL )
+        {
+            free( pad );
+            goto error;
+        }
+
+        for( unsigned j = 0; j < p->count; j++ )
+        {
+            size_t len = __MIN( (size_t)block, f->length - (size_t)j * block );
+
+            memset( pad, 0, 2 * block * sizeof (float) );
+            for( size_t t = 0; t < len; t++ )
+            {
+                pad[t] = f->ir[(size_t)j * block + t] * scale;
+                p->used[j] |= pad[t] != 0.f;
+            }
+            float *s = Spectrum( c, p->spectra, j );
+            ForwardFFT( c, pad, s, s + c->stride );
+        }
+        if( p->count > c->depth )
+            c->depth = p->count;
+    }
+    free( pad );
+
+    c->fdl = vlc_alloc( (size_t)inputs * c->depth,
+                        2 * c->stride * sizeof (float) );
+    if( c->fdl == NULL )
+        goto error;
+
+    convolver_Reset( c );
+    return c;
+
+error:
+    convolver_Delete( c );
+    return NULL;
+}
+
+void convolver_Delete( convolver_t *c )
+{
+    for( size_t i = 0; i < c->filter_count; i++ )
+    {
+        free( c->filters[i].spectra );
+        free( c->filters[i].used );
+    }
+    free( c->filters );
+    free( c->fdl );
+    free( c->acc );
+    free( c->out );
+    free( c->in );
+    free( c->work );
+    free( c->twr );
+    free( c );
+}
+
+void convolver_Reset( convolver_t *c )
+{
+    memset( c->in, 0, 2 * c->block * c->inputs * sizeof (float) );
+    memset( c->out, 0, c->block * c->outputs * sizeof (float) );
+    memset( c->fdl, 0, (size_t)c->inputs * c->depth * 2 * c->stride
+                       * sizeof (float) );
+    c->slot = 0;
+    c->fill = 0;
+}
+
+const char *convolver_GetKernelsName( const convolver_t *c )
+{
+    return c->kernels;
+}
+
+static void ProcessBlock( convolver_t *c )
+{
+    const unsigned n = c->block;
+
+    for( unsigned i = 0; i < c->inputs; i++ )
+    {
+        float *in = &c->in[2 * n * i];
+        float *s = Spectrum( c, c->fdl, (size_t)i * c->depth + c->slot );
+
+        ForwardFFT( c, in, s, s + c->stride );
+        memcpy( in, in + n, n * sizeof (float) );
+    }
+
+    for( unsigned o = 0; o < c->outputs; o++ )
+    {
+        float *yr = c->acc, *yi = c->acc + c->stride;
+        bool used = false;
+
+        memset( c->acc, 0, 2 * c->stride * sizeof (float) );
+        for( size_t f = 0; f < c->filter_count; f++ )
+        {
+            const struct convolver_partitions *p = &c->filters[f];
+            if( p->output != o )
+                continue;
+
+            for( unsigned j = 0; j < p->count; j++ )
+            {
+                if( !p->used[j] )
+                    continue;
+
+                unsigned slot = (c->slot + c->depth - j) % c->depth;
+                const float *x = Spectrum( c, c->fdl,
+                                           (size_t)p->input * c->depth + slot );
+                const float *h = Spectrum( c, p->spectra, j );
+                c->cmac( yr, yi, x, x + c->stride, h, h + c->stride,
+                         c->stride );
+                used = true;
+            }
+        }
+
+        if( used )
+            InverseFFT( c, yr, yi, &c->out[n * o] );
+        else
+            memset( &c->out[n * o], 0, n * sizeof (float) );
+    }
+
+    c->slot = (c->slot + 1) % c->depth;
+}
+
+void convolver_Process( convolver_t *c, const float *in, float *out,
+                        size_t frames )
+{
+    const unsigned n = c->block;
+
+    while( frames > 0 )
+    {
+        size_t len = __MIN( frames, (size_t)(n - c->fill) );
+
+        /* all the input frames are read before the output ones are written */
+        for( unsigned i = 0; i < c->inputs; i++ )
+        {
+            float *dst = &c->in[2 * n * i + n + c->fill];
+            for( size_t j = 0; j < len; j++ )
+                dst[j] = in[j * c->inputs + i];
+        }
+        for( unsigned o = 0; o < c->outputs; o++ )
+        {
+            const float *src = &c->out[n * o + c->fill];
+            for( size_t j = 0; j < len; j++ )
+                out[j * c->outputs + o] = src[j];
+        }
+
+        in += len * c->inputs;
+        out += len * c->outputs;
+        frames -= len;
+        c->fill += len;
+        if( c->fill == n )
+        {
+            ProcessBlock( c );
+            c->fill = 0;
+        }
+    }
+}
+
+/*****************************************************************************
+ * WAVE files
+ *****************************************************************************/
+#define WAV_MAX_SIZE (256 << 20)
+
+static float *ParseWAV( vlc_object_t *obj, const uint8_t *p, size_t size,
+                        unsigned *channels, unsigned *rate, size_t *frames )
+{
+    unsigned tag = 0, nb = 0, bits = 0;
+    const uint8_t *data = NULL;
+    size_t data_size = 0;
+
+    *rate = 0;
+    if( size < 12 || memcmp( p, "RIFF", 4 ) || memcmp( p + 8, "WAVE", 4 ) )
+    {
+        msg_Err( obj, "not a RIFF WAVE file" );
+        return NULL;
+    }
+
+    for( size_t pos = 12; pos + 8 <= size; )
+    {
+        const uint8_t *chunk = p + pos;
+        size_t len = GetDWLE( chunk + 4 );
+
+        if( len > size - pos - 8 )
+            len = size - pos - 8; /* truncated file */
+
+        if( !memcmp( chunk, "fmt ", 4 ) && len >= 16 )
+        {
+            tag = GetWLE( chunk + 8 );
+            nb = GetWLE( chunk + 10 );
+            *rate = GetDWLE( chunk + 12 );
+            bits = GetWLE( chunk + 22 );
+            /* WAVE_FORMAT_EXTENSIBLE: the tag starts the sub-format GUID */
+            if( tag == 0xFFFE && len >= 26 )
+                tag = GetWLE( chunk + 32 );
+        }
+        else if( !memcmp( chunk, "data", 4 ) )
+        {
+            data = chunk + 8;
+            data_size = len;
+        }
+        pos += 8 + len + (len & 1);
+    }
+
+    bool is_float = tag == 3;
+    if( data == NULL || nb == 0 || *rate == 0
+     || !(tag == 1 || is_float)
+     || (is_float ? (bits != 32 && bits != 64)
+                  : (bits != 8 && bits != 16 && bits != 24 && bits != 32)) )
+    {
+        msg_Err( obj, "unsupported WAVE format %#x, %u bits", tag, bits );
+        return NULL;
+    }
+
+    const unsigned bytes = bits / 8;
+    *channels = nb;
+    *frames = data_size / (bytes * nb);
+    if( *frames == 0 )
+        return NULL;
+
+    float *ir = vlc_alloc( *frames * nb, sizeof (float) );
+    if( unlikely(ir == NULL) )
+        return NULL;
+
+    for( size_t t = 0; t < *frames; t++ )
+        for( unsigned ch = 0; ch < nb; ch++ )
+        {
+            const uint8_t *s = data + (t * nb + ch) * bytes;
+            float v;
+
+            switch( bits )
+            {
+                case 8:
+                    v = (s[0] - 128) / 128.f;
+                    break;
+                case 16:
+                    v = (int16_t)GetWLE( s ) / 32768.f;
+                    break;
+                case 24:
+                    v = (int32_t)((uint32_t)GetWLE( s ) << 8
+                                  | (uint32_t)s[2] << 24) / 2147483648.f;
+                    break;
+                case 32:
+                    if( is_float )
+                    {
+                        union { uint32_t u; float f; } u = { GetDWLE( s ) };
+                        v = u.f;
+                    }
+                    else
+                        v = (int32_t)GetDWLE( s ) / 2147483648.f;
+                    break;
+                default:
+                {
+                    union { uint64_t u; double d; } u = { GetQWLE( s ) };
+                    v = u.d;
+                    break;
+                }
+            }
+            ir[ch * *frames + t] = v;
+        }
+    return ir;
+}
+
+float *convolver_LoadWAV( vlc_object_t *obj, const char *path,
+                          unsigned *channels, unsigned *rate, size_t *frames )
+{
+    FILE *file = vlc_fopen( path, "rb" );
+    if( file == NULL )
+    {
+        msg_Err( obj, "cannot open %s: %s", path, vlc_strerror_c( errno ) );
+        return NULL;
+    }
+
+    uint8_t *buf = NULL;
+    size_t size = 0;
+    float *ir = NULL;
+
+    for( ;; )
+    {
+        uint8_t *grown = realloc( buf, size + 65536 );
+        if( grown == NULL )
+            goto out;
+        buf = grown;
+
+        size_t len = fread( buf + size, 1, 65536, file );
+        size += len;
+        if( len < 65536 )
+            break;
+        if( size > WAV_MAX_SIZE )
+        {
+            msg_Err( obj, "%s is too large", path );
+            goto out;
+        }
+    }
+
+    ir = ParseWAV( obj, buf, size, channels, rate, frames );
+out:
+    free( buf );
+    fclose( file );
+    return ir;
+}
+
+#ifdef CONVOLVER_TEST
+/*****************************************************************************
+ * Test: compare with the direct convolution
+ *****************************************************************************/
+static bool Test( unsigned block, unsigned inputs, unsigned outputs,
+                  size_t taps, size_t frames )
+{
+    struct convolver_filter filters[4];
+    float *irs = malloc( 4 * taps * sizeof (float) );
+    size_t count = 0;
+
+    for( unsigned o = 0; o < outputs; o++ )
+        for( unsigned i = 0; i < inputs && count < 4; i++ )
+        {
+            float *ir = &irs[count * taps];
+            for( size_t t = 0; t < taps; t++ )
+                ir[t] = (rand() / (float)RAND_MAX - .5f) * expf( -(float)t / taps );
+            /* a silent partition, as sparse responses have */
+            if( taps > 2 * block )
+                memset( &ir[block], 0, block * sizeof (float) );
+            filters[count++] = (struct convolver_filter) {
+                .input = i, .output = o, .ir = ir, .length = taps,
+            };
+        }
+
+    convolver_t *c = convolver_New( block, inputs, outputs, filters, count );
+    assert( c != NULL );
+
+    float *in = malloc( frames * inputs * sizeof (float) );
+    float *out = malloc( frames * outputs * sizeof (float) );
+    for( size_t j = 0; j < frames * inputs; j++ )
+        in[j] = rand() / (float)RAND_MAX - .5f;
+
+    /* any chunking of the stream */
+    for( size_t j = 0; j < frames; )
+    {
+        size_t len = __MIN( frames - j, (size_t)(rand() % (3 * block)) );
+        convolver_Process( c, &in[j * inputs], &out[j * outputs], len );
+        j += len;
+    }
+
+    /* the tail, where all the partitions contribute */
+    double err = 0., ref = 0.;
+    for( size_t j = __MAX( (size_t)block, frames - __MIN( frames, 8192 ) );
+         j < frames; j++ )
+        for( unsigned o = 0; o < outputs; o++ )
+        {
+            double sum = 0.;
+            for( size_t f = 0; f < count; f++ )
+            {
+                if( filters[f].output != o )
+                    continue;
+                for( size_t t = 0; t < taps && t <= j - block; t++ )
+                    sum += filters[f].ir[t]
+                         * in[(j - block - t) * inputs + filters[f].input];
+            }
+            double d = out[j * outputs + o] - sum;
+            err += d * d;
+            ref += sum * sum;
+        }
+
+    double snr = 10. * log10( ref / err );
+    printf( "block %5u, %u -> %u, %6zu taps (%s): %.1f dB\n", block, inputs,
+            outputs, taps, convolver_GetKernelsName( c ), snr );
+
+    convolver_Delete( c );
+    free( out );
+    free( in );
+    free( irs );
+    return snr > 100.;
+}
+
+int main( void )
+{
+    bool ok = true;
+
+    srand( 0 );
+    ok &= Test( 16, 1, 1, 1, 1000 );
+    ok &= Test( 64, 1, 1, 1000, 20000 );
+    ok &= Test( 256, 2, 2, 5000, 30000 );
+    ok &= Test( 128, 4, 1, 300, 5000 );
+    ok &= Test( 256, 1, 2, 65536, 80000 );
+    return ok ? 0 : 1;
+}
+#endif
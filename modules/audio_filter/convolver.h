@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * convolver.h: partitioned FFT convolution of audio streams
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_CONVOLVER_H
+#define VLC_AUDIO_CONVOLVER_H
+
+/**
+ * \file
+ * Convolution of interleaved float samples with long impulse responses.
+ *
+ * The impulse responses are cut into partitions of one block, and the
+ * convolution is done in the frequency domain one block at a time (uniformly
+ * partitioned overlap-save). The cost per sample grows with the number of
+ * partitions rather than with the number of taps: responses of tens of
+ * thousands of taps run in real time.
+ *
+ * The output is delayed by one block. Each output channel is the sum of the
+ * convolutions of the input channels with the filters routed to it, so that
+ * a matrix of filters (a pair of HRIRs per speaker) costs a single inverse
+ * transform per output channel.
+ */
+
+typedef struct convolver convolver_t;
+
+struct convolver_filter
+{
+    unsigned input;   /**< input channel */
+    unsigned output;  /**< output channel */
+    const float *ir;  /**< impulse response */
+    size_t length;    /**< number of taps of the impulse response */
+};
+
+/**
+ * Creates a convolver.
+ *
+ * \param block number of samples per partition, a power of two from 16 to
+ *              16384, that is the latency
+ * \param filters filters to apply, the impulse responses are copied
+ * \return a convolver or NULL on error
+ */
+convolver_t *convolver_New( unsigned block, unsigned inputs, unsigned outputs,
+                            const struct convolver_filter *filters,
+                            size_t count );
+
+void convolver_Delete( convolver_t * );
+
+/**
+ * Convolves frames of interleaved samples.
+ *
+ * Any number of frames can be given, the output is delayed by one block.
+ * The output buffer may be the input buffer when there are no more output
+ * than input channels.
+ */
+void convolver_Process( convolver_t *, const float *in, float *out,
+                        size_t frames );
+
+/**
+ * Forgets the past samples.
+ */
+void convolver_Reset( convolver_t * );
+
+/**
+ * Returns the name of the selected SIMD kernels.
+ */
+const char *convolver_GetKernelsName( const convolver_t * );
+
+/**
+ * Loads an impulse response from a RIFF WAVE file.
+ *
+ * Integer PCM (8, 16, 24 and 32 bits) and float (32 and 64 bits) files are
+ * supported.
+ *
+ * \return the samples, one channel after the other, to be freed, or NULL
+ */
+float *convolver_LoadWAV( vlc_object_t *, const char *path,
+                          unsigned *channels, unsigned *rate, size_t *frames );
+
+#endif
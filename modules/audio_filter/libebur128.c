@@ -22,24 +22,51 @@
 # include "config.h"
 #endif
 
+#include <math.h>
+
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_block.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 #include <vlc_plugin.h>
+#include <vlc_tracer.h>
 
 #include <ebur128.h>
 
 #define UPDATE_INTERVAL VLC_TICK_FROM_MS(400)
+/* Audio queued for the measurement thread, above which it is dropped */
+#define MAX_QUEUE_DURATION VLC_TICK_FROM_SEC(5)
 
 #define CFG_PREFIX "ebur128-"
 
+/*
+ * The measurement runs on its own thread: the filter only queues a copy of
+ * the blocks, and forwards the latest measure to its owner from the audio
+ * thread. The reset of a flush is queued as an empty block, so that the
+ * measure of the audio before it is completed first.
+ */
 struct filter_sys
 {
     int mode;
+
+    /* Owned by the measurement thread */
     ebur128_state *state;
     vlc_tick_t last_update;
     bool new_frames;
+
+    block_fifo_t *fifo;
+    size_t max_queue;
+    unsigned dropped;
+    bool dead; /* protected by the fifo lock */
+    vlc_thread_t thread;
+
+    vlc_mutex_t lock;
+    struct vlc_audio_loudness loudness;
+    bool loudness_changed;
+
+    struct vlc_tracer *tracer;
+    char *id;
 };
 
 static ebur128_state *
@@ -118,7 +145,7 @@ SendLoudnessMeter(filter_t *filter)
         for (unsigned i = 0; i < filter->fmt_in.audio.i_channels; ++i)
         {
             double truepeak;
-            error = ebur128_true_peak(sys->state, 0, &truepeak);
+            error = ebur128_true_peak(sys->state, i, &truepeak);
             if (error != EBUR128_SUCCESS)
                 return error;
             if (truepeak > loudness.truepeak)
@@ -126,24 +153,46 @@ SendLoudnessMeter(filter_t *filter)
         }
     }
 
-    filter_SendAudioLoudness(filter, &loudness);
+    vlc_mutex_lock(&sys->lock);
+    sys->loudness = loudness;
+    sys->loudness_changed = true;
+    vlc_mutex_unlock(&sys->lock);
+
+    if (sys->tracer != NULL)
+    {
+        /* The tracer values are integers: the loudness values are in
+         * thousandths of LUFS (or LU), the peak in thousandths of dBTP */
+#define TRACE_LOUDNESS(name, v) \
+        VLC_TRACE(name, (vlc_tick_t) llround(1000. * fmax(v, -200.)))
+
+        vlc_tracer_Trace(sys->tracer, VLC_TRACE("type", "LOUDNESS"),
+                         VLC_TRACE("id", sys->id),
+                         VLC_TRACE("pts", NS_FROM_VLC_TICK(sys->last_update)),
+                         TRACE_LOUDNESS("momentary", loudness.loudness_momentary),
+                         TRACE_LOUDNESS("shortterm", loudness.loudness_shortterm),
+                         TRACE_LOUDNESS("integrated", loudness.loudness_integrated),
+                         TRACE_LOUDNESS("range", loudness.loudness_range),
+                         TRACE_LOUDNESS("truepeak", 20. * log10(loudness.truepeak)),
+                         VLC_TRACE_END);
+#undef TRACE_LOUDNESS
+    }
 
     return EBUR128_SUCCESS;
 }
 
-static block_t *
-Process(filter_t *filter, block_t *block)
+static void
+Measure(filter_t *filter, block_t *block)
 {
     struct filter_sys *sys = filter->p_sys;
     int error;
-    block_t *out = block;
+    const block_t *out = block;
 
     if (unlikely(sys->state == NULL))
     {
         /* Can happen after a flush */
         sys->state = CreateEbuR128State(filter, sys->mode);
         if (sys->state == NULL)
-            return out;
+            return;
     }
 
     switch (filter->fmt_in.i_codec)
@@ -153,7 +202,7 @@ Process(filter_t *filter, block_t *block)
             /* Convert to S16N */
             short *data_s16 = malloc(block->i_buffer * 2);
             if (unlikely(data_s16 == NULL))
-                return out;
+                return;
 
             uint8_t *src = (uint8_t *)block->p_buffer;
             short *dst = data_s16;
@@ -191,7 +240,7 @@ Process(filter_t *filter, block_t *block)
     if (error != EBUR128_SUCCESS)
     {
         msg_Warn(filter, "ebur128_add_frames_*() failed: %d\n", error);
-        return out;
+        return;
     }
 
     if (sys->last_update == VLC_TICK_INVALID)
@@ -199,21 +248,17 @@ Process(filter_t *filter, block_t *block)
 
     if (out->i_pts + out->i_length - sys->last_update >= UPDATE_INTERVAL)
     {
+        sys->last_update = out->i_pts + out->i_length;
         error = SendLoudnessMeter(filter);
         if (error == EBUR128_SUCCESS)
-        {
-            sys->last_update = out->i_pts + out->i_length;
             sys->new_frames = false;
-        }
     }
     else
         sys->new_frames = true;
-
-    return out;
 }
 
 static void
-Flush(filter_t *filter)
+Reset(filter_t *filter)
 {
     struct filter_sys *sys = filter->p_sys;
 
@@ -230,13 +275,116 @@ Flush(filter_t *filter)
     }
 }
 
+static void *
+Thread(void *data)
+{
+    filter_t *filter = data;
+    struct filter_sys *sys = filter->p_sys;
+
+    vlc_fifo_Lock(sys->fifo);
+    for (;;)
+    {
+        while (vlc_fifo_IsEmpty(sys->fifo) && !sys->dead)
+            vlc_fifo_Wait(sys->fifo);
+        if (sys->dead)
+            break;
+
+        block_t *chain = vlc_fifo_DequeueAllUnlocked(sys->fifo);
+        vlc_fifo_Unlock(sys->fifo);
+
+        while (chain != NULL)
+        {
+            block_t *block = chain;
+            chain = block->p_next;
+
+            if (block->i_nb_samples == 0)
+                Reset(filter);
+            else
+                Measure(filter, block);
+            block_Release(block);
+        }
+
+        vlc_fifo_Lock(sys->fifo);
+    }
+    vlc_fifo_Unlock(sys->fifo);
+    return NULL;
+}
+
+static block_t *
+Process(filter_t *filter, block_t *block)
+{
+    struct filter_sys *sys = filter->p_sys;
+
+    if (block->i_nb_samples > 0)
+    {
+        block_t *copy = block_Duplicate(block);
+        if (likely(copy != NULL))
+        {
+            vlc_fifo_Lock(sys->fifo);
+            if (vlc_fifo_GetBytes(sys->fifo) + copy->i_buffer <= sys->max_queue)
+            {
+                vlc_fifo_QueueUnlocked(sys->fifo, copy);
+                copy = NULL;
+            }
+            vlc_fifo_Unlock(sys->fifo);
+
+            if (copy != NULL)
+            {
+                if (sys->dropped++ == 0)
+                    msg_Warn(filter, "measurement too slow, dropping audio");
+                block_Release(copy);
+            }
+        }
+    }
+
+    /* The meter of the owner is updated from the audio thread */
+    if (filter->owner.audio != NULL
+     && filter->owner.audio->meter_loudness.on_changed != NULL)
+    {
+        struct vlc_audio_loudness loudness;
+        bool changed;
+
+        vlc_mutex_lock(&sys->lock);
+        changed = sys->loudness_changed;
+        loudness = sys->loudness;
+        sys->loudness_changed = false;
+        vlc_mutex_unlock(&sys->lock);
+
+        if (changed)
+            filter_SendAudioLoudness(filter, &loudness);
+    }
+
+    return block;
+}
+
+static void
+Flush(filter_t *filter)
+{
+    struct filter_sys *sys = filter->p_sys;
+
+    block_t *reset = block_Alloc(0);
+    if (likely(reset != NULL))
+        vlc_fifo_Push(sys->fifo, reset);
+}
+
 static void
 Close(filter_t *filter)
 {
     struct filter_sys *sys = filter->p_sys;
 
+    vlc_fifo_Lock(sys->fifo);
+    sys->dead = true;
+    vlc_fifo_Signal(sys->fifo);
+    vlc_fifo_Unlock(sys->fifo);
+    vlc_join(sys->thread, NULL);
+
+    if (sys->dropped > 0)
+        msg_Warn(filter, "%u blocks were not measured", sys->dropped);
+
+    block_FifoRelease(sys->fifo);
     if (sys->state != NULL)
         ebur128_destroy(&sys->state);
+    free(sys->id);
     free(filter->p_sys);
 }
 
@@ -261,7 +409,7 @@ static int Open(vlc_object_t *this)
     }
 
     static const char *const options[] = {
-        "mode", NULL
+        "mode", "id", NULL
     };
     config_ChainParse(filter, CFG_PREFIX, options, filter->p_cfg);
 
@@ -291,7 +439,37 @@ static int Open(vlc_object_t *this)
         return VLC_EGENERIC;
     }
 
+    sys->fifo = block_FifoNew();
+    if (unlikely(sys->fifo == NULL))
+    {
+        ebur128_destroy(&sys->state);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+    sys->max_queue = samples_from_vlc_tick(MAX_QUEUE_DURATION,
+                                           filter->fmt_in.audio.i_rate)
+                   * filter->fmt_in.audio.i_bytes_per_frame;
+    sys->dropped = 0;
+    sys->dead = false;
+    vlc_mutex_init(&sys->lock);
+    sys->loudness_changed = false;
+
+    sys->tracer = vlc_object_get_tracer(VLC_OBJECT(filter));
+    sys->id = var_InheritString(filter, CFG_PREFIX "id");
+    if (sys->id == NULL)
+        sys->id = strdup(MODULE_STRING);
+
     filter->p_sys = sys;
+    if (unlikely(sys->id == NULL)
+     || vlc_clone(&sys->thread, Thread, filter, VLC_THREAD_PRIORITY_LOW))
+    {
+        free(sys->id);
+        block_FifoRelease(sys->fifo);
+        ebur128_destroy(&sys->state);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
     filter->fmt_out.audio = filter->fmt_in.audio;
     filter->ops = &filter_ops;
     return VLC_SUCCESS;
@@ -303,6 +481,14 @@ vlc_module_begin()
     set_category(CAT_AUDIO)
     set_subcategory(SUBCAT_AUDIO_AFILTER)
     add_integer_with_range(CFG_PREFIX "mode", 0, 0, 4, N_("Mode"), NULL)
+    add_string(CFG_PREFIX "id", NULL, N_("Identifier"),
+               N_("Identifier of the measured stream in the traces"))
     set_capability("audio meter", 0)
     set_callback(Open)
+
+    /* Measurement within an audio filter chain, e.g. of a transcoding, the
+     * measures being published in the traces only */
+    add_submodule()
+    set_capability("audio filter", 0)
+    set_callback(Open)
 vlc_module_end()
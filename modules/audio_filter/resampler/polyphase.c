@@ -0,0 +1,844 @@
+/*****************************************************************************
+ * polyphase.c : polyphase windowed sinc resampler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble:
+ *
+ * Every output sample is the dot product of the input around its position
+ * with a Kaiser windowed sinc low-pass filter, sampled at the fractional
+ * part of the position: the filter bank holds one row of coefficients per
+ * phase.
+ *
+ * When the ratio of the rates reduces to a small enough fraction L/M, the
+ * bank holds the exact L phases, and the positions are stepped in integers.
+ * Otherwise, and whenever the input rate is changed (drift correction or
+ * playback rate), the position is a 32.32 fixed point value and the output
+ * is linearly interpolated between the two nearest of VR_PHASES phases: both
+ * rows are computed in the same pass over the input.
+ *
+ * The banks depend on the rates and quality only, and are shared between
+ * the instances, e.g. from one track to the next.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+#include <vlc_list.h>
+
+#define QUALITY_TEXT N_("Resampling quality")
+#define QUALITY_LONGTEXT N_("Resampling quality, from fastest to best. " \
+    "The best quality uses longer filters.")
+
+static const int quality_values[] = { 0, 1, 2 };
+static const char *const quality_texts[] = {
+    N_("Low"), N_("Medium"), N_("High"),
+};
+
+static int  OpenConverter( vlc_object_t * );
+static int  OpenResampler( vlc_object_t * );
+static void Close( filter_t * );
+
+vlc_module_begin ()
+    set_shortname( N_("Polyphase resampler") )
+    set_description( N_("Polyphase windowed sinc resampler") )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_RESAMPLER )
+    add_integer( "polyphase-resampler-quality", 2,
+                 QUALITY_TEXT, QUALITY_LONGTEXT )
+        change_integer_list( quality_values, quality_texts )
+    set_capability( "audio converter", 30 )
+    set_callback( OpenConverter )
+
+    add_submodule()
+    set_capability( "audio resampler", 30 )
+    set_callback( OpenResampler )
+    add_shortcut( "polyphase" )
+vlc_module_end ()
+
+/* Phases of the interpolated bank */
+#define VR_PHASES 256
+/* Above, the ratio is resampled with the interpolated bank */
+#define MAX_EXACT_PHASES 1024
+/* Banks kept while unused */
+#define BANK_CACHE_SIZE 4
+
+static const struct
+{
+    unsigned taps;   /* for upsampling, scaled for downsampling */
+    double   cutoff; /* of the output Nyquist frequency */
+    double   beta;   /* of the Kaiser window */
+} qualities[] = {
+    { 16, 0.80, 5.0 },
+    { 32, 0.88, 7.0 },
+    { 64, 0.94, 9.0 },
+};
+
+/*****************************************************************************
+ * Dot products
+ *****************************************************************************/
+
+/* The number of taps is rounded up to a multiple of 8, so that the
+ * vectorized loops have no tail */
+#define TAPS_ALIGN 8
+
+typedef float (*dot_t)( const float *x, const float *h, unsigned taps );
+/* between the rows h and h + taps, at the fraction f */
+typedef float (*dot_interp_t)( const float *x, const float *h, unsigned taps,
+                               float f );
+
+static float dot_c( const float *x, const float *h, unsigned taps )
+{
+    float acc = 0.f;
+    for( unsigned i = 0; i < taps; i++ )
+        acc += x[i] * h[i];
+    return acc;
+}
+
+static float dot_interp_c( const float *x, const float *h, unsigned taps,
+                           float f )
+{
+    const float *h1 = h + taps;
+    float a0 = 0.f, a1 = 0.f;
+    for( unsigned i = 0; i < taps; i++ )
+    {
+        a0 += x[i] * h[i];
+        a1 += x[i] * h1[i];
+    }
+    return a0 + f * (a1 - a0);
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_POLYPHASE_SSE2 1
+
+static inline __attribute__((__target__("sse2")))
+float hsum_sse2( __m128 v )
+{
+    v = _mm_add_ps( v, _mm_movehl_ps( v, v ) );
+    v = _mm_add_ss( v, _mm_shuffle_ps( v, v, 1 ) );
+    return _mm_cvtss_f32( v );
+}
+
+static __attribute__((__target__("sse2")))
+float dot_sse2( const float *x, const float *h, unsigned taps )
+{
+    __m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+
+    for( unsigned i = 0; i < taps; i += 8 )
+    {
+        a = _mm_add_ps( a, _mm_mul_ps( _mm_loadu_ps( &x[i] ),
+                                       _mm_loadu_ps( &h[i] ) ) );
+        b = _mm_add_ps( b, _mm_mul_ps( _mm_loadu_ps( &x[i + 4] ),
+                                       _mm_loadu_ps( &h[i + 4] ) ) );
+    }
+    return hsum_sse2( _mm_add_ps( a, b ) );
+}
+
+static __attribute__((__target__("sse2")))
+float dot_interp_sse2( const float *x, const float *h, unsigned taps, float f )
+{
+    const float *h1 = h + taps;
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+
+    for( unsigned i = 0; i < taps; i += 4 )
+    {
+        const __m128 v = _mm_loadu_ps( &x[i] );
+        a0 = _mm_add_ps( a0, _mm_mul_ps( v, _mm_loadu_ps( &h[i] ) ) );
+        a1 = _mm_add_ps( a1, _mm_mul_ps( v, _mm_loadu_ps( &h1[i] ) ) );
+    }
+    const float s0 = hsum_sse2( a0 );
+    return s0 + f * (hsum_sse2( a1 ) - s0);
+}
+# endif
+
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_POLYPHASE_AVX2 1
+
+static inline __attribute__((__target__("avx2")))
+float hsum_avx2( __m256 v )
+{
+    __m128 s = _mm_add_ps( _mm256_castps256_ps128( v ),
+                           _mm256_extractf128_ps( v, 1 ) );
+    s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+    s = _mm_add_ss( s, _mm_shuffle_ps( s, s, 1 ) );
+    return _mm_cvtss_f32( s );
+}
+
+static __attribute__((__target__("avx2")))
+float dot_avx2( const float *x, const float *h, unsigned taps )
+{
+    __m256 a = _mm256_setzero_ps();
+
+    for( unsigned i = 0; i < taps; i += 8 )
+        a = _mm256_add_ps( a, _mm256_mul_ps( _mm256_loadu_ps( &x[i] ),
+                                             _mm256_loadu_ps( &h[i] ) ) );
+    return hsum_avx2( a );
+}
+
+static __attribute__((__target__("avx2")))
+float dot_interp_avx2( const float *x, const float *h, unsigned taps, float f )
+{
+    const float *h1 = h + taps;
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+
+    for( unsigned i = 0; i < taps; i += 8 )
+    {
+        const __m256 v = _mm256_loadu_ps( &x[i] );
+        a0 = _mm256_add_ps( a0, _mm256_mul_ps( v, _mm256_loadu_ps( &h[i] ) ) );
+        a1 = _mm256_add_ps( a1, _mm256_mul_ps( v, _mm256_loadu_ps( &h1[i] ) ) );
+    }
+    const float s0 = hsum_avx2( a0 );
+    return s0 + f * (hsum_avx2( a1 ) - s0);
+}
+# endif
+#endif
+
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_POLYPHASE_NEON 1
+
+static inline float hsum_neon( float32x4_t v )
+{
+    float32x2_t s = vadd_f32( vget_low_f32( v ), vget_high_f32( v ) );
+    return vget_lane_f32( vpadd_f32( s, s ), 0 );
+}
+
+static float dot_neon( const float *x, const float *h, unsigned taps )
+{
+    float32x4_t a = vdupq_n_f32( 0.f ), b = vdupq_n_f32( 0.f );
+
+    for( unsigned i = 0; i < taps; i += 8 )
+    {
+        a = vmlaq_f32( a, vld1q_f32( &x[i] ), vld1q_f32( &h[i] ) );
+        b = vmlaq_f32( b, vld1q_f32( &x[i + 4] ), vld1q_f32( &h[i + 4] ) );
+    }
+    return hsum_neon( vaddq_f32( a, b ) );
+}
+
+static float dot_interp_neon( const float *x, const float *h, unsigned taps,
+                              float f )
+{
+    const float *h1 = h + taps;
+    float32x4_t a0 = vdupq_n_f32( 0.f ), a1 = vdupq_n_f32( 0.f );
+
+    for( unsigned i = 0; i < taps; i += 4 )
+    {
+        const float32x4_t v = vld1q_f32( &x[i] );
+        a0 = vmlaq_f32( a0, v, vld1q_f32( &h[i] ) );
+        a1 = vmlaq_f32( a1, v, vld1q_f32( &h1[i] ) );
+    }
+    const float s0 = hsum_neon( a0 );
+    return s0 + f * (hsum_neon( a1 ) - s0);
+}
+#endif
+
+/*****************************************************************************
+ * Filter banks
+ *****************************************************************************/
+typedef struct
+{
+    struct vlc_list node;
+    unsigned refs;
+
+    unsigned phases;
+    unsigned taps;
+    unsigned quality;
+    double   fc;      /* cutoff, of the input sampling frequency */
+    float    coefs[]; /* (phases + 1) rows of taps */
+} bank_t;
+
+static vlc_mutex_t banks_lock = VLC_STATIC_MUTEX;
+/* Most recently used first */
+static struct vlc_list banks = VLC_LIST_INITIALIZER( &banks );
+
+static double BesselI0( double x )
+{
+    double sum = 1., term = 1.;
+
+    for( unsigned k = 1; term > sum * 1e-12; k++ )
+    {
+        const double t = x / (2. * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+/* The row of the phase p holds the filter at the times (taps/2 - 1 + p/phases
+ * - k) for the taps k: the guard row at p = phases is the last phase of the
+ * interpolation. Every row is normalized to a unity DC gain. */
+static void BankCompute( bank_t *bank, double beta )
+{
+    const double half = bank->taps / 2.;
+    const double i0beta = BesselI0( beta );
+
+    for( unsigned p = 0; p <= bank->phases; p++ )
+    {
+        float *row = &bank->coefs[p * bank->taps];
+        double sum = 0.;
+
+        for( unsigned k = 0; k < bank->taps; k++ )
+        {
+            const double t = half - 1. + (double)p / bank->phases - k;
+            double v = 0.;
+
+            if( fabs( t ) < half )
+            {
+                const double r = t / half;
+                const double x = M_PI * bank->fc * t;
+                v = bank->fc * (x != 0. ? sin( x ) / x : 1.)
+                  * BesselI0( beta * sqrt( 1. - r * r ) ) / i0beta;
+            }
+            row[k] = v;
+            sum += v;
+        }
+        for( unsigned k = 0; k < bank->taps; k++ )
+            row[k] /= sum;
+    }
+}
+
+static bank_t *BankHold( unsigned phases, unsigned taps, unsigned quality,
+                         double fc )
+{
+    bank_t *bank;
+
+    vlc_mutex_lock( &banks_lock );
+    vlc_list_foreach( bank, &banks, node )
+    {
+        if( bank->phases == phases && bank->taps == taps
+         && bank->quality == quality && bank->fc == fc )
+        {
+            vlc_list_remove( &bank->node );
+            goto out;
+        }
+    }
+
+    bank = malloc( sizeof(*bank)
+                 + (phases + 1) * taps * sizeof(bank->coefs[0]) );
+    if( unlikely(bank == NULL) )
+    {
+        vlc_mutex_unlock( &banks_lock );
+        return NULL;
+    }
+    bank->refs = 0;
+    bank->phases = phases;
+    bank->taps = taps;
+    bank->quality = quality;
+    bank->fc = fc;
+    BankCompute( bank, qualities[quality].beta );
+out:
+    bank->refs++;
+    vlc_list_prepend( &bank->node, &banks );
+    vlc_mutex_unlock( &banks_lock );
+    return bank;
+}
+
+static void BankRelease( bank_t *bank )
+{
+    unsigned unused = 0;
+
+    vlc_mutex_lock( &banks_lock );
+    assert( bank->refs > 0 );
+    bank->refs--;
+
+    /* evict the least recently used unused banks */
+    vlc_list_foreach( bank, &banks, node )
+    {
+        if( bank->refs > 0 )
+            continue;
+        if( ++unused > BANK_CACHE_SIZE )
+        {
+            vlc_list_remove( &bank->node );
+            free( bank );
+        }
+    }
+    vlc_mutex_unlock( &banks_lock );
+}
+
+/*****************************************************************************
+ * Resampler
+ *****************************************************************************/
+typedef struct
+{
+    unsigned channels;
+    unsigned quality;
+    unsigned taps;
+    double   fc;
+    unsigned rate_out;
+
+    /* exact bank of the nominal ratio, or NULL */
+    bank_t  *exact;
+    unsigned rate_in;  /* nominal */
+    unsigned L, M;     /* reduced ratio of the rates */
+    unsigned phase;    /* in [0, L) */
+
+    /* interpolated bank, created on first use */
+    bank_t  *vr;
+    uint32_t frac;     /* fractional position, in 1/2^32 */
+    bool     variable; /* whether the position is in frac */
+
+    /* per channel input history, planar */
+    float   *buf;
+    size_t   stride;   /* allocated samples per channel */
+    size_t   avail;    /* valid samples per channel */
+    size_t   pos;      /* first tap of the next output sample */
+
+    vlc_tick_t end_pts; /* date of the sample following the buffer */
+
+    dot_t        dot;
+    dot_interp_t dot_interp;
+} filter_sys_t;
+
+static block_t *Resample( filter_t *, block_t * );
+static block_t *Drain( filter_t * );
+static void     Flush( filter_t * );
+
+static unsigned gcd( unsigned a, unsigned b )
+{
+    while( b != 0 )
+    {
+        unsigned c = a % b;
+        a = b;
+        b = c;
+    }
+    return a;
+}
+
+/* The output of the sample at the position pos is centered at pos + taps/2
+ * - 1: that many zeros are buffered for the first input sample to be at
+ * the center of the first output one */
+static void Reset( filter_sys_t *sys )
+{
+    sys->avail = sys->taps / 2 - 1;
+    for( unsigned c = 0; c < sys->channels; c++ )
+        memset( &sys->buf[c * sys->stride], 0, sys->avail * sizeof(float) );
+    sys->pos = 0;
+    sys->phase = 0;
+    sys->frac = 0;
+    sys->end_pts = VLC_TICK_INVALID;
+}
+
+static int Open( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+    const audio_format_t *in = &filter->fmt_in.audio;
+    const audio_format_t *out = &filter->fmt_out.audio;
+
+    /* Cannot convert format */
+    if( in->i_format != VLC_CODEC_FL32 || out->i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || in->i_channels != out->i_channels || in->i_channels == 0
+     || in->i_rate == 0 || out->i_rate == 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = calloc( 1, sizeof(*sys) );
+    if( unlikely(sys == NULL) )
+        return VLC_ENOMEM;
+
+    int64_t q = var_InheritInteger( obj, "polyphase-resampler-quality" );
+    sys->quality = VLC_CLIP( q, 0, (int64_t)ARRAY_SIZE(qualities) - 1 );
+    sys->channels = in->i_channels;
+    sys->rate_in = in->i_rate;
+    sys->rate_out = out->i_rate;
+
+    /* The filter is widened when downsampling, to keep the same transition
+     * band relative to the output rate */
+    unsigned taps = qualities[sys->quality].taps;
+    double fc = qualities[sys->quality].cutoff;
+    if( in->i_rate > out->i_rate )
+    {
+        taps = ceil( taps * (double)in->i_rate / out->i_rate );
+        fc *= (double)out->i_rate / in->i_rate;
+    }
+    sys->taps = (taps + TAPS_ALIGN - 1) & ~(TAPS_ALIGN - 1);
+    sys->fc = fc;
+
+    const unsigned g = gcd( in->i_rate, out->i_rate );
+    sys->L = out->i_rate / g;
+    sys->M = in->i_rate / g;
+    if( sys->L <= MAX_EXACT_PHASES )
+    {
+        sys->exact = BankHold( sys->L, sys->taps, sys->quality, fc );
+        if( unlikely(sys->exact == NULL) )
+            goto error;
+    }
+    else
+    {
+        sys->vr = BankHold( VR_PHASES, sys->taps, sys->quality, fc );
+        if( unlikely(sys->vr == NULL) )
+            goto error;
+        sys->variable = true;
+    }
+
+    sys->stride = 4096;
+    sys->buf = vlc_alloc( sys->channels * sys->stride, sizeof(float) );
+    if( unlikely(sys->buf == NULL) )
+        goto error;
+    Reset( sys );
+
+    sys->dot = dot_c;
+    sys->dot_interp = dot_interp_c;
+#ifdef CAN_COMPILE_POLYPHASE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        sys->dot = dot_avx2;
+        sys->dot_interp = dot_interp_avx2;
+    }
+    else
+#endif
+#ifdef CAN_COMPILE_POLYPHASE_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        sys->dot = dot_sse2;
+        sys->dot_interp = dot_interp_sse2;
+    }
+    else
+#endif
+#ifdef CAN_COMPILE_POLYPHASE_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        sys->dot = dot_neon;
+        sys->dot_interp = dot_interp_neon;
+    }
+    else
+#endif
+    {}
+
+    msg_Dbg( filter, "%u Hz to %u Hz, %u taps, %u phases%s",
+             in->i_rate, out->i_rate, sys->taps,
+             sys->exact ? sys->L : VR_PHASES,
+             sys->exact ? "" : " interpolated" );
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+    filter->ops = &filter_ops;
+    filter->p_sys = sys;
+    return VLC_SUCCESS;
+
+error:
+    if( sys->exact != NULL )
+        BankRelease( sys->exact );
+    if( sys->vr != NULL )
+        BankRelease( sys->vr );
+    free( sys );
+    return VLC_ENOMEM;
+}
+
+static int OpenResampler( vlc_object_t *obj )
+{
+    return Open( obj );
+}
+
+static int OpenConverter( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if( filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate )
+        return VLC_EGENERIC;
+    return Open( obj );
+}
+
+static void Close( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if( sys->exact != NULL )
+        BankRelease( sys->exact );
+    if( sys->vr != NULL )
+        BankRelease( sys->vr );
+    free( sys->buf );
+    free( sys );
+}
+
+static void Flush( filter_t *filter )
+{
+    Reset( filter->p_sys );
+}
+
+/* Appends interleaved samples to the history, or zeros if in is NULL */
+static int Append( filter_sys_t *sys, const float *in, size_t count )
+{
+    const unsigned channels = sys->channels;
+
+    if( sys->avail + count > sys->stride )
+    {
+        size_t stride = sys->stride * 2;
+        while( sys->avail + count > stride )
+            stride *= 2;
+
+        float *buf = vlc_alloc( channels * stride, sizeof(float) );
+        if( unlikely(buf == NULL) )
+            return VLC_ENOMEM;
+        for( unsigned c = 0; c < channels; c++ )
+            memcpy( &buf[c * stride], &sys->buf[c * sys->stride],
+                    sys->avail * sizeof(float) );
+        free( sys->buf );
+        sys->buf = buf;
+        sys->stride = stride;
+    }
+
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        float *dst = &sys->buf[c * sys->stride + sys->avail];
+        if( in == NULL )
+            memset( dst, 0, count * sizeof(float) );
+        else
+            for( size_t i = 0; i < count; i++ )
+                dst[i] = in[i * channels + c];
+    }
+    sys->avail += count;
+    return VLC_SUCCESS;
+}
+
+/* Drops the samples before the next output one */
+static void Compact( filter_sys_t *sys )
+{
+    if( sys->pos == 0 )
+        return;
+
+    assert( sys->pos <= sys->avail );
+    for( unsigned c = 0; c < sys->channels; c++ )
+    {
+        float *buf = &sys->buf[c * sys->stride];
+        memmove( buf, &buf[sys->pos], (sys->avail - sys->pos) * sizeof(float) );
+    }
+    sys->avail -= sys->pos;
+    sys->pos = 0;
+}
+
+/* Switches the position between the exact phases and the fractional one,
+ * within half an exact phase */
+static int SetVariable( filter_sys_t *sys, bool variable )
+{
+    if( sys->variable == variable )
+        return VLC_SUCCESS;
+
+    assert( sys->exact != NULL );
+    if( variable )
+    {
+        if( sys->vr == NULL )
+        {
+            sys->vr = BankHold( VR_PHASES, sys->taps, sys->quality, sys->fc );
+            if( unlikely(sys->vr == NULL) )
+                return VLC_ENOMEM;
+        }
+        sys->frac = ((uint64_t)sys->phase << 32) / sys->L;
+    }
+    else
+    {
+        uint64_t phase = ((uint64_t)sys->frac * sys->L + (UINT64_C(1) << 31)) >> 32;
+        if( phase == sys->L )
+        {
+            phase = 0;
+            sys->pos++;
+        }
+        sys->phase = phase;
+    }
+    sys->variable = variable;
+    return VLC_SUCCESS;
+}
+
+static size_t ResampleExact( filter_sys_t *sys, float *out )
+{
+    const unsigned channels = sys->channels, taps = sys->taps;
+    const unsigned L = sys->L, M = sys->M;
+
+    if( sys->avail < sys->pos + taps )
+        return 0;
+    const size_t count = ((sys->avail - taps - sys->pos + 1) * L - 1
+                          - sys->phase) / M + 1;
+
+    if( L == 1 && M == 1 )
+    {   /* same rates: the samples are only delayed by the filter */
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            const float *x = &sys->buf[c * sys->stride + sys->pos + taps / 2 - 1];
+            for( size_t i = 0; i < count; i++ )
+                out[i * channels + c] = x[i];
+        }
+        sys->pos += count;
+        return count;
+    }
+
+    size_t pos = 0;
+    unsigned phase = 0;
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        const float *x = &sys->buf[c * sys->stride];
+
+        pos = sys->pos;
+        phase = sys->phase;
+        for( size_t i = 0; i < count; i++ )
+        {
+            out[i * channels + c] = sys->dot( &x[pos],
+                                              &sys->exact->coefs[phase * taps],
+                                              taps );
+            phase += M;
+            pos += phase / L;
+            phase %= L;
+        }
+    }
+    sys->pos = pos;
+    sys->phase = phase;
+    return count;
+}
+
+static size_t ResampleVariable( filter_sys_t *sys, float *out,
+                                unsigned rate_in )
+{
+    const unsigned channels = sys->channels, taps = sys->taps;
+    const uint64_t step = ((uint64_t)rate_in << 32) / sys->rate_out;
+    const uint64_t start = ((uint64_t)sys->pos << 32) | sys->frac;
+
+    /* the last position with all its taps available */
+    if( sys->avail < sys->pos + taps || step == 0 )
+        return 0;
+    const uint64_t end = (uint64_t)(sys->avail - taps + 1) << 32;
+    const size_t count = (end - 1 - start) / step + 1;
+
+    uint64_t p = start;
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        const float *x = &sys->buf[c * sys->stride];
+
+        p = start;
+        for( size_t i = 0; i < count; i++ )
+        {
+            const uint32_t frac = p;
+            const unsigned phase = frac >> 24;
+            const float f = (frac & 0xffffff) * (1.f / 16777216.f);
+
+            out[i * channels + c] = sys->dot_interp( &x[p >> 32],
+                                                     &sys->vr->coefs[phase * taps],
+                                                     taps, f );
+            p += step;
+        }
+    }
+    sys->pos = p >> 32;
+    sys->frac = p;
+    return count;
+}
+
+/* Resamples the whole history, the first buffered sample being at date */
+static block_t *Process( filter_t *filter, unsigned rate_in, vlc_tick_t date,
+                         size_t buffered )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned channels = sys->channels;
+
+    /* upper bound of the output samples */
+    const size_t max = (sys->avail - sys->pos) * (uint64_t)sys->rate_out
+                     / rate_in + 2;
+    block_t *out = block_Alloc( max * channels * sizeof(float) );
+    if( unlikely(out == NULL) )
+        return NULL;
+
+    /* date of the center of the first output sample */
+    const double center = sys->pos + sys->taps / 2 - 1 - (double)buffered
+        + (sys->variable ? sys->frac / 4294967296.
+                         : (double)sys->phase / sys->L);
+    out->i_pts = date + llround( center * CLOCK_FREQ / rate_in );
+
+    size_t count;
+    if( sys->variable )
+        count = ResampleVariable( sys, (float *)out->p_buffer, rate_in );
+    else
+        count = ResampleExact( sys, (float *)out->p_buffer );
+    assert( count <= max );
+    Compact( sys );
+
+    if( count == 0 )
+    {
+        block_Release( out );
+        return NULL;
+    }
+
+    out->i_nb_samples = count;
+    out->i_buffer = count * channels * sizeof(float);
+    out->i_dts = out->i_pts;
+    out->i_length = vlc_tick_from_samples( count, sys->rate_out );
+    return out;
+}
+
+static block_t *Resample( filter_t *filter, block_t *in )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned rate_in = filter->fmt_in.audio.i_rate;
+
+    if( in->i_flags & BLOCK_FLAG_DISCONTINUITY )
+        Reset( sys );
+
+    /* The exact bank is only for the nominal ratio */
+    if( sys->exact != NULL
+     && SetVariable( sys, rate_in != sys->rate_in ) != VLC_SUCCESS )
+        goto error;
+
+    const size_t buffered = sys->avail;
+    if( Append( sys, (const float *)in->p_buffer, in->i_nb_samples ) )
+        goto error;
+    sys->end_pts = in->i_pts + vlc_tick_from_samples( in->i_nb_samples,
+                                                      rate_in );
+
+    block_t *out = Process( filter, rate_in, in->i_pts, buffered );
+    if( out != NULL )
+        out->i_flags = in->i_flags;
+    block_Release( in );
+    return out;
+
+error:
+    block_Release( in );
+    return NULL;
+}
+
+static block_t *Drain( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned rate_in = filter->fmt_in.audio.i_rate;
+
+    if( sys->end_pts == VLC_TICK_INVALID )
+        return NULL;
+
+    /* Outputs up to the last input sample at the center */
+    const size_t buffered = sys->avail;
+
+    block_t *out = NULL;
+    if( Append( sys, NULL, sys->taps / 2 ) == VLC_SUCCESS )
+        out = Process( filter, rate_in, sys->end_pts, buffered );
+    Reset( sys );
+    return out;
+}
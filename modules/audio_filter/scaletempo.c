@@ -29,6 +29,7 @@
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
@@ -44,6 +45,11 @@ static int  Open( vlc_object_t * );
 static void Close( filter_t * );
 static block_t *DoWork( filter_t *, block_t * );
 
+static const int pi_quality_values[] = { 0, 1, 2 };
+static const char *const ppsz_quality_texts[] = {
+    N_("Fast"), N_("Normal"), N_("Best"),
+};
+
 #ifdef PITCH_SHIFTER
 static int  OpenPitch( vlc_object_t * );
 static void ClosePitch( filter_t * );
@@ -68,6 +74,12 @@ vlc_module_begin ()
         N_("Overlap Length"), N_("Percentage of stride to overlap") )
     add_integer_with_range( "scaletempo-search", 14, 0, 200,
         N_("Search Length"), N_("Length in milliseconds to search for best overlap position") )
+    add_integer( "scaletempo-quality", 2, N_("Search Quality"),
+        N_("Trade-off between the CPU usage and the accuracy of the search "
+           "for the best overlap position. The normal mode searches at "
+           "coarse steps first, the fast mode also mixes the channels "
+           "together for that first search.") )
+        change_integer_list( pi_quality_values, ppsz_quality_texts )
 #ifdef PITCH_SHIFTER
     add_float_with_range( "pitch-shift", 0, -12, 12,
         N_("Pitch Shift"), N_("Pitch shift in semitones.") )
@@ -129,6 +141,11 @@ typedef struct
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    float   (*dot)( const float *, const float *, unsigned );
+    unsigned  search_step;
+    bool      search_mix;
+    float    *buf_pre_corr_mix;
+    float    *buf_queue_mix;
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
@@ -136,38 +153,201 @@ typedef struct
 #endif
 } filter_sys_t;
 
+/*****************************************************************************
+ * dot: cross correlation of the overlap with one search position
+ *****************************************************************************/
+static float dot_c( const float *a, const float *b, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_SCALETEMPO_SSE2 1
+
+static __attribute__((__target__("sse2")))
+float dot_sse2( const float *a, const float *b, unsigned n )
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( &a[i] ),
+                                             _mm_loadu_ps( &b[i] ) ) );
+        acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( &a[i + 4] ),
+                                             _mm_loadu_ps( &b[i + 4] ) ) );
+    }
+    acc0 = _mm_add_ps( acc0, acc1 );
+    acc0 = _mm_add_ps( acc0, _mm_movehl_ps( acc0, acc0 ) );
+    acc0 = _mm_add_ss( acc0, _mm_shuffle_ps( acc0, acc0, 1 ) );
+    return _mm_cvtss_f32( acc0 ) + dot_c( &a[i], &b[i], n - i );
+}
+# endif
+
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_SCALETEMPO_AVX2 1
+
+static __attribute__((__target__("avx2")))
+float dot_avx2( const float *a, const float *b, unsigned n )
+{
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 16 <= n; i += 16 )
+    {
+        acc0 = _mm256_add_ps( acc0, _mm256_mul_ps( _mm256_loadu_ps( &a[i] ),
+                                                   _mm256_loadu_ps( &b[i] ) ) );
+        acc1 = _mm256_add_ps( acc1, _mm256_mul_ps( _mm256_loadu_ps( &a[i + 8] ),
+                                                   _mm256_loadu_ps( &b[i + 8] ) ) );
+    }
+    acc0 = _mm256_add_ps( acc0, acc1 );
+    __m128 sum = _mm_add_ps( _mm256_castps256_ps128( acc0 ),
+                             _mm256_extractf128_ps( acc0, 1 ) );
+    sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+    sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+    return _mm_cvtss_f32( sum ) + dot_c( &a[i], &b[i], n - i );
+}
+# endif
+#endif
+
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_SCALETEMPO_NEON 1
+
+static float dot_neon( const float *a, const float *b, unsigned n )
+{
+    float32x4_t acc0 = vdupq_n_f32( 0.f ), acc1 = vdupq_n_f32( 0.f );
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = vmlaq_f32( acc0, vld1q_f32( &a[i] ), vld1q_f32( &b[i] ) );
+        acc1 = vmlaq_f32( acc1, vld1q_f32( &a[i + 4] ), vld1q_f32( &b[i + 4] ) );
+    }
+    acc0 = vaddq_f32( acc0, acc1 );
+    float32x2_t sum = vadd_f32( vget_low_f32( acc0 ), vget_high_f32( acc0 ) );
+    return vget_lane_f32( vpadd_f32( sum, sum ), 0 )
+         + dot_c( &a[i], &b[i], n - i );
+}
+#endif
+
+static const char *SelectDot( filter_sys_t *p )
+{
+#ifdef CAN_COMPILE_SCALETEMPO_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        p->dot = dot_avx2;
+        return "AVX2";
+    }
+#endif
+#ifdef CAN_COMPILE_SCALETEMPO_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        p->dot = dot_sse2;
+        return "SSE2";
+    }
+#endif
+#ifdef CAN_COMPILE_SCALETEMPO_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        p->dot = dot_neon;
+        return "NEON";
+    }
+#endif
+    p->dot = dot_c;
+    return "C";
+}
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
 static unsigned best_overlap_offset_float( filter_t *p_filter )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pw, *po, *ppc, *search_start;
+    const unsigned channels = p->samples_per_frame;
+    const unsigned frames = p->samples_overlap / channels - 1;
+    float *pw, *po, *ppc;
     float best_corr = INT_MIN;
     unsigned best_off = 0;
-    unsigned i, off;
+    unsigned i, off, off_min = 0, off_max = p->frames_search;
 
     pw  = p->table_window;
     po  = p->buf_overlap;
-    po += p->samples_per_frame;
+    po += channels;
     ppc = p->buf_pre_corr;
-    for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
+    for( i = channels; i < p->samples_overlap; i++ ) {
       *ppc++ = *pw++ * *po++;
     }
 
-    search_start = (float *)p->buf_queue + p->samples_per_frame;
-    for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+    if( p->search_step > 1 )
+    {   /* coarse search, over the mix of the channels if enabled */
+        const float *mix = p->buf_pre_corr_mix;
+        const float *qmix = p->buf_queue_mix + 1;
+        unsigned stride = 1, length = frames;
+
+        if( !p->search_mix )
+        {
+            mix = p->buf_pre_corr;
+            qmix = (const float *)p->buf_queue + channels;
+            stride = channels;
+            length = p->samples_overlap - channels;
+        }
+        else if( channels > 1 )
+        {
+            const float *q = (const float *)p->buf_queue;
+
+            ppc = p->buf_pre_corr;
+            for( i = 0; i < frames; i++, ppc += channels )
+            {
+                float sum = 0;
+                for( unsigned c = 0; c < channels; c++ )
+                    sum += ppc[c];
+                p->buf_pre_corr_mix[i] = sum;
+            }
+            for( i = 0; i < p->frames_search + frames + 1; i++, q += channels )
+            {
+                float sum = 0;
+                for( unsigned c = 0; c < channels; c++ )
+                    sum += q[c];
+                p->buf_queue_mix[i] = sum;
+            }
+        }
+        else
+        {
+            mix = p->buf_pre_corr;
+            qmix = (const float *)p->buf_queue + 1;
+        }
+
+        for( off = 0; off < p->frames_search; off += p->search_step ) {
+          float corr = p->dot( mix, qmix + off * stride, length );
+          if( corr > best_corr ) {
+            best_corr = corr;
+            best_off  = off;
+          }
+        }
+
+        /* then refine around the best coarse position */
+        off_min = best_off > p->search_step ? best_off - p->search_step + 1 : 0;
+        off_max = __MIN( best_off + p->search_step, p->frames_search );
+        best_corr = INT_MIN;
+    }
+
+    const float *search_start = (const float *)p->buf_queue
+                              + ( off_min + 1 ) * channels;
+    for( off = off_min; off < off_max; off++ ) {
+      float corr = p->dot( p->buf_pre_corr, search_start,
+                           p->samples_overlap - channels );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
       }
-      search_start += p->samples_per_frame;
+      search_start += channels;
     }
 
     return best_off * p->bytes_per_frame;
@@ -352,6 +532,16 @@ static int reinit_buffers( filter_t *p_filter )
                 *pw++ = v;
         }
         p->best_overlap_offset = best_overlap_offset_float;
+
+        if( p->search_mix && p->samples_per_frame > 1 )
+        {
+            p->buf_pre_corr_mix = vlc_alloc( frames_overlap - 1,
+                                             sizeof (float) );
+            p->buf_queue_mix = vlc_alloc( p->frames_search + frames_overlap,
+                                          sizeof (float) );
+            if( !p->buf_pre_corr_mix || !p->buf_queue_mix )
+                return VLC_ENOMEM;
+        }
     }
 
     unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
@@ -422,14 +612,23 @@ static int Open( vlc_object_t *p_this )
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
 
-    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search",
-             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search );
+    int i_quality = var_InheritInteger( p_this, "scaletempo-quality" );
+    p_sys->search_step = i_quality < 2 ? 4 : 1;
+    p_sys->search_mix  = i_quality < 1;
+
+    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search, %u step%s",
+             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search,
+             p_sys->search_step, p_sys->search_mix ? " (mixed)" : "" );
+
+    msg_Dbg( p_this, "using %s correlation", SelectDot( p_sys ) );
 
     p_sys->buf_queue      = NULL;
     p_sys->buf_overlap    = NULL;
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
     p_sys->table_window   = NULL;
+    p_sys->buf_pre_corr_mix = NULL;
+    p_sys->buf_queue_mix  = NULL;
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
     p_sys->bytes_to_slide = 0;
@@ -533,6 +732,8 @@ static void Close( filter_t *p_filter )
     free( p_sys->table_blend );
     free( p_sys->buf_pre_corr );
     free( p_sys->table_window );
+    free( p_sys->buf_pre_corr_mix );
+    free( p_sys->buf_queue_mix );
     free( p_sys );
 }
 
@@ -14,6 +14,7 @@ public:
         allpass();
     void    setbuffer(float *buf, int size);
     inline  float    process(float inp);
+    inline  void     processblock(float *buf, int count);
     void    mute();
     void    setfeedback(float val);
     float    getfeedback();
@@ -42,6 +43,34 @@ inline float allpass::process(float input)
     return output;
 }
 
+// Same as process() over a block, in place
+//
+// As for the combs, the block is cut at the wrap of the delay line so that
+// the loop vectorizes.
+inline void allpass::processblock(float *data, int count)
+{
+    while (count > 0)
+    {
+        int len = bufsize - bufidx;
+        if (len > count)
+            len = count;
+
+        float *buf = buffer + bufidx;
+        for (int i = 0; i < len; i++)
+        {
+            float input = data[i];
+            float bufout = undenormalise(buf[i]);
+
+            data[i] = -input + bufout;
+            buf[i] = input + (bufout*feedback);
+        }
+        data += len;
+        count -= len;
+        bufidx += len;
+        if (bufidx >= bufsize) bufidx = 0;
+    }
+}
+
 #endif//_allpass
 
 //ends
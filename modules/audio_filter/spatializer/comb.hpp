@@ -19,6 +19,7 @@ public:
     comb();
     void    setbuffer(float *buf, int size);
     inline  float    process(float inp);
+    inline  void     processblock(const float *inp, float *out, int count);
     void    mute();
     void    setdamp(float val);
     float    getdamp();
@@ -55,6 +56,37 @@ inline float comb::process(float input)
     return output;
 }
 
+// Same as process() over a block, adding the outputs to out[]
+//
+// The block is cut at the wrap of the delay line: as the segments are never
+// longer than the delay, the reads and the writes of a segment do not
+// overlap and its loop vectorizes. filterstore is only a temporary of
+// process(), it needs not be kept.
+inline void comb::processblock(const float *input, float *out, int count)
+{
+    while (count > 0)
+    {
+        int len = bufsize - bufidx;
+        if (len > count)
+            len = count;
+
+        float *buf = buffer + bufidx;
+        for (int i = 0; i < len; i++)
+        {
+            float output = undenormalise(buf[i]);
+            float store = undenormalise(output*damp2);
+
+            buf[i] = input[i] + store*feedback;
+            out[i] += output;
+        }
+        input += len;
+        out += len;
+        count -= len;
+        bufidx += len;
+        if (bufidx >= bufsize) bufidx = 0;
+    }
+}
+
 #endif //_comb_
 
 //ends
@@ -8,11 +8,15 @@
 #ifndef _denormals_
 #define _denormals_
 
+#include <float.h>
+#include <math.h>
 
-#ifdef __cplusplus
-extern "C"
-#endif
-float undenormalise( float );
+// Inline and without branch, so that the block loops of the filters
+// vectorize
+static inline float undenormalise( float f )
+{
+    return fabsf( f ) < FLT_MIN ? 0.f : f;
+}
 
 #endif//_denormals_
 
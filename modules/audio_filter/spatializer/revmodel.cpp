@@ -155,6 +155,61 @@ void revmodel::processmix(float *inputL, float *outputL, long /* numsamples */,
         outputL[1] += (outR*wet1 + outL*wet2 + inputR*dry);
 }
 
+/*****************************************************************************
+ *  Transforms a block of the audio stream, as processreplace() per sample
+ * /param float *input      input buffer
+ * /param float *output     output buffer, may be the input buffer
+ * /param long numsamples  number of samples to be processed
+ * /param int skip             number of channels in the audio stream
+ *****************************************************************************/
+void revmodel::processblock(const float *input, float *output, long numsamples, int skip)
+{
+    /* Each filter runs over a chunk before the next one, instead of all the
+     * filters for each sample */
+    static const int CHUNK = 256;
+    float in[CHUNK], inR[CHUNK], outL[CHUNK], outR[CHUNK];
+
+    while (numsamples > 0)
+    {
+        int len = numsamples < CHUNK ? (int)numsamples : CHUNK;
+
+        for (int j = 0; j < len; j++)
+        {
+            const float *frame = &input[j * skip];
+            inR[j] = skip > 1 ? frame[1] : frame[0];
+            in[j] = (frame[0] + inR[j]) * gain;
+            outL[j] = outR[j] = 0;
+        }
+
+        // Accumulate comb filters in parallel
+        for (int i = 0; i < numcombs; i++)
+        {
+            combL[i].processblock(in, outL, len);
+            combR[i].processblock(in, outR, len);
+        }
+
+        // Feed through allpasses in series
+        for (int i = 0; i < numallpasses; i++)
+        {
+            allpassL[i].processblock(outL, len);
+            allpassR[i].processblock(outR, len);
+        }
+
+        // Calculate output REPLACING anything already there
+        for (int j = 0; j < len; j++)
+        {
+            float *frame = &output[j * skip];
+            frame[0] = outL[j]*wet1 + outR[j]*wet2 + inR[j]*dry;
+            if (skip > 1)
+                frame[1] = outR[j]*wet1 + outL[j]*wet2 + inR[j]*dry;
+        }
+
+        input += len * skip;
+        output += len * skip;
+        numsamples -= len;
+    }
+}
+
 void revmodel::update()
 {
 // Recalculate internal values after parameter change
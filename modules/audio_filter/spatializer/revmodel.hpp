@@ -22,6 +22,7 @@ public:
     void    mute();
     void    processreplace(float *inputL, float *outputL, long numsamples, int skip);
     void    processmix(float *inputL, float *outputL, long numsamples, int skip);
+    void    processblock(const float *input, float *output, long numsamples, int skip);
     void    setroomsize(float value);
     float    getroomsize();
     void    setdamp(float value);
@@ -214,17 +214,13 @@ static void SpatFilter( filter_t *p_filter, float *out, float *in,
 {
     filter_sys_t *p_sys = reinterpret_cast<filter_sys_t *>( p_filter->p_sys );
     vlc_mutex_locker locker( &p_sys->lock );
+    unsigned i_amp_channels = __MIN( i_channels, 2u );
 
     for( unsigned i = 0; i < i_samples; i++ )
-    {
-        for( unsigned ch = 0 ; ch < 2; ch++)
-        {
-            in[ch] = in[ch] * SPAT_AMP;
-        }
-        p_sys->p_reverbm->processreplace( in, out , 1, i_channels);
-        in  += i_channels;
-        out += i_channels;
-    }
+        for( unsigned ch = 0 ; ch < i_amp_channels; ch++ )
+            in[i * i_channels + ch] = in[i * i_channels + ch] * SPAT_AMP;
+
+    p_sys->p_reverbm->processblock( in, out, i_samples, i_channels );
 }
 
 static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
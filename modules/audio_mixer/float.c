@@ -31,6 +31,7 @@
 #include <stddef.h>
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
 
@@ -80,6 +81,114 @@ static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_VOLUME_SSE2 1
+
+static __attribute__((__target__("sse2")))
+void FilterFL32_SSE2( audio_volume_t *p_volume, block_t *p_buffer,
+                      float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i_count = p_buffer->i_buffer / sizeof(*p), i = 0;
+    const __m128 mult = _mm_set1_ps( f_multiplier );
+
+    for( ; i + 8 <= i_count; i += 8 )
+    {
+        _mm_storeu_ps( &p[i], _mm_mul_ps( _mm_loadu_ps( &p[i] ), mult ) );
+        _mm_storeu_ps( &p[i + 4],
+                       _mm_mul_ps( _mm_loadu_ps( &p[i + 4] ), mult ) );
+    }
+    for( ; i < i_count; i++ )
+        p[i] *= f_multiplier;
+
+    (void) p_volume;
+}
+
+static __attribute__((__target__("sse2")))
+void FilterFL64_SSE2( audio_volume_t *p_volume, block_t *p_buffer,
+                      float f_multiplier )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    double mult = f_multiplier;
+    if( mult == 1. )
+        return; /* nothing to do */
+
+    size_t i_count = p_buffer->i_buffer / sizeof(*p), i = 0;
+    const __m128d vmult = _mm_set1_pd( mult );
+
+    for( ; i + 4 <= i_count; i += 4 )
+    {
+        _mm_storeu_pd( &p[i], _mm_mul_pd( _mm_loadu_pd( &p[i] ), vmult ) );
+        _mm_storeu_pd( &p[i + 2],
+                       _mm_mul_pd( _mm_loadu_pd( &p[i + 2] ), vmult ) );
+    }
+    for( ; i < i_count; i++ )
+        p[i] *= mult;
+
+    (void) p_volume;
+}
+# endif
+
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_VOLUME_AVX2 1
+
+static __attribute__((__target__("avx2")))
+void FilterFL32_AVX2( audio_volume_t *p_volume, block_t *p_buffer,
+                      float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i_count = p_buffer->i_buffer / sizeof(*p), i = 0;
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        _mm256_storeu_ps( &p[i],
+                          _mm256_mul_ps( _mm256_loadu_ps( &p[i] ), mult ) );
+        _mm256_storeu_ps( &p[i + 8],
+                          _mm256_mul_ps( _mm256_loadu_ps( &p[i + 8] ), mult ) );
+    }
+    for( ; i < i_count; i++ )
+        p[i] *= f_multiplier;
+
+    (void) p_volume;
+}
+
+static __attribute__((__target__("avx2")))
+void FilterFL64_AVX2( audio_volume_t *p_volume, block_t *p_buffer,
+                      float f_multiplier )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    double mult = f_multiplier;
+    if( mult == 1. )
+        return; /* nothing to do */
+
+    size_t i_count = p_buffer->i_buffer / sizeof(*p), i = 0;
+    const __m256d vmult = _mm256_set1_pd( mult );
+
+    for( ; i + 8 <= i_count; i += 8 )
+    {
+        _mm256_storeu_pd( &p[i],
+                          _mm256_mul_pd( _mm256_loadu_pd( &p[i] ), vmult ) );
+        _mm256_storeu_pd( &p[i + 4],
+                          _mm256_mul_pd( _mm256_loadu_pd( &p[i + 4] ), vmult ) );
+    }
+    for( ; i < i_count; i++ )
+        p[i] *= mult;
+
+    (void) p_volume;
+}
+# endif
+#endif
+
 /**
  * Initializes the mixer
  */
@@ -91,9 +200,25 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+#ifdef CAN_COMPILE_VOLUME_SSE2
+            if( vlc_CPU_SSE2() )
+                p_volume->amplify = FilterFL32_SSE2;
+#endif
+#ifdef CAN_COMPILE_VOLUME_AVX2
+            if( vlc_CPU_AVX2() )
+                p_volume->amplify = FilterFL32_AVX2;
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+#ifdef CAN_COMPILE_VOLUME_SSE2
+            if( vlc_CPU_SSE2() )
+                p_volume->amplify = FilterFL64_SSE2;
+#endif
+#ifdef CAN_COMPILE_VOLUME_AVX2
+            if( vlc_CPU_AVX2() )
+                p_volume->amplify = FilterFL64_AVX2;
+#endif
             break;
         default:
             return -1;
@@ -27,6 +27,7 @@
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
 
@@ -103,6 +104,147 @@ static void FilterU8 (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+/*
+ * The vector kernels compute the same output as the C ones, bit for bit:
+ * the products are kept at full width, shifted then saturated.
+ */
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_VOLUME_SSE2 1
+
+static __attribute__((__target__("sse2")))
+void FilterS16N_SSE2 (audio_volume_t *vol, block_t *block, float volume)
+{
+    int_fast16_t mult = lroundf (volume * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+    if (mult > INT16_MAX)
+    {
+        FilterS16N (vol, block, volume);
+        return;
+    }
+
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    const __m128i m = _mm_set1_epi16 (mult);
+
+    for (; n >= 8; n -= 8, p += 8)
+    {
+        const __m128i v = _mm_loadu_si128 ((const __m128i *)p);
+        const __m128i lo = _mm_mullo_epi16 (v, m);
+        const __m128i hi = _mm_mulhi_epi16 (v, m);
+        const __m128i a = _mm_srai_epi32 (_mm_unpacklo_epi16 (lo, hi), 8);
+        const __m128i b = _mm_srai_epi32 (_mm_unpackhi_epi16 (lo, hi), 8);
+        _mm_storeu_si128 ((__m128i *)p, _mm_packs_epi32 (a, b));
+    }
+    for (; n > 0; n--)
+    {
+        int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
+        if (s > INT16_MAX)
+            s = INT16_MAX;
+        else
+        if (s < INT16_MIN)
+            s = INT16_MIN;
+        *(p++) = s;
+    }
+}
+# endif
+
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_VOLUME_AVX2 1
+
+static __attribute__((__target__("avx2")))
+void FilterS16N_AVX2 (audio_volume_t *vol, block_t *block, float volume)
+{
+    int_fast16_t mult = lroundf (volume * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+    if (mult > INT16_MAX)
+    {
+        FilterS16N (vol, block, volume);
+        return;
+    }
+
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    const __m256i m = _mm256_set1_epi16 (mult);
+
+    for (; n >= 16; n -= 16, p += 16)
+    {   /* the unpacking and packing both work within 128-bit lanes */
+        const __m256i v = _mm256_loadu_si256 ((const __m256i *)p);
+        const __m256i lo = _mm256_mullo_epi16 (v, m);
+        const __m256i hi = _mm256_mulhi_epi16 (v, m);
+        const __m256i a = _mm256_srai_epi32 (_mm256_unpacklo_epi16 (lo, hi), 8);
+        const __m256i b = _mm256_srai_epi32 (_mm256_unpackhi_epi16 (lo, hi), 8);
+        _mm256_storeu_si256 ((__m256i *)p, _mm256_packs_epi32 (a, b));
+    }
+    for (; n > 0; n--)
+    {
+        int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
+        if (s > INT16_MAX)
+            s = INT16_MAX;
+        else
+        if (s < INT16_MIN)
+            s = INT16_MIN;
+        *(p++) = s;
+    }
+}
+
+/** Shifts signed 64-bit products right by 24 bits, saturated to 32 bits */
+static inline __attribute__((__target__("avx2")))
+__m256i ScaleS32_AVX2 (__m256i prod)
+{
+    const __m256i sign = _mm256_cmpgt_epi64 (_mm256_setzero_si256 (), prod);
+    const __m256i max = _mm256_set1_epi64x (INT32_MAX);
+    const __m256i min = _mm256_set1_epi64x (INT32_MIN);
+
+    prod = _mm256_xor_si256 (_mm256_srli_epi64 (_mm256_xor_si256 (prod, sign),
+                                                24), sign);
+    prod = _mm256_blendv_epi8 (prod, max, _mm256_cmpgt_epi64 (prod, max));
+    return _mm256_blendv_epi8 (prod, min, _mm256_cmpgt_epi64 (min, prod));
+}
+
+static __attribute__((__target__("avx2")))
+void FilterS32N_AVX2 (audio_volume_t *vol, block_t *block, float volume)
+{
+    int_fast64_t mult = llroundf (volume * 0x1.p24f);
+    if (mult == (1 << 24))
+        return;
+    if (mult > INT32_MAX)
+    {
+        FilterS32N (vol, block, volume);
+        return;
+    }
+
+    int32_t *p = (int32_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    const __m256i m = _mm256_set1_epi32 (mult);
+
+    for (; n >= 8; n -= 8, p += 8)
+    {
+        const __m256i v = _mm256_loadu_si256 ((const __m256i *)p);
+        const __m256i even = ScaleS32_AVX2 (_mm256_mul_epi32 (v, m));
+        const __m256i odd = ScaleS32_AVX2 (
+                _mm256_mul_epi32 (_mm256_srli_epi64 (v, 32), m));
+        _mm256_storeu_si256 ((__m256i *)p,
+                _mm256_blend_epi32 (even, _mm256_slli_epi64 (odd, 32), 0xAA));
+    }
+    for (; n > 0; n--)
+    {
+        int_fast64_t s = (*p * (int_fast64_t)mult) >> INT64_C(24);
+        if (s > INT32_MAX)
+            s = INT32_MAX;
+        else
+        if (s < INT32_MIN)
+            s = INT32_MIN;
+        *(p++) = s;
+    }
+}
+# endif
+#endif
+
 static int Activate (vlc_object_t *obj)
 {
     audio_volume_t *vol = (audio_volume_t *)obj;
@@ -111,9 +253,21 @@ static int Activate (vlc_object_t *obj)
     {
         case VLC_CODEC_S32N:
             vol->amplify = FilterS32N;
+#ifdef CAN_COMPILE_VOLUME_AVX2
+            if (vlc_CPU_AVX2 ())
+                vol->amplify = FilterS32N_AVX2;
+#endif
             break;
         case VLC_CODEC_S16N:
             vol->amplify = FilterS16N;
+#ifdef CAN_COMPILE_VOLUME_SSE2
+            if (vlc_CPU_SSE2 ())
+                vol->amplify = FilterS16N_SSE2;
+#endif
+#ifdef CAN_COMPILE_VOLUME_AVX2
+            if (vlc_CPU_AVX2 ())
+                vol->amplify = FilterS16N_AVX2;
+#endif
             break;
         case VLC_CODEC_U8:
             vol->amplify = FilterU8;
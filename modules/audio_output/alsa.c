@@ -51,8 +51,20 @@ typedef struct
     bool soft_mute;
     float soft_gain;
     char *device;
+
+    /* Low latency mode: the frames queued to the device are limited to a
+     * target, which grows on underruns and shrinks back while there are
+     * none, between the requested latency and the buffer size. */
+    snd_pcm_uframes_t fill_target; /**< 0 outside the low latency mode */
+    snd_pcm_uframes_t fill_min;
+    snd_pcm_uframes_t fill_max;
+    snd_pcm_uframes_t period_size;
+    vlc_tick_t fill_date; /**< Date of the last change of the target */
 } aout_sys_t;
 
+/* Period of the shrinking of the target */
+#define FILL_SHRINK_DELAY VLC_TICK_FROM_SEC(5)
+
 enum {
     PASSTHROUGH_NONE,
     PASSTHROUGH_SPDIF,
@@ -83,6 +95,12 @@ static const char *const channels_text[] = {
     N_("Surround 5.0"), N_("Surround 5.1"), N_("Surround 7.1"),
 };
 
+#define LATENCY_TEXT N_("Low latency (ms)")
+#define LATENCY_LONGTEXT N_("Latency to aim at, in milliseconds, with " \
+    "more but smaller periods. The buffering is increased again whenever " \
+    "the device underruns. Zero keeps the default sizing, suited to " \
+    "playback rather than to monitoring.")
+
 #define PASSTHROUGH_TEXT N_("Audio passthrough mode")
 static const int passthrough_modes[] = {
     PASSTHROUGH_NONE, PASSTHROUGH_SPDIF, PASSTHROUGH_HDMI,
@@ -104,6 +122,8 @@ vlc_module_begin ()
     add_integer("alsa-passthrough", PASSTHROUGH_NONE, PASSTHROUGH_TEXT,
                 NULL)
         change_integer_list(passthrough_modes, passthrough_modes_text)
+    add_integer("alsa-latency", 0, LATENCY_TEXT, LATENCY_LONGTEXT)
+        change_integer_range(0, 1000)
     add_sw_gain ()
     set_capability( "audio output", 150 )
     set_callbacks( Open, Close )
@@ -522,8 +542,26 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
+    /* Low latency: with four periods in the buffer, the wake ups, and the
+     * quantum of sound servers emulating ALSA, follow the latency. The
+     * buffer leaves room for the target to grow. */
+    vlc_tick_t latency = VLC_TICK_FROM_MS(var_InheritInteger(aout,
+                                                             "alsa-latency"));
+    if (passthrough != PASSTHROUGH_NONE)
+        latency = 0;
+    sys->fill_target = 0;
+
+    unsigned period_time = AOUT_MIN_PREPARE_TIME;
+    unsigned buffer_time = AOUT_MAX_ADVANCE_TIME;
+    if (latency > 0)
+    {
+        period_time = __MAX(US_FROM_VLC_TICK(latency) / 4, 1000);
+        buffer_time = 4 * US_FROM_VLC_TICK(__MAX(latency,
+                                                 AOUT_MIN_PREPARE_TIME));
+    }
+
 #if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
-    param = AOUT_MIN_PREPARE_TIME;
+    param = period_time;
     val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -532,7 +570,7 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
 #endif
     /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
+    param = buffer_time;
     val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -585,6 +623,30 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     /* END REVISIT */
 
+    if (latency > 0)
+    {
+        snd_pcm_uframes_t buffer_size, period_size;
+
+        snd_pcm_hw_params_get_buffer_size (hw, &buffer_size);
+        snd_pcm_hw_params_get_period_size (hw, &period_size, NULL);
+        sys->fill_min = __MAX(samples_from_vlc_tick(latency, fmt->i_rate),
+                              period_size);
+        sys->fill_max = __MAX(buffer_size - period_size, sys->fill_min);
+        sys->fill_target = sys->fill_min;
+        sys->period_size = period_size;
+        sys->fill_date = vlc_tick_now ();
+        msg_Dbg (aout, "low latency: %lu frames periods, target %lu "
+                 "frames up to %lu", (unsigned long)period_size,
+                 (unsigned long)sys->fill_min, (unsigned long)sys->fill_max);
+
+        /* Monotonic timestamps of the delays, for the timing reports */
+        snd_pcm_sw_params_set_tstamp_mode (pcm, sw, SND_PCM_TSTAMP_ENABLE);
+#if (SND_LIB_VERSION >= 0x01001D)
+        snd_pcm_sw_params_set_tstamp_type (pcm, sw,
+                                           SND_PCM_TSTAMP_TYPE_MONOTONIC);
+#endif
+    }
+
     /* Commit software parameters. */
     val = snd_pcm_sw_params (pcm, sw);
     if (val)
@@ -626,11 +688,52 @@ error:
     return VLC_EGENERIC;
 }
 
+/**
+ * Gets the date at which the next written sample will be played.
+ *
+ * The delay reported by sound servers moves by whole quanta: the timestamp
+ * of the delay, when there is one, dates it precisely.
+ */
+static int PlayDateGet (audio_output_t *aout, vlc_tick_t *restrict date)
+{
+    aout_sys_t *sys = aout->sys;
+    snd_pcm_status_t *status;
+    snd_htimestamp_t ts;
+
+    snd_pcm_status_alloca (&status);
+    int val = snd_pcm_status (sys->pcm, status);
+    if (val)
+    {
+        msg_Err (aout, "cannot get status: %s", snd_strerror (val));
+        return -1;
+    }
+
+    snd_pcm_sframes_t frames = snd_pcm_status_get_delay (status);
+    snd_pcm_status_get_htstamp (status, &ts);
+    if (snd_pcm_status_get_state (status) != SND_PCM_STATE_RUNNING
+     || (ts.tv_sec == 0 && ts.tv_nsec == 0))
+        *date = vlc_tick_now ();
+    else
+        *date = vlc_tick_from_timespec (&ts);
+    *date += vlc_tick_from_samples (frames, sys->rate);
+    return 0;
+}
+
 static int TimeGet (audio_output_t *aout, vlc_tick_t *restrict delay)
 {
     aout_sys_t *sys = aout->sys;
     snd_pcm_sframes_t frames;
 
+    if (sys->fill_target > 0)
+    {
+        vlc_tick_t date;
+
+        if (PlayDateGet (aout, &date))
+            return -1;
+        *delay = date - vlc_tick_now ();
+        return 0;
+    }
+
     int val = snd_pcm_delay (sys->pcm, &frames);
     if (val)
     {
@@ -641,6 +744,23 @@ static int TimeGet (audio_output_t *aout, vlc_tick_t *restrict delay)
     return 0;
 }
 
+/**
+ * Raises the low latency target after an underrun.
+ */
+static void FillGrow (audio_output_t *aout)
+{
+    aout_sys_t *sys = aout->sys;
+
+    if (sys->fill_target < sys->fill_max)
+    {
+        sys->fill_target = __MIN(sys->fill_target + sys->fill_target / 2,
+                                 sys->fill_max);
+        msg_Dbg (aout, "underrun, target raised to %lu frames",
+                 (unsigned long)sys->fill_target);
+    }
+    sys->fill_date = vlc_tick_now ();
+}
+
 /**
  * Queues one audio buffer to the hardware.
  */
@@ -653,15 +773,36 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
                            sys->chans_to_reorder, sys->chans_table, sys->format);
 
     snd_pcm_t *pcm = sys->pcm;
+    const vlc_tick_t end_pts = block->i_pts + block->i_length;
 
     /* TODO: better overflow handling */
     /* TODO: no period wake ups */
 
     while (block->i_nb_samples > 0)
     {
-        snd_pcm_sframes_t frames;
+        snd_pcm_sframes_t frames = block->i_nb_samples;
+
+        if (sys->fill_target > 0)
+        {   /* Keep no more than the target queued */
+            snd_pcm_sframes_t queued;
+
+            if (snd_pcm_delay (pcm, &queued) == 0 && queued > 0)
+            {   /* write by periods, not by the few frames just played */
+                snd_pcm_sframes_t room = sys->fill_target - queued;
+                snd_pcm_sframes_t want = __MIN(frames,
+                                      (snd_pcm_sframes_t)sys->period_size);
+                if (room < want)
+                {
+                    vlc_tick_sleep (vlc_tick_from_samples (want - room,
+                                                           sys->rate));
+                    continue;
+                }
+                if (frames > room)
+                    frames = room;
+            }
+        }
 
-        frames = snd_pcm_writei (pcm, block->p_buffer, block->i_nb_samples);
+        frames = snd_pcm_writei (pcm, block->p_buffer, frames);
         if (frames >= 0)
         {
             size_t bytes = snd_pcm_frames_to_bytes (pcm, frames);
@@ -672,6 +813,9 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
         }
         else  
         {
+            if (frames == -EPIPE && sys->fill_target > 0)
+                FillGrow (aout);
+
             int val = snd_pcm_recover (pcm, frames, 1);
             if (val)
             {
@@ -684,6 +828,21 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
         }
     }
     block_Release (block);
+
+    if (sys->fill_target > 0)
+    {
+        vlc_tick_t now = vlc_tick_now ();
+        if (now - sys->fill_date >= FILL_SHRINK_DELAY
+         && sys->fill_target > sys->fill_min)
+        {
+            sys->fill_target -= (sys->fill_target - sys->fill_min + 7) / 8;
+            sys->fill_date = now;
+        }
+
+        vlc_tick_t play_date;
+        if (PlayDateGet (aout, &play_date) == 0)
+            aout_TimingReport (aout, play_date, end_pts);
+    }
     (void) date;
 }
 
@@ -495,18 +495,26 @@ static block_t * ConvertAVFrame( decoder_t *p_dec, AVFrame *frame )
     AVCodecContext *ctx = p_sys->p_context;
     block_t *p_block;
 
-    /* Interleave audio if required */
-    if( av_sample_fmt_is_planar( ctx->sample_fmt ) )
+    /* Interleave audio if required, a single plane is already interleaved */
+    const bool b_interleave = av_sample_fmt_is_planar( ctx->sample_fmt ) &&
+                              ctx->channels > 1;
+    if( b_interleave )
     {
-        p_block = block_Alloc(frame->linesize[0] * ctx->channels);
+        /* Extract the channels while interleaving, to copy only once */
+        const int i_channels = p_sys->b_extract ?
+            (int)p_dec->fmt_out.audio.i_channels : ctx->channels;
+
+        p_block = block_Alloc(av_get_bytes_per_sample(ctx->sample_fmt)
+                              * frame->nb_samples * i_channels);
         if ( likely(p_block) )
         {
-            const void *planes[ctx->channels];
-            for (int i = 0; i < ctx->channels; i++)
-                planes[i] = frame->extended_data[i];
+            const void *planes[i_channels];
+            for (int i = 0; i < i_channels; i++)
+                planes[i] = frame->extended_data[p_sys->b_extract ?
+                                                 p_sys->pi_extraction[i] : i];
 
             aout_Interleave(p_block->p_buffer, planes, frame->nb_samples,
-                            ctx->channels, p_dec->fmt_out.audio.i_format);
+                            i_channels, p_dec->fmt_out.audio.i_format);
             p_block->i_nb_samples = frame->nb_samples;
         }
         av_frame_free(&frame);
@@ -517,7 +525,7 @@ static block_t * ConvertAVFrame( decoder_t *p_dec, AVFrame *frame )
         frame = NULL;
     }
 
-    if (p_sys->b_extract && p_block)
+    if (p_sys->b_extract && !b_interleave && p_block)
     {   /* TODO: do not drop channels... at least not here */
         block_t *p_buffer = block_Alloc( p_dec->fmt_out.audio.i_bytes_per_frame
                                          * p_block->i_nb_samples );
@@ -45,6 +45,10 @@ void EndAudioDec( vlc_object_t * );
 int InitSubtitleDec( vlc_object_t * );
 void EndSubtitleDec( vlc_object_t * );
 
+/* VA-API video encoder (vaapi plugin) */
+int  OpenVaapiEncoder( vlc_object_t * );
+void CloseVaapiEncoder( vlc_object_t * );
+
 /* Initialize decoder */
 AVCodecContext *ffmpeg_AllocContext( decoder_t *, const AVCodec ** );
 int ffmpeg_OpenCodec( decoder_t *p_dec, AVCodecContext *, const AVCodec * );
@@ -76,6 +76,7 @@ DEFINE_GUID(DXVA2_NoEncrypt,                        0x1b81bed0, 0xa0c7, 0x11d3,
 
 typedef struct
 {
+    d3d11_decoder_device_t       *devsys;
     d3d11_device_t               *d3d_dev;
 
     vlc_video_context            *vctx;
@@ -245,6 +246,7 @@ static int Open(vlc_va_t *va, AVCodecContext *ctx, enum AVPixelFormat hwfmt, con
     va->sys = sys;
 
     sys->render_fmt = NULL;
+    sys->devsys = devsys;
     sys->d3d_dev = &devsys->d3d_dev;
     if (sys->d3d_dev->context_mutex == INVALID_HANDLE_VALUE)
         msg_Warn(va, "No mutex found to lock the decoder");
@@ -543,11 +545,17 @@ static int DxCreateDecoderSurfaces(vlc_va_t *va, int codec_id,
     if (D3D11_DeviceSupportsFormat(sys->d3d_dev, texDesc.Format, D3D11_FORMAT_SUPPORT_SHADER_LOAD))
         texDesc.BindFlags |= D3D11_BIND_SHADER_RESOURCE;
 
-    ID3D11Texture2D *p_texture;
-    hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &p_texture );
-    if (FAILED(hr)) {
-        msg_Err(va, "CreateTexture2D %zu failed. (hr=0x%lX)", surface_count, hr);
-        return VLC_EGENERIC;
+    /* reuse the texture of the previous decoder on this device if possible */
+    ID3D11Texture2D *p_texture = D3D11_GetCachedTexture(sys->devsys, &texDesc);
+    if (p_texture != NULL)
+        msg_Dbg(va, "reusing the cached decoder texture");
+    else
+    {
+        hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &p_texture );
+        if (FAILED(hr)) {
+            msg_Err(va, "CreateTexture2D %zu failed. (hr=0x%lX)", surface_count, hr);
+            return VLC_EGENERIC;
+        }
     }
 
     unsigned surface_idx;
@@ -651,6 +659,11 @@ static void DxDestroySurfaces(void *opaque)
     if (sys->hw.decoder)
         ID3D11VideoDecoder_Release(sys->hw.decoder);
     if (sys->hw_surface[0]) {
+        ID3D11Resource *p_texture;
+        ID3D11VideoDecoderOutputView_GetResource( sys->hw_surface[0], &p_texture );
+        D3D11_CacheTexture( sys->devsys, (ID3D11Texture2D*) p_texture );
+        ID3D11Resource_Release( p_texture );
+
         for (unsigned i = 0; i < sys->hw.surface_count; i++)
         {
             for (int j = 0; j < DXGI_MAX_SHADER_VIEW; j++)
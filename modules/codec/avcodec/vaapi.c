@@ -283,4 +283,11 @@ vlc_module_begin ()
     add_shortcut( "vaapi" )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_VCODEC )
+#ifdef ENABLE_SOUT
+    add_submodule()
+    set_description( N_("VA-API video encoder") )
+    set_capability( "encoder", 250 )
+    set_callbacks( OpenVaapiEncoder, CloseVaapiEncoder )
+    add_shortcut( "vaapi" )
+#endif
 vlc_module_end ()
@@ -0,0 +1,302 @@
+/*****************************************************************************
+ * vaapi_encoder.c: VAAPI encoder for the pictures already on the GPU
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+#include <vlc_picture.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_vaapi.h>
+
+#include "avcodec.h"
+#include "../../hw/vaapi/vlc_vaapi.h"
+
+/* The VAAPI surfaces are handed to the libavcodec VAAPI encoders as
+ * AV_PIX_FMT_VAAPI frames, the pictures are held until libavcodec is done
+ * with them. */
+
+typedef struct
+{
+    vlc_decoder_device *dec_device;
+    AVBufferRef        *hwdev_ref;
+    AVBufferRef        *hwframes_ref;
+    AVCodecContext     *ctx;
+    AVPacket           *packet;
+    bool                draining;
+} vaapi_encoder_sys_t;
+
+static const char *GetEncoderName(vlc_fourcc_t codec)
+{
+    switch (codec)
+    {
+        case VLC_CODEC_H264: return "h264_vaapi";
+        case VLC_CODEC_HEVC: return "hevc_vaapi";
+        case VLC_CODEC_AV1:  return "av1_vaapi";
+        default:             return NULL;
+    }
+}
+
+static void ReleasePicture(void *opaque, uint8_t *data)
+{
+    VLC_UNUSED(data);
+    picture_Release(opaque);
+}
+
+static block_t *ReceivePackets(encoder_t *p_enc)
+{
+    vaapi_encoder_sys_t *p_sys = p_enc->p_sys;
+    block_t *p_chain = NULL;
+
+    for (;;)
+    {
+        int ret = avcodec_receive_packet(p_sys->ctx, p_sys->packet);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            break;
+        if (ret < 0)
+        {
+            msg_Err(p_enc, "cannot encode the picture (%d)", ret);
+            break;
+        }
+
+        block_t *p_block = block_Alloc(p_sys->packet->size);
+        if (likely(p_block != NULL))
+        {
+            memcpy(p_block->p_buffer, p_sys->packet->data, p_sys->packet->size);
+            /* the time base is the VLC clock */
+            p_block->i_pts = p_sys->packet->pts;
+            p_block->i_dts = p_sys->packet->dts;
+            p_block->i_length = p_sys->packet->duration;
+            if (p_sys->packet->flags & AV_PKT_FLAG_KEY)
+                p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+            block_ChainAppend(&p_chain, p_block);
+        }
+        av_packet_unref(p_sys->packet);
+    }
+    return p_chain;
+}
+
+static block_t *Encode(encoder_t *p_enc, picture_t *p_pic)
+{
+    vaapi_encoder_sys_t *p_sys = p_enc->p_sys;
+
+    if (p_pic == NULL)
+    {
+        /* flush, once */
+        if (!p_sys->draining)
+        {
+            p_sys->draining = true;
+            avcodec_send_frame(p_sys->ctx, NULL);
+        }
+        return ReceivePackets(p_enc);
+    }
+
+    if (!vlc_vaapi_IsChromaOpaque(p_pic->format.i_chroma) || p_pic->context == NULL)
+    {
+        msg_Err(p_enc, "picture not on the GPU");
+        return NULL;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    if (unlikely(frame == NULL))
+        return NULL;
+
+    frame->buf[0] = av_buffer_create(NULL, 0, ReleasePicture, picture_Hold(p_pic), 0);
+    if (unlikely(frame->buf[0] == NULL))
+    {
+        picture_Release(p_pic);
+        av_frame_free(&frame);
+        return NULL;
+    }
+    frame->format = AV_PIX_FMT_VAAPI;
+    frame->width = p_sys->ctx->width;
+    frame->height = p_sys->ctx->height;
+    frame->data[3] = (uint8_t *)(uintptr_t)vlc_vaapi_PicGetSurface(p_pic);
+    frame->hw_frames_ctx = av_buffer_ref(p_sys->hwframes_ref);
+    frame->pts = p_pic->date;
+    if (p_pic->b_force)
+        frame->pict_type = AV_PICTURE_TYPE_I;
+
+    int ret = frame->hw_frames_ctx != NULL ? avcodec_send_frame(p_sys->ctx, frame)
+                                           : AVERROR(ENOMEM);
+    av_frame_free(&frame);
+    if (ret < 0 && ret != AVERROR(EAGAIN))
+    {
+        msg_Err(p_enc, "cannot send the picture to the encoder (%d)", ret);
+        return NULL;
+    }
+    return ReceivePackets(p_enc);
+}
+
+static void Clean(vaapi_encoder_sys_t *p_sys)
+{
+    av_packet_free(&p_sys->packet);
+    avcodec_free_context(&p_sys->ctx);
+    av_buffer_unref(&p_sys->hwframes_ref);
+    av_buffer_unref(&p_sys->hwdev_ref);
+    if (p_sys->dec_device != NULL)
+        vlc_decoder_device_Release(p_sys->dec_device);
+    free(p_sys);
+}
+
+int OpenVaapiEncoder(vlc_object_t *obj)
+{
+    encoder_t *p_enc = (encoder_t *)obj;
+    const video_format_t *fmt = &p_enc->fmt_in.video;
+
+    const char *name = GetEncoderName(p_enc->fmt_out.i_codec);
+    if (name == NULL)
+        return VLC_EGENERIC;
+
+    enum AVPixelFormat sw_format;
+    switch (p_enc->fmt_in.i_codec)
+    {
+        case VLC_CODEC_VAAPI_420:
+            sw_format = AV_PIX_FMT_NV12;
+            break;
+        case VLC_CODEC_VAAPI_420_10BPP:
+            if (p_enc->fmt_out.i_codec == VLC_CODEC_H264)
+                return VLC_EGENERIC;
+            sw_format = AV_PIX_FMT_P010;
+            break;
+        default:
+            /* only the pictures already on the GPU, without readback */
+            return VLC_EGENERIC;
+    }
+    if (fmt->i_visible_width == 0 || fmt->i_visible_height == 0)
+        return VLC_EGENERIC;
+
+    const AVCodec *codec = avcodec_find_encoder_by_name(name);
+    if (codec == NULL)
+        return VLC_EGENERIC;
+
+    /* the input video context is only known when the encoder is really
+     * opened, otherwise use the device the pictures will come from */
+    vlc_decoder_device *dec_device = NULL;
+    if (p_enc->vctx_in != NULL)
+        dec_device = vlc_video_context_HoldDevice(p_enc->vctx_in);
+    else if (p_enc->cbs != NULL)
+        dec_device = vlc_encoder_GetDecoderDevice(p_enc);
+    if (dec_device == NULL || dec_device->type != VLC_DECODER_DEVICE_VAAPI)
+    {
+        if (dec_device != NULL)
+            vlc_decoder_device_Release(dec_device);
+        return VLC_EGENERIC;
+    }
+
+    vaapi_encoder_sys_t *p_sys = calloc(1, sizeof(*p_sys));
+    if (unlikely(p_sys == NULL))
+    {
+        vlc_decoder_device_Release(dec_device);
+        return VLC_ENOMEM;
+    }
+    p_sys->dec_device = dec_device;
+
+    p_sys->hwdev_ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_VAAPI);
+    if (p_sys->hwdev_ref == NULL)
+        goto error;
+    AVHWDeviceContext *hwdev_ctx = (void *)p_sys->hwdev_ref->data;
+    AVVAAPIDeviceContext *vadev_ctx = hwdev_ctx->hwctx;
+    vadev_ctx->display = dec_device->opaque;
+    if (av_hwdevice_ctx_init(p_sys->hwdev_ref) < 0)
+        goto error;
+
+    /* the surfaces come from VLC, the pool is never used */
+    p_sys->hwframes_ref = av_hwframe_ctx_alloc(p_sys->hwdev_ref);
+    if (p_sys->hwframes_ref == NULL)
+        goto error;
+    AVHWFramesContext *hwframes_ctx = (void *)p_sys->hwframes_ref->data;
+    hwframes_ctx->format = AV_PIX_FMT_VAAPI;
+    hwframes_ctx->sw_format = sw_format;
+    hwframes_ctx->width = fmt->i_width;
+    hwframes_ctx->height = fmt->i_height;
+    hwframes_ctx->initial_pool_size = 0;
+    if (av_hwframe_ctx_init(p_sys->hwframes_ref) < 0)
+        goto error;
+
+    p_sys->ctx = avcodec_alloc_context3(codec);
+    p_sys->packet = av_packet_alloc();
+    if (p_sys->ctx == NULL || p_sys->packet == NULL)
+        goto error;
+
+    AVCodecContext *ctx = p_sys->ctx;
+    ctx->pix_fmt = AV_PIX_FMT_VAAPI;
+    ctx->width = fmt->i_visible_width;
+    ctx->height = fmt->i_visible_height;
+    ctx->sample_aspect_ratio = (AVRational) {
+        fmt->i_sar_num ? fmt->i_sar_num : 1, fmt->i_sar_den ? fmt->i_sar_den : 1
+    };
+    ctx->time_base = (AVRational) { 1, CLOCK_FREQ };
+    if (fmt->i_frame_rate && fmt->i_frame_rate_base)
+        ctx->framerate = (AVRational) { fmt->i_frame_rate, fmt->i_frame_rate_base };
+    ctx->hw_frames_ctx = av_buffer_ref(p_sys->hwframes_ref);
+    ctx->hw_device_ctx = av_buffer_ref(p_sys->hwdev_ref);
+    if (ctx->hw_frames_ctx == NULL || ctx->hw_device_ctx == NULL)
+        goto error;
+    if (p_enc->fmt_out.i_bitrate > 0)
+        ctx->bit_rate = p_enc->fmt_out.i_bitrate;
+    if (p_enc->i_iframes > 0)
+        ctx->gop_size = p_enc->i_iframes;
+    if (p_enc->i_bframes >= 0)
+        ctx->max_b_frames = p_enc->i_bframes;
+    ctx->color_range = fmt->color_range == COLOR_RANGE_FULL ? AVCOL_RANGE_JPEG
+                                                             : AVCOL_RANGE_MPEG;
+
+    int ret = avcodec_open2(ctx, codec, NULL);
+    if (ret < 0)
+    {
+        msg_Err(p_enc, "cannot open the %s encoder (%d)", name, ret);
+        goto error;
+    }
+
+    if (ctx->extradata_size > 0)
+    {
+        p_enc->fmt_out.p_extra = malloc(ctx->extradata_size);
+        if (p_enc->fmt_out.p_extra != NULL)
+        {
+            memcpy(p_enc->fmt_out.p_extra, ctx->extradata, ctx->extradata_size);
+            p_enc->fmt_out.i_extra = ctx->extradata_size;
+        }
+    }
+
+    p_enc->fmt_in.video.i_chroma = p_enc->fmt_in.i_codec;
+    p_enc->p_sys = p_sys;
+    p_enc->pf_encode_video = Encode;
+
+    msg_Dbg(p_enc, "encoding %ux%u with %s on %s",
+            fmt->i_visible_width, fmt->i_visible_height, name,
+            vaQueryVendorString(dec_device->opaque));
+    return VLC_SUCCESS;
+
+error:
+    Clean(p_sys);
+    return VLC_EGENERIC;
+}
+
+void CloseVaapiEncoder(vlc_object_t *obj)
+{
+    encoder_t *p_enc = (encoder_t *)obj;
+
+    Clean(p_enc->p_sys);
+}
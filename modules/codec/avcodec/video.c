@@ -85,6 +85,8 @@ typedef struct
         FRAMEDROP_NONREF,
         FRAMEDROP_AGGRESSIVE_RECOVER,
     } framedrop;
+    /* how many blocks in a row found the display caught up */
+    unsigned i_display_recovered;
     /* how many decoded frames are late */
     int     i_late_frames;
     int64_t i_last_output_frame;
@@ -112,6 +114,9 @@ typedef struct
     unsigned decoder_width;
     unsigned decoder_height;
 
+    /* share of the decoder threads budget, if not configured */
+    vlc_decoder_threads *threads;
+
     /* Protect dec->fmt_out, decoder_Update*() and decoder_NewPicture()
      * functions */
     vlc_mutex_t lock;
@@ -517,16 +522,24 @@ int InitVideoDec( vlc_object_t *obj )
     int i_thread_count = var_InheritInteger( p_dec, "avcodec-threads" );
     if( i_thread_count <= 0 )
     {
-        i_thread_count = vlc_GetCPUCount();
-        if( i_thread_count > 1 )
-            i_thread_count++;
-
         //FIXME: take in count the decoding time
 #ifdef VLC_WINSTORE_APP
-        i_thread_count = __MIN( i_thread_count, 6 );
+        const unsigned i_max_threads = 6;
 #else
-        i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 10 : 6 );
+        const unsigned i_max_threads = p_codec->id == AV_CODEC_ID_HEVC ? 10 : 6;
 #endif
+        /* The thread count can't change once the codec is opened, so the
+         * budget is only applied here */
+        p_sys->threads = vlc_decoder_threads_Acquire( p_dec, i_max_threads );
+        if( p_sys->threads != NULL )
+            i_thread_count = vlc_decoder_threads_Count( p_sys->threads );
+        else
+        {
+            i_thread_count = vlc_GetCPUCount();
+            if( i_thread_count > 1 )
+                i_thread_count++;
+            i_thread_count = __MIN( i_thread_count, (int)i_max_threads );
+        }
     }
     i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16 );
     msg_Dbg( p_dec, "allowing %d thread(s) for decoding", i_thread_count );
@@ -566,6 +579,7 @@ int InitVideoDec( vlc_object_t *obj )
     p_sys->b_from_preroll = false;
     p_sys->i_last_output_frame = -1;
     p_sys->framedrop = FRAMEDROP_NONE;
+    p_sys->i_display_recovered = 0;
 
     /* Set output properties */
     if( GetVlcChroma( &p_dec->fmt_out.video, p_context->pix_fmt ) != VLC_SUCCESS )
@@ -591,6 +605,8 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** Open the codec ***** */
     if( OpenVideoCodec( p_dec ) < 0 )
     {
+        if( p_sys->threads != NULL )
+            vlc_decoder_threads_Release( p_sys->threads );
         free( p_sys );
         avcodec_free_context( &p_context );
         return VLC_EGENERIC;
@@ -644,7 +660,8 @@ static block_t * filter_earlydropped_blocks( decoder_t *p_dec, block_t *block )
         p_sys->i_last_late_delay = VLC_TICK_MAX;
     }
 
-    if( p_sys->i_late_frames == 0 )
+    if( p_sys->i_late_frames == 0 &&
+        p_sys->framedrop == FRAMEDROP_AGGRESSIVE_RECOVER )
         p_sys->framedrop = FRAMEDROP_NONE;
 
     if( p_sys->framedrop == FRAMEDROP_NONE && p_sys->i_late_frames < 11 )
@@ -677,6 +694,52 @@ static block_t * filter_earlydropped_blocks( decoder_t *p_dec, block_t *block )
     return block;
 }
 
+/* The non reference pictures are skipped while the pictures would reach an
+ * empty display queue too late to be rendered, and decoded again once the
+ * display has kept a few pictures ahead for a while. */
+#define DISPLAY_RECOVER_QUEUED 2
+#define DISPLAY_RECOVER_BLOCKS 16
+
+static void update_display_framedrop( decoder_t *p_dec, const block_t *block )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+    struct vlc_display_load load;
+
+    if( block == NULL || (block->i_flags & BLOCK_FLAG_PREROLL) ||
+        block->i_pts == VLC_TICK_INVALID ||
+        p_sys->framedrop == FRAMEDROP_AGGRESSIVE_RECOVER ||
+        decoder_GetDisplayLoad( p_dec, &load ) != VLC_SUCCESS )
+        return;
+
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t date = decoder_GetDisplayDate( p_dec, now, block->i_pts );
+    if( date == VLC_TICK_INVALID )
+        return;
+
+    /* Time left to decode the block once the display got its picture */
+    vlc_tick_t headroom = date - now - load.render;
+
+    if( p_sys->framedrop == FRAMEDROP_NONE )
+    {
+        if( load.queued == 0 && headroom < 0 )
+        {
+            msg_Dbg( p_dec, "display starving, skipping non reference frames" );
+            p_sys->framedrop = FRAMEDROP_NONREF;
+            p_sys->i_display_recovered = 0;
+        }
+    }
+    else if( load.queued >= DISPLAY_RECOVER_QUEUED && headroom > 0 )
+    {
+        if( ++p_sys->i_display_recovered >= DISPLAY_RECOVER_BLOCKS )
+        {
+            msg_Dbg( p_dec, "display recovered, decoding all frames" );
+            p_sys->framedrop = FRAMEDROP_NONE;
+        }
+    }
+    else
+        p_sys->i_display_recovered = 0;
+}
+
 static vlc_tick_t interpolate_next_pts( decoder_t *p_dec, AVFrame *frame )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -938,7 +1001,10 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
         /* Check also if we should/can drop the block and move to next block
             as trying to catchup the speed*/
         if( p_dec->b_frame_drop_allowed )
+        {
+            update_display_framedrop( p_dec, p_block );
             p_block = filter_earlydropped_blocks( p_dec, p_block );
+        }
     }
 
     if( !b_need_output_picture || p_sys->framedrop == FRAMEDROP_NONREF )
@@ -1307,6 +1373,9 @@ void EndVideoDec( vlc_object_t *obj )
         p_sys->vctx_out = NULL;
     }
 
+    if( p_sys->threads != NULL )
+        vlc_decoder_threads_Release( p_sys->threads );
+
     free( p_sys );
 }
 
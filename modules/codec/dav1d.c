@@ -79,6 +79,13 @@ typedef struct
     Dav1dSettings s;
     Dav1dContext *c;
     cc_data_t cc;
+
+    /* threads from the budget, when not configured */
+    vlc_decoder_threads *threads;
+    unsigned i_threads;
+    int i_cfg_frame_threads;
+    int i_cfg_tile_threads;
+    int i_max_frame_threads;
 } decoder_sys_t;
 
 struct user_data_s
@@ -250,6 +257,66 @@ static void FreePicture(Dav1dPicture *data, void *cookie)
     picture_Release(pic);
 }
 
+/****************************************************************************
+ * SetThreads: splits the threads between frames and tiles
+ ****************************************************************************/
+static void SetThreads(decoder_sys_t *p_sys, unsigned i_threads)
+{
+    int i_tiles = p_sys->i_cfg_tile_threads;
+    int i_frames = p_sys->i_cfg_frame_threads;
+
+    if (i_tiles == 0)
+    {
+        if (i_frames == 0)
+            i_tiles = VLC_CLIP(i_threads / 4, 1, 4);
+        else
+            i_tiles = VLC_CLIP(i_threads / i_frames, 1, DAV1D_MAX_TILE_THREADS);
+    }
+    if (i_frames == 0)
+        i_frames = VLC_CLIP(i_threads / i_tiles, 1, p_sys->i_max_frame_threads);
+
+    p_sys->s.n_tile_threads = i_tiles;
+    p_sys->s.n_frame_threads = i_frames;
+    p_sys->i_threads = i_threads;
+}
+
+/****************************************************************************
+ * UpdateThreads: applies the rebalanced threads budget
+ ****************************************************************************/
+static void UpdateThreads(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    if (p_sys->threads == NULL)
+        return;
+
+    unsigned i_threads = vlc_decoder_threads_Count(p_sys->threads);
+    if (i_threads == p_sys->i_threads)
+        return;
+
+    Dav1dSettings old = p_sys->s;
+    SetThreads(p_sys, i_threads);
+    if (p_sys->s.n_frame_threads == old.n_frame_threads &&
+        p_sys->s.n_tile_threads == old.n_tile_threads)
+        return;
+
+    /* The decoder is flushed, so it can be restarted without losing
+     * any reference frame */
+    dav1d_close(&p_sys->c);
+    if (dav1d_open(&p_sys->c, &p_sys->s) < 0)
+    {
+        msg_Warn(dec, "Could not restart the Dav1d decoder");
+        p_sys->s = old;
+        if (dav1d_open(&p_sys->c, &p_sys->s) < 0)
+        {
+            msg_Err(dec, "Could not reopen the Dav1d decoder");
+            p_sys->c = NULL;
+        }
+        return;
+    }
+    msg_Dbg(dec, "Using %d/%d frame/tile threads",
+            p_sys->s.n_frame_threads, p_sys->s.n_tile_threads);
+}
+
 /****************************************************************************
  * Flush: clears decoder between seeks
  ****************************************************************************/
@@ -257,8 +324,10 @@ static void FreePicture(Dav1dPicture *data, void *cookie)
 static void FlushDecoder(decoder_t *dec)
 {
     decoder_sys_t *p_sys = dec->p_sys;
-    dav1d_flush(p_sys->c);
+    if (p_sys->c)
+        dav1d_flush(p_sys->c);
     cc_Flush(&p_sys->cc);
+    UpdateThreads(dec);
 }
 
 static void release_block(const uint8_t *buf, void *b)
@@ -275,6 +344,13 @@ static int Decode(decoder_t *dec, block_t *block)
 {
     decoder_sys_t *p_sys = dec->p_sys;
 
+    if (unlikely(p_sys->c == NULL))
+    {
+        if (block)
+            block_Release(block);
+        return VLCDEC_ECRITICAL;
+    }
+
     if (block && block->i_flags & (BLOCK_FLAG_CORRUPTED))
     {
         block_Release(block);
@@ -391,12 +467,23 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_ENOMEM;
 
     dav1d_default_settings(&p_sys->s);
-    p_sys->s.n_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
-    if (p_sys->s.n_tile_threads == 0)
-        p_sys->s.n_tile_threads = VLC_CLIP(vlc_GetCPUCount(), 1, 4);
-    p_sys->s.n_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
-    if (p_sys->s.n_frame_threads == 0)
-        p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+    p_sys->i_cfg_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
+    p_sys->i_cfg_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
+    p_sys->i_max_frame_threads = DAV1D_MAX_FRAME_THREADS;
+    p_sys->threads = NULL;
+    if (p_sys->i_cfg_tile_threads == 0 || p_sys->i_cfg_frame_threads == 0)
+    {
+        /* Share the CPUs with the other decoders */
+        p_sys->threads = vlc_decoder_threads_Acquire(dec, 0);
+        if (p_sys->threads != NULL)
+            SetThreads(p_sys, vlc_decoder_threads_Count(p_sys->threads));
+        else
+            SetThreads(p_sys, vlc_GetCPUCount());
+    }
+    else
+        SetThreads(p_sys, 0);
+    /* The picture pool can't grow once the decoder is started */
+    p_sys->i_max_frame_threads = p_sys->s.n_frame_threads;
     p_sys->s.allocator.cookie = dec;
     p_sys->s.allocator.alloc_picture_callback = NewPicture;
     p_sys->s.allocator.release_picture_callback = FreePicture;
@@ -438,6 +525,8 @@ static int OpenDecoder(vlc_object_t *p_this)
     if (dav1d_open(&p_sys->c, &p_sys->s) < 0)
     {
         msg_Err(p_this, "Could not open the Dav1d decoder");
+        if (p_sys->threads != NULL)
+            vlc_decoder_threads_Release(p_sys->threads);
         return VLC_EGENERIC;
     }
 
@@ -488,8 +577,15 @@ static void CloseDecoder(vlc_object_t *p_this)
     decoder_t *dec = (decoder_t *)p_this;
     decoder_sys_t *p_sys = dec->p_sys;
 
+    if (p_sys->threads != NULL)
+    {
+        vlc_decoder_threads_Release(p_sys->threads);
+        p_sys->threads = NULL;
+    }
+
     /* Flush decoder */
     FlushDecoder(dec);
 
-    dav1d_close(&p_sys->c);
+    if (p_sys->c)
+        dav1d_close(&p_sys->c);
 }
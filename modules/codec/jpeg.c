@@ -498,6 +498,35 @@ jpeg_GetOrientation( j_decompress_ptr cinfo )
 /*
  * This function must be fed with a complete compressed frame.
  */
+/*
+ * Gets the largest DCT scaling that still covers the picture size requested
+ * by the image handler, so that the converter has less to scale down.
+ */
+static unsigned jpeg_GetScaleDenom(decoder_t *p_dec, j_decompress_ptr cinfo,
+                                   int i_otag)
+{
+    if (var_Type(p_dec, "image-target-width") == 0)
+        return 1;
+
+    unsigned w = var_GetInteger(p_dec, "image-target-width");
+    unsigned h = var_GetInteger(p_dec, "image-target-height");
+    if (i_otag >= 5) /* transposed orientations */
+    {
+        unsigned tmp = w;
+        w = h;
+        h = tmp;
+    }
+    if (w == 0 && h == 0)
+        return 1;
+
+    unsigned denom = 1;
+    while (denom < 8
+        && (w == 0 || cinfo->image_width / (denom * 2) >= w)
+        && (h == 0 || cinfo->image_height / (denom * 2) >= h))
+        denom *= 2;
+    return denom;
+}
+
 static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -527,6 +556,12 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
 
     p_sys->p_jpeg.out_color_space = JCS_RGB;
 
+    int i_otag; /* Orientation tag has valid range of 1-8. 1 is normal orientation, 0 = unspecified = normal */
+    i_otag = jpeg_GetOrientation( &p_sys->p_jpeg );
+
+    p_sys->p_jpeg.scale_num = 1;
+    p_sys->p_jpeg.scale_denom = jpeg_GetScaleDenom(p_dec, &p_sys->p_jpeg, i_otag);
+
     jpeg_start_decompress(&p_sys->p_jpeg);
 
     /* Set output properties */
@@ -535,8 +570,6 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
     p_dec->fmt_out.video.i_sar_num = 1;
     p_dec->fmt_out.video.i_sar_den = 1;
 
-    int i_otag; /* Orientation tag has valid range of 1-8. 1 is normal orientation, 0 = unspecified = normal */
-    i_otag = jpeg_GetOrientation( &p_sys->p_jpeg );
     if ( i_otag > 1 )
     {
         msg_Dbg( p_dec, "Jpeg orientation is %d", i_otag );
@@ -56,6 +56,9 @@ static int  Create ( vlc_object_t * );
 static void Destroy( vlc_object_t * );
 
 #define TEXT_SSA_FONTSDIR   N_("Additional fonts directory")
+#define TEXT_SSA_PRERENDER  N_("Render subtitles ahead of display")
+#define LONGTEXT_SSA_PRERENDER N_("Render and draw the next subtitle frame " \
+    "in a background thread, ahead of its display time.")
 
 vlc_module_begin ()
     set_shortname( N_("Subtitles (advanced)"))
@@ -65,6 +68,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_SCODEC )
     set_callbacks( Create, Destroy )
     add_string("ssa-fontsdir", NULL, TEXT_SSA_FONTSDIR, NULL)
+    add_bool("ssa-prerender", false, TEXT_SSA_PRERENDER, LONGTEXT_SSA_PRERENDER)
 vlc_module_end ()
 
 /*****************************************************************************
@@ -90,6 +94,19 @@ typedef struct
 
     /* */
     ASS_Track      *p_track;
+
+    /* Rendering of the next frame ahead of display time */
+    bool           b_prerender;
+    bool           b_prerender_stop;
+    vlc_thread_t   prerender_thread;
+    vlc_cond_t     prerender_wait;
+    vlc_tick_t     i_prerender_request; /* stream date to render */
+    vlc_tick_t     i_prerender_date; /* stream date of p_prerender */
+    int            i_prerender_changed;
+    bool           b_prerender_img;
+    subpicture_region_t *p_prerender;
+    bool           b_render_dirty; /* last rendering was not displayed */
+    vlc_tick_t     i_last_render; /* stream date of the last displayed one */
 } decoder_sys_t;
 static void DecSysRelease( decoder_sys_t *p_sys );
 static void DecSysHold( decoder_sys_t *p_sys );
@@ -111,6 +128,7 @@ typedef struct
     vlc_tick_t    i_pts;
 
     ASS_Image     *p_img;
+    subpicture_region_t *p_regions; /* pre-rendered regions, if any */
 } libass_spu_updater_sys_t;
 
 typedef struct
@@ -123,6 +141,8 @@ typedef struct
 
 static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_img_list, int i_width, int i_height );
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img );
+static subpicture_region_t *RegionsNew( const video_format_t *p_fmt, ASS_Image *p_img );
+static void *PrerenderThread( void * );
 
 //#define DEBUG_REGION
 
@@ -153,6 +173,14 @@ static int Create( vlc_object_t *p_this )
     p_sys->p_library  = NULL;
     p_sys->p_renderer = NULL;
     p_sys->p_track    = NULL;
+    p_sys->b_prerender = false;
+    p_sys->b_prerender_stop = false;
+    vlc_cond_init( &p_sys->prerender_wait );
+    p_sys->i_prerender_request = VLC_TICK_INVALID;
+    p_sys->i_prerender_date = VLC_TICK_INVALID;
+    p_sys->p_prerender = NULL;
+    p_sys->b_render_dirty = false;
+    p_sys->i_last_render = VLC_TICK_INVALID;
 
     /* Create libass library */
     ASS_Library *p_library = p_sys->p_library = ass_library_init();
@@ -281,6 +309,15 @@ static int Create( vlc_object_t *p_this )
     }
     ass_process_codec_private( p_track, p_dec->fmt_in.p_extra, p_dec->fmt_in.i_extra );
 
+    if( var_InheritBool( p_dec, "ssa-prerender" ) )
+    {
+        p_sys->b_prerender = !vlc_clone( &p_sys->prerender_thread,
+                                         PrerenderThread, p_sys,
+                                         VLC_THREAD_PRIORITY_LOW );
+        if( !p_sys->b_prerender )
+            msg_Warn( p_dec, "cannot create the pre-rendering thread" );
+    }
+
     p_dec->fmt_out.i_codec = VLC_CODEC_RGBA;
 
     return VLC_SUCCESS;
@@ -314,6 +351,16 @@ static void DecSysRelease( decoder_sys_t *p_sys )
     }
     vlc_mutex_unlock( &p_sys->lock );
 
+    if( p_sys->b_prerender )
+    {
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->b_prerender_stop = true;
+        vlc_cond_signal( &p_sys->prerender_wait );
+        vlc_mutex_unlock( &p_sys->lock );
+        vlc_join( p_sys->prerender_thread, NULL );
+    }
+    subpicture_region_ChainDelete( p_sys->p_prerender );
+
     if( p_sys->p_track )
         ass_free_track( p_sys->p_track );
     if( p_sys->p_renderer )
@@ -324,6 +371,48 @@ static void DecSysRelease( decoder_sys_t *p_sys )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Pre-rendering:
+ *****************************************************************************/
+static void PrerenderDiscard( decoder_sys_t *p_sys )
+{
+    vlc_mutex_assert( &p_sys->lock );
+
+    subpicture_region_ChainDelete( p_sys->p_prerender );
+    p_sys->p_prerender = NULL;
+    p_sys->i_prerender_date = VLC_TICK_INVALID;
+    p_sys->i_prerender_request = VLC_TICK_INVALID;
+}
+
+static void *PrerenderThread( void *data )
+{
+    decoder_sys_t *p_sys = data;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( ;; )
+    {
+        while( !p_sys->b_prerender_stop
+            && p_sys->i_prerender_request == VLC_TICK_INVALID )
+            vlc_cond_wait( &p_sys->prerender_wait, &p_sys->lock );
+        if( p_sys->b_prerender_stop )
+            break;
+
+        const vlc_tick_t i_date = p_sys->i_prerender_request;
+        int i_changed;
+
+        PrerenderDiscard( p_sys );
+        ASS_Image *p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
+                                             MS_FROM_VLC_TICK( i_date ), &i_changed );
+        p_sys->b_render_dirty = true;
+        p_sys->p_prerender = RegionsNew( &p_sys->fmt, p_img );
+        p_sys->b_prerender_img = p_img != NULL;
+        p_sys->i_prerender_changed = i_changed;
+        p_sys->i_prerender_date = i_date;
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    return NULL;
+}
+
 /*****************************************************************************
  * Flush:
  *****************************************************************************/
@@ -333,6 +422,11 @@ static void Flush( decoder_t *p_dec )
 
     p_sys->i_max_stop = VLC_TICK_INVALID;
     p_sys->i_last_pts = VLC_TICK_INVALID;
+
+    vlc_mutex_lock( &p_sys->lock );
+    PrerenderDiscard( p_sys );
+    p_sys->i_last_render = VLC_TICK_INVALID;
+    vlc_mutex_unlock( &p_sys->lock );
 }
 
 /****************************************************************************
@@ -386,6 +480,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
         }
 
         p_spu_sys->p_img = NULL;
+        p_spu_sys->p_regions = NULL;
         p_spu_sys->p_dec_sys = p_sys;
         p_spu_sys->i_pts = p_block->i_pts;
         p_spu->i_start = p_block->i_pts;
@@ -441,21 +536,54 @@ static int SubpictureValidate( subpicture_t *p_subpic,
         const double dst_ratio = (double)p_fmt_dst->i_visible_width / p_fmt_dst->i_visible_height;
         ass_set_aspect_ratio( p_sys->p_renderer, dst_ratio / src_ratio, 1 );
         p_sys->fmt = fmt;
+        PrerenderDiscard( p_sys );
     }
 
     /* */
     const vlc_tick_t i_stream_date = p_spusys->i_pts + (i_ts - p_subpic->i_start);
     int i_changed;
-    ASS_Image *p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
-                                         MS_FROM_VLC_TICK( i_stream_date ), &i_changed );
+    bool b_img;
+    ASS_Image *p_img = NULL;
+    subpicture_region_t *p_regions = NULL;
+
+    if( p_sys->i_prerender_date == i_stream_date )
+    {   /* The frame was rendered ahead */
+        p_regions = p_sys->p_prerender;
+        p_sys->p_prerender = NULL;
+        i_changed = p_sys->i_prerender_changed;
+        b_img = p_sys->b_prerender_img;
+    }
+    else
+    {
+        p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
+                                  MS_FROM_VLC_TICK( i_stream_date ), &i_changed );
+        b_img = p_img != NULL;
+        /* The change detection was relative to a frame never displayed */
+        if( p_sys->b_render_dirty )
+            i_changed = 2;
+    }
+    p_sys->b_render_dirty = false;
+    PrerenderDiscard( p_sys );
+
+    /* Render the next frame ahead, assuming a regular display rate */
+    if( p_sys->b_prerender && p_sys->i_last_render != VLC_TICK_INVALID
+     && i_stream_date > p_sys->i_last_render
+     && i_stream_date - p_sys->i_last_render < VLC_TICK_FROM_SEC(1) )
+    {
+        p_sys->i_prerender_request = 2 * i_stream_date - p_sys->i_last_render;
+        vlc_cond_signal( &p_sys->prerender_wait );
+    }
+    p_sys->i_last_render = i_stream_date;
 
     if( !i_changed && !b_fmt_src && !b_fmt_dst &&
-        (p_img != NULL) == (p_subpic->p_region != NULL) )
+        b_img == (p_subpic->p_region != NULL) )
     {
+        subpicture_region_ChainDelete( p_regions );
         vlc_mutex_unlock( &p_sys->lock );
         return VLC_SUCCESS;
     }
     p_spusys->p_img = p_img;
+    p_spusys->p_regions = p_regions;
 
     /* The lock is released by SubpictureUpdate */
     return VLC_EGENERIC;
@@ -472,12 +600,23 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     decoder_sys_t *p_sys = p_spusys->p_dec_sys;
 
     video_format_t fmt = p_sys->fmt;
-    ASS_Image *p_img = p_spusys->p_img;
 
     /* */
     p_subpic->i_original_picture_height = fmt.i_visible_height;
     p_subpic->i_original_picture_width = fmt.i_visible_width;
 
+    if( p_spusys->p_regions != NULL )
+        p_subpic->p_region = p_spusys->p_regions;
+    else
+        p_subpic->p_region = RegionsNew( &fmt, p_spusys->p_img );
+    p_spusys->p_regions = NULL;
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static subpicture_region_t *RegionsNew( const video_format_t *p_fmt, ASS_Image *p_img )
+{
+    const video_format_t fmt = *p_fmt;
+
     /* XXX to improve efficiency we merge regions that are close minimizing
      * the lost surface.
      * libass tends to create a lot of small regions and thus spu engine
@@ -489,13 +628,11 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     const int i_region = BuildRegions( region, i_max_region, p_img, fmt.i_width, fmt.i_height );
 
     if( i_region <= 0 )
-    {
-        vlc_mutex_unlock( &p_sys->lock );
-        return;
-    }
+        return NULL;
 
     /* Allocate the regions and draw them */
-    subpicture_region_t **pp_region_last = &p_subpic->p_region;
+    subpicture_region_t *p_head = NULL;
+    subpicture_region_t **pp_region_last = &p_head;
 
     for( int i = 0; i < i_region; i++ )
     {
@@ -523,13 +660,13 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         *pp_region_last = r;
         pp_region_last = &r->p_next;
     }
-    vlc_mutex_unlock( &p_sys->lock );
-
+    return p_head;
 }
 static void SubpictureDestroy( subpicture_t *p_subpic )
 {
     libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
 
+    subpicture_region_ChainDelete( p_spusys->p_regions );
     DecSysRelease( p_spusys->p_dec_sys );
     free( p_spusys );
 }
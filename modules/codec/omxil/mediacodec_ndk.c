@@ -117,6 +117,23 @@ typedef struct AMediaFormat AMediaFormat;
 struct AMediaCrypto;
 typedef struct AMediaCrypto AMediaCrypto;
 
+/* Asynchronous notifications, since API 28 */
+typedef void (*AMediaCodecOnAsyncInputAvailable)(AMediaCodec *codec,
+        void *userdata, int32_t index);
+typedef void (*AMediaCodecOnAsyncOutputAvailable)(AMediaCodec *codec,
+        void *userdata, int32_t index, AMediaCodecBufferInfo *bufferInfo);
+typedef void (*AMediaCodecOnAsyncFormatChanged)(AMediaCodec *codec,
+        void *userdata, AMediaFormat *format);
+typedef void (*AMediaCodecOnAsyncError)(AMediaCodec *codec, void *userdata,
+        media_status_t error, int32_t actionCode, const char *detail);
+
+typedef struct AMediaCodecOnAsyncNotifyCallback {
+    AMediaCodecOnAsyncInputAvailable  onAsyncInputAvailable;
+    AMediaCodecOnAsyncOutputAvailable onAsyncOutputAvailable;
+    AMediaCodecOnAsyncFormatChanged   onAsyncFormatChanged;
+    AMediaCodecOnAsyncError           onAsyncError;
+} AMediaCodecOnAsyncNotifyCallback;
+
 /*****************************************************************************
  * Ndk symbols
  *****************************************************************************/
@@ -163,6 +180,9 @@ typedef media_status_t (*pf_AMediaCodec_releaseOutputBufferAtTime)(AMediaCodec*,
 typedef media_status_t (*pf_AMediaCodec_setOutputSurface)(AMediaCodec*,
         ANativeWindow *surface);
 
+typedef media_status_t (*pf_AMediaCodec_setAsyncNotifyCallback)(AMediaCodec*,
+        AMediaCodecOnAsyncNotifyCallback callback, void *userdata);
+
 typedef AMediaFormat *(*pf_AMediaFormat_new)();
 typedef media_status_t (*pf_AMediaFormat_delete)(AMediaFormat*);
 
@@ -193,6 +213,7 @@ struct syms
         pf_AMediaCodec_releaseOutputBuffer releaseOutputBuffer;
         pf_AMediaCodec_releaseOutputBufferAtTime releaseOutputBufferAtTime;
         pf_AMediaCodec_setOutputSurface setOutputSurface;
+        pf_AMediaCodec_setAsyncNotifyCallback setAsyncNotifyCallback;
     } AMediaCodec;
     struct {
         pf_AMediaFormat_new new;
@@ -228,6 +249,7 @@ static struct members members[] =
     { "AMediaCodec_releaseOutputBuffer", OFF(releaseOutputBuffer), true },
     { "AMediaCodec_releaseOutputBufferAtTime", OFF(releaseOutputBufferAtTime), true },
     { "AMediaCodec_setOutputSurface", OFF(setOutputSurface), false },
+    { "AMediaCodec_setAsyncNotifyCallback", OFF(setAsyncNotifyCallback), false },
 #undef OFF
 #define OFF(x) offsetof(struct syms, AMediaFormat.x)
     { "AMediaFormat_new", OFF(new), true },
@@ -285,13 +307,133 @@ end:
  * Local prototypes
  ****************************************************************************/
 
+/* Larger than the number of buffers of any codec */
+#define ASYNC_QUEUE_SIZE 64
+
 struct mc_api_sys
 {
     AMediaCodec* p_codec;
     AMediaFormat* p_format;
     AMediaCodecBufferInfo info;
+
+    /* Buffers notified by the codec in asynchronous mode, waiting to be
+     * returned by DequeueInput and DequeueOutput */
+    struct
+    {
+        bool b_enabled;
+        vlc_mutex_t lock;
+        vlc_cond_t cond;
+        unsigned i_flushes; /* wakes up the waiters on flush */
+        bool b_error;
+
+        int in[ASYNC_QUEUE_SIZE];
+        size_t i_in_first, i_in_count;
+
+        struct
+        {
+            int i_index;
+            AMediaCodecBufferInfo info;
+        } out[ASYNC_QUEUE_SIZE];
+        size_t i_out_first, i_out_count;
+    } async;
 };
 
+/*****************************************************************************
+ * Asynchronous mode
+ *****************************************************************************/
+static void AsyncOnInput(AMediaCodec *codec, void *userdata, int32_t index)
+{
+    mc_api_sys *p_sys = userdata;
+    (void) codec;
+
+    vlc_mutex_lock(&p_sys->async.lock);
+    if (likely(p_sys->async.i_in_count < ASYNC_QUEUE_SIZE))
+    {
+        size_t i = (p_sys->async.i_in_first + p_sys->async.i_in_count++)
+                 % ASYNC_QUEUE_SIZE;
+        p_sys->async.in[i] = index;
+        vlc_cond_broadcast(&p_sys->async.cond);
+    }
+    vlc_mutex_unlock(&p_sys->async.lock);
+}
+
+static void AsyncQueueOutput(mc_api_sys *p_sys, int i_index,
+                             const AMediaCodecBufferInfo *info)
+{
+    vlc_mutex_lock(&p_sys->async.lock);
+    if (likely(p_sys->async.i_out_count < ASYNC_QUEUE_SIZE))
+    {
+        size_t i = (p_sys->async.i_out_first + p_sys->async.i_out_count++)
+                 % ASYNC_QUEUE_SIZE;
+        p_sys->async.out[i].i_index = i_index;
+        if (info != NULL)
+            p_sys->async.out[i].info = *info;
+        vlc_cond_broadcast(&p_sys->async.cond);
+    }
+    vlc_mutex_unlock(&p_sys->async.lock);
+}
+
+static void AsyncOnOutput(AMediaCodec *codec, void *userdata, int32_t index,
+                          AMediaCodecBufferInfo *info)
+{
+    (void) codec;
+    AsyncQueueOutput(userdata, index, info);
+}
+
+static void AsyncOnFormatChanged(AMediaCodec *codec, void *userdata,
+                                 AMediaFormat *format)
+{
+    /* The format is read again by GetOutput */
+    (void) codec; (void) format;
+    AsyncQueueOutput(userdata, MC_API_INFO_OUTPUT_FORMAT_CHANGED, NULL);
+}
+
+static void AsyncOnError(AMediaCodec *codec, void *userdata,
+                         media_status_t error, int32_t action,
+                         const char *detail)
+{
+    mc_api_sys *p_sys = userdata;
+    (void) codec; (void) error; (void) action; (void) detail;
+
+    vlc_mutex_lock(&p_sys->async.lock);
+    p_sys->async.b_error = true;
+    vlc_cond_broadcast(&p_sys->async.cond);
+    vlc_mutex_unlock(&p_sys->async.lock);
+}
+
+/* Drops the pending buffers and wakes the waiters up */
+static void AsyncReset(mc_api_sys *p_sys, bool b_error)
+{
+    vlc_mutex_lock(&p_sys->async.lock);
+    p_sys->async.i_in_count = p_sys->async.i_out_count = 0;
+    p_sys->async.i_flushes++;
+    p_sys->async.b_error = b_error;
+    vlc_cond_broadcast(&p_sys->async.cond);
+    vlc_mutex_unlock(&p_sys->async.lock);
+}
+
+/* Waits for a queued buffer, returns false on timeout, flush or error */
+static bool AsyncWait(mc_api_sys *p_sys, const size_t *pi_count,
+                      vlc_tick_t i_timeout)
+{
+    const unsigned i_flushes = p_sys->async.i_flushes;
+    const vlc_tick_t deadline = vlc_tick_now() + i_timeout;
+
+    vlc_mutex_assert(&p_sys->async.lock);
+
+    while (*pi_count == 0)
+    {
+        if (p_sys->async.b_error || p_sys->async.i_flushes != i_flushes)
+            return false;
+        if (i_timeout < 0)
+            vlc_cond_wait(&p_sys->async.cond, &p_sys->async.lock);
+        else if (vlc_cond_timedwait(&p_sys->async.cond, &p_sys->async.lock,
+                                    deadline))
+            return *pi_count > 0;
+    }
+    return true;
+}
+
 /*****************************************************************************
  * ConfigureDecoder
  *****************************************************************************/
@@ -343,6 +485,20 @@ static int ConfigureDecoder(mc_api *api, union mc_api_args *p_args)
         syms.AMediaFormat.setInt32(p_sys->p_format, "channel-count", p_args->audio.i_channel_count);
     }
 
+    /* Get notified of the available buffers instead of polling for them */
+    p_sys->async.b_enabled = false;
+    if (syms.AMediaCodec.setAsyncNotifyCallback != NULL)
+    {
+        static const AMediaCodecOnAsyncNotifyCallback cbs = {
+            AsyncOnInput, AsyncOnOutput, AsyncOnFormatChanged, AsyncOnError,
+        };
+
+        p_sys->async.b_enabled =
+            syms.AMediaCodec.setAsyncNotifyCallback(p_sys->p_codec, cbs,
+                                                    p_sys) == AMEDIA_OK;
+        AsyncReset(p_sys, false);
+    }
+
     if (syms.AMediaCodec.configure(p_sys->p_codec, p_sys->p_format,
                                    p_anw, NULL, 0) != AMEDIA_OK)
     {
@@ -371,6 +527,8 @@ static int Stop(mc_api *api)
             syms.AMediaCodec.stop(p_sys->p_codec);
             api->b_started = false;
         }
+        if (p_sys->async.b_enabled)
+            AsyncReset(p_sys, true);
         syms.AMediaCodec.delete(p_sys->p_codec);
         p_sys->p_codec = NULL;
     }
@@ -415,10 +573,18 @@ static int Flush(mc_api *api)
 {
     mc_api_sys *p_sys = api->p_sys;
 
-    if (syms.AMediaCodec.flush(p_sys->p_codec) == AMEDIA_OK)
-        return 0;
-    else
+    if (syms.AMediaCodec.flush(p_sys->p_codec) != AMEDIA_OK)
         return MC_API_ERROR;
+
+    if (p_sys->async.b_enabled)
+    {
+        /* The indices notified before the flush are not valid anymore, and
+         * an asynchronous codec must be resumed explicitly */
+        AsyncReset(p_sys, false);
+        if (syms.AMediaCodec.start(p_sys->p_codec) != AMEDIA_OK)
+            return MC_API_ERROR;
+    }
+    return 0;
 }
 
 /*****************************************************************************
@@ -429,6 +595,26 @@ static int DequeueInput(mc_api *api, vlc_tick_t i_timeout)
     mc_api_sys *p_sys = api->p_sys;
     ssize_t i_index;
 
+    if (p_sys->async.b_enabled)
+    {
+        vlc_mutex_lock(&p_sys->async.lock);
+        if (AsyncWait(p_sys, &p_sys->async.i_in_count, i_timeout))
+        {
+            i_index = p_sys->async.in[p_sys->async.i_in_first];
+            p_sys->async.i_in_first = (p_sys->async.i_in_first + 1)
+                                    % ASYNC_QUEUE_SIZE;
+            p_sys->async.i_in_count--;
+        }
+        else
+            i_index = p_sys->async.b_error ? MC_API_ERROR
+                                           : MC_API_INFO_TRYAGAIN;
+        vlc_mutex_unlock(&p_sys->async.lock);
+
+        if (i_index == MC_API_ERROR)
+            msg_Err(api->p_obj, "AMediaCodec asynchronous error");
+        return i_index;
+    }
+
     i_index = syms.AMediaCodec.dequeueInputBuffer(p_sys->p_codec, i_timeout);
     if (i_index >= 0)
         return i_index;
@@ -489,6 +675,25 @@ static int DequeueOutput(mc_api *api, vlc_tick_t i_timeout)
     mc_api_sys *p_sys = api->p_sys;
     ssize_t i_index;
 
+    if (p_sys->async.b_enabled)
+    {
+        vlc_mutex_lock(&p_sys->async.lock);
+        if (AsyncWait(p_sys, &p_sys->async.i_out_count, i_timeout))
+        {
+            size_t i = p_sys->async.i_out_first;
+
+            i_index = p_sys->async.out[i].i_index;
+            p_sys->info = p_sys->async.out[i].info;
+            p_sys->async.i_out_first = (i + 1) % ASYNC_QUEUE_SIZE;
+            p_sys->async.i_out_count--;
+        }
+        else
+            i_index = p_sys->async.b_error ? MC_API_ERROR
+                                           : MC_API_INFO_TRYAGAIN;
+        vlc_mutex_unlock(&p_sys->async.lock);
+        return i_index;
+    }
+
     i_index = syms.AMediaCodec.dequeueOutputBuffer(p_sys->p_codec, &p_sys->info,
                                                    i_timeout);
 
@@ -653,6 +858,8 @@ int MediaCodecNdk_Init(mc_api *api)
     api->p_sys = calloc(1, sizeof(mc_api_sys));
     if (!api->p_sys)
         return MC_API_ERROR;
+    vlc_mutex_init(&api->p_sys->async.lock);
+    vlc_cond_init(&api->p_sys->async.cond);
 
     api->clean = Clean;
     api->prepare = Prepare;
@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * scte35.h : SCTE-35 splice information parsing
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifndef VLC_SCTE35_H
+#define VLC_SCTE35_H
+
+#define SCTE35_TABLE_ID    0xFC
+
+#define SCTE35_SPLICE_NULL     0x00
+#define SCTE35_SPLICE_INSERT   0x05
+#define SCTE35_TIME_SIGNAL     0x06
+
+#define SCTE35_TIME_UNSET  (-1)
+
+typedef struct
+{
+    uint32_t i_event_id;
+    bool b_cancel;
+    bool b_out_of_network;
+    bool b_immediate;
+    bool b_auto_return;
+    int64_t i_pts_adjustment; /* 90 kHz */
+    int64_t i_splice_time;    /* 90 kHz, SCTE35_TIME_UNSET if immediate */
+    int64_t i_break_duration; /* 90 kHz, SCTE35_TIME_UNSET if none */
+} scte35_splice_insert_t;
+
+static inline int64_t scte35_get_33bits( const uint8_t *p )
+{
+    return ((int64_t)(p[0] & 0x01) << 32) | GetDWBE( &p[1] );
+}
+
+/* Parses a splice_time() structure, returns its size or 0 on error */
+static inline size_t scte35_parse_splice_time( const uint8_t *p, size_t i_buffer,
+                                               int64_t *pi_time )
+{
+    if( i_buffer < 1 )
+        return 0;
+    if( !(p[0] & 0x80) ) /* time_specified_flag */
+    {
+        *pi_time = SCTE35_TIME_UNSET;
+        return 1;
+    }
+    if( i_buffer < 5 )
+        return 0;
+    *pi_time = scte35_get_33bits( p );
+    return 5;
+}
+
+/* Parses a complete splice_info_section carrying a splice_insert() command.
+ * Splice times are returned as signalled, without the pts_adjustment. */
+static inline bool scte35_parse_splice_insert( const uint8_t *p_buffer, size_t i_buffer,
+                                               scte35_splice_insert_t *p_insert )
+{
+    if( i_buffer < 14 || p_buffer[0] != SCTE35_TABLE_ID )
+        return false;
+
+    size_t i_section = (((p_buffer[1] & 0x0f) << 8) | p_buffer[2]) + 3;
+    if( i_section > i_buffer )
+        return false;
+    /* encrypted_packet, we can't read the command */
+    if( p_buffer[4] & 0x80 )
+        return false;
+    if( p_buffer[13] != SCTE35_SPLICE_INSERT )
+        return false;
+
+    const uint8_t *p = &p_buffer[14];
+    size_t i_left = i_section - 14;
+
+    memset( p_insert, 0, sizeof(*p_insert) );
+    p_insert->i_pts_adjustment = scte35_get_33bits( &p_buffer[4] );
+    p_insert->i_splice_time = SCTE35_TIME_UNSET;
+    p_insert->i_break_duration = SCTE35_TIME_UNSET;
+
+    if( i_left < 5 )
+        return false;
+    p_insert->i_event_id = GetDWBE( p );
+    p_insert->b_cancel = p[4] & 0x80;
+    p += 5; i_left -= 5;
+    if( p_insert->b_cancel )
+        return true;
+
+    if( i_left < 1 )
+        return false;
+    const bool b_program = p[0] & 0x40;
+    const bool b_duration = p[0] & 0x20;
+    p_insert->b_out_of_network = p[0] & 0x80;
+    p_insert->b_immediate = p[0] & 0x10;
+    p++; i_left--;
+
+    if( b_program )
+    {
+        if( !p_insert->b_immediate )
+        {
+            size_t i_size = scte35_parse_splice_time( p, i_left, &p_insert->i_splice_time );
+            if( i_size == 0 )
+                return false;
+            p += i_size; i_left -= i_size;
+        }
+    }
+    else
+    {
+        /* Component splice mode: use the first signalled time */
+        if( i_left < 1 )
+            return false;
+        unsigned i_count = p[0];
+        p++; i_left--;
+        for( unsigned i = 0; i < i_count; i++ )
+        {
+            if( i_left < 1 )
+                return false;
+            p++; i_left--; /* component_tag */
+            if( p_insert->b_immediate )
+                continue;
+
+            int64_t i_time;
+            size_t i_size = scte35_parse_splice_time( p, i_left, &i_time );
+            if( i_size == 0 )
+                return false;
+            if( p_insert->i_splice_time == SCTE35_TIME_UNSET )
+                p_insert->i_splice_time = i_time;
+            p += i_size; i_left -= i_size;
+        }
+    }
+
+    if( b_duration )
+    {
+        if( i_left < 5 )
+            return false;
+        p_insert->b_auto_return = p[0] & 0x80;
+        p_insert->i_break_duration = scte35_get_33bits( p );
+    }
+
+    return true;
+}
+
+#endif
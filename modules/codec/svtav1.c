@@ -0,0 +1,267 @@
+/*****************************************************************************
+ * svtav1.c : SVT-AV1 encoder (AV1) module
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <svt-av1/EbSvtAv1Enc.h>
+
+#define SOUT_CFG_PREFIX "sout-svtav1-"
+
+typedef struct
+{
+    EbComponentType *handle;
+    vlc_decoder_threads *threads;
+    bool eos_sent;
+} encoder_sys_t;
+
+static block_t *ReceivePackets(encoder_t *enc, bool done)
+{
+    encoder_sys_t *sys = enc->p_sys;
+    block_t *p_out = NULL;
+
+    for (;;)
+    {
+        EbBufferHeaderType *pkt;
+        EbErrorType ret = svt_av1_enc_get_packet(sys->handle, &pkt, done);
+
+        if (ret == EB_NoErrorEmptyQueue)
+            break;
+        if (ret != EB_ErrorNone)
+        {
+            msg_Err(enc, "svt_av1_enc_get_packet() failed: 0x%x", ret);
+            break;
+        }
+
+        bool eos = (pkt->flags & EB_BUFFERFLAG_EOS) != 0;
+        if (pkt->n_filled_len > 0)
+        {
+            block_t *p_block = block_Alloc(pkt->n_filled_len);
+            if (likely(p_block != NULL))
+            {
+                memcpy(p_block->p_buffer, pkt->p_buffer, pkt->n_filled_len);
+                p_block->i_pts = pkt->pts;
+                p_block->i_dts = pkt->dts;
+                if (pkt->pic_type == EB_AV1_KEY_PICTURE)
+                    p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+                block_ChainAppend(&p_out, p_block);
+            }
+        }
+        svt_av1_enc_release_out_buffer(&pkt);
+
+        if (eos)
+            break;
+    }
+    return p_out;
+}
+
+static block_t *Encode(encoder_t *enc, picture_t *p_pict)
+{
+    encoder_sys_t *sys = enc->p_sys;
+
+    if (p_pict == NULL)
+    {
+        /* Drain: the encoder outputs its remaining packets after EOS */
+        if (!sys->eos_sent)
+        {
+            EbBufferHeaderType eos = {
+                .size = sizeof (eos),
+                .flags = EB_BUFFERFLAG_EOS,
+                .pic_type = EB_AV1_INVALID_PICTURE,
+            };
+            svt_av1_enc_send_picture(sys->handle, &eos);
+            sys->eos_sent = true;
+        }
+        return ReceivePackets(enc, true);
+    }
+
+    const unsigned pixel_size = p_pict->p[0].i_pixel_pitch;
+    EbSvtIOFormat frame = {
+        .luma = p_pict->p[0].p_pixels,
+        .cb = p_pict->p[1].p_pixels,
+        .cr = p_pict->p[2].p_pixels,
+        /* strides are in pixels */
+        .y_stride = p_pict->p[0].i_pitch / pixel_size,
+        .cb_stride = p_pict->p[1].i_pitch / pixel_size,
+        .cr_stride = p_pict->p[2].i_pitch / pixel_size,
+        .width = enc->fmt_in.video.i_visible_width,
+        .height = enc->fmt_in.video.i_visible_height,
+    };
+    EbBufferHeaderType in = {
+        .size = sizeof (in),
+        .p_buffer = (uint8_t *)&frame,
+        .n_filled_len = (p_pict->p[0].i_pitch * p_pict->p[0].i_visible_lines)
+                      + (p_pict->p[1].i_pitch * p_pict->p[1].i_visible_lines)
+                      + (p_pict->p[2].i_pitch * p_pict->p[2].i_visible_lines),
+        .pts = p_pict->date,
+        .pic_type = EB_AV1_INVALID_PICTURE,
+    };
+
+    EbErrorType ret = svt_av1_enc_send_picture(sys->handle, &in);
+    if (ret != EB_ErrorNone)
+    {
+        msg_Err(enc, "svt_av1_enc_send_picture() failed: 0x%x", ret);
+        return NULL;
+    }
+    return ReceivePackets(enc, false);
+}
+
+static int OpenEncoder(vlc_object_t *this)
+{
+    encoder_t *enc = (encoder_t *) this;
+    encoder_sys_t *sys;
+
+    if (enc->fmt_out.i_codec != VLC_CODEC_AV1)
+        return VLC_EGENERIC;
+
+    static const char *const ppsz_svtav1_options[] = {
+        "preset", "bitdepth", "crf", "low-delay", "tile-rows",
+        "tile-columns", NULL
+    };
+
+    config_ChainParse(enc, SOUT_CFG_PREFIX, ppsz_svtav1_options, enc->p_cfg);
+
+    sys = malloc(sizeof(*sys));
+    if (sys == NULL)
+        return VLC_ENOMEM;
+
+    EbSvtAv1EncConfiguration cfg;
+    EbErrorType ret = svt_av1_enc_init_handle(&sys->handle, NULL, &cfg);
+    if (ret != EB_ErrorNone)
+    {
+        msg_Err(enc, "Unable to initialize the encoder: 0x%x", ret);
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
+    int bitdepth = var_InheritInteger(enc, SOUT_CFG_PREFIX "bitdepth");
+    enc->fmt_in.i_codec = bitdepth == 8 ? VLC_CODEC_I420 : VLC_CODEC_I420_10L;
+
+    cfg.enc_mode = var_InheritInteger(enc, SOUT_CFG_PREFIX "preset");
+    cfg.source_width = enc->fmt_in.video.i_visible_width;
+    cfg.source_height = enc->fmt_in.video.i_visible_height;
+    cfg.encoder_bit_depth = bitdepth;
+    if (enc->fmt_in.video.i_frame_rate && enc->fmt_in.video.i_frame_rate_base)
+    {
+        cfg.frame_rate_numerator = enc->fmt_in.video.i_frame_rate;
+        cfg.frame_rate_denominator = enc->fmt_in.video.i_frame_rate_base;
+    }
+
+    /* Low delay does not reorder pictures, so that each picture is output as
+     * soon as it is encoded. The SVT-AV1 CBR mode requires it. */
+    bool low_delay = var_InheritBool(enc, SOUT_CFG_PREFIX "low-delay");
+    cfg.pred_structure = low_delay ? SVT_AV1_PRED_LOW_DELAY_B
+                                   : SVT_AV1_PRED_RANDOM_ACCESS;
+    if (enc->fmt_out.i_bitrate > 0)
+    {
+        cfg.rate_control_mode = low_delay ? 2 /* CBR */ : 1 /* VBR */;
+        cfg.target_bit_rate = enc->fmt_out.i_bitrate;
+    }
+    else
+    {
+        cfg.rate_control_mode = 0; /* CRF */
+        cfg.qp = var_InheritInteger(enc, SOUT_CFG_PREFIX "crf");
+    }
+    if (enc->i_iframes > 0)
+        cfg.intra_period_length = enc->i_iframes - 1;
+
+    cfg.tile_rows = var_InheritInteger(enc, SOUT_CFG_PREFIX "tile-rows");
+    cfg.tile_columns = var_InheritInteger(enc, SOUT_CFG_PREFIX "tile-columns");
+
+    /* Like other encoders, use the transcode threads if set, otherwise a
+     * share of the threads budget. */
+    sys->threads = NULL;
+    if (enc->i_threads > 0)
+        cfg.logical_processors = enc->i_threads;
+    else
+    {
+        sys->threads = vlc_encoder_threads_Acquire(enc, 0);
+        if (sys->threads != NULL)
+            cfg.logical_processors = vlc_decoder_threads_Count(sys->threads);
+    }
+
+    ret = svt_av1_enc_set_parameter(sys->handle, &cfg);
+    if (ret != EB_ErrorNone)
+    {
+        msg_Err(enc, "Unable to set the encoder parameters: 0x%x", ret);
+        goto error;
+    }
+
+    ret = svt_av1_enc_init(sys->handle);
+    if (ret != EB_ErrorNone)
+    {
+        msg_Err(enc, "Unable to start the encoder: 0x%x", ret);
+        goto error;
+    }
+
+    msg_Dbg(enc, "preset %d, %s, %u threads", cfg.enc_mode,
+            low_delay ? "low delay" : "random access", cfg.logical_processors);
+
+    sys->eos_sent = false;
+    enc->p_sys = sys;
+    enc->pf_encode_video = Encode;
+    return VLC_SUCCESS;
+
+error:
+    if (sys->threads != NULL)
+        vlc_decoder_threads_Release(sys->threads);
+    svt_av1_enc_deinit_handle(sys->handle);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void CloseEncoder(vlc_object_t* this)
+{
+    encoder_t *enc = (encoder_t *) this;
+    encoder_sys_t *sys = enc->p_sys;
+
+    svt_av1_enc_deinit(sys->handle);
+    svt_av1_enc_deinit_handle(sys->handle);
+    if (sys->threads != NULL)
+        vlc_decoder_threads_Release(sys->threads);
+    free(sys);
+}
+
+static const int bitdepth_values_list[] = {8, 10};
+static const char *bitdepth_values_name_list[] = {N_("8 bpp"), N_("10 bpp")};
+
+vlc_module_begin()
+    set_shortname("SVT-AV1")
+    set_description(N_("SVT-AV1 video encoder"))
+    set_capability("encoder", 110)
+    set_callbacks(OpenEncoder, CloseEncoder)
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+    add_integer(SOUT_CFG_PREFIX "preset", 10, "Preset (0: slowest, 13: fastest)", NULL)
+        change_integer_range(0, 13)
+    add_integer(SOUT_CFG_PREFIX "bitdepth", 8, "Bit Depth", NULL)
+        change_integer_list(bitdepth_values_list, bitdepth_values_name_list)
+    add_integer(SOUT_CFG_PREFIX "crf", 35, "Quality (when no bitrate is set)", NULL)
+        change_integer_range(1, 63)
+    add_bool(SOUT_CFG_PREFIX "low-delay", false, "Low delay", NULL)
+    add_integer(SOUT_CFG_PREFIX "tile-rows", 0, "Tile Rows (in log2 units)", NULL)
+        change_integer_range(0, 6)
+    add_integer(SOUT_CFG_PREFIX "tile-columns", 0, "Tile Columns (in log2 units)", NULL)
+        change_integer_range(0, 4)
+vlc_module_end()
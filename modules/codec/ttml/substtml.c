@@ -85,6 +85,9 @@ typedef struct
 typedef struct
 {
     vlc_dictionary_t regions;
+    vlc_dictionary_t style_ids;  /* style nodes by id */
+    vlc_dictionary_t region_ids; /* region nodes by id */
+    vlc_dictionary_t inherited;  /* computed styles, by parent node */
     tt_node_t *      p_rootnode; /* for now. FIXME: split header */
     ttml_length_t    root_extent_h, root_extent_v;
     unsigned         i_cell_resolution_v;
@@ -161,11 +164,16 @@ static void ttml_region_Delete( ttml_region_t *p_region )
 
 static ttml_style_t * ttml_style_Duplicate( const ttml_style_t *p_src )
 {
-    ttml_style_t *p_dup = ttml_style_New( );
+    ttml_style_t *p_dup = malloc( sizeof( *p_dup ) );
     if( p_dup )
     {
         *p_dup = *p_src;
         p_dup->font_style = text_style_Duplicate( p_src->font_style );
+        if( unlikely( !p_dup->font_style ) )
+        {
+            free( p_dup );
+            return NULL;
+        }
     }
     return p_dup;
 }
@@ -312,6 +320,37 @@ static tt_node_t * FindNode( tt_node_t *p_node, const char *psz_nodename,
     return NULL;
 }
 
+static const char *GetNodeID( const tt_node_t *p_node )
+{
+    const char *psz = vlc_dictionary_value_for_key( &p_node->attr_dict, "xml:id" );
+    if( !psz ) /* People can't do xml properly */
+        psz = vlc_dictionary_value_for_key( &p_node->attr_dict, "id" );
+    return psz;
+}
+
+/* Indexes the style and region nodes by id, in FindNode() lookup order */
+static void IndexNodes( ttml_context_t *p_ctx, const tt_node_t *p_node )
+{
+    vlc_dictionary_t *p_ids = NULL;
+
+    if( !tt_node_NameCompare( p_node->psz_node_name, "style" ) )
+        p_ids = &p_ctx->style_ids;
+    else if( !tt_node_NameCompare( p_node->psz_node_name, "region" ) )
+        p_ids = &p_ctx->region_ids;
+
+    const char *psz_id;
+    if( p_ids && (psz_id = GetNodeID( p_node )) &&
+        !vlc_dictionary_has_key( p_ids, psz_id ) )
+        vlc_dictionary_insert( p_ids, psz_id, (void *) p_node );
+
+    for( const tt_basenode_t *p_child = p_node->p_child;
+                              p_child; p_child = p_child->p_next )
+    {
+        if( p_child->i_type != TT_NODE_TYPE_TEXT )
+            IndexNodes( p_ctx, (const tt_node_t *) p_child );
+    }
+}
+
 static void FillTextStyle( const char *psz_attr, const char *psz_val,
                            text_style_t *p_text_style )
 {
@@ -611,8 +650,8 @@ static void DictMergeWithStyleID( ttml_context_t *p_ctx, const char *psz_styles,
         while( psz_id )
         {
             /* Lookup referenced style ID */
-            const tt_node_t *p_node = FindNode( p_ctx->p_rootnode,
-                                                "style", -1, psz_id );
+            const tt_node_t *p_node =
+                vlc_dictionary_value_for_key( &p_ctx->style_ids, psz_id );
             if( p_node )
                 DictionaryMerge( &p_node->attr_dict, &tempdict, true );
 
@@ -633,8 +672,8 @@ static void DictMergeWithRegionID( ttml_context_t *p_ctx, const char *psz_id,
     assert(p_ctx->p_rootnode);
     if( psz_id && p_ctx->p_rootnode )
     {
-        const tt_node_t *p_regionnode = FindNode( p_ctx->p_rootnode,
-                                                 "region", -1, psz_id );
+        const tt_node_t *p_regionnode =
+                vlc_dictionary_value_for_key( &p_ctx->region_ids, psz_id );
         if( !p_regionnode )
             return;
 
@@ -678,6 +717,17 @@ static ttml_style_t * InheritTTMLStyles( ttml_context_t *p_ctx, tt_node_t *p_nod
 {
     assert( p_node );
     ttml_style_t *p_ttml_style = NULL;
+
+    /* Sibling text nodes share the styles computed for their parent */
+    char psz_key[sizeof(void *) * 2 + 3];
+    snprintf( psz_key, sizeof(psz_key), "%p", (void *) p_node );
+    if( vlc_dictionary_has_key( &p_ctx->inherited, psz_key ) )
+    {
+        const ttml_style_t *p_interned =
+                vlc_dictionary_value_for_key( &p_ctx->inherited, psz_key );
+        return p_interned ? ttml_style_Duplicate( p_interned ) : NULL;
+    }
+
     vlc_dictionary_t merged;
     vlc_dictionary_init( &merged, 0 );
 
@@ -704,7 +754,16 @@ static ttml_style_t * InheritTTMLStyles( ttml_context_t *p_ctx, tt_node_t *p_nod
 
     vlc_dictionary_clear( &merged, NULL, NULL );
 
-    return p_ttml_style;
+    vlc_dictionary_insert( &p_ctx->inherited, psz_key, p_ttml_style );
+
+    return p_ttml_style ? ttml_style_Duplicate( p_ttml_style ) : NULL;
+}
+
+static void InternedStyleDelete( void *p_style, void *p_obj )
+{
+    VLC_UNUSED( p_obj );
+    if( p_style )
+        ttml_style_Delete( p_style );
 }
 
 static int ParseTTMLChunk( xml_reader_t *p_reader, tt_node_t **pp_rootnode )
@@ -1093,7 +1152,14 @@ static ttml_region_t *GenerateRegions( tt_node_t *p_rootnode, tt_time_t playback
             context.p_rootnode = p_rootnode;
 
             vlc_dictionary_init( &context.regions, 1 );
+            vlc_dictionary_init( &context.style_ids, 0 );
+            vlc_dictionary_init( &context.region_ids, 0 );
+            vlc_dictionary_init( &context.inherited, 0 );
+            IndexNodes( &context, p_rootnode );
             ConvertNodesToRegionContent( &context, p_bodynode, NULL, NULL, playbacktime );
+            vlc_dictionary_clear( &context.inherited, InternedStyleDelete, NULL );
+            vlc_dictionary_clear( &context.region_ids, NULL, NULL );
+            vlc_dictionary_clear( &context.style_ids, NULL, NULL );
 
             for( int i = 0; i < context.regions.i_size; ++i )
             {
@@ -529,7 +529,16 @@ static bool VideoToolboxNeedsToRestartH264(decoder_t *p_dec,
         {
             b_ret = !VTDecompressionSessionCanAcceptFormatDescription(session,
                                                                       newvideoFormatDesc);
-            CFRelease(newvideoFormatDesc);
+            if (!b_ret)
+            {
+                /* Keep the session, but describe the next samples with the
+                 * new parameter sets */
+                msg_Dbg(p_dec, "parameters sets changed: reusing decoder");
+                CFRelease(p_sys->videoFormatDescription);
+                p_sys->videoFormatDescription = newvideoFormatDesc;
+            }
+            else
+                CFRelease(newvideoFormatDesc);
         }
         CFRelease(decoderConfiguration);
     }
@@ -100,6 +100,7 @@ static void vpx_err_msg(vlc_object_t *this, struct vpx_codec_ctx *ctx,
 typedef struct
 {
     struct vpx_codec_ctx ctx;
+    vlc_decoder_threads *threads;
 } decoder_sys_t;
 
 static const struct
@@ -324,8 +325,12 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_ENOMEM;
     dec->p_sys = sys;
 
+    /* libvpx can't change its threads once started, so the budget is only
+     * applied when opening */
+    sys->threads = vlc_decoder_threads_Acquire(dec, 16);
     struct vpx_codec_dec_cfg deccfg = {
-        .threads = __MIN(vlc_GetCPUCount(), 16)
+        .threads = sys->threads ? vlc_decoder_threads_Count(sys->threads)
+                                : __MIN(vlc_GetCPUCount(), 16)
     };
 
     msg_Dbg(p_this, "VP%d: using libvpx version %s (build options %s)",
@@ -333,6 +338,8 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     if (vpx_codec_dec_init(&sys->ctx, iface, &deccfg, 0) != VPX_CODEC_OK) {
         VPX_ERR(p_this, &sys->ctx, "Failed to initialize decoder");
+        if (sys->threads)
+            vlc_decoder_threads_Release(sys->threads);
         free(sys);
         return VLC_EGENERIC;;
     }
@@ -369,6 +376,8 @@ static void CloseDecoder(vlc_object_t *p_this)
 
     vpx_codec_destroy(&sys->ctx);
 
+    if (sys->threads)
+        vlc_decoder_threads_Release(sys->threads);
     free(sys);
 }
 
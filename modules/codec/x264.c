@@ -400,6 +400,12 @@ static void x264_log( void *, int i_level, const char *psz, va_list );
 #define LOOKAHEAD_LONGTEXT N_("Framecount to use on frametype lookahead. " \
     "Currently default can cause sync-issues on unmuxable output, like rtsp-output without ts-mux" )
 
+#define LATENCY_TEXT N_("Latency target (ms)")
+#define LATENCY_LONGTEXT N_("Choose the frame threads, lookahead, B-frames " \
+    "and VBV buffer so that the encoding delay stays within this many " \
+    "milliseconds, using the threads that the other encoders and decoders " \
+    "leave. 0 keeps the individual settings." )
+
 #define HRD_TEXT N_("HRD-timing information")
 #define TUNE_TEXT N_("Default tune setting used" )
 #define PRESET_TEXT N_("Default preset setting used" )
@@ -649,6 +655,10 @@ vlc_module_begin ()
                  LOOKAHEAD_LONGTEXT )
         change_integer_range( 0, 60 )
 
+    add_integer( SOUT_CFG_PREFIX "latency", 0, LATENCY_TEXT,
+                 LATENCY_LONGTEXT )
+        change_integer_range( 0, 10000 )
+
     add_bool( SOUT_CFG_PREFIX "intra-refresh", false, INTRAREFRESH_TEXT,
               INTRAREFRESH_LONGTEXT )
 
@@ -735,7 +745,7 @@ static const char *const ppsz_sout_options[] = {
     "aq-mode", "aq-strength", "psy-rd", "psy", "profile", "lookahead", "slices",
     "slice-max-size", "slice-max-mbs", "intra-refresh", "mbtree", "hrd",
     "tune","preset", "opengop", "bluray-compat", "frame-packing", "options",
-    "fullrange",
+    "fullrange", "latency",
     NULL
 };
 
@@ -750,8 +760,57 @@ typedef struct
     int             i_sei_size;
     uint32_t         i_colorspace;
     uint8_t         *p_sei;
+
+    vlc_decoder_threads *threads;
 } encoder_sys_t;
 
+/*****************************************************************************
+ * SetupLatency: fit the encoder delay within a latency target
+ *****************************************************************************/
+static void SetupLatency( encoder_t *p_enc, x264_param_t *param,
+                          unsigned i_latency, unsigned i_threads )
+{
+    unsigned i_fps_num = param->i_fps_num, i_fps_den = param->i_fps_den;
+    if( i_fps_num == 0 || i_fps_den == 0 )
+    {
+        i_fps_num = 25;
+        i_fps_den = 1;
+    }
+
+    /* Frames that the encoder may hold back */
+    unsigned i_frames = (uint64_t)i_latency * i_fps_num / (1000 * i_fps_den);
+
+    /* Each frame thread delays the output by one frame: past half of the
+     * target, the threads encode slices of the same frame instead. */
+    unsigned i_frame_threads = __MIN( i_threads, __MAX( i_frames / 2, 1 ) );
+    param->i_threads = i_threads;
+    param->b_sliced_threads = i_frame_threads < i_threads;
+    if( param->b_sliced_threads )
+        i_frame_threads = 1;
+
+    unsigned i_left = i_frames - __MIN( i_frames, i_frame_threads - 1 );
+    param->i_bframe = __MIN( param->i_bframe, (int)i_left / 4 );
+    i_left -= param->i_bframe;
+    param->rc.i_lookahead = __MIN( param->rc.i_lookahead, (int)i_left );
+    param->i_sync_lookahead = 0;
+    if( param->rc.i_lookahead == 0 )
+        param->rc.b_mb_tree = false;
+
+    /* The VBV buffer delays the decoder by its duration at the bitrate */
+    if( param->rc.i_bitrate > 0 && param->rc.i_vbv_buffer_size == 0 )
+    {
+        param->rc.i_vbv_buffer_size = (uint64_t)param->rc.i_bitrate
+                                    * i_latency / 1000;
+        if( param->rc.i_vbv_max_bitrate == 0 )
+            param->rc.i_vbv_max_bitrate = param->rc.i_bitrate;
+    }
+
+    msg_Dbg( p_enc, "latency %ums: %u %s threads, %d B-frames, "
+             "lookahead %d, VBV %d kbit", i_latency, i_threads,
+             param->b_sliced_threads ? "slice" : "frame", param->i_bframe,
+             param->rc.i_lookahead, param->rc.i_vbv_buffer_size );
+}
+
 /*****************************************************************************
  * Open: probe the encoder
  *****************************************************************************/
@@ -850,6 +909,7 @@ static int  Open ( vlc_object_t *p_this )
     p_sys->psz_stat_name = NULL;
     p_sys->i_sei_size = 0;
     p_sys->p_sei = NULL;
+    p_sys->threads = NULL;
 
     char *psz_preset = var_GetString( p_enc, SOUT_CFG_PREFIX  "preset" );
     char *psz_tune = var_GetString( p_enc, SOUT_CFG_PREFIX  "tune" );
@@ -1302,8 +1362,16 @@ static int  Open ( vlc_object_t *p_this )
        also adds support for threads = 0 for automatically selecting an optimal
        value (cores * 1.5) based on detected CPUs. Default behavior for x264 is
        threads = 1, however VLC usage differs and uses threads = 0 (auto) by
-       default unless ofcourse transcode threads is explicitly specified.. */
+       default unless ofcourse transcode threads is explicitly specified..
+       In auto mode, the threads are taken from the budget shared with the
+       other encoders and decoders of the process. */
     p_sys->param.i_threads = p_enc->i_threads;
+    if( p_enc->i_threads == 0 )
+    {
+        p_sys->threads = vlc_encoder_threads_Acquire( p_enc, 0 );
+        if( p_sys->threads != NULL )
+            p_sys->param.i_threads = vlc_decoder_threads_Count( p_sys->threads );
+    }
 
     psz_val = var_GetString( p_enc, SOUT_CFG_PREFIX "stats" );
     if( psz_val )
@@ -1327,6 +1395,15 @@ static int  Open ( vlc_object_t *p_this )
     if( i_val != 40 )
         p_sys->param.rc.i_lookahead = i_val;
 
+    i_val = var_GetInteger( p_enc, SOUT_CFG_PREFIX "latency" );
+    if( i_val > 0 )
+    {
+        unsigned i_threads = p_sys->param.i_threads;
+        if( i_threads == 0 )
+            i_threads = vlc_GetCPUCount();
+        SetupLatency( p_enc, &p_sys->param, i_val, i_threads );
+    }
+
     /* We don't want repeated headers, we repeat p_extra ourself if needed */
     p_sys->param.b_repeat_headers = 0;
 
@@ -1523,4 +1600,7 @@ static void Close( vlc_object_t *p_this )
         msg_Dbg( p_enc, "framecount still in libx264 buffer: %d", x264_encoder_delayed_frames( p_sys->h ) );
         x264_encoder_close( p_sys->h );
     }
+
+    if( p_sys->threads )
+        vlc_decoder_threads_Release( p_sys->threads );
 }
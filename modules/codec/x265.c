@@ -55,6 +55,8 @@ typedef struct
     x265_encoder    *h;
     x265_param      param;
 
+    vlc_decoder_threads *threads;
+
     unsigned        frame_count;
     vlc_tick_t      initial_date;
 #ifndef NDEBUG
@@ -153,7 +155,10 @@ static int  Open (vlc_object_t *p_this)
     x265_param *param = &p_sys->param;
     x265_param_default(param);
 
-    param->frameNumThreads = vlc_GetCPUCount();
+    /* x265 supports at most 16 frame threads */
+    p_sys->threads = vlc_encoder_threads_Acquire(p_enc, 16);
+    param->frameNumThreads = p_sys->threads
+        ? vlc_decoder_threads_Count(p_sys->threads) : vlc_GetCPUCount();
     param->bEnableWavefront = 0; // buggy in x265, use frame threading for now
     param->maxCUSize = 16; /* use smaller macroblock */
 
@@ -178,11 +183,15 @@ static int  Open (vlc_object_t *p_this)
     if (param->sourceWidth & (param->maxCUSize - 1)) {
         msg_Err(p_enc, "Width (%d) must be a multiple of %d",
             param->sourceWidth, param->maxCUSize);
+        if (p_sys->threads)
+            vlc_decoder_threads_Release(p_sys->threads);
         free(p_sys);
         return VLC_EGENERIC;
     }
     if (param->sourceHeight & 7) {
         msg_Err(p_enc, "Height (%d) must be a multiple of 8", param->sourceHeight);
+        if (p_sys->threads)
+            vlc_decoder_threads_Release(p_sys->threads);
         free(p_sys);
         return VLC_EGENERIC;
     }
@@ -195,6 +204,8 @@ static int  Open (vlc_object_t *p_this)
     p_sys->h = x265_encoder_open(param);
     if (p_sys->h == NULL) {
         msg_Err(p_enc, "cannot open x265 encoder");
+        if (p_sys->threads)
+            vlc_decoder_threads_Release(p_sys->threads);
         free(p_sys);
         return VLC_EGENERIC;
     }
@@ -240,5 +251,7 @@ static void Close(vlc_object_t *p_this)
 
     x265_encoder_close(p_sys->h);
 
+    if (p_sys->threads)
+        vlc_decoder_threads_Release(p_sys->threads);
     free(p_sys);
 }
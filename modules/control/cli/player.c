@@ -916,6 +916,8 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_late_pictures);
         cli_printf(cl, _("| frames lost      :    %5"PRIi64),
                    item->p_stats->i_lost_pictures);
+        cli_printf(cl, _("| vsyncs missed    :    %5"PRIi64),
+                   item->p_stats->i_missed_vsyncs);
         cli_printf(cl, "|");
 
         /* Audio*/
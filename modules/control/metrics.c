@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * metrics.c: OpenMetrics exporter interface
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_interface.h>
+#include <vlc_httpd.h>
+#include <vlc_metrics.h>
+
+#define METRICS_URL "/metrics"
+#define METRICS_MIME "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+struct intf_sys_t
+{
+    httpd_host_t *host;
+    httpd_file_t *file;
+};
+
+static int Fill(httpd_file_sys_t *opaque, httpd_file_t *file,
+                uint8_t *request, uint8_t **data, int *len)
+{
+    intf_thread_t *intf = (intf_thread_t *)opaque;
+    char *text = vlc_metrics_Format(intf);
+
+    VLC_UNUSED(file); VLC_UNUSED(request);
+
+    /* the body is freed by the HTTP server */
+    *data = (uint8_t *)text;
+    *len = text != NULL ? strlen(text) : 0;
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+
+    if (!var_InheritBool(intf, "metrics"))
+        msg_Warn(intf, "metrics are disabled, use --metrics to collect them");
+
+    intf_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->host = vlc_http_HostNew(obj);
+    if (sys->host == NULL)
+        goto error;
+
+    sys->file = httpd_FileNew(sys->host, METRICS_URL, METRICS_MIME, NULL, NULL,
+                              Fill, (httpd_file_sys_t *)intf);
+    if (sys->file == NULL)
+    {
+        httpd_HostDelete(sys->host);
+        goto error;
+    }
+
+    intf->p_sys = sys;
+    return VLC_SUCCESS;
+
+error:
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+    intf_sys_t *sys = intf->p_sys;
+
+    httpd_FileDelete(sys->file);
+    httpd_HostDelete(sys->host);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_shortname(N_("Metrics"))
+    set_description(N_("OpenMetrics exporter"))
+    set_help(N_("Serves the performance metrics on " METRICS_URL
+                " of the HTTP server, for Prometheus or any OpenMetrics "
+                "scraper. The metrics must be enabled with --metrics."))
+    set_category(CAT_INTERFACE)
+    set_subcategory(SUBCAT_INTERFACE_CONTROL)
+    set_capability("interface", 0)
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/HybridAdaptationLogic.hpp"
 #include "logic/BufferingLogic.hpp"
 #include "tools/Debug.hpp"
 #ifdef ADAPTIVE_DEBUGGING_LOGIC
@@ -85,7 +86,9 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     cached.playlistStart = 0;
     cached.playlistEnd = 0;
     cached.playlistLength = 0;
+    cached.latency = 0;
     cached.lastupdate = 0;
+    rateAdjust = 1.f;
 }
 
 PlaylistManager::~PlaylistManager   ()
@@ -456,6 +459,7 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
     AbstractStream::Status status = dequeue(demux.i_nzpcr, &i_nzbarrier);
 
     updateControlsPosition();
+    updateLatencyControl();
 
     switch(status)
     {
@@ -636,7 +640,10 @@ int PlaylistManager::doControl(int i_query, va_list args)
         }
 
         case DEMUX_GET_PTS_DELAY:
-            *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
+            if(bufferingLogic && bufferingLogic->isLowLatency(playlist))
+                *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_MS(300);
+            else
+                *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
             break;
 
         default:
@@ -723,13 +730,15 @@ void PlaylistManager::updateControlsPosition()
 
     vlc_tick_t rapPlaylistStart = 0;
     vlc_tick_t rapDemuxStart = 0;
+    bool b_rap = false;
     for(AbstractStream* st : streams)
     {
         if(st->isValid() && !st->isDisabled() && st->isSelected())
         {
-            if(st->getMediaPlaybackTimes(&cached.playlistStart, &cached.playlistEnd,
-                                         &cached.playlistLength,
-                                         &rapPlaylistStart, &rapDemuxStart))
+            b_rap = st->getMediaPlaybackTimes(&cached.playlistStart, &cached.playlistEnd,
+                                              &cached.playlistLength,
+                                              &rapPlaylistStart, &rapDemuxStart);
+            if(b_rap)
                 break;
         }
     }
@@ -762,6 +771,15 @@ void PlaylistManager::updateControlsPosition()
            the above description */
         cached.i_time = currentDemuxTime;
 
+        /* Distance to the edge, in playlist time */
+        cached.latency = 0;
+        if(b_rap && currentDemuxTime != VLC_TICK_INVALID && cached.playlistStart >= 0)
+        {
+            vlc_tick_t absPlaylistTime = rapPlaylistStart + currentDemuxTime - rapDemuxStart;
+            if(cached.playlistEnd > absPlaylistTime)
+                cached.latency = cached.playlistEnd - absPlaylistTime;
+        }
+
         if(cached.playlistStart != cached.playlistEnd)
         {
             if(cached.playlistStart < 0) /* Live template. Range start = now() - buffering depth */
@@ -805,6 +823,35 @@ void PlaylistManager::updateControlsPosition()
                cached.i_time, currentDemuxTime, rapPlaylistStart, rapDemuxStart));
 }
 
+void PlaylistManager::updateLatencyControl()
+{
+    /* Speeds up playback while too far from the live edge */
+    const float catchupRate = 1.05f;
+    const vlc_tick_t tolerance = VLC_TICK_FROM_MS(500);
+
+    if(!bufferingLogic->isLowLatency(playlist))
+        return;
+
+    vlc_mutex_lock(&cached.lock);
+    const vlc_tick_t latency = cached.b_live ? cached.latency : 0;
+    vlc_mutex_unlock(&cached.lock);
+
+    const vlc_tick_t target = bufferingLogic->getLiveDelay(playlist);
+    float rate = rateAdjust;
+    if(latency == 0 || latency <= target)
+        rate = 1.f;
+    else if(latency > target + tolerance)
+        rate = catchupRate;
+
+    if(rate != rateAdjust &&
+       es_out_ControlSetRateAdjust(p_demux->out, rate) == VLC_SUCCESS)
+    {
+        msg_Dbg(p_demux, "Latency %" PRId64 "ms, target %" PRId64 "ms, rate x%.2f",
+                MS_FROM_VLC_TICK(latency), MS_FROM_VLC_TICK(target), rate);
+        rateAdjust = rate;
+    }
+}
+
 AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::LogicType type, AbstractConnectionManager *conn)
 {
     vlc_object_t *obj = VLC_OBJECT(p_demux);
@@ -847,6 +894,15 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = noplogic;
             break;
         }
+        case AbstractAdaptationLogic::LogicType::Hybrid:
+        {
+            HybridAdaptationLogic *hybridlogic =
+                    new (std::nothrow) HybridAdaptationLogic(obj);
+            if(hybridlogic)
+                conn->setDownloadRateObserver(hybridlogic);
+            logic = hybridlogic;
+            break;
+        }
         case AbstractAdaptationLogic::LogicType::Predictive:
         {
             AbstractAdaptationLogic *predictivelogic =
@@ -891,6 +947,9 @@ AbstractBufferingLogic *PlaylistManager::createBufferingLogic() const
         v = var_InheritInteger(p_demux, "adaptive-maxbuffer");
         if(v)
             bl->setUserMaxBuffering(VLC_TICK_FROM_MS(v));
+        v = var_InheritInteger(p_demux, "adaptive-prefetch");
+        if(v)
+            bl->setUserPrefetchDepth(v);
     }
     return bl;
 }
@@ -90,6 +90,7 @@ namespace adaptive
             void unsetPeriod();
 
             void updateControlsPosition();
+            void updateLatencyControl();
 
             /* local factories */
             virtual AbstractAdaptationLogic *createLogic(AbstractAdaptationLogic::LogicType,
@@ -136,9 +137,12 @@ namespace adaptive
                 vlc_tick_t  playlistStart;
                 vlc_tick_t  playlistEnd;
                 vlc_tick_t  playlistLength;
+                vlc_tick_t  latency; /* from the live edge, 0 if unknown */
                 time_t      lastupdate;
             } cached;
 
+            float                                rateAdjust; /* live catch-up */
+
         private:
             void setBufferingRunState(bool);
             void Run();
@@ -412,11 +412,43 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
         notify(DiscontinuityEvent());
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks(switch_allowed, connManager);
+    }
 
     return returnedChunk;
 }
 
+void SegmentTracker::prefetchChunks(bool switch_allowed,
+                                    AbstractConnectionManager *connManager)
+{
+    /* Only pipeline media segments, init and index are sequential */
+    if(!next.isValid() || !next.init_sent || !next.index_sent)
+        return;
+
+    const unsigned depth = bufferingLogic->getPrefetchDepth(adaptationSet->getPlaylist());
+    /* the chunk being returned counts as the first one */
+    while(chunkssequence.size() + 1 < depth)
+    {
+        Position pos = next;
+        if(!chunkssequence.empty())
+        {
+            pos = chunkssequence.back().pos;
+            ++pos;
+        }
+
+        ChunkEntry chunk = prepareChunk(switch_allowed, pos, connManager);
+        if(!chunk.isValid())
+        {
+            /* not available yet, will retry on next chunk */
+            delete chunk.chunk;
+            break;
+        }
+        chunkssequence.push_back(chunk);
+    }
+}
+
 bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool tryonly)
 {
     Position pos = Position(current.rep, current.number);
@@ -218,6 +218,7 @@ namespace adaptive
             ChunkEntry prepareChunk(bool switch_allowed, Position pos,
                                     AbstractConnectionManager *connManager) const;
             void resetChunksSequence();
+            void prefetchChunks(bool switch_allowed, AbstractConnectionManager *);
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
             bool first;
@@ -25,9 +25,14 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/ChunkCache.hpp"
 #include "encryption/Keyring.hpp"
+#include "logic/BufferingLogic.hpp"
+
+#include <algorithm>
 
 using namespace adaptive;
+using namespace adaptive::logic;
 
 SharedResources::SharedResources(AuthStorage *auth, Keyring *ring,
                                  AbstractConnectionManager *conn)
@@ -64,10 +69,17 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
 {
     AuthStorage *auth = new AuthStorage(obj);
     Keyring *keyring = new Keyring(obj);
-    HTTPConnectionManager *m = new HTTPConnectionManager(obj);
+    /* one transfer per prefetched segment */
+    int64_t depth = var_InheritInteger(obj, "adaptive-prefetch");
+    depth = std::min(std::max(depth, INT64_C(1)),
+                     (int64_t) AbstractBufferingLogic::MAX_PREFETCH_DEPTH);
+    HTTPConnectionManager *m = new HTTPConnectionManager(obj, depth);
     if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
         m->addFactory(new LibVLCHTTPConnectionFactory(auth));
     m->addFactory(new StreamUrlConnectionFactory());
+    int64_t cachesize = var_InheritInteger(obj, "adaptive-cache-size");
+    if(cachesize > 0)
+        m->setChunkCache(ChunkCache::acquire(cachesize * 1024 * 1024));
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
@@ -82,6 +82,15 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
+#define ADAPT_CACHE_TEXT N_("Segments cache size (MiB)")
+#define ADAPT_CACHE_LONGTEXT N_("Keeps downloaded segments in memory for " \
+    "seeking back, and shares them between the playlists opened at the " \
+    "same time (0 to disable)")
+
+#define ADAPT_PREFETCH_TEXT N_("Segments prefetch depth")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of segments of each stream " \
+    "downloaded at the same time, each over its own connection")
+
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
@@ -89,6 +98,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
                                 AbstractAdaptationLogic::LogicType::NearOptimal,
+                                AbstractAdaptationLogic::LogicType::Hybrid,
                                 AbstractAdaptationLogic::LogicType::RateBased,
                                 AbstractAdaptationLogic::LogicType::FixedRate,
                                 AbstractAdaptationLogic::LogicType::AlwaysLowest,
@@ -98,6 +108,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "hybrid",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -106,6 +117,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Throughput and Buffer Hybrid"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -145,6 +157,11 @@ vlc_module_begin ()
                      ADAPT_MAXBUFFER_TEXT, nullptr );
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT );
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer( "adaptive-cache-size", 0, ADAPT_CACHE_TEXT, ADAPT_CACHE_LONGTEXT )
+        add_integer_with_range( "adaptive-prefetch",
+                                AbstractBufferingLogic::DEFAULT_PREFETCH_DEPTH,
+                                1, AbstractBufferingLogic::MAX_PREFETCH_DEPTH,
+                                ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
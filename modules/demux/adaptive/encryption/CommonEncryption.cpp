@@ -26,7 +26,7 @@
 #include "Keyring.hpp"
 #include "../SharedResources.hpp"
 
-#include <vlc_common.h>
+#include <cstring>
 
 #ifdef HAVE_GCRYPT
  #include <gcrypt.h>
@@ -67,6 +67,7 @@ bool CommonEncryptionSession::start(SharedResources *res, const CommonEncryption
 {
     if(ctx)
         close();
+    pending.clear();
     encryption = enc;
 #ifndef HAVE_GCRYPT
     /* We don't use the SharedResources */
@@ -106,42 +107,66 @@ void CommonEncryptionSession::close()
         gcry_cipher_close(handle);
     ctx = nullptr;
 #endif
+    pending.clear();
 }
 
-size_t CommonEncryptionSession::decrypt(void *inputdata, size_t inputbytes, bool last)
+block_t * CommonEncryptionSession::decrypt(block_t *p_block, bool last)
 {
 #ifndef HAVE_GCRYPT
-    VLC_UNUSED(inputdata);
     VLC_UNUSED(last);
 #else
     gcry_cipher_hd_t handle = reinterpret_cast<gcry_cipher_hd_t>(ctx);
     if(encryption.method == CommonEncryption::Method::AES_128 && ctx)
     {
-        if ((inputbytes % 16) != 0 || inputbytes < 16 ||
-            gcry_cipher_decrypt(handle, inputdata, inputbytes, nullptr, 0))
+        /* Downloads are not aligned on the cipher blocks: the bytes held
+         * back from the previous buffer go in front of this one */
+        if(!pending.empty())
+        {
+            p_block = block_Realloc(p_block, pending.size(), p_block->i_buffer);
+            if(!p_block)
+                return nullptr;
+            memcpy(p_block->p_buffer, &pending[0], pending.size());
+            pending.clear();
+        }
+
+        /* Decrypt the whole buffer in one go, but keep the last cipher
+         * block until the end is known, as it carries the padding */
+        size_t inputbytes = p_block->i_buffer & ~(size_t)15;
+        if(!last)
+        {
+            if(inputbytes == p_block->i_buffer && inputbytes > 0)
+                inputbytes -= 16;
+            pending.assign(p_block->p_buffer + inputbytes,
+                           p_block->p_buffer + p_block->i_buffer);
+        }
+
+        uint8_t *inputdata = p_block->p_buffer;
+        if(inputbytes > 0 &&
+           gcry_cipher_decrypt(handle, inputdata, inputbytes, nullptr, 0))
         {
             inputbytes = 0;
         }
-        else if(last)
+        else if(last && inputbytes > 0)
         {
             /* last bytes */
             /* remove the PKCS#7 padding from the buffer */
-            const uint8_t pad = reinterpret_cast<uint8_t *>(inputdata)[inputbytes - 1];
+            const uint8_t pad = inputdata[inputbytes - 1];
             for(uint8_t i=0; i<pad && i<16; i++)
             {
-                if(reinterpret_cast<uint8_t *>(inputdata)[inputbytes - i - 1] != pad)
+                if(inputdata[inputbytes - i - 1] != pad)
                     break;
                 if(i+1==pad)
                     inputbytes -= pad;
             }
         }
+        p_block->i_buffer = inputbytes;
     }
     else
 #endif
     if(encryption.method != CommonEncryption::Method::None)
     {
-        inputbytes = 0;
+        p_block->i_buffer = 0;
     }
 
-    return inputbytes;
+    return p_block;
 }
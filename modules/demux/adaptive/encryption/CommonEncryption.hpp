@@ -20,6 +20,9 @@
 #ifndef COMMONENCRYPTION_H
 #define COMMONENCRYPTION_H
 
+#include <vlc_common.h>
+#include <vlc_block.h>
+
 #include <vector>
 #include <string>
 
@@ -52,10 +55,11 @@ namespace adaptive
 
                 bool start(SharedResources *, const CommonEncryption &);
                 void close();
-                size_t decrypt(void *, size_t, bool);
+                block_t * decrypt(block_t *, bool);
 
             private:
                 std::vector<unsigned char> key;
+                std::vector<unsigned char> pending;
                 CommonEncryption encryption;
                 void *ctx;
         };
@@ -119,7 +119,8 @@ block_t * AbstractChunk::doRead(size_t size, bool b_block)
             block->i_flags |= BLOCK_FLAG_HEADER;
         bytesRead += block->i_buffer;
         onDownload(&block);
-        block->i_flags &= ~BLOCK_FLAG_HEADER;
+        if(block)
+            block->i_flags &= ~BLOCK_FLAG_HEADER;
     }
 
     return block;
@@ -261,6 +262,12 @@ std::string HTTPChunkSource::getContentType() const
         return std::string();
 }
 
+std::string HTTPChunkSource::getUrl() const
+{
+    mutex_locker locker {lock};
+    return params.getUrl();
+}
+
 bool HTTPChunkSource::prepare()
 {
     if(prepared)
@@ -320,11 +327,17 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     HTTPChunkSource(url, manager, sourceid, type, range, access),
     p_head     (nullptr),
     pp_tail    (&p_head),
-    buffered     (0)
+    buffered     (0),
+    p_kept     (nullptr),
+    pp_kepttail(&p_kept)
 {
     done = false;
     eof = false;
     held = false;
+    keep = false;
+    complete = false;
+    transferReported.size = 0;
+    transferReported.time = 0;
 }
 
 HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
@@ -344,6 +357,9 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
         pp_tail = &p_head;
     }
     buffered = 0;
+
+    if(p_kept)
+        block_ChainRelease(p_kept);
 }
 
 bool HTTPChunkBufferedSource::isDone() const
@@ -365,6 +381,23 @@ void HTTPChunkBufferedSource::release()
     avail.signal();
 }
 
+void HTTPChunkBufferedSource::keepData()
+{
+    mutex_locker locker {lock};
+    keep = true;
+}
+
+block_t * HTTPChunkBufferedSource::takeKeptData()
+{
+    mutex_locker locker {lock};
+    if(!done || !complete)
+        return nullptr;
+    block_t *p_data = p_kept;
+    p_kept = nullptr;
+    pp_kepttail = &p_kept;
+    return p_data;
+}
+
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
@@ -398,13 +431,23 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t latency;
     } rate = {0,0,0};
 
+    struct
+    {
+        size_t size;
+        vlc_tick_t time;
+    } transfer = {0,0};
+
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    const size_t activeBytes = connection->getActiveBytesRead();
+    const vlc_tick_t activeTime = connection->getActiveTime();
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
         mutex_locker locker {lock};
         done = true;
+        complete = keep && ret == 0 &&
+                   (!contentLength || buffered + consumed == contentLength);
         downloadEndTime = vlc_tick_now();
         rate.size = buffered + consumed;
         rate.time = downloadEndTime - requestStartTime;
@@ -415,10 +458,20 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         p_block->i_buffer = (size_t) ret;
         mutex_locker locker {lock};
         buffered += p_block->i_buffer;
+        if(keep)
+        {
+            block_t *p_copy = block_Duplicate(p_block);
+            if(p_copy)
+                block_ChainLastAppend(&pp_kepttail, p_copy);
+            else
+                keep = false;
+        }
         block_ChainLastAppend(&pp_tail, p_block);
         if((size_t) ret < readsize)
         {
             done = true;
+            complete = keep &&
+                       (!contentLength || buffered + consumed == contentLength);
             downloadEndTime = vlc_tick_now();
             rate.size = buffered + consumed;
             rate.time = downloadEndTime - requestStartTime;
@@ -426,12 +479,33 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         }
     }
 
+    {
+        mutex_locker locker {lock};
+        if(activeBytes >= transferReported.size + TRANSFER_SAMPLE_SIZE ||
+           (done && activeBytes > transferReported.size))
+        {
+            transfer.size = activeBytes - transferReported.size;
+            transfer.time = activeTime - transferReported.time;
+            transferReported.size = activeBytes;
+            transferReported.time = activeTime;
+        }
+        else if(done && transferReported.size == 0)
+        {
+            /* not measured by the connection */
+            transfer.size = rate.size;
+            transfer.time = downloadEndTime - responseTime;
+        }
+    }
+
     if(rate.size && rate.time && type == ChunkType::Segment)
     {
         connManager->updateDownloadRate(sourceid, rate.size,
                                         rate.time, rate.latency);
     }
 
+    if(transfer.size && transfer.time > 0 && type == ChunkType::Segment)
+        connManager->updateTransferRate(sourceid, transfer.size, transfer.time);
+
     avail.signal();
 }
 
@@ -519,6 +593,74 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
     return p_block;
 }
 
+CachedChunkSource::CachedChunkSource(AbstractConnectionManager *manager,
+                                     ChunkType t, const BytesRange &range,
+                                     block_t *p_block, const std::string &ctype)
+    : AbstractChunkSource(t, range)
+{
+    connManager = manager;
+    p_data = p_block;
+    consumed = 0;
+    contentLength = p_data->i_buffer;
+    contentType = ctype;
+}
+
+CachedChunkSource::~CachedChunkSource()
+{
+    if(p_data)
+        block_Release(p_data);
+}
+
+block_t * CachedChunkSource::readBlock()
+{
+    if(consumed == 0 && p_data)
+    {
+        /* Hand over the whole chunk */
+        block_t *p_block = p_data;
+        p_data = nullptr;
+        consumed = contentLength;
+        return p_block;
+    }
+    return read(HTTPChunkSource::CHUNK_SIZE);
+}
+
+block_t * CachedChunkSource::read(size_t size)
+{
+    if(!p_data || consumed >= contentLength)
+        return nullptr;
+
+    if(size > contentLength - consumed)
+        size = contentLength - consumed;
+
+    block_t *p_block = block_Alloc(size);
+    if(p_block)
+    {
+        memcpy(p_block->p_buffer, &p_data->p_buffer[consumed], size);
+        consumed += size;
+    }
+    return p_block;
+}
+
+bool CachedChunkSource::hasMoreData() const
+{
+    return consumed < contentLength;
+}
+
+size_t CachedChunkSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string CachedChunkSource::getContentType() const
+{
+    return contentType;
+}
+
+void CachedChunkSource::recycle()
+{
+    connManager->recycleSource(this);
+}
+
 HTTPChunk::HTTPChunk(const std::string &url, AbstractConnectionManager *manager,
                      const adaptive::ID &id, ChunkType type, const BytesRange &range):
     AbstractChunk(manager->makeSource(url, id, type, range))
@@ -123,6 +123,7 @@ namespace adaptive
                 virtual size_t      getBytesRead    () const  override;
                 virtual std::string getContentType  () const  override;
                 virtual void        recycle() override;
+                std::string         getUrl          () const;
 
                 static const size_t CHUNK_SIZE = 32768;
 
@@ -167,6 +168,8 @@ namespace adaptive
                 bool               isDone() const;
                 void               hold();
                 void               release();
+                void               keepData();
+                block_t *          takeKeptData();
 
             private:
                 block_t            *p_head; /* read cache buffer */
@@ -176,6 +179,42 @@ namespace adaptive
                 bool                eof;
                 vlc::threads::condition_variable avail;
                 bool                held;
+                block_t            *p_kept; /* copy of the whole download */
+                block_t           **pp_kepttail;
+                bool                keep;
+                bool                complete;
+                struct
+                {
+                    size_t size;
+                    vlc_tick_t time;
+                } transferReported; /* active transfer already sampled */
+                static const size_t TRANSFER_SAMPLE_SIZE = 16384;
+        };
+
+        class CachedChunkSource : public AbstractChunkSource
+        {
+            friend class AbstractConnectionManager;
+
+            public:
+                virtual ~CachedChunkSource();
+
+                virtual block_t *   readBlock       ()  override;
+                virtual block_t *   read            (size_t)  override;
+                virtual bool        hasMoreData     () const  override;
+                virtual size_t      getBytesRead    () const  override;
+                virtual std::string getContentType  () const  override;
+                virtual void        recycle() override;
+
+            protected:
+                CachedChunkSource(AbstractConnectionManager *, ChunkType,
+                                  const BytesRange &, block_t *,
+                                  const std::string &);
+
+            private:
+                AbstractConnectionManager *connManager;
+                block_t            *p_data;
+                size_t              consumed;
+                std::string         contentType;
         };
 
         class HTTPChunk : public AbstractChunk
@@ -0,0 +1,177 @@
+/*
+ * ChunkCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ChunkCache.hpp"
+
+#include <vlc_block.h>
+
+#include <cassert>
+#include <sstream>
+
+using namespace adaptive::http;
+using vlc::threads::mutex_locker;
+
+static vlc::threads::mutex shared_lock;
+static ChunkCache *shared_cache = nullptr;
+
+ChunkCache::ChunkCache(size_t maxsize_)
+{
+    size = 0;
+    maxsize = maxsize_;
+    stats = {0, 0, 0};
+    refs = 0;
+}
+
+ChunkCache::~ChunkCache()
+{
+    for(Entry &entry : entries)
+        block_Release(entry.data);
+}
+
+ChunkCache * ChunkCache::acquire(size_t maxsize)
+{
+    mutex_locker locker {shared_lock};
+    if(shared_cache == nullptr)
+        shared_cache = new ChunkCache(maxsize);
+    else
+    {
+        mutex_locker cachelocker {shared_cache->lock};
+        if(shared_cache->maxsize < maxsize)
+            shared_cache->maxsize = maxsize;
+    }
+    shared_cache->refs++;
+    return shared_cache;
+}
+
+void ChunkCache::release(ChunkCache *cache)
+{
+    mutex_locker locker {shared_lock};
+    assert(cache == shared_cache);
+    if(--cache->refs == 0)
+    {
+        delete cache;
+        shared_cache = nullptr;
+    }
+}
+
+std::string ChunkCache::makeKey(const std::string &url, const BytesRange &range)
+{
+    /* The fragment is never sent to the server */
+    std::string key = url.substr(0, url.find('#'));
+    if(range.isValid())
+    {
+        std::ostringstream os;
+        os.imbue(std::locale("C"));
+        os << " " << range.getStartByte() << "-" << range.getEndByte();
+        key += os.str();
+    }
+    return key;
+}
+
+block_t * ChunkCache::get(const std::string &url, const BytesRange &range,
+                          std::string *contentType)
+{
+    const std::string key = makeKey(url, range);
+
+    mutex_locker locker {lock};
+    auto it = index.find(key);
+    if(it == index.end())
+    {
+        stats.misses++;
+        return nullptr;
+    }
+
+    block_t *p_block = block_Duplicate(it->second->data);
+    if(p_block == nullptr)
+        return nullptr;
+
+    stats.hits++;
+    *contentType = it->second->contentType;
+    entries.splice(entries.begin(), entries, it->second);
+    return p_block;
+}
+
+void ChunkCache::put(const std::string &url, const BytesRange &range,
+                     const std::string &contentType, block_t *p_data)
+{
+    p_data = block_ChainGather(p_data);
+    if(p_data == nullptr)
+        return;
+
+    mutex_locker locker {lock};
+    if(p_data->i_buffer > maxsize)
+    {
+        block_Release(p_data);
+        return;
+    }
+
+    const std::string key = makeKey(url, range);
+    auto it = index.find(key);
+    if(it != index.end())
+    {
+        /* Downloaded concurrently by another session */
+        block_Release(p_data);
+        return;
+    }
+
+    evict(maxsize - p_data->i_buffer);
+
+    Entry entry;
+    entry.key = key;
+    entry.contentType = contentType;
+    entry.data = p_data;
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    size += p_data->i_buffer;
+}
+
+void ChunkCache::evict(size_t target)
+{
+    while(size > target && !entries.empty())
+    {
+        Entry &entry = entries.back();
+        size -= entry.data->i_buffer;
+        block_Release(entry.data);
+        index.erase(entry.key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+}
+
+ChunkCache::Stats ChunkCache::getStats() const
+{
+    mutex_locker locker {lock};
+    return stats;
+}
+
+size_t ChunkCache::getSize() const
+{
+    mutex_locker locker {lock};
+    return size;
+}
+
+size_t ChunkCache::getMaxSize() const
+{
+    mutex_locker locker {lock};
+    return maxsize;
+}
@@ -0,0 +1,88 @@
+/*
+ * ChunkCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef CHUNKCACHE_HPP_
+#define CHUNKCACHE_HPP_
+
+#include "BytesRange.hpp"
+
+#include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+typedef struct block_t block_t;
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Size bounded LRU storage of downloaded chunks, keyed by URL and
+         * byte range. A single instance is shared by all the playlists
+         * of the process, see acquire(). */
+        class ChunkCache
+        {
+            public:
+                ChunkCache(size_t maxsize);
+                ~ChunkCache();
+
+                static ChunkCache * acquire(size_t maxsize);
+                static void release(ChunkCache *);
+
+                /* Returns a copy of the chunk data, or nullptr */
+                block_t * get(const std::string &, const BytesRange &,
+                              std::string *contentType);
+                /* Takes ownership of the data */
+                void put(const std::string &, const BytesRange &,
+                         const std::string &contentType, block_t *);
+
+                struct Stats
+                {
+                    uint64_t hits;
+                    uint64_t misses;
+                    uint64_t evictions;
+                };
+                Stats getStats() const;
+                size_t getSize() const;
+                size_t getMaxSize() const;
+
+            private:
+                struct Entry
+                {
+                    std::string key;
+                    std::string contentType;
+                    block_t *data;
+                };
+                static std::string makeKey(const std::string &, const BytesRange &);
+                void evict(size_t);
+
+                mutable vlc::threads::mutex lock;
+                std::list<Entry> entries; /* most recently used first */
+                std::unordered_map<std::string, std::list<Entry>::iterator> index;
+                size_t size;
+                size_t maxsize;
+                Stats stats;
+                unsigned refs;
+        };
+    }
+}
+
+#endif /* CHUNKCACHE_HPP_ */
@@ -29,23 +29,36 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Worker::Worker()
 {
-    killed = false;
+    downloader = nullptr;
     thread_handle_valid = false;
-    current = nullptr;
     cancel_current = false;
+    current = nullptr;
+}
+
+Downloader::Downloader(unsigned count)
+    : workers(count ? count : 1)
+{
+    killed = false;
+    for(Worker &w : workers)
+        w.downloader = this;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    for(Worker &w : workers)
     {
-        return false;
+        if(w.thread_handle_valid)
+            continue;
+        if(vlc_clone(&w.thread_handle, downloaderThread,
+                     static_cast<void *>(&w), VLC_THREAD_PRIORITY_INPUT))
+        {
+            /* keep going with the transfers we could start */
+            return workers.front().thread_handle_valid;
+        }
+        w.thread_handle_valid = true;
     }
-    thread_handle_valid = true;
     return true;
 }
 
@@ -53,15 +66,16 @@ Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(Worker &w : workers)
+        if(w.thread_handle_valid)
+            vlc_join(w.thread_handle, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -75,9 +89,10 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    Worker *w;
+    while ((w = getWorker(source)))
     {
-        cancel_current = true;
+        w->cancel_current = true;
         updated_cond.wait(lock);
     }
 
@@ -88,20 +103,43 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+Downloader::Worker * Downloader::getWorker(const HTTPChunkBufferedSource *source)
+{
+    for(Worker &w : workers)
+        if(w.current == source)
+            return &w;
+    return nullptr;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextQueued() const
+{
+    /* oldest chunk no other worker is already downloading */
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        bool b_busy = false;
+        for(const Worker &w : workers)
+            b_busy |= (w.current == source);
+        if(!b_busy)
+            return source;
+    }
+    return nullptr;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
-    Downloader *instance = static_cast<Downloader *>(opaque);
-    instance->Run();
+    Worker *w = static_cast<Worker *>(opaque);
+    w->downloader->Run(w);
     return nullptr;
 }
 
-void Downloader::Run()
+void Downloader::Run(Worker *w)
 {
     while(1)
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source;
+        while(!(source = getNextQueued()) && !killed)
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +148,18 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
+        w->current = source;
         lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone() || cancel_current)
+        if(source->isDone() || w->cancel_current)
         {
-            chunks.pop_front();
-            current->release();
+            chunks.remove(source);
+            source->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+        w->cancel_current = false;
+        w->current = nullptr;
+        updated_cond.broadcast();
         lock.unlock();
     }
 }
@@ -25,6 +25,7 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -35,25 +36,35 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
 
             private:
+                /* one per concurrent transfer */
+                class Worker
+                {
+                    public:
+                        Worker();
+                        Downloader  *downloader;
+                        vlc_thread_t thread_handle;
+                        bool         thread_handle_valid;
+                        bool         cancel_current;
+                        HTTPChunkBufferedSource *current;
+                };
                 static void * downloaderThread(void *);
-                void Run();
+                void Run(Worker *);
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextQueued() const;
+                Worker * getWorker(const HTTPChunkBufferedSource *);
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::vector<Worker> workers;
         };
 
     }
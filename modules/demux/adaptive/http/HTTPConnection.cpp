@@ -30,6 +30,8 @@
 #include <vlc_stream.h>
 #include <vlc_keystore.h>
 
+#include <algorithm>
+
 extern "C"
 {
     #include "../access/http/resource.h"
@@ -45,6 +47,8 @@ AbstractConnection::AbstractConnection(vlc_object_t *p_object_)
     p_object = p_object_;
     available = true;
     bytesRead = 0;
+    activeBytesRead = 0;
+    activeTime = 0;
     contentLength = 0;
 }
 
@@ -73,6 +77,16 @@ size_t AbstractConnection::getBytesRead() const
     return bytesRead;
 }
 
+size_t AbstractConnection::getActiveBytesRead() const
+{
+    return activeBytesRead;
+}
+
+vlc_tick_t AbstractConnection::getActiveTime() const
+{
+    return activeTime;
+}
+
 const std::string & AbstractConnection::getContentType() const
 {
     return contentType;
@@ -93,6 +107,7 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
             http_mgr = vlc_http_mgr_create(p_object, jar);
             http_res = nullptr;
             totalRead = 0;
+            resetActivity();
         }
         virtual ~LibVLCHTTPSource()
         {
@@ -103,11 +118,15 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
         {
             if(http_res == nullptr)
                 return nullptr;
+            vlc_tick_t start = vlc_tick_now();
             block_t *b = vlc_http_res_read(http_res);
             if(b == vlc_http_error)
                 return nullptr;
             if(b)
+            {
                 totalRead += b->i_buffer;
+                accountActivity(b->i_buffer, vlc_tick_now() - start);
+            }
             return b;
         }
         void reset()
@@ -117,6 +136,7 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
                 vlc_http_res_destroy(http_res);
                 http_res = nullptr;
                 totalRead = 0;
+                resetActivity();
             }
         }
 
@@ -183,20 +203,52 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
             return (*static_cast<LibVLCHTTPSource **>(opaque))->validateResponse(res, resp);
         }
 
+        /* The first block of a burst also carries the time the server had
+         * nothing to send (response latency, chunked transfer of content
+         * being produced): it is left out of the active transfer. A burst
+         * starts when the wait is much longer than for the previous blocks */
+        void accountActivity(size_t size, vlc_tick_t wait)
+        {
+            if(!burst)
+            {
+                burst = true;
+                return;
+            }
+            if(activeBlocks > 0 &&
+               wait > std::max(IDLE_MIN_WAIT, IDLE_WAIT_FACTOR * activeTime / activeBlocks))
+                return;
+            activeRead += size;
+            activeTime += wait;
+            activeBlocks++;
+        }
+        void resetActivity()
+        {
+            burst = false;
+            activeRead = 0;
+            activeTime = 0;
+            activeBlocks = 0;
+        }
+
         static const struct vlc_http_resource_cbs callbacks;
+        static constexpr vlc_tick_t IDLE_MIN_WAIT = VLC_TICK_FROM_MS(20);
+        static constexpr unsigned IDLE_WAIT_FACTOR = 4;
         size_t totalRead;
+        size_t activeRead;
+        vlc_tick_t activeTime;
+        unsigned activeBlocks;
+        bool burst;
         struct vlc_http_mgr *http_mgr;
         BytesRange range;
 
     public:
         struct vlc_http_resource *http_res;
-        int create(const char *uri,const std::string &ua,
+        int create(struct vlc_http_mgr *mgr, const char *uri, const std::string &ua,
                    const std::string &ref, const BytesRange &range)
         {
             struct restuple *tpl = new struct restuple;
             tpl->source = this;
             this->range = range;
-            if (vlc_http_res_init(&tpl->resource, &this->callbacks, http_mgr, uri,
+            if (vlc_http_res_init(&tpl->resource, &this->callbacks, mgr, uri,
                                   ua.empty() ? nullptr : ua.c_str(),
                                   ref.empty() ? nullptr : ref.c_str()))
             {
@@ -235,10 +287,12 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           struct vlc_http_mgr *shared)
     : AbstractConnection( p_object_ )
 {
     source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
+    sharedMgr = shared;
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
     char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
@@ -274,6 +328,8 @@ void LibVLCHTTPConnection::reset()
     bytesRange = BytesRange();
     contentType = std::string();
     bytesRead = 0;
+    activeBytesRead = 0;
+    activeTime = 0;
     contentLength = 0;
 }
 
@@ -303,7 +359,15 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     else
         msg_Dbg(p_object, "Retrieving %s", params.getUrl().c_str());
 
-    if(source->create(params.getUrl().c_str(), useragent,referer, range))
+    /* Multiplex with all other transfers to that server when it speaks
+     * HTTP/2, otherwise keep our own persistent connection */
+    struct vlc_http_mgr *mgr = source->http_mgr;
+    if(sharedMgr && params.getScheme() == "https" &&
+       vlc_http_mgr_can_multiplex(sharedMgr, params.getHostname().c_str(),
+                                  params.getPort()))
+        mgr = sharedMgr;
+
+    if(source->create(mgr, params.getUrl().c_str(), useragent,referer, range))
         return RequestStatus::GenericError;
 
     struct vlc_credential crd;
@@ -410,6 +474,8 @@ ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
 {
     ssize_t read = vlc_stream_Read(stream, p_buffer, len);
     bytesRead = source->totalRead;
+    activeBytesRead = source->activeRead;
+    activeTime = source->activeTime;
     return read;
 }
 
@@ -539,6 +605,13 @@ LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
     authStorage = auth;
+    sharedMgr = nullptr;
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    if(sharedMgr)
+        vlc_http_mgr_destroy(sharedMgr);
 }
 
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
@@ -547,7 +620,10 @@ AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    /* HTTP/2 connections are shared by all the connections we create */
+    if(!sharedMgr)
+        sharedMgr = vlc_http_mgr_create_shared(p_object, authStorage->getJar());
+    return new LibVLCHTTPConnection(p_object, authStorage, sharedMgr);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
@@ -30,6 +30,8 @@
 #include <vlc_common.h>
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     class ChunksSourceStream;
@@ -55,6 +57,10 @@ namespace adaptive
 
                 virtual size_t  getContentLength() const;
                 virtual size_t  getBytesRead() const;
+                /* bytes and time of the active transfer periods, leaving out
+                 * idle chunked transfer gaps. 0 when not measured */
+                virtual size_t  getActiveBytesRead() const;
+                virtual vlc_tick_t getActiveTime() const;
                 virtual const std::string & getContentType() const;
                 virtual const ConnectionParams &getRedirection() const;
                 virtual void    setUsed( bool ) = 0;
@@ -68,6 +74,8 @@ namespace adaptive
                 std::string        contentType;
                 BytesRange         bytesRange;
                 size_t             bytesRead;
+                size_t             activeBytesRead;
+                vlc_tick_t         activeTime;
         };
 
        class LibVLCHTTPSource;
@@ -75,7 +83,8 @@ namespace adaptive
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    struct vlc_http_mgr * = nullptr);
                virtual ~LibVLCHTTPConnection();
                virtual bool    canReuse     (const ConnectionParams &) const override;
                virtual RequestStatus request(const std::string& path,
@@ -88,6 +97,7 @@ namespace adaptive
                std::string useragent;
                std::string referer;
                LibVLCHTTPSource *source;
+               struct vlc_http_mgr *sharedMgr;
                ChunksSourceStream *sourceStream;
                stream_t *stream;
        };
@@ -123,10 +133,11 @@ namespace adaptive
        {
            public:
                LibVLCHTTPConnectionFactory( AuthStorage * );
-               virtual ~LibVLCHTTPConnectionFactory() = default;
+               virtual ~LibVLCHTTPConnectionFactory();
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
            private:
                AuthStorage *authStorage;
+               struct vlc_http_mgr *sharedMgr;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
@@ -27,11 +27,14 @@
 
 #include "HTTPConnectionManager.h"
 #include "HTTPConnection.hpp"
+#include "Chunk.h"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "ChunkCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
+#include <vlc_block.h>
 
 using namespace adaptive::http;
 
@@ -40,16 +43,27 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = nullptr;
+    cache = nullptr;
+    cacheHits = 0;
+    cacheMisses = 0;
+    downloadMetric = vlc_histogram_Get(p_object, "vlc_http_segment_download_seconds",
+                                       nullptr, "Time to download a segment",
+                                       VLC_METRIC_SECONDS);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    if(cache)
+    {
+        msg_Dbg(p_object, "chunk cache: %u hits, %u misses", cacheHits, cacheMisses);
+        ChunkCache::release(cache);
+    }
 }
 
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size,
                                                    vlc_tick_t time, vlc_tick_t latency)
 {
+    vlc_histogram_Observe(downloadMetric, time);
     if(rateObserver)
     {
         BwDebug(msg_Dbg(p_object,
@@ -60,22 +74,72 @@ void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid,
     }
 }
 
+void AbstractConnectionManager::updateTransferRate(const adaptive::ID &sourceid, size_t size,
+                                                   vlc_tick_t time)
+{
+    if(rateObserver)
+        rateObserver->updateTransferRate(sourceid, size, time);
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
 }
 
+void AbstractConnectionManager::setChunkCache(ChunkCache *cache_)
+{
+    if(cache)
+        ChunkCache::release(cache);
+    cache = cache_;
+}
+
 void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
 {
     delete source;
 }
 
-HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
+bool AbstractConnectionManager::isCacheable(ChunkType type) const
+{
+    /* Playlists and keys must always be fresh */
+    return cache && (type == ChunkType::Segment ||
+                     type == ChunkType::Init ||
+                     type == ChunkType::Index);
+}
+
+AbstractChunkSource *AbstractConnectionManager::makeCachedSource(const std::string &url,
+                                                                 ChunkType type,
+                                                                 const BytesRange &range)
+{
+    if(!isCacheable(type))
+        return nullptr;
+
+    std::string contentType;
+    block_t *p_data = cache->get(url, range, &contentType);
+    if(!p_data)
+    {
+        cacheMisses++;
+        return nullptr;
+    }
+    cacheHits++;
+    return new CachedChunkSource(this, type, range, p_data, contentType);
+}
+
+void AbstractConnectionManager::storeChunk(const std::string &url, const BytesRange &range,
+                                           const std::string &contentType, block_t *p_data)
+{
+    if(cache)
+        cache->put(url, range, contentType, p_data);
+    else
+        block_ChainRelease(p_data);
+}
+
+HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_,
+                                                 unsigned transfers)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    downloader = new Downloader(transfers);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
@@ -162,6 +226,17 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
                                                        const ID &id, ChunkType type,
                                                        const BytesRange &range)
 {
+    if(isCacheable(type))
+    {
+        AbstractChunkSource *cached = makeCachedSource(url, type, range);
+        if(cached)
+            return cached;
+        HTTPChunkBufferedSource *src =
+                new HTTPChunkBufferedSource(url, this, id, type, range);
+        src->keepData();
+        return src;
+    }
+
     switch(type)
     {
         case ChunkType::Init:
@@ -177,6 +252,14 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
 
 void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
 {
+    HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
+    if(src && isCacheable(src->getChunkType()))
+    {
+        block_t *p_data = src->takeKeptData();
+        if(p_data)
+            storeChunk(src->getUrl(), src->getBytesRange(),
+                       src->getContentType(), p_data);
+    }
     deleteSource(source);
 }
 
@@ -29,6 +29,7 @@
 #include "BytesRange.hpp"
 
 #include <vlc_common.h>
+#include <vlc_metrics.h>
 
 #include <vector>
 #include <list>
@@ -43,6 +44,7 @@ namespace adaptive
         class AbstractConnection;
         class Downloader;
         class AbstractChunkSource;
+        class ChunkCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -62,20 +64,31 @@ namespace adaptive
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
+                virtual void updateTransferRate(const ID &, size_t, vlc_tick_t) override;
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                void setChunkCache(ChunkCache *);
 
             protected:
                 void deleteSource(AbstractChunkSource *);
+                bool isCacheable(ChunkType) const;
+                AbstractChunkSource *makeCachedSource(const std::string &, ChunkType,
+                                                      const BytesRange &);
+                void storeChunk(const std::string &, const BytesRange &,
+                                const std::string &, block_t *);
                 vlc_object_t                                       *p_object;
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                ChunkCache                                         *cache;
+                unsigned                                            cacheHits;
+                unsigned                                            cacheMisses;
+                struct vlc_histogram                               *downloadMetric;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
         {
             public:
-                HTTPConnectionManager           (vlc_object_t *p_object);
+                HTTPConnectionManager           (vlc_object_t *p_object, unsigned = 1);
                 virtual ~HTTPConnectionManager  ();
 
                 virtual void    closeAllConnections ()  override;
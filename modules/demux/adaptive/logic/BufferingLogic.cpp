@@ -41,12 +41,15 @@ const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWEST_LIMIT = VLC_TICK_FROM_
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING = VLC_TICK_FROM_SEC(15);
+const unsigned   AbstractBufferingLogic::DEFAULT_PREFETCH_DEPTH = 1;
+const unsigned   AbstractBufferingLogic::MAX_PREFETCH_DEPTH = 8;
 
 AbstractBufferingLogic::AbstractBufferingLogic()
 {
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userPrefetchDepth = 0;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -69,6 +72,11 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserPrefetchDepth(unsigned v)
+{
+    userPrefetchDepth = v;
+}
+
 /* Try to never buffer up to really end */
 /* Enforce no overlap for demuxers segments 3.0.0 */
 /* FIXME: check duration instead ? */
@@ -129,7 +137,13 @@ vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 vlc_tick_t DefaultBufferingLogic::getLiveDelay(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+    {
+        /* Target latency, held by adjusting the playback rate.
+         * The user value has precedence over the playlist hold back */
+        vlc_tick_t delay = userLiveDelay ? userLiveDelay
+                                         : p->suggestedPresentationDelay.Get();
+        return std::max(delay, getMinBuffering(p));
+    }
     vlc_tick_t delay = userLiveDelay ? userLiveDelay
                                      : DEFAULT_LIVE_BUFFERING;
     if(p->suggestedPresentationDelay.Get())
@@ -152,6 +166,16 @@ vlc_tick_t DefaultBufferingLogic::getStableBuffering(const BasePlaylist *p) cons
     return std::min(getMinBuffering(p) * 2, max);
 }
 
+unsigned DefaultBufferingLogic::getPrefetchDepth(const BasePlaylist *p) const
+{
+    /* Next segments might not be published yet near live edge */
+    if(isLowLatency(p))
+        return 1;
+    unsigned depth = userPrefetchDepth ? userPrefetchDepth
+                                       : DEFAULT_PREFETCH_DEPTH;
+    return std::min(depth, MAX_PREFETCH_DEPTH);
+}
+
 uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *rep) const
 {
     BasePlaylist *playlist = rep->getPlaylist();
@@ -316,9 +340,10 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
             }
         }
 
+        /* In low latency, the last segment is read while being published */
+        const uint64_t edgeoffset = isLowLatency(playlist) ? 0 : SAFETY_BUFFERING_EDGE_OFFSET;
         uint64_t safeedgenumber = back->getSequenceNumber() -
-                        std::min((uint64_t)list.size() - 1,
-                                 (uint64_t)SAFETY_BUFFERING_EDGE_OFFSET);
+                        std::min((uint64_t)list.size() - 1, edgeoffset);
         uint64_t safestartnumber = availableliststartnumber;
 
         for(unsigned i=0; i<SAFETY_EXPURGING_OFFSET; i++)
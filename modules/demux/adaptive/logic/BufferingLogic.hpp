@@ -47,19 +47,26 @@ namespace adaptive
                 virtual vlc_tick_t getMaxBuffering(const BasePlaylist *) const = 0;
                 virtual vlc_tick_t getLiveDelay(const BasePlaylist *) const = 0;
                 virtual vlc_tick_t getStableBuffering(const BasePlaylist *) const = 0;
+                /* number of segments requested ahead, including the current one */
+                virtual unsigned getPrefetchDepth(const BasePlaylist *) const = 0;
+                virtual bool isLowLatency(const BasePlaylist *) const = 0;
                 void setUserMinBuffering(vlc_tick_t);
                 void setUserMaxBuffering(vlc_tick_t);
                 void setUserLiveDelay(vlc_tick_t);
+                void setUserPrefetchDepth(unsigned);
                 void setLowDelay(bool);
                 static const vlc_tick_t BUFFERING_LOWEST_LIMIT;
                 static const vlc_tick_t DEFAULT_MIN_BUFFERING;
                 static const vlc_tick_t DEFAULT_MAX_BUFFERING;
                 static const vlc_tick_t DEFAULT_LIVE_BUFFERING;
+                static const unsigned   DEFAULT_PREFETCH_DEPTH;
+                static const unsigned   MAX_PREFETCH_DEPTH;
 
             protected:
                 vlc_tick_t userMinBuffering;
                 vlc_tick_t userMaxBuffering;
                 vlc_tick_t userLiveDelay;
+                unsigned   userPrefetchDepth;
                 Undef<bool> userLowLatency;
         };
 
@@ -73,13 +80,14 @@ namespace adaptive
                 virtual vlc_tick_t getMaxBuffering(const BasePlaylist *) const override;
                 virtual vlc_tick_t getLiveDelay(const BasePlaylist *) const override;
                 virtual vlc_tick_t getStableBuffering(const BasePlaylist *) const override;
+                virtual unsigned getPrefetchDepth(const BasePlaylist *) const override;
+                virtual bool isLowLatency(const BasePlaylist *) const override;
                 static const unsigned SAFETY_BUFFERING_EDGE_OFFSET;
                 static const unsigned SAFETY_EXPURGING_OFFSET;
 
             protected:
                 vlc_tick_t getBufferingOffset(const BasePlaylist *) const;
                 uint64_t getLiveStartSegmentNumber(BaseRepresentation *) const;
-                bool isLowLatency(const BasePlaylist *) const;
         };
     }
 }
@@ -0,0 +1,320 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput and buffer hybrid, as dash.js DYNAMIC / L2A:
+ * - bandwidth is estimated from the active transfer periods only, as chunked
+ *   (low latency) transfers are mostly idle waiting for the content,
+ * - throughput rule while the buffer is low, BOLA once it is filled,
+ *   scaled to the buffering target so that it also works with the small
+ *   buffers of low latency.
+ */
+
+#define FAST_HALFLIFE  VLC_TICK_FROM_SEC(2)
+#define SLOW_HALFLIFE  VLC_TICK_FROM_SEC(8)
+#define BANDWIDTH_SAFETY_FACTOR 0.9
+
+ThroughputEstimate::ThroughputEstimate(vlc_tick_t halflife_)
+    : halflife( secf_from_vlc_tick(halflife_) )
+    , estimate( 0.0 )
+    , weight( 0.0 )
+{ }
+
+void ThroughputEstimate::push(size_t size, vlc_tick_t duration)
+{
+    const double w = secf_from_vlc_tick(duration);
+    if(w <= 0.0)
+        return;
+    const double alpha = std::pow(0.5, w / halflife);
+    estimate = alpha * estimate + (1.0 - alpha) * (8.0 * size / w);
+    weight += w;
+}
+
+unsigned ThroughputEstimate::get() const
+{
+    if(weight <= 0.0)
+        return 0;
+    /* unbias from the zero initial estimate */
+    return std::lround(estimate / (1.0 - std::pow(0.5, weight / halflife)));
+}
+
+HybridContext::HybridContext()
+    : buffering_min( 0 )
+    , buffering_level( 0 )
+    , buffering_target( 0 )
+    , buffer_based( false )
+{ }
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , fast( FAST_HALFLIFE )
+    , slow( SLOW_HALFLIFE )
+    , usedBps( 0 )
+{
+    stats = Stats();
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+    msg_Dbg(p_obj, "hybrid logic: %u transfer samples over %" PRId64 "ms, %u switches",
+            stats.samples, MS_FROM_VLC_TICK(stats.activetime), stats.switches);
+}
+
+BaseRepresentation *
+HybridAdaptationLogic::getBufferBasedRepresentation(BaseAdaptationSet *adaptSet,
+                                                    RepresentationSelector &selector,
+                                                    const HybridContext &ctx)
+{
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+
+    /* utilities are log(S/Smin) + 1, the buffer ramp goes from the
+     * minimum to the target buffering */
+    const float umin = getUtility(lowest);
+    const float umax = getUtility(highest) - umin + 1.0;
+    const float Qmin = secf_from_vlc_tick(ctx.buffering_min);
+    const float Qmax = secf_from_vlc_tick(ctx.buffering_target);
+    const float gammaP = (umax - 1.0) / (Qmax / Qmin - 1.0);
+    const float Vp = Qmin / gammaP;
+    const float Q = secf_from_vlc_tick(ctx.buffering_level);
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    float argmax;
+    for(BaseRepresentation *rep = lowest;
+                            rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        float u = getUtility(rep) - umin + 1.0;
+        float arg = ( Vp * (u + gammaP) - Q ) / rep->getBandwidth();
+        if(ret == nullptr || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(lowest == nullptr || highest == nullptr)
+        return nullptr;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        return lowest;
+    }
+
+    HybridContext &ctx = (*it).second;
+    /* Hysteresis between the throughput and buffer rules */
+    if(!ctx.buffer_based && ctx.buffering_level >= ctx.buffering_target / 2)
+        ctx.buffer_based = true;
+    else if(ctx.buffer_based && ctx.buffering_level < ctx.buffering_target / 4)
+        ctx.buffer_based = false;
+    const HybridContext ctxcopy = ctx;
+
+    const unsigned bw = getBandwidth();
+    const unsigned bps = getAvailableBw(bw, prevRep);
+
+    vlc_mutex_unlock(&lock);
+
+    BaseRepresentation *rep;
+    if(bw == 0) /* no estimate yet */
+    {
+        rep = prevRep ? prevRep : lowest;
+    }
+    else
+    {
+        BaseRepresentation *throughputRep = selector.select(adaptSet, bps * BANDWIDTH_SAFETY_FACTOR);
+        if(!ctxcopy.buffer_based || prevRep == nullptr || lowest == highest ||
+           ctxcopy.buffering_target <= ctxcopy.buffering_min)
+        {
+            rep = throughputRep;
+        }
+        else
+        {
+            rep = getBufferBasedRepresentation(adaptSet, selector, ctxcopy);
+            /* BOLA-O: do not switch up to a rate that can not be sustained */
+            if(rep->getBandwidth() > prevRep->getBandwidth() && rep->getBandwidth() > bps)
+            {
+                if(throughputRep->getBandwidth() > prevRep->getBandwidth())
+                    rep = throughputRep;
+                else
+                    rep = prevRep;
+            }
+        }
+    }
+
+    vlc_mutex_lock(&lock);
+    stats.bandwidth = bw;
+    stats.available = bps;
+    stats.buffering_level = ctxcopy.buffering_level;
+    stats.buffering_target = ctxcopy.buffering_target;
+    stats.buffer_based = ctxcopy.buffer_based;
+    if(prevRep && rep != prevRep)
+        stats.switches++;
+    vlc_mutex_unlock(&lock);
+
+    BwDebug( msg_Info(p_obj, "Stream %s %s buffering level %.2f%% estimate %u kBps rep %" PRIu64 " kBps",
+             adaptSet->getID().str().c_str(), ctxcopy.buffer_based ? "buffer" : "throughput",
+             ctxcopy.buffering_target ? 100.0 * ctxcopy.buffering_level / ctxcopy.buffering_target : 0.0,
+             bw / 8000, rep->getBandwidth() / 8000); );
+
+    return rep;
+}
+
+HybridAdaptationLogic::Stats HybridAdaptationLogic::getStats() const
+{
+    vlc_mutex_lock(&lock);
+    Stats ret = stats;
+    vlc_mutex_unlock(&lock);
+    return ret;
+}
+
+float HybridAdaptationLogic::getUtility(const BaseRepresentation *rep)
+{
+    float ret;
+    std::map<uint64_t, float>::iterator it = utilities.find(rep->getBandwidth());
+    if(it == utilities.end())
+    {
+        ret = std::log((float)rep->getBandwidth());
+        utilities.insert(std::pair<uint64_t, float>(rep->getBandwidth(), ret));
+    }
+    else ret = (*it).second;
+    return ret;
+}
+
+unsigned HybridAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRepresentation *curRep) const
+{
+    unsigned i_remain = i_bw;
+    if(i_remain > usedBps)
+        i_remain -= usedBps;
+    else
+        i_remain = 0;
+    if(curRep)
+        i_remain += curRep->getBandwidth();
+    return i_remain > i_bw ? i_remain : i_bw;
+}
+
+unsigned HybridAdaptationLogic::getBandwidth() const
+{
+    return std::min(fast.get(), slow.get());
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &, size_t, vlc_tick_t, vlc_tick_t)
+{
+    /* whole chunk rates include the idle time, see updateTransferRate */
+}
+
+void HybridAdaptationLogic::updateTransferRate(const ID &, size_t size, vlc_tick_t time)
+{
+    vlc_mutex_lock(&lock);
+    fast.push(size, time);
+    slow.push(size, time);
+    stats.samples++;
+    stats.activetime += time;
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &event =
+                    static_cast<const RepresentationSwitchEvent &>(ev);
+            vlc_mutex_lock(&lock);
+            if(event.prev)
+                usedBps -= event.prev->getBandwidth();
+            if(event.next)
+                usedBps += event.next->getBandwidth();
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    HybridContext ctx;
+                    streams.insert(std::pair<ID, HybridContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            HybridContext &ctx = streams[id];
+            ctx.buffering_level = event.current;
+            ctx.buffering_target = event.target;
+            ctx.buffering_min = std::min(event.minimum, event.target / 2);
+            if(ctx.buffering_min <= 0)
+                ctx.buffering_min = event.target / 4;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * HybridAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HYBRIDADAPTATIONLOGIC_HPP
+#define HYBRIDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include "Representationselectors.hpp"
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Exponentially weighted throughput, samples weighted by duration */
+        class ThroughputEstimate
+        {
+            public:
+                ThroughputEstimate(vlc_tick_t halflife);
+                void push(size_t, vlc_tick_t);
+                unsigned get() const;
+
+            private:
+                double halflife;
+                double estimate;
+                double weight;
+        };
+
+        class HybridContext
+        {
+            friend class HybridAdaptationLogic;
+
+            public:
+                HybridContext();
+
+            private:
+                vlc_tick_t buffering_min;
+                vlc_tick_t buffering_level;
+                vlc_tick_t buffering_target;
+                bool       buffer_based;
+        };
+
+        class HybridAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                HybridAdaptationLogic(vlc_object_t *);
+                virtual ~HybridAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *,
+                                                                  BaseRepresentation *) override;
+                virtual void                updateDownloadRate     (const ID &, size_t,
+                                                                    vlc_tick_t, vlc_tick_t) override;
+                virtual void                updateTransferRate     (const ID &, size_t,
+                                                                    vlc_tick_t) override;
+                virtual void                trackerEvent           (const TrackerEvent &) override;
+
+                /* Inputs of the last decision */
+                struct Stats
+                {
+                    unsigned   bandwidth;    /* estimated, bps */
+                    unsigned   available;    /* for the stream, bps */
+                    unsigned   samples;
+                    vlc_tick_t activetime;   /* sampled transfer time */
+                    vlc_tick_t buffering_level;
+                    vlc_tick_t buffering_target;
+                    bool       buffer_based;
+                    unsigned   switches;
+                };
+                Stats getStats() const;
+
+            private:
+                BaseRepresentation *        getBufferBasedRepresentation(BaseAdaptationSet *,
+                                                                         RepresentationSelector &,
+                                                                         const HybridContext &);
+                float                       getUtility(const BaseRepresentation *);
+                unsigned                    getAvailableBw(unsigned, const BaseRepresentation *) const;
+                unsigned                    getBandwidth() const;
+                ThroughputEstimate          fast;
+                ThroughputEstimate          slow;
+                std::map<adaptive::ID, HybridContext> streams;
+                std::map<uint64_t, float>   utilities;
+                unsigned                    usedBps;
+                Stats                       stats;
+                mutable vlc_mutex_t         lock;
+        };
+    }
+}
+
+#endif // HYBRIDADAPTATIONLOGIC_HPP
@@ -36,6 +36,9 @@ namespace adaptive
         public:
             virtual void updateDownloadRate(const ID &, size_t,
                                             vlc_tick_t, vlc_tick_t) = 0;
+            /* bytes received during active transfer periods only,
+             * sampled while the chunk is downloaded */
+            virtual void updateTransferRate(const ID &, size_t, vlc_tick_t) {}
             virtual ~IDownloadRateObserver(){}
     };
 }
@@ -59,7 +59,9 @@ ISegment::~ISegment()
 
 bool ISegment::prepareChunk(SharedResources *res, SegmentChunk *chunk, BaseRepresentation *rep)
 {
-    CommonEncryption enc = encryption;
+    CommonEncryption enc;
+    if(encryption)
+        enc = *encryption;
     enc.mergeWith(rep->intheritEncryption());
 
     if(enc.method != CommonEncryption::Method::None)
@@ -187,7 +189,16 @@ int ISegment::compare(ISegment *other) const
     return 0;
 }
 
-void ISegment::setEncryption(CommonEncryption &e)
+void ISegment::updateWith(ISegment *)
+{
+}
+
+void ISegment::setEncryption(const CommonEncryption &e)
+{
+    encryption = std::make_shared<const CommonEncryption>(e);
+}
+
+void ISegment::setEncryption(const std::shared_ptr<const CommonEncryption> &e)
 {
     encryption = e;
 }
@@ -234,7 +245,14 @@ Segment::~Segment()
 void                    Segment::setSourceUrl   ( const std::string &url )
 {
     if ( url.empty() == false )
-        this->sourceUrl = Url(url);
+        this->sourceUrl = url;
+}
+
+Url Segment::getSourceUrl() const
+{
+    if(sourceUrl.empty())
+        return Url();
+    return Url(sourceUrl);
 }
 
 void Segment::debug(vlc_object_t *obj, int indent) const
@@ -256,15 +274,16 @@ void Segment::debug(vlc_object_t *obj, int indent) const
 
 Url Segment::getUrlSegment() const
 {
-    if(sourceUrl.hasScheme())
+    Url url = getSourceUrl();
+    if(url.hasScheme())
     {
-        return sourceUrl;
+        return url;
     }
     else
     {
         Url ret = getParentUrlSegment();
-        if (!sourceUrl.empty())
-            ret.append(sourceUrl);
+        if (!url.empty())
+            ret.append(url);
         return ret;
     }
 }
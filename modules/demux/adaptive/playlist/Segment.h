@@ -28,6 +28,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <memory>
 #include "ICanonicalUrl.hpp"
 #include "../http/Chunk.h"
 #include "../encryption/CommonEncryption.hpp"
@@ -74,7 +75,11 @@ namespace adaptive
                 virtual void                            debug           (vlc_object_t *,int = 0) const;
                 virtual bool                            contains        (size_t byte) const;
                 virtual int                             compare         (ISegment *) const;
-                void                                    setEncryption   (CommonEncryption &);
+                /* merges a newer version of the same segment */
+                virtual void                            updateWith      (ISegment *);
+                void                                    setEncryption   (const CommonEncryption &);
+                /* shares the same key between consecutive segments */
+                void                                    setEncryption   (const std::shared_ptr<const CommonEncryption> &);
                 void                                    setDisplayTime  (vlc_tick_t);
                 vlc_tick_t                              getDisplayTime  () const;
                 Property<stime_t>       startTime;
@@ -85,10 +90,10 @@ namespace adaptive
                 virtual bool                            prepareChunk    (SharedResources *,
                                                                          SegmentChunk *,
                                                                          BaseRepresentation *);
-                CommonEncryption        encryption;
+                std::shared_ptr<const CommonEncryption> encryption;
                 size_t                  startByte;
                 size_t                  endByte;
-                std::string             debugName;
+                const char *            debugName;
                 bool                    templated;
                 uint64_t                sequence;
                 vlc_tick_t              displayTime;
@@ -107,8 +112,10 @@ namespace adaptive
                 virtual void addSubSegment(SubSegment *);
 
             protected:
+                /* only built when requested, see getUrlSegment() */
+                virtual Url getSourceUrl() const;
                 std::vector<Segment *> subsegments;
-                Url sourceUrl;
+                std::string sourceUrl;
         };
 
         class InitSegment : public Segment
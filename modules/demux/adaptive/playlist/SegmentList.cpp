@@ -30,6 +30,7 @@
 #include "SegmentInformation.hpp"
 #include "SegmentTimeline.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace adaptive;
@@ -39,6 +40,7 @@ SegmentList::SegmentList( SegmentInformation *parent_ ):
     AbstractMultipleSegmentBaseType( parent_, AttrsNode::Type::SegmentList )
 {
     totalLength = 0;
+    sequenceStart = std::numeric_limits<uint64_t>::max();
 }
 SegmentList::~SegmentList()
 {
@@ -52,6 +54,11 @@ const std::vector<Segment*>& SegmentList::getSegments() const
     return segments;
 }
 
+void SegmentList::setSequenceStart(uint64_t number)
+{
+    sequenceStart = number;
+}
+
 Segment * SegmentList::getMediaSegment(uint64_t number) const
 {
     const SegmentTimeline *timeline = inheritSegmentTimeline();
@@ -86,6 +93,11 @@ void SegmentList::addSegment(Segment *seg)
     totalLength += seg->duration.Get();
 }
 
+void SegmentList::reserve(size_t count)
+{
+    segments.reserve(count);
+}
+
 void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
                              bool b_restamp)
 {
@@ -95,10 +107,13 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     if(!updated || updated->segments.empty())
         return;
 
-    const Segment * lastSegment = (segments.empty()) ? nullptr : segments.back();
+    Segment * lastSegment = (segments.empty()) ? nullptr : segments.back();
     const Segment * prevSegment = lastSegment;
 
-    uint64_t firstnumber = updated->segments.front()->getSequenceNumber();
+    uint64_t firstnumber = std::min(updated->sequenceStart,
+                                    updated->segments.front()->getSequenceNumber());
+
+    segments.reserve(segments.size() + updated->segments.size());
 
     std::vector<Segment *>::iterator it;
     for(it = updated->segments.begin(); it != updated->segments.end(); ++it)
@@ -119,7 +134,16 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
             addSegment(cur);
         }
         else
+        {
+            /* Last one might still be growing (low latency) */
+            if(lastSegment->compare(cur) == 0)
+            {
+                totalLength -= lastSegment->duration.Get();
+                lastSegment->updateWith(cur);
+                totalLength += lastSegment->duration.Get();
+            }
             delete cur;
+        }
     }
     updated->segments.clear();
 
@@ -146,8 +170,9 @@ void SegmentList::pruneBySegmentNumber(uint64_t tobelownum)
 
         totalLength -= (*it)->duration.Get();
         delete *it;
-        it = segments.erase(it);
+        ++it;
     }
+    segments.erase(segments.begin(), it);
 }
 
 bool SegmentList::getPlaybackTimeDurationBySegmentNumber(uint64_t number,
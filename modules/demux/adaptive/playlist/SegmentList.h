@@ -43,6 +43,10 @@ namespace adaptive
 
                 const std::vector<Segment *>&   getSegments() const;
                 void                    addSegment(Segment *seg);
+                void                    reserve(size_t);
+                /* The update covers from this number, even if the unchanged
+                 * segments were left out from it */
+                void                    setSequenceStart(uint64_t);
                 virtual void            updateWith(AbstractMultipleSegmentBaseType *,
                                                    bool = false) override;
                 void                    pruneBySegmentNumber(uint64_t);
@@ -62,6 +66,7 @@ namespace adaptive
             private:
                 std::vector<Segment *>  segments;
                 stime_t totalLength;
+                uint64_t sequenceStart;
         };
     }
 }
@@ -46,7 +46,12 @@ SegmentTemplateSegment::~SegmentTemplateSegment()
 
 void SegmentTemplateSegment::setSourceUrl(const std::string &url)
 {
-    sourceUrl = Url(Url::Component(url, templ));
+    sourceUrl = url;
+}
+
+Url SegmentTemplateSegment::getSourceUrl() const
+{
+    return Url(Url::Component(sourceUrl, templ));
 }
 
 void SegmentTemplateSegment::setParentTemplate( SegmentTemplate *templ_ )
@@ -285,5 +290,10 @@ SegmentTemplateInit::~SegmentTemplateInit()
 
 void SegmentTemplateInit::setSourceUrl(const std::string &url)
 {
-    sourceUrl = Url(Url::Component(url, templ));
+    sourceUrl = url;
+}
+
+Url SegmentTemplateInit::getSourceUrl() const
+{
+    return Url(Url::Component(sourceUrl, templ));
 }
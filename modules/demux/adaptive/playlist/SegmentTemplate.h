@@ -45,6 +45,7 @@ namespace adaptive
                 void setParentTemplate( SegmentTemplate * );
 
             protected:
+                virtual Url getSourceUrl() const override;
                 const SegmentTemplate *templ;
         };
 
@@ -82,6 +83,7 @@ namespace adaptive
                 virtual void setSourceUrl( const std::string &url ) override;
 
             protected:
+                virtual Url getSourceUrl() const override;
                 const SegmentTemplate *templ;
         };
     }
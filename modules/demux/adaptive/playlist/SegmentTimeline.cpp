@@ -39,6 +39,12 @@ SegmentTimeline::SegmentTimeline(AbstractMultipleSegmentBaseType *parent_)
 {
     totalLength = 0;
     parent = parent_;
+    runLength = false;
+}
+
+void SegmentTimeline::setRunLength(bool b)
+{
+    runLength = b;
 }
 
 SegmentTimeline::~SegmentTimeline()
@@ -50,6 +56,20 @@ SegmentTimeline::~SegmentTimeline()
 
 void SegmentTimeline::addElement(uint64_t number, stime_t d, uint64_t r, stime_t t)
 {
+    /* Run-length: contiguous S of the same duration extend the previous one */
+    if(runLength && !elements.empty())
+    {
+        Element *el = elements.back();
+        if(el->d == d && number == el->number + el->r + 1 &&
+           (!t || t == el->t + el->d * (stime_t)(el->r + 1)) &&
+           el->r < std::numeric_limits<unsigned>::max())
+        {
+            el->r += r + 1;
+            totalLength += (d * (r + 1));
+            return;
+        }
+    }
+
     Element *element = new (std::nothrow) Element(number, d, r, t);
     if(element)
     {
@@ -253,6 +273,13 @@ void SegmentTimeline::updateWith(SegmentTimeline &other)
         else /* Did not exist in previous list */
         {
             totalLength += (el->d * (el->r + 1));
+            if(runLength && el->d == last->d &&
+               el->t == last->t + last->d * (stime_t)(last->r + 1))
+            {
+                last->r += el->r + 1;
+                delete el;
+                continue;
+            }
             elements.push_back(el);
             el->number = last->number + last->r + 1;
             last = el;
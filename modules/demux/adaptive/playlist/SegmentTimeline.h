@@ -41,6 +41,9 @@ namespace adaptive
             public:
                 SegmentTimeline(AbstractMultipleSegmentBaseType *);
                 virtual ~SegmentTimeline();
+                /* Merges contiguous elements of the same duration. Only when
+                 * elements are not matched to listed segments (templates) */
+                void setRunLength(bool);
                 void addElement(uint64_t, stime_t d, uint64_t r = 0, stime_t t = 0);
                 uint64_t getElementNumberByScaledPlaybackTime(stime_t) const;
                 bool    getScaledPlaybackTimeDurationBySegmentNumber(uint64_t, stime_t *, stime_t *) const;
@@ -59,6 +62,7 @@ namespace adaptive
                 std::list<Element *> elements;
                 stime_t totalLength;
                 AbstractMultipleSegmentBaseType *parent;
+                bool runLength;
 
                 class Element
                 {
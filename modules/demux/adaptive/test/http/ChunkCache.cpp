@@ -0,0 +1,104 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/ChunkCache.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+
+#include <cstring>
+
+using namespace adaptive::http;
+
+static block_t * MakeData(size_t size, uint8_t fill)
+{
+    block_t *p_block = block_Alloc(size);
+    if(p_block)
+        memset(p_block->p_buffer, fill, size);
+    return p_block;
+}
+
+static bool CheckData(block_t *p_block, size_t size, uint8_t fill)
+{
+    bool b_ret = p_block && p_block->i_buffer == size &&
+                 p_block->p_buffer[0] == fill &&
+                 p_block->p_buffer[size - 1] == fill;
+    if(p_block)
+        block_Release(p_block);
+    return b_ret;
+}
+
+int ChunkCache_test()
+{
+    ChunkCache *cache = ChunkCache::acquire(1000);
+    try
+    {
+        std::string type;
+
+        Expect(ChunkCache::acquire(500) == cache);
+        ChunkCache::release(cache);
+        Expect(cache->getMaxSize() == 1000);
+
+        Expect(cache->get("http://a/1.ts", BytesRange(), &type) == nullptr);
+
+        cache->put("http://a/1.ts", BytesRange(), "video/mp2t", MakeData(400, 1));
+        Expect(cache->getSize() == 400);
+        Expect(CheckData(cache->get("http://a/1.ts", BytesRange(), &type), 400, 1));
+        Expect(type == "video/mp2t");
+        /* fragment is not part of the resource */
+        Expect(CheckData(cache->get("http://a/1.ts#t=10", BytesRange(), &type), 400, 1));
+
+        /* ranges are different resources */
+        Expect(cache->get("http://a/1.ts", BytesRange(0, 199), &type) == nullptr);
+        block_t *p_chain = MakeData(100, 2);
+        p_chain->p_next = MakeData(100, 2);
+        cache->put("http://a/1.ts", BytesRange(0, 199), "", p_chain);
+        Expect(CheckData(cache->get("http://a/1.ts", BytesRange(0, 199), &type), 200, 2));
+        Expect(cache->getSize() == 600);
+
+        /* least recently used goes first */
+        Expect(CheckData(cache->get("http://a/1.ts", BytesRange(), &type), 400, 1));
+        cache->put("http://a/2.ts", BytesRange(), "", MakeData(500, 3));
+        Expect(cache->getSize() == 900);
+        Expect(cache->get("http://a/1.ts", BytesRange(0, 199), &type) == nullptr);
+        Expect(CheckData(cache->get("http://a/1.ts", BytesRange(), &type), 400, 1));
+        Expect(CheckData(cache->get("http://a/2.ts", BytesRange(), &type), 500, 3));
+
+        /* too large */
+        cache->put("http://a/3.ts", BytesRange(), "", MakeData(1001, 4));
+        Expect(cache->get("http://a/3.ts", BytesRange(), &type) == nullptr);
+        Expect(cache->getSize() == 900);
+
+        ChunkCache::Stats stats = cache->getStats();
+        Expect(stats.evictions == 1);
+        Expect(stats.hits == 6);
+        Expect(stats.misses == 4);
+    } catch(...) {
+        ChunkCache::release(cache);
+        return 1;
+    }
+
+    ChunkCache::release(cache);
+    return 0;
+}
@@ -110,6 +110,12 @@ int BufferingLogic_test()
         Expect(bufferinglogic.getStableBuffering(playlist) <= bufferinglogic.getMaxBuffering(playlist));
         Expect(bufferinglogic.getStableBuffering(playlist) >= bufferinglogic.getMinBuffering(playlist));
 
+        Expect(bufferinglogic.getPrefetchDepth(playlist) == DefaultBufferingLogic::DEFAULT_PREFETCH_DEPTH);
+        bufferinglogic.setUserPrefetchDepth(DefaultBufferingLogic::MAX_PREFETCH_DEPTH * 2);
+        Expect(bufferinglogic.getPrefetchDepth(playlist) == DefaultBufferingLogic::MAX_PREFETCH_DEPTH);
+        bufferinglogic.setUserPrefetchDepth(4);
+        Expect(bufferinglogic.getPrefetchDepth(playlist) == 4);
+
         bufferinglogic.setUserMinBuffering(DefaultBufferingLogic::DEFAULT_MIN_BUFFERING / 2);
         Expect(bufferinglogic.getMinBuffering(playlist) == std::max(DefaultBufferingLogic::DEFAULT_MIN_BUFFERING / 2,
                                                                     DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT));
@@ -143,6 +149,7 @@ int BufferingLogic_test()
         Expect(bufferinglogic.getMaxBuffering(playlist) < DefaultBufferingLogic::DEFAULT_MAX_BUFFERING);
         Expect(bufferinglogic.getMinBuffering(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
         Expect(bufferinglogic.getLiveDelay(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
+        Expect(bufferinglogic.getPrefetchDepth(playlist) == 1);
 
         playlist->b_lowlatency = false;
         Expect(bufferinglogic.getStartSegmentNumber(rep) == number);
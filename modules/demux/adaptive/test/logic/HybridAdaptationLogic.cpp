@@ -0,0 +1,139 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../../SegmentTracker.hpp"
+
+#include "../test.hpp"
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace logic;
+
+class HybridTestPlaylist : public BasePlaylist
+{
+    public:
+        HybridTestPlaylist() : BasePlaylist(nullptr) {}
+        virtual ~HybridTestPlaylist() {}
+        virtual bool isLive() const override { return false; }
+};
+
+int HybridAdaptationLogic_test()
+{
+    HybridTestPlaylist *playlist = nullptr;
+    try
+    {
+        ThroughputEstimate estimate(VLC_TICK_FROM_SEC(2));
+        Expect(estimate.get() == 0);
+        estimate.push(125000, VLC_TICK_FROM_SEC(1));
+        Expect(estimate.get() == 1000000);
+        estimate.push(125000, VLC_TICK_FROM_MS(500));
+        Expect(estimate.get() > 1000000);
+        Expect(estimate.get() < 2000000);
+        estimate.push(1000000, 0);
+        Expect(estimate.get() < 2000000);
+
+        playlist = new HybridTestPlaylist();
+        BasePeriod *period = nullptr;
+        BaseAdaptationSet *set = nullptr;
+        try
+        {
+            period = new BasePeriod(playlist);
+            set = new BaseAdaptationSet(period);
+        } catch(...) {
+            delete period;
+            delete set;
+            std::rethrow_exception(std::current_exception());
+        }
+        period->addAdaptationSet(set);
+        playlist->addPeriod(period);
+        set->setID(ID("hybrid"));
+
+        BaseRepresentation *reps[3];
+        const uint64_t bandwidths[3] = { 500000, 1000000, 3000000 };
+        for(int i=0; i<3; i++)
+        {
+            reps[i] = new BaseRepresentation(set);
+            reps[i]->setBandwidth(bandwidths[i]);
+            set->addRepresentation(reps[i]);
+        }
+
+        HybridAdaptationLogic logic(nullptr);
+        const ID &id = set->getID();
+        logic.trackerEvent(BufferingStateUpdatedEvent(id, true));
+
+        /* no estimate */
+        Expect(logic.getNextRepresentation(set, nullptr) == reps[0]);
+
+        /* whole chunk rates are ignored */
+        logic.updateDownloadRate(id, 10000000, VLC_TICK_FROM_SEC(1), 0);
+        Expect(logic.getStats().bandwidth == 0);
+
+        /* throughput rule while the buffer is low */
+        logic.updateTransferRate(id, 250000, VLC_TICK_FROM_SEC(1));
+        logic.trackerEvent(BufferingLevelChangedEvent(id, 0, VLC_TICK_FROM_SEC(20),
+                                                      0, VLC_TICK_FROM_SEC(10)));
+        BaseRepresentation *rep = logic.getNextRepresentation(set, nullptr);
+        Expect(rep == reps[1]);
+        logic.trackerEvent(RepresentationSwitchEvent(nullptr, rep));
+        HybridAdaptationLogic::Stats stats = logic.getStats();
+        Expect(stats.bandwidth == 2000000);
+        Expect(stats.samples == 1);
+        Expect(stats.activetime == VLC_TICK_FROM_SEC(1));
+        Expect(!stats.buffer_based);
+
+        /* buffer rule, but never up to an unsustainable rate */
+        logic.trackerEvent(BufferingLevelChangedEvent(id, 0, VLC_TICK_FROM_SEC(20),
+                                                      VLC_TICK_FROM_SEC(9), VLC_TICK_FROM_SEC(10)));
+        Expect(logic.getNextRepresentation(set, rep) == reps[1]);
+        stats = logic.getStats();
+        Expect(stats.buffer_based);
+        Expect(stats.buffering_level == VLC_TICK_FROM_SEC(9));
+        Expect(stats.switches == 0);
+
+        /* buffer rule, draining */
+        logic.trackerEvent(BufferingLevelChangedEvent(id, 0, VLC_TICK_FROM_SEC(20),
+                                                      VLC_TICK_FROM_SEC(3), VLC_TICK_FROM_SEC(10)));
+        Expect(logic.getNextRepresentation(set, rep) == reps[0]);
+        stats = logic.getStats();
+        Expect(stats.buffer_based);
+        Expect(stats.switches == 1);
+
+        /* back to throughput */
+        logic.trackerEvent(BufferingLevelChangedEvent(id, 0, VLC_TICK_FROM_SEC(20),
+                                                      VLC_TICK_FROM_SEC(2), VLC_TICK_FROM_SEC(10)));
+        Expect(logic.getNextRepresentation(set, rep) == reps[1]);
+        Expect(!logic.getStats().buffer_based);
+
+        delete playlist;
+    } catch(...) {
+        delete playlist;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/BufferingLogic.hpp"
+#include "../../logic/AlwaysBestAdaptationLogic.h"
+#include "../../logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../../SegmentTracker.hpp"
+
+#include "../test.hpp"
+
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace logic;
+
+/*
+ * Replays network traces against the adaptation and buffering logics,
+ * on a virtual clock. The transfers are modeled as the single worker
+ * Downloader and the buffered chunk sources would perform them, and
+ * report the same rate samples to the logic.
+ */
+
+class SimulationPlaylist : public BasePlaylist
+{
+    public:
+        SimulationPlaylist(bool lowlatency) : BasePlaylist(nullptr)
+        {
+            b_lowlatency = lowlatency;
+        }
+
+        virtual ~SimulationPlaylist() {}
+
+        virtual bool isLive() const override
+        {
+            return b_lowlatency;
+        }
+
+        virtual bool isLowLatency() const override
+        {
+            return b_lowlatency;
+        }
+
+    private:
+        bool b_lowlatency;
+};
+
+/* piecewise constant link, the last step lasting forever */
+class NetworkTrace
+{
+    public:
+        struct Step
+        {
+            vlc_tick_t duration;
+            uint64_t   bandwidth; /* bps */
+            vlc_tick_t rtt;
+        };
+
+        NetworkTrace(const std::vector<Step> &steps) : steps(steps) {}
+
+        const Step & at(vlc_tick_t time, vlc_tick_t *end = nullptr) const
+        {
+            vlc_tick_t start = 0;
+            for(size_t i=0; i<steps.size() - 1; i++)
+            {
+                if(time < start + steps[i].duration)
+                {
+                    if(end)
+                        *end = start + steps[i].duration;
+                    return steps[i];
+                }
+                start += steps[i].duration;
+            }
+            if(end)
+                *end = VLC_TICK_MAX;
+            return steps.back();
+        }
+
+        vlc_tick_t transferTime(vlc_tick_t time, size_t size) const
+        {
+            uint64_t bits = (uint64_t) size * 8;
+            vlc_tick_t elapsed = 0;
+            for(;;)
+            {
+                vlc_tick_t end;
+                const Step &step = at(time + elapsed, &end);
+                if(end != VLC_TICK_MAX &&
+                   step.bandwidth * (end - time - elapsed) < bits * CLOCK_FREQ)
+                {
+                    bits -= step.bandwidth * (end - time - elapsed) / CLOCK_FREQ;
+                    elapsed = end - time;
+                    continue;
+                }
+                return elapsed + (bits * CLOCK_FREQ + step.bandwidth - 1) / step.bandwidth;
+            }
+        }
+
+    private:
+        std::vector<Step> steps;
+};
+
+struct SimulationResult
+{
+    vlc_tick_t startup;
+    vlc_tick_t rebuffering;
+    unsigned   stalls;
+    unsigned   switches;
+    uint64_t   bitrate; /* average over the segments, bps */
+};
+
+class Simulation
+{
+    public:
+        static const size_t TRANSFER_SAMPLE_SIZE = 16384;
+
+        Simulation(BasePlaylist *playlist, BaseAdaptationSet *set,
+                   AbstractBufferingLogic *bufferingLogic, vlc_tick_t duration)
+            : playlist(playlist), set(set), bufferingLogic(bufferingLogic),
+              segmentDuration(duration) {}
+
+        SimulationResult run(AbstractAdaptationLogic *logic,
+                             const NetworkTrace &trace, unsigned count)
+        {
+            const ID &id = set->getID();
+            const vlc_tick_t min = bufferingLogic->getMinBuffering(playlist);
+            const vlc_tick_t max = bufferingLogic->getMaxBuffering(playlist);
+            const vlc_tick_t target = bufferingLogic->getStableBuffering(playlist);
+            BaseRepresentation *rep = nullptr;
+            uint64_t bitrates = 0;
+
+            now = buffered = 0;
+            playing = started = false;
+            result = SimulationResult();
+
+            logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+            for(unsigned i=0; i<count; i++)
+            {
+                /* fetching is suspended while above the maximum */
+                if(playing && buffered > max)
+                    advance(buffered - max);
+
+                logic->trackerEvent(BufferingLevelChangedEvent(id, min, max,
+                                                               buffered, target));
+                BaseRepresentation *next = logic->getNextRepresentation(set, rep);
+                if(next == nullptr)
+                    break;
+                if(next != rep)
+                {
+                    logic->trackerEvent(RepresentationSwitchEvent(rep, next));
+                    if(rep)
+                        result.switches++;
+                    rep = next;
+                }
+                logic->trackerEvent(SegmentChangedEvent(id, segmentDuration * i,
+                                                        segmentDuration * i,
+                                                        segmentDuration));
+
+                download(logic, id, trace,
+                         rep->getBandwidth() * segmentDuration / CLOCK_FREQ / 8);
+
+                buffered += segmentDuration;
+                bitrates += rep->getBandwidth();
+                result.bitrate = bitrates / (i + 1);
+
+                if(!playing && (buffered >= min || i + 1 == count))
+                {
+                    playing = true;
+                    if(!started)
+                        result.startup = now;
+                    started = true;
+                }
+            }
+            logic->trackerEvent(BufferingStateUpdatedEvent(id, false));
+
+            return result;
+        }
+
+    private:
+        void download(AbstractAdaptationLogic *logic, const ID &id,
+                      const NetworkTrace &trace, size_t size)
+        {
+            const vlc_tick_t start = now;
+            const vlc_tick_t latency = trace.at(now).rtt;
+            advance(latency);
+            for(size_t done = 0; done < size; )
+            {
+                const size_t sample = (size - done < TRANSFER_SAMPLE_SIZE)
+                                    ? size - done : TRANSFER_SAMPLE_SIZE;
+                const vlc_tick_t time = trace.transferTime(now, sample);
+                advance(time);
+                logic->updateTransferRate(id, sample, time);
+                done += sample;
+            }
+            logic->updateDownloadRate(id, size, now - start, latency);
+        }
+
+        void advance(vlc_tick_t time)
+        {
+            if(playing)
+            {
+                if(time > buffered)
+                {
+                    result.rebuffering += time - buffered;
+                    result.stalls++;
+                    buffered = 0;
+                    playing = false;
+                }
+                else buffered -= time;
+            }
+            else if(started)
+            {
+                result.rebuffering += time;
+            }
+            now += time;
+        }
+
+        BasePlaylist *playlist;
+        BaseAdaptationSet *set;
+        AbstractBufferingLogic *bufferingLogic;
+        vlc_tick_t segmentDuration;
+
+        vlc_tick_t now;
+        vlc_tick_t buffered;
+        bool playing;
+        bool started;
+        SimulationResult result;
+};
+
+/* 2 minutes of 2s segments, or 1 minute of 1s parts at low latency */
+#define SIMULATION_SEGMENTS 60
+
+static SimulationResult Simulate(const char *name, AbstractAdaptationLogic *logic,
+                                 Simulation &simulation, const NetworkTrace &trace)
+{
+    SimulationResult result = simulation.run(logic, trace, SIMULATION_SEGMENTS);
+    delete logic;
+    std::cerr << "  " << name
+              << ": startup " << MS_FROM_VLC_TICK(result.startup) << "ms"
+              << " rebuffering " << MS_FROM_VLC_TICK(result.rebuffering) << "ms"
+              << " (" << result.stalls << " stalls)"
+              << " bitrate " << result.bitrate / 1000 << "kbps"
+              << " switches " << result.switches << std::endl;
+    return result;
+}
+
+static BasePlaylist * CreatePlaylist(bool lowlatency, BaseAdaptationSet **pset)
+{
+    SimulationPlaylist *playlist = new SimulationPlaylist(lowlatency);
+    BasePeriod *period = nullptr;
+    BaseAdaptationSet *set = nullptr;
+    try
+    {
+        period = new BasePeriod(playlist);
+        set = new BaseAdaptationSet(period);
+    } catch(...) {
+        delete period;
+        delete set;
+        delete playlist;
+        std::rethrow_exception(std::current_exception());
+    }
+    period->addAdaptationSet(set);
+    playlist->addPeriod(period);
+    set->setID(ID("simulation"));
+
+    const uint64_t bandwidths[] = { 400000, 800000, 1600000, 3200000, 6400000 };
+    for(size_t i=0; i<ARRAY_SIZE(bandwidths); i++)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setBandwidth(bandwidths[i]);
+        set->addRepresentation(rep);
+    }
+
+    *pset = set;
+    return playlist;
+}
+
+int Simulation_test()
+{
+    BasePlaylist *playlist = nullptr;
+    try
+    {
+        const NetworkTrace steady({
+            { 0, 4000000, VLC_TICK_FROM_MS(50) },
+        });
+        const NetworkTrace drop({
+            { VLC_TICK_FROM_SEC(30), 5000000, VLC_TICK_FROM_MS(40) },
+            { VLC_TICK_FROM_SEC(30),  600000, VLC_TICK_FROM_MS(200) },
+            { 0, 5000000, VLC_TICK_FROM_MS(40) },
+        });
+        std::vector<NetworkTrace::Step> steps;
+        for(int i=0; i<40; i++)
+            steps.push_back({ VLC_TICK_FROM_SEC(4), (i % 2) ? 1500000u : 3000000u,
+                              VLC_TICK_FROM_MS(80) });
+        const NetworkTrace oscillating(steps);
+
+        BaseAdaptationSet *set;
+        DefaultBufferingLogic bufferingLogic;
+        const vlc_tick_t duration = VLC_TICK_FROM_SEC(2);
+        SimulationResult lowest, best, rated, hybrid;
+
+        /* transfer time over a step boundary */
+        Expect(drop.transferTime(VLC_TICK_FROM_SEC(29), 625000 + 75000) ==
+               VLC_TICK_FROM_SEC(2));
+
+        playlist = CreatePlaylist(false, &set);
+        Simulation simulation(playlist, set, &bufferingLogic, duration);
+
+        std::cerr << " steady" << std::endl;
+        lowest = Simulate("lowest", new AlwaysLowestAdaptationLogic(nullptr),
+                          simulation, steady);
+        Expect(lowest.rebuffering == 0);
+        Expect(lowest.switches == 0);
+        Expect(lowest.bitrate == 400000);
+        Expect(lowest.startup > 0);
+        best = Simulate("best", new AlwaysBestAdaptationLogic(nullptr),
+                        simulation, steady);
+        Expect(best.rebuffering > 0);
+        Expect(best.switches == 0);
+        Expect(best.startup > lowest.startup);
+        rated = Simulate("rate", new RateBasedAdaptationLogic(nullptr),
+                         simulation, steady);
+        Simulate("predictive", new PredictiveAdaptationLogic(nullptr),
+                 simulation, steady);
+        Simulate("nearoptimal", new NearOptimalAdaptationLogic(nullptr),
+                 simulation, steady);
+        hybrid = Simulate("hybrid", new HybridAdaptationLogic(nullptr),
+                          simulation, steady);
+        Expect(rated.bitrate > lowest.bitrate);
+        Expect(hybrid.rebuffering == 0);
+        Expect(hybrid.bitrate > lowest.bitrate);
+        Expect(hybrid.bitrate < 4000000);
+
+        std::cerr << " drop" << std::endl;
+        lowest = Simulate("lowest", new AlwaysLowestAdaptationLogic(nullptr),
+                          simulation, drop);
+        Expect(lowest.rebuffering == 0);
+        best = Simulate("best", new AlwaysBestAdaptationLogic(nullptr),
+                        simulation, drop);
+        Simulate("rate", new RateBasedAdaptationLogic(nullptr),
+                 simulation, drop);
+        Simulate("predictive", new PredictiveAdaptationLogic(nullptr),
+                 simulation, drop);
+        Simulate("nearoptimal", new NearOptimalAdaptationLogic(nullptr),
+                 simulation, drop);
+        hybrid = Simulate("hybrid", new HybridAdaptationLogic(nullptr),
+                          simulation, drop);
+        Expect(hybrid.rebuffering < best.rebuffering);
+        Expect(hybrid.switches > 0);
+
+        delete playlist;
+        playlist = CreatePlaylist(true, &set);
+        Simulation lowlatency(playlist, set, &bufferingLogic, VLC_TICK_FROM_SEC(1));
+
+        std::cerr << " low latency, oscillating" << std::endl;
+        lowest = Simulate("lowest", new AlwaysLowestAdaptationLogic(nullptr),
+                          lowlatency, oscillating);
+        Expect(lowest.rebuffering == 0);
+        Simulate("best", new AlwaysBestAdaptationLogic(nullptr),
+                 lowlatency, oscillating);
+        Simulate("rate", new RateBasedAdaptationLogic(nullptr),
+                 lowlatency, oscillating);
+        Simulate("predictive", new PredictiveAdaptationLogic(nullptr),
+                 lowlatency, oscillating);
+        Simulate("nearoptimal", new NearOptimalAdaptationLogic(nullptr),
+                 lowlatency, oscillating);
+        hybrid = Simulate("hybrid", new HybridAdaptationLogic(nullptr),
+                          lowlatency, oscillating);
+        Expect(hybrid.bitrate > lowest.bitrate);
+        Expect(hybrid.bitrate < 3000000);
+
+        delete playlist;
+    } catch(...) {
+        delete playlist;
+        return 1;
+    }
+
+    return 0;
+}
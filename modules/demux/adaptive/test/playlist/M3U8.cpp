@@ -382,6 +382,88 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 5: low latency */
+    const char manifest5[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.5\n"
+    "#EXT-X-PART-INF:PART-TARGET=0.5\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4,\n"
+    "foobar10.mp4\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"foobar11.0.mp4\",INDEPENDENT=YES\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"foobar11.1.mp4\"\n"
+    "#EXTINF:1,\n"
+    "foobar11.mp4\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"foobar12.mp4\",BYTERANGE=\"1000@0\",INDEPENDENT=YES\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"foobar12.mp4\",BYTERANGE=\"800\"\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"foobar12.mp4\",BYTERANGE-START=1800\n";
+
+    /* Manifest 6: same, once segment 12 is complete */
+    const char manifest6[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.5\n"
+    "#EXT-X-PART-INF:PART-TARGET=0.5\n"
+    "#EXT-X-MEDIA-SEQUENCE:11\n"
+    "#EXTINF:1,\n"
+    "foobar11.mp4\n"
+    "#EXTINF:1.5,\n"
+    "foobar12.mp4\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"foobar13.0.mp4\"\n";
+
+    m3u = ParseM3U8(obj, manifest5, sizeof(manifest5));
+    M3U8 *m3u6 = ParseM3U8(obj, manifest6, sizeof(manifest6));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u6);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        Expect(m3u->suggestedPresentationDelay.Get() == VLC_TICK_FROM_MS(1500));
+        Expect(bufferingLogic.getLiveDelay(m3u) == std::max(VLC_TICK_FROM_MS(1500),
+                                                            bufferingLogic.getMinBuffering(m3u)));
+
+        HLSRepresentation *rep = dynamic_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                    getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep);
+        Expect(rep->getPartTargetDuration() == VLC_TICK_FROM_MS(500));
+        const Timescale timescale = rep->inheritTimescale();
+
+        /* segment being published is listed from its parts */
+        HLSSegment *seg = dynamic_cast<HLSSegment *>(rep->getMediaSegment(11));
+        Expect(seg);
+        Expect(seg->isComplete());
+        seg = dynamic_cast<HLSSegment *>(rep->getMediaSegment(12));
+        Expect(seg);
+        Expect(!seg->isComplete());
+        Expect(seg->startTime.Get() == timescale.ToScaled(vlc_tick_from_sec(5)));
+        Expect(seg->duration.Get() == timescale.ToScaled(VLC_TICK_FROM_MS(1500)));
+        Expect(rep->getMediaSegment(13) == nullptr);
+
+        /* the edge segment is usable in low latency */
+        Expect(bufferingLogic.getStartSegmentNumber(rep) >= 11);
+
+        HLSRepresentation *rep6 = dynamic_cast<HLSRepresentation *>(m3u6->getFirstPeriod()->
+                                    getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep6);
+        seg->updateWith(rep6->getMediaSegment(12));
+        Expect(seg->isComplete());
+        Expect(seg->duration.Get() == timescale.ToScaled(VLC_TICK_FROM_MS(1500)));
+        HLSSegment *seg13 = dynamic_cast<HLSSegment *>(rep6->getMediaSegment(13));
+        Expect(seg13);
+        Expect(!seg13->isComplete());
+
+        delete m3u;
+        delete m3u6;
+    }
+    catch (...)
+    {
+        delete m3u;
+        delete m3u6;
+        return 1;
+    }
+
 
     return 0;
 }
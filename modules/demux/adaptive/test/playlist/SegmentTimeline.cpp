@@ -171,6 +171,31 @@ int Timeline_test()
         timeline->updateWith(*timeline2);
         Expect(timeline->maxElementNumber() == 4+99+10);
 
+        /* Run-length, contiguous elements of the same duration are merged */
+        delete timeline2;
+        timeline2 = new SegmentTimeline(nullptr);
+        timeline2->setRunLength(true);
+        timeline2->addElement(1, 100, 0, START);
+        timeline2->addElement(2, 100, 0, 0);
+        timeline2->addElement(3, 100, 1, START + 200);
+        timeline2->addElement(5, 50, 0, 0);
+        Expect(timeline2->getElementIndexBySequence(4) == 0);
+        Expect(timeline2->getElementIndexBySequence(5) == 1);
+        Expect(timeline2->maxElementNumber() == 5);
+        Expect(timeline2->getTotalLength() == 450);
+        Expect(timeline2->getScaledPlaybackTimeDurationBySegmentNumber(4, &time, &duration));
+        Expect(time == START + 300);
+        Expect(duration == 100);
+
+        delete timeline;
+        timeline = new SegmentTimeline(nullptr);
+        timeline->addElement(5, 50, 2, START + 400);
+        timeline->addElement(8, 50, 0, 0);
+        timeline2->updateWith(*timeline);
+        Expect(timeline2->maxElementNumber() == 8);
+        Expect(timeline2->getElementIndexBySequence(8) == 1);
+        Expect(timeline2->getTotalLength() == 600);
+
         delete timeline;
         delete timeline2;
 
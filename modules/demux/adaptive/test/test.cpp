@@ -45,7 +45,10 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(HybridAdaptationLogic) ||
+    TEST(Simulation) ||
     TEST(CommandsQueue) ||
+    TEST(ChunkCache) ||
     TEST(M3U8MasterPlaylist) ||
     TEST(M3U8Playlist);
 }
@@ -47,5 +47,8 @@ int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
 int CommandsQueue_test();
 int BufferingLogic_test();
+int HybridAdaptationLogic_test();
+int Simulation_test();
+int ChunkCache_test();
 
 #endif
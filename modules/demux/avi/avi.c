@@ -37,6 +37,7 @@
 #include <vlc_input.h>
 
 #include <vlc_dialog.h>
+#include <vlc_interrupt.h>
 
 #include <vlc_meta.h>
 #include <vlc_codecs.h>
@@ -57,6 +58,11 @@
     "Recreate a index for the AVI file. Use this if your AVI file is damaged "\
     "or incomplete (not seekable)." )
 
+#define INDEX_BG_TEXT N_("Create the index during playback")
+#define INDEX_BG_LONGTEXT N_( \
+    "Build a missing or broken index in the background while the file " \
+    "plays, instead of before playback." )
+
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
@@ -80,6 +86,8 @@ vlc_module_begin ()
     add_integer( "avi-index", 0,
               INDEX_TEXT, INDEX_LONGTEXT )
         change_integer_list( pi_index, ppsz_indexes )
+    add_bool( "avi-index-background", true,
+              INDEX_BG_TEXT, INDEX_BG_LONGTEXT )
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -138,6 +146,20 @@ static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
 
+/* LIST-movi walk creating the indexes */
+typedef struct
+{
+    stream_t        *s;
+    uint64_t        i_movi_pos;
+    uint64_t        i_movi_end;
+    uint64_t        i_avix_pos;  /* data of the first RIFF-AVIX, 0 if none */
+
+    avi_index_t     *p_idx;      /* one per track */
+    uint64_t        i_last_pos;
+    vlc_mutex_t     *p_lock;     /* held while appending, if not NULL */
+    vlc_dialog_id   *p_dialog_id;
+} avi_index_scan_t;
+
 typedef struct
 {
     bool            b_activated;
@@ -195,6 +217,18 @@ typedef struct
 
     unsigned int       i_attachment;
     input_attachment_t **attachment;
+
+    /* index created during playback */
+    struct
+    {
+        bool             b_started;
+        vlc_thread_t     thread;
+        vlc_interrupt_t  *p_interrupt;
+        vlc_mutex_t      lock;
+        avi_index_scan_t scan;        /* indexes under lock */
+        uint32_t         *pi_adopted; /* entries merged in each track */
+        bool             b_done;      /* under lock */
+    } indexer;
 } demux_sys_t;
 
 #define __EVEN(x) (((x) & 1) ? (x) + 1 : (x))
@@ -214,12 +248,15 @@ static int AVI_StreamBytesSet ( demux_t *,
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( vlc_fourcc_t , uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static int  AVI_IndexerStart ( demux_t * );
+static void AVI_IndexerStop  ( demux_t * );
+static void AVI_IndexerAdopt ( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -272,6 +309,8 @@ static void Close ( vlc_object_t * p_this )
     demux_t *    p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    AVI_IndexerStop( p_demux );
+
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         if( p_sys->track[i] )
@@ -695,7 +734,9 @@ static int Open( vlc_object_t * p_this )
 aviindex:
         if( p_sys->b_fastseekable )
         {
-            AVI_IndexCreate( p_demux );
+            if( !var_InheritBool( p_demux, "avi-index-background" ) ||
+                AVI_IndexerStart( p_demux ) )
+                AVI_IndexCreate( p_demux );
         }
         else if( p_sys->b_seekable )
         {
@@ -734,7 +775,7 @@ aviindex:
                 b_index = true;
                 goto aviindex;
             }
-            if( i_do_index == 0 )
+            if( i_do_index == 0 && !var_InheritBool( p_demux, "avi-index-background" ) )
             {
                 const char *psz_msg = _(
                     "Because this file index is broken or missing, "
@@ -882,29 +923,29 @@ static block_t * ReadFrame( demux_t *p_demux, const avi_track_t *tk,
     }
     else
     {
-        block_t *p_flippedframe = block_Alloc( p_frame->i_buffer );
-        if ( !p_flippedframe )
-        {
-            block_Release( p_frame );
-            return NULL;
-        }
-
-        unsigned int i_lines = p_frame->i_buffer / i_stride_bytes;
-        const uint8_t *p_src = p_frame->p_buffer + i_lines * i_stride_bytes;
-        uint8_t *p_dst = p_flippedframe->p_buffer;
-
-        p_flippedframe->i_buffer = 0;
+        /* flip the lines in place, then pack them */
+        const unsigned int i_lines = p_frame->i_buffer / i_stride_bytes;
+        uint8_t *p_top = p_frame->p_buffer;
+        uint8_t *p_bottom = p_frame->p_buffer + ( i_lines - 1 ) * i_stride_bytes;
 
-        while ( i_lines-- > 0 )
+        while ( p_top < p_bottom )
         {
-            p_src -= i_stride_bytes;
-            memcpy( p_dst, p_src, tk->bihprops.i_stride );
-            p_dst += tk->bihprops.i_stride;
-            p_flippedframe->i_buffer += tk->bihprops.i_stride;
+            uint8_t p_swap[256];
+            for( unsigned int i = 0; i < tk->bihprops.i_stride; i += sizeof(p_swap) )
+            {
+                size_t i_copy = __MIN( sizeof(p_swap), tk->bihprops.i_stride - i );
+                memcpy( p_swap, &p_top[i], i_copy );
+                memcpy( &p_top[i], &p_bottom[i], i_copy );
+                memcpy( &p_bottom[i], p_swap, i_copy );
+            }
+            p_top += i_stride_bytes;
+            p_bottom -= i_stride_bytes;
         }
 
-        block_Release( p_frame );
-        p_frame = p_flippedframe;
+        for( unsigned int i = 1; i < i_lines; i++ )
+            memmove( &p_frame->p_buffer[i * tk->bihprops.i_stride],
+                     &p_frame->p_buffer[i * i_stride_bytes], tk->bihprops.i_stride );
+        p_frame->i_buffer = i_lines * tk->bihprops.i_stride;
     }
 
     return p_frame;
@@ -978,6 +1019,7 @@ static int Demux_Seekable( demux_t *p_demux )
     /* cannot be more than 100 stream (dcXX or wbXX) */
     avi_track_toread_t toread[100];
 
+    AVI_IndexerAdopt( p_demux );
 
     /* detect new selected/unselected streams */
     for( i_track = 0; i_track < p_sys->i_track; i_track++ )
@@ -1123,7 +1165,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
                     return VLC_DEMUXER_EGENERIC;
 
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1138,7 +1180,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1147,7 +1189,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1179,7 +1221,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1359,7 +1401,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
     {
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -1376,18 +1418,18 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return VLC_DEMUXER_EOF;
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position @%"PRIu64", resync",
                               vlc_stream_Tell(p_demux->s) );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return VLC_DEMUXER_EGENERIC;
@@ -1414,7 +1456,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return VLC_DEMUXER_EOF;
                 }
@@ -1453,6 +1495,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
     {
         uint64_t i_pos_backup = vlc_stream_Tell( p_demux->s );
 
+        AVI_IndexerAdopt( p_demux );
+
         /* Check and lazy load indexes if it was not done (not fastseekable) */
         if ( !p_sys->b_indexloaded && ( p_sys->i_avih_flags & AVIF_HASINDEX ) )
         {
@@ -1820,7 +1864,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     {
         if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
             return VLC_EGENERIC;
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1833,7 +1877,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
     for( ;; )
     {
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1841,7 +1885,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1867,7 +1911,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -2164,17 +2208,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( vlc_stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = vlc_stream_Tell( p_demux->s );
+    p_pk->i_pos     = vlc_stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2191,12 +2235,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     size_t          i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2221,7 +2265,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     if( i_skip > SSIZE_MAX )
         return VLC_EGENERIC;
 
-    ssize_t i_ret = vlc_stream_Read( p_demux->s, NULL, i_skip );
+    ssize_t i_ret = vlc_stream_Read( s, NULL, i_skip );
     if( i_ret < 0 || (size_t) i_ret != i_skip )
     {
         return VLC_EGENERIC;
@@ -2229,7 +2273,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2237,11 +2281,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( vlc_stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2588,67 +2632,73 @@ static void AVI_IndexLoad( demux_t *p_demux )
     }
 }
 
-static void AVI_IndexCreate( demux_t *p_demux )
+static int AVI_IndexScanInit( demux_t *p_demux, avi_index_scan_t *p_scan,
+                              avi_index_t *p_idx )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     avi_chunk_list_t *p_riff;
     avi_chunk_list_t *p_movi;
 
-    unsigned int i_stream;
-    uint32_t i_movi_end;
-
-    vlc_tick_t i_dialog_update;
-    vlc_dialog_id *p_dialog_id = NULL;
-
     p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
     p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
 
     if( !p_movi )
     {
         msg_Err( p_demux, "cannot find p_movi" );
-        return;
+        return VLC_EGENERIC;
     }
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
+    avi_chunk_list_t *p_sysx = AVI_ChunkFind( &p_sys->ck_root,
+                                              AVIFOURCC_RIFF, 1, true );
 
-    i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
+    p_scan->s          = p_demux->s;
+    p_scan->i_movi_pos = p_movi->i_chunk_pos;
+    p_scan->i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
+                                stream_Size( p_demux->s ) );
+    p_scan->i_avix_pos = p_sysx ? p_sysx->i_chunk_pos + 24 : 0;
 
-    vlc_stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
-    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+    for( unsigned i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+        avi_index_Init( &p_idx[i_stream] );
+    p_scan->p_idx       = p_idx;
+    p_scan->i_last_pos  = 0;
+    p_scan->p_lock      = NULL;
+    p_scan->p_dialog_id = NULL;
 
+    return VLC_SUCCESS;
+}
 
-    /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = vlc_tick_now();
-    if( stream_Size( p_demux->s ) > 10000000 )
-    {
-        p_dialog_id =
-            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
-                                         _("Broken or missing AVI Index"),
-                                         _("Fixing AVI Index...") );
-    }
+static void AVI_IndexScan( demux_t *p_demux, avi_index_scan_t *p_scan )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    stream_t *s = p_scan->s;
+    vlc_tick_t i_dialog_update = vlc_tick_now();
+
+    if( vlc_stream_Seek( s, p_scan->i_movi_pos + 12 ) )
+        return;
 
     for( ;; )
     {
         avi_packet_t pk;
 
+        if( vlc_killed() )
+            break;
+
         /* Don't update/check dialog too often */
-        if( p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
+        if( p_scan->p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
         {
-            if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
+            if( vlc_dialog_is_cancelled( p_demux, p_scan->p_dialog_id ) )
                 break;
 
-            double f_current = vlc_stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
+            double f_current = vlc_stream_Tell( s );
+            double f_size    = stream_Size( s );
             double f_pos     = f_current / f_size;
-            vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
+            vlc_dialog_update_progress( p_demux, p_scan->p_dialog_id, f_pos );
 
             i_dialog_update = vlc_tick_now();
         }
 
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
+        if( AVI_PacketGetHeader( s, &pk ) )
             break;
 
         if( pk.i_stream < p_sys->i_track &&
@@ -2662,7 +2712,11 @@ static void AVI_IndexCreate( demux_t *p_demux )
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
             index.i_lengthtotal = pk.i_size;
-            avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
+            if( p_scan->p_lock != NULL )
+                vlc_mutex_lock( p_scan->p_lock );
+            avi_index_Append( &p_scan->p_idx[pk.i_stream], &p_scan->i_last_pos, &index );
+            if( p_scan->p_lock != NULL )
+                vlc_mutex_unlock( p_scan->p_lock );
         }
         else
         {
@@ -2671,17 +2725,13 @@ static void AVI_IndexCreate( demux_t *p_demux )
             case AVIFOURCC_idx1:
                 if( p_sys->b_odml )
                 {
-                    avi_chunk_list_t *p_sysx;
-                    p_sysx = AVI_ChunkFind( &p_sys->ck_root,
-                                            AVIFOURCC_RIFF, 1, true );
-
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( !p_sysx || vlc_stream_Seek( p_demux->s,
-                                         p_sysx->i_chunk_pos + 24 ) )
-                        goto print_stat;
+                    if( !p_scan->i_avix_pos ||
+                        vlc_stream_Seek( s, p_scan->i_avix_pos ) )
+                        return;
                     break;
                 }
-                goto print_stat;
+                return;
 
             case AVIFOURCC_RIFF:
                     msg_Dbg( p_demux, "new RIFF chunk found" );
@@ -2693,30 +2743,189 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
-                    goto print_stat;
+                    return;
                 }
             }
         }
 
-        if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+        if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= p_scan->i_movi_end ) ||
+            AVI_PacketNext( s ) )
         {
             break;
         }
     }
+}
+
+static void AVI_IndexCreate( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-print_stat:
-    if( p_dialog_id != NULL )
-        vlc_dialog_release( p_demux, p_dialog_id );
+    avi_index_scan_t scan;
+    avi_index_t p_idx[p_sys->i_track];
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    if( AVI_IndexScanInit( p_demux, &scan, p_idx ) )
+        return;
+
+    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+
+    /* Only show dialog if AVI is > 10MB */
+    if( stream_Size( p_demux->s ) > 10000000 )
+    {
+        scan.p_dialog_id =
+            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
+                                         _("Broken or missing AVI Index"),
+                                         _("Fixing AVI Index...") );
+    }
+
+    AVI_IndexScan( p_demux, &scan );
+
+    if( scan.p_dialog_id != NULL )
+        vlc_dialog_release( p_demux, scan.p_dialog_id );
+
+    for( unsigned i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
     {
+        avi_index_Clean( &p_sys->track[i_stream]->idx );
+        p_sys->track[i_stream]->idx = p_idx[i_stream];
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
                 i_stream, p_sys->track[i_stream]->idx.i_size );
     }
+    p_sys->i_movi_lastchunk_pos = __MAX( p_sys->i_movi_lastchunk_pos,
+                                         scan.i_last_pos );
+}
+
+/****************************************************************************
+ * Index created by a background scan of LIST-movi, through a stream of its
+ * own. The track indexes start empty and are extended as the scan goes.
+ ****************************************************************************/
+static void *AVI_IndexerThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_scan_t *p_scan = &p_sys->indexer.scan;
+
+    vlc_interrupt_set( p_sys->indexer.p_interrupt );
+
+    stream_t *s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( s != NULL )
+    {
+        vlc_tick_t i_start = vlc_tick_now();
+
+        p_scan->s = s;
+        AVI_IndexScan( p_demux, p_scan );
+        p_scan->s = NULL;
+        vlc_stream_Delete( s );
+
+        msg_Dbg( p_demux, "background index creation %s in %"PRId64" ms",
+                 vlc_killed() ? "aborted" : "completed",
+                 MS_FROM_VLC_TICK( vlc_tick_now() - i_start ) );
+    }
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    p_sys->indexer.b_done = true;
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+    return NULL;
+}
+
+static int AVI_IndexerStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_scan_t *p_scan = &p_sys->indexer.scan;
+
+    if( !p_demux->psz_url )
+        return VLC_EGENERIC;
+
+    avi_index_t *p_idx = malloc( p_sys->i_track * sizeof(*p_idx) );
+    p_sys->indexer.pi_adopted = calloc( p_sys->i_track, sizeof(uint32_t) );
+    p_sys->indexer.p_interrupt = vlc_interrupt_create();
+    if( !p_idx || !p_sys->indexer.pi_adopted || !p_sys->indexer.p_interrupt ||
+        AVI_IndexScanInit( p_demux, p_scan, p_idx ) )
+        goto error;
+
+    vlc_mutex_init( &p_sys->indexer.lock );
+    p_scan->p_lock = &p_sys->indexer.lock;
+    p_sys->indexer.b_done = false;
+
+    if( vlc_clone( &p_sys->indexer.thread, AVI_IndexerThread, p_demux,
+                   VLC_THREAD_PRIORITY_LOW ) )
+        goto error;
+
+    /* The damaged index is dropped, playback reads the new one */
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_index_Clean( &p_sys->track[i]->idx );
+        avi_index_Init( &p_sys->track[i]->idx );
+    }
+    p_sys->i_movi_lastchunk_pos = 0;
+
+    msg_Dbg( p_demux, "creating index from LIST-movi during playback" );
+    p_sys->indexer.b_started = true;
+    return VLC_SUCCESS;
+
+error:
+    if( p_sys->indexer.p_interrupt )
+        vlc_interrupt_destroy( p_sys->indexer.p_interrupt );
+    free( p_sys->indexer.pi_adopted );
+    free( p_idx );
+    return VLC_EGENERIC;
+}
+
+static void AVI_IndexerStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->indexer.b_started )
+        return;
+
+    vlc_interrupt_kill( p_sys->indexer.p_interrupt );
+    vlc_join( p_sys->indexer.thread, NULL );
+    vlc_interrupt_destroy( p_sys->indexer.p_interrupt );
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Clean( &p_sys->indexer.scan.p_idx[i] );
+    free( p_sys->indexer.scan.p_idx );
+    free( p_sys->indexer.pi_adopted );
+    p_sys->indexer.b_started = false;
+}
+
+/* Appends the chunks found since the last call to the track indexes */
+static void AVI_IndexerAdopt( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->indexer.b_started )
+        return;
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        const avi_index_t *p_src = &p_sys->indexer.scan.p_idx[i];
+        avi_index_t *p_dst = &p_sys->track[i]->idx;
+        uint32_t *pi_adopted = &p_sys->indexer.pi_adopted[i];
+
+        /* skip what playback already indexed by itself */
+        uint64_t i_last_pos = p_dst->i_size > 0 ?
+                              p_dst->p_entry[p_dst->i_size - 1].i_pos : 0;
+        while( *pi_adopted < p_src->i_size &&
+               p_src->p_entry[*pi_adopted].i_pos <= i_last_pos )
+            (*pi_adopted)++;
+
+        for( ; *pi_adopted < p_src->i_size; (*pi_adopted)++ )
+        {
+            avi_entry_t index = p_src->p_entry[*pi_adopted];
+            avi_index_Append( p_dst, &p_sys->i_movi_lastchunk_pos, &index );
+        }
+    }
+    bool b_done = p_sys->indexer.b_done;
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+
+    if( b_done )
+    {
+        AVI_IndexerStop( p_demux );
+        p_sys->i_length = __MAX( p_sys->i_length, AVI_MovieGetLength( p_demux ) );
+    }
 }
 
 /* */
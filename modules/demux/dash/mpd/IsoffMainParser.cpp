@@ -446,6 +446,7 @@ size_t IsoffMainParser::parseSegmentList(MPD *mpd, Node * segListNode, SegmentIn
 
             parseAvailability<SegmentInformation>(mpd, segListNode, info);
 
+            list->reserve(segments.size());
             uint64_t nzStartTime = 0;
             std::vector<Node *>::const_iterator it;
             for(it = segments.begin(); it != segments.end(); ++it)
@@ -519,6 +520,8 @@ void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType
     SegmentTimeline *timeline = new (std::nothrow) SegmentTimeline(base);
     if(timeline)
     {
+        /* Lists map their segments to the timeline elements */
+        timeline->setRunLength(dynamic_cast<SegmentTemplate *>(base) != nullptr);
         std::vector<Node *> elements = DOMHelper::getElementByTagName(node, "S", false);
         std::vector<Node *>::const_iterator it;
         for(it = elements.begin(); it != elements.end(); ++it)
@@ -84,6 +84,7 @@ typedef struct
     vlc_meta_t *p_meta;
 
     vlc_tick_t i_pts;
+    vlc_tick_t i_next_pts; /* time of the frame following the output ones */
     struct flac_stream_info stream_info;
     bool b_stream_info;
 
@@ -106,6 +107,7 @@ typedef struct
 } demux_sys_t;
 
 #define FLAC_PACKET_SIZE 16384
+#define FLAC_SEEKPOINT_SPACING VLC_TICK_FROM_SEC(1)
 #define FLAC_MAX_PREROLL      VLC_TICK_FROM_SEC(4)
 #define FLAC_MAX_SLOW_PREROLL VLC_TICK_FROM_SEC(45)
 
@@ -146,6 +148,7 @@ static int Open( vlc_object_t * p_this )
     p_sys->p_meta = NULL;
     p_sys->i_length = 0;
     p_sys->i_pts = VLC_TICK_INVALID;
+    p_sys->i_next_pts = VLC_TICK_INVALID;
     p_sys->b_stream_info = false;
     p_sys->p_es = NULL;
     p_sys->p_current_block = NULL;
@@ -254,6 +257,7 @@ static void FlushPacketizer( decoder_t *p_packetizer )
 static void Reset( demux_sys_t *p_sys )
 {
     p_sys->i_pts = VLC_TICK_INVALID;
+    p_sys->i_next_pts = VLC_TICK_INVALID;
 
     FlushPacketizer( p_sys->p_packetizer );
     if( p_sys->p_current_block )
@@ -353,6 +357,32 @@ static int RefineSeek( demux_t *p_demux, vlc_tick_t i_time, double i_bytemicrora
     return b_found ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Inserts a seekpoint discovered while playing, unless one is close by */
+static void AddSeekpoint( demux_sys_t *p_sys, vlc_tick_t i_time,
+                          uint64_t i_byte_offset )
+{
+    int i = p_sys->i_seekpoint;
+
+    while( i > 0 && p_sys->seekpoint[i - 1]->i_time_offset > i_time )
+        i--;
+
+    if( i > 0 &&
+        ( i_time - p_sys->seekpoint[i - 1]->i_time_offset < FLAC_SEEKPOINT_SPACING ||
+          i_byte_offset <= p_sys->seekpoint[i - 1]->i_byte_offset ) )
+        return;
+    if( i < p_sys->i_seekpoint &&
+        ( p_sys->seekpoint[i]->i_time_offset - i_time < FLAC_SEEKPOINT_SPACING ||
+          i_byte_offset >= p_sys->seekpoint[i]->i_byte_offset ) )
+        return;
+
+    flac_seekpoint_t *s = malloc( sizeof (*s) );
+    if( unlikely(s == NULL) )
+        return;
+    s->i_time_offset = i_time;
+    s->i_byte_offset = i_byte_offset;
+    TAB_INSERT( p_sys->i_seekpoint, p_sys->seekpoint, s, i );
+}
+
 /*****************************************************************************
  * Demux: reads and demuxes data packets
  *****************************************************************************
@@ -366,6 +396,12 @@ static int Demux( demux_t *p_demux )
     bool b_eof = false;
     if( p_sys->p_current_block == NULL )
     {
+        /* The frames are timestamped by their headers: remember where the
+         * data following the output frames starts, for later seeks */
+        if( p_sys->i_next_pts != VLC_TICK_INVALID )
+            AddSeekpoint( p_sys, p_sys->i_next_pts - VLC_TICK_0,
+                          vlc_stream_Tell( p_demux->s ) - p_sys->i_data_pos );
+
         p_sys->p_current_block = vlc_stream_Block( p_demux->s, FLAC_PACKET_SIZE );
         b_eof = (p_sys->p_current_block == NULL);
     }
@@ -395,7 +431,10 @@ static int Demux( demux_t *p_demux )
                 es_out_SetPCR( p_demux->out, __MAX(p_block_out->i_dts - 1, VLC_TICK_0) );
 
             if(p_block_out->i_dts != VLC_TICK_INVALID)
+            {
                 p_sys->i_pts = p_block_out->i_dts;
+                p_sys->i_next_pts = p_block_out->i_dts + p_block_out->i_length;
+            }
 
             es_out_Send( p_demux->out, p_sys->p_es, p_block_out );
 
@@ -480,8 +519,10 @@ static int ControlSetTime( demux_t *p_demux, vlc_tick_t i_time )
             if( p_sys->seekpoint[i]->i_time_offset <= i_time )
                 break;
         }
+        if( i < 0 )
+            i = 0;
 
-        i_lower = p_sys->seekpoint[0]->i_byte_offset + p_sys->i_data_pos;
+        i_lower = p_sys->seekpoint[i]->i_byte_offset + p_sys->i_data_pos;
         if( i+1 < p_sys->i_seekpoint )
             i_upper = p_sys->seekpoint[i+1]->i_byte_offset + p_sys->i_data_pos;
 
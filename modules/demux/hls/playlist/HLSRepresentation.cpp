@@ -33,6 +33,8 @@
 #include "../../adaptive/playlist/SegmentList.h"
 
 #include <ctime>
+#include <sstream>
+#include <algorithm>
 #include <limits>
 #include <cassert>
 
@@ -47,6 +49,12 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     b_failed = false;
     lastUpdateTime = 0;
     targetDuration = 0;
+    partTargetDuration = 0;
+    b_canBlockReload = false;
+    nextMediaSequence = 0;
+    nextPart = 0;
+    canSkipUntil = 0;
+    b_skipFailed = false;
     streamFormat = StreamFormat::Type::Unknown;
 }
 
@@ -89,6 +97,55 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getPlaylistUpdateUrl() const
+{
+    std::string url = getPlaylistUrl().toString();
+    if(!b_loaded)
+        return url;
+
+    std::stringstream ss;
+    ss.imbue(std::locale("C"));
+    char sep = (url.find('?') == std::string::npos) ? '?' : '&';
+    /* Blocking reload: the server answers once that part is available */
+    if(b_canBlockReload)
+    {
+        ss << sep << "_HLS_msn=" << nextMediaSequence;
+        if(partTargetDuration)
+            ss << "&_HLS_part=" << nextPart;
+        sep = '&';
+    }
+    /* Delta update, only listing the segments after the skip boundary.
+     * Requires our copy to be no older than half of that boundary */
+    if(canSkipUntil && !b_skipFailed && lastUpdateTime &&
+       vlc_tick_now() - lastUpdateTime < canSkipUntil / 2)
+        ss << sep << "_HLS_skip=YES";
+    return url.append(ss.str());
+}
+
+bool HLSRepresentation::isLowLatency() const
+{
+    return b_live && partTargetDuration > 0;
+}
+
+vlc_tick_t HLSRepresentation::getPartTargetDuration() const
+{
+    return partTargetDuration;
+}
+
+bool HLSRepresentation::reloadParts(SharedResources *res)
+{
+    /* Without blocking reloads, poll at the parts pace */
+    if(!b_canBlockReload)
+        vlc_tick_sleep(std::max(partTargetDuration / 2, VLC_TICK_FROM_MS(100)));
+
+    BasePlaylist *playlist = getPlaylist();
+    M3U8Parser parser(res);
+    if(!parser.appendSegmentsFromPlaylistURI(playlist->getVLCObject(), this))
+        return false;
+    lastUpdateTime = vlc_tick_now();
+    return true;
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -135,9 +192,12 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
     {
         const vlc_tick_t now = vlc_tick_now();
         const vlc_tick_t elapsed = now - lastUpdateTime;
-        const vlc_tick_t duration = targetDuration
-                                  ? vlc_tick_from_sec(targetDuration)
-                                  : VLC_TICK_FROM_SEC(2);
+        vlc_tick_t duration = targetDuration
+                            ? vlc_tick_from_sec(targetDuration)
+                            : VLC_TICK_FROM_SEC(2);
+        /* new parts are published at the part target pace */
+        if(isLowLatency())
+            duration = partTargetDuration;
         if(elapsed < duration)
             return false;
 
@@ -54,7 +54,13 @@ namespace hls
 
                 virtual uint64_t translateSegmentNumber(uint64_t, const BaseRepresentation *) const override;
 
+                /* Low latency */
+                bool isLowLatency() const;
+                vlc_tick_t getPartTargetDuration() const;
+                bool reloadParts(SharedResources *);
+
             private:
+                std::string getPlaylistUpdateUrl() const;
                 StreamFormat streamFormat;
                 bool b_live;
                 bool b_loaded;
@@ -62,6 +68,12 @@ namespace hls
                 vlc_tick_t lastUpdateTime;
                 time_t targetDuration;
                 Url playlistUrl;
+                vlc_tick_t partTargetDuration;
+                bool b_canBlockReload;
+                uint64_t nextMediaSequence; /* to be requested on blocking reload */
+                unsigned nextPart;
+                vlc_tick_t canSkipUntil; /* playlist delta updates */
+                bool b_skipFailed;
         };
     }
 }
@@ -22,11 +22,268 @@
 #endif
 
 #include "HLSSegment.hpp"
-#include "../../adaptive/playlist/BaseRepresentation.h"
+#include "HLSRepresentation.hpp"
+#include "../../adaptive/playlist/BaseAdaptationSet.h"
+#include "../../adaptive/playlist/SegmentChunk.hpp"
+#include "../../adaptive/http/HTTPConnectionManager.h"
 
+#include <vlc_block.h>
 
+#include <algorithm>
+
+using namespace adaptive::http;
 using namespace hls::playlist;
 
+namespace hls
+{
+    namespace playlist
+    {
+        /* Reads the parts of a segment as they get published, reloading
+         * the playlist when the known ones have been consumed */
+        class HLSPartsChunkSource : public AbstractChunkSource
+        {
+            public:
+                HLSPartsChunkSource(SharedResources *, AbstractConnectionManager *,
+                                    HLSRepresentation *, const Url &,
+                                    const std::shared_ptr<HLSPartsList> &);
+
+                virtual block_t *   readBlock       () override;
+                virtual block_t *   read            (size_t) override;
+                virtual bool        hasMoreData     () const override;
+                virtual size_t      getBytesRead    () const override;
+                virtual std::string getContentType  () const override;
+                virtual void        recycle() override;
+
+            protected:
+                virtual ~HLSPartsChunkSource();
+
+            private:
+                block_t *           doRead(size_t, bool);
+                bool                openNextPart();
+                bool                open(const HLSPart &);
+                bool                covered(const HLSPart &) const;
+
+                SharedResources           *resources;
+                AbstractConnectionManager *connManager;
+                HLSRepresentation         *rep;
+                Url                        baseUrl;
+                std::shared_ptr<HLSPartsList> parts;
+                AbstractChunkSource       *current;
+                bool                       currentIsHint;
+                bool                       hintFailed;
+                size_t                     index; /* next part to read */
+                size_t                     consumed;
+                bool                       eof;
+                std::string                contentType;
+                /* what has been requested of the last resource, as hints and
+                 * byte ranged parts can overlap */
+                struct
+                {
+                    std::string uri;
+                    size_t      end; /* first byte not read */
+                    bool        whole;
+                } fetched;
+        };
+    }
+}
+
+HLSPart::HLSPart()
+{
+    startByte = 0;
+    endByte = 0;
+    byteRange = false;
+    duration = 0;
+    independent = false;
+    hint = false;
+}
+
+HLSPartsList::HLSPartsList()
+{
+    complete = false;
+}
+
+HLSPartsChunkSource::HLSPartsChunkSource(SharedResources *res,
+                                         AbstractConnectionManager *manager,
+                                         HLSRepresentation *rep_, const Url &url,
+                                         const std::shared_ptr<HLSPartsList> &list)
+    : AbstractChunkSource(ChunkType::Segment)
+{
+    resources = res;
+    connManager = manager;
+    rep = rep_;
+    baseUrl = url;
+    parts = list;
+    current = nullptr;
+    currentIsHint = false;
+    hintFailed = false;
+    index = 0;
+    consumed = 0;
+    eof = false;
+    fetched.end = 0;
+    fetched.whole = false;
+}
+
+HLSPartsChunkSource::~HLSPartsChunkSource()
+{
+    if(current)
+        connManager->recycleSource(current);
+}
+
+bool HLSPartsChunkSource::covered(const HLSPart &part) const
+{
+    if(part.uri != fetched.uri)
+        return false;
+    if(!part.byteRange || fetched.whole)
+        return true;
+    /* open ended hints are satisfied by any data past their start */
+    const size_t end = part.endByte ? part.endByte + 1 : part.startByte + 1;
+    return end <= fetched.end;
+}
+
+bool HLSPartsChunkSource::open(const HLSPart &part)
+{
+    Url url(part.uri);
+    if(!url.hasScheme())
+    {
+        Url ret = baseUrl;
+        url = ret.append(url);
+    }
+
+    if(part.uri != fetched.uri)
+    {
+        fetched.uri = part.uri;
+        fetched.end = 0;
+        fetched.whole = false;
+    }
+
+    BytesRange range;
+    if(part.byteRange)
+    {
+        /* skip what an overlapping request already returned */
+        size_t start = std::max(part.startByte, fetched.end);
+        range = BytesRange(start, part.endByte);
+        fetched.end = start;
+    }
+    else fetched.whole = true;
+
+    current = connManager->makeSource(url.toString(),
+                                      rep->getAdaptationSet()->getID(),
+                                      ChunkType::Segment, range);
+    if(!current)
+        return false;
+    currentIsHint = part.hint;
+    connManager->start(current);
+    return true;
+}
+
+bool HLSPartsChunkSource::openNextPart()
+{
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    for(;;)
+    {
+        const std::vector<HLSPart> &list = parts->parts;
+        while(index < list.size())
+        {
+            const HLSPart &part = list[index];
+            /* hints are always last and get replaced by the published part */
+            if(part.hint)
+            {
+                if(hintFailed || covered(part))
+                    break;
+                return open(part);
+            }
+            index++;
+            if(!covered(part))
+                return open(part);
+        }
+
+        if(parts->complete)
+            return false;
+
+        const vlc_tick_t now = vlc_tick_now();
+        if(deadline == VLC_TICK_INVALID)
+            deadline = now + 3 * std::max(rep->getPartTargetDuration(),
+                                          VLC_TICK_FROM_MS(200));
+        else if(now > deadline)
+            return false;
+
+        if(!rep->reloadParts(resources))
+            return false;
+        hintFailed = false;
+    }
+}
+
+block_t * HLSPartsChunkSource::doRead(size_t size, bool b_block)
+{
+    while(!eof)
+    {
+        if(!current && !openNextPart())
+        {
+            eof = true;
+            break;
+        }
+
+        block_t *p_block = b_block ? current->readBlock() : current->read(size);
+        if(p_block)
+        {
+            if(contentType.empty())
+                contentType = current->getContentType();
+            consumed += p_block->i_buffer;
+            fetched.end += p_block->i_buffer;
+            return p_block;
+        }
+
+        const RequestStatus status = current->getRequestStatus();
+        connManager->recycleSource(current);
+        current = nullptr;
+        if(status != RequestStatus::Success)
+        {
+            if(currentIsHint)
+            {
+                /* not available yet, wait for the next playlist */
+                fetched.uri.clear();
+                hintFailed = true;
+            }
+            else
+            {
+                requeststatus = status;
+                eof = true;
+            }
+        }
+    }
+    return nullptr;
+}
+
+block_t * HLSPartsChunkSource::readBlock()
+{
+    return doRead(0, true);
+}
+
+block_t * HLSPartsChunkSource::read(size_t size)
+{
+    return doRead(size, false);
+}
+
+bool HLSPartsChunkSource::hasMoreData() const
+{
+    return !eof;
+}
+
+size_t HLSPartsChunkSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string HLSPartsChunkSource::getContentType() const
+{
+    return contentType;
+}
+
+void HLSPartsChunkSource::recycle()
+{
+    delete this;
+}
+
 HLSSegment::HLSSegment( ICanonicalUrl *parent, uint64_t seq ) :
     Segment( parent )
 {
@@ -40,23 +297,78 @@ HLSSegment::~HLSSegment()
 
 bool HLSSegment::prepareChunk(SharedResources *res, SegmentChunk *chunk, BaseRepresentation *rep)
 {
-    if(encryption.method == CommonEncryption::Method::AES_128)
+    if(encryption && encryption->method == CommonEncryption::Method::AES_128)
     {
-        if (encryption.iv.size() != 16)
+        if (encryption->iv.size() != 16)
         {
+            /* key is shared with the other segments, but not the implicit IV */
+            std::shared_ptr<CommonEncryption> enc = std::make_shared<CommonEncryption>(*encryption);
             uint64_t sequence = getSequenceNumber();
-            encryption.iv.clear();
-            encryption.iv.resize(16);
-            encryption.iv[15] = (sequence >> 0) & 0xff;
-            encryption.iv[14] = (sequence >> 8) & 0xff;
-            encryption.iv[13] = (sequence >> 16) & 0xff;
-            encryption.iv[12] = (sequence >> 24) & 0xff;
+            enc->iv.clear();
+            enc->iv.resize(16);
+            enc->iv[15] = (sequence >> 0) & 0xff;
+            enc->iv[14] = (sequence >> 8) & 0xff;
+            enc->iv[13] = (sequence >> 16) & 0xff;
+            enc->iv[12] = (sequence >> 24) & 0xff;
+            encryption = enc;
         }
     }
 
     return Segment::prepareChunk(res, chunk, rep);
 }
 
+bool HLSSegment::isComplete() const
+{
+    return !parts || parts->complete;
+}
+
+void HLSSegment::updateWith(ISegment *updated_)
+{
+    HLSSegment *updated = dynamic_cast<HLSSegment *>(updated_);
+    if(!updated || isComplete())
+        return;
+
+    /* playlists always list all the parts of a segment */
+    if(updated->parts)
+        parts->parts = updated->parts->parts;
+    duration.Set(updated->duration.Get());
+    if(updated->isComplete())
+    {
+        sourceUrl = updated->sourceUrl;
+        setByteRange(updated->startByte, updated->endByte);
+        parts->complete = true;
+    }
+}
+
+SegmentChunk* HLSSegment::toChunk(SharedResources *res, AbstractConnectionManager *connManager,
+                                  size_t index, BaseRepresentation *rep)
+{
+    HLSRepresentation *hlsrep = dynamic_cast<HLSRepresentation *>(rep);
+    if(isComplete() || !hlsrep)
+        return Segment::toChunk(res, connManager, index, rep);
+
+    AbstractChunkSource *source = new (std::nothrow)
+            HLSPartsChunkSource(res, connManager, hlsrep, getParentUrlSegment(), parts);
+    if(!source)
+        return nullptr;
+
+    SegmentChunk *chunk = createChunk(source, rep);
+    if(!chunk)
+    {
+        source->recycle();
+        return nullptr;
+    }
+
+    chunk->sequence = index;
+    chunk->discontinuity = discontinuity;
+    if(!prepareChunk(res, chunk, rep))
+    {
+        delete chunk;
+        return nullptr;
+    }
+    return chunk;
+}
+
 vlc_tick_t HLSSegment::getUTCTime() const
 {
     return utcTime;
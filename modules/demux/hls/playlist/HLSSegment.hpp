@@ -23,6 +23,9 @@
 #include "../../adaptive/playlist/Segment.h"
 #include "../../adaptive/encryption/CommonEncryption.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace hls
 {
     namespace playlist
@@ -31,6 +34,31 @@ namespace hls
         using namespace adaptive::playlist;
         using namespace adaptive::encryption;
 
+        /* Low latency partial segment (EXT-X-PART or EXT-X-PRELOAD-HINT) */
+        class HLSPart
+        {
+            public:
+                HLSPart();
+                std::string uri;
+                size_t      startByte;
+                size_t      endByte; /* inclusive, 0 for open ended */
+                bool        byteRange;
+                vlc_tick_t  duration;
+                bool        independent;
+                bool        hint; /* not published yet */
+        };
+
+        /* Parts of a segment, shared with the chunk reading them, as the
+         * playlist updates can replace or expire the segment meanwhile.
+         * Both happen from the buffering thread. */
+        class HLSPartsList
+        {
+            public:
+                HLSPartsList();
+                std::vector<HLSPart> parts;
+                bool complete; /* the segment has been fully published */
+        };
+
         class HLSSegment : public Segment
         {
             friend class M3U8Parser;
@@ -40,9 +68,14 @@ namespace hls
                 virtual ~HLSSegment();
                 vlc_tick_t getUTCTime() const;
                 virtual int compare(ISegment *) const override;
+                virtual void updateWith(ISegment *) override;
+                virtual SegmentChunk* toChunk(SharedResources *, AbstractConnectionManager *,
+                                              size_t, BaseRepresentation *) override;
+                bool isComplete() const;
 
             protected:
                 vlc_tick_t utcTime;
+                std::shared_ptr<HLSPartsList> parts;
                 virtual bool prepareChunk(SharedResources *, SegmentChunk *,
                                           BaseRepresentation *) override;
         };
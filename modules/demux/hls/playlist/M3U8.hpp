@@ -36,6 +36,7 @@ namespace hls
                 virtual ~M3U8();
 
                 virtual bool isLive() const override;
+                virtual bool isLowLatency() const override;
         };
     }
 }
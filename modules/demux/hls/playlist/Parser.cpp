@@ -162,7 +162,7 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUpdateUrl());
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -220,22 +220,77 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
 {
     SegmentList *segmentList = new (std::nothrow) SegmentList(rep);
 
+    /* Segments we already hold are not created again, but the last one
+     * which might still be growing: the merge would discard them */
+    uint64_t knownFirst = std::numeric_limits<uint64_t>::max();
+    uint64_t knownLast = std::numeric_limits<uint64_t>::max();
+    const SegmentList *currentList = rep->b_loaded
+            ? static_cast<SegmentList *>(rep->getAttribute(AbstractAttr::Type::SegmentList))
+            : nullptr;
+    if(currentList && !currentList->getSegments().empty())
+    {
+        knownFirst = currentList->getSegments().front()->getSequenceNumber();
+        knownLast = currentList->getSegments().back()->getSequenceNumber();
+    }
+
     Timescale timescale(1000000);
     rep->addAttribute(new TimescaleAttr(timescale));
     rep->b_loaded = true;
+    rep->b_skipFailed = false;
 
     vlc_tick_t totalduration = 0;
     vlc_tick_t nzStartTime = 0;
     vlc_tick_t absReferenceTime = VLC_TICK_INVALID;
     uint64_t sequenceNumber = 0;
+    uint64_t mediaSequence = 0;
     bool discontinuity = false;
     std::size_t prevbyterangeoffset = 0;
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
+    std::shared_ptr<const CommonEncryption> sharedEncryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    std::vector<HLSPart> ctx_parts; /* of the segment not listed yet */
+    std::size_t prevpartbyteoffset = 0;
 
     std::list<HLSSegment *> segmentstoappend;
 
+    auto appendSegment = [&](HLSSegment *segment, vlc_tick_t nzDuration)
+    {
+        segment->duration.Set(timescale.ToScaled(nzDuration));
+        segment->startTime.Set(timescale.ToScaled(nzStartTime));
+        nzStartTime += nzDuration;
+        totalduration += nzDuration;
+        if(absReferenceTime != VLC_TICK_INVALID)
+        {
+            segment->setDisplayTime(absReferenceTime);
+            absReferenceTime += nzDuration;
+        }
+
+        segmentstoappend.push_back(segment);
+
+        if(discontinuity)
+        {
+            segment->discontinuity = true;
+            discontinuity = false;
+        }
+
+        if(encryption.method != CommonEncryption::Method::None)
+        {
+            if(!sharedEncryption)
+                sharedEncryption = std::make_shared<const CommonEncryption>(encryption);
+            segment->setEncryption(sharedEncryption);
+        }
+    };
+
+    auto skipSegment = [&](vlc_tick_t nzDuration)
+    {
+        nzStartTime += nzDuration;
+        totalduration += nzDuration;
+        if(absReferenceTime != VLC_TICK_INVALID)
+            absReferenceTime += nzDuration;
+        discontinuity = false;
+    };
+
     std::list<Tag *>::const_iterator it;
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
     {
@@ -246,6 +301,7 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case SingleValueTag::EXTXMEDIASEQUENCE:
             {
                 sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+                mediaSequence = sequenceNumber;
             }
             break;
 
@@ -265,12 +321,6 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
-
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
                 if(ctx_extinf)
@@ -280,36 +330,134 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                         nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
                     ctx_extinf = nullptr;
                 }
-                segment->duration.Set(timescale.ToScaled(nzDuration));
-                segment->startTime.Set(timescale.ToScaled(nzStartTime));
-                nzStartTime += nzDuration;
-                totalduration += nzDuration;
-                if(absReferenceTime != VLC_TICK_INVALID)
-                {
-                    segment->setDisplayTime(absReferenceTime);
-                    absReferenceTime += nzDuration;
-                }
-
-                segmentstoappend.push_back(segment);
 
+                std::pair<std::size_t,std::size_t> range(0, 0);
                 if(ctx_byterange)
                 {
-                    std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+                    range = ctx_byterange->getValue().getByteRange();
                     if(range.first == 0) /* first == size, second = offset */
                         range.first = prevbyterangeoffset;
                     prevbyterangeoffset = range.first + range.second;
-                    segment->setByteRange(range.first, prevbyterangeoffset - 1);
                     ctx_byterange = nullptr;
                 }
 
-                if(discontinuity)
+                if(sequenceNumber >= knownFirst && sequenceNumber < knownLast)
                 {
-                    segment->discontinuity = true;
-                    discontinuity = false;
+                    skipSegment(nzDuration);
+                    ctx_parts.clear();
+                    prevpartbyteoffset = 0;
+                    sequenceNumber++;
+                    break;
                 }
 
-                if(encryption.method != CommonEncryption::Method::None)
-                    segment->setEncryption(encryption);
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                if(!segment)
+                    break;
+
+                segment->setSourceUrl(uritag->getValue().value);
+
+                if(!ctx_parts.empty())
+                {
+                    segment->parts = std::make_shared<HLSPartsList>();
+                    segment->parts->parts.swap(ctx_parts);
+                    segment->parts->complete = true;
+                }
+                prevpartbyteoffset = 0;
+
+                appendSegment(segment, nzDuration);
+
+                if(range.second)
+                    segment->setByteRange(range.first, range.first + range.second - 1);
+            }
+            break;
+
+            case AttributesTag::EXTXSKIP:
+            {
+                /* Delta update: the oldest segments are left out */
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("SKIPPED-SEGMENTS");
+                if(attr)
+                {
+                    const uint64_t skipped = attr->decimal();
+                    /* can't merge without holding up to the first listed one,
+                     * next reload needs to be a full one */
+                    if(knownLast == std::numeric_limits<uint64_t>::max() ||
+                       sequenceNumber + skipped > knownLast + 1)
+                        rep->b_skipFailed = true;
+                    sequenceNumber += skipped;
+                }
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTargetDuration = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *ctrltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = ctrltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->b_canBlockReload = (attr && attr->value == "YES");
+                attr = ctrltag->getAttributeByName("CAN-SKIP-UNTIL");
+                rep->canSkipUntil = attr ? vlc_tick_from_sec(attr->floatingPoint()) : 0;
+                attr = ctrltag->getAttributeByName("PART-HOLD-BACK");
+                if(attr)
+                    rep->getPlaylist()->suggestedPresentationDelay.Set(
+                                vlc_tick_from_sec(attr->floatingPoint()));
+            }
+            break;
+
+            case AttributesTag::EXTXPART:
+            case AttributesTag::EXTXPRELOADHINT:
+            {
+                const AttributesTag *parttag = static_cast<const AttributesTag *>(tag);
+                const Attribute *uriAttr = parttag->getAttributeByName("URI");
+                HLSPart part;
+                if(!uriAttr)
+                    break;
+                part.uri = uriAttr->quotedString();
+
+                if(tag->getType() == AttributesTag::EXTXPRELOADHINT)
+                {
+                    const Attribute *attr = parttag->getAttributeByName("TYPE");
+                    if(!attr || attr->value != "PART")
+                        break;
+                    part.hint = true;
+                    part.duration = rep->partTargetDuration;
+                    if((attr = parttag->getAttributeByName("BYTERANGE-START")))
+                    {
+                        part.byteRange = true;
+                        part.startByte = attr->decimal();
+                        if((attr = parttag->getAttributeByName("BYTERANGE-LENGTH")) &&
+                            attr->decimal() > 0)
+                            part.endByte = part.startByte + attr->decimal() - 1;
+                    }
+                }
+                else
+                {
+                    const Attribute *attr = parttag->getAttributeByName("DURATION");
+                    if(attr)
+                        part.duration = vlc_tick_from_sec(attr->floatingPoint());
+                    attr = parttag->getAttributeByName("INDEPENDENT");
+                    part.independent = (attr && attr->value == "YES");
+                    attr = parttag->getAttributeByName("GAP");
+                    if(attr && attr->value == "YES")
+                        break;
+                    if((attr = parttag->getAttributeByName("BYTERANGE")))
+                    {
+                        std::pair<std::size_t,std::size_t> range = attr->unescapeQuotes().getByteRange();
+                        if(range.first == 0) /* first == offset, second = size */
+                            range.first = prevpartbyteoffset;
+                        prevpartbyteoffset = range.first + range.second;
+                        part.byteRange = true;
+                        part.startByte = range.first;
+                        part.endByte = prevpartbyteoffset - 1;
+                    }
+                }
+                ctx_parts.push_back(part);
             }
             break;
 
@@ -348,6 +496,7 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case AttributesTag::EXTXKEY:
                 parseEncryption(static_cast<const AttributesTag *>(tag),
                                 rep->getPlaylistUrl(), encryption);
+                sharedEncryption.reset();
             break;
 
             case AttributesTag::EXTXMAP:
@@ -383,9 +532,38 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         }
     }
 
+    /* Segment still being published, only available as its parts */
+    if(!ctx_parts.empty())
+    {
+        HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber);
+        if(segment)
+        {
+            vlc_tick_t nzDuration = 0;
+            for(const HLSPart &part : ctx_parts)
+                nzDuration += part.duration;
+            segment->parts = std::make_shared<HLSPartsList>();
+            segment->parts->parts.swap(ctx_parts);
+            appendSegment(segment, nzDuration);
+        }
+    }
+
+    if(rep->b_canBlockReload)
+    {
+        rep->nextMediaSequence = sequenceNumber;
+        rep->nextPart = 0;
+        if(!segmentstoappend.empty() && !segmentstoappend.back()->isComplete())
+        {
+            for(const HLSPart &part : segmentstoappend.back()->parts->parts)
+                if(!part.hint)
+                    rep->nextPart++;
+        }
+    }
+
+    segmentList->reserve(segmentstoappend.size());
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
+    segmentList->setSequenceStart(mediaSequence);
 
     if(rep->isLive())
     {
@@ -25,6 +25,8 @@
 #include "Ebml_parser.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_block.h>
+
 namespace mkv {
 
 /*****************************************************************************
@@ -37,6 +39,7 @@ EbmlParser::EbmlParser( EbmlStream *es, EbmlElement *el_start, demux_t *p_demux
     m_got( NULL ),
     mi_user_level( 1 ),
     mb_keep( false ),
+    mi_fast_end( 0 ),
     mb_dummy( var_InheritBool( p_demux, "mkv-use-dummy" ) )
 {
     memset( m_el, 0, sizeof( *m_el ) * M_EL_MAXSIZE);
@@ -83,6 +86,7 @@ void EbmlParser::Down( void )
 {
     mi_user_level++;
     mi_level++;
+    mi_fast_end = 0;
 }
 
 void EbmlParser::Keep( void )
@@ -110,6 +114,7 @@ void EbmlParser::Reset( demux_t *p_demux )
     }
     this->p_demux = p_demux;
     mi_user_level = mi_level = 1;
+    mi_fast_end = 0;
     // a little faster and cleaner
     m_es->I_O().setFilePointer( static_cast<EbmlMaster*>(m_el[0])->GetDataStart() );
 }
@@ -150,7 +155,10 @@ EbmlElement *EbmlParser::Get( bool allow_overshoot )
 
 next:
     p_prev = m_el[mi_level];
-    if( p_prev )
+    /* blocks read by ReadSimpleBlock() already moved past p_prev */
+    const uint64 i_fast_end = p_prev ? mi_fast_end : 0;
+    mi_fast_end = 0;
+    if( p_prev && !i_fast_end )
         p_prev->SkipData( *m_es, EBML_CONTEXT(p_prev) );
 
     uint64_t i_max_read;
@@ -174,21 +182,26 @@ next:
         }
     }
     else {
+        const uint64 bom = i_fast_end ? i_fast_end : p_prev->GetEndPosition();
         size_t size_lvl = mi_level;
-        while ( size_lvl && m_el[size_lvl-1]->IsFiniteSize() && m_el[size_lvl]->IsFiniteSize() &&
-                m_el[size_lvl-1]->GetEndPosition() == m_el[size_lvl]->GetEndPosition() )
+        uint64 lvl_end = bom;
+        bool lvl_finite = i_fast_end || p_prev->IsFiniteSize();
+        while ( size_lvl && m_el[size_lvl-1]->IsFiniteSize() && lvl_finite &&
+                m_el[size_lvl-1]->GetEndPosition() == lvl_end )
+        {
             size_lvl--;
+            lvl_end = m_el[size_lvl]->GetEndPosition();
+        }
         if (size_lvl == 0 && !allow_overshoot)
         {
             i_ulev = mi_level; // trick to go all the way up
             m_el[mi_level] = NULL;
             do_read = false;
         }
-        else if (size_lvl == 0 || !m_el[size_lvl-1]->IsFiniteSize() || !m_el[size_lvl]->IsFiniteSize() )
+        else if (size_lvl == 0 || !m_el[size_lvl-1]->IsFiniteSize() || !lvl_finite )
             i_max_read = UINT64_MAX;
         else {
             uint64 top = m_el[size_lvl-1]->GetEndPosition();
-            uint64 bom = m_el[mi_level]->GetEndPosition();
             i_max_read = top - bom;
         }
     }
@@ -251,7 +264,9 @@ next:
     {
         msg_Dbg( p_demux,"MKV/Ebml Parser: m_el[mi_level] == NULL" );
         /* go back to the end of the parent */
-        if( p_prev )
+        if( i_fast_end )
+            m_es->I_O().setFilePointer( i_fast_end );
+        else if( p_prev )
             p_prev->SkipData( *m_es, EBML_CONTEXT(p_prev) );
     }
     else if( m_el[mi_level]->IsDummy() && !mb_dummy )
@@ -266,8 +281,8 @@ next:
         }
 
         if( mi_level > 1 &&
-            p_prev && p_prev->IsFiniteSize() &&
-            p_prev->GetEndPosition() != m_el[mi_level]->GetElementPosition() )
+            p_prev && ( i_fast_end || p_prev->IsFiniteSize() ) &&
+            ( i_fast_end ? i_fast_end : p_prev->GetEndPosition() ) != m_el[mi_level]->GetElementPosition() )
         {
             msg_Err( p_demux, "Dummy Element at unexpected position... corrupted file?" );
             b_bad_position = true;
@@ -336,6 +351,102 @@ next:
     return m_el[mi_level];
 }
 
+/* reads an EBML coded number, returns its length or 0 if invalid */
+static size_t ReadVint( const uint8_t *p, size_t i_size, uint64_t *pi_value )
+{
+    if( i_size == 0 || p[0] == 0 )
+        return 0;
+
+    size_t i_len = 1;
+    uint8_t i_mask = 0x80;
+    while( !( p[0] & i_mask ) )
+    {
+        i_mask >>= 1;
+        i_len++;
+    }
+    if( i_len > i_size )
+        return 0;
+
+    uint64_t i_value = p[0] & ( i_mask - 1 );
+    bool b_unknown = i_value == (uint64_t)( i_mask - 1 );
+    for( size_t i = 1; i < i_len; i++ )
+    {
+        i_value = ( i_value << 8 ) | p[i];
+        b_unknown &= p[i] == 0xff;
+    }
+    if( b_unknown )
+        return 0;
+
+    *pi_value = i_value;
+    return i_len;
+}
+
+bool EbmlParser::PeekSimpleBlock( SimpleBlockHeader & header )
+{
+    if( mi_user_level != mi_level || m_got || mi_level < 2 )
+        return false;
+
+    EbmlElement *p_prev = m_el[mi_level];
+    EbmlElement *p_parent = m_el[mi_level - 1];
+    if( !p_prev || !p_prev->IsFiniteSize() || !p_parent->IsFiniteSize() )
+        return false;
+
+    vlc_stream_io_callback *io_callback = dynamic_cast<vlc_stream_io_callback *>(&m_es->I_O());
+    if( io_callback == NULL )
+        return false;
+
+    if( !mi_fast_end )
+        p_prev->SkipData( *m_es, EBML_CONTEXT(p_prev) );
+
+    /* ID, size, track number, timecode and flags */
+    const uint8_t *p_peek;
+    ssize_t i_peek = io_callback->peek( &p_peek, 1 + 8 + 8 + 3 );
+    if( i_peek < 1 + 1 + 1 + 3 || p_peek[0] != 0xA3 )
+        return false;
+
+    uint64_t i_size;
+    size_t i_size_len = ReadVint( &p_peek[1], i_peek - 1, &i_size );
+    if( i_size_len == 0 )
+        return false;
+
+    size_t i_offset = 1 + i_size_len;
+    size_t i_track_len = ReadVint( &p_peek[i_offset], i_peek - i_offset,
+                                   &header.i_track_number );
+    if( i_track_len == 0 || i_offset + i_track_len + 3 > (size_t)i_peek ||
+        i_size < i_track_len + 3 || i_size - i_track_len - 3 > UINT32_MAX )
+        return false;
+    i_offset += i_track_len;
+
+    header.i_timecode = (int16_t)GetWBE( &p_peek[i_offset] );
+    header.i_flags    = p_peek[i_offset + 2];
+    if( header.i_flags & 0x06 ) /* laced */
+        return false;
+
+    header.i_position = io_callback->getFilePointer();
+    header.i_header   = i_offset + 3;
+    header.i_payload  = i_size - i_track_len - 3;
+    header.i_end      = header.i_position + 1 + i_size_len + i_size;
+
+    return header.i_payload > 0 &&
+           header.i_end <= p_parent->GetEndPosition();
+}
+
+block_t *EbmlParser::ReadSimpleBlock( SimpleBlockHeader const & header )
+{
+    vlc_stream_io_callback *io_callback = static_cast<vlc_stream_io_callback *>(&m_es->I_O());
+    uint8_t p_header[1 + 8 + 8 + 3];
+
+    /* whatever happens, the block is consumed */
+    mi_fast_end = header.i_end;
+
+    block_t *p_block = NULL;
+    if( io_callback->read( p_header, header.i_header ) == header.i_header )
+        p_block = io_callback->readBlock( header.i_payload );
+    if( p_block == NULL )
+        io_callback->setFilePointer( header.i_end );
+    return p_block;
+}
+
 bool EbmlParser::IsTopPresent( EbmlElement *el ) const
 {
     for( int i = 0; i < mi_level; i++ )
@@ -51,6 +51,22 @@ class EbmlParser
     /* Is the provided element presents in our upper elements */
     bool IsTopPresent( EbmlElement * ) const;
 
+    /* SimpleBlock without lacing, read without creating libmatroska objects */
+    struct SimpleBlockHeader
+    {
+        uint64_t i_position;    /* position of the element */
+        uint64_t i_track_number;
+        int16_t  i_timecode;    /* relative to the cluster */
+        uint8_t  i_flags;
+        size_t   i_header;      /* size of the element and block headers */
+        size_t   i_payload;
+        uint64_t i_end;
+    };
+
+    /* Is the next element at the current level such a SimpleBlock */
+    bool    PeekSimpleBlock( SimpleBlockHeader & );
+    block_t *ReadSimpleBlock( SimpleBlockHeader const & );
+
   private:
     static const int M_EL_MAXSIZE = 10;
 
@@ -63,6 +79,8 @@ class EbmlParser
 
     int          mi_user_level;
     bool         mb_keep;
+    /* end of the last block read by ReadSimpleBlock(), past m_el[mi_level] */
+    uint64_t     mi_fast_end;
     /* Allow dummy/unknown EBML elements */
     bool         mb_dummy;
 };
@@ -0,0 +1,593 @@
+/*****************************************************************************
+ * cluster_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "cluster_indexer.hpp"
+
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <cstdio>
+
+namespace {
+    /* The scan runs on its own thread and must not share the libebml state
+     * of the demuxer, so the few elements it needs are parsed here. */
+    enum {
+        ID_SEEKHEAD    = 0x114D9B74,
+        ID_INFO        = 0x1549A966,
+        ID_TRACKS      = 0x1654AE6B,
+        ID_CLUSTER     = 0x1F43B675,
+        ID_CUES        = 0x1C53BB6B,
+        ID_CHAPTERS    = 0x1043A770,
+        ID_ATTACHMENTS = 0x1941A469,
+        ID_TAGS        = 0x1254C367,
+        ID_VOID        = 0xEC,
+        ID_CRC32       = 0xBF,
+
+        ID_TIMECODE    = 0xE7,
+        ID_SIMPLEBLOCK = 0xA3,
+        ID_BLOCKGROUP  = 0xA0,
+        ID_BLOCK       = 0xA1,
+        ID_REFBLOCK    = 0xFB,
+    };
+
+    const uint64_t UNKNOWN_SIZE = std::numeric_limits<uint64_t>::max();
+
+    bool is_segment_child( uint32_t id )
+    {
+        switch( id )
+        {
+            case ID_SEEKHEAD: case ID_INFO: case ID_TRACKS: case ID_CLUSTER:
+            case ID_CUES: case ID_CHAPTERS: case ID_ATTACHMENTS: case ID_TAGS:
+            case ID_VOID: case ID_CRC32:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /* reads an EBML variable size integer, with its length marker removed */
+    int parse_vint( const uint8_t *p, size_t i_size, uint64_t *pi_value, bool *pb_unknown )
+    {
+        if( i_size == 0 || p[0] == 0 )
+            return -1;
+
+        int i_len = 1;
+        while( !( p[0] & ( 0x80 >> ( i_len - 1 ) ) ) )
+            i_len++;
+        if( (size_t)i_len > i_size )
+            return -1;
+
+        uint64_t i_value = p[0] & ( 0xFF >> i_len );
+        bool b_all_ones = i_value == ( 0xFFu >> i_len );
+        for( int i = 1; i < i_len; i++ )
+        {
+            i_value = ( i_value << 8 ) | p[i];
+            b_all_ones = b_all_ones && p[i] == 0xFF;
+        }
+
+        *pi_value = i_value;
+        if( pb_unknown )
+            *pb_unknown = b_all_ones;
+        return i_len;
+    }
+
+    bool read_header( stream_t *s, uint32_t *pi_id, uint64_t *pi_size )
+    {
+        uint8_t buf[8];
+
+        if( vlc_stream_Read( s, buf, 1 ) != 1 || !( buf[0] & 0xF0 ) )
+            return false;
+
+        /* IDs keep their length marker */
+        int i_len = ( buf[0] & 0x80 ) ? 1 : ( buf[0] & 0x40 ) ? 2 :
+                    ( buf[0] & 0x20 ) ? 3 : 4;
+        if( i_len > 1 && vlc_stream_Read( s, &buf[1], i_len - 1 ) != i_len - 1 )
+            return false;
+        uint32_t i_id = 0;
+        for( int i = 0; i < i_len; i++ )
+            i_id = ( i_id << 8 ) | buf[i];
+
+        if( vlc_stream_Read( s, buf, 1 ) != 1 || buf[0] == 0 )
+            return false;
+        i_len = 1;
+        while( !( buf[0] & ( 0x80 >> ( i_len - 1 ) ) ) )
+            i_len++;
+        if( i_len > 1 && vlc_stream_Read( s, &buf[1], i_len - 1 ) != i_len - 1 )
+            return false;
+
+        bool b_unknown;
+        if( parse_vint( buf, i_len, pi_size, &b_unknown ) != i_len )
+            return false;
+        if( b_unknown )
+            *pi_size = UNKNOWN_SIZE;
+
+        *pi_id = i_id;
+        return true;
+    }
+
+    /* reads the track number, relative timecode and flags of a block */
+    bool read_block_header( stream_t *s, uint64_t i_size, uint64_t *pi_track,
+                            int16_t *pi_timecode, uint8_t *pi_flags )
+    {
+        uint8_t buf[11];
+        const size_t i_toread = std::min<uint64_t>( i_size, sizeof(buf) );
+
+        if( vlc_stream_Read( s, buf, i_toread ) != (ssize_t)i_toread )
+            return false;
+
+        int i_len = parse_vint( buf, i_toread, pi_track, NULL );
+        if( i_len < 0 || (size_t)i_len + 3 > i_toread )
+            return false;
+
+        *pi_timecode = (int16_t)GetWBE( &buf[i_len] );
+        *pi_flags = buf[i_len + 2];
+        return true;
+    }
+
+    const char cache_magic[8] = { 'V','L','C','M','K','V','I','1' };
+}
+
+namespace mkv {
+
+ClusterIndexer::ClusterIndexer( vlc_object_t *obj, std::string const& url,
+                                fptr_t start, fptr_t end, uint64_t timescale,
+                                track_ids_t const& tracks, bool use_cache )
+    : obj( obj )
+    , url( url )
+    , i_start( start )
+    , i_end( end )
+    , i_timescale( timescale )
+    , tracks( tracks )
+    , b_use_cache( use_cache )
+    , is_running( false )
+    , p_interrupt( NULL )
+    , i_clusters_fetched( 0 )
+    , i_keyframes_fetched( 0 )
+    , i_scanned_pts( -1 )
+    , b_done( false )
+    , b_interrupted( false )
+{
+    memset( key, 0, sizeof(key) );
+    vlc_mutex_init( &lock );
+    vlc_cond_init( &wait_cond );
+}
+
+ClusterIndexer::~ClusterIndexer()
+{
+    if( !is_running )
+        return;
+
+    vlc_interrupt_kill( p_interrupt );
+    vlc_join( thread, NULL );
+    vlc_interrupt_destroy( p_interrupt );
+}
+
+bool ClusterIndexer::start()
+{
+    p_interrupt = vlc_interrupt_create();
+    if( unlikely( p_interrupt == NULL ) )
+        return false;
+
+    is_running = !vlc_clone( &thread, thread_entry, this, VLC_THREAD_PRIORITY_LOW );
+    if( !is_running )
+    {
+        vlc_interrupt_destroy( p_interrupt );
+        p_interrupt = NULL;
+    }
+    return is_running;
+}
+
+bool ClusterIndexer::fetch( clusters_t& out_clusters, keyframes_t& out_keyframes )
+{
+    vlc_mutex_locker guard( &lock );
+
+    out_clusters.insert( out_clusters.end(),
+                         clusters.begin() + i_clusters_fetched, clusters.end() );
+    out_keyframes.insert( out_keyframes.end(),
+                          keyframes.begin() + i_keyframes_fetched, keyframes.end() );
+    i_clusters_fetched  = clusters.size();
+    i_keyframes_fetched = keyframes.size();
+
+    return b_done;
+}
+
+void ClusterIndexer::wake_up( void *data )
+{
+    ClusterIndexer *self = static_cast<ClusterIndexer*>( data );
+    vlc_mutex_locker guard( &self->lock );
+
+    self->b_interrupted = true;
+    vlc_cond_broadcast( &self->wait_cond );
+}
+
+bool ClusterIndexer::wait( vlc_tick_t pts )
+{
+    vlc_mutex_lock( &lock );
+    b_interrupted = false;
+    vlc_mutex_unlock( &lock );
+
+    /* a pending interruption invokes the callback right away */
+    vlc_interrupt_register( wake_up, this );
+
+    vlc_mutex_lock( &lock );
+    while( !b_done && !b_interrupted && i_scanned_pts <= pts )
+        vlc_cond_wait( &wait_cond, &lock );
+    bool b_reached = b_done || i_scanned_pts > pts;
+    vlc_mutex_unlock( &lock );
+
+    vlc_interrupt_unregister();
+    return b_reached;
+}
+
+void *ClusterIndexer::thread_entry( void *data )
+{
+    static_cast<ClusterIndexer*>( data )->run();
+    return NULL;
+}
+
+void ClusterIndexer::run()
+{
+    vlc_interrupt_set( p_interrupt );
+
+    stream_t *s = vlc_stream_NewURL( obj, url.c_str() );
+    if( s != NULL )
+    {
+        compute_key( s );
+
+        if( b_use_cache && load_cache() )
+            msg_Dbg( obj, "loaded %zu clusters index from the cache", clusters.size() );
+        else
+        {
+            vlc_tick_t i_begin = vlc_tick_now();
+            bool b_complete = scan( s );
+
+            msg_Dbg( obj, "%s clusters scan: %zu clusters, %zu keyframes in %" PRId64 " ms",
+                     b_complete ? "completed" : "aborted", clusters.size(),
+                     keyframes.size(), MS_FROM_VLC_TICK( vlc_tick_now() - i_begin ) );
+
+            if( b_complete && b_use_cache && !clusters.empty() )
+                save_cache();
+        }
+        vlc_stream_Delete( s );
+    }
+
+    vlc_mutex_locker guard( &lock );
+    b_done = true;
+    vlc_cond_broadcast( &wait_cond );
+}
+
+/* returns true if the end of the segment was reached */
+bool ClusterIndexer::scan( stream_t *s )
+{
+    if( vlc_stream_Seek( s, i_start ) != VLC_SUCCESS )
+        return false;
+
+    while( !vlc_killed() )
+    {
+        const fptr_t i_pos = vlc_stream_Tell( s );
+        uint32_t i_id;
+        uint64_t i_size;
+
+        if( i_pos >= i_end || !read_header( s, &i_id, &i_size ) )
+            return !vlc_killed();
+
+        if( i_id == ID_CLUSTER )
+        {
+            if( !scan_cluster( s, i_pos, i_size ) )
+                return !vlc_killed();
+            continue;
+        }
+
+        /* anything else than a known, sized, element ends the segment */
+        if( !is_segment_child( i_id ) || i_size == UNKNOWN_SIZE )
+            return true;
+
+        if( vlc_stream_Seek( s, vlc_stream_Tell( s ) + i_size ) != VLC_SUCCESS )
+            return !vlc_killed();
+    }
+    return false;
+}
+
+/* returns false if the scan cannot go on past this cluster */
+bool ClusterIndexer::scan_cluster( stream_t *s, fptr_t i_pos, uint64_t i_size )
+{
+    const fptr_t i_data_start = vlc_stream_Tell( s );
+    const fptr_t i_cluster_end = i_size == UNKNOWN_SIZE ? UNKNOWN_SIZE : i_data_start + i_size;
+
+    keyframes_t found;
+    int64_t i_cluster_timecode = -1;
+    bool b_next = true;
+
+    for( ;; )
+    {
+        const fptr_t i_child_pos = vlc_stream_Tell( s );
+        uint32_t i_id;
+        uint64_t i_child_size;
+
+        if( i_child_pos >= i_cluster_end )
+            break;
+
+        if( vlc_killed() || !read_header( s, &i_id, &i_child_size ) )
+        {
+            b_next = false;
+            break;
+        }
+
+        const fptr_t i_child_data = vlc_stream_Tell( s );
+
+        if( i_cluster_end == UNKNOWN_SIZE && is_segment_child( i_id ) )
+        {
+            /* the next cluster (or index) ends a cluster of unknown size */
+            b_next = vlc_stream_Seek( s, i_child_pos ) == VLC_SUCCESS;
+            break;
+        }
+
+        if( i_child_size == UNKNOWN_SIZE )
+        {
+            b_next = false;
+            break;
+        }
+
+        if( i_id == ID_TIMECODE && i_child_size <= 8 )
+        {
+            uint8_t buf[8];
+            if( vlc_stream_Read( s, buf, i_child_size ) != (ssize_t)i_child_size )
+            {
+                b_next = false;
+                break;
+            }
+            i_cluster_timecode = 0;
+            for( uint64_t i = 0; i < i_child_size; i++ )
+                i_cluster_timecode = ( i_cluster_timecode << 8 ) | buf[i];
+        }
+        else if( i_id == ID_SIMPLEBLOCK || i_id == ID_BLOCKGROUP )
+        {
+            fptr_t   i_block_pos = i_child_pos;
+            uint64_t i_track = 0;
+            int16_t  i_timecode = 0;
+            uint8_t  i_flags = 0;
+            bool     b_block = false;
+            bool     b_key = true;
+
+            if( i_id == ID_SIMPLEBLOCK )
+            {
+                b_block = read_block_header( s, i_child_size, &i_track, &i_timecode, &i_flags );
+                b_key = i_flags & 0x80;
+            }
+            else /* a group is a keyframe unless it references another block */
+            {
+                const fptr_t i_group_end = i_child_data + i_child_size;
+                for( fptr_t i_sub_pos = i_child_data; i_sub_pos < i_group_end;
+                     i_sub_pos = vlc_stream_Tell( s ) )
+                {
+                    uint32_t i_sub_id;
+                    uint64_t i_sub_size;
+
+                    if( !read_header( s, &i_sub_id, &i_sub_size ) || i_sub_size == UNKNOWN_SIZE )
+                        break;
+                    const fptr_t i_sub_data = vlc_stream_Tell( s );
+
+                    if( i_sub_id == ID_BLOCK )
+                    {
+                        i_block_pos = i_sub_pos;
+                        b_block = read_block_header( s, i_sub_size, &i_track, &i_timecode, &i_flags );
+                    }
+                    else if( i_sub_id == ID_REFBLOCK )
+                        b_key = false;
+
+                    if( vlc_stream_Seek( s, i_sub_data + i_sub_size ) != VLC_SUCCESS )
+                        break;
+                }
+            }
+
+            if( b_block && b_key && i_cluster_timecode >= 0 &&
+                std::find( tracks.begin(), tracks.end(), i_track ) != tracks.end() )
+            {
+                bool b_first = true;
+                for( keyframes_t::const_iterator it = found.begin(); it != found.end(); ++it )
+                    b_first = b_first && it->track_id != i_track;
+
+                if( b_first )
+                {
+                    Keyframe keyframe = {
+                        /* track_id */ track_id_t( i_track ),
+                        /* fpos     */ i_block_pos,
+                        /* pts      */ VLC_TICK_FROM_NS( ( i_cluster_timecode + i_timecode ) * int64_t( i_timescale ) ),
+                    };
+                    found.push_back( keyframe );
+                }
+            }
+
+            /* the remaining blocks are of no use for a sized cluster */
+            if( found.size() == tracks.size() && i_cluster_end != UNKNOWN_SIZE )
+            {
+                b_next = vlc_stream_Seek( s, i_cluster_end ) == VLC_SUCCESS;
+                break;
+            }
+        }
+
+        if( vlc_stream_Seek( s, i_child_data + i_child_size ) != VLC_SUCCESS )
+        {
+            b_next = false;
+            break;
+        }
+    }
+
+    if( i_cluster_timecode < 0 )
+        return b_next;
+
+    const fptr_t i_end_pos = b_next ? fptr_t( vlc_stream_Tell( s ) ) : i_cluster_end;
+    Cluster cluster = {
+        /* fpos */ i_pos,
+        /* size */ i_end_pos == UNKNOWN_SIZE ? UNKNOWN_SIZE : i_end_pos - i_pos,
+        /* pts  */ VLC_TICK_FROM_NS( i_cluster_timecode * int64_t( i_timescale ) ),
+    };
+
+    vlc_mutex_locker guard( &lock );
+    clusters.push_back( cluster );
+    keyframes.insert( keyframes.end(), found.begin(), found.end() );
+    /* everything before the start of this cluster is indexed */
+    i_scanned_pts = std::max( i_scanned_pts, cluster.pts );
+    vlc_cond_broadcast( &wait_cond );
+
+    return b_next;
+}
+
+/* identifies the segment by its location, file size and timescale */
+void ClusterIndexer::compute_key( stream_t *s )
+{
+    vlc_hash_md5_t md5;
+    uint8_t buf[8];
+
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, url.data(), url.size() );
+    SetQWBE( buf, stream_Size( s ) );
+    vlc_hash_md5_Update( &md5, buf, sizeof(buf) );
+    SetQWBE( buf, i_start );
+    vlc_hash_md5_Update( &md5, buf, sizeof(buf) );
+    SetQWBE( buf, i_timescale );
+    vlc_hash_md5_Update( &md5, buf, sizeof(buf) );
+    vlc_hash_md5_Finish( &md5, key, sizeof(key) );
+}
+
+std::string ClusterIndexer::cache_path() const
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir == NULL )
+        return std::string();
+
+    std::string dir = std::string( psz_cachedir ) + DIR_SEP "mkvindex";
+    bool b_ok = ( vlc_mkdir( psz_cachedir, 0700 ) == 0 || errno == EEXIST ) &&
+                ( vlc_mkdir( dir.c_str(), 0700 ) == 0 || errno == EEXIST );
+    free( psz_cachedir );
+    if( !b_ok )
+        return std::string();
+
+    char psz_hash[2 * sizeof(key) + 1];
+    for( size_t i = 0; i < sizeof(key); i++ )
+        snprintf( &psz_hash[2 * i], 3, "%02x", key[i] );
+
+    return dir + DIR_SEP + psz_hash;
+}
+
+/* Cached index file layout, all values big endian:
+ * magic, key, clusters count (32 bits), keyframes count (32 bits),
+ * then each cluster position, size and date,
+ * then each keyframe track (32 bits), position and date */
+bool ClusterIndexer::load_cache()
+{
+    std::string path = cache_path();
+    if( path.empty() )
+        return false;
+
+    FILE *p_file = vlc_fopen( path.c_str(), "rb" );
+    if( p_file == NULL )
+        return false;
+
+    clusters_t  loaded_clusters;
+    keyframes_t loaded_keyframes;
+    uint8_t header[sizeof(cache_magic) + sizeof(key) + 8];
+    bool b_ok = false;
+
+    if( fread( header, sizeof(header), 1, p_file ) == 1 &&
+        !memcmp( header, cache_magic, sizeof(cache_magic) ) &&
+        !memcmp( &header[sizeof(cache_magic)], key, sizeof(key) ) )
+    {
+        const uint32_t i_clusters  = GetDWBE( &header[sizeof(cache_magic) + sizeof(key)] );
+        const uint32_t i_keyframes = GetDWBE( &header[sizeof(cache_magic) + sizeof(key) + 4] );
+        uint8_t entry[24];
+
+        b_ok = i_clusters > 0;
+        for( uint32_t i = 0; b_ok && i < i_clusters; i++ )
+        {
+            b_ok = fread( entry, 24, 1, p_file ) == 1;
+            Cluster cluster = { GetQWBE( &entry[0] ), GetQWBE( &entry[8] ),
+                                vlc_tick_t( GetQWBE( &entry[16] ) ) };
+            loaded_clusters.push_back( cluster );
+        }
+        for( uint32_t i = 0; b_ok && i < i_keyframes; i++ )
+        {
+            b_ok = fread( entry, 20, 1, p_file ) == 1;
+            Keyframe keyframe = { GetDWBE( &entry[0] ), GetQWBE( &entry[4] ),
+                                  vlc_tick_t( GetQWBE( &entry[12] ) ) };
+            loaded_keyframes.push_back( keyframe );
+        }
+    }
+    fclose( p_file );
+
+    if( !b_ok )
+        return false;
+
+    vlc_mutex_locker guard( &lock );
+    clusters.swap( loaded_clusters );
+    keyframes.swap( loaded_keyframes );
+    i_scanned_pts = std::numeric_limits<vlc_tick_t>::max();
+    return true;
+}
+
+void ClusterIndexer::save_cache() const
+{
+    std::string path = cache_path();
+    if( path.empty() )
+        return;
+
+    std::string tmp_path = path + ".part";
+    FILE *p_file = vlc_fopen( tmp_path.c_str(), "wb" );
+    if( p_file == NULL )
+        return;
+
+    /* only this thread modifies the index */
+    uint8_t header[sizeof(cache_magic) + sizeof(key) + 8];
+    memcpy( header, cache_magic, sizeof(cache_magic) );
+    memcpy( &header[sizeof(cache_magic)], key, sizeof(key) );
+    SetDWBE( &header[sizeof(cache_magic) + sizeof(key)], clusters.size() );
+    SetDWBE( &header[sizeof(cache_magic) + sizeof(key) + 4], keyframes.size() );
+    bool b_ok = fwrite( header, sizeof(header), 1, p_file ) == 1;
+
+    uint8_t entry[24];
+    for( clusters_t::const_iterator it = clusters.begin(); b_ok && it != clusters.end(); ++it )
+    {
+        SetQWBE( &entry[0], it->fpos );
+        SetQWBE( &entry[8], it->size );
+        SetQWBE( &entry[16], it->pts );
+        b_ok = fwrite( entry, 24, 1, p_file ) == 1;
+    }
+    for( keyframes_t::const_iterator it = keyframes.begin(); b_ok && it != keyframes.end(); ++it )
+    {
+        SetDWBE( &entry[0], it->track_id );
+        SetQWBE( &entry[4], it->fpos );
+        SetQWBE( &entry[12], it->pts );
+        b_ok = fwrite( entry, 20, 1, p_file ) == 1;
+    }
+
+    if( fclose( p_file ) != 0 )
+        b_ok = false;
+
+    if( b_ok && vlc_rename( tmp_path.c_str(), path.c_str() ) == 0 )
+        msg_Dbg( obj, "saved clusters index to %s", path.c_str() );
+    else
+        vlc_unlink( tmp_path.c_str() );
+}
+
+} // namespace
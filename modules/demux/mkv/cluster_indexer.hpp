@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * cluster_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MKV_CLUSTER_INDEXER_HPP_
+#define VLC_MKV_CLUSTER_INDEXER_HPP_
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_interrupt.h>
+#include <vlc_stream.h>
+
+#include <string>
+#include <vector>
+
+namespace mkv {
+
+/*****************************************************************************
+ * Background cluster index
+ *****************************************************************************
+ * Walks the clusters of a segment through a stream of its own, reading only
+ * the cluster timecodes and the block headers, and collects the first
+ * keyframe of each track within each cluster. The demuxer fetches what has
+ * been found so far into its seeker, and can wait for the scan to reach a
+ * given date. A complete index can be kept in the cache directory.
+ *****************************************************************************/
+class ClusterIndexer
+{
+    public:
+        typedef uint64_t fptr_t;
+        typedef unsigned int track_id_t;
+
+        struct Cluster
+        {
+            fptr_t     fpos;
+            fptr_t     size;
+            vlc_tick_t pts;
+        };
+
+        struct Keyframe
+        {
+            track_id_t track_id;
+            fptr_t     fpos;
+            vlc_tick_t pts;
+        };
+
+        typedef std::vector<track_id_t> track_ids_t;
+        typedef std::vector<Cluster>    clusters_t;
+        typedef std::vector<Keyframe>   keyframes_t;
+
+        ClusterIndexer( vlc_object_t *obj, std::string const& url,
+                        fptr_t start, fptr_t end, uint64_t timescale,
+                        track_ids_t const& tracks, bool use_cache );
+        ~ClusterIndexer();
+
+        ClusterIndexer( ClusterIndexer const& ) = delete;
+        ClusterIndexer& operator=( ClusterIndexer const& ) = delete;
+
+        bool start();
+
+        /* appends what was found since the previous call,
+         * returns true once the scan is over and everything was fetched */
+        bool fetch( clusters_t&, keyframes_t& );
+
+        /* waits until the scan goes past the given date or is over,
+         * returns false if interrupted */
+        bool wait( vlc_tick_t pts );
+
+    private:
+        static void *thread_entry( void * );
+        static void  wake_up( void * );
+
+        void run();
+        bool scan( stream_t * );
+        bool scan_cluster( stream_t *, fptr_t fpos, uint64_t size );
+
+        void compute_key( stream_t * );
+        std::string cache_path() const;
+        bool load_cache();
+        void save_cache() const;
+
+        vlc_object_t    * const obj;
+        std::string     const   url;
+        fptr_t          const   i_start;
+        fptr_t          const   i_end;
+        uint64_t        const   i_timescale;
+        track_ids_t     const   tracks;
+        bool            const   b_use_cache;
+
+        uint8_t          key[16];
+
+        bool             is_running;
+        vlc_thread_t     thread;
+        vlc_interrupt_t *p_interrupt;
+
+        vlc_mutex_t      lock;
+        vlc_cond_t       wait_cond;
+        clusters_t       clusters;        /*< under lock */
+        keyframes_t      keyframes;       /*< under lock */
+        size_t           i_clusters_fetched;
+        size_t           i_keyframes_fetched;
+        vlc_tick_t       i_scanned_pts;   /*< under lock */
+        bool             b_done;          /*< under lock */
+        bool             b_interrupted;   /*< under lock */
+};
+
+} // namespace
+
+#endif
@@ -836,6 +836,15 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
             priority = selected_tracks;
     }
 
+    // use the clusters scanned in background rather than parsing blocks //
+
+    if( _indexer )
+    {
+        if( !_indexer->wait( i_mk_date ) )
+            return false;
+        _seeker.import_index( *_indexer );
+    }
+
     // find appropriate seekpoints //
 
     try {
@@ -1153,9 +1162,51 @@ bool matroska_segment_c::ESCreate()
             es_out_Control( sys.demuxer.out, ES_OUT_SET_ES_DEFAULT, track->p_es );
     }
 
+    StartClusterIndexer();
+
     return true;
 }
 
+void matroska_segment_c::StartClusterIndexer()
+{
+    if( _indexer || !b_preloaded || !sys.b_seekable || tracks.empty() ||
+        !var_InheritBool( &sys.demuxer, "mkv-index-clusters" ) )
+        return;
+
+    if( b_cues )
+    {
+        // cues of recordings cut short may only cover their beginning
+        vlc_tick_t i_cues_end = -1;
+        for( SegmentSeeker::tracks_seekpoints_t::const_iterator it = _seeker._tracks_seekpoints.begin();
+             it != _seeker._tracks_seekpoints.end(); ++it )
+        {
+            if( !it->second.empty() )
+                i_cues_end = std::max( i_cues_end, it->second.rbegin()->pts );
+        }
+
+        if( i_duration <= 0 || i_cues_end + VLC_TICK_FROM_SEC( 30 ) >= i_duration )
+            return;
+    }
+
+    const char *psz_url = static_cast<vlc_stream_io_callback&>( es.I_O() ).GetURL();
+    if( psz_url == NULL )
+        return;
+
+    ClusterIndexer::track_ids_t track_ids;
+    for( tracks_map_t::const_iterator it = tracks.begin(); it != tracks.end(); ++it )
+        track_ids.push_back( it->first );
+
+    _indexer.reset( new (std::nothrow) ClusterIndexer( VLC_OBJECT( &sys.demuxer ), psz_url,
+        segment->GetDataStart(),
+        segment->IsFiniteSize() ? segment->GetEndPosition() : std::numeric_limits<uint64_t>::max(),
+        i_timescale, track_ids, var_InheritBool( &sys.demuxer, "mkv-index-cache" ) ) );
+
+    if( _indexer && !_indexer->start() )
+        _indexer.reset();
+    else if( _indexer )
+        msg_Dbg( &sys.demuxer, "indexing clusters in background" );
+}
+
 void matroska_segment_c::ESDestroy( )
 {
     sys.ev.ResetPci();
@@ -1176,11 +1227,13 @@ void matroska_segment_c::ESDestroy( )
 int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_simpleblock,
                                   KaxBlockAdditions * & pp_additions,
                                   bool *pb_key_picture, bool *pb_discardable_picture,
-                                  int64_t *pi_duration )
+                                  int64_t *pi_duration, fast_block_t *p_fast )
 {
     pp_simpleblock = NULL;
     pp_block = NULL;
     pp_additions = NULL;
+    if( p_fast != NULL )
+        p_fast->p_block = NULL;
 
     *pb_key_picture         = true;
     *pb_discardable_picture = false;
@@ -1350,6 +1403,22 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         EbmlElement *el = NULL;
         int         i_level;
 
+        /* plain SimpleBlocks of simple enough tracks skip libmatroska */
+        if( p_fast != NULL && pp_block == NULL && pp_simpleblock == NULL &&
+            payload.b_cluster_timecode && ep.GetLevel() == 2 &&
+            cluster != NULL && ep.IsTopPresent( cluster ) )
+        {
+            int i_ret = FastBlockGet( *p_fast );
+            if( i_ret < 0 )
+                continue;
+            if( i_ret > 0 )
+            {
+                *pb_key_picture         = p_fast->b_key_picture;
+                *pb_discardable_picture = p_fast->b_discardable_picture;
+                return VLC_SUCCESS;
+            }
+        }
+
         if( pp_simpleblock != NULL || ((el = ep.Get()) == NULL && pp_block != NULL) )
         {
             /* Check blocks validity to protect againts broken files */
@@ -1465,4 +1534,39 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
     }
 }
 
+/* returns 1 if a block was read, 0 if the next element needs the full
+ * parser and -1 if a block was skipped */
+int matroska_segment_c::FastBlockGet( fast_block_t & fast )
+{
+    EbmlParser::SimpleBlockHeader header;
+    if( !ep.PeekSimpleBlock( header ) )
+        return 0;
+
+    tracks_map_t::const_iterator it = tracks.find( header.i_track_number );
+    if( it == tracks.end() )
+        return 0;
+
+    const mkv_track_t & track = *it->second;
+    if( track.i_compression_type != MATROSKA_COMPRESSION_NONE ||
+        track.fmt.i_codec == VLC_CODEC_WAVPACK ||
+        track.fmt.i_codec == VLC_CODEC_PRORES )
+        return 0;
+
+    fast.p_block = ep.ReadSimpleBlock( header );
+    if( fast.p_block == NULL )
+        return -1;
+
+    fast.track_id   = header.i_track_number;
+    fast.i_position = header.i_position;
+    fast.i_pts      = VLC_TICK_FROM_NS( cluster->GetBlockGlobalTimecode( header.i_timecode ) );
+
+    fast.b_key_picture         = ( header.i_flags & 0x80 ) != 0;
+    fast.b_discardable_picture = ( header.i_flags & 0x01 ) != 0;
+
+    if( fast.b_key_picture )
+        _seeker.add_seekpoint( fast.track_id,
+            SegmentSeeker::Seekpoint( fast.i_position, fast.i_pts ) );
+    return 1;
+}
+
 } // namespace
@@ -82,6 +82,17 @@ public:
     typedef std::map<mkv_track_t::track_id_t, std::unique_ptr<mkv_track_t>> tracks_map_t;
     typedef std::vector<Tag>            tags_t;
 
+    /* SimpleBlock read straight into a block_t, see BlockGet() */
+    struct fast_block_t
+    {
+        block_t                 *p_block;
+        mkv_track_t::track_id_t track_id;
+        uint64_t                i_position;
+        vlc_tick_t              i_pts;  /* segment time, before the track delay */
+        bool                    b_key_picture;
+        bool                    b_discardable_picture;
+    };
+
     matroska_segment_c( demux_sys_t &, EbmlStream &, KaxSegment * );
     virtual ~matroska_segment_c();
 
@@ -146,7 +157,7 @@ public:
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
 
     int BlockGet( KaxBlock * &, KaxSimpleBlock * &, KaxBlockAdditions * &,
-                  bool *, bool *, int64_t *);
+                  bool *, bool *, int64_t *, fast_block_t * = NULL );
 
     mkv_track_t * FindTrackByBlock(const KaxBlock *, const KaxSimpleBlock * );
 
@@ -173,8 +184,11 @@ private:
     bool TrackInit( mkv_track_t * p_tk );
     void ComputeTrackPriority();
     void EnsureDuration();
+    void StartClusterIndexer();
+    int  FastBlockGet( fast_block_t & );
 
     SegmentSeeker _seeker;
+    std::unique_ptr<ClusterIndexer> _indexer;
 
     friend SegmentSeeker;
 };
@@ -74,6 +74,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
@@ -112,6 +118,32 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
     return it;
 }
 
+bool
+SegmentSeeker::import_index( ClusterIndexer& indexer )
+{
+    ClusterIndexer::clusters_t  clusters;
+    ClusterIndexer::keyframes_t keyframes;
+
+    bool const b_done = indexer.fetch( clusters, keyframes );
+
+    for( ClusterIndexer::clusters_t::const_iterator it = clusters.begin(); it != clusters.end(); ++it )
+    {
+        Cluster cinfo = {
+            /* fpos     */ it->fpos,
+            /* pts      */ it->pts,
+            /* duration */ vlc_tick_t( -1 ),
+            /* size     */ it->size
+        };
+
+        add_cluster( cinfo );
+    }
+
+    for( ClusterIndexer::keyframes_t::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it )
+        add_seekpoint( it->track_id, Seekpoint( it->fpos, it->pts ) );
+
+    return b_done;
+}
+
 void
 SegmentSeeker::add_seekpoint( track_id_t track_id, Seekpoint sp )
 {
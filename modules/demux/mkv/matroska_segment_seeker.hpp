@@ -24,6 +24,7 @@
 #define MKV_MATROSKA_SEGMENT_SEEKER_HPP_
 
 #include "mkv.hpp"
+#include "cluster_indexer.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -110,6 +111,9 @@ class SegmentSeeker
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
         cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        cluster_map_t      ::iterator add_cluster( Cluster const& );
+
+        bool import_index( ClusterIndexer& );
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -82,6 +82,14 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") );
 
+    add_bool( "mkv-index-clusters", true,
+            N_("Index clusters in background"),
+            N_("Scan the clusters of seekable files without complete cues, through a separate connection, to seek without parsing the blocks.") );
+
+    add_bool( "mkv-index-cache", false,
+            N_("Cache clusters index"),
+            N_("Save the scanned clusters index of a file to the cache directory, and reuse it when opening that same file again.") );
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -526,6 +534,158 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_mk_date, double f_percent, virtu
     return p_vsegment->Seek( *p_demux, i_mk_date, p_vchapter, b_precise ) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+static bool BlockTrackSelected( demux_t *p_demux, mkv_track_t &track )
+{
+    if( track.fmt.i_cat != DATA_ES && track.p_es == NULL )
+    {
+        msg_Err( p_demux, "unknown track number %u (%4.4s)",
+                 track.i_number, (const char *) &track.fmt.i_codec );
+        return false;
+    }
+
+    if ( track.fmt.i_cat != DATA_ES )
+    {
+        bool b;
+        es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE, track.p_es, &b );
+
+        if( !b )
+        {
+            if( track.fmt.i_cat == VIDEO_ES || track.fmt.i_cat == AUDIO_ES )
+                track.i_last_dts = VLC_TICK_INVALID;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* sends one frame of a block, returns false if the following frames of
+ * the block must be dropped */
+static bool BlockSendFrame( demux_t *p_demux, mkv_track_t &track, block_t *p_block,
+                            KaxBlockAdditions *additions, vlc_tick_t &i_pts,
+                            int64_t i_duration, unsigned i_number_frames,
+                            bool b_key_picture, bool b_discardable_picture )
+{
+    demux_sys_t *p_sys = (demux_sys_t *)p_demux->p_sys;
+    matroska_segment_c *p_segment = p_sys->p_current_vsegment->CurrentSegment();
+
+    if ( b_key_picture )
+        p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+
+    switch( track.fmt.i_codec )
+    {
+    case VLC_CODEC_COOK:
+    case VLC_CODEC_ATRAC3:
+    {
+        handle_real_audio(p_demux, &track, p_block, i_pts);
+        block_Release(p_block);
+        i_pts = ( track.i_default_duration )?
+            i_pts + track.i_default_duration:
+            VLC_TICK_INVALID;
+        return true;
+     }
+
+     case VLC_CODEC_WEBVTT:
+        {
+            const uint8_t *p_addition = NULL;
+            size_t i_addition = 0;
+            if(additions)
+            {
+                KaxBlockMore *blockmore = FindChild<KaxBlockMore>(*additions);
+                if(blockmore)
+                {
+                    KaxBlockAdditional *addition = FindChild<KaxBlockAdditional>(*blockmore);
+                    if(addition)
+                    {
+                        i_addition = static_cast<std::string::size_type>(addition->GetSize());
+                        p_addition = reinterpret_cast<const uint8_t *>(addition->GetBuffer());
+                    }
+                }
+            }
+            p_block = WEBVTT_Repack_Sample( p_block, /* D_WEBVTT -> webm */
+                                            !track.codec.compare( 0, 1, "D" ),
+                                            p_addition, i_addition );
+            if( !p_block )
+                return true;
+        }
+        break;
+
+     case VLC_CODEC_OPUS:
+        {
+            vlc_tick_t i_length = VLC_TICK_FROM_NS(i_duration * track.f_timecodescale *
+                                                   p_segment->i_timescale);
+            if ( i_length < 0 ) i_length = 0;
+            p_block->i_nb_samples = samples_from_vlc_tick(i_length, track.fmt.audio.i_rate);
+        }
+        break;
+
+     case VLC_CODEC_DVBS:
+        {
+            p_block = block_Realloc( p_block, 2, p_block->i_buffer + 1);
+
+            if( unlikely( !p_block ) )
+                return true;
+
+            p_block->p_buffer[0] = 0x20; // data identifier
+            p_block->p_buffer[1] = 0x00; // subtitle stream id
+            p_block->p_buffer[ p_block->i_buffer - 1 ] = 0x3f; // end marker
+        }
+        break;
+
+      case VLC_CODEC_AV1:
+        p_block = AV1_Unpack_Sample( p_block );
+        if( unlikely( !p_block ) )
+            return true;
+        break;
+    }
+
+    if( track.fmt.i_cat != VIDEO_ES )
+    {
+        if ( track.fmt.i_cat == DATA_ES )
+        {
+            // TODO handle the start/stop times of this packet
+            if( p_block->i_size >= sizeof(pci_t))
+                p_sys->ev.SetPci( (const pci_t *)&p_block->p_buffer[1]);
+            block_Release( p_block );
+            return false;
+        }
+        p_block->i_dts = p_block->i_pts = i_pts;
+    }
+    else
+    {
+        // correct timestamping when B frames are used
+        if( track.b_dts_only )
+        {
+            p_block->i_pts = VLC_TICK_INVALID;
+            p_block->i_dts = i_pts;
+        }
+        else if( track.b_pts_only )
+        {
+            p_block->i_pts = i_pts;
+            p_block->i_dts = i_pts;
+        }
+        else
+        {
+            p_block->i_pts = i_pts;
+            // condition when the DTS is correct (keyframe or B frame == NOT P frame)
+            if ( b_key_picture || b_discardable_picture )
+                    p_block->i_dts = p_block->i_pts;
+            else if ( track.i_last_dts == VLC_TICK_INVALID )
+                p_block->i_dts = i_pts;
+            else
+                p_block->i_dts = std::min( i_pts, track.i_last_dts + track.i_default_duration );
+        }
+    }
+
+    send_Block( p_demux, &track, p_block, i_number_frames, i_duration );
+
+    /* use time stamp only for first block */
+    i_pts = ( track.i_default_duration )?
+             i_pts + track.i_default_duration:
+             ( track.fmt.b_packetized ) ? VLC_TICK_INVALID : i_pts + 1;
+    return true;
+}
+
 /* Needed by matroska_segment::Seek() and Seek */
 void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock,
                   KaxBlockAdditions *additions,
@@ -550,28 +710,11 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
 
     mkv_track_t &track = *p_track;
 
-    if( track.fmt.i_cat != DATA_ES && track.p_es == NULL )
-    {
-        msg_Err( p_demux, "unknown track number %u (%4.4s)",
-                 track.i_number, (const char *) &track.fmt.i_codec );
+    if( !BlockTrackSelected( p_demux, track ) )
         return;
-    }
 
     i_pts -= track.i_codec_delay;
 
-    if ( track.fmt.i_cat != DATA_ES )
-    {
-        bool b;
-        es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE, track.p_es, &b );
-
-        if( !b )
-        {
-            if( track.fmt.i_cat == VIDEO_ES || track.fmt.i_cat == AUDIO_ES )
-                track.i_last_dts = VLC_TICK_INVALID;
-            return;
-        }
-    }
-
     size_t frame_size = 0;
     size_t block_size = internal_block.GetSize();
     const unsigned i_number_frames = internal_block.NumberFrames();
@@ -621,121 +764,26 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
         if ( track.fmt.i_codec == VLC_CODEC_PRORES )
             memcpy( p_block->p_buffer + 4, "icpf", 4 );
 
-        if ( b_key_picture )
-            p_block->i_flags |= BLOCK_FLAG_TYPE_I;
-
-        switch( track.fmt.i_codec )
-        {
-        case VLC_CODEC_COOK:
-        case VLC_CODEC_ATRAC3:
-        {
-            handle_real_audio(p_demux, &track, p_block, i_pts);
-            block_Release(p_block);
-            i_pts = ( track.i_default_duration )?
-                i_pts + track.i_default_duration:
-                VLC_TICK_INVALID;
-            continue;
-         }
-
-         case VLC_CODEC_WEBVTT:
-            {
-                const uint8_t *p_addition = NULL;
-                size_t i_addition = 0;
-                if(additions)
-                {
-                    KaxBlockMore *blockmore = FindChild<KaxBlockMore>(*additions);
-                    if(blockmore)
-                    {
-                        KaxBlockAdditional *addition = FindChild<KaxBlockAdditional>(*blockmore);
-                        if(addition)
-                        {
-                            i_addition = static_cast<std::string::size_type>(addition->GetSize());
-                            p_addition = reinterpret_cast<const uint8_t *>(addition->GetBuffer());
-                        }
-                    }
-                }
-                p_block = WEBVTT_Repack_Sample( p_block, /* D_WEBVTT -> webm */
-                                                !p_track->codec.compare( 0, 1, "D" ),
-                                                p_addition, i_addition );
-                if( !p_block )
-                    continue;
-            }
-            break;
-
-         case VLC_CODEC_OPUS:
-            {
-                vlc_tick_t i_length = VLC_TICK_FROM_NS(i_duration * track.f_timecodescale *
-                                                       p_segment->i_timescale);
-                if ( i_length < 0 ) i_length = 0;
-                p_block->i_nb_samples = samples_from_vlc_tick(i_length, track.fmt.audio.i_rate);
-            }
-            break;
-
-         case VLC_CODEC_DVBS:
-            {
-                p_block = block_Realloc( p_block, 2, p_block->i_buffer + 1);
-
-                if( unlikely( !p_block ) )
-                    continue;
-
-                p_block->p_buffer[0] = 0x20; // data identifier
-                p_block->p_buffer[1] = 0x00; // subtitle stream id
-                p_block->p_buffer[ p_block->i_buffer - 1 ] = 0x3f; // end marker
-            }
-            break;
-
-          case VLC_CODEC_AV1:
-            p_block = AV1_Unpack_Sample( p_block );
-            if( unlikely( !p_block ) )
-                continue;
-            break;
-        }
+        if( !BlockSendFrame( p_demux, track, p_block, additions, i_pts, i_duration,
+                             i_number_frames, b_key_picture, b_discardable_picture ) )
+            return;
+    }
+}
 
-        if( track.fmt.i_cat != VIDEO_ES )
-        {
-            if ( track.fmt.i_cat == DATA_ES )
-            {
-                // TODO handle the start/stop times of this packet
-                if( p_block->i_size >= sizeof(pci_t))
-                    p_sys->ev.SetPci( (const pci_t *)&p_block->p_buffer[1]);
-                block_Release( p_block );
-                return;
-            }
-            p_block->i_dts = p_block->i_pts = i_pts;
-        }
-        else
-        {
-            // correct timestamping when B frames are used
-            if( track.b_dts_only )
-            {
-                p_block->i_pts = VLC_TICK_INVALID;
-                p_block->i_dts = i_pts;
-            }
-            else if( track.b_pts_only )
-            {
-                p_block->i_pts = i_pts;
-                p_block->i_dts = i_pts;
-            }
-            else
-            {
-                p_block->i_pts = i_pts;
-                // condition when the DTS is correct (keyframe or B frame == NOT P frame)
-                if ( b_key_picture || b_discardable_picture )
-                        p_block->i_dts = p_block->i_pts;
-                else if ( track.i_last_dts == VLC_TICK_INVALID )
-                    p_block->i_dts = i_pts;
-                else
-                    p_block->i_dts = std::min( i_pts, track.i_last_dts + track.i_default_duration );
-            }
-        }
+void BlockDecode( demux_t *p_demux, mkv_track_t &track, block_t *p_block,
+                  vlc_tick_t i_pts, int64_t i_duration, bool b_key_picture,
+                  bool b_discardable_picture )
+{
+    if( !BlockTrackSelected( p_demux, track ) )
+    {
+        block_Release( p_block );
+        return;
+    }
 
-        send_Block( p_demux, &track, p_block, i_number_frames, i_duration );
+    i_pts -= track.i_codec_delay;
 
-        /* use time stamp only for first block */
-        i_pts = ( track.i_default_duration )?
-                 i_pts + track.i_default_duration:
-                 ( track.fmt.b_packetized ) ? VLC_TICK_INVALID : i_pts + 1;
-    }
+    BlockSendFrame( p_demux, track, p_block, NULL, i_pts, i_duration,
+                    1, b_key_picture, b_discardable_picture );
 }
 
 /*****************************************************************************
@@ -768,9 +816,11 @@ static int Demux( demux_t *p_demux)
     int64_t i_block_duration = 0;
     bool b_key_picture;
     bool b_discardable_picture;
+    matroska_segment_c::fast_block_t fast;
 
     if( p_segment->BlockGet( block, simpleblock, additions,
-                             &b_key_picture, &b_discardable_picture, &i_block_duration ) )
+                             &b_key_picture, &b_discardable_picture, &i_block_duration,
+                             &fast ) )
     {
         if ( p_vsegment->CurrentEdition() && p_vsegment->CurrentEdition()->b_ordered )
         {
@@ -791,13 +841,28 @@ static int Demux( demux_t *p_demux)
         return VLC_DEMUXER_EOF;
     }
 
-    KaxInternalBlock& internal_block = block
-        ? static_cast<KaxInternalBlock&>( *block )
-        : static_cast<KaxInternalBlock&>( *simpleblock );
+    mkv_track_t *p_track;
+    uint64_t     block_fpos;
+    vlc_tick_t   block_time;
 
+    if( fast.p_block != NULL )
+    {
+        p_track    = p_segment->tracks.at( fast.track_id ).get();
+        block_fpos = fast.i_position;
+        block_time = fast.i_pts;
+    }
+    else
     {
-        mkv_track_t *p_track = p_segment->FindTrackByBlock( block, simpleblock );
+        KaxInternalBlock& internal_block = block
+            ? static_cast<KaxInternalBlock&>( *block )
+            : static_cast<KaxInternalBlock&>( *simpleblock );
 
+        p_track    = p_segment->FindTrackByBlock( block, simpleblock );
+        block_fpos = internal_block.GetElementPosition();
+        block_time = VLC_TICK_FROM_NS(internal_block.GlobalTimecode());
+    }
+
+    {
         if( p_track == NULL )
         {
             msg_Err( p_demux, "invalid track number" );
@@ -811,10 +876,10 @@ static int Demux( demux_t *p_demux)
 
         if( track.i_skip_until_fpos != std::numeric_limits<uint64_t>::max() ) {
 
-            uint64_t block_fpos = internal_block.GetElementPosition();
-
             if ( track.i_skip_until_fpos > block_fpos )
             {
+                if( fast.p_block != NULL )
+                    block_Release( fast.p_block );
                 delete block;
                 delete additions;
                 return VLC_DEMUXER_SUCCESS; // this block shall be ignored
@@ -849,6 +914,8 @@ static int Demux( demux_t *p_demux)
             if( es_out_SetPCR( p_demux->out, i_pcr ) )
             {
                 msg_Err( p_demux, "ES_OUT_SET_PCR failed, aborting." );
+                if( fast.p_block != NULL )
+                    block_Release( fast.p_block );
                 delete block;
                 delete additions;
                 return VLC_DEMUXER_EGENERIC;
@@ -861,7 +928,7 @@ static int Demux( demux_t *p_demux)
     /* set pts */
     {
         p_sys->i_pts = p_sys->i_mk_chapter_time + VLC_TICK_0;
-        p_sys->i_pts += VLC_TICK_FROM_NS(internal_block.GlobalTimecode());
+        p_sys->i_pts += block_time;
     }
 
     if ( p_vsegment->CurrentEdition() &&
@@ -869,13 +936,19 @@ static int Demux( demux_t *p_demux)
          p_vsegment->CurrentChapter() == NULL )
     {
         /* nothing left to read in this ordered edition */
+        if( fast.p_block != NULL )
+            block_Release( fast.p_block );
         delete block;
         delete additions;
         return VLC_DEMUXER_EOF;
     }
 
-    BlockDecode( p_demux, block, simpleblock, additions,
-                 p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
+    if( fast.p_block != NULL )
+        BlockDecode( p_demux, *p_track, fast.p_block,
+                     p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
+    else
+        BlockDecode( p_demux, block, simpleblock, additions,
+                     p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
 
     delete block;
     delete additions;
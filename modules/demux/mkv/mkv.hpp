@@ -124,6 +124,12 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
                   vlc_tick_t i_pts, vlc_tick_t i_duration, bool b_key_picture,
                   bool b_discardable_picture );
 
+class mkv_track_t;
+/* single frame already read into a block */
+void BlockDecode( demux_t *p_demux, mkv_track_t &track, block_t *p_block,
+                  vlc_tick_t i_pts, int64_t i_duration, bool b_key_picture,
+                  bool b_discardable_picture );
+
 class matroska_segment_c;
 struct matroska_stream_c
 {
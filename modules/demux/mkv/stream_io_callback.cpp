@@ -43,6 +43,28 @@ uint32 vlc_stream_io_callback::read( void *p_buffer, size_t i_size )
     return i_ret < 0 ? 0 : i_ret;
 }
 
+ssize_t vlc_stream_io_callback::peek( const uint8_t **pp_peek, size_t i_size )
+{
+    if( i_size == 0 || mb_eof )
+        return 0;
+
+    return vlc_stream_Peek( s, pp_peek, i_size );
+}
+
+block_t *vlc_stream_io_callback::readBlock( size_t i_size )
+{
+    if( i_size == 0 || mb_eof )
+        return NULL;
+
+    block_t *p_block = vlc_stream_Block( s, i_size );
+    if( p_block != NULL && p_block->i_buffer != i_size )
+    {
+        block_Release( p_block );
+        return NULL;
+    }
+    return p_block;
+}
+
 void vlc_stream_io_callback::setFilePointer(int64_t i_offset, seek_mode mode )
 {
     int64_t i_pos, i_size;
@@ -56,6 +56,7 @@ class vlc_stream_io_callback: public IOCallback
     }
 
     bool IsEOF() const { return mb_eof; }
+    const char *GetURL() const { return s->psz_url; }
 
     virtual uint32   read            ( void *p_buffer, size_t i_size);
     virtual void     setFilePointer  ( int64_t i_offset, seek_mode mode = seek_beginning );
@@ -63,6 +64,10 @@ class vlc_stream_io_callback: public IOCallback
     virtual uint64   getFilePointer  ( void );
     virtual void     close           ( void ) { return; }
     uint64           toRead          ( void );
+
+    /* direct access to the stream, bypassing the libebml buffers */
+    ssize_t          peek            ( const uint8_t **pp_peek, size_t i_size );
+    block_t         *readBlock       ( size_t i_size );
 };
 
 } // namespace
@@ -36,25 +36,140 @@ void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
 
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num )
 {
-    if( !i_tracks || !i_num || SIZE_MAX / i_num < i_tracks )
+    /* with no entries yet, allocate some room to append to */
+    const unsigned i_alloc = i_num ? i_num : 64;
+    if( !i_tracks || SIZE_MAX / i_alloc < i_tracks )
         return NULL;
     mp4_fragments_index_t *p_index = malloc( sizeof(*p_index) );
     if( p_index )
     {
-        p_index->p_times = calloc( (size_t)i_num * i_tracks, sizeof(*p_index->p_times) );
-        p_index->pi_pos = calloc( i_num, sizeof(*p_index->pi_pos) );
+        p_index->p_times = calloc( (size_t)i_alloc * i_tracks, sizeof(*p_index->p_times) );
+        p_index->pi_pos = calloc( i_alloc, sizeof(*p_index->pi_pos) );
         if( !p_index->p_times || !p_index->pi_pos )
         {
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
         p_index->i_entries = i_num;
+        p_index->i_allocated = i_alloc;
         p_index->i_last_time = 0;
         p_index->i_tracks = i_tracks;
     }
     return p_index;
 }
 
+int MP4_Fragments_Index_Append( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                                const stime_t *p_times )
+{
+    if( p_index->i_entries == p_index->i_allocated )
+    {
+        if( p_index->i_allocated > UINT_MAX / 2 ||
+            SIZE_MAX / 2 / p_index->i_allocated < p_index->i_tracks )
+            return VLC_ENOMEM;
+
+        const unsigned i_alloc = p_index->i_allocated * 2;
+        uint64_t *pi_pos = realloc( p_index->pi_pos, sizeof(*pi_pos) * i_alloc );
+        if( !pi_pos )
+            return VLC_ENOMEM;
+        p_index->pi_pos = pi_pos;
+
+        stime_t *p_times = realloc( p_index->p_times, sizeof(*p_times) *
+                                    (size_t)i_alloc * p_index->i_tracks );
+        if( !p_times )
+            return VLC_ENOMEM;
+        p_index->p_times = p_times;
+        p_index->i_allocated = i_alloc;
+    }
+
+    memcpy( &p_index->p_times[(size_t)p_index->i_entries * p_index->i_tracks],
+            p_times, sizeof(*p_times) * p_index->i_tracks );
+    p_index->pi_pos[p_index->i_entries++] = i_pos;
+    return VLC_SUCCESS;
+}
+
+/* Cached index file layout, all values big endian:
+ * magic, key, tracks count (32 bits), entries count (32 bits), last time,
+ * then for each entry, its position followed by the time of each track */
+static const char sz_cache_magic[8] = { 'V','L','C','M','P','4','I','1' };
+
+int MP4_Fragments_Index_Save( const mp4_fragments_index_t *p_index, FILE *p_file,
+                              const uint8_t key[MP4_FRAGMENTS_INDEX_KEY_SIZE] )
+{
+    uint8_t header[sizeof(sz_cache_magic) + MP4_FRAGMENTS_INDEX_KEY_SIZE + 16];
+    uint8_t *p = header;
+
+    memcpy( p, sz_cache_magic, sizeof(sz_cache_magic) );
+    p += sizeof(sz_cache_magic);
+    memcpy( p, key, MP4_FRAGMENTS_INDEX_KEY_SIZE );
+    p += MP4_FRAGMENTS_INDEX_KEY_SIZE;
+    SetDWBE( p, p_index->i_tracks );
+    SetDWBE( p + 4, p_index->i_entries );
+    SetQWBE( p + 8, p_index->i_last_time );
+
+    if( fwrite( header, sizeof(header), 1, p_file ) != 1 )
+        return VLC_EGENERIC;
+
+    for( unsigned i=0; i<p_index->i_entries; i++ )
+    {
+        uint8_t entry[8];
+
+        SetQWBE( entry, p_index->pi_pos[i] );
+        if( fwrite( entry, sizeof(entry), 1, p_file ) != 1 )
+            return VLC_EGENERIC;
+
+        for( unsigned j=0; j<p_index->i_tracks; j++ )
+        {
+            SetQWBE( entry, p_index->p_times[(size_t)i * p_index->i_tracks + j] );
+            if( fwrite( entry, sizeof(entry), 1, p_file ) != 1 )
+                return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+mp4_fragments_index_t * MP4_Fragments_Index_Load( FILE *p_file, unsigned i_tracks,
+                                                  const uint8_t key[MP4_FRAGMENTS_INDEX_KEY_SIZE] )
+{
+    uint8_t header[sizeof(sz_cache_magic) + MP4_FRAGMENTS_INDEX_KEY_SIZE + 16];
+    const uint8_t *p = header;
+
+    if( fread( header, sizeof(header), 1, p_file ) != 1 ||
+        memcmp( p, sz_cache_magic, sizeof(sz_cache_magic) ) ||
+        memcmp( p + sizeof(sz_cache_magic), key, MP4_FRAGMENTS_INDEX_KEY_SIZE ) )
+        return NULL;
+    p += sizeof(sz_cache_magic) + MP4_FRAGMENTS_INDEX_KEY_SIZE;
+
+    const unsigned i_entries = GetDWBE( p + 4 );
+    if( GetDWBE( p ) != i_tracks || i_entries == 0 )
+        return NULL;
+
+    mp4_fragments_index_t *p_index = MP4_Fragments_Index_New( i_tracks, i_entries );
+    if( !p_index )
+        return NULL;
+    p_index->i_last_time = GetQWBE( p + 8 );
+
+    for( unsigned i=0; i<i_entries; i++ )
+    {
+        uint8_t entry[8];
+
+        if( fread( entry, sizeof(entry), 1, p_file ) != 1 )
+            goto error;
+        p_index->pi_pos[i] = GetQWBE( entry );
+
+        for( unsigned j=0; j<i_tracks; j++ )
+        {
+            if( fread( entry, sizeof(entry), 1, p_file ) != 1 )
+                goto error;
+            p_index->p_times[(size_t)i * i_tracks + j] = GetQWBE( entry );
+        }
+    }
+    return p_index;
+
+error:
+    MP4_Fragments_Index_Delete( p_index );
+    return NULL;
+}
+
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
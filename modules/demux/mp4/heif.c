@@ -30,6 +30,7 @@
 #include <vlc_image.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdatomic.h>
 
 #include "libmp4.h"
 #include "heif.h"
@@ -534,12 +535,30 @@ static int ReadDerivationData( demux_t *p_demux, vlc_fourcc_t type,
     return i_ret;
 }
 
-static int LoadGridImage( demux_t *p_demux,
-                          image_handler_t *handler,
-                          uint32_t i_pic_item_id,
-                               uint8_t *p_buffer,
-                               unsigned tile, unsigned gridcols,
-                               unsigned imagewidth, unsigned imageheight )
+#define HEIF_MAX_GRID_THREADS 8
+
+struct heif_grid_tile
+{
+    es_format_t fmt;
+    block_t *p_sample;
+};
+
+struct heif_grid
+{
+    demux_t *p_demux;
+    struct heif_grid_tile *p_tiles;
+    unsigned i_tiles;
+    atomic_uint next_tile;
+
+    uint8_t *p_buffer;
+    unsigned gridcols;
+    unsigned imagewidth;
+    unsigned imageheight;
+};
+
+/* Reads the tile sample, this must be done from the demuxer thread */
+static int LoadGridImage( demux_t *p_demux, uint32_t i_pic_item_id,
+                          struct heif_grid_tile *p_tile )
 {
     struct heif_private_t *p_sys = (void *) p_demux->p_sys;
 
@@ -549,45 +568,50 @@ static int LoadGridImage( demux_t *p_demux,
     if( !p_infe )
         return VLC_EGENERIC;
 
-    es_format_t fmt;
-    es_format_Init(&fmt, UNKNOWN_ES, 0);
-
+    es_format_t *fmt = &p_tile->fmt;
     const MP4_Box_t *p_shared_header = NULL;
-    if( SetupPicture( p_demux, p_infe, &fmt, &p_shared_header ) != VLC_SUCCESS )
-    {
-        es_format_Clean( &fmt );
+    if( SetupPicture( p_demux, p_infe, fmt, &p_shared_header ) != VLC_SUCCESS )
         return VLC_EGENERIC; /* Unsupported picture, goto next */
-    }
 
-    block_t *p_sample = ReadItemExtents( p_demux, i_pic_item_id,
-                                         p_shared_header );
-    if(!p_sample)
-    {
-        es_format_Clean( &fmt );
+    p_tile->p_sample = ReadItemExtents( p_demux, i_pic_item_id,
+                                        p_shared_header );
+    if( !p_tile->p_sample )
         return VLC_EGENERIC;
-    }
 
-    video_format_t decoded;
-    video_format_Init( &decoded, VLC_CODEC_RGBA );
+    fmt->video.i_chroma = fmt->i_codec;
+    return VLC_SUCCESS;
+}
 
-    fmt.video.i_chroma = fmt.i_codec;
+/* Decodes a tile and copies it at its place in the grid picture */
+static void DecodeGridImage( struct heif_grid *p_grid,
+                             image_handler_t *handler, unsigned tile )
+{
+    struct heif_grid_tile *p_tile = &p_grid->p_tiles[tile];
+    const unsigned gridcols = p_grid->gridcols;
+    const unsigned imagewidth = p_grid->imagewidth;
+    const unsigned imageheight = p_grid->imageheight;
 
-    picture_t *p_picture = image_Read( handler, p_sample, &fmt, &decoded );
+    block_t *p_sample = p_tile->p_sample;
+    p_tile->p_sample = NULL;
+    if( !p_sample )
+        return;
 
-    es_format_Clean( &fmt );
+    video_format_t decoded;
+    video_format_Init( &decoded, VLC_CODEC_RGBA );
 
+    picture_t *p_picture = image_Read( handler, p_sample, &p_tile->fmt, &decoded );
     if ( !p_picture )
-        return VLC_EGENERIC;
+        return;
 
     const unsigned tilewidth = p_picture->format.i_visible_width;
     const unsigned tileheight = p_picture->format.i_visible_height;
-    uint8_t *dstline = p_buffer;
+    uint8_t *dstline = p_grid->p_buffer;
     dstline += (tile / gridcols) * (imagewidth * tileheight * 4);
     for(;1;)
     {
         const unsigned offsetpxw = (tile % gridcols) * tilewidth;
         const unsigned offsetpxh = (tile / gridcols) * tileheight;
-        if( offsetpxw > imagewidth )
+        if( offsetpxw > imagewidth || offsetpxh >= imageheight )
             break;
         const uint8_t *srcline = p_picture->p[0].p_pixels;
         unsigned tocopylines = p_picture->p[0].i_lines;
@@ -607,8 +631,32 @@ static int LoadGridImage( demux_t *p_demux,
     }
 
     picture_Release( p_picture );
+}
 
-    return VLC_SUCCESS;
+static void DecodeGridImages( struct heif_grid *p_grid,
+                              image_handler_t *handler )
+{
+    for( ;; )
+    {
+        unsigned tile = atomic_fetch_add_explicit( &p_grid->next_tile, 1,
+                                                   memory_order_relaxed );
+        if( tile >= p_grid->i_tiles )
+            break;
+        DecodeGridImage( p_grid, handler, tile );
+    }
+}
+
+static void *GridThread( void *data )
+{
+    struct heif_grid *p_grid = data;
+
+    image_handler_t *handler = image_HandlerCreate( p_grid->p_demux );
+    if( handler )
+    {
+        DecodeGridImages( p_grid, handler );
+        image_HandlerDelete( handler );
+    }
+    return NULL;
 }
 
 static int DerivedImageAssembleGrid( demux_t *p_demux, uint32_t i_grid_item_id,
@@ -643,15 +691,37 @@ static int DerivedImageAssembleGrid( demux_t *p_demux, uint32_t i_grid_item_id,
             derivation_data.ImageGrid.columns_minus_one + 1,
             derivation_data.ImageGrid.columns_minus_one + 1);
 
+    const unsigned i_tiles = BOXDATA(p_refbox)->i_reference_count;
+    struct heif_grid grid = {
+        .p_demux = p_demux,
+        .i_tiles = i_tiles,
+        .gridcols = derivation_data.ImageGrid.columns_minus_one + 1,
+        .imagewidth = derivation_data.ImageGrid.output_width,
+        .imageheight = derivation_data.ImageGrid.output_height,
+    };
+    atomic_init( &grid.next_tile, 0 );
+
+    grid.p_tiles = vlc_alloc( i_tiles, sizeof(*grid.p_tiles) );
+    if( i_tiles && !grid.p_tiles )
+        return VLC_EGENERIC;
+
     image_handler_t *handler = image_HandlerCreate( p_demux );
     if( !handler )
+    {
+        free( grid.p_tiles );
         return VLC_EGENERIC;
+    }
 
     block_t *p_block = block_Alloc( derivation_data.ImageGrid.output_width *
                                     derivation_data.ImageGrid.output_height * 4 );
     if( !p_block )
+    {
+        image_HandlerDelete( handler );
+        free( grid.p_tiles );
         return VLC_EGENERIC;
+    }
     *pp_block = p_block;
+    grid.p_buffer = p_block->p_buffer;
 
     es_format_Init( fmt, VIDEO_ES, VLC_CODEC_RGBA );
     fmt->video.i_sar_num =
@@ -661,18 +731,42 @@ static int DerivedImageAssembleGrid( demux_t *p_demux, uint32_t i_grid_item_id,
     fmt->video.i_height =
     fmt->video.i_visible_height = derivation_data.ImageGrid.output_height;
 
-    for( uint16_t i=0; i<BOXDATA(p_refbox)->i_reference_count; i++ )
+    /* The samples are read sequentially, then the tiles are decoded in
+     * parallel, each thread with its own decoder, straight into the grid */
+    for( unsigned i=0; i<i_tiles; i++ )
     {
-        msg_Dbg( p_demux, "Loading tile %d/%d", i,
+        msg_Dbg( p_demux, "Loading tile %u/%d", i,
                  (derivation_data.ImageGrid.rows_minus_one + 1) *
                  (derivation_data.ImageGrid.columns_minus_one + 1) );
-        LoadGridImage( p_demux, handler,
-                       BOXDATA(p_refbox)->p_references[i].i_to_item_id,
-                       p_block->p_buffer, i,
-                       derivation_data.ImageGrid.columns_minus_one + 1,
-                       derivation_data.ImageGrid.output_width,
-                       derivation_data.ImageGrid.output_height );
+        es_format_Init( &grid.p_tiles[i].fmt, UNKNOWN_ES, 0 );
+        grid.p_tiles[i].p_sample = NULL;
+        LoadGridImage( p_demux, BOXDATA(p_refbox)->p_references[i].i_to_item_id,
+                       &grid.p_tiles[i] );
+    }
+
+    vlc_thread_t threads[HEIF_MAX_GRID_THREADS - 1];
+    unsigned i_threads = __MIN( vlc_GetCPUCount(), HEIF_MAX_GRID_THREADS );
+    if( i_threads > i_tiles )
+        i_threads = i_tiles;
+
+    unsigned i_started = 0;
+    while( i_started + 1 < i_threads &&
+           !vlc_clone( &threads[i_started], GridThread, &grid,
+                       VLC_THREAD_PRIORITY_LOW ) )
+        i_started++;
+
+    DecodeGridImages( &grid, handler );
+
+    for( unsigned i=0; i<i_started; i++ )
+        vlc_join( threads[i], NULL );
+
+    for( unsigned i=0; i<i_tiles; i++ )
+    {
+        if( grid.p_tiles[i].p_sample )
+            block_Release( grid.p_tiles[i].p_sample );
+        es_format_Clean( &grid.p_tiles[i].fmt );
     }
+    free( grid.p_tiles );
 
     SetPictureProperties( p_demux, i_grid_item_id, fmt, NULL );
 
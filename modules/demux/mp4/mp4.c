@@ -35,6 +35,9 @@
 #include <vlc_plugin.h>
 #include <vlc_dialog.h>
 #include <vlc_url.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_interrupt.h>
 #include <assert.h>
 #include <limits.h>
 #include "attachments.h"
@@ -53,6 +56,17 @@ static void Close( vlc_object_t * );
 #define MP4_M4A_TEXT     N_("M4A audio only")
 #define MP4_M4A_LONGTEXT N_("Ignore non audio tracks from iTunes audio files")
 
+#define MP4_INDEX_SCAN_TEXT N_("Index fragments in background")
+#define MP4_INDEX_SCAN_LONGTEXT N_( \
+    "Scan the fragments of seekable fragmented files without a fragments " \
+    "index, through a separate connection, so that seeking does not " \
+    "need to read them all first.")
+
+#define MP4_INDEX_CACHE_TEXT N_("Cache fragments index")
+#define MP4_INDEX_CACHE_LONGTEXT N_( \
+    "Save the scanned fragments index of a file to the cache directory, " \
+    "and reuse it when opening that same file again.")
+
 #define HEIF_DURATION_TEXT N_("Duration in seconds")
 #define HEIF_DURATION_LONGTEXT N_( \
     "Duration in seconds before simulating an end of file. " \
@@ -71,6 +85,11 @@ vlc_module_begin ()
     add_file_extension("mov")
     add_file_extension("mp4")
 
+    add_bool( CFG_PREFIX"index-scan", true, MP4_INDEX_SCAN_TEXT,
+              MP4_INDEX_SCAN_LONGTEXT )
+    add_bool( CFG_PREFIX"index-cache", false, MP4_INDEX_CACHE_TEXT,
+              MP4_INDEX_CACHE_LONGTEXT )
+
     set_section("Hacks", NULL)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT )
 
@@ -146,6 +165,22 @@ typedef struct
 
     mp4_fragments_index_t *p_fragsindex;
 
+    /* background fragments scan */
+    struct
+    {
+        bool             b_started;
+        vlc_thread_t     thread;
+        vlc_interrupt_t *p_interrupt;
+        vlc_mutex_t      lock;
+        vlc_cond_t       wait;
+        mp4_fragments_index_t *p_index; /* growing, under lock */
+        bool             b_done;
+        bool             b_complete;
+        bool             b_interrupted;
+        uint8_t          key[MP4_FRAGMENTS_INDEX_KEY_SIZE];
+        char            *psz_cache;
+    } indexer;
+
     ssize_t i_attachments;
     input_attachment_t **pp_attachments;
 } demux_sys_t;
@@ -191,6 +226,12 @@ static int  ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented
 static int  ProbeFragmentsChecked( demux_t *p_demux );
 static int  ProbeIndex( demux_t *p_demux );
 
+static void FragIndexerStart( demux_t * );
+static void FragIndexerStop( demux_t * );
+static void FragIndexerAdopt( demux_t * );
+static int  FragIndexerLookup( demux_t *, stime_t *pi_time, uint64_t *pi_pos,
+                               unsigned i_track_index );
+
 static int FragCreateTrunIndex( demux_t *, MP4_Box_t *, MP4_Box_t *, stime_t );
 
 static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t i_target_time,
@@ -345,104 +386,140 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocDtsEntries( mp4_chunk_t *ck )
+/* Runs of samples of a chunk in the stts or ctts table */
+typedef struct
 {
-    size_t entries = ck->i_entries_dts;
-
-    if( entries <= ARRAY_SIZE(ck->small_dts_buf) / 2 )
-    {
-        ck->p_sample_count_dts = ck->small_dts_buf;
-        ck->p_sample_delta_dts = ck->small_dts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_dts = buf;
-    ck->p_sample_delta_dts = buf + entries;
-    return 0;
+    const uint32_t *p_count;
+    const int32_t  *p_value;
+    uint32_t        i_entries;
+    uint32_t        i_entry;
+    uint32_t        i_skip;
+    uint32_t        i_samples; /* samples left in the chunk */
+} mp4_chunk_runs_t;
+
+static void MP4_ChunkDtsRuns( const mp4_track_t *p_track,
+                              const mp4_chunk_t *p_chunk,
+                              mp4_chunk_runs_t *p_runs )
+{
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+
+    p_runs->p_count = stts ? stts->pi_sample_count : NULL;
+    p_runs->p_value = stts ? stts->pi_sample_delta : NULL;
+    p_runs->i_entries = stts ? stts->i_entry_count : 0;
+    p_runs->i_entry = p_chunk->i_dts_entry;
+    p_runs->i_skip = p_chunk->i_dts_skip;
+    p_runs->i_samples = p_chunk->i_sample_count;
 }
 
-static int MP4_ChunkAllocPtsEntries( mp4_chunk_t *ck )
+static void MP4_ChunkPtsRuns( const mp4_track_t *p_track,
+                              const mp4_chunk_t *p_chunk,
+                              mp4_chunk_runs_t *p_runs )
 {
-    size_t entries = ck->i_entries_pts;
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+
+    p_runs->p_count = ctts ? ctts->pi_sample_count : NULL;
+    p_runs->p_value = ctts ? ctts->pi_sample_offset : NULL;
+    p_runs->i_entries = ctts ? ctts->i_entry_count : 0;
+    p_runs->i_entry = p_chunk->i_pts_entry;
+    p_runs->i_skip = p_chunk->i_pts_skip;
+    p_runs->i_samples = p_chunk->i_sample_count;
+}
 
-    if( entries <= ARRAY_SIZE(ck->small_pts_buf) / 2 )
-    {
-        ck->p_sample_count_pts = ck->small_pts_buf;
-        ck->p_sample_offset_pts = ck->small_pts_buf + entries;
-        return 0;
-    }
+static bool MP4_ChunkNextRun( mp4_chunk_runs_t *p_runs,
+                              uint32_t *pi_count, int32_t *pi_value )
+{
+    if( p_runs->i_samples == 0 || p_runs->i_entry >= p_runs->i_entries )
+        return false;
 
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
+    uint32_t i_count = p_runs->p_count[p_runs->i_entry] - p_runs->i_skip;
+    if( i_count > p_runs->i_samples )
+        i_count = p_runs->i_samples;
 
-    ck->p_sample_count_pts = buf;
-    ck->p_sample_offset_pts = buf + entries;
-    return 0;
+    *pi_count = i_count;
+    *pi_value = p_runs->p_value[p_runs->i_entry];
+    p_runs->i_samples -= i_count;
+    p_runs->i_entry++;
+    p_runs->i_skip = 0;
+    return true;
 }
 
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
+static bool MP4_ChunkHasPts( const mp4_track_t *p_track,
+                             const mp4_chunk_t *p_chunk )
 {
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
+    return p_track->p_ctts && p_chunk->i_sample_count &&
+           p_chunk->i_pts_entry < p_track->p_ctts->i_entry_count;
 }
 
 static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
                                                     uint32_t i_sample )
 {
-    if( i_sample >= p_track->i_sample_count )
+    if( i_sample >= p_track->i_sample_count || p_track->i_chunk_count == 0 )
         return NULL;
-    for( uint32_t i=0; i<p_track->i_chunk_count; i++ )
+
+    /* last chunk starting at or before the sample */
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count;
+    while( i_high - i_low > 1 )
     {
-        if( i_sample >= p_track->chunk[i].i_sample_first &&
-            i_sample - p_track->chunk[i].i_sample_first < p_track->chunk[i].i_sample_count )
-            return &p_track->chunk[i];
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_track->chunk[i_mid].i_sample_first <= i_sample )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
     }
+
+    const mp4_chunk_t *ck = &p_track->chunk[i_low];
+    if( i_sample >= ck->i_sample_first &&
+        i_sample - ck->i_sample_first < ck->i_sample_count )
+        return ck;
     return NULL;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    mp4_chunk_runs_t runs;
+    uint32_t i_count;
+    int32_t i_delta;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+
+    MP4_ChunkDtsRuns( p_track, p_chunk, &runs );
+    while( i_sample > 0 && MP4_ChunkNextRun( &runs, &i_count, &i_delta ) )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * (uint32_t)i_delta;
+            i_sample -= i_count;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * (uint32_t)i_delta;
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    mp4_chunk_runs_t runs;
+    uint32_t i_count;
+    int32_t i_offset;
+
+    MP4_ChunkPtsRuns( p_track, p_chunk, &runs );
+    while( MP4_ChunkNextRun( &runs, &i_count, &i_offset ) )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        if( i_sample < i_count )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            int64_t i_ctsdelta = i_offset + p_track->i_cts_shift;
+            if( i_ctsdelta < 0 ) /* should not */
+                i_ctsdelta = 0;
+            *pi_delta = (uint32_t)i_ctsdelta;
+            return true;
         }
+        i_sample -= i_count;
     }
     return false;
 }
@@ -500,38 +577,32 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     stime_t i_duration = 0;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
+    mp4_chunk_runs_t runs;
+    uint32_t i_count;
+    int32_t i_delta;
+    uint32_t i_skip = p_track->i_sample - p_chunk->i_sample_first;
+
+    MP4_ChunkDtsRuns( p_track, p_chunk, &runs );
+    while( i_nb_samples > 0 && MP4_ChunkNextRun( &runs, &i_count, &i_delta ) )
     {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
+        /* Forward to the current sample */
+        if( i_skip >= i_count )
         {
-            i_remain = p_track->i_sample - i;
-            break;
+            i_skip -= i_count;
+            continue;
         }
-    }
+        i_count -= i_skip;
+        i_skip = 0;
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        /* Compute total duration from all samples from there */
+        if( i_nb_samples >= i_count )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
+            i_duration += (stime_t)i_count * (uint32_t)i_delta;
+            i_nb_samples -= i_count;
         }
         else
         {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
+            i_duration += (stime_t)i_nb_samples * (uint32_t)i_delta;
             break;
         }
     }
@@ -1246,6 +1317,9 @@ static int Open( vlc_object_t * p_this )
             msg_Warn( p_demux, "that media doesn't look properly interleaved, will need to seek");
     }
 
+    if( p_sys->b_fragmented && p_sys->b_seekable && !p_sys->b_fragments_probed )
+        FragIndexerStart( p_demux );
+
     /* */
     LoadChapter( p_demux );
 
@@ -1914,6 +1988,8 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
 
     uint64_t i_backup_pos = vlc_stream_Tell( p_demux->s );
 
+    FragIndexerAdopt( p_demux );
+
     if ( !p_sys->b_fragments_probed && !p_sys->b_index_probed && p_sys->b_seekable )
     {
         ProbeIndex( p_demux );
@@ -1944,9 +2020,23 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
         }
         else if( !p_sys->b_fragments_probed )
         {
-            int i_ret = ProbeFragmentsChecked( p_demux );
-            if( i_ret != VLC_SUCCESS )
+            stime_t i_basetime = MP4_rescale_qtime( i_sync_time, p_sys->i_timescale );
+            int i_ret = FragIndexerLookup( p_demux, &i_basetime, &i64, i_seek_track_index );
+            if( i_ret == VLC_SUCCESS )
+            {
+                i_sync_time = MP4_rescale_mtime( i_basetime, p_sys->i_timescale );
+                msg_Dbg( p_demux, "seeking to scanned fragment pos %" PRId64 " %" PRId64,
+                         i64, i_sync_time );
+            }
+            else if( i_ret != VLC_ENOENT )
                 return i_ret;
+            else
+            {
+                FragIndexerAdopt( p_demux );
+                i_ret = ProbeFragmentsChecked( p_demux );
+                if( i_ret != VLC_SUCCESS )
+                    return i_ret;
+            }
         }
 
         if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
@@ -2019,6 +2109,13 @@ static int FragSeekToPos( demux_t *p_demux, double f, bool b_accurate )
     uint64_t i_duration = __MAX(p_sys->i_duration, p_sys->i_cumulated_duration);
     if( !i_duration && !p_sys->b_fragments_probed )
     {
+        /* The duration is only known once the scan has ended */
+        stime_t i_end = INT64_MAX;
+        uint64_t i_pos;
+        if( FragIndexerLookup( p_demux, &i_end, &i_pos, 0 ) == VLC_EGENERIC )
+            return VLC_EGENERIC;
+        FragIndexerAdopt( p_demux );
+
         int i_ret = ProbeFragmentsChecked( p_demux );
         if( i_ret != VLC_SUCCESS )
             return i_ret;
@@ -2247,6 +2344,7 @@ static void Close ( vlc_object_t * p_this )
 
     msg_Dbg( p_demux, "freeing all memory" );
 
+    FragIndexerStop( p_demux );
     FragResetContext( p_sys );
 
     MP4_BoxFree( p_sys->p_root );
@@ -2445,14 +2543,7 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
-
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2514,54 +2605,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2601,16 +2644,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     {
         /* 2: each sample can have a different size */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2625,19 +2659,15 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
     /* Use stts table to create a sample number -> dts table.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     *  the box! so each chunk only records where its samples start in the
+     *  table, and the table is walked from there when needed */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
@@ -2648,93 +2678,40 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        p_demux_track->p_stts = stts;
+
+        /* Locate the first sample of each chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
+            ck->i_dts_entry = i_index;
+            ck->i_dts_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocDtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
+            while( i_sample_count > 0 && i_index < stts->i_entry_count )
             {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
+                uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+                int32_t i_delta = stts->pi_sample_delta[i_index];
+                if( i_count > i_sample_count )
+                {   /* keep building from same index */
+                    i_count = i_sample_count;
+                    i_skip += i_count;
                 }
                 else
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_skip = 0;
+                    i_index++;
                 }
-
+                i_next_dts += (int64_t)i_count * i_delta;
+                i_sample_count -= i_count;
             }
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
     }
 
@@ -2764,84 +2741,35 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
             }
         }
 
-        /* Create pts-dts table per chunk */
+        p_demux_track->p_ctts = ctts;
+        p_demux_track->i_cts_shift = i_cts_shift;
+
+        /* Locate the first sample of each chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocPtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->i_pts_entry = i_index;
+            ck->i_pts_skip = i_skip;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
+            while( i_sample_count > 0 && i_index < ctts->i_entry_count )
             {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
+                uint32_t i_count = ctts->pi_sample_count[i_index] - i_skip;
+                if( i_count > i_sample_count )
+                {   /* keep building from same index */
+                    i_skip += i_sample_count;
+                    i_sample_count = 0;
                 }
                 else
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_sample_count -= i_count;
+                    i_skip = 0;
+                    i_index++;
                 }
-
-
             }
         }
     }
@@ -3183,52 +3111,45 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale_qtime( start, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
     /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
-    {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+    /* last chunk starting at or before i_start, the check of the end is
+       done while searching i_sample */
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count;
+    while( i_high - i_low > 1 )
+    {
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( (uint64_t)i_start >= p_track->chunk[i_mid].i_first_dts )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
     }
+    i_chunk = i_low;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    mp4_chunk_runs_t runs;
+    uint32_t i_count;
+    int32_t i_delta;
+
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
+    MP4_ChunkDtsRuns( p_track, ck, &runs );
+    while( i_sample < ck->i_sample_count &&
+           MP4_ChunkNextRun( &runs, &i_count, &i_delta ) )
     {
-        if( i_dts +
-            (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+        if( i_dts + (uint64_t)i_count * (uint32_t)i_delta < (uint64_t)i_start )
         {
-            i_dts    +=
-                (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            i_dts    += (uint64_t)i_count * (uint32_t)i_delta;
+            i_sample += i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+            if( i_delta == 0 )
             {
                 break;
             }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += ( i_start - i_dts ) / (uint32_t)i_delta;
             break;
         }
     }
@@ -3379,7 +3300,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
     /* Probe the 16 first B frames */
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( MP4_ChunkHasPts( p_track, p_chunk ) )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3388,9 +3309,11 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             if(!ck)
                 break;
             stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck,
+                                                      i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck,
+                                            i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3408,9 +3331,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
 {
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3698,16 +3621,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4363,6 +4278,47 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
+/* Sets the movie time of each track at the start of a fragment, and
+ * advances the tracks times to the end of it */
+static void FragIndexMoof( demux_sys_t *p_sys, MP4_Box_t *p_moof, bool b_first,
+                           stime_t *pi_track_times, stime_t *p_times )
+{
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        MP4_Box_t *p_tfdt = NULL;
+        MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+        if( p_traf )
+            p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+
+        if( p_tfdt && BOXDATA(p_tfdt) )
+        {
+            pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
+        }
+        else if( b_first ) /* Set first fragment time offset from moov */
+        {
+            stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+            pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
+        }
+
+        p_times[i] = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+
+        stime_t i_duration = 0;
+        if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+            pi_track_times[i] += i_duration;
+    }
+}
+
+static void FragIndexUpdateLastTime( demux_sys_t *p_sys, mp4_fragments_index_t *p_index,
+                                     const stime_t *pi_track_times )
+{
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+        if( p_index->i_last_time < i_movietime )
+            p_index->i_last_time = i_movietime;
+    }
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4407,40 +4363,12 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 if( p_moof->i_type != ATOM_moof )
                     continue;
 
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
-
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
-
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
-
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
-
+                FragIndexMoof( p_sys, p_moof, index == 0, pi_track_times,
+                               &p_sys->p_fragsindex->p_times[index * p_sys->i_tracks] );
                 p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
             }
 
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
-            {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
-            }
+            FragIndexUpdateLastTime( p_sys, p_sys->p_fragsindex, pi_track_times );
 
             free( pi_track_times );
 #ifdef MP4_VERBOSE
@@ -4513,6 +4441,346 @@ static int ProbeFragmentsChecked( demux_t *p_demux )
     return i_ret;
 }
 
+/*****************************************************************************
+ * Background fragments index
+ *****************************************************************************
+ * Without a global sidx nor mfra, seeking needs the position and time of
+ * every moof. Those are read by a thread through a stream of its own while
+ * playback goes on, and seeks use the part of the index already built. The
+ * complete index can be kept in the cache directory, keyed by the file.
+ *****************************************************************************/
+static char * FragIndexerCachePath( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_path;
+
+    if( !psz_cachedir )
+        return NULL;
+
+    for( size_t i = 0; i < MP4_FRAGMENTS_INDEX_KEY_SIZE; i++ )
+        snprintf( &psz_hash[2 * i], 3, "%02x", p_sys->indexer.key[i] );
+
+    if( vlc_mkdir( psz_cachedir, 0700 ) && errno != EEXIST )
+        psz_path = NULL;
+    else if( asprintf( &psz_path, "%s" DIR_SEP "mp4index", psz_cachedir ) == -1 )
+        psz_path = NULL;
+    else if( vlc_mkdir( psz_path, 0700 ) && errno != EEXIST )
+    {
+        free( psz_path );
+        psz_path = NULL;
+    }
+    else
+    {
+        char *psz_dir = psz_path;
+        if( asprintf( &psz_path, "%s" DIR_SEP "%s", psz_dir, psz_hash ) == -1 )
+            psz_path = NULL;
+        free( psz_dir );
+    }
+
+    free( psz_cachedir );
+    return psz_path;
+}
+
+/* Identifies a file by its location, its size and its movie header */
+static void FragIndexerComputeKey( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const MP4_Box_t *p_mvhd = MP4_BoxGet( p_sys->p_moov, "mvhd" );
+    uint8_t buf[8];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, p_demux->psz_url, strlen( p_demux->psz_url ) );
+    SetQWBE( buf, stream_Size( p_demux->s ) );
+    vlc_hash_md5_Update( &md5, buf, 8 );
+    SetQWBE( buf, p_sys->p_moov->i_pos );
+    vlc_hash_md5_Update( &md5, buf, 8 );
+    SetQWBE( buf, p_sys->p_moov->i_size );
+    vlc_hash_md5_Update( &md5, buf, 8 );
+    if( p_mvhd && BOXDATA(p_mvhd) )
+    {
+        SetQWBE( buf, BOXDATA(p_mvhd)->i_modification_time );
+        vlc_hash_md5_Update( &md5, buf, 8 );
+        SetQWBE( buf, BOXDATA(p_mvhd)->i_duration );
+        vlc_hash_md5_Update( &md5, buf, 8 );
+    }
+    vlc_hash_md5_Finish( &md5, p_sys->indexer.key, sizeof(p_sys->indexer.key) );
+}
+
+static void FragIndexerSave( demux_t *p_demux, const mp4_fragments_index_t *p_index )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    char *psz_tmp;
+
+    if( asprintf( &psz_tmp, "%s.part", p_sys->indexer.psz_cache ) == -1 )
+        return;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( p_file )
+    {
+        int i_ret = MP4_Fragments_Index_Save( p_index, p_file, p_sys->indexer.key );
+        if( fclose( p_file ) )
+            i_ret = VLC_EGENERIC;
+        if( i_ret == VLC_SUCCESS &&
+            vlc_rename( psz_tmp, p_sys->indexer.psz_cache ) == 0 )
+            msg_Dbg( p_demux, "saved fragments index to %s", p_sys->indexer.psz_cache );
+        else
+            vlc_unlink( psz_tmp );
+    }
+    free( psz_tmp );
+}
+
+static void *FragIndexerThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    mp4_fragments_index_t *p_index = NULL;
+    bool b_complete = false;
+
+    vlc_interrupt_set( p_sys->indexer.p_interrupt );
+
+    if( p_sys->indexer.psz_cache )
+    {
+        FILE *p_file = vlc_fopen( p_sys->indexer.psz_cache, "rb" );
+        if( p_file )
+        {
+            p_index = MP4_Fragments_Index_Load( p_file, p_sys->i_tracks,
+                                                p_sys->indexer.key );
+            fclose( p_file );
+        }
+        if( p_index )
+        {
+            msg_Dbg( p_demux, "loaded %u fragments index entries from %s",
+                     p_index->i_entries, p_sys->indexer.psz_cache );
+            vlc_mutex_lock( &p_sys->indexer.lock );
+            p_sys->indexer.p_index = p_index;
+            p_sys->indexer.b_complete = true;
+            p_sys->indexer.b_done = true;
+            vlc_cond_broadcast( &p_sys->indexer.wait );
+            vlc_mutex_unlock( &p_sys->indexer.lock );
+            return NULL;
+        }
+    }
+
+    p_index = MP4_Fragments_Index_New( p_sys->i_tracks, 0 );
+    stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+    stime_t *p_times = calloc( p_sys->i_tracks, sizeof(*p_times) );
+    stream_t *s = NULL;
+
+    if( p_index && pi_track_times && p_times )
+    {
+        vlc_mutex_lock( &p_sys->indexer.lock );
+        p_sys->indexer.p_index = p_index;
+        vlc_mutex_unlock( &p_sys->indexer.lock );
+
+        s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    }
+
+    if( s && vlc_stream_Seek( s, p_sys->p_moov->i_pos + p_sys->p_moov->i_size ) == VLC_SUCCESS )
+    {
+        const uint64_t i_size = stream_Size( s );
+        vlc_tick_t i_start = vlc_tick_now();
+
+        /* Only the moof boxes are read, the mdat ones are skipped */
+        while( !vlc_killed() )
+        {
+            MP4_Box_t *p_chunk = MP4_BoxGetNextChunk( s );
+            if( !p_chunk )
+            {
+                b_complete = !vlc_killed() &&
+                             ( i_size == 0 || vlc_stream_Tell( s ) >= i_size );
+                break;
+            }
+
+            for( MP4_Box_t *p_moof = p_chunk->p_first; p_moof; p_moof = p_moof->p_next )
+            {
+                if( p_moof->i_type != ATOM_moof )
+                    continue;
+
+                FragIndexMoof( p_sys, p_moof, p_index->i_entries == 0,
+                               pi_track_times, p_times );
+
+                vlc_mutex_lock( &p_sys->indexer.lock );
+                if( MP4_Fragments_Index_Append( p_index, p_moof->i_pos, p_times ) == VLC_SUCCESS )
+                    FragIndexUpdateLastTime( p_sys, p_index, pi_track_times );
+                vlc_cond_broadcast( &p_sys->indexer.wait );
+                vlc_mutex_unlock( &p_sys->indexer.lock );
+            }
+
+            MP4_BoxFree( p_chunk );
+        }
+
+        msg_Dbg( p_demux, "%s fragments scan: %u entries in %"PRId64" ms",
+                 b_complete ? "completed" : "aborted", p_index->i_entries,
+                 MS_FROM_VLC_TICK( vlc_tick_now() - i_start ) );
+    }
+
+    if( s )
+        vlc_stream_Delete( s );
+    free( pi_track_times );
+    free( p_times );
+
+    if( b_complete && p_index->i_entries && p_sys->indexer.psz_cache )
+        FragIndexerSave( p_demux, p_index );
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    if( !p_sys->indexer.p_index )
+        MP4_Fragments_Index_Delete( p_index );
+    p_sys->indexer.b_complete = b_complete;
+    p_sys->indexer.b_done = true;
+    vlc_cond_broadcast( &p_sys->indexer.wait );
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+    return NULL;
+}
+
+static void FragIndexerStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_demux->psz_url || !p_sys->p_moov || !p_sys->i_tracks ||
+        !var_InheritBool( p_demux, CFG_PREFIX"index-scan" ) )
+        return;
+
+    FragIndexerComputeKey( p_demux );
+    if( var_InheritBool( p_demux, CFG_PREFIX"index-cache" ) )
+        p_sys->indexer.psz_cache = FragIndexerCachePath( p_demux );
+
+    p_sys->indexer.p_interrupt = vlc_interrupt_create();
+    if( unlikely(!p_sys->indexer.p_interrupt) )
+        goto error;
+
+    vlc_mutex_init( &p_sys->indexer.lock );
+    vlc_cond_init( &p_sys->indexer.wait );
+    p_sys->indexer.p_index = NULL;
+    p_sys->indexer.b_done = false;
+    p_sys->indexer.b_complete = false;
+
+    if( vlc_clone( &p_sys->indexer.thread, FragIndexerThread, p_demux,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_interrupt_destroy( p_sys->indexer.p_interrupt );
+        goto error;
+    }
+    p_sys->indexer.b_started = true;
+    return;
+
+error:
+    free( p_sys->indexer.psz_cache );
+    p_sys->indexer.psz_cache = NULL;
+}
+
+static void FragIndexerJoin( demux_sys_t *p_sys )
+{
+    vlc_join( p_sys->indexer.thread, NULL );
+    vlc_interrupt_destroy( p_sys->indexer.p_interrupt );
+    free( p_sys->indexer.psz_cache );
+    p_sys->indexer.psz_cache = NULL;
+    p_sys->indexer.b_started = false;
+}
+
+static void FragIndexerStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->indexer.b_started )
+        return;
+
+    vlc_interrupt_kill( p_sys->indexer.p_interrupt );
+    FragIndexerJoin( p_sys );
+    MP4_Fragments_Index_Delete( p_sys->indexer.p_index );
+    p_sys->indexer.p_index = NULL;
+}
+
+/* Takes over the index once the scan is over */
+static void FragIndexerAdopt( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->indexer.b_started )
+        return;
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    bool b_done = p_sys->indexer.b_done;
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+    if( !b_done )
+        return;
+
+    FragIndexerJoin( p_sys );
+
+    mp4_fragments_index_t *p_index = p_sys->indexer.p_index;
+    p_sys->indexer.p_index = NULL;
+
+    if( p_sys->indexer.b_complete && p_index && p_index->i_entries &&
+        !p_sys->b_fragments_probed )
+    {
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = p_index;
+        p_sys->b_fragments_probed = true;
+#ifdef MP4_VERBOSE
+        MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+#endif
+        MP4_Box_t *p_mehd = MP4_BoxGet( p_sys->p_moov, "mvex/mehd");
+        if ( !p_mehd )
+            p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+    }
+    else
+        MP4_Fragments_Index_Delete( p_index );
+}
+
+static void FragIndexerWakeUp( void *data )
+{
+    demux_sys_t *p_sys = data;
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    p_sys->indexer.b_interrupted = true;
+    vlc_cond_broadcast( &p_sys->indexer.wait );
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+}
+
+/* Waits for the scan to reach the given time (movie scaled).
+ * Returns VLC_ENOENT if there is no scan, or if it ended before. */
+static int FragIndexerLookup( demux_t *p_demux, stime_t *pi_time, uint64_t *pi_pos,
+                              unsigned i_track_index )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    int i_ret = VLC_ENOENT;
+
+    if( !p_sys->indexer.b_started )
+        return i_ret;
+
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    p_sys->indexer.b_interrupted = false;
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+
+    /* A pending interruption invokes the callback right away */
+    vlc_interrupt_register( FragIndexerWakeUp, p_sys );
+    vlc_mutex_lock( &p_sys->indexer.lock );
+    for( ;; )
+    {
+        mp4_fragments_index_t *p_index = p_sys->indexer.p_index;
+        if( p_index && *pi_time < p_index->i_last_time )
+        {
+            if( MP4_Fragments_Index_Lookup( p_index, pi_time, pi_pos, i_track_index ) )
+                i_ret = VLC_SUCCESS;
+            break;
+        }
+        if( p_sys->indexer.b_done )
+            break;
+        if( p_sys->indexer.b_interrupted )
+        {
+            i_ret = VLC_EGENERIC;
+            break;
+        }
+        vlc_cond_wait( &p_sys->indexer.wait, &p_sys->indexer.lock );
+    }
+    vlc_mutex_unlock( &p_sys->indexer.lock );
+    vlc_interrupt_unregister();
+
+    return i_ret;
+}
+
 static void FragResetContext( demux_sys_t *p_sys )
 {
     if( p_sys->context.p_fragment_atom )
@@ -4973,6 +5241,80 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
     return VLC_SUCCESS;
 }
 
+/* Reads the sidx box referenced by a parent one */
+static MP4_Box_t * FragReadSidxAt( demux_t *p_demux, uint64_t i_pos )
+{
+    const uint8_t *p_peek;
+    const uint32_t stoplist[] = { ATOM_sidx, 0 };
+    uint64_t i_backup_pos = vlc_stream_Tell( p_demux->s );
+    MP4_Box_t *p_vroot = NULL;
+
+    if( vlc_stream_Seek( p_demux->s, i_pos ) == VLC_SUCCESS &&
+        vlc_stream_Peek( p_demux->s, &p_peek, 8 ) == 8 &&
+        VLC_FOURCC(p_peek[4], p_peek[5], p_peek[6], p_peek[7]) == ATOM_sidx &&
+        (p_vroot = MP4_BoxNew( ATOM_root )) )
+    {
+        MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, stoplist );
+    }
+
+    if( vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS )
+    {
+        demux_sys_t *p_sys = p_demux->p_sys;
+        p_sys->b_error = true;
+    }
+    return p_vroot;
+}
+
+#define FRAG_SIDX_MAX_DEPTH 4
+
+static int FragGetMoofBySidx( demux_t *p_demux, const MP4_Box_t *p_sidx,
+                              vlc_tick_t target_time, vlc_tick_t i_start, unsigned i_depth,
+                              uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+{
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+    if( !p_data || !p_data->i_timescale )
+        return VLC_EGENERIC;
+
+    stime_t i_target_time = MP4_rescale_qtime( target_time - i_start, p_data->i_timescale );
+
+    /* sidx refers to offsets from end of sidx pos in the file + first offset */
+    uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
+    stime_t i_time = 0;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        if( i_time + p_data->p_items[i].i_subsegment_duration > i_target_time )
+        {
+            const vlc_tick_t i_item_start = i_start + MP4_rescale_mtime( i_time, p_data->i_timescale );
+
+            if( p_data->p_items[i].b_reference_type == 0 )
+            {
+                *pi_sampletime = i_item_start;
+                *pi_moof_pos = i_pos;
+                return VLC_SUCCESS;
+            }
+
+            /* hierarchical index: the item is another sidx */
+            if( i_depth >= FRAG_SIDX_MAX_DEPTH )
+                return VLC_EGENERIC;
+
+            MP4_Box_t *p_vroot = FragReadSidxAt( p_demux, i_pos );
+            if( !p_vroot )
+                return VLC_EGENERIC;
+
+            int i_ret = VLC_EGENERIC;
+            const MP4_Box_t *p_child = MP4_BoxGet( p_vroot, "sidx" );
+            if( p_child )
+                i_ret = FragGetMoofBySidx( p_demux, p_child, target_time, i_item_start,
+                                           i_depth + 1, pi_moof_pos, pi_sampletime );
+            MP4_BoxFree( p_vroot );
+            return i_ret;
+        }
+        i_pos += p_data->p_items[i].i_referenced_size;
+        i_time += p_data->p_items[i].i_subsegment_duration;
+    }
+    return VLC_EGENERIC;
+}
+
 static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
                                    uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
 {
@@ -4983,28 +5325,12 @@ static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
         if( p_sidx->i_type != ATOM_sidx )
             continue;
 
-        const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
-        if( !p_data || !p_data->i_timescale )
+        if( !BOXDATA(p_sidx) || !BOXDATA(p_sidx)->i_timescale )
             break;
 
-        stime_t i_target_time = MP4_rescale_qtime( target_time, p_data->i_timescale );
-
-        /* sidx refers to offsets from end of sidx pos in the file + first offset */
-        uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
-        stime_t i_time = 0;
-        for( uint16_t i=0; i<p_data->i_reference_count; i++ )
-        {
-            if(p_data->p_items[i].b_reference_type != 0)
-                continue;
-            if( i_time + p_data->p_items[i].i_subsegment_duration > i_target_time )
-            {
-                *pi_sampletime = MP4_rescale_mtime( i_time, p_data->i_timescale );
-                *pi_moof_pos = i_pos;
-                return VLC_SUCCESS;
-            }
-            i_pos += p_data->p_items[i].i_referenced_size;
-            i_time += p_data->p_items[i].i_subsegment_duration;
-        }
+        if( FragGetMoofBySidx( p_demux, p_sidx, target_time, 0, 0,
+                               pi_moof_pos, pi_sampletime ) == VLC_SUCCESS )
+            return VLC_SUCCESS;
     }
     return VLC_EGENERIC;
 }
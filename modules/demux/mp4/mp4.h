@@ -46,18 +46,13 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-    uint32_t     small_dts_buf[4];
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-    uint32_t     small_pts_buf[4];
-
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    /* position of the first sample in the stts and ctts tables: entry,
+       and count of samples of that entry in the previous chunks. The
+       tables are then walked on demand for the samples of the chunk. */
+    uint32_t     i_dts_entry;
+    uint32_t     i_dts_skip;
+    uint32_t     i_pts_entry;
+    uint32_t     i_pts_skip;
 
 } mp4_chunk_t;
 
@@ -146,8 +141,12 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* from the stsz box */
+
+    /* decoding and composition times tables (p_ctts could be NULL) */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts;
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
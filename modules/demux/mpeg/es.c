@@ -128,6 +128,15 @@ typedef struct
     seekpoint_t *p_seekpoint;
 } chap_entry_t;
 
+typedef struct
+{
+    vlc_tick_t i_time;
+    uint64_t i_pos;
+} seek_entry_t;
+
+/* minimal time between two seek index entries */
+#define SEEK_INDEX_SPACING VLC_TICK_FROM_SEC(1)
+
 typedef struct
 {
     codec_t codec;
@@ -177,6 +186,16 @@ typedef struct
         size_t i_current;
         chap_entry_t *p_entry;
     } chapters;
+
+    /* seek index, filled while playing as long as the timestamps are not
+     * estimated from the bitrate */
+    struct
+    {
+        size_t i_count;
+        seek_entry_t *p_entry;
+        vlc_tick_t i_time; /* time at the current read position */
+        bool b_exact;
+    } index;
 } demux_sys_t;
 
 static int MpgaProbe( demux_t *p_demux, uint64_t *pi_offset );
@@ -240,6 +259,9 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->p_packetized_data = NULL;
     p_sys->chapters.i_current = 0;
     TAB_INIT(p_sys->chapters.i_count, p_sys->chapters.p_entry);
+    TAB_INIT(p_sys->index.i_count, p_sys->index.p_entry);
+    p_sys->index.i_time = 0;
+    p_sys->index.b_exact = true;
 
     if( vlc_stream_Seek( p_demux->s, p_sys->i_stream_offset ) )
     {
@@ -390,6 +412,11 @@ static int Demux( demux_t *p_demux )
             p_block_out->i_dts += p_sys->i_time_offset;
             es_out_SetPCR( p_demux->out, p_block_out->i_dts );
         }
+        /* Time at which the data following this block starts */
+        if( p_block_out->i_pts != VLC_TICK_INVALID )
+            p_sys->index.i_time = p_block_out->i_pts - VLC_TICK_0
+                                + p_block_out->i_length;
+
         /* Re-estimate bitrate */
         if( p_sys->b_estimate_bitrate && p_sys->i_pts > VLC_TICK_FROM_MS(500) )
             p_sys->i_bitrate_avg = 8 * CLOCK_FREQ * p_sys->i_bytes
@@ -418,12 +445,62 @@ static void Close( vlc_object_t * p_this )
     for( size_t i=0; i< p_sys->chapters.i_count; i++ )
         vlc_seekpoint_Delete( p_sys->chapters.p_entry[i].p_seekpoint );
     TAB_CLEAN( p_sys->chapters.i_count, p_sys->chapters.p_entry );
+    TAB_CLEAN( p_sys->index.i_count, p_sys->index.p_entry );
     if( p_sys->mllt.p_bits )
         free( p_sys->mllt.p_bits );
     demux_PacketizerDestroy( p_sys->p_packetizer );
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Seek index:
+ *****************************************************************************/
+/* Returns the number of entries at or before i_time */
+static size_t SeekIndexLookup( const demux_sys_t *p_sys, vlc_tick_t i_time )
+{
+    size_t i_lo = 0, i_hi = p_sys->index.i_count;
+
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = (i_lo + i_hi) / 2;
+        if( p_sys->index.p_entry[i_mid].i_time <= i_time )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+    return i_lo;
+}
+
+static void SeekIndexAdd( demux_sys_t *p_sys, vlc_tick_t i_time, uint64_t i_pos )
+{
+    const seek_entry_t *p_entry = p_sys->index.p_entry;
+    size_t i = SeekIndexLookup( p_sys, i_time );
+
+    if( i > 0 && i_time - p_entry[i - 1].i_time < SEEK_INDEX_SPACING )
+        return;
+    if( i < p_sys->index.i_count &&
+        p_entry[i].i_time - i_time < SEEK_INDEX_SPACING )
+        return;
+
+    seek_entry_t entry = { .i_time = i_time, .i_pos = i_pos };
+    TAB_INSERT( p_sys->index.i_count, p_sys->index.p_entry, entry, i );
+}
+
+/* Returns the entry to start from to reach i_time, if the index covers it */
+static const seek_entry_t *SeekIndexFind( const demux_sys_t *p_sys,
+                                          vlc_tick_t i_time )
+{
+    size_t i = SeekIndexLookup( p_sys, i_time );
+
+    /* The played ranges are indexed without holes */
+    if( i == 0 || i == p_sys->index.i_count )
+        return NULL;
+    const seek_entry_t *p_prev = &p_sys->index.p_entry[i - 1];
+    if( p_prev[1].i_time - p_prev->i_time > 2 * SEEK_INDEX_SPACING )
+        return NULL;
+    return p_prev;
+}
+
 /*****************************************************************************
  * Time seek:
  *****************************************************************************/
@@ -500,6 +577,34 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 uint64_t i_pos = SeekByMlltTable( p_demux, &i_time );
                 return MovetoTimePos( p_demux, i_time, i_pos );
             }
+            else
+            {
+                va_list ap;
+
+                va_copy( ap, args );
+                vlc_tick_t i_time = va_arg( ap, vlc_tick_t );
+                bool b_precise = va_arg( ap, int );
+                va_end( ap );
+
+                const seek_entry_t *p_entry = SeekIndexFind( p_sys, i_time );
+                if( p_entry )
+                {
+                    vlc_tick_t i_entry_time = p_entry->i_time;
+                    /* packetizer time of the next frame */
+                    vlc_tick_t i_next = p_sys->index.i_time - p_sys->i_time_offset;
+                    int i_ret = MovetoTimePos( p_demux, i_entry_time,
+                                               p_entry->i_pos );
+                    if( i_ret != VLC_SUCCESS )
+                        return i_ret;
+                    p_sys->i_time_offset = i_entry_time - i_next;
+                    p_sys->index.i_time = i_entry_time;
+                    if( b_precise )
+                        es_out_Control( p_demux->out,
+                                        ES_OUT_SET_NEXT_DISPLAY_TIME,
+                                        VLC_TICK_0 + i_time );
+                    return VLC_SUCCESS;
+                }
+            }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
@@ -563,7 +668,10 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 return demux_Control( p_demux, DEMUX_SET_TIME, p->p_seekpoint->i_time_offset );
             int i_ret= MovetoTimePos( p_demux, p->p_seekpoint->i_time_offset, p->i_offset );
             if( i_ret == VLC_SUCCESS )
+            {
                 p_sys->chapters.i_current = i;
+                p_sys->index.b_exact = false;
+            }
             return i_ret;
         }
 
@@ -601,6 +709,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         /* Reset chapter if any */
         p_sys->chapters.i_current = 0;
         p_sys->i_demux_flags |= INPUT_UPDATE_SEEKPOINT;
+        /* The timestamps are now estimated: stop indexing */
+        p_sys->index.b_exact = false;
     }
 
     return VLC_SUCCESS;
@@ -625,6 +735,11 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
             return true;
     }
 
+    /* Index where the next frames start */
+    if( p_sys->index.b_exact && p_sys->p_packetizer->fmt_in.i_cat == AUDIO_ES )
+        SeekIndexAdd( p_sys, p_sys->index.i_time,
+                      vlc_stream_Tell( p_demux->s ) - p_sys->i_stream_offset );
+
     p_block_in = vlc_stream_Block( p_demux->s, p_sys->i_packet_size );
     bool b_eof = p_block_in == NULL;
 
@@ -34,6 +34,7 @@
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_executor.h>
 
 #include "ts_pid.h"
 #include "ts_streams.h"
@@ -123,6 +124,16 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define THREADS_TEXT N_("PES parsing threads")
+#define THREADS_LONGTEXT N_("Number of threads used to parse PES packets " \
+    "in parallel (0 to parse them on the demux thread). This can help " \
+    "demuxing high bitrate multi-program streams.")
+
+#define SHARED_THREADS_TEXT N_("Share the PES parsing threads")
+#define SHARED_THREADS_LONGTEXT N_("Parse the PES of all the TS inputs of " \
+    "the process with a single pool of threads, instead of creating them " \
+    "per input. This is useful to stream many channels at once.")
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -164,6 +175,10 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_integer_with_range( "ts-threads", 0, 0, 32,
+                            THREADS_TEXT, THREADS_LONGTEXT )
+    add_bool( "ts-threads-shared", false, SHARED_THREADS_TEXT,
+              SHARED_THREADS_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -193,6 +208,8 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
+static vlc_executor_t *SharedExecutorHold( unsigned );
+static void SharedExecutorRelease( void );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
@@ -426,6 +443,28 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_access_control = ( VLC_SUCCESS == SetPIDFilter( p_sys, patpid, true ) );
 
+    p_sys->packet_pool = block_pool_New();
+
+    p_sys->pes_jobs.p_first = NULL;
+    p_sys->pes_jobs.pp_last = &p_sys->pes_jobs.p_first;
+    p_sys->pes_jobs.b_defer = false;
+    p_sys->pes_jobs.b_shared = false;
+    unsigned i_threads = var_InheritInteger( p_demux, "ts-threads" );
+    if( i_threads > 0 )
+    {
+        p_sys->pes_jobs.b_shared = var_InheritBool( p_demux, "ts-threads-shared" );
+        if( p_sys->pes_jobs.b_shared )
+            p_sys->pes_jobs.executor = SharedExecutorHold( i_threads );
+        else
+            p_sys->pes_jobs.executor = vlc_executor_New( i_threads );
+        if( p_sys->pes_jobs.executor )
+        {
+            /* A PES spans many packets, parse more of them per call */
+            p_sys->i_ts_read = 1000;
+            msg_Dbg( p_demux, "parsing PES with %u threads", i_threads );
+        }
+    }
+
     p_sys->i_pmt_es = 0;
     p_sys->seltype = PROGRAM_AUTO_DEFAULT;
 
@@ -562,6 +601,7 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    FlushPESJobs( p_demux, NULL );
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -592,6 +632,24 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    if( p_sys->packet_pool )
+    {
+        struct block_pool_stats stats;
+
+        block_pool_GetStats( p_sys->packet_pool, &stats );
+        msg_Dbg( p_demux, "packet pool: %"PRIu64" hits, %"PRIu64" misses",
+                 stats.hits, stats.misses );
+        block_pool_Release( p_sys->packet_pool );
+    }
+
+    if( p_sys->pes_jobs.executor )
+    {
+        if( p_sys->pes_jobs.b_shared )
+            SharedExecutorRelease();
+        else
+            vlc_executor_Delete( p_sys->pes_jobs.executor );
+    }
+
     free( p_sys );
 }
 
@@ -634,6 +692,11 @@ static int Demux( demux_t *p_demux )
         p_sys->patfix.status = PAT_FIXTRIED;
     }
 
+    /* Completed PES are parsed by the workers and output before returning */
+    p_sys->pes_jobs.b_defer = p_sys->pes_jobs.executor != NULL;
+
+    int i_ret = VLC_DEMUXER_SUCCESS;
+
     /* We read at most 100 TS packet or until a frame is completed */
     for( unsigned i_pkt = 0; i_pkt < p_sys->i_ts_read; i_pkt++ )
     {
@@ -642,7 +705,8 @@ static int Demux( demux_t *p_demux )
         block_t     *p_pkt;
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
-            return VLC_DEMUXER_EOF;
+            i_ret = VLC_DEMUXER_EOF;
+            break;
         }
 
         if( p_sys->b_start_record )
@@ -719,6 +783,7 @@ static int Demux( demux_t *p_demux )
             if( p_sys->es_creation == DELAY_ES ) /* No longer delay ES since that pid's program sends data */
             {
                 msg_Dbg( p_demux, "Creating delayed ES" );
+                FlushPESJobs( p_demux, NULL );
                 AddAndCreateES( p_demux, p_pid, true );
                 UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
             }
@@ -765,10 +830,18 @@ static int Demux( demux_t *p_demux )
             break;
         }
 
-        if( b_frame || ( b_wait_es && p_sys->i_pmt_es > 0 ) )
+        /* With worker threads, keep on reading so that they have work */
+        if( ( b_frame && !p_sys->pes_jobs.b_defer ) ||
+            ( b_wait_es && p_sys->i_pmt_es > 0 ) )
             break;
     }
 
+    FlushPESJobs( p_demux, NULL );
+    p_sys->pes_jobs.b_defer = false;
+
+    if( i_ret != VLC_DEMUXER_SUCCESS )
+        return i_ret;
+
     demux_UpdateTitleFromStream( p_demux );
     return VLC_DEMUXER_SUCCESS;
 }
@@ -1530,36 +1603,40 @@ static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
 /****************************************************************************
  * gathering stuff
  ****************************************************************************/
-static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
-                               stime_t i_append_pcr )
+typedef struct
+{
+    unsigned i_skip;
+    stime_t  i_dts;
+    stime_t  i_pts;
+    uint8_t  i_stream_id;
+} ts_pes_header_t;
+
+/* Parses the PES header and gathers the data chain. It does not depend on
+ * the demux state, and can then be run from any thread. */
+static block_t * PreparsePESDataChain( vlc_object_t *p_obj, uint16_t i_pid,
+                                       block_t *p_pes, ts_pes_header_t *p_hdr )
 {
     uint8_t header[34];
-    unsigned i_pes_size = 0;
-    unsigned i_skip = 0;
-    stime_t i_dts = -1;
-    stime_t i_pts = -1;
-    vlc_tick_t i_length = 0;
-    uint8_t i_stream_id;
     bool b_pes_scrambling = false;
-    const es_mpeg4_descriptor_t *p_mpeg4desc = NULL;
-    demux_sys_t *p_sys = p_demux->p_sys;
 
-    assert(pid->type == TYPE_STREAM);
+    p_hdr->i_skip = 0;
+    p_hdr->i_dts = -1;
+    p_hdr->i_pts = -1;
 
     const int i_max = block_ChainExtract( p_pes, header, 34 );
     if ( i_max < 4 )
     {
         block_ChainRelease( p_pes );
-        return;
+        return NULL;
     }
 
     if( header[0] != 0 || header[1] != 0 || header[2] != 1 )
     {
         if ( !(p_pes->i_flags & BLOCK_FLAG_SCRAMBLED) )
-            msg_Warn( p_demux, "invalid header [0x%02x:%02x:%02x:%02x] (pid: %d)",
-                        header[0], header[1],header[2],header[3], pid->i_pid );
+            msg_Warn( p_obj, "invalid header [0x%02x:%02x:%02x:%02x] (pid: %d)",
+                        header[0], header[1],header[2],header[3], i_pid );
         block_ChainRelease( p_pes );
-        return;
+        return NULL;
     }
     else
     {
@@ -1567,24 +1644,42 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
         p_pes->i_flags &= ~BLOCK_FLAG_SCRAMBLED;
     }
 
-    ts_es_t *p_es = pid->u.p_stream->p_es;
-
-    if( ParsePESHeader( VLC_OBJECT(p_demux), (uint8_t*)&header, i_max, &i_skip,
-                        &i_dts, &i_pts, &i_stream_id, &b_pes_scrambling ) == VLC_EGENERIC )
+    if( ParsePESHeader( p_obj, (uint8_t*)&header, i_max, &p_hdr->i_skip,
+                        &p_hdr->i_dts, &p_hdr->i_pts, &p_hdr->i_stream_id,
+                        &b_pes_scrambling ) == VLC_EGENERIC )
     {
         block_ChainRelease( p_pes );
-        return;
-    }
-    else
-    {
-        if( i_pts != -1 && p_es->p_program )
-            i_pts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_pts );
-        if( i_dts != -1 && p_es->p_program )
-            i_dts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_dts );
-        if( b_pes_scrambling )
-            p_pes->i_flags |= BLOCK_FLAG_SCRAMBLED;
+        return NULL;
     }
 
+    if( b_pes_scrambling )
+        p_pes->i_flags |= BLOCK_FLAG_SCRAMBLED;
+
+    /* May be NULL on allocation failure */
+    return block_ChainGather( p_pes );
+}
+
+static void OutputPESData( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
+                           const ts_pes_header_t *p_hdr, stime_t i_append_pcr )
+{
+    unsigned i_pes_size = 0;
+    unsigned i_skip = p_hdr->i_skip;
+    stime_t i_dts = p_hdr->i_dts;
+    stime_t i_pts = p_hdr->i_pts;
+    vlc_tick_t i_length = 0;
+    const uint8_t i_stream_id = p_hdr->i_stream_id;
+    const es_mpeg4_descriptor_t *p_mpeg4desc = NULL;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    assert(pid->type == TYPE_STREAM);
+
+    ts_es_t *p_es = pid->u.p_stream->p_es;
+
+    if( i_pts != -1 && p_es->p_program )
+        i_pts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_pts );
+    if( i_dts != -1 && p_es->p_program )
+        i_dts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_dts );
+
     if( p_es->i_sl_es_id )
         p_mpeg4desc = GetMPEG4DescByEsId( p_es->p_program, p_es->i_sl_es_id );
 
@@ -1620,22 +1715,15 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
     }
 
     /* skip header */
-    while( p_pes && i_skip > 0 )
+    if( p_pes->i_buffer <= i_skip )
     {
-        if( p_pes->i_buffer <= i_skip )
-        {
-            block_t *p_next = p_pes->p_next;
-
-            i_skip -= p_pes->i_buffer;
-            block_Release( p_pes );
-            p_pes = p_next;
-        }
-        else
-        {
-            p_pes->i_buffer -= i_skip;
-            p_pes->p_buffer += i_skip;
-            break;
-        }
+        block_Release( p_pes );
+        p_pes = NULL;
+    }
+    else
+    {
+        p_pes->i_buffer -= i_skip;
+        p_pes->p_buffer += i_skip;
     }
 
     /* ISO/IEC 13818-1 2.7.5: if no pts and no dts, then dts == pts */
@@ -1663,7 +1751,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
         p_pes->i_length = FROM_SCALE_NZ(i_length);
 
         /* Can become a chain on next call due to prepcr */
-        block_t *p_chain = block_ChainGather( p_pes );
+        block_t *p_chain = p_pes;
         while ( p_chain ) {
             block_t *p_block = p_chain;
             p_chain = p_chain->p_next;
@@ -1762,9 +1850,203 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
     }
 }
 
+static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
+                               stime_t i_append_pcr )
+{
+    ts_pes_header_t hdr;
+
+    p_pes = PreparsePESDataChain( VLC_OBJECT(p_demux), pid->i_pid, p_pes, &hdr );
+    if( p_pes )
+        OutputPESData( p_demux, pid, p_pes, &hdr, i_append_pcr );
+}
+
+/****************************************************************************
+ * parallel PES parsing
+ *
+ * Completed PES are preparsed by the executor threads, then output from the
+ * demux thread in completion order. The output of a program is flushed
+ * before anything else can depend on it (PCR, PSI changes, ES creation),
+ * so that es_out sees the same sequence as with serial parsing.
+ ****************************************************************************/
+/* Executor shared by the demuxers with ts-threads-shared, its thread count
+ * being set by the first one */
+static struct
+{
+    vlc_mutex_t     lock;
+    vlc_executor_t *executor;
+    unsigned        refs;
+} ts_shared_executor = { VLC_STATIC_MUTEX, NULL, 0 };
+
+static vlc_executor_t *SharedExecutorHold( unsigned i_threads )
+{
+    vlc_mutex_lock( &ts_shared_executor.lock );
+    if( ts_shared_executor.refs == 0 )
+        ts_shared_executor.executor = vlc_executor_New( i_threads );
+    if( ts_shared_executor.executor )
+        ts_shared_executor.refs++;
+    vlc_executor_t *executor = ts_shared_executor.executor;
+    vlc_mutex_unlock( &ts_shared_executor.lock );
+    return executor;
+}
+
+static void SharedExecutorRelease( void )
+{
+    vlc_mutex_lock( &ts_shared_executor.lock );
+    assert( ts_shared_executor.refs > 0 );
+    if( --ts_shared_executor.refs == 0 )
+    {
+        vlc_executor_Delete( ts_shared_executor.executor );
+        ts_shared_executor.executor = NULL;
+    }
+    vlc_mutex_unlock( &ts_shared_executor.lock );
+}
+
+struct ts_pes_job_t
+{
+    struct vlc_runnable runnable;
+    vlc_sem_t        done;
+    vlc_object_t    *p_obj;
+    ts_pid_t        *p_pid;
+    const ts_pmt_t  *p_pmt;
+    block_t         *p_pes;
+    stime_t          i_append_pcr;
+    ts_pes_header_t  hdr;
+    ts_pes_job_t    *p_next;
+};
+
+static void PESJobRun( void *priv )
+{
+    ts_pes_job_t *p_job = priv;
+
+    p_job->p_pes = PreparsePESDataChain( p_job->p_obj, p_job->p_pid->i_pid,
+                                         p_job->p_pes, &p_job->hdr );
+    vlc_sem_post( &p_job->done );
+}
+
+static bool PESJobSubmit( demux_t *p_demux, ts_pid_t *pid, const ts_pmt_t *p_pmt,
+                          block_t *p_pes, stime_t i_append_pcr )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_pes_job_t *p_job = malloc( sizeof(*p_job) );
+    if( unlikely(p_job == NULL) )
+        return false;
+
+    p_job->runnable.run = PESJobRun;
+    p_job->runnable.userdata = p_job;
+    vlc_sem_init( &p_job->done, 0 );
+    p_job->p_obj = VLC_OBJECT(p_demux);
+    p_job->p_pid = pid;
+    p_job->p_pmt = p_pmt;
+    p_job->p_pes = p_pes;
+    p_job->i_append_pcr = i_append_pcr;
+    p_job->p_next = NULL;
+
+    *p_sys->pes_jobs.pp_last = p_job;
+    p_sys->pes_jobs.pp_last = &p_job->p_next;
+
+    vlc_executor_Submit( p_sys->pes_jobs.executor, &p_job->runnable );
+    return true;
+}
+
+/* Outputs the pending PES of a program, or of all programs if NULL */
+void FlushPESJobs( demux_t *p_demux, const ts_pmt_t *p_pmt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_pes_job_t **pp_job = &p_sys->pes_jobs.p_first;
+
+    while( *pp_job )
+    {
+        ts_pes_job_t *p_job = *pp_job;
+        if( p_pmt && p_job->p_pmt != p_pmt )
+        {
+            pp_job = &p_job->p_next;
+            continue;
+        }
+
+        *pp_job = p_job->p_next;
+
+        vlc_sem_wait( &p_job->done );
+        if( p_job->p_pes )
+            OutputPESData( p_demux, p_job->p_pid, p_job->p_pes, &p_job->hdr,
+                           p_job->i_append_pcr );
+        free( p_job );
+    }
+    p_sys->pes_jobs.pp_last = pp_job;
+}
+
 static void PESDataChainHandle( vlc_object_t *p_obj, void *priv, block_t *p_data, stime_t i_appendpcr )
 {
-    ParsePESDataChain( (demux_t *)p_obj, (ts_pid_t *) priv, p_data, i_appendpcr );
+    demux_t *p_demux = (demux_t *)p_obj;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_pid_t *pid = (ts_pid_t *) priv;
+    const ts_pmt_t *p_pmt = pid->u.p_stream->p_es->p_program;
+
+    if( p_pmt )
+    {
+        /* Without PCR, the output generates the program PCR itself */
+        if( p_sys->pes_jobs.b_defer && !p_pmt->pcr.b_disable &&
+            PESJobSubmit( p_demux, pid, p_pmt, p_data, i_appendpcr ) )
+            return;
+
+        /* Keep the PES order */
+        FlushPESJobs( p_demux, p_pmt );
+    }
+
+    ParsePESDataChain( p_demux, pid, p_data, i_appendpcr );
+}
+
+static block_t* ReadTSBlock( demux_sys_t *p_sys )
+{
+    if( p_sys->packet_pool == NULL )
+        return vlc_stream_Block( p_sys->stream, p_sys->i_packet_size );
+
+    block_t *p_pkt = block_pool_Alloc( p_sys->packet_pool, p_sys->i_packet_size );
+    if( unlikely(p_pkt == NULL) )
+        return NULL;
+
+    ssize_t i_read = vlc_stream_Read( p_sys->stream, p_pkt->p_buffer,
+                                      p_sys->i_packet_size );
+    if( i_read <= 0 )
+    {
+        block_Release( p_pkt );
+        return NULL;
+    }
+    p_pkt->i_buffer = i_read;
+    return p_pkt;
+}
+
+/* Looks for the first of two consecutive sync bytes. The buffer must hold
+ * i_max + i_packet_size bytes. If there are none, returns false and the
+ * amount of garbage that can be skipped. */
+static bool FindTSSync( const uint8_t *p_peek, unsigned i_max,
+                        unsigned i_packet_size, unsigned i_header_size,
+                        unsigned *pi_skip )
+{
+    /* The second sync byte must be within the buffer */
+    if( i_max <= i_header_size )
+    {
+        *pi_skip = i_max;
+        return false;
+    }
+    const unsigned i_end = i_max - i_header_size;
+
+    /* memchr() is vectorized by the C library, use it to skip the garbage */
+    for( unsigned i_skip = 0; i_skip < i_end; i_skip++ )
+    {
+        const uint8_t *p_sync = memchr( &p_peek[i_skip + i_header_size], 0x47,
+                                        i_end - i_skip );
+        if( p_sync == NULL )
+            break;
+
+        i_skip = p_sync - p_peek - i_header_size;
+        if( p_sync[i_packet_size] == 0x47 )
+        {
+            *pi_skip = i_skip;
+            return true;
+        }
+    }
+    *pi_skip = i_end;
+    return false;
 }
 
 static block_t* ReadTSPacket( demux_t *p_demux )
@@ -1774,7 +2056,7 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     block_t     *p_pkt;
 
     /* Get a new TS packet */
-    if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+    if( !( p_pkt = ReadTSBlock( p_sys ) ) )
     {
         int64_t size = stream_Size( p_sys->stream );
         if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
@@ -1816,27 +2098,21 @@ static block_t* ReadTSPacket( demux_t *p_demux )
                 return NULL;
             }
 
-            while( i_skip < i_peek - p_sys->i_packet_size )
-            {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
-                {
-                    break;
-                }
-                i_skip++;
-            }
+            bool b_synced = FindTSSync( p_peek, i_peek - p_sys->i_packet_size,
+                                        p_sys->i_packet_size,
+                                        p_sys->i_packet_header_size, &i_skip );
             msg_Dbg( p_demux, "skipping %d bytes of garbage at %"PRIu64,
                      i_skip, vlc_stream_Tell( p_sys->stream ) );
             if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
                 return NULL;
 
-            if( i_skip < i_peek - p_sys->i_packet_size )
+            if( b_synced )
             {
                 break;
             }
         }
         msg_Dbg( p_demux, "resynced at %" PRIu64, vlc_stream_Tell( p_sys->stream ) );
-        if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+        if( !( p_pkt = ReadTSBlock( p_sys ) ) )
         {
             msg_Dbg( p_demux, "eof ?" );
             return NULL;
@@ -2390,20 +2666,30 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
     if(unlikely(GetPID(p_sys, 0)->type != TYPE_PAT))
         return;
 
+    /* PES drained by the PCR checks must be output before the PCR */
+    const bool b_defer = p_sys->pes_jobs.b_defer;
+    p_sys->pes_jobs.b_defer = false;
+
     /* Search program and set the PCR */
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
     for( int i = 0; i < p_pat->programs.i_size; i++ )
     {
         ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        /* The program PCR setup can still be changed by its pending PES */
+        if( !p_pmt->pcr.b_fix_done )
+            FlushPESJobs( p_demux, p_pmt );
         if( p_pmt->pcr.b_disable )
             continue;
         stime_t i_program_pcr = TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr );
+        /* The first PCR fixup looks at the queues of all programs */
+        const ts_pmt_t *p_flush = ( p_pmt->pcr.i_current == -1 ) ? NULL : p_pmt;
 
         if( p_pmt->i_pid_pcr == 0x1FFF ) /* That program has no dedicated PCR pid ISO/IEC 13818-1 2.4.4.9 */
         {
             if( PIDReferencedByProgram( p_pmt, pid->i_pid ) ) /* PCR shall be on pid itself */
             {
                 /* ? update PCR for the whole group program ? */
+                FlushPESJobs( p_demux, p_flush );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
             }
         }
@@ -2413,12 +2699,15 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             if( p_pmt->i_pid_pcr == pid->i_pid ) /* If that program references current pid as PCR */
             {
                 /* We've found a target group for update */
+                FlushPESJobs( p_demux, p_flush );
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
             }
         }
 
     }
+
+    p_sys->pes_jobs.b_defer = b_defer;
 }
 
 int FindPCRCandidate( ts_pmt_t *p_pmt )
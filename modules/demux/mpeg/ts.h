@@ -24,6 +24,8 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct vlc_executor vlc_executor_t;
+typedef struct ts_pes_job_t ts_pes_job_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -71,6 +73,19 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* recycled TS packet blocks (NULL if unavailable) */
+    block_pool_t *packet_pool;
+
+    /* PES parsed by worker threads (NULL executor if disabled) */
+    struct
+    {
+        vlc_executor_t *executor;
+        ts_pes_job_t   *p_first; /* in completion order */
+        ts_pes_job_t  **pp_last;
+        bool            b_defer;
+        bool            b_shared; /* executor shared between demuxers */
+    } pes_jobs;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -154,6 +169,7 @@ int ProbeStart( demux_t *p_demux, int i_program );
 int ProbeEnd( demux_t *p_demux, int i_program );
 
 void AddAndCreateES( demux_t *p_demux, ts_pid_t *pid, bool b_create_delayed );
+void FlushPESJobs( demux_t *p_demux, const ts_pmt_t *p_pmt );
 int FindPCRCandidate( ts_pmt_t *p_pmt );
 
 #endif
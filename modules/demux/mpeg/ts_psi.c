@@ -126,6 +126,9 @@ static void PATCallBack( void *data, dvbpsi_pat_t *p_dvbpsipat )
         return;
     }
 
+    /* Pending PES may belong to programs or ES going away */
+    FlushPESJobs( p_demux, NULL );
+
     msg_Dbg( p_demux, "new PAT ts_id=%d version=%d current_next=%d",
              p_dvbpsipat->i_ts_id, p_dvbpsipat->i_version, p_dvbpsipat->b_current_next );
 
@@ -1614,6 +1617,13 @@ static void PIDFillFormat( demux_t *p_demux, ts_stream_t *p_pes,
     case 0x84:  /* SDDS (audio) */
         es_format_Change( fmt, AUDIO_ES, VLC_CODEC_SDDS );
         break;
+    case 0x86:  /* SCTE-35 splice information */
+        es_format_Change( fmt, SPU_ES, VLC_CODEC_SCTE_35 );
+        fmt->i_priority = ES_PRIORITY_NOT_DEFAULTABLE; /* for stream outputs */
+        *p_datatype = TS_TRANSPORT_SECTIONS;
+        ts_sections_processor_Add( p_demux, &p_pes->p_sections_proc, SCTE35_TABLE_ID, 0x00,
+                                   SCTE35_Section_Callback, p_pes );
+        break;
     case 0x85:  /* DTS (audio) FIXME: HDMV Only ? */
         es_format_Change( fmt, AUDIO_ES, VLC_CODEC_DTS );
         break;
@@ -1860,6 +1870,9 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
         return;
     }
 
+    /* Pending PES may belong to ES going away */
+    FlushPESJobs( p_demux, NULL );
+
     /* Save old es array */
     DECL_ARRAY(ts_pid_t *) pid_to_decref;
     pid_to_decref.i_alloc = p_pmt->e_streams.i_alloc;
@@ -119,3 +119,43 @@ void SCTE27_Section_Callback( demux_t *p_demux,
     else
         block_Release( p_content );
 }
+
+/* Splice information: forwarded as is, with the splice time as PTS */
+void SCTE35_Section_Callback( demux_t *p_demux,
+                              const uint8_t *p_sectiondata, size_t i_sectiondata,
+                              const uint8_t *p_payloaddata, size_t i_payloaddata,
+                              void *p_pes_cb_data )
+{
+    VLC_UNUSED(p_payloaddata); VLC_UNUSED(i_payloaddata);
+    ts_stream_t *p_pes = (ts_stream_t *) p_pes_cb_data;
+    assert( p_pes->p_es->fmt.i_codec == VLC_CODEC_SCTE_35 );
+    const ts_pmt_t *p_pmt = p_pes->p_es->p_program;
+
+    if( !p_pes->p_es->id || p_pmt->pcr.i_current == -1 )
+        return;
+
+    scte35_splice_insert_t insert;
+    if( !scte35_parse_splice_insert( p_sectiondata, i_sectiondata, &insert ) )
+        return; /* splice_null heartbeats, time signals, encrypted sections */
+
+    const stime_t i_date = TimeStampWrapAround( p_pmt->pcr.i_first, p_pmt->pcr.i_current );
+    stime_t i_splice = i_date;
+    if( !insert.b_cancel && insert.i_splice_time != SCTE35_TIME_UNSET )
+        i_splice = TimeStampWrapAround( p_pmt->pcr.i_first,
+                        (insert.i_splice_time + insert.i_pts_adjustment) & 0x1FFFFFFFF );
+
+    msg_Dbg( p_demux, "SCTE-35 splice_insert event %"PRIu32"%s%s at %"PRId64,
+             insert.i_event_id, insert.b_cancel ? " cancelled" : "",
+             insert.b_out_of_network ? " out" : " in", FROM_SCALE(i_splice) );
+
+    block_t *p_content = block_Alloc( i_sectiondata );
+    if( unlikely(!p_content) )
+        return;
+    memcpy( p_content->p_buffer, p_sectiondata, i_sectiondata );
+    p_content->i_dts = FROM_SCALE(i_date);
+    p_content->i_pts = FROM_SCALE(i_splice);
+    if( insert.i_break_duration != SCTE35_TIME_UNSET )
+        p_content->i_length = FROM_SCALE_NZ(insert.i_break_duration);
+
+    es_out_Send( p_demux->out, p_pes->p_es->id, p_content );
+}
@@ -20,6 +20,7 @@
 #define VLC_TS_SCTE_H
 
 #include "../../codec/scte18.h"
+#include "../../codec/scte35.h"
 
 void SCTE18_Section_Callback( dvbpsi_t *p_handle,
                               const dvbpsi_psi_section_t* p_section,
@@ -28,5 +29,9 @@ void SCTE27_Section_Callback( demux_t *p_demux,
                               const uint8_t *, size_t,
                               const uint8_t *, size_t,
                               void * );
+void SCTE35_Section_Callback( demux_t *p_demux,
+                              const uint8_t *, size_t,
+                              const uint8_t *, size_t,
+                              void * );
 
 #endif
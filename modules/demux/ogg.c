@@ -520,6 +520,15 @@ static int Demux( demux_t * p_demux )
             {
                 continue;
             }
+
+            /* Index the page for later seeks */
+            if( p_stream->i_secondary_header_packets == 0 &&
+                ogg_page_granulepos( &p_sys->current_page ) > 0 )
+                OggSeek_IndexAdd( p_stream,
+                                  Ogg_GranuleToTime( p_stream,
+                                        ogg_page_granulepos( &p_sys->current_page ),
+                                        !p_stream->b_contiguous, false ),
+                                  p_sys->i_page_position );
         }
 
         /* clear the finished flag if pages after eos (ex: after a seek) */
@@ -929,6 +938,12 @@ static int Ogg_ReadPage( demux_t *p_demux, ogg_page *p_oggpage )
         ogg_sync_wrote( &p_ogg->oy, i_read );
     }
 
+    /* The sync buffer holds what was read past the page */
+    int64_t i_pos = vlc_stream_Tell( p_demux->s );
+    i_pos -= p_ogg->oy.fill - p_ogg->oy.returned;
+    i_pos -= p_oggpage->header_len + p_oggpage->body_len;
+    p_ogg->i_page_position = i_pos;
+
     return VLC_SUCCESS;
 }
 
@@ -196,6 +196,8 @@ typedef struct
 
     /* current page being parsed */
     ogg_page current_page;
+    /* offset of the current page in file */
+    int64_t i_page_position;
 
     /* */
     vlc_meta_t          *p_meta;
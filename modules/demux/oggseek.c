@@ -97,10 +97,10 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
 
     if ( p_stream == NULL ) return NULL;
 
-    idx = p_stream->idx;
-
     if ( i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 ) return NULL;
 
+    idx = p_stream->idx;
+
     if ( idx == NULL )
     {
         demux_index_entry_t *ie = index_entry_new();
@@ -113,6 +113,9 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
 
     while ( idx != NULL )
     {
+        /* Keep the index sparse, so that playback does not grow it per page */
+        if ( llabs( idx->i_pagepos - i_pagepos ) < OGGSEEK_INDEX_SPACING )
+            return NULL;
         if ( idx->i_pagepos > i_pagepos ) break;
         last_idx = idx;
         idx = idx->p_next;
@@ -144,31 +147,29 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
     return idx;
 }
 
+/* Narrows the given bounds (-1 if unset) with the index entries surrounding
+   the timestamp. Returns true if a lower bound was found. */
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
                                int64_t *pi_pos_lower, int64_t *pi_pos_upper )
 {
     demux_index_entry_t *idx = p_stream->idx;
+    bool b_found = false;
 
     while ( idx != NULL )
     {
-        if ( idx->i_value <= i_timestamp )
+        if ( idx->i_value > i_timestamp )
         {
-            if ( !idx->p_next ) /* found on last index */
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                return true;
-            }
-            if ( idx->p_next->i_value > i_timestamp )
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_pos_upper = idx->p_next->i_pagepos;
-                return true;
-            }
+            if ( *pi_pos_upper < 0 || idx->i_pagepos < *pi_pos_upper )
+                *pi_pos_upper = idx->i_pagepos;
+            break;
         }
+        if ( idx->i_pagepos > *pi_pos_lower )
+            *pi_pos_lower = idx->i_pagepos;
+        b_found = true;
         idx = idx->p_next;
     }
 
-    return false;
+    return b_found;
 }
 
 /*********************************************************************
@@ -693,7 +694,8 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
 
         if ( current.i_pos != -1 && current.i_granule != -1 )
         {
-            /* found a page */
+            /* found a page, remember it for the next seeks */
+            OggSeek_IndexAdd( p_stream, current.i_timestamp, current.i_pos );
 
             if ( current.i_timestamp <= i_targettime )
             {
@@ -783,10 +785,16 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_lowerpos, &i_upperpos );
     if ( i_lowerpos != -1 ) b_found = true;
 
-    /* And also search in our own index */
+    /* And also search in our own index; the pages are indexed as they are
+     * read, so only jump there if the target is closely bracketed and every
+     * packet is a keyframe, otherwise just narrow the search */
+    bool b_indexed = false;
     if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos ) )
     {
-        b_found = true;
+        b_indexed = true;
+        if ( i_upperpos != -1 && i_upperpos - i_lowerpos <= 2 * OGGSEEK_INDEX_SPACING
+          && Ogg_GetKeyframeGranule( p_stream, 0xFF00FF00 ) == 0xFF00FF00 )
+            b_found = true;
     }
 
     /* Or try to be smart with audio fixed bitrate streams */
@@ -802,11 +810,20 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     /* or search */
     if ( !b_found && b_fastseek )
     {
-        i_lowerpos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                            p_stream->i_data_start, p_sys->i_total_length );
-        b_found = ( i_lowerpos != -1 );
+        int64_t i_pos = OggBisectSearchByTime( p_demux, p_stream, i_time,
+                                               i_lowerpos, i_upperpos );
+        if ( i_pos != -1 )
+        {
+            i_lowerpos = i_pos;
+            i_upperpos = -1;
+            b_found = true;
+        }
     }
 
+    /* or fall back to the closest indexed page before the target */
+    if ( !b_found && b_indexed )
+        b_found = true;
+
     if ( !b_found ) return -1;
 
     if ( i_lowerpos < p_stream->i_data_start || i_upperpos > p_sys->i_total_length )
@@ -889,9 +906,7 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     }
     OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
-    OggNoDebug(
-        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper )
-    );
+    OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper );
 
     i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
     i_offset_upper = __MIN( i_offset_upper, p_sys->i_total_length );
@@ -905,12 +920,6 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
         p_sys->i_input_position = i_pagepos;
         seek_byte( p_demux, p_sys->i_input_position );
     }
-    /* Insert keyframe position into index */
-    OggNoDebug(
-    if ( i_pagepos >= p_stream->i_data_start )
-        OggSeek_IndexAdd( p_stream, i_time, i_pagepos )
-    );
-
     OggDebug( msg_Dbg( p_demux, "=================== Seeked To %"PRId64" time %"PRId64, i_pagepos, i_time ) );
     return i_pagepos;
 }
@@ -39,9 +39,13 @@
 
 #define OGGSEEK_BYTES_TO_READ 8500
 
+/* minimal distance in bytes between two index entries */
+#define OGGSEEK_INDEX_SPACING (4 * OGGSEEK_BYTES_TO_READ)
+
 /* index entries are structured as follows:
- *   - for theora, highest granulepos -> pagepos (bytes) where keyframe begins
- *  - for dirac, kframe (sync point) -> pagepos of sequence start (?)
+ *   - time of the page granulepos -> pagepos (bytes) where the page begins
+ * Entries are collected from the pages read during playback and from the
+ * seek probes, and are used to narrow the bisection before seeking.
  */
 
 /* this is typedefed to demux_index_entry_t in ogg.h */
@@ -50,7 +54,7 @@ struct oggseek_index_entry
     demux_index_entry_t *p_next;
     demux_index_entry_t *p_prev;
 
-    /* value is highest granulepos for theora, sync frame for dirac */
+    /* time of the page granulepos, as compared by the bisection */
     vlc_tick_t i_value;
     int64_t i_pagepos;
 
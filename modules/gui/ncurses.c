@@ -714,6 +714,8 @@ static int DrawStats(intf_thread_t *intf)
                 p_stats->i_late_pictures);
         MainBoxWrite(sys, l++, _("| frames lost      :    %5"PRIi64),
                 p_stats->i_lost_pictures);
+        MainBoxWrite(sys, l++, _("| vsyncs missed    :    %5"PRIi64),
+                p_stats->i_missed_vsyncs);
     }
     /* Audio*/
     if (i_audio) {
@@ -120,25 +120,14 @@ void MLBaseModel::onVlcMlEvent(const MLEvent &event)
                 if (!m_cache)
                     break;
 
-                ssize_t stotal = m_cache->count();
-                if (stotal == COUNT_UNINITIALIZED)
-                    break;
-
-                size_t total = static_cast<size_t>(stotal);
-                for (size_t i = 0; i < total; ++i)
-                {
-                    const std::unique_ptr<MLItem> *item = m_cache->get(i);
-                    if (!item)
-                        /* Only consider items available locally in cache */
-                        break;
-
-                    MLItem *localItem = item->get();
-                    if (localItem->getId().id == event.media_thumbnail_generated.i_media_id)
-                    {
-                        thumbnailUpdated(i);
-                        break;
-                    }
-                }
+                /* Only consider items available locally in cache */
+                int64_t mediaId = event.media_thumbnail_generated.i_media_id;
+                ssize_t i = m_cache->findLocal(
+                    [mediaId](const std::unique_ptr<MLItem> &item) {
+                        return item->getId().id == mediaId;
+                    });
+                if (i >= 0)
+                    thumbnailUpdated(i);
             }
             break;
         }
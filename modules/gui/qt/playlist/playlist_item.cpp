@@ -26,7 +26,11 @@ PlaylistItem::PlaylistItem(vlc_playlist_item_t* item)
     if (item)
     {
         d->item.reset(item);
-        sync();
+
+        input_item_t *media = vlc_playlist_item_GetMedia(item);
+        vlc_mutex_lock(&media->lock);
+        d->duration = media->i_duration;
+        vlc_mutex_unlock(&media->lock);
     }
 }
 
@@ -42,21 +46,25 @@ void PlaylistItem::setSelected(bool selected)
 
 QString PlaylistItem::getTitle() const
 {
+    syncMeta();
     return d->title;
 }
 
 QString PlaylistItem::getArtist() const
 {
+    syncMeta();
     return d->artist;
 }
 
 QString PlaylistItem::getAlbum() const
 {
+    syncMeta();
     return d->album;
 }
 
 QUrl PlaylistItem::getArtwork() const
 {
+    syncMeta();
     return d->artwork;
 }
 
@@ -67,10 +75,20 @@ vlc_tick_t PlaylistItem::getDuration() const
 
 QUrl PlaylistItem::getUrl() const
 {
+    syncMeta();
     return d->url;
 }
 
 void PlaylistItem::sync() {
+    d->metaSynced = false;
+    syncMeta();
+}
+
+void PlaylistItem::syncMeta() const {
+    if (d->metaSynced || !d->item)
+        return;
+    d->metaSynced = true;
+
     input_item_t *media = vlc_playlist_item_GetMedia(d->item.get());
     vlc_mutex_lock(&media->lock);
     d->duration = media->i_duration;
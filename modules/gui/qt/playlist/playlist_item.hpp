@@ -41,9 +41,14 @@ using PlaylistItemPtr = vlc_shared_data_ptr_type(vlc_playlist_item_t,
 /**
  * Playlist item wrapper.
  *
- * It contains both the PlaylistItemPtr and cached data saved while the playlist
- * is locked, so that the fields may be read without synchronization or race
- * conditions.
+ * It contains both the PlaylistItemPtr and cached data, so that the fields may
+ * be read without synchronization or race conditions.
+ *
+ * Only the duration is cached on creation (it is needed to compute the total
+ * duration of the playlist). The other fields are fetched from the media on
+ * first access, so that wrapping a huge playlist does not copy the metadata of
+ * items that are never displayed. The fields must therefore be read from a
+ * single thread (the UI thread).
  */
 class PlaylistItem
 {
@@ -83,10 +88,13 @@ public:
     void sync();
 
 private:
+    void syncMeta() const;
+
     struct Data : public QSharedData {
         PlaylistItemPtr item;
 
         bool selected = false;
+        bool metaSynced = false;
 
         /* cached values */
         QString title;
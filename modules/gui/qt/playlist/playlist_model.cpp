@@ -50,6 +50,75 @@ static QVector<RAW> toRaw(const QVector<WRAPPER> &items)
         vec.push_back(items[i].raw());
     return vec;
 }
+
+/**
+ * Merge the change @a event into the pending change @a last, if the result is
+ * equivalent to applying both in sequence.
+ */
+static bool mergeEvents(PlaylistPendingEvent &last,
+                        const PlaylistPendingEvent &event)
+{
+    if (last.type != event.type || last.playlist != event.playlist)
+        return false;
+
+    switch (event.type)
+    {
+    case PlaylistPendingEvent::Added:
+    {
+        /* insertion within (or right after) the pending inserted range */
+        if (event.index < last.index || event.index > last.index + last.count)
+            return false;
+        int pos = event.index - last.index;
+        if (pos == last.items.size())
+            last.items += event.items;
+        else
+            last.items = last.items.mid(0, pos) + event.items
+                       + last.items.mid(pos);
+        last.count += event.count;
+        return true;
+    }
+    case PlaylistPendingEvent::Removed:
+        /* removal right after (in the new indexes) or right before the
+         * pending removed range */
+        if (event.index == last.index)
+        {
+            last.count += event.count;
+            return true;
+        }
+        if (event.index + event.count == last.index)
+        {
+            last.index = event.index;
+            last.count += event.count;
+            return true;
+        }
+        return false;
+    case PlaylistPendingEvent::Updated:
+    {
+        if (event.index > last.index + last.count
+         || event.index + event.count < last.index)
+            return false;
+        size_t first = std::min(last.index, event.index);
+        size_t end = std::max(last.index + last.count,
+                              event.index + event.count);
+        QVector<PlaylistItem> merged;
+        merged.reserve(end - first);
+        for (size_t i = first; i < end; ++i)
+        {
+            /* the most recent values win */
+            if (i >= event.index && i < event.index + event.count)
+                merged.push_back(event.items[i - event.index]);
+            else
+                merged.push_back(last.items[i - last.index]);
+        }
+        last.index = first;
+        last.count = end - first;
+        last.items = std::move(merged);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
 }
 
 extern "C" { // for C callbacks
@@ -60,12 +129,8 @@ on_playlist_items_reset(vlc_playlist_t *playlist,
                         size_t len, void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    QVector<PlaylistItem> newContent = toVec(items, len);
-    that->callAsync([=]() {
-        if (that->m_playlist != playlist)
-            return;
-        that->onItemsReset(newContent);
-    });
+    that->postEvent({ PlaylistPendingEvent::Reset, playlist, 0, len, 0,
+                      toVec(items, len), -1 });
 }
 
 static void
@@ -74,12 +139,8 @@ on_playlist_items_added(vlc_playlist_t *playlist, size_t index,
                         void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    QVector<PlaylistItem> added = toVec(items, len);
-    that->callAsync([=]() {
-        if (that->m_playlist != playlist)
-            return;
-        that->onItemsAdded(added, index);
-    });
+    that->postEvent({ PlaylistPendingEvent::Added, playlist, index, len, 0,
+                      toVec(items, len), -1 });
 }
 
 static void
@@ -87,11 +148,8 @@ on_playlist_items_moved(vlc_playlist_t *playlist, size_t index, size_t count,
                         size_t target, void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    that->callAsync([=]() {
-        if (that->m_playlist != playlist)
-            return;
-        that->onItemsMoved(index, count, target);
-    });
+    that->postEvent({ PlaylistPendingEvent::Moved, playlist, index, count,
+                      target, {}, -1 });
 }
 
 static void
@@ -99,11 +157,8 @@ on_playlist_items_removed(vlc_playlist_t *playlist, size_t index, size_t count,
                           void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    that->callAsync([=](){
-        if (that->m_playlist != playlist)
-            return;
-        that->onItemsRemoved(index, count);
-    });
+    that->postEvent({ PlaylistPendingEvent::Removed, playlist, index, count, 0,
+                      {}, -1 });
 }
 
 static void
@@ -112,15 +167,8 @@ on_playlist_items_updated(vlc_playlist_t *playlist, size_t index,
                           void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    QVector<PlaylistItem> updated = toVec(items, len);
-    that->callAsync([=](){
-        if (that->m_playlist != playlist)
-            return;
-        int count = updated.size();
-        for (int i = 0; i < count; ++i)
-            that->m_items[index + i] = updated[i]; /* sync metadata */
-        that->notifyItemsChanged(index, count);
-    });
+    that->postEvent({ PlaylistPendingEvent::Updated, playlist, index, len, 0,
+                      toVec(items, len), -1 });
 }
 
 static void
@@ -128,17 +176,9 @@ on_playlist_current_item_changed(vlc_playlist_t *playlist, ssize_t index,
                                  void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    that->callAsync([=](){
-        if (that->m_playlist != playlist)
-            return;
-        ssize_t oldCurrent = that->m_current;
-        that->m_current = index;
-        if (oldCurrent != -1)
-            that->notifyItemsChanged(oldCurrent, 1, {PlaylistListModel::IsCurrentRole});
-        if (index != -1)
-            that->notifyItemsChanged(index, 1, {PlaylistListModel::IsCurrentRole});
-        emit that->q_func()->currentIndexChanged(index);
-    });
+    /* queued with the other changes, so that the index matches the content */
+    that->postEvent({ PlaylistPendingEvent::CurrentChanged, playlist, 0, 0, 0,
+                      {}, index });
 }
 
 } // extern "C"
@@ -170,12 +210,117 @@ PlaylistListModelPrivate::~PlaylistListModelPrivate()
     }
 }
 
+void PlaylistListModelPrivate::postEvent(PlaylistPendingEvent &&event)
+{
+    QMutexLocker locker(&m_pendingLock);
+
+    if (event.type == PlaylistPendingEvent::Reset)
+    {
+        /* the new content supersedes the pending changes of the list */
+        auto it = std::remove_if(m_pendingEvents.begin(), m_pendingEvents.end(),
+                                 [](const PlaylistPendingEvent &e) {
+            return e.type != PlaylistPendingEvent::CurrentChanged;
+        });
+        m_pendingEvents.erase(it, m_pendingEvents.end());
+    }
+    else if (!m_pendingEvents.isEmpty()
+          && mergeEvents(m_pendingEvents.last(), event))
+        return;
+
+    m_pendingEvents.push_back(std::move(event));
+
+    /* apply all the changes received meanwhile at once, on the next event loop
+     * iteration */
+    if (!m_flushScheduled)
+    {
+        m_flushScheduled = true;
+        callAsync([this]() { flushPendingEvents(); });
+    }
+}
+
+void PlaylistListModelPrivate::flushPendingEvents()
+{
+    QVector<PlaylistPendingEvent> events;
+    {
+        QMutexLocker locker(&m_pendingLock);
+        events.swap(m_pendingEvents);
+        m_flushScheduled = false;
+    }
+
+    for (const PlaylistPendingEvent &event : events)
+    {
+        if (event.playlist != m_playlist)
+            continue;
+
+        switch (event.type)
+        {
+        case PlaylistPendingEvent::Reset:
+            onItemsReset(event.items);
+            break;
+        case PlaylistPendingEvent::Added:
+            onItemsAdded(event.items, event.index);
+            break;
+        case PlaylistPendingEvent::Moved:
+            onItemsMoved(event.index, event.count, event.target);
+            break;
+        case PlaylistPendingEvent::Removed:
+            onItemsRemoved(event.index, event.count);
+            break;
+        case PlaylistPendingEvent::Updated:
+            onItemsUpdated(event.items, event.index);
+            break;
+        case PlaylistPendingEvent::CurrentChanged:
+            onCurrentIndexChanged(event.current);
+            break;
+        }
+    }
+}
+
 void PlaylistListModelPrivate::onItemsReset(const QVector<PlaylistItem>& newContent)
 {
     Q_Q(PlaylistListModel);
-    q->beginResetModel();
-    m_items = newContent;
-    q->endResetModel();
+    int oldCount = m_items.size();
+    int newCount = newContent.size();
+
+    /* Only notify the rows which actually changed, so that the views do not
+     * reload everything and the kept items preserve their state (selection,
+     * fetched metadata) */
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount
+           && m_items[prefix].raw() == newContent[prefix].raw())
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+           && m_items[oldCount - suffix - 1].raw()
+              == newContent[newCount - suffix - 1].raw())
+        ++suffix;
+
+    if (prefix + suffix == 0)
+    {
+        q->beginResetModel();
+        m_items = newContent;
+        q->endResetModel();
+    }
+    else
+    {
+        int removed = oldCount - prefix - suffix;
+        int added = newCount - prefix - suffix;
+        if (removed > 0)
+        {
+            q->beginRemoveRows({}, prefix, prefix + removed - 1);
+            m_items.remove(prefix, removed);
+            q->endRemoveRows();
+        }
+        if (added > 0)
+        {
+            q->beginInsertRows({}, prefix, prefix + added - 1);
+            m_items.insert(prefix, added, nullptr);
+            std::copy(newContent.cbegin() + prefix,
+                      newContent.cbegin() + prefix + added,
+                      m_items.begin() + prefix);
+            q->endInsertRows();
+        }
+    }
 
     m_duration = VLC_TICK_FROM_SEC(0);
     if (m_items.size())
@@ -246,6 +391,29 @@ void PlaylistListModelPrivate::onItemsRemoved(size_t index, size_t count)
     emit q->selectedCountChanged();
 }
 
+void PlaylistListModelPrivate::onItemsUpdated(const QVector<PlaylistItem>& updated, size_t index)
+{
+    int count = updated.size();
+    for (int i = 0; i < count; ++i)
+    {
+        m_duration += updated[i].getDuration()
+                    - m_items[index + i].getDuration();
+        m_items[index + i] = updated[i]; /* sync metadata */
+    }
+    notifyItemsChanged(index, count);
+}
+
+void PlaylistListModelPrivate::onCurrentIndexChanged(ssize_t index)
+{
+    Q_Q(PlaylistListModel);
+    ssize_t oldCurrent = m_current;
+    m_current = index;
+    if (oldCurrent != -1)
+        notifyItemsChanged(oldCurrent, 1, {PlaylistListModel::IsCurrentRole});
+    if (index != -1)
+        notifyItemsChanged(index, 1, {PlaylistListModel::IsCurrentRole});
+    emit q->currentIndexChanged(index);
+}
 
 void
 PlaylistListModelPrivate::notifyItemsChanged(int idx, int count, const QVector<int> &roles)
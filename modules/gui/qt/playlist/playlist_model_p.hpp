@@ -21,10 +21,30 @@
 #define PLAYLIST_MODEL_P_HPP
 
 #include "playlist_model.hpp"
+#include <QMutex>
 
 namespace vlc {
 namespace playlist {
 
+/**
+ * Playlist change received from the core, not applied to the model yet.
+ *
+ * Consecutive changes of the same kind and on adjacent ranges are merged, so
+ * that the views are notified once per range rather than once per callback.
+ */
+struct PlaylistPendingEvent
+{
+    enum Type { Reset, Added, Moved, Removed, Updated, CurrentChanged };
+
+    Type type;
+    vlc_playlist_t *playlist;
+    size_t index;
+    size_t count;
+    size_t target;
+    QVector<PlaylistItem> items;
+    ssize_t current;
+};
+
 class PlaylistListModelPrivate
 {
     Q_DISABLE_COPY(PlaylistListModelPrivate)
@@ -49,10 +69,16 @@ public:
 #endif
     }
 
+    ///queue a playlist change, applied on the UI thread (any thread)
+    void postEvent(PlaylistPendingEvent &&event);
+    void flushPendingEvents();
+
     void onItemsReset(const QVector<PlaylistItem>& items);
     void onItemsAdded(const QVector<PlaylistItem>& added, size_t index);
     void onItemsMoved(size_t index, size_t count, size_t target);
     void onItemsRemoved(size_t index, size_t count);
+    void onItemsUpdated(const QVector<PlaylistItem>& updated, size_t index);
+    void onCurrentIndexChanged(ssize_t index);
 
     void notifyItemsChanged(int index, int count,
                             const QVector<int> &roles = {});
@@ -65,6 +91,11 @@ public:
     ssize_t m_current = -1;
 
     vlc_tick_t m_duration = 0;
+
+    /* changes not applied yet, protected by m_pendingLock */
+    QMutex m_pendingLock;
+    QVector<PlaylistPendingEvent> m_pendingEvents;
+    bool m_flushScheduled = false;
 };
 
 } //namespace playlist
@@ -25,6 +25,7 @@
 
 #include "vlc_common.h"
 #include <cassert>
+#include <map>
 #include <memory>
 #include <vector>
 #include <QtGlobal>
@@ -47,6 +48,10 @@
  * The precise cache strategy is unspecified (it may change in the future), but
  * the general principle is to keep locally only a part of the whole data.
  *
+ * Items are loaded by chunks. The chunks around the last referred one are
+ * prefetched, a bounded number of chunks is kept locally, and the loads which
+ * are not needed anymore (because the referred index moved away) are canceled.
+ *
  * The list of items it represents is assumed constant:
  *  1. the list size will never change once initialized,
  *  2. the items retrieved by several calls at a specific location should be
@@ -82,39 +87,29 @@ class CountTask;
 template <typename T>
 class LoadTask;
 
-struct MLRange
-{
-    size_t offset = 0;
-    size_t count = 0;
-
-    MLRange() = default;
-
-    MLRange(size_t offset, size_t count)
-        : offset(offset)
-        , count(count)
-    {
-    }
-
-    bool isEmpty() {
-        return count == 0;
-    }
-
-    bool contains(size_t index) {
-        return index >= offset && index < offset + count;
-    }
-};
-
 template <typename T>
 class ListCache : public BaseListCache
 {
 public:
     static constexpr ssize_t COUNT_UNINITIALIZED = -1;
 
+    /**
+     * \param chunkSize number of items loaded at once
+     * \param prefetchChunks number of chunks to load on each side of the
+     *                       referred one
+     * \param maxChunks number of chunks kept locally
+     */
     ListCache(QThreadPool &threadPool, ListCacheLoader<T> *loader,
-              size_t chunkSize = 100)
+              size_t chunkSize = 100, size_t prefetchChunks = 1,
+              size_t maxChunks = 8)
         : m_threadPool(threadPool)
         , m_loader(loader)
-        , m_chunkSize(chunkSize) {}
+        , m_chunkSize(chunkSize)
+        , m_prefetchChunks(prefetchChunks)
+        , m_maxChunks(maxChunks)
+    {
+        assert(m_maxChunks >= 2 * m_prefetchChunks + 1);
+    }
 
     /**
      * Return the item at specified index
@@ -124,6 +119,13 @@ public:
      */
     const T *get(size_t index) const;
 
+    /**
+     * Return the index of the first local item matching `pred`, or -1
+     *
+     * This does not retrieve anything from the loader.
+     */
+    template <typename Pred>
+    ssize_t findLocal(Pred &&pred) const;
 
     /**
      * Return the number of items or `COUNT_UNINITIALIZED`
@@ -147,8 +149,9 @@ public:
     void refer(size_t index);
 
 private:
-    void asyncLoad(size_t offset, size_t count);
+    void asyncLoad(size_t chunk);
     void onLoadResult() override;
+    void evictChunks();
 
     void asyncCount();
     void onCountResult() override;
@@ -158,15 +161,18 @@ private:
      * loader callbacks */
     QSharedPointer<ListCacheLoader<T>> m_loader;
     size_t m_chunkSize;
+    size_t m_prefetchChunks;
+    size_t m_maxChunks;
+
+    /* local items and pending loads, by chunk index */
+    std::map<size_t, std::vector<T>> m_chunks;
+    std::map<size_t, TaskHandle<LoadTask<T>>> m_loadTasks;
+    size_t m_lastChunkReferred = 0;
 
-    std::vector<T> m_list;
     ssize_t m_total_count = COUNT_UNINITIALIZED;
-    size_t m_offset = 0;
 
     bool m_countRequested = false;
-    MLRange m_lastRangeRequested;
 
-    TaskHandle<LoadTask<T>> m_loadTask;
     TaskHandle<CountTask<T>> m_countTask;
 };
 
@@ -174,10 +180,27 @@ template <typename T>
 const T *ListCache<T>::get(size_t index) const
 {
     assert(m_total_count >= 0 && index < static_cast<size_t>(m_total_count));
-    if (index < m_offset || index >= m_offset + m_list.size())
+    auto it = m_chunks.find(index / m_chunkSize);
+    if (it == m_chunks.end())
+        return nullptr;
+
+    size_t offset = index % m_chunkSize;
+    if (offset >= it->second.size())
+        /* the loader returned less items than expected */
         return nullptr;
 
-    return &m_list[index - m_offset];
+    return &it->second[offset];
+}
+
+template <typename T>
+template <typename Pred>
+ssize_t ListCache<T>::findLocal(Pred &&pred) const
+{
+    for (const auto &chunk : m_chunks)
+        for (size_t i = 0; i < chunk.second.size(); ++i)
+            if (pred(chunk.second[i]))
+                return chunk.first * m_chunkSize + i;
+    return -1;
 }
 
 template <typename T>
@@ -207,14 +230,34 @@ void ListCache<T>::refer(size_t index)
         return;
     }
 
-    /* index outside the known portion of the list */
-    if (!m_lastRangeRequested.contains(index))
+    size_t chunk = index / m_chunkSize;
+    /* fast path: this is called for every item read by the views */
+    if (chunk == m_lastChunkReferred
+     && (m_chunks.count(chunk) || m_loadTasks.count(chunk)))
+        return;
+    m_lastChunkReferred = chunk;
+
+    size_t lastChunk = (m_total_count - 1) / m_chunkSize;
+    size_t first = chunk > m_prefetchChunks ? chunk - m_prefetchChunks : 0;
+    size_t last = qMin(chunk + m_prefetchChunks, lastChunk);
+
+    /* the referred index moved away: cancel the loads not needed anymore */
+    for (auto it = m_loadTasks.begin(); it != m_loadTasks.end();)
     {
-        /* FIXME bad heuristic if the interval of visible items crosses a cache
-         * page boundary */
-        size_t offset = index - index % m_chunkSize;
-        size_t count = qMin(m_total_count - offset, m_chunkSize);
-        asyncLoad(offset, count);
+        if (it->first < first || it->first > last)
+            it = m_loadTasks.erase(it);
+        else
+            ++it;
+    }
+
+    /* load the referred chunk first, then its neighbours */
+    asyncLoad(chunk);
+    for (size_t i = 1; i <= m_prefetchChunks; ++i)
+    {
+        if (chunk + i <= last)
+            asyncLoad(chunk + i);
+        if (chunk >= first + i)
+            asyncLoad(chunk - i);
     }
 }
 
@@ -251,8 +294,7 @@ void ListCache<T>::onCountResult()
     CountTask<T> *task = static_cast<CountTask<T> *>(sender());
     assert(task == m_countTask.get());
 
-    m_offset = 0;
-    m_list.clear();
+    m_chunks.clear();
     m_total_count = static_cast<ssize_t>(task->takeResult());
     emit localSizeChanged(m_total_count);
 
@@ -285,27 +327,59 @@ private:
 };
 
 template <typename T>
-void ListCache<T>::asyncLoad(size_t offset, size_t count)
+void ListCache<T>::asyncLoad(size_t chunk)
 {
-    m_loadTask.reset(new LoadTask<T>(m_loader, offset, count));
-    connect(m_loadTask.get(), &BaseAsyncTask::result,
+    if (m_chunks.count(chunk) || m_loadTasks.count(chunk))
+        return;
+
+    size_t offset = chunk * m_chunkSize;
+    size_t count = qMin(m_total_count - offset, m_chunkSize);
+
+    TaskHandle<LoadTask<T>> task(new LoadTask<T>(m_loader, offset, count));
+    connect(task.get(), &BaseAsyncTask::result,
             this, &ListCache<T>::onLoadResult);
-    m_lastRangeRequested = { offset, count };
-    m_loadTask->start(m_threadPool);
+    task->start(m_threadPool);
+    m_loadTasks.emplace(chunk, std::move(task));
 }
 
 template <typename T>
 void ListCache<T>::onLoadResult()
 {
     LoadTask<T> *task = static_cast<LoadTask<T> *>(sender());
-    assert(task == m_loadTask.get());
+    size_t offset = task->m_offset;
+    size_t chunk = offset / m_chunkSize;
+
+    auto it = m_loadTasks.find(chunk);
+    assert(it != m_loadTasks.end() && it->second.get() == task);
 
-    m_offset = task->m_offset;
-    m_list = task->takeResult();
-    if (m_list.size())
-        emit localDataChanged(m_offset, m_list.size());
+    std::vector<T> list = task->takeResult();
+    size_t count = list.size();
+    m_loadTasks.erase(it);
+
+    m_chunks[chunk] = std::move(list);
+    evictChunks();
+
+    if (count)
+        emit localDataChanged(offset, count);
+}
 
-    m_loadTask.reset();
+template <typename T>
+void ListCache<T>::evictChunks()
+{
+    auto distance = [this](size_t chunk) {
+        return chunk > m_lastChunkReferred ? chunk - m_lastChunkReferred
+                                           : m_lastChunkReferred - chunk;
+    };
+
+    /* drop the chunks the farthest from the referred one */
+    while (m_chunks.size() > m_maxChunks)
+    {
+        if (distance(m_chunks.begin()->first)
+                >= distance(m_chunks.rbegin()->first))
+            m_chunks.erase(m_chunks.begin());
+        else
+            m_chunks.erase(std::prev(m_chunks.end()));
+    }
 }
 
 #endif
@@ -69,7 +69,9 @@ namespace
     }
 
     // images are cached (result of RoundImageGenerator) with the cost calculated from QImage::sizeInBytes
-    QCache<ImageCacheKey, QImage> imageCache(2 * 1024 * 1024); // 2 MiB
+    // the cache is shared by all the views, it must hold at least a few screens of grid covers so that
+    // scrolling back and forth does not decode them again
+    QCache<ImageCacheKey, QImage> imageCache(32 * 1024 * 1024); // 32 MiB
 
     QString getPath(const QUrl &url)
     {
@@ -401,12 +401,18 @@ void CtrlSliderBg::draw( OSGraphics &rImage, int xDest, int yDest, int w, int h
                  m_bgHeight - (int)(m_padVert * factorY) );
     rect clip( xDest, yDest, w, h );
     rect inter;
-    if( rect::intersect( region, clip, &inter ) )
-        rImage.drawBitmap( *m_pScaledBmp,
-                           x + inter.x - region.x,
-                           y + inter.y - region.y,
-                           inter.x, inter.y,
-                           inter.width, inter.height );
+    if( !rect::intersect( region, clip, &inter ) )
+        return;
+
+    // The position changes on every tick: reuse the graphics copy of the
+    // image sequence rather than converting the bitmap again
+    const OSGraphics *pGraphics = m_pScaledBmp->getGraphics();
+    if( pGraphics )
+        rImage.drawGraphics( *pGraphics,
+                             x + inter.x - region.x,
+                             y + inter.y - region.y,
+                             inter.x, inter.y,
+                             inter.width, inter.height );
 }
 
 
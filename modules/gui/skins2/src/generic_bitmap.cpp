@@ -22,6 +22,10 @@
 
 #include "generic_bitmap.hpp"
 #include "os_factory.hpp"
+#include "scaled_bitmap.hpp"
+
+/// Maximum number of scaled copies kept by a bitmap
+#define MAX_SCALED_BITMAPS 4
 
 
 GenericBitmap::GenericBitmap( intf_thread_t *pIntf,
@@ -31,6 +35,15 @@ GenericBitmap::GenericBitmap( intf_thread_t *pIntf,
 {
 }
 
+GenericBitmap::~GenericBitmap()
+{
+    delete m_pGraphics;
+
+    std::list<GenericBitmap*>::const_iterator it;
+    for( it = m_scaledList.begin(); it != m_scaledList.end(); ++it )
+        delete *it;
+}
+
 const OSGraphics *GenericBitmap::getGraphics() const
 {
     if( m_pGraphics )
@@ -51,6 +64,32 @@ const OSGraphics *GenericBitmap::getGraphics() const
     return NULL;
 }
 
+const GenericBitmap &GenericBitmap::getScaled( int width, int height ) const
+{
+    if( width == getWidth() && height == getHeight() )
+        return *this;
+
+    std::list<GenericBitmap*>::iterator it;
+    for( it = m_scaledList.begin(); it != m_scaledList.end(); ++it )
+    {
+        if( (*it)->getWidth() == width && (*it)->getHeight() == height )
+        {
+            // Move it to the front of the list
+            m_scaledList.splice( m_scaledList.begin(), m_scaledList, it );
+            return *m_scaledList.front();
+        }
+    }
+
+    m_scaledList.push_front( new ScaledBitmap( getIntf(), *this,
+                                               width, height ) );
+    if( m_scaledList.size() > MAX_SCALED_BITMAPS )
+    {
+        delete m_scaledList.back();
+        m_scaledList.pop_back();
+    }
+    return *m_scaledList.front();
+}
+
 
 BitmapImpl::BitmapImpl( intf_thread_t *pIntf, int width, int height,
                         int nbFrames, int fps, int nbLoops ):
@@ -29,12 +29,14 @@
 #include "../utils/pointer.hpp"
 #include "../utils/position.hpp"
 
+#include <list>
+
 
 /// Generic interface for bitmaps
 class GenericBitmap: public SkinObject, public Box
 {
 public:
-    virtual ~GenericBitmap() { delete m_pGraphics; }
+    virtual ~GenericBitmap();
 
     /// Get a linear buffer containing the image data.
     /// Each pixel is stored in 4 bytes in the order B,G,R,A
@@ -43,6 +45,14 @@ public:
     /// Get the bitmap as a graphics
     virtual const OSGraphics *getGraphics() const;
 
+    /// Get the bitmap scaled to the given size
+    /**
+     * The last scaled copies are cached, so that controls redrawn with the
+     * same size do not scale the bitmap again. The returned bitmap is owned
+     * by this bitmap, and is only valid until the next call.
+     */
+    const GenericBitmap &getScaled( int width, int height ) const;
+
     /// Get the number of frames in the bitmap
     int getNbFrames() const { return m_nbFrames; }
 
@@ -65,6 +75,8 @@ private:
 
     /// graphics copy of the bitmap
     mutable OSGraphics* m_pGraphics;
+    /// scaled copies of the bitmap, most recently used first
+    mutable std::list<GenericBitmap*> m_scaledList;
 };
 
 
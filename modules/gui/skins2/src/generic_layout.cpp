@@ -25,6 +25,7 @@
 #include "top_window.hpp"
 #include "os_factory.hpp"
 #include "os_graphics.hpp"
+#include "os_timer.hpp"
 #include "var_manager.hpp"
 #include "anchor.hpp"
 #include "../controls/ctrl_generic.hpp"
@@ -41,12 +42,15 @@ GenericLayout::GenericLayout( intf_thread_t *pIntf, int width, int height,
     m_rect( 0, 0, width, height ),
     m_minWidth( minWidth ), m_maxWidth( maxWidth ),
     m_minHeight( minHeight ), m_maxHeight( maxHeight ), m_pVideoCtrlSet(),
-    m_visible( false ), m_pVarActive( NULL )
+    m_visible( false ), m_pVarActive( NULL ), m_refreshPending( false ),
+    m_cmdRefresh( this )
 {
     // Get the OSFactory
     OSFactory *pOsFactory = OSFactory::instance( getIntf() );
     // Create the graphics buffer
     m_pImage = pOsFactory->createOSGraphics( width, height );
+    // Create the timer for the deferred refreshes
+    m_pTimer = pOsFactory->createOSTimer( m_cmdRefresh );
 
     // Create the "active layout" variable and register it in the manager
     m_pVarActive = new VarBoolImpl( pIntf );
@@ -56,6 +60,7 @@ GenericLayout::GenericLayout( intf_thread_t *pIntf, int width, int height,
 
 GenericLayout::~GenericLayout()
 {
+    delete m_pTimer;
     delete m_pImage;
 
     std::list<Anchor*>::const_iterator it;
@@ -165,7 +170,7 @@ void GenericLayout::onControlUpdate( const CtrlGeneric &rCtrl,
         rect inter;
         if( rect::intersect( layout, region, &inter ) )
         {
-            refreshRect( inter.x, inter.y, inter.width, inter.height );
+            invalidateRect( inter.x, inter.y, inter.width, inter.height );
         }
     }
 }
@@ -199,6 +204,11 @@ void GenericLayout::resize( int width, int height )
 
 void GenericLayout::refreshAll()
 {
+    // The pending portions are refreshed as well
+    m_pTimer->stop();
+    m_refreshPending = false;
+    m_dirtyRects.clear();
+
     refreshRect( 0, 0, m_rect.getWidth(), m_rect.getHeight() );
 }
 
@@ -209,6 +219,60 @@ void GenericLayout::refreshRect( int x, int y, int width, int height )
     if( !m_visible )
         return;
 
+    drawRect( x, y, width, height );
+
+    // Refresh the associated window
+    TopWindow *pWindow = getWindow();
+    if( pWindow )
+    {
+        // first apply new shape to the window
+        pWindow->updateShape();
+        pWindow->invalidateRect( x, y, width, height );
+    }
+}
+
+
+void GenericLayout::invalidateRect( int x, int y, int width, int height )
+{
+    // Do nothing if the layout is hidden
+    if( !m_visible )
+        return;
+
+    // Merge the new portion with the overlapping ones
+    rect dirty( x, y, width, height );
+    std::list<rect>::iterator it = m_dirtyRects.begin();
+    while( it != m_dirtyRects.end() )
+    {
+        if( !rect::areDisjunct( *it, dirty ) )
+        {
+            rect::join( *it, dirty, &dirty );
+            it = m_dirtyRects.erase( it );
+        }
+        else
+            ++it;
+    }
+
+    // Avoid spending more time in the bookkeeping than in the drawing
+    if( m_dirtyRects.size() >= 8 )
+    {
+        for( it = m_dirtyRects.begin(); it != m_dirtyRects.end(); ++it )
+            rect::join( *it, dirty, &dirty );
+        m_dirtyRects.clear();
+    }
+
+    m_dirtyRects.push_back( dirty );
+
+    // All the updates received during this delay are repainted at once
+    if( !m_refreshPending )
+    {
+        m_refreshPending = true;
+        m_pTimer->start( 10, false );
+    }
+}
+
+
+void GenericLayout::drawRect( int x, int y, int width, int height )
+{
     // update the transparency global mask
     m_pImage->clear( x, y, width, height );
 
@@ -222,14 +286,42 @@ void GenericLayout::refreshRect( int x, int y, int width, int height )
             pCtrl->draw( *m_pImage, x, y, width, height );
         }
     }
+}
 
-    // Refresh the associated window
-    TopWindow *pWindow = getWindow();
+
+void GenericLayout::CmdRefresh::execute()
+{
+    std::list<rect> dirtyRects;
+    dirtyRects.swap( m_pParent->m_dirtyRects );
+
+    // Controls updated while drawing will start the timer again
+    m_pParent->m_pTimer->stop();
+    m_pParent->m_refreshPending = false;
+
+    if( !m_pParent->m_visible )
+        return;
+
+    // The layout may have been resized meanwhile
+    rect layout( 0, 0, m_pParent->getWidth(), m_pParent->getHeight() );
+    std::list<rect>::iterator it;
+    for( it = dirtyRects.begin(); it != dirtyRects.end(); )
+    {
+        if( rect::intersect( layout, *it, &*it ) )
+        {
+            m_pParent->drawRect( it->x, it->y, it->width, it->height );
+            ++it;
+        }
+        else
+            it = dirtyRects.erase( it );
+    }
+
+    // Refresh the associated window, with a single shape update
+    TopWindow *pWindow = m_pParent->getWindow();
     if( pWindow )
     {
-        // first apply new shape to the window
         pWindow->updateShape();
-        pWindow->invalidateRect( x, y, width, height );
+        for( it = dirtyRects.begin(); it != dirtyRects.end(); ++it )
+            pWindow->invalidateRect( it->x, it->y, it->width, it->height );
     }
 }
 
@@ -257,6 +349,10 @@ void GenericLayout::onShow()
 void GenericLayout::onHide()
 {
     m_visible = false;
+
+    m_pTimer->stop();
+    m_refreshPending = false;
+    m_dirtyRects.clear();
 }
 
 
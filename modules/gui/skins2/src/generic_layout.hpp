@@ -26,6 +26,7 @@
 
 #include "skin_common.hpp"
 #include "top_window.hpp"
+#include "../commands/cmd_generic.hpp"
 #include "../utils/pointer.hpp"
 #include "../utils/position.hpp"
 
@@ -33,6 +34,7 @@
 
 class Anchor;
 class OSGraphics;
+class OSTimer;
 class CtrlGeneric;
 class CtrlVideo;
 class VarBoolImpl;
@@ -78,6 +80,10 @@ public:
     /// Refresh a rectangular portion of the window
     virtual void refreshRect( int x, int y, int width, int height );
 
+    /// Refresh a rectangular portion of the window later, together with
+    /// the other portions invalidated meanwhile
+    virtual void invalidateRect( int x, int y, int width, int height );
+
     /// Get the image of the layout
     virtual OSGraphics *getImage() const { return m_pImage; }
 
@@ -176,6 +182,17 @@ private:
      * layout). This way, we avoid using a setActiveLayoutInner method.
      */
     mutable VarBoolImpl *m_pVarActive;
+    /// Portions of the layout to refresh
+    std::list<rect> m_dirtyRects;
+    /// Timer to refresh the dirty portions
+    OSTimer *m_pTimer;
+    bool m_refreshPending;
+
+    /// Draw the controls in a rectangular portion of the image
+    void drawRect( int x, int y, int width, int height );
+
+    /// Callback to refresh the dirty portions
+    DEFINE_CALLBACK( GenericLayout, Refresh )
 };
 
 
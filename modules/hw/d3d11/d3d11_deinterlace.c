@@ -309,8 +309,7 @@ int D3D11OpenDeinterlace(filter_t *filter)
         if (!(rateCaps.ProcessorCaps & p_mode->i_mode))
             continue;
 
-        hr = ID3D11VideoDevice_CreateVideoProcessor(sys->d3d_proc.d3dviddev,
-                                                    sys->d3d_proc.procEnumerator, type, &sys->d3d_proc.videoProcessor);
+        hr = D3D11_CreateSharedProcessor(&sys->d3d_proc, type);
         if (SUCCEEDED(hr))
             break;
         sys->d3d_proc.videoProcessor = NULL;
@@ -326,8 +325,7 @@ int D3D11OpenDeinterlace(filter_t *filter)
             if (!(rateCaps.ProcessorCaps & D3D11_VIDEO_PROCESSOR_PROCESSOR_CAPS_DEINTERLACE_BOB))
                 continue;
 
-            hr = ID3D11VideoDevice_CreateVideoProcessor(sys->d3d_proc.d3dviddev,
-                                                        sys->d3d_proc.procEnumerator, type, &sys->d3d_proc.videoProcessor);
+            hr = D3D11_CreateSharedProcessor(&sys->d3d_proc, type);
             if (SUCCEEDED(hr))
                 break;
             sys->d3d_proc.videoProcessor = NULL;
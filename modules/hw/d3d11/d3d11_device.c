@@ -31,6 +31,7 @@
 #include <vlc_common.h>
 #include <vlc_codec.h>
 
+#define COBJMACROS
 #include "d3d11_filters.h"
 
 static void D3D11CloseDecoderDevice(vlc_decoder_device *device)
@@ -43,19 +44,70 @@ static const struct vlc_decoder_device_operations d3d11_dev_ops = {
     .close = D3D11CloseDecoderDevice,
 };
 
+#ifndef VLC_WINSTORE_APP
+/* Pick the adapter to balance the sessions on, NULL for the default one.
+ * The DXGI library must be kept loaded as long as the adapter is used. */
+static IDXGIAdapter *D3D11SelectAdapter(vlc_decoder_device *device, HMODULE *pdxgi)
+{
+    HRESULT (WINAPI *pf_CreateDXGIFactory1)(REFIID, void **);
+    IDXGIFactory1 *factory;
+    IDXGIAdapter1 *adapter = NULL;
+    UINT count = 0;
+
+    HMODULE dxgi = *pdxgi = LoadLibrary(TEXT("DXGI.DLL"));
+    if (dxgi == NULL)
+        return NULL;
+    pf_CreateDXGIFactory1 = (void *)GetProcAddress(dxgi, "CreateDXGIFactory1");
+    if (pf_CreateDXGIFactory1 == NULL ||
+        FAILED(pf_CreateDXGIFactory1(&IID_IDXGIFactory1, (void **)&factory)))
+        return NULL;
+
+    while (SUCCEEDED(IDXGIFactory1_EnumAdapters1(factory, count, &adapter)))
+    {
+        IDXGIAdapter1_Release(adapter);
+        count++;
+    }
+    adapter = NULL;
+
+    if (count > 1)
+    {
+        UINT idx = vlc_decoder_device_SelectAdapter(device, count);
+        if (idx > 0 && FAILED(IDXGIFactory1_EnumAdapters1(factory, idx, &adapter)))
+        {
+            msg_Warn(device, "can't get adapter %u", idx);
+            adapter = NULL;
+        }
+    }
+    IDXGIFactory1_Release(factory);
+    return (IDXGIAdapter *)adapter;
+}
+#endif
+
 static int D3D11OpenDecoderDevice(vlc_decoder_device *device, bool forced, vout_window_t *wnd)
 {
     VLC_UNUSED(wnd);
 
+    IDXGIAdapter *adapter = NULL;
+    device->type = VLC_DECODER_DEVICE_D3D11VA;
+#ifndef VLC_WINSTORE_APP
+    HMODULE dxgi = NULL;
+    adapter = D3D11SelectAdapter(device, &dxgi);
+#endif
+
     d3d11_decoder_device_t *dec_device;
-    dec_device = D3D11_CreateDevice( device, NULL, true /* is_d3d11_opaque(chroma) */,
+    dec_device = D3D11_CreateDevice( device, adapter, true /* is_d3d11_opaque(chroma) */,
                                           forced );
+    if (adapter != NULL)
+        IDXGIAdapter_Release(adapter);
+#ifndef VLC_WINSTORE_APP
+    if (dxgi != NULL)
+        FreeLibrary(dxgi);
+#endif
     if ( dec_device == NULL )
         return VLC_EGENERIC;
 
     device->ops = &d3d11_dev_ops;
     device->opaque = dec_device;
-    device->type = VLC_DECODER_DEVICE_D3D11VA;
     device->sys = NULL;
 
     return VLC_SUCCESS;
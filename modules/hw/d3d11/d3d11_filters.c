@@ -49,7 +49,6 @@
 #define D3D11_VIDEO_PROCESSOR_FILTER_CAPS_SATURATION   0x8
 #endif
 
-#define PROCESSOR_SLICES 2
 
 struct filter_level
 {
@@ -72,13 +71,6 @@ typedef struct
 
     d3d11_device_t                 *d3d_dev;
     d3d11_processor_t              d3d_proc;
-
-    union {
-        ID3D11Texture2D            *texture;
-        ID3D11Resource             *resource;
-    } out[PROCESSOR_SLICES];
-    ID3D11VideoProcessorInputView  *procInput[PROCESSOR_SLICES];
-    ID3D11VideoProcessorOutputView *procOutput[PROCESSOR_SLICES];
 } filter_sys_t;
 
 #define THRES_TEXT N_("Brightness threshold")
@@ -101,25 +93,58 @@ static const char *const ppsz_filter_options[] = {
     "brightness-threshold", NULL
 };
 
-static bool ApplyFilter( filter_sys_t *p_sys,
-                         D3D11_VIDEO_PROCESSOR_FILTER filter,
-                         struct filter_level *p_level,
-                         ID3D11VideoProcessorInputView *input,
-                         ID3D11VideoProcessorOutputView *output,
-                         const video_format_t *fmt)
+static bool SetFilter( filter_sys_t *p_sys,
+                       D3D11_VIDEO_PROCESSOR_FILTER filter,
+                       struct filter_level *p_level )
 {
-    HRESULT hr;
-
     int level = atomic_load(&p_level->level);
-    if (level == p_level->Range.Default)
-        return false;
+    bool enable = level != p_level->Range.Default;
 
+    /* the processor may be shared, always reset the filters we use */
     ID3D11VideoContext_VideoProcessorSetStreamFilter(p_sys->d3d_proc.d3dvidctx,
                                                      p_sys->d3d_proc.videoProcessor,
                                                      0,
                                                      filter,
-                                                     TRUE,
+                                                     enable,
                                                      level);
+    return enable;
+}
+
+static bool ApplyFilters( filter_t *p_filter,
+                          picture_sys_d3d11_t *p_src_sys,
+                          picture_sys_d3d11_t *p_out_sys )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *fmt = &p_filter->fmt_out.video;
+    HRESULT hr;
+
+    /* all the adjustments are done in a single pass */
+    bool enabled = false;
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_CONTRAST, &p_sys->Contrast );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_BRIGHTNESS, &p_sys->Brightness );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_HUE, &p_sys->Hue );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_SATURATION, &p_sys->Saturation );
+    if (!enabled)
+        return false;
+
+    if (p_out_sys->processorOutput == NULL)
+    {
+        D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
+            .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
+        };
+
+        hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(p_sys->d3d_proc.d3dviddev,
+                                                             p_out_sys->resource[KNOWN_DXGI_INDEX],
+                                                             p_sys->d3d_proc.procEnumerator,
+                                                             &outDesc,
+                                                             &p_out_sys->processorOutput);
+        if (FAILED(hr))
+        {
+            msg_Dbg(p_filter,"Failed to create processor output. (hr=0x%lX)", hr);
+            return false;
+        }
+    }
+
     ID3D11VideoContext_VideoProcessorSetStreamAutoProcessingMode(p_sys->d3d_proc.d3dvidctx,
                                                                  p_sys->d3d_proc.videoProcessor,
                                                                  0, FALSE);
@@ -136,11 +161,11 @@ static bool ApplyFilter( filter_sys_t *p_sys,
 
     D3D11_VIDEO_PROCESSOR_STREAM stream = {0};
     stream.Enable = TRUE;
-    stream.pInputSurface = input;
+    stream.pInputSurface = p_src_sys->processorInput;
 
     hr = ID3D11VideoContext_VideoProcessorBlt(p_sys->d3d_proc.d3dvidctx,
                                               p_sys->d3d_proc.videoProcessor,
-                                              output,
+                                              p_out_sys->processorOutput,
                                               0, 1, &stream);
     return SUCCEEDED(hr);
 }
@@ -239,57 +264,9 @@ static picture_t *Filter(filter_t *p_filter, picture_t *p_pic)
 
     picture_CopyProperties( p_outpic, p_pic );
 
-    ID3D11VideoProcessorInputView *inputs[4] = {
-        p_src_sys->processorInput,
-        p_sys->procInput[0],
-        p_sys->procInput[1],
-        p_sys->procInput[0]
-    };
-
-    ID3D11VideoProcessorOutputView *outputs[4] = {
-        p_sys->procOutput[0],
-        p_sys->procOutput[1],
-        p_sys->procOutput[0],
-        p_sys->procOutput[1]
-    };
-
     d3d11_device_lock( p_sys->d3d_dev );
 
-    size_t idx = 0, count = 0;
-    /* contrast */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_CONTRAST, &p_sys->Contrast,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* brightness */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_BRIGHTNESS, &p_sys->Brightness,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* hue */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_HUE, &p_sys->Hue,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* saturation */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_SATURATION, &p_sys->Saturation,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-
-    if (count == 0)
+    if ( !ApplyFilters( p_filter, p_src_sys, p_out_sys ) )
     {
         ID3D11DeviceContext_CopySubresourceRegion(p_sys->d3d_dev->d3dcontext,
                                                   p_out_sys->resource[KNOWN_DXGI_INDEX],
@@ -299,16 +276,6 @@ static picture_t *Filter(filter_t *p_filter, picture_t *p_pic)
                                                   p_src_sys->slice_index,
                                                   NULL);
     }
-    else
-    {
-        ID3D11DeviceContext_CopySubresourceRegion(p_sys->d3d_dev->d3dcontext,
-                                                  p_out_sys->resource[KNOWN_DXGI_INDEX],
-                                                  p_out_sys->slice_index,
-                                                  0, 0, 0,
-                                                  p_sys->out[outputs[idx] == p_sys->procOutput[0] ? 1 : 0].resource,
-                                                  0,
-                                                  NULL);
-    }
 
     d3d11_device_unlock( p_sys->d3d_dev );
 
@@ -347,15 +314,6 @@ static void D3D11CloseAdjust(filter_t *filter)
     var_DelCallback( filter, "brightness-threshold",
                                              AdjustCallback, sys );
 
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        if (sys->procInput[i])
-            ID3D11VideoProcessorInputView_Release(sys->procInput[i]);
-        if (sys->procOutput[i])
-            ID3D11VideoProcessorOutputView_Release(sys->procOutput[i]);
-    }
-    ID3D11Texture2D_Release(sys->out[0].texture);
-    ID3D11Texture2D_Release(sys->out[1].texture);
     D3D11_ReleaseProcessor( &sys->d3d_proc );
     vlc_video_context_Release(filter->vctx_out);
 
@@ -466,77 +424,13 @@ static int D3D11OpenAdjust(filter_t *filter)
     var_AddCallback( filter, "brightness-threshold",
                                              AdjustCallback, sys );
 
-    hr = ID3D11VideoDevice_CreateVideoProcessor(sys->d3d_proc.d3dviddev,
-                                                sys->d3d_proc.procEnumerator, 0,
-                                                &sys->d3d_proc.videoProcessor);
+    hr = D3D11_CreateSharedProcessor(&sys->d3d_proc, 0);
     if (FAILED(hr) || sys->d3d_proc.videoProcessor == NULL)
     {
         msg_Dbg(filter, "failed to create the processor");
         goto error;
     }
 
-    D3D11_TEXTURE2D_DESC texDesc;
-    ZeroMemory(&texDesc, sizeof(texDesc));
-    texDesc.MipLevels = 1;
-    texDesc.SampleDesc.Count = 1;
-    texDesc.MiscFlags = 0; //D3D11_RESOURCE_MISC_SHARED;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.CPUAccessFlags = 0;
-    texDesc.Format = format;
-    texDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.ArraySize = 1;
-    texDesc.Height = filter->fmt_out.video.i_height;
-    texDesc.Width  = filter->fmt_out.video.i_width;
-
-    hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &sys->out[0].texture );
-    if (FAILED(hr)) {
-        msg_Err(filter, "CreateTexture2D failed. (hr=0x%lX)", hr);
-        goto error;
-    }
-    hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &sys->out[1].texture );
-    if (FAILED(hr)) {
-        ID3D11Texture2D_Release(sys->out[0].texture);
-        msg_Err(filter, "CreateTexture2D failed. (hr=0x%lX)", hr);
-        goto error;
-    }
-
-    D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
-        .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
-    };
-
-    D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC inDesc = {
-        .FourCC = 0,
-        .ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D,
-        .Texture2D.MipSlice = 0,
-    };
-
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(sys->d3d_proc.d3dviddev,
-                                                             sys->out[i].resource,
-                                                             sys->d3d_proc.procEnumerator,
-                                                             &outDesc,
-                                                             &sys->procOutput[i]);
-        if (FAILED(hr))
-        {
-            msg_Dbg(filter,"Failed to create processor output. (hr=0x%lX)", hr);
-            goto error;
-        }
-
-        hr = ID3D11VideoDevice_CreateVideoProcessorInputView(sys->d3d_proc.d3dviddev,
-                                                             sys->out[i].resource,
-                                                             sys->d3d_proc.procEnumerator,
-                                                             &inDesc,
-                                                             &sys->procInput[i]);
-
-        if (FAILED(hr))
-        {
-            msg_Dbg(filter,"Failed to create processor input. (hr=0x%lX)", hr);
-            goto error;
-        }
-    }
-
     filter->ops = &filter_ops;
     filter->p_sys = sys;
     filter->vctx_out = vlc_video_context_Hold(filter->vctx_in);
@@ -544,18 +438,6 @@ static int D3D11OpenAdjust(filter_t *filter)
 
     return VLC_SUCCESS;
 error:
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        if (sys->procInput[i])
-            ID3D11VideoProcessorInputView_Release(sys->procInput[i]);
-        if (sys->procOutput[i])
-            ID3D11VideoProcessorOutputView_Release(sys->procOutput[i]);
-    }
-
-    if (sys->out[0].texture)
-        ID3D11Texture2D_Release(sys->out[0].texture);
-    if (sys->out[1].texture)
-        ID3D11Texture2D_Release(sys->out[1].texture);
     D3D11_ReleaseProcessor(&sys->d3d_proc);
     d3d11_device_unlock(sys->d3d_dev);
     free(sys);
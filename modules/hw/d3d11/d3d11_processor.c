@@ -26,6 +26,7 @@
 
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_vector.h>
 
 #include <assert.h>
 
@@ -36,6 +37,107 @@
 #include "d3d11_processor.h"
 
 #if defined(ID3D11VideoContext_VideoProcessorBlt)
+#define MAX_SHARED_PROCESSORS 8
+
+/* Processors are shared between the filter instances using the same device
+ * with the same content description. Each user programs the stream state it
+ * needs before every Blt, under the device lock. */
+struct d3d11_shared_processor
+{
+    ID3D11Device                       *d3ddevice;
+    D3D11_VIDEO_PROCESSOR_CONTENT_DESC desc;
+    ID3D11VideoProcessorEnumerator     *procEnumerator;
+    ID3D11VideoProcessor               *videoProcessor[MAX_SHARED_PROCESSORS];
+    unsigned                           refs;
+};
+
+static vlc_mutex_t shared_lock = VLC_STATIC_MUTEX;
+static struct VLC_VECTOR(struct d3d11_shared_processor *) shared_procs =
+    VLC_VECTOR_INITIALIZER;
+
+static struct d3d11_shared_processor *
+FindSharedProcessor(ID3D11VideoProcessorEnumerator *procEnumerator, size_t *idx)
+{
+    for (size_t i = 0; i < shared_procs.size; i++)
+        if (shared_procs.data[i]->procEnumerator == procEnumerator)
+        {
+            if (idx != NULL)
+                *idx = i;
+            return shared_procs.data[i];
+        }
+    return NULL;
+}
+
+static ID3D11VideoProcessorEnumerator *
+HoldSharedEnumerator(ID3D11Device *d3ddevice,
+                     const D3D11_VIDEO_PROCESSOR_CONTENT_DESC *desc)
+{
+    ID3D11VideoProcessorEnumerator *procEnumerator = NULL;
+
+    vlc_mutex_lock(&shared_lock);
+    for (size_t i = 0; i < shared_procs.size; i++)
+    {
+        struct d3d11_shared_processor *shared = shared_procs.data[i];
+        if (shared->d3ddevice == d3ddevice &&
+            !memcmp(&shared->desc, desc, sizeof (*desc)))
+        {
+            shared->refs++;
+            procEnumerator = shared->procEnumerator;
+            ID3D11VideoProcessorEnumerator_AddRef(procEnumerator);
+            break;
+        }
+    }
+    vlc_mutex_unlock(&shared_lock);
+    return procEnumerator;
+}
+
+static void AddSharedEnumerator(ID3D11Device *d3ddevice,
+                                const D3D11_VIDEO_PROCESSOR_CONTENT_DESC *desc,
+                                ID3D11VideoProcessorEnumerator *procEnumerator)
+{
+    struct d3d11_shared_processor *shared = calloc(1, sizeof (*shared));
+    if (unlikely(shared == NULL))
+        return; /* not shared */
+
+    shared->d3ddevice = d3ddevice;
+    shared->desc = *desc;
+    shared->procEnumerator = procEnumerator;
+    shared->refs = 1;
+
+    vlc_mutex_lock(&shared_lock);
+    if (vlc_vector_push(&shared_procs, shared))
+    {
+        ID3D11Device_AddRef(d3ddevice);
+        ID3D11VideoProcessorEnumerator_AddRef(procEnumerator);
+    }
+    else
+        free(shared);
+    vlc_mutex_unlock(&shared_lock);
+}
+
+static void ReleaseSharedEnumerator(ID3D11VideoProcessorEnumerator *procEnumerator)
+{
+    size_t idx;
+
+    vlc_mutex_lock(&shared_lock);
+    struct d3d11_shared_processor *shared = FindSharedProcessor(procEnumerator, &idx);
+    if (shared != NULL && --shared->refs == 0)
+        vlc_vector_remove(&shared_procs, idx);
+    else
+        shared = NULL;
+    vlc_mutex_unlock(&shared_lock);
+
+    if (shared == NULL)
+        return;
+
+    for (size_t i = 0; i < ARRAY_SIZE(shared->videoProcessor); i++)
+        if (shared->videoProcessor[i])
+            ID3D11VideoProcessor_Release(shared->videoProcessor[i]);
+    ID3D11VideoProcessorEnumerator_Release(shared->procEnumerator);
+    ID3D11Device_Release(shared->d3ddevice);
+    free(shared);
+}
+
 #ifndef NDEBUG
 static void LogProcessorSupport(vlc_object_t *o,
                                 ID3D11VideoProcessorEnumerator *processorEnumerator)
@@ -103,16 +205,22 @@ int D3D11_CreateProcessor(vlc_object_t *o, d3d11_device_t *d3d_dev,
         },
         .Usage = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL,
     };
+    out->procEnumerator = HoldSharedEnumerator(d3d_dev->d3ddevice, &processorDesc);
+    if (out->procEnumerator != NULL)
+        return VLC_SUCCESS;
+
     hr = ID3D11VideoDevice_CreateVideoProcessorEnumerator(out->d3dviddev, &processorDesc, &out->procEnumerator);
     if ( FAILED(hr) || out->procEnumerator == NULL )
     {
         msg_Dbg(o, "Can't get a video processor for the video.");
+        out->procEnumerator = NULL;
         goto error;
     }
 
 #ifndef NDEBUG
     LogProcessorSupport(o, out->procEnumerator);
 #endif
+    AddSharedEnumerator(d3d_dev->d3ddevice, &processorDesc, out->procEnumerator);
 
     return VLC_SUCCESS;
 error:
@@ -129,6 +237,7 @@ void D3D11_ReleaseProcessor(d3d11_processor_t *out)
     }
     if (out->procEnumerator)
     {
+        ReleaseSharedEnumerator(out->procEnumerator);
         ID3D11VideoProcessorEnumerator_Release(out->procEnumerator);
         out->procEnumerator = NULL;
     }
@@ -144,6 +253,41 @@ void D3D11_ReleaseProcessor(d3d11_processor_t *out)
     }
 }
 
+HRESULT D3D11_CreateSharedProcessor(d3d11_processor_t *d3d_proc, UINT rateConversionIndex)
+{
+    ID3D11VideoProcessor *videoProcessor = NULL;
+    HRESULT hr;
+
+    assert(d3d_proc->videoProcessor == NULL);
+
+    vlc_mutex_lock(&shared_lock);
+    struct d3d11_shared_processor *shared = FindSharedProcessor(d3d_proc->procEnumerator, NULL);
+    if (shared != NULL && rateConversionIndex < ARRAY_SIZE(shared->videoProcessor))
+        videoProcessor = shared->videoProcessor[rateConversionIndex];
+
+    if (videoProcessor != NULL)
+    {
+        ID3D11VideoProcessor_AddRef(videoProcessor);
+        hr = S_OK;
+    }
+    else
+    {
+        hr = ID3D11VideoDevice_CreateVideoProcessor(d3d_proc->d3dviddev, d3d_proc->procEnumerator,
+                                                    rateConversionIndex, &videoProcessor);
+        if (SUCCEEDED(hr) && shared != NULL &&
+            rateConversionIndex < ARRAY_SIZE(shared->videoProcessor))
+        {
+            ID3D11VideoProcessor_AddRef(videoProcessor);
+            shared->videoProcessor[rateConversionIndex] = videoProcessor;
+        }
+    }
+    vlc_mutex_unlock(&shared_lock);
+
+    if (SUCCEEDED(hr))
+        d3d_proc->videoProcessor = videoProcessor;
+    return hr;
+}
+
 #undef D3D11_Assert_ProcessorInput
 HRESULT D3D11_Assert_ProcessorInput(vlc_object_t *o, d3d11_processor_t *d3d_proc, picture_sys_d3d11_t *p_sys)
 {
@@ -44,6 +44,14 @@ int D3D11_CreateProcessor(vlc_object_t *, d3d11_device_t *,
 
 void D3D11_ReleaseProcessor(d3d11_processor_t *);
 
+/**
+ * Get a video processor shared with the other users of the same enumerator.
+ *
+ * The stream state of a shared processor is not preserved between calls: it
+ * must be set before each VideoProcessorBlt, with the device locked.
+ */
+HRESULT D3D11_CreateSharedProcessor(d3d11_processor_t *, UINT rateConversionIndex);
+
 HRESULT D3D11_Assert_ProcessorInput(vlc_object_t *, d3d11_processor_t *, picture_sys_d3d11_t *);
 #define D3D11_Assert_ProcessorInput(a,b,c) D3D11_Assert_ProcessorInput(VLC_OBJECT(a),b,c)
 #endif
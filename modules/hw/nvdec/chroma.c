@@ -30,8 +30,10 @@
 #include <vlc_codec.h>
 
 #include "nvdec_fmt.h"
+#include "hw_pool.h"
 
 static int OpenCUDAToCPU( filter_t * );
+static int OpenCUDAScale( filter_t * );
 
 vlc_module_begin()
     set_shortname(N_("CUDA converter"))
@@ -39,6 +41,9 @@ vlc_module_begin()
     set_category(CAT_VIDEO)
     set_subcategory(SUBCAT_VIDEO_VFILTER)
     set_callback_video_converter(OpenCUDAToCPU, 10)
+    add_submodule()
+        set_description(N_("CUDA/NVDEC scaling filter"))
+        set_callback_video_converter(OpenCUDAScale, 10)
 vlc_module_end()
 
 #define CALL_CUDA(func, ...) CudaCheckErr(VLC_OBJECT(p_filter), devsys->cudaFunctions, devsys->cudaFunctions->func(__VA_ARGS__), #func)
@@ -142,3 +147,382 @@ static int OpenCUDAToCPU( filter_t *p_filter )
 
     return VLC_SUCCESS;
 }
+
+/* scaling */
+
+#define SCALE_POOL_SIZE  10
+
+/* Bilinear resize of one plane, each thread writes one component of one
+ * pixel. Interleaved planes (NV12 UV) use comps=2. */
+#define RESIZE_KERNEL(name, type, shift) \
+    ".visible .entry " name "(\n" \
+    "    .param .u64 src, .param .u32 src_pitch,\n" \
+    "    .param .u32 src_w, .param .u32 src_h,\n" \
+    "    .param .u64 dst, .param .u32 dst_pitch,\n" \
+    "    .param .u32 dst_w, .param .u32 dst_h,\n" \
+    "    .param .u32 comps)\n" \
+    "{\n" \
+    "    .reg .pred %p<4>;\n" \
+    "    .reg .u32 %r<32>;\n" \
+    "    .reg .u64 %rd<12>;\n" \
+    "    .reg .f32 %f<20>;\n" \
+    "    mov.u32 %r1, %ctaid.x;\n" \
+    "    mov.u32 %r2, %ntid.x;\n" \
+    "    mov.u32 %r3, %tid.x;\n" \
+    "    mad.lo.u32 %r4, %r1, %r2, %r3;\n" \
+    "    mov.u32 %r1, %ctaid.y;\n" \
+    "    mov.u32 %r2, %ntid.y;\n" \
+    "    mov.u32 %r3, %tid.y;\n" \
+    "    mad.lo.u32 %r5, %r1, %r2, %r3;\n" \
+    "    ld.param.u32 %r6, [dst_w];\n" \
+    "    ld.param.u32 %r7, [dst_h];\n" \
+    "    ld.param.u32 %r8, [comps];\n" \
+    "    mul.lo.u32 %r9, %r6, %r8;\n" \
+    "    setp.ge.u32 %p1, %r4, %r9;\n" \
+    "    setp.ge.u32 %p2, %r5, %r7;\n" \
+    "    or.pred %p3, %p1, %p2;\n" \
+    "    @%p3 bra DONE;\n" \
+    "    div.u32 %r10, %r4, %r8;\n" \
+    "    rem.u32 %r11, %r4, %r8;\n" \
+    "    ld.param.u32 %r12, [src_w];\n" \
+    "    ld.param.u32 %r13, [src_h];\n" \
+    /* x0, x1 and the horizontal weight */ \
+    "    cvt.rn.f32.u32 %f1, %r10;\n" \
+    "    add.f32 %f1, %f1, 0f3F000000;\n" \
+    "    cvt.rn.f32.u32 %f2, %r12;\n" \
+    "    cvt.rn.f32.u32 %f3, %r6;\n" \
+    "    div.rn.f32 %f4, %f2, %f3;\n" \
+    "    mul.f32 %f1, %f1, %f4;\n" \
+    "    sub.f32 %f1, %f1, 0f3F000000;\n" \
+    "    max.f32 %f1, %f1, 0f00000000;\n" \
+    "    cvt.rmi.f32.f32 %f5, %f1;\n" \
+    "    sub.f32 %f6, %f1, %f5;\n" \
+    "    cvt.rzi.u32.f32 %r14, %f5;\n" \
+    "    sub.u32 %r15, %r12, 1;\n" \
+    "    min.u32 %r14, %r14, %r15;\n" \
+    "    add.u32 %r16, %r14, 1;\n" \
+    "    min.u32 %r16, %r16, %r15;\n" \
+    /* y0, y1 and the vertical weight */ \
+    "    cvt.rn.f32.u32 %f7, %r5;\n" \
+    "    add.f32 %f7, %f7, 0f3F000000;\n" \
+    "    cvt.rn.f32.u32 %f2, %r13;\n" \
+    "    cvt.rn.f32.u32 %f3, %r7;\n" \
+    "    div.rn.f32 %f4, %f2, %f3;\n" \
+    "    mul.f32 %f7, %f7, %f4;\n" \
+    "    sub.f32 %f7, %f7, 0f3F000000;\n" \
+    "    max.f32 %f7, %f7, 0f00000000;\n" \
+    "    cvt.rmi.f32.f32 %f8, %f7;\n" \
+    "    sub.f32 %f9, %f7, %f8;\n" \
+    "    cvt.rzi.u32.f32 %r17, %f8;\n" \
+    "    sub.u32 %r18, %r13, 1;\n" \
+    "    min.u32 %r17, %r17, %r18;\n" \
+    "    add.u32 %r19, %r17, 1;\n" \
+    "    min.u32 %r19, %r19, %r18;\n" \
+    /* load the 4 neighbours */ \
+    "    mad.lo.u32 %r20, %r14, %r8, %r11;\n" \
+    "    mad.lo.u32 %r21, %r16, %r8, %r11;\n" \
+    "    shl.b32 %r20, %r20, " shift ";\n" \
+    "    shl.b32 %r21, %r21, " shift ";\n" \
+    "    ld.param.u64 %rd1, [src];\n" \
+    "    ld.param.u32 %r22, [src_pitch];\n" \
+    "    mul.wide.u32 %rd2, %r17, %r22;\n" \
+    "    add.u64 %rd2, %rd1, %rd2;\n" \
+    "    mul.wide.u32 %rd3, %r19, %r22;\n" \
+    "    add.u64 %rd3, %rd1, %rd3;\n" \
+    "    cvt.u64.u32 %rd4, %r20;\n" \
+    "    cvt.u64.u32 %rd5, %r21;\n" \
+    "    add.u64 %rd6, %rd2, %rd4;\n" \
+    "    add.u64 %rd7, %rd2, %rd5;\n" \
+    "    add.u64 %rd8, %rd3, %rd4;\n" \
+    "    add.u64 %rd9, %rd3, %rd5;\n" \
+    "    ld.global." type " %r23, [%rd6];\n" \
+    "    ld.global." type " %r24, [%rd7];\n" \
+    "    ld.global." type " %r25, [%rd8];\n" \
+    "    ld.global." type " %r26, [%rd9];\n" \
+    "    cvt.rn.f32.u32 %f10, %r23;\n" \
+    "    cvt.rn.f32.u32 %f11, %r24;\n" \
+    "    cvt.rn.f32.u32 %f12, %r25;\n" \
+    "    cvt.rn.f32.u32 %f13, %r26;\n" \
+    "    sub.f32 %f14, %f11, %f10;\n" \
+    "    fma.rn.f32 %f14, %f14, %f6, %f10;\n" \
+    "    sub.f32 %f15, %f13, %f12;\n" \
+    "    fma.rn.f32 %f15, %f15, %f6, %f12;\n" \
+    "    sub.f32 %f16, %f15, %f14;\n" \
+    "    fma.rn.f32 %f16, %f16, %f9, %f14;\n" \
+    "    cvt.rni.u32.f32 %r27, %f16;\n" \
+    /* store */ \
+    "    ld.param.u64 %rd10, [dst];\n" \
+    "    ld.param.u32 %r28, [dst_pitch];\n" \
+    "    mul.wide.u32 %rd11, %r5, %r28;\n" \
+    "    add.u64 %rd10, %rd10, %rd11;\n" \
+    "    shl.b32 %r29, %r4, " shift ";\n" \
+    "    cvt.u64.u32 %rd11, %r29;\n" \
+    "    add.u64 %rd10, %rd10, %rd11;\n" \
+    "    st.global." type " [%rd10], %r27;\n" \
+    "DONE:\n" \
+    "    ret;\n" \
+    "}\n"
+
+static const char resize_ptx[] =
+    ".version 6.0\n"
+    ".target sm_30\n"
+    ".address_size 64\n"
+    RESIZE_KERNEL("resize_u8", "u8", "0")
+    RESIZE_KERNEL("resize_u16", "u16", "1");
+
+typedef struct
+{
+    CUmodule        module;
+    CUfunction      resize;
+    unsigned        pixel_size;
+    unsigned        pitch;
+    nvdec_pool_t    *pool;
+} filter_sys_t;
+
+typedef struct
+{
+    pic_context_nvdec_t ctx;
+    nvdec_pool_t        *pool;
+} pic_scale_context_t;
+
+#define SCALE_PICCTX_FROM_PICCTX(pic_ctx)  \
+    container_of(NVDEC_PICCONTEXT_FROM_PICCTX(pic_ctx), pic_scale_context_t, ctx)
+
+static void ScaleCtxDestroy(picture_context_t *picctx)
+{
+    pic_scale_context_t *pic = SCALE_PICCTX_FROM_PICCTX(picctx);
+    nvdec_pool_Release(pic->pool);
+    free(pic);
+}
+
+static picture_context_t *ScaleCtxClone(picture_context_t *srcctx)
+{
+    pic_scale_context_t *clone = malloc(sizeof(*clone));
+    if (unlikely(clone == NULL))
+        return NULL;
+
+    *clone = *SCALE_PICCTX_FROM_PICCTX(srcctx);
+    vlc_video_context_Hold(clone->ctx.ctx.vctx);
+    nvdec_pool_AddRef(clone->pool);
+    return &clone->ctx.ctx;
+}
+
+static void ScalePoolRelease(nvdec_pool_owner_t *owner, void *buffers[], size_t pics_count)
+{
+    vlc_decoder_device *dec_dev = vlc_video_context_HoldDevice(owner->sys);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(dec_dev);
+
+    devsys->cudaFunctions->cuCtxPushCurrent(devsys->cuCtx);
+    for (size_t i=0; i < pics_count; i++)
+        devsys->cudaFunctions->cuMemFree((CUdeviceptr)buffers[i]);
+    devsys->cudaFunctions->cuCtxPopCurrent(NULL);
+    vlc_decoder_device_Release(dec_dev);
+}
+
+static picture_context_t *ScalePoolAttach(nvdec_pool_owner_t *owner, nvdec_pool_t *pool, void *surface)
+{
+    pic_scale_context_t *pic = malloc(sizeof(*pic));
+    if (unlikely(pic == NULL))
+        return NULL;
+
+    pic->ctx.ctx = (picture_context_t) {
+        ScaleCtxDestroy, ScaleCtxClone, owner->sys,
+    };
+    vlc_video_context_Hold(pic->ctx.ctx.vctx);
+    pic->ctx.devicePtr = (CUdeviceptr)surface;
+    /* the pitch and lines are set by the filter */
+    pic->ctx.bufferPitch = 0;
+    pic->ctx.bufferHeight = 0;
+    pic->pool = pool;
+    nvdec_pool_AddRef(pool);
+    return &pic->ctx.ctx;
+}
+
+static int ResizePlane(filter_t *p_filter, decoder_device_nvdec_t *devsys,
+                       CUdeviceptr src, unsigned src_pitch, unsigned src_w, unsigned src_h,
+                       CUdeviceptr dst, unsigned dst_pitch, unsigned dst_w, unsigned dst_h,
+                       unsigned comps)
+{
+    filter_sys_t *sys = p_filter->p_sys;
+    void *args[] = {
+        &src, &src_pitch, &src_w, &src_h,
+        &dst, &dst_pitch, &dst_w, &dst_h,
+        &comps,
+    };
+    const unsigned block_w = 32, block_h = 8;
+
+    return CALL_CUDA(cuLaunchKernel, sys->resize,
+                     (dst_w * comps + block_w - 1) / block_w,
+                     (dst_h + block_h - 1) / block_h, 1,
+                     block_w, block_h, 1, 0, 0, args, NULL);
+}
+
+static picture_t *FilterCUDAScale(filter_t *p_filter, picture_t *src)
+{
+    filter_sys_t *sys = p_filter->p_sys;
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    picture_t *dst = nvdec_pool_Wait(sys->pool);
+    if (unlikely(dst == NULL))
+    {
+        picture_Release(src);
+        return NULL;
+    }
+
+    pic_context_nvdec_t *srcpic = NVDEC_PICCONTEXT_FROM_PICCTX(src->context);
+    pic_context_nvdec_t *dstpic = NVDEC_PICCONTEXT_FROM_PICCTX(dst->context);
+    dstpic->bufferPitch = sys->pitch;
+    dstpic->bufferHeight = fmt_out->i_height;
+
+    vlc_decoder_device *dec_dev = vlc_video_context_HoldDevice(p_filter->vctx_in);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(dec_dev);
+
+    int result = CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx);
+    if (result != VLC_SUCCESS)
+        goto error;
+
+    /* luma, then the interleaved chroma at half resolution */
+    for (unsigned plane = 0; plane < 2 && result == VLC_SUCCESS; plane++)
+    {
+        const unsigned sub = plane ? 2 : 1;
+        CUdeviceptr src_ptr = srcpic->devicePtr
+            + (size_t)srcpic->bufferPitch * (plane * srcpic->bufferHeight + fmt_in->i_y_offset / sub)
+            + (size_t)fmt_in->i_x_offset / sub * sub * sys->pixel_size;
+        CUdeviceptr dst_ptr = dstpic->devicePtr
+            + (size_t)dstpic->bufferPitch * plane * dstpic->bufferHeight;
+
+        result = ResizePlane(p_filter, devsys,
+                             src_ptr, srcpic->bufferPitch,
+                             fmt_in->i_visible_width / sub, fmt_in->i_visible_height / sub,
+                             dst_ptr, dstpic->bufferPitch,
+                             fmt_out->i_width / sub, fmt_out->i_height / sub,
+                             sub);
+    }
+
+    // the source may only be released once the kernels are done with it
+    int sync_result = CALL_CUDA(cuStreamSynchronize, 0);
+    if (result == VLC_SUCCESS)
+        result = sync_result;
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+    if (result != VLC_SUCCESS)
+        goto error;
+
+    picture_CopyProperties(dst, src);
+    picture_Release(src);
+    vlc_decoder_device_Release(dec_dev);
+    return dst;
+
+error:
+    picture_Release(dst);
+    picture_Release(src);
+    vlc_decoder_device_Release(dec_dev);
+    return NULL;
+}
+
+static void CloseCUDAScale(filter_t *p_filter)
+{
+    filter_sys_t *sys = p_filter->p_sys;
+    vlc_decoder_device *dec_dev = vlc_video_context_HoldDevice(p_filter->vctx_in);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(dec_dev);
+
+    nvdec_pool_Release(sys->pool);
+    CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx);
+    CALL_CUDA(cuModuleUnload, sys->module);
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+    vlc_decoder_device_Release(dec_dev);
+    vlc_video_context_Release(p_filter->vctx_out);
+    free(sys);
+}
+
+static const struct vlc_filter_operations scale_ops = {
+    .filter_video = FilterCUDAScale, .close = CloseCUDAScale,
+};
+
+static int OpenCUDAScale( filter_t *p_filter )
+{
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    if ( p_filter->vctx_in == NULL ||
+         vlc_video_context_GetType(p_filter->vctx_in) != VLC_VIDEO_CONTEXT_NVDEC )
+        return VLC_EGENERIC;
+    if ( fmt_in->i_chroma != fmt_out->i_chroma ||
+         ( fmt_in->i_chroma != VLC_CODEC_NVDEC_OPAQUE &&
+           fmt_in->i_chroma != VLC_CODEC_NVDEC_OPAQUE_10B &&
+           fmt_in->i_chroma != VLC_CODEC_NVDEC_OPAQUE_16B ) )
+        return VLC_EGENERIC;
+    if ( fmt_in->orientation != fmt_out->orientation ||
+         fmt_out->i_width == 0 || fmt_out->i_height == 0 ||
+         fmt_out->i_x_offset != 0 || fmt_out->i_y_offset != 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = malloc(sizeof(*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+    p_filter->p_sys = sys;
+    sys->pixel_size = fmt_in->i_chroma == VLC_CODEC_NVDEC_OPAQUE ? 1 : 2;
+    sys->pitch = ((fmt_out->i_width * sys->pixel_size) + 255) & ~255;
+
+    vlc_decoder_device *dec_dev = vlc_video_context_HoldDevice(p_filter->vctx_in);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(dec_dev);
+
+    int result = CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx);
+    if (result != VLC_SUCCESS)
+        goto error;
+
+    result = CALL_CUDA(cuModuleLoadData, &sys->module, resize_ptx);
+    if (result != VLC_SUCCESS)
+        goto pop;
+    result = CALL_CUDA(cuModuleGetFunction, &sys->resize, sys->module,
+                       sys->pixel_size == 1 ? "resize_u8" : "resize_u16");
+    if (result != VLC_SUCCESS)
+        goto unload;
+
+    /* NV12 like surfaces: the chroma plane is half the luma height */
+    const size_t surface_size = (size_t)sys->pitch * (fmt_out->i_height + fmt_out->i_height / 2);
+    void *buffers[SCALE_POOL_SIZE];
+    for (size_t i=0; i < ARRAY_SIZE(buffers); i++)
+    {
+        CUdeviceptr ptr;
+        result = CALL_CUDA(cuMemAlloc, &ptr, surface_size);
+        if (result != VLC_SUCCESS)
+        {
+            while (i)
+                CALL_CUDA(cuMemFree, (CUdeviceptr)buffers[--i]);
+            goto unload;
+        }
+        buffers[i] = (void *)(uintptr_t)ptr;
+    }
+
+    const nvdec_pool_owner_t owner = {
+        p_filter->vctx_in, surface_size, ScalePoolRelease, ScalePoolAttach,
+    };
+    sys->pool = nvdec_pool_Create(&owner, fmt_out, p_filter->vctx_in,
+                                  buffers, ARRAY_SIZE(buffers));
+    if (sys->pool == NULL)
+    {
+        for (size_t i=0; i < ARRAY_SIZE(buffers); i++)
+            CALL_CUDA(cuMemFree, (CUdeviceptr)buffers[i]);
+        result = VLC_ENOMEM;
+        goto unload;
+    }
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+    vlc_decoder_device_Release(dec_dev);
+
+    msg_Dbg(p_filter, "scaling %ux%u to %ux%u on the GPU",
+            fmt_in->i_visible_width, fmt_in->i_visible_height,
+            fmt_out->i_width, fmt_out->i_height);
+    p_filter->ops = &scale_ops;
+    p_filter->vctx_out = vlc_video_context_Hold(p_filter->vctx_in);
+    return VLC_SUCCESS;
+
+unload:
+    CALL_CUDA(cuModuleUnload, sys->module);
+pop:
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+error:
+    vlc_decoder_device_Release(dec_dev);
+    free(sys);
+    return result;
+}
@@ -32,7 +32,7 @@
 struct nvdec_pool_t {
     vlc_video_context           *vctx;
 
-    nvdec_pool_owner_t          *owner;
+    nvdec_pool_owner_t          owner;
 
     void                        *res[64];
     size_t                      pool_size;
@@ -52,13 +52,14 @@ void nvdec_pool_Release(nvdec_pool_t *pool)
     if (!vlc_atomic_rc_dec(&pool->rc))
         return;
 
-    pool->owner->release_resources(pool->owner, pool->res, pool->pool_size);
+    pool->owner.release_resources(&pool->owner, pool->res, pool->pool_size);
 
     picture_pool_Release(pool->picture_pool);
     vlc_video_context_Release(pool->vctx);
+    free(pool);
 }
 
-nvdec_pool_t* nvdec_pool_Create(nvdec_pool_owner_t *owner,
+nvdec_pool_t* nvdec_pool_Create(const nvdec_pool_owner_t *owner,
                                 const video_format_t *fmt, vlc_video_context *vctx,
                                 void *buffers[], size_t pics_count)
 {
@@ -84,7 +85,7 @@ nvdec_pool_t* nvdec_pool_Create(nvdec_pool_owner_t *owner,
     if (!pool->picture_pool)
         goto free_pool;
 
-    pool->owner = owner;
+    pool->owner = *owner;
     pool->vctx = vctx;
     pool->pool_size = pics_count;
     vlc_video_context_Hold(pool->vctx);
@@ -111,7 +112,7 @@ picture_t* nvdec_pool_Wait(nvdec_pool_t *pool)
 
     void *surface = pic->p_sys;
     pic->p_sys = NULL;
-    pic->context = pool->owner->attach_picture(pool->owner, pool, surface);
+    pic->context = pool->owner.attach_picture(&pool->owner, pool, surface);
     if (likely(pic->context != NULL))
         return pic;
 
@@ -30,11 +30,18 @@ typedef struct nvdec_pool_owner  nvdec_pool_owner_t;
 struct nvdec_pool_owner
 {
     void *sys;
+    size_t buffer_size;
     void (*release_resources)(nvdec_pool_owner_t *, void *buffers[], size_t pics_count);
     picture_context_t * (*attach_picture)(nvdec_pool_owner_t *, nvdec_pool_t *, void *surface);
 };
 
-nvdec_pool_t* nvdec_pool_Create(nvdec_pool_owner_t *,
+/**
+ * Create a pool of pictures using the given buffers.
+ *
+ * The owner is copied, its callbacks are called until the pool is released,
+ * which may happen after the creator is gone.
+ */
+nvdec_pool_t* nvdec_pool_Create(const nvdec_pool_owner_t *,
                                 const video_format_t *, vlc_video_context *,
                                 void *buffers[], size_t pics_count);
 void nvdec_pool_AddRef(nvdec_pool_t *);
@@ -107,7 +107,6 @@ struct nvdec_ctx {
 
     unsigned int                outputPitch;
     nvdec_pool_t                *out_pool;
-    nvdec_pool_owner_t          pool_owner;
 
     vlc_video_context           *vctx_out;
 };
@@ -119,13 +118,74 @@ struct nvdec_ctx {
 #define NVDEC_PICPOOLCTX_FROM_PICCTX(pic_ctx)  \
     container_of(NVDEC_PICCONTEXT_FROM_PICCTX(pic_ctx), pic_pool_context_nvdec_t, ctx)
 
+static void FreeSurfaces(decoder_device_nvdec_t *devsys, const CUdeviceptr ptrs[], size_t count)
+{
+    if (count == 0)
+        return;
+    devsys->cudaFunctions->cuCtxPushCurrent(devsys->cuCtx);
+    for (size_t i=0; i < count; i++)
+        devsys->cudaFunctions->cuMemFree(ptrs[i]);
+    devsys->cudaFunctions->cuCtxPopCurrent(NULL);
+}
+
+static size_t TakeCachedSurfaces(decoder_device_nvdec_t *devsys, size_t size,
+                                 CUdeviceptr ptrs[], size_t count)
+{
+    size_t taken = 0;
+
+    vlc_mutex_lock(&devsys->cache_lock);
+    for (size_t i=0; i < devsys->cache_count && taken < count; )
+    {
+        /* don't hold much larger surfaces than needed */
+        if (devsys->cache[i].size >= size && devsys->cache[i].size / 2 < size)
+        {
+            ptrs[taken++] = devsys->cache[i].ptr;
+            devsys->cache[i] = devsys->cache[--devsys->cache_count];
+        }
+        else
+            i++;
+    }
+    vlc_mutex_unlock(&devsys->cache_lock);
+
+    return taken;
+}
+
+static void CacheSurfaces(decoder_device_nvdec_t *devsys, size_t size,
+                          const CUdeviceptr ptrs[], size_t count)
+{
+    CUdeviceptr evicted[NVDEC_CACHED_SURFACES];
+    size_t evicted_count = 0;
+
+    vlc_mutex_lock(&devsys->cache_lock);
+    for (size_t i=0; i < count; i++)
+    {
+        if (devsys->cache_count == NVDEC_CACHED_SURFACES)
+        {
+            /* drop the oldest */
+            evicted[evicted_count++] = devsys->cache[0].ptr;
+            memmove(&devsys->cache[0], &devsys->cache[1],
+                    (NVDEC_CACHED_SURFACES - 1) * sizeof(devsys->cache[0]));
+            devsys->cache_count--;
+        }
+        devsys->cache[devsys->cache_count].ptr = ptrs[i];
+        devsys->cache[devsys->cache_count].size = size;
+        devsys->cache_count++;
+    }
+    vlc_mutex_unlock(&devsys->cache_lock);
+
+    FreeSurfaces(devsys, evicted, evicted_count);
+}
+
 static void PoolRelease(nvdec_pool_owner_t *owner, void *buffers[], size_t pics_count)
 {
-    nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
+    /* the decoder may be gone, but the pool still holds the video context */
+    vlc_decoder_device *device = vlc_video_context_HoldDevice(owner->sys);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(device);
+    CUdeviceptr ptrs[pics_count];
     for (size_t i=0; i < pics_count; i++)
-        p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
-    cuvid_free_functions(&p_sys->cuvidFunctions);
-    free(p_sys);
+        ptrs[i] = (CUdeviceptr)buffers[i];
+    CacheSurfaces(devsys, owner->buffer_size, ptrs, pics_count);
+    vlc_decoder_device_Release(device);
 }
 
 static void nvdec_picture_CtxDestroy(struct picture_context_t *picctx)
@@ -150,7 +210,6 @@ static struct picture_context_t *nvdec_picture_CtxClone(struct picture_context_t
 
 static picture_context_t * PoolAttachPicture(nvdec_pool_owner_t *owner, nvdec_pool_t *pool, void *surface)
 {
-    nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
     pic_pool_context_nvdec_t *picctx = malloc(sizeof(*picctx));
     if (unlikely(!picctx))
         return NULL;
@@ -158,7 +217,7 @@ static picture_context_t * PoolAttachPicture(nvdec_pool_owner_t *owner, nvdec_po
     picctx->ctx.ctx = (picture_context_t) {
         nvdec_picture_CtxDestroy,
         nvdec_picture_CtxClone,
-        p_sys->vctx_out,
+        owner->sys,
     };
     vlc_video_context_Hold(picctx->ctx.ctx.vctx);
 
@@ -337,12 +396,17 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         if (ret != CUDA_SUCCESS)
             goto cuda_error;
 
+        const size_t surface_size = ByteWidth * Height;
         CUdeviceptr outputDevicePtr[MAX_POOL_SIZE];
-        for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr); i++)
+        size_t cached = TakeCachedSurfaces(p_sys->devsys, surface_size, outputDevicePtr,
+                                           ARRAY_SIZE(outputDevicePtr));
+        if (cached)
+            msg_Dbg(p_dec, "reusing %zu output surfaces", cached);
+        for (size_t i=cached; i < ARRAY_SIZE(outputDevicePtr); i++)
         {
             ret = CALL_CUDA_DEC(cuMemAlloc,
                                 &outputDevicePtr[i],
-                                ByteWidth * Height);
+                                surface_size);
             if (ret != CUDA_SUCCESS || outputDevicePtr[i] == 0)
             {
                 while (i)
@@ -355,18 +419,19 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         p_sys->out_pool = NULL;
         if (outputDevicePtr[0])
         {
-            p_sys->pool_owner = (nvdec_pool_owner_t) {
-                p_dec, PoolRelease, PoolAttachPicture,
+            const nvdec_pool_owner_t pool_owner = {
+                p_sys->vctx_out, surface_size, PoolRelease, PoolAttachPicture,
             };
 
             void *bufferPtr[ARRAY_SIZE(outputDevicePtr)];
             for (size_t i=0; i<ARRAY_SIZE(outputDevicePtr); i++)
                 bufferPtr[i] = (void*)(uintptr_t)outputDevicePtr[i];
-            p_sys->out_pool = nvdec_pool_Create(&p_sys->pool_owner,
+            p_sys->out_pool = nvdec_pool_Create(&pool_owner,
                                                 &p_dec->fmt_out.video, p_sys->vctx_out,
                                                 bufferPtr, ARRAY_SIZE(outputDevicePtr));
             if (p_sys->out_pool == NULL)
-                PoolRelease(&p_sys->pool_owner, bufferPtr, ARRAY_SIZE(outputDevicePtr));
+                CacheSurfaces(p_sys->devsys, surface_size, outputDevicePtr,
+                              ARRAY_SIZE(outputDevicePtr));
         }
         CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
         if (p_sys->out_pool == NULL)
@@ -1032,14 +1097,12 @@ static void CloseDecoder(vlc_object_t *p_this)
         vlc_video_context_Release(p_sys->vctx_out);
     if (p_sys->b_is_hxxx)
         hxxx_helper_clean(&p_sys->hh);
+    /* the surfaces go back to the device once the pictures are released */
     if (p_sys->out_pool)
         nvdec_pool_Release(p_sys->out_pool);
-    else
-    {
-        cuvid_free_functions(&p_sys->cuvidFunctions);
-        free(p_dec->p_sys);
-        p_dec->p_sys = NULL;
-    }
+    cuvid_free_functions(&p_sys->cuvidFunctions);
+    free(p_dec->p_sys);
+    p_dec->p_sys = NULL;
 }
 
 /** Decoder Device **/
@@ -1047,7 +1110,13 @@ static void DecoderContextClose(vlc_decoder_device *device)
 {
     decoder_device_nvdec_t *p_sys = GetNVDECOpaqueDevice(device);
     if (p_sys->cuCtx)
+    {
+        CUdeviceptr cached[NVDEC_CACHED_SURFACES];
+        for (size_t i=0; i < p_sys->cache_count; i++)
+            cached[i] = p_sys->cache[i].ptr;
+        FreeSurfaces(p_sys, cached, p_sys->cache_count);
         CALL_CUDA_DEV(cuCtxDestroy, p_sys->cuCtx);
+    }
     cuda_free_functions(&p_sys->cudaFunctions);
 }
 
@@ -1067,6 +1136,9 @@ DecoderContextOpen(vlc_decoder_device *device, vout_window_t *window)
     device->ops = &dev_ops;
     device->type = VLC_DECODER_DEVICE_NVDEC;
     p_sys->cudaFunctions = NULL;
+    p_sys->cuCtx = NULL;
+    vlc_mutex_init(&p_sys->cache_lock);
+    p_sys->cache_count = 0;
 
     int result = cuda_load_functions(&p_sys->cudaFunctions, device);
     if (result != VLC_SUCCESS) {
@@ -1080,7 +1152,24 @@ DecoderContextOpen(vlc_decoder_device *device, vout_window_t *window)
         return result;
     }
 
-    result = CALL_CUDA_DEV(cuCtxCreate, &p_sys->cuCtx, 0, 0);
+    int count;
+    result = CALL_CUDA_DEV(cuDeviceGetCount, &count);
+    if (result != VLC_SUCCESS || count <= 0)
+    {
+        DecoderContextClose(device);
+        return VLC_EGENERIC;
+    }
+
+    CUdevice cuDevice;
+    result = CALL_CUDA_DEV(cuDeviceGet, &cuDevice,
+                           vlc_decoder_device_SelectAdapter(device, count));
+    if (result != VLC_SUCCESS)
+    {
+        DecoderContextClose(device);
+        return result;
+    }
+
+    result = CALL_CUDA_DEV(cuCtxCreate, &p_sys->cuCtx, 0, cuDevice);
     if (result != VLC_SUCCESS)
     {
         DecoderContextClose(device);
@@ -25,11 +25,22 @@
 
 #include <ffnvcodec/dynlink_loader.h>
 
+#define NVDEC_CACHED_SURFACES  8
+
 typedef struct {
 
     CudaFunctions  *cudaFunctions;
     CUcontext      cuCtx;
 
+    /* output surfaces of released pools, reused by the next pools
+     * created on this device, even from another decoder */
+    vlc_mutex_t    cache_lock;
+    struct {
+        CUdeviceptr ptr;
+        size_t      size;
+    }              cache[NVDEC_CACHED_SURFACES];
+    size_t         cache_count;
+
 } decoder_device_nvdec_t;
 
 static inline decoder_device_nvdec_t *GetNVDECOpaqueDevice(vlc_decoder_device *device)
@@ -0,0 +1,578 @@
+/*****************************************************************************
+ * nvenc.c: NVENC hw video encoder
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_picture.h>
+
+#define FFNV_LOG_FUNC(logctx, msg, ...)        msg_Err((vlc_object_t*)logctx, msg, __VA_ARGS__)
+#define FFNV_DEBUG_LOG_FUNC(logctx, msg, ...)  msg_Dbg((vlc_object_t*)logctx, msg, __VA_ARGS__)
+
+#include <ffnvcodec/dynlink_loader.h>
+#include "nvdec_fmt.h"
+
+static int OpenEncoder(vlc_object_t *);
+static void CloseEncoder(vlc_object_t *);
+
+/* Only opened for pictures already on the GPU, so it is always preferred
+ * to the software encoders in that case. */
+vlc_module_begin ()
+    set_description(N_("NVENC video encoder"))
+    set_shortname("nvenc")
+    set_capability("encoder", 250)
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+    set_callbacks(OpenEncoder, CloseEncoder)
+    add_shortcut("nvenc")
+vlc_module_end ()
+
+#define MAX_FRAMES_IN_FLIGHT  8  // B-frames + 1, and a few more for the pipeline
+#define MAX_REGISTERED        64 // distinct input surfaces, see hw_pool
+
+typedef struct
+{
+    CUdeviceptr             devicePtr;
+    NV_ENC_REGISTERED_PTR   registered;
+} nvenc_registered_t;
+
+typedef struct
+{
+    picture_t               *pic;
+    NV_ENC_INPUT_PTR        mapped;
+    NV_ENC_OUTPUT_PTR       bitstream;
+} nvenc_frame_t;
+
+typedef struct
+{
+    vlc_decoder_device          *dec_dev;
+    decoder_device_nvdec_t      *devsys;
+    NvencFunctions              *nvencFunctions;
+    NV_ENCODE_API_FUNCTION_LIST api;
+    void                        *session;
+
+    NV_ENC_BUFFER_FORMAT        buffer_format;
+    unsigned                    b_frames;
+
+    nvenc_registered_t          registered[MAX_REGISTERED];
+    size_t                      registered_count;
+
+    /* frames sent to the encoder, in submission order */
+    nvenc_frame_t               frames[MAX_FRAMES_IN_FLIGHT];
+    size_t                      first_frame;
+    size_t                      frame_count;
+    uint32_t                    frame_idx;
+
+    vlc_tick_t                  initial_date;
+    vlc_tick_t                  frame_length;
+    unsigned                    output_count;
+} encoder_sys_t;
+
+#define CALL_CUDA_ENC(func, ...) CudaCheckErr(VLC_OBJECT(p_enc), p_sys->devsys->cudaFunctions, p_sys->devsys->cudaFunctions->func(__VA_ARGS__), #func)
+
+static int NvencCheckErr(encoder_t *p_enc, NVENCSTATUS status, const char *psz_func)
+{
+    if (unlikely(status != NV_ENC_SUCCESS))
+    {
+        msg_Err(p_enc, "%s failed: %d", psz_func, (int)status);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+#define CALL_NVENC(func, ...) NvencCheckErr(p_enc, p_sys->api.func(__VA_ARGS__), #func)
+
+static NV_ENC_BUFFER_FORMAT MapBufferFormat(vlc_fourcc_t chroma, vlc_fourcc_t codec)
+{
+    switch (chroma)
+    {
+        case VLC_CODEC_NVDEC_OPAQUE:
+            return NV_ENC_BUFFER_FORMAT_NV12;
+        case VLC_CODEC_NVDEC_OPAQUE_10B:
+            /* P010, only HEVC can keep the 10 bits */
+            return codec == VLC_CODEC_HEVC ? NV_ENC_BUFFER_FORMAT_YUV420_10BIT
+                                           : NV_ENC_BUFFER_FORMAT_UNDEFINED;
+        default:
+            return NV_ENC_BUFFER_FORMAT_UNDEFINED;
+    }
+}
+
+static NV_ENC_REGISTERED_PTR GetRegistered(encoder_t *p_enc, const pic_context_nvdec_t *picctx)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+
+    for (size_t i = 0; i < p_sys->registered_count; i++)
+        if (p_sys->registered[i].devicePtr == picctx->devicePtr)
+            return p_sys->registered[i].registered;
+
+    if (p_sys->registered_count == MAX_REGISTERED)
+    {
+        /* the pools were recreated, drop the surfaces not in flight */
+        for (size_t i = 0; i < p_sys->registered_count; )
+        {
+            bool in_flight = false;
+            for (size_t j = 0; j < p_sys->frame_count; j++)
+            {
+                const nvenc_frame_t *frame =
+                    &p_sys->frames[(p_sys->first_frame + j) % MAX_FRAMES_IN_FLIGHT];
+                const pic_context_nvdec_t *ctx =
+                    NVDEC_PICCONTEXT_FROM_PICCTX(frame->pic->context);
+                if (ctx->devicePtr == p_sys->registered[i].devicePtr)
+                    in_flight = true;
+            }
+            if (in_flight)
+            {
+                i++;
+                continue;
+            }
+            CALL_NVENC(nvEncUnregisterResource, p_sys->session,
+                       p_sys->registered[i].registered);
+            p_sys->registered[i] = p_sys->registered[--p_sys->registered_count];
+        }
+        if (p_sys->registered_count == MAX_REGISTERED)
+            return NULL;
+    }
+
+    NV_ENC_REGISTER_RESOURCE reg = {
+        .version            = NV_ENC_REGISTER_RESOURCE_VER,
+        .resourceType       = NV_ENC_INPUT_RESOURCE_TYPE_CUDADEVICEPTR,
+        .width              = p_enc->fmt_in.video.i_width,
+        /* the chroma plane follows the surface lines, not the visible ones */
+        .height             = picctx->bufferHeight,
+        .pitch              = picctx->bufferPitch,
+        .resourceToRegister = (void *)(uintptr_t)picctx->devicePtr,
+        .bufferFormat       = p_sys->buffer_format,
+        .bufferUsage        = NV_ENC_INPUT_IMAGE,
+    };
+    if (CALL_NVENC(nvEncRegisterResource, p_sys->session, &reg) != VLC_SUCCESS)
+        return NULL;
+
+    p_sys->registered[p_sys->registered_count].devicePtr = picctx->devicePtr;
+    p_sys->registered[p_sys->registered_count].registered = reg.registeredResource;
+    p_sys->registered_count++;
+    return reg.registeredResource;
+}
+
+static void ReleaseFrame(encoder_t *p_enc, nvenc_frame_t *frame)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+
+    if (frame->mapped != NULL)
+    {
+        CALL_NVENC(nvEncUnmapInputResource, p_sys->session, frame->mapped);
+        frame->mapped = NULL;
+    }
+    picture_Release(frame->pic);
+    frame->pic = NULL;
+}
+
+static block_t *GetOutput(encoder_t *p_enc, nvenc_frame_t *frame)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+    block_t *p_block = NULL;
+
+    NV_ENC_LOCK_BITSTREAM lock = {
+        .version         = NV_ENC_LOCK_BITSTREAM_VER,
+        .outputBitstream = frame->bitstream,
+    };
+    if (CALL_NVENC(nvEncLockBitstream, p_sys->session, &lock) != VLC_SUCCESS)
+        return NULL;
+
+    p_block = block_Alloc(lock.bitstreamSizeInBytes);
+    if (likely(p_block != NULL))
+    {
+        memcpy(p_block->p_buffer, lock.bitstreamBufferPtr, lock.bitstreamSizeInBytes);
+        p_block->i_length = p_sys->frame_length;
+        p_block->i_pts = lock.outputTimeStamp;
+        /* the first pictures are delayed by the B-frames reordering */
+        p_block->i_dts = p_sys->initial_date
+                       + ((int64_t)p_sys->output_count - p_sys->b_frames) * p_sys->frame_length;
+        p_sys->output_count++;
+
+        switch (lock.pictureType)
+        {
+            case NV_ENC_PIC_TYPE_IDR:
+            case NV_ENC_PIC_TYPE_I:
+                p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+                break;
+            case NV_ENC_PIC_TYPE_P:
+                p_block->i_flags |= BLOCK_FLAG_TYPE_P;
+                break;
+            case NV_ENC_PIC_TYPE_B:
+                p_block->i_flags |= BLOCK_FLAG_TYPE_B;
+                break;
+            default:
+                break;
+        }
+    }
+    CALL_NVENC(nvEncUnlockBitstream, p_sys->session, frame->bitstream);
+    return p_block;
+}
+
+/* Called once the encoder returned pictures, they are ready in submission order */
+static block_t *DrainFrames(encoder_t *p_enc)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+    block_t *p_chain = NULL;
+
+    while (p_sys->frame_count > 0)
+    {
+        nvenc_frame_t *frame = &p_sys->frames[p_sys->first_frame];
+        block_ChainAppend(&p_chain, GetOutput(p_enc, frame));
+        ReleaseFrame(p_enc, frame);
+        p_sys->first_frame = (p_sys->first_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+        p_sys->frame_count--;
+    }
+    return p_chain;
+}
+
+static block_t *Encode(encoder_t *p_enc, picture_t *p_pic)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+    block_t *p_chain = NULL;
+    NVENCSTATUS status;
+
+    if (CALL_CUDA_ENC(cuCtxPushCurrent, p_sys->devsys->cuCtx) != VLC_SUCCESS)
+        return NULL;
+
+    if (p_pic == NULL)
+    {
+        /* flush the reordered pictures */
+        if (p_sys->frame_count > 0)
+        {
+            NV_ENC_PIC_PARAMS params = {
+                .version        = NV_ENC_PIC_PARAMS_VER,
+                .encodePicFlags = NV_ENC_PIC_FLAG_EOS,
+            };
+            status = p_sys->api.nvEncEncodePicture(p_sys->session, &params);
+            if (NvencCheckErr(p_enc, status, "nvEncEncodePicture") == VLC_SUCCESS)
+                p_chain = DrainFrames(p_enc);
+        }
+        goto done;
+    }
+
+    if (p_pic->context == NULL ||
+        vlc_video_context_GetType(p_pic->context->vctx) != VLC_VIDEO_CONTEXT_NVDEC)
+    {
+        msg_Err(p_enc, "picture not on the GPU");
+        goto done;
+    }
+    if (p_sys->frame_count == MAX_FRAMES_IN_FLIGHT)
+    {
+        msg_Err(p_enc, "too many pictures waiting for the encoder");
+        goto done;
+    }
+
+    pic_context_nvdec_t *picctx = NVDEC_PICCONTEXT_FROM_PICCTX(p_pic->context);
+    NV_ENC_REGISTERED_PTR registered = GetRegistered(p_enc, picctx);
+    if (registered == NULL)
+        goto done;
+
+    size_t idx = (p_sys->first_frame + p_sys->frame_count) % MAX_FRAMES_IN_FLIGHT;
+    nvenc_frame_t *frame = &p_sys->frames[idx];
+
+    NV_ENC_MAP_INPUT_RESOURCE map = {
+        .version            = NV_ENC_MAP_INPUT_RESOURCE_VER,
+        .registeredResource = registered,
+    };
+    if (CALL_NVENC(nvEncMapInputResource, p_sys->session, &map) != VLC_SUCCESS)
+        goto done;
+    frame->mapped = map.mappedResource;
+    frame->pic = picture_Hold(p_pic);
+
+    if (p_sys->frame_idx == 0)
+        p_sys->initial_date = p_pic->date;
+
+    NV_ENC_PIC_PARAMS params = {
+        .version         = NV_ENC_PIC_PARAMS_VER,
+        .inputWidth      = p_enc->fmt_in.video.i_width,
+        .inputHeight     = picctx->bufferHeight,
+        .inputPitch      = picctx->bufferPitch,
+        .frameIdx        = p_sys->frame_idx++,
+        .inputTimeStamp  = p_pic->date,
+        .inputDuration   = p_sys->frame_length,
+        .inputBuffer     = frame->mapped,
+        .outputBitstream = frame->bitstream,
+        .bufferFmt       = map.mappedBufferFmt,
+        .pictureStruct   = NV_ENC_PIC_STRUCT_FRAME,
+    };
+    p_sys->frame_count++;
+
+    status = p_sys->api.nvEncEncodePicture(p_sys->session, &params);
+    if (status == NV_ENC_SUCCESS)
+        p_chain = DrainFrames(p_enc);
+    else if (status != NV_ENC_ERR_NEED_MORE_INPUT)
+    {
+        NvencCheckErr(p_enc, status, "nvEncEncodePicture");
+        p_sys->frame_count--;
+        ReleaseFrame(p_enc, frame);
+    }
+
+done:
+    CALL_CUDA_ENC(cuCtxPopCurrent, NULL);
+    return p_chain;
+}
+
+static int SetExtraData(encoder_t *p_enc)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+    uint8_t buffer[1024];
+    uint32_t size = 0;
+
+    NV_ENC_SEQUENCE_PARAM_PAYLOAD payload = {
+        .version              = NV_ENC_SEQUENCE_PARAM_PAYLOAD_VER,
+        .inBufferSize         = sizeof(buffer),
+        .spsppsBuffer         = buffer,
+        .outSPSPPSPayloadSize = &size,
+    };
+    if (CALL_NVENC(nvEncGetSequenceParams, p_sys->session, &payload) != VLC_SUCCESS)
+        return VLC_EGENERIC;
+
+    p_enc->fmt_out.p_extra = malloc(size);
+    if (unlikely(p_enc->fmt_out.p_extra == NULL))
+        return VLC_ENOMEM;
+    memcpy(p_enc->fmt_out.p_extra, buffer, size);
+    p_enc->fmt_out.i_extra = size;
+    return VLC_SUCCESS;
+}
+
+static int InitSession(encoder_t *p_enc)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+    const video_format_t *fmt = &p_enc->fmt_in.video;
+    GUID codec_guid = p_enc->fmt_out.i_codec == VLC_CODEC_HEVC ?
+                      NV_ENC_CODEC_HEVC_GUID : NV_ENC_CODEC_H264_GUID;
+
+    NV_ENC_OPEN_ENCODE_SESSION_EX_PARAMS session_params = {
+        .version    = NV_ENC_OPEN_ENCODE_SESSION_EX_PARAMS_VER,
+        .deviceType = NV_ENC_DEVICE_TYPE_CUDA,
+        .device     = p_sys->devsys->cuCtx,
+        .apiVersion = NVENCAPI_VERSION,
+    };
+    if (CALL_NVENC(nvEncOpenEncodeSessionEx, &session_params, &p_sys->session) != VLC_SUCCESS)
+    {
+        p_sys->session = NULL;
+        return VLC_EGENERIC;
+    }
+
+    NV_ENC_PRESET_CONFIG preset = {
+        .version   = NV_ENC_PRESET_CONFIG_VER,
+        .presetCfg = { .version = NV_ENC_CONFIG_VER },
+    };
+    if (CALL_NVENC(nvEncGetEncodePresetConfigEx, p_sys->session, codec_guid,
+                   NV_ENC_PRESET_P4_GUID, NV_ENC_TUNING_INFO_HIGH_QUALITY,
+                   &preset) != VLC_SUCCESS)
+        return VLC_EGENERIC;
+
+    NV_ENC_CONFIG config = preset.presetCfg;
+    config.gopLength = p_enc->i_iframes > 0 ? p_enc->i_iframes : 250;
+    config.frameIntervalP = 1 + p_sys->b_frames;
+    if (p_enc->fmt_out.i_bitrate > 0)
+    {
+        config.rcParams.rateControlMode = NV_ENC_PARAMS_RC_VBR;
+        config.rcParams.averageBitRate = p_enc->fmt_out.i_bitrate;
+        config.rcParams.maxBitRate = p_enc->fmt_out.i_bitrate * 3 / 2;
+    }
+    if (p_enc->fmt_out.i_codec == VLC_CODEC_HEVC)
+    {
+        /* Annex B with the parameter sets on every IDR, for the live outputs */
+        config.encodeCodecConfig.hevcConfig.repeatSPSPPS = 1;
+        config.encodeCodecConfig.hevcConfig.idrPeriod = config.gopLength;
+        if (p_sys->buffer_format == NV_ENC_BUFFER_FORMAT_YUV420_10BIT)
+        {
+            config.profileGUID = NV_ENC_HEVC_PROFILE_MAIN10_GUID;
+#if NVENCAPI_MAJOR_VERSION >= 12
+            config.encodeCodecConfig.hevcConfig.inputBitDepth = NV_ENC_BIT_DEPTH_10;
+            config.encodeCodecConfig.hevcConfig.outputBitDepth = NV_ENC_BIT_DEPTH_10;
+#else
+            config.encodeCodecConfig.hevcConfig.pixelBitDepthMinus8 = 2;
+#endif
+        }
+    }
+    else
+    {
+        config.encodeCodecConfig.h264Config.repeatSPSPPS = 1;
+        config.encodeCodecConfig.h264Config.idrPeriod = config.gopLength;
+    }
+
+    unsigned sar_num = fmt->i_sar_num ? fmt->i_sar_num : 1;
+    unsigned sar_den = fmt->i_sar_den ? fmt->i_sar_den : 1;
+    NV_ENC_INITIALIZE_PARAMS init = {
+        .version        = NV_ENC_INITIALIZE_PARAMS_VER,
+        .encodeGUID     = codec_guid,
+        .presetGUID     = NV_ENC_PRESET_P4_GUID,
+        .tuningInfo     = NV_ENC_TUNING_INFO_HIGH_QUALITY,
+        .encodeWidth    = fmt->i_visible_width,
+        .encodeHeight   = fmt->i_visible_height,
+        .maxEncodeWidth = fmt->i_visible_width,
+        .maxEncodeHeight= fmt->i_visible_height,
+        .darWidth       = fmt->i_visible_width * sar_num,
+        .darHeight      = fmt->i_visible_height * sar_den,
+        .frameRateNum   = fmt->i_frame_rate,
+        .frameRateDen   = fmt->i_frame_rate_base,
+        .enablePTD      = 1,
+        .encodeConfig   = &config,
+    };
+    if (CALL_NVENC(nvEncInitializeEncoder, p_sys->session, &init) != VLC_SUCCESS)
+        return VLC_EGENERIC;
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        NV_ENC_CREATE_BITSTREAM_BUFFER bitstream = {
+            .version = NV_ENC_CREATE_BITSTREAM_BUFFER_VER,
+        };
+        if (CALL_NVENC(nvEncCreateBitstreamBuffer, p_sys->session, &bitstream) != VLC_SUCCESS)
+            return VLC_EGENERIC;
+        p_sys->frames[i].bitstream = bitstream.bitstreamBuffer;
+    }
+
+    return SetExtraData(p_enc);
+}
+
+static void CloseSession(encoder_t *p_enc)
+{
+    encoder_sys_t *p_sys = p_enc->p_sys;
+
+    if (p_sys->session == NULL)
+        return;
+
+    while (p_sys->frame_count > 0)
+    {
+        ReleaseFrame(p_enc, &p_sys->frames[p_sys->first_frame]);
+        p_sys->first_frame = (p_sys->first_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+        p_sys->frame_count--;
+    }
+    for (size_t i = 0; i < p_sys->registered_count; i++)
+        CALL_NVENC(nvEncUnregisterResource, p_sys->session, p_sys->registered[i].registered);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        if (p_sys->frames[i].bitstream != NULL)
+            CALL_NVENC(nvEncDestroyBitstreamBuffer, p_sys->session, p_sys->frames[i].bitstream);
+    CALL_NVENC(nvEncDestroyEncoder, p_sys->session);
+}
+
+static int OpenEncoder(vlc_object_t *p_this)
+{
+    encoder_t *p_enc = (encoder_t *) p_this;
+
+    if (p_enc->fmt_out.i_codec != VLC_CODEC_H264 &&
+        p_enc->fmt_out.i_codec != VLC_CODEC_HEVC)
+        return VLC_EGENERIC;
+
+    /* only encode the pictures decoded by NVDEC, without any readback */
+    NV_ENC_BUFFER_FORMAT buffer_format =
+        MapBufferFormat(p_enc->fmt_in.i_codec, p_enc->fmt_out.i_codec);
+    if (buffer_format == NV_ENC_BUFFER_FORMAT_UNDEFINED)
+        return VLC_EGENERIC;
+    if (p_enc->fmt_in.video.i_visible_width == 0 ||
+        p_enc->fmt_in.video.i_visible_height == 0)
+        return VLC_EGENERIC;
+
+    /* the input video context is only known when the encoder is really
+     * opened, otherwise use the device the pictures will come from */
+    vlc_decoder_device *dec_dev = NULL;
+    if (p_enc->vctx_in != NULL)
+        dec_dev = vlc_video_context_HoldDevice(p_enc->vctx_in);
+    else if (p_enc->cbs != NULL)
+        dec_dev = vlc_encoder_GetDecoderDevice(p_enc);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(dec_dev);
+    if (devsys == NULL)
+    {
+        if (dec_dev != NULL)
+            vlc_decoder_device_Release(dec_dev);
+        return VLC_EGENERIC;
+    }
+
+    encoder_sys_t *p_sys = calloc(1, sizeof(*p_sys));
+    if (unlikely(p_sys == NULL))
+    {
+        vlc_decoder_device_Release(dec_dev);
+        return VLC_ENOMEM;
+    }
+    p_enc->p_sys = p_sys;
+    p_sys->dec_dev = dec_dev;
+    p_sys->devsys = devsys;
+    p_sys->buffer_format = buffer_format;
+    p_sys->b_frames = VLC_CLIP(p_enc->i_bframes, 0, MAX_FRAMES_IN_FLIGHT - 4);
+
+    if (!p_enc->fmt_in.video.i_frame_rate || !p_enc->fmt_in.video.i_frame_rate_base)
+    {
+        p_enc->fmt_in.video.i_frame_rate = 25;
+        p_enc->fmt_in.video.i_frame_rate_base = 1;
+    }
+    p_sys->frame_length = vlc_tick_from_samples(p_enc->fmt_in.video.i_frame_rate_base,
+                                                p_enc->fmt_in.video.i_frame_rate);
+
+    if (nvenc_load_functions(&p_sys->nvencFunctions, p_enc) != 0)
+    {
+        msg_Err(p_enc, "Unable to load the NVENC library");
+        goto error;
+    }
+
+    uint32_t max_version;
+    if (p_sys->nvencFunctions->NvEncodeAPIGetMaxSupportedVersion(&max_version) != NV_ENC_SUCCESS ||
+        max_version < ((NVENCAPI_MAJOR_VERSION << 4) | NVENCAPI_MINOR_VERSION))
+    {
+        msg_Err(p_enc, "the NVIDIA driver is too old for NVENC API %d.%d",
+                NVENCAPI_MAJOR_VERSION, NVENCAPI_MINOR_VERSION);
+        goto error;
+    }
+
+    p_sys->api.version = NV_ENCODE_API_FUNCTION_LIST_VER;
+    if (p_sys->nvencFunctions->NvEncodeAPICreateInstance(&p_sys->api) != NV_ENC_SUCCESS)
+        goto error;
+
+    if (CALL_CUDA_ENC(cuCtxPushCurrent, devsys->cuCtx) != VLC_SUCCESS)
+        goto error;
+    int result = InitSession(p_enc);
+    CALL_CUDA_ENC(cuCtxPopCurrent, NULL);
+    if (result != VLC_SUCCESS)
+        goto error;
+
+    p_enc->fmt_in.video.i_chroma = p_enc->fmt_in.i_codec;
+    p_enc->pf_encode_video = Encode;
+
+    msg_Dbg(p_enc, "encoding %ux%u %4.4s on the GPU",
+            p_enc->fmt_in.video.i_visible_width, p_enc->fmt_in.video.i_visible_height,
+            (const char *)&p_enc->fmt_out.i_codec);
+    return VLC_SUCCESS;
+
+error:
+    CloseEncoder(p_this);
+    return VLC_EGENERIC;
+}
+
+static void CloseEncoder(vlc_object_t *p_this)
+{
+    encoder_t *p_enc = (encoder_t *) p_this;
+    encoder_sys_t *p_sys = p_enc->p_sys;
+
+    if (p_sys->session != NULL &&
+        CALL_CUDA_ENC(cuCtxPushCurrent, p_sys->devsys->cuCtx) == VLC_SUCCESS)
+    {
+        CloseSession(p_enc);
+        CALL_CUDA_ENC(cuCtxPopCurrent, NULL);
+    }
+    nvenc_free_functions(&p_sys->nvencFunctions);
+    vlc_decoder_device_Release(p_sys->dec_dev);
+    free(p_sys);
+}
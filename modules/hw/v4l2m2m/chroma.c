@@ -0,0 +1,153 @@
+/*****************************************************************************
+ * chroma.c: DRM PRIME to memory chroma conversion filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/dma-buf.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "drm_prime.h"
+
+static int OpenDRMPrimeToCPU(filter_t *);
+
+vlc_module_begin()
+    set_shortname(N_("DRM PRIME converter"))
+    set_description(N_("DRM PRIME to memory chroma converter"))
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+    set_callback_video_converter(OpenDRMPrimeToCPU, 10)
+vlc_module_end()
+
+struct dmabuf_map
+{
+    int     fd;
+    void   *base;
+    size_t  size;
+};
+
+static void SyncMap(const struct dmabuf_map *map, uint64_t flags)
+{
+    struct dma_buf_sync sync = { .flags = DMA_BUF_SYNC_READ | flags };
+
+    while (ioctl(map->fd, DMA_BUF_IOCTL_SYNC, &sync) == -1 && errno == EINTR);
+}
+
+static picture_t *FilterDRMPrimeToCPU(filter_t *p_filter, picture_t *src)
+{
+    drm_prime_picture_context_t *ctx = vlc_drm_prime_PicGetContext(src);
+    struct dmabuf_map maps[DRM_PRIME_MAX_PLANES];
+    unsigned map_count = 0;
+    picture_t *dst = NULL;
+
+    if (ctx == NULL)
+        goto done;
+
+    dst = filter_NewPicture(p_filter);
+    if (unlikely(dst == NULL))
+        goto done;
+
+    /* the planes usually share the buffer */
+    const uint8_t *planes[DRM_PRIME_MAX_PLANES];
+    for (unsigned i = 0; i < ctx->plane_count; i++)
+    {
+        unsigned j;
+        for (j = 0; j < map_count; j++)
+            if (maps[j].fd == ctx->planes[i].fd)
+                break;
+
+        if (j == map_count)
+        {
+            off_t size = lseek(ctx->planes[i].fd, 0, SEEK_END);
+            if (size <= 0)
+                goto error;
+
+            void *base = mmap(NULL, size, PROT_READ, MAP_SHARED,
+                              ctx->planes[i].fd, 0);
+            if (base == MAP_FAILED)
+                goto error;
+
+            maps[j] = (struct dmabuf_map) { ctx->planes[i].fd, base, size };
+            map_count++;
+            SyncMap(&maps[j], DMA_BUF_SYNC_START);
+        }
+
+        if (ctx->planes[i].offset >= maps[j].size)
+            goto error;
+        planes[i] = (const uint8_t *)maps[j].base + ctx->planes[i].offset;
+    }
+
+    for (int i = 0; i < dst->i_planes && i < (int)ctx->plane_count; i++)
+    {
+        plane_t *p = &dst->p[i];
+        size_t pitch = ctx->planes[i].pitch;
+        size_t width = __MIN((size_t)p->i_pitch, pitch);
+
+        for (int y = 0; y < p->i_lines; y++)
+            memcpy(p->p_pixels + y * p->i_pitch, planes[i] + y * pitch, width);
+    }
+    picture_CopyProperties(dst, src);
+    goto done;
+
+error:
+    msg_Err(p_filter, "cannot map the picture buffer");
+    picture_Release(dst);
+    dst = NULL;
+done:
+    for (unsigned j = 0; j < map_count; j++)
+    {
+        SyncMap(&maps[j], DMA_BUF_SYNC_END);
+        munmap(maps[j].base, maps[j].size);
+    }
+    picture_Release(src);
+    return dst;
+}
+
+static const struct vlc_filter_operations filter_ops = {
+    .filter_video = FilterDRMPrimeToCPU,
+};
+
+static int OpenDRMPrimeToCPU(filter_t *p_filter)
+{
+    if (p_filter->vctx_in == NULL ||
+        vlc_video_context_GetType(p_filter->vctx_in) != VLC_VIDEO_CONTEXT_DRM_PRIME)
+        return VLC_EGENERIC;
+
+    vlc_fourcc_t chroma = p_filter->fmt_in.video.i_chroma;
+    if (!vlc_drm_prime_IsChroma(chroma) ||
+        p_filter->fmt_out.video.i_chroma != vlc_drm_prime_GetSwChroma(chroma))
+        return VLC_EGENERIC;
+
+    if (p_filter->fmt_in.video.i_width != p_filter->fmt_out.video.i_width ||
+        p_filter->fmt_in.video.i_height != p_filter->fmt_out.video.i_height)
+        return VLC_EGENERIC;
+
+    p_filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * drm_prime.h: DRM PRIME (dma-buf) opaque pictures
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_HW_DRM_PRIME_H_
+#define VLC_HW_DRM_PRIME_H_
+
+#include <stdint.h>
+
+#include <vlc_picture.h>
+#include <vlc_codec.h>
+
+#ifndef fourcc_code
+# define fourcc_code(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | \
+                                  ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+#endif
+#ifndef DRM_FORMAT_NV12
+# define DRM_FORMAT_NV12    fourcc_code('N', 'V', '1', '2')
+#endif
+#ifndef DRM_FORMAT_P010
+# define DRM_FORMAT_P010    fourcc_code('P', '0', '1', '0')
+#endif
+#ifndef DRM_FORMAT_MOD_LINEAR
+# define DRM_FORMAT_MOD_LINEAR  0
+#endif
+
+#define DRM_PRIME_MAX_PLANES 4
+
+/**
+ * Picture context of the VLC_CODEC_DRM_PRIME_* pictures
+ *
+ * The dma-buf file descriptors belong to the producer of the picture and
+ * remain valid as long as the context exists. Consumers must duplicate them
+ * if they need them for longer.
+ */
+typedef struct
+{
+    picture_context_t s;
+    uint32_t drm_fourcc;    /**< DRM_FORMAT_NV12 or DRM_FORMAT_P010 */
+    uint64_t modifier;      /**< layout modifier, DRM_FORMAT_MOD_LINEAR */
+    unsigned plane_count;
+    struct {
+        int      fd;        /**< can be shared by several planes */
+        uint32_t offset;
+        uint32_t pitch;
+    } planes[DRM_PRIME_MAX_PLANES];
+} drm_prime_picture_context_t;
+
+static inline bool vlc_drm_prime_IsChroma(vlc_fourcc_t chroma)
+{
+    return chroma == VLC_CODEC_DRM_PRIME_NV12 ||
+           chroma == VLC_CODEC_DRM_PRIME_P010;
+}
+
+static inline uint32_t vlc_drm_prime_GetDrmFourcc(vlc_fourcc_t chroma)
+{
+    switch (chroma)
+    {
+        case VLC_CODEC_DRM_PRIME_NV12: return DRM_FORMAT_NV12;
+        case VLC_CODEC_DRM_PRIME_P010: return DRM_FORMAT_P010;
+        default:                       return 0;
+    }
+}
+
+/* software chroma with the same memory layout */
+static inline vlc_fourcc_t vlc_drm_prime_GetSwChroma(vlc_fourcc_t chroma)
+{
+    switch (chroma)
+    {
+        case VLC_CODEC_DRM_PRIME_NV12: return VLC_CODEC_NV12;
+        case VLC_CODEC_DRM_PRIME_P010: return VLC_CODEC_P010;
+        default:                       return 0;
+    }
+}
+
+static inline drm_prime_picture_context_t *
+vlc_drm_prime_PicGetContext(picture_t *pic)
+{
+    if (pic->context == NULL || !vlc_drm_prime_IsChroma(pic->format.i_chroma))
+        return NULL;
+    return container_of(pic->context, drm_prime_picture_context_t, s);
+}
+
+#endif /* VLC_HW_DRM_PRIME_H_ */
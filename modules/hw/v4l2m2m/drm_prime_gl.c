@@ -0,0 +1,239 @@
+/*****************************************************************************
+ * drm_prime_gl.c: OpenGL DRM PRIME opaque converter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <vlc_common.h>
+#include <vlc_vout_window.h>
+#include <vlc_codec.h>
+#include <vlc_plugin.h>
+
+#include "drm_prime.h"
+
+#include "../../video_output/opengl/gl_api.h"
+#include "../../video_output/opengl/interop.h"
+
+/* From https://www.khronos.org/registry/OpenGL/extensions/OES/OES_EGL_image.txt */
+#ifndef GL_OES_EGL_image
+#define GL_OES_EGL_image 1
+typedef void *GLeglImageOES;
+typedef void (*PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)(GLenum target, GLeglImageOES image);
+#endif
+
+static int Open(vlc_object_t *);
+
+vlc_module_begin ()
+    set_description("DRM PRIME OpenGL surface converter")
+    set_capability("glinterop", 1)
+    set_callback(Open)
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VOUT)
+    add_shortcut("drm_prime")
+vlc_module_end ()
+
+struct priv
+{
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+    bool has_modifiers;
+    EGLint drm_fourccs[2];
+
+    struct {
+        picture_t   *pic;
+        EGLImageKHR  egl_images[2];
+    } last;
+};
+
+static EGLImageKHR
+image_create(const struct vlc_gl_interop *interop, EGLint w, EGLint h,
+             EGLint fourcc, EGLint fd, EGLint offset, EGLint pitch,
+             uint64_t modifier)
+{
+    const struct priv *priv = interop->priv;
+    EGLint attribs[] = {
+        EGL_WIDTH, w,
+        EGL_HEIGHT, h,
+        EGL_LINUX_DRM_FOURCC_EXT, fourcc,
+        EGL_DMA_BUF_PLANE0_FD_EXT, fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, pitch,
+        EGL_NONE, EGL_NONE,
+        EGL_NONE, EGL_NONE,
+        EGL_NONE
+    };
+
+    /* without the extension, only the linear layout can be imported */
+    if (priv->has_modifiers)
+    {
+        attribs[12] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
+        attribs[13] = modifier & 0xffffffff;
+        attribs[14] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
+        attribs[15] = modifier >> 32;
+    }
+    else if (modifier != DRM_FORMAT_MOD_LINEAR)
+        return NULL;
+
+    return interop->gl->egl.createImageKHR(interop->gl, EGL_LINUX_DMA_BUF_EXT,
+                                           NULL, attribs);
+}
+
+static void
+release_last_pic(const struct vlc_gl_interop *interop, struct priv *priv)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(priv->last.egl_images); ++i)
+        if (priv->last.egl_images[i] != NULL)
+            interop->gl->egl.destroyImageKHR(interop->gl,
+                                             priv->last.egl_images[i]);
+    picture_Release(priv->last.pic);
+    priv->last.pic = NULL;
+}
+
+static int
+tc_drm_prime_update(const struct vlc_gl_interop *interop, GLuint *textures,
+                    const GLsizei *tex_width, const GLsizei *tex_height,
+                    picture_t *pic, const size_t *plane_offset)
+{
+    (void) plane_offset;
+    struct priv *priv = interop->priv;
+    EGLImageKHR egl_images[2] = { NULL, NULL };
+
+    if (pic == priv->last.pic)
+    {
+        for (unsigned i = 0; i < interop->tex_count; ++i)
+        {
+            interop->vt->BindTexture(interop->tex_target, textures[i]);
+            priv->glEGLImageTargetTexture2DOES(interop->tex_target,
+                                               priv->last.egl_images[i]);
+        }
+        return VLC_SUCCESS;
+    }
+
+    drm_prime_picture_context_t *ctx = vlc_drm_prime_PicGetContext(pic);
+    if (ctx == NULL || ctx->plane_count < interop->tex_count)
+        return VLC_EGENERIC;
+
+    for (unsigned i = 0; i < interop->tex_count; ++i)
+    {
+        egl_images[i] = image_create(interop, tex_width[i], tex_height[i],
+                                     priv->drm_fourccs[i], ctx->planes[i].fd,
+                                     ctx->planes[i].offset,
+                                     ctx->planes[i].pitch, ctx->modifier);
+        if (egl_images[i] == NULL)
+            goto error;
+
+        interop->vt->BindTexture(interop->tex_target, textures[i]);
+        priv->glEGLImageTargetTexture2DOES(interop->tex_target, egl_images[i]);
+    }
+
+    if (priv->last.pic != NULL)
+        release_last_pic(interop, priv);
+    priv->last.pic = picture_Hold(pic);
+    for (unsigned i = 0; i < ARRAY_SIZE(egl_images); ++i)
+        priv->last.egl_images[i] = egl_images[i];
+    return VLC_SUCCESS;
+
+error:
+    for (unsigned i = 0; i < ARRAY_SIZE(egl_images); ++i)
+        if (egl_images[i] != NULL)
+            interop->gl->egl.destroyImageKHR(interop->gl, egl_images[i]);
+    return VLC_EGENERIC;
+}
+
+static void
+Close(struct vlc_gl_interop *interop)
+{
+    struct priv *priv = interop->priv;
+
+    if (priv->last.pic != NULL)
+        release_last_pic(interop, priv);
+    free(priv);
+}
+
+static int
+Open(vlc_object_t *obj)
+{
+    struct vlc_gl_interop *interop = (void *) obj;
+
+    if (interop->vctx == NULL ||
+        vlc_video_context_GetType(interop->vctx) != VLC_VIDEO_CONTEXT_DRM_PRIME ||
+        !vlc_drm_prime_IsChroma(interop->fmt_in.i_chroma) ||
+        interop->gl->ext != VLC_GL_EXT_EGL ||
+        interop->gl->egl.createImageKHR == NULL ||
+        interop->gl->egl.destroyImageKHR == NULL)
+        return VLC_EGENERIC;
+
+    if (!vlc_gl_StrHasToken(interop->api->extensions, "GL_OES_EGL_image"))
+        return VLC_EGENERIC;
+
+    const char *eglexts = interop->gl->egl.queryString(interop->gl, EGL_EXTENSIONS);
+    if (eglexts == NULL || !vlc_gl_StrHasToken(eglexts, "EGL_EXT_image_dma_buf_import"))
+        return VLC_EGENERIC;
+
+    struct priv *priv = interop->priv = calloc(1, sizeof (struct priv));
+    if (unlikely(priv == NULL))
+        return VLC_ENOMEM;
+
+    priv->has_modifiers =
+        vlc_gl_StrHasToken(eglexts, "EGL_EXT_image_dma_buf_import_modifiers");
+
+    /* each plane is imported on its own */
+    switch (interop->fmt_in.i_chroma)
+    {
+        case VLC_CODEC_DRM_PRIME_NV12:
+            priv->drm_fourccs[0] = VLC_FOURCC('R', '8', ' ', ' ');
+            priv->drm_fourccs[1] = VLC_FOURCC('G', 'R', '8', '8');
+            break;
+        case VLC_CODEC_DRM_PRIME_P010:
+            priv->drm_fourccs[0] = VLC_FOURCC('R', '1', '6', ' ');
+            priv->drm_fourccs[1] = VLC_FOURCC('G', 'R', '3', '2');
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    priv->glEGLImageTargetTexture2DOES =
+        vlc_gl_GetProcAddress(interop->gl, "glEGLImageTargetTexture2DOES");
+    if (priv->glEGLImageTargetTexture2DOES == NULL)
+        goto error;
+
+    /* The pictures are uploaded upside-down */
+    video_format_TransformBy(&interop->fmt_out, TRANSFORM_VFLIP);
+
+    int ret = opengl_interop_init(interop, GL_TEXTURE_2D,
+                                  vlc_drm_prime_GetSwChroma(interop->fmt_in.i_chroma),
+                                  interop->fmt_in.space);
+    if (ret != VLC_SUCCESS)
+        goto error;
+
+    static const struct vlc_gl_interop_ops ops = {
+        .update_textures = tc_drm_prime_update,
+        .close = Close,
+    };
+    interop->ops = &ops;
+    return VLC_SUCCESS;
+
+error:
+    free(priv);
+    return VLC_EGENERIC;
+}
@@ -0,0 +1,1114 @@
+/*****************************************************************************
+ * v4l2m2m.c: Video4Linux2 memory-to-memory hardware decoder
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_fs.h>
+#include <vlc_atomic.h>
+
+#include "drm_prime.h"
+
+/* Only the stateful interface is supported: the driver parses the
+ * bitstream itself. The stateless decoders (*_SLICE formats) need the
+ * parsed headers and are not handled. */
+
+#ifndef V4L2_PIX_FMT_HEVC
+# define V4L2_PIX_FMT_HEVC  v4l2_fourcc('H', 'E', 'V', 'C')
+#endif
+#ifndef V4L2_PIX_FMT_VP9
+# define V4L2_PIX_FMT_VP9   v4l2_fourcc('V', 'P', '9', '0')
+#endif
+
+#define M2M_MAX_DEVICES     64
+#define M2M_OUTPUT_BUFFERS  8
+#define M2M_OUTPUT_MIN_SIZE (2 * 1024 * 1024)
+/* capture buffers on top of the driver minimum, for the video output */
+#define M2M_EXTRA_CAPTURE   5
+#define M2M_TIMEOUT_MS      1000
+
+static int OpenDecoder(vlc_object_t *);
+static void CloseDecoder(vlc_object_t *);
+static int OpenDecoderDevice(vlc_decoder_device *, vout_window_t *);
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+    set_shortname(N_("V4L2 M2M"))
+    set_description(N_("Video4Linux2 memory-to-memory hardware decoder"))
+    set_capability("video decoder", 90)
+    add_shortcut("v4l2m2m")
+    set_callbacks(OpenDecoder, CloseDecoder)
+    add_submodule()
+        set_description(N_("DRM PRIME buffers for V4L2 M2M"))
+        set_callback_dec_device(OpenDecoderDevice, 2)
+        add_shortcut("v4l2m2m")
+vlc_module_end()
+
+struct m2m_map
+{
+    void   *base;
+    size_t  length;
+};
+
+typedef struct m2m_pool m2m_pool_t;
+
+/* A capture buffer of the driver */
+struct m2m_frame
+{
+    m2m_pool_t     *pool;
+    unsigned        index;
+    unsigned        generation;
+    unsigned        users;      /* pictures showing the frame */
+    bool            queued;
+
+    unsigned        mem_planes;
+    int             fds[VIDEO_MAX_PLANES];  /* exported, zero-copy only */
+    struct m2m_map  maps[VIDEO_MAX_PLANES]; /* mapped, copy only */
+};
+
+/* The capture queue, shared with the pictures in flight, which queue their
+ * frame back when they are released */
+struct m2m_pool
+{
+    vlc_atomic_rc_t     rc;
+    vlc_mutex_t         lock;
+    int                 fd;             /* -1 once the decoder is closed */
+    enum v4l2_buf_type  type;
+    bool                mplane;
+    unsigned            generation;     /* bumped at each reallocation */
+    struct m2m_frame  **frames;
+    unsigned            count;
+};
+
+typedef struct
+{
+    drm_prime_picture_context_t ctx;
+    struct m2m_frame           *frame;
+} m2m_picture_context_t;
+
+typedef struct
+{
+    int                 fd;
+    bool                mplane;
+    enum v4l2_buf_type  out_type;
+    enum v4l2_buf_type  cap_type;
+
+    struct m2m_map      out[M2M_OUTPUT_BUFFERS];
+    bool                out_queued[M2M_OUTPUT_BUFFERS];
+    unsigned            out_count;
+
+    m2m_pool_t         *pool;
+    bool                cap_streaming;
+    bool                eos;
+    bool                header_sent;
+
+    /* layout of the capture buffers */
+    vlc_fourcc_t        chroma;
+    uint32_t            drm_fourcc;
+    unsigned            plane_count;
+    struct {
+        unsigned        mem;    /* memory plane */
+        uint32_t        offset;
+        uint32_t        pitch;
+    }                   planes[2];
+
+    vlc_video_context  *vctx;   /* NULL when copying the pictures */
+} decoder_sys_t;
+
+static const struct
+{
+    uint32_t     v4l2;
+    unsigned     mem_planes;
+    vlc_fourcc_t opaque;
+    vlc_fourcc_t chroma;
+} capture_formats[] = {
+    { V4L2_PIX_FMT_NV12,  1, VLC_CODEC_DRM_PRIME_NV12, VLC_CODEC_NV12 },
+    { V4L2_PIX_FMT_NV12M, 2, VLC_CODEC_DRM_PRIME_NV12, VLC_CODEC_NV12 },
+#ifdef V4L2_PIX_FMT_P010
+    { V4L2_PIX_FMT_P010,  1, VLC_CODEC_DRM_PRIME_P010, VLC_CODEC_P010 },
+#endif
+};
+
+static int m2m_ioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+
+    do
+        ret = ioctl(fd, request, arg);
+    while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+static uint32_t GetCodedFourcc(vlc_fourcc_t codec)
+{
+    switch (codec)
+    {
+        case VLC_CODEC_H264: return V4L2_PIX_FMT_H264;
+        case VLC_CODEC_HEVC: return V4L2_PIX_FMT_HEVC;
+        case VLC_CODEC_VP8:  return V4L2_PIX_FMT_VP8;
+        case VLC_CODEC_VP9:  return V4L2_PIX_FMT_VP9;
+        case VLC_CODEC_MPGV: return V4L2_PIX_FMT_MPEG2;
+        case VLC_CODEC_MP4V: return V4L2_PIX_FMT_MPEG4;
+        default:             return 0;
+    }
+}
+
+static void InitBuffer(struct v4l2_buffer *buf, struct v4l2_plane *planes,
+                       enum v4l2_buf_type type, bool mplane, unsigned index,
+                       unsigned plane_count)
+{
+    memset(buf, 0, sizeof (*buf));
+    buf->type = type;
+    buf->memory = V4L2_MEMORY_MMAP;
+    buf->index = index;
+    if (mplane)
+    {
+        memset(planes, 0, sizeof (*planes) * VIDEO_MAX_PLANES);
+        buf->m.planes = planes;
+        buf->length = plane_count;
+    }
+}
+
+/**
+ * Opens the first memory-to-memory device decoding the given format,
+ * or any compressed format if it is 0.
+ */
+static int OpenDevice(vlc_object_t *obj, uint32_t coded, bool *restrict mplane)
+{
+    for (unsigned i = 0; i < M2M_MAX_DEVICES; i++)
+    {
+        char path[sizeof ("/dev/video") + 3 * sizeof (i)];
+
+        snprintf(path, sizeof (path), "/dev/video%u", i);
+        int fd = vlc_open(path, O_RDWR | O_NONBLOCK);
+        if (fd == -1) /* the numbering can have gaps */
+            continue;
+
+        struct v4l2_capability cap;
+        if (m2m_ioctl(fd, VIDIOC_QUERYCAP, &cap))
+            goto next;
+
+        uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS)
+                      ? cap.device_caps : cap.capabilities;
+        if (!(caps & V4L2_CAP_STREAMING))
+            goto next;
+
+        enum v4l2_buf_type type;
+        if (caps & V4L2_CAP_VIDEO_M2M_MPLANE)
+        {
+            *mplane = true;
+            type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+        }
+        else if (caps & V4L2_CAP_VIDEO_M2M)
+        {
+            *mplane = false;
+            type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        }
+        else
+            goto next;
+
+        struct v4l2_fmtdesc desc = { .type = type };
+        while (m2m_ioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0)
+        {
+            if ((desc.flags & V4L2_FMT_FLAG_COMPRESSED) &&
+                (coded == 0 || desc.pixelformat == coded))
+            {
+                msg_Dbg(obj, "using %s (%s) for %4.4s", path,
+                        (const char *)cap.card, (const char *)&desc.pixelformat);
+                return fd;
+            }
+            desc.index++;
+        }
+next:
+        vlc_close(fd);
+    }
+    return -1;
+}
+
+/*****************************************************************************
+ * Capture queue
+ *****************************************************************************/
+
+static void FreeFrame(struct m2m_frame *frame)
+{
+    for (unsigned i = 0; i < frame->mem_planes; i++)
+    {
+        if (frame->fds[i] != -1)
+            vlc_close(frame->fds[i]);
+        if (frame->maps[i].base != MAP_FAILED)
+            munmap(frame->maps[i].base, frame->maps[i].length);
+    }
+    free(frame);
+}
+
+/* Must be called with the pool lock held */
+static int QueueFrame(m2m_pool_t *pool, struct m2m_frame *frame)
+{
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+    InitBuffer(&buf, planes, pool->type, pool->mplane, frame->index,
+               frame->mem_planes);
+    if (m2m_ioctl(pool->fd, VIDIOC_QBUF, &buf))
+        return -1;
+    frame->queued = true;
+    return 0;
+}
+
+static m2m_pool_t *PoolNew(int fd, enum v4l2_buf_type type, bool mplane)
+{
+    m2m_pool_t *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    vlc_atomic_rc_init(&pool->rc);
+    vlc_mutex_init(&pool->lock);
+    pool->fd = fd;
+    pool->type = type;
+    pool->mplane = mplane;
+    pool->generation = 0;
+    pool->frames = NULL;
+    pool->count = 0;
+    return pool;
+}
+
+static void PoolRelease(m2m_pool_t *pool)
+{
+    if (!vlc_atomic_rc_dec(&pool->rc))
+        return;
+
+    assert(pool->count == 0);
+    free(pool);
+}
+
+/**
+ * Forgets the current frames: the idle ones are freed, the others when
+ * their last picture is released.
+ */
+static void PoolReset(m2m_pool_t *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    pool->generation++;
+    for (unsigned i = 0; i < pool->count; i++)
+        if (pool->frames[i]->users == 0)
+            FreeFrame(pool->frames[i]);
+    free(pool->frames);
+    pool->frames = NULL;
+    pool->count = 0;
+    vlc_mutex_unlock(&pool->lock);
+}
+
+static void ReleaseFrame(struct m2m_frame *frame)
+{
+    m2m_pool_t *pool = frame->pool;
+
+    vlc_mutex_lock(&pool->lock);
+    assert(frame->users > 0);
+    if (--frame->users == 0)
+    {
+        if (pool->fd != -1 && frame->generation == pool->generation)
+            QueueFrame(pool, frame);
+        else
+            FreeFrame(frame);
+    }
+    vlc_mutex_unlock(&pool->lock);
+    PoolRelease(pool);
+}
+
+static void PictureContextDestroy(picture_context_t *ctx)
+{
+    m2m_picture_context_t *pctx =
+        container_of(ctx, m2m_picture_context_t, ctx.s);
+
+    ReleaseFrame(pctx->frame);
+    vlc_video_context_Release(ctx->vctx);
+    free(pctx);
+}
+
+static picture_context_t *PictureContextCopy(picture_context_t *ctx)
+{
+    m2m_picture_context_t *src =
+        container_of(ctx, m2m_picture_context_t, ctx.s);
+    m2m_picture_context_t *dst = malloc(sizeof (*dst));
+    if (unlikely(dst == NULL))
+        return NULL;
+
+    *dst = *src;
+    m2m_pool_t *pool = src->frame->pool;
+    vlc_mutex_lock(&pool->lock);
+    src->frame->users++;
+    vlc_mutex_unlock(&pool->lock);
+    vlc_atomic_rc_inc(&pool->rc);
+    vlc_video_context_Hold(dst->ctx.s.vctx);
+    return &dst->ctx.s;
+}
+
+static int SetupCaptureFormat(decoder_t *dec, struct v4l2_format *fmt,
+                              unsigned *restrict mem_planes)
+{
+    decoder_sys_t *sys = dec->p_sys;
+
+    *fmt = (struct v4l2_format) { .type = sys->cap_type };
+    if (m2m_ioctl(sys->fd, VIDIOC_G_FMT, fmt))
+        return -1;
+
+    /* keep the driver choice if possible, otherwise ask for a known layout */
+    for (unsigned pass = 0; pass < 2; pass++)
+    {
+        uint32_t pixfmt = sys->mplane ? fmt->fmt.pix_mp.pixelformat
+                                      : fmt->fmt.pix.pixelformat;
+
+        for (size_t i = 0; i < ARRAY_SIZE(capture_formats); i++)
+        {
+            if (capture_formats[i].v4l2 != pixfmt)
+                continue;
+            if (!sys->mplane && capture_formats[i].mem_planes > 1)
+                continue;
+            *mem_planes = capture_formats[i].mem_planes;
+            sys->chroma = sys->vctx != NULL ? capture_formats[i].opaque
+                                            : capture_formats[i].chroma;
+            sys->drm_fourcc = vlc_drm_prime_GetDrmFourcc(capture_formats[i].opaque);
+            return 0;
+        }
+
+        if (pass > 0)
+            break;
+
+        if (sys->mplane)
+            fmt->fmt.pix_mp.pixelformat = V4L2_PIX_FMT_NV12M;
+        else
+            fmt->fmt.pix.pixelformat = V4L2_PIX_FMT_NV12;
+        if (m2m_ioctl(sys->fd, VIDIOC_S_FMT, fmt))
+            break;
+    }
+
+    msg_Err(dec, "unsupported capture format");
+    return -1;
+}
+
+static int SetupCapture(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    m2m_pool_t *pool = sys->pool;
+    struct v4l2_format fmt;
+    unsigned mem_planes;
+
+    if (sys->cap_streaming)
+    {
+        enum v4l2_buf_type type = sys->cap_type;
+
+        m2m_ioctl(sys->fd, VIDIOC_STREAMOFF, &type);
+        sys->cap_streaming = false;
+    }
+    PoolReset(pool);
+
+    if (SetupCaptureFormat(dec, &fmt, &mem_planes))
+        return -1;
+
+    unsigned width, height;
+    if (sys->mplane)
+    {
+        width = fmt.fmt.pix_mp.width;
+        height = fmt.fmt.pix_mp.height;
+    }
+    else
+    {
+        width = fmt.fmt.pix.width;
+        height = fmt.fmt.pix.height;
+    }
+
+    sys->plane_count = 2;
+    for (unsigned i = 0; i < 2; i++)
+    {
+        if (mem_planes == 1)
+        {
+            uint32_t pitch = sys->mplane ? fmt.fmt.pix_mp.plane_fmt[0].bytesperline
+                                         : fmt.fmt.pix.bytesperline;
+            sys->planes[i].mem = 0;
+            sys->planes[i].pitch = pitch;
+            sys->planes[i].offset = i * pitch * height;
+        }
+        else
+        {
+            sys->planes[i].mem = i;
+            sys->planes[i].pitch = fmt.fmt.pix_mp.plane_fmt[i].bytesperline;
+            sys->planes[i].offset = 0;
+        }
+    }
+
+    /* visible area */
+    struct v4l2_selection sel = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .target = V4L2_SEL_TGT_COMPOSE,
+    };
+    if (m2m_ioctl(sys->fd, VIDIOC_G_SELECTION, &sel))
+        sel.r = (struct v4l2_rect) { 0, 0, width, height };
+
+    struct v4l2_control ctrl = { .id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE };
+    unsigned count = 4;
+    if (m2m_ioctl(sys->fd, VIDIOC_G_CTRL, &ctrl) == 0 && ctrl.value > 0)
+        count = ctrl.value;
+    count += M2M_EXTRA_CAPTURE;
+
+    struct v4l2_requestbuffers req = {
+        .type = sys->cap_type,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    /* the exported frames of the previous allocation are orphaned */
+    m2m_ioctl(sys->fd, VIDIOC_REQBUFS, &req);
+    req.count = count;
+    if (m2m_ioctl(sys->fd, VIDIOC_REQBUFS, &req) || req.count == 0)
+    {
+        msg_Err(dec, "cannot allocate capture buffers: %s", vlc_strerror_c(errno));
+        return -1;
+    }
+
+    vlc_mutex_lock(&pool->lock);
+    pool->frames = calloc(req.count, sizeof (*pool->frames));
+    if (unlikely(pool->frames == NULL))
+        goto error;
+
+    for (unsigned i = 0; i < req.count; i++)
+    {
+        struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+        InitBuffer(&buf, planes, sys->cap_type, sys->mplane, i, mem_planes);
+        if (m2m_ioctl(sys->fd, VIDIOC_QUERYBUF, &buf))
+            goto error;
+
+        struct m2m_frame *frame = malloc(sizeof (*frame));
+        if (unlikely(frame == NULL))
+            goto error;
+
+        frame->pool = pool;
+        frame->index = i;
+        frame->generation = pool->generation;
+        frame->users = 0;
+        frame->queued = false;
+        frame->mem_planes = mem_planes;
+        for (unsigned j = 0; j < mem_planes; j++)
+        {
+            frame->fds[j] = -1;
+            frame->maps[j].base = MAP_FAILED;
+        }
+        pool->frames[pool->count++] = frame;
+
+        for (unsigned j = 0; j < mem_planes; j++)
+        {
+            if (sys->vctx != NULL)
+            {
+                struct v4l2_exportbuffer exp = {
+                    .type = sys->cap_type,
+                    .index = i,
+                    .plane = j,
+                    .flags = O_RDONLY | O_CLOEXEC,
+                };
+                if (m2m_ioctl(sys->fd, VIDIOC_EXPBUF, &exp))
+                {
+                    msg_Err(dec, "cannot export capture buffer: %s",
+                            vlc_strerror_c(errno));
+                    goto error;
+                }
+                frame->fds[j] = exp.fd;
+            }
+            else
+            {
+                size_t length = sys->mplane ? buf.m.planes[j].length : buf.length;
+                off_t offset = sys->mplane ? buf.m.planes[j].m.mem_offset
+                                           : buf.m.offset;
+
+                frame->maps[j].base = mmap(NULL, length, PROT_READ, MAP_SHARED,
+                                           sys->fd, offset);
+                if (frame->maps[j].base == MAP_FAILED)
+                    goto error;
+                frame->maps[j].length = length;
+            }
+        }
+
+        if (QueueFrame(pool, frame))
+            goto error;
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    enum v4l2_buf_type type = sys->cap_type;
+    if (m2m_ioctl(sys->fd, VIDIOC_STREAMON, &type))
+    {
+        msg_Err(dec, "cannot start capture: %s", vlc_strerror_c(errno));
+        return -1;
+    }
+    sys->cap_streaming = true;
+
+    video_format_t *vfmt = &dec->fmt_out.video;
+    dec->fmt_out.i_codec = sys->chroma;
+    vfmt->i_chroma = sys->chroma;
+    vfmt->i_width = width;
+    vfmt->i_height = height;
+    vfmt->i_x_offset = sel.r.left;
+    vfmt->i_y_offset = sel.r.top;
+    vfmt->i_visible_width = sel.r.width;
+    vfmt->i_visible_height = sel.r.height;
+    if (!vfmt->i_sar_num || !vfmt->i_sar_den)
+    {
+        vfmt->i_sar_num = 1;
+        vfmt->i_sar_den = 1;
+    }
+
+    msg_Dbg(dec, "decoding %ux%u (%ux%u) to %4.4s, %u buffers",
+            sel.r.width, sel.r.height, width, height,
+            (const char *)&sys->chroma, req.count);
+
+    return decoder_UpdateVideoOutput(dec, sys->vctx);
+
+error:
+    vlc_mutex_unlock(&pool->lock);
+    msg_Err(dec, "cannot set up capture buffers");
+    PoolReset(pool);
+    return -1;
+}
+
+/*****************************************************************************
+ * Decoding
+ *****************************************************************************/
+
+static picture_t *CopyFrame(decoder_t *dec, struct m2m_frame *frame)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    picture_t *pic = decoder_NewPicture(dec);
+    if (pic == NULL)
+        return NULL;
+
+    for (int i = 0; i < pic->i_planes && i < (int)sys->plane_count; i++)
+    {
+        const uint8_t *src = (const uint8_t *)frame->maps[sys->planes[i].mem].base
+                           + sys->planes[i].offset;
+        size_t src_pitch = sys->planes[i].pitch;
+        plane_t *dst = &pic->p[i];
+        size_t width = __MIN((size_t)dst->i_pitch, src_pitch);
+
+        for (int y = 0; y < dst->i_lines; y++)
+            memcpy(dst->p_pixels + y * dst->i_pitch, src + y * src_pitch, width);
+    }
+    return pic;
+}
+
+static picture_t *AttachFrame(decoder_t *dec, struct m2m_frame *frame)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    m2m_picture_context_t *pctx = malloc(sizeof (*pctx));
+    if (unlikely(pctx == NULL))
+        return NULL;
+
+    picture_t *pic = decoder_NewPicture(dec);
+    if (pic == NULL)
+    {
+        free(pctx);
+        return NULL;
+    }
+
+    pctx->ctx.s = (picture_context_t) {
+        PictureContextDestroy, PictureContextCopy,
+        vlc_video_context_Hold(sys->vctx),
+    };
+    pctx->ctx.drm_fourcc = sys->drm_fourcc;
+    pctx->ctx.modifier = DRM_FORMAT_MOD_LINEAR;
+    pctx->ctx.plane_count = sys->plane_count;
+    for (unsigned i = 0; i < sys->plane_count; i++)
+    {
+        pctx->ctx.planes[i].fd = frame->fds[sys->planes[i].mem];
+        pctx->ctx.planes[i].offset = sys->planes[i].offset;
+        pctx->ctx.planes[i].pitch = sys->planes[i].pitch;
+    }
+    pctx->frame = frame;
+
+    /* the frame belongs to the picture until it is released */
+    vlc_mutex_lock(&sys->pool->lock);
+    frame->users++;
+    vlc_mutex_unlock(&sys->pool->lock);
+    vlc_atomic_rc_inc(&sys->pool->rc);
+    pic->context = &pctx->ctx.s;
+    return pic;
+}
+
+static void DequeueCapture(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    m2m_pool_t *pool = sys->pool;
+
+    while (sys->cap_streaming && !sys->eos)
+    {
+        struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+        InitBuffer(&buf, planes, sys->cap_type, sys->mplane, 0, VIDEO_MAX_PLANES);
+        if (m2m_ioctl(sys->fd, VIDIOC_DQBUF, &buf))
+        {
+            if (errno == EPIPE) /* the last buffer was already dequeued */
+                sys->eos = true;
+            else if (errno != EAGAIN)
+                msg_Err(dec, "cannot dequeue capture buffer: %s",
+                        vlc_strerror_c(errno));
+            break;
+        }
+
+        /* only this thread changes the frames array */
+        assert(buf.index < pool->count);
+        struct m2m_frame *frame = pool->frames[buf.index];
+        vlc_mutex_lock(&pool->lock);
+        frame->queued = false;
+        vlc_mutex_unlock(&pool->lock);
+
+        /* the lock is not held while waiting for a picture, as the video
+         * output gives the frames back */
+        size_t used = sys->mplane ? buf.m.planes[0].bytesused : buf.bytesused;
+        picture_t *pic = NULL;
+        if (used > 0 && !(buf.flags & V4L2_BUF_FLAG_ERROR))
+        {
+            if (sys->vctx != NULL)
+                pic = AttachFrame(dec, frame);
+            else
+                pic = CopyFrame(dec, frame);
+        }
+
+        vlc_mutex_lock(&pool->lock);
+        if (frame->users == 0)
+            QueueFrame(pool, frame);
+        vlc_mutex_unlock(&pool->lock);
+
+        if (buf.flags & V4L2_BUF_FLAG_LAST)
+            sys->eos = true;
+
+        if (pic == NULL)
+            continue;
+
+        pic->date = vlc_tick_from_sec(buf.timestamp.tv_sec)
+                  + VLC_TICK_FROM_US(buf.timestamp.tv_usec);
+        pic->b_progressive = buf.field == V4L2_FIELD_NONE ||
+                             buf.field == V4L2_FIELD_ANY;
+        pic->b_top_field_first = buf.field != V4L2_FIELD_INTERLACED_BT;
+        decoder_QueueVideo(dec, pic);
+    }
+}
+
+static void HandleEvents(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    struct v4l2_event ev;
+
+    while (m2m_ioctl(sys->fd, VIDIOC_DQEVENT, &ev) == 0)
+    {
+        if (ev.type == V4L2_EVENT_SOURCE_CHANGE &&
+            (ev.u.src_change.changes & V4L2_EVENT_SRC_CH_RESOLUTION))
+        {
+            if (SetupCapture(dec))
+                msg_Err(dec, "cannot follow the format change");
+        }
+    }
+}
+
+static void ReclaimOutput(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+
+    for (;;)
+    {
+        struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+        InitBuffer(&buf, planes, sys->out_type, sys->mplane, 0, 1);
+        if (m2m_ioctl(sys->fd, VIDIOC_DQBUF, &buf))
+            break;
+        if (buf.index < sys->out_count)
+            sys->out_queued[buf.index] = false;
+    }
+}
+
+/**
+ * Waits for the device, then processes the decoded pictures and events.
+ * Returns the poll() events, 0 on timeout or -1 on error.
+ */
+static int Process(decoder_t *dec, int timeout, short events)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    struct pollfd ufd = {
+        .fd = sys->fd,
+        .events = POLLIN | POLLPRI | events,
+    };
+
+    int ret = poll(&ufd, 1, timeout);
+    if (ret <= 0)
+        return ret;
+
+    /* the pictures before the format change come first */
+    if (ufd.revents & POLLIN)
+        DequeueCapture(dec);
+    if (ufd.revents & POLLPRI)
+        HandleEvents(dec);
+    if (ufd.revents & POLLOUT)
+        ReclaimOutput(dec);
+    if ((ufd.revents & (POLLIN | POLLPRI | POLLOUT)) == 0)
+        return -1;
+    return ufd.revents;
+}
+
+static int QueueBitstream(decoder_t *dec, const uint8_t *data, size_t size,
+                          vlc_tick_t ts)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    unsigned index;
+
+    for (;;)
+    {
+        ReclaimOutput(dec);
+        for (index = 0; index < sys->out_count; index++)
+            if (!sys->out_queued[index])
+                break;
+        if (index < sys->out_count)
+            break;
+
+        if (Process(dec, M2M_TIMEOUT_MS, POLLOUT) <= 0)
+        {
+            msg_Err(dec, "decoder stalled, dropping data");
+            return -1;
+        }
+    }
+
+    if (size > sys->out[index].length)
+    {
+        msg_Err(dec, "dropping oversized data (%zu bytes)", size);
+        return -1;
+    }
+    memcpy(sys->out[index].base, data, size);
+
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+    InitBuffer(&buf, planes, sys->out_type, sys->mplane, index, 1);
+    if (sys->mplane)
+        planes[0].bytesused = size;
+    else
+        buf.bytesused = size;
+    /* copied by the driver to the decoded picture */
+    if (ts != VLC_TICK_INVALID)
+    {
+        buf.timestamp.tv_sec = SEC_FROM_VLC_TICK(ts);
+        buf.timestamp.tv_usec = US_FROM_VLC_TICK(ts % CLOCK_FREQ);
+    }
+
+    if (m2m_ioctl(sys->fd, VIDIOC_QBUF, &buf))
+    {
+        msg_Err(dec, "cannot queue data: %s", vlc_strerror_c(errno));
+        return -1;
+    }
+    sys->out_queued[index] = true;
+    return 0;
+}
+
+static void Drain(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+
+    if (!sys->cap_streaming)
+        return;
+
+    struct v4l2_decoder_cmd cmd = { .cmd = V4L2_DEC_CMD_STOP };
+    if (m2m_ioctl(sys->fd, VIDIOC_DECODER_CMD, &cmd))
+        return;
+
+    while (!sys->eos)
+        if (Process(dec, M2M_TIMEOUT_MS, 0) <= 0)
+            break;
+
+    /* resume decoding after the last buffer */
+    cmd = (struct v4l2_decoder_cmd) { .cmd = V4L2_DEC_CMD_START };
+    m2m_ioctl(sys->fd, VIDIOC_DECODER_CMD, &cmd);
+    sys->eos = false;
+}
+
+static int DecodeBlock(decoder_t *dec, block_t *block)
+{
+    decoder_sys_t *sys = dec->p_sys;
+
+    if (block == NULL)
+    {
+        Drain(dec);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (block->i_flags & BLOCK_FLAG_CORRUPTED)
+    {
+        block_Release(block);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (!sys->header_sent)
+    {
+        if (dec->fmt_in.i_extra > 0)
+            QueueBitstream(dec, dec->fmt_in.p_extra, dec->fmt_in.i_extra,
+                           VLC_TICK_INVALID);
+        sys->header_sent = true;
+    }
+
+    QueueBitstream(dec, block->p_buffer, block->i_buffer,
+                   block->i_pts != VLC_TICK_INVALID ? block->i_pts
+                                                    : block->i_dts);
+    block_Release(block);
+
+    /* output what is ready, without waiting */
+    Process(dec, 0, 0);
+    return VLCDEC_SUCCESS;
+}
+
+static void Flush(decoder_t *dec)
+{
+    decoder_sys_t *sys = dec->p_sys;
+    m2m_pool_t *pool = sys->pool;
+    enum v4l2_buf_type type;
+
+    /* stopping a queue gives all its buffers back */
+    type = sys->out_type;
+    m2m_ioctl(sys->fd, VIDIOC_STREAMOFF, &type);
+    for (unsigned i = 0; i < sys->out_count; i++)
+        sys->out_queued[i] = false;
+    m2m_ioctl(sys->fd, VIDIOC_STREAMON, &type);
+
+    if (sys->cap_streaming)
+    {
+        type = sys->cap_type;
+        vlc_mutex_lock(&pool->lock);
+        m2m_ioctl(sys->fd, VIDIOC_STREAMOFF, &type);
+        for (unsigned i = 0; i < pool->count; i++)
+        {
+            pool->frames[i]->queued = false;
+            if (pool->frames[i]->users == 0)
+                QueueFrame(pool, pool->frames[i]);
+        }
+        vlc_mutex_unlock(&pool->lock);
+        if (m2m_ioctl(sys->fd, VIDIOC_STREAMON, &type))
+            sys->cap_streaming = false;
+    }
+
+    sys->eos = false;
+    sys->header_sent = false;
+}
+
+/*****************************************************************************
+ * Module
+ *****************************************************************************/
+
+static void Clean(decoder_sys_t *sys)
+{
+    enum v4l2_buf_type type;
+
+    type = sys->out_type;
+    m2m_ioctl(sys->fd, VIDIOC_STREAMOFF, &type);
+    type = sys->cap_type;
+    m2m_ioctl(sys->fd, VIDIOC_STREAMOFF, &type);
+
+    if (sys->pool != NULL)
+    {
+        PoolReset(sys->pool);
+        /* the pictures still shown free their frame themselves */
+        vlc_mutex_lock(&sys->pool->lock);
+        sys->pool->fd = -1;
+        vlc_mutex_unlock(&sys->pool->lock);
+        PoolRelease(sys->pool);
+    }
+
+    for (unsigned i = 0; i < sys->out_count; i++)
+        munmap(sys->out[i].base, sys->out[i].length);
+    vlc_close(sys->fd);
+
+    if (sys->vctx != NULL)
+        vlc_video_context_Release(sys->vctx);
+    free(sys);
+}
+
+static int OpenDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+
+    if (dec->fmt_in.i_cat != VIDEO_ES)
+        return VLC_EGENERIC;
+
+    uint32_t coded = GetCodedFourcc(dec->fmt_in.i_codec);
+    if (coded == 0)
+        return VLC_EGENERIC;
+
+    decoder_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->fd = OpenDevice(obj, coded, &sys->mplane);
+    if (sys->fd == -1)
+    {
+        free(sys);
+        return VLC_EGENERIC;
+    }
+    sys->out_type = sys->mplane ? V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE
+                                : V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    sys->cap_type = sys->mplane ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE
+                                : V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    sys->pool = PoolNew(sys->fd, sys->cap_type, sys->mplane);
+    if (unlikely(sys->pool == NULL))
+        goto error;
+
+    /* bitstream queue */
+    unsigned width = dec->fmt_in.video.i_width;
+    unsigned height = dec->fmt_in.video.i_height;
+    uint32_t size = __MAX(width * height * 3 / 4, M2M_OUTPUT_MIN_SIZE);
+    struct v4l2_format fmt = { .type = sys->out_type };
+
+    if (sys->mplane)
+    {
+        fmt.fmt.pix_mp.pixelformat = coded;
+        fmt.fmt.pix_mp.width = width;
+        fmt.fmt.pix_mp.height = height;
+        fmt.fmt.pix_mp.num_planes = 1;
+        fmt.fmt.pix_mp.plane_fmt[0].sizeimage = size;
+    }
+    else
+    {
+        fmt.fmt.pix.pixelformat = coded;
+        fmt.fmt.pix.width = width;
+        fmt.fmt.pix.height = height;
+        fmt.fmt.pix.sizeimage = size;
+    }
+    if (m2m_ioctl(sys->fd, VIDIOC_S_FMT, &fmt))
+    {
+        msg_Err(dec, "cannot set the coded format: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    struct v4l2_requestbuffers req = {
+        .count = M2M_OUTPUT_BUFFERS,
+        .type = sys->out_type,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    if (m2m_ioctl(sys->fd, VIDIOC_REQBUFS, &req) || req.count == 0)
+        goto error;
+
+    for (unsigned i = 0; i < req.count && i < M2M_OUTPUT_BUFFERS; i++)
+    {
+        struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
+        InitBuffer(&buf, planes, sys->out_type, sys->mplane, i, 1);
+        if (m2m_ioctl(sys->fd, VIDIOC_QUERYBUF, &buf))
+            goto error;
+
+        size_t length = sys->mplane ? planes[0].length : buf.length;
+        off_t offset = sys->mplane ? planes[0].m.mem_offset : buf.m.offset;
+        void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                          sys->fd, offset);
+        if (base == MAP_FAILED)
+            goto error;
+        sys->out[i].base = base;
+        sys->out[i].length = length;
+        sys->out_count++;
+    }
+
+    struct v4l2_event_subscription sub = { .type = V4L2_EVENT_SOURCE_CHANGE };
+    if (m2m_ioctl(sys->fd, VIDIOC_SUBSCRIBE_EVENT, &sub))
+    {
+        msg_Err(dec, "cannot subscribe to format changes");
+        goto error;
+    }
+
+    enum v4l2_buf_type type = sys->out_type;
+    if (m2m_ioctl(sys->fd, VIDIOC_STREAMON, &type))
+        goto error;
+
+    /* export the pictures if the video output can import them */
+    vlc_decoder_device *dec_dev = decoder_GetDecoderDevice(dec);
+    if (dec_dev != NULL)
+    {
+        if (dec_dev->type == VLC_DECODER_DEVICE_DRM_PRIME)
+            sys->vctx = vlc_video_context_Create(dec_dev,
+                                                 VLC_VIDEO_CONTEXT_DRM_PRIME,
+                                                 0, NULL);
+        vlc_decoder_device_Release(dec_dev);
+    }
+
+    dec->p_sys = sys;
+    dec->fmt_out.i_cat = VIDEO_ES;
+    dec->fmt_out.video = dec->fmt_in.video;
+    dec->fmt_out.i_codec = sys->vctx != NULL ? VLC_CODEC_DRM_PRIME_NV12
+                                             : VLC_CODEC_NV12;
+    dec->fmt_out.video.i_chroma = dec->fmt_out.i_codec;
+    dec->pf_decode = DecodeBlock;
+    dec->pf_flush = Flush;
+
+    msg_Dbg(dec, "V4L2 M2M decoder for %4.4s, %s pictures",
+            (const char *)&dec->fmt_in.i_codec,
+            sys->vctx != NULL ? "exported" : "copied");
+    return VLC_SUCCESS;
+
+error:
+    Clean(sys);
+    return VLC_EGENERIC;
+}
+
+static void CloseDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+
+    Clean(dec->p_sys);
+}
+
+/*****************************************************************************
+ * Decoder device
+ *****************************************************************************/
+
+static const struct vlc_decoder_device_operations m2m_device_ops = {
+    .close = NULL,
+};
+
+static int OpenDecoderDevice(vlc_decoder_device *device, vout_window_t *window)
+{
+    VLC_UNUSED(window);
+    bool mplane;
+
+    /* there is nothing to share before the decoder opens its own device
+     * node, only check that there is one */
+    int fd = OpenDevice(VLC_OBJECT(device), 0, &mplane);
+    if (fd == -1)
+        return VLC_EGENERIC;
+    vlc_close(fd);
+
+    device->ops = &m2m_device_ops;
+    device->opaque = NULL;
+    device->type = VLC_DECODER_DEVICE_DRM_PRIME;
+    return VLC_SUCCESS;
+}
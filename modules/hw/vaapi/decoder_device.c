@@ -44,6 +44,7 @@
 # include <va/va_drm.h>
 # include <vlc_fs.h>
 # include <fcntl.h>
+# include <sys/stat.h>
 #endif
 
 typedef void (*vaapi_native_destroy_cb)(VANativeDisplay);
@@ -192,6 +193,31 @@ vaapi_InitializeInstanceDRM(vlc_object_t *o,
 static struct vaapi_instance *
 drm_init_vaapi_instance(vlc_decoder_device *device, VADisplay *vadpyp)
 {
+    /* Balance the sessions across the render nodes of the GPUs */
+    unsigned minors[16], count = 0;
+    for (unsigned i = 0; i < ARRAY_SIZE(minors); i++)
+    {
+        char path[sizeof ("/dev/dri/renderD255")];
+        struct stat st;
+
+        snprintf(path, sizeof (path), "/dev/dri/renderD%u", 128 + i);
+        if (vlc_stat(path, &st) == 0)
+            minors[count++] = 128 + i;
+    }
+
+    if (count > 1)
+    {
+        char path[sizeof ("/dev/dri/renderD255")];
+        unsigned idx = vlc_decoder_device_SelectAdapter(device, count);
+
+        snprintf(path, sizeof (path), "/dev/dri/renderD%u", minors[idx]);
+        struct vaapi_instance *va_inst =
+            vaapi_InitializeInstanceDRM(VLC_OBJECT(device), vaGetDisplayDRM,
+                                        vadpyp, path);
+        if (va_inst != NULL)
+            return va_inst;
+    }
+
     return vaapi_InitializeInstanceDRM(VLC_OBJECT(device), vaGetDisplayDRM,
                                        vadpyp, NULL);
 }
@@ -225,6 +251,8 @@ Open(vlc_decoder_device *device, vout_window_t *window)
 {
     VADisplay vadpy = NULL;
     struct vaapi_instance *vainst = NULL;
+
+    device->type = VLC_DECODER_DEVICE_VAAPI;
 #if defined (HAVE_VA_X11)
     if (window && window->type == VOUT_WINDOW_TYPE_XID)
         vainst = x11_init_vaapi_instance(device, window, &vadpy);
@@ -243,7 +271,6 @@ Open(vlc_decoder_device *device, vout_window_t *window)
 
     device->ops = &ops;
     device->sys = vainst;
-    device->type = VLC_DECODER_DEVICE_VAAPI;
     device->opaque = vadpy;
     return VLC_SUCCESS;
 }
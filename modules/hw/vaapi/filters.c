@@ -218,18 +218,21 @@ Filter(filter_t * filter, picture_t * src,
     vlc_vaapi_PicAttachContext(dest);
     picture_CopyProperties(dest, src);
 
-    void *      p_va_params;
+    if (filter_sys->va.buf != VA_INVALID_ID)
+    {
+        void *      p_va_params;
 
-    if (vlc_vaapi_MapBuffer(VLC_OBJECT(filter), filter_sys->va.dpy,
-                            filter_sys->va.buf, &p_va_params))
-        goto error;
+        if (vlc_vaapi_MapBuffer(VLC_OBJECT(filter), filter_sys->va.dpy,
+                                filter_sys->va.buf, &p_va_params))
+            goto error;
 
-    if (pf_update_va_filter_params)
-        pf_update_va_filter_params(filter_sys->p_data, p_va_params);
+        if (pf_update_va_filter_params)
+            pf_update_va_filter_params(filter_sys->p_data, p_va_params);
 
-    if (vlc_vaapi_UnmapBuffer(VLC_OBJECT(filter),
-                              filter_sys->va.dpy, filter_sys->va.buf))
-        goto error;
+        if (vlc_vaapi_UnmapBuffer(VLC_OBJECT(filter),
+                                  filter_sys->va.dpy, filter_sys->va.buf))
+            goto error;
+    }
 
     if (vlc_vaapi_BeginPicture(VLC_OBJECT(filter),
                                filter_sys->va.dpy, filter_sys->va.ctx,
@@ -255,8 +258,11 @@ Filter(filter_t * filter, picture_t * src,
 
     *pipeline_params = (typeof(*pipeline_params)){0};
     pipeline_params->surface = vlc_vaapi_PicGetSurface(src);
-    pipeline_params->filters = &filter_sys->va.buf;
-    pipeline_params->num_filters = 1;
+    if (filter_sys->va.buf != VA_INVALID_ID)
+    {
+        pipeline_params->filters = &filter_sys->va.buf;
+        pipeline_params->num_filters = 1;
+    }
     if (filter_sys->b_pipeline_fast)
         pipeline_params->pipeline_flags = VA_PROC_PIPELINE_FAST;
     if (pf_update_pipeline_params)
@@ -341,34 +347,40 @@ Open(filter_t * filter,
     if (filter_sys->va.ctx == VA_INVALID_ID)
         goto error;
 
-    if (vlc_vaapi_IsVideoProcFilterAvailable(VLC_OBJECT(filter),
-                                             filter_sys->va.dpy,
-                                             filter_sys->va.ctx,
-                                             filter_type))
-        goto error;
-
-    void *      p_va_params;
-    uint32_t    i_sz_param;
-    uint32_t    i_num_params;
-
-    if (pf_init_filter_params(filter, p_data,
-                              &p_va_params, &i_sz_param, &i_num_params))
-        goto error;
-
-    filter_sys->va.buf =
-        vlc_vaapi_CreateBuffer(VLC_OBJECT(filter),
-                               filter_sys->va.dpy, filter_sys->va.ctx,
-                               VAProcFilterParameterBufferType,
-                               i_sz_param, i_num_params, p_va_params);
-    free(p_va_params);
-    if (filter_sys->va.buf == VA_INVALID_ID)
-        goto error;
+    /* VAProcFilterNone only uses the pipeline, to scale */
+    if (filter_type != VAProcFilterNone)
+    {
+        if (vlc_vaapi_IsVideoProcFilterAvailable(VLC_OBJECT(filter),
+                                                 filter_sys->va.dpy,
+                                                 filter_sys->va.ctx,
+                                                 filter_type))
+            goto error;
+
+        void *      p_va_params;
+        uint32_t    i_sz_param;
+        uint32_t    i_num_params;
+
+        if (pf_init_filter_params(filter, p_data,
+                                  &p_va_params, &i_sz_param, &i_num_params))
+            goto error;
+
+        filter_sys->va.buf =
+            vlc_vaapi_CreateBuffer(VLC_OBJECT(filter),
+                                   filter_sys->va.dpy, filter_sys->va.ctx,
+                                   VAProcFilterParameterBufferType,
+                                   i_sz_param, i_num_params, p_va_params);
+        free(p_va_params);
+        if (filter_sys->va.buf == VA_INVALID_ID)
+            goto error;
+    }
 
     if (vlc_vaapi_QueryVideoProcPipelineCaps(VLC_OBJECT(filter),
                                              filter_sys->va.dpy,
                                              filter_sys->va.ctx,
-                                             &filter_sys->va.buf,
-                                             1, p_pipeline_caps))
+                                             filter_sys->va.buf != VA_INVALID_ID ?
+                                                &filter_sys->va.buf : NULL,
+                                             filter_sys->va.buf != VA_INVALID_ID,
+                                             p_pipeline_caps))
         goto error;
 
     filter_sys->b_pipeline_fast =
@@ -405,7 +417,8 @@ Close(filter_t *filter, filter_sys_t * filter_sys)
 {
     vlc_object_t * obj = VLC_OBJECT(filter);
     picture_pool_Release(filter_sys->dest_pics);
-    vlc_vaapi_DestroyBuffer(obj, filter_sys->va.dpy, filter_sys->va.buf);
+    if (filter_sys->va.buf != VA_INVALID_ID)
+        vlc_vaapi_DestroyBuffer(obj, filter_sys->va.dpy, filter_sys->va.buf);
     vlc_vaapi_DestroyContext(obj, filter_sys->va.dpy, filter_sys->va.ctx);
     vlc_vaapi_DestroyConfig(obj, filter_sys->va.dpy, filter_sys->va.conf);
     vlc_decoder_device_Release(filter_sys->va.dec_device);
@@ -1122,6 +1135,93 @@ error:
     return VLC_EGENERIC;
 }
 
+/*******************
+ * Scale functions *
+ *******************/
+
+struct  scale_data
+{
+    VARectangle src_region;
+    VARectangle dst_region;
+};
+
+static void
+Scale_UpdatePipelineParams(void * p_data,
+                           VAProcPipelineParameterBuffer * pipeline_param)
+{
+    struct scale_data *const    p_scale_data = p_data;
+
+    pipeline_param->surface_region = &p_scale_data->src_region;
+    pipeline_param->output_region = &p_scale_data->dst_region;
+    pipeline_param->filter_flags = VA_FILTER_SCALING_HQ;
+}
+
+static picture_t *
+Scale(filter_t * filter, picture_t * src)
+{
+    picture_t *const    dest =
+        Filter(filter, src, NULL, NULL, Scale_UpdatePipelineParams);
+    picture_Release(src);
+    return dest;
+}
+
+static void
+CloseScale(filter_t *filter)
+{
+    filter_sys_t *const filter_sys = filter->p_sys;
+
+    free(filter_sys->p_data);
+    Close(filter, filter_sys);
+}
+
+static const struct vlc_filter_operations Scale_ops = {
+    .filter_video = Scale, .close = CloseScale,
+};
+
+static int
+OpenScale(filter_t *filter)
+{
+    const video_format_t *const fmt_in = &filter->fmt_in.video;
+    const video_format_t *const fmt_out = &filter->fmt_out.video;
+    VAProcPipelineCaps          pipeline_caps;
+
+    if (filter->vctx_in == NULL ||
+        vlc_video_context_GetType(filter->vctx_in) != VLC_VIDEO_CONTEXT_VAAPI)
+        return VLC_EGENERIC;
+    if (!vlc_vaapi_IsChromaOpaque(fmt_in->i_chroma) ||
+        fmt_in->i_chroma != fmt_out->i_chroma ||
+        fmt_in->orientation != fmt_out->orientation)
+        return VLC_EGENERIC;
+    if (fmt_in->i_visible_width == fmt_out->i_visible_width &&
+        fmt_in->i_visible_height == fmt_out->i_visible_height)
+        return VLC_EGENERIC;
+
+    struct scale_data *const    p_data = malloc(sizeof(*p_data));
+    if (!p_data)
+        return VLC_ENOMEM;
+
+    p_data->src_region = (VARectangle) {
+        .x = fmt_in->i_x_offset, .y = fmt_in->i_y_offset,
+        .width = fmt_in->i_visible_width, .height = fmt_in->i_visible_height,
+    };
+    p_data->dst_region = (VARectangle) {
+        .x = fmt_out->i_x_offset, .y = fmt_out->i_y_offset,
+        .width = fmt_out->i_visible_width, .height = fmt_out->i_visible_height,
+    };
+
+    if (Open(filter, VAProcFilterNone, &pipeline_caps, p_data, NULL, NULL))
+    {
+        free(p_data);
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg(filter, "scaling %ux%u to %ux%u",
+            fmt_in->i_visible_width, fmt_in->i_visible_height,
+            fmt_out->i_visible_width, fmt_out->i_visible_height);
+    filter->ops = &Scale_ops;
+    return VLC_SUCCESS;
+}
+
 /*********************
  * Module descriptor *
  *********************/
@@ -1153,4 +1253,8 @@ vlc_module_begin()
 
     add_submodule()
     set_callback_video_converter(vlc_vaapi_OpenChroma, 10)
+
+    add_submodule()
+    set_callback_video_converter(OpenScale, 10)
+    add_shortcut("vaapi_scale")
 vlc_module_end()
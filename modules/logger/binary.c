@@ -0,0 +1,492 @@
+/*****************************************************************************
+ * binary.c: binary tracer plugin
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_arrays.h>
+#include <vlc_tracer.h>
+
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <assert.h>
+
+/*
+ * The traces are serialized without any lock nor system call on the traced
+ * thread: each thread writes raw records to its own single-producer ring
+ * buffer, and a background thread drains the rings to the file.
+ *
+ * File format: the "VLCTRACE" magic and a version byte, followed by records
+ * starting with a tag byte. Integers are LEB128 varints, signed ones are
+ * zigzag-encoded first.
+ *  'S' id len bytes[len]            string definition, ids start at 0
+ *  'E' thread delta count entries   event, delta is the timestamp in ns
+ *                                   relative to the previous event
+ *   with each entry:  key_id type value (VLC_TRACER_INT: signed varint,
+ *                                        VLC_TRACER_STRING: string id)
+ *  'D' thread count                 events lost, the ring was full
+ */
+
+#define BINARY_FILENAME "vlc-trace.bin"
+#define BINARY_MAGIC "VLCTRACE"
+#define BINARY_VERSION 1
+
+/* Per-thread buffer size, must be a power of 2 */
+#define RING_SIZE (1 << 16)
+/* Maximum size of a raw record */
+#define RECORD_MAX 1024
+#define DRAIN_PERIOD VLC_TICK_FROM_MS(20)
+
+struct trace_ring
+{
+    struct trace_ring *next; /**< protected by the tracer lock */
+    unsigned id;
+
+    atomic_size_t head; /**< written by the traced thread */
+    atomic_size_t tail; /**< written by the drainer */
+    atomic_uint dropped;
+    atomic_bool orphan; /**< the traced thread exited */
+
+    unsigned char data[RING_SIZE];
+};
+
+typedef struct
+{
+    FILE *stream;
+    vlc_threadvar_t key;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    bool stop;
+    struct trace_ring *rings;
+    unsigned ring_count;
+
+    /* drainer state */
+    vlc_thread_t thread;
+    vlc_dictionary_t strings;
+    unsigned string_count;
+    int64_t last_ts;
+} vlc_tracer_sys_t;
+
+/*
+ * Traced threads
+ */
+
+static void RingOrphan(void *data)
+{
+    struct trace_ring *ring = data;
+
+    /* freed by the drainer once empty */
+    atomic_store_explicit(&ring->orphan, true, memory_order_release);
+}
+
+static struct trace_ring *RingGet(vlc_tracer_sys_t *sys)
+{
+    struct trace_ring *ring = vlc_threadvar_get(sys->key);
+    if (likely(ring != NULL))
+        return ring;
+
+    ring = malloc(sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->orphan, false);
+
+    if (vlc_threadvar_set(sys->key, ring))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    ring->id = sys->ring_count++;
+    ring->next = sys->rings;
+    sys->rings = ring;
+    vlc_mutex_unlock(&sys->lock);
+    return ring;
+}
+
+static size_t RecordPutString(unsigned char *rec, size_t size, const char *str)
+{
+    size_t len = str != NULL ? strlen(str) : 0;
+    if (len > UINT8_MAX)
+        len = UINT8_MAX;
+    if (size + 1 + len > RECORD_MAX)
+        return 0;
+
+    rec[size] = len;
+    if (len > 0)
+        memcpy(&rec[size + 1], str, len);
+    return size + 1 + len;
+}
+
+/* Raw record: u16 size, i64 timestamp, then per entry: u8 type, u8 key length,
+ * key, and either an i64 or u8 value length and value */
+static void TraceBinary(void *opaque, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    int64_t ts = NS_FROM_VLC_TICK(vlc_tick_now());
+
+    struct trace_ring *ring = RingGet(sys);
+    if (unlikely(ring == NULL))
+        return;
+
+    unsigned char rec[RECORD_MAX];
+    size_t size = 2;
+
+    memcpy(&rec[size], &ts, sizeof (ts));
+    size += sizeof (ts);
+
+    struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+    while (entry.key != NULL && size > 0)
+    {
+        if (size + 1 > RECORD_MAX)
+        {
+            size = 0;
+            break;
+        }
+        rec[size++] = entry.type;
+        size = RecordPutString(rec, size, entry.key);
+        if (size == 0)
+            break;
+
+        switch (entry.type)
+        {
+            case VLC_TRACER_INT:
+                if (size + sizeof (entry.value.integer) > RECORD_MAX)
+                {
+                    size = 0;
+                    break;
+                }
+                memcpy(&rec[size], &entry.value.integer,
+                       sizeof (entry.value.integer));
+                size += sizeof (entry.value.integer);
+                break;
+            case VLC_TRACER_STRING:
+                size = RecordPutString(rec, size, entry.value.string);
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+        entry = va_arg(entries, struct vlc_tracer_entry);
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    /* never wait for the drainer, that would disturb the traced timings */
+    if (size == 0 || size > RING_SIZE - (head - tail))
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint16_t size16 = size;
+    memcpy(rec, &size16, sizeof (size16));
+
+    size_t offset = head & (RING_SIZE - 1);
+    size_t first = __MIN(size, RING_SIZE - offset);
+    memcpy(&ring->data[offset], rec, first);
+    memcpy(ring->data, &rec[first], size - first);
+
+    atomic_store_explicit(&ring->head, head + size, memory_order_release);
+}
+
+/*
+ * Drainer
+ */
+
+static void WriteVarint(FILE *stream, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        putc_unlocked((value & 0x7f) | 0x80, stream);
+        value >>= 7;
+    }
+    putc_unlocked(value, stream);
+}
+
+static void WriteSigned(FILE *stream, int64_t value)
+{
+    WriteVarint(stream, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static unsigned Intern(vlc_tracer_sys_t *sys, const char *str)
+{
+    /* the dictionary cannot store 0, store the id + 1 */
+    void *value = vlc_dictionary_value_for_key(&sys->strings, str);
+    if (value != kVLCDictionaryNotFound)
+        return (uintptr_t)value - 1;
+
+    unsigned id = sys->string_count++;
+    vlc_dictionary_insert(&sys->strings, str, (void *)(uintptr_t)(id + 1));
+
+    size_t len = strlen(str);
+    putc_unlocked('S', sys->stream);
+    WriteVarint(sys->stream, id);
+    WriteVarint(sys->stream, len);
+    fwrite(str, 1, len, sys->stream);
+    return id;
+}
+
+static const unsigned char *ReadString(const unsigned char *p, char *str)
+{
+    size_t len = *p++;
+    memcpy(str, p, len);
+    str[len] = '\0';
+    return p + len;
+}
+
+static void WriteRecord(vlc_tracer_sys_t *sys, const struct trace_ring *ring,
+                        const unsigned char *rec, size_t size)
+{
+    const unsigned char *p = rec + 2, *end = rec + size;
+    unsigned key_ids[RECORD_MAX / 3];
+    int64_t values[RECORD_MAX / 3];
+    unsigned char types[RECORD_MAX / 3];
+    unsigned count = 0;
+    char str[UINT8_MAX + 1];
+
+    int64_t ts;
+    memcpy(&ts, p, sizeof (ts));
+    p += sizeof (ts);
+
+    /* intern the strings first, their definitions precede the event */
+    while (p < end)
+    {
+        types[count] = *p++;
+        p = ReadString(p, str);
+        key_ids[count] = Intern(sys, str);
+
+        if (types[count] == VLC_TRACER_INT)
+        {
+            memcpy(&values[count], p, sizeof (values[count]));
+            p += sizeof (values[count]);
+        }
+        else
+        {
+            p = ReadString(p, str);
+            values[count] = Intern(sys, str);
+        }
+        count++;
+    }
+
+    FILE *stream = sys->stream;
+    putc_unlocked('E', stream);
+    WriteVarint(stream, ring->id);
+    WriteSigned(stream, ts - sys->last_ts);
+    WriteVarint(stream, count);
+    for (unsigned i = 0; i < count; i++)
+    {
+        WriteVarint(stream, key_ids[i]);
+        putc_unlocked(types[i], stream);
+        if (types[i] == VLC_TRACER_INT)
+            WriteSigned(stream, values[i]);
+        else
+            WriteVarint(stream, values[i]);
+    }
+    sys->last_ts = ts;
+}
+
+static void RingDrain(vlc_tracer_sys_t *sys, struct trace_ring *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned char rec[RECORD_MAX];
+
+    while (tail != head)
+    {
+        size_t offset = tail & (RING_SIZE - 1);
+        uint16_t size16;
+
+        /* the size itself may be split by the end of the buffer */
+        rec[0] = ring->data[offset];
+        rec[1] = ring->data[(offset + 1) & (RING_SIZE - 1)];
+        memcpy(&size16, rec, sizeof (size16));
+
+        size_t first = __MIN((size_t)size16, RING_SIZE - offset);
+        memcpy(rec, &ring->data[offset], first);
+        memcpy(&rec[first], ring->data, size16 - first);
+
+        WriteRecord(sys, ring, rec, size16);
+        tail += size16;
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+    unsigned dropped = atomic_exchange_explicit(&ring->dropped, 0,
+                                                memory_order_relaxed);
+    if (dropped > 0)
+    {
+        putc_unlocked('D', sys->stream);
+        WriteVarint(sys->stream, ring->id);
+        WriteVarint(sys->stream, dropped);
+    }
+}
+
+/* Called with the lock held */
+static void DrainAll(vlc_tracer_sys_t *sys)
+{
+    flockfile(sys->stream);
+    for (struct trace_ring **pp = &sys->rings; *pp != NULL;)
+    {
+        struct trace_ring *ring = *pp;
+        /* check before draining, not to miss the last records */
+        bool orphan = atomic_load_explicit(&ring->orphan,
+                                           memory_order_acquire);
+
+        RingDrain(sys, ring);
+        if (orphan)
+        {
+            *pp = ring->next;
+            free(ring);
+        }
+        else
+            pp = &ring->next;
+    }
+    funlockfile(sys->stream);
+    fflush(sys->stream);
+}
+
+static void *Drainer(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    while (!sys->stop)
+    {
+        vlc_tick_t deadline = vlc_tick_now() + DRAIN_PERIOD;
+        while (!sys->stop && vlc_cond_timedwait(&sys->wait, &sys->lock,
+                                                deadline) == 0);
+        DrainAll(sys);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->stop = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+    /* no destructors can run anymore */
+    vlc_threadvar_delete(&sys->key);
+
+    vlc_mutex_lock(&sys->lock);
+    DrainAll(sys);
+    vlc_mutex_unlock(&sys->lock);
+
+    while (sys->rings != NULL)
+    {
+        struct trace_ring *ring = sys->rings;
+        sys->rings = ring->next;
+        free(ring);
+    }
+
+    vlc_dictionary_clear(&sys->strings, NULL, NULL);
+    fclose(sys->stream);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations binary_ops =
+{
+    TraceBinary,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                                void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    char *path = var_InheritString(obj, "binary-tracer-file");
+    const char *filename = path != NULL ? path : BINARY_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wb");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    fputs(BINARY_MAGIC, sys->stream);
+    putc(BINARY_VERSION, sys->stream);
+
+    if (vlc_threadvar_create(&sys->key, RingOrphan))
+        goto error;
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    sys->stop = false;
+    sys->rings = NULL;
+    sys->ring_count = 0;
+    vlc_dictionary_init(&sys->strings, 64);
+    sys->string_count = 0;
+    sys->last_ts = 0;
+
+    if (vlc_clone(&sys->thread, Drainer, sys, VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_dictionary_clear(&sys->strings, NULL, NULL);
+        vlc_threadvar_delete(&sys->key);
+        goto error;
+    }
+
+    *sysp = sys;
+    return &binary_ops;
+
+error:
+    fclose(sys->stream);
+    free(sys);
+    return NULL;
+}
+
+#define LOGFILE_NAME_TEXT N_("Trace filename")
+#define LOGFILE_NAME_LONGTEXT N_("Specify the binary trace filename.")
+
+vlc_module_begin()
+    set_shortname(N_("Binary tracer"))
+    set_description(N_("Binary tracer"))
+    set_category(CAT_ADVANCED)
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("binary-tracer-file", NULL, LOGFILE_NAME_TEXT,
+                 LOGFILE_NAME_LONGTEXT)
+vlc_module_end()
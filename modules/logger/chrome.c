@@ -0,0 +1,321 @@
+/*****************************************************************************
+ * chrome.c: Chrome/Perfetto trace event tracer plugin
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+
+#include <stdarg.h>
+#include <errno.h>
+#include <assert.h>
+
+/*
+ * Writes the traces in the Trace Event Format (JSON array), which can be
+ * loaded in ui.perfetto.dev or chrome://tracing:
+ *  - each traced thread gets its own track, named after its first event
+ *    (e.g. "DEMUX es1", "DEC es1" or "RENDER es1");
+ *  - span events become slices, counter events become counter tracks;
+ *  - pts events (DEMUX OUT, DEC IN/OUT, RENDER) are linked by flows, keyed by
+ *    the stream id and the pts, so that a frame can be followed through the
+ *    pipeline.
+ */
+
+#define CHROME_FILENAME "vlc-trace.json"
+#define MAX_ENTRIES 16
+
+typedef struct
+{
+    FILE *stream;
+    vlc_mutex_t lock;
+    bool first;
+
+    /* threads already named */
+    unsigned long *tids;
+    size_t tid_count;
+} vlc_tracer_sys_t;
+
+struct chrome_event
+{
+    struct vlc_tracer_entry entries[MAX_ENTRIES];
+    size_t count;
+
+    const char *type;
+    const char *id;
+    const char *stream;
+    const char *span;
+    const char *counter;
+    const struct vlc_tracer_entry *pts;
+    const struct vlc_tracer_entry *value;
+};
+
+static void PrintString(FILE *stream, const char *str)
+{
+    putc_unlocked('"', stream);
+    for (; str != NULL && *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+        if (c == '"' || c == '\\')
+        {
+            putc_unlocked('\\', stream);
+            putc_unlocked(c, stream);
+        }
+        else if (c < 0x20)
+            fprintf(stream, "\\u%04x", c);
+        else
+            putc_unlocked(c, stream);
+    }
+    putc_unlocked('"', stream);
+}
+
+static void PrintArgs(FILE *stream, const struct chrome_event *ev)
+{
+    fputs(",\"args\":{", stream);
+    for (size_t i = 0; i < ev->count; i++)
+    {
+        const struct vlc_tracer_entry *entry = &ev->entries[i];
+        if (i > 0)
+            putc_unlocked(',', stream);
+        PrintString(stream, entry->key);
+        putc_unlocked(':', stream);
+        if (entry->type == VLC_TRACER_INT)
+            fprintf(stream, "%"PRId64, entry->value.integer);
+        else
+            PrintString(stream, entry->value.string);
+    }
+    putc_unlocked('}', stream);
+}
+
+/* Called with the lock held */
+static void NameThread(vlc_tracer_sys_t *sys, unsigned long tid,
+                       const struct chrome_event *ev)
+{
+    for (size_t i = 0; i < sys->tid_count; i++)
+        if (sys->tids[i] == tid)
+            return;
+
+    unsigned long *tids = realloc(sys->tids,
+                                  (sys->tid_count + 1) * sizeof (*tids));
+    if (unlikely(tids == NULL))
+        return;
+    tids[sys->tid_count++] = tid;
+    sys->tids = tids;
+
+    FILE *stream = sys->stream;
+    if (!sys->first)
+        fputs(",\n", stream);
+    sys->first = false;
+
+    char name[64];
+    snprintf(name, sizeof (name), "%s %s",
+             ev->type != NULL ? ev->type : "thread",
+             ev->id != NULL ? ev->id : "");
+
+    fprintf(stream, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+                    "\"tid\":%lu,\"args\":{\"name\":", tid);
+    PrintString(stream, name);
+    fputs("}}", stream);
+}
+
+static uint64_t FlowId(const char *id, int64_t pts)
+{
+    /* FNV-1a */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for (; *id != '\0'; id++)
+        hash = (hash ^ (unsigned char)*id) * UINT64_C(0x100000001b3);
+    return (hash ^ (uint64_t)pts) * UINT64_C(0x100000001b3);
+}
+
+static void PrintEvent(vlc_tracer_sys_t *sys, const struct chrome_event *ev,
+                       unsigned long tid, int64_t ts)
+{
+    FILE *stream = sys->stream;
+
+    if (!sys->first)
+        fputs(",\n", stream);
+    sys->first = false;
+
+    const char *type = ev->type != NULL ? ev->type : "trace";
+    fprintf(stream, "{\"pid\":1,\"tid\":%lu,\"ts\":%"PRId64",", tid, ts);
+
+    if (ev->counter != NULL && ev->value != NULL
+     && ev->value->type == VLC_TRACER_INT)
+    {
+        /* one counter track per stream */
+        char name[64];
+        snprintf(name, sizeof (name), "%s %s", ev->counter,
+                 ev->id != NULL ? ev->id : "");
+
+        fputs("\"ph\":\"C\",\"name\":", stream);
+        PrintString(stream, name);
+        fprintf(stream, ",\"args\":{\"value\":%"PRId64"}}",
+                ev->value->value.integer);
+        return;
+    }
+
+    if (ev->span != NULL)
+    {
+        fprintf(stream, "\"ph\":\"%s\",\"name\":",
+                strcmp(ev->span, "end") ? "B" : "E");
+        PrintString(stream, type);
+        PrintArgs(stream, ev);
+        putc_unlocked('}', stream);
+        return;
+    }
+
+    /* point events are zero-length slices, so that flows can bind to them */
+    fputs("\"ph\":\"X\",\"dur\":0,\"name\":", stream);
+    if (ev->stream != NULL)
+    {
+        char name[64];
+        snprintf(name, sizeof (name), "%s %s", type, ev->stream);
+        PrintString(stream, name);
+    }
+    else
+        PrintString(stream, type);
+
+    if (ev->pts != NULL && ev->pts->type == VLC_TRACER_INT && ev->id != NULL)
+    {
+        bool flow_in = strcmp(type, "DEMUX") != 0;
+        bool flow_out = strcmp(type, "RENDER") != 0;
+
+        fprintf(stream, ",\"bind_id\":\"0x%"PRIx64"\"",
+                FlowId(ev->id, ev->pts->value.integer));
+        if (flow_in)
+            fputs(",\"flow_in\":true", stream);
+        if (flow_out)
+            fputs(",\"flow_out\":true", stream);
+    }
+
+    PrintArgs(stream, ev);
+    putc_unlocked('}', stream);
+}
+
+static void TraceChrome(void *opaque, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    int64_t ts = US_FROM_VLC_TICK(vlc_tick_now());
+    unsigned long tid = vlc_thread_id();
+    struct chrome_event ev = { .count = 0 };
+
+    struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+    while (entry.key != NULL && ev.count < MAX_ENTRIES)
+    {
+        struct vlc_tracer_entry *e = &ev.entries[ev.count++];
+        *e = entry;
+
+        if (entry.type == VLC_TRACER_STRING)
+        {
+            if (!strcmp(entry.key, "type"))
+                ev.type = entry.value.string;
+            else if (!strcmp(entry.key, "id"))
+                ev.id = entry.value.string;
+            else if (!strcmp(entry.key, "stream"))
+                ev.stream = entry.value.string;
+            else if (!strcmp(entry.key, "span"))
+                ev.span = entry.value.string;
+            else if (!strcmp(entry.key, "counter"))
+                ev.counter = entry.value.string;
+        }
+        else if (!strcmp(entry.key, "pts"))
+            ev.pts = e;
+        else if (!strcmp(entry.key, "value"))
+            ev.value = e;
+
+        entry = va_arg(entries, struct vlc_tracer_entry);
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    flockfile(sys->stream);
+    NameThread(sys, tid, &ev);
+    PrintEvent(sys, &ev, tid, ts);
+    funlockfile(sys->stream);
+    vlc_mutex_unlock(&sys->lock);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    fputs("\n]\n", sys->stream);
+    fclose(sys->stream);
+    free(sys->tids);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations chrome_ops =
+{
+    TraceChrome,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                                void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    char *path = var_InheritString(obj, "chrome-tracer-file");
+    const char *filename = path != NULL ? path : CHROME_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wt");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    /* the closing bracket is optional, the trace remains usable if VLC does
+     * not exit cleanly */
+    fputs("[\n", sys->stream);
+
+    vlc_mutex_init(&sys->lock);
+    sys->first = true;
+    sys->tids = NULL;
+    sys->tid_count = 0;
+
+    *sysp = sys;
+    return &chrome_ops;
+}
+
+#define LOGFILE_NAME_TEXT N_("Trace filename")
+#define LOGFILE_NAME_LONGTEXT N_("Specify the Chrome/Perfetto trace filename.")
+
+vlc_module_begin()
+    set_shortname(N_("Chrome tracer"))
+    set_description(N_("Chrome/Perfetto trace event tracer"))
+    set_category(CAT_ADVANCED)
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("chrome-tracer-file", NULL, LOGFILE_NAME_TEXT,
+                 LOGFILE_NAME_LONGTEXT)
+vlc_module_end()
@@ -46,6 +46,7 @@ struct vlclua_playlist
     char *filename;
     char *access;
     const char *path;
+    char *dir; /**< Scripts directory the Lua state was set up for */
 };
 
 static int vlclua_demux_peek( lua_State *L )
@@ -118,21 +119,31 @@ static const luaL_Reg p_reg_parse[] =
 };
 
 /*****************************************************************************
- * Called through lua_scripts_batch_execute to call 'probe' on
- * the script pointed by psz_filename.
+ * Gets a Lua state for a script, reusing the previous one if it was set up
+ * for the same scripts directory.
  *****************************************************************************/
-static int probe_luascript(vlc_object_t *obj, const char *filename,
-                           const luabatch_context_t *ctx)
+static lua_State *vlclua_playlist_state(stream_t *s, const char *filename)
 {
-    stream_t *s = (stream_t *)obj;
     struct vlclua_playlist *sys = s->p_sys;
+    const char *sep = strrchr(filename, DIR_SEP_CHAR);
+    size_t len = (sep != NULL) ? (size_t)(sep - filename) : 0;
+
+    if (sys->L != NULL)
+    {
+        if (sys->dir != NULL && strlen(sys->dir) == len
+         && !strncmp(sys->dir, filename, len))
+            return sys->L;
+
+        lua_close(sys->L);
+        sys->L = NULL;
+        free(sys->dir);
+        sys->dir = NULL;
+    }
 
     /* Initialise Lua state structure */
     lua_State *L = luaL_newstate();
     if( !L )
-        return VLC_ENOMEM;
-
-    sys->L = L;
+        return NULL;
 
     /* Load Lua libraries */
     luaL_openlibs( L ); /* FIXME: Don't open all the libs? */
@@ -163,11 +174,35 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
     if (vlclua_add_modules_path(L, filename))
     {
         msg_Warn(s, "error setting the module search path for %s", filename);
-        goto error;
+        lua_close(L);
+        return NULL;
     }
 
+    sys->L = L;
+    sys->dir = strndup(filename, len);
+    return L;
+}
+
+/*****************************************************************************
+ * Called through lua_scripts_batch_execute to call 'probe' on
+ * the script pointed by psz_filename.
+ *****************************************************************************/
+static int probe_luascript(vlc_object_t *obj, const char *filename,
+                           const luabatch_context_t *ctx)
+{
+    stream_t *s = (stream_t *)obj;
+    struct vlclua_playlist *sys = s->p_sys;
+
+    /* Skip the scripts that declared they handle other hosts only */
+    if (!vlclua_probe_hosts_match(filename, sys->path))
+        return VLC_EGENERIC;
+
+    lua_State *L = vlclua_playlist_state(s, filename);
+    if (L == NULL)
+        return VLC_EGENERIC;
+
     /* Load and run the script(s) */
-    if (vlclua_dofile(VLC_OBJECT(s), L, filename))
+    if (vlclua_dofile_cached(VLC_OBJECT(s), L, filename))
     {
         msg_Warn(s, "error loading script %s: %s", filename,
                  lua_tostring(L, lua_gettop(L)));
@@ -201,10 +236,23 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
         }
     }
 
+    /* Keep the state for the next script, without this script's entry
+     * points */
+    lua_settop( L, 0 );
+    lua_pushnil( L );
+    lua_setglobal( L, "probe" );
+    lua_pushnil( L );
+    lua_setglobal( L, "parse" );
+    lua_pushnil( L );
+    lua_setglobal( L, "probe_hosts" );
     (void) ctx;
+    return VLC_EGENERIC;
+
 error:
-    lua_pop( L, 1 );
     lua_close(sys->L);
+    sys->L = NULL;
+    free(sys->dir);
+    sys->dir = NULL;
     return VLC_EGENERIC;
 }
 
@@ -284,8 +332,11 @@ int Import_LuaPlaylist(vlc_object_t *obj)
         return VLC_ENOMEM;
 
     s->p_sys = sys;
+    sys->L = NULL;
+    sys->filename = NULL;
     sys->access = NULL;
     sys->path = NULL;
+    sys->dir = NULL;
 
     if (s->psz_url != NULL)
     {   /* Backward compatibility hack: Lua scripts expect the URI scheme and
@@ -302,6 +353,9 @@ int Import_LuaPlaylist(vlc_object_t *obj)
                                            probe_luascript, NULL);
     if (ret != VLC_SUCCESS)
     {
+        if (sys->L != NULL)
+            lua_close(sys->L);
+        free(sys->dir);
         free(sys->access);
         free(sys);
         return ret;
@@ -320,6 +374,7 @@ void Close_LuaPlaylist(vlc_object_t *obj)
     free(sys->filename);
     assert(sys->L != NULL);
     lua_close(sys->L);
+    free(sys->dir);
     free(sys->access);
     free(sys);
 }
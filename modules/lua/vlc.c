@@ -41,6 +41,7 @@
 #include <vlc_fs.h>
 #include <vlc_services_discovery.h>
 #include <vlc_stream.h>
+#include <vlc_memstream.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -655,6 +656,199 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
+/*****************************************************************************
+ * Compiled scripts cache
+ *****************************************************************************/
+struct vlclua_chunk
+{
+    struct vlclua_chunk *next;
+    char *path;
+    time_t mtime;
+    off_t size;
+    char *code; /**< Lua bytecode */
+    size_t length;
+    bool hosts_known; /**< Whether the script has been run once */
+    char **hosts; /**< NULL-terminated probe_hosts, NULL if none */
+};
+
+static vlc_mutex_t chunks_lock = VLC_STATIC_MUTEX;
+static struct vlclua_chunk *chunks = NULL;
+
+static void vlclua_chunk_free( struct vlclua_chunk *chunk )
+{
+    if( chunk->hosts != NULL )
+        for( char **host = chunk->hosts; *host != NULL; host++ )
+            free( *host );
+    free( chunk->hosts );
+    free( chunk->code );
+    free( chunk->path );
+    free( chunk );
+}
+
+__attribute__((destructor))
+static void vlclua_chunks_clear( void )
+{
+    for( struct vlclua_chunk *chunk = chunks, *next; chunk; chunk = next )
+    {
+        next = chunk->next;
+        vlclua_chunk_free( chunk );
+    }
+    chunks = NULL;
+}
+
+static struct vlclua_chunk **vlclua_chunk_find( const char *path )
+{
+    struct vlclua_chunk **pp = &chunks;
+
+    while( *pp != NULL && strcmp( (*pp)->path, path ) )
+        pp = &(*pp)->next;
+    return pp;
+}
+
+static int vlclua_chunk_write( lua_State *L, const void *p, size_t size,
+                               void *data )
+{
+    (void) L;
+    return fwrite( p, 1, size, data ) != size;
+}
+
+/* Reads the optional probe_hosts table of a script that has just run */
+static char **vlclua_chunk_hosts( lua_State *L )
+{
+    char **hosts = NULL;
+
+    lua_getglobal( L, "probe_hosts" );
+    if( lua_istable( L, -1 ) )
+    {
+        size_t count = lua_objlen( L, -1 );
+
+        hosts = calloc( count + 1, sizeof (*hosts) );
+        for( size_t i = 0, j = 0; hosts != NULL && i < count; i++ )
+        {
+            lua_rawgeti( L, -1, i + 1 );
+            if( lua_isstring( L, -1 ) )
+            {
+                hosts[j] = strdup( lua_tostring( L, -1 ) );
+                if( hosts[j] != NULL )
+                    j++;
+            }
+            lua_pop( L, 1 );
+        }
+    }
+    lua_pop( L, 1 );
+    return hosts;
+}
+
+int vlclua_dofile_cached( vlc_object_t *p_this, lua_State *L,
+                          const char *path )
+{
+    struct stat st;
+
+    if( strstr( path, "://" ) != NULL || vlc_stat( path, &st ) )
+        return vlclua_dofile( p_this, L, path );
+
+    int ret = -1;
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = *vlclua_chunk_find( path );
+    if( chunk != NULL && chunk->mtime == st.st_mtime
+     && chunk->size == st.st_size )
+        ret = luaL_loadbuffer( L, chunk->code, chunk->length, path );
+    vlc_mutex_unlock( &chunks_lock );
+
+    if( ret != 0 )
+    {
+        char *localpath = ToLocaleDup( path );
+        if( unlikely(localpath == NULL) )
+            return 1;
+        ret = luaL_loadfile( L, localpath );
+        free( localpath );
+        if( ret != 0 )
+            return ret;
+
+        /* Keep the compiled chunk for the next time */
+        struct vlc_memstream code;
+        chunk = malloc( sizeof (*chunk) );
+        if( likely(chunk != NULL) && vlc_memstream_open( &code ) == 0 )
+        {
+#if LUA_VERSION_NUM >= 503
+            int val = lua_dump( L, vlclua_chunk_write, code.stream, 0 );
+#else
+            int val = lua_dump( L, vlclua_chunk_write, code.stream );
+#endif
+            chunk->path = strdup( path );
+            if( vlc_memstream_close( &code ) == 0 && val == 0
+             && chunk->path != NULL )
+            {
+                chunk->mtime = st.st_mtime;
+                chunk->size = st.st_size;
+                chunk->code = code.ptr;
+                chunk->length = code.length;
+                chunk->hosts_known = false;
+                chunk->hosts = NULL;
+
+                vlc_mutex_lock( &chunks_lock );
+                struct vlclua_chunk **pp = vlclua_chunk_find( path );
+                chunk->next = NULL;
+                if( *pp != NULL )
+                {   /* Outdated */
+                    chunk->next = (*pp)->next;
+                    vlclua_chunk_free( *pp );
+                }
+                *pp = chunk;
+                vlc_mutex_unlock( &chunks_lock );
+            }
+            else
+            {
+                free( code.ptr );
+                free( chunk->path );
+                free( chunk );
+            }
+        }
+        else
+            free( chunk );
+    }
+
+    ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
+    if( ret != 0 )
+        return ret;
+
+    vlc_mutex_lock( &chunks_lock );
+    chunk = *vlclua_chunk_find( path );
+    if( chunk != NULL && !chunk->hosts_known )
+    {
+        chunk->hosts = vlclua_chunk_hosts( L );
+        chunk->hosts_known = true;
+    }
+    vlc_mutex_unlock( &chunks_lock );
+    return 0;
+}
+
+bool vlclua_probe_hosts_match( const char *path, const char *url )
+{
+    bool match = true;
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = *vlclua_chunk_find( path );
+    if( chunk != NULL && chunk->hosts != NULL )
+    {
+        size_t len = (url != NULL) ? strcspn( url, "/:?#" ) : 0;
+
+        match = false;
+        for( char **host = chunk->hosts; *host != NULL && !match; host++ )
+        {
+            size_t hostlen = strlen( *host );
+
+            /* The host or one of its subdomains */
+            match = len >= hostlen
+                 && !strncasecmp( url + len - hostlen, *host, hostlen )
+                 && (len == hostlen || url[len - hostlen - 1] == '.');
+        }
+    }
+    vlc_mutex_unlock( &chunks_lock );
+    return match;
+}
+
 /** Replacement for luaL_dofile, using VLC's input capabilities */
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
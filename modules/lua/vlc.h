@@ -175,6 +175,21 @@ char *vlclua_find_file( const char *psz_luadirname, const char *psz_name );
  *****************************************************************************/
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *url );
 
+/**
+ * Runs a script like vlclua_dofile(), keeping the compiled bytecode of local
+ * scripts in a process-wide cache (invalidated if the file changes).
+ */
+int vlclua_dofile_cached( vlc_object_t *p_this, lua_State *L,
+                          const char *path );
+
+/**
+ * Checks whether a script may probe an URL (without its scheme), from the
+ * optional probe_hosts table it declared the last time it was run.
+ *
+ * \return false if the script only handles other hosts
+ */
+bool vlclua_probe_hosts_match( const char *path, const char *url );
+
 /*****************************************************************************
  * Playlist and meta data internal utilities.
  *****************************************************************************/
@@ -22,7 +22,9 @@
 #endif
 
 #include <assert.h>
+#include <errno.h>
 #include <stdatomic.h>
+#include <sys/stat.h>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -30,6 +32,10 @@
 #include <vlc_modules.h>
 #include <vlc_meta.h>
 #include <vlc_url.h>
+#include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_vector.h>
+#include <vlc_executor.h>
 
 #include <vlc_player.h>
 #include <vlc_fingerprinter.h>
@@ -40,44 +46,86 @@
  * Local prototypes
  *****************************************************************************/
 
-struct fingerprinter_sys_t
+/* Seconds decoded past the prefix, as the stop time is not sample accurate */
+#define FINGERPRINT_MARGIN 2
+/* Fingerprints of local files kept in memory */
+#define FINGERPRINT_CACHE_SIZE 8192
+
+/* One player, reused across the requests it processes */
+struct fingerprinter_worker
 {
-    vlc_thread_t thread;
+    struct vlc_object_t obj;
     vlc_player_t *player;
     vlc_player_listener_id *listener_id;
+    vlc_cond_t cond;
+    bool b_working;
+};
+
+struct fingerprint_task
+{
+    fingerprinter_thread_t *fingerprinter;
+    fingerprint_request_t *request;
+    struct vlc_runnable runnable; /**< to be passed to the executor */
+    struct vlc_list node;
+};
+
+struct fingerprint_cache_entry
+{
+    char *psz_fingerprint;
+    unsigned int i_duration;
+};
+
+struct fingerprinter_sys_t
+{
+    vlc_executor_t *executor;
+    unsigned int i_prefix; /* fingerprinted duration in seconds */
 
     atomic_bool abort;
 
+    vlc_mutex_t lock;
+    struct vlc_list tasks; /* submitted, not yet completed */
+    struct VLC_VECTOR(struct fingerprinter_worker *) workers;
+    struct VLC_VECTOR(struct fingerprinter_worker *) idle;
+
     struct
     {
-        vlc_array_t         queue;
-        vlc_mutex_t         lock;
-    } incoming, results;
-
-    vlc_cond_t              incoming_cond;
+        vlc_dictionary_t entries; /* by file identity */
+        char **keys; /* insertion order, for eviction */
+        size_t i_next;
+    } cache;
 
     struct
     {
         vlc_array_t         queue;
-        vlc_cond_t          cond;
-        bool                b_working;
-    } processing;
+        vlc_mutex_t         lock;
+    } results;
 };
 
 static int  Open            (vlc_object_t *);
 static void Close           (vlc_object_t *);
 static void CleanSys        (fingerprinter_sys_t *);
-static void *Run(void *);
+static void RunTask(void *);
 
 /*****************************************************************************
  * Module descriptor
  ****************************************************************************/
+#define THREADS_TEXT N_("Fingerprinting threads")
+#define THREADS_LONGTEXT N_("Number of tracks fingerprinted in parallel " \
+    "(0 for the number of CPUs).")
+#define PREFIX_TEXT N_("Fingerprinted duration")
+#define PREFIX_LONGTEXT N_("Duration in seconds of the beginning of the " \
+    "track that is decoded and fingerprinted.")
+
 vlc_module_begin ()
     set_category(CAT_ADVANCED)
     set_subcategory(SUBCAT_ADVANCED_MISC)
     set_shortname(N_("acoustid"))
     set_description(N_("Track fingerprinter (based on Acoustid)"))
     set_capability("fingerprinter", 10)
+    add_integer("fingerprinter-threads", 0, THREADS_TEXT, THREADS_LONGTEXT)
+        change_integer_range(0, 64)
+    add_integer("fingerprinter-duration", 90, PREFIX_TEXT, PREFIX_LONGTEXT)
+        change_integer_range(10, 600)
     set_callbacks(Open, Close)
 vlc_module_end ()
 
@@ -88,22 +136,21 @@ vlc_module_end ()
 static int EnqueueRequest( fingerprinter_thread_t *f, fingerprint_request_t *r )
 {
     fingerprinter_sys_t *p_sys = f->p_sys;
-    vlc_mutex_lock( &p_sys->incoming.lock );
-    int i_ret = vlc_array_append( &p_sys->incoming.queue, r );
-    vlc_cond_signal( &p_sys->incoming_cond );
-    vlc_mutex_unlock( &p_sys->incoming.lock );
-    return i_ret;
-}
+    struct fingerprint_task *task = malloc( sizeof( *task ) );
+    if( unlikely(task == NULL) )
+        return VLC_ENOMEM;
 
-static void QueueIncomingRequests( fingerprinter_sys_t *p_sys )
-{
-    for( size_t i = vlc_array_count( &p_sys->incoming.queue ); i > 0 ; i-- )
-    {
-        fingerprint_request_t *r = vlc_array_item_at_index( &p_sys->incoming.queue, i - 1 );
-        if( vlc_array_append( &p_sys->processing.queue, r ) )
-            fingerprint_request_Delete( r );
-    }
-    vlc_array_clear( &p_sys->incoming.queue );
+    task->fingerprinter = f;
+    task->request = r;
+    task->runnable.run = RunTask;
+    task->runnable.userdata = task;
+
+    vlc_mutex_lock( &p_sys->lock );
+    vlc_list_append( &task->node, &p_sys->tasks );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    vlc_executor_Submit( p_sys->executor, &task->runnable );
+    return VLC_SUCCESS;
 }
 
 static fingerprint_request_t * GetResult( fingerprinter_thread_t *f )
@@ -132,20 +179,202 @@ static void ApplyResult( fingerprint_request_t *p_r, size_t i_resultid )
     vlc_mutex_unlock( &p_item->lock );
 }
 
+/*****************************************************************************
+ * Fingerprints cache
+ *****************************************************************************/
+
+/* Identifies a local file by its inode (or path), size and modification
+ * time, so that renamed or duplicated requests are not decoded again */
+static char *CacheKey( const char *psz_uri )
+{
+    char *psz_path = vlc_uri2path( psz_uri );
+    if( psz_path == NULL )
+        return NULL; /* not a local file */
+
+    struct stat st;
+    char *psz_key = NULL;
+    if( vlc_stat( psz_path, &st ) == 0 && S_ISREG( st.st_mode ) )
+    {
+        int i_ret;
+        if( st.st_ino != 0 )
+            i_ret = asprintf( &psz_key, "%ju:%ju:%jd:%jd",
+                              (uintmax_t) st.st_dev, (uintmax_t) st.st_ino,
+                              (intmax_t) st.st_size, (intmax_t) st.st_mtime );
+        else
+            i_ret = asprintf( &psz_key, "%s:%jd:%jd", psz_path,
+                              (intmax_t) st.st_size, (intmax_t) st.st_mtime );
+        if( i_ret == -1 )
+            psz_key = NULL;
+    }
+    free( psz_path );
+    return psz_key;
+}
+
+static void CacheEntryDelete( void *p_data, void *p_obj )
+{
+    struct fingerprint_cache_entry *p_entry = p_data;
+    VLC_UNUSED( p_obj );
+    free( p_entry->psz_fingerprint );
+    free( p_entry );
+}
+
+static bool CacheGet( fingerprinter_sys_t *p_sys, const char *psz_key,
+                      acoustid_fingerprint_t *fp )
+{
+    vlc_mutex_lock( &p_sys->lock );
+    const struct fingerprint_cache_entry *p_entry =
+        vlc_dictionary_value_for_key( &p_sys->cache.entries, psz_key );
+    if( p_entry != kVLCDictionaryNotFound )
+    {
+        fp->psz_fingerprint = strdup( p_entry->psz_fingerprint );
+        if( !fp->i_duration )
+            fp->i_duration = p_entry->i_duration;
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    return fp->psz_fingerprint != NULL;
+}
+
+static void CachePut( fingerprinter_sys_t *p_sys, const char *psz_key,
+                      const acoustid_fingerprint_t *fp )
+{
+    struct fingerprint_cache_entry *p_entry = malloc( sizeof( *p_entry ) );
+    char *psz_keycopy = strdup( psz_key );
+    if( unlikely(p_entry == NULL || psz_keycopy == NULL) )
+        goto error;
+    p_entry->psz_fingerprint = strdup( fp->psz_fingerprint );
+    p_entry->i_duration = fp->i_duration;
+    if( unlikely(p_entry->psz_fingerprint == NULL) )
+        goto error;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( vlc_dictionary_has_key( &p_sys->cache.entries, psz_key ) )
+    {
+        /* fingerprinted concurrently */
+        vlc_mutex_unlock( &p_sys->lock );
+        CacheEntryDelete( p_entry, NULL );
+        free( psz_keycopy );
+        return;
+    }
+
+    char **pp_slot = &p_sys->cache.keys[p_sys->cache.i_next];
+    if( *pp_slot != NULL )
+    {
+        vlc_dictionary_remove_value_for_key( &p_sys->cache.entries, *pp_slot,
+                                             CacheEntryDelete, NULL );
+        free( *pp_slot );
+    }
+    *pp_slot = psz_keycopy;
+    p_sys->cache.i_next = (p_sys->cache.i_next + 1) % FINGERPRINT_CACHE_SIZE;
+    vlc_dictionary_insert( &p_sys->cache.entries, psz_key, p_entry );
+    vlc_mutex_unlock( &p_sys->lock );
+    return;
+
+error:
+    if( p_entry )
+        free( p_entry->psz_fingerprint );
+    free( p_entry );
+    free( psz_keycopy );
+}
+
+/*****************************************************************************
+ * Workers
+ *****************************************************************************/
+
 static void player_on_state_changed(vlc_player_t *player,
                                     enum vlc_player_state new_state,
                                     void *p_user_data)
 {
     VLC_UNUSED(player);
-    fingerprinter_sys_t *p_sys = p_user_data;
+    struct fingerprinter_worker *p_worker = p_user_data;
     if (new_state == VLC_PLAYER_STATE_STOPPED)
     {
-        p_sys->processing.b_working = false;
-        vlc_cond_signal( &p_sys->processing.cond );
+        p_worker->b_working = false;
+        vlc_cond_signal( &p_worker->cond );
+    }
+}
+
+static void WorkerDelete( struct fingerprinter_worker *p_worker )
+{
+    vlc_player_Lock(p_worker->player);
+    vlc_player_RemoveListener(p_worker->player, p_worker->listener_id);
+    vlc_player_Unlock(p_worker->player);
+    vlc_player_Delete(p_worker->player);
+    vlc_object_delete(p_worker);
+}
+
+static struct fingerprinter_worker *
+WorkerGet( fingerprinter_thread_t *p_fingerprinter )
+{
+    fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
+    struct fingerprinter_worker *p_worker = NULL;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( p_sys->idle.size > 0 )
+    {
+        p_worker = p_sys->idle.data[p_sys->idle.size - 1];
+        vlc_vector_remove( &p_sys->idle, p_sys->idle.size - 1 );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    if( p_worker != NULL )
+        return p_worker;
+
+    p_worker = vlc_object_create( p_fingerprinter, sizeof( *p_worker ) );
+    if( unlikely(p_worker == NULL) )
+        return NULL;
+
+    /* The output parameters are per worker, found by the chromaprint output
+     * of the player inputs */
+    var_Create( p_worker, "fingerprint-data", VLC_VAR_ADDRESS );
+    var_Create( p_worker, "duration", VLC_VAR_INTEGER );
+    var_SetInteger( p_worker, "duration", p_sys->i_prefix );
+
+    vlc_cond_init( &p_worker->cond );
+    p_worker->b_working = false;
+    p_worker->player = vlc_player_New( VLC_OBJECT(p_worker),
+                                       VLC_PLAYER_LOCK_NORMAL, NULL, NULL );
+    if( !p_worker->player )
+    {
+        vlc_object_delete( p_worker );
+        return NULL;
+    }
+
+    static const struct vlc_player_cbs cbs = {
+        .on_state_changed = player_on_state_changed,
+    };
+
+    vlc_player_Lock(p_worker->player);
+    p_worker->listener_id =
+        vlc_player_AddListener(p_worker->player, &cbs, p_worker);
+    vlc_player_Unlock(p_worker->player);
+    if( !p_worker->listener_id )
+    {
+        vlc_player_Delete( p_worker->player );
+        vlc_object_delete( p_worker );
+        return NULL;
+    }
+
+    vlc_mutex_lock( &p_sys->lock );
+    bool b_added = vlc_vector_push( &p_sys->workers, p_worker );
+    vlc_mutex_unlock( &p_sys->lock );
+    if( !b_added )
+    {
+        WorkerDelete( p_worker );
+        return NULL;
     }
+    return p_worker;
 }
 
-static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
+static void WorkerPut( fingerprinter_sys_t *p_sys,
+                       struct fingerprinter_worker *p_worker )
+{
+    vlc_mutex_lock( &p_sys->lock );
+    /* if this fails, the worker is only deleted on Close() */
+    vlc_vector_push( &p_sys->idle, p_worker );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void DoFingerprint( fingerprinter_sys_t *p_sys,
+                           struct fingerprinter_worker *p_worker,
                            acoustid_fingerprint_t *fp,
                            const char *psz_uri )
 {
@@ -167,16 +396,19 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
 
     input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
     free( psz_sout_option );
-    if ( fp->i_duration )
+    /* Only the audio prefix is needed: do not decode the other tracks, nor
+     * the rest of the file. The chromaprint output does not synchronize,
+     * so the input runs as fast as the audio decodes. */
+    input_item_AddOption( p_item, "no-sout-video", VLC_INPUT_OPTION_TRUSTED );
+    input_item_AddOption( p_item, "no-sout-spu", VLC_INPUT_OPTION_TRUSTED );
+    if ( asprintf( &psz_sout_option, "stop-time=%u",
+                   p_sys->i_prefix + FINGERPRINT_MARGIN ) == -1 )
     {
-        if ( asprintf( &psz_sout_option, "stop-time=%u", fp->i_duration ) == -1 )
-        {
-            input_item_Release( p_item );
-            return;
-        }
-        input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
-        free( psz_sout_option );
+        input_item_Release( p_item );
+        return;
     }
+    input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
+    free( psz_sout_option );
     input_item_SetURI( p_item, psz_uri ) ;
 
     chromaprint_fingerprint_t chroma_fingerprint;
@@ -184,31 +416,39 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
     chroma_fingerprint.psz_fingerprint = NULL;
     chroma_fingerprint.i_duration = fp->i_duration;
 
-    var_Create( p_fingerprinter, "fingerprint-data", VLC_VAR_ADDRESS );
-    var_SetAddress( p_fingerprinter, "fingerprint-data", &chroma_fingerprint );
+    var_SetAddress( p_worker, "fingerprint-data", &chroma_fingerprint );
 
-    vlc_player_t *player = p_fingerprinter->p_sys->player;
+    vlc_player_t *player = p_worker->player;
     vlc_player_Lock(player);
 
-    p_fingerprinter->p_sys->processing.b_working = true;
-
-    int ret = vlc_player_SetCurrentMedia(player, p_item);
-    if (ret == VLC_SUCCESS)
-        ret = vlc_player_Start(player);
-    input_item_Release(p_item);
+    int ret = VLC_EGENERIC;
+    /* Close() stops the players under their lock once aborting */
+    if( !atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
+    {
+        p_worker->b_working = true;
+        ret = vlc_player_SetCurrentMedia(player, p_item);
+        if (ret == VLC_SUCCESS)
+            ret = vlc_player_Start(player);
+    }
 
     if (ret == VLC_SUCCESS)
     {
-        while( p_fingerprinter->p_sys->processing.b_working )
-            vlc_player_CondWait(player,
-                                &p_fingerprinter->p_sys->processing.cond);
+        while( p_worker->b_working )
+            vlc_player_CondWait(player, &p_worker->cond);
 
         fp->psz_fingerprint = chroma_fingerprint.psz_fingerprint;
         if( !fp->i_duration ) /* had not given hint */
-            fp->i_duration = chroma_fingerprint.i_duration;
+        {
+            /* the fingerprinted prefix is shorter than the track */
+            vlc_tick_t i_length = input_item_GetDuration( p_item );
+            fp->i_duration = i_length > 0 ? SEC_FROM_VLC_TICK( i_length )
+                                          : chroma_fingerprint.i_duration;
+        }
     }
+    p_worker->b_working = false;
 
     vlc_player_Unlock(player);
+    input_item_Release(p_item);
 }
 
 /*****************************************************************************
@@ -222,42 +462,42 @@ static int Open(vlc_object_t *p_this)
     if ( !p_sys )
         return VLC_ENOMEM;
 
-    p_fingerprinter->p_sys = p_sys;
-
-    var_Create(p_fingerprinter, "vout", VLC_VAR_STRING);
-    var_SetString(p_fingerprinter, "vout", "dummy");
-    var_Create(p_fingerprinter, "aout", VLC_VAR_STRING);
-    var_SetString(p_fingerprinter, "aout", "dummy");
-    p_sys->player = vlc_player_New(VLC_OBJECT(p_fingerprinter),
-                                   VLC_PLAYER_LOCK_NORMAL, NULL, NULL );
-    if (!p_sys->player)
+    p_sys->cache.keys = calloc( FINGERPRINT_CACHE_SIZE, sizeof( char * ) );
+    if ( !p_sys->cache.keys )
     {
-        free(p_sys);
+        free( p_sys );
         return VLC_ENOMEM;
     }
 
-    static const struct vlc_player_cbs cbs = {
-        .on_state_changed = player_on_state_changed,
-    };
+    unsigned i_threads = var_InheritInteger( p_fingerprinter,
+                                             "fingerprinter-threads" );
+    if ( i_threads == 0 )
+        i_threads = vlc_GetCPUCount();
+    p_sys->i_prefix = var_InheritInteger( p_fingerprinter,
+                                          "fingerprinter-duration" );
 
-    vlc_player_Lock(p_sys->player);
-    p_sys->listener_id =
-        vlc_player_AddListener(p_sys->player, &cbs, p_fingerprinter->p_sys);
-    vlc_player_Unlock(p_sys->player);
-    if (!p_sys->listener_id)
+    p_sys->executor = vlc_executor_New( i_threads );
+    if ( !p_sys->executor )
     {
-        vlc_player_Delete(p_sys->player);
-        free(p_sys);
-        return VLC_ENOMEM;
+        msg_Err( p_fingerprinter, "cannot create fingerprinter executor" );
+        free( p_sys->cache.keys );
+        free( p_sys );
+        return VLC_EGENERIC;
     }
 
-    atomic_init( &p_sys->abort, false );
-    vlc_array_init( &p_sys->incoming.queue );
-    vlc_mutex_init( &p_sys->incoming.lock );
-    vlc_cond_init( &p_sys->incoming_cond );
+    p_fingerprinter->p_sys = p_sys;
+
+    var_Create(p_fingerprinter, "vout", VLC_VAR_STRING);
+    var_SetString(p_fingerprinter, "vout", "dummy");
+    var_Create(p_fingerprinter, "aout", VLC_VAR_STRING);
+    var_SetString(p_fingerprinter, "aout", "dummy");
 
-    vlc_array_init( &p_sys->processing.queue );
-    vlc_cond_init( &p_sys->processing.cond );
+    atomic_init( &p_sys->abort, false );
+    vlc_mutex_init( &p_sys->lock );
+    vlc_list_init( &p_sys->tasks );
+    vlc_vector_init( &p_sys->workers );
+    vlc_vector_init( &p_sys->idle );
+    vlc_dictionary_init( &p_sys->cache.entries, 0 );
 
     vlc_array_init( &p_sys->results.queue );
     vlc_mutex_init( &p_sys->results.lock );
@@ -267,19 +507,10 @@ static int Open(vlc_object_t *p_this)
     p_fingerprinter->pf_apply = ApplyResult;
 
     var_Create( p_fingerprinter, "results-available", VLC_VAR_BOOL );
-    if( vlc_clone( &p_sys->thread, Run, p_fingerprinter,
-                   VLC_THREAD_PRIORITY_LOW ) )
-    {
-        msg_Err( p_fingerprinter, "cannot spawn fingerprinter thread" );
-        goto error;
-    }
+    msg_Dbg( p_fingerprinter, "fingerprinting %us prefixes on %u threads",
+             p_sys->i_prefix, i_threads );
 
     return VLC_SUCCESS;
-
-error:
-    CleanSys( p_sys );
-    free( p_sys );
-    return VLC_EGENERIC;
 }
 
 /*****************************************************************************
@@ -290,11 +521,32 @@ static void Close(vlc_object_t *p_this)
     fingerprinter_thread_t   *p_fingerprinter = (fingerprinter_thread_t*) p_this;
     fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
 
-    vlc_mutex_lock( &p_sys->incoming.lock );
     atomic_store_explicit( &p_sys->abort, true, memory_order_relaxed );
-    vlc_cond_signal( &p_sys->incoming_cond );
-    vlc_mutex_unlock( &p_sys->incoming.lock );
-    vlc_join( p_sys->thread, NULL );
+
+    vlc_mutex_lock( &p_sys->lock );
+    struct fingerprint_task *task;
+    vlc_list_foreach( task, &p_sys->tasks, node )
+    {
+        if( vlc_executor_Cancel( p_sys->executor, &task->runnable ) )
+        {
+            vlc_list_remove( &task->node );
+            fingerprint_request_Delete( task->request );
+            free( task );
+        }
+    }
+
+    /* Interrupt the running requests */
+    struct fingerprinter_worker *p_worker;
+    vlc_vector_foreach( p_worker, &p_sys->workers )
+    {
+        vlc_player_Lock( p_worker->player );
+        vlc_player_Stop( p_worker->player );
+        vlc_player_Unlock( p_worker->player );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    vlc_executor_Delete( p_sys->executor );
+    assert( vlc_list_is_empty( &p_sys->tasks ) );
 
     CleanSys( p_sys );
     free( p_sys );
@@ -302,22 +554,20 @@ static void Close(vlc_object_t *p_this)
 
 static void CleanSys( fingerprinter_sys_t *p_sys )
 {
-    for ( size_t i = 0; i < vlc_array_count( &p_sys->incoming.queue ); i++ )
-        fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->incoming.queue, i ) );
-    vlc_array_clear( &p_sys->incoming.queue );
-
-    for ( size_t i = 0; i < vlc_array_count( &p_sys->processing.queue ); i++ )
-        fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->processing.queue, i ) );
-    vlc_array_clear( &p_sys->processing.queue );
-
     for ( size_t i = 0; i < vlc_array_count( &p_sys->results.queue ); i++ )
         fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->results.queue, i ) );
     vlc_array_clear( &p_sys->results.queue );
 
-    vlc_player_Lock(p_sys->player);
-    vlc_player_RemoveListener(p_sys->player, p_sys->listener_id);
-    vlc_player_Unlock(p_sys->player);
-    vlc_player_Delete(p_sys->player);
+    struct fingerprinter_worker *p_worker;
+    vlc_vector_foreach( p_worker, &p_sys->workers )
+        WorkerDelete( p_worker );
+    vlc_vector_destroy( &p_sys->workers );
+    vlc_vector_destroy( &p_sys->idle );
+
+    vlc_dictionary_clear( &p_sys->cache.entries, CacheEntryDelete, NULL );
+    for ( size_t i = 0; i < FINGERPRINT_CACHE_SIZE; i++ )
+        free( p_sys->cache.keys[i] );
+    free( p_sys->cache.keys );
 }
 
 static void fill_metas_with_results( fingerprint_request_t *p_r, acoustid_fingerprint_t *p_f )
@@ -341,84 +591,80 @@ static void fill_metas_with_results( fingerprint_request_t *p_r, acoustid_finger
     }
 }
 
-/*****************************************************************************
- * Run :
- *****************************************************************************/
-static void *Run( void *opaque )
+static void Fingerprint( fingerprinter_thread_t *p_fingerprinter,
+                         fingerprint_request_t *p_data )
 {
-    fingerprinter_thread_t *p_fingerprinter = opaque;
     fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
 
-    /* main loop */
-    for (;;)
-    {
-        vlc_mutex_lock( &p_sys->incoming.lock );
-
-        while( vlc_array_count( &p_sys->incoming.queue ) == 0 )
-        {
-            if( atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
-            {
-                vlc_mutex_unlock( &p_sys->incoming.lock );
-                return NULL;
-            }
-            vlc_cond_wait( &p_sys->incoming_cond, &p_sys->incoming.lock );
-        }
+    char *psz_uri = input_item_GetURI( p_data->p_item );
+    if ( psz_uri == NULL )
+        return;
 
-        QueueIncomingRequests( p_sys );
+    acoustid_fingerprint_t acoustid_print = {0};
 
-        vlc_mutex_unlock( &p_sys->incoming.lock );
+    /* overwrite with hint, as in this case, fingerprint's session will be truncated */
+    if ( p_data->i_duration )
+         acoustid_print.i_duration = p_data->i_duration;
 
-        bool results_available = false;
-        while( vlc_array_count( &p_sys->processing.queue ) )
+    char *psz_key = CacheKey( psz_uri );
+    if ( psz_key == NULL || !CacheGet( p_sys, psz_key, &acoustid_print ) )
+    {
+        struct fingerprinter_worker *p_worker = WorkerGet( p_fingerprinter );
+        if ( p_worker != NULL )
         {
-            fingerprint_request_t *p_data = vlc_array_item_at_index( &p_sys->processing.queue, 0 );
-
-            char *psz_uri = input_item_GetURI( p_data->p_item );
-            if ( psz_uri != NULL )
-            {
-                 acoustid_fingerprint_t acoustid_print = {0};
+            DoFingerprint( p_sys, p_worker, &acoustid_print, psz_uri );
+            WorkerPut( p_sys, p_worker );
+        }
+        if ( psz_key != NULL && acoustid_print.psz_fingerprint != NULL )
+            CachePut( p_sys, psz_key, &acoustid_print );
+    }
+    free( psz_key );
+    free( psz_uri );
 
-                /* overwrite with hint, as in this case, fingerprint's session will be truncated */
-                if ( p_data->i_duration )
-                     acoustid_print.i_duration = p_data->i_duration;
+    if ( acoustid_print.psz_fingerprint != NULL &&
+         !atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
+    {
+        acoustid_config_t cfg = { .p_obj = VLC_OBJECT(p_fingerprinter),
+                                  .psz_server = NULL, .psz_apikey = NULL };
+        acoustid_lookup_fingerprint( &cfg, &acoustid_print );
+        fill_metas_with_results( p_data, &acoustid_print );
+    }
 
-                DoFingerprint( p_fingerprinter, &acoustid_print, psz_uri );
-                free( psz_uri );
+    for( unsigned j = 0; j < acoustid_print.results.count; j++ )
+         acoustid_result_release( &acoustid_print.results.p_results[j] );
+    if( acoustid_print.results.count )
+        free( acoustid_print.results.p_results );
+    free( acoustid_print.psz_fingerprint );
+}
 
-                acoustid_config_t cfg = { .p_obj = VLC_OBJECT(p_fingerprinter),
-                                          .psz_server = NULL, .psz_apikey = NULL };
-                acoustid_lookup_fingerprint( &cfg, &acoustid_print );
-                fill_metas_with_results( p_data, &acoustid_print );
+/*****************************************************************************
+ * RunTask : executed on one of the executor threads
+ *****************************************************************************/
+static void RunTask( void *opaque )
+{
+    struct fingerprint_task *task = opaque;
+    fingerprinter_thread_t *p_fingerprinter = task->fingerprinter;
+    fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
+    fingerprint_request_t *p_data = task->request;
 
-                for( unsigned j = 0; j < acoustid_print.results.count; j++ )
-                     acoustid_result_release( &acoustid_print.results.p_results[j] );
-                if( acoustid_print.results.count )
-                    free( acoustid_print.results.p_results );
-                free( acoustid_print.psz_fingerprint );
-            }
+    if( !atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
+        Fingerprint( p_fingerprinter, p_data );
 
-            /* copy results */
-            vlc_mutex_lock( &p_sys->results.lock );
-            if( vlc_array_append( &p_sys->results.queue, p_data ) )
-                fingerprint_request_Delete( p_data );
-            else
-                results_available = true;
-            vlc_mutex_unlock( &p_sys->results.lock );
-
-            // the fingerprint request must not exist both in the
-            // processing and results queue, even in case of thread
-            // cancellation, so remove it immediately
-            vlc_array_remove( &p_sys->processing.queue, 0 );
-
-            if( atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
-                return NULL;
-        }
+    vlc_mutex_lock( &p_sys->lock );
+    vlc_list_remove( &task->node );
+    vlc_mutex_unlock( &p_sys->lock );
+    free( task );
 
-        if ( results_available )
-        {
-            var_TriggerCallback( p_fingerprinter, "results-available" );
-        }
-    }
+    /* copy results */
+    bool results_available = false;
+    vlc_mutex_lock( &p_sys->results.lock );
+    if( vlc_array_append( &p_sys->results.queue, p_data ) )
+        fingerprint_request_Delete( p_data );
+    else
+        results_available = true;
+    vlc_mutex_unlock( &p_sys->results.lock );
 
-    vlc_assert_unreachable();
+    if ( results_available &&
+         !atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
+        var_TriggerCallback( p_fingerprinter, "results-available" );
 }
@@ -42,13 +42,91 @@
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
 
+/* Kernel TLS offload needs GnuTLS to do the I/O on the socket itself */
+#if defined (__linux__) && GNUTLS_VERSION_NUMBER >= 0x030703
+# include <gnutls/socket.h>
+# define HAVE_GNUTLS_KTLS 1
+#endif
+
 typedef struct vlc_tls_gnutls
 {
     vlc_tls_t tls;
     gnutls_session_t session;
     vlc_object_t *obj;
+    vlc_tls_t *sock; /**< underlying transport */
+    char *host; /**< authenticated server name, for session resumption */
 } vlc_tls_gnutls_t;
 
+/*
+ * Client session resumption
+ *
+ * The session parameters of the last connection to each server are kept for
+ * the whole process, including the TLS 1.3 tickets received while the
+ * connection was used, so that the next connection to the same server can
+ * skip the key exchange and certificate transmission.
+ */
+#define GNUTLS_SESSION_CACHE_SIZE 16
+
+struct gnutls_cached_session
+{
+    char *host;
+    gnutls_datum_t data;
+};
+
+static vlc_mutex_t session_cache_lock = VLC_STATIC_MUTEX;
+static struct gnutls_cached_session session_cache[GNUTLS_SESSION_CACHE_SIZE];
+static unsigned session_cache_next;
+
+static struct gnutls_cached_session *gnutls_SessionFind(const char *host)
+{
+    vlc_mutex_assert(&session_cache_lock);
+
+    for (size_t i = 0; i < ARRAY_SIZE(session_cache); i++)
+        if (session_cache[i].host != NULL
+         && strcmp(session_cache[i].host, host) == 0)
+            return &session_cache[i];
+    return NULL;
+}
+
+static void gnutls_SessionLoad(gnutls_session_t session, const char *host)
+{
+    vlc_mutex_lock(&session_cache_lock);
+    const struct gnutls_cached_session *cached = gnutls_SessionFind(host);
+    if (cached != NULL)
+        gnutls_session_set_data(session, cached->data.data,
+                                cached->data.size);
+    vlc_mutex_unlock(&session_cache_lock);
+}
+
+static void gnutls_SessionSave(gnutls_session_t session, const char *host)
+{
+    gnutls_datum_t data;
+
+    if (gnutls_session_get_data2(session, &data) != 0)
+        return;
+
+    vlc_mutex_lock(&session_cache_lock);
+    struct gnutls_cached_session *cached = gnutls_SessionFind(host);
+    if (cached == NULL)
+    {   /* Replace the oldest entry */
+        cached = &session_cache[session_cache_next];
+        session_cache_next = (session_cache_next + 1) % ARRAY_SIZE(session_cache);
+        free(cached->host);
+        cached->host = strdup(host);
+    }
+
+    gnutls_free(cached->data.data);
+    if (likely(cached->host != NULL))
+        cached->data = data;
+    else
+    {
+        gnutls_free(data.data);
+        cached->data.data = NULL;
+        cached->data.size = 0;
+    }
+    vlc_mutex_unlock(&session_cache_lock);
+}
+
 static void gnutls_Banner(vlc_object_t *obj)
 {
     msg_Dbg(obj, "using GnuTLS v%s (built with v"GNUTLS_VERSION")",
@@ -130,9 +208,8 @@ static ssize_t vlc_gnutls_writev(gnutls_transport_ptr_t ptr,
 static int gnutls_GetFD(vlc_tls_t *tls, short *restrict events)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
-    vlc_tls_t *sock = gnutls_transport_get_ptr(priv->session);
 
-    return vlc_tls_GetPollFD(sock, events);
+    return vlc_tls_GetPollFD(priv->sock, events);
 }
 
 static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
@@ -207,6 +284,11 @@ static void gnutls_Close (vlc_tls_t *tls)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
 
+    if (priv->host != NULL)
+    {
+        gnutls_SessionSave(priv->session, priv->host);
+        free(priv->host);
+    }
     gnutls_deinit(priv->session);
     free(priv);
 }
@@ -289,12 +371,23 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
         free (protv);
     }
 
-    gnutls_transport_set_ptr(session, sock);
-    gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
-    gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+#ifdef HAVE_GNUTLS_KTLS
+    /* GnuTLS can only install the session keys into the kernel, if enabled
+     * in its system configuration, when it owns the socket I/O. */
+    if (vlc_tls_IsSocket(sock) && var_InheritBool(obj, "gnutls-ktls"))
+        gnutls_transport_set_int(session, vlc_tls_GetFD(sock));
+    else
+#endif
+    {
+        gnutls_transport_set_ptr(session, sock);
+        gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
+        gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+    }
 
     priv->session = session;
     priv->obj = obj;
+    priv->sock = sock;
+    priv->host = NULL;
 
     vlc_tls_t *tls = &priv->tls;
 
@@ -352,6 +445,16 @@ static int gnutls_Handshake(vlc_tls_t *tls, char **restrict alp)
         msg_Dbg(obj, " - encrypt then MAC (RFC7366) enabled");
     if (flags & GNUTLS_SFLAGS_FALSE_START)
         msg_Dbg(obj, " - false start (RFC7918) enabled");
+    if (gnutls_session_is_resumed(session))
+        msg_Dbg(obj, " - session resumed");
+#ifdef HAVE_GNUTLS_KTLS
+    gnutls_transport_ktls_enable_flags_t ktls =
+        gnutls_transport_is_ktls_enabled(session);
+    if (ktls & GNUTLS_KTLS_SEND)
+        msg_Dbg(obj, " - kernel TLS send offload enabled");
+    if (ktls & GNUTLS_KTLS_RECV)
+        msg_Dbg(obj, " - kernel TLS receive offload enabled");
+#endif
 
     if (alp != NULL)
     {
@@ -388,16 +491,19 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_client_t *crd,
     gnutls_dh_set_prime_bits (session, 1024);
 
     if (likely(hostname != NULL))
+    {
         /* fill Server Name Indication */
         gnutls_server_name_set (session, GNUTLS_NAME_DNS,
                                 hostname, strlen (hostname));
+        gnutls_SessionLoad(session, hostname);
+    }
 
     return &priv->tls;
 }
 
-static int gnutls_ClientHandshake(vlc_tls_t *tls,
-                                  const char *host, const char *service,
-                                  char **restrict alp)
+static int gnutls_ClientHandshakeVerify(vlc_tls_t *tls,
+                                        const char *host, const char *service,
+                                        char **restrict alp)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
     vlc_object_t *obj = priv->obj;
@@ -529,6 +635,19 @@ error:
     return -1;
 }
 
+static int gnutls_ClientHandshake(vlc_tls_t *tls,
+                                  const char *host, const char *service,
+                                  char **restrict alp)
+{
+    vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
+    int val = gnutls_ClientHandshakeVerify(tls, host, service, alp);
+
+    /* Only resume sessions with an authenticated server */
+    if (val == 0 && host != NULL && priv->host == NULL)
+        priv->host = strdup(host);
+    return val;
+}
+
 static void gnutls_ClientDestroy(vlc_tls_client_t *crd)
 {
     gnutls_certificate_credentials_t x509 = crd->sys;
@@ -736,6 +855,12 @@ error:
 #define PRIORITIES_LONGTEXT N_("Ciphers, key exchange methods, " \
     "hash functions and compression methods can be selected. " \
     "Refer to GNU TLS documentation for detailed syntax.")
+#define KTLS_TEXT N_("Kernel TLS offload")
+#define KTLS_LONGTEXT N_( \
+    "Let GNU TLS offload the encryption of the established sessions to " \
+    "the kernel, if it is enabled in the system configuration of GNU TLS " \
+    "(\"ktls = true\").")
+
 static const char *const priorities_values[] = {
     "PERFORMANCE",
     "NORMAL",
@@ -763,6 +888,9 @@ vlc_module_begin ()
     add_string ("gnutls-priorities", "NORMAL", PRIORITIES_TEXT,
                 PRIORITIES_LONGTEXT)
         change_string_list (priorities_values, priorities_text)
+#ifdef HAVE_GNUTLS_KTLS
+    add_bool("gnutls-ktls", true, KTLS_TEXT, KTLS_LONGTEXT)
+#endif
 #ifdef ENABLE_SOUT
     add_submodule ()
         set_description( N_("GNU TLS server") )
@@ -219,6 +219,16 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
     if ( ctx.inputItem == nullptr )
         return medialibrary::parser::Status::Fatal;
 
+    // Unchanged local files were already parsed, either by the preparser or
+    // by a previous run. Playlists are never cached, their items are needed.
+    auto libvlc = vlc_object_instance( m_obj );
+    if ( item.fileType() != medialibrary::IFile::Type::Playlist &&
+         libvlc_MetadataCacheRestore( libvlc, ctx.inputItem.get() ) == true )
+    {
+        populateItem( item, ctx.inputItem.get() );
+        return medialibrary::parser::Status::Success;
+    }
+
     if ( vlc_event_attach( &ctx.inputItem->event_manager, vlc_InputItemAttachmentsFound,
                       &MetadataExtractor::onAttachmentFound, &ctx ) != VLC_SUCCESS )
         return medialibrary::parser::Status::Fatal;
@@ -267,6 +277,9 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
          item.nbLinkedItems() == 0 )
         return medialibrary::parser::Status::Fatal;
 
+    if ( item.fileType() != medialibrary::IFile::Type::Playlist )
+        libvlc_MetadataCacheStore( libvlc, ctx.inputItem.get() );
+
     populateItem( item, ctx.inputItem.get() );
 
     return medialibrary::parser::Status::Success;
@@ -54,6 +54,9 @@ SDDirectory::SDDirectory(const std::string &mrl, SDFileSystemFactory &fs)
 {
     if ( *m_mrl.crbegin() != '/' )
         m_mrl += '/';
+
+    m_runnable.run = runPrefetch;
+    m_runnable.userdata = this;
 }
 
 const std::string &
@@ -65,16 +68,14 @@ SDDirectory::mrl() const
 const std::vector<std::shared_ptr<IFile>> &
 SDDirectory::files() const
 {
-    if ( !m_read_done )
-        read();
+    ensureRead();
     return m_files;
 }
 
 const std::vector<std::shared_ptr<IDirectory>> &
 SDDirectory::dirs() const
 {
-    if ( !m_read_done )
-        read();
+    ensureRead();
     return m_dirs;
 }
 
@@ -188,6 +189,119 @@ static bool request_metadata_sync( libvlc_int_t *libvlc, input_item_t *media,
     return req.success;
 }
 
+void
+SDDirectory::ensureRead() const
+{
+    std::shared_ptr<const SDDirectory> self;
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+
+        if ( m_state == ReadState::Queued &&
+             vlc_executor_Cancel( m_fs.executor(), &m_runnable ) )
+        {
+            /* Not started yet, do not wait for it in the queue */
+            m_state = ReadState::Idle;
+            self = std::move( m_self ); /* released out of the lock */
+        }
+
+        while ( m_state == ReadState::Queued || m_state == ReadState::Running )
+            m_cond.wait( m_mutex );
+
+        if ( m_state == ReadState::Idle )
+        {
+            m_state = ReadState::Running;
+            m_mutex.unlock();
+            std::exception_ptr error;
+            try
+            {
+                read();
+            }
+            catch ( ... )
+            {
+                error = std::current_exception();
+            }
+            m_mutex.lock();
+            m_error = error;
+            m_state = ReadState::Done;
+            m_cond.broadcast();
+        }
+
+        if ( m_error )
+            std::rethrow_exception( m_error );
+        if ( m_children_prefetched )
+            return;
+        m_children_prefetched = true;
+    }
+
+    /* The media library is walking into this directory: start reading the
+     * next level */
+    prefetchChildren();
+}
+
+void
+SDDirectory::prefetchChildren() const
+{
+    if ( m_fs.executor() == nullptr )
+        return;
+
+    /* Nothing to overlap with a single subdirectory */
+    if ( m_dirs.size() < 2 )
+        return;
+
+    for ( const auto& dir : m_dirs )
+    {
+        auto sdDir = std::static_pointer_cast<const SDDirectory>( dir );
+        sdDir->prefetch( sdDir );
+    }
+}
+
+void
+SDDirectory::prefetch( std::shared_ptr<const SDDirectory> self ) const
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+    if ( m_state != ReadState::Idle )
+        return;
+
+    m_state = ReadState::Queued;
+    m_self = std::move( self );
+    vlc_executor_Submit( m_fs.executor(), &m_runnable );
+}
+
+void
+SDDirectory::runPrefetch( void *data )
+{
+    auto dir = static_cast<const SDDirectory *>( data );
+    std::shared_ptr<const SDDirectory> self;
+
+    {
+        vlc::threads::mutex_locker lock( dir->m_mutex );
+        assert( dir->m_state == ReadState::Queued );
+        self = std::move( dir->m_self );
+        if ( dir->m_fs.isStopping() )
+        {
+            dir->m_state = ReadState::Idle;
+            dir->m_cond.broadcast();
+            return;
+        }
+        dir->m_state = ReadState::Running;
+    }
+
+    std::exception_ptr error;
+    try
+    {
+        dir->read();
+    }
+    catch ( ... )
+    {
+        error = std::current_exception();
+    }
+
+    vlc::threads::mutex_locker lock( dir->m_mutex );
+    dir->m_error = error;
+    dir->m_state = ReadState::Done;
+    dir->m_cond.broadcast();
+}
+
 void
 SDDirectory::read() const
 {
@@ -229,8 +343,6 @@ SDDirectory::read() const
             }
         }
     }
-
-    m_read_done = true;
 }
 
 void
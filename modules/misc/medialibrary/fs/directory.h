@@ -24,6 +24,9 @@
 #include <medialibrary/filesystem/IDirectory.h>
 #include <medialibrary/filesystem/IFile.h>
 
+#include <exception>
+#include <vlc_executor.h>
+
 #include "fs.h"
 
 namespace vlc {
@@ -43,13 +46,30 @@ public:
     bool contains( const std::string& file ) const override;
 
 private:
+    enum class ReadState { Idle, Queued, Running, Done };
+
+    void ensureRead() const;
     void read() const;
     void addFile( std::string mrl, fs::IFile::LinkedFileType, std::string linkedWith ) const;
 
+    /* Read the subdirectories in the background, so that they are ready
+     * once the media library walks into them */
+    void prefetchChildren() const;
+    void prefetch( std::shared_ptr<const SDDirectory> self ) const;
+    static void runPrefetch( void *data );
+
     std::string m_mrl;
     SDFileSystemFactory &m_fs;
 
-    mutable bool m_read_done = false;
+    mutable vlc::threads::mutex m_mutex;
+    mutable vlc::threads::condition_variable m_cond;
+    mutable ReadState m_state = ReadState::Idle;
+    mutable std::exception_ptr m_error;
+    mutable bool m_children_prefetched = false;
+    mutable struct vlc_runnable m_runnable;
+    /* held by the queued prefetch task */
+    mutable std::shared_ptr<const SDDirectory> m_self;
+
     mutable std::vector<std::shared_ptr<fs::IFile>> m_files;
     mutable std::vector<std::shared_ptr<fs::IDirectory>> m_dirs;
     mutable std::shared_ptr<IDevice> m_device;
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <vlc_services_discovery.h>
+#include <vlc_executor.h>
 #include <medialibrary/IDeviceLister.h>
 #include <medialibrary/filesystem/IDevice.h>
 #include <medialibrary/IMediaLibrary.h>
@@ -33,6 +34,9 @@
 #include "util.h"
 #include "fs.h"
 
+/* Number of directories read concurrently */
+#define SD_READ_THREADS 4
+
 namespace vlc {
   namespace medialibrary {
 
@@ -49,6 +53,20 @@ SDFileSystemFactory::SDFileSystemFactory(vlc_object_t *parent,
 {
     m_isNetwork = strncasecmp( m_scheme.c_str(), "file://",
                                m_scheme.length() ) != 0;
+    /* Reading ahead is only an optimization, do without it on error */
+    m_executor = vlc_executor_New( SD_READ_THREADS );
+}
+
+SDFileSystemFactory::~SDFileSystemFactory()
+{
+    if ( m_executor != nullptr )
+    {
+        /* The queued directories hold themselves until they are run, flush
+         * them without reading them */
+        m_stopping = true;
+        vlc_executor_WaitIdle( m_executor );
+        vlc_executor_Delete( m_executor );
+    }
 }
 
 std::shared_ptr<fs::IDirectory>
@@ -130,6 +148,18 @@ SDFileSystemFactory::libvlc() const
     return vlc_object_instance(m_parent);
 }
 
+vlc_executor_t *
+SDFileSystemFactory::executor() const
+{
+    return m_executor;
+}
+
+bool
+SDFileSystemFactory::isStopping() const
+{
+    return m_stopping;
+}
+
 void SDFileSystemFactory::onDeviceMounted(const std::string& uuid,
                                           const std::string& mountpoint,
                                           bool removable)
@@ -21,6 +21,7 @@
 #ifndef SD_FS_H
 #define SD_FS_H
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <vlc_common.h>
@@ -30,6 +31,7 @@
 #include <medialibrary/IDeviceLister.h>
 
 struct libvlc_int_t;
+typedef struct vlc_executor vlc_executor_t;
 
 namespace medialibrary {
 class IDeviceListerCb;
@@ -47,6 +49,7 @@ public:
     SDFileSystemFactory(vlc_object_t *m_parent,
                         IMediaLibrary* ml,
                         const std::string &scheme);
+    ~SDFileSystemFactory();
 
     std::shared_ptr<IDirectory>
     createDirectory(const std::string &mrl) override;
@@ -81,6 +84,13 @@ public:
     libvlc_int_t *
     libvlc() const;
 
+    /* Used to read directories ahead, may be NULL */
+    vlc_executor_t *
+    executor() const;
+
+    bool
+    isStopping() const;
+
     void
     onDeviceMounted(const std::string& uuid, const std::string& mountpoint, bool removable) override;
 
@@ -105,6 +115,8 @@ private:
     std::shared_ptr<IDeviceLister> m_deviceLister;
     IFileSystemFactoryCb *m_callbacks;
     bool m_isNetwork;
+    vlc_executor_t *m_executor;
+    std::atomic<bool> m_stopping{ false };
 
     mutable vlc::threads::mutex m_mutex;
     mutable vlc::threads::condition_variable m_cond;
@@ -57,7 +57,8 @@ static inline block_t *AV1_Pack_Sample(block_t *p_block)
                 }
                 else
                 {
-                    memmove(&p_block->p_buffer[i_offset], &p_obu[i_obu], i_obu);
+                    memmove(&p_block->p_buffer[i_offset], &p_obu[i_obu],
+                            p_block->i_buffer - i_offset - i_obu);
                     p_block->i_buffer -= i_obu;
                 }
                 AV1_OBU_iterator_init(&ctx, p_block->p_buffer,
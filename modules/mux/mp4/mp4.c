@@ -54,6 +54,21 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define FRAGDURATION_TEXT N_("Fragment duration (ms)")
+#define FRAGDURATION_LONGTEXT N_(\
+    "Maximum duration of the fragments of the fragmented and streamable " \
+    "MP4 muxer.")
+
+#define FRAGKEYFRAMES_TEXT N_("Start fragments on keyframes")
+#define FRAGKEYFRAMES_LONGTEXT N_(\
+    "Write out the pending fragment as soon as a video keyframe is " \
+    "received, rather than waiting for the fragment duration.")
+
+#define CMAF_TEXT N_("Create CMAF fragments")
+#define CMAF_LONGTEXT N_(\
+    "Write Common Media Application Format compliant fragments, with one " \
+    "track per fragment and no fragment index.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static void CloseFrag  (vlc_object_t *);
@@ -68,6 +83,12 @@ vlc_module_begin ()
 
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT)
+    add_integer(SOUT_CFG_PREFIX "frag-duration", 1500,
+                FRAGDURATION_TEXT, FRAGDURATION_LONGTEXT)
+        change_integer_range(100, 60000)
+    add_bool(SOUT_CFG_PREFIX "frag-keyframes", false,
+             FRAGKEYFRAMES_TEXT, FRAGKEYFRAMES_LONGTEXT)
+    add_bool(SOUT_CFG_PREFIX "cmaf", false, CMAF_TEXT, CMAF_LONGTEXT)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -87,7 +108,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "frag-duration", "frag-keyframes", "cmaf", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -173,6 +194,10 @@ typedef struct
     /* mp4frag */
     vlc_tick_t     i_written_duration;
     uint32_t       i_mfhd_sequence;
+    vlc_tick_t     i_fragment_duration;
+    bool           b_fragment_keyframes;
+    bool           b_fragment_index;
+    bool           b_cmaf;
 } sout_mux_sys_t;
 
 static void mp4_stream_Delete(mp4_stream_t *p_stream)
@@ -291,6 +316,16 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_written_duration= 0;
     p_sys->i_start_dts = VLC_TICK_INVALID;
     p_sys->i_mfhd_sequence = 1;
+    p_sys->i_fragment_duration =
+        VLC_TICK_FROM_MS(var_GetInteger(p_mux, SOUT_CFG_PREFIX "frag-duration"));
+    p_sys->b_fragment_keyframes = var_GetBool(p_mux, SOUT_CFG_PREFIX "frag-keyframes");
+    p_sys->b_cmaf = (options & FRAGMENTED) &&
+                    var_GetBool(p_mux, SOUT_CFG_PREFIX "cmaf");
+    /* The index refers to the fragments by absolute position, so it is only
+     * written to files. It is not collected otherwise, keeping the memory
+     * use of long lived streams bounded. */
+    p_sys->b_fragment_index = (options & FRAGMENTED) && !p_sys->b_cmaf &&
+                              !strcmp(p_mux->psz_mux, "mp4frag");
 
     p_mux->p_sys        = p_sys;
     p_mux->pf_control   = Control;
@@ -303,6 +338,12 @@ static int Open(vlc_object_t *p_this)
         mp4mux_SetBrand(p_sys->muxh, BRAND_3gp6, 0x0);
         mp4mux_AddExtraBrand(p_sys->muxh, BRAND_3gp4);
     }
+    else if(p_sys->b_cmaf)
+    {
+        mp4mux_SetBrand(p_sys->muxh, BRAND_iso6, 0x0);
+        mp4mux_AddExtraBrand(p_sys->muxh, BRAND_cmfc);
+        mp4mux_AddExtraBrand(p_sys->muxh, BRAND_isom);
+    }
     else
     {
         mp4mux_SetBrand(p_sys->muxh, BRAND_isom, 0x0);
@@ -900,8 +941,6 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
-#define FRAGMENT_LENGTH  VLC_TICK_FROM_MS(1500)
-
 #define ENQUEUE_ENTRY(object, entry) \
     do {\
         if (object.p_last)\
@@ -960,7 +999,8 @@ static void AddKeyframeEntry(mp4_stream_t *p_stream, const uint64_t i_moof_pos,
  * requires base_offset_is_moof and then comply to late iso brand spec which
  * breaks clients. */
 static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
-                        vlc_tick_t i_barrier_time, const uint64_t i_write_pos)
+                        vlc_tick_t i_barrier_time, const uint64_t i_write_pos,
+                        const mp4_stream_t *p_only)
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
 
@@ -989,6 +1029,10 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
     {
         mp4_stream_t *p_stream = p_sys->pp_streams[i_trak];
 
+        /* CMAF fragments only carry a single track */
+        if (p_only != NULL && p_stream != p_only)
+            continue;
+
         /* *** add /moof/traf *** */
         bo_t *traf = box_new("traf");
         if(!traf)
@@ -1032,6 +1076,9 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
             i_tfhd_flags |= MP4_TFHD_DURATION_IS_EMPTY;
         }
 
+        if (p_sys->b_cmaf)
+            i_tfhd_flags |= MP4_TFHD_DEFAULT_BASE_IS_MOOF;
+
         /* *** add /moof/traf/tfhd *** */
         bo_t *tfhd = box_full_new("tfhd", 0, i_tfhd_flags);
         if(!tfhd)
@@ -1068,7 +1115,11 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
         {
             uint32_t i_trun_flags = 0x0;
 
-            if (p_stream->b_hasiframes && !(p_stream->read.p_first->p_block->i_flags & BLOCK_FLAG_TYPE_I))
+            /* CMAF requires signaling the sync samples, the default
+             * sample flags from trex flag them all as sync */
+            if (p_sys->b_cmaf && p_stream->b_hasiframes)
+                i_trun_flags |= MP4_TRUN_SAMPLE_FLAGS;
+            else if (p_stream->b_hasiframes && !(p_stream->read.p_first->p_block->i_flags & BLOCK_FLAG_TYPE_I))
                 i_trun_flags |= MP4_TRUN_FIRST_FLAGS;
 
             if (!b_allsamelength ||
@@ -1128,6 +1179,14 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
                 if (i_trun_flags & MP4_TRUN_SAMPLE_SIZE)
                     bo_add_32be(trun, p_entry->p_block->i_buffer); // sample size
 
+                if (i_trun_flags & MP4_TRUN_SAMPLE_FLAGS)
+                {
+                    if (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I)
+                        bo_add_32be(trun, 2<<24); // does not depend on others
+                    else
+                        bo_add_32be(trun, (1<<24) | (1<<16)); // non keyframe
+                }
+
                 if (i_trun_flags & MP4_TRUN_SAMPLE_TIME_OFFSET)
                 {
                     vlc_tick_t i_diff = 0;
@@ -1146,7 +1205,8 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
                 i_sample++;
 
                 /* Add keyframe entry if needed */
-                if (p_stream->b_hasiframes && (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
+                if (p_sys->b_fragment_index &&
+                    p_stream->b_hasiframes && (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
                     (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == VIDEO_ES ||
                      mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == AUDIO_ES))
                 {
@@ -1177,8 +1237,10 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
         bo_set_32be(moof, i_fixupoffset, bo_size(moof) + 8);
     }
 
-    /* set iframe flag, so the streaming server always starts from moof */
-    moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
+    /* set iframe flag, so the streaming server always starts from moof,
+     * CMAF fragments are flagged by WriteFragments() */
+    if (!p_sys->b_cmaf)
+        moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
 
     return moof;
 }
@@ -1287,7 +1349,7 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    vlc_tick_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    vlc_tick_t i_barrier_time = p_sys->i_written_duration + p_sys->i_fragment_duration;
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
 
@@ -1322,24 +1384,56 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
     if (!p_sys->b_header_sent)
         FlushHeader(p_mux);
 
-    if (b_has_samples)
-        moof = GetMoofBox(p_mux, &i_mdat_size, (b_flush)?0:i_barrier_time, p_sys->i_pos);
+    if (!b_has_samples)
+        return;
 
-    if (moof && i_mdat_size == 0)
+    /* With one moof per track, only the first moof of the fragments can be
+     * a starting point, and only if every track starts with a sync sample */
+    bool b_independent = true;
+    for (unsigned int i = 0; p_sys->b_cmaf && i < p_sys->i_nb_streams; i++)
     {
-        block_Release(moof->b);
-        FREENULL(moof);
+        const mp4_stream_t *p_stream = p_sys->pp_streams[i];
+        if (p_stream->read.p_first && p_stream->b_hasiframes &&
+            !(p_stream->read.p_first->p_block->i_flags & BLOCK_FLAG_TYPE_I))
+            b_independent = false;
     }
 
-    if (moof)
+    bool b_written = false;
+    for (unsigned int i = 0; i < (p_sys->b_cmaf ? p_sys->i_nb_streams : 1); i++)
     {
-        msg_Dbg(p_mux, "writing moof @ %"PRId64, p_sys->i_pos);
-        p_sys->i_pos += bo_size(moof);
-        assert(moof->b->i_flags & BLOCK_FLAG_TYPE_I); /* http sout */
-        box_send(p_mux, moof);
-        msg_Dbg(p_mux, "writing mdat @ %"PRId64, p_sys->i_pos);
-        WriteFragmentMDAT(p_mux, i_mdat_size);
+        const mp4_stream_t *p_only = NULL;
+        if (p_sys->b_cmaf)
+        {
+            p_only = p_sys->pp_streams[i];
+            if (!p_only->read.p_first)
+                continue;
+        }
 
+        moof = GetMoofBox(p_mux, &i_mdat_size, (b_flush)?0:i_barrier_time,
+                          p_sys->i_pos, p_only);
+
+        if (moof && i_mdat_size == 0)
+        {
+            block_Release(moof->b);
+            FREENULL(moof);
+        }
+
+        if (moof)
+        {
+            msg_Dbg(p_mux, "writing moof @ %"PRId64, p_sys->i_pos);
+            p_sys->i_pos += bo_size(moof);
+            if (p_sys->b_cmaf && b_independent && !b_written)
+                moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
+            assert(p_sys->b_cmaf || (moof->b->i_flags & BLOCK_FLAG_TYPE_I)); /* http sout */
+            box_send(p_mux, moof);
+            msg_Dbg(p_mux, "writing mdat @ %"PRId64, p_sys->i_pos);
+            WriteFragmentMDAT(p_mux, i_mdat_size);
+            b_written = true;
+        }
+    }
+
+    if (b_written)
+    {
         /* update iframe point */
         for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
         {
@@ -1405,7 +1499,7 @@ static void CloseFrag(vlc_object_t *p_this)
 
     /* Write indexes, but only for non streamed content
        as they refer to moof by absolute position */
-    if (!strcmp(p_mux->psz_mux, "mp4frag"))
+    if (p_sys->b_fragment_index)
     {
         bo_t *mfra = GetMfraBox(p_mux);
         if (mfra)
@@ -1475,7 +1569,8 @@ static int MuxFrag(sout_mux_t *p_mux)
         p_stream->p_held_entry = NULL;
 
         if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < FRAGMENT_LENGTH)
+            (p_sys->b_fragment_keyframes ||
+             mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < p_sys->i_fragment_duration))
         {
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
@@ -1515,8 +1610,8 @@ static int MuxFrag(sout_mux_t *p_mux)
     for (unsigned int i=0; i<p_sys->i_nb_streams; i++)
     {
         const mp4_stream_t *p_s = p_sys->pp_streams[i];
-        if (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != VIDEO_ES &&
-            mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != AUDIO_ES)
+        if (mp4mux_track_GetFmt(p_s->tinfo)->i_cat != VIDEO_ES &&
+            mp4mux_track_GetFmt(p_s->tinfo)->i_cat != AUDIO_ES)
             continue;
         if (mp4mux_track_GetDuration(p_s->tinfo) < i_min_read_duration)
             i_min_read_duration = mp4mux_track_GetDuration(p_s->tinfo);
@@ -1528,8 +1623,22 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= p_sys->i_fragment_duration)
         WriteFragments(p_mux, false);
+    /* or every stream got up to a new keyframe */
+    else if (p_sys->b_fragment_keyframes)
+    {
+        for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
+        {
+            const mp4_stream_t *p_s = p_sys->pp_streams[i];
+            if (p_s->i_last_iframe_time > p_sys->i_written_duration &&
+                p_sys->i_read_duration >= p_s->i_last_iframe_time)
+            {
+                WriteFragments(p_mux, false);
+                break;
+            }
+        }
+    }
 
     return VLC_SUCCESS;
 }
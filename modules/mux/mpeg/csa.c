@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 
 #include "csa.h"
 
@@ -607,3 +608,231 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+
+/*****************************************************************************
+ * Batches
+ *****************************************************************************/
+typedef struct
+{
+    uint8_t *p_data; /* first block of the payload */
+    int      i_size; /* bytes to XOR with the key stream after it */
+} csa_lane_t;
+
+/* Transposes the 8x8 bits matrix whose rows are the bytes of x */
+static inline uint64_t csa_Transpose8x8( uint64_t x )
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & UINT64_C(0x00AA00AA00AA00AA);
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & UINT64_C(0x0000CCCC0000CCCC);
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & UINT64_C(0x00000000F0F0F0F0);
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+#define BS_WORD         uint64_t
+#define BS_ZERO         UINT64_C(0)
+#define BS_ONES         (~UINT64_C(0))
+#define BS_AND(a, b)    ((a) & (b))
+#define BS_XOR(a, b)    ((a) ^ (b))
+#define BS_FUNC(name)   name##_c
+#define BS_ATTR
+#include "csa_bitslice.h"
+#define CSA_LANES_C 64
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CSA_LANES_SSE2 128
+#  define BS_WORD       __m128i
+#  define BS_ZERO       _mm_setzero_si128()
+#  define BS_ONES       _mm_set1_epi32(-1)
+#  define BS_AND(a, b)  _mm_and_si128(a, b)
+#  define BS_XOR(a, b)  _mm_xor_si128(a, b)
+#  define BS_FUNC(name) name##_sse2
+#  define BS_ATTR       __attribute__((__target__("sse2")))
+#  include "csa_bitslice.h"
+# endif
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CSA_LANES_AVX2 256
+#  define BS_WORD       __m256i
+#  define BS_ZERO       _mm256_setzero_si256()
+#  define BS_ONES       _mm256_set1_epi32(-1)
+#  define BS_AND(a, b)  _mm256_and_si256(a, b)
+#  define BS_XOR(a, b)  _mm256_xor_si256(a, b)
+#  define BS_FUNC(name) name##_avx2
+#  define BS_ATTR       __attribute__((__target__("avx2")))
+#  include "csa_bitslice.h"
+# endif
+#endif
+
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CSA_LANES_NEON 128
+# define BS_WORD        uint8x16_t
+# define BS_ZERO        vdupq_n_u8(0)
+# define BS_ONES        vdupq_n_u8(0xff)
+# define BS_AND(a, b)   vandq_u8(a, b)
+# define BS_XOR(a, b)   veorq_u8(a, b)
+# define BS_FUNC(name)  name##_neon
+# define BS_ATTR
+# include "csa_bitslice.h"
+#endif
+
+/* Same as csa_BlockCypher() on CSA_BLOCK_LANES blocks at once, with the
+ * byte i of a block in the bits 8*i to 8*i+7 of its word */
+#define CSA_BLOCK_LANES 8
+
+static void csa_BlockCypherLanes( const uint8_t kk[57],
+                                  uint64_t R[CSA_BLOCK_LANES] )
+{
+    for( int i = 1; i <= 56; i++ )
+    {
+        for( int l = 0; l < CSA_BLOCK_LANES; l++ )
+        {
+            const uint64_t R1 = R[l] & 0xff;
+            const uint64_t sbox_out = block_sbox[ kk[i] ^ (R[l] >> 56) ];
+            const uint64_t perm_out = block_perm[sbox_out];
+
+            R[l] = (R[l] >> 8) ^ (R1 * UINT64_C(0x01010100))
+                 ^ (perm_out << 40) ^ ((R1 ^ sbox_out) << 56);
+        }
+    }
+}
+
+/* Below this many packets, the scalar stream cypher is faster */
+#define CSA_LANES_MIN 4
+
+static void csa_StreamLane( csa_t *c, uint8_t *ck, const csa_lane_t *lane )
+{
+    uint8_t stream[8];
+
+    csa_StreamCypher( c, 1, ck, lane->p_data, stream );
+    for( int i = 0; i < lane->i_size; i += 8 )
+    {
+        csa_StreamCypher( c, 0, ck, NULL, stream );
+        for( int j = 0; j < 8 && i + j < lane->i_size; j++ )
+            lane->p_data[8 + i + j] ^= stream[j];
+    }
+}
+
+static void csa_EncryptLanes( csa_t *c, uint8_t *ck, uint8_t *kk,
+                              const csa_lane_t *lanes, unsigned i_lanes )
+{
+    /* The block cypher chains the blocks of a packet from the last one.
+     * Several packets are interleaved to hide the latency of the tables. */
+    for( unsigned g = 0; g < i_lanes; g += CSA_BLOCK_LANES )
+    {
+        const unsigned i_group = __MIN( i_lanes - g, CSA_BLOCK_LANES );
+        uint64_t R[CSA_BLOCK_LANES] = { 0 };
+        int n[CSA_BLOCK_LANES], i_max = 0;
+
+        for( unsigned l = 0; l < i_group; l++ )
+        {
+            n[l] = (8 + lanes[g+l].i_size) / 8;
+            i_max = __MAX( i_max, n[l] );
+        }
+
+        for( int k = 0; k < i_max; k++ )
+        {
+            for( unsigned l = 0; l < i_group; l++ )
+                if( n[l] - k > 0 )
+                    R[l] ^= GetQWLE( &lanes[g+l].p_data[8*(n[l]-k-1)] );
+
+            csa_BlockCypherLanes( kk, R );
+
+            for( unsigned l = 0; l < i_group; l++ )
+                if( n[l] - k > 0 )
+                    SetQWLE( &lanes[g+l].p_data[8*(n[l]-k-1)], R[l] );
+        }
+    }
+
+    /* The stream cypher is then run on the batch, as many packets at once as
+     * the widest available words allow */
+    while( i_lanes > 0 )
+    {
+        unsigned i_run;
+
+#ifdef CSA_LANES_AVX2
+        if( i_lanes > CSA_LANES_AVX2 / 2 && vlc_CPU_AVX2() )
+        {
+            i_run = __MIN( i_lanes, CSA_LANES_AVX2 );
+            csa_StreamBatch_avx2( ck, lanes, i_run );
+        }
+        else
+#endif
+#ifdef CSA_LANES_SSE2
+        if( i_lanes > CSA_LANES_SSE2 / 2 && vlc_CPU_SSE2() )
+        {
+            i_run = __MIN( i_lanes, CSA_LANES_SSE2 );
+            csa_StreamBatch_sse2( ck, lanes, i_run );
+        }
+        else
+#endif
+#ifdef CSA_LANES_NEON
+        if( i_lanes > CSA_LANES_NEON / 2 && vlc_CPU_ARM_NEON() )
+        {
+            i_run = __MIN( i_lanes, CSA_LANES_NEON );
+            csa_StreamBatch_neon( ck, lanes, i_run );
+        }
+        else
+#endif
+        if( i_lanes >= CSA_LANES_MIN )
+        {
+            i_run = __MIN( i_lanes, CSA_LANES_C );
+            csa_StreamBatch_c( ck, lanes, i_run );
+        }
+        else
+        {
+            i_run = 1;
+            csa_StreamLane( c, ck, lanes );
+        }
+        lanes += i_run;
+        i_lanes -= i_run;
+    }
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch:
+ *****************************************************************************/
+void csa_EncryptBatch( csa_t *c, uint8_t *const *pp_pkt, unsigned i_count,
+                       int i_pkt_size )
+{
+    csa_lane_t lanes[CSA_BATCH_MAX];
+    unsigned i_lanes = 0;
+    uint8_t *ck = c->use_odd ? c->o_ck : c->e_ck;
+    uint8_t *kk = c->use_odd ? c->o_kk : c->e_kk;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pp_pkt[i];
+        int i_hdr = 4;
+
+        /* set transport scrambling control */
+        pkt[3] |= c->use_odd ? 0xc0 : 0x80;
+
+        if( pkt[3]&0x20 )
+        {
+            /* skip adaption field */
+            i_hdr += pkt[4] + 1;
+        }
+        if( (i_pkt_size - i_hdr) / 8 <= 0 )
+        {
+            pkt[3] &= 0x3f;
+            continue;
+        }
+
+        lanes[i_lanes].p_data = &pkt[i_hdr];
+        lanes[i_lanes].i_size = i_pkt_size - i_hdr - 8;
+        if( ++i_lanes == CSA_BATCH_MAX )
+        {
+            csa_EncryptLanes( c, ck, kk, lanes, i_lanes );
+            i_lanes = 0;
+        }
+    }
+    if( i_lanes > 0 )
+        csa_EncryptLanes( c, ck, kk, lanes, i_lanes );
+}
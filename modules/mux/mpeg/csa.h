@@ -30,6 +30,7 @@ typedef struct csa_t csa_t;
 #define csa_UseKey  __csa_UseKey
 #define csa_Decrypt __csa_decrypt
 #define csa_Encrypt __csa_encrypt
+#define csa_EncryptBatch __csa_encrypt_batch
 
 csa_t *csa_New( void );
 void   csa_Delete( csa_t * );
@@ -40,4 +41,11 @@ void   csa_UseKey( vlc_object_t *p_caller, csa_t *, bool use_odd );
 void   csa_Decrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 void   csa_Encrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 
+/* Number of packets csa_EncryptBatch() scrambles in parallel at most */
+#define CSA_BATCH_MAX 256
+
+/* Same as calling csa_Encrypt() on every packet, but faster for large counts */
+void   csa_EncryptBatch( csa_t *, uint8_t *const *pp_pkt, unsigned i_count,
+                         int i_pkt_size );
+
 #endif /* _CSA_H */
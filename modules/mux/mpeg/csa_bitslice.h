@@ -0,0 +1,271 @@
+/*****************************************************************************
+ * csa_bitslice.h: bitsliced DVB-CSA stream cypher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * This file is included by csa.c once per word type. Every bit of a word
+ * holds the state of one packet (lane), so that a single run of the stream
+ * cypher produces the key streams of as many packets as the word has bits.
+ *
+ * The includer defines:
+ *  - BS_WORD: the word type,
+ *  - BS_ZERO and BS_ONES: the all clear and all set words,
+ *  - BS_AND(a,b) and BS_XOR(a,b): the bitwise operators,
+ *  - BS_FUNC(name): the decorated name of the functions,
+ *  - BS_ATTR: the attributes of the functions (e.g. the target).
+ * They are undefined at the end of this file.
+ */
+
+#define BS_LANES        (8 * sizeof (BS_WORD))
+#define BS_NOT(a)       BS_XOR(a, BS_ONES)
+/* s ? b : a */
+#define BS_MUX(s, a, b) BS_XOR(a, BS_AND(BS_XOR(a, b), s))
+
+typedef struct
+{
+    /* nibbles, one word per bit */
+    BS_WORD A[11][4];
+    BS_WORD B[11][4];
+    BS_WORD X[4], Y[4], Z[4];
+    BS_WORD D[4], E[4], F[4];
+    BS_WORD p, q, r;
+} BS_FUNC(csa_bs_state_t);
+
+static inline BS_ATTR BS_WORD BS_FUNC(csa_bs_Load)( const uint8_t *p )
+{
+    BS_WORD w;
+    memcpy( &w, p, sizeof( w ) );
+    return w;
+}
+
+static inline BS_ATTR void BS_FUNC(csa_bs_Store)( uint8_t *p, BS_WORD w )
+{
+    memcpy( p, &w, sizeof( w ) );
+}
+
+/* Evaluates one of the 5 to 2 bits s-boxes as a tree of multiplexers,
+ * in[0] being the least significant bit of the s-box index */
+static inline BS_ATTR void BS_FUNC(csa_bs_Sbox)( const int sbox[0x20],
+                                                 const BS_WORD in[5],
+                                                 BS_WORD out[2] )
+{
+    const BS_WORD leaf[4] = { BS_ZERO, BS_NOT(in[0]), in[0], BS_ONES };
+
+    for( int b = 0; b < 2; b++ )
+    {
+        BS_WORD t[16];
+
+        for( int i = 0; i < 16; i++ )
+            t[i] = leaf[((sbox[2*i] >> b) & 1) | (((sbox[2*i+1] >> b) & 1) << 1)];
+        for( int l = 1, n = 8; n > 0; l++, n /= 2 )
+            for( int i = 0; i < n; i++ )
+                t[i] = BS_MUX( in[l], t[2*i], t[2*i+1] );
+        out[b] = t[0];
+    }
+}
+
+/* One iteration of csa_StreamCypher(), producing 2 bits of key stream */
+static inline BS_ATTR void BS_FUNC(csa_bs_Step)( BS_FUNC(csa_bs_state_t) *s,
+                                                 const BS_WORD *in_a,
+                                                 const BS_WORD *in_b,
+                                                 BS_WORD out[2] )
+{
+    BS_WORD (*A)[4] = s->A;
+    BS_WORD (*B)[4] = s->B;
+    BS_WORD s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+    BS_WORD extra_B[4], next_A1[4], next_B1[4], next_E[4];
+
+#define SBOX(n, a,ab, b,bb, c,cb, d,db, e,eb) do { \
+        const BS_WORD in[5] = { A[e][eb], A[d][db], A[c][cb], A[b][bb], A[a][ab] }; \
+        BS_FUNC(csa_bs_Sbox)( sbox##n, in, s##n ); \
+    } while(0)
+    SBOX(1, 4,0, 1,2, 6,1, 7,3, 9,0);
+    SBOX(2, 2,1, 3,2, 6,3, 7,0, 9,1);
+    SBOX(3, 1,3, 2,0, 5,1, 5,3, 6,2);
+    SBOX(4, 3,3, 1,1, 2,3, 4,2, 8,0);
+    SBOX(5, 5,2, 4,3, 6,0, 8,1, 9,2);
+    SBOX(6, 3,1, 4,1, 5,0, 7,2, 9,3);
+    SBOX(7, 2,2, 3,0, 7,1, 8,2, 8,3);
+#undef SBOX
+
+    extra_B[3] = BS_XOR( BS_XOR( B[3][0], B[6][1] ), BS_XOR( B[7][2], B[9][3] ) );
+    extra_B[2] = BS_XOR( BS_XOR( B[6][0], B[8][1] ), BS_XOR( B[3][3], B[4][2] ) );
+    extra_B[1] = BS_XOR( BS_XOR( B[5][3], B[8][2] ), BS_XOR( B[4][0], B[5][1] ) );
+    extra_B[0] = BS_XOR( BS_XOR( B[9][2], B[6][3] ), BS_XOR( B[3][1], B[8][0] ) );
+
+    for( int k = 0; k < 4; k++ )
+    {
+        next_A1[k] = BS_XOR( A[10][k], s->X[k] );
+        next_B1[k] = BS_XOR( BS_XOR( B[7][k], B[10][k] ), s->Y[k] );
+        if( in_a != NULL )
+        {
+            next_A1[k] = BS_XOR( next_A1[k], BS_XOR( s->D[k], in_a[k] ) );
+            next_B1[k] = BS_XOR( next_B1[k], in_b[k] );
+        }
+    }
+
+    /* if p=1, rotate left */
+    const BS_WORD b3 = next_B1[3];
+    next_B1[3] = BS_MUX( s->p, next_B1[3], next_B1[2] );
+    next_B1[2] = BS_MUX( s->p, next_B1[2], next_B1[1] );
+    next_B1[1] = BS_MUX( s->p, next_B1[1], next_B1[0] );
+    next_B1[0] = BS_MUX( s->p, next_B1[0], b3 );
+
+    /* T3 and T4 */
+    BS_WORD carry = s->r;
+    for( int k = 0; k < 4; k++ )
+    {
+        const BS_WORD t = BS_XOR( s->Z[k], s->E[k] );
+        const BS_WORD sum = BS_XOR( t, carry );
+
+        s->D[k] = BS_XOR( t, extra_B[k] );
+        next_E[k] = s->F[k];
+        carry = BS_XOR( BS_AND( s->Z[k], s->E[k] ), BS_AND( carry, t ) );
+        s->F[k] = BS_MUX( s->q, s->E[k], sum );
+        s->E[k] = next_E[k];
+    }
+    s->r = BS_MUX( s->q, s->r, carry );
+
+    for( int i = 10; i > 1; i-- )
+        for( int k = 0; k < 4; k++ )
+        {
+            A[i][k] = A[i-1][k];
+            B[i][k] = B[i-1][k];
+        }
+    for( int k = 0; k < 4; k++ )
+    {
+        A[1][k] = next_A1[k];
+        B[1][k] = next_B1[k];
+    }
+
+    s->X[0] = s1[1]; s->X[1] = s2[1]; s->X[2] = s3[0]; s->X[3] = s4[0];
+    s->Y[0] = s3[1]; s->Y[1] = s4[1]; s->Y[2] = s5[0]; s->Y[3] = s6[0];
+    s->Z[0] = s5[1]; s->Z[1] = s6[1]; s->Z[2] = s1[0]; s->Z[3] = s2[0];
+    s->p = s7[1];
+    s->q = s7[0];
+
+    out[1] = BS_XOR( s->D[2], s->D[3] );
+    out[0] = BS_XOR( s->D[0], s->D[1] );
+}
+
+/*****************************************************************************
+ * csa_StreamBatch: initializes the stream cypher of every lane with its first
+ * block, then XORs the following bytes with the key stream
+ *****************************************************************************/
+static BS_ATTR void BS_FUNC(csa_StreamBatch)( const uint8_t ck[8],
+                                              const csa_lane_t *lanes,
+                                              unsigned i_lanes )
+{
+    BS_FUNC(csa_bs_state_t) s;
+    const BS_WORD bit[2] = { BS_ZERO, BS_ONES };
+    uint8_t bytes[8][sizeof (BS_WORD)];
+    const unsigned i_groups = (i_lanes + 7) / 8;
+    int i_max = 0;
+
+    assert( i_lanes > 0 && i_lanes <= BS_LANES );
+
+    for( int i = 0; i < 4; i++ )
+        for( int k = 0; k < 4; k++ )
+        {
+            s.A[1+2*i+0][k] = bit[(ck[i] >> (4 + k)) & 1];
+            s.A[1+2*i+1][k] = bit[(ck[i] >> k) & 1];
+            s.B[1+2*i+0][k] = bit[(ck[4+i] >> (4 + k)) & 1];
+            s.B[1+2*i+1][k] = bit[(ck[4+i] >> k) & 1];
+        }
+    for( int k = 0; k < 4; k++ )
+    {
+        s.A[9][k] = s.A[10][k] = BS_ZERO;
+        s.B[9][k] = s.B[10][k] = BS_ZERO;
+        s.X[k] = s.Y[k] = s.Z[k] = BS_ZERO;
+        s.D[k] = s.E[k] = s.F[k] = BS_ZERO;
+    }
+    s.p = s.q = s.r = BS_ZERO;
+
+    for( unsigned l = 0; l < i_lanes; l++ )
+        if( lanes[l].i_size > i_max )
+            i_max = lanes[l].i_size;
+
+    /* init with the first block of every lane */
+    memset( bytes, 0, sizeof( bytes ) );
+    for( int i = 0; i < 8; i++ )
+    {
+        BS_WORD in[8];
+
+        for( unsigned g = 0; g < i_groups; g++ )
+        {
+            uint64_t x = 0;
+            for( unsigned c = 0; c < 8 && 8 * g + c < i_lanes; c++ )
+                x |= (uint64_t)lanes[8 * g + c].p_data[i] << (8 * c);
+            x = csa_Transpose8x8( x );
+            for( int k = 0; k < 8; k++ )
+                bytes[k][g] = x >> (8 * k);
+        }
+        for( int k = 0; k < 8; k++ )
+            in[k] = BS_FUNC(csa_bs_Load)( bytes[k] );
+
+        for( int j = 0; j < 4; j++ )
+        {
+            BS_WORD out[2];
+            /* in1 is the high nibble, in2 the low one */
+            if( j % 2 )
+                BS_FUNC(csa_bs_Step)( &s, &in[0], &in[4], out );
+            else
+                BS_FUNC(csa_bs_Step)( &s, &in[4], &in[0], out );
+        }
+    }
+
+    /* generate */
+    for( int i = 0; i < i_max; i++ )
+    {
+        for( int j = 0; j < 4; j++ )
+        {
+            BS_WORD out[2];
+
+            BS_FUNC(csa_bs_Step)( &s, NULL, NULL, out );
+            BS_FUNC(csa_bs_Store)( bytes[7 - 2 * j], out[1] );
+            BS_FUNC(csa_bs_Store)( bytes[6 - 2 * j], out[0] );
+        }
+
+        for( unsigned g = 0; g < i_groups; g++ )
+        {
+            uint64_t x = 0;
+            for( int k = 0; k < 8; k++ )
+                x |= (uint64_t)bytes[k][g] << (8 * k);
+            x = csa_Transpose8x8( x );
+            for( unsigned c = 0; c < 8 && 8 * g + c < i_lanes; c++ )
+            {
+                const csa_lane_t *lane = &lanes[8 * g + c];
+                if( i < lane->i_size )
+                    lane->p_data[8 + i] ^= x >> (8 * c);
+            }
+        }
+    }
+}
+
+#undef BS_MUX
+#undef BS_NOT
+#undef BS_LANES
+
+#undef BS_WORD
+#undef BS_ZERO
+#undef BS_ONES
+#undef BS_AND
+#undef BS_XOR
+#undef BS_FUNC
+#undef BS_ATTR
@@ -181,6 +181,14 @@ static const char *const ts_standards_list_text[] =
     "The encryption routines subtract the TS-header from the value before " \
     "encrypting." )
 
+#define CTHREAD_TEXT N_("Scramble in a separate thread")
+#define CTHREAD_LONGTEXT N_("Scramble the packets in a dedicated thread, " \
+    "so that the muxer is not held up by the scrambling of high bitrates.")
+
+#define BLOCKP_TEXT N_("Packets per output block")
+#define BLOCKP_LONGTEXT N_("Number of TS packets written into each block " \
+    "handed to the access output. 7 packets fill a regular UDP datagram.")
+
 #define SOUT_CFG_PREFIX "sout-ts-"
 #define MAX_PMT 64       /* Maximum number of programs. FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #define MAX_PMT_PID 64       /* Maximum pids in each pmt.  FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
@@ -221,6 +229,8 @@ vlc_module_begin ()
 
     add_integer( SOUT_CFG_PREFIX "pcr", 70, PCR_TEXT, PCR_LONGTEXT)
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT)
+    add_integer( SOUT_CFG_PREFIX "block-packets", 1, BLOCKP_TEXT, BLOCKP_LONGTEXT)
+        change_integer_range( 1, 64 )
 
     add_obsolete_integer( "sout-ts-bmin" ) /* since 4.0.0 */
     add_obsolete_integer( "sout-ts-bmax" ) /* since 4.0.0 */
@@ -231,6 +241,7 @@ vlc_module_begin ()
     add_string( SOUT_CFG_PREFIX "csa2-ck", NULL, CK2_TEXT,  CK2_LONGTEXT)
     add_string( SOUT_CFG_PREFIX "csa-use", "1",  CU_TEXT,   CU_LONGTEXT)
     add_integer(SOUT_CFG_PREFIX "csa-pkt", 188,  CPKT_TEXT, CPKT_LONGTEXT)
+    add_bool(   SOUT_CFG_PREFIX "csa-thread", false, CTHREAD_TEXT, CTHREAD_LONGTEXT)
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -244,7 +255,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "block-packets", "csa-thread",
     NULL
 };
 
@@ -377,6 +388,15 @@ typedef struct
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
     bool            b_crypt_video;
+
+    /* scrambling thread */
+    block_fifo_t    *p_csa_fifo;
+    vlc_thread_t    csa_thread;
+    bool            b_csa_exit;
+
+    /* for output */
+    block_pool_t    *p_pool;
+    int             i_block_packets;
 } sout_mux_sys_t;
 
 
@@ -472,6 +492,9 @@ static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
+static void TSWrite( sout_mux_t *, block_t * );
+static void *CsaThread( void * );
+static block_t *TSAlloc( sout_mux_sys_t *, size_t );
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
 static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
 
@@ -716,9 +739,26 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    /* TS packets are recycled rather than allocated one by one */
+    p_sys->p_pool = block_pool_New();
+    p_sys->i_block_packets = var_GetInteger( p_mux, SOUT_CFG_PREFIX "block-packets" );
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
+    if( p_sys->csa != NULL && var_GetBool( p_mux, SOUT_CFG_PREFIX "csa-thread" ) )
+    {
+        p_sys->p_csa_fifo = block_FifoNewSPSC();
+        if( p_sys->p_csa_fifo != NULL &&
+            vlc_clone( &p_sys->csa_thread, CsaThread, p_mux,
+                       VLC_THREAD_PRIORITY_OUTPUT ) )
+        {
+            block_FifoRelease( p_sys->p_csa_fifo );
+            p_sys->p_csa_fifo = NULL;
+        }
+        if( p_sys->p_csa_fifo == NULL )
+            msg_Warn( p_mux, "cannot scramble in a separate thread" );
+    }
 
     p_mux->pf_control   = Control;
     p_mux->pf_addstream = AddStream;
@@ -739,6 +779,17 @@ static void Close( vlc_object_t * p_this )
     if( p_sys->p_dvbpsi )
         dvbpsi_delete( p_sys->p_dvbpsi );
 
+    if( p_sys->p_csa_fifo )
+    {
+        /* The thread writes out what is left before exiting */
+        vlc_fifo_Lock( p_sys->p_csa_fifo );
+        p_sys->b_csa_exit = true;
+        vlc_fifo_Signal( p_sys->p_csa_fifo );
+        vlc_fifo_Unlock( p_sys->p_csa_fifo );
+        vlc_join( p_sys->csa_thread, NULL );
+        block_FifoRelease( p_sys->p_csa_fifo );
+    }
+
     if( p_sys->csa )
     {
         var_DelCallback( p_mux, SOUT_CFG_PREFIX "csa-ck", ChangeKeyCallback, p_mux );
@@ -747,6 +798,9 @@ static void Close( vlc_object_t * p_this )
         csa_Delete( p_sys->csa );
     }
 
+    if( p_sys->p_pool )
+        block_pool_Release( p_sys->p_pool );
+
     for (int i = 0; i < MAX_SDT_DESC; i++ )
     {
         free( p_sys->sdt.desc[i].psz_service_name );
@@ -1743,26 +1797,136 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
             TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
         }
-        if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
-        {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
-        }
 
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
 
         block_ChainLastAppend( &pp_last, p_ts );
     }
-    if ( p_list != NULL )
+
+    if( p_list == NULL )
+        return;
+    if( p_sys->p_csa_fifo != NULL )
+        vlc_fifo_Push( p_sys->p_csa_fifo, p_list );
+    else
+        TSWrite( p_mux, p_list );
+}
+
+static void TSScramble( sout_mux_sys_t *p_sys, block_t *p_list )
+{
+    uint8_t *pp_pkt[CSA_BATCH_MAX];
+    unsigned i_count = 0;
+
+    vlc_mutex_lock( &p_sys->csa_lock );
+    for( block_t *p_ts = p_list; p_ts != NULL; p_ts = p_ts->p_next )
+    {
+        if( !( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED ) )
+            continue;
+
+        pp_pkt[i_count++] = p_ts->p_buffer;
+        if( i_count == CSA_BATCH_MAX )
+        {
+            csa_EncryptBatch( p_sys->csa, pp_pkt, i_count, p_sys->i_csa_pkt_size );
+            i_count = 0;
+        }
+    }
+    if( i_count > 0 )
+        csa_EncryptBatch( p_sys->csa, pp_pkt, i_count, p_sys->i_csa_pkt_size );
+    vlc_mutex_unlock( &p_sys->csa_lock );
+}
+
+static block_t *TSGather( sout_mux_sys_t *p_sys, block_t *p_ts )
+{
+    block_t *p_list = NULL;
+    block_t **pp_last = &p_list;
+    block_t *p_out = NULL;
+
+    while( p_ts != NULL )
+    {
+        block_t *p_next = p_ts->p_next;
+
+        /* Gather the packets, a header always starts a new block so that
+         * segmenters can still cut on it */
+        if( p_out != NULL &&
+            ( p_out->i_buffer >= 188 * (size_t)p_sys->i_block_packets ||
+              ( p_ts->i_flags & BLOCK_FLAG_HEADER ) ) )
+        {
+            block_ChainLastAppend( &pp_last, p_out );
+            p_out = NULL;
+        }
+        if( p_out == NULL )
+        {
+            p_out = TSAlloc( p_sys, 188 * p_sys->i_block_packets );
+            if( unlikely(p_out == NULL) )
+            {
+                block_Release( p_ts );
+                p_ts = p_next;
+                continue;
+            }
+            p_out->i_buffer = 0;
+            p_out->i_dts = p_ts->i_dts;
+            p_out->i_length = 0;
+            p_out->i_flags = p_ts->i_flags & BLOCK_FLAG_HEADER;
+        }
+        memcpy( &p_out->p_buffer[p_out->i_buffer], p_ts->p_buffer, 188 );
+        p_out->i_buffer += 188;
+        p_out->i_length += p_ts->i_length;
+        p_out->i_flags |= p_ts->i_flags & (BLOCK_FLAG_CLOCK|BLOCK_FLAG_TYPE_I);
+        block_Release( p_ts );
+        p_ts = p_next;
+    }
+    if( p_out != NULL )
+        block_ChainLastAppend( &pp_last, p_out );
+    return p_list;
+}
+
+/* Scrambles and sends out the dated packets */
+static void TSWrite( sout_mux_t *p_mux, block_t *p_list )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    if( p_sys->csa != NULL )
+        TSScramble( p_sys, p_list );
+    if( p_sys->i_block_packets > 1 )
+        p_list = TSGather( p_sys, p_list );
+    if( p_list != NULL )
         sout_AccessOutWrite( p_mux->p_access, p_list );
 }
 
+static void *CsaThread( void *data )
+{
+    sout_mux_t *p_mux = data;
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    vlc_fifo_t *p_fifo = p_sys->p_csa_fifo;
+
+    vlc_fifo_Lock( p_fifo );
+    for( ;; )
+    {
+        while( vlc_fifo_IsEmpty( p_fifo ) && !p_sys->b_csa_exit )
+            vlc_fifo_Wait( p_fifo );
+
+        block_t *p_list = vlc_fifo_DequeueAllUnlocked( p_fifo );
+        if( p_list == NULL )
+            break;
+
+        vlc_fifo_Unlock( p_fifo );
+        TSWrite( p_mux, p_list );
+        vlc_fifo_Lock( p_fifo );
+    }
+    vlc_fifo_Unlock( p_fifo );
+    return NULL;
+}
+
+static block_t *TSAlloc( sout_mux_sys_t *p_sys, size_t i_size )
+{
+    if( p_sys->p_pool )
+        return block_pool_Alloc( p_sys->p_pool, i_size );
+    return block_Alloc( i_size );
+}
+
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
                        bool b_pcr )
 {
-    VLC_UNUSED(p_mux);
     block_t *p_pes = p_stream->state.chain_pes.p_first;
 
     bool b_new_pes = false;
@@ -1782,7 +1946,7 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         b_adaptation_field = true;
     }
 
-    block_t *p_ts = block_Alloc( 188 );
+    block_t *p_ts = TSAlloc( p_mux->p_sys, 188 );
 
     if (b_new_pes && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) && p_pes->i_flags & BLOCK_FLAG_TYPE_I)
     {
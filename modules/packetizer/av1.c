@@ -31,6 +31,7 @@
 #include <vlc_codec.h>
 #include <vlc_block.h>
 #include <vlc_bits.h>
+#include <vlc_atomic.h>
 
 #include <vlc_block_helper.h>
 
@@ -85,6 +86,104 @@ static bool block_Differs(const block_t *a, const block_t *b)
             memcmp(a->p_buffer, b->p_buffer, a->i_buffer));
 }
 
+/* OBU views reference the payload of the fed blocks, so that OBUs can be
+ * split off without copy */
+typedef struct
+{
+    vlc_atomic_rc_t rc;
+    block_t *p_block;
+} av1_obu_storage_t;
+
+typedef struct
+{
+    block_t self;
+    av1_obu_storage_t *p_storage;
+} av1_obu_view_t;
+
+static void OBUViewRelease(block_t *p_block)
+{
+    av1_obu_view_t *p_view = container_of(p_block, av1_obu_view_t, self);
+
+    if(vlc_atomic_rc_dec(&p_view->p_storage->rc))
+    {
+        block_Release(p_view->p_storage->p_block);
+        free(p_view->p_storage);
+    }
+    free(p_view);
+}
+
+static const struct vlc_block_callbacks av1_obu_view_cbs =
+{
+    OBUViewRelease,
+};
+
+static inline bool OBUIsView(const block_t *p_block)
+{
+    return p_block->cbs == &av1_obu_view_cbs;
+}
+
+static block_t *OBUViewWrap(block_t *p_block)
+{
+    av1_obu_storage_t *p_storage = malloc(sizeof(*p_storage));
+    av1_obu_view_t *p_view = malloc(sizeof(*p_view));
+    if(!p_storage || !p_view)
+    {
+        free(p_storage);
+        free(p_view);
+        return NULL;
+    }
+
+    vlc_atomic_rc_init(&p_storage->rc);
+    p_storage->p_block = p_block;
+    block_Init(&p_view->self, &av1_obu_view_cbs,
+               p_block->p_buffer, p_block->i_buffer);
+    block_CopyProperties(&p_view->self, p_block);
+    p_view->p_storage = p_storage;
+    return &p_view->self;
+}
+
+static block_t *OBUViewSplit(block_t *p_frag, size_t i_obu)
+{
+    av1_obu_view_t *p_parent = container_of(p_frag, av1_obu_view_t, self);
+    av1_obu_view_t *p_view = malloc(sizeof(*p_view));
+    if(!p_view)
+        return NULL;
+
+    vlc_atomic_rc_inc(&p_parent->p_storage->rc);
+    block_Init(&p_view->self, &av1_obu_view_cbs, p_frag->p_buffer, i_obu);
+    p_view->p_storage = p_parent->p_storage;
+    return &p_view->self;
+}
+
+/* A temporal unit made of contiguous views does not need to be gathered */
+static block_t *OBUViewMerge(block_t *p_chain)
+{
+    if(!OBUIsView(p_chain))
+        return p_chain;
+
+    const av1_obu_storage_t *p_storage =
+            container_of(p_chain, av1_obu_view_t, self)->p_storage;
+    size_t i_total = p_chain->i_buffer;
+    for(const block_t *p = p_chain; p->p_next; p = p->p_next)
+    {
+        const block_t *p_next = p->p_next;
+        if(!OBUIsView(p_next) ||
+           container_of(p_next, av1_obu_view_t, self)->p_storage != p_storage ||
+           p_next->p_buffer != &p->p_buffer[p->i_buffer])
+            return p_chain;
+        i_total += p_next->i_buffer;
+    }
+
+    if(p_chain->p_next)
+    {
+        block_ChainRelease(p_chain->p_next);
+        p_chain->p_next = NULL;
+        p_chain->i_buffer = i_total;
+        p_chain->i_size = (p_chain->p_buffer - p_chain->p_start) + i_total;
+    }
+    return p_chain;
+}
+
 #define INITQ(name) InitQueue(&p_sys->name.p_chain, &p_sys->name.pp_chain_last)
 #define PUSHQ(name,b) \
 {\
@@ -248,7 +347,7 @@ static block_t *GatherAndValidateChain(decoder_t *p_dec, block_t *p_outputchain)
         if(p_outputchain->i_flags & BLOCK_FLAG_DROP)
             p_output = p_outputchain; /* Avoid useless gather */
         else
-            p_output = block_ChainGather(p_outputchain);
+            p_output = block_ChainGather(OBUViewMerge(p_outputchain));
     }
 
     if(p_output && (p_output->i_flags & BLOCK_FLAG_DROP))
@@ -277,18 +376,19 @@ static block_t *ParseOBUBlock(decoder_t *p_dec, block_t *p_obu)
 
             if(b_base_layer)
             {
-                /* Save a copy for Extradata */
+                /* Save a copy for Extradata, and only parse changes since
+                 * the header is usually repeated on every key frame */
                 if(!p_sys->p_sequence_header_block ||
                    block_Differs(p_sys->p_sequence_header_block, p_obu))
                 {
                     if(p_sys->p_sequence_header_block)
                         block_Release(p_sys->p_sequence_header_block);
                     p_sys->p_sequence_header_block = block_Duplicate(p_obu);
-                }
 
-                if(p_sys->p_sequence_header)
-                    AV1_release_sequence_header(p_sys->p_sequence_header);
-                p_sys->p_sequence_header = AV1_OBU_parse_sequence_header(p_obu->p_buffer, p_obu->i_buffer);
+                    if(p_sys->p_sequence_header)
+                        AV1_release_sequence_header(p_sys->p_sequence_header);
+                    p_sys->p_sequence_header = AV1_OBU_parse_sequence_header(p_obu->p_buffer, p_obu->i_buffer);
+                }
             }
             PUSHQ(tu.pre, p_obu);
         } break;
@@ -467,8 +567,28 @@ static block_t *PacketizeOBU(decoder_t *p_dec, block_t **pp_block)
         }
         else
         {
-            p_obublock = block_Alloc(i_obu);
-            memcpy(p_obublock->p_buffer, p_frag->p_buffer, i_obu);
+            if(!OBUIsView(p_frag))
+            {
+                /* Substitute a view, holding the fed block */
+                block_t *p_view = OBUViewWrap(p_frag);
+                if(p_view)
+                {
+                    p_view->p_next = p_frag->p_next;
+                    p_frag->p_next = NULL;
+                    if(p_sys->obus.pp_chain_last == &p_frag->p_next)
+                        p_sys->obus.pp_chain_last = &p_view->p_next;
+                    p_sys->obus.p_chain = p_frag = p_view;
+                }
+            }
+
+            p_obublock = OBUIsView(p_frag) ? OBUViewSplit(p_frag, i_obu) : NULL;
+            if(!p_obublock)
+            {
+                p_obublock = block_Alloc(i_obu);
+                if(!p_obublock)
+                    break;
+                memcpy(p_obublock->p_buffer, p_frag->p_buffer, i_obu);
+            }
             p_frag->i_buffer -= i_obu;
             p_frag->p_buffer += i_obu;
             p_obublock->i_dts = p_frag->i_dts;
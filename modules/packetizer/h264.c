@@ -157,6 +157,7 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag );
 static void PutPPS( decoder_t *p_dec, block_t *p_frag );
 static void PutSPSEXT( decoder_t *p_dec, block_t *p_frag );
 static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slice_t *p_slice );
+static void ParseSliceMMCO5( decoder_t *p_dec, const block_t *p_frag, h264_slice_t *p_slice );
 static bool ParseSeiCallback( const hxxx_sei_data_t *, void * );
 
 
@@ -166,6 +167,26 @@ static const uint8_t p_h264_startcode[3] = { 0x00, 0x00, 0x01 };
  * Helpers
  *****************************************************************************/
 
+static block_t *CopyXPS( block_t *p_block )
+{
+    /* Fragments can be views of the input, do not keep it alive */
+    block_t *p_copy = p_block ? block_Duplicate( p_block ) : NULL;
+    if( p_copy == NULL )
+        return p_block;
+    block_Release( p_block );
+    return p_copy;
+}
+
+static bool IsStoredXPS( const block_t *p_stored, const uint8_t *p_buffer, size_t i_buffer )
+{
+    if( !p_stored )
+        return false;
+    const uint8_t *p_stripped = p_stored->p_buffer;
+    size_t i_stripped = p_stored->i_buffer;
+    hxxx_strip_AnnexB_startcode( &p_stripped, &i_stripped );
+    return i_stripped == i_buffer && !memcmp( p_stripped, p_buffer, i_buffer );
+}
+
 static void StoreSPS( decoder_sys_t *p_sys, uint8_t i_id,
                       block_t *p_block, h264_sequence_parameter_set_t *p_sps )
 {
@@ -175,7 +196,7 @@ static void StoreSPS( decoder_sys_t *p_sys, uint8_t i_id,
         h264_release_sps( p_sys->sps[i_id].p_sps );
     if( p_sys->sps[i_id].p_sps == p_sys->p_active_sps )
         p_sys->p_active_sps = NULL;
-    p_sys->sps[i_id].p_block = p_block;
+    p_sys->sps[i_id].p_block = CopyXPS( p_block );
     p_sys->sps[i_id].p_sps = p_sps;
 }
 
@@ -188,7 +209,7 @@ static void StorePPS( decoder_sys_t *p_sys, uint8_t i_id,
         h264_release_pps( p_sys->pps[i_id].p_pps );
     if( p_sys->pps[i_id].p_pps == p_sys->p_active_pps )
         p_sys->p_active_pps = NULL;
-    p_sys->pps[i_id].p_block = p_block;
+    p_sys->pps[i_id].p_block = CopyXPS( p_block );
     p_sys->pps[i_id].p_pps = p_pps;
 }
 
@@ -196,7 +217,7 @@ static void StoreSPSEXT( decoder_sys_t *p_sys, uint8_t i_id, block_t *p_block )
 {
     if( p_sys->spsext[i_id].p_block )
         block_Release( p_sys->spsext[i_id].p_block );
-    p_sys->spsext[i_id].p_block = p_block;
+    p_sys->spsext[i_id].p_block = CopyXPS( p_block );
 }
 
 static void ActivateSets( decoder_t *p_dec, const h264_sequence_parameter_set_t *p_sps,
@@ -353,6 +374,7 @@ static int Open( vlc_object_t *p_this )
                      p_h264_startcode, 1, 5,
                      PacketizeReset, PacketizeParse, PacketizeValidate, PacketizeDrain,
                      p_dec );
+    p_sys->packetizer.b_views = true;
 
     p_sys->b_slice = false;
     p_sys->frame.p_head = NULL;
@@ -668,6 +690,9 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                 bool b_new_picture = IsFirstVCLNALUnit( &p_sys->slice, &newslice );
                 if( b_new_picture )
                 {
+                    /* The rest of the header only matters once per picture */
+                    ParseSliceMMCO5( p_dec, p_frag, &newslice );
+
                     /* Parse SEI for that frame now we should have matched SPS/PPS */
                     for( block_t *p_sei = p_sys->leading.p_head; p_sei; p_sei = p_sei->p_next )
                     {
@@ -680,6 +705,7 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                     if( p_sys->b_slice )
                         p_pic = OutputPicture( p_dec );
                 }
+                else newslice.has_mmco5 = p_sys->slice.has_mmco5;
 
                 /* */
                 p_sys->slice = newslice;
@@ -1103,6 +1129,15 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
         return;
     }
 
+    /* Repeated SPS, no need to decode it again */
+    uint8_t i_id;
+    if( h264_get_xps_id( p_buffer, i_buffer, &i_id ) &&
+        IsStoredXPS( p_sys->sps[i_id].p_block, p_buffer, i_buffer ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     h264_sequence_parameter_set_t *p_sps = h264_decode_sps( p_buffer, i_buffer, true );
     if( !p_sps )
     {
@@ -1130,6 +1165,15 @@ static void PutPPS( decoder_t *p_dec, block_t *p_frag )
         return;
     }
 
+    /* Repeated PPS, no need to decode it again */
+    uint8_t i_id;
+    if( h264_get_xps_id( p_buffer, i_buffer, &i_id ) &&
+        IsStoredXPS( p_sys->pps[i_id].p_block, p_buffer, i_buffer ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     h264_picture_parameter_set_t *p_pps = h264_decode_pps( p_buffer, i_buffer, true );
     if( !p_pps )
     {
@@ -1157,6 +1201,15 @@ static void PutSPSEXT( decoder_t *p_dec, block_t *p_frag )
         return;
     }
 
+    /* Repeated SPSEXT */
+    uint8_t i_id;
+    if( h264_get_xps_id( p_buffer, i_buffer, &i_id ) &&
+        IsStoredXPS( p_sys->spsext[i_id].p_block, p_buffer, i_buffer ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     h264_sequence_parameter_set_extension_t *p_spsext =
             h264_decode_sps_extension( p_buffer, i_buffer, true );
     if( !p_spsext )
@@ -1199,7 +1252,7 @@ static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slic
     if( !hxxx_strip_AnnexB_startcode( &p_stripped, &i_stripped ) || i_stripped < 2 )
         return false;
 
-    if( !h264_decode_slice( p_stripped, i_stripped, GetSPSPPS, p_sys, p_slice ) )
+    if( !h264_decode_slice_head( p_stripped, i_stripped, GetSPSPPS, p_sys, p_slice ) )
         return false;
 
     const h264_sequence_parameter_set_t *p_sps;
@@ -1208,11 +1261,28 @@ static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slic
     if( unlikely( !p_sps || !p_pps) )
         return false;
 
-    ActivateSets( p_dec, p_sps, p_pps );
+    if( p_sps != p_sys->p_active_sps || p_pps != p_sys->p_active_pps )
+        ActivateSets( p_dec, p_sps, p_pps );
 
     return true;
 }
 
+static void ParseSliceMMCO5( decoder_t *p_dec, const block_t *p_frag, h264_slice_t *p_slice )
+{
+    /* Only non IDR reference pictures can carry it */
+    p_slice->has_mmco5 = false;
+    if( p_slice->i_nal_type == H264_NAL_SLICE_IDR || p_slice->i_nal_ref_idc == 0 )
+        return;
+
+    const uint8_t *p_stripped = p_frag->p_buffer;
+    size_t i_stripped = p_frag->i_buffer;
+    h264_slice_t fullslice;
+
+    if( hxxx_strip_AnnexB_startcode( &p_stripped, &i_stripped ) &&
+        h264_decode_slice( p_stripped, i_stripped, GetSPSPPS, p_dec->p_sys, &fullslice ) )
+        p_slice->has_mmco5 = fullslice.has_mmco5;
+}
+
 static bool ParseSeiCallback( const hxxx_sei_data_t *p_sei_data, void *cbdata )
 {
     decoder_t *p_dec = (decoder_t *) cbdata;
@@ -662,6 +662,26 @@ IMPL_h264_generic_decode( h264_decode_pps, h264_picture_parameter_set_t,
 IMPL_h264_generic_decode( h264_decode_sps_extension, h264_sequence_parameter_set_extension_t,
                           h264_parse_sequence_parameter_set_extension_rbsp, h264_release_sps_extension )
 
+bool h264_get_xps_id( const uint8_t *p_buf, size_t i_buf, uint8_t *pi_id )
+{
+    if( i_buf < 2 )
+        return false;
+    /* No need to lookup convert from emulation for that data */
+    const uint8_t i_nal_type = p_buf[0] & 0x1f;
+    bs_t bs;
+    bs_init( &bs, &p_buf[1], i_buf - 1 );
+    if( i_nal_type == H264_NAL_SPS )
+        bs_skip( &bs, 24 ); /* profile_idc, constraint flags, level_idc */
+    else if( i_nal_type != H264_NAL_PPS && i_nal_type != H264_NAL_SPS_EXT )
+        return false;
+    const uint32_t i_id = bs_read_ue( &bs );
+    if( bs_error( &bs ) ||
+        i_id > (i_nal_type == H264_NAL_PPS ? H264_PPS_ID_MAX : H264_SPS_ID_MAX) )
+        return false;
+    *pi_id = i_id;
+    return true;
+}
+
 block_t *h264_NAL_to_avcC( uint8_t i_nal_length_size,
                            const uint8_t **pp_sps_buf,
                            const size_t *p_sps_size, uint8_t i_sps_count,
@@ -88,6 +88,9 @@ void h264_release_sps( h264_sequence_parameter_set_t * );
 void h264_release_pps( h264_picture_parameter_set_t * );
 void h264_release_sps_extension( h264_sequence_parameter_set_extension_t * );
 
+/* Gets the SPS, PPS or SPS extension id from the raw NAL, without decoding */
+bool h264_get_xps_id( const uint8_t *p_nalbuf, size_t i_nalbuf, uint8_t *pi_id );
+
 struct h264_sequence_parameter_set_t
 {
     uint8_t i_id;
@@ -29,11 +29,11 @@
 #include "hxxx_nal.h"
 #include "hxxx_ep3b.h"
 
-bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
-                        void (* get_sps_pps)(uint8_t, void *,
-                                             const h264_sequence_parameter_set_t **,
-                                             const h264_picture_parameter_set_t ** ),
-                        void *priv, h264_slice_t *p_slice )
+static bool h264_decode_slice_internal( const uint8_t *p_buffer, size_t i_buffer,
+                                        void (* get_sps_pps)(uint8_t, void *,
+                                                             const h264_sequence_parameter_set_t **,
+                                                             const h264_picture_parameter_set_t ** ),
+                                        void *priv, h264_slice_t *p_slice, bool b_head )
 {
     int i_slice_type;
     h264_slice_init( p_slice );
@@ -98,6 +98,10 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
             p_slice->i_delta_pic_order_cnt1 = bs_read_se( &s );
     }
 
+    /* Everything needed for AU detection and POC, but MMCO 5 presence */
+    if( b_head )
+        return !bs_error( &s );
+
     if( p_pps->i_redundant_pic_present_flag )
         bs_read_ue( &s ); /* redudant_pic_count */
 
@@ -216,6 +220,25 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
     return !bs_error( &s );
 }
 
+bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
+                        void (* get_sps_pps)(uint8_t, void *,
+                                             const h264_sequence_parameter_set_t **,
+                                             const h264_picture_parameter_set_t ** ),
+                        void *priv, h264_slice_t *p_slice )
+{
+    return h264_decode_slice_internal( p_buffer, i_buffer, get_sps_pps,
+                                       priv, p_slice, false );
+}
+
+bool h264_decode_slice_head( const uint8_t *p_buffer, size_t i_buffer,
+                             void (* get_sps_pps)(uint8_t, void *,
+                                                  const h264_sequence_parameter_set_t **,
+                                                  const h264_picture_parameter_set_t ** ),
+                             void *priv, h264_slice_t *p_slice )
+{
+    return h264_decode_slice_internal( p_buffer, i_buffer, get_sps_pps,
+                                       priv, p_slice, true );
+}
 
 void h264_compute_poc( const h264_sequence_parameter_set_t *p_sps,
                        const h264_slice_t *p_slice, h264_poc_context_t *p_ctx,
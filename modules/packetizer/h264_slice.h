@@ -78,6 +78,15 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
                                              const h264_picture_parameter_set_t ** ),
                         void *, h264_slice_t *p_slice );
 
+/* Only decodes the fields needed for AU detection and POC computation, but
+ * has_mmco5. MMCO 5 presence is the same for all the slices of a picture and
+ * can be decoded once with h264_decode_slice() */
+bool h264_decode_slice_head( const uint8_t *p_buffer, size_t i_buffer,
+                             void (* get_sps_pps)(uint8_t pps_id, void *,
+                                                  const h264_sequence_parameter_set_t **,
+                                                  const h264_picture_parameter_set_t ** ),
+                             void *, h264_slice_t *p_slice );
+
 typedef struct
 {
     struct
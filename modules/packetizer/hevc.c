@@ -218,6 +218,7 @@ static int Open(vlc_object_t *p_this)
                     p_hevc_startcode, 1, 5,
                     PacketizeReset, PacketizeParse, PacketizeValidate, PacketizeDrain,
                     p_dec);
+    p_sys->packetizer.b_views = true;
 
     /* Copy properties */
     es_format_Copy(&p_dec->fmt_out, &p_dec->fmt_in);
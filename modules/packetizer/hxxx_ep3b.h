@@ -20,8 +20,20 @@
  *****************************************************************************/
 #include <vlc_bits.h>
 
+#include "startcode_helper.h"
+
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
+    /* Long skips that do not cross any emulation prevention can jump.
+     * Unless the current byte is 0, such a sequence would be found whole. */
+    if( i_count >= 16 && !(*pi_prev & 1) && i_count < (size_t)(end - p) &&
+        startcode_FindPattern( p + 1, p + i_count + 1, 0x03 ) == NULL )
+    {
+        p += i_count;
+        *pi_prev = (!p[-2] << 2) | (!p[-1] << 1) | (!p[0]);
+        return p;
+    }
+
     for( size_t i=0; i<i_count; i++ )
     {
         if( ++p >= end )
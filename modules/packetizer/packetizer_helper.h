@@ -56,6 +56,10 @@ typedef struct
 
     unsigned i_au_min_size;
 
+    /* Output units are views of the input blocks whenever they do not
+     * straddle blocks, the parser must not modify their data in place */
+    bool b_views;
+
     void *p_private;
     packetizer_reset_t    pf_reset;
     packetizer_parse_t    pf_parse;
@@ -82,6 +86,7 @@ static inline void packetizer_Init( packetizer_t *p_pack,
     p_pack->i_au_prepend = i_au_prepend;
     p_pack->p_au_prepend = p_au_prepend;
     p_pack->i_au_min_size = i_au_min_size;
+    p_pack->b_views = false;
 
     p_pack->i_startcode = i_startcode;
     p_pack->p_startcode = p_startcode;
@@ -106,6 +111,27 @@ static inline void packetizer_Flush( packetizer_t *p_pack )
     p_pack->pf_reset( p_pack->p_private, true );
 }
 
+static block_t *packetizer_GetView( packetizer_t *p_pack )
+{
+    const block_t *p_block = p_pack->bytestream.p_block;
+    size_t i_start = p_pack->bytestream.i_block_offset;
+
+    if( p_block->i_buffer - i_start < p_pack->i_offset )
+        return NULL;
+
+    /* The bytes to prepend must already precede the unit */
+    if( p_pack->i_au_prepend > 0 )
+    {
+        if( i_start < (size_t)p_pack->i_au_prepend ||
+            memcmp( &p_block->p_buffer[i_start - p_pack->i_au_prepend],
+                    p_pack->p_au_prepend, p_pack->i_au_prepend ) )
+            return NULL;
+        i_start -= p_pack->i_au_prepend;
+    }
+
+    return block_View( p_block, i_start, p_pack->i_offset + p_pack->i_au_prepend );
+}
+
 static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_block )
 {
     block_t *p_block = ( pp_block ) ? *pp_block : NULL;
@@ -126,7 +152,11 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
     }
 
     if( p_block )
+    {
+        if( p_pack->b_views )
+            p_block = block_Shareable( p_block );
         block_BytestreamPush( &p_pack->bytestream, p_block );
+    }
 
     for( ;; )
     {
@@ -180,7 +210,19 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            p_pic = p_pack->b_views ? packetizer_GetView( p_pack ) : NULL;
+            if( p_pic )
+            {
+                block_SkipBytes( &p_pack->bytestream, p_pack->i_offset );
+            }
+            else
+            {
+                p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+                block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
+                                p_pic->i_buffer - p_pack->i_au_prepend );
+                if( p_pack->i_au_prepend > 0 )
+                    memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
+            }
             p_pic->i_pts = p_block_bytestream->i_pts;
             p_pic->i_dts = p_block_bytestream->i_dts;
 
@@ -191,11 +233,6 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
                 p_pic->i_flags |= BLOCK_FLAG_AU_END;
             }
 
-            block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
-                            p_pic->i_buffer - p_pack->i_au_prepend );
-            if( p_pack->i_au_prepend > 0 )
-                memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
-
             p_pack->i_offset = 0;
 
             /* Parse the NAL */
@@ -34,20 +34,21 @@
 #  endif
 #endif
 
-/* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
+/* Looks up efficiently for a 0x00 0x00 i_code pattern, either an AnnexB
+ * startcode (i_code 0x01) or an emulation prevention (i_code 0x03),
  * by using a 4 times faster trick than single byte lookup. */
 
-#define TRY_MATCH(p,a) {\
+#define TRY_MATCH(p,a,c) {\
      if (p[a+1] == 0) {\
-            if (p[a+0] == 0 && p[a+2] == 1)\
+            if (p[a+0] == 0 && p[a+2] == c)\
                 return a+p;\
-            if (p[a+2] == 0 && p[a+3] == 1)\
+            if (p[a+2] == 0 && p[a+3] == c)\
                 return a+p+1;\
         }\
         if (p[a+3] == 0) {\
-            if (p[a+2] == 0 && p[a+4] == 1)\
+            if (p[a+2] == 0 && p[a+4] == c)\
                 return a+p+2;\
-            if (p[a+4] == 0 && p[a+5] == 1)\
+            if (p[a+4] == 0 && p[a+5] == c)\
                 return a+p+3;\
         }\
     }
@@ -55,17 +56,19 @@
 #ifdef CAN_COMPILE_SSE2
 
 __attribute__ ((__target__ ("sse2")))
-static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const uint8_t *end )
+static inline const uint8_t * startcode_FindPattern_SSE2( const uint8_t *p, const uint8_t *end,
+                                                          uint8_t c )
 {
     /* First align to 16 */
     /* Skipping this step and doing unaligned loads isn't faster */
     const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
     for (end -= 3; p < alignedend && p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
-    if( p == end )
+    /* a start code can still begin at end */
+    if( p > end )
         return NULL;
 
     alignedend = end - ((intptr_t) end & 15);
@@ -99,18 +102,111 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             );
 #  endif
             if( match & 0x000F )
-                TRY_MATCH(p, 0);
+                TRY_MATCH(p, 0, c);
             if( match & 0x00F0 )
-                TRY_MATCH(p, 4);
+                TRY_MATCH(p, 4, c);
             if( match & 0x0F00 )
-                TRY_MATCH(p, 8);
+                TRY_MATCH(p, 8, c);
             if( match & 0xF000 )
-                TRY_MATCH(p, 12);
+                TRY_MATCH(p, 12, c);
         }
     }
 
     for (; p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindPattern_AVX2( const uint8_t *p, const uint8_t *end,
+                                                          uint8_t c )
+{
+    /* Pairs of zeros are located 32 bytes at a time, the byte
+     * following the block is always part of the buffer */
+    if( end - p >= 32 + 2 )
+    {
+        const uint8_t *blockend = end - 32 - 2;
+        const uint8_t *found = NULL;
+
+        for( ; p <= blockend && found == NULL; p += 32 )
+        {
+            uint32_t match;
+            asm volatile(
+                "vmovdqu    0(%[v]),  %%ymm0\n"
+                "vpxor      %%ymm1,   %%ymm1,   %%ymm1\n"
+                "vpcmpeqb   %%ymm1,   %%ymm0,   %%ymm0\n"
+                "vpmovmskb  %%ymm0,   %[match]\n" /* mask will be in reversed match order */
+                : [match]"=r"(match)
+                : [v]"r"(p)
+                : "xmm0", "xmm1"
+            );
+            uint32_t pairs = match & ((match >> 1) | ((uint32_t)(p[32] == 0) << 31));
+            while( pairs )
+            {
+                unsigned i = ctz( pairs );
+                if( p[i + 2] == c )
+                {
+                    found = p + i;
+                    break;
+                }
+                pairs &= pairs - 1;
+            }
+        }
+        asm volatile( "vzeroupper" );
+
+        if( found )
+            return found;
+    }
+
+    for (; end - p >= 3; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define CAN_COMPILE_STARTCODE_NEON
+
+static inline const uint8_t * startcode_FindPattern_NEON( const uint8_t *p, const uint8_t *end,
+                                                          uint8_t c )
+{
+    /* Pairs of zeros are located 16 bytes at a time, the byte
+     * following the block is always part of the buffer */
+    if( end - p >= 16 + 2 )
+    {
+        const uint8_t *blockend = end - 16 - 2;
+
+        for( ; p <= blockend; p += 16 )
+        {
+            /* one nibble per byte, there is no movemask */
+            uint8x16_t zeros = vceqzq_u8( vld1q_u8( p ) );
+            uint64_t match = vget_lane_u64( vreinterpret_u64_u8(
+                                vshrn_n_u16( vreinterpretq_u16_u8( zeros ), 4 ) ), 0 );
+            uint64_t pairs = match & ((match >> 4) | (p[16] == 0 ? UINT64_C(0xF) << 60 : 0));
+            while( pairs )
+            {
+                unsigned i = ctz( pairs ) / 4;
+                if( p[i + 2] == c )
+                    return p + i;
+                pairs &= ~(UINT64_C(0xF) << (4 * i));
+            }
+        }
+    }
+
+    for (; end - p >= 3; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -123,12 +219,13 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
  */
-static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const uint8_t *end )
+static inline const uint8_t * startcode_FindPattern_Bits( const uint8_t *p, const uint8_t *end,
+                                                          uint8_t c )
 {
     const uint8_t *a = p + 4 - ((intptr_t)p & 3);
 
     for (end -= 3; p < a && p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -137,12 +234,12 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
         if ((x - 0x01010101) & (~x) & 0x80808080)
         {
             /* matching DW isn't faster */
-            TRY_MATCH(p, 0);
+            TRY_MATCH(p, 0, c);
         }
     }
 
     for (end += 3; p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -150,16 +247,32 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
-static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
+static inline const uint8_t * startcode_FindPattern( const uint8_t *p, const uint8_t *end,
+                                                     uint8_t c )
 {
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return startcode_FindPattern_AVX2(p, end, c);
+#endif
+#ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
-        return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
+        return startcode_FindPattern_SSE2(p, end, c);
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+    return startcode_FindPattern_NEON(p, end, c);
 #else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+    return startcode_FindPattern_Bits(p, end, c);
 #endif
+}
+
+static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindPattern_Bits(p, end, 0x01);
+}
+
+static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindPattern(p, end, 0x01);
+}
 
 #endif
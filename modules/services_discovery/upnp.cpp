@@ -52,6 +52,7 @@ const char* CONTENT_DIRECTORY_SERVICE_TYPE = "urn:schemas-upnp-org:service:Conte
 const char* SATIP_SERVER_DEVICE_TYPE = "urn:ses-com:device:SatIPServer:1";
 
 #define UPNP_SEARCH_TIMEOUT_SECONDS 15
+#define UPNP_BROWSE_PAGE_SIZE 1000
 #define SATIP_CHANNEL_LIST N_("SAT>IP channel list")
 #define SATIP_CHANNEL_LIST_URL N_("Custom SAT>IP channel list URL")
 
@@ -1275,19 +1276,20 @@ browseActionCleanup:
  */
 bool MediaServer::fetchContents()
 {
-    std::string StartingIndex = "0";
-    std::string RequestedCount = "5000";
-    const char* psz_TotalMatches = "0";
-    const char* psz_NumberReturned = "0";
-    long  l_reqCount = 0;
+    /* Browse by pages of bounded size: some servers don't understand "0" as
+     * "no-limit", and a single response for a huge container takes ages to
+     * be generated, transferred and parsed */
+    const std::string RequestedCount = std::to_string( UPNP_BROWSE_PAGE_SIZE );
+    unsigned long i_index = 0;
+    unsigned long i_total;
+    unsigned long i_returned;
 
     do
     {
         IXML_Document* p_response = _browseAction( m_psz_objectId,
                                                   "BrowseDirectChildren",
                                                   "*",
-                                                  StartingIndex.c_str(),
-                                                  // Some servers don't understand "0" as "no-limit"
+                                                  std::to_string( i_index ).c_str(),
                                                   RequestedCount.c_str(), /* RequestedCount */
                                                   "" /* SortCriteria */
                                                   );
@@ -1297,12 +1299,14 @@ bool MediaServer::fetchContents()
             return false;
         }
 
-        psz_TotalMatches = xml_getChildElementValue( (IXML_Element*)p_response, "TotalMatches" );
-        psz_NumberReturned = xml_getChildElementValue( (IXML_Element*)p_response, "NumberReturned" );
-
-        StartingIndex = std::to_string(  std::stol(psz_NumberReturned) + std::stol(StartingIndex) );
-        l_reqCount = std::stol(psz_TotalMatches) - std::stol(StartingIndex) ;
-        RequestedCount = std::to_string(l_reqCount);
+        const char* psz_TotalMatches =
+            xml_getChildElementValue( (IXML_Element*)p_response, "TotalMatches" );
+        const char* psz_NumberReturned =
+            xml_getChildElementValue( (IXML_Element*)p_response, "NumberReturned" );
+        /* TotalMatches is 0 if the server does not know it */
+        i_total = psz_TotalMatches ? strtoul( psz_TotalMatches, NULL, 10 ) : 0;
+        i_returned = psz_NumberReturned ? strtoul( psz_NumberReturned, NULL, 10 ) : 0;
+        i_index += i_returned;
 
         IXML_Document* p_result = parseBrowseResult( p_response );
 
@@ -1339,7 +1343,9 @@ bool MediaServer::fetchContents()
 
         ixmlDocument_free( p_result );
     }
-    while( l_reqCount );
+    while( i_returned > 0 && !vlc_killed() &&
+           ( i_total > 0 ? i_index < i_total
+                         : i_returned >= UPNP_BROWSE_PAGE_SIZE ) );
     return true;
 }
 
@@ -77,9 +77,19 @@ struct private_sys_t
     uint64_t i_offset;
 
     uint8_t buffer[ 8192 ];
+    uint64_t i_buffer_pos; /* source offset of the buffer, if from source */
+    size_t i_buffer_len;
     bool b_seekable_source;
     bool b_seekable_archive;
 
+    /* entry stored as is in the source: read and seek it directly */
+    bool b_direct;
+    uint64_t i_direct_start;
+
+    /* first data block, read while probing for direct access */
+    const uint8_t* p_pending;
+    size_t i_pending;
+
     libarchive_callback_t** pp_callback_data;
     size_t i_callback_data;
 };
@@ -188,6 +198,12 @@ static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
     stream_t*  p_source = p_cb->p_source;
     private_sys_t* p_sys = p_cb->p_sys;
 
+    if( p_source == p_sys->source )
+        p_sys->i_buffer_pos = vlc_stream_Tell( p_source );
+    else
+        p_sys->i_buffer_pos = UINT64_MAX;
+    p_sys->i_buffer_len = 0;
+
     ssize_t i_ret = vlc_stream_Read( p_source, &p_sys->buffer,
       sizeof( p_sys->buffer ) );
 
@@ -199,6 +215,7 @@ static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
         return ARCHIVE_FATAL;
     }
 
+    p_sys->i_buffer_len = i_ret;
     *pp_dst = &p_sys->buffer;
     return i_ret;
 }
@@ -384,6 +401,84 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
     return VLC_SUCCESS;
 }
 
+/**
+ * Checks whether the data of the current entry is stored as is in the
+ * source stream, so that it can be read and seeked without libarchive.
+ *
+ * libarchive hands out pointers into our read buffer for data it does not
+ * need to decode; that tells where the entry data lies in the source.
+ */
+static void archive_probe_direct( private_sys_t* p_sys )
+{
+    libarchive_t* p_arc = p_sys->p_archive;
+
+    if( p_sys->i_callback_data != 1 || !p_sys->b_seekable_source
+     || archive_filter_count( p_arc ) != 1
+#if ARCHIVE_VERSION_NUMBER >= 3002000
+     || archive_entry_is_encrypted( p_sys->p_entry )
+#endif
+     || !archive_entry_size_is_set( p_sys->p_entry )
+     || archive_entry_size( p_sys->p_entry ) <= 0 )
+        return;
+
+    switch( archive_format( p_arc ) & ARCHIVE_FORMAT_BASE_MASK )
+    {
+        case ARCHIVE_FORMAT_TAR:
+        case ARCHIVE_FORMAT_ZIP:
+        case ARCHIVE_FORMAT_CPIO:
+        case ARCHIVE_FORMAT_AR:
+            break;
+        default:
+            return;
+    }
+
+    const void* p_block;
+    size_t i_block;
+    la_int64_t i_block_offset;
+
+    if( archive_read_data_block( p_arc, &p_block, &i_block,
+                                 &i_block_offset ) != ARCHIVE_OK )
+        return;
+
+    /* Read() returns this block first if the entry is not stored as is */
+    p_sys->p_pending = p_block;
+    p_sys->i_pending = i_block;
+
+    const uint8_t* p = p_block;
+    if( i_block_offset != 0 || p_sys->i_buffer_pos == UINT64_MAX
+     || p < p_sys->buffer
+     || p + i_block > p_sys->buffer + p_sys->i_buffer_len )
+        return;
+
+    p_sys->b_direct = true;
+    p_sys->i_direct_start = p_sys->i_buffer_pos + ( p - p_sys->buffer );
+    p_sys->i_pending = 0;
+    msg_Dbg( p_sys->p_obj, "entry stored at offset %"PRIu64", reading "
+             "it directly", p_sys->i_direct_start );
+}
+
+static ssize_t archive_read_direct( stream_extractor_t* p_extractor,
+                                    void* p_data, size_t i_size )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    uint64_t i_entry = archive_entry_size( p_sys->p_entry );
+
+    if( p_sys->i_offset >= i_entry )
+        return 0;
+
+    i_size = __MIN( i_size, i_entry - p_sys->i_offset );
+
+    uint64_t i_pos = p_sys->i_direct_start + p_sys->i_offset;
+    if( vlc_stream_Tell( p_extractor->source ) != i_pos
+     && vlc_stream_Seek( p_extractor->source, i_pos ) )
+        return -1;
+
+    ssize_t i_ret = vlc_stream_Read( p_extractor->source, p_data, i_size );
+    if( i_ret > 0 )
+        p_sys->i_offset += i_ret;
+    return i_ret;
+}
+
 static int archive_extractor_reset( stream_extractor_t* p_extractor )
 {
     private_sys_t* p_sys = p_extractor->p_sys;
@@ -398,6 +493,7 @@ static int archive_extractor_reset( stream_extractor_t* p_extractor )
     }
 
     p_sys->i_offset = 0;
+    p_sys->i_pending = 0;
     p_sys->b_eof = false;
     p_sys->b_dead = false;
     return VLC_SUCCESS;
@@ -498,7 +594,7 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
     switch( i_query )
     {
         case STREAM_CAN_FASTSEEK:
-            *va_arg( args, bool* ) = false;
+            *va_arg( args, bool* ) = p_sys->b_direct;
             break;
 
         case STREAM_CAN_SEEK:
@@ -574,9 +670,23 @@ static ssize_t Read( stream_extractor_t *p_extractor, void* p_data, size_t i_siz
     if( p_sys->b_dead || p_sys->p_entry == NULL )
         return 0;
 
+    if( p_sys->b_direct )
+        return archive_read_direct( p_extractor, p_data, i_size );
+
     if( p_sys->b_eof )
         return 0;
 
+    if( p_sys->i_pending > 0 )
+    {
+        i_ret = __MIN( i_size, p_sys->i_pending );
+        if( p_data )
+            memcpy( p_data, p_sys->p_pending, i_ret );
+        p_sys->p_pending += i_ret;
+        p_sys->i_pending -= i_ret;
+        p_sys->i_offset += i_ret;
+        return i_ret;
+    }
+
     i_ret = archive_read_data( p_arc,
       p_data ? p_data :                        dummy_buffer,
       p_data ? i_size : __MIN( i_size, sizeof( dummy_buffer ) ) );
@@ -630,6 +740,12 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
     if( !p_sys->p_entry || !p_sys->b_seekable_source )
         return VLC_EGENERIC;
 
+    if( p_sys->b_direct )
+    {
+        p_sys->i_offset = i_req;
+        return VLC_SUCCESS;
+    }
+
     if( archive_entry_size_is_set( p_sys->p_entry ) &&
         (uint64_t)archive_entry_size( p_sys->p_entry ) <= i_req )
     {
@@ -639,6 +755,22 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
 
     p_sys->b_eof = false;
 
+    /* the pending block is only valid until the next libarchive call */
+    if( p_sys->i_pending > 0 )
+    {
+        if( p_sys->i_offset <= i_req
+         && i_req - p_sys->i_offset < p_sys->i_pending )
+        {
+            p_sys->p_pending += i_req - p_sys->i_offset;
+            p_sys->i_pending -= i_req - p_sys->i_offset;
+            p_sys->i_offset = i_req;
+            return VLC_SUCCESS;
+        }
+        if( i_req > p_sys->i_offset ) /* skip over the rest of it */
+            p_sys->i_offset += p_sys->i_pending;
+        p_sys->i_pending = 0;
+    }
+
     if( !p_sys->b_seekable_archive || p_sys->b_dead
       || archive_seek_data( p_sys->p_archive, i_req, SEEK_SET ) < 0 )
     {
@@ -744,6 +876,8 @@ static int ExtractorOpen( vlc_object_t* p_obj )
         return VLC_EGENERIC;
     }
 
+    archive_probe_direct( p_sys );
+
     p_extractor->p_sys = p_sys;
     p_extractor->pf_read = Read;
     p_extractor->pf_control = Control;
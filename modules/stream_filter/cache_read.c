@@ -32,6 +32,7 @@
 #include <vlc_plugin.h>
 #include <vlc_stream.h>
 #include <vlc_interrupt.h>
+#include <vlc_mirror.h>
 
 // #define STREAM_DEBUG 1
 
@@ -92,6 +93,7 @@ typedef struct
 
     /* Global buffer */
     uint8_t     *p_buffer;
+    bool         b_mirrored; /* Tracks in mirrored buffers, never split */
 
     /* */
     unsigned     i_used; /* Used since last read */
@@ -132,7 +134,9 @@ static int AStreamRefillStream(stream_t *s)
         if (vlc_killed())
             return VLC_EGENERIC;
 
-        i_read = __MIN(i_toread, STREAM_CACHE_TRACK_SIZE - i_off);
+        i_read = i_toread;
+        if (!sys->b_mirrored)
+            i_read = __MIN(i_read, STREAM_CACHE_TRACK_SIZE - i_off);
         i_read = vlc_stream_Read(s->s, &tk->p_buffer[i_off], i_read);
 
         /* msg_Dbg(s, "AStreamRefillStream: read=%d", i_read); */
@@ -217,6 +221,46 @@ static void AStreamPrebufferStream(stream_t *s)
     }
 }
 
+static int AStreamAllocTracks(stream_sys_t *sys)
+{
+    sys->b_mirrored = true;
+    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
+    {
+        sys->tk[i].p_buffer = vlc_mirror_Alloc(STREAM_CACHE_TRACK_SIZE);
+        if (sys->tk[i].p_buffer == NULL)
+        {
+            while (i > 0)
+                vlc_mirror_Free(sys->tk[--i].p_buffer,
+                                STREAM_CACHE_TRACK_SIZE);
+            sys->b_mirrored = false;
+            break;
+        }
+    }
+
+    if (sys->b_mirrored)
+    {
+        sys->p_buffer = NULL;
+        return VLC_SUCCESS;
+    }
+
+    sys->p_buffer = malloc(STREAM_CACHE_SIZE);
+    if (sys->p_buffer == NULL)
+        return VLC_ENOMEM;
+
+    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
+        sys->tk[i].p_buffer = &sys->p_buffer[i * STREAM_CACHE_TRACK_SIZE];
+    return VLC_SUCCESS;
+}
+
+static void AStreamFreeTracks(stream_sys_t *sys)
+{
+    if (sys->b_mirrored)
+        for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
+            vlc_mirror_Free(sys->tk[i].p_buffer, STREAM_CACHE_TRACK_SIZE);
+    else
+        free(sys->p_buffer);
+}
+
 /****************************************************************************
  * AStreamControlReset:
  ****************************************************************************/
@@ -257,8 +301,9 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
 #endif
 
     unsigned i_off = (tk->i_start + sys->i_offset) % STREAM_CACHE_TRACK_SIZE;
-    size_t i_current = __MIN(tk->i_end - tk->i_start - sys->i_offset,
-                             STREAM_CACHE_TRACK_SIZE - i_off);
+    size_t i_current = tk->i_end - tk->i_start - sys->i_offset;
+    if (!sys->b_mirrored)
+        i_current = __MIN(i_current, STREAM_CACHE_TRACK_SIZE - i_off);
     ssize_t i_copy = __MIN(i_current, len);
     if (i_copy <= 0)
         return 0; /* EOF */
@@ -511,8 +556,7 @@ static int Open(vlc_object_t *obj)
     /* Allocate/Setup our tracks */
     sys->i_offset = 0;
     sys->i_tk     = 0;
-    sys->p_buffer = malloc(STREAM_CACHE_SIZE);
-    if (sys->p_buffer == NULL)
+    if (AStreamAllocTracks(sys))
     {
         free(sys);
         return VLC_ENOMEM;
@@ -529,7 +573,6 @@ static int Open(vlc_object_t *obj)
         sys->tk[i].date  = 0;
         sys->tk[i].i_start = sys->i_pos;
         sys->tk[i].i_end   = sys->i_pos;
-        sys->tk[i].p_buffer = &sys->p_buffer[i * STREAM_CACHE_TRACK_SIZE];
     }
 
     s->p_sys = sys;
@@ -540,7 +583,7 @@ static int Open(vlc_object_t *obj)
     if (sys->tk[sys->i_tk].i_end <= 0)
     {
         msg_Err(s, "cannot pre fill buffer");
-        free(sys->p_buffer);
+        AStreamFreeTracks(sys);
         free(sys);
         return VLC_EGENERIC;
     }
@@ -559,7 +602,7 @@ static void Close(vlc_object_t *obj)
     stream_t *s = (stream_t *)obj;
     stream_sys_t *sys = s->p_sys;
 
-    free(sys->p_buffer);
+    AStreamFreeTracks(sys);
     free(sys);
 }
 
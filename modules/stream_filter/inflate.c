@@ -29,6 +29,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_stream.h>
+#include <vlc_executor.h>
 
 typedef struct
 {
@@ -37,6 +38,50 @@ typedef struct
     unsigned char buffer[16384];
 } stream_sys_t;
 
+/*
+ * BGZF (blocked gzip, as produced by bgzip) is a sequence of gzip members of
+ * at most 64 KiB each, whose compressed size is given in an extra field.
+ * The members are decompressed in parallel, and indexed for seeking.
+ */
+#define BGZF_MAX_BLOCK 65536
+#define BGZF_HEADER 18
+
+struct bgzf_block
+{
+    struct vlc_runnable runnable;
+    size_t in_size;
+    size_t out_size;
+    bool ok;
+    uint8_t in[BGZF_MAX_BLOCK];
+    uint8_t out[BGZF_MAX_BLOCK];
+};
+
+struct bgzf_index
+{
+    uint64_t in; /**< offset of the member in the source */
+    uint64_t out; /**< decompressed offset */
+};
+
+typedef struct
+{
+    vlc_executor_t *executor;
+    struct bgzf_block *blockv;
+    unsigned blockc;
+    unsigned block_count; /**< blocks decompressed in the current batch */
+    unsigned block_index; /**< block being read */
+    size_t block_pos; /**< read position in that block */
+
+    uint64_t offset; /**< decompressed read position */
+    uint64_t in_offset; /**< source offset of the next member */
+    uint64_t out_next; /**< decompressed offset of the next member */
+    bool can_seek;
+    bool eof;
+
+    struct bgzf_index *index;
+    size_t index_count;
+    size_t index_size;
+} bgzf_sys_t;
+
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -133,6 +178,275 @@ static int Control(stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+/** Returns the total member size from a BGZF header, or 0 if not BGZF */
+static size_t BgzfBlockSize(const uint8_t *hdr)
+{
+    if (hdr[0] != 0x1F || hdr[1] != 0x8B || hdr[2] != 8 || !(hdr[3] & 0x04))
+        return 0;
+    if (GetWLE(&hdr[10]) != 6 || hdr[12] != 'B' || hdr[13] != 'C'
+     || GetWLE(&hdr[14]) != 2)
+        return 0;
+    return GetWLE(&hdr[16]) + 1;
+}
+
+static void BgzfDecompress(void *data)
+{
+    struct bgzf_block *block = data;
+    z_stream z = { .zalloc = Z_NULL, .zfree = Z_NULL, .opaque = Z_NULL };
+
+    block->ok = false;
+
+    /* header, raw deflate data, CRC32 and ISIZE */
+    size_t isize = GetDWLE(&block->in[block->in_size - 4]);
+    uint32_t crc = GetDWLE(&block->in[block->in_size - 8]);
+    if (isize > BGZF_MAX_BLOCK)
+        return;
+
+    if (inflateInit2(&z, -15) != Z_OK)
+        return;
+    z.next_in = block->in + BGZF_HEADER;
+    z.avail_in = block->in_size - BGZF_HEADER - 8;
+    z.next_out = block->out;
+    z.avail_out = isize;
+
+    int val = inflate(&z, Z_FINISH);
+    inflateEnd(&z);
+    if (val != Z_STREAM_END || z.avail_out != 0)
+        return;
+
+    block->out_size = isize;
+    block->ok = crc32(0, block->out, isize) == crc;
+}
+
+static int BgzfIndexAdd(bgzf_sys_t *sys, uint64_t in, uint64_t out)
+{
+    if (sys->index_count > 0 && sys->index[sys->index_count - 1].in >= in)
+        return 0; /* already known */
+
+    if (sys->index_count == sys->index_size)
+    {
+        size_t size = sys->index_size ? sys->index_size * 2 : 256;
+        struct bgzf_index *index = realloc(sys->index, size * sizeof (*index));
+        if (unlikely(index == NULL))
+            return -1;
+        sys->index = index;
+        sys->index_size = size;
+    }
+    sys->index[sys->index_count++] = (struct bgzf_index){ in, out };
+    return 0;
+}
+
+/** Reads and decompresses the next batch of members */
+static int BgzfFill(stream_t *stream)
+{
+    bgzf_sys_t *sys = stream->p_sys;
+    unsigned count = 0;
+
+    while (count < sys->blockc)
+    {
+        struct bgzf_block *block = &sys->blockv[count];
+        ssize_t val = vlc_stream_Read(stream->s, block->in, BGZF_HEADER);
+        if (val == 0)
+            break;
+
+        size_t size = val == BGZF_HEADER ? BgzfBlockSize(block->in) : 0;
+        if (size < BGZF_HEADER + 8 || size > BGZF_MAX_BLOCK)
+        {
+            msg_Err(stream, "corrupt BGZF member");
+            return -1;
+        }
+
+        val = vlc_stream_Read(stream->s, block->in + BGZF_HEADER,
+                              size - BGZF_HEADER);
+        if (val != (ssize_t)(size - BGZF_HEADER))
+        {
+            msg_Err(stream, "truncated BGZF member");
+            return -1;
+        }
+        block->in_size = size;
+
+        /* the decompressed size is known beforehand from ISIZE */
+        if (BgzfIndexAdd(sys, sys->in_offset, sys->out_next))
+            return -1;
+        sys->in_offset += size;
+        sys->out_next += GetDWLE(&block->in[size - 4]);
+
+        vlc_executor_Submit(sys->executor, &block->runnable);
+        count++;
+    }
+
+    vlc_executor_WaitIdle(sys->executor);
+
+    for (unsigned i = 0; i < count; i++)
+        if (!sys->blockv[i].ok)
+        {
+            msg_Err(stream, "corrupt BGZF member data");
+            return -1;
+        }
+
+    sys->block_count = count;
+    sys->block_index = 0;
+    sys->block_pos = 0;
+    if (count == 0)
+        sys->eof = true;
+    return 0;
+}
+
+static ssize_t BgzfRead(stream_t *stream, void *buf, size_t buflen)
+{
+    bgzf_sys_t *sys = stream->p_sys;
+
+    while (!sys->eof)
+    {
+        if (sys->block_index >= sys->block_count)
+        {
+            if (BgzfFill(stream))
+            {
+                sys->eof = true;
+                return -1;
+            }
+            continue;
+        }
+
+        struct bgzf_block *block = &sys->blockv[sys->block_index];
+        size_t len = __MIN(buflen, block->out_size - sys->block_pos);
+        if (len == 0)
+        {   /* end of member, or empty EOF marker member */
+            sys->block_index++;
+            sys->block_pos = 0;
+            continue;
+        }
+
+        if (buf != NULL)
+            memcpy(buf, block->out + sys->block_pos, len);
+        sys->block_pos += len;
+        sys->offset += len;
+        return len;
+    }
+    return 0;
+}
+
+static int BgzfSeek(stream_t *stream, uint64_t offset)
+{
+    bgzf_sys_t *sys = stream->p_sys;
+
+    if (!sys->can_seek || sys->index_count == 0)
+        return -1;
+
+    /* Find the last known member starting at or before the offset */
+    size_t lo = 0, hi = sys->index_count;
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (sys->index[mid].out <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    const struct bgzf_index *entry = &sys->index[lo];
+    if (vlc_stream_Seek(stream->s, entry->in))
+        return -1;
+
+    sys->in_offset = entry->in;
+    sys->out_next = entry->out;
+    sys->offset = entry->out;
+    sys->block_count = sys->block_index = 0;
+    sys->eof = false;
+
+    /* Decompress up to the offset (members not indexed yet included) */
+    while (sys->offset < offset)
+    {
+        ssize_t val = BgzfRead(stream, NULL, offset - sys->offset);
+        if (val <= 0)
+            break;
+    }
+    return 0;
+}
+
+static int BgzfControl(stream_t *stream, int query, va_list args)
+{
+    bgzf_sys_t *sys = stream->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+            *va_arg(args, bool *) = sys->can_seek;
+            break;
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+            return vlc_stream_vaControl(stream->s, query, args);
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int OpenBgzf(stream_t *stream)
+{
+    unsigned threads = vlc_GetCPUCount();
+    if (threads < 2)
+        return VLC_EGENERIC; /* the plain inflate path is as good */
+    threads = __MIN(threads, 8);
+
+    bgzf_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->blockc = 2 * threads;
+    sys->blockv = vlc_alloc(sys->blockc, sizeof (*sys->blockv));
+    sys->executor = vlc_executor_New(threads);
+    if (unlikely(sys->blockv == NULL || sys->executor == NULL))
+    {
+        if (sys->executor != NULL)
+            vlc_executor_Delete(sys->executor);
+        free(sys->blockv);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
+    for (unsigned i = 0; i < sys->blockc; i++)
+    {
+        sys->blockv[i].runnable.run = BgzfDecompress;
+        sys->blockv[i].runnable.userdata = &sys->blockv[i];
+    }
+    sys->block_count = sys->block_index = 0;
+    sys->block_pos = 0;
+    sys->offset = 0;
+    sys->in_offset = vlc_stream_Tell(stream->s);
+    sys->out_next = 0;
+    sys->eof = false;
+    sys->index = NULL;
+    sys->index_count = sys->index_size = 0;
+    if (vlc_stream_Control(stream->s, STREAM_CAN_SEEK, &sys->can_seek))
+        sys->can_seek = false;
+
+    msg_Dbg(stream, "BGZF stream, using %u threads", threads);
+    stream->p_sys = sys;
+    stream->pf_read = BgzfRead;
+    stream->pf_seek = BgzfSeek;
+    stream->pf_control = BgzfControl;
+    return VLC_SUCCESS;
+}
+
+static void CloseBgzf(stream_t *stream)
+{
+    bgzf_sys_t *sys = stream->p_sys;
+
+    vlc_executor_Delete(sys->executor);
+    free(sys->index);
+    free(sys->blockv);
+    free(sys);
+}
+
 static int Open(vlc_object_t *obj)
 {
     stream_t *stream = (stream_t *)obj;
@@ -151,6 +465,11 @@ static int Open(vlc_object_t *obj)
     else
         return VLC_EGENERIC;
 
+    if (bits > 15 && vlc_stream_Peek(stream->s, &peek, BGZF_HEADER)
+                     == BGZF_HEADER
+     && BgzfBlockSize(peek) > 0 && OpenBgzf(stream) == VLC_SUCCESS)
+        return VLC_SUCCESS;
+
     stream_sys_t *sys = malloc(sizeof (*sys));
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
@@ -181,6 +500,12 @@ static void Close (vlc_object_t *obj)
     stream_t *stream = (stream_t *)obj;
     stream_sys_t *sys = stream->p_sys;
 
+    if (stream->pf_read == BgzfRead)
+    {
+        CloseBgzf(stream);
+        return;
+    }
+
     inflateEnd(&sys->zstream);
     free(sys);
 }
@@ -35,6 +35,10 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* Adaptive mode: minimum time and size of data read ahead */
+#define PREFETCH_LEAD_TIME VLC_TICK_FROM_SEC(4)
+#define PREFETCH_LEAD_SIZE (1 << 20)
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -75,6 +79,24 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    /* Adaptive mode */
+    bool         adaptive;
+    uint64_t     upstream_offset; /**< current offset of the source */
+    vlc_tick_t   seek_date; /**< date of the last seek until data came */
+    vlc_tick_t   latency; /**< average latency of the source */
+    uint64_t     read_bytes;
+    vlc_tick_t   read_time;
+    uint64_t     rate; /**< consumption rate (bytes per second) */
+    uint64_t     rate_bytes;
+    vlc_tick_t   rate_date;
+
+    /* Data at the end of the stream, read without dropping the buffer */
+    char        *tail;
+    uint64_t     tail_offset;
+    size_t       tail_length;
+    size_t       tail_size;
+    bool         tail_eof;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -85,9 +107,27 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     vlc_mutex_unlock(&sys->lock);
     assert(length > 0);
 
+    vlc_tick_t start = vlc_tick_now();
     ssize_t val = vlc_stream_ReadPartial(stream->s, buf, length);
+    vlc_tick_t now = vlc_tick_now();
 
     vlc_mutex_lock(&sys->lock);
+
+    if (val > 0)
+    {
+        sys->upstream_offset += val;
+        sys->read_bytes += val;
+        sys->read_time += now - start;
+
+        if (sys->seek_date != VLC_TICK_INVALID)
+        {   /* First data since the last seek */
+            vlc_tick_t latency = now - sys->seek_date;
+
+            sys->latency = sys->latency ? (3 * sys->latency + latency) / 4
+                                        : latency;
+            sys->seek_date = VLC_TICK_INVALID;
+        }
+    }
     return val;
 }
 
@@ -97,12 +137,19 @@ static int ThreadSeek(stream_t *stream, uint64_t seek_offset)
 
     vlc_mutex_unlock(&sys->lock);
 
+    vlc_tick_t start = vlc_tick_now();
     int val = vlc_stream_Seek(stream->s, seek_offset);
     if (val != VLC_SUCCESS)
         msg_Err(stream, "cannot seek (to offset %"PRIu64")", seek_offset);
 
     vlc_mutex_lock(&sys->lock);
 
+    if (val == VLC_SUCCESS)
+    {
+        sys->upstream_offset = seek_offset;
+        sys->seek_date = start;
+    }
+
     return (val == VLC_SUCCESS) ? 0 : -1;
 }
 
@@ -123,6 +170,61 @@ static int ThreadControl(stream_t *stream, int query, ...)
     return ret;
 }
 
+/**
+ * Returns how far ahead of the reader to read.
+ *
+ * In adaptive mode, this covers a few seconds of the consumption rate and a
+ * few times the latency of the source; the rest of the buffer keeps already
+ * read data for backward seeks.
+ */
+static size_t ReadAheadTarget(const stream_sys_t *sys)
+{
+    if (!sys->adaptive || sys->rate == 0)
+        return sys->buffer_size;
+
+    uint64_t target = sys->rate * (PREFETCH_LEAD_TIME + 4 * sys->latency)
+                      / CLOCK_FREQ;
+    if (target < PREFETCH_LEAD_SIZE)
+        target = PREFETCH_LEAD_SIZE;
+    if (target > sys->buffer_size)
+        target = sys->buffer_size;
+    return target;
+}
+
+/**
+ * Returns the distance beyond which forward jumps are seeked.
+ *
+ * In adaptive mode, shorter jumps are read through if that takes less time
+ * than the latency of a seek.
+ */
+static uint64_t SeekThreshold(const stream_sys_t *sys)
+{
+    uint64_t threshold = sys->seek_threshold;
+
+    if (sys->adaptive && sys->read_time > 0)
+    {
+        uint64_t through = sys->read_bytes * sys->latency / sys->read_time;
+
+        if (through > sys->buffer_size / 2)
+            through = sys->buffer_size / 2;
+        if (threshold < through)
+            threshold = through;
+    }
+    return threshold;
+}
+
+/**
+ * Checks for a jump to the end of the stream (typically to an MP4 index)
+ * that will likely be followed by a jump back into the buffered data.
+ */
+static bool TailWanted(const stream_sys_t *sys, uint64_t offset)
+{
+    if (sys->tail == NULL || offset + sys->tail_size < sys->size)
+        return false;
+    return offset >= sys->buffer_offset + sys->buffer_length
+                     + SeekThreshold(sys);
+}
+
 static void *Thread(void *data)
 {
     stream_t *stream = data;
@@ -161,6 +263,48 @@ static void *Thread(void *data)
 
         uint_fast64_t stream_offset = sys->stream_offset;
 
+        if (TailWanted(sys, stream_offset))
+        {   /* Read the end of the stream aside, keeping the buffer */
+            uint64_t end = sys->tail_offset + sys->tail_length;
+
+            if (stream_offset < sys->tail_offset || stream_offset > end
+             || (stream_offset == end && sys->tail_length == sys->tail_size))
+            {
+                msg_Dbg(stream, "reading the end (offset %"PRIu64") aside",
+                        (uint64_t)stream_offset);
+                sys->tail_offset = end = stream_offset;
+                sys->tail_length = 0;
+                sys->tail_eof = false;
+            }
+
+            if (sys->tail_eof || sys->tail_length == sys->tail_size)
+            {
+                vlc_cond_wait(&sys->wait_space, &sys->lock);
+                continue;
+            }
+
+            if (sys->upstream_offset != end)
+            {
+                if (ThreadSeek(stream, end))
+                {
+                    sys->error = true;
+                    vlc_cond_signal(&sys->wait_data);
+                }
+                continue;
+            }
+
+            ssize_t val = ThreadRead(stream, sys->tail + sys->tail_length,
+                                     sys->tail_size - sys->tail_length);
+            if (val < 0)
+                continue;
+            if (val == 0)
+                sys->tail_eof = true;
+
+            sys->tail_length += val;
+            vlc_cond_signal(&sys->wait_data);
+            continue;
+        }
+
         if (stream_offset < sys->buffer_offset)
         {   /* Need to seek backward */
             if (ThreadSeek(stream, stream_offset) == 0)
@@ -197,7 +341,7 @@ static void *Thread(void *data)
          * seek is a no-op, and continue as if seeking was not supported.
          * WARNING: Except problems with misbehaving access plug-ins. */
         if (sys->can_seek
-         && history >= (sys->buffer_length + sys->seek_threshold))
+         && history >= (sys->buffer_length + SeekThreshold(sys)))
         {
             if (ThreadSeek(stream, stream_offset) == 0)
             {
@@ -218,8 +362,28 @@ static void *Thread(void *data)
             continue;
         }
 
+        if (sys->upstream_offset != sys->buffer_offset + sys->buffer_length)
+        {   /* Resume after the data read aside */
+            if (ThreadSeek(stream, sys->buffer_offset + sys->buffer_length))
+            {
+                sys->error = true;
+                vlc_cond_signal(&sys->wait_data);
+            }
+            continue;
+        }
+
         assert(sys->buffer_size >= sys->buffer_length);
 
+        size_t target = ReadAheadTarget(sys);
+        size_t unread = (history < sys->buffer_length)
+                        ? sys->buffer_length - history : 0;
+
+        if (history > 0 && unread >= target)
+        {   /* Far enough ahead: keep the historical data */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
         size_t len = sys->buffer_size - sys->buffer_length;
         if (len == 0)
         {   /* Buffer is full */
@@ -231,6 +395,8 @@ static void *Thread(void *data)
 
             /* Discard some historical data to make room. */
             len = history > sys->buffer_length ? sys->buffer_length : history;
+            if (len > target - unread)
+                len = target - unread;
 
             sys->buffer_offset += len;
             sys->buffer_length -= len;
@@ -278,12 +444,24 @@ static int Seek(stream_t *stream, uint64_t offset)
     return 0;
 }
 
-static size_t BufferLevel(const stream_t *stream, bool *eof)
+static size_t BufferLevel(const stream_t *stream, bool *eof,
+                          const char **data)
 {
     stream_sys_t *sys = stream->p_sys;
 
     *eof = false;
 
+    if (sys->stream_offset >= sys->tail_offset
+     && (sys->stream_offset - sys->tail_offset) <= sys->tail_length
+     && TailWanted(sys, sys->stream_offset))
+    {
+        size_t offset = sys->stream_offset - sys->tail_offset;
+
+        *eof = sys->tail_eof;
+        *data = sys->tail + offset;
+        return sys->tail_length - offset;
+    }
+
     if (sys->stream_offset < sys->buffer_offset)
         return 0;
     if ((sys->stream_offset - sys->buffer_offset) >= sys->buffer_length)
@@ -291,13 +469,39 @@ static size_t BufferLevel(const stream_t *stream, bool *eof)
         *eof = sys->eof;
         return 0;
     }
-    return sys->buffer_offset + sys->buffer_length - sys->stream_offset;
+
+    size_t offset = sys->stream_offset % sys->buffer_size;
+    size_t level = sys->buffer_offset + sys->buffer_length
+                   - sys->stream_offset;
+
+    /* Do not step past the sharp edge of the circular buffer */
+    if (offset + level > sys->buffer_size)
+        level = sys->buffer_size - offset;
+
+    *data = sys->buffer + offset;
+    return level;
+}
+
+static void RateUpdate(stream_sys_t *sys, size_t length)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    sys->rate_bytes += length;
+    if (now - sys->rate_date >= VLC_TICK_FROM_SEC(1))
+    {
+        uint64_t rate = sys->rate_bytes * CLOCK_FREQ / (now - sys->rate_date);
+
+        sys->rate = sys->rate ? (3 * sys->rate + rate) / 4 : rate;
+        sys->rate_bytes = 0;
+        sys->rate_date = now;
+    }
 }
 
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
-    size_t copy, offset;
+    const char *data;
+    size_t copy;
     bool eof;
 
     if (buflen == 0)
@@ -311,7 +515,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_cond_signal(&sys->wait_space);
     }
 
-    while ((copy = BufferLevel(stream, &eof)) == 0 && !eof)
+    while ((copy = BufferLevel(stream, &eof, &data)) == 0 && !eof)
     {
         void *data[2];
 
@@ -326,15 +530,14 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_interrupt_forward_stop(data);
     }
 
-    offset = sys->stream_offset % sys->buffer_size;
     if (copy > buflen)
         copy = buflen;
-    /* Do not step past the sharp edge of the circular buffer */
-    if (offset + copy > sys->buffer_size)
-        copy = sys->buffer_size - offset;
 
-    memcpy(buf, sys->buffer + offset, copy);
+    if (copy > 0)
+        memcpy(buf, data, copy);
     sys->stream_offset += copy;
+    if (sys->adaptive)
+        RateUpdate(sys, copy);
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -386,6 +589,9 @@ static int Control(stream_t *stream, int query, va_list args)
 
             vlc_mutex_lock(&sys->lock);
             sys->paused = paused;
+            /* Do not count the pause in the consumption rate */
+            sys->rate_bytes = 0;
+            sys->rate_date = vlc_tick_now();
             vlc_cond_signal(&sys->wait_space);
             vlc_mutex_unlock (&sys->lock);
             break;
@@ -467,11 +673,29 @@ static int Open(vlc_object_t *obj)
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
     sys->controls = NULL;
 
+    sys->adaptive = var_InheritBool(obj, "prefetch-adaptive");
+    sys->upstream_offset = 0;
+    sys->seek_date = vlc_tick_now();
+    sys->latency = 0;
+    sys->read_bytes = 0;
+    sys->read_time = 0;
+    sys->rate = 0;
+    sys->rate_bytes = 0;
+    sys->rate_date = sys->seek_date;
+    sys->tail = NULL;
+    sys->tail_offset = 0;
+    sys->tail_length = 0;
+    sys->tail_size = sys->buffer_size / 4;
+    sys->tail_eof = false;
+
     uint64_t size = stream_Size(stream->s);
     if (size > 0)
     {   /* No point allocating a buffer larger than the source stream */
         if (sys->buffer_size > size)
             sys->buffer_size = size;
+        /* Room to read the end of the stream aside, if needed */
+        else if (sys->adaptive && sys->can_seek && sys->size != (uint64_t)-1)
+            sys->tail = malloc(sys->tail_size);
     }
 
     sys->buffer = malloc(sys->buffer_size);
@@ -494,13 +718,15 @@ static int Open(vlc_object_t *obj)
         goto error;
     }
 
-    msg_Dbg(stream, "using %zu bytes buffer", sys->buffer_size);
+    msg_Dbg(stream, "using %zu bytes buffer%s", sys->buffer_size,
+            sys->adaptive ? " (adaptive)" : "");
     stream->pf_read = Read;
     stream->pf_seek = Seek;
     stream->pf_control = Control;
     return VLC_SUCCESS;
 
 error:
+    free(sys->tail);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -530,6 +756,7 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    free(sys->tail);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -550,4 +777,9 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
         change_integer_range(0, UINT64_C(1) << 60)
+    add_bool("prefetch-adaptive", false, N_("Adaptive prefetching"),
+             N_("Read ahead according to the consumption rate and the "
+                "latency of the source, keep the rest of the buffer for "
+                "backward seeks, and read the end of the stream aside when "
+                "a demuxer looks for an index there."))
 vlc_module_end()
@@ -104,6 +104,10 @@ struct sout_stream_sys_t
         , out_force_reload( false )
         , perf_warning_shown( false )
         , transcoding_state( TRANSCODING_NONE )
+        , mp4_remux( false )
+        , mp4_failed( false )
+        , remux_audio( false )
+        , remux_video_codec( 0 )
         , venc_opt_idx ( -1 )
         , out_streams_added( 0 )
     {
@@ -150,6 +154,10 @@ struct sout_stream_sys_t
     bool                               out_force_reload;
     bool                               perf_warning_shown;
     int                                transcoding_state;
+    bool                               mp4_remux;
+    bool                               mp4_failed;
+    bool                               remux_audio;
+    vlc_fourcc_t                       remux_video_codec;
     int                                venc_opt_idx;
     std::vector<sout_stream_id_sys_t*> streams;
     std::vector<sout_stream_id_sys_t*> out_streams;
@@ -174,6 +182,7 @@ struct sout_stream_id_sys_t
 
 static const char DEFAULT_MUXER[] = "avformat{mux=matroska,options={live=1},reset-ts}";
 static const char DEFAULT_MUXER_WEBM[] = "avformat{mux=webm,options={live=1},reset-ts}";
+static const char DEFAULT_MUXER_MP4[] = "mp4stream{frag-keyframes}";
 
 
 /*****************************************************************************
@@ -742,10 +751,13 @@ static void Del(sout_stream_t *p_stream, void *_id)
 
 /**
  * Transcode steps:
- * 0: Accept HEVC/VP9 & all supported audio formats
- * 1: Transcode to h264 & accept all supported audio formats if the video codec
- *    was HEVC/VP9
- * 2: Transcode to H264 & MP3
+ * 0: Accept HEVC/VP9 & all supported audio formats, remuxed into fragmented
+ *    MP4 when the codecs allow it, or else WebM or Matroska
+ * 1: Same, but never into MP4
+ * 2: Transcode to h264 & accept all supported audio formats if the video codec
+ *    was HEVC/VP9, or only transcode the audio if the video codec was H264,
+ *    which every device decodes
+ * 3: Transcode to H264 & MP3
  *
  * Additionally:
  * - Allow (E)AC3 passthrough depending on the audio-passthrough
@@ -868,7 +880,12 @@ bool sout_stream_sys_t::startSoutChain(sout_stream_t *p_stream,
 
 void sout_stream_sys_t::setNextTranscodingState()
 {
-    if (!(transcoding_state & TRANSCODING_VIDEO))
+    if (mp4_remux && !mp4_failed)
+        mp4_failed = true;
+    else if (!(transcoding_state & TRANSCODING_AUDIO) && remux_audio
+          && remux_video_codec == VLC_CODEC_H264)
+        transcoding_state |= TRANSCODING_AUDIO;
+    else if (!(transcoding_state & TRANSCODING_VIDEO))
         transcoding_state |= TRANSCODING_VIDEO;
     else if (!(transcoding_state & TRANSCODING_AUDIO))
         transcoding_state = TRANSCODING_AUDIO;
@@ -876,7 +893,8 @@ void sout_stream_sys_t::setNextTranscodingState()
 
 bool sout_stream_sys_t::transcodingCanFallback() const
 {
-    return transcoding_state != (TRANSCODING_VIDEO|TRANSCODING_AUDIO);
+    return (mp4_remux && !mp4_failed)
+        || transcoding_state != (TRANSCODING_VIDEO|TRANSCODING_AUDIO);
 }
 
 std::string
@@ -1068,10 +1086,20 @@ bool sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
                          ( i_codec_video == VLC_CODEC_VP8 ||
                            i_codec_video == VLC_CODEC_VP9 );
 
+    /* MP4 is the container the devices support best */
+    const bool is_mp4 = !is_webm && !mp4_failed
+        && ( !p_original_video || i_codec_video == VLC_CODEC_H264 ||
+             i_codec_video == VLC_CODEC_HEVC )
+        && ( !p_original_audio || i_codec_audio == VLC_CODEC_MP4A ||
+             i_codec_audio == VLC_CODEC_MP3 || i_codec_audio == VLC_CODEC_A52 ||
+             i_codec_audio == VLC_CODEC_EAC3 );
+
     if ( !p_original_video )
     {
         if( is_webm )
             mime = "audio/webm";
+        else if( is_mp4 )
+            mime = "audio/mp4";
         else
             mime = "audio/x-matroska";
     }
@@ -1079,12 +1107,19 @@ bool sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
     {
         if ( is_webm )
             mime = "video/webm";
+        else if( is_mp4 )
+            mime = "video/mp4";
         else
             mime = "video/x-matroska";
     }
 
+    mp4_remux = is_mp4;
+    remux_audio = p_original_audio && !( new_transcoding_state & TRANSCODING_AUDIO );
+    remux_video_codec = ( new_transcoding_state & TRANSCODING_VIDEO ) ? 0 : i_codec_video;
+
     ssout << "chromecast-proxy:"
-          << "std{mux=" << ( is_webm ? DEFAULT_MUXER_WEBM : DEFAULT_MUXER )
+          << "std{mux=" << ( is_webm ? DEFAULT_MUXER_WEBM :
+                             is_mp4 ? DEFAULT_MUXER_MP4 : DEFAULT_MUXER )
           << ",access=chromecast-http}";
 
     if ( !startSoutChain( p_stream, new_streams, ssout.str(),
@@ -1214,9 +1249,12 @@ static void on_input_event_cb(void *data, enum cc_input_event event, union cc_in
             if( p_sys->transcodingCanFallback() )
             {
                 p_sys->setNextTranscodingState();
+                const int state = p_sys->transcoding_state;
                 msg_Warn(p_stream, "Load failed detected. Switching to next "
-                         "configuration. Transcoding video%s",
-                         p_sys->transcoding_state & TRANSCODING_AUDIO ? "/audio" : "");
+                         "configuration. Transcoding %s",
+                         state == (TRANSCODING_VIDEO|TRANSCODING_AUDIO) ? "video/audio" :
+                         state & TRANSCODING_VIDEO ? "video" :
+                         state & TRANSCODING_AUDIO ? "audio" : "nothing");
                 p_sys->out_force_reload = p_sys->es_changed = true;
             }
             break;
@@ -28,6 +28,8 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
@@ -60,6 +62,29 @@ static void *Add( sout_stream_t *, const es_format_t * );
 static void  Del( sout_stream_t *, void * );
 static int   Send( sout_stream_t *, void *, block_t * );
 
+/* Branch running on its own thread, fed through a bounded queue */
+typedef struct
+{
+    sout_stream_t   *p_stream;
+    vlc_thread_t    thread;
+    vlc_mutex_t     lock; /* serializes the calls to the branch */
+
+    vlc_mutex_t     queue_lock;
+    vlc_cond_t      wait;
+    vlc_cond_t      drain;
+    struct
+    {
+        void        *id;
+        block_t     *p_block;
+    }               *queue;
+    size_t          i_size;
+    size_t          i_head;
+    size_t          i_count;
+    bool            b_block; /* wait for room rather than drop */
+    bool            b_quit;
+    unsigned        i_dropped;
+} duplicate_async_t;
+
 typedef struct
 {
     int             i_nb_streams;
@@ -67,17 +92,152 @@ typedef struct
 
     int             i_nb_select;
     char            **ppsz_select;
+
+    int             i_nb_async;
+    duplicate_async_t **pp_async; /* NULL for synchronous branches */
 } sout_stream_sys_t;
 
 typedef struct
 {
     int                 i_nb_ids;
     void                **pp_ids;
+    bool                *pb_dropped; /* a block was dropped per branch */
 } sout_stream_id_sys_t;
 
 static bool ESSelected( struct vlc_logger *, const es_format_t *fmt,
                         char *psz_select );
 
+/*****************************************************************************
+ * Asynchronous branches
+ *****************************************************************************/
+static void *AsyncThread( void *data )
+{
+    duplicate_async_t *p_async = data;
+
+    for( ;; )
+    {
+        vlc_mutex_lock( &p_async->queue_lock );
+        while( p_async->i_count == 0 && !p_async->b_quit )
+            vlc_cond_wait( &p_async->wait, &p_async->queue_lock );
+        if( p_async->i_count == 0 )
+        {
+            /* Stopped, and everything queued was sent */
+            vlc_mutex_unlock( &p_async->queue_lock );
+            break;
+        }
+        vlc_mutex_unlock( &p_async->queue_lock );
+
+        /* The ES may be deleted meanwhile, along with its queued blocks */
+        vlc_mutex_lock( &p_async->lock );
+        vlc_mutex_lock( &p_async->queue_lock );
+        void *id = NULL;
+        block_t *p_block = NULL;
+        if( p_async->i_count > 0 )
+        {
+            id = p_async->queue[p_async->i_head].id;
+            p_block = p_async->queue[p_async->i_head].p_block;
+            p_async->i_head = (p_async->i_head + 1) % p_async->i_size;
+            p_async->i_count--;
+            vlc_cond_signal( &p_async->drain );
+        }
+        vlc_mutex_unlock( &p_async->queue_lock );
+
+        if( p_block != NULL )
+            sout_StreamIdSend( p_async->p_stream, id, p_block );
+        vlc_mutex_unlock( &p_async->lock );
+    }
+    return NULL;
+}
+
+static duplicate_async_t *AsyncNew( sout_stream_t *p_stream, size_t i_size )
+{
+    duplicate_async_t *p_async = malloc( sizeof( *p_async ) );
+    if( unlikely(p_async == NULL) )
+        return NULL;
+
+    p_async->queue = vlc_alloc( i_size, sizeof( *p_async->queue ) );
+    if( unlikely(p_async->queue == NULL) )
+    {
+        free( p_async );
+        return NULL;
+    }
+
+    p_async->p_stream = p_stream;
+    vlc_mutex_init( &p_async->lock );
+    vlc_mutex_init( &p_async->queue_lock );
+    vlc_cond_init( &p_async->wait );
+    vlc_cond_init( &p_async->drain );
+    p_async->i_size = i_size;
+    p_async->i_head = 0;
+    p_async->i_count = 0;
+    p_async->b_block = false;
+    p_async->b_quit = false;
+    p_async->i_dropped = 0;
+    return p_async;
+}
+
+static void AsyncDelete( duplicate_async_t *p_async )
+{
+    vlc_mutex_lock( &p_async->queue_lock );
+    p_async->b_quit = true;
+    vlc_cond_signal( &p_async->wait );
+    vlc_mutex_unlock( &p_async->queue_lock );
+
+    vlc_join( p_async->thread, NULL );
+    free( p_async->queue );
+    free( p_async );
+}
+
+/* Queues a block for a branch. Returns false if it was dropped. */
+static bool AsyncSend( duplicate_async_t *p_async, void *id, block_t *p_block )
+{
+    vlc_mutex_lock( &p_async->queue_lock );
+    if( p_async->b_block )
+        while( p_async->i_count == p_async->i_size )
+            vlc_cond_wait( &p_async->drain, &p_async->queue_lock );
+
+    if( p_async->i_count == p_async->i_size )
+    {
+        p_async->i_dropped++;
+        vlc_mutex_unlock( &p_async->queue_lock );
+        block_Release( p_block );
+        return false;
+    }
+
+    size_t i_tail = (p_async->i_head + p_async->i_count) % p_async->i_size;
+    p_async->queue[i_tail].id = id;
+    p_async->queue[i_tail].p_block = p_block;
+    p_async->i_count++;
+    vlc_cond_signal( &p_async->wait );
+    vlc_mutex_unlock( &p_async->queue_lock );
+    return true;
+}
+
+/* Drops the blocks of an ES still queued for a branch. */
+static void AsyncFlush( duplicate_async_t *p_async, void *id )
+{
+    vlc_mutex_assert( &p_async->lock );
+
+    vlc_mutex_lock( &p_async->queue_lock );
+    size_t i_count = 0;
+    for( size_t i = 0; i < p_async->i_count; i++ )
+    {
+        size_t i_from = (p_async->i_head + i) % p_async->i_size;
+
+        if( p_async->queue[i_from].id == id )
+        {
+            block_Release( p_async->queue[i_from].p_block );
+            continue;
+        }
+
+        size_t i_to = (p_async->i_head + i_count++) % p_async->i_size;
+        p_async->queue[i_to] = p_async->queue[i_from];
+    }
+    p_async->i_count = i_count;
+    vlc_cond_signal( &p_async->drain );
+    vlc_mutex_unlock( &p_async->queue_lock );
+}
+
 /*****************************************************************************
  * Control
  *****************************************************************************/
@@ -94,9 +254,16 @@ static int Control( sout_stream_t *p_stream, int i_query, va_list args )
             void *spu_hl = va_arg(args, void *);
             for( int i = 0; i < id->i_nb_ids; i++ )
             {
-                if( id->pp_ids[i] )
-                    sout_StreamControl( p_sys->pp_streams[i], i_query,
-                                        id->pp_ids[i], spu_hl );
+                duplicate_async_t *p_async = p_sys->pp_async[i];
+
+                if( !id->pp_ids[i] )
+                    continue;
+                if( p_async )
+                    vlc_mutex_lock( &p_async->lock );
+                sout_StreamControl( p_sys->pp_streams[i], i_query,
+                                    id->pp_ids[i], spu_hl );
+                if( p_async )
+                    vlc_mutex_unlock( &p_async->lock );
             }
             return VLC_SUCCESS;
         }
@@ -126,6 +293,7 @@ static int Open( vlc_object_t *p_this )
 
     TAB_INIT( p_sys->i_nb_streams, p_sys->pp_streams );
     TAB_INIT( p_sys->i_nb_select, p_sys->ppsz_select );
+    TAB_INIT( p_sys->i_nb_async, p_sys->pp_async );
 
     char **ppsz_select = NULL;
 
@@ -143,9 +311,38 @@ static int Open( vlc_object_t *p_this )
             {
                 TAB_APPEND( p_sys->i_nb_streams, p_sys->pp_streams, s );
                 TAB_APPEND( p_sys->i_nb_select,  p_sys->ppsz_select, NULL );
+                TAB_APPEND( p_sys->i_nb_async, p_sys->pp_async, NULL );
                 ppsz_select = &p_sys->ppsz_select[p_sys->i_nb_select - 1];
             }
         }
+        else if( !strcmp( p_cfg->psz_name, "async" )
+              || !strcmp( p_cfg->psz_name, "overflow" ) )
+        {
+            const char *psz = p_cfg->psz_value ? p_cfg->psz_value : "";
+            duplicate_async_t **pp_async = p_sys->i_nb_async > 0
+                ? &p_sys->pp_async[p_sys->i_nb_async - 1] : NULL;
+
+            if( pp_async == NULL )
+                msg_Err( p_stream, " * ignore %s `%s'", p_cfg->psz_name, psz );
+            else if( p_cfg->psz_name[0] == 'a' )
+            {
+                /* Queue length in blocks */
+                int i_size = atoi( psz );
+
+                if( i_size > 0 && *pp_async == NULL )
+                {
+                    msg_Dbg( p_stream, " * run asynchronously (%d blocks)",
+                             i_size );
+                    *pp_async = AsyncNew( p_sys->pp_streams[p_sys->i_nb_streams - 1],
+                                          i_size );
+                }
+            }
+            else if( *pp_async == NULL )
+                msg_Err( p_stream, " * ignore overflow `%s' of a synchronous "
+                         "output", psz );
+            else
+                (*pp_async)->b_block = !strcmp( psz, "block" );
+        }
         else if( !strncmp( p_cfg->psz_name, "select", strlen( "select" ) ) )
         {
             char *psz = p_cfg->psz_value;
@@ -178,6 +375,21 @@ static int Open( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
+    for( int i = 0; i < p_sys->i_nb_async; i++ )
+    {
+        duplicate_async_t *p_async = p_sys->pp_async[i];
+
+        if( p_async != NULL
+         && vlc_clone( &p_async->thread, AsyncThread, p_async,
+                       VLC_THREAD_PRIORITY_OUTPUT ) )
+        {
+            msg_Warn( p_stream, "output %d runs synchronously", i );
+            free( p_async->queue );
+            free( p_async );
+            p_sys->pp_async[i] = NULL;
+        }
+    }
+
     p_stream->p_sys = p_sys;
     p_stream->ops = &ops;
     return VLC_SUCCESS;
@@ -194,11 +406,21 @@ static void Close( vlc_object_t * p_this )
     msg_Dbg( p_stream, "closing a duplication" );
     for( int i = 0; i < p_sys->i_nb_streams; i++ )
     {
+        duplicate_async_t *p_async = p_sys->pp_async[i];
+
+        if( p_async != NULL )
+        {
+            if( p_async->i_dropped > 0 )
+                msg_Warn( p_stream, "output %d dropped %u blocks", i,
+                          p_async->i_dropped );
+            AsyncDelete( p_async );
+        }
         sout_StreamChainDelete(p_sys->pp_streams[i], p_stream->p_next);
         free( p_sys->ppsz_select[i] );
     }
     free( p_sys->pp_streams );
     free( p_sys->ppsz_select );
+    free( p_sys->pp_async );
 
     free( p_sys );
 }
@@ -217,6 +439,12 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         return NULL;
 
     TAB_INIT( id->i_nb_ids, id->pp_ids );
+    id->pb_dropped = calloc( p_sys->i_nb_streams, sizeof( *id->pb_dropped ) );
+    if( unlikely(id->pb_dropped == NULL) )
+    {
+        free( id );
+        return NULL;
+    }
 
     msg_Dbg( p_stream, "duplicated a new stream codec=%4.4s (es=%d group=%d)",
              (char*)&p_fmt->i_codec, p_fmt->i_id, p_fmt->i_group );
@@ -229,8 +457,13 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
                         p_sys->ppsz_select[i_stream] ) )
         {
             sout_stream_t *out = p_sys->pp_streams[i_stream];
+            duplicate_async_t *p_async = p_sys->pp_async[i_stream];
 
+            if( p_async )
+                vlc_mutex_lock( &p_async->lock );
             id_new = (void*)sout_StreamIdAdd( out, p_fmt );
+            if( p_async )
+                vlc_mutex_unlock( &p_async->lock );
             if( id_new )
             {
                 msg_Dbg( p_stream, "    - added for output %d", i_stream );
@@ -274,22 +507,50 @@ static void Del( sout_stream_t *p_stream, void *_id )
         if( id->pp_ids[i_stream] )
         {
             sout_stream_t *out = p_sys->pp_streams[i_stream];
+            duplicate_async_t *p_async = p_sys->pp_async[i_stream];
+
+            if( p_async )
+            {
+                vlc_mutex_lock( &p_async->lock );
+                AsyncFlush( p_async, id->pp_ids[i_stream] );
+            }
             sout_StreamIdDel( out, id->pp_ids[i_stream] );
+            if( p_async )
+                vlc_mutex_unlock( &p_async->lock );
         }
     }
 
     free( id->pp_ids );
+    free( id->pb_dropped );
     free( id );
 }
 
 /*****************************************************************************
  * Send:
  *****************************************************************************/
+static void SendBranch( sout_stream_sys_t *p_sys, sout_stream_id_sys_t *id,
+                        int i_stream, block_t *p_buffer )
+{
+    duplicate_async_t *p_async = p_sys->pp_async[i_stream];
+
+    if( p_async == NULL )
+    {
+        sout_StreamIdSend( p_sys->pp_streams[i_stream], id->pp_ids[i_stream],
+                           p_buffer );
+        return;
+    }
+
+    /* Tell the branch about the gap after dropped blocks */
+    if( id->pb_dropped[i_stream] )
+        p_buffer->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+    id->pb_dropped[i_stream] = !AsyncSend( p_async, id->pp_ids[i_stream],
+                                           p_buffer );
+}
+
 static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 {
     sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
-    sout_stream_t     *p_dup_stream;
     int               i_stream;
 
     /* Loop through the linked list of buffers */
@@ -301,22 +562,17 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 
         for( i_stream = 0; i_stream < p_sys->i_nb_streams - 1; i_stream++ )
         {
-            p_dup_stream = p_sys->pp_streams[i_stream];
-
             if( id->pp_ids[i_stream] )
             {
                 block_t *p_dup = block_Duplicate( p_buffer );
 
                 if( p_dup )
-                    sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
+                    SendBranch( p_sys, id, i_stream, p_dup );
             }
         }
 
         if( i_stream < p_sys->i_nb_streams && id->pp_ids[i_stream] )
-        {
-            p_dup_stream = p_sys->pp_streams[i_stream];
-            sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_buffer );
-        }
+            SendBranch( p_sys, id, i_stream, p_buffer );
         else
         {
             block_Release( p_buffer );
@@ -522,6 +522,8 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
     sout_stream_sys_t *p_sys = p_stream->p_sys;
     picture_t *p_new_pic;
     const video_format_t *p_fmt_in = &p_sys->p_decoder->fmt_out.video;
+    const vlc_chroma_description_t *p_desc =
+        vlc_fourcc_GetChromaDescription( p_pic->format.i_chroma );
 
     if( p_sys->i_height || p_sys->i_width )
     {
@@ -565,6 +567,13 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
             return;
         }
     }
+    else if( p_desc != NULL && p_desc->plane_count == 0 )
+    {
+        /* Opaque (hardware) picture: it cannot be copied, hand it over as is
+         * with its video context, so that a GPU mosaic can import it. */
+        p_new_pic = p_pic;
+        p_pic = NULL;
+    }
     else
     {
         /* TODO: chroma conversion if needed */
@@ -582,7 +591,8 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
 
         picture_Copy( p_new_pic, p_pic );
     }
-    picture_Release( p_pic );
+    if( p_pic != NULL )
+        picture_Release( p_pic );
 
     if( p_sys->p_vf2 )
         p_new_pic = filter_chain_VideoFilter( p_sys->p_vf2, p_new_pic );
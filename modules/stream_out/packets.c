@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * packets.c: stream output handing packets to the LibVLC application
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_media_player.h>
+#include <vlc/libvlc_packet.h>
+
+/* NOTE: the callback prototypes must match those of LibVLC */
+typedef void *(*vlc_packets_add_cb)(libvlc_packet_es_added_cb, void *,
+                                    const es_format_t *);
+typedef void (*vlc_packets_del_cb)(libvlc_packet_es_removed_cb, void *,
+                                   void *);
+typedef void (*vlc_packets_send_cb)(libvlc_packet_cb, void *, void *,
+                                    block_t *);
+
+typedef struct
+{
+    vlc_packets_add_cb add;
+    vlc_packets_del_cb del;
+    vlc_packets_send_cb send;
+    libvlc_packet_es_added_cb es_added;
+    libvlc_packet_es_removed_cb es_removed;
+    libvlc_packet_cb packet;
+    void *opaque;
+} sout_stream_sys_t;
+
+static void *Add(sout_stream_t *stream, const es_format_t *fmt)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    return sys->add(sys->es_added, sys->opaque, fmt);
+}
+
+static void Del(sout_stream_t *stream, void *id)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    sys->del(sys->es_removed, sys->opaque, id);
+}
+
+static int Send(sout_stream_t *stream, void *id, block_t *block)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    sys->send(sys->packet, sys->opaque, id, block);
+    return VLC_SUCCESS;
+}
+
+static const struct sout_stream_operations ops = {
+    Add, Del, Send, NULL, NULL,
+};
+
+static int Open(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    sout_stream_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->add = var_InheritAddress(stream, "packets-add");
+    sys->del = var_InheritAddress(stream, "packets-del");
+    sys->send = var_InheritAddress(stream, "packets-send");
+    sys->es_added = var_InheritAddress(stream, "packets-es-added");
+    sys->es_removed = var_InheritAddress(stream, "packets-es-removed");
+    sys->packet = var_InheritAddress(stream, "packets-packet");
+    sys->opaque = var_InheritAddress(stream, "packets-data");
+
+    if (sys->add == NULL || sys->del == NULL || sys->send == NULL
+     || sys->es_added == NULL || sys->packet == NULL)
+    {
+        msg_Err(stream, "packet callbacks not set");
+        return VLC_EGENERIC;
+    }
+
+    stream->p_sys = sys;
+    stream->ops = &ops;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_shortname(N_("Packets"))
+    set_description(N_("Elementary stream packets to LibVLC"))
+    set_capability("sout output", 0)
+    add_shortcut("packets")
+    set_category(CAT_SOUT)
+    set_subcategory(SUBCAT_SOUT_STREAM)
+    set_callback(Open)
+vlc_module_end()
@@ -50,6 +50,12 @@ static void     Close   ( vlc_object_t * );
 #define DST_PREFIX_LONGTEXT N_( \
     "Prefix of the destination file automatically generated" )
 
+#define PREROLL_TEXT N_("Pre-roll duration (s)")
+#define PREROLL_LONGTEXT N_( \
+    "When not zero, the stream is kept in memory but not recorded until " \
+    "the recording is triggered. The recording then starts with up to " \
+    "this duration of past data, from a key frame." )
+
 #define SOUT_CFG_PREFIX "sout-record-"
 
 vlc_module_begin ()
@@ -63,6 +69,9 @@ vlc_module_begin ()
 
     add_string( SOUT_CFG_PREFIX "dst-prefix", "", DST_PREFIX_TEXT,
                 DST_PREFIX_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "preroll", 0, PREROLL_TEXT,
+                 PREROLL_LONGTEXT )
+        change_integer_range( 0, 3600 )
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -70,6 +79,7 @@ vlc_module_end ()
 /* */
 static const char *const ppsz_sout_options[] = {
     "dst-prefix",
+    "preroll",
     NULL
 };
 
@@ -77,6 +87,7 @@ static const char *const ppsz_sout_options[] = {
 static void *Add( sout_stream_t *, const es_format_t * );
 static void  Del( sout_stream_t *, void * );
 static int   Send( sout_stream_t *, void *, block_t * );
+static int   Control( sout_stream_t *, int, va_list );
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
 struct sout_stream_id_sys_t
@@ -106,6 +117,11 @@ typedef struct
 
     bool        b_drop;
 
+    /* Pre-roll: buffer up to i_preroll until triggered */
+    vlc_tick_t  i_preroll;
+    bool        b_armed;
+    vlc_tick_t  i_last_dts;
+
     int              i_id;
     sout_stream_id_sys_t **id;
     vlc_tick_t  i_dts_start;
@@ -113,9 +129,12 @@ typedef struct
 
 static void OutputStart( sout_stream_t *p_stream );
 static void OutputSend( sout_stream_t *p_stream, sout_stream_id_sys_t *id, block_t * );
+static void PrerollTrim( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                         vlc_tick_t i_dts );
+static vlc_tick_t BlockTick( const block_t *p_block );
 
 static const struct sout_stream_operations ops = {
-    Add, Del, Send, NULL, NULL,
+    Add, Del, Send, Control, NULL,
 };
 
 /*****************************************************************************
@@ -154,6 +173,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_max_size = 20*1024*1024; /* 20 MiB */
 #endif
     p_sys->b_drop = false;
+    p_sys->i_preroll = VLC_TICK_FROM_SEC(
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "preroll" ) );
+    p_sys->b_armed = p_sys->i_preroll > 0;
+    p_sys->i_last_dts = VLC_TICK_INVALID;
     p_sys->i_dts_start = 0;
     TAB_INIT( p_sys->i_id, p_sys->id );
     p_stream->ops = &ops;
@@ -206,7 +229,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
     sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
 
-    if( !p_sys->p_out )
+    if( !p_sys->p_out && !p_sys->b_armed )
         OutputStart( p_stream );
 
     if( id->p_first )
@@ -233,6 +256,15 @@ static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
 {
     sout_stream_sys_t *p_sys = p_stream->p_sys;
 
+    if( p_sys->b_armed )
+    {
+        vlc_tick_t i_dts = BlockTick( p_buffer );
+
+        OutputSend( p_stream, id, p_buffer );
+        PrerollTrim( p_stream, id, i_dts );
+        return VLC_SUCCESS;
+    }
+
     if( p_sys->i_date_start == VLC_TICK_INVALID )
         p_sys->i_date_start = vlc_tick_now();
     if( !p_sys->p_out &&
@@ -249,6 +281,26 @@ static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
     return VLC_SUCCESS;
 }
 
+static int Control( sout_stream_t *p_stream, int i_query, va_list args )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    (void) args;
+    switch( i_query )
+    {
+        case SOUT_STREAM_RECORD_START:
+            if( !p_sys->b_armed || p_sys->i_id <= 0 )
+                return VLC_EGENERIC;
+
+            msg_Dbg( p_stream, "Starting recording, with %dbyte of pre-roll",
+                     (int)p_sys->i_size );
+            p_sys->b_armed = false;
+            OutputStart( p_stream );
+            return p_sys->p_out ? VLC_SUCCESS : VLC_EGENERIC;
+    }
+    return VLC_EGENERIC;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
@@ -654,3 +706,70 @@ static void OutputSend( sout_stream_t *p_stream, sout_stream_id_sys_t *id, block
     }
 }
 
+/*****************************************************************************
+ * Pre-roll
+ *****************************************************************************/
+static bool IsSyncPoint( const block_t *p_block )
+{
+    return ( p_block->i_flags & BLOCK_FLAG_TYPE_I ) ||
+           ( p_block->i_flags & BLOCK_FLAG_TYPE_MASK ) == 0;
+}
+
+static void PrerollDrop( sout_stream_sys_t *p_sys, sout_stream_id_sys_t *id,
+                         block_t *p_until )
+{
+    while( id->p_first != p_until )
+    {
+        block_t *p_block = id->p_first;
+
+        id->p_first = p_block->p_next;
+        assert( p_sys->i_size >= p_block->i_buffer );
+        p_sys->i_size -= p_block->i_buffer;
+        block_Release( p_block );
+    }
+    if( id->p_first == NULL )
+        id->pp_last = &id->p_first;
+}
+
+static void PrerollTrim( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                         vlc_tick_t i_dts )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( i_dts != VLC_TICK_INVALID &&
+        ( p_sys->i_last_dts == VLC_TICK_INVALID || i_dts > p_sys->i_last_dts ) )
+        p_sys->i_last_dts = i_dts;
+
+    /* Keep from the last sync point older than the pre-roll duration, so
+     * that the recording can start on it. The scan stops at the first recent
+     * block, so this is cheap once the queue is trimmed. */
+    if( p_sys->i_last_dts != VLC_TICK_INVALID )
+    {
+        const vlc_tick_t i_limit = p_sys->i_last_dts - p_sys->i_preroll;
+        block_t *p_cut = NULL;
+
+        for( block_t *p_block = id->p_first; p_block != NULL;
+             p_block = p_block->p_next )
+        {
+            vlc_tick_t i_tick = BlockTick( p_block );
+            if( i_tick != VLC_TICK_INVALID && i_tick > i_limit )
+                break;
+            if( IsSyncPoint( p_block ) )
+                p_cut = p_block;
+        }
+        if( p_cut != NULL )
+            PrerollDrop( p_sys, id, p_cut );
+    }
+
+    /* Bound the memory, at the expense of the pre-roll duration */
+    while( p_sys->i_size > p_sys->i_max_size && id->p_first != NULL )
+    {
+        block_t *p_next = id->p_first->p_next;
+
+        while( p_next != NULL && !IsSyncPoint( p_next ) )
+            p_next = p_next->p_next;
+        if( p_next == NULL )
+            break;
+        PrerollDrop( p_sys, id, p_next );
+    }
+}
@@ -152,6 +152,11 @@ static const char *const ppsz_protocols[] = {
     "DCCP", "SCTP", "TCP", "UDP", "UDP-Lite",
 };
 
+#define SEND_THREADS_TEXT N_("Sender threads")
+#define SEND_THREADS_LONGTEXT N_( \
+    "Number of threads sending the packets of each elementary stream. " \
+    "The RTSP clients and other destinations are shared out among them, " \
+    "which helps when there are hundreds of unicast clients." )
 #define RFC3016_TEXT N_("MP4A LATM")
 #define RFC3016_LONGTEXT N_( \
     "This allows you to stream MPEG4 LATM audio streams (see RFC3016)." )
@@ -216,6 +221,8 @@ vlc_module_begin ()
               RTCP_MUX_TEXT, RTCP_MUX_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "caching", MS_FROM_VLC_TICK(DEFAULT_PTS_DELAY),
                  CACHING_TEXT, CACHING_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "send-threads", 1, 1, 64,
+                            SEND_THREADS_TEXT, SEND_THREADS_LONGTEXT )
     add_integer( "rtsp-timeout", 60, RTSP_TIMEOUT_TEXT,
                  RTSP_TIMEOUT_LONGTEXT )
     add_string( "sout-rtsp-user", "",
@@ -241,6 +248,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "dst", "name", "cat", "port", "port-audio", "port-video", "*sdp", "ttl",
     "mux", "sap", "description", "proto", "rtcp-mux", "caching",
+    "send-threads",
 #ifdef HAVE_SRTP
     "key", "salt",
 #endif
@@ -257,6 +265,8 @@ static int   MuxSend( sout_stream_t *, void *, block_t * );
 
 static sout_access_out_t *GrabberCreate( sout_stream_t *p_sout );
 static void* ThreadSend( void * );
+static void  RtpSendersStart( sout_stream_id_sys_t *, unsigned );
+static void  RtpSendersStop( sout_stream_id_sys_t * );
 static void *rtp_listen_thread( void * );
 
 static void SDPHandleUrl( sout_stream_t *, const char * );
@@ -315,8 +325,19 @@ typedef struct rtp_sink_t
 {
     int rtp_fd;
     rtcp_sender_t *rtcp;
+    bool dead; /* broken connection, to be removed */
 } rtp_sink_t;
 
+/* Packets sent in a single system call to each sink */
+#define RTP_BATCH_MAX 32
+
+struct rtp_sender
+{
+    sout_stream_id_sys_t *id;
+    vlc_thread_t thread;
+    unsigned shard;
+};
+
 struct sout_stream_id_sys_t
 {
     sout_stream_t *p_stream;
@@ -354,6 +375,22 @@ struct sout_stream_id_sys_t
         vlc_thread_t  thread;
     } listen;
 
+    /* Extra sender threads, each sending to a shard of the sinks
+     * (protected by lock_sink while a batch is sent) */
+    struct {
+        struct rtp_sender *threads;
+        unsigned      count; /* including ThreadSend */
+        vlc_mutex_t   lock;
+        vlc_cond_t    wait;
+        vlc_cond_t    done;
+        uint64_t      generation;
+        unsigned      pending;
+        bool          rtcp;
+        block_t     **pkts;
+        unsigned      pktc;
+        bool          quit;
+    } pool;
+
     vlc_tick_t        i_caching;
 };
 
@@ -942,6 +979,13 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     vlc_queue_Init(&id->queue, offsetof (block_t, p_next));
     id->dead = true;
     id->listen.fd = NULL;
+    id->pool.threads = NULL;
+    id->pool.count = 1;
+    vlc_mutex_init( &id->pool.lock );
+    vlc_cond_init( &id->pool.wait );
+    vlc_cond_init( &id->pool.done );
+    id->pool.generation = 0;
+    id->pool.quit = false;
 
     id->b_first_packet = true;
     id->i_caching =
@@ -1125,6 +1169,9 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         id->rtsp_id = RtspAddId( p_sys->rtsp, id, GetDWBE( id->ssrc ),
                                  id->rtp_fmt.clock_rate, mcast_fd );
 
+    RtpSendersStart( id,
+                     var_GetInteger( p_stream, SOUT_CFG_PREFIX "send-threads" ) );
+
     id->dead = false;
     if( vlc_clone( &id->thread, ThreadSend, id, VLC_THREAD_PRIORITY_HIGHEST ) )
     {
@@ -1171,6 +1218,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
         vlc_queue_Kill(&id->queue, &id->dead);
         vlc_join( id->thread, NULL );
      }
+    RtpSendersStop( id );
     free( id->rtp_fmt.fmtp );
 
     if( id->rtsp_id )
@@ -1326,19 +1374,238 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+
+/* Handles a failed send of a packet to a sink.
+ * Returns false if the connection is broken. */
+static bool rtp_SinkError( const rtp_sink_t *sink, const block_t *out )
+{
+    if( net_errno == EAGAIN || net_errno == EWOULDBLOCK
+     || net_errno == ENOBUFS || net_errno == ENOMEM )
+        return true; /* dropped */
+
+    int type;
+    getsockopt( sink->rtp_fd, SOL_SOCKET, SO_TYPE,
+                &type, &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        return false; /* Broken connection */
+
+    /* ICMP soft error: ignore and retry */
+    send( sink->rtp_fd, out->p_buffer, out->i_buffer, 0 );
+    return true;
+}
+
+/* Sends a batch of packets to one sink, with as few system calls as
+ * possible. Returns false if the connection is broken. */
+static bool rtp_SinkSend( rtp_sink_t *sink, block_t *const *pkts,
+                          unsigned count, bool rtcp )
+{
+    if( rtcp )
+        for( unsigned i = 0; i < count; i++ )
+            SendRTCP( sink->rtcp, pkts[i] );
+
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[RTP_BATCH_MAX];
+    struct iovec iov[RTP_BATCH_MAX];
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+        iov[i].iov_base = pkts[i]->p_buffer;
+        iov[i].iov_len = pkts[i]->i_buffer;
+        memset( &msgs[i], 0, sizeof (msgs[i]) );
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for( unsigned sent = 0; sent < count; )
+    {
+        int val = sendmmsg( sink->rtp_fd, msgs + sent, count - sent, 0 );
+        if( val == -1 )
+        {
+            if( !rtp_SinkError( sink, pkts[sent] ) )
+                return false;
+            val = 1; /* skip the failed packet */
+        }
+        sent += val;
+    }
+#else
+    for( unsigned i = 0; i < count; i++ )
+        if( send( sink->rtp_fd, pkts[i]->p_buffer, pkts[i]->i_buffer, 0 ) == -1
+         && !rtp_SinkError( sink, pkts[i] ) )
+            return false;
+#endif
+    return true;
+}
+
+/* Sends a batch to every count-th sink, starting from the shard-th one.
+ * lock_sink must be held (by ThreadSend). */
+static void rtp_SendShard( sout_stream_id_sys_t *id, unsigned shard,
+                           unsigned count, block_t *const *pkts,
+                           unsigned pktc, bool rtcp )
+{
+    for( int i = shard; i < id->sinkc; i += count )
+    {
+        rtp_sink_t *sink = &id->sinkv[i];
+
+        if( !sink->dead && !rtp_SinkSend( sink, pkts, pktc, rtcp ) )
+            sink->dead = true;
+    }
+}
+
+static void *ThreadSendShard( void *data )
+{
+    struct rtp_sender *sender = data;
+    sout_stream_id_sys_t *id = sender->id;
+    uint64_t generation = 0;
+
+    vlc_mutex_lock( &id->pool.lock );
+    for( ;; )
+    {
+        while( !id->pool.quit && id->pool.generation == generation )
+            vlc_cond_wait( &id->pool.wait, &id->pool.lock );
+        if( id->pool.quit )
+            break;
+
+        generation = id->pool.generation;
+        vlc_mutex_unlock( &id->pool.lock );
+
+        rtp_SendShard( id, sender->shard, id->pool.count, id->pool.pkts,
+                       id->pool.pktc, id->pool.rtcp );
+
+        vlc_mutex_lock( &id->pool.lock );
+        if( --id->pool.pending == 0 )
+            vlc_cond_signal( &id->pool.done );
+    }
+    vlc_mutex_unlock( &id->pool.lock );
+    return NULL;
+}
+
+static void RtpSendersStart( sout_stream_id_sys_t *id, unsigned count )
+{
+    if( count <= 1 )
+        return;
+
+    id->pool.threads = vlc_alloc( count - 1, sizeof (*id->pool.threads) );
+    if( unlikely(id->pool.threads == NULL) )
+        return;
+
+    for( unsigned i = 1; i < count; i++ )
+    {
+        struct rtp_sender *sender = &id->pool.threads[i - 1];
+
+        sender->id = id;
+        sender->shard = i;
+        if( vlc_clone( &sender->thread, ThreadSendShard, sender,
+                       VLC_THREAD_PRIORITY_HIGHEST ) )
+        {
+            msg_Warn( id->p_stream, "only %u sender threads", i );
+            break;
+        }
+        id->pool.count = i + 1;
+    }
+}
+
+static void RtpSendersStop( sout_stream_id_sys_t *id )
+{
+    vlc_mutex_lock( &id->pool.lock );
+    id->pool.quit = true;
+    vlc_cond_broadcast( &id->pool.wait );
+    vlc_mutex_unlock( &id->pool.lock );
+
+    for( unsigned i = 1; i < id->pool.count; i++ )
+        vlc_join( id->pool.threads[i - 1].thread, NULL );
+    free( id->pool.threads );
+}
+
+/* Sends a batch of packets to all sinks, then releases them. */
+static void rtp_SendBatch( sout_stream_id_sys_t *id, block_t **pkts,
+                           unsigned pktc )
+{
+    bool rtcp = true;
+#ifdef HAVE_SRTP
+    if( id->srtp ) /* FIXME: SRTCP support */
+        rtcp = false;
+#endif
+
+    vlc_mutex_lock( &id->lock_sink );
+    if( id->pool.count > 1 && id->sinkc > 1 )
+    {
+        vlc_mutex_lock( &id->pool.lock );
+        id->pool.pkts = pkts;
+        id->pool.pktc = pktc;
+        id->pool.rtcp = rtcp;
+        id->pool.pending = id->pool.count - 1;
+        id->pool.generation++;
+        vlc_cond_broadcast( &id->pool.wait );
+        vlc_mutex_unlock( &id->pool.lock );
+
+        rtp_SendShard( id, 0, id->pool.count, pkts, pktc, rtcp );
+
+        vlc_mutex_lock( &id->pool.lock );
+        while( id->pool.pending > 0 )
+            vlc_cond_wait( &id->pool.done, &id->pool.lock );
+        vlc_mutex_unlock( &id->pool.lock );
+    }
+    else
+        rtp_SendShard( id, 0, 1, pkts, pktc, rtcp );
+
+    unsigned deadc = 0; /* How many dead sockets? */
+    int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+
+    for( int i = 0; i < id->sinkc; i++ )
+        if( id->sinkv[i].dead )
+            deadv[deadc++] = id->sinkv[i].rtp_fd;
+
+    const block_t *last = pkts[pktc - 1];
+    id->i_seq_sent_next = ntohs(((uint16_t *) last->p_buffer)[1]) + 1;
+    vlc_mutex_unlock( &id->lock_sink );
+
+    for( unsigned i = 0; i < pktc; i++ )
+        block_Release( pkts[i] );
+
+    for( unsigned i = 0; i < deadc; i++ )
+    {
+        msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
+        rtp_del_sink( id, deadv[i] );
+    }
+}
+
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
+    block_t *batch[RTP_BATCH_MAX];
+    unsigned count = 0;
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+    for( ;; )
     {
+        block_t *out;
+
+        if( count > 0 )
+        {
+            /* Only packets that are already queued can join the batch */
+            vlc_queue_Lock( &id->queue );
+            out = vlc_queue_DequeueUnlocked( &id->queue );
+            vlc_queue_Unlock( &id->queue );
+
+            if( out == NULL )
+            {
+                rtp_SendBatch( id, batch, count );
+                count = 0;
+                continue;
+            }
+        }
+        else
+        {
+            out = vlc_queue_DequeueKillable( &id->queue, &id->dead );
+            if( out == NULL )
+                break;
+        }
+
 #ifdef HAVE_SRTP
         if( id->srtp )
         {   /* FIXME: this is awfully inefficient */
@@ -1357,44 +1624,24 @@ static void* ThreadSend( void *data )
             out->i_buffer = len;
         }
 #endif
-        vlc_tick_wait (out->i_dts + i_caching);
-
-        ssize_t len = out->i_buffer;
-
-        vlc_mutex_lock( &id->lock_sink );
-        unsigned deadc = 0; /* How many dead sockets? */
-        int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+        vlc_tick_t date = out->i_dts + i_caching;
 
-        for( int i = 0; i < id->sinkc; i++ )
+        if( date > vlc_tick_now() )
         {
-#ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
-#endif
-                SendRTCP( id->sinkv[i].rtcp, out );
-
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
+            /* The pending batch is due now, this packet only later */
+            if( count > 0 )
             {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
+                rtp_SendBatch( id, batch, count );
+                count = 0;
             }
+            vlc_tick_wait( date );
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
-        vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        batch[count++] = out;
 
-        for( unsigned i = 0; i < deadc; i++ )
+        if( count == RTP_BATCH_MAX )
         {
-            msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
-            rtp_del_sink( id, deadv[i] );
+            rtp_SendBatch( id, batch, count );
+            count = 0;
         }
     }
     return NULL;
@@ -1424,7 +1671,7 @@ static void *rtp_listen_thread( void *data )
 
 int rtp_add_sink( sout_stream_id_sys_t *id, int fd, bool rtcp_mux, uint16_t *seq )
 {
-    rtp_sink_t sink = { fd, NULL };
+    rtp_sink_t sink = { fd, NULL, false };
     sink.rtcp = OpenRTCP( VLC_OBJECT( id->p_stream ), fd, IPPROTO_UDP,
                           rtcp_mux );
     if( sink.rtcp == NULL )
@@ -1440,7 +1687,7 @@ int rtp_add_sink( sout_stream_id_sys_t *id, int fd, bool rtcp_mux, uint16_t *seq
 
 void rtp_del_sink( sout_stream_id_sys_t *id, int fd )
 {
-    rtp_sink_t sink = { fd, NULL };
+    rtp_sink_t sink = { fd, NULL, false };
 
     /* NOTE: must be safe to use if fd is not included */
     vlc_mutex_lock( &id->lock_sink );
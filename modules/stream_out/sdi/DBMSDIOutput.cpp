@@ -70,6 +70,7 @@ DBMSDIOutput::DBMSDIOutput(sout_stream_t *p_stream) :
     vlc_mutex_init(&feeder.lock);
     vlc_cond_init(&feeder.cond);
     feeder.canceled = false;
+    vlc_mutex_init(&framepool.lock);
 }
 
 DBMSDIOutput::~DBMSDIOutput()
@@ -96,6 +97,8 @@ DBMSDIOutput::~DBMSDIOutput()
         p_output->DisableAudioOutput();
         p_output->Release();
     }
+    for(IDeckLinkMutableVideoFrame *frame : framepool.frames)
+        frame->Release();
     if(p_card)
         p_card->Release();
 }
@@ -145,13 +148,21 @@ ULONG STDMETHODCALLTYPE DBMSDIOutput::Release()
 }
 
 HRESULT STDMETHODCALLTYPE DBMSDIOutput::ScheduledFrameCompleted
-    (IDeckLinkVideoFrame *, BMDOutputFrameCompletionResult result)
+    (IDeckLinkVideoFrame *frame, BMDOutputFrameCompletionResult result)
 {
     if(result == bmdOutputFrameDropped)
         msg_Warn(p_stream, "dropped frame");
     else if(result == bmdOutputFrameDisplayedLate)
         msg_Warn(p_stream, "late frame");
 
+    /* All scheduled frames come from getVideoFrame(): take ours back */
+    if(frame)
+    {
+        vlc_mutex_lock(&framepool.lock);
+        framepool.frames.push_back(static_cast<IDeckLinkMutableVideoFrame *>(frame));
+        vlc_mutex_unlock(&framepool.lock);
+    }
+
     bool b_active;
     vlc_mutex_lock(&feeder.lock);
     if((S_OK == p_output->IsScheduledPlaybackRunning(&b_active)) && b_active)
@@ -721,6 +732,32 @@ int DBMSDIOutput::ProcessVideo(picture_t *picture, block_t *p_cc)
     return doProcessVideo(picture, p_cc);
 }
 
+IDeckLinkMutableVideoFrame * DBMSDIOutput::getVideoFrame(int w, int h)
+{
+    IDeckLinkMutableVideoFrame *frame = NULL;
+
+    vlc_mutex_lock(&framepool.lock);
+    if(!framepool.frames.empty())
+    {
+        frame = framepool.frames.back();
+        framepool.frames.pop_back();
+    }
+    vlc_mutex_unlock(&framepool.lock);
+
+    if(frame == NULL)
+    {
+        HRESULT result = p_output->CreateVideoFrame(w, h, w*3,
+                                    video.tenbits ? bmdFormat10BitYUV : bmdFormat8BitYUV,
+                                    bmdFrameFlagDefault, &frame);
+        if(result != S_OK)
+        {
+            msg_Err(p_stream, "Failed to create video frame: 0x%X", result);
+            return NULL;
+        }
+    }
+    return frame;
+}
+
 int DBMSDIOutput::doProcessVideo(picture_t *picture, block_t *p_cc)
 {
     HRESULT result;
@@ -733,13 +770,9 @@ int DBMSDIOutput::doProcessVideo(picture_t *picture, block_t *p_cc)
     if(FAKE_DRIVER)
         goto end;
 
-    result = p_output->CreateVideoFrame(w, h, w*3,
-                                        video.tenbits ? bmdFormat10BitYUV : bmdFormat8BitYUV,
-                                        bmdFrameFlagDefault, &pDLVideoFrame);
-    if(result != S_OK) {
-        msg_Err(p_stream, "Failed to create video frame: 0x%X", result);
+    pDLVideoFrame = getVideoFrame(w, h);
+    if(!pDLVideoFrame)
         goto error;
-    }
 
     void *frame_bytes;
     pDLVideoFrame->GetBytes((void**)&frame_bytes);
@@ -804,6 +837,8 @@ int DBMSDIOutput::doProcessVideo(picture_t *picture, block_t *p_cc)
         goto error;
     }
     lasttimestamp = __MAX(scheduleTime, lasttimestamp);
+    /* handed back through ScheduledFrameCompleted() */
+    pDLVideoFrame = NULL;
 
     if(!b_running) /* preroll */
     {
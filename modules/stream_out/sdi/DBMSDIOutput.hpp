@@ -26,6 +26,8 @@
 #include <vlc_es.h>
 #include "../../access/vlc_decklink.h"
 
+#include <vector>
+
 namespace sdi_sout
 {
     class DBMSDIOutput : public SDIOutput,
@@ -74,6 +76,13 @@ namespace sdi_sout
                 vlc_thread_t thread;
                 bool canceled;
             } feeder;
+            struct
+            {
+                vlc_mutex_t lock;
+                /* completed frames, ready to be filled again */
+                std::vector<IDeckLinkMutableVideoFrame *> frames;
+            } framepool;
+            IDeckLinkMutableVideoFrame * getVideoFrame(int, int);
             static void *feederThreadCallback(void *);
             void feederThread();
             int doSchedule();
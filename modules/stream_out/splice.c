@@ -0,0 +1,619 @@
+/*****************************************************************************
+ * splice.c: SCTE-35 splice-aware content insertion
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The main feed is forwarded as is until an SCTE-35 splice_insert cue takes
+ * it out of the network. At the first video key frame past the splice time,
+ * the inserted content is demuxed and sent in its place, with its timestamps
+ * rebased onto the main feed clock, until the break ends. The main feed then
+ * resumes at its next key frame. Nothing is decoded: the inserted content
+ * must use the same codecs as the main feed, and the muxer downstream
+ * regenerates the PCR and continuity counters from the rebased timestamps.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define VLC_MODULE_LICENSE VLC_LICENSE_GPL_2_PLUS
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_block.h>
+#include <vlc_codec.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_sout.h>
+#include <vlc_list.h>
+
+#include "../codec/scte35.h"
+
+#define SOUT_CFG_PREFIX "sout-splice-"
+
+/* Bound on demux calls per main feed block, for inserted content that
+ * does not advance */
+#define SPLICE_PUMP_MAX 256
+
+enum splice_state
+{
+    SPLICE_MAIN,   /*< forwarding the main feed */
+    SPLICE_BREAK,  /*< forwarding the inserted content */
+    SPLICE_RETURN, /*< waiting for a main feed key frame */
+};
+
+typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
+struct sout_stream_id_sys_t
+{
+    struct vlc_list node;
+    es_format_t fmt;
+    void *id; /*< NULL for the splice information */
+    bool cue;
+    bool discontinuity;
+    bool mapped; /*< replaced by an inserted ES */
+};
+
+struct splice_es
+{
+    struct vlc_list node;
+    es_format_t fmt;
+    sout_stream_id_sys_t *main;
+    decoder_t *packetizer;
+    bool started;
+};
+
+typedef struct
+{
+    struct vlc_list ids;
+    char *mrl;
+    vlc_tick_t default_duration;
+    enum splice_state state;
+    bool has_video;
+
+    /* Pending splice out */
+    bool cue;
+    uint32_t cue_event;
+    vlc_tick_t cue_time;
+    vlc_tick_t cue_duration;
+
+    vlc_tick_t cut;       /*< main feed DTS of the last switch */
+    vlc_tick_t cue_in;    /*< signalled return, or VLC_TICK_INVALID */
+    vlc_tick_t break_end; /*< end of the break, or VLC_TICK_INVALID */
+
+    /* Inserted content */
+    sout_stream_t *stream;
+    es_out_t out;
+    demux_t *demux;
+    struct vlc_list es;
+    vlc_tick_t origin; /*< first DTS of the inserted content */
+    vlc_tick_t last;   /*< last rebased DTS */
+    bool done;
+} sout_stream_sys_t;
+
+static void SendNext(sout_stream_t *stream, sout_stream_id_sys_t *id,
+                     block_t *block)
+{
+    if (id->discontinuity)
+    {
+        block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        id->discontinuity = false;
+    }
+    sout_StreamIdSend(stream->p_next, id->id, block);
+}
+
+/*****************************************************************************
+ * Inserted content
+ *****************************************************************************/
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    sout_stream_sys_t *sys = container_of(out, sout_stream_sys_t, out);
+    sout_stream_id_sys_t *id;
+    VLC_UNUSED(in);
+
+    struct splice_es *es = malloc(sizeof (*es));
+    if (unlikely(es == NULL))
+        return NULL;
+    if (es_format_Copy(&es->fmt, fmt))
+    {
+        es_format_Clean(&es->fmt);
+        free(es);
+        return NULL;
+    }
+    es->main = NULL;
+    es->packetizer = NULL;
+    es->started = false;
+
+    vlc_list_foreach (id, &sys->ids, node)
+        if (!id->cue && !id->mapped && id->fmt.i_cat == fmt->i_cat
+         && id->fmt.i_codec == fmt->i_codec)
+        {
+            id->mapped = true;
+            es->main = id;
+            break;
+        }
+
+    if (es->main == NULL)
+        msg_Warn(sys->stream, "no main ES for inserted %4.4s ES, dropping it",
+                 (const char *)&fmt->i_codec);
+
+    vlc_list_append(&es->node, &sys->es);
+    return (es_out_id_t *)es;
+}
+
+static void EsDelete(struct splice_es *es)
+{
+    vlc_list_remove(&es->node);
+    if (es->main != NULL)
+        es->main->mapped = false;
+    if (es->packetizer != NULL)
+        demux_PacketizerDestroy(es->packetizer);
+    else
+        es_format_Clean(&es->fmt);
+    free(es);
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out);
+    EsDelete((struct splice_es *)id);
+}
+
+static void EsSend(sout_stream_t *stream, struct splice_es *es, block_t *block)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    if (sys->origin == VLC_TICK_INVALID)
+        sys->origin = block->i_dts;
+    if (block->i_dts == VLC_TICK_INVALID || sys->state != SPLICE_BREAK)
+    {
+        block_Release(block);
+        return;
+    }
+
+    vlc_tick_t offset = sys->cut - sys->origin;
+    block->i_dts += offset;
+    if (block->i_pts != VLC_TICK_INVALID)
+        block->i_pts += offset;
+
+    if (sys->break_end != VLC_TICK_INVALID && block->i_dts >= sys->break_end)
+    {
+        sys->done = true;
+        block_Release(block);
+        return;
+    }
+
+    /* Start video on a key frame, the main feed one has been dropped */
+    if (!es->started && es->fmt.i_cat == VIDEO_ES
+     && !(block->i_flags & BLOCK_FLAG_TYPE_I))
+    {
+        block_Release(block);
+        return;
+    }
+    es->started = true;
+
+    if (block->i_dts > sys->last)
+        sys->last = block->i_dts;
+    SendNext(stream, es->main, block);
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    sout_stream_sys_t *sys = container_of(out, sout_stream_sys_t, out);
+    struct splice_es *es = (struct splice_es *)id;
+
+    if (es->main == NULL || sys->demux == NULL)
+    {
+        block_Release(block);
+        return VLC_SUCCESS;
+    }
+
+    if (!es->fmt.b_packetized)
+    {
+        if (es->packetizer == NULL)
+        {
+            es->packetizer = demux_PacketizerNew(sys->demux, &es->fmt,
+                                                 "inserted content");
+            if (es->packetizer == NULL)
+            {
+                /* The format was cleaned */
+                es_format_Init(&es->fmt, UNKNOWN_ES, 0);
+                es->main->mapped = false;
+                es->main = NULL;
+                block_Release(block);
+                return VLC_EGENERIC;
+            }
+        }
+
+        decoder_t *packetizer = es->packetizer;
+        block_t *out_block;
+
+        while ((out_block = packetizer->pf_packetize(packetizer, &block)))
+            for (block_t *next; out_block != NULL; out_block = next)
+            {
+                next = out_block->p_next;
+                out_block->p_next = NULL;
+                EsSend(sys->stream, es, out_block);
+            }
+        return VLC_SUCCESS;
+    }
+
+    EsSend(sys->stream, es, block);
+    return VLC_SUCCESS;
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+
+    switch (query)
+    {
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+            return VLC_SUCCESS;
+
+        case ES_OUT_GET_ES_STATE:
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static const struct es_out_callbacks es_out_cbs = {
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+};
+
+static void StartBreak(sout_stream_t *stream, vlc_tick_t cut)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    sout_stream_id_sys_t *id;
+
+    sys->cue = false;
+
+    stream_t *source = vlc_stream_NewURL(stream, sys->mrl);
+    if (source != NULL)
+    {
+        sys->demux = demux_New(VLC_OBJECT(stream), "any", sys->mrl, source,
+                               &sys->out);
+        if (sys->demux == NULL)
+            vlc_stream_Delete(source);
+    }
+    if (sys->demux == NULL)
+    {
+        msg_Err(stream, "cannot open inserted content %s", sys->mrl);
+        return;
+    }
+
+    sys->cut = cut;
+    sys->cue_in = VLC_TICK_INVALID;
+    sys->break_end = VLC_TICK_INVALID;
+    if (sys->cue_duration != VLC_TICK_INVALID)
+        sys->break_end = cut + sys->cue_duration;
+    else if (sys->default_duration > 0)
+        sys->break_end = cut + sys->default_duration;
+    sys->origin = VLC_TICK_INVALID;
+    sys->last = cut;
+    sys->done = false;
+    sys->state = SPLICE_BREAK;
+
+    vlc_list_foreach (id, &sys->ids, node)
+        id->discontinuity = true;
+
+    msg_Dbg(stream, "splicing out at %"PRId64" for event %"PRIu32,
+            cut, sys->cue_event);
+}
+
+static void EndBreak(sout_stream_t *stream)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    struct splice_es *es;
+
+    demux_Delete(sys->demux);
+    sys->demux = NULL;
+    vlc_list_foreach (es, &sys->es, node)
+        EsDelete(es);
+
+    sys->state = SPLICE_RETURN;
+    msg_Dbg(stream, "inserted content ended at %"PRId64, sys->last);
+}
+
+/* Demuxes the inserted content up to the main feed position */
+static void Pump(sout_stream_t *stream, vlc_tick_t date)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    for (unsigned i = 0; i < SPLICE_PUMP_MAX && !sys->done
+                      && sys->last < date; i++)
+        if (demux_Demux(sys->demux) != VLC_DEMUXER_SUCCESS)
+            sys->done = true;
+
+    if (sys->done
+     || (sys->cue_in != VLC_TICK_INVALID && date >= sys->cue_in)
+     || (sys->break_end != VLC_TICK_INVALID && date >= sys->break_end))
+        EndBreak(stream);
+}
+
+/*****************************************************************************
+ * Main feed
+ *****************************************************************************/
+static void Cue(sout_stream_t *stream, block_t *block)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    scte35_splice_insert_t insert;
+
+    if (!scte35_parse_splice_insert(block->p_buffer, block->i_buffer, &insert))
+        return;
+
+    if (insert.b_cancel)
+    {
+        if (sys->cue && sys->cue_event == insert.i_event_id)
+        {
+            msg_Dbg(stream, "event %"PRIu32" cancelled", insert.i_event_id);
+            sys->cue = false;
+        }
+        return;
+    }
+
+    /* The demuxer converted the splice time to the PTS */
+    vlc_tick_t date = block->i_pts != VLC_TICK_INVALID ? block->i_pts
+                                                       : block->i_dts;
+    if (insert.b_out_of_network)
+    {
+        if (sys->state != SPLICE_MAIN)
+            return;
+        sys->cue = true;
+        sys->cue_event = insert.i_event_id;
+        sys->cue_time = date;
+        sys->cue_duration = block->i_length > 0 ? block->i_length
+                                                : VLC_TICK_INVALID;
+        msg_Dbg(stream, "event %"PRIu32" splices out at %"PRId64,
+                insert.i_event_id, date);
+    }
+    else if (sys->state == SPLICE_BREAK)
+        sys->cue_in = date;
+    else if (sys->cue && sys->cue_event == insert.i_event_id)
+        sys->cue = false;
+}
+
+static bool IsSplicePoint(const sout_stream_sys_t *sys,
+                          const sout_stream_id_sys_t *id, const block_t *block)
+{
+    if (id->fmt.i_cat == VIDEO_ES)
+        return block->i_flags & BLOCK_FLAG_TYPE_I;
+    return !sys->has_video;
+}
+
+static void *Add(sout_stream_t *stream, const es_format_t *fmt)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    sout_stream_id_sys_t *id = malloc(sizeof (*id));
+    if (unlikely(id == NULL))
+        return NULL;
+
+    if (es_format_Copy(&id->fmt, fmt))
+    {
+        es_format_Clean(&id->fmt);
+        free(id);
+        return NULL;
+    }
+
+    id->cue = fmt->i_codec == VLC_CODEC_SCTE_35;
+    id->discontinuity = false;
+    id->mapped = false;
+    id->id = NULL;
+    if (!id->cue)
+    {
+        id->id = sout_StreamIdAdd(stream->p_next, &id->fmt);
+        if (id->id == NULL)
+        {
+            es_format_Clean(&id->fmt);
+            free(id);
+            return NULL;
+        }
+        if (fmt->i_cat == VIDEO_ES)
+            sys->has_video = true;
+    }
+
+    vlc_list_append(&id->node, &sys->ids);
+    return id;
+}
+
+static void Del(sout_stream_t *stream, void *_id)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+    struct splice_es *es;
+
+    vlc_list_foreach (es, &sys->es, node)
+        if (es->main == id)
+            es->main = NULL;
+    vlc_list_remove(&id->node);
+
+    if (id->id != NULL)
+        sout_StreamIdDel(stream->p_next, id->id);
+
+    es_format_Clean(&id->fmt);
+    free(id);
+}
+
+static int Send(sout_stream_t *stream, void *_id, block_t *block)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+
+    for (block_t *next; block != NULL; block = next)
+    {
+        next = block->p_next;
+        block->p_next = NULL;
+
+        if (id->cue)
+        {
+            Cue(stream, block);
+            block_Release(block);
+            continue;
+        }
+
+        vlc_tick_t pts = block->i_pts != VLC_TICK_INVALID ? block->i_pts
+                                                          : block->i_dts;
+        if (sys->state == SPLICE_MAIN && sys->cue && pts >= sys->cue_time
+         && block->i_dts != VLC_TICK_INVALID && IsSplicePoint(sys, id, block))
+            StartBreak(stream, block->i_dts);
+
+        if (sys->state == SPLICE_BREAK)
+            Pump(stream, block->i_dts);
+
+        if (sys->state == SPLICE_RETURN && block->i_dts >= sys->last
+         && IsSplicePoint(sys, id, block))
+        {
+            sout_stream_id_sys_t *other;
+
+            sys->state = SPLICE_MAIN;
+            sys->cut = block->i_dts;
+            vlc_list_foreach (other, &sys->ids, node)
+                other->discontinuity = true;
+            msg_Dbg(stream, "splicing in at %"PRId64, sys->cut);
+        }
+
+        /* Around a switch, only keep the main feed on its side of the cut */
+        bool keep;
+        switch (sys->state)
+        {
+            case SPLICE_MAIN:
+                keep = sys->cut == VLC_TICK_INVALID
+                    || block->i_dts == VLC_TICK_INVALID
+                    || block->i_dts >= sys->cut;
+                break;
+            case SPLICE_BREAK:
+                keep = id->fmt.i_cat != VIDEO_ES
+                    && block->i_dts != VLC_TICK_INVALID
+                    && block->i_dts < sys->cut;
+                break;
+            default:
+                keep = false;
+                break;
+        }
+
+        if (keep)
+            SendNext(stream, id, block);
+        else
+            block_Release(block);
+    }
+    return VLC_SUCCESS;
+}
+
+static void Flush(sout_stream_t *stream, void *_id)
+{
+    sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+
+    if (id->id != NULL)
+        sout_StreamFlush(stream->p_next, id->id);
+}
+
+static const struct sout_stream_operations ops = {
+    Add, Del, Send, NULL, Flush,
+};
+
+static const char *const ppsz_sout_options[] = {
+    "ad", "duration", NULL
+};
+
+static int Open(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    config_ChainParse(stream, SOUT_CFG_PREFIX, ppsz_sout_options,
+                      stream->p_cfg);
+
+    char *mrl = var_GetNonEmptyString(stream, SOUT_CFG_PREFIX "ad");
+    if (mrl == NULL)
+    {
+        msg_Err(stream, "no inserted content specified");
+        return VLC_EGENERIC;
+    }
+
+    sout_stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+    {
+        free(mrl);
+        return VLC_ENOMEM;
+    }
+
+    vlc_list_init(&sys->ids);
+    sys->mrl = mrl;
+    sys->default_duration = VLC_TICK_FROM_MS(
+        var_GetInteger(stream, SOUT_CFG_PREFIX "duration"));
+    sys->state = SPLICE_MAIN;
+    sys->has_video = false;
+    sys->cue = false;
+    sys->cut = VLC_TICK_INVALID;
+    sys->cue_in = VLC_TICK_INVALID;
+    sys->break_end = VLC_TICK_INVALID;
+    sys->stream = stream;
+    sys->out.cbs = &es_out_cbs;
+    sys->demux = NULL;
+    vlc_list_init(&sys->es);
+
+    stream->ops = &ops;
+    stream->p_sys = sys;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    if (sys->demux != NULL)
+        EndBreak(stream);
+
+    assert(vlc_list_is_empty(&sys->ids));
+    free(sys->mrl);
+    free(sys);
+}
+
+#define AD_TEXT N_("Inserted content")
+#define AD_LONGTEXT N_("MRL of the content inserted at each SCTE-35 " \
+    "splice out point. It must use the same codecs as the main feed.")
+#define DURATION_TEXT N_("Default break duration (ms)")
+#define DURATION_LONGTEXT N_("Duration of the breaks whose splice " \
+    "information signals none. 0 plays the inserted content until its " \
+    "end or until the main feed is spliced back in.")
+
+vlc_module_begin()
+    set_shortname(N_("Splice"))
+    set_description(N_("SCTE-35 splice-aware content insertion"))
+    set_capability("sout filter", 0)
+    add_shortcut("splice")
+    set_category(CAT_SOUT)
+    set_subcategory(SUBCAT_SOUT_STREAM)
+    set_callbacks(Open, Close)
+    add_string(SOUT_CFG_PREFIX "ad", NULL, AD_TEXT, AD_LONGTEXT)
+    add_integer(SOUT_CFG_PREFIX "duration", 0, DURATION_TEXT,
+                DURATION_LONGTEXT)
+vlc_module_end()
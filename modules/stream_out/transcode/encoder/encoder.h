@@ -45,6 +45,11 @@ typedef struct
                 int          i_priority;
                 uint32_t     pool_size;
             } threads;
+            struct
+            {
+                unsigned int i_count; /* parallel encoders, 0 to disable */
+                unsigned int i_group; /* pictures encoded independently */
+            } pool;
         } video;
         struct
         {
@@ -94,6 +99,8 @@ void transcode_encoder_video_configure( vlc_object_t *p_obj,
 
 void transcode_encoder_video_set_src( encoder_t *, const video_format_t *,
                                       const transcode_encoder_config_t * );
+void transcode_encoder_video_set_vctx_in( transcode_encoder_t *,
+                                          vlc_video_context * );
 
 void transcode_video_framerate_apply( const video_format_t *p_src,
                                             video_format_t *p_dst );
@@ -18,6 +18,8 @@
  *****************************************************************************/
 #include <vlc_picture_fifo.h>
 
+typedef struct transcode_encoder_pool_t transcode_encoder_pool_t;
+
 struct transcode_encoder_t
 {
     encoder_t       *p_encoder;
@@ -31,6 +33,9 @@ struct transcode_encoder_t
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* parallel video encoders, the p_encoder one only being a reference */
+    transcode_encoder_pool_t *p_pool;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
@@ -49,6 +54,13 @@ block_t * transcode_encoder_spu_encode( transcode_encoder_t *p_enc, subpicture_t
 int transcode_encoder_audio_drain( transcode_encoder_t *p_enc, block_t **out );
 int transcode_encoder_video_drain( transcode_encoder_t *p_enc, block_t **out );
 
+transcode_encoder_pool_t * transcode_encoder_pool_new( encoder_t *p_parent,
+                                                       const es_format_t *p_fmt_out,
+                                                       const transcode_encoder_config_t *p_cfg );
+block_t * transcode_encoder_pool_encode( transcode_encoder_pool_t *, picture_t * );
+block_t * transcode_encoder_pool_drain( transcode_encoder_pool_t * );
+void transcode_encoder_pool_delete( transcode_encoder_pool_t * );
+
 int transcode_encoder_video_test( encoder_t *p_encoder,
                                   const transcode_encoder_config_t *p_cfg,
                                   const es_format_t *p_dec_fmtin,
@@ -0,0 +1,421 @@
+/*****************************************************************************
+ * pool.c: transcoding parallel video encoders
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, If not, see https://www.gnu.org/licenses/
+ *****************************************************************************/
+
+/*
+ * The pictures are split in groups of consecutive pictures, every group
+ * being encoded from scratch by one of the pool encoders, each running in its
+ * own thread. An encoder is flushed at the end of its group and reopened
+ * before the next one, so that every group starts with a key frame and
+ * doesn't reference the other groups. Groups of a single picture are meant
+ * for intra-only codecs and keep their encoder open.
+ *
+ * The encoded groups are output in their input order, hence in decode order.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_codec.h>
+#include <vlc_sout.h>
+#include "encoder.h"
+#include "encoder_priv.h"
+
+typedef struct transcode_pool_job_t transcode_pool_job_t;
+
+struct transcode_pool_job_t
+{
+    transcode_pool_job_t *p_next;
+    block_t     *p_out;
+    bool         b_running;
+    bool         b_done;
+    unsigned     i_pics;
+    picture_t   *pp_pics[];
+};
+
+struct pool_encoder_owner
+{
+    encoder_t enc;
+    encoder_t *p_parent;
+};
+
+typedef struct
+{
+    transcode_encoder_pool_t *p_pool;
+    encoder_t    *p_encoder;
+    vlc_thread_t  thread;
+} transcode_pool_worker_t;
+
+struct transcode_encoder_pool_t
+{
+    encoder_t       *p_parent;
+    const transcode_encoder_config_t *p_cfg;
+    es_format_t     fmt_out; /* requested output format, before opening */
+    unsigned        i_group;
+
+    vlc_mutex_t     lock;
+    vlc_cond_t      wait; /* queued jobs or abort, for the workers */
+    vlc_cond_t      done; /* completed jobs, for the owner */
+    bool            b_abort;
+
+    /* queued jobs, in input order */
+    transcode_pool_job_t  *p_first;
+    transcode_pool_job_t **pp_last;
+    unsigned        i_jobs;
+    unsigned        i_max_jobs;
+
+    /* job being filled by the owner */
+    transcode_pool_job_t  *p_filling;
+
+    size_t          i_workers;
+    transcode_pool_worker_t workers[];
+};
+
+static vlc_decoder_device *pool_get_encoder_device( encoder_t *p_enc )
+{
+    struct pool_encoder_owner *p_owner =
+        container_of( p_enc, struct pool_encoder_owner, enc );
+    return vlc_encoder_GetDecoderDevice( p_owner->p_parent );
+}
+
+static const struct encoder_owner_callbacks pool_encoder_cbs = {
+    { pool_get_encoder_device, }
+};
+
+static int pool_encoder_open( transcode_encoder_pool_t *p_pool,
+                              encoder_t *p_encoder )
+{
+    const encoder_t *p_parent = p_pool->p_parent;
+    const transcode_encoder_config_t *p_cfg = p_pool->p_cfg;
+
+    es_format_Clean( &p_encoder->fmt_in );
+    es_format_Copy( &p_encoder->fmt_in, &p_parent->fmt_in );
+    es_format_Clean( &p_encoder->fmt_out );
+    es_format_Copy( &p_encoder->fmt_out, &p_pool->fmt_out );
+    p_encoder->vctx_in = p_parent->vctx_in;
+    p_encoder->i_threads = p_parent->i_threads;
+    p_encoder->p_cfg = p_cfg->p_config_chain;
+
+    p_encoder->p_module =
+        module_need( p_encoder, "encoder", p_cfg->psz_name, true );
+    if( !p_encoder->p_module )
+        return VLC_EGENERIC;
+
+    /* Every encoder of the pool must take the pictures prepared for the
+     * parent one */
+    if( p_encoder->fmt_in.i_codec != p_parent->fmt_in.i_codec )
+    {
+        msg_Err( p_encoder, "pool encoder wants %4.4s input instead of %4.4s",
+                 (const char *)&p_encoder->fmt_in.i_codec,
+                 (const char *)&p_parent->fmt_in.i_codec );
+        module_unneed( p_encoder, p_encoder->p_module );
+        p_encoder->p_module = NULL;
+        return VLC_EGENERIC;
+    }
+    p_encoder->fmt_in.video.i_chroma = p_encoder->fmt_in.i_codec;
+    return VLC_SUCCESS;
+}
+
+static void pool_encoder_close( encoder_t *p_encoder )
+{
+    if( p_encoder->p_module )
+    {
+        module_unneed( p_encoder, p_encoder->p_module );
+        p_encoder->p_module = NULL;
+    }
+}
+
+static void pool_encoder_delete( encoder_t *p_encoder )
+{
+    pool_encoder_close( p_encoder );
+    es_format_Clean( &p_encoder->fmt_in );
+    es_format_Clean( &p_encoder->fmt_out );
+    vlc_object_delete( p_encoder );
+}
+
+static block_t *pool_encoder_flush( encoder_t *p_encoder )
+{
+    block_t *p_out = NULL, *p_block;
+    if( !p_encoder->p_module )
+        return NULL;
+    do {
+        p_block = p_encoder->pf_encode_video( p_encoder, NULL );
+        block_ChainAppend( &p_out, p_block );
+    } while( p_block );
+    return p_out;
+}
+
+static void pool_job_delete( transcode_pool_job_t *p_job )
+{
+    for( unsigned i = 0; i < p_job->i_pics; i++ )
+        picture_Release( p_job->pp_pics[i] );
+    block_ChainRelease( p_job->p_out );
+    free( p_job );
+}
+
+static block_t *pool_job_encode( transcode_encoder_pool_t *p_pool,
+                                 encoder_t *p_encoder,
+                                 transcode_pool_job_t *p_job )
+{
+    block_t *p_out = NULL;
+
+    if( !p_encoder->p_module )
+    {
+        /* The encoder could not be reopened, the group is lost */
+        msg_Warn( p_encoder, "dropping %u pictures", p_job->i_pics );
+        return NULL;
+    }
+
+    for( unsigned i = 0; i < p_job->i_pics; i++ )
+    {
+        block_t *p_block = p_encoder->pf_encode_video( p_encoder,
+                                                       p_job->pp_pics[i] );
+        block_ChainAppend( &p_out, p_block );
+    }
+
+    if( p_pool->i_group > 1 )
+    {
+        /* Output the whole group, and start the next one from scratch */
+        block_ChainAppend( &p_out, pool_encoder_flush( p_encoder ) );
+        pool_encoder_close( p_encoder );
+        if( pool_encoder_open( p_pool, p_encoder ) )
+            msg_Err( p_encoder, "cannot reopen pool encoder" );
+    }
+    return p_out;
+}
+
+static void* pool_worker_thread( void *data )
+{
+    transcode_pool_worker_t *p_worker = data;
+    transcode_encoder_pool_t *p_pool = p_worker->p_pool;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &p_pool->lock );
+    for( ;; )
+    {
+        transcode_pool_job_t *p_job = p_pool->p_first;
+        while( p_job && p_job->b_running )
+            p_job = p_job->p_next;
+
+        if( p_pool->b_abort )
+            break;
+
+        if( p_job == NULL )
+        {
+            vlc_cond_wait( &p_pool->wait, &p_pool->lock );
+            continue;
+        }
+
+        /* release lock while encoding */
+        p_job->b_running = true;
+        vlc_mutex_unlock( &p_pool->lock );
+        block_t *p_out = pool_job_encode( p_pool, p_worker->p_encoder, p_job );
+        vlc_mutex_lock( &p_pool->lock );
+
+        p_job->p_out = p_out;
+        p_job->b_done = true;
+        vlc_cond_signal( &p_pool->done );
+    }
+    vlc_mutex_unlock( &p_pool->lock );
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+/* Must be called locked */
+static block_t *pool_collect( transcode_encoder_pool_t *p_pool )
+{
+    block_t *p_out = NULL;
+
+    while( p_pool->p_first && p_pool->p_first->b_done )
+    {
+        transcode_pool_job_t *p_job = p_pool->p_first;
+        p_pool->p_first = p_job->p_next;
+        if( p_pool->p_first == NULL )
+            p_pool->pp_last = &p_pool->p_first;
+        p_pool->i_jobs--;
+
+        block_ChainAppend( &p_out, p_job->p_out );
+        p_job->p_out = NULL;
+        pool_job_delete( p_job );
+    }
+    return p_out;
+}
+
+static void pool_queue( transcode_encoder_pool_t *p_pool )
+{
+    transcode_pool_job_t *p_job = p_pool->p_filling;
+    p_pool->p_filling = NULL;
+
+    vlc_mutex_lock( &p_pool->lock );
+    *p_pool->pp_last = p_job;
+    p_pool->pp_last = &p_job->p_next;
+    p_pool->i_jobs++;
+    vlc_cond_signal( &p_pool->wait );
+    vlc_mutex_unlock( &p_pool->lock );
+}
+
+block_t * transcode_encoder_pool_encode( transcode_encoder_pool_t *p_pool,
+                                         picture_t *p_pic )
+{
+    if( p_pool->p_filling == NULL )
+    {
+        p_pool->p_filling = malloc( sizeof(*p_pool->p_filling) +
+                                    p_pool->i_group * sizeof(picture_t *) );
+        if( unlikely(p_pool->p_filling == NULL) )
+            return NULL;
+        p_pool->p_filling->p_next = NULL;
+        p_pool->p_filling->p_out = NULL;
+        p_pool->p_filling->b_running = false;
+        p_pool->p_filling->b_done = false;
+        p_pool->p_filling->i_pics = 0;
+    }
+
+    transcode_pool_job_t *p_job = p_pool->p_filling;
+    p_job->pp_pics[p_job->i_pics++] = picture_Hold( p_pic );
+    if( p_job->i_pics == p_pool->i_group )
+        pool_queue( p_pool );
+
+    vlc_mutex_lock( &p_pool->lock );
+    block_t *p_out = pool_collect( p_pool );
+    /* Don't let the pending groups grow without bounds */
+    while( p_pool->i_jobs >= p_pool->i_max_jobs )
+    {
+        vlc_cond_wait( &p_pool->done, &p_pool->lock );
+        block_ChainAppend( &p_out, pool_collect( p_pool ) );
+    }
+    vlc_mutex_unlock( &p_pool->lock );
+
+    return p_out;
+}
+
+block_t * transcode_encoder_pool_drain( transcode_encoder_pool_t *p_pool )
+{
+    if( p_pool->p_filling )
+        pool_queue( p_pool );
+
+    vlc_mutex_lock( &p_pool->lock );
+    block_t *p_out = pool_collect( p_pool );
+    while( p_pool->p_first )
+    {
+        vlc_cond_wait( &p_pool->done, &p_pool->lock );
+        block_ChainAppend( &p_out, pool_collect( p_pool ) );
+    }
+
+    /* Single picture groups don't flush their encoders after each picture,
+     * the workers are idle at this point */
+    if( p_pool->i_group == 1 )
+        for( size_t i = 0; i < p_pool->i_workers; i++ )
+            block_ChainAppend( &p_out,
+                               pool_encoder_flush( p_pool->workers[i].p_encoder ) );
+    vlc_mutex_unlock( &p_pool->lock );
+
+    return p_out;
+}
+
+void transcode_encoder_pool_delete( transcode_encoder_pool_t *p_pool )
+{
+    vlc_mutex_lock( &p_pool->lock );
+    p_pool->b_abort = true;
+    vlc_cond_broadcast( &p_pool->wait );
+    vlc_mutex_unlock( &p_pool->lock );
+
+    for( size_t i = 0; i < p_pool->i_workers; i++ )
+    {
+        vlc_join( p_pool->workers[i].thread, NULL );
+        pool_encoder_delete( p_pool->workers[i].p_encoder );
+    }
+
+    while( p_pool->p_first )
+    {
+        transcode_pool_job_t *p_job = p_pool->p_first;
+        p_pool->p_first = p_job->p_next;
+        pool_job_delete( p_job );
+    }
+    if( p_pool->p_filling )
+        pool_job_delete( p_pool->p_filling );
+
+    es_format_Clean( &p_pool->fmt_out );
+    free( p_pool );
+}
+
+transcode_encoder_pool_t *
+transcode_encoder_pool_new( encoder_t *p_parent, const es_format_t *p_fmt_out,
+                            const transcode_encoder_config_t *p_cfg )
+{
+    const unsigned i_count = p_cfg->video.pool.i_count;
+
+    transcode_encoder_pool_t *p_pool =
+        malloc( sizeof(*p_pool) + i_count * sizeof(p_pool->workers[0]) );
+    if( !p_pool )
+        return NULL;
+
+    p_pool->p_parent = p_parent;
+    p_pool->p_cfg = p_cfg;
+    es_format_Copy( &p_pool->fmt_out, p_fmt_out );
+    p_pool->i_group = __MAX( p_cfg->video.pool.i_group, 1 );
+    vlc_mutex_init( &p_pool->lock );
+    vlc_cond_init( &p_pool->wait );
+    vlc_cond_init( &p_pool->done );
+    p_pool->b_abort = false;
+    p_pool->p_first = NULL;
+    p_pool->pp_last = &p_pool->p_first;
+    p_pool->i_jobs = 0;
+    p_pool->i_max_jobs = 2 * i_count;
+    p_pool->p_filling = NULL;
+    p_pool->i_workers = 0;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        transcode_pool_worker_t *p_worker = &p_pool->workers[i];
+        struct pool_encoder_owner *p_owner =
+            (struct pool_encoder_owner *)sout_EncoderCreate( p_parent,
+                                                             sizeof(*p_owner) );
+        if( !p_owner )
+            break;
+        p_owner->p_parent = p_parent;
+        p_owner->enc.cbs = &pool_encoder_cbs;
+        es_format_Init( &p_owner->enc.fmt_in, VIDEO_ES, 0 );
+        es_format_Init( &p_owner->enc.fmt_out, VIDEO_ES, 0 );
+
+        p_worker->p_pool = p_pool;
+        p_worker->p_encoder = &p_owner->enc;
+        if( pool_encoder_open( p_pool, p_worker->p_encoder ) ||
+            vlc_clone( &p_worker->thread, pool_worker_thread, p_worker,
+                       p_cfg->video.threads.i_priority ) )
+        {
+            pool_encoder_delete( p_worker->p_encoder );
+            break;
+        }
+        p_pool->i_workers++;
+    }
+
+    if( p_pool->i_workers < i_count )
+    {
+        msg_Err( p_parent, "cannot start %u parallel encoders", i_count );
+        transcode_encoder_pool_delete( p_pool );
+        return NULL;
+    }
+
+    msg_Dbg( p_parent, "encoding groups of %u pictures with %u encoders",
+             p_pool->i_group, i_count );
+    return p_pool;
+}
@@ -224,6 +224,14 @@ void transcode_encoder_video_set_src(encoder_t *p_encoder, const video_format_t
     transcode_video_size_config_apply( VLC_OBJECT(p_encoder), p_src, p_cfg, p_enc_in );
 }
 
+void transcode_encoder_video_set_vctx_in( transcode_encoder_t *p_enc,
+                                          vlc_video_context *vctx_in )
+{
+    /* The encoder input format can't change once it is opened */
+    assert( !transcode_encoder_opened( p_enc ) );
+    p_enc->p_encoder->vctx_in = vctx_in;
+}
+
 void transcode_encoder_video_configure( vlc_object_t *p_obj,
                                         const video_format_t *p_dec_out,
                                         const transcode_encoder_config_t *p_cfg,
@@ -410,7 +418,11 @@ static void* EncoderThread( void *obj )
 
 int transcode_encoder_video_drain( transcode_encoder_t *p_enc, block_t **out )
 {
-    if( !p_enc->b_threaded )
+    if( p_enc->p_pool )
+    {
+        block_ChainAppend( out, transcode_encoder_pool_drain( p_enc->p_pool ) );
+    }
+    else if( !p_enc->b_threaded )
     {
         block_t *p_block;
         do {
@@ -444,6 +456,12 @@ void transcode_encoder_video_close( transcode_encoder_t *p_enc )
         vlc_join( p_enc->thread, NULL );
     }
 
+    if( p_enc->p_pool )
+    {
+        transcode_encoder_pool_delete( p_enc->p_pool );
+        p_enc->p_pool = NULL;
+    }
+
     /* Close encoder */
     module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
     p_enc->p_encoder->p_module = NULL;
@@ -455,10 +473,19 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->i_threads = p_cfg->video.threads.i_count;
     p_enc->p_encoder->p_cfg = p_cfg->p_config_chain;
 
+    /* The pool encoders are opened with the same request */
+    es_format_t fmt_out_req;
+    if( p_cfg->video.pool.i_count > 0 )
+        es_format_Copy( &fmt_out_req, &p_enc->p_encoder->fmt_out );
+
     p_enc->p_encoder->p_module =
         module_need( p_enc->p_encoder, "encoder", p_cfg->psz_name, true );
     if( !p_enc->p_encoder->p_module )
+    {
+        if( p_cfg->video.pool.i_count > 0 )
+            es_format_Clean( &fmt_out_req );
         return VLC_EGENERIC;
+    }
 
     p_enc->p_encoder->fmt_in.video.i_chroma = p_enc->p_encoder->fmt_in.i_codec;
 
@@ -470,8 +497,21 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     vlc_cond_init( &p_enc->cond );
     p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
+    p_enc->p_pool = NULL;
 
-    if( p_cfg->video.threads.i_count > 0 )
+    if( p_cfg->video.pool.i_count > 0 )
+    {
+        p_enc->p_pool = transcode_encoder_pool_new( p_enc->p_encoder,
+                                                    &fmt_out_req, p_cfg );
+        es_format_Clean( &fmt_out_req );
+        if( !p_enc->p_pool )
+        {
+            module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+            p_enc->p_encoder->p_module = NULL;
+            return VLC_EGENERIC;
+        }
+    }
+    else if( p_cfg->video.threads.i_count > 0 )
     {
         if( vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
         {
@@ -487,6 +527,13 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic )
 {
+    if( p_enc->p_pool )
+    {
+        if( !p_pic )
+            return transcode_encoder_pool_drain( p_enc->p_pool );
+        return transcode_encoder_pool_encode( p_enc->p_pool, p_pic );
+    }
+
     if( !p_enc->b_threaded )
     {
         return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
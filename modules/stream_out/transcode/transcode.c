@@ -75,6 +75,12 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video ladder")
+#define LADDER_LONGTEXT N_( \
+    "Additional renditions of the video, as a comma-separated list of " \
+    "WIDTHxHEIGHT[@BITRATE] (bitrate in kb/s, eg: 1280x720@3000,640x360@800)." \
+    " They are encoded from the same decoded pictures as the main video, " \
+    "each one in its own thread." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -129,6 +135,21 @@
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
+#define VENC_POOL_TEXT N_("Parallel video encoders")
+#define VENC_POOL_LONGTEXT N_( \
+    "Number of video encoders running in parallel, each one encoding its " \
+    "own groups of pictures. This is meant for single-threaded encoders " \
+    "such as Theora or MJPEG. 0 disables it." )
+#define VENC_POOL_GROUP_TEXT N_("Parallel video encoders group size")
+#define VENC_POOL_GROUP_LONGTEXT N_( \
+    "Number of consecutive pictures encoded independently by one of the " \
+    "parallel video encoders. Every group starts with a key frame, so this " \
+    "should be the key frame interval, or 1 for intra-only codecs." )
+#define VFILTER_THREADS_TEXT N_("Video filter threads")
+#define VFILTER_THREADS_LONGTEXT N_( \
+    "Number of threads running the video filters as a pipeline, each one " \
+    "running a group of consecutive filters. This adds a few pictures of " \
+    "latency. 0 runs the filters in the decoder thread." )
 
 
 static const char *const ppsz_deinterlace_type[] =
@@ -173,6 +194,8 @@ vlc_module_begin ()
                  MAXWIDTH_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "maxheight", 0, MAXHEIGHT_TEXT,
                  MAXHEIGHT_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
 
@@ -211,6 +234,15 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT )
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "venc-pool", 0, VENC_POOL_TEXT,
+                 VENC_POOL_LONGTEXT )
+        change_integer_range( 0, 32 )
+    add_integer( SOUT_CFG_PREFIX "venc-pool-group", 1, VENC_POOL_GROUP_TEXT,
+                 VENC_POOL_GROUP_LONGTEXT )
+        change_integer_range( 1, 1000 )
+    add_integer( SOUT_CFG_PREFIX "vfilter-threads", 0, VFILTER_THREADS_TEXT,
+                 VFILTER_THREADS_LONGTEXT )
+        change_integer_range( 0, 16 )
 
 vlc_module_end ()
 
@@ -220,7 +252,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "ladder", "venc-pool", "venc-pool-group", "vfilter-threads", NULL
 };
 
 /*****************************************************************************
@@ -321,6 +353,8 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
 
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->video.pool.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "venc-pool" );
+    p_cfg->video.pool.i_group = var_GetInteger( p_stream, SOUT_CFG_PREFIX "venc-pool-group" );
 
 #if VLC_THREAD_PRIORITY_OUTPUT != VLC_THREAD_PRIORITY_VIDEO
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
@@ -330,6 +364,63 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_ladder = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( !psz_ladder )
+        return;
+
+    size_t i_count = 1;
+    for( const char *psz = psz_ladder; *psz; psz++ )
+        if( *psz == ',' )
+            i_count++;
+
+    p_sys->p_ladder_cfg = vlc_alloc( i_count, sizeof(*p_sys->p_ladder_cfg) );
+    if( unlikely(!p_sys->p_ladder_cfg) )
+    {
+        free( psz_ladder );
+        return;
+    }
+
+    const transcode_encoder_config_t *p_main = &p_sys->venc_cfg;
+    char *psz_save;
+    for( char *psz_rung = strtok_r( psz_ladder, ",", &psz_save ); psz_rung;
+         psz_rung = strtok_r( NULL, ",", &psz_save ) )
+    {
+        unsigned i_width, i_height, i_bitrate = 0;
+        if( sscanf( psz_rung, "%ux%u@%u", &i_width, &i_height, &i_bitrate ) < 2 ||
+            i_width < 2 || i_height < 2 )
+        {
+            msg_Warn( p_stream, "ignoring invalid ladder rendition `%s'", psz_rung );
+            continue;
+        }
+
+        /* Renditions use the main video encoder and its options so that
+         * they share the same GOP structure */
+        transcode_encoder_config_t *p_cfg = &p_sys->p_ladder_cfg[p_sys->i_ladder];
+        transcode_encoder_config_init( p_cfg );
+        p_cfg->i_codec = p_main->i_codec;
+        p_cfg->psz_name = p_main->psz_name ? strdup( p_main->psz_name ) : NULL;
+        p_cfg->psz_lang = p_main->psz_lang ? strdup( p_main->psz_lang ) : NULL;
+        p_cfg->p_config_chain = config_ChainDuplicate( p_main->p_config_chain );
+        p_cfg->video = p_main->video;
+        p_cfg->video.f_scale = 0;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        if( i_bitrate )
+            p_cfg->video.i_bitrate = i_bitrate < 16000 ? i_bitrate * 1000 : i_bitrate;
+        /* Each rendition already runs in its own thread */
+        p_cfg->video.threads.i_count = 0;
+        p_cfg->video.pool.i_count = 0;
+
+        msg_Dbg( p_stream, "ladder rendition %ux%u %ukb/s",
+                 i_width, i_height, p_cfg->video.i_bitrate / 1000 );
+        p_sys->i_ladder++;
+    }
+    free( psz_ladder );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -419,6 +510,9 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
     }
 
+    if( p_sys->venc_cfg.i_codec )
+        SetVideoLadderConfig( p_stream, p_sys );
+
     /* Video Filter Parameters */
     sout_filters_config_init( &p_sys->vfilters_cfg );
 
@@ -438,6 +532,9 @@ static int Open( vlc_object_t *p_this )
         free( psz_string );
     }
 
+    p_sys->vfilters_cfg.video.i_pipeline =
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "vfilter-threads" );
+
     /* Subpictures SOURCES parameters (not releated to subtitles stream) */
     psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "sfilter" );
     if( psz_string && *psz_string )
@@ -477,6 +574,9 @@ static void Close( vlc_object_t * p_this )
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
+    for( size_t i = 0; i < p_sys->i_ladder; i++ )
+        transcode_encoder_config_clean( &p_sys->p_ladder_cfg[i] );
+    free( p_sys->p_ladder_cfg );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
     sout_filters_config_clean( &p_sys->afilters_cfg );
@@ -688,7 +788,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
@@ -17,6 +17,7 @@ typedef struct
             config_chain_t  *p_deinterlace_cfg;
             char            *psz_spu_sources;
             bool             b_reorient;
+            unsigned         i_pipeline; /**< Filter pipeline threads */
         } video;
     };
 } sout_filters_config_t;
@@ -52,6 +53,9 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    /* Additional renditions sharing the video decoder */
+    transcode_encoder_config_t *p_ladder_cfg;
+    size_t          i_ladder;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -67,6 +71,7 @@ typedef struct
 } sout_stream_sys_t;
 
 struct aout_filters;
+typedef struct transcode_rung_t transcode_rung_t;
 
 struct sout_stream_id_sys_t
 {
@@ -125,6 +130,8 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             transcode_rung_t *p_rungs; /**< Additional ladder renditions */
+             size_t           i_rungs;
          };
          struct
          {
@@ -201,7 +208,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
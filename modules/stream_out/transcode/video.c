@@ -40,12 +40,44 @@
 
 #include <math.h>
 
+/* Pictures queued in front of each thread of the pipelined filter chains */
+#define TRANSCODE_FILTER_PIPELINE_DEPTH 2
+
 struct encoder_owner
 {
     encoder_t enc;
     sout_stream_id_sys_t *id;
 };
 
+/*
+ * Ladder renditions
+ *
+ * Every rendition of the ladder gets the pictures coming out of the video
+ * filters, before the main encoder converter and the subpictures blending.
+ * It scales and encodes them in its own thread. All renditions encode the
+ * very same pictures with the same encoder options, so fixed GOP encoders
+ * produce key frames at the same timestamps in every rendition.
+ */
+struct transcode_rung_t
+{
+    const transcode_encoder_config_t *p_enccfg;
+    transcode_encoder_t *encoder;
+    filter_chain_t      *p_conv; /**< converter to the rendition encoder input */
+    void                *downstream_id;
+
+    vlc_thread_t         thread;
+    bool                 b_running;
+    vlc_mutex_t          lock;
+    vlc_cond_t           wait;
+    bool                 b_abort;
+    picture_fifo_t      *pics;
+    vlc_sem_t            room; /**< limits the pictures queued in pics */
+
+    /* output blocks, protected by lock */
+    block_t             *p_out;
+    block_t            **pp_out_last;
+};
+
 static vlc_decoder_device *TranscodeHoldDecoderDevice(vlc_object_t *o, sout_stream_id_sys_t *id)
 {
     if (id->dec_dev == NULL)
@@ -136,15 +168,17 @@ static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vct
     return chain_works;
 }
 
-static picture_t *video_new_buffer_encoder( transcode_encoder_t *p_enc )
+static picture_t *video_new_buffer_encoder( vlc_object_t *p_obj,
+                                            transcode_encoder_t *p_enc )
 {
-    return picture_NewFromFormat( &transcode_encoder_format_in( p_enc )->video );
+    return picture_NewCached( p_obj,
+                              &transcode_encoder_format_in( p_enc )->video );
 }
 
 static picture_t *transcode_video_filter_buffer_new( filter_t *p_filter )
 {
     assert(p_filter->fmt_out.video.i_chroma == p_filter->fmt_out.i_codec);
-    return picture_NewFromFormat( &p_filter->fmt_out.video );
+    return picture_NewCached( p_filter, &p_filter->fmt_out.video );
 }
 
 static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
@@ -249,6 +283,22 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
 
     es_format_Clean( &encoder_tested_fmt_in );
 
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+    if( p_sys->i_ladder > 0 )
+    {
+        id->p_rungs = calloc( p_sys->i_ladder, sizeof(*id->p_rungs) );
+        if( likely(id->p_rungs != NULL) )
+            id->i_rungs = p_sys->i_ladder;
+        for( size_t i = 0; i < id->i_rungs; i++ )
+        {
+            transcode_rung_t *rung = &id->p_rungs[i];
+            rung->p_enccfg = &p_sys->p_ladder_cfg[i];
+            vlc_mutex_init( &rung->lock );
+            vlc_cond_init( &rung->wait );
+            rung->pp_out_last = &rung->p_out;
+        }
+    }
+
     return VLC_SUCCESS;
 
 error:
@@ -269,6 +319,41 @@ static inline bool transcode_video_filters_configured( const sout_stream_id_sys_
     return !!id->p_f_chain;
 }
 
+/* Hardware decoded pictures stay in GPU memory as long as every stage of the
+ * chain accepts their video context. Warn whenever a stage forces a readback
+ * to system memory since it is usually the most expensive part of the
+ * transcoding. */
+static void transcode_video_check_readback( sout_stream_t *p_stream,
+                                            const char *psz_stage,
+                                            const es_format_t *p_in,
+                                            vlc_video_context *vctx_in,
+                                            const es_format_t *p_out,
+                                            vlc_video_context *vctx_out )
+{
+    if( vctx_in == NULL )
+        return;
+    if( vctx_out == NULL )
+        msg_Warn( p_stream, "%s forces a copy of GPU frames to system memory "
+                  "(%4.4s -> %4.4s)", psz_stage,
+                  (const char *)&p_in->video.i_chroma,
+                  (const char *)&p_out->video.i_chroma );
+    else
+        msg_Dbg( p_stream, "%s keeps frames in GPU memory (%4.4s -> %4.4s)",
+                 psz_stage, (const char *)&p_in->video.i_chroma,
+                 (const char *)&p_out->video.i_chroma );
+}
+
+static void transcode_video_set_encoder_vctx( sout_stream_id_sys_t *id,
+                                              vlc_video_context *vctx )
+{
+    /* The encoder doesn't hold its input video context, keep it alive for
+     * as long as the encoder may use it */
+    if( id->enc_vctx_in )
+        vlc_video_context_Release( id->enc_vctx_in );
+    id->enc_vctx_in = vctx ? vlc_video_context_Hold( vctx ) : NULL;
+    transcode_encoder_video_set_vctx_in( id->encoder, id->enc_vctx_in );
+}
+
 static int transcode_video_filters_init( sout_stream_t *p_stream,
                                          const sout_filters_config_t *p_cfg,
                                          const es_format_t *p_src,
@@ -285,6 +370,11 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     if( !id->p_f_chain )
         return VLC_EGENERIC;
     filter_chain_Reset( id->p_f_chain, p_src, src_ctx, p_src );
+    filter_chain_SetPipeline( id->p_f_chain, p_cfg->video.i_pipeline,
+                              TRANSCODE_FILTER_PIPELINE_DEPTH );
+
+    const es_format_t *p_dec_out = p_src;
+    vlc_video_context *dec_ctx = src_ctx;
 
     /* Deinterlace */
     if( p_cfg->video.psz_deinterlace != NULL )
@@ -320,13 +410,22 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
         if(!id->p_uf_chain)
             return VLC_EGENERIC;
         filter_chain_Reset( id->p_uf_chain, p_src, src_ctx, p_dst );
+        filter_chain_SetPipeline( id->p_uf_chain, p_cfg->video.i_pipeline,
+                                  TRANSCODE_FILTER_PIPELINE_DEPTH );
         filter_chain_AppendFromString( id->p_uf_chain, p_cfg->psz_filters );
         p_src = filter_chain_GetFmtOut( id->p_uf_chain );
+        src_ctx = filter_chain_GetVideoCtxOut( id->p_uf_chain );
         debug_format( p_stream, p_src );
     }
 
+    if( p_src != p_dec_out )
+        transcode_video_check_readback( p_stream, "video filters",
+                                        p_dec_out, dec_ctx, p_src, src_ctx );
+
     /* Update encoder so it matches filters output */
     transcode_encoder_update_format_in( id->encoder, p_src, id->p_enccfg );
+    if( !transcode_encoder_opened( id->encoder ) )
+        transcode_video_set_encoder_vctx( id, src_ctx );
 
     /* SPU Sources */
     if( p_cfg->video.psz_spu_sources )
@@ -338,8 +437,256 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+static block_t *transcode_rung_encode( transcode_rung_t *rung, picture_t *p_pic )
+{
+    block_t *p_out = NULL;
+
+    for( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+    {
+        if( rung->p_conv )
+            p_in = filter_chain_VideoFilter( rung->p_conv, p_in );
+        if( !p_in )
+            break;
+        block_ChainAppend( &p_out, transcode_encoder_encode( rung->encoder, p_in ) );
+        picture_Release( p_in );
+    }
+    return p_out;
+}
+
+static void *transcode_rung_thread( void *data )
+{
+    transcode_rung_t *rung = data;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &rung->lock );
+    for( ;; )
+    {
+        picture_t *p_pic = picture_fifo_Pop( rung->pics );
+        if( p_pic == NULL )
+        {
+            if( rung->b_abort )
+                break;
+            vlc_cond_wait( &rung->wait, &rung->lock );
+            continue;
+        }
+        vlc_sem_post( &rung->room );
+
+        /* release lock while encoding */
+        vlc_mutex_unlock( &rung->lock );
+        block_t *p_block = transcode_rung_encode( rung, p_pic );
+        vlc_mutex_lock( &rung->lock );
+
+        block_ChainLastAppend( &rung->pp_out_last, p_block );
+    }
+    vlc_mutex_unlock( &rung->lock );
+
+    /* Flush the encoder */
+    block_t *p_block = NULL;
+    transcode_encoder_drain( rung->encoder, &p_block );
+
+    vlc_mutex_lock( &rung->lock );
+    block_ChainLastAppend( &rung->pp_out_last, p_block );
+    vlc_mutex_unlock( &rung->lock );
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+static void transcode_rung_send( sout_stream_t *p_stream, transcode_rung_t *rung )
+{
+    vlc_mutex_lock( &rung->lock );
+    block_t *p_out = rung->p_out;
+    rung->p_out = NULL;
+    rung->pp_out_last = &rung->p_out;
+    vlc_mutex_unlock( &rung->lock );
+
+    if( p_out )
+        sout_StreamIdSend( p_stream->p_next, rung->downstream_id, p_out );
+}
+
+static void transcode_rung_push( transcode_rung_t *rung, picture_t *p_pic )
+{
+    /* Picture fifos chain their pictures, each rendition needs its own
+     * picture_t referencing the shared pixels */
+    picture_t *p_clone = picture_Clone( p_pic );
+    if( unlikely(p_clone == NULL) )
+        return;
+
+    vlc_sem_wait( &rung->room );
+    vlc_mutex_lock( &rung->lock );
+    picture_fifo_Push( rung->pics, p_clone );
+    vlc_cond_signal( &rung->wait );
+    vlc_mutex_unlock( &rung->lock );
+}
+
+static void transcode_rung_stop( sout_stream_t *p_stream, transcode_rung_t *rung )
+{
+    if( rung->b_running )
+    {
+        vlc_mutex_lock( &rung->lock );
+        rung->b_abort = true;
+        vlc_cond_signal( &rung->wait );
+        vlc_mutex_unlock( &rung->lock );
+        vlc_join( rung->thread, NULL );
+        rung->b_running = false;
+
+        transcode_rung_send( p_stream, rung );
+    }
+
+    if( rung->encoder )
+    {
+        transcode_encoder_close( rung->encoder );
+        transcode_encoder_delete( rung->encoder );
+        rung->encoder = NULL;
+    }
+    transcode_remove_filters( &rung->p_conv );
+    if( rung->pics )
+    {
+        picture_fifo_Delete( rung->pics );
+        rung->pics = NULL;
+    }
+}
+
+static int transcode_rung_start( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                                 transcode_rung_t *rung, const es_format_t *p_src )
+{
+    const transcode_encoder_config_t *p_cfg = rung->p_enccfg;
+
+    struct encoder_owner *p_owner =
+        (struct encoder_owner *)sout_EncoderCreate( p_stream, sizeof(*p_owner) );
+    if( unlikely(p_owner == NULL) )
+        return VLC_ENOMEM;
+    p_owner->id = id;
+    p_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    rung->encoder = transcode_encoder_new( &p_owner->enc, p_src );
+    if( !rung->encoder )
+        return VLC_ENOMEM;
+
+    transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                       &id->p_decoder->fmt_out.video, p_cfg,
+                                       &p_src->video, id->enc_vctx_in,
+                                       rung->encoder );
+    if( transcode_encoder_open( rung->encoder, p_cfg ) != VLC_SUCCESS )
+    {
+        msg_Err( p_stream, "cannot open ladder encoder %ux%u",
+                 p_cfg->video.i_width, p_cfg->video.i_height );
+        goto error;
+    }
+
+    const es_format_t *p_enc_in = transcode_encoder_format_in( rung->encoder );
+    if( p_enc_in->video.i_chroma != p_src->video.i_chroma ||
+        p_enc_in->video.i_width  != p_src->video.i_width ||
+        p_enc_in->video.i_height != p_src->video.i_height ||
+        p_enc_in->video.i_visible_width  != p_src->video.i_visible_width ||
+        p_enc_in->video.i_visible_height != p_src->video.i_visible_height )
+    {
+        rung->p_conv = filter_chain_NewVideo( p_stream, false, NULL );
+        if( !rung->p_conv )
+            goto error;
+        filter_chain_Reset( rung->p_conv, p_src, id->enc_vctx_in, p_enc_in );
+        if( filter_chain_AppendConverter( rung->p_conv, NULL ) != VLC_SUCCESS )
+        {
+            msg_Err( p_stream, "cannot convert %4.4s %ux%u to ladder input %4.4s %ux%u",
+                     (const char *)&p_src->video.i_chroma,
+                     p_src->video.i_visible_width, p_src->video.i_visible_height,
+                     (const char *)&p_enc_in->video.i_chroma,
+                     p_enc_in->video.i_visible_width, p_enc_in->video.i_visible_height );
+            goto error;
+        }
+        transcode_video_check_readback( p_stream, "ladder scaler",
+                                        p_src, id->enc_vctx_in, p_enc_in,
+                                        filter_chain_GetVideoCtxOut( rung->p_conv ) );
+    }
+
+    if( !rung->downstream_id )
+    {
+        es_format_t fmt;
+        es_format_Copy( &fmt, transcode_encoder_format_out( rung->encoder ) );
+        /* Let the next stream pick an ES ID for each rendition */
+        fmt.i_id = -1;
+        fmt.i_group = id->p_decoder->fmt_in.i_group;
+        rung->downstream_id = sout_StreamIdAdd( p_stream->p_next, &fmt );
+        es_format_Clean( &fmt );
+        if( !rung->downstream_id )
+        {
+            msg_Err( p_stream, "cannot output ladder rendition %4.4s %ux%u",
+                     (const char *)&p_cfg->i_codec,
+                     p_cfg->video.i_width, p_cfg->video.i_height );
+            goto error;
+        }
+    }
+
+    rung->pics = picture_fifo_New();
+    if( !rung->pics )
+        goto error;
+    vlc_sem_init( &rung->room, p_cfg->video.threads.pool_size );
+    rung->b_abort = false;
+
+    if( vlc_clone( &rung->thread, transcode_rung_thread, rung,
+                   p_cfg->video.threads.i_priority ) )
+        goto error;
+    rung->b_running = true;
+
+    msg_Dbg( p_stream, "ladder rendition %ux%u started",
+             p_enc_in->video.i_visible_width, p_enc_in->video.i_visible_height );
+    return VLC_SUCCESS;
+
+error:
+    transcode_rung_stop( p_stream, rung );
+    return VLC_EGENERIC;
+}
+
+/* Filtered pictures fed to the main encoder converter and to the ladder */
+static const es_format_t *transcode_video_filters_fmt_out( const sout_stream_id_sys_t *id )
 {
+    if( id->p_uf_chain )
+        return filter_chain_GetFmtOut( id->p_uf_chain );
+    return filter_chain_GetFmtOut( id->p_f_chain );
+}
+
+static void transcode_video_ladder_start( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+    {
+        transcode_rung_t *rung = &id->p_rungs[i];
+        if( !rung->b_running &&
+            transcode_rung_start( p_stream, id, rung,
+                                  transcode_video_filters_fmt_out( id ) ) != VLC_SUCCESS )
+            msg_Warn( p_stream, "ladder rendition %ux%u disabled",
+                      rung->p_enccfg->video.i_width, rung->p_enccfg->video.i_height );
+    }
+}
+
+static void transcode_video_ladder_stop( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+        transcode_rung_stop( p_stream, &id->p_rungs[i] );
+}
+
+static void transcode_video_ladder_push( sout_stream_id_sys_t *id, picture_t *p_pic )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+        if( id->p_rungs[i].b_running )
+            transcode_rung_push( &id->p_rungs[i], p_pic );
+}
+
+static void transcode_video_ladder_send( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+        if( id->p_rungs[i].b_running )
+            transcode_rung_send( p_stream, &id->p_rungs[i] );
+}
+
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    /* Close ladder renditions */
+    transcode_video_ladder_stop( p_stream, id );
+    for( size_t i = 0; i < id->i_rungs; i++ )
+        if( id->p_rungs[i].downstream_id )
+            sout_StreamIdDel( p_stream->p_next, id->p_rungs[i].downstream_id );
+    free( id->p_rungs );
+
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
@@ -354,6 +701,8 @@ void transcode_video_clean( sout_stream_id_sys_t *id )
         filter_DeleteBlend( id->p_spu_blender );
     if( id->p_spu )
         spu_Destroy( id->p_spu );
+    if( id->enc_vctx_in )
+        vlc_video_context_Release( id->enc_vctx_in );
     if ( id->dec_dev )
         vlc_decoder_device_Release( id->dec_dev );
 }
@@ -405,11 +754,12 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     /* Overlay subpicture */
     if( p_subpic )
     {
-        if( filter_chain_IsEmpty( id->p_f_chain ) )
+        if( filter_chain_IsEmpty( id->p_f_chain ) || id->i_rungs > 0 )
         {
             /* We can't modify the picture, we need to duplicate it,
                  * in this point the picture is already p_encoder->fmt.in format*/
-            picture_t *p_tmp = video_new_buffer_encoder( id->encoder );
+            picture_t *p_tmp = video_new_buffer_encoder( VLC_OBJECT(id->p_decoder),
+                                                         id->encoder );
             if( likely( p_tmp ) )
             {
                 picture_Copy( p_tmp, p_pic );
@@ -440,6 +790,76 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+/* Run the user filters and the output chain on a picture (or NULL to drain
+ * them) and encode the resulting pictures. */
+static void transcode_video_encode_filtered( sout_stream_id_sys_t *id,
+                                             picture_t *p_in, block_t **out )
+{
+    for ( ;; p_in = NULL /* drain second time */ )
+    {
+        /* Run user specified filter chain */
+        if( id->p_uf_chain )
+            p_in = filter_chain_VideoFilter( id->p_uf_chain, p_in );
+
+        /* Share the filtered pictures with the ladder renditions */
+        if( p_in )
+            transcode_video_ladder_push( id, p_in );
+
+        if( p_in && id->p_final_conv_static )
+            p_in = filter_chain_VideoFilter( id->p_final_conv_static, p_in );
+
+        if( !p_in )
+            break;
+
+        /* Blend subpictures */
+        p_in = RenderSubpictures( id, p_in );
+
+        if( p_in )
+        {
+            block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
+            if( p_encoded )
+                block_ChainAppend( out, p_encoded );
+            picture_Release( p_in );
+        }
+    }
+}
+
+/* Run the filter and output chains; first with the picture,
+ * and then with NULL as many times as we need until they
+ * stop outputting frames.
+ */
+static void transcode_video_filter( sout_stream_id_sys_t *id,
+                                    picture_t *p_pic, block_t **out )
+{
+    for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+    {
+        /* Run filter chain */
+        if( id->p_f_chain )
+            p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
+
+        if( !p_in )
+            break;
+
+        transcode_video_encode_filtered( id, p_in, out );
+    }
+}
+
+/* Encode the pictures still in the pipelined filter chains */
+static void transcode_video_filters_drain( sout_stream_id_sys_t *id,
+                                           block_t **out )
+{
+    if( id->p_f_chain )
+    {
+        filter_chain_VideoDrain( id->p_f_chain );
+        transcode_video_filter( id, NULL, out );
+    }
+    if( id->p_uf_chain )
+    {
+        filter_chain_VideoDrain( id->p_uf_chain );
+        transcode_video_encode_filtered( id, NULL, out );
+    }
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -483,6 +903,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                             id->decoder_out.video.i_sar_num, p_pic->format.i_sar_num,
                             id->decoder_out.video.i_sar_den, p_pic->format.i_sar_den
                         );
+                /* Encode the pictures filtered with the previous format */
+                transcode_video_filters_drain( id, out );
+                /* Renditions are restarted with the new filters output */
+                transcode_video_ladder_stop( p_stream, id );
                 /* Close filters, encoder format input can't change */
                 transcode_remove_filters( &id->p_f_chain );
                 transcode_remove_filters( &id->p_uf_chain );
@@ -537,9 +961,15 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                 id->decoder_out.video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
                 id->decoder_out.video.i_visible_height != encoder_fmt_in->video.i_visible_height )
             {
+                /* Give the converter access to the decoder device so that
+                 * GPU scalers and GPU uploads are possible */
+                filter_owner_t owner = {
+                    .video = &transcode_filter_video_cbs,
+                    .sys = id,
+                };
                 if ( !id->p_final_conv_static )
                     id->p_final_conv_static =
-                        filter_chain_NewVideo( p_stream, false, NULL );
+                        filter_chain_NewVideo( p_stream, false, &owner );
 
                 const es_format_t *p_fmt_filtered = &filter_fmt_out;
                 es_format_t tmpdst;
@@ -553,10 +983,18 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
                 filter_chain_Reset( id->p_final_conv_static,
                                     &id->decoder_out,
-                                    picture_GetVideoContext(p_pic),
+                                    id->enc_vctx_in,
                                     encoder_fmt_in );
-                filter_chain_AppendConverter( id->p_final_conv_static, NULL );
+                if( filter_chain_AppendConverter( id->p_final_conv_static,
+                                                  NULL ) == VLC_SUCCESS )
+                    transcode_video_check_readback( p_stream,
+                        "encoder input conversion",
+                        &id->decoder_out, id->enc_vctx_in, encoder_fmt_in,
+                        filter_chain_GetVideoCtxOut( id->p_final_conv_static ) );
             }
+            else if( id->enc_vctx_in )
+                msg_Dbg( p_stream, "encoder takes %4.4s GPU frames without copy",
+                         (const char *)&encoder_fmt_in->video.i_chroma );
             es_format_Clean(&filter_fmt_out);
 
             msg_Dbg( p_stream, "destination (after video filters) %ux%u",
@@ -574,55 +1012,20 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
-        }
 
-        /* Run the filter and output chains; first with the picture,
-         * and then with NULL as many times as we need until they
-         * stop outputting frames.
-         */
-        for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
-        {
-            /* Run filter chain */
-            if( id->p_f_chain )
-                p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
-
-            if( !p_in )
-                break;
-
-            for ( ;; p_in = NULL /* drain second time */ )
-            {
-                /* Run user specified filter chain */
-                filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                        id->p_final_conv_static };
-                for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
-                {
-                    if( !secondary_chains[i] )
-                        continue;
-                    p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
-                }
-
-                if( !p_in )
-                    break;
-
-                /* Blend subpictures */
-                p_in = RenderSubpictures( id, p_in );
-
-                if( p_in )
-                {
-                    block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                    if( p_encoded )
-                        block_ChainAppend( out, p_encoded );
-                    picture_Release( p_in );
-                }
-            }
+            transcode_video_ladder_start( p_stream, id );
         }
 
+        transcode_video_filter( id, p_pic, out );
+
         if( b_eos )
         {
             msg_Info( p_stream, "Drain/restart on EOS" );
+            transcode_video_filters_drain( id, out );
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
             transcode_encoder_close( id->encoder );
+            transcode_video_ladder_stop( p_stream, id );
             /* Close filters */
             transcode_remove_filters( &id->p_f_chain );
             transcode_remove_filters( &id->p_uf_chain );
@@ -644,15 +1047,20 @@ error:
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
     }
 
+    transcode_video_ladder_send( p_stream, id );
+
     /* Drain encoder */
     if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
     {
         msg_Dbg( p_stream, "Flushing thread and waiting that");
+        transcode_video_filters_drain( id, out );
         if( transcode_encoder_drain( id->encoder, out ) == VLC_SUCCESS )
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
     }
+    if( in == NULL )
+        transcode_video_ladder_stop( p_stream, id );
 
     if( b_eos )
         tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
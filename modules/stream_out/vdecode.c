@@ -0,0 +1,227 @@
+/*****************************************************************************
+ * vdecode.c: stream output decoding video frames for the LibVLC application
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <limits.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+#include <vlc_sout.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_media_player.h>
+
+/* NOTE: the callback prototype must match that of LibVLC */
+typedef void (*vlc_vframe_output_cb)(libvlc_video_frame_cb, void *,
+                                     picture_t *, int, vlc_fourcc_t,
+                                     const libvlc_video_frame_plane_t *,
+                                     unsigned, void *, uintptr_t);
+
+typedef struct
+{
+    vlc_vframe_output_cb output;
+    libvlc_video_frame_cb cb;
+    void *opaque;
+    unsigned step;
+    bool keyframes;
+} sout_stream_sys_t;
+
+typedef struct
+{
+    decoder_t dec;
+    sout_stream_sys_t *sys;
+    unsigned count;
+    bool error;
+} sout_stream_id_sys_t;
+
+static int FormatUpdate(decoder_t *dec, vlc_video_context *vctx)
+{
+    (void) dec; (void) vctx;
+    return 0;
+}
+
+static vlc_decoder_device *GetDevice(decoder_t *dec)
+{
+    (void) dec;
+    return NULL; /* frames are handed out in system memory */
+}
+
+static void Queue(decoder_t *dec, picture_t *pic)
+{
+    sout_stream_id_sys_t *id = container_of(dec, sout_stream_id_sys_t, dec);
+    sout_stream_sys_t *sys = id->sys;
+
+    if (id->count++ % sys->step == 0)
+    {
+        libvlc_video_frame_plane_t planes[PICTURE_PLANE_MAX];
+
+        for (int i = 0; i < pic->i_planes; i++)
+            planes[i] = (libvlc_video_frame_plane_t) {
+                .data = pic->p[i].p_pixels,
+                .fd = -1,
+                .pitch = pic->p[i].i_pitch,
+                .lines = pic->p[i].i_visible_lines,
+            };
+
+        sys->output(sys->cb, sys->opaque, pic, libvlc_video_frame_cpu,
+                    pic->format.i_chroma, planes, pic->i_planes, NULL, 0);
+    }
+    picture_Release(pic);
+}
+
+static void *Add(sout_stream_t *stream, const es_format_t *fmt)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    if (fmt->i_cat != VIDEO_ES)
+        return NULL;
+
+    sout_stream_id_sys_t *id = vlc_object_create(stream, sizeof (*id));
+    if (unlikely(id == NULL))
+        return NULL;
+
+    static const struct decoder_owner_callbacks dec_cbs =
+    {
+        .video = {
+            .get_device = GetDevice,
+            .format_update = FormatUpdate,
+            .queue = Queue,
+        },
+    };
+
+    id->sys = sys;
+    id->count = 0;
+    id->error = false;
+    decoder_Init(&id->dec, fmt);
+    id->dec.cbs = &dec_cbs;
+    id->dec.p_module = module_need_var(&id->dec, "video decoder", "codec");
+    if (id->dec.p_module == NULL)
+    {
+        msg_Err(stream, "cannot find video decoder for %4.4s",
+                (const char *)&fmt->i_codec);
+        decoder_Destroy(&id->dec);
+        return NULL;
+    }
+    return id;
+}
+
+static void Del(sout_stream_t *stream, void *opaque)
+{
+    sout_stream_id_sys_t *id = opaque;
+
+    /* Drain the last frames */
+    if (!id->error)
+        id->dec.pf_decode(&id->dec, NULL);
+    decoder_Destroy(&id->dec);
+    (void) stream;
+}
+
+static int Send(sout_stream_t *stream, void *opaque, block_t *chain)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+    sout_stream_id_sys_t *id = opaque;
+
+    while (chain != NULL)
+    {
+        block_t *block = chain;
+
+        chain = block->p_next;
+        block->p_next = NULL;
+
+        /* Only intra frames can be decoded without their references */
+        if (id->error
+         || (sys->keyframes && !(block->i_flags & BLOCK_FLAG_TYPE_I)))
+        {
+            block_Release(block);
+            continue;
+        }
+        if (id->dec.pf_decode(&id->dec, block) != VLCDEC_SUCCESS)
+        {
+            msg_Err(stream, "decoding error");
+            id->error = true;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static void Flush(sout_stream_t *stream, void *opaque)
+{
+    sout_stream_id_sys_t *id = opaque;
+
+    if (id->dec.pf_flush != NULL)
+        id->dec.pf_flush(&id->dec);
+    (void) stream;
+}
+
+static const struct sout_stream_operations ops = {
+    Add, Del, Send, NULL, Flush,
+};
+
+static int Open(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    sout_stream_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->output = var_InheritAddress(stream, "vframe-output");
+    sys->cb = var_InheritAddress(stream, "vframe-cb");
+    sys->opaque = var_InheritAddress(stream, "vframe-data");
+    if (sys->output == NULL || sys->cb == NULL)
+    {
+        msg_Err(stream, "frame callback not set");
+        return VLC_EGENERIC;
+    }
+
+    int64_t step = var_InheritInteger(stream, "vdecode-step");
+    sys->step = (step > 1 && step <= UINT_MAX) ? step : 1;
+    sys->keyframes = var_InheritBool(stream, "vdecode-keyframes");
+
+    if (sys->keyframes)
+    {
+        /* Let libavcodec skip the non-key frames that slip through */
+        var_Create(stream, "avcodec-skip-frame", VLC_VAR_INTEGER);
+        var_SetInteger(stream, "avcodec-skip-frame", 3);
+    }
+
+    stream->p_sys = sys;
+    stream->ops = &ops;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_shortname(N_("Video decode"))
+    set_description(N_("Decoded video frames to LibVLC"))
+    set_capability("sout output", 0)
+    add_shortcut("vdecode")
+    set_category(CAT_SOUT)
+    set_subcategory(SUBCAT_SOUT_STREAM)
+    set_callback(Open)
+vlc_module_end()
@@ -1229,6 +1229,12 @@ static int Create( filter_t *p_filter )
     if( !p_sys->ftcache )
         goto error;
 
+#ifdef HAVE_HARFBUZZ
+    p_sys->shaped_runs = ShapedRunsCacheNew();
+    if( !p_sys->shaped_runs )
+        goto error;
+#endif
+
     p_sys->i_scale = 100;
 
     /* default style to apply to uncomplete segmeents styles */
@@ -1295,6 +1301,9 @@ static void Destroy( filter_t *p_filter )
         DumpFamilies( p_sys->fs );
 #endif
 
+    if( p_sys->shaped_runs )
+        vlc_lru_Release( p_sys->shaped_runs );
+
     if( p_sys->ftcache )
         vlc_ftcache_Delete( p_sys->ftcache );
 
@@ -73,6 +73,7 @@ typedef uint32_t uni_char_t;
 #endif
 
 #include "ftcache.h"
+#include "lru.h"
 
 typedef struct vlc_font_select_t vlc_font_select_t;
 
@@ -112,6 +113,7 @@ typedef struct
 
     vlc_font_select_t *fs;
     vlc_ftcache_t     *ftcache;
+    vlc_lru           *shaped_runs;    /* HarfBuzz buffers, see text_layout.c */
 
 } filter_sys_t;
 
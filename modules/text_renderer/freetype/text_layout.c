@@ -41,6 +41,7 @@
 #include <vlc_common.h>
 #include <vlc_filter.h>
 #include <vlc_text_style.h>
+#include <vlc_memstream.h>
 
 /* Freetype */
 #include <ft2build.h>
@@ -92,6 +93,9 @@
 # warning YOU ARE MISSING FONTS FALLBACK. TEXT WILL BE INCORRECT
 #endif
 
+/* Number of shaped runs kept around */
+#define SHAPED_RUNS_CACHE_SIZE 256
+
 /**
  * Within a paragraph, run_desc_t represents a run of characters
  * having the same font face, size, and style, Unicode script
@@ -679,6 +683,42 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
 }
 
 #ifdef HAVE_HARFBUZZ
+static void ShapedRunRelease( void *priv, void *value )
+{
+    VLC_UNUSED(priv);
+    hb_buffer_destroy( value );
+}
+
+vlc_lru *ShapedRunsCacheNew( void )
+{
+    return vlc_lru_New( SHAPED_RUNS_CACHE_SIZE, ShapedRunRelease, NULL );
+}
+
+/**
+ * The shaping of a run only depends on its face, size, direction, script
+ * and code points: colors and other rendering styles (e.g. karaoke) do not
+ * split runs, so the same shaped runs come back frame after frame.
+ */
+static char *ShapedRunKey( const paragraph_t *p_paragraph, const run_desc_t *p_run,
+                           const vlc_face_id_t *p_faceid,
+                           const vlc_ftcache_metrics_t *p_metrics )
+{
+    struct vlc_memstream stream;
+    if( vlc_memstream_open( &stream ) )
+        return NULL;
+
+    vlc_memstream_printf( &stream, "%s#%u#%d,%d#%d,%x#",
+                          p_faceid->psz_filename, p_faceid->idx,
+                          p_metrics->width_px, p_metrics->height_px,
+                          (int) p_run->direction, (unsigned) p_run->script );
+    for( int i = p_run->i_start_offset; i < p_run->i_end_offset; ++i )
+        vlc_memstream_printf( &stream, "%x,", (unsigned) p_paragraph->p_code_points[i] );
+
+    if( vlc_memstream_close( &stream ) )
+        return NULL;
+    return stream.ptr;
+}
+
 /**
  * Shape an itemized paragraph using HarfBuzz.
  * This is where the glyphs of complex scripts get their positions
@@ -741,33 +781,53 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
         if(!p_face)
             goto error;
 
-        hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_hb_font )
+        char *psz_key = ShapedRunKey( p_paragraph, p_run, p_faceid, &metrics );
+        if( psz_key && p_sys->shaped_runs )
         {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
-            goto error;
+            hb_buffer_t *p_cached = vlc_lru_Get( p_sys->shaped_runs, psz_key );
+            if( p_cached )
+                p_run->p_buffer = hb_buffer_reference( p_cached );
         }
 
-        p_run->p_buffer = hb_buffer_create();
         if( !p_run->p_buffer )
         {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
-            hb_font_destroy( p_hb_font );
-            goto error;
-        }
+            hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
+            if( !p_hb_font )
+            {
+                msg_Err( p_filter,
+                         "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+                free( psz_key );
+                goto error;
+            }
+
+            p_run->p_buffer = hb_buffer_create();
+            if( !p_run->p_buffer )
+            {
+                msg_Err( p_filter,
+                         "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
+                hb_font_destroy( p_hb_font );
+                free( psz_key );
+                goto error;
+            }
+
+            hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
+            hb_buffer_set_script( p_run->p_buffer, p_run->script );
+            hb_buffer_add_utf32( p_run->p_buffer,
+                                 p_paragraph->p_code_points + p_run->i_start_offset,
+                                 p_run->i_end_offset - p_run->i_start_offset, 0,
+                                 p_run->i_end_offset - p_run->i_start_offset );
+            hb_shape( p_hb_font, p_run->p_buffer, 0, 0 );
 
-        hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
-        hb_buffer_set_script( p_run->p_buffer, p_run->script );
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-        hb_shape( p_hb_font, p_run->p_buffer, 0, 0 );
+            hb_font_destroy( p_hb_font );
+            p_hb_font = 0;
 
-        hb_font_destroy( p_hb_font );
-        p_hb_font = 0;
+            /* the buffer is only read from now on, and can be shared */
+            if( psz_key && p_sys->shaped_runs &&
+                hb_buffer_get_length( p_run->p_buffer ) > 0 )
+                vlc_lru_Insert( p_sys->shaped_runs, psz_key,
+                                hb_buffer_reference( p_run->p_buffer ) );
+        }
+        free( psz_key );
 
         const unsigned length = hb_buffer_get_length( p_run->p_buffer );
         if( length == 0 )
@@ -105,3 +105,11 @@ typedef struct
  */
 int LayoutTextBlock( filter_t *p_filter, const layout_text_block_t *p_textblock,
                      line_desc_t **pp_lines, FT_BBox *p_bbox, int *pi_max_face_height );
+
+#ifdef HAVE_HARFBUZZ
+/**
+ * Creates the cache of the shaped runs, to be set as the shaped_runs of the
+ * filter_sys_t, and released with vlc_lru_Release().
+ */
+vlc_lru *ShapedRunsCacheNew( void );
+#endif
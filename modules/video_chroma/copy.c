@@ -132,6 +132,256 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSE2() (0)
 #endif
 
+#ifdef CAN_COMPILE_AVX2
+/* Copy 32/128 bytes from srcp to dstp with the AVX2 instructions load and
+ * store. Only the 256-bit integer shifts require AVX2, plain moves would also
+ * work with AVX.
+ */
+
+#define COPY32_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n"
+#define COPY32_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n"
+
+#define COPY32_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "  0(%[src]), %%ymm1\n"    \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "xmm1")
+
+#define COPY128_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n" \
+    "vpsrlw "x", %%ymm2, %%ymm2\n" \
+    "vpsrlw "x", %%ymm3, %%ymm3\n" \
+    "vpsrlw "x", %%ymm4, %%ymm4\n"
+#define COPY128_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n" \
+    "vpsllw "x", %%ymm2, %%ymm2\n" \
+    "vpsllw "x", %%ymm3, %%ymm3\n" \
+    "vpsllw "x", %%ymm4, %%ymm4\n"
+
+#define COPY128_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "  0(%[src]), %%ymm1\n"    \
+        load " 32(%[src]), %%ymm2\n"    \
+        load " 64(%[src]), %%ymm3\n"    \
+        load " 96(%[src]), %%ymm4\n"    \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        store " %%ymm2,   32(%[dst])\n" \
+        store " %%ymm3,   64(%[dst])\n" \
+        store " %%ymm4,   96(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "xmm1", "xmm2", "xmm3", "xmm4")
+
+#define COPY128(dstp, srcp, load, store) \
+    COPY128_S(dstp, srcp, load, store, "")
+
+#ifdef COPY_TEST_NOOPTIM
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+#endif
+
+/* AVX2 variant of CopyFromUswc(): vmovntdqa on 256-bit registers halves the
+ * number of streaming loads needed to drain a write-combining surface. */
+VLC_AVX
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    asm volatile ("mfence");
+
+#define AVX2_USWC_COPY(shiftstr32, shiftstr128) \
+    for (unsigned y = 0; y < height; y++) { \
+        unsigned x = 0; \
+        if (width >= 32) { \
+            const unsigned unaligned = (-(uintptr_t)src) & 0x1f; \
+            if (unaligned) { \
+                COPY32_S(dst, src, "vmovdqu", "vmovdqu", shiftstr32); \
+                x = unaligned; \
+            } \
+            for (; x+127 < width; x += 128) \
+                COPY128_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr128); \
+            for (; x+31 < width; x += 32) \
+                COPY32_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr32); \
+        } \
+        if (x < width) { \
+            asm volatile ("vzeroupper"); \
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift); \
+        } \
+        src += src_pitch; \
+        dst += dst_pitch; \
+    }
+
+    switch (bitshift)
+    {
+        case 0:
+            AVX2_USWC_COPY("", "")
+            break;
+        case -6:
+            AVX2_USWC_COPY(COPY32_SHIFTL("$6"), COPY128_SHIFTL("$6"))
+            break;
+        case 6:
+            AVX2_USWC_COPY(COPY32_SHIFTR("$6"), COPY128_SHIFTR("$6"))
+            break;
+        case 2:
+            AVX2_USWC_COPY(COPY32_SHIFTR("$2"), COPY128_SHIFTR("$2"))
+            break;
+        case -2:
+            AVX2_USWC_COPY(COPY32_SHIFTL("$2"), COPY128_SHIFTL("$2"))
+            break;
+        case 4:
+            AVX2_USWC_COPY(COPY32_SHIFTR("$4"), COPY128_SHIFTR("$4"))
+            break;
+        case -4:
+            AVX2_USWC_COPY(COPY32_SHIFTL("$4"), COPY128_SHIFTL("$4"))
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+#undef AVX2_USWC_COPY
+
+    asm volatile ("mfence\n"
+                  "vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_Copy2d(uint8_t *dst, size_t dst_pitch,
+                        const uint8_t *src, size_t src_pitch,
+                        unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        bool unaligned = ((intptr_t)dst & 0x1f) != 0;
+        if (!unaligned) {
+            for (; x+127 < width; x += 128)
+                COPY128(&dst[x], &src[x], "vmovdqu", "vmovntdq");
+        } else {
+            for (; x+127 < width; x += 128)
+                COPY128(&dst[x], &src[x], "vmovdqu", "vmovdqu");
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                              uint8_t *srcu, size_t srcu_pitch,
+                              uint8_t *srcv, size_t srcv_pitch,
+                              unsigned int width, unsigned int height,
+                              uint8_t pixel_size)
+{
+    /* The unpack instructions work within each 128-bit lane, the two
+     * vperm2i128 put the four interleaved halves back in order. */
+#define INTERLEAVE64(unpckl, unpckh) \
+    asm volatile (                                          \
+        "vmovdqu      (%[src1]), %%ymm0\n"                  \
+        "vmovdqu      (%[src2]), %%ymm1\n"                  \
+        unpckl "      %%ymm1, %%ymm0, %%ymm2\n"             \
+        unpckh "      %%ymm1, %%ymm0, %%ymm3\n"             \
+        "vperm2i128 $0x20, %%ymm3, %%ymm2, %%ymm0\n"        \
+        "vperm2i128 $0x31, %%ymm3, %%ymm2, %%ymm1\n"        \
+        "vmovdqu      %%ymm0, 0x00(%[dst])\n"               \
+        "vmovdqu      %%ymm1, 0x20(%[dst])\n"               \
+        : : [dst]"r"(dst+2*x), [src1]"r"(srcu+x), [src2]"r"(srcv+x) \
+        : "memory", "xmm0", "xmm1", "xmm2", "xmm3")
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        unsigned int x = 0;
+
+        if (pixel_size == 1)
+        {
+            for (; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklbw", "vpunpckhbw");
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            for (; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklwd", "vpunpckhwd");
+            for (; x < width; x+= 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+#undef INTERLEAVE64
+    asm volatile ("vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height, uint8_t pixel_size)
+{
+    static const uint8_t shuffle_8[] = { 0, 2, 4, 6, 8, 10, 12, 14,
+                                         1, 3, 5, 7, 9, 11, 13, 15 };
+    static const uint8_t shuffle_16[] = {  0,  1,  4,  5,  8,  9, 12, 13,
+                                           2,  3,  6,  7, 10, 11, 14, 15 };
+    const uint8_t *shuffle = pixel_size == 1 ? shuffle_8 : shuffle_16;
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+        /* Each lane is shuffled into its U and V quadwords, vpermq gathers
+         * the U (resp. V) quadwords in the low (resp. high) lane and
+         * vperm2i128 merges the two source registers. */
+        for (; x < (width & ~31); x += 32) {
+            asm volatile (
+                "vbroadcasti128 (%[shuffle]), %%ymm7\n"
+                "vmovdqu     0(%[src]), %%ymm0\n"
+                "vmovdqu    32(%[src]), %%ymm1\n"
+                "vpshufb    %%ymm7, %%ymm0, %%ymm0\n"
+                "vpshufb    %%ymm7, %%ymm1, %%ymm1\n"
+                "vpermq     $0xd8, %%ymm0, %%ymm0\n"
+                "vpermq     $0xd8, %%ymm1, %%ymm1\n"
+                "vperm2i128 $0x20, %%ymm1, %%ymm0, %%ymm2\n"
+                "vperm2i128 $0x31, %%ymm1, %%ymm0, %%ymm3\n"
+                "vmovdqu    %%ymm2, (%[dst1])\n"
+                "vmovdqu    %%ymm3, (%[dst2])\n"
+                : : [dst1]"r"(&dstu[x]), [dst2]"r"(&dstv[x]), [src]"r"(&src[2*x]), [shuffle]"r"(shuffle) : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7");
+        }
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+#undef COPY128
+#endif /* CAN_COMPILE_AVX2 */
+
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
  * as used by some video surface.
  * XXX It is really efficient only when SSE4.1 is available.
@@ -143,6 +393,12 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)dst & 0x0f) == 0 && (dst_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_CopyFromUswc(dst, dst_pitch, src, src_pitch,
+                                 width, height, bitshift);
+#endif
+
     asm volatile ("mfence");
 
 #define SSE_USWC_COPY(shiftstr16, shiftstr64) \
@@ -196,7 +452,7 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
             SSE_USWC_COPY(COPY16_SHIFTR("$4"), COPY64_SHIFTR("$4"))
             break;
         case -4:
-            SSE_USWC_COPY(COPY16_SHIFTL("$2"), COPY64_SHIFTL("$2"))
+            SSE_USWC_COPY(COPY16_SHIFTL("$4"), COPY64_SHIFTL("$4"))
             break;
         default:
             vlc_assert_unreachable();
@@ -213,6 +469,11 @@ static void Copy2d(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)src & 0x0f) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_Copy2d(dst, dst_pitch, src, src_pitch, width, height);
+#endif
+
     for (unsigned y = 0; y < height; y++) {
         unsigned x = 0;
 
@@ -243,6 +504,12 @@ SSE_InterleaveUV(uint8_t *dst, size_t dst_pitch,
     assert(!((intptr_t)srcu & 0xf) && !(srcu_pitch & 0x0f) &&
            !((intptr_t)srcv & 0xf) && !(srcv_pitch & 0x0f));
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_InterleaveUV(dst, dst_pitch, srcu, srcu_pitch,
+                                 srcv, srcv_pitch, width, height, pixel_size);
+#endif
+
     static const uint8_t shuffle_8[] = { 0, 8,
                                          1, 9,
                                          2, 10,
@@ -358,6 +625,12 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
     assert(pixel_size == 1 || pixel_size == 2);
     assert(((intptr_t)src & 0xf) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                            src, src_pitch, width, height, pixel_size);
+#endif
+
 #define LOAD64 \
     "movdqa  0(%[src]), %%xmm0\n" \
     "movdqa 16(%[src]), %%xmm1\n" \
@@ -609,6 +882,193 @@ static void SSE_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #undef COPY64
 #endif /* CAN_COMPILE_SSE2 */
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# define COPY_NEON
+# include <arm_neon.h>
+
+# ifdef COPY_TEST_NOOPTIM
+#  undef vlc_CPU_ARM_NEON
+#  define vlc_CPU_ARM_NEON() (0)
+# endif
+
+/* There is no USWC surface to drain on ARM, frames are read back from
+ * cacheable memory, so the NEON paths work directly on the pictures without
+ * going through the copy cache. */
+
+static void NEON_CopyPlane16(uint8_t *dst, size_t dst_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned height, int bitshift)
+{
+    const size_t copy_pitch = __MIN(src_pitch, dst_pitch) / 2;
+    /* vshlq_u16() shifts right for negative counts */
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+
+    for (unsigned y = 0; y < height; y++) {
+        uint16_t *dst16 = (uint16_t *) dst;
+        const uint16_t *src16 = (const uint16_t *) src;
+        size_t x = 0;
+
+        for (; x + 8 <= copy_pitch; x += 8)
+            vst1q_u16(&dst16[x], vshlq_u16(vld1q_u16(&src16[x]), shift));
+        for (; x < copy_pitch; x++)
+            dst16[x] = bitshift > 0 ? src16[x] >> (bitshift & 0xf)
+                                    : src16[x] << ((-bitshift) & 0xf);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+static void NEON_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
+                             uint8_t *dstv, size_t dstv_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned height, uint8_t pixel_size, int bitshift)
+{
+    if (pixel_size == 1)
+    {
+        const size_t copy_pitch =
+            __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
+
+        for (unsigned y = 0; y < height; y++) {
+            size_t x = 0;
+            for (; x + 16 <= copy_pitch; x += 16) {
+                const uint8x16x2_t uv = vld2q_u8(&src[2*x]);
+                vst1q_u8(&dstu[x], uv.val[0]);
+                vst1q_u8(&dstv[x], uv.val[1]);
+            }
+            for (; x < copy_pitch; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+            src  += src_pitch;
+            dstu += dstu_pitch;
+            dstv += dstv_pitch;
+        }
+    }
+    else
+    {
+        const size_t copy_pitch =
+            __MIN(__MIN(src_pitch / 4, dstu_pitch), dstv_pitch);
+        const int16x8_t shift = vdupq_n_s16(-bitshift);
+
+        for (unsigned y = 0; y < height; y++) {
+            const uint16_t *src16 = (const uint16_t *) src;
+            uint16_t *dstu16 = (uint16_t *) dstu;
+            uint16_t *dstv16 = (uint16_t *) dstv;
+            size_t x = 0;
+            for (; x + 8 <= copy_pitch; x += 8) {
+                const uint16x8x2_t uv = vld2q_u16(&src16[2*x]);
+                vst1q_u16(&dstu16[x], vshlq_u16(uv.val[0], shift));
+                vst1q_u16(&dstv16[x], vshlq_u16(uv.val[1], shift));
+            }
+            for (; x < copy_pitch; x++) {
+                if (bitshift >= 0) {
+                    dstu16[x] = src16[2*x+0] >> (bitshift & 0xf);
+                    dstv16[x] = src16[2*x+1] >> (bitshift & 0xf);
+                } else {
+                    dstu16[x] = src16[2*x+0] << ((-bitshift) & 0xf);
+                    dstv16[x] = src16[2*x+1] << ((-bitshift) & 0xf);
+                }
+            }
+            src  += src_pitch;
+            dstu += dstu_pitch;
+            dstv += dstv_pitch;
+        }
+    }
+}
+
+static void NEON_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *srcu, size_t srcu_pitch,
+                                  const uint8_t *srcv, size_t srcv_pitch,
+                                  unsigned height, uint8_t pixel_size,
+                                  int bitshift)
+{
+    if (pixel_size == 1)
+    {
+        const size_t copy_pitch = __MIN(srcu_pitch, dst_pitch / 2);
+
+        for (unsigned y = 0; y < height; y++) {
+            size_t x = 0;
+            for (; x + 16 <= copy_pitch; x += 16) {
+                const uint8x16x2_t uv = { { vld1q_u8(&srcu[x]),
+                                            vld1q_u8(&srcv[x]) } };
+                vst2q_u8(&dst[2*x], uv);
+            }
+            for (; x < copy_pitch; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+            srcu += srcu_pitch;
+            srcv += srcv_pitch;
+            dst  += dst_pitch;
+        }
+    }
+    else
+    {
+        const size_t copy_pitch = srcu_pitch / 2;
+        const int16x8_t shift = vdupq_n_s16(-bitshift);
+
+        for (unsigned y = 0; y < height; y++) {
+            const uint16_t *srcu16 = (const uint16_t *) srcu;
+            const uint16_t *srcv16 = (const uint16_t *) srcv;
+            uint16_t *dst16 = (uint16_t *) dst;
+            size_t x = 0;
+            for (; x + 8 <= copy_pitch; x += 8) {
+                const uint16x8x2_t uv = { {
+                    vshlq_u16(vld1q_u16(&srcu16[x]), shift),
+                    vshlq_u16(vld1q_u16(&srcv16[x]), shift) } };
+                vst2q_u16(&dst16[2*x], uv);
+            }
+            for (; x < copy_pitch; x++) {
+                if (bitshift >= 0) {
+                    dst16[2*x+0] = srcu16[x] >> (bitshift & 0xf);
+                    dst16[2*x+1] = srcv16[x] >> (bitshift & 0xf);
+                } else {
+                    dst16[2*x+0] = srcu16[x] << ((-bitshift) & 0xf);
+                    dst16[2*x+1] = srcv16[x] << ((-bitshift) & 0xf);
+                }
+            }
+            srcu += srcu_pitch;
+            srcv += srcv_pitch;
+            dst  += dst_pitch;
+        }
+    }
+}
+
+static void NEON_Copy420_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
+                                 const size_t src_pitch[static 2],
+                                 unsigned height, uint8_t pixel_size,
+                                 int bitshift)
+{
+    if (bitshift != 0)
+        NEON_CopyPlane16(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                         src[0], src_pitch[0], height, bitshift);
+    else
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+    NEON_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                     dst->p[2].p_pixels, dst->p[2].i_pitch,
+                     src[1], src_pitch[1], (height+1) / 2,
+                     pixel_size, bitshift);
+}
+
+static void NEON_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
+                                 const size_t src_pitch[static 3],
+                                 unsigned height, uint8_t pixel_size,
+                                 int bitshift)
+{
+    if (bitshift != 0)
+        NEON_CopyPlane16(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                         src[0], src_pitch[0], height, bitshift);
+    else
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+    NEON_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                          src[U_PLANE], src_pitch[U_PLANE],
+                          src[V_PLANE], src_pitch[V_PLANE],
+                          (height+1) / 2, pixel_size, bitshift);
+}
+#endif /* __aarch64__ && __ARM_NEON */
+
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift)
@@ -747,6 +1207,10 @@ void Copy420_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 #else
     VLC_UNUSED(cache);
 #endif
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_Copy420_SP_to_P(dst, src, src_pitch, height, 1, 0);
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
@@ -768,6 +1232,10 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 #else
     VLC_UNUSED(cache);
 #endif
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_Copy420_SP_to_P(dst, src, src_pitch, height, 2, bitshift);
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, bitshift);
@@ -823,6 +1291,10 @@ void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #else
     (void) cache;
 #endif
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_Copy420_P_to_SP(dst, src, src_pitch, height, 1, 0);
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
@@ -854,6 +1326,10 @@ void Copy420_16_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #else
     (void) cache;
 #endif
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_Copy420_P_to_SP(dst, src, src_pitch, height, 2, bitshift);
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, bitshift);
@@ -1102,9 +1578,54 @@ static picture_t *pic_new_unaligned(const video_format_t *fmt)
     return picture_NewFromResource(fmt, &rsc);
 }
 
-int main(void)
+static void convert(const struct test_dst *test_dst, picture_t *dst,
+                    const uint8_t *src_planes[static 3],
+                    const size_t src_pitches[static 3], unsigned height,
+                    const copy_cache_t *cache)
 {
-    alarm(10);
+    if (test_dst->bitshift == 0)
+        test_dst->conv(dst, src_planes, src_pitches, height, cache);
+    else
+        test_dst->conv16(dst, src_planes, src_pitches, height,
+                         test_dst->bitshift, cache);
+}
+
+/* Run with --bench to print the throughput of each conversion, e.g. to
+ * compare chroma_copy_sse_test with the plain C chroma_copy_test. */
+#define BENCH_DURATION VLC_TICK_FROM_MS(200)
+
+static void bench(const struct test_dst *test_dst, picture_t *dst,
+                  const picture_t *src, const uint8_t *src_planes[static 3],
+                  const size_t src_pitches[static 3],
+                  const copy_cache_t *cache)
+{
+    size_t frame_size = 0;
+    for (int i = 0; i < src->i_planes; i++)
+        frame_size += src->p[i].i_pitch * src->p[i].i_visible_lines;
+
+    unsigned count = 0;
+    const vlc_tick_t start = vlc_tick_now();
+    vlc_tick_t elapsed;
+    do
+    {
+        convert(test_dst, dst, src_planes, src_pitches,
+                src->format.i_visible_height, cache);
+        count++;
+        elapsed = vlc_tick_now() - start;
+    } while (elapsed < BENCH_DURATION);
+
+    fprintf(stderr, "    %u frames, %.3f ms/frame, %.1f MiB/s\n", count,
+            (double) elapsed / (count * VLC_TICK_FROM_MS(1)),
+            (double) frame_size * count / (1024 * 1024)
+                / secf_from_vlc_tick(elapsed));
+}
+
+int main(int argc, char *argv[])
+{
+    const bool benchmark = argc > 1 && !strcmp(argv[1], "--bench");
+
+    if (!benchmark)
+        alarm(10);
 
 #ifndef COPY_TEST_NOOPTIM
     if (!vlc_CPU_SSE2())
@@ -1164,14 +1685,11 @@ int main(void)
                         size->i_visible_width, size->i_visible_height,
                         (const char *) &src->format.i_chroma,
                         (const char *) &dst->format.i_chroma);
-                if (test_dst->bitshift == 0)
-                    test_dst->conv(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, &cache);
-                else
-                    test_dst->conv16(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, test_dst->bitshift,
-                                   &cache);
+                convert(test_dst, dst, src_planes, src_pitches,
+                        src->format.i_visible_height, &cache);
                 piccheck(dst, dst_dsc, false);
+                if (benchmark)
+                    bench(test_dst, dst, src, src_planes, src_pitches, &cache);
                 picture_Release(dst);
             }
             picture_Release(src);
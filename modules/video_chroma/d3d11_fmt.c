@@ -301,6 +301,10 @@ typedef struct {
 
     d3d11_handle_t                      hd3d;
     d3d11_decoder_device_t              dec_device;
+
+    /* decoder texture kept for the next decoder using the same device */
+    vlc_mutex_t                         cache_lock;
+    ID3D11Texture2D                     *cached_texture;
 } d3d11_decoder_device;
 
 static int D3D11_Create(vlc_object_t *obj, d3d11_handle_t *hd3d)
@@ -352,6 +356,11 @@ void D3D11_ReleaseDevice(d3d11_decoder_device_t *dev_sys)
 {
     d3d11_decoder_device *sys = container_of(dev_sys, d3d11_decoder_device, dec_device);
     d3d11_device_t *d3d_dev = &dev_sys->d3d_dev;
+    if (sys->cached_texture)
+    {
+        ID3D11Texture2D_Release(sys->cached_texture);
+        sys->cached_texture = NULL;
+    }
     if (d3d_dev->d3dcontext)
     {
         ID3D11DeviceContext_Flush(d3d_dev->d3dcontext);
@@ -538,6 +547,8 @@ d3d11_decoder_device_t *(D3D11_CreateDevice)(vlc_object_t *obj,
     }
 
     sys->external.cleanupDeviceCb = NULL;
+    vlc_mutex_init(&sys->cache_lock);
+    sys->cached_texture = NULL;
     HRESULT hr = E_FAIL;
 #ifdef VLC_WINSTORE_APP
     /* LEGACY, the d3dcontext and swapchain were given by the host app */
@@ -611,6 +622,50 @@ error:
     return &sys->dec_device;
 }
 
+ID3D11Texture2D *D3D11_GetCachedTexture(d3d11_decoder_device_t *dev_sys,
+                                        const D3D11_TEXTURE2D_DESC *desc)
+{
+    d3d11_decoder_device *sys = container_of(dev_sys, d3d11_decoder_device, dec_device);
+    ID3D11Texture2D *texture = NULL;
+
+    vlc_mutex_lock(&sys->cache_lock);
+    if (sys->cached_texture)
+    {
+        D3D11_TEXTURE2D_DESC cachedDesc;
+        ID3D11Texture2D_GetDesc(sys->cached_texture, &cachedDesc);
+        if (cachedDesc.Width     == desc->Width &&
+            cachedDesc.Height    == desc->Height &&
+            cachedDesc.Format    == desc->Format &&
+            cachedDesc.MipLevels == desc->MipLevels &&
+            cachedDesc.Usage     == desc->Usage &&
+            cachedDesc.BindFlags == desc->BindFlags &&
+            cachedDesc.MiscFlags == desc->MiscFlags &&
+            cachedDesc.CPUAccessFlags == desc->CPUAccessFlags &&
+            cachedDesc.ArraySize >= desc->ArraySize)
+        {
+            texture = sys->cached_texture;
+            sys->cached_texture = NULL;
+        }
+    }
+    vlc_mutex_unlock(&sys->cache_lock);
+
+    return texture;
+}
+
+void D3D11_CacheTexture(d3d11_decoder_device_t *dev_sys, ID3D11Texture2D *texture)
+{
+    d3d11_decoder_device *sys = container_of(dev_sys, d3d11_decoder_device, dec_device);
+
+    ID3D11Texture2D_AddRef(texture);
+    vlc_mutex_lock(&sys->cache_lock);
+    ID3D11Texture2D *old = sys->cached_texture;
+    sys->cached_texture = texture;
+    vlc_mutex_unlock(&sys->cache_lock);
+
+    if (old)
+        ID3D11Texture2D_Release(old);
+}
+
 IDXGIAdapter *D3D11DeviceAdapter(ID3D11Device *d3ddev)
 {
     IDXGIDevice *pDXGIDevice = NULL;
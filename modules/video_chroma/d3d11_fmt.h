@@ -153,6 +153,21 @@ void D3D11_ReleaseDevice(d3d11_decoder_device_t *);
 
 void D3D11_LogResources(d3d11_decoder_device_t *);
 
+/**
+ * Take the texture cached on the device if it matches the description.
+ *
+ * The cached texture may have more slices than requested.
+ * \return the texture to release by the caller or NULL
+ */
+ID3D11Texture2D *D3D11_GetCachedTexture(d3d11_decoder_device_t *,
+                                        const D3D11_TEXTURE2D_DESC *);
+/**
+ * Keep a reference to the texture for the next D3D11_GetCachedTexture() call.
+ *
+ * A texture previously cached is released.
+ */
+void D3D11_CacheTexture(d3d11_decoder_device_t *, ID3D11Texture2D *);
+
 bool isXboxHardware(const d3d11_device_t *);
 IDXGIAdapter *D3D11DeviceAdapter(ID3D11Device *d3ddev);
 int D3D11CheckDriverVersion(const d3d11_device_t *, UINT vendorId,
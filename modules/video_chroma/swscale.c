@@ -37,6 +37,7 @@
 
 #include <libswscale/swscale.h>
 #include <libswscale/version.h>
+#include <libavutil/opt.h>
 
 #ifdef __APPLE__
 # include <TargetConditionals.h>
@@ -57,6 +58,11 @@ static void CloseScaler( filter_t * );
 #define SCALEMODE_TEXT N_("Scaling mode")
 #define SCALEMODE_LONGTEXT NULL
 
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_( "Number of threads used to scale the slices " \
+    "of each picture (0=automatic based on the picture size and the " \
+    "number of CPUs, 1=single-threaded)." )
+
 static const int pi_mode_values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
 static const char *const ppsz_mode_descriptions[] =
 { N_("Fast bilinear"), N_("Bilinear"), N_("Bicubic (good quality)"),
@@ -72,6 +78,8 @@ vlc_module_begin ()
     set_callback_video_converter( OpenScaler, 150 )
     add_integer( "swscale-mode", 2, SCALEMODE_TEXT, SCALEMODE_LONGTEXT )
         change_integer_list( pi_mode_values, ppsz_mode_descriptions )
+    add_integer( "swscale-threads", 0, THREADS_TEXT, THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
 vlc_module_end ()
 
 /* Version checking */
@@ -86,6 +94,7 @@ typedef struct
 {
     SwsFilter *p_filter;
     int i_sws_flags;
+    int i_threads;
 
     video_format_t fmt_in;
     video_format_t fmt_out;
@@ -226,6 +235,7 @@ static int OpenScaler( filter_t *p_filter )
     case 10: p_sys->i_sws_flags = SWS_SPLINE; break;
     default: p_sys->i_sws_flags = SWS_BICUBIC; i_sws_mode = 2; break;
     }
+    p_sys->i_threads = var_InheritInteger( p_filter, "swscale-threads" );
 
     /* Misc init */
     memset( &p_sys->fmt_in,  0, sizeof(p_sys->fmt_in) );
@@ -375,6 +385,53 @@ static int GetParameters( ScalerConfiguration *p_cfg,
     return VLC_SUCCESS;
 }
 
+/* Below this height per thread, the slices are not worth the
+ * synchronization */
+#define THREAD_MIN_HEIGHT (256)
+
+static struct SwsContext *GetContext( filter_t *p_filter,
+                                      int i_wi, int i_hi, int i_fmti,
+                                      int i_wo, int i_ho, int i_fmto,
+                                      int i_sws_flags )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+    /* The threaded contexts scale the slices of the picture in parallel */
+    int i_threads = p_sys->i_threads;
+    if( i_threads == 0 )
+        i_threads = __MIN( (int)vlc_GetCPUCount(),
+                           __MAX( i_hi, i_ho ) / THREAD_MIN_HEIGHT );
+
+    if( i_threads > 1 )
+    {
+        struct SwsContext *ctx = sws_alloc_context();
+        if( ctx == NULL )
+            return NULL;
+
+        av_opt_set_int( ctx, "srcw", i_wi, 0 );
+        av_opt_set_int( ctx, "srch", i_hi, 0 );
+        av_opt_set_int( ctx, "src_format", i_fmti, 0 );
+        av_opt_set_int( ctx, "dstw", i_wo, 0 );
+        av_opt_set_int( ctx, "dsth", i_ho, 0 );
+        av_opt_set_int( ctx, "dst_format", i_fmto, 0 );
+        av_opt_set_int( ctx, "sws_flags", i_sws_flags, 0 );
+        av_opt_set_int( ctx, "threads", i_threads, 0 );
+
+        if( sws_init_context( ctx, p_sys->p_filter, NULL ) >= 0 )
+        {
+            msg_Dbg( p_filter, "scaling with %d threads", i_threads );
+            return ctx;
+        }
+        sws_freeContext( ctx );
+        msg_Warn( p_filter, "cannot scale with threads" );
+    }
+#endif
+
+    return sws_getContext( i_wi, i_hi, i_fmti, i_wo, i_ho, i_fmto,
+                           i_sws_flags, p_sys->p_filter, NULL, 0 );
+}
+
 static int Init( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -429,10 +486,10 @@ static int Init( filter_t *p_filter )
         const int i_fmto = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8;
         struct SwsContext *ctx;
 
-        ctx = sws_getContext( i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
-                              i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
-                              cfg.i_sws_flags,
-                              p_sys->p_filter, NULL, 0 );
+        ctx = GetContext( p_filter,
+                          i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
+                          i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
+                          cfg.i_sws_flags );
         if( n == 0 )
             p_sys->ctx = ctx;
         else
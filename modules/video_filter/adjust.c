@@ -241,6 +241,146 @@ static void Destroy( filter_t *p_filter )
                      &p_sys->b_brightness_threshold );
 }
 
+/*****************************************************************************
+ * Planar YUV slices
+ *****************************************************************************/
+static void AdjustLuma( const int *pi_luma, const plane_t *p_in_plane,
+                        plane_t *p_out_plane )
+{
+    uint8_t *p_in, *p_in_end, *p_line_end;
+    uint8_t *p_out;
+    p_in = p_in_plane->p_pixels;
+    p_in_end = p_in + p_in_plane->i_visible_lines
+             * p_in_plane->i_pitch - 8;
+
+    p_out = p_out_plane->p_pixels;
+
+    for( ; p_in < p_in_end ; )
+    {
+        p_line_end = p_in + p_in_plane->i_visible_pitch - 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            /* Do 8 pixels at a time */
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_line_end += 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_in += p_in_plane->i_pitch
+              - p_in_plane->i_visible_pitch;
+        p_out += p_out_plane->i_pitch
+               - p_out_plane->i_visible_pitch;
+    }
+}
+
+static void AdjustLuma16( const int *pi_luma, const plane_t *p_in_plane,
+                          plane_t *p_out_plane )
+{
+    uint16_t *p_in, *p_in_end, *p_line_end;
+    uint16_t *p_out;
+    p_in = (uint16_t *) p_in_plane->p_pixels;
+    p_in_end = p_in + p_in_plane->i_visible_lines
+        * (p_in_plane->i_pitch >> 1) - 8;
+
+    p_out = (uint16_t *) p_out_plane->p_pixels;
+
+    for( ; p_in < p_in_end ; )
+    {
+        p_line_end = p_in + (p_in_plane->i_visible_pitch >> 1) - 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            /* Do 8 pixels at a time */
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_line_end += 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_in += (p_in_plane->i_pitch >> 1)
+            - (p_in_plane->i_visible_pitch >> 1);
+        p_out += (p_out_plane->i_pitch >> 1)
+            - (p_out_plane->i_visible_pitch >> 1);
+    }
+}
+
+/* Restricts the planes of a picture to the lines of one slice */
+static void GetSlicePicture( picture_t *p_slice, const picture_t *p_pic,
+                             unsigned i_slice, unsigned i_count )
+{
+    p_slice->format = p_pic->format;
+    p_slice->i_planes = p_pic->i_planes;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        int i_begin, i_end;
+
+        filter_GetSliceLines( p_pic->p[i].i_visible_lines, i_slice, i_count,
+                              &i_begin, &i_end );
+        p_slice->p[i] = p_pic->p[i];
+        p_slice->p[i].p_pixels += i_begin * p_pic->p[i].i_pitch;
+        p_slice->p[i].i_lines = i_end - i_begin;
+        p_slice->p[i].i_visible_lines = i_end - i_begin;
+    }
+}
+
+struct adjust_slices
+{
+    filter_sys_t *p_sys;
+    picture_t *p_pic;
+    picture_t *p_outpic;
+    const int *pi_luma;
+    bool b_16bit;
+    bool b_clip;
+    int i_sin, i_cos, i_sat, i_x, i_y;
+};
+
+static void AdjustSlice( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct adjust_slices *slices = opaque;
+    filter_sys_t *p_sys = slices->p_sys;
+    picture_t in, out;
+
+    GetSlicePicture( &in, slices->p_pic, i_slice, i_count );
+    GetSlicePicture( &out, slices->p_outpic, i_slice, i_count );
+
+    if( in.p[Y_PLANE].i_visible_lines > 0 )
+    {
+        if( slices->b_16bit )
+            AdjustLuma16( slices->pi_luma, &in.p[Y_PLANE], &out.p[Y_PLANE] );
+        else
+            AdjustLuma( slices->pi_luma, &in.p[Y_PLANE], &out.p[Y_PLANE] );
+    }
+
+    if( in.p[U_PLANE].i_visible_lines == 0 )
+        return;
+
+    /* Currently no errors are implemented in the functions, if any are added
+     * check them here */
+    if( slices->b_clip )
+        p_sys->pf_process_sat_hue_clip( &in, &out, slices->i_sin,
+                                        slices->i_cos, slices->i_sat,
+                                        slices->i_x, slices->i_y );
+    else
+        p_sys->pf_process_sat_hue( &in, &out, slices->i_sin, slices->i_cos,
+                                   slices->i_sat, slices->i_x, slices->i_y );
+}
+
 /*****************************************************************************
  * Run the filter on a Planar YUV picture
  *****************************************************************************/
@@ -323,83 +463,7 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
     }
 
     /*
-     * Do the Y plane
-     */
-    if ( b_16bit )
-    {
-        uint16_t *p_in, *p_in_end, *p_line_end;
-        uint16_t *p_out;
-        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
-
-        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
-                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
-            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
-                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
-        }
-    }
-    else
-    {
-        uint8_t *p_in, *p_in_end, *p_line_end;
-        uint8_t *p_out;
-        p_in = p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                 * p_pic->p[Y_PLANE].i_pitch - 8;
-
-        p_out = p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += p_pic->p[Y_PLANE].i_pitch
-                  - p_pic->p[Y_PLANE].i_visible_pitch;
-            p_out += p_outpic->p[Y_PLANE].i_pitch
-                   - p_outpic->p[Y_PLANE].i_visible_pitch;
-        }
-    }
-
-    /*
-     * Do the U and V planes
+     * Do the U and V planes parameters
      */
 
     int i_sin = sinf(f_hue) * f_max;
@@ -409,20 +473,23 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
     int i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
     int i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
 
-    if ( i_sat > i_range )
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
-    else
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
+    struct adjust_slices slices = {
+        .p_sys = p_sys,
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+        .pi_luma = pi_luma,
+        .b_16bit = b_16bit,
+        .b_clip = i_sat > i_range,
+        .i_sin = i_sin,
+        .i_cos = i_cos,
+        .i_sat = i_sat,
+        .i_x = i_x,
+        .i_y = i_y,
+    };
+
+    /* Keep at least 16 luma lines per slice */
+    filter_ExecuteSlices( p_filter, p_pic->p[Y_PLANE].i_visible_lines / 16,
+                          AdjustSlice, &slices );
 }
 
 /*****************************************************************************
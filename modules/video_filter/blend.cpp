@@ -32,6 +32,7 @@
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 #include "filter_picture.h"
+#include "blend_kernels.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -79,6 +80,18 @@ public:
     {
         return fmt;
     }
+    const picture_t *getPicture() const
+    {
+        return picture;
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
     bool isFull(unsigned) const
     {
         return true;
@@ -560,6 +573,108 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+/* Same output as Blend<>, row by row with the vectorized kernels, or false
+ * if the pictures layout is not handled */
+typedef bool (*blend_rows_function_t)(const blend_kernels_t *kernels,
+                                      const CPicture &dst_data, const CPicture &src_data,
+                                      unsigned width, unsigned height, int alpha);
+
+static inline const uint8_t *GetSourceLine(const CPicture &src_data,
+                                           unsigned plane, unsigned y)
+{
+    const plane_t *p = &src_data.getPicture()->p[plane];
+    return &p->p_pixels[(src_data.getY() + y) * p->i_pitch];
+}
+
+static inline uint8_t *GetDestLine(const CPicture &dst_data,
+                                   unsigned plane, unsigned y, unsigned ry)
+{
+    const plane_t *p = &dst_data.getPicture()->p[plane];
+    return &p->p_pixels[(dst_data.getY() + y) / ry * p->i_pitch];
+}
+
+/* The subsampled chroma is merged from the pixels of the even columns of
+ * the even lines, as for the generic blending */
+template <bool swap_uv>
+bool BlendRowsYUVAToI420(const blend_kernels_t *k,
+                         const CPicture &dst_data, const CPicture &src_data,
+                         unsigned width, unsigned height, int alpha)
+{
+    const unsigned dx = dst_data.getX();
+    const unsigned sx = src_data.getX();
+    const unsigned cx = dx % 2;
+    const unsigned ccount = (width - cx + 1) / 2;
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *sa = &GetSourceLine(src_data, A_PLANE, y)[sx];
+
+        k->plane(&GetDestLine(dst_data, Y_PLANE, y, 1)[dx],
+                 &GetSourceLine(src_data, Y_PLANE, y)[sx], sa, alpha, width);
+
+        if ((dst_data.getY() + y) % 2 == 0 && ccount > 0) {
+            k->plane_sub2(&GetDestLine(dst_data, swap_uv ? V_PLANE : U_PLANE, y, 2)[(dx + cx) / 2],
+                          &GetSourceLine(src_data, U_PLANE, y)[sx + cx], &sa[cx],
+                          alpha, ccount);
+            k->plane_sub2(&GetDestLine(dst_data, swap_uv ? U_PLANE : V_PLANE, y, 2)[(dx + cx) / 2],
+                          &GetSourceLine(src_data, V_PLANE, y)[sx + cx], &sa[cx],
+                          alpha, ccount);
+        }
+    }
+    return true;
+}
+
+template <bool swap_uv>
+bool BlendRowsYUVAToNV12(const blend_kernels_t *k,
+                         const CPicture &dst_data, const CPicture &src_data,
+                         unsigned width, unsigned height, int alpha)
+{
+    const unsigned dx = dst_data.getX();
+    const unsigned sx = src_data.getX();
+    const unsigned cx = dx % 2;
+    const unsigned ccount = (width - cx + 1) / 2;
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *sa = &GetSourceLine(src_data, A_PLANE, y)[sx];
+
+        k->plane(&GetDestLine(dst_data, Y_PLANE, y, 1)[dx],
+                 &GetSourceLine(src_data, Y_PLANE, y)[sx], sa, alpha, width);
+
+        if ((dst_data.getY() + y) % 2 == 0 && ccount > 0) {
+            const uint8_t *su = &GetSourceLine(src_data, U_PLANE, y)[sx + cx];
+            const uint8_t *sv = &GetSourceLine(src_data, V_PLANE, y)[sx + cx];
+            k->uv_sub2(&GetDestLine(dst_data, 1, y, 2)[(dx + cx) / 2 * 2],
+                       swap_uv ? sv : su, swap_uv ? su : sv, &sa[cx],
+                       alpha, ccount);
+        }
+    }
+    return true;
+}
+
+static bool BlendRowsRGBAToRGB32(const blend_kernels_t *k,
+                                 const CPicture &dst_data, const CPicture &src_data,
+                                 unsigned width, unsigned height, int alpha)
+{
+    int offset_r, offset_g, offset_b;
+    if (GetPackedRgbIndexes(dst_data.getFormat(),
+                            &offset_r, &offset_g, &offset_b) != VLC_SUCCESS ||
+        offset_g != 1)
+        return false;
+
+    bool swap_rb;
+    if (offset_r == 0 && offset_b == 2)
+        swap_rb = false;
+    else if (offset_r == 2 && offset_b == 0)
+        swap_rb = true;
+    else
+        return false;
+
+    for (unsigned y = 0; y < height; y++)
+        k->rgbx(&GetDestLine(dst_data, 0, y, 1)[dst_data.getX() * 4],
+                &GetSourceLine(src_data, 0, y)[src_data.getX() * 4],
+                alpha, width, swap_rb);
+    return true;
+}
+
 namespace {
 
 static const struct {
@@ -636,11 +751,27 @@ static const struct {
 #undef YUV
 };
 
+static const struct {
+    vlc_fourcc_t          dst;
+    vlc_fourcc_t          src;
+    blend_rows_function_t blend;
+} blends_rows[] = {
+    { VLC_CODEC_I420,  VLC_CODEC_YUVA, BlendRowsYUVAToI420<false> },
+    { VLC_CODEC_J420,  VLC_CODEC_YUVA, BlendRowsYUVAToI420<false> },
+    { VLC_CODEC_YV12,  VLC_CODEC_YUVA, BlendRowsYUVAToI420<true> },
+    { VLC_CODEC_NV12,  VLC_CODEC_YUVA, BlendRowsYUVAToNV12<false> },
+    { VLC_CODEC_NV21,  VLC_CODEC_YUVA, BlendRowsYUVAToNV12<true> },
+    { VLC_CODEC_RGB32, VLC_CODEC_RGBA, BlendRowsRGBAToRGB32 },
+};
+
 struct filter_sys_t {
-    filter_sys_t() : blend(NULL)
+    filter_sys_t() : blend(NULL), blend_rows(NULL)
     {
+        blend_kernels_Init(&kernels);
     }
     blend_function_t blend;
+    blend_rows_function_t blend_rows;
+    blend_kernels_t kernels;
 };
 
 } // namespace
@@ -670,13 +801,17 @@ static void DoBlend(filter_t *filter,
     video_format_FixRgb(&filter->fmt_out.video);
     video_format_FixRgb(&filter->fmt_in.video);
 
-    sys->blend(CPicture(dst, &filter->fmt_out.video,
-                        filter->fmt_out.video.i_x_offset + x_offset,
-                        filter->fmt_out.video.i_y_offset + y_offset),
-               CPicture(src, &filter->fmt_in.video,
-                        filter->fmt_in.video.i_x_offset,
-                        filter->fmt_in.video.i_y_offset),
-               width, height, alpha);
+    const CPicture dst_data(dst, &filter->fmt_out.video,
+                            filter->fmt_out.video.i_x_offset + x_offset,
+                            filter->fmt_out.video.i_y_offset + y_offset);
+    const CPicture src_data(src, &filter->fmt_in.video,
+                            filter->fmt_in.video.i_x_offset,
+                            filter->fmt_in.video.i_y_offset);
+
+    if (sys->blend_rows &&
+        sys->blend_rows(&sys->kernels, dst_data, src_data, width, height, alpha))
+        return;
+    sys->blend(dst_data, src_data, width, height, alpha);
 }
 
 static const struct FilterOperationInitializer {
@@ -699,6 +834,11 @@ static int Open(filter_t *filter)
             sys->blend = blends[i].blend;
     }
 
+    for (size_t i = 0; i < sizeof(blends_rows) / sizeof(*blends_rows); i++) {
+        if (blends_rows[i].src == src && blends_rows[i].dst == dst)
+            sys->blend_rows = blends_rows[i].blend;
+    }
+
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
                (char *)&src, (char *)&dst);
@@ -706,6 +846,9 @@ static int Open(filter_t *filter)
         return VLC_EGENERIC;
     }
 
+    if (sys->blend_rows)
+        msg_Dbg(filter, "using %s blending kernels", sys->kernels.name);
+
     filter->ops = &filter_ops.ops;
     filter->p_sys          = sys;
     return VLC_SUCCESS;
@@ -0,0 +1,236 @@
+/*****************************************************************************
+ * blend_kernels.c: vectorized alpha blending rows
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "blend_kernels.h"
+
+/*****************************************************************************
+ * C, also handling the remainder of the vectorized rows
+ *****************************************************************************/
+static inline unsigned div255( unsigned v )
+{
+    /* same as blend.cpp */
+    return ((v >> 8) + v + 1) >> 8;
+}
+
+static inline void merge( uint8_t *dst, unsigned src, unsigned a )
+{
+    *dst = div255( (255 - a) * *dst + src * a );
+}
+
+static void blend_plane_c( uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                           unsigned alpha, unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+        merge( &dst[i], src[i], div255( alpha * a[i] ) );
+}
+
+static void blend_plane_sub2_c( uint8_t *dst, const uint8_t *src,
+                                const uint8_t *a, unsigned alpha,
+                                unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+        merge( &dst[i], src[2*i], div255( alpha * a[2*i] ) );
+}
+
+static void blend_uv_sub2_c( uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                             const uint8_t *a, unsigned alpha, unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+    {
+        const unsigned pa = div255( alpha * a[2*i] );
+        merge( &dst[2*i+0], u[2*i], pa );
+        merge( &dst[2*i+1], v[2*i], pa );
+    }
+}
+
+static void blend_rgbx_c( uint8_t *dst, const uint8_t *src, unsigned alpha,
+                          unsigned count, bool swap_rb )
+{
+    for( unsigned i = 0; i < count; i++ )
+    {
+        const uint8_t *s = &src[4*i];
+        uint8_t *d = &dst[4*i];
+        const unsigned pa = div255( alpha * s[3] );
+        merge( &d[0], s[swap_rb ? 2 : 0], pa );
+        merge( &d[1], s[1], pa );
+        merge( &d[2], s[swap_rb ? 0 : 2], pa );
+    }
+}
+
+/* the 16 bits lanes are loaded and stored as little endian */
+#ifndef WORDS_BIGENDIAN
+
+/*****************************************************************************
+ * SSE2
+ *****************************************************************************/
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_SSE2_INTRINSICS
+#  include <emmintrin.h>
+#  define CAN_COMPILE_BLEND_SSE2 1
+#  define BK_WORD           __m128i
+#  define BK_LANES          8
+#  define BK_LOAD8(p)       _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)(p) ), \
+                                               _mm_setzero_si128() )
+#  define BK_STORE8(p, w)   _mm_storel_epi64( (__m128i *)(p), _mm_packus_epi16( w, w ) )
+#  define BK_LOAD16(p)      _mm_loadu_si128( (const __m128i *)(p) )
+#  define BK_STORE16(p, w)  _mm_storeu_si128( (__m128i *)(p), w )
+#  define BK_SET1(x)        _mm_set1_epi16( x )
+#  define BK_ADD(a, b)      _mm_add_epi16( a, b )
+#  define BK_SUB(a, b)      _mm_sub_epi16( a, b )
+#  define BK_MUL(a, b)      _mm_mullo_epi16( a, b )
+#  define BK_AND(a, b)      _mm_and_si128( a, b )
+#  define BK_OR(a, b)       _mm_or_si128( a, b )
+#  define BK_SRL8(w)        _mm_srli_epi16( w, 8 )
+#  define BK_SLL8(w)        _mm_slli_epi16( w, 8 )
+#  define BK_ALPHA4(w)      _mm_shufflehi_epi16( _mm_shufflelo_epi16( w, 0xff ), 0xff )
+#  define BK_SWAP4(w)       _mm_shufflehi_epi16( _mm_shufflelo_epi16( w, \
+                                _MM_SHUFFLE(3, 0, 1, 2) ), _MM_SHUFFLE(3, 0, 1, 2) )
+#  define BK_MASK_RGB       _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 )
+#  define BK_FUNC(name)     name##_sse2
+#  define BK_ATTR           __attribute__((__target__("sse2")))
+#  include "blend_kernels_simd.h"
+# endif
+
+/*****************************************************************************
+ * AVX2
+ *****************************************************************************/
+# ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#  define CAN_COMPILE_BLEND_AVX2 1
+#  define BK_WORD           __m256i
+#  define BK_LANES          16
+#  define BK_LOAD8(p)       _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)(p) ) )
+/* packus works within the 128 bits halves */
+#  define BK_STORE8(p, w)   _mm_storeu_si128( (__m128i *)(p), _mm256_castsi256_si128( \
+                                _mm256_permute4x64_epi64( _mm256_packus_epi16( w, w ), 0x08 ) ) )
+#  define BK_LOAD16(p)      _mm256_loadu_si256( (const __m256i *)(p) )
+#  define BK_STORE16(p, w)  _mm256_storeu_si256( (__m256i *)(p), w )
+#  define BK_SET1(x)        _mm256_set1_epi16( x )
+#  define BK_ADD(a, b)      _mm256_add_epi16( a, b )
+#  define BK_SUB(a, b)      _mm256_sub_epi16( a, b )
+#  define BK_MUL(a, b)      _mm256_mullo_epi16( a, b )
+#  define BK_AND(a, b)      _mm256_and_si256( a, b )
+#  define BK_OR(a, b)       _mm256_or_si256( a, b )
+#  define BK_SRL8(w)        _mm256_srli_epi16( w, 8 )
+#  define BK_SLL8(w)        _mm256_slli_epi16( w, 8 )
+#  define BK_ALPHA4(w)      _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( w, 0xff ), 0xff )
+#  define BK_SWAP4(w)       _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( w, \
+                                _MM_SHUFFLE(3, 0, 1, 2) ), _MM_SHUFFLE(3, 0, 1, 2) )
+#  define BK_MASK_RGB       _mm256_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1, \
+                                              0, -1, -1, -1, 0, -1, -1, -1 )
+#  define BK_FUNC(name)     name##_avx2
+#  define BK_ATTR           __attribute__((__target__("avx2")))
+#  include "blend_kernels_simd.h"
+# endif
+#endif
+
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_BLEND_NEON 1
+static const uint16_t bk_mask_rgb_neon[8] = {
+    0xffff, 0xffff, 0xffff, 0, 0xffff, 0xffff, 0xffff, 0,
+};
+static const uint16_t bk_mask_rb_neon[8] = {
+    0xffff, 0, 0xffff, 0, 0xffff, 0, 0xffff, 0,
+};
+# define BK_WORD            uint16x8_t
+# define BK_LANES           8
+# define BK_LOAD8(p)        vmovl_u8( vld1_u8( p ) )
+# define BK_STORE8(p, w)    vst1_u8( p, vmovn_u16( w ) )
+# define BK_LOAD16(p)       vreinterpretq_u16_u8( vld1q_u8( p ) )
+# define BK_STORE16(p, w)   vst1q_u8( p, vreinterpretq_u8_u16( w ) )
+# define BK_SET1(x)         vdupq_n_u16( x )
+# define BK_ADD(a, b)       vaddq_u16( a, b )
+# define BK_SUB(a, b)       vsubq_u16( a, b )
+# define BK_MUL(a, b)       vmulq_u16( a, b )
+# define BK_AND(a, b)       vandq_u16( a, b )
+# define BK_OR(a, b)        vorrq_u16( a, b )
+# define BK_SRL8(w)         vshrq_n_u16( w, 8 )
+# define BK_SLL8(w)         vshlq_n_u16( w, 8 )
+# define BK_ALPHA4(w)       vcombine_u16( vdup_lane_u16( vget_low_u16( w ), 3 ), \
+                                          vdup_lane_u16( vget_high_u16( w ), 3 ) )
+/* swapping the 32 bits halves of the groups moves the 1st and 3rd lanes */
+# define BK_SWAP4(w)        vbslq_u16( vld1q_u16( bk_mask_rb_neon ), \
+                                vreinterpretq_u16_u32( vrev64q_u32( vreinterpretq_u32_u16( w ) ) ), w )
+# define BK_MASK_RGB        vld1q_u16( bk_mask_rgb_neon )
+# define BK_FUNC(name)      name##_neon
+# define BK_ATTR
+# include "blend_kernels_simd.h"
+#endif
+
+#endif /* !WORDS_BIGENDIAN */
+
+void blend_kernels_InitC( blend_kernels_t *k )
+{
+    k->plane = blend_plane_c;
+    k->plane_sub2 = blend_plane_sub2_c;
+    k->uv_sub2 = blend_uv_sub2_c;
+    k->rgbx = blend_rgbx_c;
+    k->name = "C";
+}
+
+void blend_kernels_Init( blend_kernels_t *k )
+{
+    blend_kernels_InitC( k );
+
+#ifdef CAN_COMPILE_BLEND_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        k->plane = blend_plane_avx2;
+        k->plane_sub2 = blend_plane_sub2_avx2;
+        k->uv_sub2 = blend_uv_sub2_avx2;
+        k->rgbx = blend_rgbx_avx2;
+        k->name = "AVX2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_BLEND_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        k->plane = blend_plane_sse2;
+        k->plane_sub2 = blend_plane_sub2_sse2;
+        k->uv_sub2 = blend_uv_sub2_sse2;
+        k->rgbx = blend_rgbx_sse2;
+        k->name = "SSE2";
+        return;
+    }
+#endif
+#ifdef CAN_COMPILE_BLEND_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        k->plane = blend_plane_neon;
+        k->plane_sub2 = blend_plane_sub2_neon;
+        k->uv_sub2 = blend_uv_sub2_neon;
+        k->rgbx = blend_rgbx_neon;
+        k->name = "NEON";
+        return;
+    }
+#endif
+}
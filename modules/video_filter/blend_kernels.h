@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * blend_kernels.h: vectorized alpha blending rows
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_BLEND_KERNELS_H
+#define VLC_BLEND_KERNELS_H
+
+/**
+ * \file
+ * Row kernels for the most common blending of subpictures, in 8 bits.
+ * They compute the same output as the generic blend.cpp templates, bit for
+ * bit: the pixel alpha is the source one scaled by the global alpha, and
+ * every sample is merged as dst = ((255 - a) * dst + a * src) / 255.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    /* dst[i] from src[i] with the alpha a[i] */
+    void (*plane)( uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                   unsigned alpha, unsigned count );
+    /* dst[i] from src[2*i] with the alpha a[2*i] (subsampled chroma) */
+    void (*plane_sub2)( uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                        unsigned alpha, unsigned count );
+    /* interleaved chroma: dst[2*i] from u[2*i] and dst[2*i+1] from v[2*i],
+     * with the alpha a[2*i] */
+    void (*uv_sub2)( uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                     const uint8_t *a, unsigned alpha, unsigned count );
+    /* RGBA pixels onto 32 bits RGB ones, with R and B optionally swapped,
+     * the 4th byte of the destination is left untouched */
+    void (*rgbx)( uint8_t *dst, const uint8_t *src, unsigned alpha,
+                  unsigned count, bool swap_rb );
+    const char *name;
+} blend_kernels_t;
+
+/**
+ * Selects the fastest kernels supported by the CPU.
+ */
+void blend_kernels_Init( blend_kernels_t * );
+
+/**
+ * Selects the plain C kernels.
+ */
+void blend_kernels_InitC( blend_kernels_t * );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ * blend_kernels_simd.h: alpha blending rows, for one instruction set
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * This file is included by blend_kernels.c once per instruction set. The
+ * samples are processed in unsigned 16 bits lanes, which hold the products
+ * of two 8 bits values exactly.
+ *
+ * The includer defines:
+ *  - BK_WORD: the vector type, of BK_LANES 16 bits lanes,
+ *  - BK_LOAD8(p) and BK_STORE8(p, w): BK_LANES bytes to and from lanes,
+ *  - BK_LOAD16(p) and BK_STORE16(p, w): 2 * BK_LANES bytes as lanes,
+ *    in little endian order,
+ *  - BK_SET1(x), BK_ADD, BK_SUB, BK_MUL, BK_AND, BK_OR,
+ *  - BK_SRL8(w) and BK_SLL8(w): the lanes shifts by 8 bits,
+ *  - BK_ALPHA4(w): the 4th lane of every group of 4 copied to the group,
+ *  - BK_SWAP4(w): the 1st and 3rd lanes of every group of 4 swapped,
+ *  - BK_MASK_RGB: the 3 first lanes of every group of 4 set,
+ *  - BK_FUNC(name): the decorated name of the functions,
+ *  - BK_ATTR: the attributes of the functions (e.g. the target).
+ * They are undefined at the end of this file.
+ */
+
+static inline BK_ATTR BK_WORD BK_FUNC(bk_div255)( BK_WORD v )
+{
+    return BK_SRL8( BK_ADD( BK_ADD( BK_SRL8( v ), v ), BK_SET1( 1 ) ) );
+}
+
+static inline BK_ATTR BK_WORD BK_FUNC(bk_merge)( BK_WORD d, BK_WORD s, BK_WORD a )
+{
+    const BK_WORD na = BK_SUB( BK_SET1( 255 ), a );
+    return BK_FUNC(bk_div255)( BK_ADD( BK_MUL( d, na ), BK_MUL( s, a ) ) );
+}
+
+static inline BK_ATTR BK_WORD BK_FUNC(bk_alpha)( BK_WORD a, unsigned alpha )
+{
+    return BK_FUNC(bk_div255)( BK_MUL( a, BK_SET1( alpha ) ) );
+}
+
+static BK_ATTR void BK_FUNC(blend_plane)( uint8_t *dst, const uint8_t *src,
+                                          const uint8_t *a, unsigned alpha,
+                                          unsigned count )
+{
+    unsigned i = 0;
+
+    for( ; i + BK_LANES <= count; i += BK_LANES )
+    {
+        const BK_WORD va = BK_FUNC(bk_alpha)( BK_LOAD8( &a[i] ), alpha );
+        BK_STORE8( &dst[i], BK_FUNC(bk_merge)( BK_LOAD8( &dst[i] ),
+                                               BK_LOAD8( &src[i] ), va ) );
+    }
+    blend_plane_c( &dst[i], &src[i], &a[i], alpha, count - i );
+}
+
+/* The even samples are read as whole lanes, the last vector is left to the
+ * C tail so that nothing is read past src[2 * (count - 1)] */
+static BK_ATTR void BK_FUNC(blend_plane_sub2)( uint8_t *dst, const uint8_t *src,
+                                               const uint8_t *a, unsigned alpha,
+                                               unsigned count )
+{
+    const BK_WORD mask = BK_SET1( 0xff );
+    unsigned i = 0;
+
+    for( ; i + BK_LANES < count; i += BK_LANES )
+    {
+        const BK_WORD va = BK_FUNC(bk_alpha)( BK_AND( BK_LOAD16( &a[2*i] ), mask ),
+                                              alpha );
+        const BK_WORD vs = BK_AND( BK_LOAD16( &src[2*i] ), mask );
+        BK_STORE8( &dst[i], BK_FUNC(bk_merge)( BK_LOAD8( &dst[i] ), vs, va ) );
+    }
+    blend_plane_sub2_c( &dst[i], &src[2*i], &a[2*i], alpha, count - i );
+}
+
+static BK_ATTR void BK_FUNC(blend_uv_sub2)( uint8_t *dst, const uint8_t *u,
+                                            const uint8_t *v, const uint8_t *a,
+                                            unsigned alpha, unsigned count )
+{
+    const BK_WORD mask = BK_SET1( 0xff );
+    unsigned i = 0;
+
+    for( ; i + BK_LANES < count; i += BK_LANES )
+    {
+        const BK_WORD va = BK_FUNC(bk_alpha)( BK_AND( BK_LOAD16( &a[2*i] ), mask ),
+                                              alpha );
+        const BK_WORD vu = BK_AND( BK_LOAD16( &u[2*i] ), mask );
+        const BK_WORD vv = BK_AND( BK_LOAD16( &v[2*i] ), mask );
+        const BK_WORD d = BK_LOAD16( &dst[2*i] );
+        const BK_WORD du = BK_FUNC(bk_merge)( BK_AND( d, mask ), vu, va );
+        const BK_WORD dv = BK_FUNC(bk_merge)( BK_SRL8( d ), vv, va );
+        BK_STORE16( &dst[2*i], BK_OR( du, BK_SLL8( dv ) ) );
+    }
+    blend_uv_sub2_c( &dst[2*i], &u[2*i], &v[2*i], &a[2*i], alpha, count - i );
+}
+
+/* A zero alpha keeps the 4th byte as is */
+static BK_ATTR void BK_FUNC(blend_rgbx)( uint8_t *dst, const uint8_t *src,
+                                         unsigned alpha, unsigned count,
+                                         bool swap_rb )
+{
+    const BK_WORD mask = BK_MASK_RGB;
+    unsigned i = 0;
+
+    for( ; i + BK_LANES / 4 <= count; i += BK_LANES / 4 )
+    {
+        BK_WORD s = BK_LOAD8( &src[4*i] );
+        const BK_WORD va = BK_AND( BK_FUNC(bk_alpha)( BK_ALPHA4( s ), alpha ),
+                                   mask );
+        if( swap_rb )
+            s = BK_SWAP4( s );
+        BK_STORE8( &dst[4*i], BK_FUNC(bk_merge)( BK_LOAD8( &dst[4*i] ), s, va ) );
+    }
+    blend_rgbx_c( &dst[4*i], &src[4*i], alpha, count - i, swap_rb );
+}
+
+#undef BK_WORD
+#undef BK_LANES
+#undef BK_LOAD8
+#undef BK_STORE8
+#undef BK_LOAD16
+#undef BK_STORE16
+#undef BK_SET1
+#undef BK_ADD
+#undef BK_SUB
+#undef BK_MUL
+#undef BK_AND
+#undef BK_OR
+#undef BK_SRL8
+#undef BK_SLL8
+#undef BK_ALPHA4
+#undef BK_SWAP4
+#undef BK_MASK_RGB
+#undef BK_FUNC
+#undef BK_ATTR
@@ -68,6 +68,11 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
                                  " in")
 
+#define ALL_TEXT N_("Benchmark all the chromas")
+#define ALL_LONGTEXT N_("Blend generated pictures of every source and " \
+                        "destination chroma at several resolutions instead " \
+                        "of the images")
+
 #define CFG_PREFIX "blendbench-"
 
 vlc_module_begin ()
@@ -82,6 +87,8 @@ vlc_module_begin ()
     add_integer_with_range( CFG_PREFIX "alpha", 128, 0, 255, ALPHA_TEXT,
               ALPHA_LONGTEXT )
 
+    add_bool( CFG_PREFIX "all", false, ALL_TEXT, ALL_LONGTEXT )
+
     set_section( N_("Base image"), NULL )
     add_loadfile(CFG_PREFIX "base-image", NULL,
                  BASE_IMAGE_TEXT, BASE_IMAGE_LONGTEXT)
@@ -98,16 +105,51 @@ vlc_module_begin ()
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
-    "loops", "alpha", "base-image", "base-chroma", "blend-image",
+    "loops", "alpha", "all", "base-image", "base-chroma", "blend-image",
     "blend-chroma", NULL
 };
 
+/* Pairs of the "all" mode, the blended picture covers the whole base */
+static const vlc_fourcc_t pi_blend_chromas[] = {
+    VLC_CODEC_YUVA, VLC_CODEC_RGBA, VLC_CODEC_YUVP,
+};
+
+static const vlc_fourcc_t pi_base_chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_J420, VLC_CODEC_YV12,
+    VLC_CODEC_NV12, VLC_CODEC_NV21,
+    VLC_CODEC_I422, VLC_CODEC_J422, VLC_CODEC_I444, VLC_CODEC_J444,
+    VLC_CODEC_YV9, VLC_CODEC_I410, VLC_CODEC_I411,
+#ifdef WORDS_BIGENDIAN
+    VLC_CODEC_I420_9B, VLC_CODEC_I420_10B,
+    VLC_CODEC_I422_9B, VLC_CODEC_I422_10B, VLC_CODEC_I422_16B,
+    VLC_CODEC_I444_9B, VLC_CODEC_I444_10B, VLC_CODEC_I444_16B,
+#else
+    VLC_CODEC_I420_9L, VLC_CODEC_I420_10L,
+    VLC_CODEC_I422_9L, VLC_CODEC_I422_10L, VLC_CODEC_I422_16L,
+    VLC_CODEC_I444_9L, VLC_CODEC_I444_10L, VLC_CODEC_I444_16L,
+#endif
+    VLC_CODEC_YUYV, VLC_CODEC_UYVY, VLC_CODEC_YVYU, VLC_CODEC_VYUY,
+    VLC_CODEC_RGB15, VLC_CODEC_RGB16, VLC_CODEC_RGB24, VLC_CODEC_RGB32,
+    VLC_CODEC_RGBA, VLC_CODEC_BGRA,
+};
+
+static const struct
+{
+    unsigned i_width;
+    unsigned i_height;
+} p_sizes[] = {
+    {  720,  576 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
 /*****************************************************************************
  * filter_sys_t: filter method descriptor
  *****************************************************************************/
 typedef struct
 {
     bool b_done;
+    bool b_all;
     int i_loops, i_alpha;
 
     picture_t *p_base_image;
@@ -143,6 +185,129 @@ static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
     return VLC_SUCCESS;
 }
 
+/* Fills the pictures with the same content on every run */
+static picture_t *blendbench_NewPicture( vlc_fourcc_t i_chroma,
+                                         unsigned i_width, unsigned i_height,
+                                         uint32_t *pi_seed )
+{
+    video_format_t fmt;
+
+    video_format_Init( &fmt, i_chroma );
+    video_format_Setup( &fmt, i_chroma, i_width, i_height,
+                        i_width, i_height, 1, 1 );
+    picture_t *p_pic = picture_NewFromFormat( &fmt );
+    video_format_Clean( &fmt );
+    if( p_pic == NULL )
+        return NULL;
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+            {
+                *pi_seed = *pi_seed * 1103515245 + 12345;
+                p->p_pixels[y * p->i_pitch + x] = *pi_seed >> 16;
+            }
+    }
+    return p_pic;
+}
+
+static void blendbench_Run( filter_t *p_filter, picture_t *p_base,
+                            const video_format_t *p_base_fmt,
+                            picture_t *p_blend,
+                            const video_format_t *p_blend_fmt )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    filter_t *p_blend_filter;
+
+    p_blend_filter = vlc_object_create( p_filter, sizeof(filter_t) );
+    if( !p_blend_filter )
+        return;
+    p_blend_filter->fmt_out.video = *p_base_fmt;
+    p_blend_filter->fmt_in.video = *p_blend_fmt;
+    p_blend_filter->p_module = module_need( p_blend_filter, "video blending",
+                                            NULL, false );
+    if( !p_blend_filter->p_module )
+    {
+        msg_Warn( p_filter, "%4.4s -> %4.4s: no blending module",
+                  (const char *)&p_blend_fmt->i_chroma,
+                  (const char *)&p_base_fmt->i_chroma );
+        vlc_object_delete(p_blend_filter);
+        return;
+    }
+    assert( p_blend_filter->ops != NULL );
+
+    vlc_tick_t time = vlc_tick_now();
+    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
+    {
+        filter_Blend( p_blend_filter, p_base,
+                      0, 0, p_blend, p_sys->i_alpha );
+    }
+    time = vlc_tick_now() - time;
+    if( time <= 0 )
+        time = 1;
+
+    msg_Info( p_filter, "%4.4s -> %4.4s %dx%d: blended %d images in %f sec",
+              (const char *)&p_blend_fmt->i_chroma,
+              (const char *)&p_base_fmt->i_chroma,
+              p_blend->p[Y_PLANE].i_visible_pitch / p_blend->p[Y_PLANE].i_pixel_pitch,
+              p_blend->p[Y_PLANE].i_visible_lines,
+              p_sys->i_loops, secf_from_vlc_tick(time) );
+    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
+              (float) p_sys->i_loops / time * CLOCK_FREQ,
+              (float) p_sys->i_loops / time * CLOCK_FREQ *
+                  p_blend->p[Y_PLANE].i_visible_pitch *
+                  p_blend->p[Y_PLANE].i_visible_lines );
+
+    filter_Close( p_blend_filter );
+    module_unneed( p_blend_filter, p_blend_filter->p_module );
+
+    vlc_object_delete(p_blend_filter);
+}
+
+static void blendbench_RunAll( filter_t *p_filter )
+{
+    video_palette_t palette;
+    uint32_t i_seed = 0;
+
+    palette.i_entries = 256;
+    for( int i = 0; i < palette.i_entries; i++ )
+        for( int c = 0; c < 4; c++ )
+        {
+            i_seed = i_seed * 1103515245 + 12345;
+            palette.palette[i][c] = i_seed >> 16;
+        }
+
+    for( size_t s = 0; s < ARRAY_SIZE(p_sizes); s++ )
+    for( size_t j = 0; j < ARRAY_SIZE(pi_blend_chromas); j++ )
+    for( size_t i = 0; i < ARRAY_SIZE(pi_base_chromas); i++ )
+    {
+        /* same content for every pair */
+        i_seed = 0;
+        picture_t *p_base = blendbench_NewPicture( pi_base_chromas[i],
+                                                   p_sizes[s].i_width,
+                                                   p_sizes[s].i_height,
+                                                   &i_seed );
+        picture_t *p_blend = blendbench_NewPicture( pi_blend_chromas[j],
+                                                    p_sizes[s].i_width,
+                                                    p_sizes[s].i_height,
+                                                    &i_seed );
+        if( p_base && p_blend )
+        {
+            video_format_t blend_fmt = p_blend->format;
+            if( blend_fmt.i_chroma == VLC_CODEC_YUVP )
+                blend_fmt.p_palette = &palette;
+            blendbench_Run( p_filter, p_base, &p_base->format,
+                            p_blend, &blend_fmt );
+        }
+        if( p_base )
+            picture_Release( p_base );
+        if( p_blend )
+            picture_Release( p_blend );
+    }
+}
+
 static const struct vlc_filter_operations filter_ops =
 {
     .filter_video = Filter, .close = Destroy,
@@ -176,6 +341,13 @@ static int Create( filter_t *p_filter )
                                                   CFG_PREFIX "loops" );
     p_sys->i_alpha = var_CreateGetIntegerCommand( p_filter,
                                                   CFG_PREFIX "alpha" );
+    p_sys->b_all = var_CreateGetBool( p_filter, CFG_PREFIX "all" );
+    if( p_sys->b_all )
+    {
+        p_sys->p_base_image = NULL;
+        p_sys->p_blend_image = NULL;
+        return VLC_SUCCESS;
+    }
 
     psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
     p_sys->i_base_chroma = !psz_temp || strlen( psz_temp ) != 4 ? 0 :
@@ -220,8 +392,11 @@ static void Destroy( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_Release( p_sys->p_base_image );
-    picture_Release( p_sys->p_blend_image );
+    if( p_sys->p_base_image )
+        picture_Release( p_sys->p_base_image );
+    if( p_sys->p_blend_image )
+        picture_Release( p_sys->p_blend_image );
+    free( p_sys );
 }
 
 /*****************************************************************************
@@ -230,48 +405,16 @@ static void Destroy( filter_t *p_filter )
 static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_t *p_blend;
 
     if( p_sys->b_done )
         return p_pic;
 
-    p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
-    if( !p_blend )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-    p_blend->fmt_out.video = p_sys->p_base_image->format;
-    p_blend->fmt_in.video = p_sys->p_blend_image->format;
-    p_blend->p_module = module_need( p_blend, "video blending", NULL, false );
-    if( !p_blend->p_module )
-    {
-        picture_Release( p_pic );
-        vlc_object_delete(p_blend);
-        return NULL;
-    }
-    assert( p_blend->ops != NULL );
-
-    vlc_tick_t time = vlc_tick_now();
-    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
-    {
-        filter_Blend( p_blend, p_sys->p_base_image,
-                      0, 0, p_sys->p_blend_image, p_sys->i_alpha );
-    }
-    time = vlc_tick_now() - time;
-
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
-              secf_from_vlc_tick(time) );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
-              (float) p_sys->i_loops / time * CLOCK_FREQ,
-              (float) p_sys->i_loops / time * CLOCK_FREQ *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
-
-    filter_Close( p_blend );
-    module_unneed( p_blend, p_blend->p_module );
-
-    vlc_object_delete(p_blend);
+    if( p_sys->b_all )
+        blendbench_RunAll( p_filter );
+    else
+        blendbench_Run( p_filter, p_sys->p_base_image,
+                        &p_sys->p_base_image->format,
+                        p_sys->p_blend_image, &p_sys->p_blend_image->format );
 
     p_sys->b_done = true;
     return p_pic;
@@ -0,0 +1,210 @@
+/*****************************************************************************
+ * algo_bwdif.c : Wrapper for FFmpeg's Bwdif algorithm
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+
+#include "deinterlace.h" /* filter_sys_t  */
+#include "helpers.h"
+#include "line_filters.h"
+
+#include "algo_bwdif.h"
+
+/*****************************************************************************
+ * Bwdif (BobWeaver DeInterlacing Filter).
+ *****************************************************************************/
+
+/* bwdif.h comes from bwdif.c of FFmpeg project. */
+#include "bwdif.h"
+
+struct bwdif_frame
+{
+    picture_t *p_dst;
+    const picture_t *p_prev;
+    const picture_t *p_cur;
+    const picture_t *p_next;
+    bwdif_filter_line_t filter_line;
+    int i_parity;
+    int i_field;
+    int i_clip_max;
+};
+
+static bwdif_filter_line_t GetFilterLine( const vlc_chroma_description_t *chroma )
+{
+    if( chroma->pixel_size == 2 )
+    {
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+        if( vlc_CPU_AVX2() )
+            return bwdif_filter_line_16bit_avx2;
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+        if( vlc_CPU_ARM_NEON() )
+            return bwdif_filter_line_16bit_neon;
+#endif
+        return bwdif_filter_line_c_16bit;
+    }
+
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+    if( vlc_CPU_AVX2() )
+        return bwdif_filter_line_avx2;
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+    if( vlc_CPU_ARM_NEON() )
+        return bwdif_filter_line_neon;
+#endif
+    return bwdif_filter_line_c;
+}
+
+static void RenderBwdifBand( filter_t *p_filter, void *opaque, int n,
+                             int i_y_start, int i_y_end )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const struct bwdif_frame *frame = opaque;
+    const unsigned i_size = p_sys->chroma->pixel_size;
+
+    const plane_t *prevp = &frame->p_prev->p[n];
+    const plane_t *curp  = &frame->p_cur->p[n];
+    const plane_t *nextp = &frame->p_next->p[n];
+    plane_t *dstp        = &frame->p_dst->p[n];
+
+    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+
+    /* The filters work in samples, not in bytes */
+    const int w = dstp->i_visible_pitch / i_size;
+    const int h = dstp->i_visible_lines;
+    const int refs = curp->i_pitch / i_size;
+
+    for( int y = i_y_start; y < i_y_end; y++ )
+    {
+        uint8_t *dst = &dstp->p_pixels[y * dstp->i_pitch];
+        const uint8_t *prev = &prevp->p_pixels[y * prevp->i_pitch];
+        const uint8_t *cur  = &curp->p_pixels[y * curp->i_pitch];
+        const uint8_t *next = &nextp->p_pixels[y * nextp->i_pitch];
+
+        if( (y % 2) == frame->i_field  ||  frame->i_parity == 2 )
+        {
+            memcpy( dst, cur, dstp->i_visible_pitch );
+        }
+        else if( y < 4 || y + 5 > h )
+        {
+            /* Not enough lines for the full filter: mirror the missing
+             * neighbours, and skip the spatial check on the outer lines */
+            const int spat = y >= 2 && y + 3 <= h;
+
+            if( i_size == 2 )
+                bwdif_filter_edge_c_16bit( dst, prev, cur, next, w,
+                                           y + 1 < h ? refs : -refs,
+                                           y > 0 ? -refs : refs,
+                                           refs << 1, -(refs << 1),
+                                           frame->i_parity,
+                                           frame->i_clip_max, spat );
+            else
+                bwdif_filter_edge_c( dst, prev, cur, next, w,
+                                     y + 1 < h ? refs : -refs,
+                                     y > 0 ? -refs : refs,
+                                     refs << 1, -(refs << 1),
+                                     frame->i_parity, frame->i_clip_max, spat );
+        }
+        else
+        {
+            frame->filter_line( dst, prev, cur, next, w,
+                                refs, -refs, refs << 1, -(refs << 1),
+                                3 * refs, -3 * refs, refs << 2, -(refs << 2),
+                                frame->i_parity, frame->i_clip_max );
+        }
+    }
+}
+
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderBwdif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    /* */
+    assert( i_order >= 0 && i_order <= 2 ); /* 2 = soft field repeat */
+    assert( i_field == 0 || i_field == 1 );
+
+    /* As the pitches must match, use ONLY pictures coming from picture_New()! */
+    picture_t *p_prev = p_sys->context.pp_history[0];
+    picture_t *p_cur  = p_sys->context.pp_history[1];
+    picture_t *p_next = p_sys->context.pp_history[2];
+
+    /* Account for soft field repeat: same as in RenderYadif(), parity 2
+       bypasses the filter for the repeated field. */
+    int bwdif_parity;
+    if( p_cur  &&  p_cur->i_nb_fields > 2 )
+        bwdif_parity = (i_order + 1) % 3; /* 1, *2*, 0 */
+    else
+        bwdif_parity = (i_order + 1) % 2; /* 1, 0 */
+
+    /* Filter if we have all the pictures we need */
+    if( p_prev && p_cur && p_next )
+    {
+        struct bwdif_frame frame = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .filter_line = GetFilterLine( p_sys->chroma ),
+            .i_parity = bwdif_parity,
+            .i_field = i_field,
+            .i_clip_max = (1 << p_sys->chroma->pixel_bits) - 1,
+        };
+
+        RenderBands( p_filter, p_dst, RenderBwdifBand, &frame );
+
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
+
+        return VLC_SUCCESS;
+    }
+    else if( !p_prev && !p_cur && p_next )
+    {
+        /* NOTE: For the first frame, we use the default frame offset
+                 as set by Open() or SetFilterMethod(). It is always 0. */
+
+        /* FIXME not good as it does not use i_order/i_field */
+        RenderX( p_filter, p_dst, p_next );
+        return VLC_SUCCESS;
+    }
+    else
+    {
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame */
+
+        return VLC_EGENERIC;
+    }
+}
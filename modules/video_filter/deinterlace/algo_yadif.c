@@ -35,6 +35,8 @@
 
 #include "deinterlace.h" /* filter_sys_t  */
 #include "common.h"      /* FFMIN3 et al. */
+#include "helpers.h"
+#include "line_filters.h"
 
 #include "algo_yadif.h"
 
@@ -46,6 +48,110 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+typedef void (*yadif_filter_line_t)( uint8_t *dst, uint8_t *prev,
+                                     uint8_t *cur, uint8_t *next, int w,
+                                     int prefs, int mrefs, int parity,
+                                     int mode );
+
+struct yadif_frame
+{
+    picture_t *p_dst;
+    const picture_t *p_prev;
+    const picture_t *p_cur;
+    const picture_t *p_next;
+    yadif_filter_line_t filter;
+    int i_parity;
+    int i_field;
+};
+
+static yadif_filter_line_t GetFilterLine( const vlc_chroma_description_t *chroma )
+{
+    if( chroma->pixel_size == 2 )
+    {
+        /* The SIMD versions work on 16-bit lanes and need some headroom */
+        if( chroma->pixel_bits <= 12 )
+        {
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+            if( vlc_CPU_AVX2() )
+                return yadif_filter_line_16bit_avx2;
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+            if( vlc_CPU_ARM_NEON() )
+                return yadif_filter_line_16bit_neon;
+#endif
+        }
+        return yadif_filter_line_c_16bit;
+    }
+
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+    if( vlc_CPU_AVX2() )
+        return yadif_filter_line_avx2;
+#endif
+#if defined(HAVE_X86ASM)
+    if( vlc_CPU_SSSE3() )
+        return vlcpriv_yadif_filter_line_ssse3;
+    if( vlc_CPU_SSE2() )
+        return vlcpriv_yadif_filter_line_sse2;
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+    if( vlc_CPU_ARM_NEON() )
+        return yadif_filter_line_neon;
+#endif
+    return yadif_filter_line_c;
+}
+
+static void RenderYadifBand( filter_t *p_filter, void *opaque, int n,
+                             int i_y_start, int i_y_end )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const struct yadif_frame *frame = opaque;
+
+    const plane_t *prevp = &frame->p_prev->p[n];
+    const plane_t *curp  = &frame->p_cur->p[n];
+    const plane_t *nextp = &frame->p_next->p[n];
+    plane_t *dstp        = &frame->p_dst->p[n];
+
+    /* The filter works in samples, not in bytes */
+    const int w = dstp->i_visible_pitch / p_sys->chroma->pixel_size;
+
+    for( int y = __MAX( i_y_start, 1 );
+         y < __MIN( i_y_end, dstp->i_visible_lines - 1 ); y++ )
+    {
+        if( (y % 2) == frame->i_field  ||  frame->i_parity == 2 )
+        {
+            memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                        &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+        }
+        else
+        {
+            int mode;
+            /* Spatial checks only when enough data */
+            mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+            assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+            frame->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                           &prevp->p_pixels[y * prevp->i_pitch],
+                           &curp->p_pixels[y * curp->i_pitch],
+                           &nextp->p_pixels[y * nextp->i_pitch],
+                           w,
+                           y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                           y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                           frame->i_parity,
+                           mode );
+        }
+
+        /* We duplicate the first and last lines */
+        if( y == 1 )
+            memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+        else if( y == dstp->i_visible_lines - 2 )
+            memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+    }
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -108,66 +214,17 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
-
-#if defined(HAVE_X86ASM)
-        if( vlc_CPU_SSSE3() )
-            filter = vlcpriv_yadif_filter_line_ssse3;
-        else
-        if( vlc_CPU_SSE2() )
-            filter = vlcpriv_yadif_filter_line_sse2;
-        else
-#endif
-            filter = yadif_filter_line_c;
-
-        if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
-
-        for( int n = 0; n < p_dst->i_planes; n++ )
-        {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
-        }
+        struct yadif_frame frame = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .filter = GetFilterLine( p_sys->chroma ),
+            .i_parity = yadif_parity,
+            .i_field = i_field,
+        };
+
+        RenderBands( p_filter, p_dst, RenderYadifBand, &frame );
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
@@ -0,0 +1,157 @@
+/*
+ * BobWeaver Deinterlacing Filter
+ * Copyright (C) 2016 Thomas Mundt <loudmax@yahoo.de>
+ *
+ * Based on YADIF (Yet Another Deinterlacing Filter)
+ * Copyright (C) 2006-2011 Michael Niedermayer <michaelni@gmx.at>
+ *               2010      James Darnley <james.darnley@gmail.com>
+ *
+ * With use of Weston 3 Field Deinterlacing Filter algorithm
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ * Author of de-interlace algorithm: Jim Easterbrook for BBC R&D
+ * Based on the process described by Martin Weston for BBC R&D
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef VLC_DEINTERLACE_BWDIF_H
+#define VLC_DEINTERLACE_BWDIF_H 1
+
+/*
+ * Filter coefficients coef_lf and coef_hf taken from BBC PH-2071 (Weston 3
+ * Field Deinterlacer). Used when there is spatial and temporal interpolation.
+ * Filter coefficients coef_sp are used when there is spatial interpolation
+ * only. Adjusted for matching visual sharpness impression of spatial and
+ * temporal interpolation.
+ */
+#define BWDIF_COEF_LF0 4309
+#define BWDIF_COEF_LF1 213
+#define BWDIF_COEF_HF0 5570
+#define BWDIF_COEF_HF1 3801
+#define BWDIF_COEF_HF2 1016
+#define BWDIF_COEF_SP0 5077
+#define BWDIF_COEF_SP1 981
+
+/* The references are in samples, not in bytes */
+typedef void (*bwdif_filter_line_t)( void *dst, const void *prev,
+                                     const void *cur, const void *next,
+                                     int w, int prefs, int mrefs,
+                                     int prefs2, int mrefs2,
+                                     int prefs3, int mrefs3,
+                                     int prefs4, int mrefs4,
+                                     int parity, int clip_max );
+
+#define BWDIF_FILTER1 \
+    for( int x = 0; x < w; x++ ) { \
+        int c = cur[mrefs]; \
+        int d = (prev2[0] + next2[0]) >> 1; \
+        int e = cur[prefs]; \
+        int temporal_diff0 = abs(prev2[0] - next2[0]); \
+        int temporal_diff1 = (abs(prev[mrefs] - c) + abs(prev[prefs] - e)) >> 1; \
+        int temporal_diff2 = (abs(next[mrefs] - c) + abs(next[prefs] - e)) >> 1; \
+        int diff = __MAX(__MAX(temporal_diff0 >> 1, temporal_diff1), temporal_diff2); \
+        int interpol; \
+ \
+        if( !diff ) { \
+            dst[0] = d; \
+        } else {
+
+#define BWDIF_SPAT_CHECK \
+            int b = ((prev2[mrefs2] + next2[mrefs2]) >> 1) - c; \
+            int f = ((prev2[prefs2] + next2[prefs2]) >> 1) - e; \
+            int dc = d - c; \
+            int de = d - e; \
+            int max = __MAX(__MAX(de, dc), __MIN(b, f)); \
+            int min = __MIN(__MIN(de, dc), __MAX(b, f)); \
+            diff = __MAX(__MAX(diff, min), -max);
+
+#define BWDIF_FILTER_LINE \
+            BWDIF_SPAT_CHECK \
+            if( abs(c - e) > temporal_diff0 ) { \
+                interpol = (((BWDIF_COEF_HF0 * (prev2[0] + next2[0]) \
+                    - BWDIF_COEF_HF1 * (prev2[mrefs2] + next2[mrefs2] + prev2[prefs2] + next2[prefs2]) \
+                    + BWDIF_COEF_HF2 * (prev2[mrefs4] + next2[mrefs4] + prev2[prefs4] + next2[prefs4])) >> 2) \
+                    + BWDIF_COEF_LF0 * (c + e) - BWDIF_COEF_LF1 * (cur[mrefs3] + cur[prefs3])) >> 13; \
+            } else { \
+                interpol = (BWDIF_COEF_SP0 * (c + e) - BWDIF_COEF_SP1 * (cur[mrefs3] + cur[prefs3])) >> 13; \
+            }
+
+#define BWDIF_FILTER_EDGE \
+            if( spat ) { \
+                BWDIF_SPAT_CHECK \
+            } \
+            interpol = (c + e) >> 1;
+
+#define BWDIF_FILTER2 \
+            if( interpol > d + diff ) \
+                interpol = d + diff; \
+            else if( interpol < d - diff ) \
+                interpol = d - diff; \
+ \
+            dst[0] = VLC_CLIP(interpol, 0, clip_max); \
+        } \
+ \
+        dst++; \
+        cur++; \
+        prev++; \
+        next++; \
+        prev2++; \
+        next2++; \
+    }
+
+#define BWDIF_LINE_C(name, type) \
+static inline void name( void *dst1, const void *prev1, const void *cur1, \
+                         const void *next1, int w, int prefs, int mrefs, \
+                         int prefs2, int mrefs2, int prefs3, int mrefs3, \
+                         int prefs4, int mrefs4, int parity, int clip_max ) \
+{ \
+    type *dst = dst1; \
+    const type *prev = prev1; \
+    const type *cur = cur1; \
+    const type *next = next1; \
+    const type *prev2 = parity ? prev : cur; \
+    const type *next2 = parity ? cur  : next; \
+ \
+    BWDIF_FILTER1 \
+    BWDIF_FILTER_LINE \
+    BWDIF_FILTER2 \
+}
+
+#define BWDIF_EDGE_C(name, type) \
+static inline void name( void *dst1, const void *prev1, const void *cur1, \
+                         const void *next1, int w, int prefs, int mrefs, \
+                         int prefs2, int mrefs2, int parity, int clip_max, \
+                         int spat ) \
+{ \
+    type *dst = dst1; \
+    const type *prev = prev1; \
+    const type *cur = cur1; \
+    const type *next = next1; \
+    const type *prev2 = parity ? prev : cur; \
+    const type *next2 = parity ? cur  : next; \
+ \
+    BWDIF_FILTER1 \
+    BWDIF_FILTER_EDGE \
+    BWDIF_FILTER2 \
+}
+
+BWDIF_LINE_C(bwdif_filter_line_c, uint8_t)
+BWDIF_LINE_C(bwdif_filter_line_c_16bit, uint16_t)
+BWDIF_EDGE_C(bwdif_filter_edge_c, uint8_t)
+BWDIF_EDGE_C(bwdif_filter_edge_c_16bit, uint16_t)
+
+#endif
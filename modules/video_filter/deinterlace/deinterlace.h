@@ -39,6 +39,7 @@ struct vlc_object_t;
 #include "algo_basic.h"
 #include "algo_x.h"
 #include "algo_yadif.h"
+#include "algo_bwdif.h"
 #include "algo_phosphor.h"
 #include "algo_ivtc.h"
 #include "common.h"
@@ -50,12 +51,13 @@ struct vlc_object_t;
 /** Available deinterlace modes. */
 static const char *const mode_list[] = {
     "discard", "blend", "mean", "bob", "linear", "x",
-    "yadif", "yadif2x", "phosphor", "ivtc" };
+    "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor", "ivtc" };
 
 /** User labels for the available deinterlace modes. */
 static const char *const mode_list_text[] = {
     N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"), N_("Linear"), "X",
-    "Yadif", "Yadif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
+    "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)", N_("Phosphor"),
+    N_("Film NTSC (IVTC)") };
 
 /*****************************************************************************
  * Data structures
@@ -452,3 +452,51 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     return i_score;
 }
 #undef T
+
+/*****************************************************************************
+ * RenderBands: render the planes of a picture in parallel bands
+ *****************************************************************************/
+
+struct render_bands
+{
+    filter_t *p_filter;
+    const picture_t *p_dst;
+    deinterlace_band_cb pf_band;
+    void *opaque;
+};
+
+static void RenderSlice( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct render_bands *bands = opaque;
+    const picture_t *p_dst = bands->p_dst;
+
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        const int i_lines = p_dst->p[n].i_visible_lines;
+        int i_start, i_end;
+
+        filter_GetSliceLines( i_lines, i_slice, i_count, &i_start, &i_end );
+        /* Keep both lines of a field pair in the same band */
+        i_start &= ~1;
+        if( i_slice + 1 < i_count )
+            i_end &= ~1;
+        if( i_start < i_end )
+            bands->pf_band( bands->p_filter, bands->opaque, n,
+                            i_start, i_end );
+    }
+}
+
+/* See header for function doc. */
+void RenderBands( filter_t *p_filter, const picture_t *p_dst,
+                  deinterlace_band_cb pf_band, void *opaque )
+{
+    struct render_bands bands = {
+        .p_filter = p_filter,
+        .p_dst = p_dst,
+        .pf_band = pf_band,
+        .opaque = opaque,
+    };
+
+    filter_ExecuteSlices( p_filter, DEINTERLACE_MAX_BANDS, RenderSlice,
+                          &bands );
+}
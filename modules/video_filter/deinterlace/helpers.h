@@ -165,4 +165,32 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
 int CalculateInterlaceScore( const picture_t* p_pic_top,
                              const picture_t* p_pic_bot );
 
+/** Maximum number of horizontal bands a plane is split into. */
+#define DEINTERLACE_MAX_BANDS 8
+
+/**
+ * Callback rendering lines [i_y_start, i_y_end) of plane i_plane.
+ * @see RenderBands()
+ */
+typedef void (*deinterlace_band_cb)( filter_t *p_filter, void *opaque,
+                                     int i_plane, int i_y_start, int i_y_end );
+
+/**
+ * Helper function: renders every plane of p_dst in horizontal bands.
+ *
+ * The bands are rendered in parallel with filter_ExecuteSlices(), and this
+ * function returns once all of them are done.
+ *
+ * The band boundaries are always on even lines, so that both lines of a
+ * field pair belong to the same band. The callback must only write the lines
+ * of its band, but may read any line of the source pictures.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ * @param p_dst Output picture, used for the plane geometry.
+ * @param pf_band Callback rendering one band.
+ * @param opaque Data passed to pf_band.
+ */
+void RenderBands( filter_t *p_filter, const picture_t *p_dst,
+                  deinterlace_band_cb pf_band, void *opaque );
+
 #endif
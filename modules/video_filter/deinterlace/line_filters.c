@@ -0,0 +1,622 @@
+/*****************************************************************************
+ * line_filters.c : SIMD line filters for the Yadif and Bwdif algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <vlc_common.h>
+
+#include "common.h"      /* FFMIN3 et al. */
+#include "line_filters.h"
+
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2) || defined(CAN_COMPILE_LINE_FILTERS_NEON)
+/* The C versions filter the remainder of the lines */
+# include "yadif.h"
+# include "bwdif.h"
+#endif
+
+/*****************************************************************************
+ * AVX2
+ *****************************************************************************/
+#ifdef CAN_COMPILE_LINE_FILTERS_AVX2
+#include <immintrin.h>
+
+#define VLC_AVX2_INLINE \
+    static inline __attribute__((__always_inline__, __target__("avx2")))
+
+/* Yadif works on 16-bit lanes, 16 samples at a time */
+VLC_AVX2_INLINE __m256i yadif_load_avx2( const void *p, ptrdiff_t i, bool b16 )
+{
+    if( b16 )
+        return _mm256_loadu_si256( (const __m256i *)((const uint16_t *)p + i) );
+    return _mm256_cvtepu8_epi16(
+                _mm_loadu_si128( (const __m128i *)((const uint8_t *)p + i) ) );
+}
+
+VLC_AVX2_INLINE void yadif_store_avx2( void *p, ptrdiff_t i, __m256i v, bool b16 )
+{
+    if( b16 )
+    {
+        _mm256_storeu_si256( (__m256i *)((uint16_t *)p + i), v );
+        return;
+    }
+    v = _mm256_permute4x64_epi64( _mm256_packus_epi16( v, v ), 0xD8 );
+    _mm_storeu_si128( (__m128i *)((uint8_t *)p + i),
+                      _mm256_castsi256_si128( v ) );
+}
+
+VLC_AVX2_INLINE void yadif_pixels_avx2( void *dst, const void *prev,
+                                        const void *cur, const void *next,
+                                        const void *prev2, const void *next2,
+                                        ptrdiff_t x, int prefs, int mrefs,
+                                        int mode, bool b16 )
+{
+#define L(p, o) yadif_load_avx2( p, x + (o), b16 )
+#define ABSDIFF(a, b) _mm256_abs_epi16( _mm256_sub_epi16( a, b ) )
+#define AVG(a, b) _mm256_srli_epi16( _mm256_add_epi16( a, b ), 1 )
+    const __m256i c = L(cur, mrefs);
+    const __m256i e = L(cur, prefs);
+    const __m256i p2 = L(prev2, 0);
+    const __m256i n2 = L(next2, 0);
+    const __m256i d = AVG( p2, n2 );
+
+    const __m256i temporal_diff0 = ABSDIFF( p2, n2 );
+    const __m256i temporal_diff1 = _mm256_srli_epi16(
+            _mm256_add_epi16( ABSDIFF( L(prev, mrefs), c ),
+                              ABSDIFF( L(prev, prefs), e ) ), 1 );
+    const __m256i temporal_diff2 = _mm256_srli_epi16(
+            _mm256_add_epi16( ABSDIFF( L(next, mrefs), c ),
+                              ABSDIFF( L(next, prefs), e ) ), 1 );
+    __m256i diff = _mm256_max_epi16(
+            _mm256_max_epi16( _mm256_srli_epi16( temporal_diff0, 1 ),
+                              temporal_diff1 ), temporal_diff2 );
+
+    __m256i spatial_pred = AVG( c, e );
+    __m256i spatial_score = _mm256_sub_epi16(
+            _mm256_add_epi16(
+                _mm256_add_epi16( ABSDIFF( L(cur, mrefs - 1), L(cur, prefs - 1) ),
+                                  ABSDIFF( c, e ) ),
+                ABSDIFF( L(cur, mrefs + 1), L(cur, prefs + 1) ) ),
+            _mm256_set1_epi16( 1 ) );
+
+#define SCORE(j) \
+    _mm256_add_epi16( \
+        _mm256_add_epi16( ABSDIFF( L(cur, mrefs - 1 + (j)), L(cur, prefs - 1 - (j)) ), \
+                          ABSDIFF( L(cur, mrefs + (j)), L(cur, prefs - (j)) ) ), \
+        ABSDIFF( L(cur, mrefs + 1 + (j)), L(cur, prefs + 1 - (j)) ) )
+#define SPATIAL_CHECK(j, outer) do { \
+        const __m256i score = SCORE(j); \
+        mask = _mm256_and_si256( outer, \
+                                 _mm256_cmpgt_epi16( spatial_score, score ) ); \
+        spatial_score = _mm256_blendv_epi8( spatial_score, score, mask ); \
+        spatial_pred = _mm256_blendv_epi8( spatial_pred, \
+                            AVG( L(cur, mrefs + (j)), L(cur, prefs - (j)) ), mask ); \
+    } while(0)
+
+    const __m256i all = _mm256_set1_epi16( -1 );
+    __m256i mask;
+    /* The second check is only done if the first one succeeded */
+    SPATIAL_CHECK(-1, all);
+    SPATIAL_CHECK(-2, mask);
+    SPATIAL_CHECK( 1, all);
+    SPATIAL_CHECK( 2, mask);
+
+    if( mode < 2 )
+    {
+        const __m256i b = AVG( L(prev2, 2 * mrefs), L(next2, 2 * mrefs) );
+        const __m256i f = AVG( L(prev2, 2 * prefs), L(next2, 2 * prefs) );
+        const __m256i dc = _mm256_sub_epi16( d, c );
+        const __m256i de = _mm256_sub_epi16( d, e );
+        const __m256i bc = _mm256_sub_epi16( b, c );
+        const __m256i fe = _mm256_sub_epi16( f, e );
+        const __m256i max = _mm256_max_epi16( _mm256_max_epi16( de, dc ),
+                                              _mm256_min_epi16( bc, fe ) );
+        const __m256i min = _mm256_min_epi16( _mm256_min_epi16( de, dc ),
+                                              _mm256_max_epi16( bc, fe ) );
+        diff = _mm256_max_epi16( _mm256_max_epi16( diff, min ),
+                                 _mm256_sub_epi16( _mm256_setzero_si256(), max ) );
+    }
+
+    spatial_pred = _mm256_max_epi16( spatial_pred, _mm256_sub_epi16( d, diff ) );
+    spatial_pred = _mm256_min_epi16( spatial_pred, _mm256_add_epi16( d, diff ) );
+    yadif_store_avx2( dst, x, spatial_pred, b16 );
+#undef SPATIAL_CHECK
+#undef SCORE
+#undef AVG
+#undef ABSDIFF
+#undef L
+}
+
+__attribute__((__target__("avx2")))
+void yadif_filter_line_avx2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                             uint8_t *next, int w, int prefs, int mrefs,
+                             int parity, int mode )
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+        yadif_pixels_avx2( dst, prev, cur, next, prev2, next2,
+                           x, prefs, mrefs, mode, false );
+    if( x < w )
+        yadif_filter_line_c( dst + x, prev + x, cur + x, next + x,
+                             w - x, prefs, mrefs, parity, mode );
+}
+
+__attribute__((__target__("avx2")))
+void yadif_filter_line_16bit_avx2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                   uint8_t *next, int w, int prefs, int mrefs,
+                                   int parity, int mode )
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+        yadif_pixels_avx2( dst, prev, cur, next, prev2, next2,
+                           x, prefs / 2, mrefs / 2, mode, true );
+    if( x < w )
+        yadif_filter_line_c_16bit( dst + 2 * x, prev + 2 * x, cur + 2 * x,
+                                   next + 2 * x, w - x, prefs, mrefs,
+                                   parity, mode );
+}
+
+/* Bwdif needs 32-bit lanes for its coefficients, 8 samples at a time */
+VLC_AVX2_INLINE __m256i bwdif_load_avx2( const void *p, ptrdiff_t i, bool b16 )
+{
+    if( b16 )
+        return _mm256_cvtepu16_epi32(
+                _mm_loadu_si128( (const __m128i *)((const uint16_t *)p + i) ) );
+    return _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64( (const __m128i *)((const uint8_t *)p + i) ) );
+}
+
+VLC_AVX2_INLINE void bwdif_store_avx2( void *p, ptrdiff_t i, __m256i v, bool b16 )
+{
+    v = _mm256_packus_epi32( v, v );
+    if( b16 )
+    {
+        v = _mm256_permute4x64_epi64( v, 0xD8 );
+        _mm_storeu_si128( (__m128i *)((uint16_t *)p + i),
+                          _mm256_castsi256_si128( v ) );
+        return;
+    }
+    v = _mm256_packus_epi16( v, v );
+    v = _mm256_permutevar8x32_epi32( v, _mm256_setr_epi32( 0, 4, 0, 4,
+                                                           0, 4, 0, 4 ) );
+    _mm_storel_epi64( (__m128i *)((uint8_t *)p + i),
+                      _mm256_castsi256_si128( v ) );
+}
+
+VLC_AVX2_INLINE void bwdif_pixels_avx2( void *dst, const void *prev,
+                                        const void *cur, const void *next,
+                                        const void *prev2, const void *next2,
+                                        ptrdiff_t x, int prefs, int mrefs,
+                                        int prefs2, int mrefs2,
+                                        int prefs3, int mrefs3,
+                                        int prefs4, int mrefs4,
+                                        int clip_max, bool b16 )
+{
+#define L(p, o) bwdif_load_avx2( p, x + (o), b16 )
+#define ABSDIFF(a, b) _mm256_abs_epi32( _mm256_sub_epi32( a, b ) )
+#define MUL(a, k) _mm256_mullo_epi32( a, _mm256_set1_epi32( k ) )
+    const __m256i c = L(cur, mrefs);
+    const __m256i e = L(cur, prefs);
+    const __m256i p2 = L(prev2, 0);
+    const __m256i n2 = L(next2, 0);
+    const __m256i d = _mm256_srai_epi32( _mm256_add_epi32( p2, n2 ), 1 );
+
+    const __m256i temporal_diff0 = ABSDIFF( p2, n2 );
+    const __m256i temporal_diff1 = _mm256_srai_epi32(
+            _mm256_add_epi32( ABSDIFF( L(prev, mrefs), c ),
+                              ABSDIFF( L(prev, prefs), e ) ), 1 );
+    const __m256i temporal_diff2 = _mm256_srai_epi32(
+            _mm256_add_epi32( ABSDIFF( L(next, mrefs), c ),
+                              ABSDIFF( L(next, prefs), e ) ), 1 );
+    __m256i diff = _mm256_max_epi32(
+            _mm256_max_epi32( _mm256_srai_epi32( temporal_diff0, 1 ),
+                              temporal_diff1 ), temporal_diff2 );
+    const __m256i still = _mm256_cmpeq_epi32( diff, _mm256_setzero_si256() );
+
+    /* spatial check */
+    const __m256i m2 = _mm256_add_epi32( L(prev2, mrefs2), L(next2, mrefs2) );
+    const __m256i p2s = _mm256_add_epi32( L(prev2, prefs2), L(next2, prefs2) );
+    const __m256i b = _mm256_sub_epi32( _mm256_srai_epi32( m2, 1 ), c );
+    const __m256i f = _mm256_sub_epi32( _mm256_srai_epi32( p2s, 1 ), e );
+    const __m256i dc = _mm256_sub_epi32( d, c );
+    const __m256i de = _mm256_sub_epi32( d, e );
+    const __m256i max = _mm256_max_epi32( _mm256_max_epi32( de, dc ),
+                                          _mm256_min_epi32( b, f ) );
+    const __m256i min = _mm256_min_epi32( _mm256_min_epi32( de, dc ),
+                                          _mm256_max_epi32( b, f ) );
+    diff = _mm256_max_epi32( _mm256_max_epi32( diff, min ),
+                             _mm256_sub_epi32( _mm256_setzero_si256(), max ) );
+
+    /* interpolation */
+    const __m256i ce = _mm256_add_epi32( c, e );
+    const __m256i cur3 = _mm256_add_epi32( L(cur, mrefs3), L(cur, prefs3) );
+    const __m256i m4 = _mm256_add_epi32(
+            _mm256_add_epi32( L(prev2, mrefs4), L(next2, mrefs4) ),
+            _mm256_add_epi32( L(prev2, prefs4), L(next2, prefs4) ) );
+    __m256i hf = _mm256_sub_epi32(
+            _mm256_add_epi32( MUL( _mm256_add_epi32( p2, n2 ), BWDIF_COEF_HF0 ),
+                              MUL( m4, BWDIF_COEF_HF2 ) ),
+            MUL( _mm256_add_epi32( m2, p2s ), BWDIF_COEF_HF1 ) );
+    hf = _mm256_add_epi32( _mm256_srai_epi32( hf, 2 ),
+                           _mm256_sub_epi32( MUL( ce, BWDIF_COEF_LF0 ),
+                                             MUL( cur3, BWDIF_COEF_LF1 ) ) );
+    hf = _mm256_srai_epi32( hf, 13 );
+    const __m256i sp = _mm256_srai_epi32(
+            _mm256_sub_epi32( MUL( ce, BWDIF_COEF_SP0 ),
+                              MUL( cur3, BWDIF_COEF_SP1 ) ), 13 );
+    __m256i interpol = _mm256_blendv_epi8( sp, hf,
+            _mm256_cmpgt_epi32( ABSDIFF( c, e ), temporal_diff0 ) );
+
+    interpol = _mm256_max_epi32( interpol, _mm256_sub_epi32( d, diff ) );
+    interpol = _mm256_min_epi32( interpol, _mm256_add_epi32( d, diff ) );
+    interpol = _mm256_max_epi32( interpol, _mm256_setzero_si256() );
+    interpol = _mm256_min_epi32( interpol, _mm256_set1_epi32( clip_max ) );
+
+    bwdif_store_avx2( dst, x, _mm256_blendv_epi8( interpol, d, still ), b16 );
+#undef MUL
+#undef ABSDIFF
+#undef L
+}
+
+__attribute__((__target__("avx2")))
+void bwdif_filter_line_avx2( void *dst, const void *prev, const void *cur,
+                             const void *next, int w, int prefs, int mrefs,
+                             int prefs2, int mrefs2, int prefs3, int mrefs3,
+                             int prefs4, int mrefs4, int parity, int clip_max )
+{
+    const void *prev2 = parity ? prev : cur;
+    const void *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        bwdif_pixels_avx2( dst, prev, cur, next, prev2, next2, x,
+                           prefs, mrefs, prefs2, mrefs2, prefs3, mrefs3,
+                           prefs4, mrefs4, clip_max, false );
+    if( x < w )
+        bwdif_filter_line_c( (uint8_t *)dst + x, (const uint8_t *)prev + x,
+                             (const uint8_t *)cur + x, (const uint8_t *)next + x,
+                             w - x, prefs, mrefs, prefs2, mrefs2,
+                             prefs3, mrefs3, prefs4, mrefs4, parity, clip_max );
+}
+
+__attribute__((__target__("avx2")))
+void bwdif_filter_line_16bit_avx2( void *dst, const void *prev,
+                                   const void *cur, const void *next, int w,
+                                   int prefs, int mrefs, int prefs2, int mrefs2,
+                                   int prefs3, int mrefs3, int prefs4,
+                                   int mrefs4, int parity, int clip_max )
+{
+    const void *prev2 = parity ? prev : cur;
+    const void *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        bwdif_pixels_avx2( dst, prev, cur, next, prev2, next2, x,
+                           prefs, mrefs, prefs2, mrefs2, prefs3, mrefs3,
+                           prefs4, mrefs4, clip_max, true );
+    if( x < w )
+        bwdif_filter_line_c_16bit( (uint16_t *)dst + x,
+                                   (const uint16_t *)prev + x,
+                                   (const uint16_t *)cur + x,
+                                   (const uint16_t *)next + x,
+                                   w - x, prefs, mrefs, prefs2, mrefs2,
+                                   prefs3, mrefs3, prefs4, mrefs4,
+                                   parity, clip_max );
+}
+#endif /* CAN_COMPILE_LINE_FILTERS_AVX2 */
+
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+#ifdef CAN_COMPILE_LINE_FILTERS_NEON
+#include <arm_neon.h>
+
+/* Yadif works on 16-bit lanes, 8 samples at a time */
+static inline int16x8_t yadif_load_neon( const void *p, ptrdiff_t i, bool b16 )
+{
+    if( b16 )
+        return vreinterpretq_s16_u16( vld1q_u16( (const uint16_t *)p + i ) );
+    return vreinterpretq_s16_u16( vmovl_u8( vld1_u8( (const uint8_t *)p + i ) ) );
+}
+
+static inline void yadif_store_neon( void *p, ptrdiff_t i, int16x8_t v, bool b16 )
+{
+    if( b16 )
+        vst1q_u16( (uint16_t *)p + i, vreinterpretq_u16_s16( v ) );
+    else
+        vst1_u8( (uint8_t *)p + i, vqmovun_s16( v ) );
+}
+
+static inline void yadif_pixels_neon( void *dst, const void *prev,
+                                      const void *cur, const void *next,
+                                      const void *prev2, const void *next2,
+                                      ptrdiff_t x, int prefs, int mrefs,
+                                      int mode, bool b16 )
+{
+#define L(p, o) yadif_load_neon( p, x + (o), b16 )
+#define AVG(a, b) vshrq_n_s16( vaddq_s16( a, b ), 1 )
+    const int16x8_t c = L(cur, mrefs);
+    const int16x8_t e = L(cur, prefs);
+    const int16x8_t p2 = L(prev2, 0);
+    const int16x8_t n2 = L(next2, 0);
+    const int16x8_t d = AVG( p2, n2 );
+
+    const int16x8_t temporal_diff0 = vabdq_s16( p2, n2 );
+    const int16x8_t temporal_diff1 = vshrq_n_s16(
+            vaddq_s16( vabdq_s16( L(prev, mrefs), c ),
+                       vabdq_s16( L(prev, prefs), e ) ), 1 );
+    const int16x8_t temporal_diff2 = vshrq_n_s16(
+            vaddq_s16( vabdq_s16( L(next, mrefs), c ),
+                       vabdq_s16( L(next, prefs), e ) ), 1 );
+    int16x8_t diff = vmaxq_s16( vmaxq_s16( vshrq_n_s16( temporal_diff0, 1 ),
+                                           temporal_diff1 ), temporal_diff2 );
+
+    int16x8_t spatial_pred = AVG( c, e );
+    int16x8_t spatial_score = vsubq_s16(
+            vaddq_s16( vaddq_s16( vabdq_s16( L(cur, mrefs - 1), L(cur, prefs - 1) ),
+                                  vabdq_s16( c, e ) ),
+                       vabdq_s16( L(cur, mrefs + 1), L(cur, prefs + 1) ) ),
+            vdupq_n_s16( 1 ) );
+
+#define SCORE(j) \
+    vaddq_s16( vaddq_s16( vabdq_s16( L(cur, mrefs - 1 + (j)), L(cur, prefs - 1 - (j)) ), \
+                          vabdq_s16( L(cur, mrefs + (j)), L(cur, prefs - (j)) ) ), \
+               vabdq_s16( L(cur, mrefs + 1 + (j)), L(cur, prefs + 1 - (j)) ) )
+#define SPATIAL_CHECK(j, outer) do { \
+        const int16x8_t score = SCORE(j); \
+        mask = vandq_u16( outer, vcgtq_s16( spatial_score, score ) ); \
+        spatial_score = vbslq_s16( mask, score, spatial_score ); \
+        spatial_pred = vbslq_s16( mask, AVG( L(cur, mrefs + (j)), \
+                                             L(cur, prefs - (j)) ), spatial_pred ); \
+    } while(0)
+
+    const uint16x8_t all = vdupq_n_u16( 0xffff );
+    uint16x8_t mask;
+    /* The second check is only done if the first one succeeded */
+    SPATIAL_CHECK(-1, all);
+    SPATIAL_CHECK(-2, mask);
+    SPATIAL_CHECK( 1, all);
+    SPATIAL_CHECK( 2, mask);
+
+    if( mode < 2 )
+    {
+        const int16x8_t b = AVG( L(prev2, 2 * mrefs), L(next2, 2 * mrefs) );
+        const int16x8_t f = AVG( L(prev2, 2 * prefs), L(next2, 2 * prefs) );
+        const int16x8_t dc = vsubq_s16( d, c );
+        const int16x8_t de = vsubq_s16( d, e );
+        const int16x8_t bc = vsubq_s16( b, c );
+        const int16x8_t fe = vsubq_s16( f, e );
+        const int16x8_t max = vmaxq_s16( vmaxq_s16( de, dc ), vminq_s16( bc, fe ) );
+        const int16x8_t min = vminq_s16( vminq_s16( de, dc ), vmaxq_s16( bc, fe ) );
+        diff = vmaxq_s16( vmaxq_s16( diff, min ), vnegq_s16( max ) );
+    }
+
+    spatial_pred = vmaxq_s16( spatial_pred, vsubq_s16( d, diff ) );
+    spatial_pred = vminq_s16( spatial_pred, vaddq_s16( d, diff ) );
+    yadif_store_neon( dst, x, spatial_pred, b16 );
+#undef SPATIAL_CHECK
+#undef SCORE
+#undef AVG
+#undef L
+}
+
+void yadif_filter_line_neon( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                             uint8_t *next, int w, int prefs, int mrefs,
+                             int parity, int mode )
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        yadif_pixels_neon( dst, prev, cur, next, prev2, next2,
+                           x, prefs, mrefs, mode, false );
+    if( x < w )
+        yadif_filter_line_c( dst + x, prev + x, cur + x, next + x,
+                             w - x, prefs, mrefs, parity, mode );
+}
+
+void yadif_filter_line_16bit_neon( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                   uint8_t *next, int w, int prefs, int mrefs,
+                                   int parity, int mode )
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        yadif_pixels_neon( dst, prev, cur, next, prev2, next2,
+                           x, prefs / 2, mrefs / 2, mode, true );
+    if( x < w )
+        yadif_filter_line_c_16bit( dst + 2 * x, prev + 2 * x, cur + 2 * x,
+                                   next + 2 * x, w - x, prefs, mrefs,
+                                   parity, mode );
+}
+
+/* Bwdif needs 32-bit lanes for its coefficients, 8 samples at a time in two
+ * halves */
+static inline int32x4x2_t bwdif_load_neon( const void *p, ptrdiff_t i, bool b16 )
+{
+    uint16x8_t v;
+    if( b16 )
+        v = vld1q_u16( (const uint16_t *)p + i );
+    else
+        v = vmovl_u8( vld1_u8( (const uint8_t *)p + i ) );
+
+    int32x4x2_t r;
+    r.val[0] = vreinterpretq_s32_u32( vmovl_u16( vget_low_u16( v ) ) );
+    r.val[1] = vreinterpretq_s32_u32( vmovl_u16( vget_high_u16( v ) ) );
+    return r;
+}
+
+static inline int32x4_t bwdif_half_neon( int32x4_t c, int32x4_t e,
+                                         int32x4_t p2, int32x4_t n2,
+                                         int32x4_t pm, int32x4_t pp,
+                                         int32x4_t nm, int32x4_t np,
+                                         int32x4_t m2, int32x4_t p2s,
+                                         int32x4_t m4, int32x4_t cur3,
+                                         int32x4_t clip_max )
+{
+    const int32x4_t d = vshrq_n_s32( vaddq_s32( p2, n2 ), 1 );
+
+    const int32x4_t temporal_diff0 = vabdq_s32( p2, n2 );
+    const int32x4_t temporal_diff1 = vshrq_n_s32(
+            vaddq_s32( vabdq_s32( pm, c ), vabdq_s32( pp, e ) ), 1 );
+    const int32x4_t temporal_diff2 = vshrq_n_s32(
+            vaddq_s32( vabdq_s32( nm, c ), vabdq_s32( np, e ) ), 1 );
+    int32x4_t diff = vmaxq_s32( vmaxq_s32( vshrq_n_s32( temporal_diff0, 1 ),
+                                           temporal_diff1 ), temporal_diff2 );
+    const uint32x4_t still = vceqq_s32( diff, vdupq_n_s32( 0 ) );
+
+    /* spatial check */
+    const int32x4_t b = vsubq_s32( vshrq_n_s32( m2, 1 ), c );
+    const int32x4_t f = vsubq_s32( vshrq_n_s32( p2s, 1 ), e );
+    const int32x4_t dc = vsubq_s32( d, c );
+    const int32x4_t de = vsubq_s32( d, e );
+    const int32x4_t max = vmaxq_s32( vmaxq_s32( de, dc ), vminq_s32( b, f ) );
+    const int32x4_t min = vminq_s32( vminq_s32( de, dc ), vmaxq_s32( b, f ) );
+    diff = vmaxq_s32( vmaxq_s32( diff, min ), vnegq_s32( max ) );
+
+    /* interpolation */
+    const int32x4_t ce = vaddq_s32( c, e );
+    int32x4_t hf = vsubq_s32(
+            vaddq_s32( vmulq_n_s32( vaddq_s32( p2, n2 ), BWDIF_COEF_HF0 ),
+                       vmulq_n_s32( m4, BWDIF_COEF_HF2 ) ),
+            vmulq_n_s32( vaddq_s32( m2, p2s ), BWDIF_COEF_HF1 ) );
+    hf = vaddq_s32( vshrq_n_s32( hf, 2 ),
+                    vsubq_s32( vmulq_n_s32( ce, BWDIF_COEF_LF0 ),
+                               vmulq_n_s32( cur3, BWDIF_COEF_LF1 ) ) );
+    hf = vshrq_n_s32( hf, 13 );
+    const int32x4_t sp = vshrq_n_s32(
+            vsubq_s32( vmulq_n_s32( ce, BWDIF_COEF_SP0 ),
+                       vmulq_n_s32( cur3, BWDIF_COEF_SP1 ) ), 13 );
+    int32x4_t interpol = vbslq_s32( vcgtq_s32( vabdq_s32( c, e ), temporal_diff0 ),
+                                    hf, sp );
+
+    interpol = vmaxq_s32( interpol, vsubq_s32( d, diff ) );
+    interpol = vminq_s32( interpol, vaddq_s32( d, diff ) );
+    interpol = vmaxq_s32( interpol, vdupq_n_s32( 0 ) );
+    interpol = vminq_s32( interpol, clip_max );
+
+    return vbslq_s32( still, d, interpol );
+}
+
+static inline void bwdif_pixels_neon( void *dst, const void *prev,
+                                      const void *cur, const void *next,
+                                      const void *prev2, const void *next2,
+                                      ptrdiff_t x, int prefs, int mrefs,
+                                      int prefs2, int mrefs2,
+                                      int prefs3, int mrefs3,
+                                      int prefs4, int mrefs4,
+                                      int clip_max, bool b16 )
+{
+#define L(p, o) bwdif_load_neon( p, x + (o), b16 )
+    const int32x4x2_t c = L(cur, mrefs);
+    const int32x4x2_t e = L(cur, prefs);
+    const int32x4x2_t p2 = L(prev2, 0);
+    const int32x4x2_t n2 = L(next2, 0);
+    const int32x4x2_t pm = L(prev, mrefs);
+    const int32x4x2_t pp = L(prev, prefs);
+    const int32x4x2_t nm = L(next, mrefs);
+    const int32x4x2_t np = L(next, prefs);
+    const int32x4x2_t p2m2 = L(prev2, mrefs2);
+    const int32x4x2_t n2m2 = L(next2, mrefs2);
+    const int32x4x2_t p2p2 = L(prev2, prefs2);
+    const int32x4x2_t n2p2 = L(next2, prefs2);
+    const int32x4x2_t p2m4 = L(prev2, mrefs4);
+    const int32x4x2_t n2m4 = L(next2, mrefs4);
+    const int32x4x2_t p2p4 = L(prev2, prefs4);
+    const int32x4x2_t n2p4 = L(next2, prefs4);
+    const int32x4x2_t cm3 = L(cur, mrefs3);
+    const int32x4x2_t cp3 = L(cur, prefs3);
+#undef L
+    const int32x4_t max = vdupq_n_s32( clip_max );
+    int32x4_t r[2];
+
+    for( int h = 0; h < 2; h++ )
+        r[h] = bwdif_half_neon( c.val[h], e.val[h], p2.val[h], n2.val[h],
+                                pm.val[h], pp.val[h], nm.val[h], np.val[h],
+                                vaddq_s32( p2m2.val[h], n2m2.val[h] ),
+                                vaddq_s32( p2p2.val[h], n2p2.val[h] ),
+                                vaddq_s32( vaddq_s32( p2m4.val[h], n2m4.val[h] ),
+                                           vaddq_s32( p2p4.val[h], n2p4.val[h] ) ),
+                                vaddq_s32( cm3.val[h], cp3.val[h] ), max );
+
+    const uint16x8_t v = vcombine_u16( vqmovun_s32( r[0] ), vqmovun_s32( r[1] ) );
+    if( b16 )
+        vst1q_u16( (uint16_t *)dst + x, v );
+    else
+        vst1_u8( (uint8_t *)dst + x, vqmovn_u16( v ) );
+}
+
+void bwdif_filter_line_neon( void *dst, const void *prev, const void *cur,
+                             const void *next, int w, int prefs, int mrefs,
+                             int prefs2, int mrefs2, int prefs3, int mrefs3,
+                             int prefs4, int mrefs4, int parity, int clip_max )
+{
+    const void *prev2 = parity ? prev : cur;
+    const void *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        bwdif_pixels_neon( dst, prev, cur, next, prev2, next2, x,
+                           prefs, mrefs, prefs2, mrefs2, prefs3, mrefs3,
+                           prefs4, mrefs4, clip_max, false );
+    if( x < w )
+        bwdif_filter_line_c( (uint8_t *)dst + x, (const uint8_t *)prev + x,
+                             (const uint8_t *)cur + x, (const uint8_t *)next + x,
+                             w - x, prefs, mrefs, prefs2, mrefs2,
+                             prefs3, mrefs3, prefs4, mrefs4, parity, clip_max );
+}
+
+void bwdif_filter_line_16bit_neon( void *dst, const void *prev,
+                                   const void *cur, const void *next, int w,
+                                   int prefs, int mrefs, int prefs2, int mrefs2,
+                                   int prefs3, int mrefs3, int prefs4,
+                                   int mrefs4, int parity, int clip_max )
+{
+    const void *prev2 = parity ? prev : cur;
+    const void *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+        bwdif_pixels_neon( dst, prev, cur, next, prev2, next2, x,
+                           prefs, mrefs, prefs2, mrefs2, prefs3, mrefs3,
+                           prefs4, mrefs4, clip_max, true );
+    if( x < w )
+        bwdif_filter_line_c_16bit( (uint16_t *)dst + x,
+                                   (const uint16_t *)prev + x,
+                                   (const uint16_t *)cur + x,
+                                   (const uint16_t *)next + x,
+                                   w - x, prefs, mrefs, prefs2, mrefs2,
+                                   prefs3, mrefs3, prefs4, mrefs4,
+                                   parity, clip_max );
+}
+#endif /* CAN_COMPILE_LINE_FILTERS_NEON */
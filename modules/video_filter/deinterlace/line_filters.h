@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * line_filters.h : SIMD line filters for the Yadif and Bwdif algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DEINTERLACE_LINE_FILTERS_H
+#define VLC_DEINTERLACE_LINE_FILTERS_H 1
+
+/**
+ * \file
+ * Vectorized versions of the yadif_filter_line_c() and bwdif_filter_line_c()
+ * families. They compute the same output as the C versions, bit for bit.
+ *
+ * The 16-bit versions only support samples of up to 12 bits for Yadif.
+ */
+
+#include <stdint.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef HAVE_AVX2_INTRINSICS
+#  define CAN_COMPILE_LINE_FILTERS_AVX2 1
+void yadif_filter_line_avx2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                             uint8_t *next, int w, int prefs, int mrefs,
+                             int parity, int mode );
+void yadif_filter_line_16bit_avx2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                   uint8_t *next, int w, int prefs, int mrefs,
+                                   int parity, int mode );
+void bwdif_filter_line_avx2( void *dst, const void *prev, const void *cur,
+                             const void *next, int w, int prefs, int mrefs,
+                             int prefs2, int mrefs2, int prefs3, int mrefs3,
+                             int prefs4, int mrefs4, int parity, int clip_max );
+void bwdif_filter_line_16bit_avx2( void *dst, const void *prev,
+                                   const void *cur, const void *next, int w,
+                                   int prefs, int mrefs, int prefs2, int mrefs2,
+                                   int prefs3, int mrefs3, int prefs4,
+                                   int mrefs4, int parity, int clip_max );
+# endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# define CAN_COMPILE_LINE_FILTERS_NEON 1
+void yadif_filter_line_neon( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                             uint8_t *next, int w, int prefs, int mrefs,
+                             int parity, int mode );
+void yadif_filter_line_16bit_neon( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                   uint8_t *next, int w, int prefs, int mrefs,
+                                   int parity, int mode );
+void bwdif_filter_line_neon( void *dst, const void *prev, const void *cur,
+                             const void *next, int w, int prefs, int mrefs,
+                             int prefs2, int mrefs2, int prefs3, int mrefs3,
+                             int prefs4, int mrefs4, int parity, int clip_max );
+void bwdif_filter_line_16bit_neon( void *dst, const void *prev,
+                                   const void *cur, const void *next, int w,
+                                   int prefs, int mrefs, int prefs2, int mrefs2,
+                                   int prefs3, int mrefs3, int prefs4,
+                                   int mrefs4, int parity, int clip_max );
+#endif
+
+#endif
@@ -179,11 +179,101 @@ static void Destroy( filter_t *p_filter )
     free( p_sys );
 }
 
+struct blur_slices
+{
+    filter_sys_t *p_sys;
+    picture_t *p_pic;
+    picture_t *p_outpic;
+    int i_plane;
+};
+
+static void BlurHorizontal( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct blur_slices *slices = opaque;
+    filter_sys_t *p_sys = slices->p_sys;
+    const picture_t *p_pic = slices->p_pic;
+    const int i_plane = slices->i_plane;
+    const int i_dim = p_sys->i_dim;
+    type_t *pt_buffer = p_sys->pt_buffer;
+    const type_t *pt_distribution = p_sys->pt_distribution;
+
+    const uint8_t *p_in = p_pic->p[i_plane].p_pixels;
+
+    const int i_visible_lines = p_pic->p[i_plane].i_visible_lines;
+    const int i_visible_pitch = p_pic->p[i_plane].i_visible_pitch;
+    const int i_in_pitch = p_pic->p[i_plane].i_pitch;
+
+    const int x_factor = p_pic->p[Y_PLANE].i_visible_pitch/i_visible_pitch-1;
+    int i_begin, i_end;
+
+    filter_GetSliceLines( i_visible_lines, i_slice, i_count, &i_begin, &i_end );
+
+    for( int i_line = i_begin; i_line < i_end; i_line++ )
+    {
+        for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
+        {
+            type_t t_value = 0;
+            const int c = i_line*i_in_pitch+i_col;
+            for( int x = __MAX( -i_dim, -i_col*(x_factor+1) );
+                 x <= __MIN( i_dim, (i_visible_pitch - i_col)*(x_factor+1) + 1 );
+                 x++ )
+            {
+                t_value += pt_distribution[x+i_dim] *
+                           p_in[c+(x>>x_factor)];
+            }
+            pt_buffer[c] = t_value;
+        }
+    }
+}
+
+static void BlurVertical( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct blur_slices *slices = opaque;
+    filter_sys_t *p_sys = slices->p_sys;
+    const picture_t *p_pic = slices->p_pic;
+    picture_t *p_outpic = slices->p_outpic;
+    const int i_plane = slices->i_plane;
+    const int i_dim = p_sys->i_dim;
+    const type_t *pt_buffer = p_sys->pt_buffer;
+    const type_t *pt_scale = p_sys->pt_scale;
+    const type_t *pt_distribution = p_sys->pt_distribution;
+
+    uint8_t *p_out = p_outpic->p[i_plane].p_pixels;
+
+    const int i_visible_lines = p_pic->p[i_plane].i_visible_lines;
+    const int i_visible_pitch = p_pic->p[i_plane].i_visible_pitch;
+    const int i_in_pitch = p_pic->p[i_plane].i_pitch;
+
+    const int x_factor = p_pic->p[Y_PLANE].i_visible_pitch/i_visible_pitch-1;
+    const int y_factor = p_pic->p[Y_PLANE].i_visible_lines/i_visible_lines-1;
+    int i_begin, i_end;
+
+    filter_GetSliceLines( i_visible_lines, i_slice, i_count, &i_begin, &i_end );
+
+    for( int i_line = i_begin; i_line < i_end; i_line++ )
+    {
+        for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
+        {
+            type_t t_value = 0;
+            const int c = i_line*i_in_pitch+i_col;
+            for( int y = __MAX( -i_dim, (-i_line)*(y_factor+1) );
+                 y <= __MIN( i_dim, (i_visible_lines - i_line)*(y_factor+1) - 1 );
+                 y++ )
+            {
+                t_value += pt_distribution[y+i_dim] *
+                           pt_buffer[c+(y>>y_factor)*i_in_pitch];
+            }
+
+            const type_t t_scale = pt_scale[(i_line<<y_factor)*(i_in_pitch<<x_factor)+(i_col<<x_factor)];
+            p_out[i_line * p_outpic->p[i_plane].i_pitch + i_col] = (uint8_t)(t_value / t_scale); // FIXME wouldn't it be better to round instead of trunc ?
+        }
+    }
+}
+
 static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     const int i_dim = p_sys->i_dim;
-    type_t *pt_buffer;
     type_t *pt_scale;
     const type_t *pt_distribution = p_sys->pt_distribution;
 
@@ -194,7 +284,6 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
                                p_pic->p[Y_PLANE].i_pitch * sizeof( type_t ) );
     }
 
-    pt_buffer = p_sys->pt_buffer;
     if( !p_sys->pt_scale )
     {
         const int i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
@@ -227,53 +316,21 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
         }
     }
 
-    pt_scale = p_sys->pt_scale;
+    struct blur_slices slices = {
+        .p_sys = p_sys,
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+    };
+
     for( int i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
-
-        uint8_t *p_in = p_pic->p[i_plane].p_pixels;
-        uint8_t *p_out = p_outpic->p[i_plane].p_pixels;
-
-        const int i_visible_lines = p_pic->p[i_plane].i_visible_lines;
-        const int i_visible_pitch = p_pic->p[i_plane].i_visible_pitch;
-        const int i_in_pitch = p_pic->p[i_plane].i_pitch;
-
-        const int x_factor = p_pic->p[Y_PLANE].i_visible_pitch/i_visible_pitch-1;
-        const int y_factor = p_pic->p[Y_PLANE].i_visible_lines/i_visible_lines-1;
-
-        for( int i_line = 0; i_line < i_visible_lines; i_line++ )
-        {
-            for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
-            {
-                type_t t_value = 0;
-                const int c = i_line*i_in_pitch+i_col;
-                for( int x = __MAX( -i_dim, -i_col*(x_factor+1) );
-                     x <= __MIN( i_dim, (i_visible_pitch - i_col)*(x_factor+1) + 1 );
-                     x++ )
-                {
-                    t_value += pt_distribution[x+i_dim] *
-                               p_in[c+(x>>x_factor)];
-                }
-                pt_buffer[c] = t_value;
-            }
-        }
-        for( int i_line = 0; i_line < i_visible_lines; i_line++ )
-        {
-            for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
-            {
-                type_t t_value = 0;
-                const int c = i_line*i_in_pitch+i_col;
-                for( int y = __MAX( -i_dim, (-i_line)*(y_factor+1) );
-                     y <= __MIN( i_dim, (i_visible_lines - i_line)*(y_factor+1) - 1 );
-                     y++ )
-                {
-                    t_value += pt_distribution[y+i_dim] *
-                               pt_buffer[c+(y>>y_factor)*i_in_pitch];
-                }
-
-                const type_t t_scale = pt_scale[(i_line<<y_factor)*(i_in_pitch<<x_factor)+(i_col<<x_factor)];
-                p_out[i_line * p_outpic->p[i_plane].i_pitch + i_col] = (uint8_t)(t_value / t_scale); // FIXME wouldn't it be better to round instead of trunc ?
-            }
-        }
+        const unsigned i_max_slices = p_pic->p[i_plane].i_visible_lines / 16;
+
+        /* The vertical pass needs all the lines of the horizontal pass */
+        slices.i_plane = i_plane;
+        filter_ExecuteSlices( p_filter, i_max_slices, BlurHorizontal,
+                              &slices );
+        filter_ExecuteSlices( p_filter, i_max_slices, BlurVertical,
+                              &slices );
     }
 }
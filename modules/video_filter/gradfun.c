@@ -48,6 +48,8 @@ static int  Open (filter_t *);
 #define RADIUS_TEXT N_("Radius")
 #define RADIUS_LONGTEXT N_("Radius in pixels")
 
+#define GRADFUN_MAX_SLICES (16)
+
 #define STRENGTH_MIN (0.51f)
 #define STRENGTH_MAX (255)
 #define STRENGTH_TEXT N_("Strength")
@@ -158,6 +160,76 @@ static void Close(filter_t *filter)
     free(sys);
 }
 
+/* Size of the buffer of one slice, in samples, as a multiple of 16 bytes */
+static size_t GetBufferSize(int width, int radius)
+{
+    return ((((width + 15) & ~15) * (radius + 1) / 2 + 32) + 7) & ~7;
+}
+
+/* First line of a slice of a plane. The running sums need r lines above
+ * the slice, and must be computed at least once in each slice. */
+static int GetSliceStart(int h, int r, unsigned slice, unsigned count)
+{
+    const int lo = r + 2;
+    const int hi = (h - r - 1) & ~1;
+
+    if (slice == 0)
+        return 0;
+    if (slice == count || lo > hi)
+        return h;
+
+    int begin, end;
+    filter_GetSliceLines(h, slice, count, &begin, &end);
+    return VLC_CLIP(begin & ~1, lo, hi);
+}
+
+struct filter_slices
+{
+    filter_sys_t *sys;
+    const video_format_t *fmt;
+    picture_t *src;
+    picture_t *dst;
+    size_t buf_size;
+};
+
+static void FilterSlice(void *opaque, unsigned slice, unsigned count)
+{
+    const struct filter_slices *slices = opaque;
+    filter_sys_t *sys = slices->sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+    const video_format_t *fmt = slices->fmt;
+    uint16_t *buf = cfg->buf + slice * slices->buf_size;
+
+    for (int i = 0; i < slices->dst->i_planes; i++) {
+        const plane_t *srcp = &slices->src->p[i];
+        plane_t       *dstp = &slices->dst->p[i];
+
+        const vlc_chroma_description_t *chroma = sys->chroma;
+        int w = fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
+        int h = fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
+                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
+        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
+        if (__MIN(w, h) > 2 * r && cfg->buf) {
+            int begin = GetSliceStart(h, r, slice, count);
+            int end = GetSliceStart(h, r, slice + 1, count);
+            if (begin < end)
+                filter_plane(cfg, buf, dstp->p_pixels, srcp->p_pixels,
+                             w, h, dstp->i_pitch, srcp->i_pitch, r,
+                             begin, end);
+        } else {
+            int begin, end;
+            filter_GetSliceLines(__MIN(dstp->i_visible_lines,
+                                       srcp->i_visible_lines),
+                                 slice, count, &begin, &end);
+            for (int y = begin; y < end; y++)
+                memcpy(&dstp->p_pixels[y * dstp->i_pitch],
+                       &srcp->p_pixels[y * srcp->i_pitch],
+                       __MIN(dstp->i_visible_pitch, srcp->i_visible_pitch));
+        }
+    }
+}
+
 static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -169,31 +241,29 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 
     const video_format_t *fmt = &filter->fmt_in.video;
     struct vf_priv_s *cfg = &sys->cfg;
+    const size_t buf_size = GetBufferSize(fmt->i_width, radius);
 
     cfg->thresh = (1 << 15) / strength;
     if (cfg->radius != radius) {
         cfg->radius = radius;
-        cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+        aligned_free(cfg->buf);
+        cfg->buf    = aligned_alloc(16, GRADFUN_MAX_SLICES * buf_size *
+                                        sizeof(*cfg->buf));
     }
 
-    for (int i = 0; i < dst->i_planes; i++) {
-        const plane_t *srcp = &src->p[i];
-        plane_t       *dstp = &dst->p[i];
-
-        const vlc_chroma_description_t *chroma = sys->chroma;
-        int w = fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        int h = fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
-        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
-                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
-        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
-        if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
-        } else {
-            plane_CopyPixels(dstp, srcp);
-        }
-    }
+    struct filter_slices slices = {
+        .sys = sys,
+        .fmt = fmt,
+        .src = src,
+        .dst = dst,
+        .buf_size = buf_size,
+    };
+    /* Each slice computes the running sums of up to RADIUS_MAX lines
+     * above it, so keep them reasonably high */
+    filter_ExecuteSlices(filter,
+                         __MIN(fmt->i_height / (4 * RADIUS_MAX),
+                               GRADFUN_MAX_SLICES),
+                         FilterSlice, &slices);
 }
 
 static int Callback(vlc_object_t *object, char const *cmd,
@@ -172,19 +172,35 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
-static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+/* Filters the lines [y_begin, y_end) of a plane. y_begin is either 0, or an
+ * even line such that r < y_begin < height - r. */
+static void filter_plane(struct vf_priv_s *ctx, uint16_t *ctx_buf,
+                         uint8_t *dst, uint8_t *src,
+                         int width, int height, int dstride, int sstride, int r,
+                         int y_begin, int y_end)
 {
     int bstride = ((width+15)&~15)/2;
     int y;
     uint32_t dc_factor = (1<<21)/(r*r);
-    uint16_t *dc = ctx->buf+16;
-    uint16_t *buf = ctx->buf+bstride+32;
+    uint16_t *dc = ctx_buf+16;
+    uint16_t *buf = ctx_buf+bstride+32;
     int thresh = ctx->thresh;
 
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
+    if (y_begin == 0) {
+        for (y=0; y<r; y++)
+            ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
+    } else {
+        /* Fill the ring buffer with the running sums of the r block lines
+         * above the slice. Only their differences are used, so they can
+         * start from zero there. */
+        int b = (y_begin+r)/2 - r;
+        for (int k=b; k<b+r; k++)
+            ctx->blur_line(dc, buf+(k%r)*bstride,
+                           k > b ? buf+((k-1)%r)*bstride : buf-bstride,
+                           src+2*k*sstride, sstride, width/2);
+        y = y_begin;
+    }
     for (;;) {
         if (y < height-r) {
             int mod = ((y+r)/2)%r;
@@ -208,9 +224,9 @@ static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
                 ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
         }
         ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        if (++y >= y_end) break;
         ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        if (++y >= y_end) break;
     }
 }
 
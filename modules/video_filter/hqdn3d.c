@@ -135,10 +135,16 @@ static int Open(filter_t *filter)
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
     }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
-        free(sys);
-        return VLC_ENOMEM;
+    /* One line buffer per plane, so that the planes can be denoised
+     * in parallel */
+    for (int i = 0; i < 3; ++i) {
+        cfg->Line[i] = malloc(wmax*sizeof(unsigned int));
+        if (!cfg->Line[i]) {
+            while (i--)
+                free(cfg->Line[i]);
+            free(sys);
+            return VLC_ENOMEM;
+        }
     }
 
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
@@ -183,14 +189,39 @@ static void Close(filter_t *filter)
 
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
+        free(cfg->Line[i]);
     }
-    free(cfg->Line);
     free(sys);
 }
 
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+struct denoise_slices
+{
+    filter_sys_t *sys;
+    picture_t *src;
+    picture_t *dst;
+};
+
+static void DenoiseSlice(void *opaque, unsigned slice, unsigned count)
+{
+    const struct denoise_slices *slices = opaque;
+    filter_sys_t *sys = slices->sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    for (unsigned i = slice; i < 3; i += count) {
+        /* Luma and chroma coefficients */
+        int *spat = cfg->Coefs[i ? 2 : 0];
+        int *temp = cfg->Coefs[i ? 3 : 1];
+
+        deNoise(slices->src->p[i].p_pixels, slices->dst->p[i].p_pixels,
+                cfg->Line[i], &cfg->Frame[i], sys->w[i], sys->h[i],
+                slices->src->p[i].i_pitch, slices->dst->p[i].i_pitch,
+                spat, spat, temp);
+    }
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     picture_t *dst;
@@ -220,24 +251,10 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    /* The filter is recursive in both directions, so the planes cannot be
+     * split in slices. Denoise each plane on its own thread instead. */
+    struct denoise_slices slices = { sys, src, dst };
+    filter_ExecuteSlices(filter, 3, DenoiseSlice, &slices);
 
     if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
     {
@@ -33,8 +33,14 @@
 #include <vlc_sout.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if (defined(__i386__) || defined(__x86_64__)) && defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define CAN_COMPILE_MOTION_SSE2 1
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -43,12 +49,20 @@ static void Destroy   ( filter_t * );
 
 #define FILTER_PREFIX "motiondetect-"
 
+#define SCALE_TEXT N_("Analysis downscaling")
+#define SCALE_LONGTEXT N_("Motion is detected on the luma averaged over " \
+    "blocks of this size. Larger values are much faster but miss smaller " \
+    "moving objects. 1 analyses every pixel." )
+
 vlc_module_begin ()
     set_description( N_("Motion detect video filter") )
     set_shortname( N_( "Motion Detect" ))
     set_category( CAT_VIDEO )
     set_subcategory( SUBCAT_VIDEO_VFILTER )
 
+    add_integer_with_range( FILTER_PREFIX "scale", 1, 1, 16,
+                            SCALE_TEXT, SCALE_LONGTEXT )
+
     add_shortcut( "motion" )
     set_callback_video_filter( Create )
 vlc_module_end ()
@@ -71,6 +85,14 @@ typedef struct
     uint32_t *p_buf;
     uint32_t *p_buf2;
 
+    /* analysis grid, in blocks of i_scale x i_scale pixels */
+    unsigned i_scale;
+    unsigned i_width;
+    unsigned i_height;
+    uint8_t *p_row;
+    void (*pf_absdiff)( uint8_t *, const uint8_t *, const uint8_t *, unsigned );
+    void (*pf_sad8)( uint32_t *, const uint8_t *, const uint8_t *, unsigned );
+
     /* */
     int i_colors;
     int colors[NUM_COLORS];
@@ -80,6 +102,65 @@ typedef struct
     int color_y_max[NUM_COLORS];
 } filter_sys_t;
 
+/*****************************************************************************
+ * Difference kernels
+ *****************************************************************************/
+static void AbsDiff( uint8_t *p_dst, const uint8_t *p_a, const uint8_t *p_b,
+                     unsigned i_count )
+{
+    for( unsigned x = 0; x < i_count; x++ )
+        p_dst[x] = abs( p_a[x] - p_b[x] );
+}
+
+/* Sum of absolute differences of each group of 8 pixels */
+static void SAD8( uint32_t *p_dst, const uint8_t *p_a, const uint8_t *p_b,
+                  unsigned i_groups )
+{
+    for( unsigned g = 0; g < i_groups; g++ )
+    {
+        uint32_t i_sum = 0;
+        for( unsigned x = 0; x < 8; x++ )
+            i_sum += abs( p_a[8*g+x] - p_b[8*g+x] );
+        p_dst[g] = i_sum;
+    }
+}
+
+#ifdef CAN_COMPILE_MOTION_SSE2
+__attribute__((__target__("sse2")))
+static void AbsDiffSSE2( uint8_t *p_dst, const uint8_t *p_a, const uint8_t *p_b,
+                         unsigned i_count )
+{
+    unsigned x = 0;
+
+    for( ; x + 16 <= i_count; x += 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *)&p_a[x] );
+        __m128i b = _mm_loadu_si128( (const __m128i *)&p_b[x] );
+        _mm_storeu_si128( (__m128i *)&p_dst[x],
+                          _mm_or_si128( _mm_subs_epu8( a, b ),
+                                        _mm_subs_epu8( b, a ) ) );
+    }
+    AbsDiff( &p_dst[x], &p_a[x], &p_b[x], i_count - x );
+}
+
+__attribute__((__target__("sse2")))
+static void SAD8SSE2( uint32_t *p_dst, const uint8_t *p_a, const uint8_t *p_b,
+                      unsigned i_groups )
+{
+    unsigned g = 0;
+
+    for( ; g + 2 <= i_groups; g += 2 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *)&p_a[8*g] );
+        __m128i b = _mm_loadu_si128( (const __m128i *)&p_b[8*g] );
+        __m128i sad = _mm_sad_epu8( a, b );
+        p_dst[g]   = _mm_cvtsi128_si32( sad );
+        p_dst[g+1] = _mm_cvtsi128_si32( _mm_srli_si128( sad, 8 ) );
+    }
+    SAD8( &p_dst[g], &p_a[8*g], &p_b[8*g], i_groups - g );
+}
+#endif
+
 static void Flush(filter_t *p_filter)
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -127,13 +208,44 @@ static int Create( filter_t *p_filter )
 
     p_sys->is_yuv_planar = is_yuv_planar;
     p_sys->p_old = NULL;
-    p_sys->p_buf  = calloc( p_fmt->i_width * p_fmt->i_height, sizeof(*p_sys->p_buf) );
-    p_sys->p_buf2 = calloc( p_fmt->i_width * p_fmt->i_height, sizeof(*p_sys->p_buf) );
 
-    if( !p_sys->p_buf || !p_sys->p_buf2 )
+    p_sys->i_scale = var_InheritInteger( p_filter, FILTER_PREFIX "scale" );
+    if( p_sys->i_scale < 1 || p_sys->i_scale > 16 )
+        p_sys->i_scale = 1;
+    p_sys->i_width  = p_fmt->i_width / p_sys->i_scale;
+    p_sys->i_height = p_fmt->i_height / p_sys->i_scale;
+    if( p_sys->i_width < 5 || p_sys->i_height < 5 )
+    {
+        msg_Err( p_filter, "video too small for a downscaling of %u",
+                 p_sys->i_scale );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+    if( p_sys->i_scale > 1 )
+        msg_Dbg( p_filter, "analysing motion on a %ux%u grid",
+                 p_sys->i_width, p_sys->i_height );
+
+    p_sys->pf_absdiff = AbsDiff;
+    p_sys->pf_sad8 = SAD8;
+#ifdef CAN_COMPILE_MOTION_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        p_sys->pf_absdiff = AbsDiffSSE2;
+        p_sys->pf_sad8 = SAD8SSE2;
+    }
+#endif
+
+    p_sys->p_buf  = calloc( p_sys->i_width * p_sys->i_height, sizeof(*p_sys->p_buf) );
+    p_sys->p_buf2 = calloc( p_sys->i_width * p_sys->i_height, sizeof(*p_sys->p_buf) );
+    /* large enough for a row of packed YUV */
+    p_sys->p_row  = malloc( 2 * p_fmt->i_width );
+
+    if( !p_sys->p_buf || !p_sys->p_buf2 || !p_sys->p_row )
     {
+        free( p_sys->p_row );
         free( p_sys->p_buf2 );
         free( p_sys->p_buf );
+        free( p_sys );
         return VLC_ENOMEM;
     }
 
@@ -147,6 +259,7 @@ static void Destroy( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
+    free( p_sys->p_row );
     free( p_sys->p_buf2 );
     free( p_sys->p_buf );
     if( p_sys->p_old )
@@ -161,69 +274,62 @@ static void Destroy( filter_t *p_filter )
 static void PreparePlanar( filter_t *p_filter, picture_t *p_inpic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    const video_format_t *p_fmt = &p_filter->fmt_in.video;
+    const unsigned i_scale = p_sys->i_scale;
+    const unsigned i_width = p_sys->i_width;
+    uint32_t *p_diff = p_sys->p_buf2;
 
-    uint8_t *p_oldpix   = p_sys->p_old->p[Y_PLANE].p_pixels;
+    const uint8_t *p_oldpix = p_sys->p_old->p[Y_PLANE].p_pixels;
     const int i_old_pitch = p_sys->p_old->p[Y_PLANE].i_pitch;
 
     const uint8_t *p_inpix = p_inpic->p[Y_PLANE].p_pixels;
     const int i_src_pitch = p_inpic->p[Y_PLANE].i_pitch;
 
     /**
-     * Substract Y planes
+     * Substract Y planes, averaging the differences over each block
      */
-    for( unsigned y = 0; y < p_fmt->i_height; y++ )
+    if( i_scale == 1 )
     {
-        for( unsigned x = 0; x < p_fmt->i_width; x++ )
-            p_sys->p_buf2[y*p_fmt->i_width+x] = abs( p_inpix[y*i_src_pitch+x] - p_oldpix[y*i_old_pitch+x] );
-    }
-
-    int i_chroma_dx;
-    int i_chroma_dy;
-    switch( p_inpic->format.i_chroma )
-    {
-        case VLC_CODEC_I420:
-        case VLC_CODEC_J420:
-        case VLC_CODEC_YV12:
-            i_chroma_dx = 2;
-            i_chroma_dy = 2;
-            break;
-
-        case VLC_CODEC_I422:
-        case VLC_CODEC_J422:
-            i_chroma_dx = 2;
-            i_chroma_dy = 1;
-            break;
-
-        default:
-            msg_Warn( p_filter, "Not taking chroma into account" );
-            return;
+        for( unsigned y = 0; y < p_sys->i_height; y++ )
+        {
+            p_sys->pf_absdiff( p_sys->p_row, &p_inpix[y*i_src_pitch],
+                               &p_oldpix[y*i_old_pitch], i_width );
+            for( unsigned x = 0; x < i_width; x++ )
+                p_diff[y*i_width+x] = p_sys->p_row[x];
+        }
+        return;
     }
 
-    const uint8_t *p_inpix_u = p_inpic->p[U_PLANE].p_pixels;
-    const uint8_t *p_inpix_v = p_inpic->p[V_PLANE].p_pixels;
-    const int i_src_pitch_u = p_inpic->p[U_PLANE].i_pitch;
-    const int i_src_pitch_v = p_inpic->p[V_PLANE].i_pitch;
-
-    const uint8_t *p_oldpix_u = p_sys->p_old->p[U_PLANE].p_pixels;
-    const uint8_t *p_oldpix_v = p_sys->p_old->p[V_PLANE].p_pixels;
-    const int i_old_pitch_u = p_sys->p_old->p[U_PLANE].i_pitch;
-    const int i_old_pitch_v = p_sys->p_old->p[V_PLANE].i_pitch;
+    memset( p_diff, 0, sizeof(*p_diff) * i_width * p_sys->i_height );
 
-    for( unsigned y = 0; y < p_fmt->i_height/i_chroma_dy; y++ )
+    for( unsigned y = 0; y < p_sys->i_height * i_scale; y++ )
     {
-        for( unsigned x = 0; x < p_fmt->i_width/i_chroma_dx; x ++ )
-        {
-            const int d = abs( p_inpix_u[y*i_src_pitch_u+x] - p_oldpix_u[y*i_old_pitch_u+x] ) +
-                          abs( p_inpix_v[y*i_src_pitch_v+x] - p_oldpix_v[y*i_old_pitch_v+x] );
+        uint32_t *p_line = &p_diff[(y / i_scale) * i_width];
+        const uint8_t *p_in = &p_inpix[y*i_src_pitch];
+        const uint8_t *p_old = &p_oldpix[y*i_old_pitch];
 
-            for( int j = 0; j < i_chroma_dy; j++ )
-            {
-                for( int i = 0; i < i_chroma_dx; i++ )
-                    p_sys->p_buf2[i_chroma_dy*p_fmt->i_width*j + i_chroma_dx*i] = d;
-            }
+        if( i_scale % 8 == 0 )
+        {
+            /* the blocks are made of whole SAD groups */
+            const unsigned i_groups = i_scale / 8;
+            /* the smoothing buffer is free until FindShapes() */
+            uint32_t *p_sad = p_sys->p_buf;
+
+            p_sys->pf_sad8( p_sad, p_in, p_old, i_width * i_groups );
+            for( unsigned x = 0; x < i_width; x++ )
+                for( unsigned g = 0; g < i_groups; g++ )
+                    p_line[x] += p_sad[x*i_groups+g];
+        }
+        else
+        {
+            p_sys->pf_absdiff( p_sys->p_row, p_in, p_old, i_width * i_scale );
+            for( unsigned x = 0; x < i_width * i_scale; x++ )
+                p_line[x / i_scale] += p_sys->p_row[x];
         }
     }
+
+    const unsigned i_area = i_scale * i_scale;
+    for( unsigned i = 0; i < i_width * p_sys->i_height; i++ )
+        p_diff[i] /= i_area;
 }
 
 static int PreparePacked( filter_t *p_filter, picture_t *p_inpic, int *pi_pix_offset )
@@ -248,19 +354,44 @@ static int PreparePacked( filter_t *p_filter, picture_t *p_inpic, int *pi_pix_of
     const uint8_t *p_inpix = p_inpic->p[Y_PLANE].p_pixels;
     const int i_src_pitch = p_inpic->p[Y_PLANE].i_pitch;
 
-    for( unsigned y = 0; y < p_fmt->i_height; y++ )
+    const unsigned i_scale = p_sys->i_scale;
+    const unsigned i_width = p_sys->i_width;
+    const unsigned i_pixels = (i_width * i_scale) & ~1u;
+    uint32_t *p_diff = p_sys->p_buf2;
+
+    if( i_scale > 1 )
+        memset( p_diff, 0, sizeof(*p_diff) * i_width * p_sys->i_height );
+
+    for( unsigned y = 0; y < p_sys->i_height * i_scale; y++ )
     {
-        for( unsigned x = 0; x < p_fmt->i_width; x+=2 )
+        uint32_t *p_line = &p_diff[(y / i_scale) * i_width];
+        const uint8_t *p_row = p_sys->p_row;
+
+        /* 4 bytes per pair of pixels */
+        p_sys->pf_absdiff( p_sys->p_row, &p_inpix[y*i_src_pitch],
+                           &p_oldpix[y*i_old_pitch], 2 * i_pixels );
+
+        for( unsigned x = 0; x < i_pixels; x += 2 )
         {
-            int d;
-            d = abs( p_inpix[y*i_src_pitch+2*x+i_u_offset] - p_oldpix[y*i_old_pitch+2*x+i_u_offset] ) +
-                abs( p_inpix[y*i_src_pitch+2*x+i_v_offset] - p_oldpix[y*i_old_pitch+2*x+i_v_offset] );
+            const int d = p_row[2*x+i_u_offset] + p_row[2*x+i_v_offset];
 
-            for( int i = 0; i < 2; i++ )
-                p_sys->p_buf2[y*p_fmt->i_width+x+i] =
-                    abs( p_inpix[y*i_src_pitch+2*(x+i)+i_y_offset] - p_oldpix[y*i_old_pitch+2*(x+i)+i_y_offset] ) + d;
+            for( unsigned i = 0; i < 2; i++ )
+            {
+                const int i_diff = p_row[2*(x+i)+i_y_offset] + d;
+                if( i_scale == 1 )
+                    p_line[x+i] = i_diff;
+                else
+                    p_line[(x+i) / i_scale] += i_diff;
+            }
         }
     }
+
+    if( i_scale > 1 )
+    {
+        const unsigned i_area = i_scale * i_scale;
+        for( unsigned i = 0; i < i_width * p_sys->i_height; i++ )
+            p_diff[i] /= i_area;
+    }
     return VLC_SUCCESS;
 }
 
@@ -303,8 +434,7 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_inpic )
     /**
      * Get the areas where movement was detected
      */
-    const video_format_t *p_fmt = &p_filter->fmt_in.video;
-    p_sys->i_colors = FindShapes( p_sys->p_buf2, p_sys->p_buf, p_fmt->i_width, p_fmt->i_width, p_fmt->i_height,
+    p_sys->i_colors = FindShapes( p_sys->p_buf2, p_sys->p_buf, p_sys->i_width, p_sys->i_width, p_sys->i_height,
                                   p_sys->colors, p_sys->color_x_min, p_sys->color_x_max, p_sys->color_y_min, p_sys->color_y_max );
 
     /**
@@ -525,6 +655,8 @@ static int FindShapes( uint32_t *p_diff, uint32_t *p_smooth,
 static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix_size )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *p_fmt = &p_filter->fmt_in.video;
+    const int i_scale = p_sys->i_scale;
 
     int j = 0;
 
@@ -534,14 +666,17 @@ static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix
 
         if( p_sys->colors[i] != i )
             continue;
+        if( p_sys->color_x_min[i] == -1 )
+            continue;
 
-        const int color_x_min = p_sys->color_x_min[i];
-        const int color_x_max = p_sys->color_x_max[i];
-        const int color_y_min = p_sys->color_y_min[i];
-        const int color_y_max = p_sys->color_y_max[i];
+        /* back to picture coordinates */
+        const int color_x_min = p_sys->color_x_min[i] * i_scale;
+        const int color_x_max = __MIN( (p_sys->color_x_max[i] + 1) * i_scale,
+                                       (int)p_fmt->i_width ) - 1;
+        const int color_y_min = p_sys->color_y_min[i] * i_scale;
+        const int color_y_max = __MIN( (p_sys->color_y_max[i] + 1) * i_scale,
+                                       (int)p_fmt->i_height ) - 1;
 
-        if( color_x_min == -1 )
-            continue;
         if( ( color_y_max - color_y_min ) * ( color_x_max - color_x_min ) < 16 )
             continue;
 
@@ -160,17 +160,19 @@ static void Destroy( filter_t *p_filter )
         data_t *restrict p_src = (data_t *)p_pic->p[Y_PLANE].p_pixels;  \
         data_t *restrict p_out = (data_t *)p_outpic->p[Y_PLANE].p_pixels; \
         const unsigned data_sz = sizeof(data_t);                        \
+        const unsigned i_width = i_visible_pitch / data_sz;             \
         const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
         const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_sys->sigma);         \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
+        if( i_begin == 0 )                                              \
+            memcpy(p_out, p_src, i_visible_pitch);                      \
                                                                         \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = __MAX(i_begin, 1);                            \
+             i < __MIN(i_end, i_visible_lines - 1); i++ )               \
         {                                                               \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
-            for( unsigned j = data_sz; j < i_visible_pitch - 1; j++ )   \
+            for( unsigned j = 1; j < i_width - 1; j++ )                 \
             {                                                           \
                 const int line_idx_1 = (i - 1) * i_src_line_len;        \
                 const int line_idx_2 = i * i_src_line_len;              \
@@ -190,30 +192,74 @@ static void Destroy( filter_t *p_filter )
                 p_out[i * i_out_line_len + j] =                         \
                     VLC_CLIP( p_src[line_idx_2 + j] + pix, 0, maxval);  \
             }                                                           \
-            p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
-                p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
+            p_out[i * i_out_line_len + i_width - 1] =                   \
+                p_src[i * i_src_line_len + i_width - 1];                \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
+        if( i_end == i_visible_lines )                                  \
+            memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],      \
+                   &p_src[(i_visible_lines - 1) * i_src_line_len],      \
+                   i_visible_pitch);                                    \
     } while (0)
 
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+struct sharpen_slices
+{
+    picture_t *p_pic;
+    picture_t *p_outpic;
+    int sigma;
+};
+
+static void CopyPlaneLines( plane_t *p_dst, const plane_t *p_src,
+                            int i_begin, int i_end )
+{
+    const int i_width = __MIN( p_dst->i_visible_pitch,
+                               p_src->i_visible_pitch );
+
+    for( int i = i_begin; i < i_end; i++ )
+        memcpy( &p_dst->p_pixels[i * p_dst->i_pitch],
+                &p_src->p_pixels[i * p_src->i_pitch], i_width );
+}
+
+static void FilterSlice( void *opaque, unsigned i_slice, unsigned i_count )
 {
+    const struct sharpen_slices *slices = opaque;
+    picture_t *p_pic = slices->p_pic;
+    picture_t *p_outpic = slices->p_outpic;
+    const int sigma = slices->sigma;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
     const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
     const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
+    int i_begin, i_end;
 
-    filter_sys_t *p_sys = p_filter->p_sys;
+    filter_GetSliceLines( i_visible_lines, i_slice, i_count,
+                          &i_begin, &i_end );
 
     if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
         SHARPEN_FRAME(255, uint8_t);
     else
         SHARPEN_FRAME(1023, uint16_t);
 
-    plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
-    plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
+    for( int i_plane = U_PLANE; i_plane <= V_PLANE; i_plane++ )
+    {
+        filter_GetSliceLines( p_pic->p[i_plane].i_visible_lines,
+                              i_slice, i_count, &i_begin, &i_end );
+        CopyPlaneLines( &p_outpic->p[i_plane], &p_pic->p[i_plane],
+                        i_begin, i_end );
+    }
+}
+
+static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    struct sharpen_slices slices = {
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+        .sigma = atomic_load(&p_sys->sigma),
+    };
+
+    /* Keep at least 16 lines per slice */
+    filter_ExecuteSlices( p_filter, p_pic->p[Y_PLANE].i_visible_lines / 16,
+                          FilterSlice, &slices );
 }
 
 static int SharpenCallback( vlc_object_t *p_this, char const *psz_var,
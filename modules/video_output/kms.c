@@ -33,6 +33,12 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#ifdef HAVE_LINUX_UDMABUF_H
+# include <sys/ioctl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include <linux/udmabuf.h>
+#endif
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
@@ -44,6 +50,10 @@
 #include <vlc_picture_pool.h>
 #include <vlc_fs.h>
 
+#ifdef HAVE_LINUX_UDMABUF_H
+# include "../hw/v4l2m2m/drm_prime.h"
+#endif
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -65,6 +75,27 @@
  */
 #define   MAXHWBUF 3
 
+#ifdef HAVE_LINUX_UDMABUF_H
+/*
+ * how many picture buffers are kept imported as frame buffers. This should
+ * cover the pool of the decoder or converter feeding the display.
+ */
+#define   MAXIMPORT 24
+
+/* A shared memory picture buffer imported as a frame buffer */
+struct kms_import {
+    int             memfd; /* duplicate, so that the inode cannot be reused */
+    dev_t           dev;
+    ino_t           ino;
+    off_t           offset;
+    size_t          pitch;
+    uint32_t        handle;
+    uint32_t        handle_uv;  /* separate chroma buffer, or 0 */
+    uint32_t        fb;
+    uint64_t        last_use;
+};
+#endif
+
 typedef enum { drvSuccess, drvTryNext, drvFail } deviceRval;
 
 typedef struct vout_display_sys_t {
@@ -85,6 +116,23 @@ typedef struct vout_display_sys_t {
 
     unsigned int    front_buf;
 
+#ifdef HAVE_LINUX_UDMABUF_H
+/*
+ * direct display of the pictures, without copy to the dumb buffers
+ */
+    int             udmabuf_fd;
+    struct kms_import import[MAXIMPORT];
+    uint64_t        import_clock;
+
+    picture_t       *next;      /* prepared picture */
+    uint32_t        next_fb;
+    picture_t       *shown[2];  /* on screen, and until the next vblank */
+    uint32_t        shown_fb[2];
+
+    bool            prime_pictures; /* decoded on the device, no copy */
+    vout_display_place_t place;
+#endif
+
     bool            forced_drm_fourcc;
     uint32_t        drm_fourcc;
     vlc_fourcc_t    vlc_fourcc;
@@ -94,6 +142,8 @@ typedef struct vout_display_sys_t {
  */
     uint32_t        crtc;
     uint32_t        plane_id;
+    uint32_t        vblank_type;    /* selects the CRTC for the vblanks */
+    vlc_tick_t      refresh;        /* period of the mode, 0 if unknown */
 
 /*
  * other generic stuff
@@ -486,10 +536,305 @@ static bool ChromaNegotiation(vout_display_t *vd)
     return false;
 }
 
+#ifdef HAVE_LINUX_UDMABUF_H
+static void DestroyImport(vout_display_sys_t *sys, struct kms_import *imp)
+{
+    struct drm_gem_close close_req = { .handle = imp->handle };
+
+    drmModeRmFB(sys->drm_fd, imp->fb);
+    drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+    if (imp->handle_uv) {
+        close_req.handle = imp->handle_uv;
+        drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+        imp->handle_uv = 0;
+    }
+    vlc_close(imp->memfd);
+    imp->fb = 0;
+}
+
+static bool ImportInUse(vout_display_sys_t const *sys,
+                        struct kms_import const *imp)
+{
+    return imp->fb == sys->next_fb || imp->fb == sys->shown_fb[0] ||
+           imp->fb == sys->shown_fb[1];
+}
+
+static void ReleaseImports(vout_display_sys_t *sys)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sys->shown); i++)
+        if (sys->shown[i] != NULL)
+            picture_Release(sys->shown[i]);
+    if (sys->next != NULL)
+        picture_Release(sys->next);
+
+    for (size_t i = 0; i < MAXIMPORT; i++)
+        if (sys->import[i].fb)
+            DestroyImport(sys, &sys->import[i]);
+
+    if (sys->udmabuf_fd != -1)
+        vlc_close(sys->udmabuf_fd);
+    sys->udmabuf_fd = -1;
+}
+
+/*
+ * Imports the shared memory buffer of a picture as a frame buffer, through
+ * a dma-buf over its memfd, so that it can be scanned out without copy.
+ * Returns the frame buffer or 0 if the picture cannot be imported.
+ */
+static uint32_t ImportPicture(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    picture_buffer_t const *buf = pic->p_sys;
+    struct kms_import *imp = NULL;
+    struct stat st;
+
+    if (pic->context != NULL || buf == NULL || buf->fd == -1 ||
+        pic->format.i_chroma != sys->vlc_fourcc ||
+        pic->format.i_width < sys->width || pic->format.i_height < sys->height)
+        return 0;
+
+    if (fstat(buf->fd, &st))
+        return 0;
+
+    for (size_t i = 0; i < MAXIMPORT; i++) {
+        struct kms_import *cur = &sys->import[i];
+
+        if (cur->fb && cur->dev == st.st_dev && cur->ino == st.st_ino &&
+            cur->offset == buf->offset &&
+            cur->pitch == (size_t)pic->p[0].i_pitch) {
+            cur->last_use = ++sys->import_clock;
+            return cur->fb;
+        }
+    }
+
+    /*
+     * pick a free slot or evict the least recently used frame buffer,
+     * except those which may be scanned out
+     */
+    for (size_t i = 0; i < MAXIMPORT; i++) {
+        struct kms_import *cur = &sys->import[i];
+
+        if (!cur->fb) {
+            imp = cur;
+            break;
+        }
+        if (!ImportInUse(sys, cur) &&
+            (imp == NULL || cur->last_use < imp->last_use))
+            imp = cur;
+    }
+    if (imp == NULL)
+        return 0;
+    if (imp->fb)
+        DestroyImport(sys, imp);
+
+    /*
+     * the dma-buf covers whole pages from the start of the file, and the
+     * memfd must not be shrinkable while it exists
+     */
+    long page = sysconf(_SC_PAGESIZE);
+    uint64_t size = vlc_align((uint64_t)buf->offset + buf->size,
+                              (uint64_t)page);
+
+    if ((uint64_t)st.st_size < size ||
+        fcntl(buf->fd, F_ADD_SEALS, F_SEAL_SHRINK)) {
+        msg_Dbg(vd, "Picture buffers cannot be imported");
+        goto error;
+    }
+
+    struct udmabuf_create create_req = {
+        .memfd = buf->fd,
+        .flags = UDMABUF_FLAGS_CLOEXEC,
+        .offset = 0,
+        .size = size,
+    };
+    int dmabuf = ioctl(sys->udmabuf_fd, UDMABUF_CREATE, &create_req);
+    if (dmabuf < 0) {
+        msg_Dbg(vd, "Cannot create dma-buf from picture buffer");
+        goto error;
+    }
+
+    int ret = drmPrimeFDToHandle(sys->drm_fd, dmabuf, &imp->handle);
+    /* the GEM object keeps a reference to the dma-buf */
+    vlc_close(dmabuf);
+    if (ret) {
+        msg_Dbg(vd, "Cannot import dma-buf");
+        goto error;
+    }
+
+    uint32_t handles[4] = { 0 }, pitches[4] = { 0 }, offsets[4] = { 0 };
+
+    for (int i = 0; i < pic->i_planes && i < 4; i++) {
+        handles[i] = imp->handle;
+        pitches[i] = pic->p[i].i_pitch;
+        offsets[i] = buf->offset +
+                     (pic->p[i].p_pixels - (uint8_t *)buf->base);
+    }
+
+    struct drm_gem_close close_req = { .handle = imp->handle };
+
+    imp->memfd = vlc_dup(buf->fd);
+    if (imp->memfd == -1) {
+        drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+        goto error;
+    }
+
+    if (drmModeAddFB2(sys->drm_fd, sys->width, sys->height, sys->drm_fourcc,
+                      handles, pitches, offsets, &imp->fb, 0)) {
+        msg_Dbg(vd, "Cannot create frame buffer from picture buffer");
+        drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+        vlc_close(imp->memfd);
+        imp->fb = 0;
+        goto error;
+    }
+
+    imp->dev = st.st_dev;
+    imp->ino = st.st_ino;
+    imp->offset = buf->offset;
+    imp->pitch = pic->p[0].i_pitch;
+    imp->last_use = ++sys->import_clock;
+    return imp->fb;
+
+error:
+    /*
+     * all the pictures come from the same allocator: stop trying, and
+     * copy to the dumb buffers from now on
+     */
+    msg_Dbg(vd, "Copying pictures to the frame buffers");
+    vlc_close(sys->udmabuf_fd);
+    sys->udmabuf_fd = -1;
+    return 0;
+}
+
+/*
+ * Imports the dma-bufs of a picture decoded on the device as a frame
+ * buffer. Returns the frame buffer or 0 if the picture cannot be imported.
+ */
+static uint32_t ImportPrimePicture(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    drm_prime_picture_context_t *ctx = vlc_drm_prime_PicGetContext(pic);
+    struct kms_import *imp = NULL;
+    struct stat st;
+
+    if (ctx == NULL || ctx->drm_fourcc != sys->drm_fourcc ||
+        ctx->plane_count == 0 || fstat(ctx->planes[0].fd, &st))
+        return 0;
+
+    /* the same decoder buffers come back in turn */
+    for (size_t i = 0; i < MAXIMPORT; i++) {
+        struct kms_import *cur = &sys->import[i];
+
+        if (cur->fb && cur->dev == st.st_dev && cur->ino == st.st_ino &&
+            cur->offset == ctx->planes[0].offset &&
+            cur->pitch == ctx->planes[0].pitch) {
+            cur->last_use = ++sys->import_clock;
+            return cur->fb;
+        }
+    }
+
+    for (size_t i = 0; i < MAXIMPORT; i++) {
+        struct kms_import *cur = &sys->import[i];
+
+        if (!cur->fb) {
+            imp = cur;
+            break;
+        }
+        if (!ImportInUse(sys, cur) &&
+            (imp == NULL || cur->last_use < imp->last_use))
+            imp = cur;
+    }
+    if (imp == NULL)
+        return 0;
+    if (imp->fb)
+        DestroyImport(sys, imp);
+
+    uint32_t handles[4] = { 0 }, pitches[4] = { 0 }, offsets[4] = { 0 };
+    uint64_t modifiers[4] = { 0 };
+    struct drm_gem_close close_req = { 0 };
+
+    imp->handle = imp->handle_uv = 0;
+    for (unsigned i = 0; i < ctx->plane_count && i < 4; i++) {
+        uint32_t handle;
+
+        if (drmPrimeFDToHandle(sys->drm_fd, ctx->planes[i].fd, &handle)) {
+            msg_Err(vd, "Cannot import dma-buf");
+            goto error;
+        }
+        /* the same dma-buf gives the same GEM handle */
+        if (i == 0)
+            imp->handle = handle;
+        else if (handle != imp->handle)
+            imp->handle_uv = handle;
+        handles[i] = handle;
+        pitches[i] = ctx->planes[i].pitch;
+        offsets[i] = ctx->planes[i].offset;
+        modifiers[i] = ctx->modifier;
+    }
+
+    imp->memfd = vlc_dup(ctx->planes[0].fd);
+    if (imp->memfd == -1)
+        goto error;
+
+    int ret;
+    if (ctx->modifier != DRM_FORMAT_MOD_LINEAR)
+        ret = drmModeAddFB2WithModifiers(sys->drm_fd, pic->format.i_width,
+                                         pic->format.i_height,
+                                         ctx->drm_fourcc, handles, pitches,
+                                         offsets, modifiers, &imp->fb,
+                                         DRM_MODE_FB_MODIFIERS);
+    else
+        ret = drmModeAddFB2(sys->drm_fd, pic->format.i_width,
+                            pic->format.i_height, ctx->drm_fourcc,
+                            handles, pitches, offsets, &imp->fb, 0);
+    if (ret) {
+        msg_Err(vd, "Cannot create frame buffer from decoded picture");
+        vlc_close(imp->memfd);
+        goto error;
+    }
+
+    imp->dev = st.st_dev;
+    imp->ino = st.st_ino;
+    imp->offset = ctx->planes[0].offset;
+    imp->pitch = ctx->planes[0].pitch;
+    imp->last_use = ++sys->import_clock;
+    return imp->fb;
+
+error:
+    if (imp->handle) {
+        close_req.handle = imp->handle;
+        drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+    }
+    if (imp->handle_uv) {
+        close_req.handle = imp->handle_uv;
+        drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+    }
+    imp->handle = imp->handle_uv = 0;
+    imp->fb = 0;
+    return 0;
+}
+
+/* The plane scales the decoded pictures to the mode */
+static void PlacePrimePicture(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    vout_display_cfg_t cfg = *vd->cfg;
+
+    if (!sys->prime_pictures)
+        return;
+
+    cfg.display.width = sys->width;
+    cfg.display.height = sys->height;
+    vout_display_PlacePicture(&sys->place, vd->source, &cfg);
+}
+#endif
+
 static void CustomDestroyPicture(vout_display_sys_t *sys)
 {
     int c;
 
+#ifdef HAVE_LINUX_UDMABUF_H
+    ReleaseImports(sys);
+#endif
     for (c = 0; c < MAXHWBUF; c++)
         DestroyFB(sys, c);
 
@@ -575,11 +920,30 @@ static int OpenDisplay(vout_display_t *vd)
         }
         drmModeFreeConnector(conn);
     }
+
+    for (c = 0; c < modeRes->count_crtcs; c++) {
+        if (modeRes->crtcs[c] != sys->crtc)
+            continue;
+        if (c == 1)
+            sys->vblank_type = DRM_VBLANK_SECONDARY;
+        else if (c > 1)
+            sys->vblank_type = (c << DRM_VBLANK_HIGH_CRTC_SHIFT)
+                               & DRM_VBLANK_HIGH_CRTC_MASK;
+    }
     drmModeFreeResources(modeRes);
 
     if (!found_connector)
         goto err_out;
 
+    drmModeCrtc *crtc = drmModeGetCrtc(sys->drm_fd, sys->crtc);
+    if (crtc != NULL) {
+        if (crtc->mode_valid && crtc->mode.clock > 0)
+            sys->refresh = VLC_TICK_FROM_US((uint64_t)crtc->mode.htotal
+                                            * crtc->mode.vtotal * 1000
+                                            / crtc->mode.clock);
+        drmModeFreeCrtc(crtc);
+    }
+
     picture_resource_t rsc = { 0 };
 
     sys->picture = picture_NewFromResource(vd->source, &rsc);
@@ -593,6 +957,19 @@ static int OpenDisplay(vout_display_t *vd)
         sys->picture->p[i].i_pitch  = sys->stride;
     }
 
+#ifdef HAVE_LINUX_UDMABUF_H
+    /*
+     * the pictures in shared memory can be scanned out directly if they
+     * can be imported as dma-bufs
+     */
+    uint64_t prime;
+
+    if (drmGetCap(sys->drm_fd, DRM_CAP_PRIME, &prime) == 0 &&
+        (prime & DRM_PRIME_CAP_IMPORT))
+        sys->udmabuf_fd = vlc_open("/dev/udmabuf", O_RDWR);
+    else
+        sys->prime_pictures = false;
+#endif
     return VLC_SUCCESS;
 err_out:
     drmDropMaster(sys->drm_fd);
@@ -612,6 +989,9 @@ static int Control(vout_display_t *vd, int query)
         case VOUT_DISPLAY_CHANGE_ZOOM:
         case VOUT_DISPLAY_CHANGE_SOURCE_ASPECT:
         case VOUT_DISPLAY_CHANGE_SOURCE_CROP:
+#ifdef HAVE_LINUX_UDMABUF_H
+            PlacePrimePicture(vd);
+#endif
             return VLC_SUCCESS;
     }
     return VLC_EGENERIC;
@@ -623,6 +1003,35 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
 {
     VLC_UNUSED(subpic); VLC_UNUSED(date);
     vout_display_sys_t *sys = vd->sys;
+
+#ifdef HAVE_LINUX_UDMABUF_H
+    if (sys->next != NULL) {
+        picture_Release(sys->next);
+        sys->next = NULL;
+        sys->next_fb = 0;
+    }
+
+    if (sys->prime_pictures) {
+        /* there is nothing to copy from */
+        uint32_t fb = ImportPrimePicture(vd, pic);
+
+        if (fb) {
+            sys->next = picture_Hold(pic);
+            sys->next_fb = fb;
+        }
+        return;
+    }
+
+    if (sys->udmabuf_fd != -1) {
+        uint32_t fb = ImportPicture(vd, pic);
+
+        if (fb) {
+            sys->next = picture_Hold(pic);
+            sys->next_fb = fb;
+            return;
+        }
+    }
+#endif
     picture_Copy( sys->picture, pic );
 }
 
@@ -631,23 +1040,90 @@ static void Display(vout_display_t *vd, picture_t *picture)
 {
     VLC_UNUSED(picture);
     vout_display_sys_t *sys = vd->sys;
+    uint32_t fb = sys->fb[sys->front_buf];
     int i;
+    int32_t crtc_x = 0, crtc_y = 0;
+    uint32_t crtc_w = sys->width, crtc_h = sys->height;
+    uint32_t src_x = 0, src_y = 0;
+    uint32_t src_w = sys->width, src_h = sys->height;
+
+#ifdef HAVE_LINUX_UDMABUF_H
+    if (sys->next != NULL)
+        fb = sys->next_fb;
+
+    if (sys->prime_pictures) {
+        if (sys->next == NULL)
+            return; /* keep showing the last picture */
+
+        const video_format_t *f = &sys->next->format;
+
+        crtc_x = sys->place.x;
+        crtc_y = sys->place.y;
+        crtc_w = sys->place.width;
+        crtc_h = sys->place.height;
+        src_x = f->i_x_offset;
+        src_y = f->i_y_offset;
+        src_w = f->i_visible_width;
+        src_h = f->i_visible_height;
+    }
+#endif
 
     if (drmModeSetPlane(sys->drm_fd, sys->plane_id, sys->crtc,
-                         sys->fb[sys->front_buf], 0,
-                         0, 0, sys->width, sys->height,
-                         0, 0, sys->width << 16, sys->height << 16)) {
+                         fb, 0,
+                         crtc_x, crtc_y, crtc_w, crtc_h,
+                         src_x << 16, src_y << 16,
+                         src_w << 16, src_h << 16)) {
         msg_Err(vd, "Cannot do set plane for plane id %u, fb %x",
-                sys->plane_id,
-                sys->fb[sys->front_buf]);
-    } else {
-        sys->front_buf++;
-        sys->front_buf %= MAXHWBUF;
-
-        for (i = 0; i < PICTURE_PLANE_MAX; i++)
-            sys->picture->p[i].p_pixels =
-                    sys->map[sys->front_buf]+sys->offsets[i];
+                sys->plane_id, fb);
+#ifdef HAVE_LINUX_UDMABUF_H
+        if (sys->next != NULL) {
+            picture_Release(sys->next);
+            sys->next = NULL;
+            sys->next_fb = 0;
+        }
+#endif
+        return;
     }
+
+    /*
+     * the plane is updated at the next vblank: the last one is queried
+     * without waiting
+     */
+    drmVBlank vbl = {
+        .request = {
+            .type = DRM_VBLANK_RELATIVE | sys->vblank_type,
+            .sequence = 0,
+        },
+    };
+    if (sys->refresh > 0 && drmWaitVBlank(sys->drm_fd, &vbl) == 0)
+        vout_display_SendEventVsync(vd,
+                                    vlc_tick_from_sec(vbl.reply.tval_sec)
+                                    + VLC_TICK_FROM_US(vbl.reply.tval_usec)
+                                    + sys->refresh, sys->refresh);
+
+#ifdef HAVE_LINUX_UDMABUF_H
+    /*
+     * the previous frame buffer is scanned out until the next vblank,
+     * so the pictures are held for two flips
+     */
+    if (sys->shown[1] != NULL)
+        picture_Release(sys->shown[1]);
+    sys->shown[1] = sys->shown[0];
+    sys->shown_fb[1] = sys->shown_fb[0];
+    sys->shown[0] = sys->next;
+    sys->shown_fb[0] = sys->next_fb;
+    sys->next = NULL;
+    sys->next_fb = 0;
+
+    if (sys->shown[0] != NULL)
+        return;
+#endif
+    sys->front_buf++;
+    sys->front_buf %= MAXHWBUF;
+
+    for (i = 0; i < PICTURE_PLANE_MAX; i++)
+        sys->picture->p[i].p_pixels =
+                sys->map[sys->front_buf]+sys->offsets[i];
 }
 
 
@@ -694,6 +1170,9 @@ static int Open(vout_display_t *vd,
     vd->sys = sys = vlc_obj_calloc(VLC_OBJECT(vd), 1, sizeof(*sys));
     if (!sys)
         return VLC_ENOMEM;
+#ifdef HAVE_LINUX_UDMABUF_H
+    sys->udmabuf_fd = -1;
+#endif
 
     chroma = var_InheritString(vd, "kms-vlc-chroma");
     if (chroma) {
@@ -714,6 +1193,20 @@ static int Open(vout_display_t *vd,
         msg_Dbg(vd, "Chroma not defined, using default");
     }
 
+#ifdef HAVE_LINUX_UDMABUF_H
+    /*
+     * the pictures decoded on the device are scanned out as they are, if
+     * the plane supports their layout
+     */
+    if (context != NULL &&
+        vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_DRM_PRIME &&
+        vlc_drm_prime_IsChroma(vd->source->i_chroma) &&
+        vd->source->orientation == ORIENT_NORMAL) {
+        sys->prime_pictures = true;
+        sys->vlc_fourcc = vlc_drm_prime_GetSwChroma(vd->source->i_chroma);
+    }
+#endif
+
     chroma = var_InheritString(vd, "kms-drm-chroma");
     if (chroma) {
         local_drm_chroma = VLC_FOURCC(chroma[0], chroma[1], chroma[2],
@@ -736,6 +1229,19 @@ static int Open(vout_display_t *vd,
         return VLC_EGENERIC;
     }
 
+#ifdef HAVE_LINUX_UDMABUF_H
+    if (sys->prime_pictures) {
+        if (sys->drm_fourcc == vlc_drm_prime_GetDrmFourcc(vd->source->i_chroma)) {
+            msg_Dbg(vd, "Scanning out the decoded pictures");
+            PlacePrimePicture(vd);
+            vd->ops = &ops;
+            return VLC_SUCCESS;
+        }
+        /* converted to memory pictures */
+        sys->prime_pictures = false;
+    }
+#endif
+
     video_format_ApplyRotation(&fmt, vd->source);
 
     fmt.i_width = fmt.i_visible_width  = sys->width;
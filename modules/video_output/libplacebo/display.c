@@ -34,6 +34,9 @@
 
 #include "utils.h"
 #include "instance.h"
+#ifdef HAVE_PL_VAAPI
+# include "vaapi.h"
+#endif
 
 #include <libplacebo/renderer.h>
 #include <libplacebo/utils/upload.h>
@@ -84,6 +87,12 @@ typedef struct vout_display_sys_t
 
     const struct pl_hook *hook;
     char *hook_path;
+
+#ifdef HAVE_PL_VAAPI
+    // Import of the hardware decoded pictures, if any
+    vlc_placebo_vaapi_t *vaapi;
+    video_format_t fmt_sw;
+#endif
 } vout_display_sys_t;
 
 // Display callbacks
@@ -130,7 +139,18 @@ static int Open(vout_display_t *vd,
 
     vlc_placebo_ReleaseCurrent(sys->pl);
 
+#ifdef HAVE_PL_VAAPI
+    // Render the hardware surfaces directly rather than reading them back
+    sys->vaapi = vlc_placebo_vaapi_Create(VLC_OBJECT(vd), gpu, context,
+                                          vd->fmt, &sys->fmt_sw);
+#endif
+
     // Attempt using the input format as the display format
+#ifdef HAVE_PL_VAAPI
+    if (sys->vaapi != NULL) {
+        fmt->i_chroma = vd->fmt->i_chroma;
+    } else
+#endif
     if (vlc_placebo_FormatSupported(gpu, vd->fmt->i_chroma)) {
         fmt->i_chroma = vd->fmt->i_chroma;
     } else {
@@ -148,8 +168,13 @@ static int Open(vout_display_t *vd,
                      "back to RGBA for sanity!");
         }
     }
-    sys->yuv_chroma_loc = vlc_fourcc_IsYUV(fmt->i_chroma) ?
-                          vlc_placebo_ChromaLoc(fmt) : PL_CHROMA_UNKNOWN;
+    const video_format_t *fmt_sw = fmt;
+#ifdef HAVE_PL_VAAPI
+    if (sys->vaapi != NULL)
+        fmt_sw = &sys->fmt_sw;
+#endif
+    sys->yuv_chroma_loc = vlc_fourcc_IsYUV(fmt_sw->i_chroma) ?
+                          vlc_placebo_ChromaLoc(fmt_sw) : PL_CHROMA_UNKNOWN;
 
     // Hard-coded list of supported subtitle chromas (non-planar only!)
     static const vlc_fourcc_t subfmts[] = {
@@ -190,6 +215,10 @@ static void Close(vout_display_t *vd)
             pl_tex_destroy(gpu, &sys->plane_tex[i]);
         for (int i = 0; i < sys->num_overlays; i++)
             pl_tex_destroy(gpu, &sys->overlay_tex[i]);
+#ifdef HAVE_PL_VAAPI
+        if (sys->vaapi != NULL)
+            vlc_placebo_vaapi_Destroy(sys->vaapi);
+#endif
         pl_renderer_destroy(&sys->renderer);
         vlc_placebo_ReleaseCurrent(sys->pl);
     }
@@ -227,10 +256,16 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         return; // Probably benign error, ignore it
     }
 
+    const video_format_t *fmt = vd->fmt;
+#ifdef HAVE_PL_VAAPI
+    if (sys->vaapi != NULL)
+        fmt = &sys->fmt_sw;
+#endif
+
     struct pl_image img = {
         .num_planes = pic->i_planes,
-        .color      = vlc_placebo_ColorSpace(vd->fmt),
-        .repr       = vlc_placebo_ColorRepr(vd->fmt),
+        .color      = vlc_placebo_ColorSpace(fmt),
+        .repr       = vlc_placebo_ColorRepr(fmt),
         .src_rect = {
             .x0 = pic->format.i_x_offset,
             .y0 = pic->format.i_y_offset,
@@ -239,20 +274,35 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         },
     };
 
-    // Upload the image data for each plane
-    struct pl_plane_data data[4];
-    if (!vlc_placebo_PlaneData(pic, data, NULL)) {
-        // This should never happen, in theory
-        assert(!"Failed processing the picture_t into pl_plane_data!?");
-    }
-
-    for (int i = 0; i < pic->i_planes; i++) {
-        struct pl_plane *plane = &img.planes[i];
-        if (!pl_upload_plane(gpu, plane, &sys->plane_tex[i], &data[i])) {
-            msg_Err(vd, "Failed uploading image data!");
+#ifdef HAVE_PL_VAAPI
+    if (sys->vaapi != NULL) {
+        // Sample the decoded surface as is
+        img.num_planes = vlc_placebo_vaapi_MapPicture(sys->vaapi, pic, img.planes);
+        if (!img.num_planes) {
             failed = true;
             goto done;
         }
+    } else
+#endif
+    {
+        // Upload the image data for each plane
+        struct pl_plane_data data[4];
+        if (!vlc_placebo_PlaneData(pic, data, NULL)) {
+            // This should never happen, in theory
+            assert(!"Failed processing the picture_t into pl_plane_data!?");
+        }
+
+        for (int i = 0; i < pic->i_planes; i++) {
+            if (!pl_upload_plane(gpu, &img.planes[i], &sys->plane_tex[i], &data[i])) {
+                msg_Err(vd, "Failed uploading image data!");
+                failed = true;
+                goto done;
+            }
+        }
+    }
+
+    for (int i = 0; i < img.num_planes; i++) {
+        struct pl_plane *plane = &img.planes[i];
 
         // Matches only the chroma planes, never luma or alpha
         if (sys->yuv_chroma_loc != PL_CHROMA_UNKNOWN && i != 0 && i != 3)
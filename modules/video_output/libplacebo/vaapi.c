@@ -0,0 +1,264 @@
+/*****************************************************************************
+ * vaapi.c: VA-API surfaces import into libplacebo
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+#include <vlc_fs.h>
+
+#include "../../hw/vaapi/vlc_vaapi.h"
+#include <va/va_drmcommon.h>
+
+#include "utils.h"
+#include "vaapi.h"
+
+// The import needs the dma-buf strides (libplacebo v4) and the surface export
+// (libva 2.1)
+#if PL_API_VER >= 159 && VA_CHECK_VERSION(1, 1, 0)
+
+// More than the surfaces of the decoders pools
+#define SURFACE_CACHE_SIZE 32
+
+struct surface_tex
+{
+    VASurfaceID surface;
+    const struct pl_tex *tex[4];
+    uint64_t last_use;   // 0 if unused
+};
+
+struct vlc_placebo_vaapi
+{
+    vlc_object_t *obj;
+    const struct pl_gpu *gpu;
+    vlc_decoder_device *dec_device;
+    VADisplay dpy;
+
+    struct pl_plane_data data[4];
+    int num_planes;
+
+    struct surface_tex cache[SURFACE_CACHE_SIZE];
+    uint64_t clock;
+    picture_t *last;
+};
+
+static void SurfaceClear(vlc_placebo_vaapi_t *va, struct surface_tex *s)
+{
+    for (int i = 0; i < va->num_planes; i++)
+        pl_tex_destroy(va->gpu, &s->tex[i]);
+    s->last_use = 0;
+}
+
+static int SurfaceImport(vlc_placebo_vaapi_t *va, struct surface_tex *s,
+                         VASurfaceID surface)
+{
+    VADRMPRIMESurfaceDescriptor desc;
+
+    if (vlc_vaapi_ExportSurfaceHandle(va->obj, va->dpy, surface,
+                                      VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+                                      VA_EXPORT_SURFACE_READ_ONLY |
+                                      VA_EXPORT_SURFACE_SEPARATE_LAYERS,
+                                      &desc))
+        return VLC_EGENERIC;
+
+    const VADRMPRIMESurfaceDescriptor *d = &desc;
+    int ret = VLC_EGENERIC;
+    if ((int) d->num_layers != va->num_planes)
+        goto done;
+
+    for (int i = 0; i < va->num_planes; i++) {
+        // Separate layers have a single plane each
+        if (d->layers[i].num_planes != 1)
+            goto done;
+
+        unsigned obj = d->layers[i].object_index[0];
+        const struct pl_fmt *fmt = pl_plane_find_fmt(va->gpu, NULL, &va->data[i]);
+        if (fmt == NULL || fmt->texel_size == 0)
+            goto done;
+
+        s->tex[i] = pl_tex_create(va->gpu, &(struct pl_tex_params) {
+            .w = va->data[i].width,
+            .h = va->data[i].height,
+            .format = fmt,
+            .sampleable = true,
+            .import_handle = PL_HANDLE_DMA_BUF,
+            .shared_mem = {
+                .handle.fd = d->objects[obj].fd,
+                .size = d->objects[obj].size,
+                .offset = d->layers[i].offset[0],
+                .drm_format_mod = d->objects[obj].drm_format_modifier,
+                .stride_w = d->layers[i].pitch[0] / fmt->texel_size,
+            },
+        });
+        if (s->tex[i] == NULL)
+            goto done;
+    }
+
+    s->surface = surface;
+    ret = VLC_SUCCESS;
+
+done:
+    // The imported memory does not depend on the exported descriptors
+    for (unsigned i = 0; i < desc.num_objects; i++)
+        vlc_close(desc.objects[i].fd);
+    if (ret != VLC_SUCCESS)
+        SurfaceClear(va, s);
+    return ret;
+}
+
+vlc_placebo_vaapi_t *vlc_placebo_vaapi_Create(vlc_object_t *obj,
+                                              const struct pl_gpu *gpu,
+                                              vlc_video_context *vctx,
+                                              const video_format_t *fmt,
+                                              video_format_t *fmt_sw)
+{
+    if (vctx == NULL || vlc_video_context_GetType(vctx) != VLC_VIDEO_CONTEXT_VAAPI)
+        return NULL;
+    if (!(gpu->import_caps.tex & PL_HANDLE_DMA_BUF))
+        return NULL;
+
+    vlc_fourcc_t chroma;
+    switch (fmt->i_chroma) {
+    case VLC_CODEC_VAAPI_420:       chroma = VLC_CODEC_NV12; break;
+    case VLC_CODEC_VAAPI_420_10BPP: chroma = VLC_CODEC_P010; break;
+    default: return NULL;
+    }
+
+    vlc_placebo_vaapi_t *va = calloc(1, sizeof(*va));
+    if (unlikely(va == NULL))
+        return NULL;
+
+    // The textures cover the whole surfaces, the crop is done when rendering
+    video_format_t surface_fmt = *fmt;
+    surface_fmt.i_chroma = chroma;
+    surface_fmt.i_visible_width = fmt->i_width;
+    surface_fmt.i_visible_height = fmt->i_height;
+    va->num_planes = vlc_placebo_PlaneFormat(&surface_fmt, va->data);
+    for (int i = 0; i < va->num_planes; i++) {
+        if (!pl_plane_find_fmt(gpu, NULL, &va->data[i])) {
+            free(va);
+            return NULL;
+        }
+    }
+
+    va->obj = obj;
+    va->gpu = gpu;
+    va->dec_device = vlc_video_context_HoldDevice(vctx);
+    va->dpy = va->dec_device->opaque;
+
+    *fmt_sw = *fmt;
+    fmt_sw->i_chroma = chroma;
+    msg_Dbg(obj, "importing VA surfaces as dma-bufs");
+    return va;
+}
+
+void vlc_placebo_vaapi_Destroy(vlc_placebo_vaapi_t *va)
+{
+    for (size_t i = 0; i < SURFACE_CACHE_SIZE; i++)
+        if (va->cache[i].last_use)
+            SurfaceClear(va, &va->cache[i]);
+    if (va->last != NULL)
+        picture_Release(va->last);
+    vlc_decoder_device_Release(va->dec_device);
+    free(va);
+}
+
+int vlc_placebo_vaapi_MapPicture(vlc_placebo_vaapi_t *va, picture_t *pic,
+                                 struct pl_plane planes[4])
+{
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+    struct surface_tex *s = NULL, *lru = &va->cache[0];
+
+    for (size_t i = 0; i < SURFACE_CACHE_SIZE; i++) {
+        struct surface_tex *cur = &va->cache[i];
+        if (cur->last_use && cur->surface == surface) {
+            s = cur;
+            break;
+        }
+        if (cur->last_use < lru->last_use)
+            lru = cur;
+    }
+
+    if (s == NULL) {
+        // libplacebo defers the destruction of textures still in use
+        if (lru->last_use)
+            SurfaceClear(va, lru);
+        if (SurfaceImport(va, lru, surface) != VLC_SUCCESS) {
+            msg_Err(va->obj, "Failed importing VA surface %#x", surface);
+            return 0;
+        }
+        s = lru;
+    }
+    s->last_use = ++va->clock;
+
+    // The surface may still be being decoded
+    if (vaSyncSurface(va->dpy, surface) != VA_STATUS_SUCCESS)
+        return 0;
+
+    for (int i = 0; i < va->num_planes; i++) {
+        const struct pl_plane_data *data = &va->data[i];
+        struct pl_plane *plane = &planes[i];
+
+        *plane = (struct pl_plane) { .texture = s->tex[i] };
+        for (int c = 0; c < 4; c++) {
+            if (data->component_size[c])
+                plane->component_mapping[plane->components++] = data->component_map[c];
+        }
+    }
+
+    // Keep the surface from being reused for decoding while it is sampled
+    if (va->last != NULL)
+        picture_Release(va->last);
+    va->last = picture_Hold(pic);
+    return va->num_planes;
+}
+
+#else
+
+vlc_placebo_vaapi_t *vlc_placebo_vaapi_Create(vlc_object_t *obj,
+                                              const struct pl_gpu *gpu,
+                                              vlc_video_context *vctx,
+                                              const video_format_t *fmt,
+                                              video_format_t *fmt_sw)
+{
+    VLC_UNUSED(obj); VLC_UNUSED(gpu); VLC_UNUSED(vctx);
+    VLC_UNUSED(fmt); VLC_UNUSED(fmt_sw);
+    return NULL;
+}
+
+void vlc_placebo_vaapi_Destroy(vlc_placebo_vaapi_t *va)
+{
+    VLC_UNUSED(va);
+    vlc_assert_unreachable();
+}
+
+int vlc_placebo_vaapi_MapPicture(vlc_placebo_vaapi_t *va, picture_t *pic,
+                                 struct pl_plane planes[4])
+{
+    VLC_UNUSED(va); VLC_UNUSED(pic); VLC_UNUSED(planes);
+    vlc_assert_unreachable();
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * vaapi.h: VA-API surfaces import into libplacebo
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_LIBPLACEBO_VAAPI_H
+#define VLC_LIBPLACEBO_VAAPI_H
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+#include <libplacebo/gpu.h>
+#include <libplacebo/renderer.h>
+
+// Imports the decoded VA surfaces as textures through DRM PRIME dma-bufs,
+// so that the frames are rendered without being read back. The textures are
+// kept per surface, as the decoder recycles a fixed set of them.
+typedef struct vlc_placebo_vaapi vlc_placebo_vaapi_t;
+
+// Returns NULL if the pictures cannot be imported, e.g. for a video context
+// other than VA-API or a GPU without dma-buf import. On success, fmt_sw is
+// the software equivalent of the opaque chroma of fmt.
+vlc_placebo_vaapi_t *vlc_placebo_vaapi_Create(vlc_object_t *,
+                                              const struct pl_gpu *,
+                                              vlc_video_context *,
+                                              const video_format_t *fmt,
+                                              video_format_t *fmt_sw);
+
+// Needs the GPU to be current
+void vlc_placebo_vaapi_Destroy(vlc_placebo_vaapi_t *);
+
+// Fills the planes with the textures of the surface of the picture. The
+// picture is held until the next one is mapped.
+int vlc_placebo_vaapi_MapPicture(vlc_placebo_vaapi_t *, picture_t *,
+                                 struct pl_plane planes[4]);
+
+#endif // VLC_LIBPLACEBO_VAAPI_H
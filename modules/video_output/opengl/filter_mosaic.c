@@ -0,0 +1,733 @@
+/*****************************************************************************
+ * filter_mosaic.c: OpenGL multiviewer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/**
+ * This blend filter draws the pictures of every mosaic bridge in a grid, over
+ * the input video (typically a background image):
+ *
+ *     ./vlc bg.png --video-filter='opengl{filter=glmosaic{cols=4,rows=4}}'
+ *
+ * Contrary to the "mosaic" sub source, the pictures are neither converted nor
+ * scaled by the CPU: each bridged picture is imported as a texture through an
+ * OpenGL interop (so hardware decoded pictures never leave the GPU), and all
+ * the tiles are drawn in the same filter pass. The output may be displayed, or
+ * encoded when the "opengl" video filter is used in a transcode chain.
+ *
+ * Each tile is surrounded by a border, red for the tiles listed in "tally",
+ * orange if the tile did not receive any picture for "timeout" milliseconds:
+ *
+ *     ./vlc bg.png --video-filter='opengl{filter=glmosaic{tally=cam1}}'
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_modules.h>
+#include <vlc_opengl.h>
+#include <vlc_picture.h>
+
+#include "filter.h"
+#include "gl_api.h"
+#include "gl_common.h"
+#include "gl_util.h"
+#include "interop.h"
+#include "sampler_priv.h"
+#include "../../spu/mosaic.h"
+
+#define MOSAIC_CFG_PREFIX "glmosaic-"
+
+#define ROWS_TEXT N_("Number of rows")
+#define ROWS_LONGTEXT N_("Number of rows of the grid (0 to compute it " \
+    "from the number of bridged streams).")
+#define COLS_TEXT N_("Number of columns")
+#define COLS_LONGTEXT N_("Number of columns of the grid (0 to compute it " \
+    "from the number of bridged streams).")
+#define BORDER_TEXT N_("Border width")
+#define BORDER_LONGTEXT N_("Width in pixels of the border drawn around " \
+    "each tile.")
+#define TALLY_TEXT N_("Tally")
+#define TALLY_LONGTEXT N_("Comma separated list of the mosaic bridge ids " \
+    "whose tile is outlined in red.")
+#define TIMEOUT_TEXT N_("Timeout")
+#define TIMEOUT_LONGTEXT N_("Delay in milliseconds without new picture " \
+    "after which a tile is outlined as stale.")
+
+static const char *const filter_options[] = {
+    "border", "cols", "rows", "tally", "timeout", NULL
+};
+
+#define COLOR_BORDER 0x303030
+#define COLOR_TALLY  0xff0000
+#define COLOR_STALE  0xffa000
+
+struct tile {
+    const bridged_es_t *es; /* only used to detect a new bridge */
+    char *id;
+    bool tally;
+
+    /* Format and context of the current interop */
+    video_format_t fmt;
+    vlc_video_context *vctx;
+
+    struct vlc_gl_interop *interop;
+    struct vlc_gl_sampler *sampler;
+    GLuint program_id;
+    struct {
+        GLint vertex_pos;
+        GLint tex_coords_in;
+        GLint alpha;
+    } loc;
+
+    picture_t *pending; /* picture received from the bridge */
+    picture_t *pic; /* picture currently loaded in the textures */
+    vlc_tick_t last_update;
+    float alpha;
+};
+
+struct sys {
+    GLuint program_id; /* to draw the borders */
+    struct {
+        GLint vertex_pos;
+        GLint color;
+    } loc;
+
+    GLuint vbo;
+
+    struct tile *tiles;
+    size_t tile_count;
+
+    unsigned rows;
+    unsigned cols;
+    float border_x;
+    float border_y;
+    float ar;
+    vlc_tick_t timeout;
+
+    vlc_mutex_t lock;
+    char *tally; /* protected by lock */
+    bool tally_changed; /* protected by lock */
+};
+
+static bool
+IsTally(const char *tally, const char *id)
+{
+    if (tally == NULL || id == NULL)
+        return false;
+
+    size_t len = strlen(id);
+    for (const char *p = tally; *p != '\0';)
+    {
+        size_t n = strcspn(p, ",");
+        if (n == len && !strncmp(p, id, len))
+            return true;
+        p += n;
+        if (*p == ',')
+            p++;
+    }
+    return false;
+}
+
+static void
+TileCleanGL(struct vlc_gl_filter *filter, struct tile *tile)
+{
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    if (tile->pic)
+    {
+        picture_Release(tile->pic);
+        tile->pic = NULL;
+    }
+    if (tile->program_id)
+    {
+        vt->DeleteProgram(tile->program_id);
+        tile->program_id = 0;
+    }
+    if (tile->sampler)
+    {
+        vlc_gl_sampler_Delete(tile->sampler);
+        tile->sampler = NULL;
+    }
+    if (tile->interop)
+    {
+        vlc_gl_interop_Delete(tile->interop);
+        tile->interop = NULL;
+    }
+    if (tile->vctx)
+    {
+        vlc_video_context_Release(tile->vctx);
+        tile->vctx = NULL;
+    }
+}
+
+static void
+TileClean(struct vlc_gl_filter *filter, struct tile *tile)
+{
+    TileCleanGL(filter, tile);
+    if (tile->pending)
+    {
+        picture_Release(tile->pending);
+        tile->pending = NULL;
+    }
+    free(tile->id);
+    tile->id = NULL;
+    tile->es = NULL;
+}
+
+static int
+TileInitGL(struct vlc_gl_filter *filter, struct tile *tile, picture_t *pic)
+{
+    const opengl_vtable_t *vt = &filter->api->vt;
+    vlc_video_context *vctx = picture_GetVideoContext(pic);
+
+    tile->interop = vlc_gl_interop_New(filter->gl, filter->api, vctx,
+                                       &pic->format);
+    if (!tile->interop)
+        return VLC_EGENERIC;
+
+    tile->sampler = vlc_gl_sampler_NewFromInterop(tile->interop, false);
+    if (!tile->sampler)
+        goto error;
+
+    static const char *const VERTEX_SHADER_BODY =
+        "attribute vec2 vertex_pos;\n"
+        "attribute vec2 tex_coords_in;\n"
+        "varying vec2 tex_coords;\n"
+        "void main() {\n"
+        "  gl_Position = vec4(vertex_pos, 0.0, 1.0);\n"
+        "  tex_coords = tex_coords_in;\n"
+        "}\n";
+
+    static const char *const FRAGMENT_SHADER_BODY =
+        "varying vec2 tex_coords;\n"
+        "uniform float alpha;\n"
+        "void main() {\n"
+        "  vec4 color = vlc_texture(tex_coords);\n"
+        "  gl_FragColor = vec4(color.rgb, color.a * alpha);\n"
+        "}\n";
+
+    struct vlc_gl_sampler *sampler = tile->sampler;
+    const char *extensions = sampler->shader.extensions
+                           ? sampler->shader.extensions : "";
+
+    const char *shader_version;
+    const char *shader_precision;
+    if (filter->api->is_gles)
+    {
+        shader_version = "#version 100\n";
+        shader_precision = "precision highp float;\n";
+    }
+    else
+    {
+        shader_version = "#version 120\n";
+        shader_precision = "";
+    }
+
+    const char *vertex_shader[] = {
+        shader_version,
+        VERTEX_SHADER_BODY,
+    };
+    const char *fragment_shader[] = {
+        shader_version,
+        extensions,
+        shader_precision,
+        sampler->shader.body,
+        FRAGMENT_SHADER_BODY,
+    };
+
+    tile->program_id =
+        vlc_gl_BuildProgram(VLC_OBJECT(filter), vt,
+                            ARRAY_SIZE(vertex_shader), vertex_shader,
+                            ARRAY_SIZE(fragment_shader), fragment_shader);
+    if (!tile->program_id)
+        goto error;
+
+    vlc_gl_sampler_FetchLocations(sampler, tile->program_id);
+
+    tile->loc.vertex_pos = vt->GetAttribLocation(tile->program_id,
+                                                 "vertex_pos");
+    assert(tile->loc.vertex_pos != -1);
+
+    tile->loc.tex_coords_in = vt->GetAttribLocation(tile->program_id,
+                                                    "tex_coords_in");
+    assert(tile->loc.tex_coords_in != -1);
+
+    tile->loc.alpha = vt->GetUniformLocation(tile->program_id, "alpha");
+    assert(tile->loc.alpha != -1);
+
+    tile->fmt = pic->format;
+    tile->vctx = vctx ? vlc_video_context_Hold(vctx) : NULL;
+
+    return VLC_SUCCESS;
+
+error:
+    TileCleanGL(filter, tile);
+    return VLC_EGENERIC;
+}
+
+static bool
+TileIsCompatible(const struct tile *tile, picture_t *pic)
+{
+    return tile->sampler
+        && tile->fmt.i_chroma == pic->format.i_chroma
+        && tile->fmt.i_width == pic->format.i_width
+        && tile->fmt.i_height == pic->format.i_height
+        && tile->vctx == picture_GetVideoContext(pic);
+}
+
+/* Load the latest picture of the tile in its textures */
+static void
+TileUpdate(struct vlc_gl_filter *filter, struct tile *tile, vlc_tick_t now)
+{
+    picture_t *pic = tile->pending;
+    if (!pic)
+        return;
+    tile->pending = NULL;
+
+    if (!TileIsCompatible(tile, pic))
+    {
+        TileCleanGL(filter, tile);
+        if (TileInitGL(filter, tile, pic) != VLC_SUCCESS)
+        {
+            msg_Err(filter, "cannot import the pictures of %s",
+                    tile->id ? tile->id : "?");
+            picture_Release(pic);
+            return;
+        }
+    }
+
+    if (vlc_gl_sampler_UpdatePicture(tile->sampler, pic) != VLC_SUCCESS)
+    {
+        picture_Release(pic);
+        return;
+    }
+
+    if (tile->pic)
+        picture_Release(tile->pic);
+    tile->pic = pic;
+    tile->last_update = now;
+}
+
+/* Fetch the latest picture of each bridged stream, under the mosaic lock */
+static void
+FetchPictures(struct vlc_gl_filter *filter)
+{
+    struct sys *sys = filter->sys;
+    size_t count = 0;
+
+    vlc_global_lock(VLC_MOSAIC_MUTEX);
+
+    bridge_t *bridge = GetBridge(filter);
+    if (bridge && bridge->i_es_num > 0)
+    {
+        count = bridge->i_es_num;
+        if (count > sys->tile_count)
+        {
+            struct tile *tiles = realloc(sys->tiles, count * sizeof(*tiles));
+            if (!tiles)
+                count = sys->tile_count;
+            else
+            {
+                memset(&tiles[sys->tile_count], 0,
+                       (count - sys->tile_count) * sizeof(*tiles));
+                sys->tiles = tiles;
+                sys->tile_count = count;
+            }
+        }
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    const char *tally = sys->tally;
+    bool tally_changed = sys->tally_changed;
+    sys->tally_changed = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        bridged_es_t *es = bridge->pp_es[i];
+        struct tile *tile = &sys->tiles[i];
+
+        if (tile->es != es)
+        {
+            if (tile->es)
+                TileClean(filter, tile);
+            tile->es = es;
+            tile->id = es->psz_id ? strdup(es->psz_id) : NULL;
+            tally_changed = true;
+        }
+        if (tally_changed)
+            tile->tally = IsTally(tally, tile->id);
+
+        tile->alpha = es->i_alpha / 255.f;
+
+        if (es->b_empty)
+        {
+            if (tile->pending)
+            {
+                picture_Release(tile->pending);
+                tile->pending = NULL;
+            }
+            continue;
+        }
+
+        /* Only the most recent picture is drawn */
+        while (!vlc_picture_chain_IsEmpty(&es->pictures))
+        {
+            picture_t *pic = vlc_picture_chain_PopFront(&es->pictures);
+            if (tile->pending)
+                picture_Release(tile->pending);
+            tile->pending = pic;
+        }
+    }
+    vlc_mutex_unlock(&sys->lock);
+
+    vlc_global_unlock(VLC_MOSAIC_MUTEX);
+
+    /* The bridges which disappeared */
+    for (size_t i = count; i < sys->tile_count; i++)
+        TileClean(filter, &sys->tiles[i]);
+    sys->tile_count = count;
+}
+
+static void
+DrawRect(struct vlc_gl_filter *filter, float x0, float y0, float x1, float y1,
+         uint32_t rgb)
+{
+    struct sys *sys = filter->sys;
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    const GLfloat data[] = {
+        x0, y1,
+        x0, y0,
+        x1, y1,
+        x1, y0,
+    };
+
+    vt->UseProgram(sys->program_id);
+    vt->Uniform4f(sys->loc.color, ((rgb >> 16) & 0xff) / 255.f,
+                  ((rgb >> 8) & 0xff) / 255.f, (rgb & 0xff) / 255.f, 1.f);
+
+    vt->BindBuffer(GL_ARRAY_BUFFER, sys->vbo);
+    vt->BufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STREAM_DRAW);
+
+    vt->EnableVertexAttribArray(sys->loc.vertex_pos);
+    vt->VertexAttribPointer(sys->loc.vertex_pos, 2, GL_FLOAT, GL_FALSE, 0,
+                            (const void *) 0);
+
+    vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+static void
+DrawTile(struct vlc_gl_filter *filter, struct tile *tile,
+         float x0, float y0, float x1, float y1)
+{
+    struct sys *sys = filter->sys;
+    const opengl_vtable_t *vt = &filter->api->vt;
+    const video_format_t *fmt = &tile->pic->format;
+
+    /* Keep the aspect ratio of the picture inside the tile */
+    if (fmt->i_visible_width && fmt->i_visible_height)
+    {
+        unsigned sar_num = fmt->i_sar_num ? fmt->i_sar_num : 1;
+        unsigned sar_den = fmt->i_sar_den ? fmt->i_sar_den : 1;
+        float pic_ar = (float) fmt->i_visible_width * sar_num
+                     / ((float) fmt->i_visible_height * sar_den);
+        float tile_ar = (x1 - x0) / (y1 - y0) * sys->ar;
+
+        if (pic_ar > tile_ar)
+        {
+            float h = (y1 - y0) * tile_ar / pic_ar;
+            y0 += ((y1 - y0) - h) / 2;
+            y1 = y0 + h;
+        }
+        else
+        {
+            float w = (x1 - x0) * pic_ar / tile_ar;
+            x0 += ((x1 - x0) - w) / 2;
+            x1 = x0 + w;
+        }
+    }
+
+    struct vlc_gl_sampler *sampler = tile->sampler;
+
+    float coords[] = {
+        0, 1,
+        0, 0,
+        1, 1,
+        1, 0,
+    };
+    /* Transform coordinates in place */
+    vlc_gl_sampler_PicToTexCoords(sampler, 4, coords, coords);
+
+    const GLfloat data[] = {
+        x0, y1, coords[0], coords[1],
+        x0, y0, coords[2], coords[3],
+        x1, y1, coords[4], coords[5],
+        x1, y0, coords[6], coords[7],
+    };
+
+    vt->UseProgram(tile->program_id);
+    vlc_gl_sampler_Load(sampler);
+    vt->Uniform1f(tile->loc.alpha, tile->alpha);
+
+    vt->BindBuffer(GL_ARRAY_BUFFER, sys->vbo);
+    vt->BufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STREAM_DRAW);
+
+    const GLsizei stride = 4 * sizeof(float);
+
+    vt->EnableVertexAttribArray(tile->loc.vertex_pos);
+    vt->VertexAttribPointer(tile->loc.vertex_pos, 2, GL_FLOAT, GL_FALSE,
+                            stride, (const void *) 0);
+
+    intptr_t offset = 2 * sizeof(float);
+    vt->EnableVertexAttribArray(tile->loc.tex_coords_in);
+    vt->VertexAttribPointer(tile->loc.tex_coords_in, 2, GL_FLOAT, GL_FALSE,
+                            stride, (const void *) offset);
+
+    vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+static int
+Draw(struct vlc_gl_filter *filter, const struct vlc_gl_input_meta *meta)
+{
+    (void) meta;
+
+    struct sys *sys = filter->sys;
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    FetchPictures(filter);
+
+    size_t count = sys->tile_count;
+    if (count == 0)
+        return VLC_SUCCESS;
+
+    unsigned cols = sys->cols;
+    unsigned rows = sys->rows;
+    if (!cols)
+    {
+        cols = ceilf(sqrtf(rows ? (float) count / rows : count));
+        if (!cols)
+            cols = 1;
+    }
+    if (!rows)
+        rows = (count + cols - 1) / cols;
+
+    vlc_tick_t now = vlc_tick_now();
+
+    vt->Enable(GL_BLEND);
+    vt->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    const float cell_w = 2.f / cols;
+    const float cell_h = 2.f / rows;
+
+    for (size_t i = 0; i < count && i < (size_t) rows * cols; i++)
+    {
+        struct tile *tile = &sys->tiles[i];
+
+        TileUpdate(filter, tile, now);
+
+        /* Normalized device coordinates, the first tile is at the top left */
+        float x0 = -1.f + (i % cols) * cell_w;
+        float y1 = 1.f - (i / cols) * cell_h;
+        float x1 = x0 + cell_w;
+        float y0 = y1 - cell_h;
+
+        uint32_t border;
+        if (tile->tally)
+            border = COLOR_TALLY;
+        else if (!tile->pic || now - tile->last_update > sys->timeout)
+            border = COLOR_STALE;
+        else
+            border = COLOR_BORDER;
+
+        DrawRect(filter, x0, y0, x1, y1, border);
+
+        x0 += sys->border_x;
+        x1 -= sys->border_x;
+        y0 += sys->border_y;
+        y1 -= sys->border_y;
+        if (x1 <= x0 || y1 <= y0)
+            continue;
+
+        DrawRect(filter, x0, y0, x1, y1, 0x000000);
+
+        if (tile->pic)
+            DrawTile(filter, tile, x0, y0, x1, y1);
+    }
+
+    vt->Disable(GL_BLEND);
+
+    return VLC_SUCCESS;
+}
+
+static int
+TallyCallback(vlc_object_t *obj, char const *var,
+              vlc_value_t oldval, vlc_value_t newval, void *data)
+{
+    VLC_UNUSED(obj); VLC_UNUSED(var); VLC_UNUSED(oldval);
+    struct sys *sys = data;
+
+    char *tally = newval.psz_string ? strdup(newval.psz_string) : NULL;
+
+    vlc_mutex_lock(&sys->lock);
+    free(sys->tally);
+    sys->tally = tally;
+    sys->tally_changed = true;
+    vlc_mutex_unlock(&sys->lock);
+
+    return VLC_SUCCESS;
+}
+
+static void
+Close(struct vlc_gl_filter *filter)
+{
+    struct sys *sys = filter->sys;
+
+    var_DelCallback(filter, MOSAIC_CFG_PREFIX "tally", TallyCallback, sys);
+
+    for (size_t i = 0; i < sys->tile_count; i++)
+        TileClean(filter, &sys->tiles[i]);
+    free(sys->tiles);
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+    vt->DeleteProgram(sys->program_id);
+    vt->DeleteBuffers(1, &sys->vbo);
+
+    free(sys->tally);
+    free(sys);
+}
+
+static vlc_gl_filter_open_fn Open;
+static int
+Open(struct vlc_gl_filter *filter, const config_chain_t *config,
+     struct vlc_gl_tex_size *size_out)
+{
+    config_ChainParse(filter, MOSAIC_CFG_PREFIX, filter_options, config);
+
+    struct sys *sys = filter->sys = malloc(sizeof(*sys));
+    if (!sys)
+        return VLC_EGENERIC;
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    static const char *const VERTEX_SHADER_BODY =
+        "attribute vec2 vertex_pos;\n"
+        "void main() {\n"
+        "  gl_Position = vec4(vertex_pos, 0.0, 1.0);\n"
+        "}\n";
+
+    static const char *const FRAGMENT_SHADER_BODY =
+        "uniform vec4 color;\n"
+        "void main() {\n"
+        "  gl_FragColor = color;\n"
+        "}\n";
+
+    const char *shader_version;
+    const char *shader_precision;
+    if (filter->api->is_gles)
+    {
+        shader_version = "#version 100\n";
+        shader_precision = "precision highp float;\n";
+    }
+    else
+    {
+        shader_version = "#version 120\n";
+        shader_precision = "";
+    }
+
+    const char *vertex_shader[] = {
+        shader_version,
+        VERTEX_SHADER_BODY,
+    };
+    const char *fragment_shader[] = {
+        shader_version,
+        shader_precision,
+        FRAGMENT_SHADER_BODY,
+    };
+
+    GLuint program_id =
+        vlc_gl_BuildProgram(VLC_OBJECT(filter), vt,
+                            ARRAY_SIZE(vertex_shader), vertex_shader,
+                            ARRAY_SIZE(fragment_shader), fragment_shader);
+    if (!program_id)
+    {
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
+    sys->program_id = program_id;
+
+    sys->loc.vertex_pos = vt->GetAttribLocation(program_id, "vertex_pos");
+    assert(sys->loc.vertex_pos != -1);
+
+    sys->loc.color = vt->GetUniformLocation(program_id, "color");
+    assert(sys->loc.color != -1);
+
+    vt->GenBuffers(1, &sys->vbo);
+
+    sys->tiles = NULL;
+    sys->tile_count = 0;
+
+    sys->rows = var_InheritInteger(filter, MOSAIC_CFG_PREFIX "rows");
+    sys->cols = var_InheritInteger(filter, MOSAIC_CFG_PREFIX "cols");
+    unsigned border = var_InheritInteger(filter, MOSAIC_CFG_PREFIX "border");
+    sys->border_x = 2.f * border / size_out->width;
+    sys->border_y = 2.f * border / size_out->height;
+    sys->ar = (float) size_out->width / size_out->height;
+    sys->timeout = VLC_TICK_FROM_MS(
+            var_InheritInteger(filter, MOSAIC_CFG_PREFIX "timeout"));
+
+    vlc_mutex_init(&sys->lock);
+    sys->tally = var_InheritString(filter, MOSAIC_CFG_PREFIX "tally");
+    sys->tally_changed = true;
+    var_AddCallback(filter, MOSAIC_CFG_PREFIX "tally", TallyCallback, sys);
+
+    filter->config.blend = true;
+
+    static const struct vlc_gl_filter_ops ops = {
+        .draw = Draw,
+        .close = Close,
+    };
+    filter->ops = &ops;
+
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_shortname("glmosaic")
+    set_description(N_("OpenGL multiviewer"))
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+    set_capability("opengl filter", 0)
+    set_callback(Open)
+    add_shortcut("glmosaic")
+    add_integer_with_range(MOSAIC_CFG_PREFIX "rows", 0, 0, 64,
+                           ROWS_TEXT, ROWS_LONGTEXT)
+    add_integer_with_range(MOSAIC_CFG_PREFIX "cols", 0, 0, 64,
+                           COLS_TEXT, COLS_LONGTEXT)
+    add_integer_with_range(MOSAIC_CFG_PREFIX "border", 2, 0, 64,
+                           BORDER_TEXT, BORDER_LONGTEXT)
+    add_string(MOSAIC_CFG_PREFIX "tally", NULL, TALLY_TEXT, TALLY_LONGTEXT)
+    add_integer(MOSAIC_CFG_PREFIX "timeout", 1000,
+                TIMEOUT_TEXT, TIMEOUT_LONGTEXT)
+vlc_module_end()
@@ -149,6 +149,10 @@ vlc_gl_api_Init(struct vlc_gl_api *api, vlc_gl_t *gl)
     GET_PROC_ADDR_OPTIONAL(FenceSync);
     GET_PROC_ADDR_OPTIONAL(DeleteSync);
     GET_PROC_ADDR_OPTIONAL(ClientWaitSync);
+
+    GET_PROC_ADDR_OPTIONAL(GetProgramBinary);
+    GET_PROC_ADDR_OPTIONAL(ProgramBinary);
+    GET_PROC_ADDR_OPTIONAL(ProgramParameteri);
 #undef GET_PROC_ADDR
 
     GL_ASSERT_NOERROR(&api->vt);
@@ -168,6 +168,16 @@
 # define GL_STREAM_READ 0x88E1
 #endif
 
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+# define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+# define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+# define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 #ifndef APIENTRY
 # define APIENTRY
 #endif
@@ -233,6 +243,9 @@ typedef void (APIENTRY *PFNGLBLITFRAMEBUFFERPROC) (GLint srcX0, GLint srcY0, GLi
                                                    GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
                                                    GLbitfield mask, GLenum filter);
 typedef void (APIENTRY *PFNGLREADPIXELSPROC) (GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void *);
+typedef void (APIENTRY *PFNGLGETPROGRAMBINARYPROC) (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRY *PFNGLPROGRAMBINARYPROC) (GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRY *PFNGLPROGRAMPARAMETERIPROC) (GLuint program, GLenum pname, GLint value);
 
 /* The following are defined in glext.h but not for GLES2 or on Apple systems */
 #if defined(USE_OPENGL_ES2) || defined(__APPLE__)
@@ -363,6 +376,11 @@ typedef struct {
     PFNGLUSEPROGRAMPROC    UseProgram;
     PFNGLDELETEPROGRAMPROC DeleteProgram;
 
+    /* Program binaries (OpenGL 4.1, OpenGL ES 3.0) */
+    PFNGLGETPROGRAMBINARYPROC   GetProgramBinary; /* can be NULL */
+    PFNGLPROGRAMBINARYPROC      ProgramBinary; /* can be NULL */
+    PFNGLPROGRAMPARAMETERIPROC  ProgramParameteri; /* can be NULL */
+
     /* Texture commands */
     PFNGLACTIVETEXTUREPROC ActiveTexture;
 
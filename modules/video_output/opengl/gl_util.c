@@ -25,8 +25,14 @@
 
 #include "gl_util.h"
 
+#include <stdio.h>
+
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
 
 static void
 LogShaderErrors(vlc_object_t *obj, const opengl_vtable_t *vt, GLuint id)
@@ -89,6 +95,287 @@ CreateShader(vlc_object_t *obj, const opengl_vtable_t *vt, GLenum type,
     return shader;
 }
 
+/*
+ * Program binary cache
+ *
+ * Linked programs are kept in memory for the other OpenGL instances of the
+ * process, and on disk for the next runs. They are identified by the hash of
+ * their sources and of the driver strings, since a binary is only valid for
+ * the driver which produced it.
+ */
+#define PROGRAM_CACHE_MAX 32
+#define PROGRAM_BINARY_MAX (16 * 1024 * 1024)
+
+struct program_binary
+{
+    char key[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    GLenum format;
+    GLsizei size;
+    uint8_t data[];
+};
+
+struct program_binary_header
+{
+    char magic[4];
+    uint32_t format;
+};
+
+static vlc_mutex_t program_cache_lock = VLC_STATIC_MUTEX;
+/* most recently used first */
+static struct program_binary *program_cache[PROGRAM_CACHE_MAX];
+
+__attribute__((destructor))
+static void
+ProgramCacheClear(void)
+{
+    for (size_t i = 0; i < PROGRAM_CACHE_MAX; i++)
+    {
+        free(program_cache[i]);
+        program_cache[i] = NULL;
+    }
+}
+
+static bool
+ProgramCacheAvailable(const opengl_vtable_t *vt)
+{
+    if (!vt->GetProgramBinary || !vt->ProgramBinary)
+        return false;
+
+    GLint formats = 0;
+    vt->GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    /* Drain the errors of unsupported queries */
+    while (vt->GetError() != GL_NO_ERROR);
+    return formats > 0;
+}
+
+static void
+ProgramCacheKey(const opengl_vtable_t *vt,
+                GLsizei vstring_count, const GLchar **vstrings,
+                GLsizei fstring_count, const GLchar **fstrings,
+                char key[VLC_HASH_MD5_DIGEST_HEX_SIZE])
+{
+    static const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init(&md5);
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        const char *str = (const char *) vt->GetString(names[i]);
+        if (str)
+            vlc_hash_md5_Update(&md5, str, strlen(str));
+        vlc_hash_md5_Update(&md5, "", 1);
+    }
+    for (GLsizei i = 0; i < vstring_count; i++)
+        vlc_hash_md5_Update(&md5, vstrings[i], strlen(vstrings[i]));
+    vlc_hash_md5_Update(&md5, "", 1);
+    for (GLsizei i = 0; i < fstring_count; i++)
+        vlc_hash_md5_Update(&md5, fstrings[i], strlen(fstrings[i]));
+    vlc_hash_FinishHex(&md5, key);
+}
+
+static char *
+ProgramCachePath(const char *key)
+{
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (!dir)
+        return NULL;
+
+    char *path;
+    if (asprintf(&path, "%s" DIR_SEP "glprograms" DIR_SEP "%s.bin",
+                 dir, key) < 0)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+/* Must be called with the lock held */
+static void
+ProgramCacheInsert(struct program_binary *bin)
+{
+    free(program_cache[PROGRAM_CACHE_MAX - 1]);
+    memmove(&program_cache[1], &program_cache[0],
+            (PROGRAM_CACHE_MAX - 1) * sizeof (*program_cache));
+    program_cache[0] = bin;
+}
+
+static struct program_binary *
+ProgramCacheRead(const char *key)
+{
+    char *path = ProgramCachePath(key);
+    if (!path)
+        return NULL;
+
+    FILE *file = vlc_fopen(path, "rb");
+    free(path);
+    if (!file)
+        return NULL;
+
+    struct program_binary *bin = NULL;
+    struct program_binary_header hdr;
+    long size;
+
+    if (fread(&hdr, sizeof (hdr), 1, file) != 1
+     || memcmp(hdr.magic, "VGLP", 4)
+     || fseek(file, 0, SEEK_END) || (size = ftell(file)) < 0)
+        goto end;
+
+    size -= sizeof (hdr);
+    if (size <= 0 || size > PROGRAM_BINARY_MAX
+     || fseek(file, sizeof (hdr), SEEK_SET))
+        goto end;
+
+    bin = malloc(sizeof (*bin) + size);
+    if (!bin)
+        goto end;
+    if (fread(bin->data, size, 1, file) != 1)
+    {
+        free(bin);
+        bin = NULL;
+        goto end;
+    }
+    strcpy(bin->key, key);
+    bin->format = hdr.format;
+    bin->size = size;
+end:
+    fclose(file);
+    return bin;
+}
+
+static void
+ProgramCacheWrite(vlc_object_t *obj, const struct program_binary *bin)
+{
+    char *path = ProgramCachePath(bin->key);
+    if (!path)
+        return;
+
+    /* Create the cache directories */
+    char *sep = strrchr(path, DIR_SEP_CHAR);
+    *sep = '\0';
+    char *parent = strrchr(path, DIR_SEP_CHAR);
+    *parent = '\0';
+    vlc_mkdir(path, 0700);
+    *parent = DIR_SEP_CHAR;
+    vlc_mkdir(path, 0700);
+    *sep = DIR_SEP_CHAR;
+
+    char *tmp;
+    if (asprintf(&tmp, "%s.tmp", path) < 0)
+    {
+        free(path);
+        return;
+    }
+
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file)
+    {
+        struct program_binary_header hdr = {
+            .magic = { 'V', 'G', 'L', 'P' },
+            .format = bin->format,
+        };
+        bool ok = fwrite(&hdr, sizeof (hdr), 1, file) == 1
+               && fwrite(bin->data, bin->size, 1, file) == 1;
+        if (fclose(file))
+            ok = false;
+        if (!ok || vlc_rename(tmp, path))
+            vlc_unlink(tmp);
+    }
+    else
+        msg_Dbg(obj, "cannot write the program binary cache %s", tmp);
+
+    free(tmp);
+    free(path);
+}
+
+static bool
+ProgramLoadBinary(const opengl_vtable_t *vt, GLuint program,
+                  const struct program_binary *bin)
+{
+    vt->ProgramBinary(program, bin->format, bin->data, bin->size);
+    /* A binary rejected by the driver (format) is not an error here */
+    while (vt->GetError() != GL_NO_ERROR);
+
+    GLint linked;
+    vt->GetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked;
+}
+
+static GLuint
+ProgramCacheLoad(vlc_object_t *obj, const opengl_vtable_t *vt,
+                 const char *key)
+{
+    GLuint program = vt->CreateProgram();
+    if (!program)
+        return 0;
+
+    vlc_mutex_lock(&program_cache_lock);
+    for (size_t i = 0; i < PROGRAM_CACHE_MAX && program_cache[i]; i++)
+    {
+        struct program_binary *bin = program_cache[i];
+        if (strcmp(bin->key, key))
+            continue;
+
+        bool linked = ProgramLoadBinary(vt, program, bin);
+        /* Move it to the front */
+        memmove(&program_cache[1], &program_cache[0],
+                i * sizeof (*program_cache));
+        program_cache[0] = bin;
+        vlc_mutex_unlock(&program_cache_lock);
+
+        if (linked)
+            return program;
+        vt->DeleteProgram(program);
+        return 0;
+    }
+    vlc_mutex_unlock(&program_cache_lock);
+
+    struct program_binary *bin = ProgramCacheRead(key);
+    if (bin)
+    {
+        if (ProgramLoadBinary(vt, program, bin))
+        {
+            msg_Dbg(obj, "program loaded from the cache");
+            vlc_mutex_lock(&program_cache_lock);
+            ProgramCacheInsert(bin);
+            vlc_mutex_unlock(&program_cache_lock);
+            return program;
+        }
+        free(bin);
+    }
+
+    vt->DeleteProgram(program);
+    return 0;
+}
+
+static void
+ProgramCacheStore(vlc_object_t *obj, const opengl_vtable_t *vt,
+                  GLuint program, const char *key)
+{
+    GLint size = 0;
+    vt->GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0 || size > PROGRAM_BINARY_MAX)
+        return;
+
+    struct program_binary *bin = malloc(sizeof (*bin) + size);
+    if (!bin)
+        return;
+
+    GLsizei length = 0;
+    vt->GetProgramBinary(program, size, &length, &bin->format, bin->data);
+    if (vt->GetError() != GL_NO_ERROR || length <= 0)
+    {
+        while (vt->GetError() != GL_NO_ERROR);
+        free(bin);
+        return;
+    }
+    strcpy(bin->key, key);
+    bin->size = length;
+
+    ProgramCacheWrite(obj, bin);
+
+    vlc_mutex_lock(&program_cache_lock);
+    ProgramCacheInsert(bin);
+    vlc_mutex_unlock(&program_cache_lock);
+}
 
 GLuint
 vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
@@ -97,6 +384,17 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
 {
     GLuint program = 0;
 
+    char key[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    bool cacheable = ProgramCacheAvailable(vt);
+    if (cacheable)
+    {
+        ProgramCacheKey(vt, vstring_count, vstrings, fstring_count, fstrings,
+                        key);
+        program = ProgramCacheLoad(obj, vt, key);
+        if (program)
+            return program;
+    }
+
     GLuint vertex_shader = CreateShader(obj, vt, GL_VERTEX_SHADER,
                                         vstring_count, vstrings);
     if (!vertex_shader)
@@ -114,6 +412,10 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
     vt->AttachShader(program, vertex_shader);
     vt->AttachShader(program, fragment_shader);
 
+    if (cacheable && vt->ProgramParameteri)
+        vt->ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                              GL_TRUE);
+
     vt->LinkProgram(program);
 
     LogProgramErrors(obj, vt, program);
@@ -126,6 +428,8 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
         vt->DeleteProgram(program);
         program = 0;
     }
+    else if (cacheable)
+        ProgramCacheStore(obj, vt, program, key);
 
 finally_2:
     vt->DeleteShader(fragment_shader);
@@ -32,6 +32,30 @@
 #include "gl_api.h"
 
 #define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PERSISTENT_COUNT 3 /* Triple buffering */
+
+#ifndef GL_MAP_WRITE_BIT
+# define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+# define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+# define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+# define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+# define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_WAIT_FAILED
+# define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+# define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
@@ -48,6 +72,17 @@ struct priv
         picture_t *display_pics[PBO_DISPLAY_COUNT];
         size_t display_idx;
     } pbo;
+    /* Persistently mapped PBO, written while the previous uploads are
+     * still in flight, see tc_persistent_update() */
+    struct {
+        GLuint buffers[PERSISTENT_COUNT][PICTURE_PLANE_MAX];
+        void  *maps[PERSISTENT_COUNT][PICTURE_PLANE_MAX];
+        GLsync fences[PERSISTENT_COUNT];
+        size_t bytes[PICTURE_PLANE_MAX];
+        unsigned planes;
+        size_t idx;
+        bool   enabled;
+    } persistent;
 };
 
 static void
@@ -191,6 +226,149 @@ tc_pbo_update(const struct vlc_gl_interop *interop, GLuint *textures,
     return VLC_SUCCESS;
 }
 
+static void
+persistent_release(const struct vlc_gl_interop *interop)
+{
+    struct priv *priv = interop->priv;
+    const opengl_vtable_t *vt = interop->vt;
+
+    for (size_t i = 0; i < PERSISTENT_COUNT; ++i)
+    {
+        if (priv->persistent.fences[i])
+            vt->DeleteSync(priv->persistent.fences[i]);
+
+        for (unsigned j = 0; j < priv->persistent.planes; ++j)
+        {
+            if (priv->persistent.maps[i][j])
+            {
+                vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                               priv->persistent.buffers[i][j]);
+                vt->UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+        }
+        vt->DeleteBuffers(priv->persistent.planes,
+                          priv->persistent.buffers[i]);
+    }
+    vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    priv->persistent.enabled = false;
+}
+
+static int
+persistent_alloc(const struct vlc_gl_interop *interop)
+{
+    struct priv *priv = interop->priv;
+    const opengl_vtable_t *vt = interop->vt;
+
+    /* Size the buffers for the output layout, as the PBO pictures */
+    picture_t *pic = picture_NewFromFormat(&interop->fmt_out);
+    if (pic == NULL)
+        return VLC_ENOMEM;
+    assert((unsigned) pic->i_planes == interop->tex_count);
+    priv->persistent.planes = pic->i_planes;
+    for (int i = 0; i < pic->i_planes; ++i)
+        priv->persistent.bytes[i] = (size_t) pic->p[i].i_pitch * pic->p[i].i_lines;
+    picture_Release(pic);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+                           | GL_MAP_COHERENT_BIT;
+
+    vt->GetError();
+    for (size_t i = 0; i < PERSISTENT_COUNT; ++i)
+    {
+        vt->GenBuffers(priv->persistent.planes, priv->persistent.buffers[i]);
+        for (unsigned j = 0; j < priv->persistent.planes; ++j)
+        {
+            vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                           priv->persistent.buffers[i][j]);
+            vt->BufferStorage(GL_PIXEL_UNPACK_BUFFER,
+                              priv->persistent.bytes[j], NULL, flags);
+            priv->persistent.maps[i][j] =
+                vt->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                   priv->persistent.bytes[j], flags);
+            if (priv->persistent.maps[i][j] == NULL
+             || vt->GetError() != GL_NO_ERROR)
+            {
+                msg_Err(interop->gl, "could not map persistent PBO buffers");
+                persistent_release(interop);
+                return VLC_EGENERIC;
+            }
+        }
+    }
+    vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    priv->persistent.idx = 0;
+    priv->persistent.enabled = true;
+    return VLC_SUCCESS;
+}
+
+static int
+tc_common_update(const struct vlc_gl_interop *interop, GLuint *textures,
+                 const GLsizei *tex_width, const GLsizei *tex_height,
+                 picture_t *pic, const size_t *plane_offset);
+
+static int
+tc_persistent_update(const struct vlc_gl_interop *interop, GLuint *textures,
+                     const GLsizei *tex_width, const GLsizei *tex_height,
+                     picture_t *pic, const size_t *plane_offset)
+{
+    struct priv *priv = interop->priv;
+    const opengl_vtable_t *vt = interop->vt;
+
+    /* Pictures larger than the output layout (e.g. padded by the decoder)
+     * do not fit in the buffers */
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        if ((size_t) pic->p[i].i_lines * pic->p[i].i_pitch
+                > priv->persistent.bytes[i])
+            return tc_common_update(interop, textures, tex_width, tex_height,
+                                    pic, plane_offset);
+    }
+
+    const size_t idx = priv->persistent.idx;
+    priv->persistent.idx = (idx + 1) % PERSISTENT_COUNT;
+
+    /* Wait for the upload from this buffer, PERSISTENT_COUNT frames ago */
+    GLsync fence = priv->persistent.fences[idx];
+    if (fence)
+    {
+        GLenum status = vt->ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                           INT64_C(1000000000));
+        vt->DeleteSync(fence);
+        priv->persistent.fences[idx] = NULL;
+        if (status == GL_WAIT_FAILED || status == GL_TIMEOUT_EXPIRED)
+            msg_Warn(interop->gl, "persistent PBO wait failed");
+    }
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const size_t size = (size_t) pic->p[i].i_lines * pic->p[i].i_pitch;
+        memcpy(priv->persistent.maps[idx][i], pic->p[i].p_pixels, size);
+
+        vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, priv->persistent.buffers[idx][i]);
+
+        vt->ActiveTexture(GL_TEXTURE0 + i);
+        vt->BindTexture(interop->tex_target, textures[i]);
+
+        vt->PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        vt->PixelStorei(GL_UNPACK_ROW_LENGTH, pic->p[i].i_pitch
+            * tex_width[i] / (pic->p[i].i_visible_pitch ? pic->p[i].i_visible_pitch : 1));
+
+        const uintptr_t offset = plane_offset != NULL ? plane_offset[i] : 0;
+        vt->TexSubImage2D(interop->tex_target, 0, 0, 0, tex_width[i], tex_height[i],
+                          interop->texs[i].format, interop->texs[i].type,
+                          (const GLvoid *) offset);
+        vt->PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    priv->persistent.fences[idx] =
+        vt->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    /* turn off pbo */
+    vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return VLC_SUCCESS;
+}
+
 static int
 tc_common_allocate_textures(const struct vlc_gl_interop *interop, GLuint *textures,
                             const GLsizei *tex_width, const GLsizei *tex_height)
@@ -288,6 +466,8 @@ void
 opengl_interop_generic_deinit(struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
+    if (priv->persistent.enabled)
+        persistent_release(interop);
     for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
         picture_Release(priv->pbo.display_pics[i]);
     free(priv->texture_temp_buf);
@@ -392,7 +572,28 @@ interop_init:
 
         const bool supports_pbo = has_pbo && interop->vt->BufferData
             && interop->vt->BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
+
+        /* Persistent mapping with OpenGL 4.4 or GLES with the extension */
+        const bool has_storage = interop->api->is_gles
+            ? vlc_gl_StrHasToken(interop->api->extensions, "GL_EXT_buffer_storage")
+            : strverscmp((const char *)ogl_version, "4.4") >= 0 ||
+              vlc_gl_StrHasToken(interop->api->extensions, "GL_ARB_buffer_storage");
+
+        const bool supports_persistent = has_pbo && has_storage
+            && interop->vt->BufferStorage && interop->vt->MapBufferRange
+            && interop->vt->UnmapBuffer && interop->vt->FenceSync
+            && interop->vt->ClientWaitSync && interop->vt->DeleteSync;
+        if (supports_persistent && persistent_alloc(interop) == VLC_SUCCESS)
+        {
+            static const struct vlc_gl_interop_ops persistent_ops = {
+                .allocate_textures = tc_common_allocate_textures,
+                .update_textures = tc_persistent_update,
+                .close = opengl_interop_generic_deinit,
+            };
+            interop->ops = &persistent_ops;
+            msg_Dbg(interop->gl, "persistent PBO support enabled");
+        }
+        else if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
         {
             static const struct vlc_gl_interop_ops pbo_ops = {
                 .allocate_textures = tc_common_allocate_textures,
@@ -46,6 +46,13 @@ typedef struct {
     GLsizei  width;
     GLsizei  height;
 
+    /* uploaded content, held so that it can not be recycled */
+    picture_t *picture;
+    unsigned   x_offset;
+    unsigned   y_offset;
+    unsigned   visible_width;
+    unsigned   visible_height;
+
     float    alpha;
 
     float    top;
@@ -78,10 +85,13 @@ struct vlc_gl_sub_renderer
         GLint alpha;
     } uloc;
 
-    GLuint *buffer_objects;
-    unsigned buffer_object_count;
+    /* vertex and texture coordinates of all the regions */
+    GLuint buffer_object;
 };
 
+/* 4 vertices (triangle strip) of 2 position and 2 texture coordinates */
+#define REGION_VERTEX_FLOATS (4 * 4)
+
 static int
 FetchLocations(struct vlc_gl_sub_renderer *sr)
 {
@@ -175,15 +185,7 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
     if (ret != VLC_SUCCESS)
         goto error_2;
 
-    /* Initial number of allocated buffer objects for subpictures, will grow dynamically. */
-    static const unsigned INITIAL_BUFFER_OBJECT_COUNT = 8;
-    sr->buffer_objects = vlc_alloc(INITIAL_BUFFER_OBJECT_COUNT, sizeof(GLuint));
-    if (!sr->buffer_objects)
-        goto error_2;
-
-    sr->buffer_object_count = INITIAL_BUFFER_OBJECT_COUNT;
-
-    vt->GenBuffers(sr->buffer_object_count, sr->buffer_objects);
+    vt->GenBuffers(1, &sr->buffer_object);
 
     return sr;
 
@@ -198,26 +200,87 @@ error_1:
 void
 vlc_gl_sub_renderer_Delete(struct vlc_gl_sub_renderer *sr)
 {
-    if (sr->buffer_object_count)
-        sr->vt->DeleteBuffers(sr->buffer_object_count, sr->buffer_objects);
-    free(sr->buffer_objects);
+    sr->vt->DeleteBuffers(1, &sr->buffer_object);
 
     for (unsigned i = 0; i < sr->region_count; ++i)
     {
         if (sr->regions[i].texture)
             sr->vt->DeleteTextures(1, &sr->regions[i].texture);
+        if (sr->regions[i].picture)
+            picture_Release(sr->regions[i].picture);
     }
     free(sr->regions);
 
     free(sr);
 }
 
+static bool
+IsSameContent(const gl_region_t *glr, const subpicture_region_t *r)
+{
+    return glr->picture == r->p_picture &&
+           glr->x_offset == r->fmt.i_x_offset &&
+           glr->y_offset == r->fmt.i_y_offset &&
+           glr->visible_width == r->fmt.i_visible_width &&
+           glr->visible_height == r->fmt.i_visible_height;
+}
+
+static int
+UploadRegion(struct vlc_gl_sub_renderer *sr, gl_region_t *glr,
+             subpicture_region_t *r, gl_region_t *last, int last_count)
+{
+    const struct vlc_gl_interop *interop = sr->interop;
+
+    /* Try to recycle the textures allocated by the previous
+       call to this function. */
+    for (int j = 0; j < last_count; j++) {
+        if (last[j].texture &&
+            last[j].width  == glr->width &&
+            last[j].height == glr->height) {
+            glr->texture = last[j].texture;
+            last[j].texture = 0;
+            break;
+        }
+    }
+
+    const size_t pixels_offset =
+        r->fmt.i_y_offset * r->p_picture->p->i_pitch +
+        r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
+    if (!glr->texture)
+    {
+        /* Could not recycle a previous texture, generate a new one. */
+        int ret = vlc_gl_interop_GenerateTextures(interop, &glr->width,
+                                                  &glr->height,
+                                                  &glr->texture);
+        if (ret != VLC_SUCCESS)
+            return ret;
+    }
+    /* Use the visible pitch of the region */
+    r->p_picture->p[0].i_visible_pitch = r->fmt.i_visible_width
+                                       * r->p_picture->p[0].i_pixel_pitch;
+
+    GLsizei width = r->fmt.i_visible_width;
+    GLsizei height = r->fmt.i_visible_height;
+    int ret = interop->ops->update_textures(interop, &glr->texture,
+                                            &width, &height,
+                                            r->p_picture, &pixels_offset);
+    if (ret != VLC_SUCCESS)
+        return ret;
+
+    glr->picture = picture_Hold(r->p_picture);
+    glr->x_offset = r->fmt.i_x_offset;
+    glr->y_offset = r->fmt.i_y_offset;
+    glr->visible_width = r->fmt.i_visible_width;
+    glr->visible_height = r->fmt.i_visible_height;
+    return VLC_SUCCESS;
+}
+
 int
 vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpicture)
 {
     GL_ASSERT_NOERROR(sr->vt);
 
     const struct vlc_gl_interop *interop = sr->interop;
+    const opengl_vtable_t *vt = sr->vt;
 
     int last_count = sr->region_count;
     gl_region_t *last = sr->regions;
@@ -228,8 +291,13 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
             count++;
 
         gl_region_t *regions = calloc(count, sizeof(*regions));
-        if (!regions)
+        GLfloat *vertices = vlc_alloc(count, REGION_VERTEX_FLOATS * sizeof(GLfloat));
+        if (!regions || !vertices)
+        {
+            free(regions);
+            free(vertices);
             return VLC_ENOMEM;
+        }
 
         sr->region_count = count;
         sr->regions = regions;
@@ -256,43 +324,51 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
             glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
             glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
+            const GLfloat region_vertices[REGION_VERTEX_FLOATS] = {
+                glr->left,  glr->top,    0.0,            0.0,
+                glr->left,  glr->bottom, 0.0,            glr->tex_height,
+                glr->right, glr->top,    glr->tex_width, 0.0,
+                glr->right, glr->bottom, glr->tex_width, glr->tex_height,
+            };
+            memcpy(&vertices[i * REGION_VERTEX_FLOATS], region_vertices,
+                   sizeof(region_vertices));
+
+            /* The regions pictures are not modified once rendered: keep the
+               texture of the same picture region, e.g. of a static logo or
+               of a subtitle line displayed over several frames. */
             glr->texture = 0;
-            /* Try to recycle the textures allocated by the previous
-               call to this function. */
             for (int j = 0; j < last_count; j++) {
-                if (last[j].texture &&
-                    last[j].width  == glr->width &&
+                if (last[j].texture && IsSameContent(&last[j], r) &&
+                    last[j].width == glr->width &&
                     last[j].height == glr->height) {
                     glr->texture = last[j].texture;
+                    glr->picture = last[j].picture;
+                    glr->x_offset = last[j].x_offset;
+                    glr->y_offset = last[j].y_offset;
+                    glr->visible_width = last[j].visible_width;
+                    glr->visible_height = last[j].visible_height;
                     memset(&last[j], 0, sizeof(last[j]));
                     break;
                 }
             }
+        }
 
-            const size_t pixels_offset =
-                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
-                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
-            if (!glr->texture)
-            {
-                /* Could not recycle a previous texture, generate a new one. */
-                int ret = vlc_gl_interop_GenerateTextures(interop, &glr->width,
-                                                          &glr->height,
-                                                          &glr->texture);
-                if (ret != VLC_SUCCESS)
-                    break;
-            }
-            /* Use the visible pitch of the region */
-            r->p_picture->p[0].i_visible_pitch = r->fmt.i_visible_width
-                                               * r->p_picture->p[0].i_pixel_pitch;
-
-            GLsizei width = r->fmt.i_visible_width;
-            GLsizei height = r->fmt.i_visible_height;
-            int ret = interop->ops->update_textures(interop, &glr->texture,
-                                                    &width, &height,
-                                                    r->p_picture, &pixels_offset);
-            if (ret != VLC_SUCCESS)
+        /* Upload the changed regions into the remaining textures */
+        i = 0;
+        for (subpicture_region_t *r = subpicture->p_region;
+             r; r = r->p_next, i++) {
+            gl_region_t *glr = &sr->regions[i];
+            if (glr->texture)
+                continue;
+            if (UploadRegion(sr, glr, r, last, last_count) != VLC_SUCCESS)
                 break;
         }
+
+        vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_object);
+        vt->BufferData(GL_ARRAY_BUFFER,
+                       count * REGION_VERTEX_FLOATS * sizeof(GLfloat),
+                       vertices, GL_DYNAMIC_DRAW);
+        free(vertices);
     }
     else
     {
@@ -303,6 +379,8 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
     for (int i = 0; i < last_count; i++) {
         if (last[i].texture)
             vlc_gl_interop_DeleteTextures(interop, &last[i].texture);
+        if (last[i].picture)
+            picture_Release(last[i].picture);
     }
     free(last);
 
@@ -325,53 +403,26 @@ vlc_gl_sub_renderer_Draw(struct vlc_gl_sub_renderer *sr)
     vt->Enable(GL_BLEND);
     vt->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    /* We need two buffer objects for each region: for vertex and texture coordinates. */
-    if (2 * sr->region_count > sr->buffer_object_count) {
-        if (sr->buffer_object_count > 0)
-            vt->DeleteBuffers(sr->buffer_object_count, sr->buffer_objects);
-        sr->buffer_object_count = 0;
-
-        int new_count = 2 * sr->region_count;
-        sr->buffer_objects = realloc_or_free(sr->buffer_objects, new_count * sizeof(GLuint));
-        if (!sr->buffer_objects)
-            return VLC_ENOMEM;
-
-        sr->buffer_object_count = new_count;
-        vt->GenBuffers(sr->buffer_object_count, sr->buffer_objects);
-    }
+    /* All the coordinates were uploaded once by Prepare() */
+    const GLsizei stride = 4 * sizeof(GLfloat);
+    vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_object);
+    vt->EnableVertexAttribArray(sr->aloc.vertex_pos);
+    vt->VertexAttribPointer(sr->aloc.vertex_pos, 2, GL_FLOAT, 0, stride,
+                            (const void *) 0);
+    vt->EnableVertexAttribArray(sr->aloc.tex_coords_in);
+    vt->VertexAttribPointer(sr->aloc.tex_coords_in, 2, GL_FLOAT, 0, stride,
+                            (const void *) (2 * sizeof(GLfloat)));
 
     vt->ActiveTexture(GL_TEXTURE0 + 0);
     for (unsigned i = 0; i < sr->region_count; i++) {
         gl_region_t *glr = &sr->regions[i];
-        const GLfloat vertexCoord[] = {
-            glr->left,  glr->top,
-            glr->left,  glr->bottom,
-            glr->right, glr->top,
-            glr->right, glr->bottom,
-        };
-        const GLfloat textureCoord[] = {
-            0.0, 0.0,
-            0.0, glr->tex_height,
-            glr->tex_width, 0.0,
-            glr->tex_width, glr->tex_height,
-        };
 
         assert(glr->texture != 0);
         vt->BindTexture(interop->tex_target, glr->texture);
 
         vt->Uniform1f(sr->uloc.alpha, glr->alpha);
 
-        vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_objects[2 * i]);
-        vt->BufferData(GL_ARRAY_BUFFER, sizeof(textureCoord), textureCoord, GL_STATIC_DRAW);
-        vt->EnableVertexAttribArray(sr->aloc.tex_coords_in);
-        vt->VertexAttribPointer(sr->aloc.tex_coords_in, 2, GL_FLOAT, 0, 0, 0);
-
-        vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_objects[2 * i + 1]);
-        vt->BufferData(GL_ARRAY_BUFFER, sizeof(vertexCoord), vertexCoord, GL_STATIC_DRAW);
-        vt->EnableVertexAttribArray(sr->aloc.vertex_pos);
-        vt->VertexAttribPointer(sr->aloc.vertex_pos, 2, GL_FLOAT, 0, 0, 0);
-
-        vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        vt->DrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
     }
     vt->Disable(GL_BLEND);
 
@@ -41,6 +41,19 @@ struct vlc_vidsplit_part {
     vlc_sem_t lock;
     unsigned width;
     unsigned height;
+
+    /* Presentation thread, if the outputs are run in parallel */
+    struct vout_display_sys_t *sys;
+    int index;
+    vlc_thread_t thread;
+    vlc_sem_t start;
+    vlc_sem_t done;
+};
+
+enum vlc_vidsplit_op {
+    VIDSPLIT_PREPARE,
+    VIDSPLIT_DISPLAY,
+    VIDSPLIT_QUIT,
 };
 
 typedef struct vout_display_sys_t {
@@ -49,8 +62,75 @@ typedef struct vout_display_sys_t {
 
     picture_t **pictures;
     struct vlc_vidsplit_part *parts;
+
+    /* Operation run by all the parts at once */
+    enum vlc_vidsplit_op op;
+    vlc_tick_t date;
+    int threads;
 } vout_display_sys_t;
 
+static void vlc_vidsplit_Run(vout_display_sys_t *sys, int i)
+{
+    struct vlc_vidsplit_part *part = &sys->parts[i];
+
+    switch (sys->op) {
+        case VIDSPLIT_PREPARE:
+            sys->pictures[i] = vout_display_Prepare(part->display,
+                                                    sys->pictures[i], NULL,
+                                                    sys->date);
+            break;
+        case VIDSPLIT_DISPLAY:
+            if (sys->pictures[i] != NULL)
+            {
+                vout_display_Display(part->display, sys->pictures[i]);
+                picture_Release(sys->pictures[i]);
+            }
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
+static void *vlc_vidsplit_Thread(void *data)
+{
+    struct vlc_vidsplit_part *part = data;
+    vout_display_sys_t *sys = part->sys;
+
+    for (;;) {
+        vlc_sem_wait(&part->start);
+        if (sys->op == VIDSPLIT_QUIT)
+            break;
+        vlc_vidsplit_Run(sys, part->index);
+        vlc_sem_post(&part->done);
+    }
+    return NULL;
+}
+
+/**
+ * Runs an operation on every part, and waits for all of them.
+ *
+ * With one thread per part, the outputs upload and present their pictures
+ * concurrently, so that they flip on the same vertical synchronization
+ * instead of waiting for each other.
+ */
+static void vlc_vidsplit_Dispatch(vout_display_sys_t *sys,
+                                  enum vlc_vidsplit_op op)
+{
+    int n = sys->splitter.i_output;
+
+    sys->op = op;
+    if (sys->threads < n) {
+        for (int i = 0; i < n; i++)
+            vlc_vidsplit_Run(sys, i);
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+        vlc_sem_post(&sys->parts[i].start);
+    for (int i = 0; i < n; i++)
+        vlc_sem_wait(&sys->parts[i].done);
+}
+
 static void vlc_vidsplit_Prepare(vout_display_t *vd, picture_t *pic,
                                  subpicture_t *subpic, vlc_tick_t date)
 {
@@ -69,29 +149,21 @@ static void vlc_vidsplit_Prepare(vout_display_t *vd, picture_t *pic,
     }
     vlc_mutex_unlock(&sys->lock);
 
-    for (int i = 0; i < sys->splitter.i_output; i++) {
-        struct vlc_vidsplit_part *part = &sys->parts[i];
+    for (int i = 0; i < sys->splitter.i_output; i++)
+        vlc_sem_wait(&sys->parts[i].lock);
 
-        vlc_sem_wait(&part->lock);
-        sys->pictures[i] = vout_display_Prepare(part->display,
-                                                sys->pictures[i], NULL, date);
-    }
+    sys->date = date;
+    vlc_vidsplit_Dispatch(sys, VIDSPLIT_PREPARE);
 }
 
 static void vlc_vidsplit_Display(vout_display_t *vd, picture_t *picture)
 {
     vout_display_sys_t *sys = vd->sys;
 
-    for (int i = 0; i < sys->splitter.i_output; i++) {
-        struct vlc_vidsplit_part *part = &sys->parts[i];
+    vlc_vidsplit_Dispatch(sys, VIDSPLIT_DISPLAY);
 
-        if (sys->pictures[i] != NULL)
-        {
-            vout_display_Display(part->display, sys->pictures[i]);
-            picture_Release(sys->pictures[i]);
-        }
-        vlc_sem_post(&part->lock);
-    }
+    for (int i = 0; i < sys->splitter.i_output; i++)
+        vlc_sem_post(&sys->parts[i].lock);
 
     (void) picture;
 }
@@ -116,6 +188,12 @@ static void vlc_vidsplit_Close(vout_display_t *vd)
     vout_display_sys_t *sys = vd->sys;
     int n = sys->splitter.i_output;
 
+    sys->op = VIDSPLIT_QUIT;
+    for (int i = 0; i < sys->threads; i++)
+        vlc_sem_post(&sys->parts[i].start);
+    for (int i = 0; i < sys->threads; i++)
+        vlc_join(sys->parts[i].thread, NULL);
+
     for (int i = 0; i < n; i++) {
         struct vlc_vidsplit_part *part = &sys->parts[i];
         vout_display_t *display;
@@ -255,6 +333,7 @@ static int vlc_vidsplit_Open(vout_display_t *vd,
     video_splitter_t *splitter = &sys->splitter;
 
     vlc_mutex_init(&sys->lock);
+    sys->threads = 0;
     video_format_Copy(&splitter->fmt, vd->source);
 
     splitter->p_module = module_need(splitter, "video splitter", name, true);
@@ -287,6 +366,10 @@ static int vlc_vidsplit_Open(vout_display_t *vd,
         struct vlc_vidsplit_part *part = &sys->parts[i];
 
         vlc_sem_init(&part->lock, 1);
+        vlc_sem_init(&part->start, 0);
+        vlc_sem_init(&part->done, 0);
+        part->sys = sys;
+        part->index = i;
         part->display = NULL;
         part->width = 1;
         part->height = 1;
@@ -316,6 +399,20 @@ static int vlc_vidsplit_Open(vout_display_t *vd,
         vlc_sem_post(&part->lock);
     }
 
+    if (splitter->i_output > 1
+     && var_InheritBool(obj, "video-splitter-parallel")) {
+        for (int i = 0; i < splitter->i_output; i++) {
+            struct vlc_vidsplit_part *part = &sys->parts[i];
+
+            if (vlc_clone(&part->thread, vlc_vidsplit_Thread, part,
+                          VLC_THREAD_PRIORITY_OUTPUT)) {
+                msg_Warn(vd, "cannot run the outputs in parallel");
+                break;
+            }
+            sys->threads++;
+        }
+    }
+
     vd->ops = &ops;
     (void) fmtp;
     return VLC_SUCCESS;
@@ -329,4 +426,9 @@ vlc_module_begin()
     set_callback_display(vlc_vidsplit_Open, 0)
     add_module("video-splitter", "video splitter", NULL,
                N_("Video splitter module"), NULL)
+    add_bool("video-splitter-parallel", true,
+             N_("Present the outputs in parallel"),
+             N_("Prepare and display the pictures of all the outputs "
+                "concurrently, so that they are presented on the same "
+                "vertical synchronization."))
 vlc_module_end()
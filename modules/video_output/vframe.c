@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * vframe.c: video output handing decoded frames to the LibVLC application
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_vout_display.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_media_player.h>
+
+#ifdef __linux__
+# include "../hw/v4l2m2m/drm_prime.h"
+#endif
+#ifdef _WIN32
+# define COBJMACROS
+# include "../video_chroma/d3d11_fmt.h"
+#endif
+#ifdef __APPLE__
+# include "../codec/vt_utils.h"
+#endif
+#ifdef HAVE_VAAPI
+# include "../hw/vaapi/vlc_vaapi.h"
+#endif
+#ifdef HAVE_FFNVCODEC_DYNLINK_LOADER_H
+# include "../hw/nvdec/nvdec_fmt.h"
+#endif
+
+/* NOTE: the callback prototype must match that of LibVLC */
+typedef void (*vlc_vframe_output_cb)(libvlc_video_frame_cb, void *,
+                                     picture_t *, int, vlc_fourcc_t,
+                                     const libvlc_video_frame_plane_t *,
+                                     unsigned, void *, uintptr_t);
+
+typedef struct vout_display_sys_t {
+    vlc_vframe_output_cb output;
+    libvlc_video_frame_cb cb;
+    void *opaque;
+    libvlc_video_frame_type_t type;
+} vout_display_sys_t;
+
+static void Display(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    libvlc_video_frame_plane_t planes[PICTURE_PLANE_MAX];
+    unsigned count = 0;
+    vlc_fourcc_t chroma = pic->format.i_chroma;
+    void *handle = NULL;
+    uintptr_t index = 0;
+
+    switch (sys->type)
+    {
+        case libvlc_video_frame_cpu:
+            for (int i = 0; i < pic->i_planes; i++)
+                planes[i] = (libvlc_video_frame_plane_t) {
+                    .data = pic->p[i].p_pixels,
+                    .fd = -1,
+                    .pitch = pic->p[i].i_pitch,
+                    .lines = pic->p[i].i_visible_lines,
+                };
+            count = pic->i_planes;
+            break;
+#ifdef __linux__
+        case libvlc_video_frame_dmabuf:
+        {
+            drm_prime_picture_context_t *ctx =
+                vlc_drm_prime_PicGetContext(pic);
+            if (ctx == NULL)
+                return;
+
+            chroma = vlc_drm_prime_GetSwChroma(chroma);
+
+            /* The plane heights follow the subsampling of the chroma */
+            const vlc_chroma_description_t *desc =
+                vlc_fourcc_GetChromaDescription(chroma);
+            const unsigned height = pic->format.i_height;
+
+            for (unsigned i = 0; i < ctx->plane_count; i++)
+            {
+                unsigned lines = height;
+
+                if (desc != NULL && i < desc->plane_count)
+                    lines = (height * desc->p[i].h.num + desc->p[i].h.den - 1)
+                          / desc->p[i].h.den;
+
+                planes[i] = (libvlc_video_frame_plane_t) {
+                    .fd = ctx->planes[i].fd,
+                    .offset = ctx->planes[i].offset,
+                    .pitch = ctx->planes[i].pitch,
+                    .lines = lines,
+                };
+            }
+            count = ctx->plane_count;
+            break;
+        }
+#endif
+#ifdef _WIN32
+        case libvlc_video_frame_d3d11:
+        {
+            picture_sys_d3d11_t *p_sys = ActiveD3D11PictureSys(pic);
+            handle = p_sys->texture[0];
+            index = p_sys->slice_index;
+            break;
+        }
+#endif
+#ifdef __APPLE__
+        case libvlc_video_frame_cvpixelbuffer:
+            handle = (void *)cvpxpic_get_ref(pic);
+            break;
+#endif
+#ifdef HAVE_VAAPI
+        case libvlc_video_frame_vaapi:
+            handle = vlc_vaapi_PicGetDisplay(pic);
+            index = vlc_vaapi_PicGetSurface(pic);
+            break;
+#endif
+#ifdef HAVE_FFNVCODEC_DYNLINK_LOADER_H
+        case libvlc_video_frame_cuda:
+        {
+            pic_context_nvdec_t *ctx =
+                NVDEC_PICCONTEXT_FROM_PICCTX(pic->context);
+            handle = (void *)(uintptr_t)ctx->devicePtr;
+            index = ctx->bufferPitch;
+            break;
+        }
+#endif
+        default:
+            vlc_assert_unreachable();
+    }
+
+    sys->output(sys->cb, sys->opaque, pic, sys->type, chroma,
+                planes, count, handle, index);
+}
+
+static int Control(vout_display_t *vd, int query)
+{
+    (void) vd;
+
+    switch (query) {
+        case VOUT_DISPLAY_CHANGE_DISPLAY_SIZE:
+        case VOUT_DISPLAY_CHANGE_DISPLAY_FILLED:
+        case VOUT_DISPLAY_CHANGE_ZOOM:
+        case VOUT_DISPLAY_CHANGE_SOURCE_ASPECT:
+        case VOUT_DISPLAY_CHANGE_SOURCE_CROP:
+            return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+static const struct vlc_display_operations ops = {
+    .display = Display,
+    .control = Control,
+};
+
+static int Open(vout_display_t *vd,
+                video_format_t *fmtp, vlc_video_context *context)
+{
+    vlc_vframe_output_cb output = var_InheritAddress(vd, "vframe-output");
+    libvlc_video_frame_cb cb = var_InheritAddress(vd, "vframe-cb");
+    if (output == NULL || cb == NULL)
+        return VLC_EGENERIC;
+
+    vout_display_sys_t *sys = vlc_obj_malloc(VLC_OBJECT(vd), sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->output = output;
+    sys->cb = cb;
+    sys->opaque = var_InheritAddress(vd, "vframe-data");
+    sys->type = libvlc_video_frame_cpu;
+
+    /* Keep the frames of the hardware decoders in their memory whenever
+     * their native handle can be handed to the application. */
+    enum vlc_video_context_type type = context != NULL
+        ? vlc_video_context_GetType(context) : VLC_VIDEO_CONTEXT_NONE;
+    switch (type)
+    {
+        case VLC_VIDEO_CONTEXT_NONE:
+            break;
+#ifdef __linux__
+        case VLC_VIDEO_CONTEXT_DRM_PRIME:
+            sys->type = libvlc_video_frame_dmabuf;
+            break;
+#endif
+#ifdef _WIN32
+        case VLC_VIDEO_CONTEXT_D3D11VA:
+            sys->type = libvlc_video_frame_d3d11;
+            break;
+#endif
+#ifdef __APPLE__
+        case VLC_VIDEO_CONTEXT_CVPX:
+            sys->type = libvlc_video_frame_cvpixelbuffer;
+            break;
+#endif
+#ifdef HAVE_VAAPI
+        case VLC_VIDEO_CONTEXT_VAAPI:
+            sys->type = libvlc_video_frame_vaapi;
+            break;
+#endif
+#ifdef HAVE_FFNVCODEC_DYNLINK_LOADER_H
+        case VLC_VIDEO_CONTEXT_NVDEC:
+            sys->type = libvlc_video_frame_cuda;
+            break;
+#endif
+        default:
+            /* Let the core download the frames to system memory */
+            msg_Dbg(vd, "converting hardware frames to system memory");
+            fmtp->i_chroma = VLC_CODEC_I420;
+            break;
+    }
+
+    vd->sys = sys;
+    vd->ops = &ops;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_description(N_("Video frames output for LibVLC"))
+    set_shortname(N_("Video frames"))
+
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VOUT)
+
+    set_callback_display(Open, 0)
+vlc_module_end()
@@ -31,10 +31,12 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <wayland-client.h>
 #include "viewporter-client-protocol.h"
+#include "presentation-time-client-protocol.h"
 #include "registry.h"
 
 #include <vlc_common.h>
@@ -51,6 +53,8 @@ typedef struct vout_display_sys_t
     struct wl_shm *shm;
     struct wp_viewporter *viewporter;
     struct wp_viewport *viewport;
+    struct wp_presentation *presentation;
+    bool monotonic; /* presentation clock */
 
     size_t active_buffers;
 } vout_display_sys_t;
@@ -137,12 +141,62 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
     (void) subpic;
 }
 
+static void feedback_sync_output_cb(void *data,
+                                    struct wp_presentation_feedback *fb,
+                                    struct wl_output *output)
+{
+    (void) data; (void) fb; (void) output;
+}
+
+static void feedback_presented_cb(void *data,
+                                  struct wp_presentation_feedback *fb,
+                                  uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                                  uint32_t tv_nsec, uint32_t refresh,
+                                  uint32_t seq_hi, uint32_t seq_lo,
+                                  uint32_t flags)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+    uint64_t sec = ((uint64_t)tv_sec_hi << 32) | tv_sec_lo;
+
+    /* Only the vblank timestamps are of any use to align the pictures */
+    if (sys->monotonic && (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC))
+        vout_display_SendEventVsync(vd, vlc_tick_from_sec(sec)
+                                        + VLC_TICK_FROM_NS(tv_nsec),
+                                    VLC_TICK_FROM_NS(refresh));
+
+    wp_presentation_feedback_destroy(fb);
+    (void) seq_hi; (void) seq_lo;
+}
+
+static void feedback_discarded_cb(void *data,
+                                  struct wp_presentation_feedback *fb)
+{
+    wp_presentation_feedback_destroy(fb);
+    (void) data;
+}
+
+static const struct wp_presentation_feedback_listener feedback_cbs =
+{
+    feedback_sync_output_cb,
+    feedback_presented_cb,
+    feedback_discarded_cb,
+};
+
 static void Display(vout_display_t *vd, picture_t *pic)
 {
     vout_display_sys_t *sys = vd->sys;
     struct wl_display *display = sys->embed->display.wl;
     struct wl_surface *surface = sys->embed->handle.wl;
 
+    if (sys->presentation != NULL)
+    {
+        struct wp_presentation_feedback *fb =
+            wp_presentation_feedback(sys->presentation, surface);
+        if (fb != NULL)
+            wp_presentation_feedback_add_listener(fb, &feedback_cbs, vd);
+    }
+
     wl_surface_commit(surface);
     wl_display_roundtrip_queue(display, sys->eventq);
 
@@ -230,6 +284,25 @@ static const struct wl_shm_listener shm_cbs =
     shm_format_cb,
 };
 
+static void presentation_clock_id_cb(void *data,
+                                     struct wp_presentation *presentation,
+                                     uint32_t clk_id)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    /* The VLC clock is monotonic */
+    sys->monotonic = clk_id == CLOCK_MONOTONIC;
+    if (!sys->monotonic)
+        msg_Dbg(vd, "ignoring presentation clock %"PRIu32, clk_id);
+    (void) presentation;
+}
+
+static const struct wp_presentation_listener presentation_cbs =
+{
+    presentation_clock_id_cb,
+};
+
 static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
@@ -250,6 +323,8 @@ static void Close(vout_display_t *vd)
         wp_viewport_destroy(sys->viewport);
     if (sys->viewporter != NULL)
         wp_viewporter_destroy(sys->viewporter);
+    if (sys->presentation != NULL)
+        wp_presentation_destroy(sys->presentation);
     wl_shm_destroy(sys->shm);
     wl_display_flush(display);
     wl_event_queue_destroy(sys->eventq);
@@ -303,6 +378,13 @@ static int Open(vout_display_t *vd,
                       vlc_wl_interface_bind(registry, "wp_viewporter",
                                             &wp_viewporter_interface, NULL);
 
+    sys->presentation = (struct wp_presentation *)
+                        vlc_wl_interface_bind(registry, "wp_presentation",
+                                              &wp_presentation_interface, NULL);
+    sys->monotonic = false;
+    if (sys->presentation != NULL)
+        wp_presentation_add_listener(sys->presentation, &presentation_cbs, vd);
+
     wl_shm_add_listener(sys->shm, &shm_cbs, vd);
     wl_display_roundtrip_queue(display, sys->eventq);
 
@@ -52,6 +52,11 @@
 #define ACTIVE_LONGTEXT N_("Comma-separated list of active windows, " \
     "defaults to all")
 
+#define ZEROCOPY_TEXT N_("Crop views")
+#define ZEROCOPY_LONGTEXT N_("Send each window a cropped view of the " \
+    "source picture instead of a copy. This also allows hardware " \
+    "decoded pictures, which are cropped by the video outputs.")
+
 #define CFG_PREFIX "wall-"
 
 static int  Open ( vlc_object_t * );
@@ -69,6 +74,7 @@ vlc_module_begin()
     add_integer( CFG_PREFIX "rows", 3, ROWS_TEXT, ROWS_LONGTEXT )
     change_integer_range( 1, ROW_MAX )
     add_string( CFG_PREFIX "active", NULL, ACTIVE_TEXT, ACTIVE_LONGTEXT )
+    add_bool( CFG_PREFIX "zerocopy", false, ZEROCOPY_TEXT, ZEROCOPY_LONGTEXT )
     add_obsolete_string( CFG_PREFIX "element-aspect" ) /* since 4.0.0 */
 
     add_shortcut( "wall" )
@@ -79,7 +85,7 @@ vlc_module_end()
  * Local prototypes
  *****************************************************************************/
 static const char *const ppsz_filter_options[] = {
-    "cols", "rows", "active", NULL
+    "cols", "rows", "active", "zerocopy", NULL
 };
 
 /* */
@@ -98,6 +104,8 @@ typedef struct
     int           i_col;
     int           i_row;
     int           i_output;
+    bool          b_zerocopy;
+    bool          b_opaque; /* hardware pictures, cropped by the outputs */
     wall_output_t pp_output[COL_MAX][ROW_MAX]; /* [x][y] */
 } video_splitter_sys_t;
 
@@ -114,15 +122,23 @@ static int Open( vlc_object_t *p_this )
 
     const vlc_chroma_description_t *p_chroma =
         vlc_fourcc_GetChromaDescription( p_splitter->fmt.i_chroma );
-    if( p_chroma == NULL || p_chroma->plane_count == 0 )
+    if( p_chroma == NULL )
+        return VLC_EGENERIC;
+
+    config_ChainParse( p_splitter, CFG_PREFIX, ppsz_filter_options,
+                       p_splitter->p_cfg );
+
+    const bool b_zerocopy = var_InheritBool( p_splitter, CFG_PREFIX "zerocopy" );
+    /* Opaque pictures can only be split by the outputs themselves */
+    if( p_chroma->plane_count == 0 && !b_zerocopy )
         return VLC_EGENERIC;
 
     p_splitter->p_sys = p_sys = malloc( sizeof(*p_sys) );
     if( !p_sys )
         return VLC_ENOMEM;
 
-    config_ChainParse( p_splitter, CFG_PREFIX, ppsz_filter_options,
-                       p_splitter->p_cfg );
+    p_sys->b_zerocopy = b_zerocopy;
+    p_sys->b_opaque = p_chroma->plane_count == 0;
 
     /* */
     p_sys->i_col = var_CreateGetInteger( p_splitter, CFG_PREFIX "cols" );
@@ -218,10 +234,23 @@ static int Open( vlc_object_t *p_this )
             video_splitter_output_t *p_cfg = &p_splitter->p_output[p_output->i_output];
 
             video_format_Copy( &p_cfg->fmt, &p_splitter->fmt );
-            p_cfg->fmt.i_visible_width  =
-            p_cfg->fmt.i_width          = p_output->i_width;
-            p_cfg->fmt.i_visible_height =
-            p_cfg->fmt.i_height         = p_output->i_height;
+            if( p_sys->b_opaque )
+            {
+                /* The surface is shared, only the visible area changes */
+                p_cfg->fmt.i_x_offset      += p_output->i_left;
+                p_cfg->fmt.i_y_offset      += p_output->i_top;
+                p_cfg->fmt.i_visible_width  = p_output->i_width;
+                p_cfg->fmt.i_visible_height = p_output->i_height;
+            }
+            else
+            {
+                p_cfg->fmt.i_x_offset       =
+                p_cfg->fmt.i_y_offset       = 0;
+                p_cfg->fmt.i_visible_width  =
+                p_cfg->fmt.i_width          = p_output->i_width;
+                p_cfg->fmt.i_visible_height =
+                p_cfg->fmt.i_height         = p_output->i_height;
+            }
             p_cfg->fmt.i_sar_num        = p_splitter->fmt.i_sar_num;
             p_cfg->fmt.i_sar_den        = p_splitter->fmt.i_sar_den;
             p_cfg->psz_module = NULL;
@@ -247,10 +276,90 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/**
+ * Creates a picture sharing the pixels of the source, restricted to a window.
+ */
+static picture_t *NewView( video_splitter_t *p_splitter,
+                           const wall_output_t *p_output, picture_t *p_src )
+{
+    video_splitter_sys_t *p_sys = p_splitter->p_sys;
+    const video_format_t *p_fmt = &p_splitter->p_output[p_output->i_output].fmt;
+
+    picture_t *p_view = picture_Clone( p_src );
+    if( !p_view )
+        return NULL;
+
+    p_view->format.i_x_offset       = p_fmt->i_x_offset;
+    p_view->format.i_y_offset       = p_fmt->i_y_offset;
+    p_view->format.i_visible_width  = p_fmt->i_visible_width;
+    p_view->format.i_visible_height = p_fmt->i_visible_height;
+    if( p_sys->b_opaque )
+        return p_view;
+
+    p_view->format.i_width  = p_fmt->i_width;
+    p_view->format.i_height = p_fmt->i_height;
+
+    const plane_t *p0 = &p_src->p[0];
+    const unsigned i_left = p_splitter->fmt.i_x_offset + p_output->i_left;
+    const unsigned i_top  = p_splitter->fmt.i_y_offset + p_output->i_top;
+
+    for( int i = 0; i < p_view->i_planes; i++ )
+    {
+        const plane_t *p_in = &p_src->p[i];
+        plane_t *p = &p_view->p[i];
+
+        /* Keep the source pitch, only move the origin and shrink the lines */
+        const int i_y = i_top * p_in->i_visible_lines / p0->i_visible_lines;
+        const int i_x = i_left * p0->i_pixel_pitch
+                      * p_in->i_visible_pitch / p0->i_visible_pitch;
+
+        p->p_pixels = p_in->p_pixels + i_y * p_in->i_pitch
+                    + ( i_x - (i_x % p_in->i_pixel_pitch) );
+        p->i_visible_lines = p_output->i_height * p_in->i_visible_lines
+                           / p0->i_visible_lines;
+        p->i_lines = p->i_visible_lines;
+        p->i_visible_pitch = p_output->i_width * p0->i_pixel_pitch
+                           * p_in->i_visible_pitch / p0->i_visible_pitch;
+    }
+    return p_view;
+}
+
+static int FilterViews( video_splitter_t *p_splitter, picture_t *pp_dst[],
+                        picture_t *p_src )
+{
+    video_splitter_sys_t *p_sys = p_splitter->p_sys;
+
+    for( int y = 0; y < p_sys->i_row; y++ )
+    {
+        for( int x = 0; x < p_sys->i_col; x++ )
+        {
+            wall_output_t *p_output = &p_sys->pp_output[x][y];
+            if( !p_output->b_active )
+                continue;
+
+            picture_t *p_view = NewView( p_splitter, p_output, p_src );
+            if( !p_view )
+            {
+                for( int i = 0; i < p_output->i_output; i++ )
+                    picture_Release( pp_dst[i] );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
+            }
+            pp_dst[p_output->i_output] = p_view;
+        }
+    }
+
+    picture_Release( p_src );
+    return VLC_SUCCESS;
+}
+
 static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
 
+    if( p_sys->b_zerocopy )
+        return FilterViews( p_splitter, pp_dst, p_src );
+
     if( video_splitter_NewPicture( p_splitter, pp_dst ) )
     {
         picture_Release( p_src );
@@ -35,9 +35,6 @@
 #include "visual.h"
 #include <math.h>
 
-#include "fft.h"
-#include "window.h"
-
 #define PEAK_SPEED 1
 #define BAR_DECREASE_SPEED 5
 
@@ -69,18 +66,13 @@ typedef struct spectrum_data
 {
     int *peaks;
     int *prev_heights;
-
-    unsigned i_prev_nb_samples;
-    int16_t *p_prev_s16_buff;
-
-    window_param wind_param;
 } spectrum_data;
 
 static int spectrum_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
                         const block_t * p_buffer , picture_t * p_picture)
 {
     spectrum_data *p_data = p_effect->p_data;
-    float p_output[FFT_BUFFER_SIZE];  /* Raw FFT Result  */
+    const float *p_output;            /* Raw FFT Result  */
     int *height;                      /* Bar heights */
     int *peaks;                       /* Peaks */
     int *prev_heights;                /* Previous bar heights */
@@ -103,20 +95,9 @@ static int spectrum_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
      110,115,121,130,141,152,163,174,185,200,255};
     const int *xscale;
 
-    fft_state *p_state;                 /* internal FFT data */
-    DEFINE_WIND_CONTEXT( wind_ctx );    /* internal window data */
-
     int i , j , y , k;
     int i_line;
     int16_t p_dest[FFT_BUFFER_SIZE];      /* Adapted FFT result */
-    int16_t p_buffer1[FFT_BUFFER_SIZE];   /* Buffer on which we perform
-                                             the FFT (first channel) */
-
-    float *p_buffl =                     /* Original buffer */
-            (float*)p_buffer->p_buffer;
-
-    int16_t  *p_buffs;                    /* int16_t converted buffer */
-    int16_t  *p_s16_buff;                 /* int16_t converted buffer */
 
     if (!p_buffer->i_nb_samples) {
         msg_Err(p_aout, "no samples yet");
@@ -132,28 +113,10 @@ static int spectrum_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
 
         p_data->peaks = calloc( 80, sizeof(int) );
         p_data->prev_heights = calloc( 80, sizeof(int) );
-
-        p_data->i_prev_nb_samples = 0;
-        p_data->p_prev_s16_buff = NULL;
-
-        window_get_param( p_aout, &p_data->wind_param );
     }
     peaks = (int *)p_data->peaks;
     prev_heights = (int *)p_data->prev_heights;
 
-    /* Allocate the buffer only if the number of samples change */
-    if( p_buffer->i_nb_samples != p_data->i_prev_nb_samples )
-    {
-        free( p_data->p_prev_s16_buff );
-        p_data->p_prev_s16_buff = vlc_alloc( p_buffer->i_nb_samples *
-                                             p_effect->i_nb_chans,
-                                             sizeof(int16_t));
-        p_data->i_prev_nb_samples = p_buffer->i_nb_samples;
-        if( !p_data->p_prev_s16_buff )
-            return -1;
-    }
-    p_buffs = p_s16_buff = p_data->p_prev_s16_buff;
-
     i_80_bands = var_InheritInteger( p_aout, "visual-80-bands" );
     i_peak     = var_InheritInteger( p_aout, "visual-peaks" );
 
@@ -173,45 +136,13 @@ static int spectrum_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
     {
         return -1;
     }
-    /* Convert the buffer to int16_t  */
-    /* Pasted from float32tos16.c */
-    for (i = p_buffer->i_nb_samples * p_effect->i_nb_chans; i--; )
-    {
-        union { float f; int32_t i; } u;
-        u.f = *p_buffl + 384.0;
-        if(u.i >  0x43c07fff ) * p_buffs = 32767;
-        else if ( u.i < 0x43bf8000 ) *p_buffs = -32768;
-        else *p_buffs = u.i - 0x43c00000;
-
-        p_buffl++ ; p_buffs++ ;
-    }
-    p_state  = visual_fft_init();
-    if( !p_state)
+    p_output = visual_GetSpectrum( p_effect, p_buffer );
+    if( !p_output )
     {
         free( height );
-        msg_Err(p_aout,"unable to initialize FFT transform");
+        msg_Err(p_aout,"unable to compute the FFT");
         return -1;
     }
-    if( !window_init( FFT_BUFFER_SIZE, &p_data->wind_param, &wind_ctx ) )
-    {
-        fft_close( p_state );
-        free( height );
-        msg_Err(p_aout,"unable to initialize FFT window");
-        return -1;
-    }
-    p_buffs = p_s16_buff;
-    for ( i = 0 ; i < FFT_BUFFER_SIZE ; i++)
-    {
-        p_output[i]  = 0;
-        p_buffer1[i] = *p_buffs;
-
-        p_buffs += p_effect->i_nb_chans;
-        if( p_buffs >= &p_s16_buff[p_buffer->i_nb_samples * p_effect->i_nb_chans] )
-            p_buffs = p_s16_buff;
-
-    }
-    window_scale_in_place( p_buffer1, &wind_ctx );
-    fft_perform( p_buffer1, p_output, p_state);
     for( i = 0; i< FFT_BUFFER_SIZE ; i++ )
         p_dest[i] = p_output[i] *  ( 2 ^ 16 ) / ( ( FFT_BUFFER_SIZE / 2 * 32768 ) ^ 2 );
 
@@ -358,10 +289,6 @@ static int spectrum_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
         }
     }
 
-    window_close( &wind_ctx );
-
-    fft_close( p_state );
-
     free( height );
 
     return 0;
@@ -375,7 +302,6 @@ static void spectrum_Free( void *data )
     {
         free( p_data->peaks );
         free( p_data->prev_heights );
-        free( p_data->p_prev_s16_buff );
         free( p_data );
     }
 }
@@ -387,11 +313,6 @@ static void spectrum_Free( void *data )
 typedef struct
 {
     int *peaks;
-
-    unsigned i_prev_nb_samples;
-    int16_t *p_prev_s16_buff;
-
-    window_param wind_param;
 } spectrometer_data;
 
 static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
@@ -400,7 +321,7 @@ static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
 #define Y(R,G,B) ((uint8_t)( (R * .299) + (G * .587) + (B * .114) ))
 #define U(R,G,B) ((uint8_t)( (R * -.169) + (G * -.332) + (B * .500) + 128 ))
 #define V(R,G,B) ((uint8_t)( (R * .500) + (G * -.419) + (B * -.0813) + 128 ))
-    float p_output[FFT_BUFFER_SIZE];  /* Raw FFT Result  */
+    const float *p_output;            /* Raw FFT Result  */
     int *height;                      /* Bar heights */
     int *peaks;                       /* Peaks */
     int i_80_bands;                   /* number of bands : 80 if true else 20 */
@@ -441,19 +362,9 @@ static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
     const int *xscale;
     const double y_scale =  3.60673760222;  /* (log 256) */
 
-    fft_state *p_state;                 /* internal FFT data */
-    DEFINE_WIND_CONTEXT( wind_ctx );    /* internal window data */
-
     int i , j , k;
     int i_line = 0;
     int16_t p_dest[FFT_BUFFER_SIZE];      /* Adapted FFT result */
-    int16_t p_buffer1[FFT_BUFFER_SIZE];   /* Buffer on which we perform
-                                             the FFT (first channel) */
-    float *p_buffl =                     /* Original buffer */
-            (float*)p_buffer->p_buffer;
-
-    int16_t  *p_buffs;                    /* int16_t converted buffer */
-    int16_t  *p_s16_buff;                /* int16_t converted buffer */
 
     if (!p_buffer->i_nb_samples) {
         msg_Err(p_aout, "no samples yet");
@@ -473,26 +384,10 @@ static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
             free( p_data );
             return -1;
         }
-        p_data->i_prev_nb_samples = 0;
-        p_data->p_prev_s16_buff = NULL;
-        window_get_param( p_aout, &p_data->wind_param );
         p_effect->p_data = (void*)p_data;
     }
     peaks = p_data->peaks;
 
-    /* Allocate the buffer only if the number of samples change */
-    if( p_buffer->i_nb_samples != p_data->i_prev_nb_samples )
-    {
-        free( p_data->p_prev_s16_buff );
-        p_data->p_prev_s16_buff = vlc_alloc( p_buffer->i_nb_samples *
-                                             p_effect->i_nb_chans,
-                                             sizeof(int16_t));
-        p_data->i_prev_nb_samples = p_buffer->i_nb_samples;
-        if( !p_data->p_prev_s16_buff )
-            return -1;
-    }
-    p_buffs = p_s16_buff = p_data->p_prev_s16_buff;
-
     i_original     = var_InheritInteger( p_aout, "spect-show-original" );
     i_80_bands     = var_InheritInteger( p_aout, "spect-80-bands" );
     i_separ        = var_InheritInteger( p_aout, "spect-separ" );
@@ -521,44 +416,13 @@ static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
     if( !height)
         return -1;
 
-    /* Convert the buffer to int16_t  */
-    /* Pasted from float32tos16.c */
-    for (i = p_buffer->i_nb_samples * p_effect->i_nb_chans; i--; )
-    {
-        union { float f; int32_t i; } u;
-        u.f = *p_buffl + 384.0;
-        if(u.i >  0x43c07fff ) * p_buffs = 32767;
-        else if ( u.i < 0x43bf8000 ) *p_buffs = -32768;
-        else *p_buffs = u.i - 0x43c00000;
-
-        p_buffl++ ; p_buffs++ ;
-    }
-    p_state  = visual_fft_init();
-    if( !p_state)
-    {
-        msg_Err(p_aout,"unable to initialize FFT transform");
-        free( height );
-        return -1;
-    }
-    if( !window_init( FFT_BUFFER_SIZE, &p_data->wind_param, &wind_ctx ) )
+    p_output = visual_GetSpectrum( p_effect, p_buffer );
+    if( !p_output )
     {
-        fft_close( p_state );
+        msg_Err(p_aout,"unable to compute the FFT");
         free( height );
-        msg_Err(p_aout,"unable to initialize FFT window");
         return -1;
     }
-    p_buffs = p_s16_buff;
-    for ( i = 0 ; i < FFT_BUFFER_SIZE; i++)
-    {
-        p_output[i]    = 0;
-        p_buffer1[i] = *p_buffs;
-
-        p_buffs += p_effect->i_nb_chans;
-        if( p_buffs >= &p_s16_buff[p_buffer->i_nb_samples * p_effect->i_nb_chans] )
-            p_buffs = p_s16_buff;
-    }
-    window_scale_in_place( p_buffer1, &wind_ctx );
-    fft_perform( p_buffer1, p_output, p_state);
     for(i = 0; i < FFT_BUFFER_SIZE; i++)
     {
         int sqrti = sqrt(p_output[i]);
@@ -855,10 +719,6 @@ static int spectrometer_Run(visual_effect_t * p_effect, vlc_object_t *p_aout,
         }
     }
 
-    window_close( &wind_ctx );
-
-    fft_close( p_state );
-
     free( height );
 
     return 0;
@@ -871,7 +731,6 @@ static void spectrometer_Free( void *data )
     if( p_data != NULL )
     {
         free( p_data->peaks );
-        free( p_data->p_prev_s16_buff );
         free( p_data );
     }
 }
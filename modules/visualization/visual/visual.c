@@ -180,6 +180,7 @@ typedef struct
     vout_thread_t   *p_vout;
     visual_effect_t **effect;
     int             i_effect;
+    visual_analysis_t analysis;
     bool            dead;
     vlc_thread_t    thread;
 } filter_sys_t;
@@ -217,6 +218,9 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_effect = 0;
     p_sys->effect   = NULL;
 
+    memset( &p_sys->analysis, 0, sizeof( p_sys->analysis ) );
+    window_get_param( p_this, &p_sys->analysis.wind_param );
+
     /* Parse the effect list */
     psz_parser = psz_effects = var_CreateGetString( p_filter, "effect-list" );
 
@@ -233,6 +237,7 @@ static int Open( vlc_object_t *p_this )
         p_effect->i_idx_left  = 0;
         p_effect->i_idx_right = __MIN( 1, p_effect->i_nb_chans-1 );
 
+        p_effect->p_analysis = &p_sys->analysis;
         p_effect->p_data   = NULL;
         p_effect->pf_run   = NULL;
 
@@ -353,6 +358,9 @@ static block_t *DoRealWork( filter_t *p_filter, block_t *p_in_buf )
                 p_outpic->p[i].i_visible_lines * p_outpic->p[i].i_pitch );
     }
 
+    /* The analysis is computed by the first effect needing it */
+    p_sys->analysis.b_valid = false;
+
     /* We can now call our visualization effects */
     for( int i = 0; i < p_sys->i_effect; i++ )
     {
@@ -418,5 +426,61 @@ static void Close( filter_t * p_filter )
     }
 
     free( p_sys->effect );
+
+    if( p_sys->analysis.p_fft != NULL )
+    {
+        window_close( &p_sys->analysis.wind_ctx );
+        fft_close( p_sys->analysis.p_fft );
+    }
     free( p_sys );
 }
+
+/*****************************************************************************
+ * visual_GetSpectrum: FFT of the first channel, shared by the effects
+ *****************************************************************************/
+const float *visual_GetSpectrum( visual_effect_t *p_effect,
+                                 const block_t *p_buffer )
+{
+    visual_analysis_t *p_analysis = p_effect->p_analysis;
+    int16_t p_buffer1[FFT_BUFFER_SIZE]; /* Buffer on which we perform
+                                           the FFT (first channel) */
+
+    if( p_analysis->b_valid )
+        return p_analysis->spectrum;
+
+    if( p_analysis->p_fft == NULL )
+    {
+        p_analysis->p_fft = visual_fft_init();
+        if( p_analysis->p_fft == NULL )
+            return NULL;
+        if( !window_init( FFT_BUFFER_SIZE, &p_analysis->wind_param,
+                          &p_analysis->wind_ctx ) )
+        {
+            fft_close( p_analysis->p_fft );
+            p_analysis->p_fft = NULL;
+            return NULL;
+        }
+    }
+
+    /* Convert the samples of the first channel to int16_t, looping over the
+     * block if it is shorter than the FFT */
+    /* Pasted from float32tos16.c */
+    const float *p_buffl = (const float *)p_buffer->p_buffer;
+    unsigned i_sample = 0;
+    for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
+    {
+        union { float f; int32_t i; } u;
+        u.f = p_buffl[i_sample * p_effect->i_nb_chans] + 384.0;
+        if( u.i > 0x43c07fff ) p_buffer1[i] = 32767;
+        else if( u.i < 0x43bf8000 ) p_buffer1[i] = -32768;
+        else p_buffer1[i] = u.i - 0x43c00000;
+
+        if( ++i_sample >= p_buffer->i_nb_samples )
+            i_sample = 0;
+    }
+
+    window_scale_in_place( p_buffer1, &p_analysis->wind_ctx );
+    fft_perform( p_buffer1, p_analysis->spectrum, p_analysis->p_fft );
+    p_analysis->b_valid = true;
+    return p_analysis->spectrum;
+}
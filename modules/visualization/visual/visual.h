@@ -20,6 +20,19 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include "fft.h"
+#include "window.h"
+
+/* Audio analysis shared by all the effects, computed once per audio block */
+typedef struct visual_analysis_t
+{
+    bool b_valid;               /* computed for the current block */
+    fft_state *p_fft;           /* FFT state, kept across blocks */
+    window_param wind_param;
+    window_context wind_ctx;
+    float spectrum[FFT_BUFFER_SIZE]; /* FFT intensities of the first channel */
+} visual_analysis_t;
+
 typedef struct visual_effect_t visual_effect_t;
 typedef int (*visual_run_t)(visual_effect_t *, vlc_object_t *,
                             const block_t *, picture_t *);
@@ -37,8 +50,13 @@ struct visual_effect_t
     /* Channels index */
     int        i_idx_left;
     int        i_idx_right;
+
+    visual_analysis_t *p_analysis;
 };
 
+/* Returns the spectrum of the block, or NULL on error */
+const float *visual_GetSpectrum( visual_effect_t *, const block_t * );
+
 extern const struct visual_cb_t
 {
     char name[16];
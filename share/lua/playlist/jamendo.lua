@@ -22,6 +22,9 @@
 
 require "simplexml"
 
+-- Hosts handled by this script, to skip probe() for other URLs
+probe_hosts = { "jamendo.com" }
+
 -- Probe function.
 function probe()
     return vlc.access == "http"
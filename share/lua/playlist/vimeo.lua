@@ -21,6 +21,9 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+-- Hosts handled by this script, to skip probe() for other URLs
+probe_hosts = { "vimeo.com" }
+
 -- Probe function.
 function probe()
     return ( vlc.access == "http" or vlc.access == "https" )
@@ -303,6 +303,9 @@ function pick_stream( stream_map, js_url )
     return string.match( pick, '"url":"(.-)"' )
 end
 
+-- Hosts handled by this script, to skip probe() for other URLs
+probe_hosts = { "youtube.com" }
+
 -- Probe function.
 function probe()
     return ( ( vlc.access == "http" or vlc.access == "https" ) and (
@@ -76,6 +76,7 @@ typedef struct
         vlc_tick_t first_pts;
     } sync;
     vlc_tick_t original_pts;
+    struct vlc_histogram *latency_metric; /**< Output delay histogram */
 
     int requested_stereo_mode; /**< Requested stereo mode set by the user */
     int requested_mix_mode; /**< Requested mix mode set by the user */
@@ -33,6 +33,7 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_metrics.h>
 
 #include "aout_internal.h"
 #include "clock/clock.h"
@@ -130,6 +131,9 @@ error:
     owner->sync.discontinuity = true;
     owner->original_pts = VLC_TICK_INVALID;
     owner->sync.delay = owner->sync.request_delay = 0;
+    owner->latency_metric = vlc_histogram_Get(p_aout, "vlc_aout_latency_seconds",
+        NULL, "Delay until the playback of the next audio sample",
+        VLC_METRIC_SECONDS);
 
     atomic_init (&owner->buffers_lost, 0);
     atomic_init (&owner->buffers_played, 0);
@@ -294,6 +298,8 @@ static void aout_DecSynchronize(audio_output_t *aout, vlc_tick_t system_now,
     if (aout_TimeGet(aout, &delay) != 0)
         return; /* nothing can be done if timing is unknown */
 
+    vlc_histogram_Observe(owner->latency_metric, delay);
+
     if (owner->sync.discontinuity)
     {
         /* Chicken-egg situation for most aout modules that can't be started
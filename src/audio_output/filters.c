@@ -346,6 +346,9 @@ struct aout_filters
         (either the scaletempo filter or a resampler) */
     filter_t *resampler; /**< The resampler */
     int resampling; /**< Current resampling (Hz) */
+    bool skew; /**< Drift correction by inserting or dropping frames */
+    int64_t skew_frac; /**< Pending correction (frames times rate) */
+    audio_sample_format_t skew_fmt; /**< Format of the skewed samples */
     vlc_clock_t *clock;
 
     unsigned count; /**< Number of filters */
@@ -498,6 +501,8 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     filters->rate_filter = NULL;
     filters->resampler = NULL;
     filters->resampling = 0;
+    filters->skew = false;
+    filters->skew_frac = 0;
     filters->count = 0;
     if (clock)
     {
@@ -625,8 +630,16 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     /* insert the resampler */
     output_format.i_rate = outfmt->i_rate;
     assert (AOUT_FMTS_IDENTICAL(&output_format, outfmt));
-    filters->resampler = FindResampler (obj, &input_format,
-                                        &output_format);
+    if (input_format.i_rate == outfmt->i_rate
+     && !var_InheritBool (obj, "audio-drift-resampler"))
+    {   /* No conversion needed: correct the drift without resampler */
+        filters->skew = true;
+        filters->skew_fmt = output_format;
+        msg_Dbg (obj, "drift correction by frames insertion and removal");
+    }
+    else
+        filters->resampler = FindResampler (obj, &input_format,
+                                            &output_format);
     if (filters->resampler == NULL && input_format.i_rate != outfmt->i_rate)
     {
         msg_Err (obj, "cannot setup a resampler");
@@ -694,21 +707,164 @@ void aout_FiltersDelete (vlc_object_t *obj, aout_filters_t *filters)
 
 bool aout_FiltersCanResample (aout_filters_t *filters)
 {
-    return (filters->resampler != NULL);
+    return (filters->resampler != NULL) || filters->skew;
 }
 
 bool aout_FiltersAdjustResampling (aout_filters_t *filters, int adjust)
 {
-    if (filters->resampler == NULL)
+    if (filters->resampler == NULL && !filters->skew)
         return false;
 
     if (adjust)
         filters->resampling += adjust;
     else
+    {
         filters->resampling = 0;
+        filters->skew_frac = 0;
+    }
     return filters->resampling != 0;
 }
 
+#define AOUT_MAX_SKEW 8
+
+/**
+ * Returns how audible repeating or dropping a frame would be, that is the
+ * slope of the signal around the frame.
+ */
+static float SkewCost (const audio_sample_format_t *fmt, const void *buf,
+                       size_t i)
+{
+    const unsigned channels = fmt->i_channels;
+    float cost = 0.f;
+
+    switch (fmt->i_format)
+    {
+        case VLC_CODEC_FL32:
+        {
+            const float *prev = (const float *)buf + (i - 1) * channels;
+            const float *next = (const float *)buf + (i + 1) * channels;
+
+            for (unsigned c = 0; c < channels; c++)
+                cost += fabsf (next[c] - prev[c]);
+            break;
+        }
+        case VLC_CODEC_S16N:
+        {
+            const int16_t *prev = (const int16_t *)buf + (i - 1) * channels;
+            const int16_t *next = (const int16_t *)buf + (i + 1) * channels;
+
+            for (unsigned c = 0; c < channels; c++)
+                cost += abs (next[c] - prev[c]);
+            break;
+        }
+        case VLC_CODEC_S32N:
+        {
+            const int32_t *prev = (const int32_t *)buf + (i - 1) * channels;
+            const int32_t *next = (const int32_t *)buf + (i + 1) * channels;
+
+            for (unsigned c = 0; c < channels; c++)
+                cost += fabsf ((float)next[c] - (float)prev[c]);
+            break;
+        }
+        default: /* any frame will do */
+            break;
+    }
+    return cost;
+}
+
+/**
+ * Corrects the drift by repeating or dropping single frames.
+ *
+ * The correction accumulates as the resampler would shift the rate, and each
+ * whole frame is applied where the signal is the flattest, within its own
+ * part of the block so that the corrections are spread.
+ */
+static block_t *aout_FiltersSkew (aout_filters_t *filters, block_t *block)
+{
+    const audio_sample_format_t *fmt = &filters->skew_fmt;
+    const int64_t rate = fmt->i_rate;
+
+    filters->skew_frac += (int64_t)filters->resampling * block->i_nb_samples;
+
+    const size_t nb = block->i_nb_samples;
+    int64_t n = filters->skew_frac / rate;
+    size_t count = llabs (n);
+
+    if (count > AOUT_MAX_SKEW)
+        count = AOUT_MAX_SKEW;
+    if (count > nb / 4)
+        count = nb / 4;
+    if (count == 0)
+        return block;
+    filters->skew_frac -= (n > 0 ? +1 : -1) * (int64_t)count * rate;
+
+    /* Pick the flattest frame of each part of the block */
+    size_t pos[AOUT_MAX_SKEW];
+    const size_t len = nb / count;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        size_t start = k * len, end = start + len;
+        float best = INFINITY;
+
+        if (start == 0)
+            start = 1;
+        if (end > nb - 1)
+            end = nb - 1;
+        pos[k] = start;
+        for (size_t i = start; i < end; i++)
+        {
+            float cost = SkewCost (fmt, block->p_buffer, i);
+            if (cost < best)
+            {
+                best = cost;
+                pos[k] = i;
+            }
+        }
+    }
+
+    const size_t bpf = fmt->i_bytes_per_frame;
+
+    if (n > 0)
+    {   /* Late: drop the frames */
+        uint8_t *buf = block->p_buffer;
+        size_t dst = pos[0];
+
+        for (size_t k = 0; k < count; k++)
+        {
+            size_t src = pos[k] + 1;
+            size_t end = (k + 1 < count) ? pos[k + 1] : nb;
+
+            memmove (buf + dst * bpf, buf + src * bpf, (end - src) * bpf);
+            dst += end - src;
+        }
+        block->i_nb_samples -= count;
+        block->i_buffer -= count * bpf;
+    }
+    else
+    {   /* Early: repeat the frames */
+        block = block_Realloc (block, 0, block->i_buffer + count * bpf);
+        if (unlikely(block == NULL))
+            return NULL;
+
+        uint8_t *buf = block->p_buffer;
+        size_t end = nb;
+
+        for (size_t k = count; k-- > 0;)
+        {
+            size_t src = pos[k] + 1;
+
+            memmove (buf + (src + k + 1) * bpf, buf + src * bpf,
+                     (end - src) * bpf);
+            memcpy (buf + (src + k) * bpf, buf + pos[k] * bpf, bpf);
+            end = src;
+        }
+        block->i_nb_samples += count;
+    }
+    block->i_length = vlc_tick_from_samples (block->i_nb_samples, rate);
+    return block;
+}
+
 block_t *aout_FiltersPlay(aout_filters_t *filters, block_t *block, float rate)
 {
     int nominal_rate = 0;
@@ -733,6 +889,8 @@ block_t *aout_FiltersPlay(aout_filters_t *filters, block_t *block, float rate)
         block = aout_FiltersPipelinePlay (&filters->resampler, 1, block);
         filters->resampler->fmt_in.audio.i_rate -= filters->resampling;
     }
+    else if (filters->skew && block != NULL && filters->resampling != 0)
+        block = aout_FiltersSkew (filters, block);
 
     if (nominal_rate != 0)
     {   /* Restore input rate */
@@ -784,6 +942,7 @@ void aout_FiltersFlush (aout_filters_t *filters)
 
     if (filters->resampler != NULL)
         aout_FiltersPipelineFlush (&filters->resampler, 1);
+    filters->skew_frac = 0;
 }
 
 void aout_FiltersChangeViewpoint (aout_filters_t *filters,
@@ -25,6 +25,7 @@
 #include <vlc_aout.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include <vlc_tracer.h>
 #include "clock.h"
 #include "clock_internal.h"
@@ -59,6 +60,27 @@ struct vlc_clock_main_t
     clock_point_t first_pcr;
     vlc_tick_t output_dejitter; /* Delay used to absorb the output clock jitter */
     vlc_tick_t input_dejitter; /* Delay used to absorb the input jitter */
+
+    /* Genlock master only: the stream timestamp of ref is presented at the
+     * wall clock date of ref (UTC, shared by all the synchronized players) */
+    struct {
+        vlc_tick_t start; /* requested wall clock date of the first frame */
+        vlc_tick_t period; /* start grid if no date is requested */
+        clock_point_t ref;
+    } genlock;
+
+    /**
+     * Copy of the conversion parameters, published under the lock for the
+     * lock-free conversions (sequence lock, seq is odd while it is written)
+     */
+    struct {
+        atomic_uint seq;
+        _Atomic vlc_tick_t offset;
+        _Atomic double coeff;
+        _Atomic double rate;
+        _Atomic vlc_tick_t delay;
+        atomic_bool paused;
+    } pub;
 };
 
 struct vlc_clock_t
@@ -76,10 +98,59 @@ struct vlc_clock_t
     unsigned priority;
     const char *track_str_id;
 
+    /* Published with the main clock parameters */
+    _Atomic vlc_tick_t pub_delay;
+    atomic_bool pub_master;
+
     const struct vlc_clock_cbs *cbs;
     void *cbs_data;
 };
 
+static vlc_tick_t vlc_clock_master_to_system_locked(vlc_clock_t *clock,
+                                                    vlc_tick_t now,
+                                                    vlc_tick_t ts, double rate);
+
+/**
+ * Publishes the conversion parameters of the main clock, and the ones of a
+ * clock if not NULL, for vlc_clock_ConvertToSystem().
+ *
+ * Must be called with the main clock locked, after any change of the
+ * parameters.
+ */
+static void vlc_clock_main_publish(vlc_clock_main_t *main_clock,
+                                   vlc_clock_t *clock)
+{
+    vlc_mutex_assert(&main_clock->lock);
+
+    unsigned seq = atomic_load_explicit(&main_clock->pub.seq,
+                                        memory_order_relaxed);
+    atomic_store_explicit(&main_clock->pub.seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&main_clock->pub.offset, main_clock->offset,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->pub.coeff, main_clock->coeff,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->pub.rate, main_clock->rate,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->pub.delay, main_clock->delay,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->pub.paused,
+                          main_clock->pause_date != VLC_TICK_INVALID,
+                          memory_order_relaxed);
+    if (clock != NULL)
+    {
+        atomic_store_explicit(&clock->pub_delay, clock->delay,
+                              memory_order_relaxed);
+        atomic_store_explicit(&clock->pub_master,
+                              clock->to_system_locked
+                                == vlc_clock_master_to_system_locked,
+                              memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&main_clock->pub.seq, seq + 2, memory_order_release);
+}
+
 static vlc_tick_t main_stream_to_system(vlc_clock_main_t *main_clock,
                                         vlc_tick_t ts)
 {
@@ -99,6 +170,15 @@ static void vlc_clock_main_reset(vlc_clock_main_t *main_clock)
     main_clock->wait_sync_ref_priority = UINT_MAX;
     main_clock->wait_sync_ref =
         main_clock->last = clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
+    if (main_clock->genlock.ref.stream != VLC_TICK_INVALID)
+    {
+        /* After a seek or a flush, start again on the next period, the
+         * requested date is gone */
+        main_clock->genlock.start = VLC_TICK_INVALID;
+        main_clock->genlock.ref =
+            clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
+    }
+    vlc_clock_main_publish(main_clock, NULL);
     vlc_cond_broadcast(&main_clock->cond);
 }
 
@@ -165,16 +245,100 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
         main_clock->last = clock_point_Create(system_now, ts);
 
         main_clock->rate = rate;
+        vlc_clock_main_publish(main_clock, NULL);
         vlc_cond_broadcast(&main_clock->cond);
     }
 
+    double coeff = main_clock->coeff;
     vlc_mutex_unlock(&main_clock->lock);
 
+    if (main_clock->tracer != NULL && clock->track_str_id)
+        vlc_tracer_TraceCounter(main_clock->tracer, "CLOCK",
+                                clock->track_str_id, "drift_ppm",
+                                (coeff - 1.0) * 1000000);
+
     vlc_clock_on_update(clock, system_now, original_ts, rate, frame_rate,
                         frame_rate_base);
     return VLC_TICK_INVALID;
 }
 
+/* Wall clock, disciplined by NTP or PTP through the system clock */
+static vlc_tick_t vlc_clock_wall_now(void)
+{
+    struct timespec ts;
+
+    if (timespec_get(&ts, TIME_UTC) == 0)
+        return VLC_TICK_INVALID;
+    return vlc_tick_from_timespec(&ts);
+}
+
+static vlc_tick_t vlc_clock_genlock_update(vlc_clock_t *clock,
+                                           vlc_tick_t system_now,
+                                           vlc_tick_t original_ts, double rate,
+                                           unsigned frame_rate,
+                                           unsigned frame_rate_base)
+{
+    vlc_clock_main_t *main_clock = clock->owner;
+
+    if (unlikely(original_ts == VLC_TICK_INVALID
+     || system_now == VLC_TICK_INVALID))
+        return VLC_TICK_INVALID;
+
+    const vlc_tick_t ts = original_ts + clock->delay;
+    vlc_tick_t system = system_now;
+
+    vlc_mutex_lock(&main_clock->lock);
+
+    const vlc_tick_t wall_now = vlc_clock_wall_now();
+    if (system_now != VLC_TICK_MAX && wall_now != VLC_TICK_INVALID)
+    {
+        /* Offset from the monotonic clock to the wall clock, sampled on
+         * every update so that the slaves follow its corrections */
+        const vlc_tick_t wall_offset = wall_now - vlc_tick_now();
+        clock_point_t *ref = &main_clock->genlock.ref;
+
+        if (ref->stream == VLC_TICK_INVALID)
+        {
+            vlc_tick_t start = main_clock->genlock.start;
+            if (start == VLC_TICK_INVALID)
+            {
+                /* All the players starting within the same period present
+                 * their first frame together, at the next boundary after the
+                 * date requested by the input clock */
+                const vlc_tick_t period = main_clock->genlock.period;
+                start = system_now + wall_offset;
+                start = (start + period - 1) / period * period;
+            }
+            *ref = clock_point_Create(start, ts);
+            vlc_info(main_clock->logger, "genlock: %"PRId64" presented at "
+                     "wall date %"PRId64, ts, start);
+        }
+        else if (rate != main_clock->rate)
+        {
+            /* Continue from the current position at the new rate */
+            ref->system = main_stream_to_system(main_clock, ts) + wall_offset;
+            ref->stream = ts;
+        }
+
+        main_clock->coeff = 1.0f;
+        main_clock->rate = rate;
+        main_clock->offset = ref->system - wall_offset
+                           - (vlc_tick_t) (ref->stream / rate);
+        system = main_stream_to_system(main_clock, ts);
+        main_clock->last = clock_point_Create(system, ts);
+        main_clock->wait_sync_ref_priority = UINT_MAX;
+
+        vlc_clock_main_publish(main_clock, NULL);
+        vlc_cond_broadcast(&main_clock->cond);
+    }
+
+    vlc_mutex_unlock(&main_clock->lock);
+
+    vlc_clock_on_update(clock, system, original_ts, rate, frame_rate,
+                        frame_rate_base);
+    return VLC_TICK_INVALID;
+}
+
 static void vlc_clock_master_reset(vlc_clock_t *clock)
 {
     vlc_clock_main_t *main_clock = clock->owner;
@@ -199,6 +363,7 @@ static void vlc_clock_master_reset(vlc_clock_t *clock)
             main_clock->delay = delta;
         }
     }
+    vlc_clock_main_publish(main_clock, clock);
 
     vlc_mutex_unlock(&main_clock->lock);
 
@@ -227,6 +392,7 @@ static vlc_tick_t vlc_clock_master_set_delay(vlc_clock_t *clock, vlc_tick_t dela
     assert(main_clock->delay <= 0);
     assert(clock->delay >= 0);
 
+    vlc_clock_main_publish(main_clock, clock);
     vlc_cond_broadcast(&main_clock->cond);
     vlc_mutex_unlock(&main_clock->lock);
     return delta;
@@ -349,6 +515,7 @@ static vlc_tick_t vlc_clock_slave_set_delay(vlc_clock_t *clock, vlc_tick_t delay
 
     clock->delay = delay;
 
+    vlc_clock_main_publish(main_clock, clock);
     vlc_cond_broadcast(&main_clock->cond);
     vlc_mutex_unlock(&main_clock->lock);
     return 0;
@@ -426,11 +593,22 @@ vlc_clock_main_t *vlc_clock_main_New(struct vlc_logger *parent_logger, struct vl
         clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
 
     main_clock->pause_date = VLC_TICK_INVALID;
+    main_clock->genlock.start = VLC_TICK_INVALID;
+    main_clock->genlock.period = VLC_TICK_FROM_SEC(1);
+    main_clock->genlock.ref =
+        clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
     main_clock->input_dejitter = DEFAULT_PTS_DELAY;
     main_clock->output_dejitter = AOUT_MAX_PTS_ADVANCE * 2;
 
     AvgInit(&main_clock->coeff_avg, 10);
 
+    atomic_init(&main_clock->pub.seq, 0);
+    atomic_init(&main_clock->pub.offset, main_clock->offset);
+    atomic_init(&main_clock->pub.coeff, main_clock->coeff);
+    atomic_init(&main_clock->pub.rate, main_clock->rate);
+    atomic_init(&main_clock->pub.delay, main_clock->delay);
+    atomic_init(&main_clock->pub.paused, false);
+
     return main_clock;
 }
 
@@ -480,7 +658,10 @@ void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
     assert(paused == (main_clock->pause_date == VLC_TICK_INVALID));
 
     if (paused)
+    {
         main_clock->pause_date = now;
+        vlc_clock_main_publish(main_clock, NULL);
+    }
     else
     {
         /**
@@ -497,7 +678,10 @@ void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
             main_clock->first_pcr.system += delay;
         if (main_clock->wait_sync_ref.system != VLC_TICK_INVALID)
             main_clock->wait_sync_ref.system += delay;
+        if (main_clock->genlock.ref.system != VLC_TICK_INVALID)
+            main_clock->genlock.ref.system += delay;
         main_clock->pause_date = VLC_TICK_INVALID;
+        vlc_clock_main_publish(main_clock, NULL);
         vlc_cond_broadcast(&main_clock->cond);
     }
     vlc_mutex_unlock(&main_clock->lock);
@@ -540,6 +724,75 @@ vlc_tick_t vlc_clock_ConvertToSystemLocked(vlc_clock_t *clock,
     return clock->to_system_locked(clock, system_now, ts, rate);
 }
 
+/**
+ * Converts a timestamp from the published parameters, without locking.
+ *
+ * \retval true on success
+ * \retval false if the parameters were being updated, or if the conversion
+ * needs the lock (no master reference point yet)
+ */
+static bool vlc_clock_to_system_published(vlc_clock_t *clock, vlc_tick_t ts,
+                                          double rate, vlc_tick_t *system)
+{
+    vlc_clock_main_t *main_clock = clock->owner;
+
+    unsigned seq = atomic_load_explicit(&main_clock->pub.seq,
+                                        memory_order_acquire);
+    if (seq & 1)
+        return false;
+
+    vlc_tick_t offset = atomic_load_explicit(&main_clock->pub.offset,
+                                             memory_order_relaxed);
+    double coeff = atomic_load_explicit(&main_clock->pub.coeff,
+                                        memory_order_relaxed);
+    double main_rate = atomic_load_explicit(&main_clock->pub.rate,
+                                            memory_order_relaxed);
+    vlc_tick_t main_delay = atomic_load_explicit(&main_clock->pub.delay,
+                                                 memory_order_relaxed);
+    bool paused = atomic_load_explicit(&main_clock->pub.paused,
+                                       memory_order_relaxed);
+    vlc_tick_t delay = atomic_load_explicit(&clock->pub_delay,
+                                            memory_order_relaxed);
+    bool master = atomic_load_explicit(&clock->pub_master,
+                                       memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&main_clock->pub.seq,
+                             memory_order_relaxed) != seq)
+        return false;
+
+    if (!master && paused)
+    {
+        *system = VLC_TICK_MAX;
+        return true;
+    }
+
+    /* The monotonic fallback modifies the reference point */
+    if (offset == VLC_TICK_INVALID)
+        return false;
+
+    /* Same as main_stream_to_system() and the to_system_locked callbacks */
+    vlc_tick_t converted = ((vlc_tick_t) (ts * coeff / main_rate)) + offset;
+    if (master)
+        *system = converted + delay * rate;
+    else
+        *system = converted + (delay - main_delay) * rate;
+    return true;
+}
+
+vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
+                                     vlc_tick_t ts, double rate)
+{
+    vlc_tick_t system;
+    if (vlc_clock_to_system_published(clock, ts, rate, &system))
+        return system;
+
+    vlc_clock_Lock(clock);
+    system = vlc_clock_ConvertToSystemLocked(clock, system_now, ts, rate);
+    vlc_clock_Unlock(clock);
+    return system;
+}
+
 static void vlc_clock_set_master_callbacks(vlc_clock_t *clock)
 {
     clock->update = vlc_clock_master_update;
@@ -572,6 +825,8 @@ static vlc_clock_t *vlc_clock_main_Create(vlc_clock_main_t *main_clock,
     clock->cbs = cbs;
     clock->cbs_data = cbs_data;
     clock->priority = priority;
+    atomic_init(&clock->pub_delay, 0);
+    atomic_init(&clock->pub_master, false);
     assert(!cbs || cbs->on_update);
 
     return clock;
@@ -594,6 +849,7 @@ vlc_clock_t *vlc_clock_main_CreateMaster(vlc_clock_main_t *main_clock,
         vlc_clock_set_master_callbacks(clock);
     else
         vlc_clock_set_slave_callbacks(clock);
+    vlc_clock_main_publish(main_clock, clock);
 
     main_clock->master = clock;
     main_clock->rc++;
@@ -602,7 +858,9 @@ vlc_clock_t *vlc_clock_main_CreateMaster(vlc_clock_main_t *main_clock,
     return clock;
 }
 
-vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
+static vlc_clock_t *vlc_clock_main_CreateInput(vlc_clock_main_t *main_clock,
+                                               bool genlock, vlc_tick_t start,
+                                               vlc_tick_t period)
 {
     /* The master has always the 0 priority */
     vlc_clock_t *clock = vlc_clock_main_Create(main_clock, NULL, 0, NULL, NULL);
@@ -618,9 +876,20 @@ vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
 
     /* Override the master ES clock if it exists */
     if (main_clock->master != NULL)
+    {
         vlc_clock_set_slave_callbacks(main_clock->master);
+        vlc_clock_main_publish(main_clock, main_clock->master);
+    }
 
     vlc_clock_set_master_callbacks(clock);
+    if (genlock)
+    {
+        clock->update = vlc_clock_genlock_update;
+        main_clock->genlock.start = start;
+        if (period > 0)
+            main_clock->genlock.period = period;
+    }
+    vlc_clock_main_publish(main_clock, clock);
     main_clock->input_master = clock;
     main_clock->rc++;
     vlc_mutex_unlock(&main_clock->lock);
@@ -628,6 +897,18 @@ vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
     return clock;
 }
 
+vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
+{
+    return vlc_clock_main_CreateInput(main_clock, false, VLC_TICK_INVALID, 0);
+}
+
+vlc_clock_t *vlc_clock_main_CreateGenlockMaster(vlc_clock_main_t *main_clock,
+                                                vlc_tick_t start,
+                                                vlc_tick_t period)
+{
+    return vlc_clock_main_CreateInput(main_clock, true, start, period);
+}
+
 vlc_clock_t *vlc_clock_main_CreateSlave(vlc_clock_main_t *main_clock,
                                         const char* track_str_id,
                                         enum es_format_category_e cat,
@@ -26,6 +26,7 @@ enum vlc_clock_master_source
     VLC_CLOCK_MASTER_AUDIO,
     VLC_CLOCK_MASTER_INPUT,
     VLC_CLOCK_MASTER_MONOTONIC,
+    VLC_CLOCK_MASTER_GENLOCK,
 };
 
 typedef struct vlc_clock_main_t vlc_clock_main_t;
@@ -113,6 +114,24 @@ vlc_clock_t *vlc_clock_main_CreateMaster(vlc_clock_main_t *main_clock,
  */
 vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock);
 
+/**
+ * This function creates a new genlock master vlc_clock_t interface
+ *
+ * It is updated like an input master, but the stream timestamps are mapped
+ * to the wall clock of the system (UTC, disciplined by NTP or PTP) instead of
+ * the PCR arrival dates, so that all the players using the same wall clock
+ * present the same timestamp at the same time. The mapping follows the
+ * corrections of the wall clock on every update, and the slaves (audio
+ * resampling, video frame dates) converge to it.
+ *
+ * @param start wall clock date of the first frame, or VLC_TICK_INVALID to
+ * start at the next multiple of period
+ * @param period start grid, used if start is invalid or after a seek
+ */
+vlc_clock_t *vlc_clock_main_CreateGenlockMaster(vlc_clock_main_t *main_clock,
+                                                vlc_tick_t start,
+                                                vlc_tick_t period);
+
 /**
  * This function creates a new slave vlc_clock_t interface
  *
@@ -219,15 +238,14 @@ vlc_tick_t vlc_clock_ConvertToSystemLocked(vlc_clock_t *clock,
                                            vlc_tick_t system_now, vlc_tick_t ts,
                                            double rate);
 
-static inline vlc_tick_t
-vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
-                          vlc_tick_t ts, double rate)
-{
-    vlc_clock_Lock(clock);
-    vlc_tick_t system =
-        vlc_clock_ConvertToSystemLocked(clock, system_now, ts, rate);
-    vlc_clock_Unlock(clock);
-    return system;
-}
+/**
+ * Convert a timestamp from media time to system time
+ *
+ * Same as vlc_clock_ConvertToSystemLocked(), without the clock locked. Once
+ * the clock has a reference point, the conversion reads the parameters
+ * published on each update, and the lock is only taken by the updates.
+ */
+vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
+                                     vlc_tick_t ts, double rate);
 
 #endif /*VLC_CLOCK_H*/
@@ -121,6 +121,13 @@ struct input_clock_t
         unsigned i_index;
     } late;
 
+    /* Smallest margin of the updates before their deadline */
+    struct
+    {
+        vlc_tick_t i_min;
+        vlc_tick_t i_start; /* system date of the first observation */
+    } headroom;
+
     /* Reference point */
     clock_point_t ref;
     bool          b_has_reference;
@@ -141,6 +148,12 @@ static vlc_tick_t ClockSystemToStream( input_clock_t *, vlc_tick_t i_system );
 
 static vlc_tick_t ClockGetTsOffset( input_clock_t * );
 
+static void ResetHeadroom( input_clock_t *cl )
+{
+    cl->headroom.i_min = VLC_TICK_MAX;
+    cl->headroom.i_start = VLC_TICK_INVALID;
+}
+
 static void UpdateListener( input_clock_t *cl )
 {
     if( cl->clock_listener )
@@ -177,6 +190,7 @@ input_clock_t *input_clock_New( float rate )
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
         cl->late.pi_value[i] = 0;
+    ResetHeadroom( cl );
 
     cl->rate = rate;
     cl->i_pts_delay = 0;
@@ -293,6 +307,16 @@ vlc_tick_t input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
         cl->late.i_index = ( cl->late.i_index + 1 ) % INPUT_CLOCK_LATE_COUNT;
     }
 
+    /* The arrival of the updates is only meaningful for live sources */
+    if( !b_can_pace_control && !b_reset_reference )
+    {
+        const vlc_tick_t i_headroom = i_system_expected + cl->i_pts_delay - i_ck_system;
+        if( cl->headroom.i_start == VLC_TICK_INVALID )
+            cl->headroom.i_start = i_ck_system;
+        if( i_headroom < cl->headroom.i_min )
+            cl->headroom.i_min = i_headroom;
+    }
+
     UpdateListener( cl );
 
     return i_late;
@@ -306,6 +330,7 @@ void input_clock_Reset( input_clock_t *cl )
     cl->b_has_reference = false;
     cl->ref = clock_point_Create( VLC_TICK_INVALID, VLC_TICK_INVALID );
     cl->b_has_external_clock = false;
+    ResetHeadroom( cl );
 
     if( cl->clock_listener )
         vlc_clock_Reset( cl->clock_listener );
@@ -421,11 +446,9 @@ void input_clock_GetSystemOrigin( input_clock_t *cl, vlc_tick_t *pi_system, vlc_
         *pi_delay  = cl->i_pts_delay;
 }
 
-#warning "input_clock_SetJitter needs more work"
-void input_clock_SetJitter( input_clock_t *cl,
-                            vlc_tick_t i_pts_delay, int i_cr_average )
+/* Rebase the late observations on a new pts delay */
+static void ShiftLate( input_clock_t *cl, vlc_tick_t i_pts_delay )
 {
-    /* Update late observations */
     const vlc_tick_t i_delay_delta = i_pts_delay - cl->i_pts_delay;
     vlc_tick_t pi_late[INPUT_CLOCK_LATE_COUNT];
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
@@ -442,12 +465,23 @@ void input_clock_SetJitter( input_clock_t *cl,
         cl->late.pi_value[cl->late.i_index] = pi_late[i];
         cl->late.i_index = ( cl->late.i_index + 1 ) % INPUT_CLOCK_LATE_COUNT;
     }
+}
+
+#warning "input_clock_SetJitter needs more work"
+void input_clock_SetJitter( input_clock_t *cl,
+                            vlc_tick_t i_pts_delay, int i_cr_average )
+{
+    /* Update late observations */
+    ShiftLate( cl, i_pts_delay );
 
     /* TODO always save the value, and when rebuffering use the new one if smaller
      * TODO when increasing -> force rebuffering
      */
     if( cl->i_pts_delay < i_pts_delay )
+    {
         cl->i_pts_delay = i_pts_delay;
+        ResetHeadroom( cl );
+    }
 
     /* */
     if( i_cr_average < 10 )
@@ -457,6 +491,27 @@ void input_clock_SetJitter( input_clock_t *cl,
         AvgRescale( &cl->drift, i_cr_average );
 }
 
+void input_clock_LowerJitter( input_clock_t *cl, vlc_tick_t i_pts_delay )
+{
+    if( i_pts_delay >= cl->i_pts_delay )
+        return;
+
+    ShiftLate( cl, i_pts_delay );
+    cl->i_pts_delay = i_pts_delay;
+    ResetHeadroom( cl );
+}
+
+vlc_tick_t input_clock_GetHeadroom( input_clock_t *cl, vlc_tick_t i_period )
+{
+    if( cl->headroom.i_start == VLC_TICK_INVALID ||
+        cl->last.system - cl->headroom.i_start < i_period )
+        return VLC_TICK_INVALID;
+
+    const vlc_tick_t i_headroom = cl->headroom.i_min;
+    ResetHeadroom( cl );
+    return i_headroom;
+}
+
 vlc_tick_t input_clock_GetJitter( input_clock_t *cl )
 {
 #if INPUT_CLOCK_LATE_COUNT != 3
@@ -131,4 +131,21 @@ void input_clock_SetJitter( input_clock_t *,
  */
 vlc_tick_t input_clock_GetJitter( input_clock_t * );
 
+/**
+ * This function lowers the pts_delay, that input_clock_SetJitter() only raises.
+ *
+ * The outputs have to catch up the difference, so it should only be lowered
+ * by small steps.
+ */
+void input_clock_LowerJitter( input_clock_t *, vlc_tick_t i_pts_delay );
+
+/**
+ * This function returns the smallest margin before their deadline of the clock
+ * updates of a live source, observed over at least the given period, and
+ * starts a new observation.
+ *
+ * \return the margin, or VLC_TICK_INVALID if the period is not elapsed yet
+ */
+vlc_tick_t input_clock_GetHeadroom( input_clock_t *, vlc_tick_t i_period );
+
 #endif
@@ -455,7 +455,11 @@ module_config_t *config_FindConfig(const char *name)
 
     module_config_t *const *p;
     p = bsearch (name, config.list, config.count, sizeof (*p), confnamecmp);
-    return p ? *p : NULL;
+    if (p == NULL)
+        return NULL;
+
+    vlc_plugin_LoadConfig ((*p)->owner);
+    return *p;
 }
 
 /**
@@ -487,6 +491,11 @@ void config_ResetAll(void)
     vlc_rwlock_wrlock (&config_lock);
     for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
+#ifdef HAVE_DYNAMIC_PLUGINS
+        /* Items which were never used are still at their default values */
+        if (!atomic_load_explicit(&p->conf.loaded, memory_order_acquire))
+            continue;
+#endif
         for (size_t i = 0; i < p->conf.size; i++ )
         {
             module_config_t *p_config = p->conf.items + i;
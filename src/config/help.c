@@ -608,6 +608,8 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
             continue;
         found = true;
 
+        vlc_plugin_LoadConfig((vlc_plugin_t *)p);
+
         if (psz_search == NULL && !plugin_show(p))
             continue;
 
@@ -322,7 +322,14 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
         s->pf_control = AStreamControl;
         s->p_sys = access;
 
-        s = stream_FilterChainNew(s, "prefetch,cache");
+        /* The blocks of local accesses (such as memory mapped files) are
+         * handed out as they are: a cache would only copy them and seeking
+         * back is cheap anyway. */
+        bool fast_seek;
+        if (access->pf_block == NULL
+         || vlc_stream_Control(access, STREAM_CAN_FASTSEEK, &fast_seek)
+         || !fast_seek)
+            s = stream_FilterChainNew(s, "prefetch,cache");
     }
     else
         s = access;
@@ -0,0 +1,199 @@
+/*****************************************************************************
+ * caching.c : per server profiles of the adaptive caching
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/**
+ *  \file
+ *  This file stores the caching learned by the adaptive caching of live
+ *  inputs, one line per server, the most recently played first.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+#include "input_internal.h"
+
+#define CACHING_PROFILES_FILE "caching-profiles"
+#define CACHING_PROFILES_MAX  256
+
+static vlc_mutex_t profiles_lock = VLC_STATIC_MUTEX;
+
+static char *GetHost( const char *psz_uri )
+{
+    vlc_url_t url;
+    char *psz_host = NULL;
+
+    if( psz_uri == NULL )
+        return NULL;
+    if( vlc_UrlParse( &url, psz_uri ) == 0
+     && !EMPTY_STR(url.psz_host) && strpbrk( url.psz_host, " \t\n" ) == NULL )
+        psz_host = strdup( url.psz_host );
+    vlc_UrlClean( &url );
+    return psz_host;
+}
+
+static char *GetPath( bool b_create )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_path;
+
+    if( b_create && psz_cachedir != NULL )
+        vlc_mkdir( psz_cachedir, 0700 );
+    if( psz_cachedir == NULL
+     || asprintf( &psz_path, "%s" DIR_SEP CACHING_PROFILES_FILE,
+                  psz_cachedir ) == -1 )
+        psz_path = NULL;
+    free( psz_cachedir );
+    return psz_path;
+}
+
+/* Parses a "host milliseconds" line, modifying it in place */
+static const char *ParseLine( char *psz_line, vlc_tick_t *pi_caching )
+{
+    char *psz_sep = strchr( psz_line, ' ' );
+    if( psz_sep == NULL || psz_sep == psz_line )
+        return NULL;
+    *psz_sep = '\0';
+
+    char *psz_end;
+    long long i_ms = strtoll( psz_sep + 1, &psz_end, 10 );
+    if( psz_end == psz_sep + 1 || i_ms <= 0 )
+        return NULL;
+
+    *pi_caching = VLC_TICK_FROM_MS( i_ms );
+    return psz_line;
+}
+
+vlc_tick_t input_caching_LoadProfile( vlc_object_t *obj, const char *psz_uri )
+{
+    vlc_tick_t i_caching = VLC_TICK_INVALID;
+    char *psz_host = GetHost( psz_uri );
+    char *psz_path = psz_host != NULL ? GetPath( false ) : NULL;
+
+    if( psz_path == NULL )
+        goto end;
+
+    vlc_mutex_lock( &profiles_lock );
+    FILE *file = vlc_fopen( psz_path, "rt" );
+    if( file != NULL )
+    {
+        char *psz_line = NULL;
+        size_t i_size = 0;
+        ssize_t i_len;
+
+        while( (i_len = getline( &psz_line, &i_size, file )) != -1 )
+        {
+            if( i_len > 0 && psz_line[i_len - 1] == '\n' )
+                psz_line[i_len - 1] = '\0';
+
+            vlc_tick_t i_value;
+            const char *psz_entry = ParseLine( psz_line, &i_value );
+            if( psz_entry != NULL && !strcmp( psz_entry, psz_host ) )
+            {
+                i_caching = i_value;
+                break;
+            }
+        }
+        free( psz_line );
+        fclose( file );
+    }
+    vlc_mutex_unlock( &profiles_lock );
+
+    if( i_caching != VLC_TICK_INVALID )
+        msg_Dbg( obj, "caching profile of %s: %"PRId64" ms", psz_host,
+                 MS_FROM_VLC_TICK(i_caching) );
+end:
+    free( psz_path );
+    free( psz_host );
+    return i_caching;
+}
+
+void input_caching_StoreProfile( vlc_object_t *obj, const char *psz_uri,
+                                 vlc_tick_t i_caching )
+{
+    char *psz_host = GetHost( psz_uri );
+    char *psz_path = psz_host != NULL ? GetPath( true ) : NULL;
+    char *psz_tmp;
+
+    if( psz_path == NULL || i_caching <= 0
+     || asprintf( &psz_tmp, "%s.tmp", psz_path ) == -1 )
+        goto end;
+
+    vlc_mutex_lock( &profiles_lock );
+    FILE *out = vlc_fopen( psz_tmp, "wt" );
+    if( out == NULL )
+    {
+        vlc_mutex_unlock( &profiles_lock );
+        msg_Warn( obj, "cannot write caching profiles %s: %s", psz_tmp,
+                  vlc_strerror_c(errno) );
+        free( psz_tmp );
+        goto end;
+    }
+
+    fprintf( out, "%s %"PRId64"\n", psz_host, MS_FROM_VLC_TICK(i_caching) );
+
+    FILE *in = vlc_fopen( psz_path, "rt" );
+    if( in != NULL )
+    {
+        char *psz_line = NULL;
+        size_t i_size = 0;
+        ssize_t i_len;
+        unsigned i_count = 1;
+
+        while( i_count < CACHING_PROFILES_MAX
+            && (i_len = getline( &psz_line, &i_size, in )) != -1 )
+        {
+            if( i_len > 0 && psz_line[i_len - 1] == '\n' )
+                psz_line[i_len - 1] = '\0';
+
+            vlc_tick_t i_value;
+            const char *psz_entry = ParseLine( psz_line, &i_value );
+            if( psz_entry == NULL || !strcmp( psz_entry, psz_host ) )
+                continue;
+            fprintf( out, "%s %"PRId64"\n", psz_entry,
+                     MS_FROM_VLC_TICK(i_value) );
+            i_count++;
+        }
+        free( psz_line );
+        fclose( in );
+    }
+
+    if( fclose( out ) != 0 || vlc_rename( psz_tmp, psz_path ) != 0 )
+    {
+        msg_Warn( obj, "cannot write caching profiles %s", psz_path );
+        vlc_unlink( psz_tmp );
+    }
+    vlc_mutex_unlock( &profiles_lock );
+    free( psz_tmp );
+end:
+    free( psz_path );
+    free( psz_host );
+}
@@ -44,13 +44,16 @@
 #include <vlc_decoder.h>
 #include <vlc_picture_pool.h>
 #include <vlc_tracer.h>
+#include <vlc_metrics.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
 #include "../clock/clock.h"
 #include "decoder.h"
+#include "input_internal.h"
 #include "resource.h"
 #include "libvlc.h"
+#include "../misc/thread_policy.h"
 
 #include "../video_output/vout_internal.h"
 
@@ -71,6 +74,12 @@ struct vlc_input_decoder_t
     vlc_clock_t     *p_clock;
     const char *psz_id;
 
+    struct
+    {
+        struct vlc_histogram *decode; /**< decoding time per block */
+        struct vlc_histogram *fifo; /**< fifo depth when queuing a block */
+    } metrics;
+
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
 
@@ -81,6 +90,16 @@ struct vlc_input_decoder_t
     sout_packetizer_input_t *p_sout_input;
 
     vlc_thread_t     thread;
+    bool             thread_started;
+    /* Whether the decoder feeds a hardware decoder, cf. the hwdec thread
+     * policy */
+    bool             hw_feeder;
+
+    /* CPU accounting, only accessed by the decoder thread */
+    input_cpu_clock_t cpu_clock;
+    vlc_tick_t       cpu_accounted; /**< date of the last accounting */
+    int              cpu_degradation;
+    bool             cpu_wait_keyframe;
 
     /* Some decoders require already packetized data (ie. not truncated) */
     decoder_t *p_packetizer;
@@ -90,6 +109,9 @@ struct vlc_input_decoder_t
     es_format_t    fmt;
     vlc_video_context *vctx;
 
+    /* Input format, to match a future input while idle, cf. DecoderPark() */
+    es_format_t    fmt_src;
+
     /* */
     bool           b_fmt_description;
     vlc_meta_t     *p_description;
@@ -592,6 +614,19 @@ static int CreateVoutIfNeeded(vlc_input_decoder_t *p_owner)
     return 1; // new vout was created
 }
 
+static void DecoderSetHwFeeder( vlc_input_decoder_t *p_owner,
+                                vlc_decoder_device *dec_device )
+{
+    if( dec_device == NULL || p_owner->hw_feeder )
+        return;
+
+    p_owner->hw_feeder = true;
+    /* The device is requested while opening the decoder, before its thread
+     * is started, or later from the decoder thread itself. */
+    if( p_owner->thread_started )
+        vlc_thread_policy_ApplySelf( VLC_THREAD_ROLE_HWDEC );
+}
+
 static vlc_decoder_device * ModuleThread_GetDecoderDevice( decoder_t *p_dec )
 {
     vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
@@ -606,6 +641,7 @@ static vlc_decoder_device * ModuleThread_GetDecoderDevice( decoder_t *p_dec )
 
     assert(p_owner->p_vout);
     vlc_decoder_device *dec_device = vout_GetDevice(p_owner->p_vout);
+    DecoderSetHwFeeder(p_owner, dec_device);
     if (created_vout == 1)
         return dec_device; // new vout was created with a decoder device
 
@@ -785,6 +821,19 @@ static float ModuleThread_GetDisplayRate( decoder_t *p_dec )
     return rate;
 }
 
+static int ModuleThread_GetDisplayLoad( decoder_t *p_dec,
+                                        struct vlc_display_load *load )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    /* The vout is only changed by the decoder thread */
+    if( p_owner->p_vout == NULL || !p_owner->vout_started )
+        return VLC_EGENERIC;
+
+    vout_GetLoad( p_owner->p_vout, &load->queued, &load->render );
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
@@ -1102,13 +1151,16 @@ static void ModuleThread_UpdateStatVideo( vlc_input_decoder_t *p_owner,
     unsigned displayed = 0;
     unsigned vout_lost = 0;
     unsigned vout_late = 0;
+    unsigned missed_vsyncs = 0;
     if( p_owner->p_vout != NULL )
     {
-        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late );
+        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost,
+                                &vout_late, &missed_vsyncs );
     }
     if (lost) vout_lost++;
 
-    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late);
+    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed,
+                   vout_late, missed_vsyncs);
 }
 
 static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
@@ -1322,18 +1374,89 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
 }
 
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p_block );
+/* Accounts the CPU time of the decoder thread to the input, at most every
+ * 100 ms */
+static void DecoderThread_AccountCPU( vlc_input_decoder_t *p_owner, bool force )
+{
+    if( p_owner->cbs == NULL || p_owner->cbs->account_cpu == NULL )
+        return;
+
+    vlc_tick_t now = vlc_tick_now();
+    if( !force && now - p_owner->cpu_accounted < VLC_TICK_FROM_MS(100) )
+        return;
+
+    p_owner->cpu_accounted = now;
+    p_owner->cpu_degradation =
+        p_owner->cbs->account_cpu( p_owner,
+                                   input_cpu_Elapsed( &p_owner->cpu_clock ),
+                                   p_owner->cbs_userdata );
+}
+
+/* Whether a video block is skipped to stay within the CPU budget */
+static bool DecoderThread_SkipOverBudget( vlc_input_decoder_t *p_owner,
+                                          const block_t *p_block )
+{
+    if( p_owner->dec.fmt_in.i_cat != VIDEO_ES || p_owner->p_sout != NULL )
+        return false;
+
+    if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+    {
+        p_owner->cpu_wait_keyframe = false;
+        return false;
+    }
+
+    switch( p_owner->cpu_degradation )
+    {
+        case INPUT_CPU_KEYFRAMES_ONLY:
+            if( p_block->i_flags & (BLOCK_FLAG_TYPE_P | BLOCK_FLAG_TYPE_B
+                                  | BLOCK_FLAG_TYPE_PB) )
+            {   /* the next frames would refer to the skipped one */
+                p_owner->cpu_wait_keyframe = true;
+                return true;
+            }
+            break;
+        case INPUT_CPU_SKIP_B_FRAMES:
+            if( p_block->i_flags & BLOCK_FLAG_TYPE_B )
+                return true;
+            break;
+    }
+    return p_owner->cpu_wait_keyframe;
+}
+
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_block )
 {
     decoder_t *p_dec = &p_owner->dec;
     struct vlc_tracer *tracer = vlc_object_get_tracer( &p_dec->obj );
 
+    if( p_block != NULL && DecoderThread_SkipOverBudget( p_owner, p_block ) )
+    {
+        block_Release( p_block );
+        decoder_Notify(p_owner, on_new_video_stats, 0, 1, 0, 0, 0);
+        return;
+    }
+
     if ( tracer != NULL && p_block != NULL )
     {
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             p_block->i_pts, p_block->i_dts );
     }
 
+    /* the block is consumed by the decoder */
+    bool traced = tracer != NULL && p_block != NULL;
+    vlc_tick_t pts = p_block != NULL ? p_block->i_pts : VLC_TICK_INVALID;
+    if ( traced )
+        vlc_tracer_TraceSpanBegin( tracer, "DECODE", p_owner->psz_id, pts );
+
+    vlc_tick_t start = p_owner->metrics.decode != NULL ? vlc_tick_now()
+                                                       : VLC_TICK_INVALID;
+
     int ret = p_dec->pf_decode( p_dec, p_block );
+
+    if ( traced )
+        vlc_tracer_TraceSpanEnd( tracer, "DECODE", p_owner->psz_id, pts );
+    if( start != VLC_TICK_INVALID )
+        vlc_histogram_Observe( p_owner->metrics.decode,
+                               vlc_tick_now() - start );
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -1627,6 +1750,11 @@ static void *DecoderThread( void *p_data )
     vlc_tick_t delay = 0;
     bool paused = false;
 
+    p_owner->thread_started = true;
+    if( p_owner->hw_feeder )
+        vlc_thread_policy_ApplySelf( VLC_THREAD_ROLE_HWDEC );
+    input_cpu_Start( &p_owner->cpu_clock );
+
     /* The decoder's main loop */
     vlc_fifo_Lock( p_owner->p_fifo );
 
@@ -1725,6 +1853,7 @@ static void *DecoderThread( void *p_data )
         vlc_fifo_Unlock( p_owner->p_fifo );
 
         DecoderThread_ProcessInput( p_owner, p_block );
+        DecoderThread_AccountCPU( p_owner, false );
 
         if( p_block == NULL && p_owner->dec.fmt_out.i_cat == AUDIO_ES )
         {   /* Draining: the decoder is drained and all decoded buffers are
@@ -1746,6 +1875,7 @@ static void *DecoderThread( void *p_data )
     }
 
     vlc_fifo_Unlock( p_owner->p_fifo );
+    DecoderThread_AccountCPU( p_owner, true );
     return NULL;
 }
 
@@ -1759,6 +1889,7 @@ static const struct decoder_owner_callbacks dec_video_cbs =
         .queue_cc = ModuleThread_QueueCc,
         .get_display_date = ModuleThread_GetDisplayDate,
         .get_display_rate = ModuleThread_GetDisplayRate,
+        .get_display_load = ModuleThread_GetDisplayLoad,
     },
     .get_attachments = InputThread_GetInputAttachments,
 };
@@ -1789,30 +1920,14 @@ static const struct decoder_owner_callbacks dec_spu_cbs =
 };
 
 /**
- * Create a decoder object
- *
- * \param p_input the input thread
- * \param p_es the es descriptor
- * \param b_packetizer instead of a decoder
- * \return the decoder object
+ * Resets the state of the decoder owner for a new input
  */
-static vlc_input_decoder_t *
-CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
-               const char *psz_id, vlc_clock_t *p_clock,
-               input_resource_t *p_resource, sout_stream_t *p_sout,
-               bool b_thumbnailing, const struct vlc_input_decoder_callbacks *cbs,
-               void *cbs_userdata )
+static void DecoderInitOwner( vlc_input_decoder_t *p_owner, const char *psz_id,
+                              vlc_clock_t *p_clock, input_resource_t *p_resource,
+                              sout_stream_t *p_sout,
+                              const struct vlc_input_decoder_callbacks *cbs,
+                              void *cbs_userdata )
 {
-    decoder_t *p_dec;
-    vlc_input_decoder_t *p_owner;
-    static_assert(offsetof(vlc_input_decoder_t, dec) == 0,
-                  "the decoder must be first in the owner structure");
-
-    p_owner = vlc_custom_create( p_parent, sizeof( *p_owner ), "decoder" );
-    if( p_owner == NULL )
-        return NULL;
-    p_dec = &p_owner->dec;
-
     p_owner->psz_id = psz_id;
     p_owner->p_clock = p_clock;
     p_owner->i_preroll_end = PREROLL_NONE;
@@ -1826,10 +1941,9 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->i_spu_order = 0;
     p_owner->p_sout = p_sout;
     p_owner->p_sout_input = NULL;
-    p_owner->p_packetizer = NULL;
+    p_owner->out_pool = NULL;
 
     p_owner->b_fmt_description = false;
-    p_owner->p_description = NULL;
 
     p_owner->reset_out_state = false;
     p_owner->delay = 0;
@@ -1849,20 +1963,81 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->drained = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
     p_owner->b_idle = false;
+    p_owner->aborting = false;
 
     p_owner->mouse_event = NULL;
     p_owner->mouse_opaque = NULL;
 
+    p_owner->cc.b_supported = ( p_sout == NULL );
+
+    p_owner->cc.desc.i_608_channels = 0;
+    p_owner->cc.desc.i_708_channels = 0;
+    for( unsigned i = 0; i < MAX_CC_DECODERS; i++ )
+        p_owner->cc.pp_decoder[i] = NULL;
+    p_owner->cc.p_sout_input = NULL;
+    p_owner->cc.b_sout_created = false;
+}
+
+/**
+ * Create a decoder object
+ *
+ * \param p_input the input thread
+ * \param p_es the es descriptor
+ * \param b_packetizer instead of a decoder
+ * \return the decoder object
+ */
+static vlc_input_decoder_t *
+CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
+               const char *psz_id, vlc_clock_t *p_clock,
+               input_resource_t *p_resource, sout_stream_t *p_sout,
+               bool b_thumbnailing, const struct vlc_input_decoder_callbacks *cbs,
+               void *cbs_userdata )
+{
+    decoder_t *p_dec;
+    vlc_input_decoder_t *p_owner;
+    static_assert(offsetof(vlc_input_decoder_t, dec) == 0,
+                  "the decoder must be first in the owner structure");
+
+    p_owner = vlc_custom_create( p_parent, sizeof( *p_owner ), "decoder" );
+    if( p_owner == NULL )
+        return NULL;
+    p_dec = &p_owner->dec;
+
+    DecoderInitOwner( p_owner, psz_id, p_clock, p_resource, p_sout,
+                      cbs, cbs_userdata );
+    p_owner->p_packetizer = NULL;
+    p_owner->p_description = NULL;
+
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
+    es_format_Init( &p_owner->fmt_src, UNKNOWN_ES, 0 );
+    if( p_sout == NULL && !b_thumbnailing && p_resource != NULL
+     && ( fmt->i_cat == VIDEO_ES || fmt->i_cat == AUDIO_ES )
+     && var_InheritInteger( p_parent, "decoder-cache" ) > 0 )
+        es_format_Copy( &p_owner->fmt_src, fmt );
 
     /* decoder fifo */
-    p_owner->p_fifo = block_FifoNew();
+    p_owner->p_fifo = block_FifoNewSPSC();
     if( unlikely(p_owner->p_fifo == NULL) )
     {
         vlc_object_delete(p_dec);
         return NULL;
     }
 
+    const char *labels;
+    switch( fmt->i_cat )
+    {
+        case VIDEO_ES: labels = "type=\"video\""; break;
+        case AUDIO_ES: labels = "type=\"audio\""; break;
+        case SPU_ES:   labels = "type=\"spu\""; break;
+        default:       labels = "type=\"other\""; break;
+    }
+    p_owner->metrics.decode = vlc_histogram_Get( p_dec,
+        "vlc_decoder_decode_seconds", labels,
+        "Time spent decoding a block", VLC_METRIC_SECONDS );
+    p_owner->metrics.fifo = vlc_histogram_Get( p_dec,
+        "vlc_decoder_fifo_bytes", labels,
+        "Size of the decoder fifo when a block is queued", VLC_METRIC_BYTES );
+
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
     vlc_cond_init( &p_owner->wait_request );
@@ -1932,51 +2107,31 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
         }
     }
 
-    /* */
-    p_owner->cc.b_supported = ( p_sout == NULL );
-
-    p_owner->cc.desc.i_608_channels = 0;
-    p_owner->cc.desc.i_708_channels = 0;
-    for( unsigned i = 0; i < MAX_CC_DECODERS; i++ )
-        p_owner->cc.pp_decoder[i] = NULL;
-    p_owner->cc.p_sout_input = NULL;
-    p_owner->cc.b_sout_created = false;
     return p_owner;
 }
 
 /**
- * Destroys a decoder object
+ * Releases the outputs of a decoder object
  *
- * \param p_dec the decoder object
- * \return nothing
+ * The decoder thread and the module threads must be stopped.
  */
-static void DeleteDecoder( vlc_input_decoder_t *p_owner )
+static void DecoderStopOutputs( vlc_input_decoder_t *p_owner,
+                                enum es_format_category_e i_cat )
 {
-    decoder_t *p_dec = &p_owner->dec;
-    msg_Dbg( p_dec, "killing decoder fourcc `%4.4s'",
-             (char*)&p_dec->fmt_in.i_codec );
-
-    const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
-    decoder_Clean( p_dec );
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
         p_owner->out_pool = NULL;
     }
 
-    if (p_owner->vctx)
-        vlc_video_context_Release( p_owner->vctx );
-
-    /* Free all packets still in the decoder fifo. */
-    block_FifoRelease( p_owner->p_fifo );
-
-    /* Cleanup */
 #ifdef ENABLE_SOUT
     if( p_owner->p_sout_input )
     {
         sout_InputDelete( p_owner->p_sout, p_owner->p_sout_input );
         if( p_owner->cc.p_sout_input )
             sout_InputDelete( p_owner->p_sout, p_owner->cc.p_sout_input );
+        p_owner->p_sout_input = NULL;
+        p_owner->cc.p_sout_input = NULL;
     }
 #endif
 
@@ -1988,6 +2143,7 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
                 /* TODO: REVISIT gap-less audio */
                 aout_DecDelete( p_owner->p_aout );
                 input_resource_PutAout( p_owner->p_resource, p_owner->p_aout );
+                p_owner->p_aout = NULL;
             }
             break;
         case VIDEO_ES: {
@@ -2005,6 +2161,8 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
                     decoder_Notify(p_owner, on_vout_stopped, vout);
 
                 vout_Release(vout);
+                p_owner->p_vout = NULL;
+                p_owner->vout_started = false;
             }
             break;
         }
@@ -2018,6 +2176,7 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
                 vout_UnregisterSubpictureChannel( p_owner->p_vout,
                                                   p_owner->i_spu_channel );
                 vout_Release(p_owner->p_vout);
+                p_owner->p_vout = NULL;
             }
             break;
         }
@@ -2027,8 +2186,34 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
         default:
             vlc_assert_unreachable();
     }
+}
+
+/**
+ * Destroys a decoder object
+ *
+ * \param p_dec the decoder object
+ * \return nothing
+ */
+static void DeleteDecoder( vlc_input_decoder_t *p_owner )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    msg_Dbg( p_dec, "killing decoder fourcc `%4.4s'",
+             (char*)&p_dec->fmt_in.i_codec );
+
+    const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
+    decoder_Clean( p_dec );
+
+    if (p_owner->vctx)
+        vlc_video_context_Release( p_owner->vctx );
+
+    /* Free all packets still in the decoder fifo. */
+    block_FifoRelease( p_owner->p_fifo );
+
+    /* Cleanup */
+    DecoderStopOutputs( p_owner, i_cat );
 
     es_format_Clean( &p_owner->fmt );
+    es_format_Clean( &p_owner->fmt_src );
 
     if( p_owner->p_description )
         vlc_meta_Delete( p_owner->p_description );
@@ -2037,6 +2222,148 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
     decoder_Destroy( &p_owner->dec );
 }
 
+/**
+ * Keeps a decoder object loaded for a future input, cf. "decoder-cache"
+ *
+ * The decoder thread must be stopped.
+ *
+ * \return true if the decoder was handed to the input resource
+ */
+static bool DecoderPark( vlc_input_decoder_t *p_owner )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    const enum es_format_category_e i_cat = p_dec->fmt_in.i_cat;
+
+    if( p_owner->fmt_src.i_cat == UNKNOWN_ES || p_owner->error
+     || atomic_load( &p_owner->reload ) != RELOAD_NO_REQUEST )
+        return false;
+
+    int64_t max = var_InheritInteger( p_dec, "decoder-cache" );
+    if( max <= 0 )
+        return false;
+
+    msg_Dbg( p_dec, "keeping idle decoder fourcc `%4.4s'",
+             (char*)&p_dec->fmt_in.i_codec );
+
+    if( p_owner->p_packetizer != NULL && p_owner->p_packetizer->pf_flush != NULL )
+        p_owner->p_packetizer->pf_flush( p_owner->p_packetizer );
+    if( p_dec->pf_flush != NULL )
+        p_dec->pf_flush( p_dec );
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
+    /* The video context is kept to configure the next vout, cf.
+     * DecoderAdopt() */
+    DecoderStopOutputs( p_owner, i_cat );
+
+    es_format_Clean( &p_owner->fmt );
+    es_format_Init( &p_owner->fmt, i_cat, 0 );
+    if( p_owner->p_description )
+    {
+        vlc_meta_Delete( p_owner->p_description );
+        p_owner->p_description = NULL;
+    }
+
+    /* The input, its clock and its ES won't outlive the decoder */
+    vlc_object_t *libvlc = VLC_OBJECT(vlc_object_instance(p_dec));
+    vlc_object_reparent( VLC_OBJECT(p_dec), libvlc );
+    if( p_owner->p_packetizer != NULL )
+        vlc_object_reparent( VLC_OBJECT(p_owner->p_packetizer), libvlc );
+
+    input_resource_t *p_resource = p_owner->p_resource;
+    DecoderInitOwner( p_owner, NULL, NULL, NULL, NULL, NULL, NULL );
+
+    vlc_input_decoder_t *evicted =
+        input_resource_PutDecoder( p_resource, p_owner, max );
+    if( evicted != NULL )
+        vlc_input_decoder_DeleteIdle( evicted );
+    return true;
+}
+
+static bool DecoderIsSimilar( vlc_input_decoder_t *p_owner, const void *opaque )
+{
+    const es_format_t *fmt = opaque;
+    const es_format_t *src = &p_owner->fmt_src;
+
+    return es_format_IsSimilar( src, fmt )
+        && src->i_codec == fmt->i_codec
+        && src->i_original_fourcc == fmt->i_original_fourcc
+        && src->i_profile == fmt->i_profile
+        && src->i_level == fmt->i_level
+        && src->b_packetized == fmt->b_packetized
+        && src->i_extra == fmt->i_extra
+        && ( fmt->i_extra == 0
+          || memcmp( src->p_extra, fmt->p_extra, fmt->i_extra ) == 0 );
+}
+
+/**
+ * Takes an idle decoder object matching the format from the input resource
+ *
+ * The outputs are configured with the last format of the decoder module.
+ */
+static vlc_input_decoder_t *
+DecoderAdopt( vlc_object_t *p_parent, const es_format_t *fmt,
+              const char *psz_id, vlc_clock_t *p_clock,
+              input_resource_t *p_resource,
+              const struct vlc_input_decoder_callbacks *cbs,
+              void *cbs_userdata )
+{
+    if( fmt->i_cat != VIDEO_ES && fmt->i_cat != AUDIO_ES )
+        return NULL;
+
+    vlc_input_decoder_t *p_owner =
+        input_resource_GetDecoder( p_resource, DecoderIsSimilar, fmt );
+    if( p_owner == NULL )
+        return NULL;
+
+    decoder_t *p_dec = &p_owner->dec;
+    vlc_object_reparent( VLC_OBJECT(p_dec), p_parent );
+    if( p_owner->p_packetizer != NULL )
+        vlc_object_reparent( VLC_OBJECT(p_owner->p_packetizer), p_parent );
+    DecoderInitOwner( p_owner, psz_id, p_clock, p_resource, NULL,
+                      cbs, cbs_userdata );
+
+    msg_Dbg( p_dec, "reusing idle decoder fourcc `%4.4s'",
+             (char*)&p_dec->fmt_in.i_codec );
+
+    int ret = 0;
+    if( fmt->i_cat == VIDEO_ES && p_dec->fmt_out.i_codec != 0 )
+    {
+        vlc_video_context *vctx = p_owner->vctx;
+        p_owner->vctx = NULL;
+
+        ret = CreateVoutIfNeeded( p_owner );
+        if( ret >= 0 && vctx != NULL )
+        {
+            /* The hardware surfaces must belong to the device of the vout */
+            vlc_decoder_device *vctx_dev = vlc_video_context_HoldDevice( vctx );
+            vlc_decoder_device *vout_dev = vout_GetDevice( p_owner->p_vout );
+            if( vctx_dev != vout_dev )
+                ret = -1;
+            if( vctx_dev != NULL )
+                vlc_decoder_device_Release( vctx_dev );
+            if( vout_dev != NULL )
+                vlc_decoder_device_Release( vout_dev );
+        }
+        if( ret >= 0 )
+            ret = ModuleThread_UpdateVideoFormat( p_dec, vctx );
+        if( vctx != NULL )
+            vlc_video_context_Release( vctx );
+    }
+    else if( fmt->i_cat == AUDIO_ES && p_dec->fmt_out.i_codec != 0 )
+        ret = ModuleThread_UpdateAudioFormat( p_dec );
+
+    if( ret < 0 )
+    {
+        msg_Dbg( p_dec, "idle decoder outputs mismatch" );
+        vlc_input_decoder_DeleteIdle( p_owner );
+        return NULL;
+    }
+    return p_owner;
+}
+
 /* */
 static void DecoderUnsupportedCodec( decoder_t *p_dec, const es_format_t *fmt, bool b_decoding )
 {
@@ -2065,10 +2392,15 @@ decoder_New( vlc_object_t *p_parent, const es_format_t *fmt, const char *psz_id,
     const char *psz_type = p_sout ? N_("packetizer") : N_("decoder");
     int i_priority;
 
+    vlc_input_decoder_t *p_owner = NULL;
+    if( p_sout == NULL && !thumbnailing && p_resource != NULL )
+        p_owner = DecoderAdopt( p_parent, fmt, psz_id, p_clock, p_resource,
+                                cbs, userdata );
+
     /* Create the decoder configuration structure */
-    vlc_input_decoder_t *p_owner =
-        CreateDecoder( p_parent, fmt, psz_id, p_clock, p_resource, p_sout,
-                       thumbnailing, cbs, userdata );
+    if( p_owner == NULL )
+        p_owner = CreateDecoder( p_parent, fmt, psz_id, p_clock, p_resource,
+                                 p_sout, thumbnailing, cbs, userdata );
     if( p_owner == NULL )
     {
         msg_Err( p_parent, "could not create %s", psz_type );
@@ -2216,6 +2548,12 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     }
 
     /* Delete decoder */
+    if( !DecoderPark( p_owner ) )
+        DeleteDecoder( p_owner );
+}
+
+void vlc_input_decoder_DeleteIdle( vlc_input_decoder_t *p_owner )
+{
     DeleteDecoder( p_owner );
 }
 
@@ -2229,12 +2567,25 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
 void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
                                bool b_do_pace )
 {
-    vlc_fifo_Lock( p_owner->p_fifo );
+    struct vlc_tracer *tracer = vlc_object_get_tracer( &p_owner->dec.obj );
+    if ( tracer != NULL )
+        vlc_tracer_TraceCounter( tracer, "DEC", p_owner->psz_id, "fifo_bytes",
+                                 vlc_fifo_GetBytes( p_owner->p_fifo ) );
+    vlc_histogram_Observe( p_owner->metrics.fifo,
+                           vlc_fifo_GetBytes( p_owner->p_fifo ) );
+
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
         /* 400 MiB, i.e. ~ 50mb/s for 60s */
+        if( vlc_fifo_GetBytes( p_owner->p_fifo ) <= 400*1024*1024 )
+        {   /* Common case: hand the block over without locking */
+            vlc_fifo_Push( p_owner->p_fifo, p_block );
+            return;
+        }
+
+        vlc_fifo_Lock( p_owner->p_fifo );
         if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
         {
             msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
@@ -2244,12 +2595,15 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
         }
     }
     else
-    if( !p_owner->b_waiting )
-    {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
-         * Locking is not necessary as b_waiting is only read, not written by
-         * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
-            vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
+    {
+        vlc_fifo_Lock( p_owner->p_fifo );
+        if( !p_owner->b_waiting )
+        {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
+             * Locking is not necessary as b_waiting is only read, not written by
+             * the decoder thread. */
+            while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+                vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
+        }
     }
 
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
@@ -40,7 +40,7 @@ struct vlc_input_decoder_callbacks {
 
     void (*on_new_video_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned displayed, unsigned late,
-                               void *userdata);
+                               unsigned missed_vsyncs, void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
 
@@ -48,6 +48,10 @@ struct vlc_input_decoder_callbacks {
     int (*get_attachments)(vlc_input_decoder_t *decoder,
                            input_attachment_t ***ppp_attachment,
                            void *userdata);
+    /* Accounts the CPU time used by the decoder thread, and returns the
+     * degradation level to apply (enum input_cpu_degradation) */
+    int (*account_cpu)(vlc_input_decoder_t *decoder, vlc_tick_t cpu_time,
+                       void *userdata);
 };
 
 vlc_input_decoder_t *
@@ -56,6 +60,14 @@ vlc_input_decoder_New( vlc_object_t *parent, es_format_t *, const char *psz_id,
                        const struct vlc_input_decoder_callbacks *cbs,
                        void *userdata ) VLC_USED;
 
+/**
+ * This function deletes a decoder kept idle by the input resource.
+ *
+ * Decoders are kept idle instead of being deleted by vlc_input_decoder_Delete()
+ * when the "decoder-cache" option is set, see input_resource_PutDecoder().
+ */
+void vlc_input_decoder_DeleteIdle( vlc_input_decoder_t * );
+
 /**
  * This function changes the pause state.
  * The date parameter MUST hold the exact date at which the change has been
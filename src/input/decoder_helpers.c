@@ -32,6 +32,8 @@
 #include <vlc_meta.h>
 #include <vlc_modules.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
+#include <vlc_list.h>
 #include "libvlc.h"
 
 void decoder_Init( decoder_t *p_dec, const es_format_t *restrict p_fmt )
@@ -163,8 +165,86 @@ struct vlc_decoder_device_priv
 {
     struct vlc_decoder_device device;
     vlc_atomic_rc_t rc;
+    int adapter;
 };
 
+/* Active sessions per decoder device type and adapter */
+#define DECODER_DEVICE_TYPES    (VLC_DECODER_DEVICE_DRM_PRIME + 1)
+#define DECODER_DEVICE_ADAPTERS 16
+
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned sessions[DECODER_DEVICE_TYPES][DECODER_DEVICE_ADAPTERS];
+    unsigned next[DECODER_DEVICE_TYPES];
+} adapters = { VLC_STATIC_MUTEX, { { 0 } }, { 0 } };
+
+unsigned
+vlc_decoder_device_SelectAdapter(vlc_decoder_device *device, unsigned count)
+{
+    struct vlc_decoder_device_priv *priv =
+            container_of(device, struct vlc_decoder_device_priv, device);
+    const enum vlc_decoder_device_type type = device->type;
+
+    assert(priv->adapter == -1);
+    assert((unsigned)type < DECODER_DEVICE_TYPES);
+    if (count > DECODER_DEVICE_ADAPTERS)
+        count = DECODER_DEVICE_ADAPTERS;
+    if (count <= 1)
+        return 0;
+
+    char *policy = var_InheritString(device, "dec-dev-adapter");
+    unsigned idx = 0;
+
+    vlc_mutex_lock(&adapters.lock);
+    if (policy == NULL)
+        ;
+    else if (!strcmp(policy, "round-robin"))
+        idx = adapters.next[type] % count;
+    else if (!strcmp(policy, "least-loaded"))
+    {
+        /* Start from the next adapter, so that ties are spread too */
+        unsigned first = adapters.next[type] % count;
+        idx = first;
+        for (unsigned i = 1; i < count; i++)
+        {
+            unsigned cur = (first + i) % count;
+            if (adapters.sessions[type][cur] < adapters.sessions[type][idx])
+                idx = cur;
+        }
+    }
+    else
+    {
+        char *end;
+        unsigned long pin = strtoul(policy, &end, 10);
+        if (end == policy || *end != '\0' || pin >= count)
+            msg_Warn(device, "invalid decoder adapter \"%s\" (%u available)",
+                     policy, count);
+        else
+            idx = pin;
+    }
+    adapters.next[type] = idx + 1;
+    adapters.sessions[type][idx]++;
+    vlc_mutex_unlock(&adapters.lock);
+
+    msg_Dbg(device, "using adapter %u of %u", idx, count);
+    free(policy);
+    priv->adapter = idx;
+    return idx;
+}
+
+static void decoder_device_ReleaseAdapter(struct vlc_decoder_device_priv *priv)
+{
+    if (priv->adapter == -1)
+        return;
+
+    vlc_mutex_lock(&adapters.lock);
+    assert(adapters.sessions[priv->device.type][priv->adapter] > 0);
+    adapters.sessions[priv->device.type][priv->adapter]--;
+    vlc_mutex_unlock(&adapters.lock);
+    priv->adapter = -1;
+}
+
 static int decoder_device_Open(void *func, bool forced, va_list ap)
 {
     VLC_UNUSED(forced);
@@ -173,7 +253,11 @@ static int decoder_device_Open(void *func, bool forced, va_list ap)
     vout_window_t *window = va_arg(ap, vout_window_t *);
     int ret = open(device, window);
     if (ret != VLC_SUCCESS)
+    {
+        decoder_device_ReleaseAdapter(
+            container_of(device, struct vlc_decoder_device_priv, device));
         vlc_objres_clear(&device->obj);
+    }
     return ret;
 }
 
@@ -184,6 +268,7 @@ vlc_decoder_device_Create(vlc_object_t *o, vout_window_t *window)
             vlc_object_create(o, sizeof (*priv));
     if (!priv)
         return NULL;
+    priv->adapter = -1;
     char *name = var_InheritString(o, "dec-dev");
     module_t *module = vlc_module_load(&priv->device, "decoder device", name,
                                     true, decoder_device_Open, &priv->device,
@@ -218,6 +303,7 @@ vlc_decoder_device_Release(vlc_decoder_device *device)
     {
         if (device->ops->close != NULL)
             device->ops->close(device);
+        decoder_device_ReleaseAdapter(priv);
         vlc_objres_clear(VLC_OBJECT(device));
         vlc_object_delete(device);
     }
@@ -292,6 +378,103 @@ vlc_decoder_device* vlc_video_context_HoldDevice(vlc_video_context *vctx)
 }
 
 
+/** threads budget **/
+struct vlc_decoder_threads
+{
+    struct vlc_list node;
+    unsigned weight;
+    unsigned max;
+    unsigned count;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlc_list decoders;
+    unsigned total;
+} threads_budget = {
+    VLC_STATIC_MUTEX, VLC_LIST_INITIALIZER(&threads_budget.decoders), 0,
+};
+
+/* Called with the lock held */
+static void vlc_decoder_threads_Balance(void)
+{
+    unsigned weights = 0;
+    vlc_decoder_threads *threads;
+
+    vlc_list_foreach(threads, &threads_budget.decoders, node)
+        weights += threads->weight;
+
+    /* Every decoder gets its share of the budget, and at least one thread */
+    vlc_list_foreach(threads, &threads_budget.decoders, node)
+    {
+        unsigned count = threads_budget.total * threads->weight / weights;
+        count = __MAX(count, 1);
+        if (threads->max > 0)
+            count = __MIN(count, threads->max);
+        threads->count = count;
+    }
+}
+
+static vlc_decoder_threads *
+vlc_threads_Acquire(vlc_object_t *obj, const video_format_t *fmt,
+                    unsigned scale, unsigned max)
+{
+    vlc_decoder_threads *threads = malloc(sizeof (*threads));
+    if (unlikely(threads == NULL))
+        return NULL;
+
+    /* Weigh the decoder by its 720p surfaces, assuming 1080p if unknown */
+    uint64_t pixels = (uint64_t)fmt->i_width * fmt->i_height;
+    if (pixels == 0)
+        pixels = 1920 * 1080;
+    threads->weight = scale
+        * VLC_CLIP((pixels + 1280 * 720 - 1) / (1280 * 720), 1, 16);
+    threads->max = max;
+
+    int64_t total = var_InheritInteger(obj, "dec-threads");
+    if (total <= 0)
+        total = vlc_GetCPUCount();
+
+    vlc_mutex_lock(&threads_budget.lock);
+    threads_budget.total = __MAX(total, 1);
+    vlc_list_append(&threads->node, &threads_budget.decoders);
+    vlc_decoder_threads_Balance();
+    vlc_mutex_unlock(&threads_budget.lock);
+
+    msg_Dbg(obj, "using %u of %u decoder threads", threads->count,
+            threads_budget.total);
+    return threads;
+}
+
+vlc_decoder_threads *vlc_decoder_threads_Acquire(decoder_t *dec, unsigned max)
+{
+    return vlc_threads_Acquire(VLC_OBJECT(dec), &dec->fmt_in.video, 1, max);
+}
+
+vlc_decoder_threads *vlc_encoder_threads_Acquire(encoder_t *enc, unsigned max)
+{
+    /* Encoding a picture costs more than decoding it */
+    return vlc_threads_Acquire(VLC_OBJECT(enc), &enc->fmt_in.video, 2, max);
+}
+
+unsigned vlc_decoder_threads_Count(vlc_decoder_threads *threads)
+{
+    vlc_mutex_lock(&threads_budget.lock);
+    unsigned count = threads->count;
+    vlc_mutex_unlock(&threads_budget.lock);
+    return count;
+}
+
+void vlc_decoder_threads_Release(vlc_decoder_threads *threads)
+{
+    vlc_mutex_lock(&threads_budget.lock);
+    vlc_list_remove(&threads->node);
+    vlc_decoder_threads_Balance();
+    vlc_mutex_unlock(&threads_budget.lock);
+    free(threads);
+}
+
 /** encoder **/
 vlc_decoder_device *vlc_encoder_GetDecoderDevice( encoder_t *enc )
 {
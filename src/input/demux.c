@@ -35,6 +35,7 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "modules/modules.h"
 
 typedef const struct
 {
@@ -189,8 +190,14 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(p_demux, "demux", module, strict,
-                                   demux_Probe, p_demux);
+    /* Skip the demuxers which already rejected the same content */
+    uint64_t signature = strict ? 0 : stream_ContentSignature(s);
+    if (signature != 0 && b_preparsing)
+        signature = ~signature; /* some demuxers reject preparsing */
+
+    priv->module = vlc_module_load_content(vlc_object_logger(p_demux),
+                                           "demux", module, strict,
+                                           signature, demux_Probe, p_demux);
     free(modbuf);
 
     if (priv->module == NULL)
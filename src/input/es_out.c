@@ -209,6 +209,11 @@ typedef struct
     vlc_tick_t  i_pts_jitter;
     int         i_cr_average;
     float       rate;
+    float       rate_adjust; /* requested by the demuxer */
+
+    /* Adaptive caching of live inputs */
+    bool        b_adaptive_caching;
+    bool        b_caching_learned; /* the main clock was updated live */
 
     /* */
     bool        b_paused;
@@ -225,6 +230,8 @@ typedef struct
 
     /* Record */
     sout_stream_t *p_sout_record;
+    int         i_record_preroll; /* in seconds, 0 if disabled */
+    bool        b_record_armed; /* p_sout_record is buffering the pre-roll */
 
     /* Used only to limit debugging output */
     int         i_prev_stream_level;
@@ -243,6 +250,7 @@ static void         EsOutSelectList( es_out_t *, enum es_format_category_e cat,
                                      vlc_es_id_t *const* es_id_list );
 static void         EsOutUpdateInfo( es_out_t *, es_out_id_t *es, const vlc_meta_t * );
 static int          EsOutSetRecord(  es_out_t *, bool b_record );
+static int          EsOutSetRecordChain( es_out_t *, bool b_record, int i_preroll );
 
 static bool EsIsSelected( es_out_id_t *es );
 static void EsOutSelectEs( es_out_t *out, es_out_id_t *es, bool b_force );
@@ -288,6 +296,7 @@ clock_source_Inherit(vlc_object_t *obj)
         { "1", VLC_CLOCK_MASTER_MONOTONIC }, /* legacy option */
         { "audio", VLC_CLOCK_MASTER_AUDIO },
         { "auto", VLC_CLOCK_MASTER_AUTO },
+        { "genlock", VLC_CLOCK_MASTER_GENLOCK },
         { "input", VLC_CLOCK_MASTER_INPUT },
         { "monotonic", VLC_CLOCK_MASTER_MONOTONIC },
     };
@@ -309,6 +318,12 @@ default_val:
     return VLC_CLOCK_MASTER_AUTO;
 }
 
+/* The rate given to the clocks and decoders */
+static inline float EsOutGetRate( const es_out_sys_t *p_sys )
+{
+    return p_sys->rate * p_sys->rate_adjust;
+}
+
 static inline int EsOutGetClosedCaptionsChannel( const es_format_t *p_fmt )
 {
     int i_channel;
@@ -392,7 +407,8 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
 
 static void
 decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsigned lost,
-                           unsigned displayed, unsigned late, void *userdata)
+                           unsigned displayed, unsigned late,
+                           unsigned missed_vsyncs, void *userdata)
 {
     (void) decoder;
 
@@ -415,6 +431,8 @@ decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
     atomic_fetch_add_explicit(&stats->late_pictures, late,
                               memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->missed_vsyncs, missed_vsyncs,
+                              memory_order_relaxed);
 }
 
 static void
@@ -459,6 +477,28 @@ decoder_get_attachments(vlc_input_decoder_t *decoder,
     return input_GetAttachments(p_sys->p_input, ppp_attachment);
 }
 
+static int
+decoder_account_cpu(vlc_input_decoder_t *decoder, vlc_tick_t cpu_time,
+                    void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return INPUT_CPU_NORMAL;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if (!stats)
+        return INPUT_CPU_NORMAL;
+
+    input_rate_Add(&stats->cpu_time, cpu_time);
+    return atomic_load_explicit(&stats->cpu_degradation,
+                                memory_order_relaxed);
+}
+
 static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_vout_started = decoder_on_vout_started,
     .on_vout_stopped = decoder_on_vout_stopped,
@@ -466,6 +506,7 @@ static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
     .get_attachments = decoder_get_attachments,
+    .account_cpu = decoder_account_cpu,
 };
 
 /*****************************************************************************
@@ -561,13 +602,20 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
 
     p_sys->cc_decoder = var_InheritInteger( p_input, "captions" );
 
+    p_sys->i_record_preroll = var_InheritInteger( p_input, "input-record-preroll" );
+    p_sys->b_record_armed = false;
+
     p_sys->i_group_id = var_GetInteger( p_input, "program" );
 
     p_sys->user_clock_source = clock_source_Inherit( VLC_OBJECT(p_input) );
 
     p_sys->i_pause_date = -1;
 
+    p_sys->b_adaptive_caching = var_InheritBool( p_input, "adaptive-caching" );
+    p_sys->b_caching_learned = false;
+
     p_sys->rate = rate;
+    p_sys->rate_adjust = 1.f;
 
     p_sys->b_buffering = true;
     p_sys->i_preroll_end = -1;
@@ -672,7 +720,13 @@ static void EsOutTerminate( es_out_t *out )
     es_out_id_t *es;
 
     if( p_sys->p_sout_record )
-        EsOutSetRecord( out, false );
+        EsOutSetRecordChain( out, false, 0 );
+
+    if( p_sys->b_caching_learned &&
+        var_InheritBool( p_sys->p_input, "adaptive-caching-profiles" ) )
+        input_caching_StoreProfile( VLC_OBJECT(p_sys->p_input),
+                                    input_priv(p_sys->p_input)->p_item->psz_uri,
+                                    p_sys->i_pts_delay + p_sys->i_pts_jitter );
 
     foreach_es_then_es_slaves(es)
     {
@@ -787,7 +841,47 @@ static void EsOutSetDelay( es_out_t *out, int i_cat, vlc_tick_t i_delay )
                            p_sys->i_pts_jitter, p_sys->i_cr_average);
 }
 
+static void EsOutRecordArm( es_out_t *out )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    assert( p_sys->i_record_preroll > 0 && !p_sys->p_sout_record );
+
+    if( EsOutSetRecordChain( out, true, p_sys->i_record_preroll ) == VLC_SUCCESS )
+        p_sys->b_record_armed = true;
+}
+
 static int EsOutSetRecord(  es_out_t *out, bool b_record )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if( p_sys->i_record_preroll <= 0 )
+        return EsOutSetRecordChain( out, b_record, 0 );
+
+    /* With a pre-roll, the record chain buffers while not recording and
+     * starting the recording only triggers it */
+    if( b_record )
+    {
+        if( !p_sys->p_sout_record )
+            return EsOutSetRecordChain( out, true, 0 );
+
+        assert( p_sys->b_record_armed );
+#ifdef ENABLE_SOUT
+        if( sout_StreamControl( p_sys->p_sout_record, SOUT_STREAM_RECORD_START ) )
+            return VLC_EGENERIC;
+#endif
+        p_sys->b_record_armed = false;
+    }
+    else
+    {
+        if( p_sys->p_sout_record )
+            EsOutSetRecordChain( out, false, 0 );
+        EsOutRecordArm( out );
+    }
+    return VLC_SUCCESS;
+}
+
+static int EsOutSetRecordChain( es_out_t *out, bool b_record, int i_preroll )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     input_thread_t *p_input = p_sys->p_input;
@@ -820,7 +914,8 @@ static int EsOutSetRecord(  es_out_t *out, bool b_record )
                 char* psz_file_esc = config_StringEscape( psz_file );
                 if ( psz_file_esc )
                 {
-                    if( asprintf( &psz_sout, "#record{dst-prefix='%s'}", psz_file_esc ) < 0 )
+                    if( asprintf( &psz_sout, "#record{dst-prefix='%s',preroll=%d}",
+                                  psz_file_esc, i_preroll ) < 0 )
                         psz_sout = NULL;
                     free( psz_file_esc );
                 }
@@ -870,6 +965,7 @@ static int EsOutSetRecord(  es_out_t *out, bool b_record )
         sout_StreamChainDelete( p_sys->p_sout_record, NULL );
 #endif
         p_sys->p_sout_record = NULL;
+        p_sys->b_record_armed = false;
     }
 
     return VLC_SUCCESS;
@@ -925,7 +1021,7 @@ static void EsOutChangeRate( es_out_t *out, float rate )
 
     foreach_es_then_es_slaves(es)
         if( es->p_dec != NULL )
-            vlc_input_decoder_ChangeRate( es->p_dec, rate );
+            vlc_input_decoder_ChangeRate( es->p_dec, EsOutGetRate( p_sys ) );
 }
 
 static void EsOutChangePosition( es_out_t *out, bool b_flush )
@@ -1153,7 +1249,7 @@ static void EsOutProgramsChangeRate( es_out_t *out )
     es_out_pgrm_t *pgrm;
 
     vlc_list_foreach(pgrm, &p_sys->programs, node)
-        input_clock_ChangeRate(pgrm->p_input_clock, p_sys->rate);
+        input_clock_ChangeRate(pgrm->p_input_clock, EsOutGetRate( p_sys ));
 }
 
 static void EsOutFrameNext( es_out_t *out )
@@ -1261,7 +1357,7 @@ static vlc_tick_t EsOutGetBuffering( es_out_t *out )
             i_system_duration = vlc_tick_now() - i_system_start;
         }
 
-        const vlc_tick_t i_consumed = i_system_duration * p_sys->rate - i_stream_duration;
+        const vlc_tick_t i_consumed = i_system_duration * EsOutGetRate( p_sys ) - i_stream_duration;
         i_delay = p_sys->i_pts_delay + p_sys->i_pts_jitter
                 + p_sys->i_tracks_pts_delay - i_consumed;
     }
@@ -1339,6 +1435,21 @@ static void EsOutProgramHandleClockSource( es_out_t *out, es_out_pgrm_t *p_pgrm
             p_pgrm->active_clock_source = VLC_CLOCK_MASTER_INPUT;
             break;
         }
+        case VLC_CLOCK_MASTER_GENLOCK:
+        {
+            /* The wall clock date is given in milliseconds since the epoch */
+            int64_t start = var_InheritInteger( p_input, "clock-genlock-start" );
+            int64_t period = var_InheritInteger( p_input, "clock-genlock-period" );
+            vlc_clock_t *p_master_clock =
+                vlc_clock_main_CreateGenlockMaster( p_pgrm->p_main_clock,
+                    start > 0 ? VLC_TICK_FROM_MS( start ) : VLC_TICK_INVALID,
+                    VLC_TICK_FROM_MS( period ) );
+
+            if( p_master_clock != NULL )
+                input_clock_AttachListener( p_pgrm->p_input_clock, p_master_clock );
+            p_pgrm->active_clock_source = VLC_CLOCK_MASTER_GENLOCK;
+            break;
+        }
         default:
             p_pgrm->active_clock_source = p_sys->user_clock_source;
             break;
@@ -1350,6 +1461,7 @@ static void EsOutProgramHandleClockSource( es_out_t *out, es_out_pgrm_t *p_pgrm
         case VLC_CLOCK_MASTER_AUDIO:    clock_source_str = "audio"; break;
         case VLC_CLOCK_MASTER_INPUT:    clock_source_str = "input"; break;
         case VLC_CLOCK_MASTER_MONOTONIC:clock_source_str = "monotonic"; break;
+        case VLC_CLOCK_MASTER_GENLOCK:  clock_source_str = "genlock"; break;
 
         case VLC_CLOCK_MASTER_AUTO:
         default:
@@ -1508,7 +1620,7 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, in
         return NULL;
     }
 
-    p_pgrm->p_input_clock = input_clock_New( p_sys->rate );
+    p_pgrm->p_input_clock = input_clock_New( EsOutGetRate( p_sys ) );
     if( !p_pgrm->p_input_clock )
     {
         vlc_clock_main_Delete( p_pgrm->p_main_clock );
@@ -2303,6 +2415,7 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
             break;
         case VLC_CLOCK_MASTER_MONOTONIC:
         case VLC_CLOCK_MASTER_INPUT:
+        case VLC_CLOCK_MASTER_GENLOCK:
             clock_source_cat = UNKNOWN_ES;
             break;
         default:
@@ -2341,11 +2454,16 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
                                  priv->b_thumbnailing, &decoder_cbs, p_es );
     if( dec != NULL )
     {
-        vlc_input_decoder_ChangeRate( dec, p_sys->rate );
+        vlc_input_decoder_ChangeRate( dec, EsOutGetRate( p_sys ) );
 
         if( p_sys->b_buffering )
             vlc_input_decoder_StartWait( dec );
 
+        /* Arm the pre-roll with the first ES */
+        if( !p_es->p_master && !p_sys->p_sout_record &&
+            p_sys->i_record_preroll > 0 )
+            EsOutRecordArm( out );
+
         if( !p_es->p_master && p_sys->p_sout_record )
         {
             p_es->p_dec_record =
@@ -3114,6 +3232,49 @@ static void EsOutDel( es_out_t *out, es_out_id_t *es )
     vlc_mutex_unlock( &p_sys->lock );
 }
 
+/* Adaptive caching: the pts delay of live inputs grows when the clock updates
+ * are late (see ES_OUT_SET_PCR), and is lowered by small steps while they
+ * keep arriving with some margin before their deadline */
+#define ADAPTIVE_CACHING_PERIOD VLC_TICK_FROM_SEC(30)
+#define ADAPTIVE_CACHING_STEP   VLC_TICK_FROM_MS(50)
+#define ADAPTIVE_CACHING_MIN    VLC_TICK_FROM_MS(100)
+
+static void EsOutAdaptCaching( es_out_t *out, es_out_pgrm_t *p_pgrm )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    p_sys->b_caching_learned = true;
+
+    const vlc_tick_t i_headroom =
+        input_clock_GetHeadroom( p_pgrm->p_input_clock, ADAPTIVE_CACHING_PERIOD );
+    if( i_headroom == VLC_TICK_INVALID )
+        return;
+
+    /* Keep half of the margin as a safety for the arrival variance */
+    const vlc_tick_t i_caching = p_sys->i_pts_delay + p_sys->i_pts_jitter;
+    vlc_tick_t i_step = __MIN( i_headroom / 2, ADAPTIVE_CACHING_STEP );
+    i_step = __MIN( i_step, i_caching - ADAPTIVE_CACHING_MIN );
+    if( i_step <= 0 )
+        return;
+
+    /* Give back the jitter compensation first */
+    const vlc_tick_t i_jitter_step = __MIN( i_step, p_sys->i_pts_jitter );
+    p_sys->i_pts_jitter -= i_jitter_step;
+    p_sys->i_pts_delay -= i_step - i_jitter_step;
+
+    msg_Dbg( p_sys->p_input, "clock updates %"PRId64" ms early, "
+             "pts_delay decreased to %"PRId64" ms",
+             MS_FROM_VLC_TICK(i_headroom), MS_FROM_VLC_TICK(i_caching - i_step) );
+
+    const vlc_tick_t i_pts_delay = i_caching - i_step + p_sys->i_tracks_pts_delay;
+    es_out_pgrm_t *pgrm;
+    vlc_list_foreach(pgrm, &p_sys->programs, node)
+    {
+        input_clock_LowerJitter( pgrm->p_input_clock, i_pts_delay );
+        vlc_clock_main_SetInputDejitter( pgrm->p_main_clock, i_pts_delay );
+    }
+}
+
 static int EsOutVaControlLocked( es_out_t *, input_source_t *, int, va_list );
 static int EsOutControlLocked( es_out_t *out, input_source_t *source, int i_query, ... )
 {
@@ -3438,6 +3599,10 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
                                         p_sys->i_pts_delay, i_new_jitter,
                                         p_sys->i_cr_average );
             }
+            else if( i_late == 0 && p_sys->b_adaptive_caching &&
+                     !input_CanPaceControl( p_sys->p_input ) &&
+                     ( !priv->p_sout || !priv->b_out_pace_control ) )
+                EsOutAdaptCaching( out, p_pgrm );
         }
         return VLC_SUCCESS;
     }
@@ -3603,6 +3768,23 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_SET_RATE_ADJUST:
+    {
+        const float adjust = va_arg( args, double );
+
+        /* Only meant for small corrections, and not while streaming out */
+        if( !( adjust >= .5f && adjust <= 2.f ) ||
+            input_priv(p_sys->p_input)->p_sout != NULL )
+            return VLC_EGENERIC;
+
+        if( adjust != p_sys->rate_adjust )
+        {
+            p_sys->rate_adjust = adjust;
+            EsOutChangeRate( out, p_sys->rate );
+        }
+        return VLC_SUCCESS;
+    }
+
     case ES_OUT_POST_SUBNODE:
     {
         input_thread_t *input = p_sys->p_input;
@@ -3970,6 +4152,9 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         }
         return ret;
     }
+    case ES_OUT_PRIV_SET_TIMESHIFT_TIME:
+        /* Only the timeshift es_out can seek */
+        return VLC_EGENERIC;
     default: vlc_assert_unreachable();
     }
 
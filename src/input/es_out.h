@@ -96,7 +96,10 @@ enum es_out_query_private_e
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_PRIV_SET_VBI_TRANSPARENCY                /* arg1=bool res=can fail */
+    ES_OUT_PRIV_SET_VBI_TRANSPARENCY,               /* arg1=bool res=can fail */
+
+    /* Seek inside the timeshift buffer */
+    ES_OUT_PRIV_SET_TIMESHIFT_TIME,                 /* arg1=vlc_tick_t i_time arg2=bool b_absolute res=can fail */
 };
 
 static inline int es_out_vaPrivControl( es_out_t *out, int query, va_list args )
@@ -241,9 +244,16 @@ static inline int es_out_SetVbiTransparency( es_out_t *p_out, vlc_es_id_t *id,
     return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_VBI_TRANSPARENCY, id,
                                enabled );
 }
+static inline int es_out_SetTimeshiftTime( es_out_t *p_out, vlc_tick_t i_time,
+                                           bool b_absolute )
+{
+    return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_TIMESHIFT_TIME, i_time,
+                               b_absolute );
+}
 
 es_out_t  *input_EsOutNew( input_thread_t *, input_source_t *main_source, float rate );
 es_out_t  *input_EsOutTimeshiftNew( input_thread_t *, es_out_t *, float i_rate );
+es_out_t  *input_EsOutReadAheadNew( input_thread_t *, es_out_t *, vlc_tick_t );
 es_out_t  *input_EsOutSourceNew(es_out_t *master_out, input_source_t *in);
 
 es_out_id_t *vlc_es_id_get_out(vlc_es_id_t *id);
@@ -0,0 +1,611 @@
+/*****************************************************************************
+ * es_out_readahead.c: Es Out read-ahead handler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_list.h>
+#include <vlc_interrupt.h>
+
+#include "input_internal.h"
+#include "es_out.h"
+
+/*
+ * The read-ahead es_out lets the input thread demux ahead of the playback,
+ * in a queue bounded in stream time. A feeder thread drains the queue into
+ * the next es_out, honouring the wake-up dates the input thread would have
+ * waited for. A blocking read in the access then no longer starves the
+ * decoders while queued data remains.
+ *
+ * Only the blocks, the PCRs and the ES deletions are queued, in order. The
+ * other controls wait for the queue to drain before being forwarded, so that
+ * they apply after the data sent before them; only the state queries are
+ * forwarded directly. Resetting the PCR drops the queued data, as the
+ * decoders would flush it anyway.
+ */
+
+/* Hard limit, in multiples of the read-ahead duration, for demuxers that
+ * keep sending without checking the wake-up date */
+#define RA_HARD_LIMIT_FACTOR 2
+#define RA_MAX_COUNT 100000
+
+enum ra_cmd_type
+{
+    RA_SEND,
+    RA_PCR,
+    RA_DEL,
+};
+
+typedef struct
+{
+    struct vlc_list node;
+    enum ra_cmd_type type;
+    input_source_t *in;
+    es_out_id_t *es;
+    block_t *block;
+    int i_group; /* -1 for ES_OUT_SET_PCR */
+    vlc_tick_t i_pcr;
+} ra_cmd_t;
+
+typedef struct
+{
+    input_thread_t *p_input;
+    es_out_t       *p_out;
+    vlc_tick_t     i_duration;
+
+    vlc_mutex_t    lock;
+    vlc_cond_t     wait_feed;  /* signaled to the feeder */
+    vlc_cond_t     wait_space; /* signaled by the feeder */
+    vlc_thread_t   thread;
+    bool           b_thread;
+    bool           b_exit;
+    bool           b_paused;
+    bool           b_busy;     /* the feeder is executing a command */
+    vlc_tick_t     i_deadline; /* wake-up date of the next PCR */
+
+    struct vlc_list queue;
+    size_t         i_count;
+    vlc_tick_t     i_pcr_head; /* last PCR handed to the next es_out */
+    vlc_tick_t     i_pcr_tail; /* last queued PCR */
+
+    es_out_t       out;
+} es_out_sys_t;
+
+static inline int es_out_in_Control( es_out_t *p_out, input_source_t *in,
+                                     int i_query, ... )
+{
+    va_list args;
+    int     i_result;
+
+    va_start( args, i_query );
+    i_result = p_out->cbs->control( p_out, in, i_query, args );
+    va_end( args );
+    return i_result;
+}
+
+static void CmdExecute( es_out_sys_t *p_sys, ra_cmd_t *p_cmd )
+{
+    switch( p_cmd->type )
+    {
+        case RA_SEND:
+            es_out_Send( p_sys->p_out, p_cmd->es, p_cmd->block );
+            break;
+        case RA_PCR:
+            if( p_cmd->i_group < 0 )
+                es_out_in_Control( p_sys->p_out, p_cmd->in, ES_OUT_SET_PCR,
+                                   p_cmd->i_pcr );
+            else
+                es_out_in_Control( p_sys->p_out, p_cmd->in,
+                                   ES_OUT_SET_GROUP_PCR, p_cmd->i_group,
+                                   p_cmd->i_pcr );
+            break;
+        case RA_DEL:
+            es_out_Del( p_sys->p_out, p_cmd->es );
+            break;
+    }
+    free( p_cmd );
+}
+
+static void CmdDrop( ra_cmd_t *p_cmd )
+{
+    if( p_cmd->type == RA_SEND )
+        block_Release( p_cmd->block );
+    free( p_cmd );
+}
+
+static ra_cmd_t *PopLocked( es_out_sys_t *p_sys )
+{
+    ra_cmd_t *p_cmd = vlc_list_first_entry_or_null( &p_sys->queue, ra_cmd_t,
+                                                     node );
+    if( p_cmd == NULL )
+        return NULL;
+
+    vlc_list_remove( &p_cmd->node );
+    p_sys->i_count--;
+    if( p_cmd->type == RA_PCR )
+        p_sys->i_pcr_head = p_cmd->i_pcr;
+    return p_cmd;
+}
+
+static vlc_tick_t QueuedLocked( es_out_sys_t *p_sys )
+{
+    if( p_sys->i_pcr_head == VLC_TICK_INVALID ||
+        p_sys->i_pcr_tail == VLC_TICK_INVALID ||
+        p_sys->i_pcr_tail < p_sys->i_pcr_head )
+        return 0;
+    return p_sys->i_pcr_tail - p_sys->i_pcr_head;
+}
+
+static bool IsFullLocked( es_out_sys_t *p_sys, unsigned factor )
+{
+    return p_sys->i_count >= RA_MAX_COUNT / RA_HARD_LIMIT_FACTOR * factor ||
+           QueuedLocked( p_sys ) >= p_sys->i_duration * factor;
+}
+
+static void *FeederThread( void *data )
+{
+    es_out_sys_t *p_sys = data;
+
+    vlc_mutex_lock( &p_sys->lock );
+    while( !p_sys->b_exit )
+    {
+        if( p_sys->i_count == 0 )
+        {
+            vlc_cond_wait( &p_sys->wait_feed, &p_sys->lock );
+            continue;
+        }
+
+        if( p_sys->b_paused )
+        {
+            /* Feed the decoders while they are buffering only: paced
+             * decoders do not consume their FIFO while paused */
+            vlc_mutex_unlock( &p_sys->lock );
+            bool b_buffering = es_out_GetBuffering( p_sys->p_out );
+            vlc_mutex_lock( &p_sys->lock );
+            if( !b_buffering && p_sys->b_paused )
+            {
+                vlc_cond_wait( &p_sys->wait_feed, &p_sys->lock );
+                continue;
+            }
+        }
+        else if( p_sys->i_deadline != VLC_TICK_INVALID )
+        {
+            if( vlc_cond_timedwait( &p_sys->wait_feed, &p_sys->lock,
+                                    p_sys->i_deadline ) == 0 )
+                continue; /* state changed, check again */
+            p_sys->i_deadline = VLC_TICK_INVALID;
+            continue;
+        }
+
+        ra_cmd_t *p_cmd = PopLocked( p_sys );
+        const bool b_pcr = p_cmd->type == RA_PCR;
+        p_sys->b_busy = true;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        CmdExecute( p_sys, p_cmd );
+
+        vlc_tick_t i_wakeup = b_pcr ? es_out_GetWakeup( p_sys->p_out ) : 0;
+
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->b_busy = false;
+        if( b_pcr )
+            p_sys->i_deadline = i_wakeup > 0 ? i_wakeup : VLC_TICK_INVALID;
+        vlc_cond_broadcast( &p_sys->wait_space );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    return NULL;
+}
+
+static void FlushLocked( es_out_sys_t *p_sys )
+{
+    ra_cmd_t *p_cmd;
+    struct vlc_list deleted;
+
+    vlc_list_init( &deleted );
+    vlc_list_foreach( p_cmd, &p_sys->queue, node )
+    {
+        vlc_list_remove( &p_cmd->node );
+        if( p_cmd->type == RA_DEL )
+            vlc_list_append( &p_cmd->node, &deleted );
+        else
+        {
+            CmdDrop( p_cmd );
+            p_sys->i_count--;
+        }
+    }
+    /* The deletions are still due, keep them */
+    vlc_list_foreach( p_cmd, &deleted, node )
+    {
+        vlc_list_remove( &p_cmd->node );
+        vlc_list_append( &p_cmd->node, &p_sys->queue );
+    }
+
+    p_sys->i_pcr_head = VLC_TICK_INVALID;
+    p_sys->i_pcr_tail = VLC_TICK_INVALID;
+    p_sys->i_deadline = VLC_TICK_INVALID;
+
+    while( p_sys->b_busy )
+        vlc_cond_wait( &p_sys->wait_space, &p_sys->lock );
+}
+
+/* Waits for the queued commands to be executed */
+static void DrainLocked( es_out_sys_t *p_sys )
+{
+    while( p_sys->i_count > 0 || p_sys->b_busy )
+    {
+        if( p_sys->b_paused && !p_sys->b_busy )
+        {
+            /* Not fed while paused, execute them from this thread */
+            ra_cmd_t *p_cmd = PopLocked( p_sys );
+            vlc_mutex_unlock( &p_sys->lock );
+            CmdExecute( p_sys, p_cmd );
+            vlc_mutex_lock( &p_sys->lock );
+            continue;
+        }
+        vlc_cond_signal( &p_sys->wait_feed );
+        vlc_cond_wait( &p_sys->wait_space, &p_sys->lock );
+    }
+    p_sys->i_deadline = VLC_TICK_INVALID;
+}
+
+static void Drain( es_out_sys_t *p_sys )
+{
+    vlc_mutex_lock( &p_sys->lock );
+    DrainLocked( p_sys );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+/* Returns true if the command was queued, false if it must be executed now */
+static bool Push( es_out_sys_t *p_sys, ra_cmd_t *p_cmd )
+{
+    vlc_mutex_lock( &p_sys->lock );
+
+    if( !input_CanPaceControl( p_sys->p_input ) )
+    {
+        /* The decoders already buffer as much as needed */
+        DrainLocked( p_sys );
+        vlc_mutex_unlock( &p_sys->lock );
+        return false;
+    }
+
+    if( !p_sys->b_thread )
+    {
+        if( vlc_clone( &p_sys->thread, FeederThread, p_sys,
+                       VLC_THREAD_PRIORITY_INPUT ) )
+        {
+            vlc_mutex_unlock( &p_sys->lock );
+            return false;
+        }
+        p_sys->b_thread = true;
+    }
+
+    while( IsFullLocked( p_sys, RA_HARD_LIMIT_FACTOR ) && !vlc_killed() )
+        vlc_cond_timedwait( &p_sys->wait_space, &p_sys->lock,
+                            vlc_tick_now() + VLC_TICK_FROM_MS(50) );
+
+    if( p_cmd->type == RA_PCR )
+    {
+        p_sys->i_pcr_tail = p_cmd->i_pcr;
+        if( p_sys->i_pcr_head == VLC_TICK_INVALID )
+            p_sys->i_pcr_head = p_cmd->i_pcr;
+    }
+    vlc_list_append( &p_cmd->node, &p_sys->queue );
+    p_sys->i_count++;
+    vlc_cond_signal( &p_sys->wait_feed );
+
+    vlc_mutex_unlock( &p_sys->lock );
+    return true;
+}
+
+static ra_cmd_t *CmdNew( enum ra_cmd_type type )
+{
+    ra_cmd_t *p_cmd = malloc( sizeof(*p_cmd) );
+    if( p_cmd != NULL )
+    {
+        p_cmd->type = type;
+        p_cmd->in = NULL;
+        p_cmd->es = NULL;
+        p_cmd->block = NULL;
+        p_cmd->i_group = -1;
+        p_cmd->i_pcr = VLC_TICK_INVALID;
+    }
+    return p_cmd;
+}
+
+/*****************************************************************************
+ * es_out callbacks
+ *****************************************************************************/
+static es_out_id_t *Add( es_out_t *p_out, input_source_t *in,
+                         const es_format_t *p_fmt )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    /* The queued data belongs to other ES, no need to wait */
+    return p_sys->p_out->cbs->add( p_sys->p_out, in, p_fmt );
+}
+
+static int Send( es_out_t *p_out, es_out_id_t *p_es, block_t *p_block )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    ra_cmd_t *p_cmd = CmdNew( RA_SEND );
+    if( p_cmd != NULL )
+    {
+        p_cmd->es = p_es;
+        p_cmd->block = p_block;
+        if( Push( p_sys, p_cmd ) )
+            return VLC_SUCCESS;
+        free( p_cmd );
+    }
+    else
+        Drain( p_sys );
+
+    return es_out_Send( p_sys->p_out, p_es, p_block );
+}
+
+static void Del( es_out_t *p_out, es_out_id_t *p_es )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    ra_cmd_t *p_cmd = CmdNew( RA_DEL );
+    if( p_cmd != NULL )
+    {
+        p_cmd->es = p_es;
+        if( Push( p_sys, p_cmd ) )
+            return;
+        free( p_cmd );
+    }
+    else
+        Drain( p_sys );
+
+    es_out_Del( p_sys->p_out, p_es );
+}
+
+static int Control( es_out_t *p_out, input_source_t *in, int i_query,
+                    va_list args )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    switch( i_query )
+    {
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        {
+            va_list ap;
+            va_copy( ap, args );
+            int i_group = i_query == ES_OUT_SET_GROUP_PCR ? va_arg( ap, int ) : -1;
+            vlc_tick_t i_pcr = va_arg( ap, vlc_tick_t );
+            va_end( ap );
+
+            ra_cmd_t *p_cmd = CmdNew( RA_PCR );
+            if( p_cmd != NULL )
+            {
+                p_cmd->in = in;
+                p_cmd->i_group = i_group;
+                p_cmd->i_pcr = i_pcr;
+                if( Push( p_sys, p_cmd ) )
+                    return VLC_SUCCESS;
+                free( p_cmd );
+            }
+            else
+                Drain( p_sys );
+            break;
+        }
+
+        case ES_OUT_RESET_PCR:
+            vlc_mutex_lock( &p_sys->lock );
+            FlushLocked( p_sys );
+            vlc_mutex_unlock( &p_sys->lock );
+            break;
+
+        /* These only query the state, and need not wait for the queue */
+        case ES_OUT_GET_ES_STATE:
+        case ES_OUT_GET_PCR_SYSTEM:
+            break;
+
+        case ES_OUT_GET_EMPTY:
+        {
+            bool *pb_empty = va_arg( args, bool * );
+
+            vlc_mutex_lock( &p_sys->lock );
+            bool b_queued = p_sys->i_count > 0 || p_sys->b_busy;
+            vlc_mutex_unlock( &p_sys->lock );
+
+            if( b_queued )
+            {
+                *pb_empty = false;
+                return VLC_SUCCESS;
+            }
+            return es_out_Control( p_sys->p_out, ES_OUT_GET_EMPTY, pb_empty );
+        }
+
+        default:
+            /* Any other control changes the ES, group or clock state, and
+             * must only apply to the data sent after it */
+            Drain( p_sys );
+            break;
+    }
+
+    return p_sys->p_out->cbs->control( p_sys->p_out, in, i_query, args );
+}
+
+static int PrivControl( es_out_t *p_out, int i_query, va_list args )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    switch( i_query )
+    {
+        case ES_OUT_PRIV_GET_WAKE_UP:
+        {
+            vlc_tick_t *pi_wakeup = va_arg( args, vlc_tick_t * );
+
+            vlc_mutex_lock( &p_sys->lock );
+            bool b_full = p_sys->b_thread && IsFullLocked( p_sys, 1 );
+            vlc_mutex_unlock( &p_sys->lock );
+
+            if( !b_full )
+            {
+                if( p_sys->b_thread )
+                {
+                    *pi_wakeup = 0; /* read ahead */
+                    return VLC_SUCCESS;
+                }
+                return es_out_vaPrivControl( p_sys->p_out, i_query, args );
+            }
+
+            /* Check again once the feeder has consumed some data */
+            vlc_tick_t i_wakeup = es_out_GetWakeup( p_sys->p_out );
+            vlc_tick_t i_poll = vlc_tick_now() + VLC_TICK_FROM_MS(20);
+            *pi_wakeup = i_wakeup > 0 ? __MIN( i_wakeup, i_poll ) : i_poll;
+            return VLC_SUCCESS;
+        }
+
+        case ES_OUT_PRIV_SET_PAUSE_STATE:
+        {
+            va_list ap;
+            va_copy( ap, args );
+            (void) va_arg( ap, int );
+            const bool b_paused = (bool)va_arg( ap, int );
+            va_end( ap );
+
+            if( b_paused )
+            {
+                /* Stop feeding before pausing the decoders */
+                vlc_mutex_lock( &p_sys->lock );
+                p_sys->b_paused = true;
+                while( p_sys->b_busy )
+                    vlc_cond_wait( &p_sys->wait_space, &p_sys->lock );
+                vlc_mutex_unlock( &p_sys->lock );
+            }
+
+            int i_ret = es_out_vaPrivControl( p_sys->p_out, i_query, args );
+
+            vlc_mutex_lock( &p_sys->lock );
+            p_sys->b_paused = b_paused;
+            p_sys->i_deadline = VLC_TICK_INVALID;
+            vlc_cond_signal( &p_sys->wait_feed );
+            vlc_mutex_unlock( &p_sys->lock );
+            return i_ret;
+        }
+
+        case ES_OUT_PRIV_SET_RATE:
+        {
+            int i_ret = es_out_vaPrivControl( p_sys->p_out, i_query, args );
+
+            /* The clock changed, recompute the wake-up date */
+            vlc_mutex_lock( &p_sys->lock );
+            p_sys->i_deadline = VLC_TICK_INVALID;
+            vlc_cond_signal( &p_sys->wait_feed );
+            vlc_mutex_unlock( &p_sys->lock );
+            return i_ret;
+        }
+
+        case ES_OUT_PRIV_SET_EOS:
+        case ES_OUT_PRIV_SET_MODE:
+            Drain( p_sys );
+            break;
+
+        default:
+            break;
+    }
+
+    return es_out_vaPrivControl( p_sys->p_out, i_query, args );
+}
+
+static void Destroy( es_out_t *p_out )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    if( p_sys->b_thread )
+    {
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->b_exit = true;
+        vlc_cond_signal( &p_sys->wait_feed );
+        vlc_mutex_unlock( &p_sys->lock );
+        vlc_join( p_sys->thread, NULL );
+    }
+
+    /* Drop the data but delete the remaining ES */
+    ra_cmd_t *p_cmd;
+    vlc_list_foreach( p_cmd, &p_sys->queue, node )
+    {
+        vlc_list_remove( &p_cmd->node );
+        if( p_cmd->type == RA_DEL )
+            CmdExecute( p_sys, p_cmd );
+        else
+            CmdDrop( p_cmd );
+    }
+
+    es_out_Delete( p_sys->p_out );
+    free( p_sys );
+}
+
+static const struct es_out_callbacks es_out_readahead_cbs =
+{
+    .add = Add,
+    .send = Send,
+    .del = Del,
+    .control = Control,
+    .destroy = Destroy,
+    .priv_control = PrivControl,
+};
+
+/*****************************************************************************
+ * input_EsOutReadAheadNew:
+ *****************************************************************************/
+es_out_t *input_EsOutReadAheadNew( input_thread_t *p_input, es_out_t *p_next_out,
+                                   vlc_tick_t i_duration )
+{
+    es_out_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( !p_sys )
+        return NULL;
+
+    p_sys->out.cbs = &es_out_readahead_cbs;
+    p_sys->p_input = p_input;
+    p_sys->p_out = p_next_out;
+    p_sys->i_duration = i_duration;
+
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait_feed );
+    vlc_cond_init( &p_sys->wait_space );
+    p_sys->b_thread = false;
+    p_sys->b_exit = false;
+    p_sys->b_paused = false;
+    p_sys->b_busy = false;
+    p_sys->i_deadline = VLC_TICK_INVALID;
+
+    vlc_list_init( &p_sys->queue );
+    p_sys->i_count = 0;
+    p_sys->i_pcr_head = VLC_TICK_INVALID;
+    p_sys->i_pcr_tail = VLC_TICK_INVALID;
+
+    msg_Dbg( p_input, "reading ahead up to %"PRId64" ms",
+             MS_FROM_VLC_TICK(i_duration) );
+    return &p_sys->out;
+}
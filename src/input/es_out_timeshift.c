@@ -36,6 +36,10 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -94,7 +98,7 @@ typedef struct attribute_packed
     es_out_id_t *p_es;
     union{
         block_t *p_block;
-        int     i_offset;  /* We do not use file > INT_MAX */
+        int64_t i_offset;  /* Offset of the data in the storage */
     };
 } ts_cmd_send_t;
 
@@ -209,6 +213,44 @@ struct ts_storage_t
     size_t   i_cmd_buf;
 };
 
+/* Seek point of the ring buffer */
+typedef struct
+{
+    uint64_t   i_offset;  /* Offset of the block data */
+    uint64_t   i_cmd;     /* Index of the matching command */
+    vlc_tick_t i_date;    /* Date of the matching command */
+    bool       b_keyframe;
+} ts_ring_index_t;
+
+/* Single preallocated memory-mapped file, used circularly */
+typedef struct
+{
+    int      fd;
+    uint8_t  *p_base;
+    size_t   i_size;    /* Capacity in bytes */
+    uint64_t i_begin;   /* Offset of the oldest byte still in use */
+    uint64_t i_end;     /* Offset of the next byte to write */
+
+    /* Played then pending commands (circular array, indexes always
+     * increase). The played ones are kept to seek back. */
+    ts_cmd_t *p_cmd;
+    size_t   i_cmd_max;
+    uint64_t i_cmd_first;
+    uint64_t i_cmd_r;
+    uint64_t i_cmd_w;
+    uint64_t i_cmd_drop;/* Media commands before it are skipped */
+
+    vlc_tick_t i_play_date; /* Date of the last played command */
+    vlc_tick_t i_play_time; /* Last played stream time */
+    vlc_tick_t i_play_time_date;
+
+    /* Seek points, by increasing offset */
+    ts_ring_index_t *p_index;
+    size_t   i_index_max;
+    uint64_t i_index_r;
+    uint64_t i_index_w;
+} ts_ring_t;
+
 typedef struct
 {
     vlc_thread_t   thread;
@@ -216,6 +258,7 @@ typedef struct
     es_out_t       *p_tsout;
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
+    int64_t        i_ring_size;
     const char     *psz_tmp_path;
 
     /* Lock for all following fields */
@@ -239,6 +282,7 @@ typedef struct
     /* */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    ts_ring_t      *p_ring;
 
     vlc_tick_t     i_cmd_delay;
 
@@ -256,6 +300,7 @@ typedef struct
 
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
+    int64_t        i_ring_size;       /* Ring buffer size in byte, 0 if unused */
     char           *psz_tmp_path;     /* Path for temporary files */
 
     /* Lock for all following fields */
@@ -286,10 +331,12 @@ static void         TsAutoStop( es_out_t * );
 static void         TsStop( ts_thread_t * );
 static void         TsPushCmd( ts_thread_t *, ts_cmd_t * );
 static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool b_flush );
+static bool         TsIsEmptyLocked( ts_thread_t * );
 static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
+static int          TsSeek( ts_thread_t *, vlc_tick_t i_time, bool b_absolute );
 
 static void         *TsRun( void * );
 
@@ -301,6 +348,13 @@ static bool         TsStorageIsEmpty( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
 
+static ts_ring_t    *TsRingNew( const char *psz_path, int64_t i_size );
+static void         TsRingDelete( ts_ring_t * );
+static bool         TsRingIsEmpty( ts_ring_t * );
+static int          TsRingPushCmd( ts_ring_t *, const ts_cmd_t *p_cmd, vlc_tick_t *pi_dropped );
+static int          TsRingPopCmd( ts_ring_t *, ts_cmd_t *p_cmd );
+static int          TsRingSeek( ts_ring_t *, vlc_tick_t i_date, vlc_tick_t *pi_shift );
+
 static void CmdClean( ts_cmd_t * );
 
 static int  CmdInitAdd    ( ts_cmd_add_t *, input_source_t *, es_out_id_t *, const es_format_t *, bool b_copy );
@@ -361,6 +415,9 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    const int64_t i_ring_size = var_InheritInteger( p_input, "input-timeshift-ring-size" );
+    p_sys->i_ring_size = i_ring_size > 0 ? i_ring_size * 1024 * 1024 : 0;
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !defined(VLC_WINSTORE_APP)
     if( p_sys->psz_tmp_path == NULL )
@@ -645,6 +702,16 @@ static int ControlLockedSetFrameNext( es_out_t *p_out )
     return es_out_SetFrameNext( p_sys->p_out );
 }
 
+static int ControlLockedSetTimeshiftTime( es_out_t *p_out, vlc_tick_t i_time,
+                                          bool b_absolute )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+
+    if( !p_sys->b_delayed )
+        return VLC_EGENERIC;
+    return TsSeek( p_sys->p_ts, i_time, b_absolute );
+}
+
 static int ControlLocked( es_out_t *p_out, input_source_t *in, int i_query,
                           va_list args )
 {
@@ -754,6 +821,12 @@ static int ControlLocked( es_out_t *p_out, input_source_t *in, int i_query,
                                   i_system );
     }
 
+    case ES_OUT_SET_RATE_ADJUST:
+        /* Meaningless while playing back from the timeshift buffer */
+        if( p_sys->b_delayed )
+            return VLC_EGENERIC;
+        return es_out_in_vaControl( p_sys->p_out, in, i_query, args );
+
     default:
         vlc_assert_unreachable();
         return VLC_EGENERIC;
@@ -827,6 +900,13 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     {
         return ControlLockedSetFrameNext( p_tsout );
     }
+    case ES_OUT_PRIV_SET_TIMESHIFT_TIME:
+    {
+        const vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+        const bool b_absolute = (bool)va_arg( args, int );
+
+        return ControlLockedSetTimeshiftTime( p_tsout, i_time, b_absolute );
+    }
     case ES_OUT_PRIV_GET_GROUP_FORCED:
         return es_out_vaPrivControl( p_sys->p_out, i_query, args );
     /* Invalid queries for this es_out level */
@@ -891,6 +971,7 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_ring_size = p_sys->i_ring_size;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
@@ -908,12 +989,26 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->p_ring = NULL;
+
+    if( p_ts->i_ring_size > 0 )
+    {
+        p_ts->p_ring = TsRingNew( p_ts->psz_tmp_path, p_ts->i_ring_size );
+        if( p_ts->p_ring )
+            msg_Dbg( p_sys->p_input, "using a timeshift ring buffer of %"PRId64" MiB",
+                     p_ts->i_ring_size / (1024*1024) );
+        else
+            msg_Warn( p_sys->p_input, "cannot create the timeshift ring buffer, "
+                      "using temporary files" );
+    }
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
     {
         msg_Err( p_sys->p_input, "cannot create timeshift thread" );
 
+        if( p_ts->p_ring )
+            TsRingDelete( p_ts->p_ring );
         TsDestroy( p_ts );
 
         p_sys->b_delayed = false;
@@ -955,6 +1050,8 @@ static void TsStop( ts_thread_t *p_ts )
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
     if( p_ts->p_storage_r )
         TsStorageDelete( p_ts->p_storage_r );
+    if( p_ts->p_ring )
+        TsRingDelete( p_ts->p_ring );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -963,6 +1060,21 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
+    if( p_ts->p_ring )
+    {
+        vlc_tick_t i_dropped = 0;
+
+        if( TsRingPushCmd( p_ts->p_ring, p_cmd, &i_dropped ) )
+            CmdClean( p_cmd );
+
+        /* Skip the overwritten part of the buffer when playing it back */
+        p_ts->i_cmd_delay -= i_dropped;
+
+        vlc_cond_signal( &p_ts->wait );
+        vlc_mutex_unlock( &p_ts->lock );
+        return;
+    }
+
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
         ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
@@ -998,6 +1110,9 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 {
     vlc_mutex_assert( &p_ts->lock );
 
+    if( p_ts->p_ring )
+        return TsRingPopCmd( p_ts->p_ring, p_cmd );
+
     if( TsStorageIsEmpty( p_ts->p_storage_r ) )
         return VLC_EGENERIC;
 
@@ -1015,12 +1130,20 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 
     return VLC_SUCCESS;
 }
+static bool TsIsEmptyLocked( ts_thread_t *p_ts )
+{
+    vlc_mutex_assert( &p_ts->lock );
+
+    if( p_ts->p_ring )
+        return TsRingIsEmpty( p_ts->p_ring );
+    return TsStorageIsEmpty( p_ts->p_storage_r );
+}
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
     bool b_cmd;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_r );
+    b_cmd = !TsIsEmptyLocked( p_ts );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_cmd;
@@ -1030,9 +1153,11 @@ static bool TsIsUnused( ts_thread_t *p_ts )
     bool b_unused;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_unused = !p_ts->b_paused &&
+    /* The ring buffer is kept to seek back into it */
+    b_unused = !p_ts->p_ring &&
+               !p_ts->b_paused &&
                p_ts->rate == p_ts->rate_source &&
-               TsStorageIsEmpty( p_ts->p_storage_r );
+               TsIsEmptyLocked( p_ts );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_unused;
@@ -1086,6 +1211,47 @@ static int TsChangeRate( ts_thread_t *p_ts, float src_rate, float rate )
 
     return i_ret;
 }
+static int TsSeek( ts_thread_t *p_ts, vlc_tick_t i_time, bool b_absolute )
+{
+    ts_ring_t *p_ring = p_ts->p_ring;
+    vlc_tick_t i_date, i_shift;
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_ts->lock );
+    if( !p_ring )
+        goto exit;
+
+    /* Convert the target into a command date */
+    if( !b_absolute )
+    {
+        if( p_ring->i_play_date == VLC_TICK_INVALID )
+            goto exit;
+        i_date = p_ring->i_play_date + i_time;
+    }
+    else
+    {
+        if( p_ring->i_play_time == VLC_TICK_INVALID )
+            goto exit;
+        i_date = p_ring->i_play_time_date + i_time - p_ring->i_play_time;
+    }
+
+    if( TsRingSeek( p_ring, i_date, &i_shift ) )
+        goto exit;
+
+    /* Play the new position now */
+    p_ts->i_cmd_delay += p_ts->i_rate_delay + i_shift;
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+
+    /* Reset the decoders states and clock sync */
+    es_out_Control( p_ts->p_out, ES_OUT_RESET_PCR );
+
+    vlc_cond_signal( &p_ts->wait );
+    i_ret = VLC_SUCCESS;
+exit:
+    vlc_mutex_unlock( &p_ts->lock );
+    return i_ret;
+}
 
 static void *TsRun( void *p_data )
 {
@@ -1400,6 +1566,514 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     }
 }
 
+/*****************************************************************************
+ * Ring buffer storage
+ *****************************************************************************/
+#define TS_RING_COMMAND_PREALLOC 4096
+#define TS_RING_INDEX_PREALLOC 256
+/* Interval of the seek points added between keyframes */
+#define TS_RING_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+/* How far to look for a keyframe around a seek point */
+#define TS_RING_KEYFRAME_DISTANCE VLC_TICK_FROM_SEC(10)
+
+/* Header of the blocks stored in the ring */
+typedef struct
+{
+    vlc_tick_t i_pts;
+    vlc_tick_t i_dts;
+    vlc_tick_t i_length;
+    uint32_t   i_flags;
+    unsigned   i_nb_samples;
+    size_t     i_buffer;
+} ts_ring_block_t;
+
+static void TsRingCleanCmd( ts_cmd_t *p_cmd )
+{
+    /* Blocks are not allocated before the command is popped */
+    if( p_cmd->header.i_type != C_SEND )
+        CmdClean( p_cmd );
+}
+
+/* Releases the played commands before i_cmd */
+static void TsRingForget( ts_ring_t *p_ring, uint64_t i_cmd )
+{
+    for( ; p_ring->i_cmd_first < i_cmd; p_ring->i_cmd_first++ )
+        TsRingCleanCmd( &p_ring->p_cmd[p_ring->i_cmd_first % p_ring->i_cmd_max] );
+}
+
+static ts_ring_t *TsRingNew( const char *psz_tmp_path, int64_t i_size )
+{
+#ifdef HAVE_MMAP
+    if( (uint64_t)i_size > SIZE_MAX )
+        return NULL;
+
+    ts_ring_t *p_ring = malloc( sizeof (*p_ring) );
+    if( unlikely(p_ring == NULL) )
+        return NULL;
+
+    char *psz_file;
+    int fd = GetTmpFile( &psz_file, psz_tmp_path );
+    if( fd == -1 )
+    {
+        free( p_ring );
+        return NULL;
+    }
+    vlc_unlink( psz_file );
+    free( psz_file );
+
+    /* Reserve all the disk space now, rather than on every write */
+#ifdef HAVE_POSIX_FALLOCATE
+    int val = posix_fallocate( fd, 0, i_size );
+    if( val == EINVAL || val == EOPNOTSUPP )
+#else
+    int val = -1;
+#endif
+        val = ftruncate( fd, i_size ) ? errno : 0;
+    if( val != 0 )
+        goto error;
+
+    p_ring->p_base = mmap( NULL, i_size, PROT_READ|PROT_WRITE, MAP_SHARED,
+                           fd, 0 );
+    if( p_ring->p_base == MAP_FAILED )
+        goto error;
+
+    p_ring->fd = fd;
+    p_ring->i_size = i_size;
+    p_ring->i_begin = 0;
+    p_ring->i_end = 0;
+
+    p_ring->p_cmd = vlc_alloc( TS_RING_COMMAND_PREALLOC, sizeof(*p_ring->p_cmd) );
+    p_ring->i_cmd_max = TS_RING_COMMAND_PREALLOC;
+    p_ring->i_cmd_first = 0;
+    p_ring->i_cmd_r = 0;
+    p_ring->i_cmd_w = 0;
+    p_ring->i_cmd_drop = 0;
+
+    p_ring->i_play_date = VLC_TICK_INVALID;
+    p_ring->i_play_time = VLC_TICK_INVALID;
+    p_ring->i_play_time_date = VLC_TICK_INVALID;
+
+    p_ring->p_index = vlc_alloc( TS_RING_INDEX_PREALLOC, sizeof(*p_ring->p_index) );
+    p_ring->i_index_max = TS_RING_INDEX_PREALLOC;
+    p_ring->i_index_r = 0;
+    p_ring->i_index_w = 0;
+
+    if( !p_ring->p_cmd || !p_ring->p_index )
+    {
+        TsRingDelete( p_ring );
+        return NULL;
+    }
+    return p_ring;
+
+error:
+    vlc_close( fd );
+    free( p_ring );
+    return NULL;
+#else
+    VLC_UNUSED(psz_tmp_path); VLC_UNUSED(i_size);
+    return NULL;
+#endif
+}
+
+static void TsRingDelete( ts_ring_t *p_ring )
+{
+#ifdef HAVE_MMAP
+    if( p_ring->p_cmd )
+    {
+        TsRingForget( p_ring, p_ring->i_cmd_r );
+        for( uint64_t i = p_ring->i_cmd_r; i < p_ring->i_cmd_w; i++ )
+            TsRingCleanCmd( &p_ring->p_cmd[i % p_ring->i_cmd_max] );
+    }
+    free( p_ring->p_cmd );
+    free( p_ring->p_index );
+
+    munmap( p_ring->p_base, p_ring->i_size );
+    vlc_close( p_ring->fd );
+    free( p_ring );
+#else
+    VLC_UNUSED(p_ring);
+    vlc_assert_unreachable();
+#endif
+}
+
+static bool TsRingIsEmpty( ts_ring_t *p_ring )
+{
+    return p_ring->i_cmd_r >= p_ring->i_cmd_w;
+}
+
+static void TsRingWrite( ts_ring_t *p_ring, uint64_t i_offset,
+                         const void *p_data, size_t i_data )
+{
+    const size_t i_pos = i_offset % p_ring->i_size;
+    const size_t i_first = __MIN( i_data, p_ring->i_size - i_pos );
+
+    memcpy( &p_ring->p_base[i_pos], p_data, i_first );
+    memcpy( p_ring->p_base, (const uint8_t *)p_data + i_first, i_data - i_first );
+}
+
+static void TsRingRead( ts_ring_t *p_ring, uint64_t i_offset,
+                        void *p_data, size_t i_data )
+{
+    const size_t i_pos = i_offset % p_ring->i_size;
+    const size_t i_first = __MIN( i_data, p_ring->i_size - i_pos );
+
+    memcpy( p_data, &p_ring->p_base[i_pos], i_first );
+    memcpy( (uint8_t *)p_data + i_first, p_ring->p_base, i_data - i_first );
+}
+
+/* Commands that are meaningless once the data around them is lost */
+static bool TsRingIsMediaCmd( const ts_cmd_t *p_cmd )
+{
+    if( p_cmd->header.i_type == C_SEND )
+        return true;
+    return p_cmd->header.i_type == C_CONTROL &&
+           ( p_cmd->control.i_query == ES_OUT_SET_PCR ||
+             p_cmd->control.i_query == ES_OUT_SET_GROUP_PCR );
+}
+
+/* Commands that can be played again after seeking back */
+static bool TsRingIsReplayableCmd( const ts_cmd_t *p_cmd )
+{
+    if( p_cmd->header.i_type == C_PRIVCONTROL )
+        return p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES ||
+               p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_JITTER;
+    return TsRingIsMediaCmd( p_cmd );
+}
+
+static const ts_ring_index_t *TsRingGetIndex( ts_ring_t *p_ring, uint64_t i )
+{
+    return &p_ring->p_index[i % p_ring->i_index_max];
+}
+
+static void *TsRingGrow( void *p_array, size_t *pi_max, size_t i_entry,
+                         uint64_t i_first, uint64_t i_last )
+{
+    const size_t i_max = *pi_max;
+    uint8_t *p_old = p_array;
+    uint8_t *p_new = vlc_alloc( 2 * i_max, i_entry );
+    if( !p_new )
+        return NULL;
+
+    for( uint64_t i = i_first; i < i_last; i++ )
+        memcpy( &p_new[(i % (2 * i_max)) * i_entry], &p_old[(i % i_max) * i_entry],
+                i_entry );
+    free( p_old );
+    *pi_max = 2 * i_max;
+    return p_new;
+}
+
+/* Returns the first seek point at or after i_offset */
+static uint64_t TsRingFindIndex( ts_ring_t *p_ring, uint64_t i_offset )
+{
+    uint64_t i_low = p_ring->i_index_r;
+    uint64_t i_high = p_ring->i_index_w;
+
+    while( i_low < i_high )
+    {
+        const uint64_t i_mid = i_low + (i_high - i_low) / 2;
+
+        if( TsRingGetIndex( p_ring, i_mid )->i_offset < i_offset )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+/* Returns the first seek point after i_date */
+static uint64_t TsRingFindIndexByDate( ts_ring_t *p_ring, uint64_t i_low,
+                                       vlc_tick_t i_date )
+{
+    uint64_t i_high = p_ring->i_index_w;
+
+    while( i_low < i_high )
+    {
+        const uint64_t i_mid = i_low + (i_high - i_low) / 2;
+
+        if( TsRingGetIndex( p_ring, i_mid )->i_date <= i_date )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+/* Makes room for i_data bytes, overwriting the oldest data if needed */
+static void TsRingReserve( ts_ring_t *p_ring, size_t i_data, vlc_tick_t i_date,
+                           vlc_tick_t *pi_dropped )
+{
+    if( p_ring->i_end + i_data - p_ring->i_begin <= p_ring->i_size )
+        return;
+
+    const uint64_t i_min = p_ring->i_end + i_data - p_ring->i_size;
+    uint64_t i_cmd;
+
+    /* Resume on the next seek point left, a keyframe if possible */
+    uint64_t i_index = TsRingFindIndex( p_ring, i_min );
+    if( i_index < p_ring->i_index_w )
+    {
+        const ts_ring_index_t *p_entry = TsRingGetIndex( p_ring, i_index );
+
+        for( uint64_t i = i_index; i < p_ring->i_index_w; i++ )
+        {
+            const ts_ring_index_t *p_next = TsRingGetIndex( p_ring, i );
+
+            if( p_next->i_date - p_entry->i_date > TS_RING_KEYFRAME_DISTANCE )
+                break;
+            if( p_next->b_keyframe )
+            {
+                p_entry = p_next;
+                break;
+            }
+        }
+        p_ring->i_begin = p_entry->i_offset;
+        i_cmd = p_entry->i_cmd;
+    }
+    else
+    {
+        p_ring->i_begin = i_min;
+        i_cmd = __MAX( p_ring->i_cmd_first, p_ring->i_cmd_drop );
+        while( i_cmd < p_ring->i_cmd_w )
+        {
+            const ts_cmd_t *p_cmd = &p_ring->p_cmd[i_cmd % p_ring->i_cmd_max];
+
+            if( p_cmd->header.i_type == C_SEND &&
+                (uint64_t)p_cmd->send.i_offset >= i_min )
+                break;
+            i_cmd++;
+        }
+    }
+    p_ring->i_index_r = TsRingFindIndex( p_ring, p_ring->i_begin );
+
+    if( i_cmd <= p_ring->i_cmd_r )
+    {
+        /* Only played data was lost */
+        TsRingForget( p_ring, i_cmd );
+        return;
+    }
+    TsRingForget( p_ring, p_ring->i_cmd_r );
+
+    /* Account for the playback time that was lost */
+    const uint64_t i_first = __MAX( p_ring->i_cmd_r, p_ring->i_cmd_drop );
+    if( i_cmd > i_first )
+    {
+        const vlc_tick_t i_from = p_ring->p_cmd[i_first % p_ring->i_cmd_max].header.i_date;
+        const vlc_tick_t i_to = i_cmd < p_ring->i_cmd_w ?
+            p_ring->p_cmd[i_cmd % p_ring->i_cmd_max].header.i_date : i_date;
+
+        *pi_dropped += i_to - i_from;
+        p_ring->i_cmd_drop = i_cmd;
+    }
+
+    /* Release the commands that will not be played at all */
+    while( p_ring->i_cmd_r < p_ring->i_cmd_drop )
+    {
+        ts_cmd_t *p_cmd = &p_ring->p_cmd[p_ring->i_cmd_r % p_ring->i_cmd_max];
+
+        if( !TsRingIsMediaCmd( p_cmd ) )
+            break;
+        TsRingCleanCmd( p_cmd );
+        p_ring->i_cmd_r++;
+    }
+    p_ring->i_cmd_first = p_ring->i_cmd_r;
+}
+
+static int TsRingPushCmd( ts_ring_t *p_ring, const ts_cmd_t *p_cmd,
+                          vlc_tick_t *pi_dropped )
+{
+    if( p_ring->i_cmd_w - p_ring->i_cmd_first >= p_ring->i_cmd_max )
+    {
+        ts_cmd_t *p_array = TsRingGrow( p_ring->p_cmd, &p_ring->i_cmd_max,
+                                        sizeof(*p_ring->p_cmd),
+                                        p_ring->i_cmd_first, p_ring->i_cmd_w );
+        if( !p_array )
+            return VLC_ENOMEM;
+        p_ring->p_cmd = p_array;
+    }
+
+    ts_cmd_t cmd;
+    memcpy( &cmd, p_cmd, TsStorageSizeofCommand[p_cmd->header.i_type] );
+
+    if( cmd.header.i_type == C_SEND )
+    {
+        block_t *p_block = cmd.send.p_block;
+        const size_t i_data = sizeof(ts_ring_block_t) + p_block->i_buffer;
+
+        if( i_data > p_ring->i_size )
+            return VLC_EGENERIC;
+
+        /* Index the keyframes, and a point per interval otherwise */
+        const bool b_keyframe = p_block->i_flags & BLOCK_FLAG_TYPE_I;
+        const bool b_index = b_keyframe || p_ring->i_index_r == p_ring->i_index_w ||
+            cmd.header.i_date - TsRingGetIndex( p_ring, p_ring->i_index_w - 1 )->i_date
+                >= TS_RING_INDEX_INTERVAL;
+
+        if( b_index && p_ring->i_index_w - p_ring->i_index_r >= p_ring->i_index_max )
+        {
+            ts_ring_index_t *p_array = TsRingGrow( p_ring->p_index, &p_ring->i_index_max,
+                                                   sizeof(*p_ring->p_index),
+                                                   p_ring->i_index_r, p_ring->i_index_w );
+            if( !p_array )
+                return VLC_ENOMEM;
+            p_ring->p_index = p_array;
+        }
+
+        TsRingReserve( p_ring, i_data, cmd.header.i_date, pi_dropped );
+
+        const ts_ring_block_t block = {
+            .i_pts = p_block->i_pts,
+            .i_dts = p_block->i_dts,
+            .i_length = p_block->i_length,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_buffer = p_block->i_buffer,
+        };
+        TsRingWrite( p_ring, p_ring->i_end, &block, sizeof(block) );
+        TsRingWrite( p_ring, p_ring->i_end + sizeof(block),
+                     p_block->p_buffer, p_block->i_buffer );
+
+        if( b_index )
+        {
+            p_ring->p_index[p_ring->i_index_w++ % p_ring->i_index_max] =
+                (ts_ring_index_t) {
+                    .i_offset = p_ring->i_end,
+                    .i_cmd = p_ring->i_cmd_w,
+                    .i_date = cmd.header.i_date,
+                    .b_keyframe = b_keyframe,
+                };
+        }
+
+        cmd.send.i_offset = p_ring->i_end;
+        p_ring->i_end += i_data;
+        block_Release( p_block );
+    }
+
+    p_ring->p_cmd[p_ring->i_cmd_w++ % p_ring->i_cmd_max] = cmd;
+    return VLC_SUCCESS;
+}
+
+static int TsRingPopCmd( ts_ring_t *p_ring, ts_cmd_t *p_cmd )
+{
+    while( p_ring->i_cmd_r < p_ring->i_cmd_w )
+    {
+        const uint64_t i_cmd = p_ring->i_cmd_r++;
+
+        *p_cmd = p_ring->p_cmd[i_cmd % p_ring->i_cmd_max];
+        p_ring->i_play_date = p_cmd->header.i_date;
+
+        if( !TsRingIsReplayableCmd( p_cmd ) )
+        {
+            /* The command is given away, and cannot be played back again */
+            TsRingForget( p_ring, i_cmd );
+            p_ring->i_cmd_first = i_cmd + 1;
+            return VLC_SUCCESS;
+        }
+
+        if( i_cmd < p_ring->i_cmd_drop && TsRingIsMediaCmd( p_cmd ) )
+        {
+            /* Keep the skipped commands unless their data was overwritten */
+            if( p_cmd->header.i_type == C_SEND &&
+                (uint64_t)p_cmd->send.i_offset < p_ring->i_begin )
+                TsRingForget( p_ring, p_ring->i_cmd_r );
+            continue;
+        }
+
+        switch( p_cmd->header.i_type )
+        {
+        case C_SEND:
+        {
+            const uint64_t i_offset = p_cmd->send.i_offset;
+            ts_ring_block_t block;
+
+            assert( i_offset >= p_ring->i_begin );
+            TsRingRead( p_ring, i_offset, &block, sizeof(block) );
+
+            block_t *p_block = block_Alloc( block.i_buffer );
+            if( p_block )
+            {
+                p_block->i_dts      = block.i_dts;
+                p_block->i_pts      = block.i_pts;
+                p_block->i_flags    = block.i_flags;
+                p_block->i_length   = block.i_length;
+                p_block->i_nb_samples = block.i_nb_samples;
+                TsRingRead( p_ring, i_offset + sizeof(block),
+                            p_block->p_buffer, block.i_buffer );
+            }
+            p_cmd->send.p_block = p_block;
+            break;
+        }
+        case C_CONTROL:
+            /* The ring keeps its own reference */
+            if( p_cmd->control.in )
+                input_source_Hold( p_cmd->control.in );
+            break;
+        case C_PRIVCONTROL:
+            if( p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES )
+            {
+                p_ring->i_play_time = p_cmd->privcontrol.u.times.i_time;
+                p_ring->i_play_time_date = p_cmd->header.i_date;
+            }
+            break;
+        }
+        return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+/* Moves the playback to the seek point closest to i_date, preferably a
+ * keyframe before it. Returns the shift of the playback dates. */
+static int TsRingSeek( ts_ring_t *p_ring, vlc_tick_t i_date, vlc_tick_t *pi_shift )
+{
+    uint64_t i_low = p_ring->i_index_r;
+    uint64_t i_high = p_ring->i_index_w;
+
+    if( p_ring->i_play_date == VLC_TICK_INVALID )
+        return VLC_EGENERIC;
+
+    /* Skip the seek points before the last command that cannot be replayed */
+    while( i_low < i_high )
+    {
+        const uint64_t i_mid = i_low + (i_high - i_low) / 2;
+
+        if( TsRingGetIndex( p_ring, i_mid )->i_cmd < p_ring->i_cmd_first )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    if( i_low >= p_ring->i_index_w )
+        return VLC_EGENERIC;
+
+    uint64_t i_index = TsRingFindIndexByDate( p_ring, i_low, i_date );
+    if( i_index > i_low )
+        i_index--;
+
+    const ts_ring_index_t *p_entry = TsRingGetIndex( p_ring, i_index );
+    for( uint64_t i = i_index + 1; i-- > i_low; )
+    {
+        const ts_ring_index_t *p_prev = TsRingGetIndex( p_ring, i );
+
+        if( p_entry->i_date - p_prev->i_date > TS_RING_KEYFRAME_DISTANCE )
+            break;
+        if( p_prev->b_keyframe )
+        {
+            p_entry = p_prev;
+            break;
+        }
+    }
+
+    *pi_shift = p_ring->i_play_date - p_entry->i_date;
+
+    p_ring->i_cmd_r = __MIN( p_ring->i_cmd_r, p_entry->i_cmd );
+    p_ring->i_cmd_drop = p_entry->i_cmd;
+    p_ring->i_play_date = p_entry->i_date;
+    if( p_ring->i_play_time != VLC_TICK_INVALID )
+    {
+        p_ring->i_play_time += p_entry->i_date - p_ring->i_play_time_date;
+        p_ring->i_play_time_date = p_entry->i_date;
+    }
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
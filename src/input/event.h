@@ -23,6 +23,8 @@
 #ifndef LIBVLC_INPUT_EVENT_H
 #define LIBVLC_INPUT_EVENT_H 1
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_input.h>
 #include "input_internal.h"
@@ -31,6 +33,23 @@ static inline void input_SendEvent(input_thread_t *p_input,
                                    const struct vlc_input_event *event)
 {
     input_thread_private_t *priv = input_priv(p_input);
+    struct input_event_batch *batch = priv->events_batch;
+
+    if(batch != NULL && (event->type == INPUT_EVENT_TIMES
+                      || event->type == INPUT_EVENT_STATISTICS))
+    {
+        /* Only keep the last event of each type */
+        for(size_t i = 0; i < batch->count; i++)
+            if(batch->events[i].type == event->type)
+            {
+                batch->events[i] = *event;
+                return;
+            }
+        assert(batch->count < ARRAY_SIZE(batch->events));
+        batch->events[batch->count++] = *event;
+        return;
+    }
+
     if(priv->events_cb)
         priv->events_cb(p_input, event, priv->events_data);
 }
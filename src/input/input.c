@@ -55,6 +55,7 @@
 #include <vlc_stream_extractor.h>
 #include <vlc_renderer_discovery.h>
 #include <vlc_hash.h>
+#include <vlc_metrics.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -157,6 +158,14 @@ input_thread_t *input_CreateThumbnailer(vlc_object_t *obj,
                    INPUT_CREATE_OPTION_THUMBNAILING, NULL, NULL );
 }
 
+void input_SetEventsBatched( input_thread_t *p_input, bool batched )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+
+    assert( !priv->is_running );
+    priv->events_batched = batched;
+}
+
 /**
  * Start a input_thread_t created by input_Create.
  *
@@ -302,6 +311,12 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     /* Init Common fields */
     priv->events_cb = events_cb;
     priv->events_data = events_data;
+    priv->events_batched = false;
+    priv->events_batch = NULL;
+    priv->i_event_interval =
+        VLC_TICK_FROM_MS( var_InheritInteger( p_input, "input-event-interval" ) );
+    if( priv->i_event_interval <= 0 )
+        priv->i_event_interval = VLC_TICK_FROM_MS(250);
     priv->b_preparsing = option == INPUT_CREATE_OPTION_PREPARSING;
     priv->b_thumbnailing = option == INPUT_CREATE_OPTION_THUMBNAILING;
     priv->i_start = 0;
@@ -311,6 +326,7 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     priv->is_running = false;
     priv->is_stopped = false;
     priv->b_recording = false;
+    priv->b_subs_detect = false;
     priv->rate = 1.f;
     priv->normal_time = VLC_TICK_0;
     TAB_INIT( priv->i_attachment, priv->attachment );
@@ -405,6 +421,13 @@ static input_thread_t *Create( vlc_object_t *p_parent,
         priv->stats = input_stats_Create();
     else
         priv->stats = NULL;
+    priv->cpu_budget = priv->stats != NULL
+        ? var_InheritInteger( p_input, "input-cpu-budget" ) / 100.f : 0.f;
+    priv->cpu_budget_date = VLC_TICK_INVALID;
+    priv->demux_metric = !priv->b_preparsing
+        ? vlc_histogram_Get( p_input, "vlc_demux_seconds", NULL,
+                             "Time spent in a demux call", VLC_METRIC_SECONDS )
+        : NULL;
 
     priv->p_es_out_display = input_EsOutNew( p_input, priv->master, priv->rate );
     if( !priv->p_es_out_display )
@@ -462,6 +485,7 @@ static void *Run( void *data )
     input_thread_t *p_input = &priv->input;
 
     vlc_interrupt_set(&priv->interrupt);
+    input_cpu_Start( &priv->cpu_clock );
 
     if( !Init( p_input ) )
     {
@@ -540,7 +564,14 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     }
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
+    {
+        vlc_tick_t start = p_priv->demux_metric != NULL ? vlc_tick_now()
+                                                        : VLC_TICK_INVALID;
         i_ret = demux_Demux( p_demux );
+        if( start != VLC_TICK_INVALID )
+            vlc_histogram_Observe( p_priv->demux_metric,
+                                   vlc_tick_now() - start );
+    }
 
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
@@ -613,12 +644,56 @@ static int MainLoopTryRepeat( input_thread_t *p_input )
 /**
  * Update timing infos and statistics.
  */
+/**
+ * Raises the degradation level of the decoders when the input uses more CPU
+ * than its budget, and lowers it when back well under the budget.
+ */
+static void MainLoopCPUBudget( input_thread_t *p_input, input_stats_t *st )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+    int level = st->i_cpu_degradation;
+    vlc_tick_t now = vlc_tick_now();
+
+    /* Let the usage settle after a change (it is sampled every second) */
+    if( priv->cpu_budget_date != VLC_TICK_INVALID
+     && now - priv->cpu_budget_date < VLC_TICK_FROM_SEC(3) )
+        return;
+
+    if( st->f_cpu_usage > priv->cpu_budget
+     && level < INPUT_CPU_KEYFRAMES_ONLY )
+    {
+        level++;
+        msg_Warn( p_input, "CPU usage %.2f over budget %.2f, degrading "
+                  "video decoding (level %d)", st->f_cpu_usage,
+                  priv->cpu_budget, level );
+    }
+    else if( st->f_cpu_usage < priv->cpu_budget * .75f
+          && level > INPUT_CPU_NORMAL )
+    {
+        level--;
+        msg_Dbg( p_input, "CPU usage %.2f back under budget %.2f, "
+                 "degradation level %d", st->f_cpu_usage, priv->cpu_budget,
+                 level );
+    }
+    else
+        return;
+
+    atomic_store_explicit( &priv->stats->cpu_degradation, level,
+                           memory_order_relaxed );
+    priv->cpu_budget_date = now;
+    st->i_cpu_degradation = level;
+}
+
 static void MainLoopStatistics( input_thread_t *p_input )
 {
     input_thread_private_t *priv = input_priv(p_input);
     double f_position = 0.0;
     vlc_tick_t i_time;
     vlc_tick_t i_length;
+    struct input_event_batch batch = { .count = 0 };
+
+    if( priv->events_batched )
+        priv->events_batch = &batch;
 
     /* update input status variables */
     if( demux_Control( priv->master->p_demux,
@@ -640,7 +715,13 @@ static void MainLoopStatistics( input_thread_t *p_input )
 
     struct input_stats_t new_stats;
     if( priv->stats != NULL )
+    {
+        input_rate_Add( &priv->stats->cpu_time,
+                        input_cpu_Elapsed( &priv->cpu_clock ) );
         input_stats_Compute( priv->stats, &new_stats );
+        if( priv->cpu_budget > 0.f )
+            MainLoopCPUBudget( p_input, &new_stats );
+    }
 
     vlc_mutex_lock( &priv->p_item->lock );
     if( priv->stats != NULL )
@@ -648,6 +729,19 @@ static void MainLoopStatistics( input_thread_t *p_input )
     vlc_mutex_unlock( &priv->p_item->lock );
 
     input_SendEventStatistics( p_input, &new_stats );
+
+    if( priv->events_batch == NULL )
+        return;
+    priv->events_batch = NULL;
+
+    /* new_stats is still valid: flush the coalesced events now */
+    if( batch.count == 1 )
+        input_SendEvent( p_input, &batch.events[0] );
+    else if( batch.count > 1 )
+        input_SendEvent( p_input, &(struct vlc_input_event) {
+            .type = INPUT_EVENT_BATCH,
+            .batch = { batch.events, batch.count },
+        });
 }
 
 /**
@@ -728,7 +822,7 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
             if( now >= i_intf_update )
             {
                 MainLoopStatistics( p_input );
-                i_intf_update = now + VLC_TICK_FROM_MS(250);
+                i_intf_update = now + input_priv(p_input)->i_event_interval;
             }
         }
 
@@ -1066,6 +1160,75 @@ static void GetVarSlaves( input_thread_t *p_input,
     *p_slaves = i_slaves;
 }
 
+static void *SubtitlesDetectThread( void *data )
+{
+    input_thread_t *p_input = data;
+    input_item_t *p_item = input_priv(p_input)->p_item;
+    input_item_slave_t **pp_slaves;
+    int i_slaves;
+    TAB_INIT( i_slaves, pp_slaves );
+
+    char *psz_autopath = var_GetNonEmptyString( p_input, "sub-autodetect-path" );
+    char *psz_uri = input_item_GetURI( p_item );
+
+    if( subtitles_Detect( p_input, psz_autopath, psz_uri,
+                          &pp_slaves, &i_slaves ) == VLC_SUCCESS
+     && i_slaves > 0 )
+    {
+        qsort( pp_slaves, i_slaves, sizeof (input_item_slave_t*),
+               SlaveCompare );
+
+        /* The slaves given with the options or the item are already loaded,
+         * add the others as any slave added during the playback */
+        for( int i = 0; i < i_slaves; i++ )
+        {
+            input_item_slave_t *p_slave = pp_slaves[i];
+            if( p_slave == NULL )
+                continue;
+
+            vlc_mutex_lock( &p_item->lock );
+            bool b_exists = SlaveExists( p_item->pp_slaves, p_item->i_slaves,
+                                         p_slave->psz_uri );
+            vlc_mutex_unlock( &p_item->lock );
+
+            if( b_exists ||
+                input_ControlPush( p_input, INPUT_CONTROL_ADD_SLAVE,
+                                   &(input_control_param_t) {
+                                       .val.p_address = p_slave } ) )
+                input_item_slave_Delete( p_slave );
+        }
+    }
+    TAB_CLEAN( i_slaves, pp_slaves );
+    free( psz_uri );
+    free( psz_autopath );
+    return NULL;
+}
+
+/* Scanning the directories can take long on network shares, so that the
+ * detected subtitles are added once the playback started */
+static void SubtitlesDetectStart( input_thread_t *p_input )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+
+    assert( !priv->b_subs_detect );
+    priv->b_subs_detect = !vlc_clone( &priv->subs_detect_thread,
+                                      SubtitlesDetectThread, p_input,
+                                      VLC_THREAD_PRIORITY_LOW );
+    if( !priv->b_subs_detect )
+        msg_Err( p_input, "cannot start the subtitles detection" );
+}
+
+static void SubtitlesDetectStop( input_thread_t *p_input )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+
+    if( priv->b_subs_detect )
+    {
+        vlc_join( priv->subs_detect_thread, NULL );
+        priv->b_subs_detect = false;
+    }
+}
+
 static void LoadSlaves( input_thread_t *p_input )
 {
     input_item_slave_t **pp_slaves;
@@ -1080,7 +1243,6 @@ static void LoadSlaves( input_thread_t *p_input )
         msg_Dbg( p_input, "forced subtitle: %s", psz_subtitle );
         char *psz_uri = input_SubtitleFile2Uri( p_input, psz_subtitle );
         free( psz_subtitle );
-        psz_subtitle = NULL;
         if( psz_uri != NULL )
         {
             input_item_slave_t *p_slave =
@@ -1088,40 +1250,10 @@ static void LoadSlaves( input_thread_t *p_input )
                                       SLAVE_PRIORITY_USER );
             free( psz_uri );
             if( p_slave )
-            {
                 TAB_APPEND(i_slaves, pp_slaves, p_slave);
-                psz_subtitle = p_slave->psz_uri;
-            }
         }
     }
 
-    if( var_GetBool( p_input, "sub-autodetect-file" ) )
-    {
-        /* Add local subtitles */
-        char *psz_autopath = var_GetNonEmptyString( p_input, "sub-autodetect-path" );
-
-        if( subtitles_Detect( p_input, psz_autopath, input_priv(p_input)->p_item->psz_uri,
-                              &pp_slaves, &i_slaves ) == VLC_SUCCESS )
-        {
-            /* check that we did not add the subtitle through sub-file */
-            if( psz_subtitle != NULL )
-            {
-                for( int i = 1; i < i_slaves; i++ )
-                {
-                    input_item_slave_t *p_curr = pp_slaves[i];
-                    if( p_curr != NULL
-                     && !strcmp( psz_subtitle, p_curr->psz_uri ) )
-                    {
-                        /* reject current sub */
-                        input_item_slave_Delete( p_curr );
-                        pp_slaves[i] = NULL;
-                    }
-                }
-            }
-        }
-        free( psz_autopath );
-    }
-
     /* Add slaves from the "input-slave" option */
     GetVarSlaves( p_input, &pp_slaves, &i_slaves );
 
@@ -1169,6 +1301,10 @@ static void LoadSlaves( input_thread_t *p_input )
     }
     TAB_CLEAN( i_slaves, pp_slaves );
 
+    /* Add local subtitles */
+    if( var_GetBool( p_input, "sub-autodetect-file" ) )
+        SubtitlesDetectStart( p_input );
+
     /* Load subtitles from attachments */
     int i_attachment = 0;
     input_attachment_t **pp_attachment = NULL;
@@ -1326,6 +1462,16 @@ static int Init( input_thread_t * p_input )
     if( priv->p_es_out == NULL )
         goto error;
 
+    int64_t i_readahead = var_InheritInteger( p_input, "input-readahead" );
+    if( i_readahead > 0 )
+    {
+        es_out_t *p_readahead =
+            input_EsOutReadAheadNew( p_input, priv->p_es_out,
+                                     VLC_TICK_FROM_MS(i_readahead) );
+        if( p_readahead != NULL )
+            priv->p_es_out = p_readahead;
+    }
+
     /* */
     master = priv->master;
     if( master == NULL )
@@ -1338,6 +1484,18 @@ static int Init( input_thread_t * p_input )
         goto error;
     }
 
+    /* Start from the caching learned by the previous live sessions */
+    if( !priv->b_preparsing && !master->b_can_pace_control &&
+        var_InheritBool( p_input, "adaptive-caching" ) &&
+        var_InheritBool( p_input, "adaptive-caching-profiles" ) )
+    {
+        vlc_tick_t i_caching =
+            input_caching_LoadProfile( VLC_OBJECT(p_input),
+                                       priv->p_item->psz_uri );
+        if( i_caching != VLC_TICK_INVALID )
+            master->i_pts_delay = __MIN( i_caching, INPUT_PTS_DELAY_MAX );
+    }
+
     InitProperties( p_input );
 
     InitTitle( p_input, false );
@@ -1408,6 +1566,8 @@ static int Init( input_thread_t * p_input )
 error:
     input_ChangeState( p_input, ERROR_S, VLC_TICK_INVALID );
 
+    SubtitlesDetectStop( p_input );
+
     if( input_priv(p_input)->p_es_out )
         es_out_Delete( input_priv(p_input)->p_es_out );
     es_out_SetMode( input_priv(p_input)->p_es_out_display, ES_OUT_MODE_END );
@@ -1441,6 +1601,8 @@ static void End( input_thread_t * p_input )
     /* We are at the end */
     input_ChangeState( p_input, END_S, VLC_TICK_INVALID );
 
+    SubtitlesDetectStop( p_input );
+
     /* Stop es out activity */
     es_out_SetMode( priv->p_es_out, ES_OUT_MODE_NONE );
 
@@ -2019,6 +2181,14 @@ static bool Control( input_thread_t *p_input,
                 break;
             }
 
+            /* Seek inside the timeshift buffer first, if any */
+            if( !es_out_SetTimeshiftTime( priv->p_es_out, param.time.i_val,
+                                          absolute ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_Control( priv->p_es_out, ES_OUT_RESET_PCR );
 
@@ -2801,7 +2971,8 @@ static int InputSourceInit( input_source_t *in, input_thread_t *p_input,
     if( demux_Control( in->p_demux, DEMUX_CAN_RECORD, &in->b_can_stream_record ) )
         in->b_can_stream_record = false;
 #ifdef ENABLE_SOUT
-    if( !var_GetBool( p_input, "input-record-native" ) )
+    if( !var_GetBool( p_input, "input-record-native" ) ||
+        var_InheritInteger( p_input, "input-record-preroll" ) > 0 )
         in->b_can_stream_record = false;
 #endif
 
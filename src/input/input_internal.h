@@ -37,6 +37,12 @@
 
 struct input_stats;
 
+/** CPU time accounting of a thread */
+typedef struct input_cpu_clock_t
+{
+    vlc_tick_t last; /**< CPU time of the thread at the last accounting */
+} input_cpu_clock_t;
+
 /*****************************************************************************
  * input defines/constants.
  *****************************************************************************/
@@ -143,6 +149,9 @@ typedef enum input_event_type_e
 
     /* Thumbnail generation */
     INPUT_EVENT_THUMBNAIL_READY,
+
+    /* Several coalesced events, cf. input_SetEventsBatched() */
+    INPUT_EVENT_BATCH,
 } input_event_type_e;
 
 #define VLC_INPUT_CAPABILITIES_SEEKABLE (1<<0)
@@ -301,6 +310,12 @@ struct vlc_input_event
         float subs_fps;
         /* INPUT_EVENT_THUMBNAIL_READY */
         picture_t *thumbnail;
+        /* INPUT_EVENT_BATCH */
+        struct
+        {
+            const struct vlc_input_event *events;
+            size_t count;
+        } batch;
     };
 };
 
@@ -339,6 +354,16 @@ input_thread_t *input_CreateThumbnailer(vlc_object_t *obj,
                                         void *events_data, input_item_t *item)
 VLC_USED;
 
+/**
+ * Enables event batching.
+ *
+ * The times and statistics events of each update period are then coalesced
+ * and sent together as a single INPUT_EVENT_BATCH event, so that the events
+ * callback can process them at once (with a single lock for example). This
+ * must be called before input_Start().
+ */
+void input_SetEventsBatched( input_thread_t *, bool );
+
 int input_Start( input_thread_t * );
 
 void input_Stop( input_thread_t * );
@@ -461,6 +486,13 @@ typedef struct
     input_control_param_t param;
 } input_control_t;
 
+/** Events coalesced by the input thread */
+struct input_event_batch
+{
+    struct vlc_input_event events[2]; /* times and statistics */
+    size_t count;
+};
+
 /** Private input fields */
 typedef struct input_thread_private_t
 {
@@ -468,6 +500,9 @@ typedef struct input_thread_private_t
 
     input_thread_events_cb events_cb;
     void *events_data;
+    bool events_batched;
+    struct input_event_batch *events_batch; /* only set by the input thread */
+    vlc_tick_t  i_event_interval;
 
     /* Global properties */
     bool        b_preparsing;
@@ -518,11 +553,19 @@ typedef struct input_thread_private_t
     input_source_t **slave;
     float          slave_subs_rate;
 
+    /* Subtitles autodetection, run off the input thread */
+    vlc_thread_t   subs_detect_thread;
+    bool           b_subs_detect;
+
     /* Resources */
     input_resource_t *p_resource;
 
     /* Stats counters */
     struct input_stats *stats;
+    input_cpu_clock_t cpu_clock; /**< of the input thread */
+    float cpu_budget; /**< in CPUs, 0 if unlimited */
+    vlc_tick_t cpu_budget_date; /**< of the last degradation change */
+    struct vlc_histogram *demux_metric; /**< demux_Demux() durations */
 
     /* Buffer of pending actions */
     vlc_mutex_t lock_control;
@@ -710,6 +753,11 @@ void input_ConfigVarInit ( input_thread_t * );
 int subtitles_Detect( input_thread_t *, char *, const char *, input_item_slave_t ***, int * );
 int subtitles_Filter( const char *);
 
+/* caching.c */
+vlc_tick_t input_caching_LoadProfile( vlc_object_t *, const char *psz_uri );
+void input_caching_StoreProfile( vlc_object_t *, const char *psz_uri,
+                                 vlc_tick_t i_caching );
+
 /* meta.c */
 void vlc_audio_replay_gain_MergeFromMeta( audio_replay_gain_t *p_dst,
                                           const vlc_meta_t *p_meta );
@@ -727,6 +775,14 @@ typedef struct input_rate_t
     } samples[2];
 } input_rate_t;
 
+/** Degradation levels when the CPU budget of an input is exceeded */
+enum input_cpu_degradation
+{
+    INPUT_CPU_NORMAL,
+    INPUT_CPU_SKIP_B_FRAMES, /**< drop the disposable video frames */
+    INPUT_CPU_KEYFRAMES_ONLY, /**< only decode the video key frames */
+};
+
 struct input_stats {
     input_rate_t input_bitrate;
     input_rate_t demux_bitrate;
@@ -739,6 +795,9 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+    atomic_uintmax_t missed_vsyncs;
+    input_rate_t cpu_time;
+    atomic_int cpu_degradation;
 };
 
 struct input_stats *input_stats_Create(void);
@@ -746,4 +805,18 @@ void input_stats_Destroy(struct input_stats *);
 void input_rate_Add(input_rate_t *, uintmax_t);
 void input_stats_Compute(struct input_stats *, input_stats_t*);
 
+/**
+ * Starts the CPU time accounting of the calling thread.
+ */
+void input_cpu_Start(input_cpu_clock_t *);
+
+/**
+ * Gets the CPU time used by the calling thread since the start or the
+ * previous call.
+ *
+ * 
+eturn the CPU time, or 0 if thread CPU clocks are not supported
+ */
+vlc_tick_t input_cpu_Elapsed(input_cpu_clock_t *);
+
 #endif
@@ -1373,8 +1373,8 @@ input_item_parser_InputEvent(input_thread_t *input,
 }
 
 input_item_parser_id_t *
-input_item_Parse(input_item_t *item, vlc_object_t *obj,
-                 const input_item_parser_cbs_t *cbs, void *userdata)
+input_item_ParseDemux(input_item_t *item, vlc_object_t *obj, const char *demux,
+                      const input_item_parser_cbs_t *cbs, void *userdata)
 {
     assert(cbs && cbs->on_ended);
     input_item_parser_id_t *parser = malloc(sizeof(*parser));
@@ -1386,16 +1386,35 @@ input_item_Parse(input_item_t *item, vlc_object_t *obj,
     parser->userdata = userdata;
     parser->input = input_CreatePreparser(obj, input_item_parser_InputEvent,
                                           parser, item);
-    if (!parser->input || input_Start(parser->input))
+    if (!parser->input)
+    {
+        free(parser);
+        return NULL;
+    }
+
+    if (demux != NULL)
+    {
+        /* Overrides the "demux" option inherited from the parent */
+        var_Create(parser->input, "demux", VLC_VAR_STRING);
+        var_SetString(parser->input, "demux", demux);
+    }
+
+    if (input_Start(parser->input))
     {
-        if (parser->input)
-            input_Close(parser->input);
+        input_Close(parser->input);
         free(parser);
         return NULL;
     }
     return parser;
 }
 
+input_item_parser_id_t *
+input_item_Parse(input_item_t *item, vlc_object_t *obj,
+                 const input_item_parser_cbs_t *cbs, void *userdata)
+{
+    return input_item_ParseDemux(item, obj, NULL, cbs, userdata);
+}
+
 void
 input_item_parser_id_Interrupt(input_item_parser_id_t *parser)
 {
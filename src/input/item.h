@@ -30,6 +30,17 @@ void input_item_SetErrorWhenReading( input_item_t *p_i, bool b_error );
 void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt );
 bool input_item_ShouldPreparseSubItems( input_item_t *p_i );
 
+/**
+ * Parse an item with the given demux module list (see input_item_Parse())
+ *
+ * \param demux demux module list to use instead of the "demux" option, or
+ *              NULL
+ */
+input_item_parser_id_t *
+input_item_ParseDemux( input_item_t *item, vlc_object_t *obj,
+                       const char *demux, const input_item_parser_cbs_t *cbs,
+                       void *userdata );
+
 typedef struct input_item_owner
 {
     input_item_t item;
@@ -42,6 +42,7 @@
 #include "../video_output/vout_internal.h"
 #include "input_interface.h"
 #include "event.h"
+#include "decoder.h"
 #include "resource.h"
 
 struct vout_resource
@@ -53,6 +54,13 @@ struct vout_resource
     struct vlc_list node;
 };
 
+struct decoder_resource
+{
+    vlc_input_decoder_t *decoder;
+
+    struct vlc_list node;
+};
+
 struct input_resource_t
 {
     vlc_atomic_rc_t rc;
@@ -83,6 +91,10 @@ struct input_resource_t
 
     bool            b_aout_busy;
     audio_output_t *p_aout;
+
+    /* Idle decoders, the oldest first */
+    struct vlc_list decoders;
+    size_t          decoder_count;
 };
 
 #define resource_GetFirstVoutRsc(resource) \
@@ -287,6 +299,19 @@ void input_resource_ResetAout( input_resource_t *p_resource )
         aout_Destroy( p_aout );
 }
 
+static void DestroyDecoders( input_resource_t *p_resource )
+{
+    struct decoder_resource *dec_rsc;
+
+    vlc_list_foreach( dec_rsc, &p_resource->decoders, node )
+    {
+        vlc_list_remove( &dec_rsc->node );
+        vlc_input_decoder_DeleteIdle( dec_rsc->decoder );
+        free( dec_rsc );
+    }
+    p_resource->decoder_count = 0;
+}
+
 /* Common */
 input_resource_t *input_resource_New( vlc_object_t *p_parent )
 {
@@ -302,6 +327,7 @@ input_resource_t *input_resource_New( vlc_object_t *p_parent )
     }
 
     vlc_list_init( &p_resource->vout_rscs );
+    vlc_list_init( &p_resource->decoders );
 
     vlc_atomic_rc_init( &p_resource->rc );
     p_resource->p_parent = p_parent;
@@ -315,6 +341,8 @@ void input_resource_Release( input_resource_t *p_resource )
     if( !vlc_atomic_rc_dec( &p_resource->rc ) )
         return;
 
+    /* Idle decoders may still reference the vout decoder device */
+    DestroyDecoders( p_resource );
     DestroySout( p_resource );
     DestroyVout( p_resource );
     if( p_resource->p_aout != NULL )
@@ -354,13 +382,19 @@ static void input_resource_PutVoutLocked(input_resource_t *p_resource,
     if (has_stopped != NULL)
         *has_stopped = vout_rsc->started;
 
+    const bool saved = vout_rsc == resource_GetFirstVoutRsc(p_resource);
+
     if (vout_rsc->started)
     {
-        vout_StopDisplay(vout_rsc->vout);
+        /* The display of the saved vout can be reused by the next input */
+        if (saved)
+            vout_StopInput(vout_rsc->vout);
+        else
+            vout_StopDisplay(vout_rsc->vout);
         vout_rsc->started = false;
     }
 
-    if (vout_rsc == resource_GetFirstVoutRsc(p_resource))
+    if (saved)
     {
         assert(p_resource->vout_rsc_free == NULL || p_resource->vout_rsc_free == vout_rsc);
 
@@ -572,6 +606,57 @@ void input_resource_StopFreeVout(input_resource_t *p_resource)
     vlc_mutex_unlock(&p_resource->lock);
 }
 
+vlc_input_decoder_t *input_resource_PutDecoder( input_resource_t *p_resource,
+                                                vlc_input_decoder_t *decoder,
+                                                size_t max )
+{
+    struct decoder_resource *dec_rsc = malloc( sizeof(*dec_rsc) );
+    if( unlikely(dec_rsc == NULL) )
+        return decoder;
+    dec_rsc->decoder = decoder;
+
+    vlc_input_decoder_t *evicted = NULL;
+
+    vlc_mutex_lock( &p_resource->lock );
+    vlc_list_append( &dec_rsc->node, &p_resource->decoders );
+    if( ++p_resource->decoder_count > max )
+    {
+        dec_rsc = vlc_list_first_entry_or_null( &p_resource->decoders,
+                                                struct decoder_resource, node );
+        vlc_list_remove( &dec_rsc->node );
+        p_resource->decoder_count--;
+        evicted = dec_rsc->decoder;
+        free( dec_rsc );
+    }
+    vlc_mutex_unlock( &p_resource->lock );
+
+    return evicted;
+}
+
+vlc_input_decoder_t *input_resource_GetDecoder( input_resource_t *p_resource,
+            bool (*match)( vlc_input_decoder_t *, const void * ),
+            const void *opaque )
+{
+    vlc_input_decoder_t *decoder = NULL;
+    struct decoder_resource *dec_rsc;
+
+    vlc_mutex_lock( &p_resource->lock );
+    vlc_list_foreach( dec_rsc, &p_resource->decoders, node )
+    {
+        if( match( dec_rsc->decoder, opaque ) )
+        {
+            vlc_list_remove( &dec_rsc->node );
+            p_resource->decoder_count--;
+            decoder = dec_rsc->decoder;
+            free( dec_rsc );
+            break;
+        }
+    }
+    vlc_mutex_unlock( &p_resource->lock );
+
+    return decoder;
+}
+
 /* */
 sout_stream_t *input_resource_RequestSout( input_resource_t *p_resource, const char *psz_sout )
 {
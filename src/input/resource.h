@@ -25,6 +25,7 @@
 
 #include <vlc_common.h>
 #include <vlc_mouse.h>
+#include <vlc_decoder.h>
 #include "../video_output/vout_internal.h"
 
 /**
@@ -65,6 +66,25 @@ void input_resource_HoldVouts( input_resource_t *, vout_thread_t ***, size_t * )
 
 void input_resource_StopFreeVout( input_resource_t * );
 
+/**
+ * This function keeps an idle decoder for a future input.
+ *
+ * The resource takes the ownership of the decoder. If more than max decoders
+ * are kept, the oldest one is returned and must be deleted by the caller.
+ */
+vlc_input_decoder_t *input_resource_PutDecoder( input_resource_t *,
+                                                vlc_input_decoder_t *,
+                                                size_t max );
+
+/**
+ * This function returns the first idle decoder accepted by match(), if any.
+ *
+ * The caller takes the ownership of the decoder.
+ */
+vlc_input_decoder_t *input_resource_GetDecoder( input_resource_t *,
+            bool (*match)( vlc_input_decoder_t *, const void * ),
+            const void *opaque );
+
 /**
  * This function holds the input_resource_t itself
  */
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <vlc_common.h>
 #include "input/input_internal.h"
@@ -68,6 +69,9 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    atomic_init(&stats->missed_vsyncs, 0);
+    input_rate_Init(&stats->cpu_time);
+    atomic_init(&stats->cpu_degradation, INPUT_CPU_NORMAL);
     return stats;
 }
 
@@ -111,6 +115,58 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+    st->i_missed_vsyncs = atomic_load_explicit(&stats->missed_vsyncs,
+                                               memory_order_relaxed);
+
+    /* CPU */
+    vlc_mutex_lock(&stats->cpu_time.lock);
+    st->i_cpu_time = stats->cpu_time.value;
+    st->f_cpu_usage = stats_GetRate(&stats->cpu_time);
+    vlc_mutex_unlock(&stats->cpu_time.lock);
+    st->i_cpu_degradation = atomic_load_explicit(&stats->cpu_degradation,
+                                                 memory_order_relaxed);
+}
+
+static vlc_tick_t input_cpu_Now(void)
+{
+#if defined (_WIN32)
+    FILETIME creation, exit, kernel, user;
+
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return VLC_TICK_INVALID;
+
+    ULARGE_INTEGER k = { .LowPart = kernel.dwLowDateTime,
+                         .HighPart = kernel.dwHighDateTime };
+    ULARGE_INTEGER u = { .LowPart = user.dwLowDateTime,
+                         .HighPart = user.dwHighDateTime };
+    return VLC_TICK_FROM_MSFTIME(k.QuadPart + u.QuadPart);
+#elif defined (CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return VLC_TICK_INVALID;
+    return vlc_tick_from_timespec(&ts);
+#else
+    return VLC_TICK_INVALID;
+#endif
+}
+
+void input_cpu_Start(input_cpu_clock_t *clock)
+{
+    clock->last = input_cpu_Now();
+}
+
+vlc_tick_t input_cpu_Elapsed(input_cpu_clock_t *clock)
+{
+    vlc_tick_t now = input_cpu_Now();
+
+    if (now == VLC_TICK_INVALID)
+        return 0;
+
+    vlc_tick_t elapsed = (clock->last != VLC_TICK_INVALID) ? now - clock->last
+                                                           : 0;
+    clock->last = now;
+    return elapsed;
 }
 
 /** Update a counter element with new values
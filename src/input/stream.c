@@ -37,12 +37,18 @@
 #include <vlc_access.h>
 #include <vlc_charset.h>
 #include <vlc_interrupt.h>
+#include <vlc_mirror.h>
 #include <vlc_stream_extractor.h>
 
 #include <libvlc.h>
 #include "stream.h"
 #include "mrl_helpers.h"
 
+/* Largest peek served from the peek window of byte streams */
+#define STREAM_RING_SIZE (1 << 20)
+/* Minimum read size when filling the peek window */
+#define STREAM_RING_READ (1 << 15)
+
 typedef struct stream_priv_t
 {
     stream_t stream;
@@ -52,6 +58,14 @@ typedef struct stream_priv_t
     uint64_t offset;
     bool eof;
 
+    /* Peek window of byte streams, in a mirrored buffer */
+    struct {
+        uint8_t *buf;
+        size_t head;
+        size_t used;
+        bool failed;
+    } ring;
+
     /* UTF-16 and UTF-32 file reading */
     struct {
         vlc_iconv_t   conv;
@@ -91,6 +105,10 @@ stream_t *vlc_stream_CustomNew(vlc_object_t *parent,
     priv->peek = NULL;
     priv->offset = 0;
     priv->eof = false;
+    priv->ring.buf = NULL;
+    priv->ring.head = 0;
+    priv->ring.used = 0;
+    priv->ring.failed = false;
 
     /* UTF16 and UTF32 text file conversion */
     priv->text.conv = (vlc_iconv_t)(-1);
@@ -122,6 +140,8 @@ void stream_CommonDelete(stream_t *s)
         block_Release(priv->peek);
     if (priv->block != NULL)
         block_Release(priv->block);
+    if (priv->ring.buf != NULL)
+        vlc_mirror_Free(priv->ring.buf, STREAM_RING_SIZE);
 
     free(s->psz_url);
     vlc_object_delete(s);
@@ -416,6 +436,19 @@ static ssize_t vlc_stream_CopyBlock(block_t **restrict pp,
     return likely(len > 0) ? (ssize_t)len : -1;
 }
 
+static void vlc_stream_RingConsume(stream_priv_t *priv, size_t len)
+{
+    assert(len <= priv->ring.used);
+    priv->ring.head = (priv->ring.head + len) % STREAM_RING_SIZE;
+    priv->ring.used -= len;
+}
+
+static void vlc_stream_RingReset(stream_priv_t *priv)
+{
+    priv->ring.head = 0;
+    priv->ring.used = 0;
+}
+
 static ssize_t vlc_stream_ReadRaw(stream_t *s, void *buf, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
@@ -473,6 +506,17 @@ ssize_t vlc_stream_ReadPartial(stream_t *s, void *buf, size_t len)
         return ret;
     }
 
+    if (priv->ring.used > 0)
+    {
+        size_t copy = __MIN(len, priv->ring.used);
+
+        if (buf != NULL)
+            memcpy(buf, priv->ring.buf + priv->ring.head, copy);
+        vlc_stream_RingConsume(priv, copy);
+        priv->offset += copy;
+        return copy;
+    }
+
     ret = vlc_stream_ReadRaw(s, buf, len);
     if (ret > 0)
         priv->offset += ret;
@@ -504,17 +548,83 @@ ssize_t vlc_stream_Read(stream_t *s, void *buf, size_t len)
     return copied;
 }
 
+/**
+ * Peeks from the mirrored window: the peeked data is always contiguous with
+ * the data behind it, so that growing a peek never moves the data.
+ */
+static ssize_t vlc_stream_RingPeek(stream_t *s, const uint8_t **restrict bufp,
+                                   size_t len)
+{
+    stream_priv_t *priv = (stream_priv_t *)s;
+
+    while (priv->ring.used < len)
+    {
+        size_t avail = STREAM_RING_SIZE - priv->ring.used;
+        size_t tail = (priv->ring.head + priv->ring.used) % STREAM_RING_SIZE;
+        ssize_t ret;
+
+        ret = vlc_stream_ReadRaw(s, priv->ring.buf + tail,
+                                 __MIN(avail, __MAX(len - priv->ring.used,
+                                                    STREAM_RING_READ)));
+        if (ret < 0)
+            continue;
+        if (ret == 0)
+            break;
+
+        priv->ring.used += ret;
+    }
+
+    *bufp = priv->ring.buf + priv->ring.head;
+    return __MIN(len, priv->ring.used);
+}
+
 ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
     block_t *peek;
 
+    if (s->pf_read != NULL && priv->peek == NULL)
+    {
+        if (priv->ring.buf == NULL && !priv->ring.failed)
+        {
+            priv->ring.buf = vlc_mirror_Alloc(STREAM_RING_SIZE);
+            priv->ring.failed = priv->ring.buf == NULL;
+        }
+
+        if (priv->ring.buf != NULL)
+        {
+            if (len <= STREAM_RING_SIZE)
+                return vlc_stream_RingPeek(s, bufp, len);
+
+            if (priv->ring.used > 0)
+            {   /* Too large for the window: move the data to a block */
+                peek = block_Alloc(len);
+                if (unlikely(peek == NULL))
+                    return VLC_ENOMEM;
+
+                memcpy(peek->p_buffer, priv->ring.buf + priv->ring.head,
+                       priv->ring.used);
+                peek->i_buffer = priv->ring.used;
+                vlc_stream_RingReset(priv);
+                priv->peek = peek;
+            }
+        }
+    }
+
     peek = priv->peek;
     if (peek == NULL)
     {
         peek = priv->block;
-        priv->peek = peek;
         priv->block = NULL;
+
+        if (peek == NULL && s->pf_block != NULL)
+        {   /* Peek directly into the next block, usually without copying */
+            bool eof = false;
+
+            while (peek == NULL && !eof && !vlc_killed())
+                peek = s->pf_block(s, &eof);
+        }
+        priv->peek = peek;
     }
 
     if (peek == NULL)
@@ -558,6 +668,43 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
     return len;
 }
 
+/* Size of the content identifying a stream, see stream_ContentSignature() */
+#define STREAM_SIGNATURE_SIZE 4096
+
+uint64_t stream_ContentSignature(stream_t *s)
+{
+    uint64_t size;
+    bool can_seek;
+
+    /* Live contents are not expected to be opened again */
+    if (s->psz_url == NULL || vlc_stream_Tell(s) != 0
+     || vlc_stream_Control(s, STREAM_CAN_SEEK, &can_seek) || !can_seek
+     || vlc_stream_GetSize(s, &size))
+        return 0;
+
+    const uint8_t *peek;
+    ssize_t len = vlc_stream_Peek(s, &peek, STREAM_SIGNATURE_SIZE);
+    /* A short peek (interrupted or slow source) does not identify the
+     * content, and the probes would see a short peek as well */
+    if (len <= 0
+     || ((size_t)len < STREAM_SIGNATURE_SIZE && (uint64_t)len < size))
+        return 0;
+
+    /* FNV-1a of the URL, the size and the first bytes */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    uint8_t buf[8];
+
+    for (const char *c = s->psz_url; *c != '\0'; c++)
+        hash = (hash ^ (uint8_t)*c) * UINT64_C(0x100000001b3);
+    SetQWLE(buf, size);
+    for (size_t i = 0; i < sizeof (buf); i++)
+        hash = (hash ^ buf[i]) * UINT64_C(0x100000001b3);
+    for (ssize_t i = 0; i < len; i++)
+        hash = (hash ^ peek[i]) * UINT64_C(0x100000001b3);
+
+    return hash ? hash : 1; /* 0 means unknown */
+}
+
 block_t *vlc_stream_ReadBlock(stream_t *s)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
@@ -579,6 +726,16 @@ block_t *vlc_stream_ReadBlock(stream_t *s)
         block = priv->block;
         priv->block = NULL;
     }
+    else if (priv->ring.used > 0)
+    {
+        block = block_Alloc(priv->ring.used);
+        if (unlikely(block == NULL))
+            return NULL;
+
+        memcpy(block->p_buffer, priv->ring.buf + priv->ring.head,
+               priv->ring.used);
+        vlc_stream_RingReset(priv);
+    }
     else if (s->pf_block != NULL)
     {
         priv->eof = false;
@@ -653,6 +810,26 @@ int vlc_stream_Seek(stream_t *s, uint64_t offset)
     {
         if (priv->offset == offset)
             return VLC_SUCCESS; /* Nothing to do! */
+
+        if (offset > priv->offset
+         && offset - priv->offset <= priv->ring.used)
+        {   /* Seeking within the peek window */
+            vlc_stream_RingConsume(priv, offset - priv->offset);
+            priv->offset = offset;
+            return VLC_SUCCESS;
+        }
+
+        block_t *block = priv->block;
+        if (block != NULL && offset > priv->offset
+         && offset < priv->offset + block->i_buffer)
+        {   /* Seeking forward within the current block */
+            size_t fwd = offset - priv->offset;
+
+            block->p_buffer += fwd;
+            block->i_buffer -= fwd;
+            priv->offset = offset;
+            return VLC_SUCCESS;
+        }
     }
 
     if (s->pf_seek == NULL)
@@ -676,6 +853,7 @@ int vlc_stream_Seek(stream_t *s, uint64_t offset)
         priv->block = NULL;
     }
 
+    vlc_stream_RingReset(priv);
     return VLC_SUCCESS;
 }
 
@@ -711,6 +889,7 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
                 priv->block = NULL;
             }
 
+            vlc_stream_RingReset(priv);
             return VLC_SUCCESS;
         }
     }
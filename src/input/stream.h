@@ -36,6 +36,16 @@ void *vlc_stream_Private(stream_t *stream);
 /* */
 void stream_CommonDelete( stream_t *s );
 
+/**
+ * Identifies the content of a stream for the module probing.
+ *
+ * The signature covers the URL, the size and the first bytes of the stream.
+ *
+ * \return a non-zero signature, or 0 if the stream cannot be identified
+ * (it is not at its start, or it is not seekable or has no known size)
+ */
+uint64_t stream_ContentSignature( stream_t *s );
+
 stream_t *vlc_stream_AttachmentNew(vlc_object_t *p_this,
                                    input_attachment_t *attachement);
 
@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include "stream.h"
+#include "modules/modules.h"
 
 struct vlc_stream_filter_private
 {
@@ -78,7 +79,12 @@ stream_t *vlc_stream_FilterNew( stream_t *p_source,
     s->s = p_source;
 
     /* */
-    priv->module = module_need(s, "stream_filter", psz_stream_filter, true);
+    /* Automatic filters skip the ones which already rejected the content */
+    uint64_t signature = psz_stream_filter == NULL
+                       ? stream_ContentSignature(p_source) : 0;
+
+    priv->module = module_need_content(VLC_OBJECT(s), "stream_filter",
+                                       psz_stream_filter, true, signature);
     if (priv->module == NULL)
         goto error;
 
@@ -37,6 +37,7 @@
 #include <vlc_common.h>
 #include <vlc_fs.h>
 #include <vlc_url.h>
+#include <vlc_vector.h>
 
 #include "input_internal.h"
 
@@ -156,6 +157,130 @@ int subtitles_Filter( const char *psz_dir_content )
 }
 
 
+/**
+ * Cache of the subtitle files found in the recently scanned directories,
+ * so that playing through a directory does not list it again for each item.
+ * Entries are checked against the directory modification time.
+ */
+#define SUBS_DIR_CACHE_SIZE 16
+
+typedef struct VLC_VECTOR(char *) subs_names_t;
+
+static struct subs_dir_cache
+{
+    char *psz_dir;
+    time_t i_mtime;
+    subs_names_t names;
+} subs_dir_cache[SUBS_DIR_CACHE_SIZE];
+static unsigned subs_dir_cache_next;
+static vlc_mutex_t subs_dir_cache_lock = VLC_STATIC_MUTEX;
+
+static void names_clean( subs_names_t *p_names )
+{
+    char *psz_name;
+    vlc_vector_foreach( psz_name, p_names )
+        free( psz_name );
+    vlc_vector_destroy( p_names );
+}
+
+static bool names_copy( subs_names_t *p_dst, const subs_names_t *p_src )
+{
+    vlc_vector_init( p_dst );
+    if( !vlc_vector_reserve( p_dst, p_src->size ) )
+        return false;
+    for( size_t i = 0; i < p_src->size; i++ )
+    {
+        char *psz_name = strdup( p_src->data[i] );
+        if( !psz_name || !vlc_vector_push( p_dst, psz_name ) )
+        {
+            free( psz_name );
+            names_clean( p_dst );
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * List the subtitle files of a directory, from the cache if it is unchanged
+ */
+static int subtitles_ListDir( const char *psz_dir, subs_names_t *p_names )
+{
+    struct stat st;
+    if( vlc_stat( psz_dir, &st ) || !S_ISDIR( st.st_mode ) )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &subs_dir_cache_lock );
+    for( unsigned i = 0; i < SUBS_DIR_CACHE_SIZE; i++ )
+    {
+        struct subs_dir_cache *p_entry = &subs_dir_cache[i];
+        if( p_entry->psz_dir && p_entry->i_mtime == st.st_mtime &&
+            !strcmp( p_entry->psz_dir, psz_dir ) )
+        {
+            bool b_ok = names_copy( p_names, &p_entry->names );
+            vlc_mutex_unlock( &subs_dir_cache_lock );
+            return b_ok ? VLC_SUCCESS : VLC_ENOMEM;
+        }
+    }
+    vlc_mutex_unlock( &subs_dir_cache_lock );
+
+    DIR *dir = vlc_opendir( psz_dir );
+    if( dir == NULL )
+        return VLC_EGENERIC;
+
+    vlc_vector_init( p_names );
+    const char *psz_name;
+    while( (psz_name = vlc_readdir( dir )) )
+    {
+        if( psz_name[0] == '.' || !subtitles_Filter( psz_name ) )
+            continue;
+
+        char *psz_dup = strdup( psz_name );
+        if( !psz_dup || !vlc_vector_push( p_names, psz_dup ) )
+        {
+            free( psz_dup );
+            break;
+        }
+    }
+    closedir( dir );
+
+    /* Replace the entry of this directory, or the oldest one */
+    subs_names_t copy;
+    if( !names_copy( &copy, p_names ) )
+        return VLC_SUCCESS;
+
+    vlc_mutex_lock( &subs_dir_cache_lock );
+    struct subs_dir_cache *p_entry = NULL;
+    for( unsigned i = 0; i < SUBS_DIR_CACHE_SIZE && !p_entry; i++ )
+        if( subs_dir_cache[i].psz_dir &&
+            !strcmp( subs_dir_cache[i].psz_dir, psz_dir ) )
+            p_entry = &subs_dir_cache[i];
+    if( !p_entry )
+    {
+        p_entry = &subs_dir_cache[subs_dir_cache_next];
+        subs_dir_cache_next = (subs_dir_cache_next + 1) % SUBS_DIR_CACHE_SIZE;
+        if( p_entry->psz_dir )
+        {
+            free( p_entry->psz_dir );
+            names_clean( &p_entry->names );
+        }
+        p_entry->psz_dir = strdup( psz_dir );
+    }
+    else
+        names_clean( &p_entry->names );
+
+    if( p_entry->psz_dir )
+    {
+        p_entry->i_mtime = st.st_mtime;
+        p_entry->names = copy;
+    }
+    else
+        names_clean( &copy );
+    vlc_mutex_unlock( &subs_dir_cache_lock );
+
+    return VLC_SUCCESS;
+}
+
 /**
  * Convert a list of paths separated by ',' to a char**
  */
@@ -263,18 +388,15 @@ int subtitles_Detect( input_thread_t *p_this, char *psz_path, const char *psz_na
             continue;
 
         /* parse psz_src dir */
-        DIR *dir = vlc_opendir( psz_dir );
-        if( dir == NULL )
+        subs_names_t names;
+        if( subtitles_ListDir( psz_dir, &names ) != VLC_SUCCESS )
             continue;
 
         msg_Dbg( p_this, "looking for a subtitle file in %s", psz_dir );
 
         const char *psz_name;
-        while( (psz_name = vlc_readdir( dir )) )
+        vlc_vector_foreach( psz_name, &names )
         {
-            if( psz_name[0] == '.' || !subtitles_Filter( psz_name ) )
-                continue;
-
             char *tmp_fname = strdup(psz_name);
             if (!tmp_fname)
                 break;
@@ -353,7 +475,7 @@ int subtitles_Detect( input_thread_t *p_this, char *psz_path, const char *psz_na
                 free( path );
             }
         }
-        closedir( dir );
+        names_clean( &names );
     }
     if( subdirs )
     {
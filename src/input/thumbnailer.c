@@ -26,7 +26,17 @@
 
 #include <vlc_thumbnailer.h>
 #include <vlc_executor.h>
+#include <vlc_codec.h>
+#include <vlc_es_out.h>
+#include <vlc_image.h>
+#include <vlc_interrupt.h>
+#include <vlc_modules.h>
+#include <vlc_stream_extractor.h>
 #include "input_internal.h"
+#include "demux.h"
+
+/* Number of demux calls without any video track before giving up */
+#define THUMBNAILER_MAX_DEMUX_WITHOUT_VIDEO 100
 
 struct vlc_thumbnailer_t
 {
@@ -59,49 +69,81 @@ struct vlc_thumbnailer_request_t
 {
     vlc_thumbnailer_t *thumbnailer;
 
-    struct seek_target seek_target;
     bool fast_seek;
     input_item_t *item;
     /**
-     * A positive value will be used as the timeout duration
+     * A positive value will be used as the timeout duration of each
+     * thumbnail
      * VLC_TICK_INVALID means no timeout
      */
     vlc_tick_t timeout;
-    vlc_thumbnailer_cb cb;
+    /* Bounding box of the thumbnails, 0 to keep the source dimension */
+    unsigned width;
+    unsigned height;
+    vlc_thumbnailer_cb cb; /**< for single requests */
+    vlc_thumbnailer_batch_cb batch_cb; /**< for batch requests */
     void* userdata;
 
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
     bool ended;
+    bool canceled;
     picture_t *pic;
 
+    /* Interrupts the blocking calls of the direct demuxer path */
+    vlc_interrupt_t *interrupt;
+
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
     struct vlc_list node; /**< node of vlc_thumbnailer_t.submitted_tasks */
+
+    size_t target_count;
+    struct seek_target seek_targets[];
 };
 
 static void RunnableRun(void *);
 
 static task_t *
 TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
-        struct seek_target seek_target, bool fast_seek,
-        vlc_thumbnailer_cb cb, void *userdata, vlc_tick_t timeout)
+        const struct seek_target seek_targets[], size_t target_count,
+        bool fast_seek, unsigned width, unsigned height,
+        vlc_thumbnailer_cb cb, vlc_thumbnailer_batch_cb batch_cb,
+        void *userdata, vlc_tick_t timeout)
 {
-    task_t *task = malloc(sizeof(*task));
+    if (target_count == 0 ||
+        target_count > (SIZE_MAX - sizeof(task_t)) / sizeof(seek_targets[0]))
+        return NULL;
+
+    task_t *task = malloc(sizeof(*task)
+                          + target_count * sizeof(seek_targets[0]));
     if (!task)
         return NULL;
 
+    task->interrupt = vlc_interrupt_create();
+    if (!task->interrupt)
+    {
+        free(task);
+        return NULL;
+    }
+
     task->thumbnailer = thumbnailer;
     task->item = item;
-    task->seek_target = seek_target;
     task->fast_seek = fast_seek;
+    task->width = width;
+    task->height = height;
     task->cb = cb;
+    task->batch_cb = batch_cb;
     task->userdata = userdata;
     task->timeout = timeout;
 
+    task->target_count = target_count;
+    memcpy(task->seek_targets, seek_targets,
+           target_count * sizeof(seek_targets[0]));
+
     vlc_mutex_init(&task->lock);
     vlc_cond_init(&task->cond_ended);
     task->ended = false;
+    task->canceled = false;
     task->pic = NULL;
 
     task->runnable.run = RunnableRun;
@@ -115,10 +157,20 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
 static void
 TaskDelete(task_t *task)
 {
+    vlc_interrupt_destroy(task->interrupt);
     input_item_Release(task->item);
     free(task);
 }
 
+static bool
+TaskIsCanceled(task_t *task)
+{
+    vlc_mutex_lock(&task->lock);
+    bool canceled = task->canceled;
+    vlc_mutex_unlock(&task->lock);
+    return canceled;
+}
+
 static void
 ThumbnailerAddTask(vlc_thumbnailer_t *thumbnailer, task_t *task)
 {
@@ -135,14 +187,556 @@ ThumbnailerRemoveTask(vlc_thumbnailer_t *thumbnailer, task_t *task)
     vlc_mutex_unlock(&thumbnailer->lock);
 }
 
-static void NotifyThumbnail(task_t *task, picture_t *pic)
+static void NotifyThumbnail(task_t *task, size_t index, picture_t *pic)
 {
-    assert(task->cb);
-    task->cb(task->userdata, pic);
+    if (task->batch_cb)
+        task->batch_cb(task->userdata, index, pic);
+    else
+    {
+        assert(task->cb);
+        assert(index == 0);
+        task->cb(task->userdata, pic);
+    }
     if (pic)
         picture_Release(pic);
 }
 
+static picture_t *
+ScaleThumbnail(task_t *task, image_handler_t **scaler, picture_t *pic)
+{
+    if (task->width == 0 && task->height == 0)
+        return pic;
+
+    const video_format_t *fmt = &pic->format;
+    if (fmt->i_visible_width == 0 || fmt->i_visible_height == 0)
+        return pic;
+
+    uint64_t width = fmt->i_visible_width;
+    uint64_t height = fmt->i_visible_height;
+    if (fmt->i_sar_num && fmt->i_sar_den)
+        width = width * fmt->i_sar_num / fmt->i_sar_den;
+
+    /* Fit the display size in the requested box, but never upscale */
+    bool scale = false;
+    if (task->width && width > task->width)
+    {
+        height = height * task->width / width;
+        width = task->width;
+        scale = true;
+    }
+    if (task->height && height > task->height)
+    {
+        width = width * task->height / height;
+        height = task->height;
+        scale = true;
+    }
+    if (!scale)
+        return pic;
+
+    image_handler_t *handler = *scaler;
+    if (handler == NULL)
+    {
+        handler = *scaler = image_HandlerCreate(task->thumbnailer->parent);
+        if (handler == NULL)
+            return pic;
+    }
+
+    video_format_t fmt_out;
+    video_format_Init(&fmt_out, fmt->i_chroma);
+    fmt_out.i_width = fmt_out.i_visible_width = __MAX(width, 1);
+    fmt_out.i_height = fmt_out.i_visible_height = __MAX(height, 1);
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    picture_t *scaled = image_Convert(handler, pic, fmt, &fmt_out);
+    video_format_Clean(&fmt_out);
+    if (scaled == NULL)
+    {
+        msg_Warn(task->thumbnailer->parent, "cannot scale the thumbnail");
+        return pic;
+    }
+
+    picture_Release(pic);
+    return scaled;
+}
+
+/*
+ * Direct demuxer path
+ *
+ * For local files, the thumbnails are generated synchronously, on the
+ * executor thread, without spawning an input thread: the demuxer is opened
+ * directly, and only the first video track is packetized and decoded, up to
+ * the first picture after each seek target.
+ */
+
+struct thumbnailer_decoder
+{
+    decoder_t dec;
+    decoder_t *packetizer;
+    struct thumbnailer_es_out *out;
+};
+
+struct es_out_id_t
+{
+    es_out_id_t *next;
+    struct thumbnailer_decoder *decoder; /**< NULL if the track is ignored */
+};
+
+struct thumbnailer_es_out
+{
+    es_out_t out;
+    vlc_object_t *parent;
+    bool skip_loop_filter;
+
+    es_out_id_t *ids;
+    es_out_id_t *video; /**< the only decoded track, if any */
+
+    vlc_tick_t preroll_end;
+    picture_t *pic;
+};
+
+static vlc_decoder_device *
+DecoderGetDevice(decoder_t *dec)
+{
+    (void) dec;
+    /* Thumbnails are decoded in software */
+    return NULL;
+}
+
+static void
+DecoderQueueVideo(decoder_t *dec, picture_t *pic)
+{
+    struct thumbnailer_decoder *owner =
+        container_of(dec, struct thumbnailer_decoder, dec);
+    struct thumbnailer_es_out *out = owner->out;
+
+    /* Keep the first picture displayed after the seek target */
+    if (out->pic == NULL && (out->preroll_end == VLC_TICK_INVALID ||
+                             pic->date == VLC_TICK_INVALID ||
+                             pic->date >= out->preroll_end))
+        out->pic = pic;
+    else
+        picture_Release(pic);
+}
+
+static void
+DecoderQueueCc(decoder_t *dec, block_t *block, const decoder_cc_desc_t *desc)
+{
+    (void) dec; (void) desc;
+    block_Release(block);
+}
+
+static int
+DecoderLoad(decoder_t *dec, bool is_packetizer, const es_format_t *fmt,
+            bool skip_loop_filter)
+{
+    decoder_Init(dec, fmt);
+
+    dec->b_frame_drop_allowed = true;
+
+    if (is_packetizer)
+        dec->p_module = module_need(dec, "packetizer", NULL, false);
+    else
+    {
+        if (skip_loop_filter)
+        {
+            /* The artifacts are not visible once downscaled */
+            var_Create(dec, "avcodec-skiploopfilter", VLC_VAR_INTEGER);
+            var_SetInteger(dec, "avcodec-skiploopfilter", 4);
+        }
+        dec->p_module = module_need(dec, "video decoder", NULL, false);
+    }
+
+    if (!dec->p_module)
+    {
+        decoder_Clean(dec);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static struct thumbnailer_decoder *
+DecoderNew(struct thumbnailer_es_out *out, const es_format_t *fmt)
+{
+    decoder_t *packetizer = vlc_object_create(out->parent, sizeof(*packetizer));
+    if (!packetizer)
+        return NULL;
+
+    struct thumbnailer_decoder *owner =
+        vlc_object_create(out->parent, sizeof(*owner));
+    if (!owner)
+    {
+        vlc_object_delete(packetizer);
+        return NULL;
+    }
+
+    static const struct decoder_owner_callbacks cbs =
+    {
+        .video = {
+            .get_device = DecoderGetDevice,
+            .queue = DecoderQueueVideo,
+            .queue_cc = DecoderQueueCc,
+        },
+    };
+    owner->dec.cbs = &cbs;
+    owner->packetizer = packetizer;
+    owner->out = out;
+
+    if (DecoderLoad(packetizer, true, fmt, false) != VLC_SUCCESS)
+    {
+        vlc_object_delete(packetizer);
+        vlc_object_delete(&owner->dec);
+        return NULL;
+    }
+
+    if (DecoderLoad(&owner->dec, false, &packetizer->fmt_out,
+                    out->skip_loop_filter) != VLC_SUCCESS)
+    {
+        decoder_Destroy(packetizer);
+        vlc_object_delete(&owner->dec);
+        return NULL;
+    }
+
+    return owner;
+}
+
+static void
+DecoderDelete(struct thumbnailer_decoder *owner)
+{
+    decoder_Destroy(owner->packetizer);
+    decoder_Destroy(&owner->dec);
+}
+
+static void
+DecoderFlush(struct thumbnailer_decoder *owner)
+{
+    decoder_t *packetizer = owner->packetizer;
+    decoder_t *dec = &owner->dec;
+
+    if (packetizer->pf_flush)
+        packetizer->pf_flush(packetizer);
+    if (dec->p_module && dec->pf_flush)
+        dec->pf_flush(dec);
+}
+
+static void
+DecoderProcess(struct thumbnailer_decoder *owner, block_t *block)
+{
+    decoder_t *packetizer = owner->packetizer;
+    decoder_t *dec = &owner->dec;
+
+    /* The decoder reload may have failed */
+    if (!dec->p_module)
+    {
+        if (block)
+            block_Release(block);
+        return;
+    }
+
+    block_t **pp_block = block ? &block : NULL;
+    block_t *packetized;
+    while ((packetized = packetizer->pf_packetize(packetizer, pp_block)))
+    {
+        if (!es_format_IsSimilar(&dec->fmt_in, &packetizer->fmt_out))
+        {
+            /* Drain and reload the decoder with the new format */
+            dec->pf_decode(dec, NULL);
+            decoder_Clean(dec);
+            if (DecoderLoad(dec, false, &packetizer->fmt_out,
+                            owner->out->skip_loop_filter) != VLC_SUCCESS)
+            {
+                block_ChainRelease(packetized);
+                return;
+            }
+        }
+
+        if (packetizer->pf_get_cc)
+        {
+            decoder_cc_desc_t desc;
+            block_t *cc = packetizer->pf_get_cc(packetizer, &desc);
+            if (cc)
+                block_Release(cc);
+        }
+
+        while (packetized)
+        {
+            block_t *next = packetized->p_next;
+            packetized->p_next = NULL;
+
+            if (dec->pf_decode(dec, packetized) == VLCDEC_ECRITICAL)
+            {
+                block_ChainRelease(next);
+                return;
+            }
+            packetized = next;
+        }
+    }
+
+    if (!block) /* Drain */
+        dec->pf_decode(dec, NULL);
+}
+
+static es_out_id_t *
+EsOutAdd(es_out_t *es_out, input_source_t *in, const es_format_t *fmt)
+{
+    (void) in;
+    struct thumbnailer_es_out *out =
+        container_of(es_out, struct thumbnailer_es_out, out);
+
+    es_out_id_t *id = malloc(sizeof(*id));
+    if (!id)
+        return NULL;
+
+    id->decoder = NULL;
+    if (!out->video && fmt->i_cat == VIDEO_ES &&
+        fmt->i_priority >= ES_PRIORITY_SELECTABLE_MIN)
+    {
+        id->decoder = DecoderNew(out, fmt);
+        if (id->decoder)
+            out->video = id;
+    }
+
+    id->next = out->ids;
+    out->ids = id;
+    return id;
+}
+
+static int
+EsOutSend(es_out_t *es_out, es_out_id_t *id, block_t *block)
+{
+    (void) es_out;
+    if (id->decoder)
+        DecoderProcess(id->decoder, block);
+    else
+        block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void
+EsOutDel(es_out_t *es_out, es_out_id_t *id)
+{
+    struct thumbnailer_es_out *out =
+        container_of(es_out, struct thumbnailer_es_out, out);
+
+    es_out_id_t **pp = &out->ids;
+    while (*pp != id)
+    {
+        assert(*pp);
+        pp = &(*pp)->next;
+    }
+    *pp = id->next;
+
+    if (out->video == id)
+        out->video = NULL;
+    if (id->decoder)
+        DecoderDelete(id->decoder);
+    free(id);
+}
+
+static int
+EsOutControl(es_out_t *es_out, input_source_t *in, int query, va_list args)
+{
+    (void) in;
+    struct thumbnailer_es_out *out =
+        container_of(es_out, struct thumbnailer_es_out, out);
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+        {
+            /* Let the demuxer skip the other tracks */
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = id == out->video;
+            break;
+        }
+        case ES_OUT_SET_NEXT_DISPLAY_TIME:
+            out->preroll_end = va_arg(args, vlc_tick_t);
+            break;
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            break;
+        case ES_OUT_SET_ES:
+        case ES_OUT_UNSET_ES:
+        case ES_OUT_RESTART_ES:
+        case ES_OUT_SET_ES_DEFAULT:
+        case ES_OUT_SET_ES_STATE:
+        case ES_OUT_SET_ES_CAT_POLICY:
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_ES_FMT:
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG:
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+        case ES_OUT_SET_EPG_TIME:
+        case ES_OUT_DEL_GROUP:
+        case ES_OUT_SET_ES_SCRAMBLED_STATE:
+        case ES_OUT_SET_META:
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void
+EsOutDestroy(es_out_t *es_out)
+{
+    struct thumbnailer_es_out *out =
+        container_of(es_out, struct thumbnailer_es_out, out);
+
+    es_out_id_t *id;
+    while ((id = out->ids))
+    {
+        out->ids = id->next;
+        if (id->decoder)
+            DecoderDelete(id->decoder);
+        free(id);
+    }
+    if (out->pic)
+        picture_Release(out->pic);
+    free(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+static picture_t *
+DemuxThumbnail(task_t *task, demux_t *demux, struct thumbnailer_es_out *out,
+               const struct seek_target *seek_target)
+{
+    vlc_tick_t deadline = task->timeout != VLC_TICK_INVALID
+                        ? vlc_tick_now() + task->timeout : VLC_TICK_INVALID;
+    bool precise = !task->fast_seek;
+    int ret;
+
+    out->preroll_end = VLC_TICK_INVALID;
+    if (seek_target->type == VLC_THUMBNAILER_SEEK_TIME)
+        ret = demux_Control(demux, DEMUX_SET_TIME, seek_target->time, precise);
+    else
+    {
+        assert(seek_target->type == VLC_THUMBNAILER_SEEK_POS);
+        ret = demux_Control(demux, DEMUX_SET_POSITION,
+                            (double) seek_target->pos, precise);
+    }
+    if (ret != VLC_SUCCESS)
+        return NULL;
+
+    if (out->video)
+        DecoderFlush(out->video->decoder);
+
+    unsigned count = 0;
+    bool eof = false;
+    while (!out->pic && !eof)
+    {
+        if (vlc_killed())
+            break;
+        if (deadline != VLC_TICK_INVALID && vlc_tick_now() >= deadline)
+            break;
+        if (!out->video && ++count > THUMBNAILER_MAX_DEMUX_WITHOUT_VIDEO)
+            break;
+
+        eof = demux_Demux(demux) != VLC_DEMUXER_SUCCESS;
+    }
+
+    /* The last pictures may still be delayed in the decoder */
+    if (!out->pic && eof && out->video)
+        DecoderProcess(out->video->decoder, NULL);
+
+    picture_t *pic = out->pic;
+    out->pic = NULL;
+    return pic;
+}
+
+/**
+ * Generate the thumbnails without input thread
+ *
+ * \return the number of notified thumbnails, the remaining ones must be
+ *         generated by an input thread
+ */
+static size_t
+RunDemux(task_t *task, image_handler_t **scaler)
+{
+    vlc_object_t *parent = task->thumbnailer->parent;
+    input_item_t *item = task->item;
+
+    /* Items with options (or remote ones) need the whole input machinery */
+    vlc_mutex_lock(&item->lock);
+    char *uri = NULL;
+    if (item->i_type == ITEM_TYPE_FILE && !item->b_net &&
+        item->i_options == 0 && item->psz_uri)
+        uri = strdup(item->psz_uri);
+    vlc_mutex_unlock(&item->lock);
+    if (!uri)
+        return 0;
+
+    size_t done = 0;
+
+    struct thumbnailer_es_out *out = malloc(sizeof(*out));
+    if (!out)
+        goto end;
+
+    out->out.cbs = &es_out_cbs;
+    out->parent = parent;
+    out->skip_loop_filter = task->width || task->height;
+    out->ids = NULL;
+    out->video = NULL;
+    out->preroll_end = VLC_TICK_INVALID;
+    out->pic = NULL;
+
+    stream_t *s = vlc_stream_NewMRL(parent, uri);
+    if (!s)
+    {
+        es_out_Delete(&out->out);
+        goto end;
+    }
+
+    demux_t *demux = demux_New(parent, "any", uri, s, &out->out);
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        es_out_Delete(&out->out);
+        goto end;
+    }
+
+    bool can_seek;
+    if (demux->pf_demux == NULL ||
+        demux_Control(demux, DEMUX_CAN_SEEK, &can_seek) != VLC_SUCCESS ||
+        !can_seek)
+    {
+        demux_Delete(demux);
+        es_out_Delete(&out->out);
+        goto end;
+    }
+
+    for (; done < task->target_count; ++done)
+    {
+        picture_t *pic = NULL;
+        if (!TaskIsCanceled(task))
+            pic = DemuxThumbnail(task, demux, out, &task->seek_targets[done]);
+        if (pic)
+            pic = ScaleThumbnail(task, scaler, pic);
+        NotifyThumbnail(task, done, pic);
+    }
+
+    demux_Delete(demux);
+    es_out_Delete(&out->out);
+
+end:
+    free(uri);
+    return done;
+}
+
+/*
+ * Input thread path
+ */
+
 static void
 on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
@@ -175,33 +769,36 @@ on_thumbnailer_input_event( input_thread_t *input,
     vlc_cond_signal(&task->cond_ended);
 }
 
-static void
-RunnableRun(void *userdata)
+static picture_t *
+InputThumbnail(task_t *task, const struct seek_target *seek_target)
 {
-    task_t *task = userdata;
     vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
 
     vlc_tick_t now = vlc_tick_now();
 
+    vlc_mutex_lock(&task->lock);
+    task->ended = task->canceled;
+    vlc_mutex_unlock(&task->lock);
+
     input_thread_t* input =
         input_CreateThumbnailer(thumbnailer->parent, on_thumbnailer_input_event,
                                 task, task->item);
     if (!input)
-        goto end;
+        return NULL;
 
-    if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
-        input_SetTime(input, task->seek_target.time, task->fast_seek);
+    if (seek_target->type == VLC_THUMBNAILER_SEEK_TIME)
+        input_SetTime(input, seek_target->time, task->fast_seek);
     else
     {
-        assert(task->seek_target.type == VLC_THUMBNAILER_SEEK_POS);
-        input_SetPosition(input, task->seek_target.pos, task->fast_seek);
+        assert(seek_target->type == VLC_THUMBNAILER_SEEK_POS);
+        input_SetPosition(input, seek_target->pos, task->fast_seek);
     }
 
     int ret = input_Start(input);
     if (ret != VLC_SUCCESS)
     {
         input_Close(input);
-        goto end;
+        return NULL;
     }
 
     vlc_mutex_lock(&task->lock);
@@ -222,12 +819,43 @@ RunnableRun(void *userdata)
     task->pic = NULL;
     vlc_mutex_unlock(&task->lock);
 
-    NotifyThumbnail(task, pic);
-
     input_Stop(input);
     input_Close(input);
 
-end:
+    /* The thumbnail may have been received after the timeout */
+    if (task->pic)
+    {
+        picture_Release(task->pic);
+        task->pic = NULL;
+    }
+
+    return pic;
+}
+
+static void
+RunnableRun(void *userdata)
+{
+    task_t *task = userdata;
+    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
+    image_handler_t *scaler = NULL;
+
+    vlc_interrupt_t *previous = vlc_interrupt_set(task->interrupt);
+    size_t done = RunDemux(task, &scaler);
+    vlc_interrupt_set(previous);
+
+    for (size_t i = done; i < task->target_count; ++i)
+    {
+        picture_t *pic = NULL;
+        if (!TaskIsCanceled(task))
+            pic = InputThumbnail(task, &task->seek_targets[i]);
+        if (pic)
+            pic = ScaleThumbnail(task, &scaler, pic);
+        NotifyThumbnail(task, i, pic);
+    }
+
+    if (scaler)
+        image_HandlerDelete(scaler);
+
     ThumbnailerRemoveTask(thumbnailer, task);
     TaskDelete(task);
 }
@@ -235,21 +863,28 @@ end:
 static void
 Interrupt(task_t *task)
 {
-    /* Wake up RunnableRun() which will call input_Stop() */
+    /* Wake up RunnableRun() which will call input_Stop(), or abort the
+     * demuxer of the direct path */
     vlc_mutex_lock(&task->lock);
     task->ended = true;
+    task->canceled = true;
     vlc_mutex_unlock(&task->lock);
     vlc_cond_signal(&task->cond_ended);
+    vlc_interrupt_kill(task->interrupt);
 }
 
 static task_t *
-RequestCommon(vlc_thumbnailer_t *thumbnailer, struct seek_target seek_target,
-              enum vlc_thumbnailer_seek_speed speed, input_item_t *item,
-              vlc_tick_t timeout, vlc_thumbnailer_cb cb, void *userdata)
+RequestCommon(vlc_thumbnailer_t *thumbnailer,
+              const struct seek_target seek_targets[], size_t target_count,
+              enum vlc_thumbnailer_seek_speed speed,
+              unsigned width, unsigned height, input_item_t *item,
+              vlc_tick_t timeout, vlc_thumbnailer_cb cb,
+              vlc_thumbnailer_batch_cb batch_cb, void *userdata)
 {
     bool fast_seek = speed == VLC_THUMBNAILER_SEEK_FAST;
-    task_t *task = TaskNew(thumbnailer, item, seek_target, fast_seek, cb,
-                           userdata, timeout);
+    task_t *task = TaskNew(thumbnailer, item, seek_targets, target_count,
+                           fast_seek, width, height, cb, batch_cb, userdata,
+                           timeout);
     if (!task)
         return NULL;
 
@@ -275,8 +910,8 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_TIME,
         .time = time,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, &seek_target, 1, speed, 0, 0, item,
+                         timeout, cb, NULL, userdata);
 }
 
 task_t *
@@ -289,8 +924,38 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_POS,
         .pos = pos,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, &seek_target, 1, speed, 0, 0, item,
+                         timeout, cb, NULL, userdata);
+}
+
+task_t *
+vlc_thumbnailer_RequestBatchByTime( vlc_thumbnailer_t *thumbnailer,
+                                    const vlc_tick_t times[], size_t count,
+                                    enum vlc_thumbnailer_seek_speed speed,
+                                    unsigned width, unsigned height,
+                                    input_item_t *item, vlc_tick_t timeout,
+                                    vlc_thumbnailer_batch_cb cb,
+                                    void* userdata )
+{
+    assert(cb);
+    if (count == 0 || count > SIZE_MAX / sizeof(struct seek_target))
+        return NULL;
+
+    struct seek_target *seek_targets = vlc_alloc(count, sizeof(*seek_targets));
+    if (!seek_targets)
+        return NULL;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        seek_targets[i].type = VLC_THUMBNAILER_SEEK_TIME;
+        seek_targets[i].time = times[i];
+    }
+
+    task_t *task = RequestCommon(thumbnailer, seek_targets, count, speed,
+                                 width, height, item, timeout, NULL, cb,
+                                 userdata);
+    free(seek_targets);
+    return task;
 }
 
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer, task_t* task )
@@ -332,7 +997,8 @@ CancelAllTasks(vlc_thumbnailer_t *thumbnailer)
                                             &task->runnable);
         if (canceled)
         {
-            NotifyThumbnail(task, NULL);
+            for (size_t i = 0; i < task->target_count; ++i)
+                NotifyThumbnail(task, i, NULL);
             vlc_list_remove(&task->node);
             TaskDelete(task);
         }
@@ -1322,6 +1322,11 @@ static vlm_message_t *vlm_ShowMedia( vlm_media_sys_t *p_media )
         ssize_t title = vlc_player_GetSelectedTitleIdx(p_instance->player);
         ssize_t chapter = vlc_player_GetSelectedChapterIdx(p_instance->player);
         bool can_seek = vlc_player_CanSeek(p_instance->player);
+        const struct input_stats_t *stats =
+            vlc_player_GetStatistics(p_instance->player);
+        struct input_stats_t usage = { 0 };
+        if (stats != NULL)
+            usage = *stats;
         vlc_player_Unlock(p_instance->player);
 
         p_msg_instance = vlm_MessageAdd( p_msg_sub, vlm_MessageSimpleNew( "instance" ) );
@@ -1344,6 +1349,12 @@ static vlm_message_t *vlm_ShowMedia( vlm_media_sys_t *p_media )
         APPEND_INPUT_INFO( "title", "%zd", title );
         APPEND_INPUT_INFO( "chapter", "%zd", chapter );
         APPEND_INPUT_INFO( "can-seek", "%d", can_seek );
+        /* Resource usage of the channel */
+        APPEND_INPUT_INFO( "cpu-time", "%"PRId64, MS_FROM_VLC_TICK(usage.i_cpu_time) );
+        APPEND_INPUT_INFO( "cpu-usage", "%.1f", usage.f_cpu_usage * 100.f );
+        APPEND_INPUT_INFO( "cpu-degradation", "%d", usage.i_cpu_degradation );
+        APPEND_INPUT_INFO( "input-bitrate", "%.0f", usage.f_input_bitrate * 8000.f );
+        APPEND_INPUT_INFO( "read-bytes", "%"PRId64, usage.i_read_bytes );
 #undef APPEND_INPUT_INFO
         vlm_MessageAdd( p_msg_instance, vlm_MessageNew( "playlistindex",
                         "%d", p_instance->i_index + 1 ) );
@@ -89,6 +89,21 @@ static const char *const ppsz_snap_formats[] =
     "This is the verbosity level (0=only errors and " \
     "standard messages, 1=warnings, 2=debug).")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Write the messages from a background thread, so that slow logging " \
+    "outputs do not stall the threads emitting messages.")
+
+#define LOG_ASYNC_QUEUE_TEXT N_("Asynchronous log queue size")
+#define LOG_ASYNC_QUEUE_LONGTEXT N_( \
+    "Maximum number of messages waiting to be written. Further messages " \
+    "are dropped and counted.")
+
+#define LOG_RATE_LIMIT_TEXT N_("Messages rate limit")
+#define LOG_RATE_LIMIT_LONGTEXT N_( \
+    "Maximum number of messages per second from a same place in the code " \
+    "with asynchronous logging (0 = unlimited). Errors are never dropped.")
+
 #define OPEN_TEXT N_("Default stream")
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
@@ -169,6 +184,13 @@ static const char *ppsz_roles_text[] = {
 #define AUDIO_RESAMPLER_LONGTEXT N_( \
     "This selects which plugin to use for audio resampling." )
 
+#define AUDIO_DRIFT_RESAMPLER_TEXT N_("Resample to correct the clock drift")
+#define AUDIO_DRIFT_RESAMPLER_LONGTEXT N_( \
+    "The drift between the audio output and the input clocks is corrected " \
+    "by resampling. When disabled, and if the audio is not otherwise " \
+    "resampled, single samples are inserted or dropped instead, which uses " \
+    "much less CPU but can be heard with sustained tones." )
+
 #if defined(__ANDROID__) || defined(__APPLE__) || defined(_WIN32)
 #define SPDIF_TEXT N_("Force S/PDIF support")
 #define SPDIF_LONGTEXT N_( \
@@ -364,13 +386,13 @@ static const char * const  ppsz_deinterlace_text[] = {
     "Deinterlace method to use for video processing.")
 static const char * const ppsz_deinterlace_mode[] = {
     "auto", "discard", "blend", "mean", "bob",
-    "linear", "x", "yadif", "yadif2x", "phosphor",
+    "linear", "x", "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor",
     "ivtc"
 };
 static const char * const ppsz_deinterlace_mode_text[] = {
     N_("Auto"), N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"),
-    N_("Linear"), "X", "Yadif", "Yadif (2x)", N_("Phosphor"),
-    N_("Film NTSC (IVTC)")
+    N_("Linear"), "X", "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)",
+    N_("Phosphor"), N_("Film NTSC (IVTC)")
 };
 
 #define DEINTERLACE_FILTER_TEXT N_("Deinterlace filter")
@@ -405,6 +427,21 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads shared by all the video filters processing " \
+    "pictures in slices. 0 means the number of CPUs." )
+
+#define PICTURE_CACHE_SIZE_TEXT N_("Picture cache size (MiB)")
+#define PICTURE_CACHE_SIZE_LONGTEXT N_( \
+    "Maximum size of the released picture buffers kept for reuse by the " \
+    "video filters and encoders. 0 disables the cache." )
+
+#define PICTURE_CACHE_COUNT_TEXT N_("Picture cache count")
+#define PICTURE_CACHE_COUNT_LONGTEXT N_( \
+    "Maximum number of released picture buffers kept for reuse by the " \
+    "video filters and encoders." )
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -487,6 +524,12 @@ static const char *const screensaver_texts[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define VSYNC_PACING_TEXT N_("Pace the display on the refresh")
+#define VSYNC_PACING_LONGTEXT N_( \
+    "With the video outputs reporting their presentations, this displays " \
+    "the frames on the vertical blanks nearest to their dates, for a " \
+    "steady cadence." )
+
 #define QUIET_SYNCHRO_TEXT N_("Quiet synchro")
 #define QUIET_SYNCHRO_LONGTEXT N_( \
     "This avoids flooding the message log with debug output from the " \
@@ -542,6 +585,17 @@ static const char *const screensaver_texts[] = {
     "This defines the maximum input delay jitter that the synchronization " \
     "algorithms should try to compensate (in milliseconds)." )
 
+#define ADAPTIVE_CACHING_TEXT N_("Adaptive caching")
+#define ADAPTIVE_CACHING_LONGTEXT N_( \
+    "Adjust the caching of real-time sources while playing: it is " \
+    "increased when the data arrives late, and slowly decreased while " \
+    "the data keeps arriving in time." )
+
+#define ADAPTIVE_CACHING_PROFILES_TEXT N_("Remember adaptive caching")
+#define ADAPTIVE_CACHING_PROFILES_LONGTEXT N_( \
+    "Store the caching learned for each server, and start from it the " \
+    "next time a stream from the same server is played." )
+
 #define CLOCK_MASTER_TEXT N_("Clock master source")
 #define CLOCK_MASTER_LONGTEXT N_( "Select the clock master source:\n" \
     "auto: best clock source, input if the access can't be paced " \
@@ -551,16 +605,31 @@ static const char *const screensaver_texts[] = {
     "and video tracks can be altered to catch up with the input.\n" \
     "audio: if an audio track is playing, the audio output will drive the " \
     "clock (Fallback to Monotonic if there is no audio tracks).\n" \
-    "monotonic: all tracks are driven by the monotonic clock of the system.")
+    "monotonic: all tracks are driven by the monotonic clock of the system.\n" \
+    "genlock: all tracks are driven by the input clock, locked to the " \
+    "wall clock of the system (synchronized by NTP or PTP), so that several " \
+    "players present the same frame at the same time.")
+
+#define CLOCK_GENLOCK_START_TEXT N_("Genlock start date")
+#define CLOCK_GENLOCK_START_LONGTEXT N_( \
+    "Wall clock date (in milliseconds since the UNIX epoch) at which the " \
+    "first frame is presented with the genlock clock master. If zero, the " \
+    "first frame is presented at the next genlock period boundary.")
+
+#define CLOCK_GENLOCK_PERIOD_TEXT N_("Genlock period")
+#define CLOCK_GENLOCK_PERIOD_LONGTEXT N_( \
+    "The players using the genlock clock master and started within the " \
+    "same period (in milliseconds) present their first frame together.")
 
 static const char *const ppsz_clock_master_values[] = {
-    "auto", "input", "audio", "monotonic",
+    "auto", "input", "audio", "monotonic", "genlock",
 };
 static const char *const ppsz_clock_master_descriptions[] = {
     N_("Auto"),
     N_("Input (PCR)"),
     N_("Audio"),
-    N_("Monotonic")
+    N_("Monotonic"),
+    N_("Genlock (wall clock)")
 };
 
 static const int pi_clock_values[] = { -1, 0, 1 };
@@ -672,6 +741,12 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_REPEAT_LONGTEXT N_( \
     "Number of time the same input will be repeated")
 
+#define INPUT_EVENT_INTERVAL_TEXT N_("Position update interval")
+#define INPUT_EVENT_INTERVAL_LONGTEXT N_( \
+    "Minimum interval (in milliseconds) between two position and " \
+    "statistics updates of an input. Raising it lowers the overhead of " \
+    "the events when many inputs are played at once." )
+
 #define START_TIME_TEXT N_("Start time")
 #define START_TIME_LONGTEXT N_( \
     "The stream will start at this position (in seconds)." )
@@ -737,6 +812,12 @@ static const char* const ppsz_restore_playback_desc[] = {
     "When possible, the input stream will be recorded instead of using " \
     "the stream output module" )
 
+#define INPUT_RECORD_PREROLL_TEXT N_("Record pre-roll (s)")
+#define INPUT_RECORD_PREROLL_LONGTEXT N_( \
+    "When not zero, the last seconds of the streams are kept in memory, " \
+    "and recordings start up to this duration in the past, from a key " \
+    "frame. This disables the native recording." )
+
 #define INPUT_TIMESHIFT_PATH_TEXT N_("Timeshift directory")
 #define INPUT_TIMESHIFT_PATH_LONGTEXT N_( \
     "Directory used to store the timeshift temporary files." )
@@ -746,6 +827,19 @@ static const char* const ppsz_restore_playback_desc[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_RING_SIZE_TEXT N_("Timeshift ring buffer size (MiB)")
+#define INPUT_TIMESHIFT_RING_SIZE_LONGTEXT N_( \
+    "When not zero, the timeshifted streams are stored in a single " \
+    "preallocated file of this size, used as a ring buffer. The oldest " \
+    "data is overwritten once it is full." )
+
+#define INPUT_READAHEAD_TEXT N_("Read-ahead duration (ms)")
+#define INPUT_READAHEAD_LONGTEXT N_( \
+    "When not zero, the input demuxes up to this duration ahead of the " \
+    "playback and feeds the decoders from a separate thread, so that " \
+    "slow reads do not starve them. This only applies to media whose " \
+    "pace is controlled by VLC." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -989,6 +1083,26 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
+#define DEC_DEV_ADAPTER_TEXT N_("Decoder hardware adapter")
+#define DEC_DEV_ADAPTER_LONGTEXT N_( \
+    "Adapter (GPU) used by the decoder hardware devices when several are " \
+    "available: \"round-robin\" to cycle through them, \"least-loaded\" " \
+    "to use the one with the fewest decoding sessions, or the index of the " \
+    "adapter to use. By default, the first adapter is used." )
+
+#define DEC_THREADS_TEXT N_("Decoder threads budget")
+#define DEC_THREADS_LONGTEXT N_( \
+    "Total number of threads shared by all the software decoders running " \
+    "at the same time, according to their resolution. " \
+    "0 means the number of CPUs." )
+
+#define DEC_CACHE_TEXT N_("Idle decoders kept between inputs")
+#define DEC_CACHE_LONGTEXT N_( \
+    "Number of audio and video decoders kept open once their input is " \
+    "stopped, so that the next input using the same format can start " \
+    "faster. This is useful when switching between similar streams, such " \
+    "as TV channels. 0 disables it." )
+
 /*****************************************************************************
  * Sout
  ****************************************************************************/
@@ -1089,6 +1203,24 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define TRACER_LONGTEXT N_( \
     "This allow to select which tracer module you want to use." )
 
+#define METRICS_TEXT N_("Collect performance metrics")
+#define METRICS_LONGTEXT N_( \
+    "Record histograms of the processing times and queue depths, which " \
+    "can be exported by the metrics interface." )
+
+#define ALLOC_PROFILE_TEXT N_("Profile the buffer allocations")
+#define ALLOC_PROFILE_LONGTEXT N_( \
+    "Record the allocation site, size and lifetime of the data blocks and " \
+    "pictures. They can be exported by the metrics interface, and a " \
+    "summary is printed on exit." )
+
+#define LOCK_PROFILE_TEXT N_("Profile the mutex contention")
+#define LOCK_PROFILE_LONGTEXT N_( \
+    "Record the acquisitions, contention, wait and hold times of the " \
+    "mutexes per initialization site. They can be exported by the metrics " \
+    "interface, the long waits are traced, and a summary is printed on " \
+    "exit." )
+
 #define VLM_CONF_TEXT N_("VLM configuration file")
 #define VLM_CONF_LONGTEXT N_( \
     "Read a VLM configuration file as soon as VLM is started." )
@@ -1097,6 +1229,11 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define PLUGINS_CACHE_LONGTEXT N_( \
     "Use a plugins cache which will greatly improve the startup time of VLC.")
 
+#define PLUGINS_PRELOAD_TEXT N_("Preload plugins")
+#define PLUGINS_PRELOAD_LONGTEXT N_( \
+    "Load the plugins used by the previous sessions in the background " \
+    "at startup. This avoids delays the first time they are needed.")
+
 #define PLUGINS_SCAN_TEXT N_("Scan for new plugins")
 #define PLUGINS_SCAN_LONGTEXT N_( \
     "Scan plugin directories for new plugins at startup. " \
@@ -1125,6 +1262,26 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define ONEINSTANCEWHENSTARTEDFROMFILE_TEXT N_( \
     "Use only one instance when started from file manager")
 
+#define PICTURE_HUGEPAGES_TEXT N_("Huge pages for pictures")
+#define PICTURE_HUGEPAGES_LONGTEXT N_( \
+    "Backs the large picture buffers with huge pages, which reduces the " \
+    "TLB misses when processing high resolution videos. Explicit huge " \
+    "pages must be reserved by the system administrator; VLC falls back " \
+    "to normal pages when none are left." )
+static const int pi_picture_hugepages_values[] = { 0, 1, 2 };
+static const char *const ppsz_picture_hugepages_texts[] = {
+    N_("Disabled"), N_("Transparent huge pages"), N_("Explicit huge pages") };
+
+#define PICTURE_NUMA_TEXT N_("NUMA placement of pictures")
+#define PICTURE_NUMA_LONGTEXT N_( \
+    "Memory placement of the large picture buffers on NUMA systems. " \
+    "\"Local\" places them on the node of the thread allocating them, " \
+    "\"Interleaved\" spreads them over all the nodes, which suits " \
+    "pictures processed by threads running on different nodes." )
+static const int pi_picture_numa_values[] = { 0, 1, 2 };
+static const char *const ppsz_picture_numa_texts[] = {
+    N_("Default"), N_("Local"), N_("Interleaved") };
+
 #define HPRIORITY_TEXT N_("Increase the priority of the process")
 #define HPRIORITY_LONGTEXT N_( \
     "Increasing the priority of the process will very likely improve your " \
@@ -1134,6 +1291,35 @@ static const char* const ppsz_restore_playback_desc[] = {
     "all the processor time and render the whole system unresponsive which " \
     "might require a reboot of your machine.")
 
+#define THREAD_POLICY_LONGTEXT N_( \
+    "Scheduling and CPU affinity of the threads of this role, as " \
+    "[scheduler[:priority]][@cpulist], e.g. \"fifo:10@2-3\". The " \
+    "scheduler is one of other, batch, idle, fifo, rr or mmcss. The " \
+    "priority is relative to the lowest real-time one. Real-time " \
+    "scheduling requires the appropriate privileges, otherwise the " \
+    "threads keep the default scheduling. On Windows, the real-time " \
+    "schedulers register the threads with the Multimedia Class Scheduler " \
+    "and only the first 64 CPUs can be selected. This setting applies to " \
+    "the whole process.")
+#define THREAD_LOW_TEXT N_("Background thread policy")
+#define THREAD_INPUT_TEXT N_("Input thread policy")
+#define THREAD_AUDIO_TEXT N_("Audio thread policy")
+#define THREAD_VIDEO_TEXT N_("Video decoder thread policy")
+#define THREAD_OUTPUT_TEXT N_("Output thread policy")
+#define THREAD_HWDEC_TEXT N_("Hardware decoder thread policy")
+#define THREAD_HWDEC_LONGTEXT N_( \
+    "Scheduling and CPU affinity of the decoder threads feeding a " \
+    "hardware decoder, e.g. to isolate them from the software decoders, " \
+    "with the same syntax as the other thread policies.")
+
+#define CPU_BUDGET_TEXT N_("CPU budget per input (%)")
+#define CPU_BUDGET_LONGTEXT N_( \
+    "CPU time that each input, with its decoders, may use, in percent of " \
+    "one CPU (0 for no limit). When it is exceeded, the video decoders " \
+    "first skip the disposable frames, then decode only the key frames, " \
+    "until the usage gets back under the budget. This requires the " \
+    "statistics.")
+
 #define CLOCK_SOURCE_TEXT N_("Clock source")
 #ifdef _WIN32
 static const char *const clock_sources[] = {
@@ -1185,6 +1371,11 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_CACHE_TEXT N_( "Preparsing cache" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Remember the preparsing results of local files, so that unchanged " \
+    "files are not parsed again" )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1617,6 +1808,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_AUDIO_RESAMPLER )
     add_module("audio-resampler", "audio resampler", NULL,
                AUDIO_RESAMPLER_TEXT, AUDIO_RESAMPLER_LONGTEXT)
+    add_bool( "audio-drift-resampler", true, AUDIO_DRIFT_RESAMPLER_TEXT,
+              AUDIO_DRIFT_RESAMPLER_LONGTEXT )
 
 /* Video options */
     set_category( CAT_VIDEO )
@@ -1635,6 +1828,8 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", true, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT )
+    add_bool( "video-vsync-pacing", true, VSYNC_PACING_TEXT,
+              VSYNC_PACING_LONGTEXT )
     /* Used in vout_synchro */
     add_bool( "skip-frames", true, SKIP_FRAMES_TEXT,
               SKIP_FRAMES_LONGTEXT )
@@ -1733,6 +1928,15 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "filter-threads", 0, FILTER_THREADS_TEXT,
+                 FILTER_THREADS_LONGTEXT )
+        change_integer_range( 0, 256 )
+    add_integer( "picture-cache-size", 256, PICTURE_CACHE_SIZE_TEXT,
+                 PICTURE_CACHE_SIZE_LONGTEXT )
+        change_integer_range( 0, 65536 )
+    add_integer( "picture-cache-count", 16, PICTURE_CACHE_COUNT_TEXT,
+                 PICTURE_CACHE_COUNT_LONGTEXT )
+        change_integer_range( 1, 1024 )
 
     set_subcategory( SUBCAT_VIDEO_SPLITTER )
 
@@ -1842,6 +2046,9 @@ vlc_module_begin ()
                  INPUT_REPEAT_TEXT, INPUT_REPEAT_LONGTEXT )
         change_integer_range( 0, 65535 )
         change_safe ()
+    add_integer_with_range( "input-event-interval", 250, 10, 10000,
+                            INPUT_EVENT_INTERVAL_TEXT,
+                            INPUT_EVENT_INTERVAL_LONGTEXT )
     add_float( "start-time", 0,
                START_TIME_TEXT, START_TIME_LONGTEXT )
         change_safe ()
@@ -1970,19 +2177,39 @@ vlc_module_begin ()
     add_integer( "clock-jitter", 5000, CLOCK_JITTER_TEXT,
               CLOCK_JITTER_LONGTEXT )
         change_safe()
+    add_bool( "adaptive-caching", false, ADAPTIVE_CACHING_TEXT,
+              ADAPTIVE_CACHING_LONGTEXT )
+        change_safe()
+    add_bool( "adaptive-caching-profiles", false,
+              ADAPTIVE_CACHING_PROFILES_TEXT,
+              ADAPTIVE_CACHING_PROFILES_LONGTEXT )
     add_string( "clock-master", "auto",
                  CLOCK_MASTER_TEXT, CLOCK_MASTER_LONGTEXT )
         change_string_list( ppsz_clock_master_values, ppsz_clock_master_descriptions )
+    add_integer( "clock-genlock-start", 0,
+                 CLOCK_GENLOCK_START_TEXT, CLOCK_GENLOCK_START_LONGTEXT )
+    add_integer_with_range( "clock-genlock-period", 1000, 1, 3600000,
+                            CLOCK_GENLOCK_PERIOD_TEXT,
+                            CLOCK_GENLOCK_PERIOD_LONGTEXT )
 
     add_directory("input-record-path", NULL,
                   INPUT_RECORD_PATH_TEXT, INPUT_RECORD_PATH_LONGTEXT)
     add_bool( "input-record-native", true, INPUT_RECORD_NATIVE_TEXT,
               INPUT_RECORD_NATIVE_LONGTEXT )
+    add_integer( "input-record-preroll", 0, INPUT_RECORD_PREROLL_TEXT,
+                 INPUT_RECORD_PREROLL_LONGTEXT )
+        change_integer_range( 0, 3600 )
 
     add_directory("input-timeshift-path", NULL,
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT )
+    add_integer( "input-timeshift-ring-size", 0, INPUT_TIMESHIFT_RING_SIZE_TEXT,
+                 INPUT_TIMESHIFT_RING_SIZE_LONGTEXT )
+        change_integer_range( 0, 1024 * 1024 )
+    add_integer( "input-readahead", 0, INPUT_READAHEAD_TEXT,
+                 INPUT_READAHEAD_LONGTEXT )
+        change_integer_range( 0, 60000 )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT );
 
@@ -2004,6 +2231,13 @@ vlc_module_begin ()
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
+    add_string( "dec-dev-adapter", NULL, DEC_DEV_ADAPTER_TEXT,
+                DEC_DEV_ADAPTER_LONGTEXT )
+        change_safe()
+    add_integer( "dec-threads", 0, DEC_THREADS_TEXT, DEC_THREADS_LONGTEXT )
+        change_integer_range( 0, 256 )
+    add_integer( "decoder-cache", 0, DEC_CACHE_TEXT, DEC_CACHE_LONGTEXT )
+        change_integer_range( 0, 16 )
 
     set_subcategory( SUBCAT_INPUT_SCODEC )
     set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
@@ -2064,6 +2298,11 @@ vlc_module_begin ()
                VOD_SERVER_TEXT, VOD_SERVER_LONGTEXT)
     add_module("tracer", "tracer", NULL,
                TRACER_TEXT, TRACER_LONGTEXT)
+    add_bool("metrics", false, METRICS_TEXT, METRICS_LONGTEXT)
+    add_bool("alloc-profile", false, ALLOC_PROFILE_TEXT,
+             ALLOC_PROFILE_LONGTEXT)
+    add_bool("lock-profile", false, LOCK_PROFILE_TEXT,
+             LOCK_PROFILE_LONGTEXT)
 
     set_section( N_("Plugins" ), NULL )
 #ifdef HAVE_DYNAMIC_PLUGINS
@@ -2073,6 +2312,8 @@ vlc_module_begin ()
     add_bool( "plugins-scan", true, PLUGINS_SCAN_TEXT,
               PLUGINS_SCAN_LONGTEXT )
         change_volatile ()
+    add_bool( "plugins-preload", false, PLUGINS_PRELOAD_TEXT,
+              PLUGINS_PRELOAD_LONGTEXT )
 #endif
     add_string( "keystore", NULL, KEYSTORE_TEXT,
                 KEYSTORE_LONGTEXT )
@@ -2088,11 +2329,36 @@ vlc_module_begin ()
     add_obsolete_bool( "inhibit" ) /* since 3.0.0 */
 #endif
 
+#ifdef __linux__
+    add_integer( "picture-hugepages", 0, PICTURE_HUGEPAGES_TEXT,
+                 PICTURE_HUGEPAGES_LONGTEXT )
+        change_integer_list( pi_picture_hugepages_values,
+                             ppsz_picture_hugepages_texts )
+    add_integer( "picture-numa", 0, PICTURE_NUMA_TEXT,
+                 PICTURE_NUMA_LONGTEXT )
+        change_integer_list( pi_picture_numa_values,
+                             ppsz_picture_numa_texts )
+#endif
+
 #if defined(_WIN32) || defined(__OS2__)
     add_bool( "high-priority", false, HPRIORITY_TEXT,
               HPRIORITY_LONGTEXT )
 #endif
 
+    add_string( "thread-low", NULL, THREAD_LOW_TEXT, THREAD_POLICY_LONGTEXT )
+    add_string( "thread-input", NULL, THREAD_INPUT_TEXT,
+                THREAD_POLICY_LONGTEXT )
+    add_string( "thread-audio", NULL, THREAD_AUDIO_TEXT,
+                THREAD_POLICY_LONGTEXT )
+    add_string( "thread-video", NULL, THREAD_VIDEO_TEXT,
+                THREAD_POLICY_LONGTEXT )
+    add_string( "thread-output", NULL, THREAD_OUTPUT_TEXT,
+                THREAD_POLICY_LONGTEXT )
+    add_string( "thread-hwdec", NULL, THREAD_HWDEC_TEXT,
+                THREAD_HWDEC_LONGTEXT )
+    add_integer( "input-cpu-budget", 0, CPU_BUDGET_TEXT, CPU_BUDGET_LONGTEXT )
+        change_integer_range( 0, 100000 )
+
 #ifdef _WIN32
     add_string( "clock-source", NULL, CLOCK_SOURCE_TEXT, NULL )
         change_string_list( clock_sources, clock_sources_text )
@@ -2150,6 +2416,9 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT )
 
+    add_bool( "preparse-cache", true, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT )
 
@@ -2204,6 +2473,11 @@ vlc_module_begin ()
     add_integer( "verbose", 0, VERBOSE_TEXT, VERBOSE_LONGTEXT )
         change_short('v')
         change_volatile ()
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT )
+    add_integer_with_range( "log-async-queue", 4096, 16, 1048576,
+                            LOG_ASYNC_QUEUE_TEXT, LOG_ASYNC_QUEUE_LONGTEXT )
+    add_integer_with_range( "log-rate-limit", 0, 0, 100000,
+                            LOG_RATE_LIMIT_TEXT, LOG_RATE_LIMIT_LONGTEXT )
 #if !defined(_WIN32) && !defined(__OS2__)
     add_obsolete_bool( "daemon" ) /* since 4.0.0 */
         change_short('d')
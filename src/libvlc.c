@@ -63,6 +63,7 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_thumbnailer.h>
+#include <vlc_executor.h>
 
 #include "libvlc.h"
 
@@ -95,6 +96,10 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->filter_executor = NULL;
+    priv->filter_threads = 0;
+    priv->picture_cache = NULL;
+    priv->plugin_preload = NULL;
 
     vlc_ExitInit( &priv->exit );
 
@@ -132,6 +137,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
     char        *psz_val;
     int          i_ret = VLC_EGENERIC;
+    vlc_tick_t   start = vlc_tick_now();
 
     if (unlikely(vlc_LogPreinit(p_libvlc)))
         return VLC_ENOMEM;
@@ -158,11 +164,14 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * We have to do it before config_Load*() because this also gets the
      * list of configuration options exported by each module and loads their
      * default values. */
+    vlc_tick_t plugins = vlc_tick_now();
     module_LoadPlugins (p_libvlc);
+    plugins = vlc_tick_now() - plugins;
 
     /*
      * Override default configuration with config file settings
      */
+    vlc_tick_t config = vlc_tick_now();
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
     {
         if( var_InheritBool( p_libvlc, "reset-config" ) )
@@ -177,9 +186,15 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     int vlc_optind;
     if( config_LoadCmdLine( p_libvlc, i_argc, ppsz_argv, &vlc_optind ) )
         goto error;
+    config = vlc_tick_now() - config;
 
     vlc_LogInit(p_libvlc);
     vlc_tracer_Init(p_libvlc);
+    if (vlc_metrics_Init(p_libvlc))
+        goto error;
+    vlc_alloc_profile_Init(p_libvlc);
+    vlc_lock_profile_Init(p_libvlc);
+    vlc_thread_policy_Init(p_libvlc);
 
     /*
      * Support for gettext
@@ -198,6 +213,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     }
 
     i_ret = VLC_ENOMEM;
+    vlc_tick_t services = vlc_tick_now();
 
     if( libvlc_InternalDialogInit( p_libvlc ) != VLC_SUCCESS )
         goto error;
@@ -205,6 +221,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         msg_Warn( p_libvlc, "memory keystore init failed" );
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
+    picture_SetupAllocator( p_libvlc );
 
     if( var_InheritBool( p_libvlc, "media-library") )
     {
@@ -213,22 +230,14 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
             msg_Warn( p_libvlc, "Media library initialization failed" );
     }
 
-    priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
-    if ( priv->p_thumbnailer == NULL )
-        msg_Warn( p_libvlc, "Failed to instantiate thumbnailer" );
-
     /*
      * Initialize hotkey handling
      */
     if( libvlc_InternalActionsInit( p_libvlc ) != VLC_SUCCESS )
         goto error;
 
-    /*
-     * Meta data handling
-     */
-    priv->parser = input_preparser_New(VLC_OBJECT(p_libvlc));
-    if( !priv->parser )
-        goto error;
+    /* The preparser and the thumbnailer are created on first use: their
+     * threads and caches are not needed by most instances */
 
     priv->media_source_provider = vlc_media_source_provider_New( VLC_OBJECT( p_libvlc ) );
     if( !priv->media_source_provider )
@@ -259,6 +268,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     var_Create( p_libvlc, "app-version", VLC_VAR_STRING );
     var_SetString( p_libvlc, "app-version", PACKAGE_VERSION );
 
+    services = vlc_tick_now() - services;
+
     /* System specific configuration */
     system_Configure( p_libvlc, i_argc - vlc_optind, ppsz_argv + vlc_optind );
 
@@ -323,6 +334,15 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /* Create a variable for showing the main interface */
     var_Create(p_libvlc, "intf-show", VLC_VAR_VOID);
 
+    /* Warm up the plugins that will probably be needed */
+    priv->plugin_preload = vlc_plugin_StartPreload( VLC_OBJECT(p_libvlc) );
+
+    msg_Dbg( p_libvlc, "startup time breakdown: plugins %"PRId64" us, "
+             "configuration %"PRId64" us, services %"PRId64" us, "
+             "total %"PRId64" us", US_FROM_VLC_TICK(plugins),
+             US_FROM_VLC_TICK(config), US_FROM_VLC_TICK(services),
+             US_FROM_VLC_TICK(vlc_tick_now() - start) );
+
     return VLC_SUCCESS;
 
 error:
@@ -338,6 +358,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 {
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
 
+    if (priv->plugin_preload != NULL)
+        vlc_plugin_StopPreload(priv->plugin_preload);
+
     if (priv->parser != NULL)
         input_preparser_Deactivate(priv->parser);
 
@@ -385,12 +408,20 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    if( priv->filter_executor != NULL )
+        vlc_executor_Delete( priv->filter_executor );
+
+    picture_cache_Destroy( p_libvlc );
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
 
+    vlc_lock_profile_Destroy(p_libvlc);
     vlc_LogDestroy(p_libvlc->obj.logger);
     vlc_tracer_Destroy(p_libvlc);
+    vlc_metrics_Destroy(p_libvlc);
+    vlc_alloc_profile_Destroy(p_libvlc);
     /* Free module bank. It is refcounted, so we call this each time  */
     module_EndBank (true);
 #if defined(_WIN32) || defined(__OS2__)
@@ -449,18 +480,34 @@ static void GetFilenames( libvlc_int_t *p_vlc, unsigned n,
     }
 }
 
+/**
+ * Gets the preparser of an instance, and creates it if needed.
+ */
+static input_preparser_t *libvlc_GetPreparser(libvlc_int_t *libvlc,
+                                              bool create)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    vlc_mutex_lock(&priv->lock);
+    if (priv->parser == NULL && create)
+        priv->parser = input_preparser_New(VLC_OBJECT(libvlc));
+    input_preparser_t *parser = priv->parser;
+    vlc_mutex_unlock(&priv->lock);
+    return parser;
+}
+
 int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         input_item_meta_request_option_t i_options,
                         const input_preparser_callbacks_t *cbs,
                         void *cbs_userdata,
                         int timeout, void *id)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, true);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return VLC_ENOMEM;
 
-    return input_preparser_Push( priv->parser, item, i_options, cbs,
+    return input_preparser_Push( parser, item, i_options, cbs,
                                  cbs_userdata, timeout, id );
 }
 
@@ -475,10 +522,10 @@ int libvlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                            void *cbs_userdata,
                            int timeout, void *id)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, true);
     assert(i_options & META_REQUEST_OPTION_SCOPE_ANY);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return VLC_ENOMEM;
 
     vlc_mutex_lock( &item->lock );
@@ -498,13 +545,13 @@ int libvlc_ArtRequest(libvlc_int_t *libvlc, input_item_t *item,
                       const input_fetcher_callbacks_t *cbs,
                       void *cbs_userdata)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, true);
     assert(i_options & META_REQUEST_OPTION_FETCH_ANY);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return VLC_ENOMEM;
 
-    input_preparser_fetcher_Push(priv->parser, item, i_options,
+    input_preparser_fetcher_Push(parser, item, i_options,
                                  cbs, cbs_userdata);
     return VLC_SUCCESS;
 }
@@ -517,10 +564,40 @@ int libvlc_ArtRequest(libvlc_int_t *libvlc, input_item_t *item,
  */
 void libvlc_MetadataCancel(libvlc_int_t *libvlc, void *id)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, false);
+
+    if (parser == NULL)
+        return; /* nothing was ever requested */
+
+    input_preparser_Cancel(parser, id);
+}
+
+/**
+ * Fills an input item from the preparsing cache.
+ *
+ * This only succeeds for local files that did not change since their
+ * results were stored (by the preparser or libvlc_MetadataCacheStore()).
+ */
+bool libvlc_MetadataCacheRestore(libvlc_int_t *libvlc, input_item_t *item)
+{
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, true);
+
+    if (unlikely(parser == NULL))
+        return false;
+
+    return input_preparser_CacheRestore(parser, item);
+}
+
+/**
+ * Stores the meta data and tracks of a parsed local file in the preparsing
+ * cache.
+ */
+void libvlc_MetadataCacheStore(libvlc_int_t *libvlc, input_item_t *item)
+{
+    input_preparser_t *parser = libvlc_GetPreparser(libvlc, true);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return;
 
-    input_preparser_Cancel(priv->parser, id);
+    input_preparser_CacheStore(parser, item);
 }
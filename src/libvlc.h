@@ -51,6 +51,11 @@ void vlc_threads_setup (libvlc_int_t *);
 void vlc_trace (const char *fn, const char *file, unsigned line);
 #define vlc_backtrace() vlc_trace(__func__, __FILE__, __LINE__)
 
+/*
+ * Pictures allocator
+ */
+void picture_SetupAllocator(libvlc_int_t *);
+
 /*
  * Logging
  */
@@ -67,6 +72,49 @@ typedef struct vlc_tracer vlc_tracer_t;
 void vlc_tracer_Init(libvlc_int_t *);
 void vlc_tracer_Destroy(libvlc_int_t *);
 
+/*
+ * Metrics
+ */
+int vlc_metrics_Init(libvlc_int_t *);
+void vlc_metrics_Destroy(libvlc_int_t *);
+
+/*
+ * Allocation profiling
+ */
+void vlc_alloc_profile_Init(libvlc_int_t *);
+void vlc_alloc_profile_Destroy(libvlc_int_t *);
+
+/*
+ * Lock contention profiling
+ */
+void vlc_lock_profile_Init(libvlc_int_t *);
+void vlc_lock_profile_Destroy(libvlc_int_t *);
+
+/*
+ * Thread scheduling policy
+ *
+ * Parses the thread-<role> options. The policy is process-wide: only the
+ * first LibVLC instance sets it.
+ */
+void vlc_thread_policy_Init(libvlc_int_t *);
+
+/*
+ * Host name resolution
+ */
+struct addrinfo;
+
+/**
+ * Resolves a host name like vlc_getaddrinfo_i11e(), through a process-wide
+ * cache of the recent successful resolutions.
+ *
+ * On success, the list must be freed with vlc_freeaddrinfo_cached(), not
+ * freeaddrinfo().
+ */
+int vlc_getaddrinfo_cached_i11e(const char *node, unsigned port,
+                                const struct addrinfo *hints,
+                                struct addrinfo **res);
+void vlc_freeaddrinfo_cached(struct addrinfo *res);
+
 /*
  * LibVLC exit event handling
  */
@@ -125,6 +173,17 @@ vlc_custom_create (vlc_object_t *p_this, size_t i_size, const char *psz_type);
 #define vlc_custom_create(o, s, n) \
         vlc_custom_create(VLC_OBJECT(o), s, n)
 
+/**
+ * Moves an object under another parent.
+ *
+ * The variables of the object will be inherited from the new parent. This
+ * must not be called while the object can be used by any other thread.
+ *
+ * @param obj object to move
+ * @param parent new parent object
+ */
+void vlc_object_reparent(vlc_object_t *obj, vlc_object_t *parent);
+
 /**
  * Allocates an object resource.
  *
@@ -188,12 +247,17 @@ typedef struct libvlc_priv_t
     vlc_keystore      *p_memory_keystore; ///< memory keystore
     intf_thread_t *interfaces;  ///< Linked-list of interfaces
     vlc_playlist_t *main_playlist;
-    struct input_preparser_t *parser; ///< Input item meta data handler
+    struct input_preparser_t *parser; ///< Lazily instantiated meta data handler
     vlc_media_source_provider_t *media_source_provider;
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    struct vlc_metrics *metrics; ///< Performance histograms (or NULL)
+    struct vlc_executor *filter_executor; ///< Lazily created filter slices pool
+    unsigned filter_threads; ///< Number of threads of filter_executor
+    struct vlc_picture_cache *picture_cache; ///< Lazily created buffers cache
+    struct vlc_plugin_preload *plugin_preload; ///< Plugins warmup (or NULL)
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -208,6 +272,8 @@ int intf_InsertItem(libvlc_int_t *, const char *mrl, unsigned optc,
                     const char * const *optv, unsigned flags);
 void intf_DestroyAll( libvlc_int_t * );
 
+void picture_cache_Destroy(libvlc_int_t *);
+
 int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         input_item_meta_request_option_t i_options,
                         const input_preparser_callbacks_t *cbs,
@@ -0,0 +1,443 @@
+/*****************************************************************************
+ * alloc_profile.c: block and picture allocation profiling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#ifdef HAVE_DLADDR
+# include <dlfcn.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_memstream.h>
+#include "../libvlc.h"
+#include "alloc_profile.h"
+
+/*
+ * The sites are kept in a fixed open addressing table per kind of buffer,
+ * indexed by the caller address, so that profiling needs no lock. The
+ * tables live in the BSS: they cost nothing until profiling is enabled,
+ * and the tags of the buffers outliving an instance remain valid.
+ */
+#define SITE_BITS 10
+#define SITE_COUNT (1u << SITE_BITS)
+
+/* The upper bound of the bucket i is 2^i units (bytes or microseconds), up
+ * to 2^27: 128 MiB or about 134 s */
+#define BUCKET_COUNT 28
+
+struct vlc_alloc_site
+{
+    atomic_uintptr_t caller; /**< 0 if the slot is free */
+
+    atomic_uint_fast64_t allocs;
+    atomic_uint_fast64_t bytes;
+    atomic_int_fast64_t live;
+    atomic_int_fast64_t live_bytes;
+    atomic_int_fast64_t peak_live;
+    atomic_int_fast64_t peak_bytes;
+
+    atomic_uint_fast64_t sizes[BUCKET_COUNT + 1];
+    atomic_uint_fast64_t lifetimes[BUCKET_COUNT + 1];
+};
+
+static struct vlc_alloc_site sites[VLC_ALLOC_KINDS][SITE_COUNT];
+/* when a table is full */
+static struct vlc_alloc_site other_sites[VLC_ALLOC_KINDS];
+
+static const char *const kind_names[VLC_ALLOC_KINDS] = {
+    [VLC_ALLOC_BLOCK] = "block",
+    [VLC_ALLOC_PICTURE] = "picture",
+};
+
+atomic_bool vlc_alloc_profiling = false;
+
+static vlc_mutex_t instances_lock = VLC_STATIC_MUTEX;
+static unsigned instances;
+
+static unsigned Bucket(uint_fast64_t value)
+{
+    /* smallest i such that value <= 2^i */
+    unsigned i = value > 1 ? 64 - vlc_clzll(value - 1) : 0;
+    return i < BUCKET_COUNT ? i : BUCKET_COUNT;
+}
+
+static void UpdatePeak(atomic_int_fast64_t *peak, int_fast64_t value)
+{
+    int_fast64_t old = atomic_load_explicit(peak, memory_order_relaxed);
+
+    while (old < value
+        && !atomic_compare_exchange_weak_explicit(peak, &old, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
+static struct vlc_alloc_site *GetSite(enum vlc_alloc_kind kind,
+                                      const void *caller)
+{
+    uintptr_t key = (uintptr_t)caller;
+    if (key == 0)
+        key = 1; /* unknown caller */
+
+    unsigned i = (uint32_t)(key * UINT64_C(0x9E3779B97F4A7C15) >> 32)
+                 & (SITE_COUNT - 1);
+
+    for (unsigned n = 0; n < SITE_COUNT; n++, i = (i + 1) & (SITE_COUNT - 1))
+    {
+        struct vlc_alloc_site *site = &sites[kind][i];
+        uintptr_t cur = atomic_load_explicit(&site->caller,
+                                             memory_order_relaxed);
+        if (cur == key)
+            return site;
+        if (cur == 0
+         && (atomic_compare_exchange_strong_explicit(&site->caller, &cur, key,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed)
+          || cur == key))
+            return site;
+    }
+    return &other_sites[kind];
+}
+
+void vlc_alloc_profile_Alloc(struct vlc_alloc_tag *tag,
+                             enum vlc_alloc_kind kind, const void *caller,
+                             size_t size)
+{
+    struct vlc_alloc_site *site = GetSite(kind, caller);
+
+    tag->site = site;
+    tag->size = size;
+    tag->date = vlc_tick_now();
+
+    atomic_fetch_add_explicit(&site->allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->sizes[Bucket(size)], 1,
+                              memory_order_relaxed);
+    UpdatePeak(&site->peak_live,
+               atomic_fetch_add_explicit(&site->live, 1,
+                                         memory_order_relaxed) + 1);
+    UpdatePeak(&site->peak_bytes,
+               atomic_fetch_add_explicit(&site->live_bytes, size,
+                                         memory_order_relaxed) + size);
+}
+
+void vlc_alloc_profile_Free(struct vlc_alloc_tag *tag)
+{
+    struct vlc_alloc_site *site = tag->site;
+    if (site == NULL)
+        return;
+
+    vlc_tick_t lifetime = vlc_tick_now() - tag->date;
+    unsigned bucket = Bucket(US_FROM_VLC_TICK(lifetime));
+
+    atomic_fetch_sub_explicit(&site->live, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&site->live_bytes, tag->size,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->lifetimes[bucket], 1,
+                              memory_order_relaxed);
+}
+
+void vlc_profile_SiteName(char *buf, size_t size, const void *caller)
+{
+#ifdef HAVE_DLADDR
+    Dl_info info;
+
+    if (dladdr(caller, &info) && info.dli_fname != NULL)
+    {
+        const char *module = strrchr(info.dli_fname, '/');
+        module = module != NULL ? module + 1 : info.dli_fname;
+
+        if (info.dli_sname != NULL)
+            snprintf(buf, size, "%s!%s+0x%tx", module, info.dli_sname,
+                     (const char *)caller - (const char *)info.dli_saddr);
+        else
+            snprintf(buf, size, "%s+0x%tx", module,
+                     (const char *)caller - (const char *)info.dli_fbase);
+        return;
+    }
+#endif
+    snprintf(buf, size, "%p", caller);
+}
+
+static void SiteName(char *buf, size_t size, const struct vlc_alloc_site *site)
+{
+    uintptr_t caller = atomic_load_explicit(&site->caller,
+                                            memory_order_relaxed);
+
+    if (caller == 0)
+        strlcpy(buf, "other", size);
+    else if (caller == 1)
+        strlcpy(buf, "unknown", size);
+    else
+        vlc_profile_SiteName(buf, size, (const void *)caller);
+}
+
+/**
+ * Lists the used sites of a kind, the overflow site last.
+ *
+ * \param list an array of SITE_COUNT + 1 entries
+ * \return the number of sites
+ */
+static size_t ListSites(unsigned kind, struct vlc_alloc_site **list)
+{
+    size_t count = 0;
+
+    for (unsigned i = 0; i <= SITE_COUNT; i++)
+    {
+        struct vlc_alloc_site *site = i < SITE_COUNT ? &sites[kind][i]
+                                                     : &other_sites[kind];
+
+        if (atomic_load_explicit(&site->allocs, memory_order_relaxed) > 0)
+            list[count++] = site;
+    }
+    return count;
+}
+
+static void PrintLabels(struct vlc_memstream *ms, unsigned kind,
+                        const char *name)
+{
+    vlc_memstream_printf(ms, "{kind=\"%s\",site=\"", kind_names[kind]);
+    for (const char *c = name; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            vlc_memstream_putc(ms, '\\');
+        vlc_memstream_putc(ms, *c);
+    }
+    vlc_memstream_puts(ms, "\"");
+}
+
+static void PrintBuckets(struct vlc_memstream *ms, const char *family,
+                         unsigned kind, const char *name,
+                         const atomic_uint_fast64_t *buckets, bool seconds)
+{
+    uint_fast64_t cumulated = 0;
+
+    for (unsigned i = 0; i <= BUCKET_COUNT; i++)
+    {
+        cumulated += atomic_load_explicit(&buckets[i], memory_order_relaxed);
+        vlc_memstream_printf(ms, "%s_bucket", family);
+        PrintLabels(ms, kind, name);
+        if (i == BUCKET_COUNT)
+            vlc_memstream_puts(ms, ",le=\"+Inf\"");
+        else if (seconds)
+            vlc_memstream_printf(ms, ",le=\"%"PRIu64".%06"PRIu64"\"",
+                                 (UINT64_C(1) << i) / 1000000,
+                                 (UINT64_C(1) << i) % 1000000);
+        else
+            vlc_memstream_printf(ms, ",le=\"%"PRIu64"\"", UINT64_C(1) << i);
+        vlc_memstream_printf(ms, "} %"PRIuFAST64"\n", cumulated);
+    }
+    vlc_memstream_printf(ms, "%s_count", family);
+    PrintLabels(ms, kind, name);
+    vlc_memstream_printf(ms, "} %"PRIuFAST64"\n", cumulated);
+}
+
+void vlc_alloc_profile_FormatMetrics(struct vlc_memstream *ms)
+{
+    static const struct
+    {
+        const char *name;
+        const char *type;
+        const char *help;
+    } families[] = {
+        { "vlc_alloc", "counter", "Allocated buffers" },
+        { "vlc_alloc_live", "gauge", "Live buffers" },
+        { "vlc_alloc_live_bytes", "gauge", "Size of the live buffers" },
+        { "vlc_alloc_peak_bytes", "gauge", "Peak size of the live buffers" },
+        { "vlc_alloc_size_bytes", "histogram", "Buffer sizes" },
+        { "vlc_alloc_lifetime_seconds", "histogram", "Buffer lifetimes" },
+    };
+    char name[256];
+
+    if (!vlc_alloc_profile_Enabled())
+        return;
+
+    struct vlc_alloc_site **list = malloc((SITE_COUNT + 1) * sizeof (*list));
+    if (unlikely(list == NULL))
+        return;
+
+    for (size_t f = 0; f < ARRAY_SIZE(families); f++)
+    {
+        vlc_memstream_printf(ms, "# TYPE %s %s\n", families[f].name,
+                             families[f].type);
+        vlc_memstream_printf(ms, "# HELP %s %s\n", families[f].name,
+                             families[f].help);
+
+        for (unsigned kind = 0; kind < VLC_ALLOC_KINDS; kind++)
+        {
+            size_t count = ListSites(kind, list);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const struct vlc_alloc_site *site = list[i];
+
+                SiteName(name, sizeof (name), site);
+                switch (f)
+                {
+                    case 0:
+                        vlc_memstream_puts(ms, "vlc_alloc_total");
+                        PrintLabels(ms, kind, name);
+                        vlc_memstream_printf(ms, "} %"PRIuFAST64"\n",
+                            atomic_load_explicit(&site->allocs,
+                                                 memory_order_relaxed));
+                        break;
+                    case 1:
+                    case 2:
+                    case 3:
+                    {
+                        const atomic_int_fast64_t *value =
+                            f == 1 ? &site->live : f == 2 ? &site->live_bytes
+                                                          : &site->peak_bytes;
+                        vlc_memstream_puts(ms, families[f].name);
+                        PrintLabels(ms, kind, name);
+                        vlc_memstream_printf(ms, "} %"PRIdFAST64"\n",
+                            atomic_load_explicit(value, memory_order_relaxed));
+                        break;
+                    }
+                    case 4:
+                        PrintBuckets(ms, families[f].name, kind, name,
+                                     site->sizes, false);
+                        break;
+                    case 5:
+                        PrintBuckets(ms, families[f].name, kind, name,
+                                     site->lifetimes, true);
+                        break;
+                }
+            }
+        }
+    }
+    free(list);
+}
+
+/* Prints the upper bound of the bucket of the given quantile */
+static void PrintQuantile(FILE *out, const atomic_uint_fast64_t *buckets,
+                          double q)
+{
+    uint_fast64_t total = 0, cumulated = 0;
+
+    for (unsigned i = 0; i <= BUCKET_COUNT; i++)
+        total += atomic_load_explicit(&buckets[i], memory_order_relaxed);
+
+    if (total == 0)
+    {
+        fprintf(out, " %12s", "-");
+        return;
+    }
+
+    for (unsigned i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulated += atomic_load_explicit(&buckets[i], memory_order_relaxed);
+        if (cumulated >= q * total)
+        {
+            fprintf(out, " %10"PRIu64"us", UINT64_C(1) << i);
+            return;
+        }
+    }
+    fprintf(out, " %12s", "+Inf");
+}
+
+static int ComparePeak(const void *a, const void *b)
+{
+    const struct vlc_alloc_site *sa = *(const struct vlc_alloc_site **)a;
+    const struct vlc_alloc_site *sb = *(const struct vlc_alloc_site **)b;
+    int_fast64_t pa = atomic_load_explicit(&sa->peak_bytes,
+                                           memory_order_relaxed);
+    int_fast64_t pb = atomic_load_explicit(&sb->peak_bytes,
+                                           memory_order_relaxed);
+
+    return (pa < pb) - (pa > pb);
+}
+
+/**
+ * Prints the sites by decreasing peak size of their live buffers.
+ */
+static void Dump(FILE *out)
+{
+    static struct vlc_alloc_site *list[SITE_COUNT + 1];
+    char name[256];
+
+    for (unsigned k = 0; k < VLC_ALLOC_KINDS; k++)
+    {
+        size_t count = ListSites(k, list);
+        if (count == 0)
+            continue;
+
+        qsort(list, count, sizeof (*list), ComparePeak);
+
+        fprintf(out, "VLC %s allocations:\n"
+                "%10s %8s %8s %10s %10s %12s %12s  %s\n", kind_names[k],
+                "allocs", "live", "peak", "live kB", "peak kB", "life p50",
+                "life p99", "site");
+        for (size_t i = 0; i < count; i++)
+        {
+            const struct vlc_alloc_site *site = list[i];
+
+            fprintf(out, "%10"PRIuFAST64" %8"PRIdFAST64" %8"PRIdFAST64
+                    " %10"PRIdFAST64" %10"PRIdFAST64,
+                    atomic_load_explicit(&site->allocs, memory_order_relaxed),
+                    atomic_load_explicit(&site->live, memory_order_relaxed),
+                    atomic_load_explicit(&site->peak_live,
+                                         memory_order_relaxed),
+                    atomic_load_explicit(&site->live_bytes,
+                                         memory_order_relaxed) / 1024,
+                    atomic_load_explicit(&site->peak_bytes,
+                                         memory_order_relaxed) / 1024);
+            PrintQuantile(out, site->lifetimes, .5);
+            PrintQuantile(out, site->lifetimes, .99);
+            SiteName(name, sizeof (name), site);
+            fprintf(out, "  %s\n", name);
+        }
+    }
+}
+
+void vlc_alloc_profile_Init(libvlc_int_t *vlc)
+{
+    if (!var_InheritBool(vlc, "alloc-profile"))
+        return;
+
+    vlc_mutex_lock(&instances_lock);
+    if (instances++ == 0)
+        atomic_store_explicit(&vlc_alloc_profiling, true,
+                              memory_order_relaxed);
+    vlc_mutex_unlock(&instances_lock);
+}
+
+void vlc_alloc_profile_Destroy(libvlc_int_t *vlc)
+{
+    if (!var_InheritBool(vlc, "alloc-profile"))
+        return;
+
+    vlc_mutex_lock(&instances_lock);
+    assert(instances > 0);
+    if (--instances == 0)
+    {
+        /* The buffers allocated meanwhile remain profiled until released */
+        atomic_store_explicit(&vlc_alloc_profiling, false,
+                              memory_order_relaxed);
+        Dump(stderr);
+    }
+    vlc_mutex_unlock(&instances_lock);
+}
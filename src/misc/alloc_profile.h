@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * alloc_profile.h: block and picture allocation profiling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_ALLOC_PROFILE_H
+# define LIBVLC_ALLOC_PROFILE_H 1
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vlc_common.h>
+
+struct vlc_memstream;
+
+enum vlc_alloc_kind
+{
+    VLC_ALLOC_BLOCK,
+    VLC_ALLOC_PICTURE,
+};
+
+#define VLC_ALLOC_KINDS 2
+
+struct vlc_alloc_site;
+
+/**
+ * Profiling data of one buffer, stored along with it.
+ */
+struct vlc_alloc_tag
+{
+    struct vlc_alloc_site *site; /**< NULL if the buffer is not profiled */
+    size_t size;
+    vlc_tick_t date;
+};
+
+/* The caller of the allocation function identifies the allocation site */
+#if defined (__GNUC__)
+# define vlc_alloc_caller() __builtin_return_address(0)
+#else
+# define vlc_alloc_caller() NULL
+#endif
+
+extern atomic_bool vlc_alloc_profiling;
+
+/**
+ * Whether the allocations are profiled, i.e. the "alloc-profile" option of
+ * any LibVLC instance is enabled.
+ */
+static inline bool vlc_alloc_profile_Enabled(void)
+{
+    return atomic_load_explicit(&vlc_alloc_profiling, memory_order_relaxed);
+}
+
+/**
+ * Records an allocation.
+ *
+ * \param tag the profiling data of the new buffer
+ * \param caller the allocation site, from vlc_alloc_caller()
+ * \param size the buffer size in bytes
+ */
+void vlc_alloc_profile_Alloc(struct vlc_alloc_tag *tag, enum vlc_alloc_kind,
+                             const void *caller, size_t size);
+
+/**
+ * Records the release of a buffer (no-op if it was not profiled).
+ */
+void vlc_alloc_profile_Free(struct vlc_alloc_tag *tag);
+
+/**
+ * Describes a code address as module!symbol+offset when possible.
+ *
+ * This is shared with the lock profiler.
+ */
+void vlc_profile_SiteName(char *buf, size_t size, const void *caller);
+
+/**
+ * Appends the live count, size and lifetime of the allocations per site in
+ * the OpenMetrics text format.
+ */
+void vlc_alloc_profile_FormatMetrics(struct vlc_memstream *);
+
+#endif
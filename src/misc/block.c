@@ -32,8 +32,10 @@
 #include <fcntl.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include "alloc_profile.h"
 
 #ifndef NDEBUG
 static void block_Check (block_t *block)
@@ -87,6 +89,28 @@ static const struct vlc_block_callbacks block_generic_cbs =
     block_generic_Release,
 };
 
+/** Block allocated with block_Alloc() while profiling */
+struct block_profiled
+{
+    struct vlc_alloc_tag tag;
+    block_t block;
+};
+
+static void block_profiled_Release(block_t *block)
+{
+    struct block_profiled *pb = container_of(block, struct block_profiled,
+                                             block);
+
+    assert (block->p_start == (unsigned char *)(block + 1));
+    vlc_alloc_profile_Free(&pb->tag);
+    free (pb);
+}
+
+static const struct vlc_block_callbacks block_profiled_cbs =
+{
+    block_profiled_Release,
+};
+
 static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 {
     out->p_next    = in->p_next;
@@ -105,7 +129,17 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
-block_t *block_Alloc (size_t size)
+/** Sets the payload of a freshly initialized block to its aligned start. */
+static void block_Align(block_t *b, size_t size)
+{
+    static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
+                   "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
+    b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
+    b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
+    b->i_buffer = size;
+}
+
+static block_t *BlockAlloc(size_t size, const void *caller)
 {
     if (unlikely(size >> 28))
     {
@@ -119,19 +153,37 @@ block_t *block_Alloc (size_t size)
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    const struct vlc_block_callbacks *cbs = &block_generic_cbs;
+    block_t *b;
 
-    block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
-    static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
-                   "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
-    b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
-    b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
-    b->i_buffer = size;
+    if (unlikely(vlc_alloc_profile_Enabled()))
+    {
+        struct block_profiled *pb =
+            malloc(offsetof (struct block_profiled, block) + alloc);
+        if (unlikely(pb == NULL))
+            return NULL;
+
+        vlc_alloc_profile_Alloc(&pb->tag, VLC_ALLOC_BLOCK, caller, size);
+        b = &pb->block;
+        cbs = &block_profiled_cbs;
+    }
+    else
+    {
+        b = malloc (alloc);
+        if (unlikely(b == NULL))
+            return NULL;
+    }
+
+    block_Init(b, cbs, b + 1, alloc - sizeof (*b));
+    block_Align(b, size);
     return b;
 }
 
+block_t *block_Alloc (size_t size)
+{
+    return BlockAlloc(size, vlc_alloc_caller());
+}
+
 void block_Release(block_t *block)
 {
 #ifndef NDEBUG
@@ -141,7 +193,8 @@ void block_Release(block_t *block)
     block->cbs->free(block);
 }
 
-block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
+static block_t *BlockTryRealloc(block_t *p_block, ssize_t i_prebody,
+                                size_t i_body, const void *caller)
 {
     block_Check( p_block );
 
@@ -187,7 +240,7 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
         }
 
         /* Not enough room: allocate a new buffer */
-        block_t *p_rea = block_Alloc( requested );
+        block_t *p_rea = BlockAlloc( requested, caller );
         if( p_rea == NULL )
             return NULL;
 
@@ -204,7 +257,7 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     if( (size_t)(p_block->p_buffer - p_start) < (size_t)i_prebody
      || (size_t)(p_end - p_block->p_buffer) < i_body )
     {
-        block_t *p_rea = block_Alloc( requested );
+        block_t *p_rea = BlockAlloc( requested, caller );
         if( p_rea == NULL )
             return NULL;
 
@@ -232,14 +285,313 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     return p_block;
 }
 
+block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
+{
+    return BlockTryRealloc(p_block, i_prebody, i_body, vlc_alloc_caller());
+}
+
 block_t *block_Realloc (block_t *block, ssize_t prebody, size_t body)
 {
-    block_t *rea = block_TryRealloc (block, prebody, body);
+    block_t *rea = BlockTryRealloc(block, prebody, body, vlc_alloc_caller());
     if (rea == NULL)
         block_Release(block);
     return rea;
 }
 
+/** Payload sizes of the block pool size classes.
+ * These cover TS packets, datagrams, PES and NAL units of typical sizes. */
+static const size_t block_pool_sizes[] = {
+    256, 2048, 16384, 131072,
+};
+
+#define BLOCK_POOL_CLASSES ARRAY_SIZE(block_pool_sizes)
+
+/** Maximum number of unused blocks kept per size class */
+#define BLOCK_POOL_MAX 64
+
+struct block_pool_entry
+{
+    block_t self;
+    block_pool_t *pool;
+    struct block_pool_entry *next;
+    unsigned size_class;
+    struct vlc_alloc_tag tag;
+};
+
+struct block_pool_t
+{
+    vlc_mutex_t lock;
+    vlc_atomic_rc_t refs;
+    bool released;
+    struct
+    {
+        struct block_pool_entry *first;
+        unsigned count;
+    } free[BLOCK_POOL_CLASSES];
+    struct block_pool_stats stats;
+};
+
+static void block_pool_Destroy(block_pool_t *pool)
+{
+    if (!vlc_atomic_rc_dec(&pool->refs))
+        return;
+
+    assert(pool->released);
+    free(pool);
+}
+
+static void block_pool_ReleaseEntry(block_t *block)
+{
+    struct block_pool_entry *entry =
+        container_of(block, struct block_pool_entry, self);
+    block_pool_t *pool = entry->pool;
+    unsigned c = entry->size_class;
+
+    assert(block->p_start == (unsigned char *)(entry + 1));
+    vlc_alloc_profile_Free(&entry->tag);
+
+    vlc_mutex_lock(&pool->lock);
+    if (!pool->released && pool->free[c].count < BLOCK_POOL_MAX)
+    {
+        entry->next = pool->free[c].first;
+        pool->free[c].first = entry;
+        pool->free[c].count++;
+        entry = NULL;
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    free(entry);
+    block_pool_Destroy(pool);
+}
+
+static const struct vlc_block_callbacks block_pool_cbs =
+{
+    block_pool_ReleaseEntry,
+};
+
+block_pool_t *block_pool_New(void)
+{
+    block_pool_t *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    vlc_mutex_init(&pool->lock);
+    vlc_atomic_rc_init(&pool->refs);
+    pool->released = false;
+    for (size_t i = 0; i < BLOCK_POOL_CLASSES; i++)
+    {
+        pool->free[i].first = NULL;
+        pool->free[i].count = 0;
+    }
+    memset(&pool->stats, 0, sizeof (pool->stats));
+    return pool;
+}
+
+void block_pool_Release(block_pool_t *pool)
+{
+    struct block_pool_entry *list[BLOCK_POOL_CLASSES];
+
+    vlc_mutex_lock(&pool->lock);
+    assert(!pool->released);
+    pool->released = true;
+    for (size_t i = 0; i < BLOCK_POOL_CLASSES; i++)
+    {
+        list[i] = pool->free[i].first;
+        pool->free[i].first = NULL;
+        pool->free[i].count = 0;
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < BLOCK_POOL_CLASSES; i++)
+        while (list[i] != NULL)
+        {
+            struct block_pool_entry *next = list[i]->next;
+
+            free(list[i]);
+            list[i] = next;
+        }
+
+    block_pool_Destroy(pool);
+}
+
+block_t *block_pool_Alloc(block_pool_t *pool, size_t size)
+{
+    unsigned c = 0;
+
+    while (size > block_pool_sizes[c])
+        if (++c >= BLOCK_POOL_CLASSES)
+        {
+            vlc_mutex_lock(&pool->lock);
+            pool->stats.oversized++;
+            vlc_mutex_unlock(&pool->lock);
+            return BlockAlloc(size, vlc_alloc_caller());
+        }
+
+    vlc_mutex_lock(&pool->lock);
+    assert(!pool->released);
+
+    struct block_pool_entry *entry = pool->free[c].first;
+    if (entry != NULL)
+    {
+        pool->free[c].first = entry->next;
+        pool->free[c].count--;
+        pool->stats.hits++;
+    }
+    else
+        pool->stats.misses++;
+    vlc_mutex_unlock(&pool->lock);
+
+    const size_t alloc = sizeof (*entry) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                       + block_pool_sizes[c];
+    if (entry == NULL)
+    {
+        entry = malloc(alloc);
+        if (unlikely(entry == NULL))
+            return NULL;
+
+        entry->pool = pool;
+        entry->size_class = c;
+    }
+
+    vlc_atomic_rc_inc(&pool->refs);
+
+    if (unlikely(vlc_alloc_profile_Enabled()))
+        vlc_alloc_profile_Alloc(&entry->tag, VLC_ALLOC_BLOCK,
+                                vlc_alloc_caller(), size);
+    else
+        entry->tag.site = NULL;
+
+    block_t *b = block_Init(&entry->self, &block_pool_cbs, entry + 1,
+                            alloc - sizeof (*entry));
+    block_Align(b, size);
+    return b;
+}
+
+void block_pool_GetStats(block_pool_t *pool, struct block_pool_stats *stats)
+{
+    vlc_mutex_lock(&pool->lock);
+    *stats = pool->stats;
+    vlc_mutex_unlock(&pool->lock);
+}
+
+struct block_shared
+{
+    block_t self;
+    block_t *parent;
+    vlc_atomic_rc_t refs;
+};
+
+struct block_view
+{
+    block_t self;
+    struct block_shared *shared;
+};
+
+static void block_shared_Unref(struct block_shared *shared)
+{
+    if (vlc_atomic_rc_dec(&shared->refs))
+    {
+        block_Release(shared->parent);
+        free(shared);
+    }
+}
+
+static void block_shared_Release(block_t *block)
+{
+    block_shared_Unref(container_of(block, struct block_shared, self));
+}
+
+static const struct vlc_block_callbacks block_shared_cbs =
+{
+    block_shared_Release,
+};
+
+static void block_view_Release(block_t *block)
+{
+    struct block_view *view = container_of(block, struct block_view, self);
+    struct block_shared *shared = view->shared;
+
+    free(view);
+    block_shared_Unref(shared);
+}
+
+static const struct vlc_block_callbacks block_view_cbs =
+{
+    block_view_Release,
+};
+
+static struct block_shared *block_GetShared(const block_t *block)
+{
+    if (block->cbs == &block_shared_cbs)
+        return container_of(block, struct block_shared, self);
+    if (block->cbs == &block_view_cbs)
+        return container_of(block, struct block_view, self)->shared;
+    return NULL;
+}
+
+static block_t *block_view_Alloc(struct block_shared *shared,
+                                 uint8_t *buf, size_t length)
+{
+    struct block_view *view = malloc(sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    /* No room around the payload, so that reallocation always copies */
+    block_Init(&view->self, &block_view_cbs, buf, length);
+    view->shared = shared;
+    vlc_atomic_rc_inc(&shared->refs);
+    return &view->self;
+}
+
+block_t *block_Shareable(block_t *block)
+{
+    if (block_GetShared(block) != NULL)
+        return block;
+
+    struct block_shared *shared = malloc(sizeof (*shared));
+    if (unlikely(shared == NULL))
+        return block;
+
+    block_t *b = block_Init(&shared->self, &block_shared_cbs,
+                            block->p_start, block->i_size);
+    b->p_buffer = block->p_buffer;
+    b->i_buffer = block->i_buffer;
+    BlockMetaCopy(b, block);
+    block->p_next = NULL;
+
+    shared->parent = block;
+    vlc_atomic_rc_init(&shared->refs);
+    return b;
+}
+
+block_t *block_View(const block_t *block, size_t offset, size_t length)
+{
+    struct block_shared *shared = block_GetShared(block);
+    if (shared == NULL)
+        return NULL;
+
+    assert(offset <= block->i_buffer && length <= block->i_buffer - offset);
+    return block_view_Alloc(shared, block->p_buffer + offset, length);
+}
+
+block_t *block_ViewJoin(const block_t *list)
+{
+    struct block_shared *shared = block_GetShared(list);
+    if (shared == NULL)
+        return NULL;
+
+    size_t length = list->i_buffer;
+    for (const block_t *b = list; b->p_next != NULL; b = b->p_next)
+    {
+        if (block_GetShared(b->p_next) != shared
+         || b->p_buffer + b->i_buffer != b->p_next->p_buffer)
+            return NULL;
+        length += b->p_next->i_buffer;
+    }
+
+    return block_view_Alloc(shared, list->p_buffer, length);
+}
+
 static void block_heap_Release (block_t *block)
 {
     free (block->p_start);
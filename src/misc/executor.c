@@ -29,6 +29,8 @@
 #include <vlc_threads.h>
 #include "libvlc.h"
 
+#define PRIORITY_COUNT (VLC_EXECUTOR_PRIORITY_HIGH + 1)
+
 /**
  * An executor can spawn several threads.
  *
@@ -48,6 +50,29 @@ struct vlc_executor_thread {
     struct vlc_runnable *current_task;
 };
 
+/**
+ * Worker of a work-stealing executor.
+ *
+ * Each worker owns its queues, protected by its own lock. Idle workers steal
+ * tasks from the queues of the other workers.
+ */
+struct vlc_executor_worker {
+    /** The executor owning the worker */
+    vlc_executor_t *owner;
+
+    /** The system thread */
+    vlc_thread_t thread;
+
+    /** Index of the worker in vlc_executor.ws.workers */
+    unsigned index;
+
+    /** Protects the queues */
+    vlc_mutex_t lock;
+
+    /** Queues of vlc_runnable, one per priority */
+    struct vlc_list queues[PRIORITY_COUNT];
+};
+
 /**
  * The executor (also vlc_executor_t, exposed as opaque type in the public
  * header).
@@ -70,22 +95,76 @@ struct vlc_executor {
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Queues of vlc_runnable, one per priority */
+    struct vlc_list queues[PRIORITY_COUNT];
 
     /** Wait for the queue to be non-empty */
     vlc_cond_t queue_wait;
 
     /** True if executor deletion is requested */
     bool closing;
+
+    /** VLC_EXECUTOR_* flags */
+    unsigned flags;
+
+    /** Work-stealing state (if VLC_EXECUTOR_WORK_STEALING is set) */
+    struct {
+        /** Array of max_threads workers */
+        struct vlc_executor_worker *workers;
+
+        /** Round-robin counter to distribute submitted tasks */
+        atomic_uint next;
+
+        /** Number of tasks in the worker queues */
+        atomic_uint pending;
+
+        /** Number of workers waiting for a task */
+        atomic_uint sleepers;
+
+        /** Number of tasks requested but not finished */
+        atomic_uint unfinished;
+    } ws;
 };
 
+static struct vlc_runnable *
+QueuesTake(struct vlc_list *queues, bool oldest)
+{
+    for (int prio = PRIORITY_COUNT - 1; prio >= 0; --prio)
+    {
+        struct vlc_list *queue = &queues[prio];
+        struct vlc_runnable *runnable = oldest
+            ? vlc_list_first_entry_or_null(queue, struct vlc_runnable, node)
+            : vlc_list_last_entry_or_null(queue, struct vlc_runnable, node);
+
+        if (runnable != NULL)
+        {
+            vlc_list_remove(&runnable->node);
+
+            /* Set links to NULL to know that it has been taken by a thread in
+             * vlc_executor_Cancel() */
+            runnable->node.prev = runnable->node.next = NULL;
+            return runnable;
+        }
+    }
+    return NULL;
+}
+
+static bool
+QueuesEmpty(const struct vlc_list *queues)
+{
+    for (int prio = 0; prio < PRIORITY_COUNT; ++prio)
+        if (!vlc_list_is_empty(&queues[prio]))
+            return false;
+    return true;
+}
+
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable,
+          enum vlc_executor_priority priority)
 {
     vlc_mutex_assert(&executor->lock);
 
-    vlc_list_append(&runnable->node, &executor->queue);
+    vlc_list_append(&runnable->node, &executor->queues[priority]);
     vlc_cond_signal(&executor->queue_wait);
 }
 
@@ -94,21 +173,14 @@ QueueTake(vlc_executor_t *executor)
 {
     vlc_mutex_assert(&executor->lock);
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
+    while (!executor->closing && QueuesEmpty(executor->queues))
         vlc_cond_wait(&executor->queue_wait, &executor->lock);
 
     if (executor->closing)
         return NULL;
 
-    struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
-                                     node);
+    struct vlc_runnable *runnable = QueuesTake(executor->queues, true);
     assert(runnable);
-    vlc_list_remove(&runnable->node);
-
-    /* Set links to NULL to know that it has been taken by a thread in
-     * vlc_executor_Cancel() */
-    runnable->node.prev = runnable->node.next = NULL;
 
     return runnable;
 }
@@ -169,8 +241,196 @@ SpawnThread(vlc_executor_t *executor)
     return VLC_SUCCESS;
 }
 
+static struct vlc_runnable *
+WorkerTake(struct vlc_executor_worker *worker, bool steal)
+{
+    vlc_mutex_lock(&worker->lock);
+    /* The owner takes the oldest task, thieves take the most recent one, so
+     * that they contend on opposite ends of the queue */
+    struct vlc_runnable *runnable = QueuesTake(worker->queues, !steal);
+    if (runnable != NULL)
+        atomic_fetch_sub(&worker->owner->ws.pending, 1);
+    vlc_mutex_unlock(&worker->lock);
+    return runnable;
+}
+
+static void
+WorkStealingTaskDone(vlc_executor_t *executor)
+{
+    if (atomic_fetch_sub(&executor->ws.unfinished, 1) == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+static void *
+WorkerRun(void *userdata)
+{
+    struct vlc_executor_worker *worker = userdata;
+    vlc_executor_t *executor = worker->owner;
+
+    for (;;)
+    {
+        struct vlc_runnable *runnable = WorkerTake(worker, false);
+
+        for (unsigned i = 1; runnable == NULL && i < executor->max_threads;
+             ++i)
+        {
+            unsigned victim = (worker->index + i) % executor->max_threads;
+            runnable = WorkerTake(&executor->ws.workers[victim], true);
+        }
+
+        if (runnable != NULL)
+        {
+            runnable->run(runnable->userdata);
+            WorkStealingTaskDone(executor);
+            continue;
+        }
+
+        /* Nothing to run nor to steal: wait for a submission. The pending
+         * counter only changes with the queues, under the worker lock, so it
+         * never counts a task not visible in a queue yet. It is incremented
+         * before the submitter checks for sleepers, so that no wake-up can
+         * be lost. */
+        vlc_mutex_lock(&executor->lock);
+        atomic_fetch_add(&executor->ws.sleepers, 1);
+        while (!executor->closing && atomic_load(&executor->ws.pending) == 0)
+            vlc_cond_wait(&executor->queue_wait, &executor->lock);
+        atomic_fetch_sub(&executor->ws.sleepers, 1);
+
+        bool closing = executor->closing;
+        vlc_mutex_unlock(&executor->lock);
+
+        if (closing)
+            break;
+    }
+
+    return NULL;
+}
+
+static int
+WorkStealingInit(vlc_executor_t *executor)
+{
+    unsigned count = executor->max_threads;
+    struct vlc_executor_worker *workers =
+        vlc_alloc(count, sizeof (*workers));
+    if (!workers)
+        return VLC_ENOMEM;
+
+    executor->ws.workers = workers;
+    atomic_init(&executor->ws.next, 0);
+    atomic_init(&executor->ws.pending, 0);
+    atomic_init(&executor->ws.sleepers, 0);
+    atomic_init(&executor->ws.unfinished, 0);
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        struct vlc_executor_worker *worker = &workers[i];
+
+        worker->owner = executor;
+        worker->index = i;
+        vlc_mutex_init(&worker->lock);
+        for (int prio = 0; prio < PRIORITY_COUNT; ++prio)
+            vlc_list_init(&worker->queues[prio]);
+    }
+
+    /* All the workers are started upfront. If some of them cannot be started,
+     * the tasks queued for them are stolen by the others. */
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (vlc_clone(&workers[i].thread, WorkerRun, &workers[i],
+                      VLC_THREAD_PRIORITY_LOW))
+            break;
+        executor->nthreads++;
+    }
+
+    if (executor->nthreads == 0)
+    {
+        free(workers);
+        return VLC_EGENERIC;
+    }
+
+    return VLC_SUCCESS;
+}
+
+static void
+WorkStealingSubmit(vlc_executor_t *executor, struct vlc_runnable *runnable,
+                   enum vlc_executor_priority priority)
+{
+    unsigned index = atomic_fetch_add_explicit(&executor->ws.next, 1,
+                                               memory_order_relaxed);
+    struct vlc_executor_worker *worker =
+        &executor->ws.workers[index % executor->max_threads];
+
+    atomic_fetch_add(&executor->ws.unfinished, 1);
+
+    vlc_mutex_lock(&worker->lock);
+    runnable->owner = worker;
+    vlc_list_append(&runnable->node, &worker->queues[priority]);
+    atomic_fetch_add(&executor->ws.pending, 1);
+    vlc_mutex_unlock(&worker->lock);
+
+    if (atomic_load(&executor->ws.sleepers) > 0)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+static bool
+WorkStealingCancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    struct vlc_executor_worker *worker = runnable->owner;
+
+    vlc_mutex_lock(&worker->lock);
+
+    /* Either both prev and next are set, either both are NULL */
+    assert(!runnable->node.prev == !runnable->node.next);
+
+    bool in_queue = runnable->node.prev;
+    if (in_queue)
+    {
+        vlc_list_remove(&runnable->node);
+        runnable->node.prev = runnable->node.next = NULL;
+        atomic_fetch_sub(&executor->ws.pending, 1);
+    }
+
+    vlc_mutex_unlock(&worker->lock);
+
+    if (in_queue)
+        WorkStealingTaskDone(executor);
+
+    return in_queue;
+}
+
+static void
+WorkStealingDelete(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+    executor->closing = true;
+    vlc_cond_broadcast(&executor->queue_wait);
+    vlc_mutex_unlock(&executor->lock);
+
+    for (unsigned i = 0; i < executor->nthreads; ++i)
+    {
+        struct vlc_executor_worker *worker = &executor->ws.workers[i];
+
+        vlc_join(worker->thread, NULL);
+        /* All the tasks must be canceled on delete */
+        assert(QueuesEmpty(worker->queues));
+    }
+
+    assert(!atomic_load(&executor->ws.pending));
+    assert(!atomic_load(&executor->ws.unfinished));
+
+    free(executor->ws.workers);
+}
+
 vlc_executor_t *
-vlc_executor_New(unsigned max_threads)
+vlc_executor_NewExt(unsigned max_threads, unsigned flags)
 {
     assert(max_threads);
     vlc_executor_t *executor = malloc(sizeof(*executor));
@@ -182,17 +442,34 @@ vlc_executor_New(unsigned max_threads)
     executor->max_threads = max_threads;
     executor->nthreads = 0;
     executor->unfinished = 0;
+    executor->flags = flags;
 
     vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+    for (int prio = 0; prio < PRIORITY_COUNT; ++prio)
+        vlc_list_init(&executor->queues[prio]);
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
 
     executor->closing = false;
 
-    /* Create one thread on init so that vlc_executor_Submit() may never fail */
-    int ret = SpawnThread(executor);
+    int ret;
+    if (flags & VLC_EXECUTOR_WORK_STEALING)
+        ret = WorkStealingInit(executor);
+    else
+    {
+        /* Create one thread on init so that vlc_executor_Submit() may never
+         * fail */
+        ret = SpawnThread(executor);
+#ifdef __EMSCRIPTEN__
+        /* A new web worker can only start once the creating thread returns to
+         * the browser event loop, which a submitter may never do: take all
+         * the threads from the worker pool upfront */
+        while (ret == VLC_SUCCESS && executor->nthreads < max_threads
+            && SpawnThread(executor) == VLC_SUCCESS);
+#endif
+    }
+
     if (ret != VLC_SUCCESS)
     {
         free(executor);
@@ -202,14 +479,30 @@ vlc_executor_New(unsigned max_threads)
     return executor;
 }
 
+vlc_executor_t *
+vlc_executor_New(unsigned max_threads)
+{
+    return vlc_executor_NewExt(max_threads, 0);
+}
+
 void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority)
 {
+    assert(priority < PRIORITY_COUNT);
+
+    if (executor->flags & VLC_EXECUTOR_WORK_STEALING)
+    {
+        WorkStealingSubmit(executor, runnable, priority);
+        return;
+    }
+
     vlc_mutex_lock(&executor->lock);
 
     assert(!executor->closing);
 
-    QueuePush(executor, runnable);
+    QueuePush(executor, runnable, priority);
 
     if (++executor->unfinished > executor->nthreads
             && executor->nthreads < executor->max_threads)
@@ -219,9 +512,19 @@ vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
     vlc_mutex_unlock(&executor->lock);
 }
 
+void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    vlc_executor_SubmitPriority(executor, runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
+}
+
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
+    if (executor->flags & VLC_EXECUTOR_WORK_STEALING)
+        return WorkStealingCancel(executor, runnable);
+
     vlc_mutex_lock(&executor->lock);
 
     /* Either both prev and next are set, either both are NULL */
@@ -247,20 +550,31 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
-        vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    if (executor->flags & VLC_EXECUTOR_WORK_STEALING)
+        while (atomic_load(&executor->ws.unfinished))
+            vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    else
+        while (executor->unfinished)
+            vlc_cond_wait(&executor->idle_wait, &executor->lock);
     vlc_mutex_unlock(&executor->lock);
 }
 
 void
 vlc_executor_Delete(vlc_executor_t *executor)
 {
+    if (executor->flags & VLC_EXECUTOR_WORK_STEALING)
+    {
+        WorkStealingDelete(executor);
+        free(executor);
+        return;
+    }
+
     vlc_mutex_lock(&executor->lock);
 
     executor->closing = true;
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(QueuesEmpty(executor->queues));
 
     vlc_mutex_unlock(&executor->lock);
 
@@ -279,7 +593,7 @@ vlc_executor_Delete(vlc_executor_t *executor)
     }
 
     /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(QueuesEmpty(executor->queues));
 
     /* There are no tasks anymore */
     assert(!executor->unfinished);
@@ -29,40 +29,97 @@
 #include <stdlib.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 #include "libvlc.h"
 
+/** Capacity of the lock-free ring of single-producer FIFOs */
+#define FIFO_RING_SIZE 64
+
+static_assert ((FIFO_RING_SIZE & (FIFO_RING_SIZE - 1)) == 0,
+               "Not a power of two");
+
 /**
  * Internal state for block queues
  */
 struct block_fifo_t
 {
     vlc_queue_t         q;
-    size_t              i_depth;
-    size_t              i_size;
+    atomic_size_t       i_depth;
+    atomic_size_t       i_size;
+
+    /* Single-producer lock-free ring. The producer owns the tail, while the
+     * head is only moved with the queue lock held. Blocks in the ring are
+     * always more recent than those in the queue. */
+    bool                spsc;
+    atomic_bool         sleeping;
+    atomic_size_t       head;
+    atomic_size_t       tail;
+    block_t            *ring[FIFO_RING_SIZE];
 };
 
 static_assert (offsetof (block_fifo_t, q) == 0, "Problems in <vlc_block.h>");
 
-size_t vlc_fifo_GetCount(const vlc_fifo_t *fifo)
+/**
+ * Moves the blocks pushed locklessly to the locked queue.
+ */
+static void vlc_fifo_Absorb(block_fifo_t *fifo)
 {
     vlc_mutex_assert(&fifo->q.lock);
-    return fifo->i_depth;
+
+    if (!fifo->spsc)
+        return;
+
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+
+    if (head == tail)
+        return;
+
+    block_t *list, **pp = &list;
+
+    while (head != tail) {
+        block_t *block = fifo->ring[head++ % FIFO_RING_SIZE];
+
+        *pp = block;
+        pp = &block->p_next;
+    }
+    *pp = NULL;
+
+    atomic_store_explicit(&fifo->head, head, memory_order_release);
+    vlc_queue_EnqueueUnlocked(&fifo->q, list);
+}
+
+size_t vlc_fifo_GetCount(const vlc_fifo_t *fifo)
+{
+    if (!fifo->spsc)
+        vlc_mutex_assert(&fifo->q.lock);
+    return atomic_load_explicit(&fifo->i_depth, memory_order_relaxed);
 }
 
 size_t vlc_fifo_GetBytes(const vlc_fifo_t *fifo)
 {
-    vlc_mutex_assert(&fifo->q.lock);
-    return fifo->i_size;
+    if (!fifo->spsc)
+        vlc_mutex_assert(&fifo->q.lock);
+    return atomic_load_explicit(&fifo->i_size, memory_order_relaxed);
+}
+
+bool vlc_fifo_IsEmpty(vlc_fifo_t *fifo)
+{
+    vlc_fifo_Absorb(fifo);
+    return vlc_queue_IsEmpty(&fifo->q);
 }
 
 void vlc_fifo_QueueUnlocked(block_fifo_t *fifo, block_t *block)
 {
     for (block_t *b = block; b != NULL; b = b->p_next) {
-        fifo->i_depth++;
-        fifo->i_size += b->i_buffer;
+        atomic_fetch_add_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&fifo->i_size, b->i_buffer,
+                                  memory_order_relaxed);
     }
 
+    /* Keep the order with respect to the blocks pushed locklessly */
+    vlc_fifo_Absorb(fifo);
     vlc_queue_EnqueueUnlocked(&fifo->q, block);
 }
 
@@ -70,11 +127,17 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 {
     block_t *block = vlc_queue_DequeueUnlocked(&fifo->q);
 
+    if (block == NULL && fifo->spsc) {
+        vlc_fifo_Absorb(fifo);
+        block = vlc_queue_DequeueUnlocked(&fifo->q);
+    }
+
     if (block != NULL) {
-        assert(fifo->i_depth > 0);
-        assert(fifo->i_size >= block->i_buffer);
-        fifo->i_depth--;
-        fifo->i_size -= block->i_buffer;
+        assert(atomic_load(&fifo->i_depth) > 0);
+        assert(atomic_load(&fifo->i_size) >= block->i_buffer);
+        atomic_fetch_sub_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&fifo->i_size, block->i_buffer,
+                                  memory_order_relaxed);
     }
 
     return block;
@@ -82,24 +145,102 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 
 block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
-    fifo->i_depth = 0;
-    fifo->i_size = 0;
-    return vlc_queue_DequeueAllUnlocked(&fifo->q);
+    vlc_fifo_Absorb(fifo);
+
+    block_t *list = vlc_queue_DequeueAllUnlocked(&fifo->q);
+
+    for (block_t *b = list; b != NULL; b = b->p_next) {
+        atomic_fetch_sub_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&fifo->i_size, b->i_buffer,
+                                  memory_order_relaxed);
+    }
+    return list;
 }
 
-block_fifo_t *block_FifoNew( void )
+void vlc_fifo_Wait(vlc_fifo_t *fifo)
+{
+    if (!fifo->spsc) {
+        vlc_queue_Wait(&fifo->q);
+        return;
+    }
+
+    /* Tell the producer to signal, then check for blocks pushed in the mean
+     * time. Spurious wake-ups are allowed. The ring is drained first so that
+     * a consumer waiting for something else than data (e.g. pause) does not
+     * spin on blocks it has not dequeued yet. */
+    vlc_fifo_Absorb(fifo);
+    atomic_store(&fifo->sleeping, true);
+    if (atomic_load(&fifo->tail)
+     == atomic_load_explicit(&fifo->head, memory_order_relaxed))
+        vlc_queue_Wait(&fifo->q);
+    atomic_store_explicit(&fifo->sleeping, false, memory_order_relaxed);
+}
+
+void vlc_fifo_Push(vlc_fifo_t *fifo, block_t *block)
+{
+    if (fifo->spsc) {
+        size_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+
+        while (block != NULL) {
+            size_t head = atomic_load_explicit(&fifo->head,
+                                               memory_order_acquire);
+            if (tail - head >= FIFO_RING_SIZE)
+                break; /* Ring full: fall back to the locked queue */
+
+            block_t *next = block->p_next;
+
+            block->p_next = NULL;
+            /* Account before publishing, so the consumer cannot underflow */
+            atomic_fetch_add_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&fifo->i_size, block->i_buffer,
+                                      memory_order_relaxed);
+            fifo->ring[tail++ % FIFO_RING_SIZE] = block;
+            atomic_store(&fifo->tail, tail);
+            block = next;
+        }
+
+        if (block == NULL) {
+            if (atomic_load(&fifo->sleeping)) {
+                vlc_fifo_Lock(fifo);
+                vlc_fifo_Signal(fifo);
+                vlc_fifo_Unlock(fifo);
+            }
+            return;
+        }
+    }
+
+    vlc_fifo_Lock(fifo);
+    vlc_fifo_QueueUnlocked(fifo, block);
+    vlc_fifo_Unlock(fifo);
+}
+
+static block_fifo_t *block_FifoCreate(bool spsc)
 {
     block_fifo_t *p_fifo = malloc( sizeof( block_fifo_t ) );
 
     if (likely(p_fifo != NULL)) {
         vlc_queue_Init(&p_fifo->q, offsetof (block_t, p_next));
-        p_fifo->i_depth = 0;
-        p_fifo->i_size = 0;
+        atomic_init(&p_fifo->i_depth, 0);
+        atomic_init(&p_fifo->i_size, 0);
+        p_fifo->spsc = spsc;
+        atomic_init(&p_fifo->sleeping, false);
+        atomic_init(&p_fifo->head, 0);
+        atomic_init(&p_fifo->tail, 0);
     }
 
     return p_fifo;
 }
 
+block_fifo_t *block_FifoNew( void )
+{
+    return block_FifoCreate(false);
+}
+
+block_fifo_t *block_FifoNewSPSC( void )
+{
+    return block_FifoCreate(true);
+}
+
 void block_FifoRelease( block_fifo_t *p_fifo )
 {
     block_FifoEmpty(p_fifo);
@@ -113,13 +254,12 @@ block_t *block_FifoGet(block_fifo_t *fifo)
     vlc_testcancel();
 
     vlc_fifo_Lock(fifo);
-    while (vlc_fifo_IsEmpty(fifo))
+    while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
     {
         vlc_fifo_CleanupPush(fifo);
         vlc_fifo_Wait(fifo);
         vlc_cleanup_pop();
     }
-    block = vlc_fifo_DequeueUnlocked(fifo);
     vlc_fifo_Unlock(fifo);
 
     return block;
@@ -130,6 +270,7 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
     block_t *b;
 
     vlc_fifo_Lock(p_fifo);
+    vlc_fifo_Absorb(p_fifo);
     assert(p_fifo->q.first != NULL);
     b = (block_t *)p_fifo->q.first;
     vlc_fifo_Unlock(p_fifo);
@@ -30,6 +30,8 @@
 #include <libvlc.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_executor.h>
+#include <vlc_cpu.h>
 #include "../misc/variables.h"
 
 /* */
@@ -101,6 +103,103 @@ void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 
 /* */
 
+#define FILTER_SLICES_MAX 64
+
+struct filter_slices
+{
+    filter_slice_cb cb;
+    void *opaque;
+    unsigned count;
+    vlc_sem_t done;
+};
+
+struct filter_slice_task
+{
+    struct vlc_runnable runnable;
+    struct filter_slices *slices;
+    unsigned slice;
+};
+
+static void RunSlice(void *userdata)
+{
+    struct filter_slice_task *task = userdata;
+    struct filter_slices *slices = task->slices;
+
+    slices->cb(slices->opaque, task->slice, slices->count);
+    vlc_sem_post(&slices->done);
+}
+
+static vlc_executor_t *GetSlicesExecutor(filter_t *filter, unsigned *threads)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(filter));
+
+    vlc_mutex_lock(&priv->lock);
+    if (priv->filter_threads == 0)
+    {
+        int64_t count = var_InheritInteger(filter, "filter-threads");
+        if (count <= 0)
+            count = vlc_GetCPUCount();
+        priv->filter_threads = VLC_CLIP(count, 1, FILTER_SLICES_MAX);
+
+        /* The calling thread processes a slice too */
+        if (priv->filter_threads > 1)
+        {
+            priv->filter_executor =
+                vlc_executor_New(priv->filter_threads - 1);
+            if (priv->filter_executor == NULL)
+                priv->filter_threads = 1;
+        }
+        msg_Dbg(filter, "using %u threads for filter slices",
+                priv->filter_threads);
+    }
+    *threads = priv->filter_threads;
+    vlc_mutex_unlock(&priv->lock);
+
+    return priv->filter_executor;
+}
+
+void filter_ExecuteSlices(filter_t *filter, unsigned max_slices,
+                          filter_slice_cb cb, void *opaque)
+{
+    unsigned threads;
+    vlc_executor_t *executor = GetSlicesExecutor(filter, &threads);
+
+    unsigned count = __MIN(threads, max_slices);
+
+    if (count <= 1)
+    {
+        cb(opaque, 0, 1);
+        return;
+    }
+
+    struct filter_slices slices = {
+        .cb = cb,
+        .opaque = opaque,
+        .count = count,
+    };
+    struct filter_slice_task tasks[FILTER_SLICES_MAX];
+
+    vlc_sem_init(&slices.done, 0);
+
+    for (unsigned i = 1; i < count; i++)
+    {
+        struct filter_slice_task *task = &tasks[i];
+
+        task->runnable.run = RunSlice;
+        task->runnable.userdata = task;
+        task->slices = &slices;
+        task->slice = i;
+        vlc_executor_Submit(executor, &task->runnable);
+    }
+
+    cb(opaque, 0, count);
+
+    for (unsigned i = 1; i < count; i++)
+        vlc_sem_wait(&slices.done);
+}
+
+/* */
+
 vlc_blender_t *filter_NewBlend( vlc_object_t *p_this,
                            const video_format_t *p_dst_chroma )
 {
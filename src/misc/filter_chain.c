@@ -42,6 +42,32 @@ typedef struct chained_filter_t
     vlc_picture_chain_t pending;
 } chained_filter_t;
 
+struct filter_chain_pipeline;
+
+/** Group of consecutive filters run by one pipeline thread */
+struct filter_chain_stage
+{
+    struct filter_chain_pipeline *pipeline;
+    chained_filter_t *first, *last; /**< First and last filters */
+    chained_filter_t *end; /**< Filter following the last one, if any */
+    vlc_picture_chain_t queue; /**< Input pictures */
+    unsigned queued; /**< Number of input pictures */
+    bool busy; /**< Whether a picture is being filtered */
+    vlc_cond_t wait; /**< Signaled when a picture is queued */
+    vlc_thread_t thread;
+};
+
+struct filter_chain_pipeline
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< Signaled when a stage pops or finishes a picture */
+    vlc_picture_chain_t *output; /**< Filtered pictures (unbounded) */
+    unsigned depth;
+    bool closing;
+    unsigned count;
+    struct filter_chain_stage stages[];
+};
+
 /* */
 struct filter_chain_t
 {
@@ -56,12 +82,18 @@ struct filter_chain_t
     bool b_allow_fmt_out_change; /**< Each filter can change the output */
     const char *filter_cap; /**< Filter modules capability */
     const char *conv_cap; /**< Converter modules capability */
+
+    unsigned pipeline_threads; /**< Maximum pipeline threads (0 if disabled) */
+    unsigned pipeline_depth; /**< Pipeline queues depth */
+    struct filter_chain_pipeline *pipeline; /**< Running pipeline, if any */
+    vlc_picture_chain_t output; /**< Pictures filtered by the pipeline */
 };
 
 /**
  * Local prototypes
  */
 static void FilterDeletePictures( vlc_picture_chain_t * );
+static void FilterChainPipelineStop( filter_chain_t *, bool discard );
 
 static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     const char *cap, const char *conv_cap, bool fmt_out_change,
@@ -83,6 +115,10 @@ static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     chain->b_allow_fmt_out_change = fmt_out_change;
     chain->filter_cap = cap;
     chain->conv_cap = conv_cap;
+    chain->pipeline_threads = 0;
+    chain->pipeline_depth = 1;
+    chain->pipeline = NULL;
+    vlc_picture_chain_Init( &chain->output );
     return chain;
 }
 
@@ -164,6 +200,8 @@ filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
 
 void filter_chain_Clear( filter_chain_t *p_chain )
 {
+    FilterChainPipelineStop( p_chain, true );
+    FilterDeletePictures( &p_chain->output );
     while( p_chain->first != NULL )
         filter_chain_DeleteFilter( p_chain, &p_chain->first->filter );
 }
@@ -174,6 +212,7 @@ void filter_chain_Clear( filter_chain_t *p_chain )
 void filter_chain_Delete( filter_chain_t *p_chain )
 {
     filter_chain_Clear( p_chain );
+    FilterDeletePictures( &p_chain->output );
 
     es_format_Clean( &p_chain->fmt_in );
     if ( p_chain->vctx_in )
@@ -214,6 +253,9 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
 
     filter_t *filter = &chained->filter;
 
+    /* The pipeline stages are split again on the next picture */
+    FilterChainPipelineStop( chain, false );
+
     const es_format_t *fmt_in;
     vlc_video_context *vctx_in;
     if( chain->last != NULL )
@@ -311,6 +353,8 @@ void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
 {
     chained_filter_t *chained = (chained_filter_t *)filter;
 
+    FilterChainPipelineStop( chain, true );
+
     /* Remove it from the chain */
     if( chained->prev != NULL )
         chained->prev->next = chained->next;
@@ -422,9 +466,11 @@ vlc_video_context *filter_chain_GetVideoCtxOut(const filter_chain_t *p_chain)
     return p_chain->vctx_in;
 }
 
-static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic )
+static picture_t *FilterChainVideoFilter( chained_filter_t *f,
+                                          const chained_filter_t *end,
+                                          picture_t *p_pic )
 {
-    for( ; f != NULL; f = f->next )
+    for( ; f != end; f = f->next )
     {
         filter_t *p_filter = &f->filter;
         p_pic = p_filter->ops->filter_video( p_filter, p_pic );
@@ -440,29 +486,294 @@ static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic
     return p_pic;
 }
 
-picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
+/** Returns the next picture pending in the filters [first, end) */
+static picture_t *FilterChainVideoPending( chained_filter_t *first,
+                                           chained_filter_t *end,
+                                           chained_filter_t *last )
 {
-    if( p_pic )
+    for( chained_filter_t *b = last; b != NULL; b = b->prev )
     {
-        p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
-        if( p_pic )
-            return p_pic;
+        if( !vlc_picture_chain_IsEmpty( &b->pending ) )
+        {
+            picture_t *p_pic = vlc_picture_chain_PopFront( &b->pending );
+
+            p_pic = FilterChainVideoFilter( b->next, end, p_pic );
+            if( p_pic )
+                return p_pic;
+        }
+        if( b == first )
+            break;
     }
-    for( chained_filter_t *b = p_chain->last; b != NULL; b = b->prev )
+    return NULL;
+}
+
+/* Pipelined filtering */
+static void FilterChainStageEmit( struct filter_chain_stage *stage,
+                                  picture_t *pic )
+{
+    struct filter_chain_pipeline *pipeline = stage->pipeline;
+    struct filter_chain_stage *next = stage + 1;
+
+    vlc_mutex_lock( &pipeline->lock );
+    if( next < pipeline->stages + pipeline->count )
     {
-        if( vlc_picture_chain_IsEmpty( &b->pending ) )
-            continue;
-        p_pic = vlc_picture_chain_PopFront( &b->pending );
+        while( next->queued >= pipeline->depth && !pipeline->closing )
+            vlc_cond_wait( &pipeline->wait, &pipeline->lock );
 
-        p_pic = FilterChainVideoFilter( b->next, p_pic );
-        if( p_pic )
-            return p_pic;
+        if( pipeline->closing )
+        {
+            vlc_mutex_unlock( &pipeline->lock );
+            picture_Release( pic );
+            return;
+        }
+        vlc_picture_chain_Append( &next->queue, pic );
+        next->queued++;
+        vlc_cond_signal( &next->wait );
     }
+    else
+    {
+        /* The last stage never blocks, so that the pipeline cannot stall */
+        vlc_picture_chain_Append( pipeline->output, pic );
+    }
+    vlc_mutex_unlock( &pipeline->lock );
+}
+
+static void *FilterChainStageThread( void *data )
+{
+    struct filter_chain_stage *stage = data;
+    struct filter_chain_pipeline *pipeline = stage->pipeline;
+
+    vlc_mutex_lock( &pipeline->lock );
+    for( ;; )
+    {
+        while( vlc_picture_chain_IsEmpty( &stage->queue ) &&
+               !pipeline->closing )
+            vlc_cond_wait( &stage->wait, &pipeline->lock );
+
+        if( vlc_picture_chain_IsEmpty( &stage->queue ) )
+            break;
+
+        picture_t *pic = vlc_picture_chain_PopFront( &stage->queue );
+        stage->queued--;
+        stage->busy = true;
+        vlc_cond_broadcast( &pipeline->wait );
+        vlc_mutex_unlock( &pipeline->lock );
+
+        /* Filter the picture, then every picture it left pending */
+        pic = FilterChainVideoFilter( stage->first, stage->end, pic );
+        for( ;; )
+        {
+            if( pic != NULL )
+                FilterChainStageEmit( stage, pic );
+            pic = FilterChainVideoPending( stage->first, stage->end,
+                                           stage->last );
+            if( pic == NULL )
+                break;
+        }
+
+        vlc_mutex_lock( &pipeline->lock );
+        stage->busy = false;
+        vlc_cond_broadcast( &pipeline->wait );
+    }
+    vlc_mutex_unlock( &pipeline->lock );
     return NULL;
 }
 
+static bool FilterChainPipelineIsIdle( const struct filter_chain_pipeline *pipeline )
+{
+    for( unsigned i = 0; i < pipeline->count; i++ )
+        if( pipeline->stages[i].queued > 0 || pipeline->stages[i].busy )
+            return false;
+    return true;
+}
+
+static void FilterChainPipelineStart( filter_chain_t *chain )
+{
+    unsigned filters = 0;
+    for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
+        filters++;
+
+    unsigned count = __MIN( chain->pipeline_threads, filters );
+    struct filter_chain_pipeline *pipeline =
+        malloc( sizeof (*pipeline) + count * sizeof (pipeline->stages[0]) );
+    if( unlikely(pipeline == NULL) )
+        return;
+
+    vlc_mutex_init( &pipeline->lock );
+    vlc_cond_init( &pipeline->wait );
+    pipeline->output = &chain->output;
+    pipeline->depth = chain->pipeline_depth;
+    pipeline->closing = false;
+    pipeline->count = 0;
+
+    /* Split the filters into groups of consecutive filters */
+    chained_filter_t *f = chain->first;
+    for( unsigned i = 0, done = 0; i < count; i++ )
+    {
+        struct filter_chain_stage *stage = &pipeline->stages[i];
+        unsigned end = (i + 1) * filters / count;
+
+        stage->pipeline = pipeline;
+        stage->first = f;
+        for( ; done + 1 < end; done++ )
+            f = f->next;
+        stage->last = f;
+        stage->end = f = f->next;
+        done++;
+        vlc_picture_chain_Init( &stage->queue );
+        stage->queued = 0;
+        stage->busy = false;
+        vlc_cond_init( &stage->wait );
+    }
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+        if( vlc_clone( &pipeline->stages[i].thread, FilterChainStageThread,
+                       &pipeline->stages[i], VLC_THREAD_PRIORITY_VIDEO ) )
+            break;
+        pipeline->count++;
+    }
+
+    if( pipeline->count < count )
+    {
+        msg_Err( chain->obj, "cannot start the filter pipeline" );
+        chain->pipeline = pipeline;
+        FilterChainPipelineStop( chain, true );
+        chain->pipeline_threads = 0;
+        return;
+    }
+
+    msg_Dbg( chain->obj, "filtering with a pipeline of %u threads", count );
+    chain->pipeline = pipeline;
+}
+
+static void FilterChainPipelineStop( filter_chain_t *chain, bool discard )
+{
+    struct filter_chain_pipeline *pipeline = chain->pipeline;
+
+    if( pipeline == NULL )
+        return;
+
+    if( !discard )
+        filter_chain_VideoDrain( chain );
+
+    vlc_mutex_lock( &pipeline->lock );
+    pipeline->closing = true;
+    for( unsigned i = 0; i < pipeline->count; i++ )
+    {
+        struct filter_chain_stage *stage = &pipeline->stages[i];
+
+        FilterDeletePictures( &stage->queue );
+        stage->queued = 0;
+        vlc_cond_signal( &stage->wait );
+    }
+    vlc_cond_broadcast( &pipeline->wait );
+    vlc_mutex_unlock( &pipeline->lock );
+
+    for( unsigned i = 0; i < pipeline->count; i++ )
+        vlc_join( pipeline->stages[i].thread, NULL );
+
+    free( pipeline );
+    chain->pipeline = NULL;
+}
+
+static picture_t *FilterChainPipelineFilter( filter_chain_t *chain,
+                                             picture_t *pic )
+{
+    struct filter_chain_pipeline *pipeline = chain->pipeline;
+    struct filter_chain_stage *stage = &pipeline->stages[0];
+
+    vlc_mutex_lock( &pipeline->lock );
+    if( pic != NULL )
+    {
+        while( stage->queued >= pipeline->depth )
+            vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+
+        vlc_picture_chain_Append( &stage->queue, pic );
+        stage->queued++;
+        vlc_cond_signal( &stage->wait );
+    }
+
+    pic = NULL;
+    if( !vlc_picture_chain_IsEmpty( pipeline->output ) )
+        pic = vlc_picture_chain_PopFront( pipeline->output );
+    vlc_mutex_unlock( &pipeline->lock );
+    return pic;
+}
+
+void filter_chain_SetPipeline( filter_chain_t *chain, unsigned threads,
+                               unsigned depth )
+{
+    assert( chain->fmt_in.i_cat == VIDEO_ES );
+
+    FilterChainPipelineStop( chain, false );
+    chain->pipeline_threads = threads;
+    chain->pipeline_depth = __MAX( depth, 1 );
+}
+
+void filter_chain_VideoDrain( filter_chain_t *chain )
+{
+    struct filter_chain_pipeline *pipeline = chain->pipeline;
+
+    if( pipeline == NULL )
+        return;
+
+    vlc_mutex_lock( &pipeline->lock );
+    while( !FilterChainPipelineIsIdle( pipeline ) )
+        vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+    vlc_mutex_unlock( &pipeline->lock );
+}
+
+picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
+{
+    if( p_chain->pipeline_threads > 0 && p_chain->first != NULL )
+    {
+        if( p_chain->pipeline == NULL )
+            FilterChainPipelineStart( p_chain );
+        if( p_chain->pipeline != NULL )
+            return FilterChainPipelineFilter( p_chain, p_pic );
+    }
+
+    if( p_pic )
+    {
+        p_pic = FilterChainVideoFilter( p_chain->first, NULL, p_pic );
+        if( p_pic && vlc_picture_chain_IsEmpty( &p_chain->output ) )
+            return p_pic;
+        /* Keep the order of the pictures left by a stopped pipeline */
+        if( p_pic )
+            vlc_picture_chain_Append( &p_chain->output, p_pic );
+    }
+    if( !vlc_picture_chain_IsEmpty( &p_chain->output ) )
+        return vlc_picture_chain_PopFront( &p_chain->output );
+    if( p_chain->last == NULL )
+        return NULL;
+    return FilterChainVideoPending( p_chain->first, NULL, p_chain->last );
+}
+
 void filter_chain_VideoFlush( filter_chain_t *p_chain )
 {
+    struct filter_chain_pipeline *pipeline = p_chain->pipeline;
+
+    if( pipeline != NULL )
+    {
+        /* Discard the queued pictures until every stage is idle */
+        vlc_mutex_lock( &pipeline->lock );
+        for( ;; )
+        {
+            for( unsigned i = 0; i < pipeline->count; i++ )
+            {
+                FilterDeletePictures( &pipeline->stages[i].queue );
+                pipeline->stages[i].queued = 0;
+            }
+            vlc_cond_broadcast( &pipeline->wait );
+            if( FilterChainPipelineIsIdle( pipeline ) )
+                break;
+            vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+        }
+        vlc_mutex_unlock( &pipeline->lock );
+    }
+    FilterDeletePictures( &p_chain->output );
+
     for( chained_filter_t *f = p_chain->first; f != NULL; f = f->next )
     {
         filter_t *p_filter = &f->filter;
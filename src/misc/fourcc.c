@@ -399,6 +399,14 @@ static const vlc_fourcc_t p_VAAPI_420_10BPP_fallback[] = {
     VLC_CODEC_VAAPI_420_10BPP, VLC_CODEC_P010, VLC_CODEC_I420_10L, 0,
 };
 
+static const vlc_fourcc_t p_DRM_PRIME_NV12_fallback[] = {
+    VLC_CODEC_DRM_PRIME_NV12, VLC_CODEC_NV12, VLC_CODEC_I420, 0,
+};
+
+static const vlc_fourcc_t p_DRM_PRIME_P010_fallback[] = {
+    VLC_CODEC_DRM_PRIME_P010, VLC_CODEC_P010, VLC_CODEC_I420_10L, 0,
+};
+
 static const vlc_fourcc_t p_D3D9_OPAQUE_fallback[] = {
     VLC_CODEC_D3D9_OPAQUE, VLC_CODEC_I420, 0,
 };
@@ -521,6 +529,8 @@ static const vlc_fourcc_t *pp_YUV_fallback[] = {
     p_CVPX_VIDEO_P010_fallback,
     p_VAAPI_420_fallback,
     p_VAAPI_420_10BPP_fallback,
+    p_DRM_PRIME_NV12_fallback,
+    p_DRM_PRIME_P010_fallback,
     p_D3D9_OPAQUE_fallback,
     p_D3D9_OPAQUE_10B_fallback,
     p_D3D11_OPAQUE_fallback,
@@ -555,6 +565,8 @@ static const vlc_fourcc_t p_list_YUV[] = {
     VLC_CODEC_CVPX_P010,
     VLC_CODEC_VAAPI_420,
     VLC_CODEC_VAAPI_420_10BPP,
+    VLC_CODEC_DRM_PRIME_NV12,
+    VLC_CODEC_DRM_PRIME_P010,
     VLC_CODEC_D3D9_OPAQUE,
     VLC_CODEC_D3D9_OPAQUE_10B,
     VLC_CODEC_D3D11_OPAQUE,
@@ -837,6 +849,9 @@ static const struct
     { { VLC_CODEC_VAAPI_420, VLC_CODEC_VAAPI_420_10BPP },
                                                FAKE_FMT() },
 
+    { { VLC_CODEC_DRM_PRIME_NV12, VLC_CODEC_DRM_PRIME_P010 },
+                                               FAKE_FMT() },
+
     { { 0 },                                   FAKE_FMT() }
 };
 
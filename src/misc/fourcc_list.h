@@ -1208,6 +1208,12 @@ static const staticentry_t p_list_video[] = {
     B(VLC_CODEC_VAAPI_420_10BPP, "4:2:0 10bits VAAPI opaque"),
         A("VAO0"),
 
+    B(VLC_CODEC_DRM_PRIME_NV12, "4:2:0 DRM PRIME opaque"),
+        A("DRM8"),
+
+    B(VLC_CODEC_DRM_PRIME_P010, "4:2:0 10bits DRM PRIME opaque"),
+        A("DRM0"),
+
     B(VLC_CODEC_ANDROID_OPAQUE, "Android opaque"),
         A("ANOP"),
 
@@ -1751,6 +1757,9 @@ static const staticentry_t p_list_spu[] = {
     B(VLC_CODEC_SCTE_27, "SCTE-27 subtitles"),
         A("SC27"),
 
+    B(VLC_CODEC_SCTE_35, "SCTE-35 splice information"),
+        A("SC35"),
+
     B(VLC_CODEC_CEA608,  "EIA-608 subtitles"),
         A("cc1 "), /* acquisition devices */
         A("cc2 "),
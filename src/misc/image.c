@@ -176,6 +176,11 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         }
     }
 
+    /* Decoders that can scale while decoding (JPEG) may output a smaller
+     * picture, as long as it is no smaller than the requested size. */
+    var_SetInteger( p_image->p_dec, "image-target-width", p_fmt_out->i_width );
+    var_SetInteger( p_image->p_dec, "image-target-height", p_fmt_out->i_height );
+
     p_block->i_pts = p_block->i_dts = vlc_tick_now();
     int ret = p_image->p_dec->pf_decode( p_image->p_dec, p_block );
     if( ret == VLCDEC_SUCCESS )
@@ -690,6 +695,9 @@ static decoder_t *CreateDecoder( image_handler_t *p_image, const es_format_t *fm
     };
     p_dec->cbs = &dec_cbs;
 
+    var_Create( p_dec, "image-target-width", VLC_VAR_INTEGER );
+    var_Create( p_dec, "image-target-height", VLC_VAR_INTEGER );
+
     /* Find a suitable decoder module */
     p_dec->p_module = module_need_var( p_dec, "video decoder", "codec" );
     if( !p_dec->p_module )
@@ -189,6 +189,20 @@ bool vlc_killed(void)
     return (ctx != NULL) && atomic_load(&ctx->killed);
 }
 
+bool vlc_interrupted(void)
+{
+    vlc_interrupt_t *ctx = vlc_interrupt_var;
+    bool ret;
+
+    if (ctx == NULL)
+        return false;
+
+    vlc_mutex_lock(&ctx->lock);
+    ret = ctx->interrupted || atomic_load(&ctx->killed);
+    vlc_mutex_unlock(&ctx->lock);
+    return ret;
+}
+
 static void vlc_interrupt_sem(void *opaque)
 {
     vlc_sem_post(opaque);
@@ -29,6 +29,12 @@
 void vlc_interrupt_init(vlc_interrupt_t *);
 void vlc_interrupt_deinit(vlc_interrupt_t *);
 
+/**
+ * Checks whether the interruption context of the calling thread was killed,
+ * or has an interruption pending.
+ */
+bool vlc_interrupted(void);
+
 struct vlc_interrupt
 {
     vlc_mutex_t lock;
@@ -0,0 +1,479 @@
+/*****************************************************************************
+ * lock_profile.c: mutex contention profiling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_memstream.h>
+#include <vlc_tracer.h>
+#include "../libvlc.h"
+#include "alloc_profile.h"
+#include "lock_profile.h"
+
+/*
+ * vlc_mutex_t has no room for profiling data, and no destructor: the
+ * mutexes are mapped to their initialization site by address, in a fixed
+ * table where a new mutex replaces the previous one at the same address
+ * (or an older one in the same probe window if the table is full). The
+ * mutexes initialized statically, before profiling or evicted from the
+ * table are accounted to the site of their first profiled lock.
+ *
+ * Everything is lock-free, since the profiler is called by the mutexes.
+ */
+#define SITE_BITS 10
+#define SITE_COUNT (1u << SITE_BITS)
+
+#define MUTEX_BITS 16
+#define MUTEX_COUNT (1u << MUTEX_BITS)
+#define MUTEX_PROBES 8
+
+/** Contended waits longer than this are traced */
+#define TRACE_WAIT VLC_TICK_FROM_MS(1)
+
+struct vlc_lock_site
+{
+    atomic_uintptr_t caller; /**< 0 if the slot is free */
+    _Atomic(char *) name; /**< resolved on first use */
+
+    atomic_uint_fast64_t acquires;
+    atomic_uint_fast64_t contended;
+    atomic_int_fast64_t wait_total;
+    atomic_int_fast64_t wait_max;
+    atomic_int_fast64_t hold_total;
+    atomic_int_fast64_t hold_max;
+};
+
+struct vlc_lock_entry
+{
+    atomic_uintptr_t mutex; /**< 0 if the slot is free */
+    _Atomic(struct vlc_lock_site *) site;
+    atomic_int_fast64_t since; /**< acquisition date, 0 if not held */
+};
+
+static struct vlc_lock_site sites[SITE_COUNT];
+static struct vlc_lock_site other_site; /* when the table is full */
+static struct vlc_lock_entry mutexes[MUTEX_COUNT];
+
+atomic_bool vlc_lock_profiling = false;
+
+static vlc_mutex_t instances_lock = VLC_STATIC_MUTEX;
+static unsigned instances;
+static libvlc_int_t *tracer_owner;
+static _Atomic(struct vlc_tracer *) tracer;
+
+/* Set while the profiler runs, so that the mutexes of the tracer are not
+ * profiled recursively */
+static thread_local bool profiling;
+
+static unsigned Hash(uintptr_t key, unsigned bits)
+{
+    return (uint32_t)(key * UINT64_C(0x9E3779B97F4A7C15) >> 32)
+           & ((1u << bits) - 1);
+}
+
+static void UpdateMax(atomic_int_fast64_t *max, int_fast64_t value)
+{
+    int_fast64_t old = atomic_load_explicit(max, memory_order_relaxed);
+
+    while (old < value
+        && !atomic_compare_exchange_weak_explicit(max, &old, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
+static struct vlc_lock_site *GetSite(const void *caller)
+{
+    uintptr_t key = (uintptr_t)caller;
+    if (key == 0)
+        key = 1; /* unknown caller */
+
+    unsigned i = Hash(key, SITE_BITS);
+
+    for (unsigned n = 0; n < SITE_COUNT; n++, i = (i + 1) & (SITE_COUNT - 1))
+    {
+        struct vlc_lock_site *site = &sites[i];
+        uintptr_t cur = atomic_load_explicit(&site->caller,
+                                             memory_order_relaxed);
+        if (cur == key)
+            return site;
+        if (cur == 0
+         && (atomic_compare_exchange_strong_explicit(&site->caller, &cur, key,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed)
+          || cur == key))
+            return site;
+    }
+    return &other_site;
+}
+
+static struct vlc_lock_entry *Register(uintptr_t mtx,
+                                       struct vlc_lock_site *site)
+{
+    unsigned home = Hash(mtx, MUTEX_BITS);
+    struct vlc_lock_entry *entry = NULL;
+
+    for (unsigned n = 0; n < MUTEX_PROBES; n++)
+    {
+        struct vlc_lock_entry *e = &mutexes[(home + n) & (MUTEX_COUNT - 1)];
+        uintptr_t cur = atomic_load_explicit(&e->mutex, memory_order_relaxed);
+
+        if (cur == mtx
+         || (cur == 0
+          && (atomic_compare_exchange_strong_explicit(&e->mutex, &cur, mtx,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)
+           || cur == mtx)))
+        {
+            entry = e;
+            break;
+        }
+    }
+
+    if (entry == NULL)
+    {   /* evict, the statistics of that mutex go to its next lock site */
+        entry = &mutexes[home];
+        atomic_store_explicit(&entry->mutex, mtx, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&entry->site, site, memory_order_relaxed);
+    atomic_store_explicit(&entry->since, 0, memory_order_relaxed);
+    return entry;
+}
+
+static struct vlc_lock_entry *Lookup(uintptr_t mtx)
+{
+    unsigned home = Hash(mtx, MUTEX_BITS);
+
+    for (unsigned n = 0; n < MUTEX_PROBES; n++)
+    {
+        struct vlc_lock_entry *e = &mutexes[(home + n) & (MUTEX_COUNT - 1)];
+
+        if (atomic_load_explicit(&e->mutex, memory_order_relaxed) == mtx)
+            return e;
+    }
+    return NULL;
+}
+
+static const char *SiteName(struct vlc_lock_site *site)
+{
+    char *name = atomic_load_explicit(&site->name, memory_order_acquire);
+    if (name != NULL)
+        return name;
+
+    char buf[256];
+    uintptr_t caller = atomic_load_explicit(&site->caller,
+                                            memory_order_relaxed);
+
+    if (caller == 0)
+        strlcpy(buf, "other", sizeof (buf));
+    else if (caller == 1)
+        strlcpy(buf, "unknown", sizeof (buf));
+    else
+        vlc_profile_SiteName(buf, sizeof (buf), (const void *)caller);
+
+    char *dup = strdup(buf);
+    if (unlikely(dup == NULL))
+        return "?";
+
+    if (!atomic_compare_exchange_strong_explicit(&site->name, &name, dup,
+                                                 memory_order_acq_rel,
+                                                 memory_order_acquire))
+    {   /* resolved by another thread meanwhile */
+        free(dup);
+        return name;
+    }
+    return dup;
+}
+
+void vlc_lock_profile_Created(const vlc_mutex_t *mtx, const void *caller)
+{
+    if (profiling)
+        return;
+    profiling = true;
+    Register((uintptr_t)mtx, GetSite(caller));
+    profiling = false;
+}
+
+void vlc_lock_profile_Acquired(const vlc_mutex_t *mtx, const void *caller,
+                               vlc_tick_t wait)
+{
+    if (profiling)
+        return;
+    profiling = true;
+
+    struct vlc_lock_entry *entry = Lookup((uintptr_t)mtx);
+    if (entry == NULL)
+        entry = Register((uintptr_t)mtx, GetSite(caller));
+
+    struct vlc_lock_site *site = atomic_load_explicit(&entry->site,
+                                                      memory_order_relaxed);
+
+    atomic_fetch_add_explicit(&site->acquires, 1, memory_order_relaxed);
+    if (wait >= 0)
+    {
+        atomic_fetch_add_explicit(&site->contended, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&site->wait_total, wait,
+                                  memory_order_relaxed);
+        UpdateMax(&site->wait_max, wait);
+
+        struct vlc_tracer *t = atomic_load_explicit(&tracer,
+                                                    memory_order_acquire);
+        if (t != NULL && wait >= TRACE_WAIT)
+            vlc_tracer_Trace(t, VLC_TRACE("type", "lock"),
+                             VLC_TRACE("id", SiteName(site)),
+                             VLC_TRACE("wait", NS_FROM_VLC_TICK(wait)),
+                             VLC_TRACE_END);
+    }
+
+    atomic_store_explicit(&entry->since, vlc_tick_now(),
+                          memory_order_relaxed);
+    profiling = false;
+}
+
+void vlc_lock_profile_Released(const vlc_mutex_t *mtx)
+{
+    if (profiling)
+        return;
+    profiling = true;
+
+    struct vlc_lock_entry *entry = Lookup((uintptr_t)mtx);
+    if (entry != NULL)
+    {
+        vlc_tick_t since = atomic_exchange_explicit(&entry->since, 0,
+                                                    memory_order_relaxed);
+        if (since != 0)
+        {
+            struct vlc_lock_site *site =
+                atomic_load_explicit(&entry->site, memory_order_relaxed);
+            vlc_tick_t hold = vlc_tick_now() - since;
+
+            atomic_fetch_add_explicit(&site->hold_total, hold,
+                                      memory_order_relaxed);
+            UpdateMax(&site->hold_max, hold);
+        }
+    }
+    profiling = false;
+}
+
+/**
+ * Lists the used sites, the overflow site last.
+ *
+ * \param list an array of SITE_COUNT + 1 entries
+ * \return the number of sites
+ */
+static size_t ListSites(struct vlc_lock_site **list)
+{
+    size_t count = 0;
+
+    for (unsigned i = 0; i <= SITE_COUNT; i++)
+    {
+        struct vlc_lock_site *site = i < SITE_COUNT ? &sites[i] : &other_site;
+
+        if (atomic_load_explicit(&site->acquires, memory_order_relaxed) > 0)
+            list[count++] = site;
+    }
+    return count;
+}
+
+static void PrintSeconds(struct vlc_memstream *ms, vlc_tick_t value)
+{
+    uint64_t us = US_FROM_VLC_TICK(value);
+
+    vlc_memstream_printf(ms, "%"PRIu64".%06"PRIu64"\n", us / 1000000,
+                         us % 1000000);
+}
+
+void vlc_lock_profile_FormatMetrics(struct vlc_memstream *ms)
+{
+    static const struct
+    {
+        const char *name;
+        const char *type;
+        const char *help;
+    } families[] = {
+        { "vlc_lock_acquires", "counter", "Mutex acquisitions" },
+        { "vlc_lock_contended", "counter", "Contended mutex acquisitions" },
+        { "vlc_lock_wait_seconds", "counter", "Time waiting for mutexes" },
+        { "vlc_lock_wait_max_seconds", "gauge", "Longest wait for a mutex" },
+        { "vlc_lock_hold_seconds", "counter", "Time holding mutexes" },
+        { "vlc_lock_hold_max_seconds", "gauge", "Longest mutex hold" },
+    };
+
+    if (!vlc_lock_profile_Enabled())
+        return;
+
+    struct vlc_lock_site **list = malloc((SITE_COUNT + 1) * sizeof (*list));
+    if (unlikely(list == NULL))
+        return;
+
+    size_t count = ListSites(list);
+
+    for (size_t f = 0; f < ARRAY_SIZE(families); f++)
+    {
+        bool counter = !strcmp(families[f].type, "counter");
+
+        vlc_memstream_printf(ms, "# TYPE %s %s\n", families[f].name,
+                             families[f].type);
+        vlc_memstream_printf(ms, "# HELP %s %s\n", families[f].name,
+                             families[f].help);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            struct vlc_lock_site *site = list[i];
+
+            vlc_memstream_printf(ms, "%s%s{site=\"", families[f].name,
+                                 counter ? "_total" : "");
+            for (const char *c = SiteName(site); *c != '\0'; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                    vlc_memstream_putc(ms, '\\');
+                vlc_memstream_putc(ms, *c);
+            }
+            vlc_memstream_puts(ms, "\"} ");
+
+            switch (f)
+            {
+                case 0:
+                case 1:
+                    vlc_memstream_printf(ms, "%"PRIuFAST64"\n",
+                        atomic_load_explicit(f == 0 ? &site->acquires
+                                                    : &site->contended,
+                                             memory_order_relaxed));
+                    break;
+                case 2:
+                    PrintSeconds(ms, atomic_load_explicit(&site->wait_total,
+                                                          memory_order_relaxed));
+                    break;
+                case 3:
+                    PrintSeconds(ms, atomic_load_explicit(&site->wait_max,
+                                                          memory_order_relaxed));
+                    break;
+                case 4:
+                    PrintSeconds(ms, atomic_load_explicit(&site->hold_total,
+                                                          memory_order_relaxed));
+                    break;
+                case 5:
+                    PrintSeconds(ms, atomic_load_explicit(&site->hold_max,
+                                                          memory_order_relaxed));
+                    break;
+            }
+        }
+    }
+    free(list);
+}
+
+static int CompareWait(const void *a, const void *b)
+{
+    const struct vlc_lock_site *sa = *(const struct vlc_lock_site **)a;
+    const struct vlc_lock_site *sb = *(const struct vlc_lock_site **)b;
+    int_fast64_t wa = atomic_load_explicit(&sa->wait_total,
+                                           memory_order_relaxed);
+    int_fast64_t wb = atomic_load_explicit(&sb->wait_total,
+                                           memory_order_relaxed);
+
+    return (wa < wb) - (wa > wb);
+}
+
+/**
+ * Prints the contended sites by decreasing total wait time.
+ */
+static void Dump(FILE *out)
+{
+    static struct vlc_lock_site *list[SITE_COUNT + 1];
+    size_t count = ListSites(list);
+
+    qsort(list, count, sizeof (*list), CompareWait);
+
+    fprintf(out, "VLC mutex contention:\n%12s %10s %8s %12s %12s %12s  %s\n",
+            "acquires", "contended", "ratio", "wait ms", "max wait us",
+            "max hold us", "site");
+    for (size_t i = 0; i < count; i++)
+    {
+        struct vlc_lock_site *site = list[i];
+        uint_fast64_t acquires = atomic_load_explicit(&site->acquires,
+                                                      memory_order_relaxed);
+        uint_fast64_t contended = atomic_load_explicit(&site->contended,
+                                                       memory_order_relaxed);
+
+        if (contended == 0)
+            continue;
+
+        fprintf(out, "%12"PRIuFAST64" %10"PRIuFAST64" %7.2f%% %12"PRId64
+                " %12"PRId64" %12"PRId64"  %s\n", acquires, contended,
+                100. * contended / acquires,
+                MS_FROM_VLC_TICK(atomic_load_explicit(&site->wait_total,
+                                                      memory_order_relaxed)),
+                US_FROM_VLC_TICK(atomic_load_explicit(&site->wait_max,
+                                                      memory_order_relaxed)),
+                US_FROM_VLC_TICK(atomic_load_explicit(&site->hold_max,
+                                                      memory_order_relaxed)),
+                SiteName(site));
+    }
+}
+
+void vlc_lock_profile_Init(libvlc_int_t *vlc)
+{
+    if (!var_InheritBool(vlc, "lock-profile"))
+        return;
+
+    vlc_mutex_lock(&instances_lock);
+    if (instances++ == 0)
+        atomic_store_explicit(&vlc_lock_profiling, true,
+                              memory_order_relaxed);
+    if (tracer_owner == NULL)
+    {
+        struct vlc_tracer *t = vlc_object_get_tracer(VLC_OBJECT(vlc));
+        if (t != NULL)
+        {
+            tracer_owner = vlc;
+            atomic_store_explicit(&tracer, t, memory_order_release);
+        }
+    }
+    vlc_mutex_unlock(&instances_lock);
+}
+
+void vlc_lock_profile_Destroy(libvlc_int_t *vlc)
+{
+    if (!var_InheritBool(vlc, "lock-profile"))
+        return;
+
+    vlc_mutex_lock(&instances_lock);
+    assert(instances > 0);
+    if (tracer_owner == vlc)
+    {
+        atomic_store_explicit(&tracer, NULL, memory_order_release);
+        tracer_owner = NULL;
+    }
+    if (--instances == 0)
+    {
+        atomic_store_explicit(&vlc_lock_profiling, false,
+                              memory_order_relaxed);
+        Dump(stderr);
+    }
+    vlc_mutex_unlock(&instances_lock);
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************
+ * lock_profile.h: mutex contention profiling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_LOCK_PROFILE_H
+# define LIBVLC_LOCK_PROFILE_H 1
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include <vlc_common.h>
+
+struct vlc_memstream;
+
+/* The caller of the mutex function identifies the lock site */
+#if defined (__GNUC__)
+# define vlc_lock_caller() __builtin_return_address(0)
+#else
+# define vlc_lock_caller() NULL
+#endif
+
+extern atomic_bool vlc_lock_profiling;
+
+/**
+ * Whether the mutexes are profiled, i.e. the "lock-profile" option of any
+ * LibVLC instance is enabled.
+ */
+static inline bool vlc_lock_profile_Enabled(void)
+{
+    return atomic_load_explicit(&vlc_lock_profiling, memory_order_relaxed);
+}
+
+/**
+ * Records the initialization of a mutex.
+ *
+ * \param caller the caller of vlc_mutex_init(), which identifies the site
+ * the statistics of the mutex are accounted to
+ */
+void vlc_lock_profile_Created(const vlc_mutex_t *, const void *caller);
+
+/**
+ * Records the acquisition of a mutex (but not the recursive ones).
+ *
+ * \param caller the caller of the lock function, used as the site of the
+ * mutexes initialized statically or before profiling
+ * \param wait the time spent waiting for a contended mutex, or -1 if the
+ * mutex was acquired without contention
+ */
+void vlc_lock_profile_Acquired(const vlc_mutex_t *, const void *caller,
+                               vlc_tick_t wait);
+
+/**
+ * Records the release of a mutex (but not the recursive ones).
+ */
+void vlc_lock_profile_Released(const vlc_mutex_t *);
+
+/**
+ * Appends the statistics of the mutexes per site in the OpenMetrics text
+ * format.
+ */
+void vlc_lock_profile_FormatMetrics(struct vlc_memstream *);
+
+#endif
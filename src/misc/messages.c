@@ -35,8 +35,10 @@
 #include <stdarg.h>                                       /* va_list for BSD */
 #include <unistd.h>
 #include <assert.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
@@ -438,6 +440,252 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that formats messages on the calling thread, queues them
+ * without locking and writes them to its backend from a background thread,
+ * so that slow (disk or console) loggers do not stall the callers.
+ */
+typedef struct vlc_log_async_t
+{
+    struct vlc_log_async_t *next;
+    int type;
+    vlc_log_t meta;
+    char text[]; /* message, then module, then header */
+} vlc_log_async_t;
+
+#define VLC_LOG_ASYNC_STOP  0x80000000u
+#define VLC_LOG_ASYNC_SITES 256
+
+struct vlc_logger_async {
+    struct vlc_logger logger;
+    struct vlc_logger *backend;
+    vlc_thread_t thread;
+
+    _Atomic(vlc_log_async_t *) head; /**< LIFO of the queued messages */
+    atomic_uint pending; /**< Queued message count, and the stop flag */
+    atomic_uint wake; /**< Bumped when the queue becomes non-empty */
+    atomic_uint dropped;
+    unsigned max_pending;
+
+    /* Per message site (file and line) rate limiting */
+    unsigned rate_limit; /**< Messages per second and site, 0 if none */
+    _Atomic uint64_t sites[VLC_LOG_ASYNC_SITES]; /**< second << 32 | count */
+};
+
+static bool vlc_LogAsyncAllowed(struct vlc_logger_async *async,
+                                const vlc_log_t *item)
+{
+    if (async->rate_limit == 0)
+        return true;
+
+    size_t idx = ((uintptr_t)item->file ^ (item->line * 2654435761u))
+                 % VLC_LOG_ASYNC_SITES;
+    _Atomic uint64_t *site = &async->sites[idx];
+    uint64_t second = SEC_FROM_VLC_TICK(vlc_tick_now()) & UINT32_MAX;
+    uint64_t val = atomic_load_explicit(site, memory_order_relaxed);
+    uint64_t newval;
+
+    do
+    {
+        if ((val >> 32) != second)
+            newval = (second << 32) | 1;
+        else if ((val & UINT32_MAX) >= async->rate_limit)
+            return false;
+        else
+            newval = val + 1;
+    }
+    while (!atomic_compare_exchange_weak_explicit(site, &val, newval,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+    return true;
+}
+
+static void vlc_LogAsyncWake(struct vlc_logger_async *async)
+{
+    atomic_fetch_add(&async->wake, 1);
+    vlc_atomic_notify_one(&async->wake);
+}
+
+/* Releases a message counted but not queued */
+static void vlc_LogAsyncUncount(struct vlc_logger_async *async)
+{
+    unsigned count = atomic_fetch_sub_explicit(&async->pending, 1,
+                                               memory_order_relaxed);
+    /* The thread may be waiting for this message to stop */
+    if (count - 1 == VLC_LOG_ASYNC_STOP)
+        vlc_LogAsyncWake(async);
+}
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+
+    /* Errors are never rate limited */
+    if (type != VLC_MSG_ERR && !vlc_LogAsyncAllowed(async, item))
+        goto drop;
+
+    unsigned count = atomic_fetch_add_explicit(&async->pending, 1,
+                                               memory_order_relaxed);
+    if ((count & ~VLC_LOG_ASYNC_STOP) >= async->max_pending)
+    {
+        vlc_LogAsyncUncount(async);
+        goto drop;
+    }
+
+    va_list aq;
+    va_copy(aq, ap);
+    int len = vsnprintf(NULL, 0, format, aq);
+    va_end(aq);
+    if (len < 0)
+        len = 0;
+
+    size_t modlen = strlen(item->psz_module) + 1;
+    size_t headlen = item->psz_header ? strlen(item->psz_header) + 1 : 0;
+    vlc_log_async_t *log = malloc(sizeof (*log) + len + 1 + modlen + headlen);
+    if (unlikely(log == NULL))
+    {
+        vlc_LogAsyncUncount(async);
+        goto drop;
+    }
+
+    vsnprintf(log->text, len + 1, format, ap);
+    log->type = type;
+    log->meta = *item;
+    /* The module name and the header may not outlive the call */
+    log->meta.psz_module = memcpy(log->text + len + 1, item->psz_module,
+                                  modlen);
+    if (headlen > 0)
+        log->meta.psz_header = memcpy(log->text + len + 1 + modlen,
+                                      item->psz_header, headlen);
+
+    log->next = atomic_load_explicit(&async->head, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak(&async->head, &log->next, log));
+
+    if (log->next == NULL)
+        vlc_LogAsyncWake(async);
+    return;
+
+drop:
+    atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+    struct vlc_logger *backend = async->backend;
+
+    for (;;)
+    {
+        unsigned wake = atomic_load(&async->wake);
+        vlc_log_async_t *log = atomic_exchange(&async->head, NULL);
+
+        if (log == NULL)
+        {
+            /* Messages may be counted but not queued yet: then wait for them
+             * rather than spin */
+            if (atomic_load_explicit(&async->pending, memory_order_relaxed)
+                 == VLC_LOG_ASYNC_STOP)
+                break;
+            vlc_atomic_wait(&async->wake, wake);
+            continue;
+        }
+
+        /* Restore the chronological order */
+        vlc_log_async_t *fifo = NULL;
+        unsigned n = 0;
+
+        while (log != NULL)
+        {
+            vlc_log_async_t *next = log->next;
+
+            log->next = fifo;
+            fifo = log;
+            log = next;
+            n++;
+        }
+
+        for (log = fifo; log != NULL; log = fifo)
+        {
+            fifo = log->next;
+            vlc_LogCallback(backend, log->type, &log->meta, "%s", log->text);
+            free(log);
+        }
+        atomic_fetch_sub_explicit(&async->pending, n, memory_order_relaxed);
+
+        unsigned dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                                    memory_order_relaxed);
+        if (dropped > 0)
+        {
+            const vlc_log_t meta = {
+                .psz_object_type = "logger",
+                .psz_module = "main",
+                .file = __FILE__,
+                .line = __LINE__,
+                .func = __func__,
+                .tid = vlc_thread_id(),
+            };
+
+            vlc_LogCallback(backend, VLC_MSG_WARN, &meta,
+                            "%u message(s) dropped", dropped);
+        }
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+
+    /* The queued messages are drained before the thread exits */
+    atomic_fetch_or_explicit(&async->pending, VLC_LOG_ASYNC_STOP,
+                             memory_order_relaxed);
+    vlc_LogAsyncWake(async);
+    vlc_join(async->thread, NULL);
+
+    async->backend->ops->destroy(async->backend);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *backend,
+                                             unsigned max_pending,
+                                             unsigned rate_limit)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->logger.ops = &async_ops;
+    async->backend = backend;
+    atomic_init(&async->head, NULL);
+    atomic_init(&async->pending, 0);
+    atomic_init(&async->wake, 0);
+    atomic_init(&async->dropped, 0);
+    async->max_pending = max_pending;
+    async->rate_limit = rate_limit;
+    for (size_t i = 0; i < VLC_LOG_ASYNC_SITES; i++)
+        atomic_init(&async->sites[i], 0);
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        free(async);
+        return NULL;
+    }
+    return &async->logger;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -447,6 +695,14 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async"))
+    {
+        struct vlc_logger *async = vlc_LogAsyncCreate(logger,
+                                var_InheritInteger(vlc, "log-async-queue"),
+                                var_InheritInteger(vlc, "log-rate-limit"));
+        if (async != NULL)
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
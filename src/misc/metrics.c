@@ -0,0 +1,261 @@
+/*****************************************************************************
+ * metrics.c: performance metrics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+#include <vlc_memstream.h>
+#include <vlc_metrics.h>
+#include "../libvlc.h"
+#include "alloc_profile.h"
+#include "lock_profile.h"
+
+/* The upper bound of the bucket i is 2^i units (microseconds or bytes), up
+ * to 2^27: about 134 s or 128 MiB */
+#define BUCKET_COUNT 28
+
+struct vlc_histogram
+{
+    struct vlc_list node;
+    char *name;
+    char *labels;
+    char *help;
+    enum vlc_metric_unit unit;
+
+    atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t buckets[BUCKET_COUNT + 1]; /**< last one is +Inf */
+};
+
+struct vlc_metrics
+{
+    vlc_mutex_t lock;
+    struct vlc_list histograms;
+};
+
+int vlc_metrics_Init(libvlc_int_t *vlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc);
+
+    priv->metrics = NULL;
+    if (!var_InheritBool(vlc, "metrics"))
+        return VLC_SUCCESS;
+
+    struct vlc_metrics *metrics = malloc(sizeof (*metrics));
+    if (unlikely(metrics == NULL))
+        return VLC_ENOMEM;
+
+    vlc_mutex_init(&metrics->lock);
+    vlc_list_init(&metrics->histograms);
+    priv->metrics = metrics;
+    return VLC_SUCCESS;
+}
+
+void vlc_metrics_Destroy(libvlc_int_t *vlc)
+{
+    struct vlc_metrics *metrics = libvlc_priv(vlc)->metrics;
+    if (metrics == NULL)
+        return;
+
+    struct vlc_histogram *h;
+    vlc_list_foreach(h, &metrics->histograms, node)
+    {
+        free(h->name);
+        free(h->labels);
+        free(h->help);
+        free(h);
+    }
+    free(metrics);
+}
+
+static bool StrEqual(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return !strcmp(a, b);
+}
+
+#undef vlc_histogram_Get
+struct vlc_histogram *
+vlc_histogram_Get(vlc_object_t *obj, const char *name, const char *labels,
+                  const char *help, enum vlc_metric_unit unit)
+{
+    struct vlc_metrics *metrics = libvlc_priv(vlc_object_instance(obj))->metrics;
+    if (metrics == NULL)
+        return NULL;
+
+    struct vlc_histogram *h;
+
+    vlc_mutex_lock(&metrics->lock);
+    vlc_list_foreach(h, &metrics->histograms, node)
+        if (!strcmp(h->name, name) && StrEqual(h->labels, labels))
+            goto out;
+
+    h = malloc(sizeof (*h));
+    if (unlikely(h == NULL))
+        goto out;
+
+    h->name = strdup(name);
+    h->labels = labels != NULL ? strdup(labels) : NULL;
+    h->help = strdup(help);
+    if (unlikely(h->name == NULL || h->help == NULL
+              || (labels != NULL && h->labels == NULL)))
+    {
+        free(h->name);
+        free(h->labels);
+        free(h->help);
+        free(h);
+        h = NULL;
+        goto out;
+    }
+
+    h->unit = unit;
+    atomic_init(&h->sum, 0);
+    for (size_t i = 0; i <= BUCKET_COUNT; i++)
+        atomic_init(&h->buckets[i], 0);
+    vlc_list_append(&h->node, &metrics->histograms);
+out:
+    vlc_mutex_unlock(&metrics->lock);
+    return h;
+}
+
+void vlc_histogram_Observe(struct vlc_histogram *h, int64_t value)
+{
+    if (h == NULL)
+        return;
+
+    if (h->unit == VLC_METRIC_SECONDS)
+        value = US_FROM_VLC_TICK(value);
+    if (value < 0)
+        value = 0;
+
+    /* smallest i such that value <= 2^i */
+    unsigned i = value > 1 ? 64 - vlc_clzll(value - 1) : 0;
+    if (i > BUCKET_COUNT)
+        i = BUCKET_COUNT;
+
+    atomic_fetch_add_explicit(&h->buckets[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+}
+
+/* Print a value in the unit of the histogram, without depending on the
+ * locale */
+static void PrintValue(struct vlc_memstream *ms, enum vlc_metric_unit unit,
+                       uint_fast64_t value)
+{
+    if (unit == VLC_METRIC_SECONDS)
+        vlc_memstream_printf(ms, "%"PRIuFAST64".%06"PRIuFAST64,
+                             value / 1000000, value % 1000000);
+    else
+        vlc_memstream_printf(ms, "%"PRIuFAST64, value);
+}
+
+static void PrintHistogram(struct vlc_memstream *ms,
+                           const struct vlc_histogram *h)
+{
+    const char *labels = h->labels != NULL ? h->labels : "";
+    const char *sep = h->labels != NULL ? "," : "";
+    uint_fast64_t cumulated = 0;
+
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulated += atomic_load_explicit(&h->buckets[i],
+                                          memory_order_relaxed);
+        vlc_memstream_printf(ms, "%s_bucket{%s%sle=\"", h->name, labels, sep);
+        PrintValue(ms, h->unit, UINT64_C(1) << i);
+        vlc_memstream_printf(ms, "\"} %"PRIuFAST64"\n", cumulated);
+    }
+    cumulated += atomic_load_explicit(&h->buckets[BUCKET_COUNT],
+                                      memory_order_relaxed);
+    vlc_memstream_printf(ms, "%s_bucket{%s%sle=\"+Inf\"} %"PRIuFAST64"\n",
+                         h->name, labels, sep, cumulated);
+
+    /* the count is the +Inf bucket, keep them consistent under updates */
+    if (h->labels != NULL)
+    {
+        vlc_memstream_printf(ms, "%s_count{%s} %"PRIuFAST64"\n", h->name,
+                             labels, cumulated);
+        vlc_memstream_printf(ms, "%s_sum{%s} ", h->name, labels);
+    }
+    else
+    {
+        vlc_memstream_printf(ms, "%s_count %"PRIuFAST64"\n", h->name,
+                             cumulated);
+        vlc_memstream_printf(ms, "%s_sum ", h->name);
+    }
+    PrintValue(ms, h->unit, atomic_load_explicit(&h->sum,
+                                                 memory_order_relaxed));
+    vlc_memstream_putc(ms, '\n');
+}
+
+#undef vlc_metrics_Format
+char *vlc_metrics_Format(vlc_object_t *obj)
+{
+    struct vlc_metrics *metrics = libvlc_priv(vlc_object_instance(obj))->metrics;
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms))
+        return NULL;
+
+    if (metrics != NULL)
+    {
+        struct vlc_histogram *h, *other;
+
+        vlc_mutex_lock(&metrics->lock);
+        vlc_list_foreach(h, &metrics->histograms, node)
+        {
+            /* print each family once, with all its label sets */
+            bool printed = false;
+            vlc_list_foreach(other, &metrics->histograms, node)
+            {
+                if (other == h)
+                    break;
+                if (!strcmp(other->name, h->name))
+                {
+                    printed = true;
+                    break;
+                }
+            }
+            if (printed)
+                continue;
+
+            vlc_memstream_printf(&ms, "# TYPE %s histogram\n", h->name);
+            vlc_memstream_printf(&ms, "# HELP %s %s\n", h->name, h->help);
+            vlc_list_foreach(other, &metrics->histograms, node)
+                if (!strcmp(other->name, h->name))
+                    PrintHistogram(&ms, other);
+        }
+        vlc_mutex_unlock(&metrics->lock);
+    }
+
+    vlc_alloc_profile_FormatMetrics(&ms);
+    vlc_lock_profile_FormatMetrics(&ms);
+    vlc_memstream_puts(&ms, "# EOF\n");
+
+    if (vlc_memstream_close(&ms))
+        return NULL;
+    return ms.ptr;
+}
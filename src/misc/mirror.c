@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * mirror.c: mirrored ring buffers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_mirror.h>
+
+#ifdef HAVE_MMAP
+void *vlc_mirror_Alloc(size_t size)
+{
+    long page_mask = sysconf(_SC_PAGESIZE) - 1;
+
+    if (size == 0 || (size & page_mask) || size > SIZE_MAX / 2)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    int fd = vlc_memfd();
+    if (fd == -1)
+        return NULL;
+
+    char *base = MAP_FAILED;
+
+    if (ftruncate(fd, size) == 0)
+        /* Reserve the address space for both copies */
+        base = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1, 0);
+    if (base != MAP_FAILED
+     && (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+              fd, 0) == MAP_FAILED
+      || mmap(base + size, size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+    {
+        munmap(base, 2 * size);
+        base = MAP_FAILED;
+    }
+
+    /* The mappings keep the memory alive */
+    vlc_close(fd);
+    return (base != MAP_FAILED) ? base : NULL;
+}
+
+void vlc_mirror_Free(void *addr, size_t size)
+{
+    munmap(addr, 2 * size);
+}
+#else
+void *vlc_mirror_Alloc(size_t size)
+{
+    (void) size;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void vlc_mirror_Free(void *addr, size_t size)
+{
+    (void) addr; (void) size;
+    vlc_assert_unreachable();
+}
+#endif
@@ -67,7 +67,9 @@ int vlc_object_init(vlc_object_t *restrict obj, vlc_object_t *parent,
 
     priv->parent = parent;
     priv->typename = typename;
-    priv->var_root = NULL;
+    priv->var_table = NULL;
+    priv->var_size = priv->var_count = 0;
+    atomic_init(&priv->var_names, 0);
     vlc_mutex_init (&priv->var_lock);
     priv->resources = NULL;
 
@@ -101,6 +103,13 @@ void *(vlc_custom_create)(vlc_object_t *parent, size_t length,
     return obj;
 }
 
+void vlc_object_reparent(vlc_object_t *obj, vlc_object_t *parent)
+{
+    assert(parent != NULL);
+    vlc_internals(obj)->parent = parent;
+    obj->logger = parent->logger;
+}
+
 void *(vlc_object_create)(vlc_object_t *p_this, size_t i_size)
 {
     return vlc_custom_create( p_this, i_size, "generic" );
@@ -35,6 +35,7 @@
 
 #include <vlc_common.h>
 #include "picture.h"
+#include "../libvlc.h"
 #include <vlc_image.h>
 #include <vlc_block.h>
 
@@ -71,6 +72,17 @@ static void picture_DestroyFromFormat(picture_t *pic)
         picture_Deallocate(res->fd, res->base, res->size);
 }
 
+/**
+ * Destroys a picture allocated with picture_NewCached().
+ */
+static void picture_DestroyFromCache(picture_t *pic)
+{
+    picture_priv_t *priv = container_of(pic, picture_priv_t, picture);
+    picture_buffer_t *res = pic->p_sys;
+
+    picture_cache_Put(priv->gc.opaque, res->fd, res->base, res->size);
+}
+
 VLC_WEAK void *picture_Allocate(int *restrict fdp, size_t size)
 {
     assert((size % 64) == 0);
@@ -85,6 +97,11 @@ VLC_WEAK void picture_Deallocate(int fd, void *base, size_t size)
     assert((size % 64) == 0);
 }
 
+VLC_WEAK void picture_SetupAllocator(libvlc_int_t *libvlc)
+{
+    (void) libvlc;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
@@ -212,6 +229,7 @@ static bool picture_InitPrivate(const video_format_t *restrict p_fmt,
 
     vlc_atomic_rc_init(&p_picture->refs);
     priv->gc.opaque = NULL;
+    priv->alloc.site = NULL;
 
     p_picture->p_sys = p_resource->p_sys;
 
@@ -256,7 +274,9 @@ struct picture_priv_buffer_t {
     picture_buffer_t res;
 };
 
-picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
+static picture_t *PictureNewFromFormat(const video_format_t *restrict fmt,
+                                       struct vlc_picture_cache *cache,
+                                       const void *caller)
 {
     static_assert(offsetof(struct picture_priv_buffer_t, priv)==0,
                   "misplaced picture_priv_t, destroy won't work");
@@ -269,7 +289,8 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
 
     picture_resource_t pic_res = {
         .p_sys = res,
-        .pf_destroy = picture_DestroyFromFormat,
+        .pf_destroy = cache != NULL ? picture_DestroyFromCache
+                                    : picture_DestroyFromFormat,
     };
 
     picture_priv_t *priv = &privbuf->priv;
@@ -279,6 +300,7 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     picture_t *pic = &priv->picture;
     if (pic->i_planes == 0) {
         pic->p_sys = NULL; // not compatible with picture_DestroyFromFormat
+        priv->gc.destroy = picture_DestroyDummy;
         return pic;
     }
 
@@ -299,7 +321,9 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     if (unlikely(pic_size >= PICTURE_SW_SIZE_MAX))
         goto error;
 
-    unsigned char *buf = picture_Allocate(&res->fd, pic_size);
+    unsigned char *buf = cache != NULL
+                       ? picture_cache_Take(cache, &res->fd, pic_size)
+                       : picture_Allocate(&res->fd, pic_size);
     if (unlikely(buf == NULL))
         goto error;
 
@@ -314,12 +338,37 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
         buf += plane_sizes[i];
     }
 
+    priv->gc.opaque = cache;
+    if (unlikely(vlc_alloc_profile_Enabled()))
+        vlc_alloc_profile_Alloc(&priv->alloc, VLC_ALLOC_PICTURE, caller,
+                                pic_size);
     return pic;
 error:
     free(privbuf);
     return NULL;
 }
 
+picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
+{
+    return PictureNewFromFormat(fmt, NULL, vlc_alloc_caller());
+}
+
+#undef picture_NewCached
+picture_t *picture_NewCached(vlc_object_t *obj,
+                             const video_format_t *restrict fmt)
+{
+    const void *caller = vlc_alloc_caller();
+    struct vlc_picture_cache *cache = picture_cache_Hold(obj);
+    if (cache == NULL)
+        return PictureNewFromFormat(fmt, NULL, caller);
+
+    picture_t *pic = PictureNewFromFormat(fmt, cache, caller);
+    /* Pictures without planes do not use the cache */
+    if (pic == NULL || pic->p_sys == NULL)
+        picture_cache_Release(cache);
+    return pic;
+}
+
 picture_t *picture_New( vlc_fourcc_t i_chroma, int i_width, int i_height, int i_sar_num, int i_sar_den )
 {
     video_format_t fmt;
@@ -328,7 +377,7 @@ picture_t *picture_New( vlc_fourcc_t i_chroma, int i_width, int i_height, int i_
     video_format_Setup( &fmt, i_chroma, i_width, i_height,
                         i_width, i_height, i_sar_num, i_sar_den );
 
-    return picture_NewFromFormat( &fmt );
+    return PictureNewFromFormat( &fmt, NULL, vlc_alloc_caller() );
 }
 
 /*****************************************************************************
@@ -344,6 +393,7 @@ void picture_Destroy(picture_t *picture)
     picture_priv_t *priv = container_of(picture, picture_priv_t, picture);
     assert(priv->gc.destroy != NULL);
     priv->gc.destroy(picture);
+    vlc_alloc_profile_Free(&priv->alloc);
     free(priv);
 }
 
@@ -22,6 +22,7 @@
 #include <stddef.h>
 
 #include <vlc_picture.h>
+#include "alloc_profile.h"
 
 typedef struct
 {
@@ -31,9 +32,30 @@ typedef struct
         void (*destroy)(picture_t *);
         void *opaque;
     } gc;
+    struct vlc_alloc_tag alloc; /**< profiling of the picture buffers */
 } picture_priv_t;
 
 void *picture_Allocate(int *, size_t);
 void picture_Deallocate(int, void *, size_t);
 
 picture_t * picture_InternalClone(picture_t *, void (*pf_destroy)(picture_t *), void *);
+
+struct vlc_picture_cache;
+
+/**
+ * Gets a reference to the picture buffers cache of the instance.
+ *
+ * \return the cache, or NULL if it is disabled
+ */
+struct vlc_picture_cache *picture_cache_Hold(vlc_object_t *);
+void picture_cache_Release(struct vlc_picture_cache *);
+
+/**
+ * Takes a buffer of the given size from the cache, or allocates one.
+ */
+void *picture_cache_Take(struct vlc_picture_cache *, int *, size_t);
+
+/**
+ * Returns a buffer to the cache and releases the reference of the picture.
+ */
+void picture_cache_Put(struct vlc_picture_cache *, int, void *, size_t);
@@ -0,0 +1,230 @@
+/*****************************************************************************
+ * picture_cache.c : recycling of picture buffers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_list.h>
+#include "picture.h"
+#include "../libvlc.h"
+
+/**
+ * Unused buffer. The bookkeeping is stored in the buffer itself, which is
+ * always at least 64 bytes large and 64 bytes aligned.
+ */
+struct picture_cache_entry
+{
+    struct vlc_list node;
+    size_t size;
+    int fd;
+};
+
+struct vlc_picture_cache
+{
+    vlc_atomic_rc_t refs; /**< The instance and every cached picture */
+    vlc_mutex_t lock;
+    struct vlc_list entries; /**< Unused buffers, most recent first */
+    size_t max_size;
+    unsigned max_count;
+    bool closed; /**< The instance is being destroyed */
+    struct vlc_picture_cache_stats stats;
+};
+
+static_assert(sizeof (struct picture_cache_entry) <= 64,
+              "picture cache entry does not fit in the smallest buffer");
+
+void picture_cache_Release(struct vlc_picture_cache *cache)
+{
+    if (!vlc_atomic_rc_dec(&cache->refs))
+        return;
+
+    assert(vlc_list_is_empty(&cache->entries));
+    free(cache);
+}
+
+static void picture_cache_DeleteEntry(struct picture_cache_entry *entry)
+{
+    int fd = entry->fd;
+    size_t size = entry->size;
+
+    picture_Deallocate(fd, entry, size);
+}
+
+struct vlc_picture_cache *picture_cache_Hold(vlc_object_t *obj)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(obj));
+    struct vlc_picture_cache *cache;
+
+    vlc_mutex_lock(&priv->lock);
+    cache = priv->picture_cache;
+    if (cache == NULL)
+    {
+        int64_t size = var_InheritInteger(obj, "picture-cache-size");
+        int64_t count = var_InheritInteger(obj, "picture-cache-count");
+
+        cache = malloc(sizeof (*cache));
+        if (likely(cache != NULL))
+        {
+            vlc_atomic_rc_init(&cache->refs);
+            vlc_mutex_init(&cache->lock);
+            vlc_list_init(&cache->entries);
+            cache->max_size = size > 0 ? (size_t)size << 20 : 0;
+            cache->max_count = count > 0 ? count : 0;
+            cache->closed = false;
+            cache->stats = (struct vlc_picture_cache_stats) { 0 };
+            priv->picture_cache = cache;
+        }
+    }
+
+    if (cache != NULL && cache->max_size > 0 && cache->max_count > 0)
+        vlc_atomic_rc_inc(&cache->refs);
+    else
+        cache = NULL;
+    vlc_mutex_unlock(&priv->lock);
+    return cache;
+}
+
+void *picture_cache_Take(struct vlc_picture_cache *cache, int *restrict fdp,
+                         size_t size)
+{
+    struct picture_cache_entry *entry, *found = NULL;
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_list_foreach(entry, &cache->entries, node)
+        if (entry->size == size)
+        {
+            vlc_list_remove(&entry->node);
+            cache->stats.cached_size -= size;
+            cache->stats.cached_count--;
+            found = entry;
+            break;
+        }
+
+    if (found != NULL)
+        cache->stats.hits++;
+    else
+        cache->stats.misses++;
+    vlc_mutex_unlock(&cache->lock);
+
+    if (found == NULL)
+        return picture_Allocate(fdp, size);
+
+    *fdp = found->fd;
+    return found;
+}
+
+void picture_cache_Put(struct vlc_picture_cache *cache, int fd, void *base,
+                       size_t size)
+{
+    struct picture_cache_entry *entry = base;
+    struct vlc_list evicted;
+
+    entry->size = size;
+    entry->fd = fd;
+    vlc_list_init(&evicted);
+
+    vlc_mutex_lock(&cache->lock);
+    if (!cache->closed && size <= cache->max_size)
+    {
+        /* Evict the least recently used buffers */
+        while (cache->stats.cached_count >= cache->max_count
+            || cache->stats.cached_size + size > cache->max_size)
+        {
+            struct picture_cache_entry *last =
+                vlc_list_last_entry_or_null(&cache->entries,
+                                            struct picture_cache_entry, node);
+            assert(last != NULL);
+            vlc_list_remove(&last->node);
+            vlc_list_append(&last->node, &evicted);
+            cache->stats.cached_size -= last->size;
+            cache->stats.cached_count--;
+            cache->stats.evictions++;
+        }
+
+        vlc_list_prepend(&entry->node, &cache->entries);
+        cache->stats.cached_size += size;
+        cache->stats.cached_count++;
+        entry = NULL;
+    }
+    vlc_mutex_unlock(&cache->lock);
+
+    if (entry != NULL)
+        picture_cache_DeleteEntry(entry);
+
+    struct picture_cache_entry *e;
+    vlc_list_foreach(e, &evicted, node)
+        picture_cache_DeleteEntry(e);
+
+    picture_cache_Release(cache);
+}
+
+void picture_cache_Destroy(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    struct vlc_picture_cache *cache = priv->picture_cache;
+
+    if (cache == NULL)
+        return;
+
+    vlc_mutex_lock(&cache->lock);
+    if (cache->stats.hits + cache->stats.misses > 0)
+        msg_Dbg(libvlc, "picture cache: %" PRIu64 " hits, %" PRIu64 " misses, "
+                "%" PRIu64 " evictions", cache->stats.hits,
+                cache->stats.misses, cache->stats.evictions);
+
+    /* The pictures still alive will free their buffers */
+    cache->closed = true;
+
+    struct picture_cache_entry *entry;
+    vlc_list_foreach(entry, &cache->entries, node)
+    {
+        vlc_list_remove(&entry->node);
+        picture_cache_DeleteEntry(entry);
+    }
+    cache->stats.cached_size = 0;
+    cache->stats.cached_count = 0;
+    vlc_mutex_unlock(&cache->lock);
+
+    priv->picture_cache = NULL;
+    picture_cache_Release(cache);
+}
+
+#undef picture_GetCacheStats
+void picture_GetCacheStats(vlc_object_t *obj,
+                           struct vlc_picture_cache_stats *stats)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(obj));
+
+    *stats = (struct vlc_picture_cache_stats) { 0 };
+
+    vlc_mutex_lock(&priv->lock);
+    struct vlc_picture_cache *cache = priv->picture_cache;
+    if (cache != NULL)
+    {
+        vlc_mutex_lock(&cache->lock);
+        *stats = cache->stats;
+        vlc_mutex_unlock(&cache->lock);
+    }
+    vlc_mutex_unlock(&priv->lock);
+}
@@ -39,20 +39,26 @@
 struct picture_fifo_t {
     vlc_mutex_t lock;
     vlc_picture_chain_t pics;
+    size_t count;
 };
 
 static void PictureFifoReset(picture_fifo_t *fifo)
 {
     vlc_picture_chain_Init( &fifo->pics );
+    fifo->count = 0;
 }
 static void PictureFifoPush(picture_fifo_t *fifo, picture_t *picture)
 {
     assert(!picture_HasChainedPics(picture));
     vlc_picture_chain_Append( &fifo->pics, picture );
+    fifo->count++;
 }
 static picture_t *PictureFifoPop(picture_fifo_t *fifo)
 {
-    return vlc_picture_chain_PopFront( &fifo->pics );
+    picture_t *picture = vlc_picture_chain_PopFront( &fifo->pics );
+    if (picture != NULL)
+        fifo->count--;
+    return picture;
 }
 
 picture_fifo_t *picture_fifo_New(void)
@@ -88,6 +94,14 @@ bool picture_fifo_IsEmpty(picture_fifo_t *fifo)
 
     return empty;
 }
+size_t picture_fifo_Count(picture_fifo_t *fifo)
+{
+    vlc_mutex_lock(&fifo->lock);
+    size_t count = fifo->count;
+    vlc_mutex_unlock(&fifo->lock);
+
+    return count;
+}
 void picture_fifo_Flush(picture_fifo_t *fifo, vlc_tick_t date, bool flush_before)
 {
     picture_t *picture;
@@ -97,11 +111,13 @@ void picture_fifo_Flush(picture_fifo_t *fifo, vlc_tick_t date, bool flush_before
     vlc_picture_chain_Init(&flush_chain);
 
     vlc_mutex_lock(&fifo->lock);
-    if (date == VLC_TICK_INVALID)
+    if (date == VLC_TICK_INVALID) {
         vlc_picture_chain_GetAndClear(&fifo->pics, &flush_chain);
-    else {
+        fifo->count = 0;
+    } else {
         vlc_picture_chain_t filter_chain;
         vlc_picture_chain_GetAndClear(&fifo->pics, &filter_chain);
+        fifo->count = 0;
 
         while ( !vlc_picture_chain_IsEmpty( &filter_chain ) ) {
             picture = vlc_picture_chain_PopFront( &filter_chain );
@@ -0,0 +1,430 @@
+/*****************************************************************************
+ * thread_policy.c: per-role thread scheduling and CPU affinity
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include "../libvlc.h"
+#include "thread_policy.h"
+
+#if defined (LIBVLC_USE_PTHREAD)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+/*
+ * The policy is written once by the first LibVLC instance, before it starts
+ * any thread, then only read: from then on, the per-role entries are
+ * accessed without locking.
+ */
+static struct vlc_thread_policy policies[VLC_THREAD_ROLES];
+static bool policy_set[VLC_THREAD_ROLES];
+static atomic_bool configured = false;
+static atomic_flag configuring = ATOMIC_FLAG_INIT;
+
+static const char *const role_names[VLC_THREAD_ROLES] = {
+    [VLC_THREAD_ROLE_LOW] = "low",
+    [VLC_THREAD_ROLE_INPUT] = "input",
+    [VLC_THREAD_ROLE_AUDIO] = "audio",
+    [VLC_THREAD_ROLE_VIDEO] = "video",
+    [VLC_THREAD_ROLE_OUTPUT] = "output",
+    [VLC_THREAD_ROLE_HWDEC] = "hwdec",
+};
+
+static const struct
+{
+    char name[6];
+    enum vlc_thread_sched sched;
+} sched_names[] = {
+    { "other", VLC_THREAD_SCHED_OTHER },
+    { "batch", VLC_THREAD_SCHED_BATCH },
+    { "idle",  VLC_THREAD_SCHED_IDLE },
+    { "fifo",  VLC_THREAD_SCHED_FIFO },
+    { "rr",    VLC_THREAD_SCHED_RR },
+    { "mmcss", VLC_THREAD_SCHED_MMCSS },
+};
+
+/**
+ * Parses a CPU list such as "0-3,8,10-11".
+ */
+static int ParseCPUs(struct vlc_thread_policy *p, const char *str)
+{
+    do
+    {
+        char *end;
+        unsigned long first = strtoul(str, &end, 10), last = first;
+
+        if (end == str)
+            return -1;
+        if (*end == '-')
+        {
+            str = end + 1;
+            last = strtoul(str, &end, 10);
+            if (end == str || last < first)
+                return -1;
+        }
+        if (last >= VLC_THREAD_POLICY_MAX_CPUS)
+            return -1;
+
+        for (unsigned long cpu = first; cpu <= last; cpu++)
+            p->cpus[cpu / 64] |= UINT64_C(1) << (cpu % 64);
+        str = end;
+    }
+    while (*(str++) == ',');
+
+    if (str[-1] != '\0')
+        return -1;
+    p->has_affinity = true;
+    return 0;
+}
+
+/**
+ * Parses a policy of the form [sched[:priority]][@cpulist].
+ */
+static int ParsePolicy(struct vlc_thread_policy *p, const char *str)
+{
+    const char *cpus = strchr(str, '@');
+    size_t len = (cpus != NULL) ? (size_t)(cpus - str) : strlen(str);
+
+    p->sched = VLC_THREAD_SCHED_DEFAULT;
+    p->priority = 0;
+    p->has_affinity = false;
+    memset(p->cpus, 0, sizeof (p->cpus));
+
+    if (len > 0)
+    {
+        const char *colon = memchr(str, ':', len);
+        size_t namelen = (colon != NULL) ? (size_t)(colon - str) : len;
+        size_t i;
+
+        for (i = 0; i < ARRAY_SIZE(sched_names); i++)
+            if (strlen(sched_names[i].name) == namelen
+             && strncasecmp(str, sched_names[i].name, namelen) == 0)
+                break;
+        if (i == ARRAY_SIZE(sched_names))
+            return -1;
+        p->sched = sched_names[i].sched;
+
+        if (colon != NULL)
+        {
+            char *end;
+            long prio = strtol(colon + 1, &end, 10);
+
+            if (end == colon + 1 || end != str + len
+             || prio < -99 || prio > 99)
+                return -1;
+            p->priority = prio;
+        }
+    }
+
+    if (cpus != NULL && ParseCPUs(p, cpus + 1))
+        return -1;
+    return 0;
+}
+
+void vlc_thread_policy_Init(libvlc_int_t *vlc)
+{
+    if (atomic_flag_test_and_set(&configuring))
+        return; /* another instance already set the policy */
+
+    for (size_t i = 0; i < VLC_THREAD_ROLES; i++)
+    {
+        char name[16];
+
+        snprintf(name, sizeof (name), "thread-%s", role_names[i]);
+
+        char *str = var_InheritString(vlc, name);
+        if (str == NULL)
+            continue;
+
+        if (ParsePolicy(&policies[i], str))
+            msg_Err(vlc, "invalid %s thread policy \"%s\"", role_names[i],
+                    str);
+        else
+        {
+            msg_Dbg(vlc, "%s thread policy: %s", role_names[i], str);
+            policy_set[i] = true;
+        }
+        free(str);
+    }
+
+    atomic_store_explicit(&configured, true, memory_order_release);
+}
+
+enum vlc_thread_role vlc_thread_policy_Role(int priority)
+{
+    /* The Windows priorities are shared by several roles: there, INPUT and
+     * OUTPUT both map to the input role, and LOW to the video role. */
+    switch (priority)
+    {
+#if VLC_THREAD_PRIORITY_AUDIO != VLC_THREAD_PRIORITY_VIDEO
+        case VLC_THREAD_PRIORITY_AUDIO:
+            return VLC_THREAD_ROLE_AUDIO;
+#endif
+#if VLC_THREAD_PRIORITY_INPUT != VLC_THREAD_PRIORITY_VIDEO
+        case VLC_THREAD_PRIORITY_INPUT:
+            return VLC_THREAD_ROLE_INPUT;
+#endif
+#if VLC_THREAD_PRIORITY_OUTPUT != VLC_THREAD_PRIORITY_INPUT
+        case VLC_THREAD_PRIORITY_OUTPUT:
+            return VLC_THREAD_ROLE_OUTPUT;
+#endif
+#if VLC_THREAD_PRIORITY_HIGHEST != VLC_THREAD_PRIORITY_AUDIO
+        case VLC_THREAD_PRIORITY_HIGHEST:
+            return VLC_THREAD_ROLE_OUTPUT;
+#endif
+#if VLC_THREAD_PRIORITY_LOW != VLC_THREAD_PRIORITY_VIDEO
+        case VLC_THREAD_PRIORITY_LOW:
+            return VLC_THREAD_ROLE_LOW;
+#endif
+        default:
+            return VLC_THREAD_ROLE_VIDEO;
+    }
+}
+
+const struct vlc_thread_policy *vlc_thread_policy_Get(enum vlc_thread_role r)
+{
+    assert(r < VLC_THREAD_ROLES);
+
+    if (!atomic_load_explicit(&configured, memory_order_acquire)
+     || !policy_set[r])
+        return NULL;
+    return &policies[r];
+}
+
+#if defined (LIBVLC_USE_PTHREAD)
+int vlc_thread_policy_ApplyPthread(pthread_t th, enum vlc_thread_role role)
+{
+    const struct vlc_thread_policy *p = vlc_thread_policy_Get(role);
+    int ret = 0;
+
+    if (p == NULL)
+        return 0;
+
+    if (p->sched != VLC_THREAD_SCHED_DEFAULT)
+    {
+        struct sched_param param = { .sched_priority = 0 };
+        int policy;
+
+        switch (p->sched)
+        {
+#ifdef SCHED_BATCH
+            case VLC_THREAD_SCHED_BATCH:
+                policy = SCHED_BATCH;
+                break;
+#endif
+#ifdef SCHED_IDLE
+            case VLC_THREAD_SCHED_IDLE:
+                policy = SCHED_IDLE;
+                break;
+#endif
+            case VLC_THREAD_SCHED_FIFO:
+            case VLC_THREAD_SCHED_MMCSS:
+                policy = SCHED_FIFO;
+                break;
+            case VLC_THREAD_SCHED_RR:
+                policy = SCHED_RR;
+                break;
+            default:
+                policy = SCHED_OTHER;
+                break;
+        }
+
+        if (policy == SCHED_FIFO || policy == SCHED_RR)
+        {
+            int min = sched_get_priority_min(policy);
+            int max = sched_get_priority_max(policy);
+
+            param.sched_priority = min + p->priority;
+            if (param.sched_priority < min)
+                param.sched_priority = min;
+            if (param.sched_priority > max)
+                param.sched_priority = max;
+        }
+
+        /* Real-time scheduling fails without the privileges (typically
+         * CAP_SYS_NICE or RLIMIT_RTPRIO): the thread then keeps the
+         * default scheduling. */
+        ret = pthread_setschedparam(th, policy, &param);
+    }
+
+#ifdef __linux__
+    if (p->has_affinity)
+    {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        for (unsigned cpu = 0; cpu < VLC_THREAD_POLICY_MAX_CPUS
+                            && cpu < CPU_SETSIZE; cpu++)
+            if (vlc_thread_policy_HasCPU(p, cpu))
+                CPU_SET(cpu, &set);
+
+        int val = pthread_setaffinity_np(th, sizeof (set), &set);
+        if (ret == 0)
+            ret = val;
+    }
+#endif
+    return ret;
+}
+
+int vlc_thread_policy_ApplySelf(enum vlc_thread_role role)
+{
+    return vlc_thread_policy_ApplyPthread(pthread_self(), role);
+}
+
+void vlc_thread_policy_LeaveSelf(void)
+{
+}
+
+#elif defined (_WIN32)
+# ifndef VLC_WINSTORE_APP
+static HANDLE (WINAPI *AvSetMmThreadCharacteristicsW_)(LPCWSTR, LPDWORD);
+static BOOL (WINAPI *AvSetMmThreadPriority_)(HANDLE, int);
+static BOOL (WINAPI *AvRevertMmThreadCharacteristics_)(HANDLE);
+static INIT_ONCE avrt_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK LoadAvrt(PINIT_ONCE once, void *param, void **ctx)
+{
+    HMODULE h = LoadLibraryW(L"avrt.dll");
+
+    if (h != NULL)
+    {
+        AvSetMmThreadCharacteristicsW_ =
+            (void *)GetProcAddress(h, "AvSetMmThreadCharacteristicsW");
+        AvSetMmThreadPriority_ =
+            (void *)GetProcAddress(h, "AvSetMmThreadPriority");
+        AvRevertMmThreadCharacteristics_ =
+            (void *)GetProcAddress(h, "AvRevertMmThreadCharacteristics");
+    }
+    (void) once; (void) param; (void) ctx;
+    return TRUE;
+}
+
+static thread_local HANDLE mmcss_task = NULL;
+# endif
+
+int vlc_thread_policy_ApplySelf(enum vlc_thread_role role)
+{
+    const struct vlc_thread_policy *p = vlc_thread_policy_Get(role);
+    HANDLE th = GetCurrentThread();
+    int ret = 0;
+
+    if (p == NULL)
+        return 0;
+
+    switch (p->sched)
+    {
+        case VLC_THREAD_SCHED_DEFAULT:
+            break;
+        case VLC_THREAD_SCHED_OTHER:
+            SetThreadPriority(th, THREAD_PRIORITY_NORMAL);
+            break;
+        case VLC_THREAD_SCHED_BATCH:
+            SetThreadPriority(th, THREAD_PRIORITY_BELOW_NORMAL);
+            break;
+        case VLC_THREAD_SCHED_IDLE:
+            SetThreadPriority(th, THREAD_PRIORITY_IDLE);
+            break;
+        default:
+        {
+            /* There is no real-time scheduling class for applications:
+             * the Multimedia Class Scheduler raises and guarantees the
+             * priority of the registered threads instead. */
+# ifndef VLC_WINSTORE_APP
+            DWORD index = 0;
+
+            InitOnceExecuteOnce(&avrt_once, LoadAvrt, NULL, NULL);
+            if (AvSetMmThreadCharacteristicsW_ == NULL)
+            {
+                ret = ENOSYS;
+                break;
+            }
+            if (mmcss_task == NULL)
+                mmcss_task = AvSetMmThreadCharacteristicsW_(
+                    (role == VLC_THREAD_ROLE_AUDIO) ? L"Pro Audio"
+                                                    : L"Playback", &index);
+            if (mmcss_task == NULL)
+            {
+                ret = EPERM;
+                break;
+            }
+            if (AvSetMmThreadPriority_ != NULL)
+            {   /* from AVRT_PRIORITY_LOW (-1) to AVRT_PRIORITY_CRITICAL */
+                int prio = p->priority;
+
+                if (prio < -1)
+                    prio = -1;
+                if (prio > 2)
+                    prio = 2;
+                AvSetMmThreadPriority_(mmcss_task, prio);
+            }
+# else
+            SetThreadPriority(th, THREAD_PRIORITY_TIME_CRITICAL);
+# endif
+            break;
+        }
+    }
+
+# ifndef VLC_WINSTORE_APP
+    if (p->has_affinity)
+    {   /* only the CPUs of the first processor group */
+        DWORD_PTR mask = 0;
+
+        for (unsigned cpu = 0; cpu < 8 * sizeof (mask); cpu++)
+            if (vlc_thread_policy_HasCPU(p, cpu))
+                mask |= (DWORD_PTR)1 << cpu;
+        if (mask != 0 && SetThreadAffinityMask(th, mask) == 0 && ret == 0)
+            ret = EINVAL;
+    }
+# endif
+    return ret;
+}
+
+void vlc_thread_policy_LeaveSelf(void)
+{
+# ifndef VLC_WINSTORE_APP
+    if (mmcss_task != NULL)
+    {
+        AvRevertMmThreadCharacteristics_(mmcss_task);
+        mmcss_task = NULL;
+    }
+# endif
+}
+
+#else
+int vlc_thread_policy_ApplySelf(enum vlc_thread_role role)
+{
+    (void) role;
+    return 0;
+}
+
+void vlc_thread_policy_LeaveSelf(void)
+{
+}
+#endif
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * thread_policy.h: per-role thread scheduling and CPU affinity
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_THREAD_POLICY_H
+# define LIBVLC_THREAD_POLICY_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <vlc_common.h>
+
+/**
+ * Role of a LibVLC thread, derived from its vlc_clone() priority.
+ */
+enum vlc_thread_role
+{
+    VLC_THREAD_ROLE_LOW,
+    VLC_THREAD_ROLE_INPUT,
+    VLC_THREAD_ROLE_AUDIO,
+    VLC_THREAD_ROLE_VIDEO,
+    VLC_THREAD_ROLE_OUTPUT,
+    VLC_THREAD_ROLE_HWDEC, /**< decoder thread feeding a hardware decoder */
+};
+
+#define VLC_THREAD_ROLES 6
+
+enum vlc_thread_sched
+{
+    VLC_THREAD_SCHED_DEFAULT, /**< left as inherited */
+    VLC_THREAD_SCHED_OTHER,
+    VLC_THREAD_SCHED_BATCH,
+    VLC_THREAD_SCHED_IDLE,
+    VLC_THREAD_SCHED_FIFO,
+    VLC_THREAD_SCHED_RR,
+    VLC_THREAD_SCHED_MMCSS, /**< Windows Multimedia Class Scheduler */
+};
+
+#define VLC_THREAD_POLICY_MAX_CPUS 1024
+
+struct vlc_thread_policy
+{
+    enum vlc_thread_sched sched;
+    int priority; /**< real-time priority, 0 for the lowest one */
+    bool has_affinity;
+    uint64_t cpus[VLC_THREAD_POLICY_MAX_CPUS / 64]; /**< CPU bitmap */
+};
+
+/**
+ * Maps a vlc_clone() priority to a thread role.
+ */
+enum vlc_thread_role vlc_thread_policy_Role(int priority);
+
+/**
+ * Gets the policy of a role.
+ *
+ * \return the policy, or NULL if the role uses the default scheduling
+ */
+const struct vlc_thread_policy *vlc_thread_policy_Get(enum vlc_thread_role);
+
+/**
+ * Applies the policy of a role to the calling thread.
+ *
+ * This is used by threads whose role is only known once they run, such as
+ * the decoder threads feeding a hardware decoder.
+ *
+ * \return 0 on success (or if the role uses the default scheduling), an
+ * error number otherwise
+ */
+int vlc_thread_policy_ApplySelf(enum vlc_thread_role);
+
+/**
+ * Releases what vlc_thread_policy_ApplySelf() registered for the calling
+ * thread (the Multimedia Class Scheduler task on Windows), before it exits.
+ */
+void vlc_thread_policy_LeaveSelf(void);
+
+#if defined (LIBVLC_USE_PTHREAD)
+/**
+ * Applies the policy of a role to a thread.
+ */
+int vlc_thread_policy_ApplyPthread(pthread_t, enum vlc_thread_role);
+#endif
+
+static inline bool vlc_thread_policy_HasCPU(const struct vlc_thread_policy *p,
+                                            unsigned cpu)
+{
+    return cpu < VLC_THREAD_POLICY_MAX_CPUS
+        && (p->cpus[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+#endif
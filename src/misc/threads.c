@@ -30,6 +30,7 @@
 #include <vlc_common.h>
 #include <vlc_atomic.h>
 #include "libvlc.h"
+#include "misc/lock_profile.h"
 
 /* <stdatomic.h> types cannot be used in the C++ view of <vlc_threads.h> */
 struct vlc_suuint { union { unsigned int value; }; };
@@ -63,21 +64,25 @@ void vlc_global_mutex (unsigned n, bool acquire)
         vlc_mutex_unlock (lock);
 }
 
-static void vlc_mutex_init_common(vlc_mutex_t *mtx, bool recursive)
+static void vlc_mutex_init_common(vlc_mutex_t *mtx, bool recursive,
+                                  const void *caller)
 {
     atomic_init(&mtx->value, 0);
     atomic_init(&mtx->recursion, recursive);
     atomic_init(&mtx->owner, 0);
+
+    if (unlikely(vlc_lock_profile_Enabled()))
+        vlc_lock_profile_Created(mtx, caller);
 }
 
 void vlc_mutex_init(vlc_mutex_t *mtx)
 {
-    vlc_mutex_init_common(mtx, false);
+    vlc_mutex_init_common(mtx, false, vlc_lock_caller());
 }
 
 void vlc_mutex_init_recursive(vlc_mutex_t *mtx)
 {
-    vlc_mutex_init_common(mtx, true);
+    vlc_mutex_init_common(mtx, true, vlc_lock_caller());
 }
 
 bool vlc_mutex_held(const vlc_mutex_t *mtx)
@@ -102,17 +107,27 @@ bool vlc_mutex_held(const vlc_mutex_t *mtx)
                                                    memory_order_relaxed);
 }
 
+static int vlc_mutex_trylock_common(vlc_mutex_t *mtx, bool *nested);
+
 void vlc_mutex_lock(vlc_mutex_t *mtx)
 {
+    bool nested;
+
     /* This is the Drepper (non-recursive) mutex algorithm
      * from his "Futexes are tricky" paper. The mutex value can be:
      * - 0: the mutex is free
      * - 1: the mutex is locked and uncontended
      * - 2: the mutex is contended (i.e., unlock needs to wake up a waiter)
      */
-    if (vlc_mutex_trylock(mtx) == 0)
+    if (vlc_mutex_trylock_common(mtx, &nested) == 0)
+    {
+        if (unlikely(vlc_lock_profile_Enabled()) && !nested)
+            vlc_lock_profile_Acquired(mtx, vlc_lock_caller(), -1);
         return;
+    }
 
+    bool profiled = vlc_lock_profile_Enabled();
+    vlc_tick_t start = unlikely(profiled) ? vlc_tick_now() : 0;
     int canc = vlc_savecancel(); /* locking is never a cancellation point */
 
     while (atomic_exchange_explicit(&mtx->value, 2, memory_order_acquire))
@@ -120,9 +135,23 @@ void vlc_mutex_lock(vlc_mutex_t *mtx)
 
     vlc_restorecancel(canc);
     atomic_store_explicit(&mtx->owner, vlc_thread_id(), memory_order_relaxed);
+
+    if (unlikely(profiled))
+        vlc_lock_profile_Acquired(mtx, vlc_lock_caller(),
+                                  vlc_tick_now() - start);
 }
 
 int vlc_mutex_trylock(vlc_mutex_t *mtx)
+{
+    bool nested;
+    int ret = vlc_mutex_trylock_common(mtx, &nested);
+
+    if (unlikely(vlc_lock_profile_Enabled()) && ret == 0 && !nested)
+        vlc_lock_profile_Acquired(mtx, vlc_lock_caller(), -1);
+    return ret;
+}
+
+static int vlc_mutex_trylock_common(vlc_mutex_t *mtx, bool *nested)
 {
     /* Check the recursion counter:
      * - 0: mutex is not recursive.
@@ -137,10 +166,13 @@ int vlc_mutex_trylock(vlc_mutex_t *mtx)
          */
         atomic_store_explicit(&mtx->recursion, recursion + 1,
                               memory_order_relaxed);
+        *nested = true;
         return 0;
     } else
         assert(!vlc_mutex_held(mtx));
 
+    *nested = false;
+
     unsigned value = 0;
 
     if (atomic_compare_exchange_strong_explicit(&mtx->value, &value, 1,
@@ -167,6 +199,9 @@ void vlc_mutex_unlock(vlc_mutex_t *mtx)
         return;
     }
 
+    if (unlikely(vlc_lock_profile_Enabled()))
+        vlc_lock_profile_Released(mtx);
+
     atomic_store_explicit(&mtx->owner, 0, memory_order_relaxed);
 
     switch (atomic_exchange_explicit(&mtx->value, 0, memory_order_release)) {
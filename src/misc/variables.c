@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,9 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash;     /**< Hash of the name */
+    struct variable_t *next; /**< Next variable in the hash bucket */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -138,25 +137,90 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+/* FNV-1a */
+static uint32_t HashName( const char *psz_name )
 {
-    const variable_t *va = a, *vb = b;
+    uint32_t hash = 2166136261u;
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    for( const unsigned char *p = (const unsigned char *)psz_name; *p; p++ )
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
 }
 
-static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
+/* Two bits of the per-object Bloom filter of the variable names */
+static uint64_t NameBits( uint32_t hash )
+{
+    return (UINT64_C(1) << (hash & 63)) | (UINT64_C(1) << ((hash >> 6) & 63));
+}
+
+/**
+ * Checks whether an object may have a variable, without locking it.
+ *
+ * The filter is never cleared when variables are destroyed, so this may
+ * report false positives, but never false negatives.
+ */
+static bool MayExist( vlc_object_internals_t *priv, uint32_t hash )
+{
+    uint64_t bits = NameBits( hash );
+
+    return (atomic_load_explicit( &priv->var_names,
+                                  memory_order_acquire ) & bits) == bits;
+}
+
+static variable_t **Bucket( vlc_object_internals_t *priv, const char *psz_name,
+                            uint32_t hash )
+{
+    if( priv->var_size == 0 )
+        return NULL;
+
+    variable_t **pp_var = &priv->var_table[hash & (priv->var_size - 1)];
+
+    while( *pp_var != NULL && ((*pp_var)->hash != hash
+                            || strcmp( (*pp_var)->psz_name, psz_name )) )
+        pp_var = &(*pp_var)->next;
+    return pp_var;
+}
+
+static variable_t *LookupHash( vlc_object_t *obj, const char *psz_name,
+                               uint32_t hash )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
+    variable_t **pp_var = Bucket( priv, psz_name, hash );
     return (pp_var != NULL) ? *pp_var : NULL;
 }
 
+static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
+{
+    return LookupHash( obj, psz_name, HashName( psz_name ) );
+}
+
+/* Doubles the number of buckets once there are more variables than buckets */
+static int Grow( vlc_object_internals_t *priv )
+{
+    if( priv->var_count < priv->var_size )
+        return VLC_SUCCESS;
+
+    unsigned size = priv->var_size ? priv->var_size * 2 : 16;
+    variable_t **table = calloc( size, sizeof (*table) );
+    if( unlikely(table == NULL) )
+        return priv->var_size ? VLC_SUCCESS : VLC_ENOMEM;
+
+    for( unsigned i = 0; i < priv->var_size; i++ )
+        for( variable_t *var = priv->var_table[i], *next; var; var = next )
+        {
+            next = var->next;
+            var->next = table[var->hash & (size - 1)];
+            table[var->hash & (size - 1)] = var;
+        }
+
+    free( priv->var_table );
+    priv->var_table = table;
+    priv->var_size = size;
+    return VLC_SUCCESS;
+}
+
 static void Destroy( variable_t *p_var )
 {
     p_var->ops->pf_free( &p_var->val );
@@ -297,6 +361,8 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = HashName( psz_name );
+    p_var->next = NULL;
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -356,17 +422,29 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
+    variable_t **pp_var;
     variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
+    pp_var = Bucket( p_priv, p_var->psz_name, p_var->hash );
+    if( pp_var == NULL || (p_oldvar = *pp_var) == NULL ) /* Variable create */
+    {
+        ret = Grow( p_priv );
+        if( likely(ret == VLC_SUCCESS) )
+        {
+            pp_var = &p_priv->var_table[p_var->hash & (p_priv->var_size - 1)];
+            p_var->next = *pp_var;
+            /* Publish the name bits before the variable can be found */
+            atomic_fetch_or_explicit( &p_priv->var_names,
+                                      NameBits( p_var->hash ),
+                                      memory_order_release );
+            *pp_var = p_var;
+            p_priv->var_count++;
+            p_var = NULL; /* Variable created */
+        }
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -388,15 +466,17 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     assert( p_this );
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
+    uint32_t hash = HashName( psz_name );
 
-    p_var = Lookup( p_this, psz_name );
+    p_var = LookupHash( p_this, psz_name, hash );
     if( p_var == NULL )
         msg_Dbg( p_this, "attempt to destroy nonexistent variable \"%s\"",
                  psz_name );
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        *Bucket( p_priv, psz_name, hash ) = p_var->next;
+        p_priv->var_count--;
     }
     else
     {
@@ -409,17 +489,21 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    for( unsigned i = 0; i < priv->var_size; i++ )
+        for( variable_t *var = priv->var_table[i], *next; var; var = next )
+        {
+            next = var->next;
+            Destroy( var );
+        }
+
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_size = priv->var_count = 0;
+    atomic_store_explicit( &priv->var_names, 0, memory_order_relaxed );
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -1041,10 +1125,26 @@ int (var_LocationParse)(vlc_object_t *obj, const char *mrl, const char *pref)
 int var_Inherit( vlc_object_t *p_this, const char *psz_name, int i_type,
                  vlc_value_t *p_val )
 {
+    uint32_t hash = HashName( psz_name );
+
     i_type &= VLC_VAR_CLASS;
     for (vlc_object_t *obj = p_this; obj != NULL; obj = vlc_object_parent(obj))
     {
-        if( var_GetChecked( obj, psz_name, i_type, p_val ) == VLC_SUCCESS )
+        vlc_object_internals_t *priv = vlc_internals( obj );
+
+        /* Most ancestors do not have the variable: skip them unlocked */
+        if( !MayExist( priv, hash ) )
+            continue;
+
+        variable_t *var = LookupHash( obj, psz_name, hash );
+        if( var != NULL )
+        {
+            assert( (var->i_type & VLC_VAR_CLASS) == i_type );
+            *p_val = var->val;
+            var->ops->pf_dup( p_val );
+        }
+        vlc_mutex_unlock( &priv->var_lock );
+        if( var != NULL )
             return VLC_SUCCESS;
     }
 
@@ -1139,21 +1239,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1161,9 +1246,14 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (unsigned i = 0; i < priv->var_size; i++)
+        for (const variable_t *var = priv->var_table[i]; var; var = var->next)
+        {
+            char *dup = strdup(var->psz_name);
+            if (dup != NULL)
+                ARRAY_APPEND(names, dup);
+        }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
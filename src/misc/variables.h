@@ -23,6 +23,8 @@
 #ifndef LIBVLC_VARIABLES_H
 # define LIBVLC_VARIABLES_H 1
 
+# include <stdatomic.h>
+# include <stdint.h>
 # include <vlc_list.h>
 
 struct vlc_res;
@@ -38,7 +40,10 @@ struct vlc_object_internals
     const char *typename; /**< Object type human-readable name */
 
     /* Object variables */
-    void           *var_root;
+    struct variable_t **var_table; /**< Hash table of the variables */
+    unsigned        var_size; /**< Number of buckets (a power of two) */
+    unsigned        var_count; /**< Number of variables */
+    _Atomic uint64_t var_names; /**< Bloom filter of the variable names */
     vlc_mutex_t     var_lock;
 
     /* Object resources */
@@ -772,6 +772,9 @@ void module_EndBank (bool b_plugins)
     vlc_mutex_unlock (&modules.lock);
 
     tdestroy(caps_tree, vlc_modcap_free);
+    if (libs != NULL)
+        /* The rejections refer to the modules being destroyed */
+        vlc_module_probe_Flush();
 
     while (libs != NULL)
     {
@@ -56,7 +56,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 37
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -178,16 +178,25 @@ static int vlc_cache_load_align(size_t align, block_t *file)
     if (vlc_cache_load_align(alignof(t), file)) \
         goto error
 
-static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
+/* Loads what is needed to index the item and parse the command line */
+static int vlc_cache_load_config_index(module_config_t *cfg, block_t *file)
 {
     LOAD_IMMEDIATE (cfg->i_type);
     LOAD_IMMEDIATE (cfg->i_short);
+    LOAD_STRING (cfg->psz_name);
+    return 0;
+error:
+    return -1;
+}
+
+/* Loads everything else, see vlc_plugin_LoadConfig() */
+static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
+{
     LOAD_FLAG (cfg->b_internal);
     LOAD_FLAG (cfg->b_unsaveable);
     LOAD_FLAG (cfg->b_safe);
     LOAD_FLAG (cfg->b_removed);
     LOAD_STRING (cfg->psz_type);
-    LOAD_STRING (cfg->psz_name);
     LOAD_STRING (cfg->psz_text);
     LOAD_STRING (cfg->psz_longtext);
     LOAD_IMMEDIATE (cfg->list_count);
@@ -260,12 +269,12 @@ static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
 
     plugin->conf.size = lines;
 
-    /* Do the duplication job */
+    /* Only load the index, the rest is loaded on first use */
     for (size_t i = 0; i < lines; i++)
     {
         module_config_t *item = plugin->conf.items + i;
 
-        if (vlc_cache_load_config(item, file))
+        if (vlc_cache_load_config_index(item, file))
             return -1;
 
         if (CONFIG_ITEM(item->i_type))
@@ -277,11 +286,47 @@ static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
         item->owner = plugin;
     }
 
+    uint32_t size;
+    const uint8_t *data;
+    LOAD_IMMEDIATE (size);
+    LOAD_ARRAY (data, size);
+
+    plugin->conf.cache = data;
+    plugin->conf.cache_size = size;
+    atomic_store_explicit(&plugin->conf.loaded, lines == 0,
+                          memory_order_relaxed);
     return 0;
 error:
     return -1; /* FIXME: leaks */
 }
 
+void vlc_plugin_LoadConfig(vlc_plugin_t *plugin)
+{
+    static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+
+    if (atomic_load_explicit(&plugin->conf.loaded, memory_order_acquire))
+        return;
+
+    vlc_mutex_lock(&lock);
+    if (!atomic_load_explicit(&plugin->conf.loaded, memory_order_relaxed))
+    {
+        /* The serialized items stay mapped as long as the plugin */
+        block_t data;
+        data.p_buffer = (uint8_t *)plugin->conf.cache;
+        data.i_buffer = plugin->conf.cache_size;
+
+        for (size_t i = 0; i < plugin->conf.size; i++)
+            /* This is too late to reject a corrupted cache: the remaining
+             * items are left at zero */
+            if (vlc_cache_load_config(plugin->conf.items + i, &data))
+                break;
+
+        atomic_store_explicit(&plugin->conf.loaded, true,
+                              memory_order_release);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
 static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
 {
     module_t *module = vlc_module_create(plugin);
@@ -506,16 +551,23 @@ static int CacheSaveAlign(FILE *file, size_t align)
     if (CacheSaveAlign(file, alignof (t))) \
         goto error
 
-static int CacheSaveConfig (FILE *file, const module_config_t *cfg)
+static int CacheSaveConfigIndex (FILE *file, const module_config_t *cfg)
 {
     SAVE_IMMEDIATE (cfg->i_type);
     SAVE_IMMEDIATE (cfg->i_short);
+    SAVE_STRING (cfg->psz_name);
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheSaveConfig (FILE *file, const module_config_t *cfg)
+{
     SAVE_FLAG (cfg->b_internal);
     SAVE_FLAG (cfg->b_unsaveable);
     SAVE_FLAG (cfg->b_safe);
     SAVE_FLAG (cfg->b_removed);
     SAVE_STRING (cfg->psz_type);
-    SAVE_STRING (cfg->psz_name);
     SAVE_STRING (cfg->psz_text);
     SAVE_STRING (cfg->psz_longtext);
     SAVE_IMMEDIATE (cfg->list_count);
@@ -549,16 +601,40 @@ error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModuleConfig(FILE *file, vlc_plugin_t *plugin)
 {
     uint16_t lines = plugin->conf.size;
 
+    vlc_plugin_LoadConfig(plugin);
+
     SAVE_IMMEDIATE (lines);
 
+    for (size_t i = 0; i < lines; i++)
+        if (CacheSaveConfigIndex(file, plugin->conf.items + i))
+           goto error;
+
+    /* The rest of the items is prefixed by its size, so that it can be
+     * skipped when loading */
+    uint32_t size = 0;
+    long start = ftell(file);
+
+    SAVE_IMMEDIATE (size);
+
     for (size_t i = 0; i < lines; i++)
         if (CacheSaveConfig(file, plugin->conf.items + i))
            goto error;
 
+    long end = ftell(file);
+    if (start < 0 || end < 0)
+        goto error;
+
+    size = end - start - sizeof (size);
+    if (fseek(file, start, SEEK_SET))
+        goto error;
+    SAVE_IMMEDIATE (size);
+    if (fseek(file, end, SEEK_SET))
+        goto error;
+
     return 0;
 error:
     return -1;
@@ -608,7 +684,7 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 
     for (size_t i = 0; i < n; i++)
     {
-        const vlc_plugin_t *plugin = cache[i];
+        vlc_plugin_t *plugin = cache[i];
         uint32_t count = plugin->modules_count;
 
         SAVE_IMMEDIATE(count);
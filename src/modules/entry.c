@@ -104,8 +104,12 @@ vlc_plugin_t *vlc_plugin_create(void)
     plugin->conf.count = 0;
     plugin->conf.booleans = 0;
 #ifdef HAVE_DYNAMIC_PLUGINS
+    plugin->conf.cache = NULL;
+    plugin->conf.cache_size = 0;
+    atomic_init(&plugin->conf.loaded, true);
     plugin->unloadable = true;
     atomic_init(&plugin->handle, 0);
+    atomic_init(&plugin->used, false);
     plugin->abspath = NULL;
     plugin->path = NULL;
 #endif
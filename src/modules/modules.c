@@ -41,6 +41,7 @@
 #include "config/configuration.h"
 #include "vlc_arrays.h"
 #include "modules/modules.h"
+#include "misc/interrupt.h"
 
 bool module_provides (const module_t *m, const char *cap)
 {
@@ -184,32 +185,78 @@ ssize_t vlc_module_match(const char *capability, const char *names,
 
 void *vlc_module_map(vlc_logger_t *log, module_t *module)
 {
+#ifdef HAVE_DYNAMIC_PLUGINS
+    /* Remembered for the next sessions, see vlc_plugin_StartPreload() */
+    atomic_bool *used = &module->plugin->used;
+    if (!atomic_load_explicit(used, memory_order_relaxed))
+        atomic_store_explicit(used, true, memory_order_relaxed);
+#endif
     return vlc_plugin_Map(log, module->plugin) ? NULL : module->pf_activate;
 }
 
-/**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
+/*
+ * Negative probe cache
  *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
+ * Remembers which modules rejected a given content, so that they are not
+ * probed again when the same content is opened again. This is a small
+ * direct-mapped table: a collision just forgets an older rejection.
  */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+#define PROBE_CACHE_SIZE 1024
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct
+    {
+        const module_t *module;
+        uint64_t signature;
+    } entries[PROBE_CACHE_SIZE];
+} probes = { VLC_STATIC_MUTEX, { { NULL, 0 } } };
+
+static size_t vlc_module_probe_Index(const module_t *module,
+                                     uint64_t signature)
+{
+    uint64_t h = signature ^ (uintptr_t)module;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    return h % PROBE_CACHE_SIZE;
+}
+
+static bool vlc_module_probe_Rejected(const module_t *module,
+                                      uint64_t signature)
+{
+    size_t i = vlc_module_probe_Index(module, signature);
+
+    vlc_mutex_lock(&probes.lock);
+    bool rejected = probes.entries[i].module == module
+                 && probes.entries[i].signature == signature;
+    vlc_mutex_unlock(&probes.lock);
+    return rejected;
+}
+
+static void vlc_module_probe_Reject(const module_t *module, uint64_t signature)
+{
+    size_t i = vlc_module_probe_Index(module, signature);
+
+    vlc_mutex_lock(&probes.lock);
+    probes.entries[i].module = module;
+    probes.entries[i].signature = signature;
+    vlc_mutex_unlock(&probes.lock);
+}
+
+void vlc_module_probe_Flush(void)
+{
+    vlc_mutex_lock(&probes.lock);
+    memset(probes.entries, 0, sizeof (probes.entries));
+    vlc_mutex_unlock(&probes.lock);
+}
+
+static module_t *vlc_module_vaload(struct vlc_logger *log,
+                                   const char *capability, const char *name,
+                                   bool strict, uint64_t signature,
+                                   vlc_activate_t probe, va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -227,13 +274,16 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
               capability, name, total);
 
     module_t *module = NULL;
-    va_list args;
-
-    va_start(args, probe);
 
     for (size_t i = 0; i < (size_t)total; i++) {
         module_t *cand = mods[i];
         int ret = VLC_EGENERIC;
+        /* Forced modules may behave differently, they are always probed */
+        bool cached = signature != 0 && i >= strict_total;
+
+        if (cached && vlc_module_probe_Rejected(cand, signature))
+            continue;
+
         void *cb = vlc_module_map(log, cand);
 
         if (cb != NULL) {
@@ -252,12 +302,16 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
                 /* fall through */
             case VLC_ETIMEOUT:
                 goto done;
+            case VLC_EGENERIC:
+                /* Other errors (out of memory...) may not happen again,
+                 * nor may a probe cut short by an interruption */
+                if (cached && cb != NULL && !vlc_interrupted())
+                    vlc_module_probe_Reject(cand, signature);
+                break;
         }
     }
 
 done:
-    va_end (args);
-
     if (module == NULL)
         vlc_debug(log, "no %s modules matched with name %s", capability, name);
 
@@ -265,6 +319,53 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vaload(log, capability, name, strict, 0,
+                                         probe, args);
+    va_end(args);
+    return module;
+}
+
+module_t *vlc_module_load_content(struct vlc_logger *log,
+                                  const char *capability, const char *name,
+                                  bool strict, uint64_t signature,
+                                  vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vaload(log, capability, name, strict,
+                                         signature, probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
@@ -278,13 +379,13 @@ static int generic_start(void *func, bool forced, va_list ap)
     return ret;
 }
 
-#undef module_need
-module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
-                      bool strict)
+module_t *module_need_content(vlc_object_t *obj, const char *cap,
+                              const char *name, bool strict,
+                              uint64_t signature)
 {
     const bool b_force_backup = obj->force; /* FIXME: remove this */
-    module_t *module = vlc_module_load(obj->logger, cap, name, strict,
-                                       generic_start, obj);
+    module_t *module = vlc_module_load_content(obj->logger, cap, name, strict,
+                                               signature, generic_start, obj);
     if (module != NULL) {
         var_Create(obj, "module-name", VLC_VAR_STRING);
         var_SetString(obj, "module-name", module_get_object(module));
@@ -294,6 +395,13 @@ module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
     return module;
 }
 
+#undef module_need
+module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
+                      bool strict)
+{
+    return module_need_content(obj, cap, name, strict, 0);
+}
+
 #undef module_unneed
 void module_unneed(vlc_object_t *obj, module_t *module)
 {
@@ -342,6 +450,8 @@ module_config_t *module_config_get( const module_t *module, unsigned *restrict p
         return NULL;
     }
 
+    vlc_plugin_LoadConfig( (vlc_plugin_t *)plugin );
+
     size_t size = plugin->conf.size;
     module_config_t *config = vlc_alloc( size, sizeof( *config ) );
 
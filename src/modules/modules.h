@@ -24,6 +24,7 @@
 # define LIBVLC_MODULES_H 1
 
 # include <stdatomic.h>
+# include <vlc_modules.h>
 
 /** VLC plugin */
 typedef struct vlc_plugin_t
@@ -43,11 +44,20 @@ typedef struct vlc_plugin_t
         size_t size; /**< Total count of all items */
         size_t count; /**< Count of real options (excludes hints) */
         size_t booleans; /**< Count of options that are of boolean type */
+#ifdef HAVE_DYNAMIC_PLUGINS
+        /**
+         * Serialized items from the plugins cache, see vlc_plugin_LoadConfig()
+         */
+        const void *cache;
+        size_t cache_size;
+        atomic_bool loaded; /**< Whether all items are filled */
+#endif
     } conf;
 
 #ifdef HAVE_DYNAMIC_PLUGINS
     bool unloadable; /**< Whether the plug-in can be unloaded safely */
     atomic_uintptr_t handle; /**< Run-time linker handle (or nul) */
+    atomic_bool used; /**< Whether a module was probed by this process */
     char *abspath; /**< Absolute path */
 
     char *path; /**< Relative path (within plug-in directory) */
@@ -127,6 +137,51 @@ void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
  */
 size_t module_list_cap(module_t *const **, const char *);
 
+/**
+ * Finds and instantiates the best module for a given content.
+ *
+ * This is the same as vlc_module_load(), except that the modules which were
+ * not forced and rejected the same content signature before are skipped,
+ * and that the modules rejecting it now are remembered.
+ *
+ * \param signature hash identifying the content to probe, or 0 if unknown
+ */
+module_t *vlc_module_load_content(struct vlc_logger *, const char *cap,
+                                  const char *name, bool strict,
+                                  uint64_t signature, vlc_activate_t probe,
+                                  ...) VLC_USED;
+
+/**
+ * Same as module_need(), with a content signature, see
+ * vlc_module_load_content()
+ */
+module_t *module_need_content(vlc_object_t *, const char *cap,
+                              const char *name, bool strict,
+                              uint64_t signature) VLC_USED;
+
+#ifdef HAVE_DYNAMIC_PLUGINS
+/**
+ * Starts loading the plugins used by the previous sessions in the
+ * background, if the "plugins-preload" option is enabled.
+ *
+ * \return a preload handle, or NULL if nothing is being preloaded
+ */
+struct vlc_plugin_preload *vlc_plugin_StartPreload(vlc_object_t *);
+
+/**
+ * Stops loading plugins, and records the plugins used by this session.
+ */
+void vlc_plugin_StopPreload(struct vlc_plugin_preload *);
+#else
+# define vlc_plugin_StartPreload(obj) ((void)(obj), NULL)
+# define vlc_plugin_StopPreload(preload) ((void)(preload))
+#endif
+
+/**
+ * Forgets all the rejected probes.
+ */
+void vlc_module_probe_Flush(void);
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
@@ -175,6 +230,20 @@ char *vlc_dlerror(void) VLC_USED;
 
 /* Plugins cache */
 vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
+
+#ifdef HAVE_DYNAMIC_PLUGINS
+/**
+ * Fills the configuration items of a plugin loaded from the cache.
+ *
+ * Only the names, types and short options of the items are loaded with the
+ * plugins cache. This must be called before any other field of the items is
+ * accessed. It is thread-safe, and does nothing if the items are filled
+ * already.
+ */
+void vlc_plugin_LoadConfig(vlc_plugin_t *);
+#else
+# define vlc_plugin_LoadConfig(plugin) ((void)(plugin))
+#endif
 vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
 
 void CacheSave(vlc_object_t *, const char *, vlc_plugin_t *const *, size_t);
@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * preload.c: background loading of the plugins used in previous sessions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include "modules/modules.h"
+
+#ifdef HAVE_DYNAMIC_PLUGINS
+
+/* Usage profile, in the cache directory */
+#define PRELOAD_PROFILE "plugins-usage"
+/* Plugins not used for that many sessions are not preloaded anymore */
+#define PRELOAD_MAX_AGE 8
+
+struct vlc_plugin_preload
+{
+    vlc_object_t *obj;
+    char *dir;
+    vlc_thread_t thread;
+    atomic_bool stop;
+
+    /* Profile, only accessed by the thread until it is joined */
+    struct preload_entry
+    {
+        vlc_plugin_t *plugin;
+        unsigned age; /**< sessions since the last use */
+    } *entries;
+    size_t count;
+};
+
+static vlc_plugin_t *PreloadFind(const char *abspath)
+{
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+        if (p->abspath != NULL && !strcmp(p->abspath, abspath))
+            return p;
+    return NULL;
+}
+
+static int PreloadEntryCmp(const void *a, const void *b)
+{
+    const struct preload_entry *ea = a, *eb = b;
+
+    return (ea->age > eb->age) - (ea->age < eb->age);
+}
+
+/*
+ * Each line of the profile is the number of sessions since the plugin was
+ * last used, a space and the absolute path of the plugin.
+ */
+static void PreloadReadProfile(struct vlc_plugin_preload *preload)
+{
+    char *path;
+    if (asprintf(&path, "%s" DIR_SEP PRELOAD_PROFILE, preload->dir) == -1)
+        return;
+
+    FILE *file = vlc_fopen(path, "rt");
+    free(path);
+    if (file == NULL)
+        return;
+
+    char *line = NULL;
+    size_t linesize = 0;
+    ssize_t len;
+
+    while ((len = getline(&line, &linesize, file)) > 0)
+    {
+        if (line[len - 1] == '\n')
+            line[len - 1] = '\0';
+
+        char *end;
+        unsigned long age = strtoul(line, &end, 10);
+        if (end == line || *end != ' ' || age > PRELOAD_MAX_AGE)
+            continue;
+
+        /* Plugins which were removed since are forgotten */
+        vlc_plugin_t *plugin = PreloadFind(end + 1);
+        if (plugin == NULL)
+            continue;
+
+        struct preload_entry *entries =
+            realloc(preload->entries,
+                    (preload->count + 1) * sizeof (*entries));
+        if (unlikely(entries == NULL))
+            break;
+
+        entries[preload->count].plugin = plugin;
+        entries[preload->count].age = age;
+        preload->entries = entries;
+        preload->count++;
+    }
+    free(line);
+    fclose(file);
+}
+
+static void PreloadWriteProfile(struct vlc_plugin_preload *preload)
+{
+    char *path, *tmp;
+    if (asprintf(&path, "%s" DIR_SEP PRELOAD_PROFILE, preload->dir) == -1)
+        return;
+    if (asprintf(&tmp, "%s.%"PRIu32, path, (uint32_t)getpid()) == -1)
+    {
+        free(path);
+        return;
+    }
+
+    vlc_mkdir(preload->dir, 0700);
+
+    FILE *file = vlc_fopen(tmp, "wt");
+    if (file == NULL)
+    {
+        msg_Warn(preload->obj, "cannot create %s: %s", tmp,
+                 vlc_strerror_c(errno));
+        goto out;
+    }
+
+    bool ok = true;
+
+    /* Plugins used by this session */
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+        if (p->abspath != NULL
+         && atomic_load_explicit(&p->used, memory_order_relaxed))
+            ok = ok && fprintf(file, "0 %s\n", p->abspath) >= 0;
+
+    /* Plugins used by previous sessions only */
+    for (size_t i = 0; i < preload->count; i++)
+    {
+        const struct preload_entry *entry = &preload->entries[i];
+
+        if (entry->age < PRELOAD_MAX_AGE
+         && !atomic_load_explicit(&entry->plugin->used, memory_order_relaxed))
+            ok = ok && fprintf(file, "%u %s\n", entry->age + 1,
+                               entry->plugin->abspath) >= 0;
+    }
+
+    if (fclose(file) == 0 && ok)
+        vlc_rename(tmp, path); /* atomically replace the old profile */
+    else
+        vlc_unlink(tmp);
+out:
+    free(tmp);
+    free(path);
+}
+
+static void *PreloadThread(void *data)
+{
+    struct vlc_plugin_preload *preload = data;
+    struct vlc_logger *log = vlc_object_logger(preload->obj);
+
+    PreloadReadProfile(preload);
+
+    /* The most recently used plugins first */
+    qsort(preload->entries, preload->count, sizeof (*preload->entries),
+          PreloadEntryCmp);
+
+    vlc_tick_t start = vlc_tick_now();
+    size_t loaded = 0;
+
+    for (size_t i = 0; i < preload->count; i++)
+    {
+        vlc_plugin_t *plugin = preload->entries[i].plugin;
+
+        if (atomic_load_explicit(&preload->stop, memory_order_relaxed))
+            break;
+        if (atomic_load_explicit(&plugin->handle, memory_order_relaxed))
+            continue; /* already loaded */
+        if (vlc_plugin_Map(log, plugin) == 0)
+            loaded++;
+    }
+
+    msg_Dbg(preload->obj, "preloaded %zu plugins in %"PRId64" us", loaded,
+            US_FROM_VLC_TICK(vlc_tick_now() - start));
+    return NULL;
+}
+
+struct vlc_plugin_preload *vlc_plugin_StartPreload(vlc_object_t *obj)
+{
+    if (!var_InheritBool(obj, "plugins-preload"))
+        return NULL;
+
+    struct vlc_plugin_preload *preload = malloc(sizeof (*preload));
+    if (unlikely(preload == NULL))
+        return NULL;
+
+    preload->obj = obj;
+    preload->dir = config_GetUserDir(VLC_CACHE_DIR);
+    preload->entries = NULL;
+    preload->count = 0;
+    atomic_init(&preload->stop, false);
+
+    if (preload->dir == NULL)
+        goto error;
+
+    if (vlc_clone(&preload->thread, PreloadThread, preload,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        free(preload->dir);
+        goto error;
+    }
+    return preload;
+
+error:
+    free(preload);
+    return NULL;
+}
+
+void vlc_plugin_StopPreload(struct vlc_plugin_preload *preload)
+{
+    atomic_store_explicit(&preload->stop, true, memory_order_relaxed);
+    vlc_join(preload->thread, NULL);
+
+    PreloadWriteProfile(preload);
+
+    free(preload->entries);
+    free(preload->dir);
+    free(preload);
+}
+
+#endif /* HAVE_DYNAMIC_PLUGINS */
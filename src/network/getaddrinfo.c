@@ -35,6 +35,7 @@
 
 #include <sys/types.h>
 #include <vlc_network.h>
+#include "libvlc.h"
 
 int vlc_getnameinfo( const struct sockaddr *sa, int salen,
                      char *host, int hostlen, int *portnum, int flags )
@@ -128,3 +129,165 @@ int vlc_getaddrinfo_i11e(const char *node, unsigned port,
     return vlc_getaddrinfo(node, port, hints, res);
 }
 #endif
+
+/*
+ * Host name resolution cache
+ *
+ * Streaming protocols connect to the same few servers over and over, and
+ * each connection would otherwise query the DNS again, unless the system
+ * caches. getaddrinfo() does not report the TTL of the records, so entries
+ * expire after a short fixed delay instead.
+ */
+#define VLC_GAI_CACHE_SIZE   16
+#define VLC_GAI_CACHE_EXPIRY VLC_TICK_FROM_SEC(30)
+
+struct vlc_gai_entry
+{
+    char *node;
+    unsigned port;
+    int flags;
+    int family;
+    int socktype;
+    int protocol;
+    vlc_tick_t expiry;
+    struct addrinfo *res;
+};
+
+static vlc_mutex_t gai_cache_lock = VLC_STATIC_MUTEX;
+static struct vlc_gai_entry gai_cache[VLC_GAI_CACHE_SIZE];
+
+void vlc_freeaddrinfo_cached(struct addrinfo *res)
+{
+    while (res != NULL)
+    {
+        struct addrinfo *next = res->ai_next;
+
+        free(res->ai_canonname);
+        free(res);
+        res = next;
+    }
+}
+
+static struct addrinfo *vlc_gai_Copy(const struct addrinfo *res)
+{
+    struct addrinfo *copy = NULL, **pp = &copy;
+
+    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
+    {
+        struct addrinfo *ai = malloc(sizeof (*ai) + p->ai_addrlen);
+        if (unlikely(ai == NULL))
+            goto error;
+
+        *ai = *p;
+        ai->ai_addr = memcpy(ai + 1, p->ai_addr, p->ai_addrlen);
+        ai->ai_canonname = NULL;
+        ai->ai_next = NULL;
+        *pp = ai;
+        pp = &ai->ai_next;
+
+        if (p->ai_canonname != NULL)
+        {
+            ai->ai_canonname = strdup(p->ai_canonname);
+            if (unlikely(ai->ai_canonname == NULL))
+                goto error;
+        }
+    }
+    return copy;
+error:
+    vlc_freeaddrinfo_cached(copy);
+    return NULL;
+}
+
+static bool vlc_gai_Match(const struct vlc_gai_entry *entry, const char *node,
+                          unsigned port, const struct addrinfo *hints)
+{
+    return entry->node != NULL && !strcmp(entry->node, node)
+        && entry->port == port
+        && entry->flags == hints->ai_flags
+        && entry->family == hints->ai_family
+        && entry->socktype == hints->ai_socktype
+        && entry->protocol == hints->ai_protocol;
+}
+
+static void vlc_gai_Store(const char *node, unsigned port,
+                          const struct addrinfo *hints,
+                          const struct addrinfo *res, vlc_tick_t now)
+{
+    struct addrinfo *copy = vlc_gai_Copy(res);
+    char *name = strdup(node);
+
+    if (unlikely(copy == NULL || name == NULL))
+    {
+        vlc_freeaddrinfo_cached(copy);
+        free(name);
+        return;
+    }
+
+    vlc_mutex_lock(&gai_cache_lock);
+    /* Replace the same request, else the entry closest to expiry */
+    struct vlc_gai_entry *entry = &gai_cache[0];
+
+    for (size_t i = 0; i < ARRAY_SIZE(gai_cache); i++)
+    {
+        if (vlc_gai_Match(&gai_cache[i], node, port, hints))
+        {
+            entry = &gai_cache[i];
+            break;
+        }
+        if (gai_cache[i].expiry < entry->expiry)
+            entry = &gai_cache[i];
+    }
+
+    free(entry->node);
+    vlc_freeaddrinfo_cached(entry->res);
+    entry->node = name;
+    entry->port = port;
+    entry->flags = hints->ai_flags;
+    entry->family = hints->ai_family;
+    entry->socktype = hints->ai_socktype;
+    entry->protocol = hints->ai_protocol;
+    entry->expiry = now + VLC_GAI_CACHE_EXPIRY;
+    entry->res = copy;
+    vlc_mutex_unlock(&gai_cache_lock);
+}
+
+int vlc_getaddrinfo_cached_i11e(const char *node, unsigned port,
+                                const struct addrinfo *hints,
+                                struct addrinfo **res)
+{
+    static const struct addrinfo no_hints;
+    struct addrinfo *list;
+
+    if (hints == NULL)
+        hints = &no_hints;
+    if (node == NULL || node[0] == '\0')
+        goto resolve;
+
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_mutex_lock(&gai_cache_lock);
+    for (size_t i = 0; i < ARRAY_SIZE(gai_cache); i++)
+    {
+        const struct vlc_gai_entry *entry = &gai_cache[i];
+
+        if (entry->expiry > now && vlc_gai_Match(entry, node, port, hints))
+        {
+            *res = vlc_gai_Copy(entry->res);
+            vlc_mutex_unlock(&gai_cache_lock);
+            return (*res != NULL) ? 0 : EAI_MEMORY;
+        }
+    }
+    vlc_mutex_unlock(&gai_cache_lock);
+
+resolve:;
+    int val = vlc_getaddrinfo_i11e(node, port, hints, &list);
+    if (val != 0)
+        return val; /* failures are not cached */
+
+    if (node != NULL && node[0] != '\0')
+        vlc_gai_Store(node, port, hints, list, vlc_tick_now());
+
+    *res = vlc_gai_Copy(list);
+    freeaddrinfo(list);
+    return (*res != NULL) ? 0 : EAI_MEMORY;
+}
@@ -42,6 +42,7 @@
 #include <vlc_url.h>
 #include <vlc_mime.h>
 #include <vlc_block.h>
+#include <vlc_fs.h>
 #include "../libvlc.h"
 
 #include <string.h>
@@ -68,6 +69,9 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* Initial size of the buffer receiving the request of a client */
+#define HTTPD_CL_RECV_BUFSIZE 1000
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
 static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
 
@@ -98,6 +102,11 @@ struct httpd_host_t
     struct vlc_list clients;
     unsigned timeout_sec;
 
+    /* wakes the host thread up when a stream gets new data,
+     * -1 if not supported */
+    int wakefd[2];
+    atomic_bool wake_pending;
+
     /* TLS data */
     vlc_tls_server_t *p_tls;
 };
@@ -130,6 +139,7 @@ enum
     HTTPD_CLIENT_SEND_DONE,
 
     HTTPD_CLIENT_WAITING,
+    HTTPD_CLIENT_STREAMING, /* sending from the buffer of the stream */
 
     HTTPD_CLIENT_DEAD,
 
@@ -147,6 +157,9 @@ struct httpd_client_t
     bool    b_stream_mode;
     uint8_t i_state;
 
+    /* Stream to send data directly from, once the answer header is sent */
+    httpd_stream_t *stream;
+
     vlc_tick_t i_timeout_date;
 
     /* buffer for reading header */
@@ -739,6 +752,9 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         } else if (!b_has_content_type)
             httpd_MsgAdd(answer, "Content-type", "%s", stream->psz_mime);
 
+        if (cl->b_stream_mode && answer->i_body_offset > 0)
+            cl->stream = stream;
+
         if (!b_has_cache_control)
             httpd_MsgAdd(answer, "Cache-Control", "no-cache");
 
@@ -824,6 +840,86 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
+/**
+ * Sends stream data to a client, straight from the circular buffer shared by
+ * all the clients of the stream: nothing is copied per client.
+ *
+ * \return -1 if the socket is not ready, 0 if data was sent, 1 if there is
+ * no data to send yet
+ */
+static int httpd_StreamClientSend(httpd_stream_t *stream, httpd_client_t *cl)
+{
+    int64_t *offset = &cl->answer.i_body_offset;
+    struct iovec iov[2];
+    int iovcnt = 0;
+    ssize_t val = 0;
+
+    vlc_mutex_lock(&stream->lock);
+    if (cl->i_keyframe_wait_to_pass >= 0) {
+        if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            goto out; /* still waiting for the next keyframe */
+
+        /* seek to the new keyframe */
+        *offset = stream->i_last_keyframe_seen_pos;
+        cl->i_keyframe_wait_to_pass = -1;
+    }
+
+    if (*offset + stream->i_buffer_size < stream->i_buffer_pos)
+        *offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
+
+    int64_t i_write = stream->i_buffer_pos - *offset;
+    if (i_write <= 0)
+        goto out; /* wait, no data available */
+    if (i_write > HTTPD_CL_BUFSIZE)
+        i_write = HTTPD_CL_BUFSIZE;
+
+    /* the data may wrap around the end of the circular buffer */
+    size_t i_pos = *offset % stream->i_buffer_size;
+    size_t i_len = __MIN((size_t)i_write, stream->i_buffer_size - i_pos);
+
+    iov[iovcnt].iov_base = &stream->p_buffer[i_pos];
+    iov[iovcnt++].iov_len = i_len;
+    if (i_len < (size_t)i_write) {
+        iov[iovcnt].iov_base = stream->p_buffer;
+        iov[iovcnt++].iov_len = i_write - i_len;
+    }
+
+    /* The producer cannot overwrite the data while it is being sent: the
+     * socket copies it before the stream gets unlocked. */
+    val = cl->sock->ops->writev(cl->sock, iov, iovcnt);
+    if (val > 0)
+        *offset += val;
+out:
+    vlc_mutex_unlock(&stream->lock);
+
+    if (iovcnt == 0)
+        return 1;
+    if (val < 0) {
+#if defined(_WIN32)
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN)
+#endif
+            return -1;
+
+        /* Connection failed, or hung up (EPIPE) */
+        cl->i_state = HTTPD_CLIENT_DEAD;
+    }
+    return 0;
+}
+
+static void httpd_HostWake(httpd_host_t *host)
+{
+#ifndef _WIN32
+    if (host->wakefd[1] != -1
+     && !atomic_exchange_explicit(&host->wake_pending, true,
+                                  memory_order_acq_rel))
+        (void) !write(host->wakefd[1], &(char){ 0 }, 1);
+#else
+    (void) host;
+#endif
+}
+
 static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
 {
     int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
@@ -860,6 +956,7 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
     httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
 
     vlc_mutex_unlock(&stream->lock);
+    httpd_HostWake(stream->url->host);
     return VLC_SUCCESS;
 }
 
@@ -981,6 +1078,13 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
+    host->wakefd[0] = host->wakefd[1] = -1;
+    atomic_init(&host->wake_pending, false);
+#ifndef _WIN32
+    if (vlc_pipe(host->wakefd))
+        host->wakefd[0] = host->wakefd[1] = -1;
+#endif
+
     /* create the thread */
     if (vlc_clone(&host->thread, httpd_HostThread, host,
                    VLC_THREAD_PRIORITY_LOW)) {
@@ -998,6 +1102,10 @@ error:
     vlc_mutex_unlock(&httpd.mutex);
 
     if (host) {
+        if (host->wakefd[0] != -1) {
+            vlc_close(host->wakefd[1]);
+            vlc_close(host->wakefd[0]);
+        }
         net_ListenClose(host->fds);
         vlc_object_delete(host);
     }
@@ -1033,6 +1141,10 @@ void httpd_HostDelete(httpd_host_t *host)
 
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
+    if (host->wakefd[0] != -1) {
+        vlc_close(host->wakefd[1]);
+        vlc_close(host->wakefd[0]);
+    }
     net_ListenClose(host->fds);
     vlc_object_delete(host);
     vlc_mutex_unlock(&httpd.mutex);
@@ -1235,11 +1347,13 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->sock    = sock;
     cl->url     = NULL;
     cl->i_state = HTTPD_CLIENT_RECEIVING;
-    cl->i_buffer_size = HTTPD_CL_BUFSIZE;
+    cl->i_buffer_size = HTTPD_CL_RECV_BUFSIZE;
     cl->i_buffer = 0;
-    cl->p_buffer = xmalloc(cl->i_buffer_size);
+    // Allocate an extra byte for the null terminating byte
+    cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
+    cl->stream = NULL;
 
     httpd_MsgInit(&cl->query);
     httpd_MsgInit(&cl->answer);
@@ -1624,7 +1738,8 @@ static int httpd_ClientSend(httpd_client_t *cl)
     cl->i_buffer += i_len;
 
     if (cl->i_buffer >= cl->i_buffer_size) {
-        if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
+        if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0
+         && cl->stream == NULL) {
             /* catch more body data */
             int     i_msg = cl->query.i_type;
             int64_t i_offset = cl->answer.i_body_offset;
@@ -1704,13 +1819,20 @@ auth_failed:
 
 static void httpdLoop(httpd_host_t *host)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
+    struct pollfd ufd[host->nfd + 1 + host->client_count];
     unsigned nfd;
     for (nfd = 0; nfd < host->nfd; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
         ufd[nfd].events = POLLIN;
         ufd[nfd].revents = 0;
     }
+    /* the wake up pipe follows the listening sockets */
+    if (host->wakefd[0] != -1) {
+        ufd[nfd].fd = host->wakefd[0];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+        nfd++;
+    }
 
     vlc_mutex_lock(&host->lock);
     /* add all socket that should be read/write and close dead connection */
@@ -1729,6 +1851,9 @@ static void httpdLoop(httpd_host_t *host)
             case HTTPD_CLIENT_SENDING:
                 val = httpd_ClientSend(cl);
                 break;
+            case HTTPD_CLIENT_STREAMING:
+                val = httpd_StreamClientSend(cl->stream, cl);
+                break;
             case HTTPD_CLIENT_TLS_HS_IN:
             case HTTPD_CLIENT_TLS_HS_OUT:
                 httpd_ClientTlsHandshake(host, cl);
@@ -1763,6 +1888,12 @@ static void httpdLoop(httpd_host_t *host)
                 pufd->events = POLLOUT;
                 break;
 
+            case HTTPD_CLIENT_STREAMING:
+                /* otherwise woken up by the stream when it gets data */
+                if (val <= 0)
+                    pufd->events = POLLOUT;
+                break;
+
             case HTTPD_CLIENT_RECEIVE_DONE: {
                 httpd_message_t *answer = &cl->answer;
                 httpd_message_t *query  = &cl->query;
@@ -1912,6 +2043,7 @@ static void httpdLoop(httpd_host_t *host)
                     bool do_close = false;
 
                     cl->url = NULL;
+                    cl->stream = NULL;
 
                     if (cl->query.i_proto != HTTPD_PROTO_HTTP
                      || cl->query.i_version > 0)
@@ -1947,7 +2079,8 @@ static void httpdLoop(httpd_host_t *host)
                     cl->i_buffer = 0;
                     cl->i_buffer_size = 0;
 
-                    cl->i_state = HTTPD_CLIENT_WAITING;
+                    cl->i_state = (cl->stream != NULL) ? HTTPD_CLIENT_STREAMING
+                                                       : HTTPD_CLIENT_WAITING;
                 }
                 break;
 
@@ -1977,7 +2110,9 @@ static void httpdLoop(httpd_host_t *host)
         if (pufd->events != 0)
             nfd++;
         /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
-        else if (delay != 0)
+        else if (delay != 0
+              && (cl->i_state != HTTPD_CLIENT_STREAMING
+               || host->wakefd[0] == -1))
             delay = 20;
     }
     vlc_mutex_unlock(&host->lock);
@@ -1996,6 +2131,14 @@ static void httpdLoop(httpd_host_t *host)
     now = vlc_tick_now();
     nfd = host->nfd;
 
+    if (host->wakefd[0] != -1 && ufd[nfd].revents != 0) {
+        char dummy;
+
+        atomic_store_explicit(&host->wake_pending, false,
+                              memory_order_release);
+        (void) !read(host->wakefd[0], &dummy, 1);
+    }
+
     /* Handle server sockets (accept new connections) */
     for (nfd = 0; nfd < host->nfd; nfd++) {
         int fd = ufd[nfd].fd;
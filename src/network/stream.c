@@ -49,6 +49,7 @@
 #include <vlc_common.h>
 #include <vlc_tls.h>
 #include <vlc_interrupt.h>
+#include "libvlc.h"
 
 ssize_t vlc_tls_Read(vlc_tls_t *session, void *buf, size_t len, bool waitall)
 {
@@ -254,6 +255,11 @@ vlc_tls_t *vlc_tls_SocketOpen(int fd)
     return vlc_tls_SocketAlloc(fd, NULL, 0);
 }
 
+bool vlc_tls_IsSocket(const vlc_tls_t *tls)
+{
+    return tls->ops == &vlc_tls_socket_ops;
+}
+
 int vlc_tls_SocketPair(int family, int protocol, vlc_tls_t *pair[2])
 {
     int fds[2];
@@ -428,6 +434,161 @@ vlc_tls_t *vlc_tls_SocketOpenAddrInfo(const struct addrinfo *restrict info,
     return sock;
 }
 
+/* Connection attempt delay and concurrency (RFC8305 §5) */
+#define VLC_TLS_CONNECT_DELAY VLC_TICK_FROM_MS(250)
+#define VLC_TLS_CONNECT_MAX   8
+
+/**
+ * Sorts the resolved addresses for connection, alternating the address
+ * families and starting with the preferred one (RFC8305 §4).
+ */
+static size_t vlc_tls_SortAddrInfo(const struct addrinfo *res,
+                                   const struct addrinfo **tab, size_t max)
+{
+    const int family = res->ai_family;
+    const struct addrinfo *next[2] = { res, res };
+    size_t n = 0;
+
+    while (next[1] != NULL && next[1]->ai_family == family)
+        next[1] = next[1]->ai_next;
+
+    for (unsigned turn = 0; n < max; turn = !turn)
+    {
+        if (next[turn] == NULL)
+        {
+            turn = !turn;
+            if (next[turn] == NULL)
+                break;
+        }
+
+        const struct addrinfo *p = next[turn];
+
+        tab[n++] = p;
+        do
+            p = p->ai_next;
+        while (p != NULL && (p->ai_family == family) == turn);
+        next[turn] = p;
+    }
+    return n;
+}
+
+/**
+ * Connects to the first reachable address.
+ *
+ * A new connection attempt starts whenever the previous ones did not
+ * complete within the attempt delay, and the first one to succeed wins.
+ */
+static vlc_tls_t *vlc_tls_SocketRace(const struct addrinfo *res)
+{
+    const struct addrinfo *tab[VLC_TLS_CONNECT_MAX];
+    vlc_tls_t *socks[VLC_TLS_CONNECT_MAX];
+    struct pollfd ufd[VLC_TLS_CONNECT_MAX];
+    size_t count = vlc_tls_SortAddrInfo(res, tab, ARRAY_SIZE(tab));
+    size_t started = 0, pending = 0;
+    vlc_tick_t deadline = VLC_TICK_INVALID; /* of the next attempt */
+    vlc_tls_t *winner = NULL;
+    int err = ECONNREFUSED;
+
+    while (winner == NULL && (started < count || pending > 0))
+    {
+        if (vlc_killed())
+        {
+            err = EINTR;
+            break;
+        }
+
+        if (started < count
+         && (deadline == VLC_TICK_INVALID || vlc_tick_now() >= deadline))
+        {
+            vlc_tls_t *sk = vlc_tls_SocketAddrInfo(tab[started++]);
+            if (sk == NULL)
+            {
+                err = errno;
+                continue;
+            }
+
+            const vlc_tls_socket_t *sock = (vlc_tls_socket_t *)sk;
+
+            if (connect(sock->fd, sock->peer, sock->peerlen) == 0)
+            {
+                winner = sk;
+                break;
+            }
+#ifndef _WIN32
+            if (errno != EINPROGRESS)
+#else
+            if (WSAGetLastError() != WSAEWOULDBLOCK)
+#endif
+            {
+                err = errno;
+                vlc_tls_SessionDelete(sk);
+                continue;
+            }
+
+            socks[pending] = sk;
+            ufd[pending].fd = sock->fd;
+            ufd[pending].events = POLLOUT;
+            pending++;
+            deadline = vlc_tick_now() + VLC_TLS_CONNECT_DELAY;
+        }
+
+        if (pending == 0)
+            continue;
+
+        int timeout = -1;
+        if (started < count)
+        {
+            vlc_tick_t delay = deadline - vlc_tick_now();
+            /* round up, not to wake up before the deadline */
+            timeout = delay > 0
+                    ? MS_FROM_VLC_TICK(delay + VLC_TICK_FROM_MS(1) - 1) : 0;
+        }
+
+        int ret = vlc_poll_i11e(ufd, pending, timeout);
+        if (ret < 0)
+        {   /* interrupted: the interruption is cleared once returned */
+            err = errno;
+            break;
+        }
+        if (ret == 0)
+            continue;
+
+        for (size_t i = 0; i < pending; i++)
+        {
+            if (ufd[i].revents == 0)
+                continue;
+
+            int val;
+            socklen_t len = sizeof (val);
+
+            if (getsockopt(ufd[i].fd, SOL_SOCKET, SO_ERROR, &val, &len))
+                val = errno;
+            if (val == 0)
+            {
+                winner = socks[i];
+                socks[i] = NULL;
+                break;
+            }
+
+            err = val;
+            deadline = VLC_TICK_INVALID; /* start the next attempt now */
+            vlc_tls_SessionDelete(socks[i]);
+            pending--;
+            socks[i] = socks[pending];
+            ufd[i] = ufd[pending];
+            i--;
+        }
+    }
+
+    for (size_t i = 0; i < pending; i++)
+        if (socks[i] != NULL)
+            vlc_tls_SessionDelete(socks[i]);
+
+    if (winner == NULL)
+        errno = err;
+    return winner;
+}
+
 vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
                                  unsigned port)
 {
@@ -440,7 +601,7 @@ vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
     assert(name != NULL);
     msg_Dbg(obj, "resolving %s ...", name);
 
-    int val = vlc_getaddrinfo_i11e(name, port, &hints, &res);
+    int val = vlc_getaddrinfo_cached_i11e(name, port, &hints, &res);
     if (val != 0)
     {   /* TODO: C locale for gai_strerror() */
         msg_Err(obj, "cannot resolve %s port %u: %s", name, port,
@@ -450,20 +611,10 @@ vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
 
     msg_Dbg(obj, "connecting to %s port %u ...", name, port);
 
-    /* TODO: implement RFC8305 */
-    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
-    {
-        vlc_tls_t *tls = vlc_tls_SocketOpenAddrInfo(p, false);
-        if (tls == NULL)
-        {
-            msg_Err(obj, "connection error: %s", vlc_strerror_c(errno));
-            continue;
-        }
-
-        freeaddrinfo(res);
-        return tls;
-    }
+    vlc_tls_t *tls = vlc_tls_SocketRace(res);
+    if (tls == NULL)
+        msg_Err(obj, "connection error: %s", vlc_strerror_c(errno));
 
-    freeaddrinfo(res);
-    return NULL;
+    vlc_freeaddrinfo_cached(res);
+    return tls;
 }
@@ -695,42 +695,12 @@ vlc_player_input_HandleVoutEvent(struct vlc_player_input *input,
 }
 
 static void
-input_thread_Events(input_thread_t *input_thread,
-                    const struct vlc_input_event *event, void *user_data)
+vlc_player_input_HandleEvent(struct vlc_player_input *input,
+                             const struct vlc_input_event *event)
 {
-    struct vlc_player_input *input = user_data;
     vlc_player_t *player = input->player;
 
-    assert(input_thread == input->thread);
-
-    /* No player lock for this event */
-    if (event->type == INPUT_EVENT_OUTPUT_CLOCK)
-    {
-        if (event->output_clock.system_ts != VLC_TICK_INVALID)
-        {
-            const struct vlc_player_timer_point point = {
-                .position = 0,
-                .rate = event->output_clock.rate,
-                .ts = event->output_clock.ts,
-                .length = VLC_TICK_INVALID,
-                .system_date = event->output_clock.system_ts,
-            };
-            vlc_player_UpdateTimer(player, event->output_clock.id,
-                                   event->output_clock.master, &point,
-                                   VLC_TICK_INVALID,
-                                   event->output_clock.frame_rate,
-                                   event->output_clock.frame_rate_base);
-        }
-        else
-        {
-            vlc_player_UpdateTimerState(player, event->output_clock.id,
-                                        VLC_PLAYER_TIMER_STATE_DISCONTINUITY,
-                                        VLC_TICK_INVALID);
-        }
-        return;
-    }
-
-    vlc_mutex_lock(&player->lock);
+    vlc_mutex_assert(&player->lock);
 
     switch (event->type)
     {
@@ -861,6 +831,54 @@ input_thread_Events(input_thread_t *input_thread,
         default:
             break;
     }
+}
+
+static void
+input_thread_Events(input_thread_t *input_thread,
+                    const struct vlc_input_event *event, void *user_data)
+{
+    struct vlc_player_input *input = user_data;
+    vlc_player_t *player = input->player;
+
+    assert(input_thread == input->thread);
+
+    /* No player lock for this event */
+    if (event->type == INPUT_EVENT_OUTPUT_CLOCK)
+    {
+        if (event->output_clock.system_ts != VLC_TICK_INVALID)
+        {
+            const struct vlc_player_timer_point point = {
+                .position = 0,
+                .rate = event->output_clock.rate,
+                .ts = event->output_clock.ts,
+                .length = VLC_TICK_INVALID,
+                .system_date = event->output_clock.system_ts,
+            };
+            vlc_player_UpdateTimer(player, event->output_clock.id,
+                                   event->output_clock.master, &point,
+                                   VLC_TICK_INVALID,
+                                   event->output_clock.frame_rate,
+                                   event->output_clock.frame_rate_base);
+        }
+        else
+        {
+            vlc_player_UpdateTimerState(player, event->output_clock.id,
+                                        VLC_PLAYER_TIMER_STATE_DISCONTINUITY,
+                                        VLC_TICK_INVALID);
+        }
+        return;
+    }
+
+    vlc_mutex_lock(&player->lock);
+
+    if (event->type == INPUT_EVENT_BATCH)
+    {
+        /* Coalesced events: handled with a single lock */
+        for (size_t i = 0; i < event->batch.count; i++)
+            vlc_player_input_HandleEvent(input, &event->batch.events[i]);
+    }
+    else
+        vlc_player_input_HandleEvent(input, event);
 
     vlc_mutex_unlock(&player->lock);
 }
@@ -965,6 +983,7 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
         free(input);
         return NULL;
     }
+    input_SetEventsBatched(input->thread, true);
     vlc_player_input_RestoreMlStates(input, false);
 
     if (player->video_string_ids)
@@ -37,6 +37,7 @@ vlc_playlist_ClearItems(vlc_playlist_t *playlist)
     vlc_vector_foreach(item, &playlist->items)
         vlc_playlist_item_Release(item);
     vlc_vector_clear(&playlist->items);
+    vlc_playlist_lookup_Clear(&playlist->lookup);
 }
 
 static void
@@ -60,6 +61,10 @@ vlc_playlist_ItemsReset(vlc_playlist_t *playlist)
 static void
 vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
 {
+    vlc_playlist_lookup_Add(&playlist->lookup, &playlist->items.data[index],
+                            count);
+    vlc_playlist_lookup_Invalidate(&playlist->lookup, index);
+
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
         randomizer_Add(&playlist->randomizer,
                        &playlist->items.data[index], count);
@@ -87,6 +92,8 @@ static void
 vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
                         size_t target)
 {
+    vlc_playlist_lookup_Invalidate(&playlist->lookup, __MIN(index, target));
+
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
 
@@ -124,6 +131,10 @@ vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
 static void
 vlc_playlist_ItemsRemoving(vlc_playlist_t *playlist, size_t index, size_t count)
 {
+    vlc_playlist_lookup_Remove(&playlist->lookup, &playlist->items.data[index],
+                               count);
+    vlc_playlist_lookup_Invalidate(&playlist->lookup, index);
+
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
         randomizer_Remove(&playlist->randomizer,
                           &playlist->items.data[index], count);
@@ -196,34 +207,21 @@ ssize_t
 vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return vlc_playlist_lookup_IndexOf(playlist, item);
 }
 
 ssize_t
 vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    return vlc_playlist_lookup_IndexOfMedia(playlist, media);
 }
 
 ssize_t
 vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    return vlc_playlist_lookup_IndexOfId(playlist, id);
 }
 
 void
@@ -323,6 +321,101 @@ vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
         vlc_player_InvalidateNextMedia(playlist->player);
 }
 
+static bool
+vlc_playlist_CanNotifyBatchRemoval(vlc_playlist_t *playlist)
+{
+    vlc_playlist_listener_id *listener;
+    vlc_playlist_listener_foreach(listener, playlist)
+        if (listener->cbs->on_items_removed &&
+            !listener->cbs->on_items_batch_removed)
+            /* this listener expects one event per slice */
+            return false;
+    return true;
+}
+
+bool
+vlc_playlist_RemoveBatch(vlc_playlist_t *playlist, const size_t indices[],
+                         size_t count)
+{
+    vlc_playlist_AssertLocked(playlist);
+    assert(count > 0);
+
+    if (!vlc_playlist_CanNotifyBatchRemoval(playlist))
+        return false;
+
+    playlist_item_vector_t *items = &playlist->items;
+    vlc_playlist_item_t **removed = vlc_alloc(count, sizeof(*removed));
+    if (unlikely(!removed))
+        return false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(indices[i] < items->size);
+        assert(i == 0 || indices[i - 1] < indices[i]);
+        removed[i] = items->data[indices[i]];
+    }
+
+    if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
+        randomizer_Remove(&playlist->randomizer, removed, count);
+
+    vlc_playlist_lookup_Remove(&playlist->lookup, removed, count);
+    vlc_playlist_lookup_Invalidate(&playlist->lookup, indices[0]);
+
+    /* remove all the items in a single pass, instead of shifting the tail of
+     * the vector once per slice */
+    size_t dst = indices[0];
+    size_t next = 0;
+    for (size_t src = indices[0]; src < items->size; ++src)
+    {
+        if (next < count && indices[next] == src)
+            ++next;
+        else
+            items->data[dst++] = items->data[src];
+    }
+    assert(next == count);
+    items->size = dst;
+    vlc_vector_autoshrink(items);
+
+    for (size_t i = 0; i < count; ++i)
+        vlc_playlist_item_Release(removed[i]);
+    free(removed);
+
+    struct vlc_playlist_state state;
+    vlc_playlist_state_Save(playlist, &state);
+
+    bool current_media_changed = false;
+    if (playlist->current != -1)
+    {
+        size_t current = (size_t) playlist->current;
+        size_t removed_before = 0;
+        while (removed_before < count && indices[removed_before] < current)
+            removed_before++;
+
+        if (removed_before < count && indices[removed_before] == current)
+        {
+            /* current item has been removed, select the first item after
+             * it, if any */
+            current -= removed_before;
+            playlist->current = current < items->size ? (ssize_t) current : -1;
+            current_media_changed = true;
+        }
+        else
+            playlist->current -= removed_before;
+    }
+    playlist->has_prev = vlc_playlist_ComputeHasPrev(playlist);
+    playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
+
+    vlc_playlist_Notify(playlist, on_items_batch_removed, indices, count);
+    vlc_playlist_state_NotifyChanges(playlist, &state);
+
+    if (current_media_changed)
+        vlc_playlist_SetCurrentMedia(playlist, playlist->current);
+    else
+        vlc_player_InvalidateNextMedia(playlist->player);
+
+    return true;
+}
+
 static int
 vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
                      input_item_t *media)
@@ -342,6 +435,12 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
         randomizer_Add(&playlist->randomizer, &item, 1);
     }
 
+    vlc_playlist_lookup_Remove(&playlist->lookup,
+                               &playlist->items.data[index], 1);
+    vlc_playlist_lookup_Add(&playlist->lookup, &item, 1);
+    /* the other items do not move */
+    item->index = index;
+
     vlc_playlist_item_Release(playlist->items.data[index]);
     playlist->items.data[index] = item;
 
@@ -21,6 +21,8 @@
 #ifndef VLC_PLAYLIST_CONTENT_H
 #define VLC_PLAYLIST_CONTENT_H
 
+#include <vlc_common.h>
+
 typedef struct vlc_playlist vlc_playlist_t;
 typedef struct input_item_t input_item_t;
 
@@ -28,6 +30,18 @@ typedef struct input_item_t input_item_t;
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist);
 
+/**
+ * Remove the items at the given indices at once, and notify listeners with a
+ * single on_items_batch_removed() event.
+ *
+ * Return false if the removal could not be batched (because some listeners
+ * do not support it, or on allocation failure); the playlist is then left
+ * unchanged, and the caller must remove the items slice by slice.
+ */
+bool
+vlc_playlist_RemoveBatch(vlc_playlist_t *playlist, const size_t indices[],
+                         size_t count);
+
 /* expand an item (replace it by the given media array) */
 int
 vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
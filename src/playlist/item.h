@@ -31,6 +31,10 @@ struct vlc_playlist_item
     input_item_t *media;
     uint64_t id;
     vlc_atomic_rc_t rc;
+    /* managed by lookup.c, under the playlist lock */
+    size_t index; /**< cached position in the playlist */
+    struct vlc_playlist_item *next_media; /**< next item in the media bucket */
+    struct vlc_playlist_item *next_id; /**< next item in the id bucket */
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
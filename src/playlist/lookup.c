@@ -0,0 +1,281 @@
+/*****************************************************************************
+ * playlist/lookup.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "lookup.h"
+
+#include "item.h"
+#include "playlist.h"
+
+#define LOOKUP_MIN_BUCKETS 64
+
+static inline size_t
+HashU64(uint64_t value)
+{
+    /* finalizer of MurmurHash3, spreads consecutive ids and pointers */
+    value ^= value >> 33;
+    value *= UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+    return value;
+}
+
+static inline size_t
+HashMedia(const input_item_t *media)
+{
+    return HashU64((uintptr_t) media);
+}
+
+void
+vlc_playlist_lookup_Init(struct vlc_playlist_lookup *lookup)
+{
+    lookup->by_media = NULL;
+    lookup->by_id = NULL;
+    lookup->mask = 0;
+    lookup->count = 0;
+    lookup->stale = 0;
+    lookup->complete = true;
+}
+
+void
+vlc_playlist_lookup_Destroy(struct vlc_playlist_lookup *lookup)
+{
+    free(lookup->by_media);
+    free(lookup->by_id);
+}
+
+void
+vlc_playlist_lookup_Clear(struct vlc_playlist_lookup *lookup)
+{
+    vlc_playlist_lookup_Destroy(lookup);
+    vlc_playlist_lookup_Init(lookup);
+}
+
+static void
+Link(struct vlc_playlist_lookup *lookup, vlc_playlist_item_t *item)
+{
+    size_t bucket = HashMedia(item->media) & lookup->mask;
+    item->next_media = lookup->by_media[bucket];
+    lookup->by_media[bucket] = item;
+
+    bucket = HashU64(item->id) & lookup->mask;
+    item->next_id = lookup->by_id[bucket];
+    lookup->by_id[bucket] = item;
+}
+
+static void
+Unlink(struct vlc_playlist_lookup *lookup, const vlc_playlist_item_t *item)
+{
+    vlc_playlist_item_t **pp = &lookup->by_media[HashMedia(item->media)
+                                                 & lookup->mask];
+    while (*pp != item)
+    {
+        assert(*pp);
+        pp = &(*pp)->next_media;
+    }
+    *pp = item->next_media;
+
+    pp = &lookup->by_id[HashU64(item->id) & lookup->mask];
+    while (*pp != item)
+    {
+        assert(*pp);
+        pp = &(*pp)->next_id;
+    }
+    *pp = item->next_id;
+}
+
+static bool
+Resize(struct vlc_playlist_lookup *lookup, size_t buckets)
+{
+    vlc_playlist_item_t **by_media = calloc(buckets, sizeof(*by_media));
+    vlc_playlist_item_t **by_id = calloc(buckets, sizeof(*by_id));
+    if (unlikely(!by_media || !by_id))
+    {
+        free(by_media);
+        free(by_id);
+        return false;
+    }
+
+    vlc_playlist_item_t **old_by_media = lookup->by_media;
+    size_t old_buckets = old_by_media ? lookup->mask + 1 : 0;
+
+    free(lookup->by_id);
+    lookup->by_media = by_media;
+    lookup->by_id = by_id;
+    lookup->mask = buckets - 1;
+
+    /* every item is in exactly one media chain */
+    for (size_t i = 0; i < old_buckets; ++i)
+    {
+        vlc_playlist_item_t *item = old_by_media[i];
+        while (item)
+        {
+            vlc_playlist_item_t *next = item->next_media;
+            Link(lookup, item);
+            item = next;
+        }
+    }
+    free(old_by_media);
+    return true;
+}
+
+static bool
+Reserve(struct vlc_playlist_lookup *lookup, size_t count)
+{
+    size_t buckets = lookup->by_media ? lookup->mask + 1 : 0;
+    if (count <= buckets)
+        return true;
+
+    size_t new_buckets = buckets ? buckets : LOOKUP_MIN_BUCKETS;
+    while (new_buckets < count)
+    {
+        if (new_buckets > SIZE_MAX / 2)
+            break;
+        new_buckets *= 2;
+    }
+
+    /* if a resize fails, the existing buckets just get longer chains */
+    return Resize(lookup, new_buckets) || buckets;
+}
+
+void
+vlc_playlist_lookup_Add(struct vlc_playlist_lookup *lookup,
+                        vlc_playlist_item_t *const items[], size_t count)
+{
+    if (!lookup->complete)
+        /* the indexes will be rebuilt on the next lookup */
+        return;
+
+    if (!Reserve(lookup, lookup->count + count))
+    {
+        lookup->complete = false;
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        Link(lookup, items[i]);
+    lookup->count += count;
+}
+
+void
+vlc_playlist_lookup_Remove(struct vlc_playlist_lookup *lookup,
+                           vlc_playlist_item_t *const items[], size_t count)
+{
+    if (!lookup->complete)
+        return;
+
+    assert(lookup->count >= count);
+    for (size_t i = 0; i < count; ++i)
+        Unlink(lookup, items[i]);
+    lookup->count -= count;
+}
+
+static bool
+vlc_playlist_lookup_Rebuild(vlc_playlist_t *playlist)
+{
+    struct vlc_playlist_lookup *lookup = &playlist->lookup;
+    if (lookup->complete)
+        return true;
+
+    vlc_playlist_lookup_Clear(lookup);
+    vlc_playlist_lookup_Add(lookup, playlist->items.data, playlist->items.size);
+    return lookup->complete;
+}
+
+static void
+vlc_playlist_lookup_Refresh(vlc_playlist_t *playlist)
+{
+    struct vlc_playlist_lookup *lookup = &playlist->lookup;
+    for (size_t i = lookup->stale; i < playlist->items.size; ++i)
+        playlist->items.data[i]->index = i;
+    lookup->stale = playlist->items.size;
+}
+
+ssize_t
+vlc_playlist_lookup_IndexOf(vlc_playlist_t *playlist,
+                            const vlc_playlist_item_t *item)
+{
+    vlc_playlist_lookup_Refresh(playlist);
+
+    /* the item may have been removed from the playlist (it is still alive,
+     * so its address may not have been reused) */
+    size_t index = item->index;
+    if (index < playlist->items.size && playlist->items.data[index] == item)
+        return index;
+    return -1;
+}
+
+ssize_t
+vlc_playlist_lookup_IndexOfMedia(vlc_playlist_t *playlist,
+                                 const input_item_t *media)
+{
+    playlist_item_vector_t *items = &playlist->items;
+    if (!vlc_playlist_lookup_Rebuild(playlist))
+    {
+        for (size_t i = 0; i < items->size; ++i)
+            if (items->data[i]->media == media)
+                return i;
+        return -1;
+    }
+
+    struct vlc_playlist_lookup *lookup = &playlist->lookup;
+    if (!lookup->by_media)
+        return -1;
+
+    vlc_playlist_lookup_Refresh(playlist);
+
+    /* the same media may be inserted several times, return the first one */
+    ssize_t ret = -1;
+    vlc_playlist_item_t *item = lookup->by_media[HashMedia(media)
+                                                 & lookup->mask];
+    for (; item; item = item->next_media)
+        if (item->media == media && (ret == -1 || item->index < (size_t) ret))
+            ret = item->index;
+    return ret;
+}
+
+ssize_t
+vlc_playlist_lookup_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
+{
+    playlist_item_vector_t *items = &playlist->items;
+    if (!vlc_playlist_lookup_Rebuild(playlist))
+    {
+        for (size_t i = 0; i < items->size; ++i)
+            if (items->data[i]->id == id)
+                return i;
+        return -1;
+    }
+
+    struct vlc_playlist_lookup *lookup = &playlist->lookup;
+    if (!lookup->by_id)
+        return -1;
+
+    vlc_playlist_lookup_Refresh(playlist);
+
+    vlc_playlist_item_t *item = lookup->by_id[HashU64(id) & lookup->mask];
+    for (; item; item = item->next_id)
+        if (item->id == id)
+            return item->index;
+    return -1;
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * playlist/lookup.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_LOOKUP_H
+#define VLC_PLAYLIST_LOOKUP_H
+
+#include <vlc_common.h>
+
+typedef struct vlc_playlist vlc_playlist_t;
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+typedef struct input_item_t input_item_t;
+
+/**
+ * Indexes of the playlist items, by media and by id.
+ *
+ * The items are chained in the buckets through their next_media and next_id
+ * fields. Each item also caches its position in the playlist; the cached
+ * positions are only refreshed on lookup, from the first position that a
+ * change may have shifted.
+ */
+struct vlc_playlist_lookup
+{
+    vlc_playlist_item_t **by_media;
+    vlc_playlist_item_t **by_id;
+    size_t mask; /**< number of buckets - 1 */
+    size_t count; /**< number of indexed items */
+    size_t stale; /**< cached positions are valid below this index */
+    bool complete; /**< false if an allocation failure lost some items */
+};
+
+void
+vlc_playlist_lookup_Init(struct vlc_playlist_lookup *lookup);
+
+void
+vlc_playlist_lookup_Destroy(struct vlc_playlist_lookup *lookup);
+
+/* to be called whenever the items have been cleared */
+void
+vlc_playlist_lookup_Clear(struct vlc_playlist_lookup *lookup);
+
+/* index new items (they do not need to be in the playlist yet) */
+void
+vlc_playlist_lookup_Add(struct vlc_playlist_lookup *lookup,
+                        vlc_playlist_item_t *const items[], size_t count);
+
+/* unindex items about to be removed from the playlist */
+void
+vlc_playlist_lookup_Remove(struct vlc_playlist_lookup *lookup,
+                           vlc_playlist_item_t *const items[], size_t count);
+
+/* the items at index and after may have moved */
+static inline void
+vlc_playlist_lookup_Invalidate(struct vlc_playlist_lookup *lookup, size_t index)
+{
+    if (index < lookup->stale)
+        lookup->stale = index;
+}
+
+ssize_t
+vlc_playlist_lookup_IndexOf(vlc_playlist_t *playlist,
+                            const vlc_playlist_item_t *item);
+
+ssize_t
+vlc_playlist_lookup_IndexOfMedia(vlc_playlist_t *playlist,
+                                 const input_item_t *media);
+
+ssize_t
+vlc_playlist_lookup_IndexOfId(vlc_playlist_t *playlist, uint64_t id);
+
+#endif
@@ -45,6 +45,7 @@ vlc_playlist_New(vlc_object_t *parent)
     }
 
     vlc_vector_init(&playlist->items);
+    vlc_playlist_lookup_Init(&playlist->lookup);
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
@@ -73,6 +74,7 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
+    vlc_playlist_lookup_Destroy(&playlist->lookup);
     free(playlist);
 }
 
@@ -524,12 +524,72 @@ randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_RemoveAt(r, index);
 }
 
+static int
+cmp_item_ptr(const void *lhs, const void *rhs)
+{
+    uintptr_t a = (uintptr_t) *(vlc_playlist_item_t *const *) lhs;
+    uintptr_t b = (uintptr_t) *(vlc_playlist_item_t *const *) rhs;
+    if (a < b)
+        return -1;
+    if (a == b)
+        return 0;
+    return 1;
+}
+
+/* Remove all the (sorted by address) items in a single pass.
+ *
+ * The relative order of the remaining items is kept, and each removed item
+ * updates the indexes as randomizer_RemoveAt() would. */
+static void
+randomizer_RemoveSorted(struct randomizer *r,
+                        vlc_playlist_item_t *const sorted[], size_t count)
+{
+    size_t head = r->head;
+    size_t next = r->next;
+    size_t history = r->history;
+
+    size_t dst = 0;
+    for (size_t src = 0; src < r->items.size; ++src)
+    {
+        vlc_playlist_item_t *item = r->items.data[src];
+        if (bsearch(&item, sorted, count, sizeof(*sorted), cmp_item_ptr))
+        {
+            if (src < r->head)
+                head--;
+            if (src < r->next)
+                next--;
+            if (src < r->history)
+                history--;
+        }
+        else
+            r->items.data[dst++] = item;
+    }
+    assert(r->items.size - dst == count); /* items must exist */
+
+    r->items.size = dst;
+    r->head = head;
+    r->next = next;
+    r->history = history;
+}
+
 void
 randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
                   size_t count)
 {
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    /* looking up each item is linear, so remove batches in one pass */
+    vlc_playlist_item_t **sorted = count > 1
+                                 ? vlc_alloc(count, sizeof(*sorted))
+                                 : NULL;
+    if (sorted)
+    {
+        memcpy(sorted, items, count * sizeof(*sorted));
+        qsort(sorted, count, sizeof(*sorted), cmp_item_ptr);
+        randomizer_RemoveSorted(r, sorted, count);
+        free(sorted);
+    }
+    else
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveOne(r, items[i]);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -1209,6 +1269,60 @@ test_has_prev_next_empty(void)
     randomizer_Destroy(&randomizer);
 }
 
+static void
+test_prev_with_batch_removal(void)
+{
+    struct randomizer randomizer;
+    randomizer_Init(&randomizer);
+
+    #define SIZE 10
+    vlc_playlist_item_t *items[SIZE];
+    ArrayInit(items, SIZE);
+
+    bool ok = randomizer_Add(&randomizer, items, SIZE);
+    assert(ok);
+
+    vlc_playlist_item_t *actual[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        assert(randomizer_HasNext(&randomizer));
+        actual[i] = randomizer_Next(&randomizer);
+        assert(actual[i]);
+    }
+
+    /* remove 2 selected items and 1 item not selected yet */
+    vlc_playlist_item_t *to_remove[] = {
+        actual[3], randomizer.items.data[7], actual[1],
+    };
+    randomizer_Remove(&randomizer, to_remove, 3);
+    assert(randomizer.items.size == SIZE - 3);
+
+    /* the history of the remaining selected items is kept in order */
+    assert(randomizer_HasPrev(&randomizer));
+    assert(randomizer_Prev(&randomizer) == actual[2]);
+    assert(randomizer_HasPrev(&randomizer));
+    assert(randomizer_Prev(&randomizer) == actual[0]);
+    assert(!randomizer_HasPrev(&randomizer));
+
+    /* the current item (actual[0]) is followed by the remaining selected ones,
+     * then by the 4 items never selected */
+    assert(randomizer_Next(&randomizer) == actual[2]);
+    assert(randomizer_Next(&randomizer) == actual[4]);
+    for (int i = 0; i < 4; ++i)
+    {
+        assert(randomizer_HasNext(&randomizer));
+        vlc_playlist_item_t *item = randomizer_Next(&randomizer);
+        for (int j = 0; j < 5; ++j)
+            assert(item != actual[j]);
+        assert(item != to_remove[1]);
+    }
+    assert(!randomizer_HasNext(&randomizer));
+
+    ArrayDestroy(items, SIZE);
+    randomizer_Destroy(&randomizer);
+    #undef SIZE
+}
+
 int main(void)
 {
     test_all_items_selected_exactly_once();
@@ -1222,6 +1336,7 @@ int main(void)
     test_prev();
     test_prev_with_select();
     test_prev_across_reshuffle_loops();
+    test_prev_with_batch_removal();
     test_loop_respect_not_same_before();
     test_loop_respect_not_same_before_impossible();
     test_has_prev_next_empty();
@@ -22,6 +22,7 @@
 # include "config.h"
 #endif
 
+#include "content.h"
 #include "item.h"
 #include "playlist.h"
 
@@ -249,7 +250,18 @@ vlc_playlist_RequestRemove(vlc_playlist_t *playlist,
         /* sort so that removing an item does not shift the other indices */
         qsort(vector.data, vector.size, sizeof(vector.data[0]), cmp_size);
 
-        vlc_playlist_RemoveBySlices(playlist, vector.data, vector.size);
+        /* an item requested twice must be removed only once */
+        size_t unique = 1;
+        for (size_t i = 1; i < vector.size; ++i)
+            if (vector.data[i] != vector.data[unique - 1])
+                vector.data[unique++] = vector.data[i];
+        vector.size = unique;
+
+        bool single_slice =
+            vector.data[vector.size - 1] - vector.data[0] == vector.size - 1;
+        if (single_slice ||
+            !vlc_playlist_RemoveBatch(playlist, vector.data, vector.size))
+            vlc_playlist_RemoveBySlices(playlist, vector.data, vector.size);
     }
 
     vlc_vector_destroy(&vector);
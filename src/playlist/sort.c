@@ -37,6 +37,7 @@
  */
 struct vlc_playlist_item_meta {
     vlc_playlist_item_t *item;
+    size_t index; /**< position before sorting, to keep the sort stable */
     const char *title_or_name;
     vlc_tick_t duration;
     const char *artist;
@@ -339,7 +340,59 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
             return ret;
         }
     }
-    return 0;
+
+    /* equal items keep their relative order */
+    return CompareIntegers(a->index, b->index);
+}
+
+/**
+ * Sort the meta array, taking advantage of an already sorted prefix.
+ *
+ * After a sort, new items are typically appended to the end of the playlist:
+ * in that case, only the new items are sorted, then merged with the others.
+ */
+static void
+vlc_playlist_SortMetaArray(struct vlc_playlist_item_meta *array[],
+                           size_t count, struct sort_request *req)
+{
+    size_t sorted = 1;
+    while (sorted < count
+        && compare_meta(&array[sorted - 1], &array[sorted], req) < 0)
+        ++sorted;
+
+    if (sorted >= count)
+        return; /* nothing to do */
+
+    struct vlc_playlist_item_meta **prefix = NULL;
+    if (sorted > count / 2)
+        prefix = vlc_alloc(sorted, sizeof(*prefix));
+
+    if (!prefix)
+    {
+        /* not worth merging (or allocation failure) */
+        vlc_qsort(array, count, sizeof(*array), compare_meta, req);
+        return;
+    }
+
+    struct vlc_playlist_item_meta **tail = &array[sorted];
+    size_t tail_count = count - sorted;
+    vlc_qsort(tail, tail_count, sizeof(*tail), compare_meta, req);
+
+    /* the output never overwrites the tail items not merged yet */
+    memcpy(prefix, array, sorted * sizeof(*prefix));
+    size_t i = 0, j = 0, k = 0;
+    while (i < sorted && j < tail_count)
+    {
+        if (compare_meta(&prefix[i], &tail[j], req) < 0)
+            array[k++] = prefix[i++];
+        else
+            array[k++] = tail[j++];
+    }
+    while (i < sorted)
+        array[k++] = prefix[i++];
+    /* the remaining tail items are already in place */
+
+    free(prefix);
 }
 
 static void
@@ -368,6 +421,7 @@ vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
                                               criteria, count);
         if (unlikely(!array[i]))
             break;
+        array[i]->index = i;
     }
 
     if (i < playlist->items.size)
@@ -399,11 +453,12 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
 
     struct sort_request req = { criteria, count };
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+    vlc_playlist_SortMetaArray(array, playlist->items.size, &req);
 
     /* apply the sorting result to the playlist */
     for (size_t i = 0; i < playlist->items.size; ++i)
         playlist->items.data[i] = array[i]->item;
+    vlc_playlist_lookup_Invalidate(&playlist->lookup, 0);
 
     vlc_playlist_DeleteMetaArray(array, playlist->items.size);
 
@@ -360,6 +360,13 @@ struct items_removed_report
     struct playlist_state state;
 };
 
+struct items_batch_removed_report
+{
+    size_t indices[10];
+    size_t count;
+    struct playlist_state state;
+};
+
 struct playback_repeat_changed_report
 {
     enum vlc_playlist_playback_repeat repeat;
@@ -391,6 +398,8 @@ struct callback_ctx
     struct VLC_VECTOR(struct items_added_report)           vec_items_added;
     struct VLC_VECTOR(struct items_moved_report)           vec_items_moved;
     struct VLC_VECTOR(struct items_removed_report)         vec_items_removed;
+    struct VLC_VECTOR(struct items_batch_removed_report)
+                                                  vec_items_batch_removed;
     struct VLC_VECTOR(struct playback_order_changed_report)
                                                   vec_playback_order_changed;
     struct VLC_VECTOR(struct playback_repeat_changed_report)
@@ -412,6 +421,7 @@ struct callback_ctx
     VLC_VECTOR_INITIALIZER, \
     VLC_VECTOR_INITIALIZER, \
     VLC_VECTOR_INITIALIZER, \
+    VLC_VECTOR_INITIALIZER, \
 }
 
 static inline void
@@ -421,6 +431,7 @@ callback_ctx_reset(struct callback_ctx *ctx)
     vlc_vector_clear(&ctx->vec_items_added);
     vlc_vector_clear(&ctx->vec_items_moved);
     vlc_vector_clear(&ctx->vec_items_removed);
+    vlc_vector_clear(&ctx->vec_items_batch_removed);
     vlc_vector_clear(&ctx->vec_playback_repeat_changed);
     vlc_vector_clear(&ctx->vec_playback_order_changed);
     vlc_vector_clear(&ctx->vec_current_index_changed);
@@ -435,6 +446,7 @@ callback_ctx_destroy(struct callback_ctx *ctx)
     vlc_vector_destroy(&ctx->vec_items_added);
     vlc_vector_destroy(&ctx->vec_items_moved);
     vlc_vector_destroy(&ctx->vec_items_removed);
+    vlc_vector_destroy(&ctx->vec_items_batch_removed);
     vlc_vector_destroy(&ctx->vec_playback_repeat_changed);
     vlc_vector_destroy(&ctx->vec_playback_order_changed);
     vlc_vector_destroy(&ctx->vec_current_index_changed);
@@ -498,6 +510,21 @@ callback_on_items_removed(vlc_playlist_t *playlist, size_t index, size_t count,
     vlc_vector_push(&ctx->vec_items_removed, report);
 }
 
+static void
+callback_on_items_batch_removed(vlc_playlist_t *playlist,
+                                const size_t indices[], size_t count,
+                                void *userdata)
+{
+    struct callback_ctx *ctx = userdata;
+
+    struct items_batch_removed_report report;
+    assert(count <= ARRAY_SIZE(report.indices));
+    memcpy(report.indices, indices, count * sizeof(*indices));
+    report.count = count;
+    playlist_state_init(&report.state, playlist);
+    vlc_vector_push(&ctx->vec_items_batch_removed, report);
+}
+
 static void
 callback_on_playback_repeat_changed(vlc_playlist_t *playlist,
                                     enum vlc_playlist_playback_repeat repeat,
@@ -1065,6 +1092,81 @@ test_index_of(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_index_of_after_changes(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* initial playlist with 8 items */
+    int ret = vlc_playlist_Append(playlist, media, 8);
+    assert(ret == VLC_SUCCESS);
+
+    vlc_playlist_item_t *item = vlc_playlist_Get(playlist, 5);
+    uint64_t id = vlc_playlist_item_GetId(item);
+    assert(vlc_playlist_IndexOfId(playlist, id) == 5);
+
+    /* insert before the item, it is shifted */
+    ret = vlc_playlist_InsertOne(playlist, 2, media[8]);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOf(playlist, item) == 6);
+    assert(vlc_playlist_IndexOfId(playlist, id) == 6);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[5]) == 6);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[8]) == 2);
+
+    /* move it to the front */
+    vlc_playlist_Move(playlist, 6, 1, 0);
+    assert(vlc_playlist_IndexOf(playlist, item) == 0);
+    assert(vlc_playlist_IndexOfId(playlist, id) == 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 1);
+
+    /* the same media may be added several times, the first one is returned */
+    ret = vlc_playlist_AppendOne(playlist, media[8]);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[8]) == 3);
+    vlc_playlist_RemoveOne(playlist, 3);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[8]) == 8);
+
+    /* do not find removed items */
+    vlc_playlist_RemoveOne(playlist, 0);
+    assert(vlc_playlist_IndexOfId(playlist, id) == -1);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[5]) == -1);
+
+    /* fill enough items to rehash */
+    for (int i = 0; i < 100; ++i)
+    {
+        ret = vlc_playlist_InsertOne(playlist, 0, media[9]);
+        assert(ret == VLC_SUCCESS);
+    }
+    assert(vlc_playlist_Count(playlist) == 108);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[9]) == 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 100);
+    item = vlc_playlist_Get(playlist, 107);
+    assert(vlc_playlist_IndexOfId(playlist, vlc_playlist_item_GetId(item))
+            == 107);
+
+    vlc_playlist_Shuffle(playlist);
+    for (size_t i = 0; i < vlc_playlist_Count(playlist); ++i)
+    {
+        item = vlc_playlist_Get(playlist, i);
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+        assert(vlc_playlist_IndexOfId(playlist, vlc_playlist_item_GetId(item))
+                == (ssize_t) i);
+    }
+
+    vlc_playlist_item_Hold(item);
+    vlc_playlist_Clear(playlist);
+    assert(vlc_playlist_IndexOf(playlist, item) == -1);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[9]) == -1);
+    vlc_playlist_item_Release(item);
+
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_prev(void)
 {
@@ -1554,6 +1656,144 @@ test_request_remove_adapt(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_request_remove_batch(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* initial playlist with 10 items */
+    int ret = vlc_playlist_Append(playlist, media, 10);
+    assert(ret == VLC_SUCCESS);
+
+    ret = vlc_playlist_GoTo(playlist, 5);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_callbacks cbs = {
+        .on_items_removed = callback_on_items_removed,
+        .on_items_batch_removed = callback_on_items_batch_removed,
+        .on_current_index_changed = callback_on_current_index_changed,
+    };
+
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    vlc_playlist_listener_id *listener =
+            vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    assert(listener);
+
+    vlc_playlist_item_t *items_to_remove[] = {
+        vlc_playlist_Get(playlist, 8),
+        vlc_playlist_Get(playlist, 1),
+        vlc_playlist_Get(playlist, 5), /* the current one */
+        vlc_playlist_Get(playlist, 1), /* twice */
+        vlc_playlist_Get(playlist, 2),
+        vlc_playlist_Get(playlist, 6),
+    };
+
+    ret = vlc_playlist_RequestRemove(playlist, items_to_remove, 6, -1);
+    assert(ret == VLC_SUCCESS);
+
+    assert(vlc_playlist_Count(playlist) == 5);
+
+    EXPECT_AT(0, 0);
+    EXPECT_AT(1, 3);
+    EXPECT_AT(2, 4);
+    EXPECT_AT(3, 7);
+    EXPECT_AT(4, 9);
+
+    /* the non-contiguous removal is notified at once */
+    assert(ctx.vec_items_removed.size == 0);
+    assert(ctx.vec_items_batch_removed.size == 1);
+    assert(ctx.vec_items_batch_removed.data[0].count == 5);
+    assert(ctx.vec_items_batch_removed.data[0].indices[0] == 1);
+    assert(ctx.vec_items_batch_removed.data[0].indices[1] == 2);
+    assert(ctx.vec_items_batch_removed.data[0].indices[2] == 5);
+    assert(ctx.vec_items_batch_removed.data[0].indices[3] == 6);
+    assert(ctx.vec_items_batch_removed.data[0].indices[4] == 8);
+    assert(ctx.vec_items_batch_removed.data[0].state.playlist_size == 5);
+    /* the first remaining item after the current one is selected */
+    assert(ctx.vec_items_batch_removed.data[0].state.current == 3);
+
+    assert(ctx.vec_current_index_changed.size == 1);
+    assert(ctx.vec_current_index_changed.data[0].current == 3);
+
+    for (size_t i = 0; i < vlc_playlist_Count(playlist); ++i)
+    {
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, i);
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+    }
+
+    callback_ctx_destroy(&ctx);
+    vlc_playlist_RemoveListener(playlist, listener);
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
+static void
+test_request_remove_batch_random(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* initial playlist with 10 items */
+    int ret = vlc_playlist_Append(playlist, media, 10);
+    assert(ret == VLC_SUCCESS);
+
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+
+    /* play 3 items */
+    for (int i = 0; i < 3; ++i)
+    {
+        ret = vlc_playlist_Next(playlist);
+        assert(ret == VLC_SUCCESS);
+    }
+
+    vlc_playlist_item_t *items_to_remove[] = {
+        vlc_playlist_Get(playlist, 0),
+        vlc_playlist_Get(playlist, 3),
+        vlc_playlist_Get(playlist, 9),
+    };
+
+    ret = vlc_playlist_RequestRemove(playlist, items_to_remove, 3, -1);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 7);
+
+    /* rewind, then play the remaining items, each of them exactly once */
+    while (vlc_playlist_HasPrev(playlist))
+        vlc_playlist_Prev(playlist);
+
+    bool selected[10] = {0};
+    ssize_t index = vlc_playlist_GetCurrentIndex(playlist);
+    if (index == -1)
+    {
+        ret = vlc_playlist_Next(playlist);
+        assert(ret == VLC_SUCCESS);
+        index = vlc_playlist_GetCurrentIndex(playlist);
+    }
+    size_t played = 0;
+    for (;;)
+    {
+        assert(index != -1);
+        assert(!selected[index]);
+        selected[index] = true;
+        played++;
+        if (!vlc_playlist_HasNext(playlist))
+            break;
+        ret = vlc_playlist_Next(playlist);
+        assert(ret == VLC_SUCCESS);
+        index = vlc_playlist_GetCurrentIndex(playlist);
+    }
+    assert(played == 7);
+
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_request_move_with_matching_hint(void)
 {
@@ -2349,6 +2589,70 @@ test_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_sort_stable_incremental(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+    media[0]->i_duration = 30;
+    media[1]->i_duration = 10;
+    media[2]->i_duration = 20;
+    media[3]->i_duration = 10;
+    media[4]->i_duration = 30;
+    media[5]->i_duration = 10;
+    /* appended later */
+    media[6]->i_duration = 20;
+    media[7]->i_duration = 5;
+    media[8]->i_duration = 40;
+    media[9]->i_duration = 10;
+
+    int ret = vlc_playlist_Append(playlist, media, 6);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    /* equal durations keep their relative order */
+    EXPECT_AT(0, 1);
+    EXPECT_AT(1, 3);
+    EXPECT_AT(2, 5);
+    EXPECT_AT(3, 2);
+    EXPECT_AT(4, 0);
+    EXPECT_AT(5, 4);
+
+    /* the new items are merged into the sorted ones */
+    ret = vlc_playlist_Append(playlist, &media[6], 4);
+    assert(ret == VLC_SUCCESS);
+
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    EXPECT_AT(0, 7);
+    EXPECT_AT(1, 1);
+    EXPECT_AT(2, 3);
+    EXPECT_AT(3, 5);
+    EXPECT_AT(4, 9);
+    EXPECT_AT(5, 2);
+    EXPECT_AT(6, 6);
+    EXPECT_AT(7, 0);
+    EXPECT_AT(8, 4);
+    EXPECT_AT(9, 8);
+
+    for (size_t i = 0; i < 10; ++i)
+        assert(vlc_playlist_IndexOfMedia(playlist,
+                                         vlc_playlist_Get(playlist, i)->media)
+               == (ssize_t) i);
+
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 #undef EXPECT_AT
 
 int main(void)
@@ -2367,6 +2671,7 @@ int main(void)
     test_playback_order_changed_callbacks();
     test_callbacks_on_add_listener();
     test_index_of();
+    test_index_of_after_changes();
     test_prev();
     test_next();
     test_goto();
@@ -2374,6 +2679,8 @@ int main(void)
     test_request_remove_with_matching_hint();
     test_request_remove_without_hint();
     test_request_remove_adapt();
+    test_request_remove_batch();
+    test_request_remove_batch_random();
     test_request_move_with_matching_hint();
     test_request_move_without_hint();
     test_request_move_adapt();
@@ -2384,6 +2691,7 @@ int main(void)
     test_random();
     test_shuffle();
     test_sort();
+    test_sort_stable_incremental();
     return 0;
 }
 
@@ -25,18 +25,155 @@
 #include <assert.h>
 #include <sys/types.h>
 #include <sys/mman.h>
+#ifdef __linux__
+# include <limits.h>
+# include <stdatomic.h>
+# include <sys/stat.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
 #include "misc/picture.h"
+#include "libvlc.h"
+
+#ifdef __linux__
+/* Smaller buffers would not even fill one huge page */
+# define PICTURE_LARGE_SIZE (UINT32_C(2) << 20)
+
+enum
+{
+    PICTURE_HUGEPAGES_NONE,
+    PICTURE_HUGEPAGES_TRANSPARENT,
+    PICTURE_HUGEPAGES_EXPLICIT,
+};
+
+enum
+{
+    PICTURE_NUMA_DEFAULT,
+    PICTURE_NUMA_LOCAL,
+    PICTURE_NUMA_INTERLEAVE,
+};
+
+/* Memory policies, from <linux/mempolicy.h> */
+# define PICTURE_MPOL_PREFERRED  1
+# define PICTURE_MPOL_INTERLEAVE 3
+
+static atomic_uint picture_hugepages = PICTURE_HUGEPAGES_NONE;
+static atomic_uint picture_numa = PICTURE_NUMA_DEFAULT;
+
+void picture_SetupAllocator(libvlc_int_t *libvlc)
+{
+    atomic_store_explicit(&picture_hugepages,
+                          var_InheritInteger(libvlc, "picture-hugepages"),
+                          memory_order_relaxed);
+    atomic_store_explicit(&picture_numa,
+                          var_InheritInteger(libvlc, "picture-numa"),
+                          memory_order_relaxed);
+}
+
+/** Returns the size of the pages of a file, i.e. of the huge pages if any */
+static size_t GetPageSize(int fd)
+{
+    struct stat st;
+
+    if (fstat(fd, &st) || st.st_blksize <= 0)
+        return 1;
+    return st.st_blksize;
+}
+
+static void SetMemoryPolicy(void *base, size_t size, unsigned numa)
+{
+# ifdef SYS_mbind
+    unsigned long nodes = ~0UL;
+    int mode = PICTURE_MPOL_INTERLEAVE;
+
+    if (numa == PICTURE_NUMA_LOCAL)
+    {
+        unsigned cpu, node;
+
+        if (syscall(SYS_getcpu, &cpu, &node, NULL)
+         || node >= CHAR_BIT * sizeof (nodes))
+            return;
+        nodes = 1UL << node;
+        mode = PICTURE_MPOL_PREFERRED;
+    }
+
+    /* The nodes that do not exist are ignored. This must be done before the
+     * pages are touched for the first time. */
+    syscall(SYS_mbind, base, size, mode, &nodes,
+            CHAR_BIT * sizeof (nodes) + 1, 0);
+# else
+    VLC_UNUSED(base); VLC_UNUSED(size); VLC_UNUSED(numa);
+# endif
+}
+
+static void *AllocateHuge(int *restrict fdp, size_t size)
+{
+# ifdef HAVE_MEMFD_CREATE
+    int fd = memfd_create(PACKAGE_NAME"-picture", MFD_CLOEXEC | MFD_HUGETLB);
+    if (fd == -1)
+        return NULL;
+
+    /* The file size must be a multiple of the huge pages size */
+    size_t page = GetPageSize(fd);
+    size = (size + page - 1) / page * page;
+
+    /* The huge pages are reserved by mmap(), it fails if there are none */
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        vlc_close(fd);
+        return NULL;
+    }
+
+    *fdp = fd;
+    return base;
+# else
+    VLC_UNUSED(fdp); VLC_UNUSED(size);
+    return NULL;
+# endif
+}
+#endif
 
 void *picture_Allocate(int *restrict fdp, size_t size)
 {
+#ifdef __linux__
+    unsigned hugepages = PICTURE_HUGEPAGES_NONE, numa = PICTURE_NUMA_DEFAULT;
+
+    if (size >= PICTURE_LARGE_SIZE)
+    {
+        hugepages = atomic_load_explicit(&picture_hugepages,
+                                         memory_order_relaxed);
+        numa = atomic_load_explicit(&picture_numa, memory_order_relaxed);
+    }
+
+    if (hugepages == PICTURE_HUGEPAGES_EXPLICIT)
+    {
+        void *base = AllocateHuge(fdp, size);
+        if (base != NULL)
+        {
+            if (numa != PICTURE_NUMA_DEFAULT)
+                SetMemoryPolicy(base, size, numa);
+            return base;
+        }
+        /* Fall back to normal pages */
+    }
+#endif
     int fd = vlc_memfd();
     if (fd == -1)
         return NULL;
 
+#ifdef __linux__
+    /* Whole pages, so that the buffer can be imported as a dma-buf */
+    size_t page = sysconf(_SC_PAGESIZE);
+    if (ftruncate(fd, (size + page - 1) / page * page)) {
+#else
     if (ftruncate(fd, size)) {
+#endif
 error:
         vlc_close(fd);
         return NULL;
@@ -46,12 +183,27 @@ error:
     if (base == MAP_FAILED)
         goto error;
 
+#ifdef __linux__
+    /* This needs shared memory huge pages to be enabled in "advise" mode */
+    if (hugepages == PICTURE_HUGEPAGES_TRANSPARENT)
+        madvise(base, size, MADV_HUGEPAGE);
+    if (numa != PICTURE_NUMA_DEFAULT)
+        SetMemoryPolicy(base, size, numa);
+#endif
     *fdp = fd;
     return base;
 }
 
 void picture_Deallocate(int fd, void *base, size_t size)
 {
+#ifdef __linux__
+    /* Huge pages mappings must be unmapped by whole pages */
+    if (size >= PICTURE_LARGE_SIZE)
+    {
+        size_t page = GetPageSize(fd);
+        size = (size + page - 1) / page * page;
+    }
+#endif
     munmap(base, size);
     vlc_close(fd);
 }
@@ -31,6 +31,7 @@
 #include <vlc_common.h>
 
 #include "libvlc.h"
+#include "misc/thread_policy.h"
 #include <stdarg.h>
 #include <stdatomic.h>
 #include <stdnoreturn.h>
@@ -179,7 +180,9 @@ static int vlc_clone_attr (vlc_thread_t *th, pthread_attr_t *attr,
     ret = pthread_create(&th->handle, attr, entry, data);
     pthread_sigmask (SIG_SETMASK, &oldset, NULL);
     pthread_attr_destroy (attr);
-    (void) priority;
+    if (ret == 0)
+        vlc_thread_policy_ApplyPthread(th->handle,
+                                       vlc_thread_policy_Role(priority));
     return ret;
 }
 
@@ -208,7 +211,9 @@ VLC_WEAK unsigned long vlc_thread_id(void)
 
 int vlc_set_priority (vlc_thread_t th, int priority)
 {
-    (void) th; (void) priority;
+    if (vlc_thread_policy_ApplyPthread(th.handle,
+                                       vlc_thread_policy_Role(priority)))
+        return VLC_EGENERIC;
     return VLC_SUCCESS;
 }
 
@@ -0,0 +1,649 @@
+/*****************************************************************************
+ * cache.c: cache of the preparsing results of local files
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_fs.h>
+#include <vlc_meta.h>
+#include <vlc_url.h>
+
+#include "cache.h"
+#include "input/item.h"
+
+/* The cache is flushed when it reaches this number of files */
+#define PREPARSER_CACHE_MAX 65536
+
+#define PREPARSER_CACHE_FILE "preparse.cache"
+/* To be changed whenever the file format changes */
+#define PREPARSER_CACHE_MAGIC "VLCPRC01"
+
+/* Sanity limits of the loaded file */
+#define PREPARSER_CACHE_MAX_STRING 65536
+#define PREPARSER_CACHE_MAX_COUNT 1024
+
+struct input_preparser_cache_t
+{
+    vlc_object_t *owner;
+    char *dir; /**< NULL for a memory only cache */
+
+    vlc_mutex_t lock;
+    vlc_dictionary_t entries; /**< of struct cache_entry, by URI */
+    size_t count;
+    bool loaded;
+    bool dirty;
+};
+
+struct cache_entry
+{
+    int64_t mtime;
+    uint64_t size;
+    vlc_tick_t duration;
+    vlc_meta_t *meta;
+    es_format_t *es;
+    size_t es_count;
+};
+
+static void CacheEntryDelete( void *data, void *obj )
+{
+    struct cache_entry *entry = data;
+    VLC_UNUSED( obj );
+
+    for( size_t i = 0; i < entry->es_count; i++ )
+        es_format_Clean( &entry->es[i] );
+    free( entry->es );
+    vlc_meta_Delete( entry->meta );
+    free( entry );
+}
+
+/* Deep copy of a cache entry */
+static int CacheEntryCopy( struct cache_entry *dst,
+                           const struct cache_entry *src )
+{
+    dst->mtime = src->mtime;
+    dst->size = src->size;
+    dst->duration = src->duration;
+    dst->es_count = 0;
+    dst->meta = vlc_meta_New();
+    dst->es = src->es_count ? vlc_alloc( src->es_count, sizeof( *dst->es ) )
+                            : NULL;
+    if( unlikely( dst->meta == NULL || ( src->es_count && dst->es == NULL ) ) )
+    {
+        if( dst->meta != NULL )
+            vlc_meta_Delete( dst->meta );
+        free( dst->es );
+        return VLC_ENOMEM;
+    }
+
+    vlc_meta_Merge( dst->meta, src->meta );
+    for( size_t i = 0; i < src->es_count; i++ )
+        if( es_format_Copy( &dst->es[dst->es_count], &src->es[i] ) == VLC_SUCCESS )
+            dst->es_count++;
+    return VLC_SUCCESS;
+}
+
+/* Must be called with the lock held */
+static void CacheInsert( input_preparser_cache_t *cache, const char *uri,
+                         struct cache_entry *entry )
+{
+    if( vlc_dictionary_has_key( &cache->entries, uri ) )
+    {
+        vlc_dictionary_remove_value_for_key( &cache->entries, uri,
+                                             CacheEntryDelete, NULL );
+        cache->count--;
+    }
+
+    if( cache->count >= PREPARSER_CACHE_MAX )
+    {
+        vlc_dictionary_clear( &cache->entries, CacheEntryDelete, NULL );
+        cache->count = 0;
+    }
+
+    vlc_dictionary_insert( &cache->entries, uri, entry );
+    cache->count++;
+}
+
+/*
+ * Cache file
+ *
+ * The file starts with PREPARSER_CACHE_MAGIC and the number of meta types,
+ * followed by one record per file. All the integers are little-endian, and
+ * the strings are prefixed by their length (UINT32_MAX for NULL).
+ */
+
+static bool WriteU32( FILE *file, uint32_t value )
+{
+    uint8_t buf[4];
+    SetDWLE( buf, value );
+    return fwrite( buf, sizeof( buf ), 1, file ) == 1;
+}
+
+static bool WriteU64( FILE *file, uint64_t value )
+{
+    uint8_t buf[8];
+    SetQWLE( buf, value );
+    return fwrite( buf, sizeof( buf ), 1, file ) == 1;
+}
+
+static bool WriteString( FILE *file, const char *str )
+{
+    if( str == NULL )
+        return WriteU32( file, UINT32_MAX );
+
+    size_t len = strlen( str );
+    return len < PREPARSER_CACHE_MAX_STRING && WriteU32( file, len )
+        && fwrite( str, 1, len, file ) == len;
+}
+
+static bool ReadU32( FILE *file, uint32_t *value )
+{
+    uint8_t buf[4];
+    if( fread( buf, sizeof( buf ), 1, file ) != 1 )
+        return false;
+    *value = GetDWLE( buf );
+    return true;
+}
+
+static bool ReadU64( FILE *file, uint64_t *value )
+{
+    uint8_t buf[8];
+    if( fread( buf, sizeof( buf ), 1, file ) != 1 )
+        return false;
+    *value = GetQWLE( buf );
+    return true;
+}
+
+static bool ReadString( FILE *file, char **str )
+{
+    uint32_t len;
+    if( !ReadU32( file, &len ) )
+        return false;
+
+    *str = NULL;
+    if( len == UINT32_MAX )
+        return true;
+    if( len >= PREPARSER_CACHE_MAX_STRING )
+        return false;
+
+    char *buf = malloc( len + 1 );
+    if( unlikely( buf == NULL ) )
+        return false;
+    if( fread( buf, 1, len, file ) != len )
+    {
+        free( buf );
+        return false;
+    }
+    buf[len] = '\0';
+    *str = buf;
+    return true;
+}
+
+static bool WriteEs( FILE *file, const es_format_t *es )
+{
+    if( !WriteU32( file, es->i_cat ) || !WriteU32( file, es->i_codec ) ||
+        !WriteU32( file, es->i_original_fourcc ) ||
+        !WriteU32( file, es->i_id ) || !WriteU32( file, es->i_group ) ||
+        !WriteU32( file, es->i_priority ) || !WriteU32( file, es->i_bitrate ) ||
+        !WriteString( file, es->psz_language ) ||
+        !WriteString( file, es->psz_description ) )
+        return false;
+
+    switch( es->i_cat )
+    {
+        case AUDIO_ES:
+            return WriteU32( file, es->audio.i_channels )
+                && WriteU32( file, es->audio.i_rate )
+                && WriteU32( file, es->audio.i_bitspersample )
+                && WriteU32( file, es->audio.i_physical_channels );
+        case VIDEO_ES:
+            return WriteU32( file, es->video.i_width )
+                && WriteU32( file, es->video.i_height )
+                && WriteU32( file, es->video.i_visible_width )
+                && WriteU32( file, es->video.i_visible_height )
+                && WriteU32( file, es->video.i_sar_num )
+                && WriteU32( file, es->video.i_sar_den )
+                && WriteU32( file, es->video.i_frame_rate )
+                && WriteU32( file, es->video.i_frame_rate_base )
+                && WriteU32( file, es->video.orientation );
+        default:
+            return true;
+    }
+}
+
+static bool ReadEs( FILE *file, es_format_t *es )
+{
+    uint32_t cat, codec, original_fourcc, id, group, priority, bitrate;
+    if( !ReadU32( file, &cat ) || !ReadU32( file, &codec ) ||
+        !ReadU32( file, &original_fourcc ) || !ReadU32( file, &id ) ||
+        !ReadU32( file, &group ) || !ReadU32( file, &priority ) ||
+        !ReadU32( file, &bitrate ) || cat >= ES_CATEGORY_COUNT )
+        return false;
+
+    es_format_Init( es, cat, codec );
+    es->i_original_fourcc = original_fourcc;
+    es->i_id = id;
+    es->i_group = group;
+    es->i_priority = priority;
+    es->i_bitrate = bitrate;
+
+    if( !ReadString( file, &es->psz_language ) ||
+        !ReadString( file, &es->psz_description ) )
+        goto error;
+
+    uint32_t v[9];
+    switch( cat )
+    {
+        case AUDIO_ES:
+            for( size_t i = 0; i < 4; i++ )
+                if( !ReadU32( file, &v[i] ) )
+                    goto error;
+            es->audio.i_channels = v[0];
+            es->audio.i_rate = v[1];
+            es->audio.i_bitspersample = v[2];
+            es->audio.i_physical_channels = v[3];
+            break;
+        case VIDEO_ES:
+            for( size_t i = 0; i < 9; i++ )
+                if( !ReadU32( file, &v[i] ) )
+                    goto error;
+            es->video.i_width = v[0];
+            es->video.i_height = v[1];
+            es->video.i_visible_width = v[2];
+            es->video.i_visible_height = v[3];
+            es->video.i_sar_num = v[4];
+            es->video.i_sar_den = v[5];
+            es->video.i_frame_rate = v[6];
+            es->video.i_frame_rate_base = v[7];
+            if( v[8] > ORIENT_MAX )
+                goto error;
+            es->video.orientation = v[8];
+            break;
+        default:
+            break;
+    }
+    return true;
+
+error:
+    es_format_Clean( es );
+    return false;
+}
+
+static bool WriteEntry( FILE *file, const char *uri,
+                        const struct cache_entry *entry )
+{
+    if( !WriteString( file, uri ) || !WriteU64( file, entry->mtime ) ||
+        !WriteU64( file, entry->size ) || !WriteU64( file, entry->duration ) )
+        return false;
+
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+        if( !WriteString( file, vlc_meta_Get( entry->meta, i ) ) )
+            return false;
+
+    char **names = vlc_meta_CopyExtraNames( entry->meta );
+    size_t count = 0;
+    while( names != NULL && names[count] != NULL )
+        count++;
+
+    bool ok = count <= PREPARSER_CACHE_MAX_COUNT && WriteU32( file, count );
+    for( size_t i = 0; i < count; i++ )
+    {
+        ok = ok && WriteString( file, names[i] )
+                && WriteString( file, vlc_meta_GetExtra( entry->meta,
+                                                         names[i] ) );
+        free( names[i] );
+    }
+    free( names );
+    if( !ok )
+        return false;
+
+    if( entry->es_count > PREPARSER_CACHE_MAX_COUNT ||
+        !WriteU32( file, entry->es_count ) )
+        return false;
+    for( size_t i = 0; i < entry->es_count; i++ )
+        if( !WriteEs( file, &entry->es[i] ) )
+            return false;
+    return true;
+}
+
+static struct cache_entry *ReadEntry( FILE *file, char **uri )
+{
+    struct cache_entry *entry = malloc( sizeof( *entry ) );
+    if( unlikely( entry == NULL ) )
+        return NULL;
+
+    entry->meta = vlc_meta_New();
+    entry->es = NULL;
+    entry->es_count = 0;
+    *uri = NULL;
+    if( unlikely( entry->meta == NULL ) )
+    {
+        free( entry );
+        return NULL;
+    }
+
+    uint64_t mtime, size, duration;
+    if( !ReadString( file, uri ) || *uri == NULL ||
+        !ReadU64( file, &mtime ) || !ReadU64( file, &size ) ||
+        !ReadU64( file, &duration ) )
+        goto error;
+    entry->mtime = mtime;
+    entry->size = size;
+    entry->duration = duration;
+
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        char *value;
+        if( !ReadString( file, &value ) )
+            goto error;
+        if( value != NULL )
+        {
+            vlc_meta_Set( entry->meta, i, value );
+            free( value );
+        }
+    }
+
+    uint32_t count;
+    if( !ReadU32( file, &count ) || count > PREPARSER_CACHE_MAX_COUNT )
+        goto error;
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        char *name, *value;
+        if( !ReadString( file, &name ) )
+            goto error;
+        if( !ReadString( file, &value ) )
+        {
+            free( name );
+            goto error;
+        }
+        if( name != NULL )
+            vlc_meta_AddExtra( entry->meta, name, value );
+        free( name );
+        free( value );
+    }
+
+    if( !ReadU32( file, &count ) || count > PREPARSER_CACHE_MAX_COUNT )
+        goto error;
+    if( count > 0 )
+    {
+        entry->es = vlc_alloc( count, sizeof( *entry->es ) );
+        if( unlikely( entry->es == NULL ) )
+            goto error;
+        for( ; entry->es_count < count; entry->es_count++ )
+            if( !ReadEs( file, &entry->es[entry->es_count] ) )
+                goto error;
+    }
+    return entry;
+
+error:
+    free( *uri );
+    *uri = NULL;
+    CacheEntryDelete( entry, NULL );
+    return NULL;
+}
+
+static char *CacheFilePath( input_preparser_cache_t *cache )
+{
+    char *path;
+    if( asprintf( &path, "%s" DIR_SEP PREPARSER_CACHE_FILE, cache->dir ) < 0 )
+        return NULL;
+    return path;
+}
+
+/* Must be called with the lock held */
+static void CacheLoad( input_preparser_cache_t *cache )
+{
+    cache->loaded = true;
+    if( cache->dir == NULL )
+        return;
+
+    char *path = CacheFilePath( cache );
+    if( path == NULL )
+        return;
+
+    FILE *file = vlc_fopen( path, "rb" );
+    if( file == NULL )
+    {
+        free( path );
+        return;
+    }
+
+    char magic[sizeof( PREPARSER_CACHE_MAGIC ) - 1];
+    uint32_t meta_count;
+    if( fread( magic, sizeof( magic ), 1, file ) != 1 ||
+        memcmp( magic, PREPARSER_CACHE_MAGIC, sizeof( magic ) ) ||
+        !ReadU32( file, &meta_count ) || meta_count != VLC_META_TYPE_COUNT )
+    {
+        msg_Warn( cache->owner, "ignoring incompatible cache %s", path );
+        goto end;
+    }
+
+    /* Keep all the valid records, up to the first truncated one */
+    char *uri;
+    struct cache_entry *entry;
+    while( ( entry = ReadEntry( file, &uri ) ) != NULL )
+    {
+        CacheInsert( cache, uri, entry );
+        free( uri );
+    }
+    msg_Dbg( cache->owner, "loaded %zu preparsed files from %s",
+             cache->count, path );
+
+end:
+    fclose( file );
+    free( path );
+}
+
+static void CacheSave( input_preparser_cache_t *cache )
+{
+    char *path = CacheFilePath( cache );
+    char *tmp;
+    if( path == NULL )
+        return;
+    if( asprintf( &tmp, "%s.tmp", path ) < 0 )
+    {
+        free( path );
+        return;
+    }
+
+    vlc_mkdir( cache->dir, 0700 );
+
+    FILE *file = vlc_fopen( tmp, "wb" );
+    if( file == NULL )
+    {
+        msg_Warn( cache->owner, "cannot create %s: %s", tmp,
+                  vlc_strerror_c( errno ) );
+        goto end;
+    }
+
+    bool ok = fwrite( PREPARSER_CACHE_MAGIC,
+                      sizeof( PREPARSER_CACHE_MAGIC ) - 1, 1, file ) == 1
+           && WriteU32( file, VLC_META_TYPE_COUNT );
+
+    char **uris = vlc_dictionary_all_keys( &cache->entries );
+    for( size_t i = 0; uris != NULL && uris[i] != NULL; i++ )
+    {
+        const struct cache_entry *entry =
+            vlc_dictionary_value_for_key( &cache->entries, uris[i] );
+        ok = ok && WriteEntry( file, uris[i], entry );
+        free( uris[i] );
+    }
+    free( uris );
+
+    /* Replace the previous cache atomically */
+    if( fclose( file ) == 0 && ok )
+        vlc_rename( tmp, path );
+    else
+    {
+        msg_Warn( cache->owner, "cannot write %s", tmp );
+        vlc_unlink( tmp );
+    }
+
+end:
+    free( tmp );
+    free( path );
+}
+
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t *owner,
+                                                    const char *dir )
+{
+    input_preparser_cache_t *cache = malloc( sizeof( *cache ) );
+    if( unlikely( cache == NULL ) )
+        return NULL;
+
+    cache->dir = dir ? strdup( dir ) : NULL;
+    if( dir && unlikely( cache->dir == NULL ) )
+    {
+        free( cache );
+        return NULL;
+    }
+
+    cache->owner = owner;
+    vlc_mutex_init( &cache->lock );
+    vlc_dictionary_init( &cache->entries, 0 );
+    cache->count = 0;
+    cache->loaded = false;
+    cache->dirty = false;
+    return cache;
+}
+
+void input_preparser_cache_Delete( input_preparser_cache_t *cache )
+{
+    if( cache->dirty && cache->dir != NULL )
+        CacheSave( cache );
+
+    vlc_dictionary_clear( &cache->entries, CacheEntryDelete, NULL );
+    free( cache->dir );
+    free( cache );
+}
+
+/* The art cache files may have been removed since the item was stored */
+static void CheckArtURL( vlc_meta_t *meta )
+{
+    const char *art = vlc_meta_Get( meta, vlc_meta_ArtworkURL );
+    if( art == NULL || strncasecmp( art, "file://", 7 ) )
+        return;
+
+    char *path = vlc_uri2path( art );
+    struct stat st;
+    if( path == NULL || vlc_stat( path, &st ) )
+        vlc_meta_Set( meta, vlc_meta_ArtworkURL, NULL );
+    free( path );
+}
+
+bool input_preparser_cache_Restore( input_preparser_cache_t *cache,
+                                    const struct input_preparser_probe *probe,
+                                    input_item_t *item )
+{
+    struct cache_entry copy;
+
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->loaded )
+        CacheLoad( cache );
+    const struct cache_entry *entry =
+        vlc_dictionary_value_for_key( &cache->entries, probe->uri );
+    bool found = entry != NULL && entry->mtime == probe->mtime &&
+                 entry->size == probe->size &&
+                 CacheEntryCopy( &copy, entry ) == VLC_SUCCESS;
+    vlc_mutex_unlock( &cache->lock );
+
+    if( !found )
+        return false;
+
+    CheckArtURL( copy.meta );
+
+    /* Apply the results outside of the cache lock, the item may send
+     * events */
+    input_item_SetDuration( item, copy.duration );
+    for( size_t i = 0; i < copy.es_count; i++ )
+    {
+        input_item_UpdateTracksInfo( item, &copy.es[i] );
+        es_format_Clean( &copy.es[i] );
+    }
+    free( copy.es );
+
+    vlc_mutex_lock( &item->lock );
+    vlc_meta_Merge( item->p_meta, copy.meta );
+    vlc_mutex_unlock( &item->lock );
+    vlc_meta_Delete( copy.meta );
+    return true;
+}
+
+void input_preparser_cache_Store( input_preparser_cache_t *cache,
+                                  const struct input_preparser_probe *probe,
+                                  input_item_t *item )
+{
+    struct cache_entry *entry = malloc( sizeof( *entry ) );
+    if( unlikely( entry == NULL ) )
+        return;
+
+    vlc_mutex_lock( &item->lock );
+    struct cache_entry src = {
+        .mtime = probe->mtime,
+        .size = probe->size,
+        .duration = item->i_duration,
+        .meta = item->p_meta,
+        .es = NULL,
+        .es_count = 0,
+    };
+    es_format_t *es = item->i_es > 0 ? vlc_alloc( item->i_es, sizeof( *es ) )
+                                     : NULL;
+    if( es != NULL )
+    {
+        for( int i = 0; i < item->i_es; i++ )
+            es[i] = *item->es[i];
+        src.es = es;
+        src.es_count = item->i_es;
+    }
+    int ret = CacheEntryCopy( entry, &src );
+    vlc_mutex_unlock( &item->lock );
+    free( es );
+
+    if( ret != VLC_SUCCESS )
+    {
+        free( entry );
+        return;
+    }
+
+    /* The codec private data is not needed to describe the tracks */
+    for( size_t i = 0; i < entry->es_count; i++ )
+    {
+        free( entry->es[i].p_extra );
+        entry->es[i].p_extra = NULL;
+        entry->es[i].i_extra = 0;
+    }
+
+    /* Attachments only live as long as the input */
+    const char *art = vlc_meta_Get( entry->meta, vlc_meta_ArtworkURL );
+    if( art != NULL && !strncasecmp( art, "attachment://", 13 ) )
+        vlc_meta_Set( entry->meta, vlc_meta_ArtworkURL, NULL );
+
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->loaded )
+        CacheLoad( cache );
+    CacheInsert( cache, probe->uri, entry );
+    cache->dirty = true;
+    vlc_mutex_unlock( &cache->lock );
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * cache.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+#include "probe.h"
+
+/**
+ * Cache of the preparsing results of local files.
+ *
+ * The results are keyed by the file URI, and are only valid as long as the
+ * file modification time and size are unchanged. If a cache directory is
+ * given, the cache is loaded from it on first use, and saved back when
+ * deleted, so that the results are kept across sessions.
+ */
+typedef struct input_preparser_cache_t input_preparser_cache_t;
+
+/**
+ * Create a cache.
+ *
+ * \param dir directory of the cache file, or NULL for a memory only cache
+ */
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t *,
+                                                    const char *dir );
+
+/**
+ * Save the cache if it was modified, and delete it.
+ */
+void input_preparser_cache_Delete( input_preparser_cache_t * );
+
+/**
+ * Restore the cached duration, tracks and meta of a file to an item.
+ *
+ * \return true if the file was in the cache and unchanged
+ */
+bool input_preparser_cache_Restore( input_preparser_cache_t *,
+                                    const struct input_preparser_probe *,
+                                    input_item_t * );
+
+/**
+ * Store the duration, tracks and meta of a preparsed item.
+ */
+void input_preparser_cache_Store( input_preparser_cache_t *,
+                                  const struct input_preparser_probe *,
+                                  input_item_t * );
+
+#endif
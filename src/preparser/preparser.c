@@ -24,17 +24,22 @@
 
 #include <vlc_common.h>
 #include <vlc_atomic.h>
+#include <vlc_configuration.h>
 #include <vlc_executor.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
+#include "input/item.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "probe.h"
+#include "cache.h"
 
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
+    input_preparser_cache_t *cache;
     vlc_executor_t *executor;
     vlc_tick_t default_timeout;
     atomic_bool deactivated;
@@ -54,6 +59,11 @@ struct task
     vlc_tick_t timeout;
 
     input_item_parser_id_t *parser;
+    bool subtree_added;
+
+    struct input_preparser_probe probe;
+    bool probed; /**< the item is a local file, see probe */
+    bool cacheable; /**< the results may be stored in the cache */
 
     vlc_sem_t preparse_ended;
     vlc_sem_t fetch_ended;
@@ -90,6 +100,9 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     input_item_Hold(item);
 
     task->parser = NULL;
+    task->subtree_added = false;
+    task->probed = false;
+    task->cacheable = false;
     vlc_sem_init(&task->preparse_ended, 0);
     vlc_sem_init(&task->fetch_ended, 0);
     atomic_init(&task->preparse_status, ITEM_PREPARSE_SKIPPED);
@@ -104,6 +117,8 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
 static void
 TaskDelete(struct task *task)
 {
+    if (task->probed)
+        input_preparser_probe_Clean(&task->probe);
     input_item_Release(task->item);
     free(task);
 }
@@ -161,6 +176,7 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    task->subtree_added = true;
     if (task->cbs && task->cbs->on_subtree_added)
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
@@ -188,8 +204,31 @@ Parse(struct task *task, vlc_tick_t deadline)
         .on_subtree_added = OnParserSubtreeAdded,
     };
 
-    vlc_object_t *obj = task->preparser->owner;
-    task->parser = input_item_Parse(task->item, obj, &cbs, task);
+    input_preparser_t *preparser = task->preparser;
+    vlc_object_t *obj = preparser->owner;
+
+    /* Local files are identified first: unchanged files are not parsed
+     * again, and the others are opened directly with the right demuxer */
+    task->probed = preparser->cache
+        && input_preparser_probe_Init(&task->probe, task->item) == VLC_SUCCESS;
+    if (task->probed)
+    {
+        if (input_preparser_cache_Restore(preparser->cache, &task->probe,
+                                          task->item))
+        {
+            atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                                  memory_order_relaxed);
+            /* Only store it again if the fetcher may complete it */
+            task->cacheable = task->options & META_REQUEST_OPTION_FETCH_ANY;
+            return;
+        }
+        input_preparser_probe_Detect(&task->probe);
+    }
+
+    task->parser = input_item_ParseDemux(task->item, obj,
+                                         task->probed ? task->probe.demux
+                                                      : NULL,
+                                         &cbs, task);
     if (!task->parser)
     {
         atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_FAILED,
@@ -210,6 +249,12 @@ Parse(struct task *task, vlc_tick_t deadline)
 
     /* This call also interrupts the parsing if it is still running */
     input_item_parser_id_Release(task->parser);
+
+    /* Playlists are not cached, their subitems must be sent */
+    task->cacheable = task->probed && !task->subtree_added
+        && !atomic_load(&task->interrupted)
+        && atomic_load_explicit(&task->preparse_status,
+                                memory_order_relaxed) == ITEM_PREPARSE_DONE;
 }
 
 static void
@@ -251,6 +296,12 @@ RunnableRun(void *userdata)
     if (atomic_load(&task->interrupted))
         goto end;
 
+    /* Stored after fetching, so that the fetched meta and art are found
+     * without any network access next time */
+    if (task->cacheable)
+        input_preparser_cache_Store(task->preparser->cache, &task->probe,
+                                    task->item);
+
     input_item_SetPreparsed(task->item, true);
 
 end:
@@ -281,7 +332,9 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (max_threads < 1)
         max_threads = 1;
 
-    preparser->executor = vlc_executor_New(max_threads);
+    /* Libraries are preparsed in bursts of many items */
+    preparser->executor = vlc_executor_NewExt(max_threads,
+                                              VLC_EXECUTOR_WORK_STEALING);
     if (!preparser->executor)
     {
         free(preparser);
@@ -295,6 +348,11 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
 
     preparser->owner = parent;
     preparser->fetcher = input_fetcher_New( parent );
+    /* Not fatal, the files are then always parsed */
+    char *cache_dir = var_InheritBool( parent, "preparse-cache" )
+                    ? config_GetUserDir( VLC_CACHE_DIR ) : NULL;
+    preparser->cache = input_preparser_cache_New( parent, cache_dir );
+    free( cache_dir );
     atomic_init( &preparser->deactivated, false );
 
     vlc_mutex_init(&preparser->lock);
@@ -345,7 +403,11 @@ int input_preparser_Push( input_preparser_t *preparser,
 
     PreparserAddTask(preparser, task);
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    /* Requests on behalf of the user go before the background ones */
+    vlc_executor_SubmitPriority(preparser->executor, &task->runnable,
+                                (i_options & META_REQUEST_OPTION_DO_INTERACT)
+                                ? VLC_EXECUTOR_PRIORITY_HIGH
+                                : VLC_EXECUTOR_PRIORITY_NORMAL);
     return VLC_SUCCESS;
 }
 
@@ -384,6 +446,31 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
     vlc_mutex_unlock(&preparser->lock);
 }
 
+bool input_preparser_CacheRestore( input_preparser_t *preparser,
+                                   input_item_t *item )
+{
+    struct input_preparser_probe probe;
+    if( !preparser->cache
+     || input_preparser_probe_Init( &probe, item ) != VLC_SUCCESS )
+        return false;
+
+    bool found = input_preparser_cache_Restore( preparser->cache, &probe, item );
+    input_preparser_probe_Clean( &probe );
+    return found;
+}
+
+void input_preparser_CacheStore( input_preparser_t *preparser,
+                                 input_item_t *item )
+{
+    struct input_preparser_probe probe;
+    if( !preparser->cache
+     || input_preparser_probe_Init( &probe, item ) != VLC_SUCCESS )
+        return;
+
+    input_preparser_cache_Store( preparser->cache, &probe, item );
+    input_preparser_probe_Clean( &probe );
+}
+
 void input_preparser_Deactivate( input_preparser_t* preparser )
 {
     atomic_store( &preparser->deactivated, true );
@@ -400,5 +487,8 @@ void input_preparser_Delete( input_preparser_t *preparser )
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
 
+    if( preparser->cache )
+        input_preparser_cache_Delete( preparser->cache );
+
     free( preparser );
 }
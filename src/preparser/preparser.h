@@ -72,6 +72,21 @@ void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
  */
 void input_preparser_Cancel( input_preparser_t *, void *id );
 
+/**
+ * Restore the cached preparsing results of a local file.
+ *
+ * The results are only restored if the file did not change since they were
+ * stored.
+ *
+ * @return true if the item has been filled from the cache
+ */
+bool input_preparser_CacheRestore( input_preparser_t *, input_item_t * );
+
+/**
+ * Store the results of a local file parsed outside of the preparser.
+ */
+void input_preparser_CacheStore( input_preparser_t *, input_item_t * );
+
 /**
  * This function destroys the preparser object and thread.
  *
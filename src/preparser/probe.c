@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * probe.c: fast container detection of local files
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+#include "probe.h"
+
+/* Enough to see two MPEG-TS packets */
+#define PROBE_SIZE 512
+
+static bool ExtensionIs( const char *ext, const char *const list[] )
+{
+    if( ext == NULL )
+        return false;
+    for( size_t i = 0; list[i] != NULL; i++ )
+        if( !strcasecmp( ext, list[i] ) )
+            return true;
+    return false;
+}
+
+static const char *ProbeDemux( const uint8_t *p, size_t len, const char *ext )
+{
+    static const char *const mpga_exts[] = { "mp3", "mpga", "mp2", NULL };
+    static const char *const flac_exts[] = { "flac", NULL };
+
+    if( len >= 12 && !memcmp( &p[4], "ftyp", 4 ) )
+    {
+        /* HEIF images are handled by another (mp4) submodule */
+        if( !memcmp( &p[8], "heic", 4 ) || !memcmp( &p[8], "heix", 4 ) ||
+            !memcmp( &p[8], "mif1", 4 ) || !memcmp( &p[8], "avif", 4 ) )
+            return NULL;
+        return "mp4,any";
+    }
+    if( len >= 8 && ( !memcmp( &p[4], "moov", 4 ) ||
+                      !memcmp( &p[4], "mdat", 4 ) ||
+                      !memcmp( &p[4], "wide", 4 ) ) )
+        return "mp4,any";
+    if( len >= 4 && !memcmp( p, "\x1A\x45\xDF\xA3", 4 ) )
+        return "mkv,any";
+    if( len >= 4 && !memcmp( p, "OggS", 4 ) )
+        return "ogg,any";
+    if( len >= 12 && !memcmp( p, "RIFF", 4 ) )
+    {
+        if( !memcmp( &p[8], "AVI ", 4 ) )
+            return "avi,any";
+        if( !memcmp( &p[8], "WAVE", 4 ) )
+            return "wav,any";
+        return NULL;
+    }
+    if( len >= 4 && !memcmp( p, "fLaC", 4 ) )
+        return "flac,any";
+    if( len >= 8 && !memcmp( p, "\x30\x26\xB2\x75\x8E\x66\xCF\x11", 8 ) )
+        return "asf,any";
+    if( len >= 4 && !memcmp( p, "\x00\x00\x01\xBA", 4 ) )
+        return "ps,any";
+    if( len >= 377 && p[0] == 0x47 && p[188] == 0x47 && p[376] == 0x47 )
+        return "ts,any";
+
+    /* Audio elementary streams have no real signature, rely on the extension
+     * too */
+    if( len >= 3 && !memcmp( p, "ID3", 3 ) )
+    {
+        if( ExtensionIs( ext, flac_exts ) )
+            return "flac,any";
+        if( ExtensionIs( ext, mpga_exts ) )
+            return "es,any";
+        return NULL;
+    }
+    if( len >= 2 && p[0] == 0xFF && ( p[1] & 0xE0 ) == 0xE0 &&
+        ExtensionIs( ext, mpga_exts ) )
+        return "es,any";
+
+    return NULL;
+}
+
+int input_preparser_probe_Init( struct input_preparser_probe *probe,
+                                input_item_t *item )
+{
+    char *uri = NULL, *path = NULL;
+
+    vlc_mutex_lock( &item->lock );
+    if( item->i_type == ITEM_TYPE_FILE && !item->b_net &&
+        item->i_options == 0 && item->psz_uri != NULL )
+        uri = strdup( item->psz_uri );
+    vlc_mutex_unlock( &item->lock );
+
+    if( uri == NULL )
+        return VLC_EGENERIC;
+
+    path = vlc_uri2path( uri );
+    if( path == NULL )
+        goto error;
+
+    struct stat st;
+    if( vlc_stat( path, &st ) || !S_ISREG( st.st_mode ) )
+        goto error;
+
+    probe->uri = uri;
+    probe->path = path;
+    probe->mtime = st.st_mtime;
+    probe->size = st.st_size;
+    probe->demux = NULL;
+    return VLC_SUCCESS;
+
+error:
+    free( path );
+    free( uri );
+    return VLC_EGENERIC;
+}
+
+void input_preparser_probe_Detect( struct input_preparser_probe *probe )
+{
+    int fd = vlc_open( probe->path, O_RDONLY | O_NONBLOCK );
+    if( fd == -1 )
+        return;
+
+    uint8_t buf[PROBE_SIZE];
+    ssize_t len = read( fd, buf, sizeof( buf ) );
+    vlc_close( fd );
+
+    if( len <= 0 )
+        return;
+
+    const char *filename = strrchr( probe->path, DIR_SEP_CHAR );
+    const char *ext = strrchr( filename ? filename : probe->path, '.' );
+
+    probe->demux = ProbeDemux( buf, len, ext ? ext + 1 : NULL );
+}
+
+void input_preparser_probe_Clean( struct input_preparser_probe *probe )
+{
+    free( probe->path );
+    free( probe->uri );
+}
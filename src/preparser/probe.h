@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * probe.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_PROBE_H
+#define _INPUT_PREPARSER_PROBE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Local file to preparse
+ */
+struct input_preparser_probe
+{
+    char *uri;
+    char *path;
+    int64_t mtime;
+    uint64_t size;
+    /**
+     * Demux module list to use, "<module>,any", or NULL if the container
+     * was not recognized
+     */
+    const char *demux;
+};
+
+/**
+ * Identify a local file.
+ *
+ * Only regular local files, without input options, can be probed.
+ *
+ * \return VLC_SUCCESS if the item is a local file, the probe must then be
+ *         cleaned with input_preparser_probe_Clean()
+ */
+int input_preparser_probe_Init( struct input_preparser_probe *,
+                                input_item_t * );
+
+/**
+ * Guess the container of a probed file.
+ *
+ * The container is detected from the first bytes of the file (read once) and
+ * its extension. The result is stored in the demux field.
+ */
+void input_preparser_probe_Detect( struct input_preparser_probe * );
+
+void input_preparser_probe_Clean( struct input_preparser_probe * );
+
+#endif
@@ -86,11 +86,112 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_pool (void)
+{
+    block_pool_t *pool = block_pool_New ();
+    struct block_pool_stats stats;
+    assert (pool != NULL);
+
+    block_t *block = block_pool_Alloc (pool, 188);
+    assert (block != NULL);
+    assert (block->i_buffer == 188);
+    assert (((uintptr_t)block->p_buffer % 32) == 0);
+    memset (block->p_buffer, 0x47, block->i_buffer);
+    block_Release (block);
+
+    /* Same size class: recycled */
+    block = block_pool_Alloc (pool, 100);
+    assert (block != NULL);
+    assert (block->i_buffer == 100);
+    assert (block->i_pts == VLC_TICK_INVALID && block->i_flags == 0);
+
+    /* Growing within the spare room must not reallocate */
+    block = block_Realloc (block, 0, 200);
+    assert (block != NULL);
+    assert (block->i_buffer == 200);
+
+    block_pool_GetStats (pool, &stats);
+    assert (stats.hits == 1 && stats.misses == 1 && stats.oversized == 0);
+
+    block_t *big = block_pool_Alloc (pool, 1 << 20);
+    assert (big != NULL);
+    assert (big->i_buffer == 1 << 20);
+    block_Release (big);
+
+    block_pool_GetStats (pool, &stats);
+    assert (stats.oversized == 1);
+
+    /* Blocks can outlive their pool */
+    block_pool_Release (pool);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block_Release (block);
+}
+
+static void test_block_View (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TICK_0;
+
+    /* Plain blocks cannot be viewed */
+    assert (block_View (block, 0, 4) == NULL);
+
+    block = block_Shareable (block);
+    assert (block != NULL);
+    assert (block->i_buffer == sizeof (text));
+    assert (block->i_pts == VLC_TICK_0);
+    assert (block_Shareable (block) == block);
+
+    block_t *a = block_View (block, 0, 5);
+    block_t *b = block_View (block, 5, 3);
+    block_t *c = block_View (b, 1, 2);
+    assert (a != NULL && b != NULL && c != NULL);
+    assert (a->p_buffer == block->p_buffer && a->i_buffer == 5);
+    assert (b->p_buffer == block->p_buffer + 5);
+    assert (c->p_buffer == block->p_buffer + 6 && c->i_buffer == 2);
+    assert (a->i_pts == VLC_TICK_INVALID);
+
+    /* Views outlive the viewed block */
+    block_Release (block);
+    assert (!memcmp (a->p_buffer, "This ", 5));
+    block_Release (c);
+
+    /* Contiguous views are joined without copying */
+    block_t *chain = NULL;
+    block_ChainAppend (&chain, a);
+    block_ChainAppend (&chain, b);
+    block_t *joined = block_ViewJoin (chain);
+    assert (joined != NULL);
+    assert (joined->p_buffer == a->p_buffer && joined->i_buffer == 8);
+    block_Release (joined);
+
+    chain = block_ChainGather (chain);
+    assert (chain != NULL && chain->p_next == NULL);
+    assert (!memcmp (chain->p_buffer, "This is ", 8));
+
+    /* Growing a view copies */
+    chain = block_Realloc (chain, 0, 16);
+    assert (chain != NULL);
+    assert (!memcmp (chain->p_buffer, "This is ", 8));
+
+    /* Non contiguous views are not */
+    block = block_Shareable (chain);
+    a = block_View (block, 0, 2);
+    b = block_View (block, 3, 2);
+    a->p_next = b;
+    assert (block_ViewJoin (a) == NULL);
+    block_ChainRelease (a);
+    block_Release (block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_pool ();
+    test_block_View ();
     return 0;
 }
 
@@ -66,9 +66,9 @@ static void RunIncrement(void *userdata)
     vlc_cond_signal(&data->cond);
 }
 
-static void test_single_runnable(void)
+static void test_single_runnable(unsigned flags)
 {
-    vlc_executor_t *executor = vlc_executor_New(1);
+    vlc_executor_t *executor = vlc_executor_NewExt(1, flags);
     assert(executor);
 
     struct data data;
@@ -91,9 +91,9 @@ static void test_single_runnable(void)
     vlc_executor_Delete(executor);
 }
 
-static void test_multiple_runnables(void)
+static void test_multiple_runnables(unsigned flags)
 {
-    vlc_executor_t *executor = vlc_executor_New(3);
+    vlc_executor_t *executor = vlc_executor_NewExt(3, flags);
     assert(executor);
 
     struct data shared_data;
@@ -118,9 +118,9 @@ static void test_multiple_runnables(void)
     vlc_executor_Delete(executor);
 }
 
-static void test_blocking_delete(void)
+static void test_blocking_delete(unsigned flags)
 {
-    vlc_executor_t *executor = vlc_executor_New(1);
+    vlc_executor_t *executor = vlc_executor_NewExt(1, flags);
     assert(executor);
 
     struct data data;
@@ -151,9 +151,9 @@ static void test_blocking_delete(void)
     vlc_mutex_unlock(&data.lock);
 }
 
-static void test_cancel(void)
+static void test_cancel(unsigned flags)
 {
-    vlc_executor_t *executor = vlc_executor_New(4);
+    vlc_executor_t *executor = vlc_executor_NewExt(4, flags);
     assert(executor);
 
     struct data shared_data;
@@ -248,9 +248,9 @@ static void DoublerRun(void *userdata)
     free(task);
 }
 
-static void test_task_chain(void)
+static void test_task_chain(unsigned flags)
 {
-    vlc_executor_t *executor = vlc_executor_New(4);
+    vlc_executor_t *executor = vlc_executor_NewExt(4, flags);
     assert(executor);
 
     /* Numbers from 0 to 99 */
@@ -271,12 +271,101 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct order_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool open;
+    int count;
+    int order[4];
+};
+
+struct order_task
+{
+    struct order_data *data;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunOrder(void *userdata)
+{
+    struct order_task *task = userdata;
+    struct order_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    /* The first task blocks the thread until all the others are queued */
+    while (!data->open)
+        vlc_cond_wait(&data->cond, &data->lock);
+    data->order[data->count++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_priority(unsigned flags)
+{
+    vlc_executor_t *executor = vlc_executor_NewExt(1, flags);
+    assert(executor);
+
+    struct order_data data = { .open = false, .count = 0 };
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+
+    static const enum vlc_executor_priority priorities[] = {
+        VLC_EXECUTOR_PRIORITY_NORMAL, /* blocker */
+        VLC_EXECUTOR_PRIORITY_LOW,
+        VLC_EXECUTOR_PRIORITY_NORMAL,
+        VLC_EXECUTOR_PRIORITY_HIGH,
+    };
+    struct order_task tasks[4];
+
+    for (int i = 0; i < 4; ++i)
+    {
+        tasks[i].data = &data;
+        tasks[i].id = i;
+        tasks[i].runnable.run = RunOrder;
+        tasks[i].runnable.userdata = &tasks[i];
+    }
+
+    vlc_executor_SubmitPriority(executor, &tasks[0].runnable, priorities[0]);
+
+    /* Make sure the blocker has been taken before queuing the others */
+    while (vlc_executor_Cancel(executor, &tasks[0].runnable))
+        vlc_executor_SubmitPriority(executor, &tasks[0].runnable,
+                                    priorities[0]);
+    vlc_tick_t delay = VLC_TICK_FROM_MS(50);
+    vlc_tick_sleep(delay);
+
+    for (int i = 1; i < 4; ++i)
+        vlc_executor_SubmitPriority(executor, &tasks[i].runnable,
+                                    priorities[i]);
+
+    vlc_mutex_lock(&data.lock);
+    data.open = true;
+    vlc_cond_broadcast(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+    vlc_executor_Delete(executor);
+
+    assert(data.count == 4);
+    assert(data.order[0] == 0);
+    assert(data.order[1] == 3);
+    assert(data.order[2] == 2);
+    assert(data.order[3] == 1);
+}
+
+static void test_all(unsigned flags)
+{
+    test_single_runnable(flags);
+    test_multiple_runnables(flags);
+    test_blocking_delete(flags);
+    test_cancel(flags);
+    test_task_chain(flags);
+    test_priority(flags);
+}
+
 int main(void)
 {
-    test_single_runnable();
-    test_multiple_runnables();
-    test_blocking_delete();
-    test_cancel();
-    test_task_chain();
+    test_all(0);
+    test_all(VLC_EXECUTOR_WORK_STEALING);
     return 0;
 }
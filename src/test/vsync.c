@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * vsync.c: test the display refresh tracking
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+
+#include "../video_output/vsync.h"
+
+#define PERIOD VLC_TICK_FROM_US(16667)
+
+int main(void)
+{
+    vout_vsync_t v;
+    const vlc_tick_t t0 = VLC_TICK_FROM_SEC(100);
+
+    vout_vsync_Init(&v);
+    assert(!vout_vsync_IsLocked(&v));
+
+    /* no period yet */
+    assert(!vout_vsync_Report(&v, t0, 0));
+    assert(!vout_vsync_IsLocked(&v));
+
+    assert(!vout_vsync_Report(&v, t0, PERIOD));
+    assert(vout_vsync_IsLocked(&v));
+
+    /* nearest vblank, after and before the last one */
+    assert(vout_vsync_Nearest(&v, t0) == t0);
+    assert(vout_vsync_Nearest(&v, t0 + PERIOD / 3) == t0);
+    assert(vout_vsync_Nearest(&v, t0 + 2 * PERIOD / 3) == t0 + PERIOD);
+    assert(vout_vsync_Nearest(&v, t0 + 10 * PERIOD + 1) == t0 + 10 * PERIOD);
+    assert(vout_vsync_Nearest(&v, t0 - PERIOD / 3) == t0);
+    assert(vout_vsync_Nearest(&v, t0 - 2 * PERIOD / 3) == t0 - PERIOD);
+    assert(vout_vsync_Nearest(&v, t0 - 5 * PERIOD - 1) == t0 - 5 * PERIOD);
+
+    /* presented on the targeted vblank, with some jitter */
+    vlc_tick_t vblank = vout_vsync_Target(&v, t0 + 3 * PERIOD + 100);
+    assert(vblank == t0 + 3 * PERIOD);
+    assert(!vout_vsync_Report(&v, vblank + 200, 0));
+
+    /* presented one vblank late */
+    vblank = vout_vsync_Target(&v, t0 + 5 * PERIOD);
+    assert(vout_vsync_Report(&v, vblank + PERIOD, 0));
+
+    /* no target, no miss */
+    assert(!vout_vsync_Report(&v, vblank + 10 * PERIOD, 0));
+
+    /* the period follows the display */
+    assert(!vout_vsync_Report(&v, t0, PERIOD / 2));
+    assert(vout_vsync_Nearest(&v, t0 + PERIOD / 2) == t0 + PERIOD / 2);
+    assert(vout_vsync_Nearest(&v, t0 + 2 * PERIOD / 3) == t0 + PERIOD / 2);
+
+    return 0;
+}
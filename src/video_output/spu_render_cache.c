@@ -0,0 +1,329 @@
+/*****************************************************************************
+ * spu_render_cache.c : cache of the rendered subpicture regions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+#include <vlc_picture.h>
+#include <vlc_subpicture.h>
+#include <vlc_text_style.h>
+
+#include "spu_render_cache.h"
+
+typedef struct
+{
+    spu_render_cache_key_t key;
+    video_format_t fmt;
+    picture_t      *picture;
+    int            x;
+    int            y;
+    size_t         size;
+    struct vlc_list node;
+} spu_render_cache_entry_t;
+
+struct spu_render_cache
+{
+    vlc_mutex_t     lock;
+    /* Most recently used first. There are only a few tens of entries within
+     * the size limit, so that a lookup is a plain walk */
+    struct vlc_list entries;
+    size_t          size;
+    size_t          max_size;
+};
+
+/*****************************************************************************
+ * Hashing (FNV-1a, by 64 bits words for the pixels)
+ *****************************************************************************/
+#define HASH_INIT  UINT64_C(0xcbf29ce484222325)
+#define HASH_PRIME UINT64_C(0x100000001b3)
+
+static uint64_t HashBytes(uint64_t h, const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < size; i++)
+        h = (h ^ p[i]) * HASH_PRIME;
+    return h;
+}
+
+static uint64_t HashInt(uint64_t h, int64_t v)
+{
+    return HashBytes(h, &v, sizeof(v));
+}
+
+static uint64_t HashString(uint64_t h, const char *str)
+{
+    if (str == NULL)
+        return HashInt(h, -1);
+    /* include the terminator so that consecutive strings are delimited */
+    return HashBytes(h, str, strlen(str) + 1);
+}
+
+static uint64_t HashWords(uint64_t h, const uint8_t *p, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, &p[i], sizeof(w));
+        h = (h ^ w) * HASH_PRIME;
+        h ^= h >> 29;
+    }
+    return HashBytes(h, &p[i], size - i);
+}
+
+static uint64_t HashStyle(uint64_t h, const text_style_t *style)
+{
+    if (style == NULL)
+        return HashInt(h, -1);
+
+    h = HashString(h, style->psz_fontname);
+    h = HashString(h, style->psz_monofontname);
+    h = HashInt(h, style->i_features);
+    h = HashInt(h, style->i_style_flags);
+    h = HashBytes(h, &style->f_font_relsize, sizeof(style->f_font_relsize));
+    h = HashInt(h, style->i_font_size);
+    h = HashInt(h, style->i_font_color);
+    h = HashInt(h, style->i_font_alpha);
+    h = HashInt(h, style->i_spacing);
+    h = HashInt(h, style->i_outline_color);
+    h = HashInt(h, style->i_outline_alpha);
+    h = HashInt(h, style->i_outline_width);
+    h = HashInt(h, style->i_shadow_color);
+    h = HashInt(h, style->i_shadow_alpha);
+    h = HashInt(h, style->i_shadow_width);
+    h = HashInt(h, style->i_background_color);
+    h = HashInt(h, style->i_background_alpha);
+    return HashInt(h, style->e_wrapinfo);
+}
+
+static uint64_t HashFormat(uint64_t h, const video_format_t *fmt)
+{
+    h = HashInt(h, fmt->i_chroma);
+    h = HashInt(h, fmt->i_width);
+    h = HashInt(h, fmt->i_height);
+    h = HashInt(h, fmt->i_x_offset);
+    h = HashInt(h, fmt->i_y_offset);
+    h = HashInt(h, fmt->i_visible_width);
+    h = HashInt(h, fmt->i_visible_height);
+    h = HashInt(h, fmt->i_sar_num);
+    h = HashInt(h, fmt->i_sar_den);
+    h = HashInt(h, fmt->primaries);
+    h = HashInt(h, fmt->transfer);
+    h = HashInt(h, fmt->space);
+    return HashInt(h, fmt->color_range);
+}
+
+uint64_t spu_render_cache_HashText(const subpicture_region_t *region,
+                                   const vlc_fourcc_t *chroma_list,
+                                   int64_t extra)
+{
+    uint64_t h = HASH_INIT;
+
+    for (const text_segment_t *s = region->p_text; s != NULL; s = s->p_next)
+    {
+        h = HashString(h, s->psz_text);
+        h = HashStyle(h, s->style);
+        for (const text_segment_ruby_t *r = s->p_ruby; r != NULL; r = r->p_next)
+        {
+            h = HashString(h, r->psz_base);
+            h = HashString(h, r->psz_rt);
+        }
+        h = HashInt(h, -2); /* end of segment */
+    }
+
+    h = HashFormat(h, &region->fmt);
+    h = HashInt(h, region->i_x);
+    h = HashInt(h, region->i_y);
+    h = HashInt(h, region->i_align);
+    h = HashInt(h, region->i_text_align);
+    h = HashInt(h, region->b_noregionbg);
+    h = HashInt(h, region->b_gridmode);
+    h = HashInt(h, region->b_balanced_text);
+    h = HashInt(h, region->i_max_width);
+    h = HashInt(h, region->i_max_height);
+
+    for (size_t i = 0; chroma_list[i]; i++)
+        h = HashInt(h, chroma_list[i]);
+
+    return HashInt(h, extra);
+}
+
+uint64_t spu_render_cache_HashPicture(const video_format_t *fmt,
+                                      const picture_t *picture)
+{
+    uint64_t h = HashFormat(HASH_INIT, fmt);
+
+    if (fmt->p_palette != NULL)
+        h = HashBytes(h, fmt->p_palette->palette,
+                      fmt->p_palette->i_entries * sizeof(fmt->p_palette->palette[0]));
+
+    /* only the visible lines, as the margins are not blended */
+    for (int i = 0; i < picture->i_planes; i++)
+    {
+        const plane_t *p = &picture->p[i];
+        for (int y = 0; y < p->i_visible_lines; y++)
+            h = HashWords(h, &p->p_pixels[y * p->i_pitch], p->i_visible_pitch);
+    }
+    return h;
+}
+
+/*****************************************************************************
+ * Cache
+ *****************************************************************************/
+static size_t PictureSize(const picture_t *picture)
+{
+    size_t size = sizeof(*picture);
+    for (int i = 0; i < picture->i_planes; i++)
+        size += (size_t)picture->p[i].i_pitch * picture->p[i].i_lines;
+    return size;
+}
+
+static bool KeyEquals(const spu_render_cache_key_t *a,
+                      const spu_render_cache_key_t *b)
+{
+    return a->hash == b->hash && a->width == b->width &&
+           a->height == b->height && a->chroma == b->chroma;
+}
+
+static void EntryDelete(spu_render_cache_t *cache,
+                        spu_render_cache_entry_t *entry)
+{
+    vlc_list_remove(&entry->node);
+    cache->size -= entry->size;
+    picture_Release(entry->picture);
+    video_format_Clean(&entry->fmt);
+    free(entry);
+}
+
+spu_render_cache_t *spu_render_cache_New(size_t max_size)
+{
+    spu_render_cache_t *cache = malloc(sizeof(*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    vlc_mutex_init(&cache->lock);
+    vlc_list_init(&cache->entries);
+    cache->size = 0;
+    cache->max_size = max_size;
+    return cache;
+}
+
+void spu_render_cache_Flush(spu_render_cache_t *cache)
+{
+    spu_render_cache_entry_t *entry;
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_list_foreach(entry, &cache->entries, node)
+        EntryDelete(cache, entry);
+    assert(cache->size == 0);
+    vlc_mutex_unlock(&cache->lock);
+}
+
+void spu_render_cache_Delete(spu_render_cache_t *cache)
+{
+    spu_render_cache_Flush(cache);
+    free(cache);
+}
+
+picture_t *spu_render_cache_Get(spu_render_cache_t *cache,
+                                const spu_render_cache_key_t *key,
+                                video_format_t *fmt, int *x, int *y)
+{
+    spu_render_cache_entry_t *entry;
+    picture_t *picture = NULL;
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_list_foreach(entry, &cache->entries, node)
+    {
+        if (!KeyEquals(&entry->key, key))
+            continue;
+
+        if (video_format_Copy(fmt, &entry->fmt) != VLC_SUCCESS)
+            break;
+        picture = picture_Hold(entry->picture);
+        if (x != NULL)
+            *x = entry->x;
+        if (y != NULL)
+            *y = entry->y;
+
+        /* move to the front */
+        vlc_list_remove(&entry->node);
+        vlc_list_prepend(&entry->node, &cache->entries);
+        break;
+    }
+    vlc_mutex_unlock(&cache->lock);
+
+    return picture;
+}
+
+void spu_render_cache_Put(spu_render_cache_t *cache,
+                          const spu_render_cache_key_t *key,
+                          const video_format_t *fmt, picture_t *picture,
+                          int x, int y)
+{
+    const size_t size = sizeof(spu_render_cache_entry_t) + PictureSize(picture);
+    if (size > cache->max_size)
+        return;
+
+    spu_render_cache_entry_t *entry = malloc(sizeof(*entry));
+    if (unlikely(entry == NULL))
+        return;
+    if (video_format_Copy(&entry->fmt, fmt) != VLC_SUCCESS)
+    {
+        free(entry);
+        return;
+    }
+    entry->key = *key;
+    entry->picture = picture_Hold(picture);
+    entry->x = x;
+    entry->y = y;
+    entry->size = size;
+
+    vlc_mutex_lock(&cache->lock);
+
+    /* a concurrent render of the same region may have inserted it already */
+    spu_render_cache_entry_t *it;
+    vlc_list_foreach(it, &cache->entries, node)
+        if (KeyEquals(&it->key, key))
+        {
+            EntryDelete(cache, it);
+            break;
+        }
+
+    /* evict the least recently used entries */
+    while (cache->size + size > cache->max_size)
+    {
+        it = vlc_list_last_entry_or_null(&cache->entries,
+                                         spu_render_cache_entry_t, node);
+        assert(it != NULL);
+        EntryDelete(cache, it);
+    }
+
+    vlc_list_prepend(&entry->node, &cache->entries);
+    cache->size += size;
+
+    vlc_mutex_unlock(&cache->lock);
+}
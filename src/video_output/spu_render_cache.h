@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * spu_render_cache.h : cache of the rendered subpicture regions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_SPU_RENDER_CACHE_H
+#define LIBVLC_VOUT_SPU_RENDER_CACHE_H
+
+#include <vlc_picture.h>
+#include <vlc_subpicture.h>
+
+/**
+ * Cache of the text rendering and of the scaling/conversion of the
+ * subpicture regions.
+ *
+ * The per region cache (subpicture_region_private_t) is lost every time a
+ * subpicture is updated, as its regions are recreated, and whenever the
+ * output size toggles. This one outlives the regions: the entries are
+ * looked up by the content of the source region, so that identical regions
+ * (repeated karaoke lines, static overlays, resizing back and forth) are
+ * only rendered once per output size.
+ *
+ * The least recently used entries are evicted above the size limit.
+ * All functions are thread-safe.
+ */
+typedef struct spu_render_cache spu_render_cache_t;
+
+typedef struct
+{
+    uint64_t     hash;   /**< hash of the source region */
+    unsigned     width;  /**< output size */
+    unsigned     height;
+    vlc_fourcc_t chroma; /**< output chroma */
+} spu_render_cache_key_t;
+
+spu_render_cache_t *spu_render_cache_New(size_t max_size);
+void spu_render_cache_Delete(spu_render_cache_t *);
+
+/**
+ * Drops all the entries, e.g. when the renderer changes.
+ */
+void spu_render_cache_Flush(spu_render_cache_t *);
+
+/**
+ * Hashes a text region before its rendering: its segments, styles and
+ * layout parameters, along with the extra rendering parameter.
+ */
+uint64_t spu_render_cache_HashText(const subpicture_region_t *,
+                                   const vlc_fourcc_t *chroma_list,
+                                   int64_t extra);
+
+/**
+ * Hashes the visible pixels of a picture of the given format, and its
+ * palette if any.
+ */
+uint64_t spu_render_cache_HashPicture(const video_format_t *,
+                                      const picture_t *);
+
+/**
+ * Looks up an entry.
+ *
+ * On success, the returned picture is held, fmt is a (deep) copy of the
+ * cached format to be cleaned by the caller and x/y the cached position
+ * when not NULL.
+ *
+ * \return the picture or NULL if not cached
+ */
+picture_t *spu_render_cache_Get(spu_render_cache_t *,
+                                const spu_render_cache_key_t *,
+                                video_format_t *fmt, int *x, int *y);
+
+/**
+ * Inserts an entry, holding the picture.
+ *
+ * The entry is not cached if larger than the limit.
+ */
+void spu_render_cache_Put(spu_render_cache_t *,
+                          const spu_render_cache_key_t *,
+                          const video_format_t *fmt, picture_t *,
+                          int x, int y);
+
+#endif
@@ -31,6 +31,7 @@ typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
     atomic_uint late;
+    atomic_uint missed_vsyncs;
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
@@ -38,6 +39,7 @@ static inline void vout_statistic_Init(vout_statistic_t *stat)
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
     atomic_init(&stat->late, 0);
+    atomic_init(&stat->missed_vsyncs, 0);
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -48,12 +50,15 @@ static inline void vout_statistic_Clean(vout_statistic_t *stat)
 static inline void vout_statistic_GetReset(vout_statistic_t *stat,
                                            unsigned *restrict displayed,
                                            unsigned *restrict lost,
-                                           unsigned *restrict late)
+                                           unsigned *restrict late,
+                                           unsigned *restrict missed_vsyncs)
 {
     *displayed = atomic_exchange_explicit(&stat->displayed, 0,
                                           memory_order_relaxed);
     *lost = atomic_exchange_explicit(&stat->lost, 0, memory_order_relaxed);
     *late = atomic_exchange_explicit(&stat->late, 0, memory_order_relaxed);
+    *missed_vsyncs = atomic_exchange_explicit(&stat->missed_vsyncs, 0,
+                                              memory_order_relaxed);
 }
 
 static inline void vout_statistic_AddDisplayed(vout_statistic_t *stat,
@@ -73,4 +78,11 @@ static inline void vout_statistic_AddLate(vout_statistic_t *stat, int late)
     atomic_fetch_add_explicit(&stat->late, late, memory_order_relaxed);
 }
 
+static inline void vout_statistic_AddMissedVsync(vout_statistic_t *stat,
+                                                 int missed)
+{
+    atomic_fetch_add_explicit(&stat->missed_vsyncs, missed,
+                              memory_order_relaxed);
+}
+
 #endif
@@ -49,12 +49,15 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
+#include <vlc_tracer.h>
+#include <vlc_metrics.h>
 
 #include <libvlc.h>
 #include "vout_private.h"
 #include "vout_internal.h"
 #include "display.h"
 #include "snapshot.h"
+#include "vsync.h"
 #include "window.h"
 #include "../misc/variables.h"
 #include "../clock/clock.h"
@@ -144,8 +147,17 @@ typedef struct vout_thread_sys_t
     /* Video output display */
     vout_display_cfg_t display_cfg;
     vout_display_t *display;
+    vlc_video_context *display_vctx; /* video context of the display */
+    bool            display_kept; /* no input, see vout_StopInput() */
     vlc_mutex_t     display_lock;
 
+    /* Display refresh, reported by the display from any thread */
+    struct {
+        vlc_mutex_t  lock;
+        bool         pacing; /* schedule the pictures on the vblanks */
+        vout_vsync_t state;
+    } vsync;
+
     /* Video filter2 chain */
     struct {
         vlc_mutex_t     lock;
@@ -163,6 +175,13 @@ typedef struct vout_thread_sys_t
         vout_chrono_t static_filter;
         vout_chrono_t render;         /**< picture render time estimator */
     } chrono;
+    struct {
+        struct vlc_histogram *filter;
+        struct vlc_histogram *prepare;
+        struct vlc_histogram *display;
+    } metrics;
+    /* copy of the estimates for the decoder thread */
+    _Atomic vlc_tick_t render_estimate;
 
     vlc_atomic_rc_t rc;
 
@@ -330,11 +349,38 @@ static void vout_UpdateWindowSizeLocked(vout_thread_sys_t *vout)
 
 /* */
 void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
-                            unsigned *restrict lost, unsigned *restrict late)
+                            unsigned *restrict lost, unsigned *restrict late,
+                            unsigned *restrict missed_vsyncs)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
-    vout_statistic_GetReset( &sys->statistic, displayed, lost, late );
+    vout_statistic_GetReset( &sys->statistic, displayed, lost, late,
+                             missed_vsyncs );
+}
+
+void vout_ReportVsync(vout_thread_t *vout, vlc_tick_t date, vlc_tick_t period)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    assert(!sys->dummy);
+
+    vlc_mutex_lock(&sys->vsync.lock);
+    bool missed = vout_vsync_Report(&sys->vsync.state, date, period);
+    vlc_mutex_unlock(&sys->vsync.lock);
+
+    if (missed)
+        vout_statistic_AddMissedVsync(&sys->statistic, 1);
+}
+
+/* How much earlier the pictures may be displayed to be on their vblank */
+static vlc_tick_t VsyncAdvance(vout_thread_sys_t *sys)
+{
+    vlc_tick_t advance = 0;
+
+    vlc_mutex_lock(&sys->vsync.lock);
+    if (sys->vsync.pacing && vout_vsync_IsLocked(&sys->vsync.state))
+        advance = sys->vsync.state.period;
+    vlc_mutex_unlock(&sys->vsync.lock);
+    return advance;
 }
 
 bool vout_IsEmpty(vout_thread_t *vout)
@@ -347,6 +393,18 @@ bool vout_IsEmpty(vout_thread_t *vout)
     return picture_fifo_IsEmpty(sys->decoder_fifo);
 }
 
+void vout_GetLoad(vout_thread_t *vout, unsigned *restrict queued,
+                  vlc_tick_t *restrict render)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    assert(!sys->dummy);
+
+    *queued = sys->decoder_fifo != NULL
+            ? picture_fifo_Count(sys->decoder_fifo) : 0;
+    *render = atomic_load_explicit(&sys->render_estimate,
+                                   memory_order_relaxed);
+}
+
 void vout_DisplayTitle(vout_thread_t *vout, const char *title)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
@@ -1036,9 +1094,18 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
         sys->displayed.timestamp     = decoded->date;
         sys->displayed.is_interlaced = !decoded->b_progressive;
 
+        struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(&vout->obj));
+        vlc_tick_t date = decoded->date;
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "FILTER", "vout", date);
+
         vout_chrono_Start(&sys->chrono.static_filter);
         picture = filter_chain_VideoFilter(sys->filter.chain_static, sys->displayed.decoded);
-        vout_chrono_Stop(&sys->chrono.static_filter);
+        vlc_histogram_Observe(sys->metrics.filter,
+                              vout_chrono_Stop(&sys->chrono.static_filter));
+
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "FILTER", "vout", date);
     }
 
     vlc_mutex_unlock(&sys->filter.lock);
@@ -1330,10 +1397,35 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     const unsigned frame_rate = todisplay->format.i_frame_rate;
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
+    /* With the display refresh known, the picture is displayed half a period
+     * before the vblank nearest to its date, so that it is latched by it */
+    vlc_tick_t vsync_shift = 0;
+    vlc_tick_t vsync_margin = 0;
+    if (!render_now)
+    {
+        vlc_mutex_lock(&sys->vsync.lock);
+        if (vout_vsync_IsLocked(&sys->vsync.state))
+        {
+            const vlc_tick_t vblank = vout_vsync_Target(&sys->vsync.state,
+                                                        system_pts);
+            if (sys->vsync.pacing)
+            {
+                vsync_margin = sys->vsync.state.period / 2;
+                vsync_shift = vblank - vsync_margin - system_pts;
+            }
+        }
+        vlc_mutex_unlock(&sys->vsync.lock);
+    }
+
     if (vd->ops->prepare != NULL)
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
 
-    vout_chrono_Stop(&sys->chrono.render);
+    vlc_histogram_Observe(sys->metrics.prepare,
+                          vout_chrono_Stop(&sys->chrono.render));
+    atomic_store_explicit(&sys->render_estimate,
+                          vout_chrono_GetHigh(&sys->chrono.render) +
+                          vout_chrono_GetHigh(&sys->chrono.static_filter),
+                          memory_order_relaxed);
 
     system_now = vlc_tick_now();
     if (!render_now)
@@ -1364,7 +1456,8 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
                 else
                 {
                     deadline = vlc_clock_ConvertToSystemLocked(sys->clock,
-                                                vlc_tick_now(), pts, sys->rate);
+                                                vlc_tick_now(), pts, sys->rate)
+                             + vsync_shift;
                     if (deadline > max_deadline)
                         deadline = max_deadline;
                 }
@@ -1374,6 +1467,9 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
             };
 
             vlc_clock_Unlock(sys->clock);
+
+            /* The picture is presented at the vblank */
+            system_pts += vsync_margin;
         }
         sys->displayed.date = system_pts;
     }
@@ -1387,7 +1483,12 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
                           frame_rate, frame_rate_base);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    vlc_tick_t display_start = sys->metrics.display != NULL ? vlc_tick_now()
+                                                           : VLC_TICK_INVALID;
     vout_display_Display(vd, todisplay);
+    if (display_start != VLC_TICK_INVALID)
+        vlc_histogram_Observe(sys->metrics.display,
+                              vlc_tick_now() - display_start);
     vlc_mutex_unlock(&sys->display_lock);
 
     picture_Release(todisplay);
@@ -1444,7 +1545,8 @@ static int DisplayPicture(vout_thread_sys_t *vout, vlc_tick_t *deadline)
 
     bool render_now = true;
     const vlc_tick_t system_now = vlc_tick_now();
-    const vlc_tick_t render_delay = vout_chrono_GetHigh(&sys->chrono.render) + VOUT_MWAIT_TOLERANCE;
+    const vlc_tick_t render_delay = vout_chrono_GetHigh(&sys->chrono.render) + VOUT_MWAIT_TOLERANCE
+                                  + VsyncAdvance(sys);
     const bool first = !sys->displayed.current;
 
     bool dropped_current_frame = false;
@@ -1704,8 +1806,11 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     vlc_mouse_Init(&sys->mouse);
 
     sys->decoder_fifo = picture_fifo_New();
-    sys->private.display_pool = NULL;
-    sys->private.private_pool = NULL;
+    if (!sys->display_kept)
+    {
+        sys->private.display_pool = NULL;
+        sys->private.private_pool = NULL;
+    }
 
     sys->filter.configuration = NULL;
     video_format_Copy(&sys->filter.src_fmt, &sys->original);
@@ -1752,11 +1857,26 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     dcfg.window_props.width = sys->window_width;
     dcfg.window_props.height = sys->window_height;
 
-    sys->display = vout_OpenWrapper(&vout->obj, &sys->private, sys->splitter_name, &dcfg,
-                                    &sys->original, vctx);
-    if (sys->display == NULL) {
-        vlc_mutex_unlock(&sys->display_lock);
-        goto error;
+    if (sys->display_kept)
+    {
+        /* Reuse the display of the previous input, see vout_Request() */
+        assert(sys->display != NULL && sys->display_vctx == vctx);
+        sys->display_kept = false;
+    }
+    else
+    {
+        /* The refresh is reported again by the new display */
+        vlc_mutex_lock(&sys->vsync.lock);
+        vout_vsync_Init(&sys->vsync.state);
+        vlc_mutex_unlock(&sys->vsync.lock);
+
+        sys->display = vout_OpenWrapper(&vout->obj, &sys->private, sys->splitter_name, &dcfg,
+                                        &sys->original, vctx);
+        if (sys->display == NULL) {
+            vlc_mutex_unlock(&sys->display_lock);
+            goto error;
+        }
+        sys->display_vctx = vctx;
     }
 
     vout_SetDisplayCrop(sys->display, &crop);
@@ -1852,11 +1972,22 @@ static void *Thread(void *object)
     return NULL;
 }
 
-static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
+static void vout_CloseDisplay(vout_thread_sys_t *vout)
 {
     vout_thread_sys_t *sys = vout;
 
-    assert(sys->display != NULL);
+    vlc_mutex_lock(&sys->display_lock);
+    vout_CloseWrapper(&vout->obj, &sys->private, sys->display);
+    sys->display = NULL;
+    sys->display_vctx = NULL;
+    vlc_mutex_unlock(&sys->display_lock);
+}
+
+static void vout_ReleaseDisplay(vout_thread_sys_t *vout, bool keep_display)
+{
+    vout_thread_sys_t *sys = vout;
+
+    assert(sys->display != NULL && !sys->display_kept);
 
     if (sys->spu_blend != NULL)
         filter_DeleteBlend(sys->spu_blend);
@@ -1865,10 +1996,8 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
     if (sys->private.display_pool != NULL)
         vout_FlushUnlocked(vout, true, VLC_TICK_MAX);
 
-    vlc_mutex_lock(&sys->display_lock);
-    vout_CloseWrapper(&vout->obj, &sys->private, sys->display);
-    sys->display = NULL;
-    vlc_mutex_unlock(&sys->display_lock);
+    if (!keep_display)
+        vout_CloseDisplay(vout);
 
     /* Destroy the video filters */
     DelAllFilterCallbacks(vout);
@@ -1887,7 +2016,7 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
         picture_fifo_Delete(sys->decoder_fifo);
         sys->decoder_fifo = NULL;
     }
-    assert(sys->private.display_pool == NULL);
+    assert(keep_display || sys->private.display_pool == NULL);
 
     if (sys->mouse_event)
     {
@@ -1898,19 +2027,57 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
     if (sys->spu)
         spu_Detach(sys->spu);
     sys->clock = NULL;
-    video_format_Clean(&sys->original);
+
+    /* The window size of a kept display still depends on the original */
+    if (keep_display)
+        sys->display_kept = true;
+    else
+        video_format_Clean(&sys->original);
 }
 
-void vout_StopDisplay(vout_thread_t *vout)
+static void vout_StopThread(vout_thread_sys_t *vout)
 {
-    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    vout_thread_sys_t *sys = vout;
 
     atomic_store(&sys->control_is_terminated, true);
     // wake up so it goes back to the loop that will detect the terminated state
     vout_control_Wake(&sys->control);
     vlc_join(sys->thread, NULL);
+}
+
+static void vout_ReleaseKeptDisplay(vout_thread_sys_t *vout)
+{
+    vout_thread_sys_t *sys = vout;
+
+    assert(sys->display_kept);
+    vout_CloseDisplay(vout);
+    sys->display_kept = false;
+    assert(sys->private.display_pool == NULL);
+    video_format_Clean(&sys->original);
+}
+
+void vout_StopDisplay(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    if (sys->display_kept)
+    {
+        vout_ReleaseKeptDisplay(sys);
+        return;
+    }
 
-    vout_ReleaseDisplay(sys);
+    vout_StopThread(sys);
+    vout_ReleaseDisplay(sys, false);
+}
+
+void vout_StopInput(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    assert(sys->display != NULL && !sys->display_kept);
+
+    vout_StopThread(sys);
+    vout_ReleaseDisplay(sys, true);
 }
 
 static void vout_DisableWindow(vout_thread_sys_t *sys)
@@ -2065,8 +2232,14 @@ vout_thread_t *vout_Create(vlc_object_t *object)
 
     /* Display */
     sys->display = NULL;
+    sys->display_vctx = NULL;
+    sys->display_kept = false;
     vlc_mutex_init(&sys->display_lock);
 
+    vlc_mutex_init(&sys->vsync.lock);
+    sys->vsync.pacing = var_InheritBool(vout, "video-vsync-pacing");
+    vout_vsync_Init(&sys->vsync.state);
+
     /* Window */
     sys->window_width = sys->window_height = 0;
     sys->display_cfg.window = vout_display_window_New(vout);
@@ -2085,6 +2258,17 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     /* Arbitrary initial time */
     vout_chrono_Init(&sys->chrono.render, 5, VLC_TICK_FROM_MS(10));
     vout_chrono_Init(&sys->chrono.static_filter, 4, VLC_TICK_FROM_MS(0));
+    sys->metrics.filter = vlc_histogram_Get(vout, "vlc_vout_filter_seconds",
+        NULL, "Time spent in the static video filters per picture",
+        VLC_METRIC_SECONDS);
+    sys->metrics.prepare = vlc_histogram_Get(vout, "vlc_vout_prepare_seconds",
+        NULL, "Time spent rendering a picture before its display",
+        VLC_METRIC_SECONDS);
+    sys->metrics.display = vlc_histogram_Get(vout, "vlc_vout_display_seconds",
+        NULL, "Time spent displaying a picture", VLC_METRIC_SECONDS);
+    atomic_init(&sys->render_estimate,
+                vout_chrono_GetHigh(&sys->chrono.render) +
+                vout_chrono_GetHigh(&sys->chrono.static_filter));
 
     if (var_InheritBool(vout, "video-wallpaper"))
         vout_window_SetState(sys->display_cfg.window, VOUT_WINDOW_STATE_BELOW);
@@ -2106,6 +2290,9 @@ int vout_ChangeSource( vout_thread_t *vout, const video_format_t *original )
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
 
+    if (sys->display_kept)
+        return -1; /* the vout thread must be restarted */
+
      /* TODO: If dimensions are equal or slightly smaller, update the aspect
      * ratio and crop settings, instead of recreating a display.
      */
@@ -2117,6 +2304,39 @@ int vout_ChangeSource( vout_thread_t *vout, const video_format_t *original )
     return -1;
 }
 
+/**
+ * Checks if the display opened for the previous input can render the
+ * pictures of a new input.
+ *
+ * The crop and sample aspect ratio are updated on the fly for every picture,
+ * only the properties fixed at display creation need to match.
+ */
+static bool VoutCanReuseDisplay(vout_thread_sys_t *vout,
+                                const video_format_t *original,
+                                vlc_video_context *vctx)
+{
+    vout_thread_sys_t *sys = vout;
+    const video_format_t *source = sys->display->source;
+
+    /* The display converters are bound to the video context */
+    if (vctx != sys->display_vctx)
+        return false;
+
+    video_format_t fmt = *original;
+    video_format_CopyCrop(&fmt, source);
+    fmt.i_sar_num = source->i_sar_num;
+    fmt.i_sar_den = source->i_sar_den;
+
+    return video_format_IsSimilar(&fmt, source)
+        && fmt.primaries == source->primaries
+        && fmt.transfer == source->transfer
+        && fmt.space == source->space
+        && fmt.color_range == source->color_range
+        && fmt.chroma_location == source->chroma_location
+        && fmt.b_multiview_right_eye_first == source->b_multiview_right_eye_first
+        && fmt.projection_mode == source->projection_mode;
+}
+
 static int EnableWindowLocked(vout_thread_sys_t *vout, const video_format_t *original)
 {
     assert(vout != NULL);
@@ -2202,7 +2422,19 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     vlc_mutex_unlock(&sys->window_lock);
 
     if (sys->display != NULL)
-        vout_StopDisplay(cfg->vout);
+    {
+        /* Keep the display, and its last picture, if it fits the new input */
+        if (!sys->display_kept)
+            vout_StopInput(cfg->vout);
+
+        if (VoutCanReuseDisplay(vout, &original, vctx))
+        {
+            msg_Dbg(cfg->vout, "reusing the display of the previous input");
+            video_format_Clean(&sys->original);
+        }
+        else
+            vout_StopDisplay(cfg->vout);
+    }
 
     vout_ReinitInterlacingSupport(cfg->vout, &sys->private);
 
@@ -2216,13 +2448,16 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     if (vout_Start(vout, vctx, cfg))
     {
         msg_Err(cfg->vout, "video output display creation failed");
-        video_format_Clean(&sys->original);
+        if (sys->display_kept)
+            vout_ReleaseKeptDisplay(vout);
+        else
+            video_format_Clean(&sys->original);
         vout_DisableWindow(vout);
         return -1;
     }
     atomic_store(&sys->control_is_terminated, false);
     if (vlc_clone(&sys->thread, Thread, vout, VLC_THREAD_PRIORITY_OUTPUT)) {
-        vout_ReleaseDisplay(vout);
+        vout_ReleaseDisplay(vout, false);
         vout_DisableWindow(vout);
         return -1;
     }
@@ -92,6 +92,14 @@ void vout_Stop(vout_thread_t *);
  */
 void vout_StopDisplay(vout_thread_t *);
 
+/**
+ * Stop processing the current input, but keep the display plugin open.
+ *
+ * The last picture stays on screen, and the display is reused by the next
+ * vout_Request() if its format is compatible, or stopped otherwise.
+ */
+void vout_StopInput(vout_thread_t *);
+
 /**
  * Set the new source format for a started vout
  *
@@ -220,7 +228,16 @@ void vout_MouseState(vout_thread_t *, const vlc_mouse_t *);
  * This function will return and reset internal statistics.
  */
 void vout_GetResetStatistic( vout_thread_t *p_vout, unsigned *pi_displayed,
-                             unsigned *pi_lost, unsigned *pi_late );
+                             unsigned *pi_lost, unsigned *pi_late,
+                             unsigned *pi_missed_vsyncs );
+
+/**
+ * This function reports a presentation of the display at a vblank.
+ *
+ * It may be called from any thread.
+ */
+void vout_ReportVsync( vout_thread_t *p_vout, vlc_tick_t date,
+                       vlc_tick_t period );
 
 /**
  * This function will force to display the next picture while paused
@@ -237,6 +254,15 @@ void vout_DisplayTitle( vout_thread_t *p_vout, const char *psz_title );
  */
 bool vout_IsEmpty( vout_thread_t *p_vout );
 
+/**
+ * This function returns the number of decoded pictures waiting to be
+ * displayed and the estimated time to prepare and render one.
+ *
+ * It may be called from any thread.
+ */
+void vout_GetLoad( vout_thread_t *p_vout, unsigned *pi_queued,
+                   vlc_tick_t *pi_render );
+
 void vout_SetSpuHighlight( vout_thread_t *p_vout, const vlc_spu_highlight_t * );
 
 #endif // LIBVLC_VOUT_INTERNAL_H
@@ -44,6 +44,7 @@
 #include "../misc/subpicture.h"
 #include "../input/input_internal.h"
 #include "../clock/clock.h"
+#include "spu_render_cache.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -76,6 +77,7 @@ struct spu_channel {
 typedef struct VLC_VECTOR(struct spu_channel) spu_channel_vector;
 typedef struct VLC_VECTOR(subpicture_t *) spu_prerender_vector;
 #define SPU_CHROMALIST_COUNT 8
+#define SPU_RENDER_CACHE_SIZE (32 * 1024 * 1024)
 
 struct spu_private_t {
     vlc_mutex_t  lock;            /* lock to protect all followings fields */
@@ -105,6 +107,7 @@ struct spu_private_t {
     int secondary_margin;
     int secondary_alignment;       /**< Force alignment for secondary subs */
     video_palette_t palette;              /**< force palette of subpicture */
+    spu_render_cache_t *render_cache;  /**< rendered/scaled regions cache */
 
     /* Subpiture filters */
     char           *source_chain_current;
@@ -341,6 +344,32 @@ static int SpuRenderText(spu_t *spu,
     if (region->fmt.color_range == COLOR_RANGE_UNDEF)
         region->fmt.color_range = COLOR_RANGE_FULL;
 
+    /* The rendering only depends on the region and on the output size */
+    const spu_render_cache_key_t key = {
+        .hash = spu_render_cache_HashText(region, chroma_list,
+                                          var_InheritInteger(spu, "sub-text-scale")),
+        .width = i_original_width,
+        .height = i_original_height,
+        .chroma = VLC_CODEC_TEXT,
+    };
+    video_format_t fmt;
+    int x, y;
+    picture_t *picture = spu_render_cache_Get(sys->render_cache, &key,
+                                              &fmt, &x, &y);
+    if (picture)
+    {
+        vlc_mutex_unlock(&sys->textlock);
+
+        if (region->p_picture)
+            picture_Release(region->p_picture);
+        video_format_Clean(&region->fmt);
+        region->fmt = fmt;
+        region->p_picture = picture;
+        region->i_x = x;
+        region->i_y = y;
+        return VLC_SUCCESS;
+    }
+
     /* FIXME aspect ratio ? */
     text->fmt_out.video.i_width =
     text->fmt_out.video.i_visible_width  = i_original_width;
@@ -351,6 +380,12 @@ static int SpuRenderText(spu_t *spu,
     int i_ret = text->ops->render(text, region, region, chroma_list);
 
     vlc_mutex_unlock(&sys->textlock);
+
+    /* speech synthesizers do not output any picture */
+    if (i_ret == VLC_SUCCESS && region->p_picture &&
+        region->fmt.i_chroma != VLC_CODEC_TEXT)
+        spu_render_cache_Put(sys->render_cache, &key, &region->fmt,
+                             region->p_picture, region->i_x, region->i_y);
     return i_ret;
 }
 
@@ -981,6 +1016,28 @@ static void SpuRenderRegion(spu_t *spu,
             }
         }
 
+        /* Look for the same region previously scaled to the same size */
+        spu_render_cache_key_t key;
+        if (!region->p_private && dst_width > 0 && dst_height > 0) {
+            key.hash = spu_render_cache_HashPicture(&region->fmt,
+                                                    region->p_picture);
+            key.width = dst_width;
+            key.height = dst_height;
+            key.chroma = chroma_list[0];
+
+            video_format_t cached_fmt;
+            picture_t *cached = spu_render_cache_Get(sys->render_cache, &key,
+                                                     &cached_fmt, NULL, NULL);
+            if (cached) {
+                region->p_private = subpicture_region_private_New(&cached_fmt);
+                if (region->p_private)
+                    region->p_private->p_picture = cached;
+                else
+                    picture_Release(cached);
+                video_format_Clean(&cached_fmt);
+            }
+        }
+
         /* Scale if needed into cache */
         if (!region->p_private && dst_width > 0 && dst_height > 0) {
             filter_t *scale = sys->scale;
@@ -1037,6 +1094,8 @@ static void SpuRenderRegion(spu_t *spu,
 
             /* */
             if (picture) {
+                spu_render_cache_Put(sys->render_cache, &key,
+                                     &picture->format, picture, 0, 0);
                 region->p_private = subpicture_region_private_New(&picture->format);
                 if (region->p_private) {
                     region->p_private->p_picture = picture;
@@ -1581,6 +1640,9 @@ static void spu_Cleanup(spu_t *spu)
     if (sys->scale)
         FilterRelease(sys->scale);
 
+    if (sys->render_cache)
+        spu_render_cache_Delete(sys->render_cache);
+
     filter_chain_ForEach(sys->source_chain, SubSourceClean, spu);
     if (sys->vout)
         filter_chain_ForEach(sys->source_chain,
@@ -1695,9 +1757,10 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->scale_yuvp = SpuRenderCreateAndLoadScale(VLC_OBJECT(spu),
                                                   VLC_CODEC_YUVP, VLC_CODEC_YUVA, false);
 
+    sys->render_cache = spu_render_cache_New(SPU_RENDER_CACHE_SIZE);
 
     if (!sys->source_chain || !sys->filter_chain || !sys->text || !sys->scale
-     || !sys->scale_yuvp)
+     || !sys->scale_yuvp || !sys->render_cache)
     {
         sys->vout = NULL;
         spu_Cleanup(spu);
@@ -1733,6 +1796,8 @@ void spu_Attach(spu_t *spu, input_thread_t *input)
         if (spu->p->text)
             FilterRelease(spu->p->text);
         spu->p->text = SpuRenderCreateAndLoadText(spu);
+        /* the new renderer may use other fonts or settings */
+        spu_render_cache_Flush(spu->p->render_cache);
         vlc_mutex_unlock(&spu->p->textlock);
     }
     vlc_mutex_unlock(&spu->p->lock);
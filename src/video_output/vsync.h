@@ -0,0 +1,96 @@
+/*****************************************************************************
+ * vsync.h: vout display refresh tracking
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_VSYNC_H
+#define LIBVLC_VOUT_VSYNC_H
+
+/*
+ * The displays reporting their presentations give the phase and the period
+ * of the refresh. A picture is then scheduled for the vblank nearest to its
+ * date rather than for the date itself: the pictures of a lower frame rate
+ * follow a steady cadence (3:2 for 24 fps on 60 Hz) instead of jittering
+ * around the vblanks whenever the wakeups drift.
+ */
+typedef struct {
+    vlc_tick_t last;   /* system date of the last reported vblank */
+    vlc_tick_t period; /* refresh period, 0 if unknown */
+    vlc_tick_t target; /* vblank targeted by the last displayed picture */
+} vout_vsync_t;
+
+static inline void vout_vsync_Init(vout_vsync_t *vsync)
+{
+    vsync->last   = VLC_TICK_INVALID;
+    vsync->period = 0;
+    vsync->target = VLC_TICK_INVALID;
+}
+
+static inline bool vout_vsync_IsLocked(const vout_vsync_t *vsync)
+{
+    return vsync->last != VLC_TICK_INVALID && vsync->period > 0;
+}
+
+/**
+ * Reports a presentation at the vblank of the given date.
+ *
+ * \return true if the targeted vblank was missed
+ */
+static inline bool vout_vsync_Report(vout_vsync_t *vsync, vlc_tick_t date,
+                                     vlc_tick_t period)
+{
+    bool missed = false;
+
+    if (period > 0)
+        vsync->period = period;
+    if (vsync->target != VLC_TICK_INVALID && vsync->period > 0)
+        missed = date > vsync->target + vsync->period / 2;
+
+    vsync->last   = date;
+    vsync->target = VLC_TICK_INVALID;
+    return missed;
+}
+
+/**
+ * Returns the vblank nearest to a date.
+ */
+static inline vlc_tick_t vout_vsync_Nearest(const vout_vsync_t *vsync,
+                                            vlc_tick_t date)
+{
+    assert(vout_vsync_IsLocked(vsync));
+
+    const vlc_tick_t period = vsync->period;
+    vlc_tick_t offset = date - vsync->last + period / 2;
+    /* rounded towards minus infinity */
+    vlc_tick_t count = offset >= 0 ? offset / period
+                                   : -((period - 1 - offset) / period);
+    return vsync->last + count * period;
+}
+
+/**
+ * Returns the vblank targeted by a picture of the given date, and records
+ * it to detect the missed vblanks.
+ */
+static inline vlc_tick_t vout_vsync_Target(vout_vsync_t *vsync,
+                                           vlc_tick_t date)
+{
+    vsync->target = vout_vsync_Nearest(vsync, date);
+    return vsync->target;
+}
+
+#endif
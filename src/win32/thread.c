@@ -33,6 +33,7 @@
 #include <vlc_common.h>
 
 #include "libvlc.h"
+#include "misc/thread_policy.h"
 #include <stdarg.h>
 #include <stdatomic.h>
 #include <stdnoreturn.h>
@@ -67,6 +68,7 @@ struct vlc_thread
 
     void        *(*entry) (void *);
     void          *data;
+    enum vlc_thread_role role;
 };
 
 /*** Thread-specific variables (TLS) ***/
@@ -342,8 +344,11 @@ __stdcall vlc_entry (void *p)
     struct vlc_thread *th = p;
 
     current_thread_ctx = th;
+    /* The Multimedia Class Scheduler only registers the calling thread */
+    vlc_thread_policy_ApplySelf(th->role);
     th->killable = true;
     th->data = th->entry (th->data);
+    vlc_thread_policy_LeaveSelf();
     current_thread_ctx = NULL;
 
     return 0;
@@ -360,6 +365,7 @@ int vlc_clone (vlc_thread_t *p_handle, void *(*entry) (void *),
     th->killable = false; /* not until vlc_entry() ! */
     atomic_init(&th->killed, false);
     th->cleaners = NULL;
+    th->role = vlc_thread_policy_Role(priority);
 
     HANDLE h;
 #ifdef VLC_WINSTORE_APP
@@ -383,7 +389,7 @@ int vlc_clone (vlc_thread_t *p_handle, void *(*entry) (void *),
     if (p_handle != NULL)
         *p_handle = th;
 
-    if (priority)
+    if (priority && vlc_thread_policy_Get(th->role) == NULL)
         SetThreadPriority (th->id, priority);
 
     return 0;
@@ -469,6 +475,7 @@ noreturn static void vlc_docancel(struct vlc_thread *th)
         p->proc (p->data);
 
     th->data = VLC_THREAD_CANCELED;
+    vlc_thread_policy_LeaveSelf();
 #ifdef VLC_WINSTORE_APP
     ExitThread(0);
 #else // !VLC_WINSTORE_APP
@@ -0,0 +1,174 @@
+/*****************************************************************************
+ * checkasm.c: verification and benchmark of the CPU-specific kernels
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "checkasm.h"
+
+/*
+ * Usage: test_modules_checkasm [--bench] [--seed=N]
+ *
+ * Without argument, the implementations are checked against the C references
+ * with a time-based seed, which is printed so that failures can be replayed.
+ * With --bench, the time per call of each implementation is printed as well.
+ */
+
+bool checkasm_benchmark;
+
+static struct
+{
+    const char *kernel;
+    const char *impl;
+    unsigned kernel_failures;
+    bool impl_failed;
+    unsigned failures;
+    unsigned impls;
+    double baseline_ns; /**< time per call of the first benchmarked impl */
+    uint32_t rand;
+} state;
+
+void checkasm_begin(const char *kernel)
+{
+    state.kernel = kernel;
+    state.impl = NULL;
+    state.kernel_failures = 0;
+    state.impls = 0;
+    state.baseline_ns = 0.;
+}
+
+bool checkasm_impl(const char *impl, bool available)
+{
+    state.impl = impl;
+    state.impl_failed = false;
+    if (!available)
+        return false;
+    state.impls++;
+    return true;
+}
+
+void checkasm_fail(const char *fmt, ...)
+{
+    va_list ap;
+
+    /* only report the first mismatch of an implementation */
+    state.kernel_failures++;
+    if (state.impl_failed)
+        return;
+    state.impl_failed = true;
+
+    fprintf(stderr, "FAILED %s/%s: ", state.kernel, state.impl);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+void checkasm_end(void)
+{
+    printf("%-24s %s (%u implementations)\n", state.kernel,
+           state.kernel_failures ? "FAILED" : "ok", state.impls);
+    if (state.kernel_failures)
+        state.failures++;
+}
+
+/* xorshift32: fast and reproducible across platforms */
+uint32_t checkasm_rand(void)
+{
+    uint32_t x = state.rand;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return state.rand = x;
+}
+
+void checkasm_random(void *buf, size_t size)
+{
+    uint8_t *p = buf;
+
+    for (; size >= 4; size -= 4, p += 4)
+    {
+        uint32_t x = checkasm_rand();
+        memcpy(p, &x, 4);
+    }
+    for (; size > 0; size--)
+        *(p++) = checkasm_rand();
+}
+
+uint64_t checkasm_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+void checkasm_bench_report(uint64_t ns, uint64_t calls)
+{
+    double per_call = (double)ns / calls;
+
+    if (state.baseline_ns == 0.)
+        state.baseline_ns = per_call;
+    printf("  %-22s %10.1f ns/call  x%.2f\n", state.impl, per_call,
+           state.baseline_ns / per_call);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t seed = time(NULL);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--bench"))
+            checkasm_benchmark = true;
+        else if (!strncmp(argv[i], "--seed=", 7))
+            seed = strtoul(argv[i] + 7, NULL, 0);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--bench] [--seed=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("checkasm: seed %"PRIu32", CPU flags 0x%x\n", seed, vlc_CPU());
+    state.rand = seed ? seed : 1;
+
+    checkasm_check_startcode();
+    checkasm_check_deinterlace();
+    checkasm_check_copy();
+
+    if (state.failures)
+    {
+        fprintf(stderr, "checkasm: %u kernels FAILED\n", state.failures);
+        return 1;
+    }
+    return 0;
+}
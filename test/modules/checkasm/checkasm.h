@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * checkasm.h: verification and benchmark of the CPU-specific kernels
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TEST_CHECKASM_H
+#define VLC_TEST_CHECKASM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vlc_common.h>
+
+/*
+ * Each suite checks every implementation of its kernels against the C
+ * reference, on random inputs:
+ *
+ *   checkasm_begin("merge8");
+ *   if (checkasm_impl("c", true))
+ *       ... run the reference, checkasm_bench(call) ...
+ *   if (checkasm_impl("sse2", vlc_CPU_SSE2()))
+ *       ... run, compare, checkasm_fail() on mismatch, checkasm_bench(call) ...
+ *   checkasm_end();
+ *
+ * The first benchmarked implementation of a kernel is the baseline of the
+ * reported speedups.
+ */
+
+extern bool checkasm_benchmark;
+
+void checkasm_begin(const char *kernel);
+bool checkasm_impl(const char *impl, bool available);
+void checkasm_fail(const char *fmt, ...) VLC_FORMAT(1, 2);
+void checkasm_end(void);
+
+uint32_t checkasm_rand(void);
+void checkasm_random(void *buf, size_t size);
+
+uint64_t checkasm_ns(void);
+void checkasm_bench_report(uint64_t ns, uint64_t calls);
+
+#define CHECKASM_BENCH_NS UINT64_C(50000000)
+
+/* Times a call for CHECKASM_BENCH_NS, if benchmarking is enabled */
+#define checkasm_bench(call) do { \
+    if (checkasm_benchmark) { \
+        uint64_t calls_ = 0, start_ = checkasm_ns(), ns_; \
+        do { \
+            call; call; call; call; \
+            calls_ += 4; \
+        } while ((ns_ = checkasm_ns() - start_) < CHECKASM_BENCH_NS); \
+        checkasm_bench_report(ns_, calls_); \
+    } \
+} while (0)
+
+void checkasm_check_startcode(void);
+void checkasm_check_deinterlace(void);
+void checkasm_check_copy(void);
+
+#endif
@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * chroma_copy.c: checkasm suite for the chroma copy helpers
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+/* The copy helpers pick their implementation at each call: mask the CPU
+ * flags to go through every path the dispatch could select, as on older
+ * CPUs. The flags implied by the compiler target cannot be masked. */
+static unsigned cpu_mask = ~0u;
+#define vlc_CPU() (vlc_CPU() & cpu_mask)
+
+#include "../modules/video_chroma/copy.c"
+
+#include "checkasm.h"
+
+static const struct
+{
+    const char *name;
+    unsigned flags; /**< extension used from this level on */
+} levels[] = {
+#if defined(__i386__) || defined(__x86_64__)
+    { "avx2", VLC_CPU_AVX2 },
+    { "sse4.1", VLC_CPU_SSE4_1 },
+    { "ssse3", VLC_CPU_SSSE3 },
+    { "sse3", VLC_CPU_SSE3 },
+    { "sse2", VLC_CPU_SSE2 },
+#elif defined(__arm__) || defined(__aarch64__)
+    { "neon", VLC_CPU_ARM_NEON },
+#endif
+};
+
+typedef void (*copy_t)(picture_t *, const uint8_t *[], const size_t [],
+                       unsigned, const copy_cache_t *);
+typedef void (*copy16_t)(picture_t *, const uint8_t *[], const size_t [],
+                         unsigned, int, const copy_cache_t *);
+
+static const struct
+{
+    const char *name;
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    copy_t copy;
+    copy16_t copy16;
+    int bitshift;
+} copies[] = {
+    { "copy_nv12_to_i420", VLC_CODEC_NV12, VLC_CODEC_I420,
+      Copy420_SP_to_P, NULL, 0 },
+    { "copy_nv12_to_nv12", VLC_CODEC_NV12, VLC_CODEC_NV12,
+      Copy420_SP_to_SP, NULL, 0 },
+    { "copy_i420_to_i420", VLC_CODEC_I420, VLC_CODEC_I420,
+      Copy420_P_to_P, NULL, 0 },
+    { "copy_i420_to_nv12", VLC_CODEC_I420, VLC_CODEC_NV12,
+      Copy420_P_to_SP, NULL, 0 },
+    { "copy_p010_to_i42010l", VLC_CODEC_P010, VLC_CODEC_I420_10L,
+      NULL, Copy420_16_SP_to_P, 6 },
+    { "copy_i42010l_to_p010", VLC_CODEC_I420_10L, VLC_CODEC_P010,
+      NULL, Copy420_16_P_to_SP, -6 },
+};
+
+static picture_t *new_picture(vlc_fourcc_t chroma, unsigned width,
+                              unsigned height)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, 0);
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+    return picture_NewFromFormat(&fmt);
+}
+
+static void run_copy(size_t c, picture_t *dst, const picture_t *src,
+                     const copy_cache_t *cache)
+{
+    const uint8_t *planes[3] = { NULL, NULL, NULL };
+    size_t pitches[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < src->i_planes; i++)
+    {
+        planes[i] = src->p[i].p_pixels;
+        pitches[i] = src->p[i].i_pitch;
+    }
+
+    if (copies[c].copy != NULL)
+        copies[c].copy(dst, planes, pitches, src->format.i_visible_height,
+                       cache);
+    else
+        copies[c].copy16(dst, planes, pitches, src->format.i_visible_height,
+                         copies[c].bitshift, cache);
+}
+
+static bool compare_pictures(const picture_t *ref, const picture_t *dst)
+{
+    for (int i = 0; i < ref->i_planes; i++)
+    {
+        const plane_t *a = &ref->p[i], *b = &dst->p[i];
+
+        for (int y = 0; y < a->i_visible_lines; y++)
+            if (memcmp(&a->p_pixels[y * a->i_pitch],
+                       &b->p_pixels[y * b->i_pitch], a->i_visible_pitch))
+            {
+                checkasm_fail("%ux%u: plane %d differs at line %d",
+                              ref->format.i_width, ref->format.i_height,
+                              i, y);
+                return false;
+            }
+    }
+    return true;
+}
+
+static const unsigned sizes[][2] = {
+    { 2, 2 }, { 18, 6 }, { 66, 40 }, { 562, 370 }, { 1274, 722 },
+    { 1920, 1080 }, /* the last one is benchmarked */
+};
+#define NB_SIZES ARRAY_SIZE(sizes)
+
+static void check_level(size_t c, picture_t *const srcs[],
+                        picture_t *const refs[], const copy_cache_t *cache)
+{
+    for (size_t s = 0; s < NB_SIZES; s++)
+    {
+        picture_t *dst = new_picture(copies[c].dst, sizes[s][0], sizes[s][1]);
+        if (dst == NULL)
+            continue;
+
+        run_copy(c, dst, srcs[s], cache);
+        compare_pictures(refs[s], dst);
+        if (s == NB_SIZES - 1)
+            checkasm_bench(run_copy(c, dst, srcs[s], cache));
+        picture_Release(dst);
+    }
+}
+
+static void check_copy(size_t c)
+{
+    picture_t *srcs[NB_SIZES] = { NULL }, *refs[NB_SIZES] = { NULL };
+    copy_cache_t cache;
+
+    if (CopyInitCache(&cache, 2 * sizes[NB_SIZES - 1][0]) != VLC_SUCCESS)
+        return;
+
+    /* the reference: every optional extension masked */
+    unsigned flags = 0;
+    for (size_t l = 0; l < ARRAY_SIZE(levels); l++)
+        flags |= levels[l].flags;
+    cpu_mask = ~flags;
+
+    for (size_t s = 0; s < NB_SIZES; s++)
+    {
+        srcs[s] = new_picture(copies[c].src, sizes[s][0], sizes[s][1]);
+        refs[s] = new_picture(copies[c].dst, sizes[s][0], sizes[s][1]);
+        if (srcs[s] == NULL || refs[s] == NULL)
+            goto out;
+
+        for (int i = 0; i < srcs[s]->i_planes; i++)
+            checkasm_random(srcs[s]->p[i].p_pixels,
+                            srcs[s]->p[i].i_pitch * srcs[s]->p[i].i_lines);
+        run_copy(c, refs[s], srcs[s], &cache);
+    }
+
+    if (checkasm_impl("c", true))
+        check_level(c, srcs, refs, &cache);
+
+    /* unmask the extensions one by one, from the oldest */
+    for (size_t l = ARRAY_SIZE(levels); l-- > 0;)
+    {
+        cpu_mask |= levels[l].flags;
+        if (checkasm_impl(levels[l].name, (vlc_CPU() & levels[l].flags) != 0))
+            check_level(c, srcs, refs, &cache);
+    }
+out:
+    cpu_mask = ~0u;
+    for (size_t s = 0; s < NB_SIZES; s++)
+    {
+        if (refs[s] != NULL)
+            picture_Release(refs[s]);
+        if (srcs[s] != NULL)
+            picture_Release(srcs[s]);
+    }
+    CopyCleanCache(&cache);
+}
+
+void checkasm_check_copy(void)
+{
+    for (size_t c = 0; c < ARRAY_SIZE(copies); c++)
+    {
+        checkasm_begin(copies[c].name);
+        check_copy(c);
+        checkasm_end();
+    }
+}
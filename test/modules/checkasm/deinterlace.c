@@ -0,0 +1,386 @@
+/*****************************************************************************
+ * deinterlace.c: checkasm suite for the deinterlacer kernels
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../modules/video_filter/deinterlace/common.h"
+#include "../modules/video_filter/deinterlace/merge.h"
+#include "../modules/video_filter/deinterlace/line_filters.h"
+#include "../modules/video_filter/deinterlace/yadif.h"
+#include "../modules/video_filter/deinterlace/bwdif.h"
+#include "checkasm.h"
+
+/*****************************************************************************
+ * Merge
+ *****************************************************************************/
+typedef void (*merge_t)(void *, const void *, const void *, size_t);
+
+static const struct
+{
+    const char *name;
+    merge_t merge8;
+    merge_t merge16;
+} merges[] = {
+    { "c", Merge8BitGeneric, Merge16BitGeneric },
+#if defined(CAN_COMPILE_C_ALTIVEC)
+    { "altivec", MergeAltivec, NULL },
+#endif
+#if defined(CAN_COMPILE_SSE2)
+    { "sse2", Merge8BitSSE2, Merge16BitSSE2 },
+#endif
+#if defined(CAN_COMPILE_ARM)
+    { "neon", merge8_arm_neon, merge16_arm_neon },
+    { "armv6", merge8_armv6, merge16_armv6 },
+#endif
+#if defined(CAN_COMPILE_SVE)
+    { "sve", merge8_arm_sve, merge16_arm_sve },
+#endif
+#if defined(CAN_COMPILE_ARM64)
+    { "neon", merge8_arm64_neon, merge16_arm64_neon },
+#endif
+};
+
+static bool merge_available(const char *name)
+{
+#if defined(CAN_COMPILE_C_ALTIVEC)
+    if (!strcmp(name, "altivec"))
+        return vlc_CPU_ALTIVEC();
+#endif
+#if defined(CAN_COMPILE_SSE2)
+    if (!strcmp(name, "sse2"))
+        return vlc_CPU_SSE2();
+#endif
+#if defined(__arm__) || defined(__aarch64__)
+    if (!strcmp(name, "neon"))
+        return vlc_CPU_ARM_NEON();
+#endif
+#if defined(CAN_COMPILE_ARM)
+    if (!strcmp(name, "armv6"))
+        return vlc_CPU_ARMv6();
+#endif
+#if defined(CAN_COMPILE_SVE)
+    if (!strcmp(name, "sve"))
+        return vlc_CPU_ARM_SVE();
+#endif
+    return true;
+}
+
+static void merge_end(const char *name)
+{
+#if defined(CAN_COMPILE_SSE2)
+    if (!strcmp(name, "sse2"))
+        EndSSE();
+#else
+    (void) name;
+#endif
+}
+
+#define MERGE_SIZE 4096
+#define MERGE_ALIGN 64
+
+static void check_merge(bool b16)
+{
+    uint8_t *s1 = aligned_alloc(MERGE_ALIGN, MERGE_SIZE + MERGE_ALIGN);
+    uint8_t *s2 = aligned_alloc(MERGE_ALIGN, MERGE_SIZE + MERGE_ALIGN);
+    uint8_t *ref = aligned_alloc(MERGE_ALIGN, MERGE_SIZE + MERGE_ALIGN);
+    uint8_t *dst = aligned_alloc(MERGE_ALIGN, MERGE_SIZE + MERGE_ALIGN);
+    if (s1 == NULL || s2 == NULL || ref == NULL || dst == NULL)
+        goto out;
+
+    checkasm_random(s1, MERGE_SIZE + MERGE_ALIGN);
+    checkasm_random(s2, MERGE_SIZE + MERGE_ALIGN);
+
+    for (size_t m = 0; m < ARRAY_SIZE(merges); m++)
+    {
+        merge_t merge = b16 ? merges[m].merge16 : merges[m].merge8;
+
+        if (merge == NULL
+         || !checkasm_impl(merges[m].name, merge_available(merges[m].name)))
+            continue;
+
+        for (unsigned iter = 0; iter < 256; iter++)
+        {
+            /* the pixels may not be aligned, and any size is allowed */
+            size_t off = (checkasm_rand() % MERGE_ALIGN) & ~(size_t)b16;
+            size_t size = (1 + checkasm_rand() % MERGE_SIZE) & ~(size_t)b16;
+            if (size == 0)
+                size = 2;
+
+            memset(ref, 0xAA, MERGE_SIZE + MERGE_ALIGN);
+            memset(dst, 0xAA, MERGE_SIZE + MERGE_ALIGN);
+            (b16 ? Merge16BitGeneric : Merge8BitGeneric)(ref + off, s1 + off,
+                                                         s2 + off, size);
+            merge(dst + off, s1 + off, s2 + off, size);
+            merge_end(merges[m].name);
+
+            for (size_t i = 0; i < MERGE_SIZE + MERGE_ALIGN; i += 1 + b16)
+            {
+                int a = b16 ? *(uint16_t *)&ref[i] : ref[i];
+                int b = b16 ? *(uint16_t *)&dst[i] : dst[i];
+                bool inside = i >= off && i < off + size;
+
+                /* the SIMD averages round up, the C code rounds down */
+                if (inside ? (b < a || b > a + 1) : a != b)
+                {
+                    checkasm_fail("offset %zu, size %zu: 0x%x instead of 0x%x"
+                                  " at %zu", off, size, b, a, i);
+                    break;
+                }
+            }
+        }
+
+        checkasm_bench(merge(dst, s1, s2, MERGE_SIZE));
+        merge_end(merges[m].name);
+    }
+out:
+    free(dst);
+    free(ref);
+    free(s2);
+    free(s1);
+}
+
+/*****************************************************************************
+ * Yadif and Bwdif line filters
+ *****************************************************************************/
+typedef void (*yadif_line_t)(uint8_t *, uint8_t *, uint8_t *, uint8_t *, int,
+                             int, int, int, int);
+
+static const struct
+{
+    const char *name;
+    yadif_line_t line8;
+    yadif_line_t line16;
+    bwdif_filter_line_t bwdif8;
+    bwdif_filter_line_t bwdif16;
+} line_filters[] = {
+    { "c", yadif_filter_line_c, yadif_filter_line_c_16bit,
+      bwdif_filter_line_c, bwdif_filter_line_c_16bit },
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+    { "avx2", yadif_filter_line_avx2, yadif_filter_line_16bit_avx2,
+      bwdif_filter_line_avx2, bwdif_filter_line_16bit_avx2 },
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+    { "neon", yadif_filter_line_neon, yadif_filter_line_16bit_neon,
+      bwdif_filter_line_neon, bwdif_filter_line_16bit_neon },
+#endif
+};
+
+static bool line_filter_available(const char *name)
+{
+#if defined(CAN_COMPILE_LINE_FILTERS_AVX2)
+    if (!strcmp(name, "avx2"))
+        return vlc_CPU_AVX2();
+#endif
+#if defined(CAN_COMPILE_LINE_FILTERS_NEON)
+    if (!strcmp(name, "neon"))
+        return vlc_CPU_ARM_NEON();
+#endif
+    (void) name;
+    return true;
+}
+
+/* 9 lines of samples, with margins for the horizontal neighbours */
+#define LINE_WIDTH 1920
+#define LINE_MARGIN 32
+#define LINE_PITCH (2 * (LINE_WIDTH + 2 * LINE_MARGIN))
+#define LINE_COUNT 9
+#define PLANE_SIZE (LINE_PITCH * LINE_COUNT)
+
+struct lines
+{
+    uint8_t *prev, *cur, *next, *ref, *dst;
+};
+
+static void fill_lines(struct lines *l, bool b16, unsigned bits)
+{
+    checkasm_random(l->prev, PLANE_SIZE);
+    checkasm_random(l->cur, PLANE_SIZE);
+    checkasm_random(l->next, PLANE_SIZE);
+
+    if (b16)
+    {
+        const uint16_t mask = (1 << bits) - 1;
+        for (size_t i = 0; i < PLANE_SIZE; i += 2)
+        {
+            *(uint16_t *)&l->prev[i] &= mask;
+            *(uint16_t *)&l->cur[i] &= mask;
+            *(uint16_t *)&l->next[i] &= mask;
+        }
+    }
+
+    /* smooth areas exercise the temporal predictions */
+    if (checkasm_rand() & 1)
+    {
+        memcpy(l->prev, l->cur, PLANE_SIZE / 2);
+        memcpy(l->next, l->cur, PLANE_SIZE / 2);
+    }
+}
+
+static bool compare_lines(const struct lines *l, size_t size, int w)
+{
+    const uint8_t *ref = l->ref + (LINE_COUNT / 2) * LINE_PITCH;
+    const uint8_t *dst = l->dst + (LINE_COUNT / 2) * LINE_PITCH;
+
+    if (memcmp(ref, dst, LINE_PITCH) == 0)
+        return true;
+
+    for (int x = 0; x < LINE_PITCH / (int)size; x++)
+    {
+        int a = size == 2 ? ((const uint16_t *)ref)[x] : ref[x];
+        int b = size == 2 ? ((const uint16_t *)dst)[x] : dst[x];
+        if (a != b)
+        {
+            checkasm_fail("width %d: %d instead of %d at %d", w, b, a,
+                          x - LINE_MARGIN);
+            break;
+        }
+    }
+    return false;
+}
+
+static void run_bwdif(bwdif_filter_line_t fn, uint8_t *dst,
+                      const struct lines *l, size_t start, int w, int refs,
+                      int parity, int clip_max)
+{
+    fn(dst + start, l->prev + start, l->cur + start, l->next + start, w,
+       refs, -refs, 2 * refs, -2 * refs, 3 * refs, -3 * refs, 4 * refs,
+       -4 * refs, parity, clip_max);
+}
+
+static void check_line_filters(bool bwdif, bool b16)
+{
+    struct lines l = {
+        .prev = malloc(PLANE_SIZE), .cur = malloc(PLANE_SIZE),
+        .next = malloc(PLANE_SIZE), .ref = malloc(PLANE_SIZE),
+        .dst = malloc(PLANE_SIZE),
+    };
+    if (l.prev == NULL || l.cur == NULL || l.next == NULL || l.ref == NULL
+     || l.dst == NULL)
+        goto out;
+
+    const size_t size = b16 ? 2 : 1;
+    /* the 16-bit SIMD yadif need headroom, see GetFilterLine() */
+    const unsigned bits = b16 ? 12 : 8;
+    const int clip_max = (1 << bits) - 1;
+    const size_t start = (LINE_COUNT / 2) * LINE_PITCH + LINE_MARGIN * size;
+    const int refs = LINE_PITCH / size;
+
+    for (size_t f = 0; f < ARRAY_SIZE(line_filters); f++)
+    {
+        if (!checkasm_impl(line_filters[f].name,
+                           line_filter_available(line_filters[f].name)))
+            continue;
+
+        for (unsigned iter = 0; iter < 64; iter++)
+        {
+            int w = 1 + checkasm_rand() % LINE_WIDTH;
+            int parity = checkasm_rand() & 1;
+
+            fill_lines(&l, b16, bits);
+            memset(l.ref, 0, PLANE_SIZE);
+            memset(l.dst, 0, PLANE_SIZE);
+
+            if (bwdif)
+            {
+                bwdif_filter_line_t ref = b16 ? bwdif_filter_line_c_16bit
+                                              : bwdif_filter_line_c;
+                bwdif_filter_line_t fn = b16 ? line_filters[f].bwdif16
+                                             : line_filters[f].bwdif8;
+                /* the references are in samples */
+                run_bwdif(ref, l.ref, &l, start, w, refs, parity, clip_max);
+                run_bwdif(fn, l.dst, &l, start, w, refs, parity, clip_max);
+            }
+            else
+            {
+                yadif_line_t ref = b16 ? yadif_filter_line_c_16bit
+                                       : yadif_filter_line_c;
+                yadif_line_t fn = b16 ? line_filters[f].line16
+                                      : line_filters[f].line8;
+                int mode = (checkasm_rand() & 1) ? 0 : 2;
+
+                /* the references are in bytes */
+                ref(l.ref + start, l.prev + start, l.cur + start,
+                    l.next + start, w, LINE_PITCH, -LINE_PITCH, parity, mode);
+                fn(l.dst + start, l.prev + start, l.cur + start,
+                   l.next + start, w, LINE_PITCH, -LINE_PITCH, parity, mode);
+            }
+
+            if (!compare_lines(&l, size, w))
+                break;
+        }
+
+        if (bwdif)
+        {
+            bwdif_filter_line_t fn = b16 ? line_filters[f].bwdif16
+                                         : line_filters[f].bwdif8;
+            checkasm_bench(run_bwdif(fn, l.dst, &l, start, LINE_WIDTH, refs, 0,
+                                     clip_max));
+        }
+        else
+        {
+            yadif_line_t fn = b16 ? line_filters[f].line16
+                                  : line_filters[f].line8;
+            checkasm_bench(fn(l.dst + start, l.prev + start, l.cur + start,
+                              l.next + start, LINE_WIDTH, LINE_PITCH,
+                              -LINE_PITCH, 0, 0));
+        }
+    }
+out:
+    free(l.dst);
+    free(l.ref);
+    free(l.next);
+    free(l.cur);
+    free(l.prev);
+}
+
+void checkasm_check_deinterlace(void)
+{
+    checkasm_begin("deinterlace_merge8");
+    check_merge(false);
+    checkasm_end();
+
+    checkasm_begin("deinterlace_merge16");
+    check_merge(true);
+    checkasm_end();
+
+    checkasm_begin("deinterlace_yadif8");
+    check_line_filters(false, false);
+    checkasm_end();
+
+    checkasm_begin("deinterlace_yadif16");
+    check_line_filters(false, true);
+    checkasm_end();
+
+    checkasm_begin("deinterlace_bwdif8");
+    check_line_filters(true, false);
+    checkasm_end();
+
+    checkasm_begin("deinterlace_bwdif16");
+    check_line_filters(true, true);
+    checkasm_end();
+}
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * startcode.c: checkasm suite for the packetizer start code scans
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "checkasm.h"
+
+typedef const uint8_t *(*find_pattern_t)(const uint8_t *, const uint8_t *,
+                                         uint8_t);
+
+static const struct
+{
+    const char *name;
+    find_pattern_t find;
+} finders[] = {
+    { "c", startcode_FindPattern_Bits },
+#ifdef CAN_COMPILE_SSE2
+    { "sse2", startcode_FindPattern_SSE2 },
+#endif
+#ifdef CAN_COMPILE_AVX2
+    { "avx2", startcode_FindPattern_AVX2 },
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+    { "neon", startcode_FindPattern_NEON },
+#endif
+};
+
+static bool finder_available(size_t i)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (finders[i].find == startcode_FindPattern_SSE2)
+        return vlc_CPU_SSE2();
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if (finders[i].find == startcode_FindPattern_AVX2)
+        return vlc_CPU_AVX2();
+#endif
+    (void) i;
+    return true;
+}
+
+static const uint8_t *find_ref(const uint8_t *p, const uint8_t *end, uint8_t c)
+{
+    for (; end - p >= 3; p++)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    return NULL;
+}
+
+/* Random bytes, with runs of zeros and codes dense enough to hit every
+ * branch of the scans */
+static void fill_dense(uint8_t *buf, size_t size, uint8_t c)
+{
+    checkasm_random(buf, size);
+    for (size_t i = 0; i < size; i++)
+    {
+        unsigned r = buf[i] & 7;
+        if (r < 4)
+            buf[i] = 0;
+        else if (r == 4)
+            buf[i] = c;
+    }
+}
+
+#define BUF_SIZE 512
+#define BENCH_SIZE (1 << 20)
+
+static void check_pattern(uint8_t c)
+{
+    uint8_t *buf = malloc(BUF_SIZE);
+    uint8_t *bench = checkasm_benchmark ? malloc(BENCH_SIZE) : NULL;
+    if (buf == NULL)
+        goto out;
+
+    if (bench != NULL)
+    {
+        /* typical payload: no start code, a few pairs of zeros */
+        checkasm_random(bench, BENCH_SIZE);
+        for (size_t i = 2; i < BENCH_SIZE; i++)
+            if (bench[i - 2] == 0 && bench[i - 1] == 0 && bench[i] == c)
+                bench[i] = 0xff;
+    }
+
+    for (size_t f = 0; f < ARRAY_SIZE(finders); f++)
+    {
+        if (!checkasm_impl(finders[f].name, finder_available(f)))
+            continue;
+
+        for (unsigned iter = 0; iter < 64; iter++)
+        {
+            size_t len = checkasm_rand() % BUF_SIZE;
+            size_t off = checkasm_rand() % (BUF_SIZE - len + 1);
+            const uint8_t *end = buf + off + len;
+
+            fill_dense(buf, BUF_SIZE, c);
+
+            /* every match, as the packetizers scan them */
+            for (const uint8_t *p = buf + off, *q = p;; p++, q++)
+            {
+                p = find_ref(p, end, c);
+                q = finders[f].find(q, end, c);
+                if (p != q)
+                {
+                    checkasm_fail("offset %zu, length %zu: %td instead of %td",
+                                  off, len, q ? q - buf : -1,
+                                  p ? p - buf : -1);
+                    break;
+                }
+                if (p == NULL)
+                    break;
+            }
+        }
+
+        if (bench != NULL)
+            checkasm_bench(finders[f].find(bench, bench + BENCH_SIZE, c));
+    }
+out:
+    free(bench);
+    free(buf);
+}
+
+void checkasm_check_startcode(void)
+{
+    checkasm_begin("startcode_annexb");
+    check_pattern(0x01);
+    checkasm_end();
+
+    checkasm_begin("startcode_ep3b");
+    check_pattern(0x03);
+    checkasm_end();
+}
@@ -37,16 +37,18 @@ struct results_s
     size_t size;
 };
 
+typedef const uint8_t *(*pf_find_pattern_t)(const uint8_t *, const uint8_t *, uint8_t);
+
 static int check_set( const uint8_t *p_set, const uint8_t *p_end,
                       const struct results_s *p_results, size_t i_results,
-                      ssize_t i_results_offset,
-                      const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *))
+                      ssize_t i_results_offset, uint8_t i_code,
+                      pf_find_pattern_t pf_find )
 {
     const uint8_t *p = p_set;
     size_t i_entry = 0;
     while( p != NULL )
     {
-        p = pf_find( p, p_end );
+        p = pf_find( p, p_end, i_code );
         if( p == NULL )
             break;
         printf("- entry %zu offset %ld\n", i_entry, p - p_set);
@@ -64,32 +66,68 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
-static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
-                            const struct results_s *p_results, size_t i_results,
-                            ssize_t i_results_offset )
+static int run_pattern_sets( const uint8_t *p_set, const uint8_t *p_end,
+                             const struct results_s *p_results, size_t i_results,
+                             ssize_t i_results_offset, uint8_t i_code )
 {
-    int i_ret;
-
-    printf("checking bits code:\n");
-    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                       startcode_FindAnnexB_Bits );
-    if( i_ret != 0 )
-        return i_ret;
+    const struct
+    {
+        const char *psz_name;
+        pf_find_pattern_t pf_find;
+        bool b_available;
+    } finders[] = {
+        { "bits", startcode_FindPattern_Bits, true },
+#ifdef CAN_COMPILE_SSE2
+        { "sse2", startcode_FindPattern_SSE2, vlc_CPU_SSE2() },
+#endif
+#ifdef CAN_COMPILE_AVX2
+        { "avx2", startcode_FindPattern_AVX2, vlc_CPU_AVX2() },
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+        { "neon", startcode_FindPattern_NEON, true },
+#endif
+        { "default", startcode_FindPattern, true },
+    };
 
-    /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
     {
-        printf("checking asm:\n");
-        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+        if( !finders[i].b_available )
+        {
+            printf("%s not supported, skipping test:\n", finders[i].psz_name);
+            continue;
+        }
+        printf("checking %s code:\n", finders[i].psz_name);
+        int i_ret = check_set( p_set, p_end, p_results, i_results,
+                               i_results_offset, i_code, finders[i].pf_find );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
 
     return 0;
 }
 
+static int run_extended_sets( const uint8_t *p_set, size_t i_set,
+                              const struct results_s *p_results, size_t i_results,
+                              uint8_t i_code )
+{
+    uint8_t *p_data = malloc( 4096 );
+    if( !p_data )
+        return 0;
+
+    int i_ret = 0;
+    /* every alignment and distance to the end of the buffer */
+    for( size_t i_tail = 0; i_tail < 80 && i_ret == 0; i_tail++ )
+    {
+        const ssize_t i_dataoffset = 4096 - i_set - i_tail;
+        memset( p_data, 0x42, 4096 );
+        memcpy( &p_data[i_dataoffset], p_set, i_set );
+        i_ret = run_pattern_sets( p_data, p_data + 4096,
+                                  p_results, i_results, i_dataoffset, i_code );
+    }
+    free( p_data );
+    return i_ret;
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -111,28 +149,43 @@ int main( void )
                                        };
 
     printf("* Running tests on set 1:\n");
-    int i_ret = run_annexb_sets( test1_annexbdata,
-                                 test1_annexbdata + sizeof(test1_annexbdata),
-                                 test1_results, ARRAY_SIZE(test1_results), 0 );
+    int i_ret = run_pattern_sets( test1_annexbdata,
+                                  test1_annexbdata + sizeof(test1_annexbdata),
+                                  test1_results, ARRAY_SIZE(test1_results), 0, 0x01 );
     if( i_ret != 0 )
         return i_ret;
 
-    uint8_t *p_data = malloc( 4096 );
-    if( p_data )
-    {
-        const ssize_t i_dataoffset = 4096 - sizeof(test1_annexbdata) - 111;
-        memset( p_data, 0x42, 4096 );
-        memcpy( &p_data[i_dataoffset],
-                test1_annexbdata, sizeof(test1_annexbdata) );
-        printf("* Running tests on extended set 1:\n");
-        i_ret = run_annexb_sets( p_data,
-                                 p_data + 4096,
-                                 test1_results, ARRAY_SIZE(test1_results),
-                                 i_dataoffset );
-        free( p_data );
-        if( i_ret != 0 )
-            return i_ret;
-    }
+    printf("* Running tests on extended set 1:\n");
+    i_ret = run_extended_sets( test1_annexbdata, sizeof(test1_annexbdata),
+                               test1_results, ARRAY_SIZE(test1_results), 0x01 );
+    if( i_ret != 0 )
+        return i_ret;
+
+    const uint8_t test2_ep3bdata[] = { 0x65, 0, 0, 3, 1, 0x55, 0, 0, 1, // 9
+                                       0, 3, 0, 0, 3, 0, 0, 3, // 17
+                                       0x22, 0, 0, 0, 3, //22
+                                       0, 0, 3,
+                                     };
+    const struct results_s test2_results[] = {
+                                        { 1,  3 },
+                                        { 11, 3 },
+                                        { 14, 3 },
+                                        { 19, 3 },
+                                        { 22, 3 },
+                                       };
+
+    printf("* Running emulation prevention tests on set 2:\n");
+    i_ret = run_pattern_sets( test2_ep3bdata,
+                              test2_ep3bdata + sizeof(test2_ep3bdata),
+                              test2_results, ARRAY_SIZE(test2_results), 0, 0x03 );
+    if( i_ret != 0 )
+        return i_ret;
+
+    printf("* Running emulation prevention tests on extended set 2:\n");
+    i_ret = run_extended_sets( test2_ep3bdata, sizeof(test2_ep3bdata),
+                               test2_results, ARRAY_SIZE(test2_results), 0x03 );
+    if( i_ret != 0 )
+        return i_ret;
 
     return 0;
 }
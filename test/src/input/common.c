@@ -41,9 +41,12 @@ void vlc_run_args_init(struct vlc_run_args *args)
 
     args->name = getenv("VLC_TARGET");
     args->test_demux_controls = getenv_atoi("VLC_DEMUX_CONTROLS");
+    args->discard_es = getenv_atoi("VLC_DISCARD_ES");
 }
 
-libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
+libvlc_instance_t *libvlc_create_with_options(const struct vlc_run_args *args,
+                                              int argc,
+                                              const char *const *argv)
 {
 #ifdef TOP_BUILDDIR
 # ifndef HAVE_STATIC_MODULES
@@ -52,24 +55,36 @@ libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
     setenv("VLC_DATA_PATH", TOP_SRCDIR"/share", 1);
 #endif
 
-    /* Override argc/argv with "--verbose lvl" or "--quiet" depending on the V
-     * environment variable */
-    const char *argv[2];
+    /* Prepend "--verbose lvl" or "--quiet" depending on the V environment
+     * variable to the options */
+    const char **vlc_argv = malloc((argc + 2) * sizeof (*vlc_argv));
+    if (vlc_argv == NULL)
+        return NULL;
+
     char verbose[2];
-    int argc = args->verbose == 0 ? 1 : 2;
+    int vlc_argc = 0;
 
     if (args->verbose > 0)
     {
-        argv[0] = "--verbose";
+        vlc_argv[vlc_argc++] = "--verbose";
         sprintf(verbose, "%u", args->verbose);
-        argv[1] = verbose;
+        vlc_argv[vlc_argc++] = verbose;
     }
     else
-        argv[0] = "--quiet";
+        vlc_argv[vlc_argc++] = "--quiet";
 
-    libvlc_instance_t *vlc = libvlc_new(argc, argv);
+    for (int i = 0; i < argc; i++)
+        vlc_argv[vlc_argc++] = argv[i];
+
+    libvlc_instance_t *vlc = libvlc_new(vlc_argc, vlc_argv);
     if (vlc == NULL)
         fprintf(stderr, "Error: cannot initialize LibVLC.\n");
 
+    free(vlc_argv);
     return vlc;
 }
+
+libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
+{
+    return libvlc_create_with_options(args, 0, NULL);
+}
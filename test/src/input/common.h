@@ -26,6 +26,16 @@
 #define debug(...) (void)0
 #endif
 
+/* counters filled while processing, see vlc_run_args.stats */
+struct vlc_run_stats
+{
+    uint64_t demux_calls;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t frames; /* decoded pictures, audio buffers and subpictures */
+    uint64_t decode_cpu_ns; /* CPU time spent in the decoders */
+};
+
 struct vlc_run_args
 {
     /* force specific target name (demux or decoder name). NULL to don't force
@@ -37,8 +47,17 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* true to drop the ES output instead of decoding it */
+    bool discard_es;
+
+    /* statistics to update, or NULL */
+    struct vlc_run_stats *stats;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
 
 libvlc_instance_t *libvlc_create(const struct vlc_run_args *args);
+libvlc_instance_t *libvlc_create_with_options(const struct vlc_run_args *args,
+                                              int argc,
+                                              const char *const *argv);
@@ -43,6 +43,7 @@ struct decoder_owner
 {
     decoder_t dec;
     decoder_t *packetizer;
+    size_t frames; /**< pictures, audio buffers and subpictures output */
 };
 
 static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
@@ -66,13 +67,13 @@ static vlc_decoder_device * get_no_device( decoder_t *dec )
 
 static void queue_video(decoder_t *dec, picture_t *pic)
 {
-    (void) dec;
+    dec_get_owner(dec)->frames++;
     picture_Release(pic);
 }
 
 static void queue_audio(decoder_t *dec, block_t *p_block)
 {
-    (void) dec;
+    dec_get_owner(dec)->frames++;
     block_Release(p_block);
 }
 static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *desc)
@@ -82,7 +83,7 @@ static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *
 }
 static void queue_sub(decoder_t *dec, subpicture_t *p_subpic)
 {
-    (void) dec;
+    dec_get_owner(dec)->frames++;
     subpicture_Delete(p_subpic);
 }
 
@@ -139,6 +140,7 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     }
     decoder = &owner->dec;
     owner->packetizer = packetizer;
+    owner->frames = 0;
 
     static const struct decoder_owner_callbacks dec_video_cbs =
     {
@@ -260,3 +262,8 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
         decoder->pf_decode(decoder, NULL);
     return VLC_SUCCESS;
 }
+
+size_t test_decoder_frames(decoder_t *decoder)
+{
+    return dec_get_owner(decoder)->frames;
+}
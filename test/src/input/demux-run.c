@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include <vlc_common.h>
 #include <vlc_access.h>
@@ -53,7 +54,9 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    struct vlc_run_stats *stats;
 #ifdef HAVE_DECODERS
+    bool discard;
     vlc_object_t *parent;
 #endif
 };
@@ -67,6 +70,17 @@ struct es_out_id_t
 #endif
 };
 
+#ifdef HAVE_DECODERS
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return 0;
+    return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+#endif
+
 static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t* in, const es_format_t *fmt)
 {
     (void)in;
@@ -82,10 +96,14 @@ static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t* in, const es_format_
     id->next = ctx->ids;
     ctx->ids = id;
 #ifdef HAVE_DECODERS
-    es_format_Copy(&id->fmt, fmt);
-    id->decoder = test_decoder_create(ctx->parent, &id->fmt);
-    if (id->decoder == NULL)
-        es_format_Clean(&id->fmt);
+    id->decoder = NULL;
+    if (!ctx->discard)
+    {
+        es_format_Copy(&id->fmt, fmt);
+        id->decoder = test_decoder_create(ctx->parent, &id->fmt);
+        if (id->decoder == NULL)
+            es_format_Clean(&id->fmt);
+    }
 #endif
 
     debug("[%p] Added   ES\n", (void *)id);
@@ -107,25 +125,40 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    if (ctx->stats != NULL)
+    {
+        ctx->stats->blocks++;
+        ctx->stats->bytes += block->i_buffer;
+    }
 #ifdef HAVE_DECODERS
     if (id->decoder)
+    {
+        uint64_t start = ctx->stats != NULL ? thread_cpu_ns() : 0;
+
         test_decoder_process(id->decoder, block);
+        if (ctx->stats != NULL)
+            ctx->stats->decode_cpu_ns += thread_cpu_ns() - start;
+    }
     else
 #endif
         block_Release(block);
     return VLC_SUCCESS;
 }
 
-static void IdDelete(es_out_id_t *id)
+static void IdDelete(struct test_es_out_t *ctx, es_out_id_t *id)
 {
 #ifdef HAVE_DECODERS
     if (id->decoder)
     {
         /* Drain */
         test_decoder_process(id->decoder, NULL);
+        if (ctx->stats != NULL)
+            ctx->stats->frames += test_decoder_frames(id->decoder);
         test_decoder_destroy(id->decoder);
         es_format_Clean(&id->fmt);
     }
+#else
+    (void) ctx;
 #endif
     free(id);
 }
@@ -144,7 +177,7 @@ static void EsOutDelete(es_out_t *out, es_out_id_t *id)
 
     debug("[%p] Deleted ES\n", (void *)id);
     *pp = id->next;
-    IdDelete(id);
+    IdDelete(ctx, id);
 }
 
 static int EsOutControl(es_out_t *out, input_source_t* in, int query, va_list args)
@@ -208,7 +241,7 @@ static void EsOutDestroy(es_out_t *out)
     while ((id = ctx->ids) != NULL)
     {
         ctx->ids = id->next;
-        IdDelete(id);
+        IdDelete(ctx, id);
     }
     free(ctx);
 }
@@ -222,7 +255,8 @@ static const struct es_out_callbacks es_out_cbs =
     .destroy = EsOutDestroy,
 };
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    const struct vlc_run_args *args)
 {
     struct test_es_out_t *ctx = malloc(sizeof (*ctx));
     if (ctx == NULL)
@@ -232,10 +266,12 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->stats = args->stats;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
 #ifdef HAVE_DECODERS
+    ctx->discard = args->discard_es;
     ctx->parent = parent;
 #else
     (void) parent;
@@ -290,7 +326,7 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), args);
     if (out == NULL)
         return -1;
 
@@ -330,6 +366,9 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    if (args->stats != NULL)
+        args->stats->demux_calls += i;
+
     demux_Delete(demux);
     es_out_Delete(out);
 
@@ -338,17 +377,23 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     return val == VLC_DEMUXER_EOF ? 0 : -1;
 }
 
+int libvlc_demux_process_url(libvlc_instance_t *vlc,
+                             const struct vlc_run_args *args, const char *url)
+{
+    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(vlc->p_libvlc_int), url);
+    if (s == NULL)
+        fprintf(stderr, "Error: cannot create input stream: %s\n", url);
+
+    return demux_process_stream(args, s);
+}
+
 int vlc_demux_process_url(const struct vlc_run_args *args, const char *url)
 {
     libvlc_instance_t *vlc = libvlc_create(args);
     if (vlc == NULL)
         return -1;
 
-    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(vlc->p_libvlc_int), url);
-    if (s == NULL)
-        fprintf(stderr, "Error: cannot create input stream: %s\n", url);
-
-    int ret = demux_process_stream(args, s);
+    int ret = libvlc_demux_process_url(vlc, args, url);
     libvlc_release(vlc);
     return ret;
 }
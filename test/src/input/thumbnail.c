@@ -208,6 +208,74 @@ static void test_cancel_thumbnail( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+#define BATCH_COUNT 3
+
+struct test_batch_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t next_idx;
+};
+
+static void thumbnailer_callback_batch( void* data, size_t index,
+                                        picture_t* p_thumbnail )
+{
+    struct test_batch_ctx* p_ctx = data;
+    assert( p_thumbnail != NULL );
+    assert( p_thumbnail->format.i_chroma == VLC_CODEC_ARGB );
+    /* The mock video is 640x480, scaled down to fit in 64x64 */
+    assert( p_thumbnail->format.i_visible_width <= 64 );
+    assert( p_thumbnail->format.i_visible_height <= 64 );
+
+    vlc_mutex_lock( &p_ctx->lock );
+    assert( index == p_ctx->next_idx && "Unexpected thumbnail order" );
+    p_ctx->next_idx++;
+    vlc_mutex_unlock( &p_ctx->lock );
+    vlc_cond_signal( &p_ctx->cond );
+}
+
+static void test_batch_thumbnails( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    struct test_batch_ctx ctx;
+    ctx.next_idx = 0;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;audio_track_count=1"
+                   ";length=%" PRId64 ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    static const vlc_tick_t times[BATCH_COUNT] = {
+        VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 30 ),
+    };
+
+    vlc_mutex_lock( &ctx.lock );
+    int res = 0;
+    vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestBatchByTime(
+        p_thumbnailer, times, BATCH_COUNT, VLC_THUMBNAILER_SEEK_FAST, 64, 64,
+        p_item, VLC_TICK_FROM_SEC( 1 ), thumbnailer_callback_batch, &ctx );
+    assert( p_req != NULL );
+    while ( ctx.next_idx < BATCH_COUNT )
+    {
+        vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 2 );
+        res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+        assert( res != ETIMEDOUT );
+    }
+    vlc_mutex_unlock( &ctx.lock );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 int main()
 {
     test_init();
@@ -221,6 +289,7 @@ int main()
 
     test_thumbnails( vlc );
     test_cancel_thumbnail( vlc );
+    test_batch_thumbnails( vlc );
 
     libvlc_release( vlc );
 }
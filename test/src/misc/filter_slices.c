@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * filter_slices.c: test for filter_ExecuteSlices()
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+
+#define LINES 1000
+#define MAX_SLICES 64
+
+struct slices
+{
+    atomic_uint calls[MAX_SLICES];
+    atomic_uint count;
+    atomic_uchar lines[LINES];
+};
+
+static void Slice(void *opaque, unsigned slice, unsigned count)
+{
+    struct slices *slices = opaque;
+    int begin, end;
+
+    assert(slice < count);
+    assert(count <= MAX_SLICES);
+    atomic_fetch_add(&slices->calls[slice], 1);
+    atomic_store(&slices->count, count);
+
+    filter_GetSliceLines(LINES, slice, count, &begin, &end);
+    assert(0 <= begin && begin <= end && end <= LINES);
+    for (int i = begin; i < end; i++)
+        atomic_fetch_add(&slices->lines[i], 1);
+}
+
+static void test_slices(filter_t *filter, unsigned max_slices,
+                        unsigned expected)
+{
+    struct slices slices;
+
+    for (unsigned i = 0; i < MAX_SLICES; i++)
+        atomic_init(&slices.calls[i], 0);
+    atomic_init(&slices.count, 0);
+    for (unsigned i = 0; i < LINES; i++)
+        atomic_init(&slices.lines[i], 0);
+
+    filter_ExecuteSlices(filter, max_slices, Slice, &slices);
+
+    unsigned count = atomic_load(&slices.count);
+    assert(count == expected);
+    for (unsigned i = 0; i < MAX_SLICES; i++)
+        assert(atomic_load(&slices.calls[i]) == (i < count));
+    /* Every line belongs to exactly one slice */
+    for (unsigned i = 0; i < LINES; i++)
+        assert(atomic_load(&slices.lines[i]) == 1);
+}
+
+int main(void)
+{
+    static const char *args[] = {
+        "-v", "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--filter-threads=4",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    filter_t *filter = vlc_object_create(vlc->p_libvlc_int, sizeof (*filter));
+    assert(filter != NULL);
+
+    test_log("Testing slices counts\n");
+    test_slices(filter, 0, 1);
+    test_slices(filter, 1, 1);
+    test_slices(filter, 3, 3);
+    test_slices(filter, 4, 4);
+    test_slices(filter, 100, 4);
+
+    test_log("Testing repeated slices\n");
+    for (unsigned i = 0; i < 1000; i++)
+        test_slices(filter, 4, 4);
+
+    vlc_object_delete(filter);
+    libvlc_release(vlc);
+    return 0;
+}
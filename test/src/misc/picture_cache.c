@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * picture_cache.c: test for picture_NewCached()
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+static picture_t *NewPicture(vlc_object_t *obj, unsigned width,
+                             unsigned height)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, width, height, width, height,
+                       1, 1);
+
+    picture_t *pic = picture_NewCached(obj, &fmt);
+    assert(pic != NULL);
+    assert(pic->i_planes == 3);
+    assert(pic->format.i_visible_width == width);
+    /* The buffer must be usable */
+    for (int i = 0; i < pic->i_planes; i++)
+        memset(pic->p[i].p_pixels, i, pic->p[i].i_pitch * pic->p[i].i_lines);
+    return pic;
+}
+
+static void test_reuse(vlc_object_t *obj)
+{
+    struct vlc_picture_cache_stats stats;
+    picture_t *pics[4];
+
+    test_log("Testing buffers reuse\n");
+
+    for (unsigned i = 0; i < 4; i++)
+        pics[i] = NewPicture(obj, 640, 480);
+    for (unsigned i = 0; i < 4; i++)
+        picture_Release(pics[i]);
+
+    picture_GetCacheStats(obj, &stats);
+    assert(stats.misses == 4);
+    assert(stats.hits == 0);
+    /* At most 3 buffers are kept */
+    assert(stats.cached_count == 3);
+    assert(stats.evictions == 1);
+
+    /* Same layout, different visible size */
+    for (unsigned i = 0; i < 3; i++)
+        pics[i] = NewPicture(obj, 630, 470);
+
+    picture_GetCacheStats(obj, &stats);
+    assert(stats.hits == 3);
+    assert(stats.misses == 4);
+    assert(stats.cached_count == 0);
+    assert(stats.cached_size == 0);
+
+    for (unsigned i = 0; i < 3; i++)
+        picture_Release(pics[i]);
+
+    /* Different layout: the old buffers are evicted */
+    for (unsigned i = 0; i < 3; i++)
+        pics[i] = NewPicture(obj, 1280, 720);
+    for (unsigned i = 0; i < 3; i++)
+        picture_Release(pics[i]);
+
+    picture_GetCacheStats(obj, &stats);
+    assert(stats.hits == 3);
+    assert(stats.misses == 7);
+    assert(stats.cached_count == 3);
+    assert(stats.evictions == 4);
+}
+
+static void test_size_limit(vlc_object_t *obj)
+{
+    struct vlc_picture_cache_stats stats, before;
+
+    test_log("Testing cache size limit\n");
+
+    picture_GetCacheStats(obj, &before);
+
+    /* Larger than the whole cache */
+    picture_t *pic = NewPicture(obj, 4096, 2160);
+    picture_Release(pic);
+
+    picture_GetCacheStats(obj, &stats);
+    assert(stats.misses == before.misses + 1);
+    assert(stats.cached_count == before.cached_count);
+    assert(stats.cached_size <= 8 << 20);
+}
+
+static void test_disabled(void)
+{
+    static const char *args[] = {
+        "-v", "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--picture-cache-size=0",
+    };
+    struct vlc_picture_cache_stats stats;
+
+    test_log("Testing disabled cache\n");
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    picture_Release(NewPicture(obj, 640, 480));
+    picture_Release(NewPicture(obj, 640, 480));
+
+    picture_GetCacheStats(obj, &stats);
+    assert(stats.hits == 0 && stats.misses == 0);
+
+    libvlc_release(vlc);
+}
+
+int main(void)
+{
+    static const char *args[] = {
+        "-v", "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--picture-cache-size=8", "--picture-cache-count=3",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    test_reuse(obj);
+    test_size_limit(obj);
+
+    /* Pictures may outlive the instance */
+    picture_t *pic = NewPicture(obj, 640, 480);
+    libvlc_release(vlc);
+    picture_Release(pic);
+
+    test_disabled();
+    return 0;
+}
@@ -444,6 +444,54 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOENT );
 }
 
+static void test_many_and_inherit( libvlc_int_t *p_libvlc )
+{
+    char name[16];
+
+    /* Enough variables to grow the hash table a few times */
+    for( int i = 0; i < 200; i++ )
+    {
+        sprintf( name, "many-%d", i );
+        var_Create( p_libvlc, name, VLC_VAR_INTEGER );
+        var_SetInteger( p_libvlc, name, i );
+    }
+    for( int i = 0; i < 200; i++ )
+    {
+        sprintf( name, "many-%d", i );
+        assert( var_GetInteger( p_libvlc, name ) == i );
+    }
+
+    vlc_object_t *child = vlc_object_create( p_libvlc, sizeof (*child) );
+    assert( child != NULL );
+    assert( var_InheritInteger( child, "many-42" ) == 42 );
+    var_SetInteger( p_libvlc, "many-42", 4242 );
+    assert( var_InheritInteger( child, "many-42" ) == 4242 );
+
+    /* A local variable shadows the inherited one */
+    var_Create( child, "many-42", VLC_VAR_INTEGER );
+    var_SetInteger( child, "many-42", 1 );
+    assert( var_InheritInteger( child, "many-42" ) == 1 );
+    var_Destroy( child, "many-42" );
+    assert( var_InheritInteger( child, "many-42" ) == 4242 );
+    vlc_object_delete( child );
+
+    for( int i = 0; i < 200; i += 2 )
+    {
+        sprintf( name, "many-%d", i );
+        var_Destroy( p_libvlc, name );
+    }
+    for( int i = 0; i < 200; i++ )
+    {
+        sprintf( name, "many-%d", i );
+        assert( (var_Type( p_libvlc, name ) != 0) == (i & 1) );
+    }
+    for( int i = 1; i < 200; i += 2 )
+    {
+        sprintf( name, "many-%d", i );
+        var_Destroy( p_libvlc, name );
+    }
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -481,6 +529,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     test_log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    test_log( "Testing many variables and inheritance\n" );
+    test_many_and_inherit( p_libvlc );
 }
 
 
@@ -0,0 +1,236 @@
+/**
+ * @file vlc-bench.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include <vlc_common.h>
+#include <vlc_input.h>
+#include <vlc_threads.h>
+
+#include "src/input/demux-run.h"
+
+/*
+ * Runs an input as fast as possible and prints one JSON object with the
+ * throughput and the resources used, so that runs of different VLC versions
+ * can be compared:
+ *  - without option, the input is demuxed (vlc-demux-bench) or demuxed and
+ *    decoded (vlc-demux-dec-bench), without any clock;
+ *  - with --player, the input is played through the whole pipeline with the
+ *    dummy video and audio outputs, at the highest playback rate.
+ */
+
+#ifdef HAVE_DECODERS
+# define BENCH_MODE "decode"
+#else
+# define BENCH_MODE "demux"
+#endif
+
+struct bench_usage
+{
+    struct timespec wall;
+    struct rusage ru;
+};
+
+static void bench_usage_get(struct bench_usage *usage)
+{
+    clock_gettime(CLOCK_MONOTONIC, &usage->wall);
+    getrusage(RUSAGE_SELF, &usage->ru);
+}
+
+static double ts_diff(const struct timespec *a, const struct timespec *b)
+{
+    return (b->tv_sec - a->tv_sec) + (b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static double tv_diff(const struct timeval *a, const struct timeval *b)
+{
+    return (b->tv_sec - a->tv_sec) + (b->tv_usec - a->tv_usec) / 1e6;
+}
+
+static void bench_print(const char *mode, const char *filename, int ret,
+                        const struct bench_usage *start,
+                        const struct bench_usage *end,
+                        const struct vlc_run_stats *stats,
+                        const libvlc_media_stats_t *player)
+{
+    double wall = ts_diff(&start->wall, &end->wall);
+    double user = tv_diff(&start->ru.ru_utime, &end->ru.ru_utime);
+    double sys = tv_diff(&start->ru.ru_stime, &end->ru.ru_stime);
+
+    printf("{\"mode\":\"%s\",\"input\":\"", mode);
+    for (const char *c = filename; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            putchar('\\');
+        if ((unsigned char)*c >= 0x20)
+            putchar(*c);
+    }
+    printf("\",\"status\":%d,\"wall_s\":%.6f,\"user_s\":%.6f,\"sys_s\":%.6f",
+           ret, wall, user, sys);
+
+    if (player != NULL)
+    {
+        printf(",\"decoded_video\":%d,\"decoded_audio\":%d"
+               ",\"displayed\":%d,\"lost\":%d,\"fps\":%.3f",
+               player->i_decoded_video, player->i_decoded_audio,
+               player->i_displayed_pictures, player->i_lost_pictures,
+               wall > 0. ? player->i_displayed_pictures / wall : 0.);
+    }
+    else
+    {
+        double decode = stats->decode_cpu_ns / 1e9;
+
+        printf(",\"demux_calls\":%"PRIu64",\"blocks\":%"PRIu64
+               ",\"bytes\":%"PRIu64, stats->demux_calls, stats->blocks,
+               stats->bytes);
+#ifdef HAVE_DECODERS
+        printf(",\"frames\":%"PRIu64",\"fps\":%.3f"
+               ",\"demux_cpu_s\":%.6f,\"decode_cpu_s\":%.6f",
+               stats->frames, wall > 0. ? stats->frames / wall : 0.,
+               user + sys > decode ? user + sys - decode : 0., decode);
+#else
+        printf(",\"blocks_per_s\":%.3f,\"demux_cpu_s\":%.6f",
+               wall > 0. ? stats->blocks / wall : 0., user + sys);
+        (void) decode;
+#endif
+    }
+
+    /* ru_maxrss is in kilobytes on Linux and the BSDs, in bytes on Darwin */
+    printf(",\"peak_rss\":%ld,\"minor_faults\":%ld,\"major_faults\":%ld"
+           ",\"ctx_switches\":%ld}\n",
+           end->ru.ru_maxrss, end->ru.ru_minflt - start->ru.ru_minflt,
+           end->ru.ru_majflt - start->ru.ru_majflt,
+           (end->ru.ru_nvcsw - start->ru.ru_nvcsw)
+           + (end->ru.ru_nivcsw - start->ru.ru_nivcsw));
+}
+
+static void bench_on_end(const struct libvlc_event_t *event, void *data)
+{
+    (void) event;
+    vlc_sem_post(data);
+}
+
+static int bench_player(const struct vlc_run_args *args, const char *path,
+                        libvlc_media_stats_t *stats)
+{
+    static const char *const options[] = {
+        "--vout=dummy", "--aout=dummy", "--no-video-title-show",
+        "--no-sub-autodetect-file",
+    };
+
+    libvlc_instance_t *vlc =
+        libvlc_create_with_options(args, ARRAY_SIZE(options), options);
+    if (vlc == NULL)
+        return -1;
+
+    int ret = -1;
+    libvlc_media_t *media = libvlc_media_new_path(vlc, path);
+    if (media == NULL)
+        goto out;
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(media);
+    if (mp == NULL)
+    {
+        libvlc_media_release(media);
+        goto out;
+    }
+
+    vlc_sem_t done;
+    vlc_sem_init(&done, 0);
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    libvlc_event_attach(em, libvlc_MediaPlayerEndReached, bench_on_end, &done);
+    libvlc_event_attach(em, libvlc_MediaPlayerEncounteredError, bench_on_end,
+                        &done);
+
+    /* The pipeline is paced by the clock: play at the highest rate, late
+     * pictures are reported as lost */
+    libvlc_media_player_set_rate(mp, INPUT_RATE_MAX);
+
+    if (libvlc_media_player_play(mp) == 0)
+    {
+        vlc_sem_wait(&done);
+        ret = libvlc_media_get_stats(media, stats) ? 0 : -1;
+    }
+
+    libvlc_event_detach(em, libvlc_MediaPlayerEndReached, bench_on_end, &done);
+    libvlc_event_detach(em, libvlc_MediaPlayerEncounteredError, bench_on_end,
+                        &done);
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+    libvlc_media_release(media);
+out:
+    libvlc_release(vlc);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename;
+    bool player = false;
+    struct vlc_run_args args;
+    vlc_run_args_init(&args);
+
+    switch (argc)
+    {
+        case 3:
+            if (strcmp(argv[1], "--player"))
+                goto usage;
+            player = true;
+            /* fall through */
+        case 2:
+            filename = argv[argc - 1];
+            break;
+        default:
+            goto usage;
+    }
+
+    struct vlc_run_stats stats = { 0 };
+    libvlc_media_stats_t player_stats;
+    struct bench_usage start, end;
+    int ret;
+
+    args.stats = &stats;
+
+    bench_usage_get(&start);
+    if (player)
+        ret = bench_player(&args, filename, &player_stats);
+    else
+        ret = vlc_demux_process_path(&args, filename);
+    bench_usage_get(&end);
+
+    bench_print(player ? "player" : BENCH_MODE, filename, ret, &start, &end,
+                &stats, player ? &player_stats : NULL);
+    return -ret;
+
+usage:
+    fprintf(stderr, "Usage: [VLC_TARGET=demux] %s [--player] <filename>\n",
+            argv[0]);
+    return 1;
+}
@@ -28,24 +28,321 @@
 # include "config.h"
 #endif
 
+#include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_url.h>
+
 #include "src/input/demux-run.h"
 
+/*
+ * Usage:
+ *   vlc-demux-run <filename>
+ *   vlc-demux-run --bench [--discard] [--repeat=N] <file|directory>...
+ *
+ * The first form runs one file through a demuxer, for fuzzing and regression.
+ *
+ * The second form measures the demux throughput over a corpus: the files,
+ * and the files of the directories, are each demuxed N times (1 by default)
+ * and the fastest run is kept. The demuxer is chosen from the file extension
+ * (ts, mp4, mkv, avi, ogg, es) unless VLC_TARGET forces one. With --discard,
+ * the ES output is dropped instead of being decoded (vlc-demux-dec-run).
+ * One JSON object is printed, with the results per file and per demuxer.
+ */
+
+static const struct
+{
+    const char *ext;
+    const char *demux;
+} bench_demuxers[] = {
+    { "ts", "ts" }, { "m2ts", "ts" }, { "mts", "ts" }, { "m2t", "ts" },
+    { "mp4", "mp4" }, { "m4a", "mp4" }, { "m4v", "mp4" }, { "mov", "mp4" },
+    { "3gp", "mp4" },
+    { "mkv", "mkv" }, { "mka", "mkv" }, { "mks", "mkv" }, { "webm", "mkv" },
+    { "avi", "avi" },
+    { "ogg", "ogg" }, { "oga", "ogg" }, { "ogv", "ogg" }, { "opus", "ogg" },
+    { "spx", "ogg" },
+    { "mp3", "es" }, { "mpga", "es" }, { "aac", "es" }, { "adts", "es" },
+    { "ac3", "es" }, { "eac3", "es" }, { "dts", "es" }, { "mlp", "es" },
+};
+
+static const char *bench_demux_name(const struct vlc_run_args *args,
+                                    const char *path)
+{
+    if (args->name != NULL)
+        return args->name;
+
+    const char *ext = strrchr(path, '.');
+    if (ext != NULL && strchr(ext, '/') == NULL)
+        for (size_t i = 0; i < ARRAY_SIZE(bench_demuxers); i++)
+            if (!strcasecmp(ext + 1, bench_demuxers[i].ext))
+                return bench_demuxers[i].demux;
+    return "any";
+}
+
+struct bench_result
+{
+    uint64_t size; /* input bytes */
+    double wall;
+    struct vlc_run_stats stats;
+};
+
+struct bench_total
+{
+    const char *demux;
+    unsigned files;
+    unsigned failures;
+    struct bench_result result;
+};
+
+struct bench
+{
+    libvlc_instance_t *vlc;
+    struct vlc_run_args args;
+    unsigned repeat;
+    bool first;
+    struct bench_total *totals;
+    size_t count;
+};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_print_string(const char *str)
+{
+    putchar('"');
+    for (const char *c = str; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            putchar('\\');
+        if ((unsigned char)*c >= 0x20)
+            putchar(*c);
+    }
+    putchar('"');
+}
+
+static void bench_print_result(const struct bench_result *r)
+{
+    printf("\"size\":%"PRIu64",\"wall_s\":%.6f,\"demux_calls\":%"PRIu64
+           ",\"packets\":%"PRIu64",\"es_bytes\":%"PRIu64, r->size, r->wall,
+           r->stats.demux_calls, r->stats.blocks, r->stats.bytes);
+#ifdef HAVE_DECODERS
+    printf(",\"frames\":%"PRIu64, r->stats.frames);
+#endif
+    printf(",\"mb_per_s\":%.3f,\"packets_per_s\":%.3f",
+           r->wall > 0. ? r->size / r->wall / 1e6 : 0.,
+           r->wall > 0. ? r->stats.blocks / r->wall : 0.);
+}
+
+static struct bench_total *bench_total_get(struct bench *bench,
+                                           const char *demux)
+{
+    for (size_t i = 0; i < bench->count; i++)
+        if (!strcmp(bench->totals[i].demux, demux))
+            return &bench->totals[i];
+
+    struct bench_total *totals = realloc(bench->totals,
+                                         (bench->count + 1) * sizeof (*totals));
+    if (totals == NULL)
+        return NULL;
+
+    bench->totals = totals;
+    totals += bench->count++;
+    memset(totals, 0, sizeof (*totals));
+    totals->demux = demux;
+    return totals;
+}
+
+static int bench_file(struct bench *bench, const char *path)
+{
+    struct stat st;
+    if (stat(path, &st))
+    {
+        fprintf(stderr, "Error: cannot stat %s\n", path);
+        return -1;
+    }
+
+    char *url = vlc_path2uri(path, NULL);
+    if (url == NULL)
+        return -1;
+
+    struct vlc_run_args args = bench->args;
+    struct bench_result best = { .wall = -1. };
+    int ret = 0;
+
+    args.name = bench_demux_name(&bench->args, path);
+
+    for (unsigned i = 0; i < bench->repeat && ret == 0; i++)
+    {
+        struct bench_result r = { .size = st.st_size };
+
+        args.stats = &r.stats;
+
+        double start = bench_now();
+        ret = libvlc_demux_process_url(bench->vlc, &args, url);
+        r.wall = bench_now() - start;
+
+        if (best.wall < 0. || r.wall < best.wall)
+            best = r;
+    }
+    free(url);
+
+    printf("%s\n    {\"input\":", bench->first ? "" : ",");
+    bench_print_string(path);
+    printf(",\"demux\":\"%s\",\"status\":%d,", args.name, ret);
+    bench_print_result(&best);
+    putchar('}');
+    bench->first = false;
+
+    struct bench_total *total = bench_total_get(bench, args.name);
+    if (total != NULL)
+    {
+        total->files++;
+        if (ret)
+            total->failures++;
+        total->result.size += best.size;
+        total->result.wall += best.wall;
+        total->result.stats.demux_calls += best.stats.demux_calls;
+        total->result.stats.blocks += best.stats.blocks;
+        total->result.stats.bytes += best.stats.bytes;
+        total->result.stats.frames += best.stats.frames;
+    }
+    return ret;
+}
+
+static int bench_filter(const struct dirent *ent)
+{
+    return ent->d_name[0] != '.';
+}
+
+static int bench_path(struct bench *bench, const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) || !S_ISDIR(st.st_mode))
+        return bench_file(bench, path);
+
+    /* the files of a directory, in a stable order */
+    struct dirent **ents;
+    int n = scandir(path, &ents, bench_filter, alphasort);
+    if (n < 0)
+    {
+        fprintf(stderr, "Error: cannot read directory %s\n", path);
+        return -1;
+    }
+
+    int ret = 0;
+    for (int i = 0; i < n; i++)
+    {
+        char *file;
+        if (asprintf(&file, "%s/%s", path, ents[i]->d_name) >= 0)
+        {
+            if (stat(file, &st) == 0 && S_ISREG(st.st_mode)
+             && bench_file(bench, file))
+                ret = -1;
+            free(file);
+        }
+        free(ents[i]);
+    }
+    free(ents);
+    return ret;
+}
+
+static int bench_run(struct vlc_run_args *args, unsigned repeat,
+                     int argc, char *argv[])
+{
+    struct bench bench = {
+        .args = *args, .repeat = repeat, .first = true,
+    };
+
+    bench.vlc = libvlc_create(args);
+    if (bench.vlc == NULL)
+        return -1;
+
+#ifdef HAVE_DECODERS
+    printf("{\"mode\":\"%s\"", args->discard_es ? "demux" : "decode");
+#else
+    printf("{\"mode\":\"demux\"");
+#endif
+    printf(",\"repeat\":%u,\"files\":[", repeat);
+
+    int ret = 0;
+    for (int i = 0; i < argc; i++)
+        if (bench_path(&bench, argv[i]))
+            ret = -1;
+
+    printf("\n  ],\"demuxers\":{");
+    for (size_t i = 0; i < bench.count; i++)
+    {
+        const struct bench_total *total = &bench.totals[i];
+
+        printf("%s\n    \"%s\":{\"files\":%u,\"failures\":%u,",
+               i ? "," : "", total->demux, total->files, total->failures);
+        bench_print_result(&total->result);
+        putchar('}');
+    }
+    printf("\n  }}\n");
+
+    free(bench.totals);
+    libvlc_release(bench.vlc);
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: [VLC_TARGET=demux] %s <filename>\n"
+            "       [VLC_TARGET=demux] %s --bench [--discard] [--repeat=N] "
+            "<file|directory>...\n", name, name);
+}
+
 int main(int argc, char *argv[])
 {
-    const char *filename;
     struct vlc_run_args args;
     vlc_run_args_init(&args);
 
-    switch (argc)
+    if (argc >= 2 && !strcmp(argv[1], "--bench"))
     {
-        case 2:
-            filename = argv[argc - 1];
-            break;
-        default:
-            fprintf(stderr, "Usage: [VLC_TARGET=demux] %s <filename>\n", argv[0]);
+        unsigned repeat = 1;
+        int i = 2;
+
+        for (; i < argc && !strncmp(argv[i], "--", 2); i++)
+        {
+            if (!strcmp(argv[i], "--discard"))
+                args.discard_es = true;
+            else if (!strncmp(argv[i], "--repeat=", 9))
+                repeat = strtoul(argv[i] + 9, NULL, 10);
+            else
+                repeat = 0;
+
+            if (repeat == 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (i == argc)
+        {
+            usage(argv[0]);
             return 1;
+        }
+        return -bench_run(&args, repeat, argc - i, argv + i);
+    }
+
+    if (argc != 2)
+    {
+        usage(argv[0]);
+        return 1;
     }
 
-    return -vlc_demux_process_path(&args, filename);
+    return -vlc_demux_process_path(&args, argv[1]);
 }